@@ -3,13 +3,20 @@ import random
 import enum
 import socket
 
-CURRENT_REQUEST_VERSION = 1
-MAX_REQUEST_DATA_SIZE = 32
-MAX_PACKET_SIZE = 48
+CURRENT_REQUEST_VERSION = 3
+MAX_REQUEST_DATA_SIZE = 1024
+MAX_PACKET_SIZE = 1040
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ReadMemoryRanges = 3,
+    WriteMemoryRanges = 4,
+    SubscribeMemory = 5,
+    GetFrameTimeStats = 6,
+    GetIPCStats = 7
+
+FRAME_TIME_CATEGORIES = ("jit", "hle", "gpu", "draw", "shader", "flush")
 
 CITRA_PORT = 45987
 
@@ -90,6 +97,115 @@ class Citra:
                 return False
         return True
 
+    def read_memory_ranges(self, ranges):
+        """
+        Reads several (address, size) ranges in one request, their sizes adding up to at most
+        MAX_REQUEST_DATA_SIZE
+        >>> c.read_memory_ranges([(0x100000, 2), (0x100002, 2)])
+        [b'\\x07\\x00', b'\\x00\\xeb']
+        """
+        request_data = b"".join(struct.pack("II", address, size) for address, size in ranges)
+        request, request_id = self._generate_header(RequestType.ReadMemoryRanges, len(request_data))
+        self.socket.sendto(request + request_data, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.ReadMemoryRanges)
+        if not reply_data:
+            return None
+        return self._split_ranges(reply_data, ranges)
+
+    def write_memory_ranges(self, writes):
+        """
+        Writes several (address, contents) pairs in one request
+        >>> c.write_memory_ranges([(0x100000, b"\\xff\\xff\\xff\\xff")])
+        True
+        >>> c.write_memory_ranges([(0x100000, b"\\x07\\x00\\x00\\xeb")])
+        True
+        """
+        request_data = b"".join(struct.pack("II", address, len(contents)) + contents
+                                for address, contents in writes)
+        request, request_id = self._generate_header(RequestType.WriteMemoryRanges, len(request_data))
+        self.socket.sendto(request + request_data, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        return None != self._read_and_validate_header(raw_reply, request_id, RequestType.WriteMemoryRanges)
+
+    def subscribe_memory(self, ranges):
+        """
+        Watches (address, size) ranges, returns the id to pass to wait_memory_update and to
+        unsubscribe_memory. Citra sends the ranges at the end of every frame they changed.
+        """
+        request_data = b"".join(struct.pack("II", address, size) for address, size in ranges)
+        request, request_id = self._generate_header(RequestType.SubscribeMemory, len(request_data))
+        self.socket.sendto(request + request_data, (self.address, CITRA_PORT))
+        self.socket.recv(MAX_PACKET_SIZE)
+        return request_id
+
+    def unsubscribe_memory(self, subscription_id):
+        request = struct.pack("IIII", CURRENT_REQUEST_VERSION, subscription_id, RequestType.SubscribeMemory, 0)
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+    def wait_memory_update(self, subscription_id, ranges):
+        """
+        Waits for the next update of a subscription, returns the contents of its ranges
+        """
+        while True:
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, subscription_id, RequestType.SubscribeMemory)
+            if reply_data:
+                return self._split_ranges(reply_data, ranges)
+
+    def get_frame_time_stats(self):
+        """
+        Returns the frame time percentiles of the last seconds and the average time per frame of
+        each subsystem, all in milliseconds
+        >>> sorted(c.get_frame_time_stats().keys())
+        ['draw', 'flush', 'gpu', 'hle', 'jit', 'p50', 'p95', 'p99', 'shader']
+        """
+        request, request_id = self._generate_header(RequestType.GetFrameTimeStats, 0)
+        self.socket.sendto(request, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.GetFrameTimeStats)
+        if not reply_data:
+            return None
+        values = struct.unpack("%df" % (len(reply_data) // 4), reply_data)
+        return dict(zip(("p50", "p95", "p99") + FRAME_TIME_CATEGORIES, values))
+
+    def get_ipc_stats(self, sample_interval=None):
+        """
+        Returns the IPC commands that took the most time, as dicts with the service name, command
+        header, request count, and the total time and latency percentiles in microseconds. A
+        sample_interval first enables the recorder, keeping one request in full out of that
+        number, or disables it if 0.
+        >>> type(c.get_ipc_stats(64))
+        <class 'list'>
+        """
+        data = b"" if sample_interval is None else struct.pack("I", sample_interval)
+        request, request_id = self._generate_header(RequestType.GetIPCStats, len(data))
+        self.socket.sendto(request + data, (self.address, CITRA_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.GetIPCStats)
+        if reply_data is None:
+            return None
+        entry_size = 28
+        result = []
+        for offset in range(0, len(reply_data) - entry_size + 1, entry_size):
+            name, header, count, total_us, p50_us, p99_us = struct.unpack(
+                "8sIIIII", reply_data[offset:offset + entry_size])
+            result.append({"service": name.rstrip(b"\0").decode("ascii", "replace"),
+                           "header": header, "count": count, "total_us": total_us,
+                           "p50_us": p50_us, "p99_us": p99_us})
+        return result
+
+    def _split_ranges(self, data, ranges):
+        result = []
+        for _, size in ranges:
+            result.append(data[:size])
+            data = data[size:]
+        return result
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Citra()})
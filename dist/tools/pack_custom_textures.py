@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+# Copyright 2020 Citra Emulator Project
+# Licensed under GPLv2 or any later version
+# Refer to the license.txt file included.
+
+"""
+Packs the compressed custom textures of a title into a .ctp file, which Citra maps and uploads
+without decoding. The textures are named like the PNG ones, tex1_[width]x[height]_[hash]_[format],
+with the .astc extension of astcenc or the .dds extension of BC7 encoders such as texconv.
+
+Citra expects the bottom row first, so encode the images flipped vertically, for instance with
+"astcenc -cl image.png image.astc 6x6 -medium -yflip" or "texconv -f BC7_UNORM -vflip image.png".
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+PACK_MAGIC = b"CTPK"
+PACK_VERSION = 1
+
+# Values of Core::CustomTexFormat
+FORMAT_RGBA8 = 0
+FORMAT_BC7 = 1
+ASTC_FORMATS = {4: 2, 6: 3, 8: 4}
+
+ASTC_MAGIC = 0x5CA1AB13
+DXGI_FORMAT_BC7_UNORM = 98
+DXGI_FORMAT_BC7_UNORM_SRGB = 99
+
+NAME_PATTERN = re.compile(r"^tex1_(\d+)x(\d+)_([0-9A-Fa-f]{16})_(\d+)\.(astc|dds)$")
+
+
+def level_size(width, height, block):
+    return ((width + block - 1) // block) * ((height + block - 1) // block) * 16
+
+
+def read_astc(data):
+    magic, block_x, block_y, block_z = struct.unpack_from("<IBBB", data, 0)
+    if magic != ASTC_MAGIC:
+        raise ValueError("not an ASTC file")
+    if block_x != block_y or block_z != 1 or block_x not in ASTC_FORMATS:
+        raise ValueError("unsupported block size {}x{}x{}".format(block_x, block_y, block_z))
+    width = int.from_bytes(data[7:10], "little")
+    height = int.from_bytes(data[10:13], "little")
+    size = level_size(width, height, block_x)
+    if len(data) < 16 + size:
+        raise ValueError("truncated image")
+    return ASTC_FORMATS[block_x], width, height, 1, data[16:16 + size]
+
+
+def read_dds(data):
+    if data[0:4] != b"DDS " or data[84:88] != b"DX10":
+        raise ValueError("not a DDS file with a DX10 header")
+    height, width = struct.unpack_from("<II", data, 12)
+    num_levels = max(struct.unpack_from("<I", data, 28)[0], 1)
+    dxgi_format = struct.unpack_from("<I", data, 128)[0]
+    if dxgi_format not in (DXGI_FORMAT_BC7_UNORM, DXGI_FORMAT_BC7_UNORM_SRGB):
+        raise ValueError("unsupported DXGI format {}".format(dxgi_format))
+    size = 0
+    for level in range(num_levels):
+        size += level_size(max(width >> level, 1), max(height >> level, 1), 4)
+    if len(data) < 148 + size:
+        raise ValueError("truncated image")
+    return FORMAT_BC7, width, height, num_levels, data[148:148 + size]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Packs compressed custom textures.")
+    parser.add_argument("input", help="directory searched recursively for the textures")
+    parser.add_argument("output", help="pack to write, put it in load/textures/[TitleID]/")
+    args = parser.parse_args()
+
+    textures = {}
+    for root, _, files in os.walk(args.input):
+        for name in files:
+            match = NAME_PATTERN.match(name)
+            if not match:
+                continue
+            path = os.path.join(root, name)
+            texture_hash = int(match.group(3), 16)
+            if texture_hash in textures:
+                print("Skipping {}, its hash is used by another texture".format(path))
+                continue
+            with open(path, "rb") as f:
+                data = f.read()
+            try:
+                if match.group(5) == "astc":
+                    textures[texture_hash] = read_astc(data)
+                else:
+                    textures[texture_hash] = read_dds(data)
+            except (ValueError, struct.error) as e:
+                print("Skipping {}: {}".format(path, e))
+                continue
+            width, height = textures[texture_hash][1:3]
+            if width & (width - 1) or height & (height - 1) or width > 0xFFFF or height > 0xFFFF:
+                print("Skipping {}, its size is not a power of 2".format(path))
+                del textures[texture_hash]
+
+    # The entries are sorted by hash for the lookups, the levels follow aligned to 16 bytes
+    header_size = 16 + 32 * len(textures)
+    entries = bytearray()
+    blob = bytearray()
+    for texture_hash in sorted(textures):
+        texture_format, width, height, num_levels, levels = textures[texture_hash]
+        offset = header_size + len(blob)
+        entries += struct.pack("<QIHHIIQ", texture_hash, texture_format, width, height,
+                               num_levels, len(levels), offset)
+        blob += levels
+        blob += bytes(-len(blob) % 16)
+
+    with open(args.output, "wb") as f:
+        f.write(PACK_MAGIC + struct.pack("<III", PACK_VERSION, len(textures), 0))
+        f.write(entries)
+        f.write(blob)
+    print("Packed {} textures into {}".format(len(textures), args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
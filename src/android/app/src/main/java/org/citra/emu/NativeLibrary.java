@@ -262,6 +262,8 @@ public final class NativeLibrary {
 
     public static native void ResetCamera();
 
+    public static native boolean ToggleProfileTrace();
+
     public static native void Screenshot(OnScreenshotCompleteListener listener);
 
     // input overlay
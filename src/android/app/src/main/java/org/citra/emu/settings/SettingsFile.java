@@ -24,6 +24,7 @@ public final class SettingsFile {
     // Core
     public static final String KEY_USE_CPU_JIT = "use_cpu_jit";
     public static final String KEY_IS_NEW_3DS = "is_new_3ds";
+    public static final String KEY_USE_PARALLEL_CORES = "use_parallel_cores";
     public static final String KEY_USE_VIRTUAL_SD = "use_virtual_sd";
     public static final String KEY_SYSTEM_REGION = "region_value";
     public static final String KEY_SYSTEM_LANGUAGE = "language";
@@ -42,12 +43,25 @@ public final class SettingsFile {
     public static final String KEY_FACTOR_3D = "factor_3d";
     public static final String KEY_CUSTOM_TEXTURES = "custom_textures";
     public static final String KEY_PRELOAD_TEXTURES = "preload_textures";
+    public static final String KEY_TEXTURE_MEMORY_BUDGET = "texture_memory_budget";
     public static final String KEY_LAYOUT_OPTION = "layout_option";
     public static final String KEY_SHADER_TYPE = "shader_type";
+    public static final String KEY_ASYNC_SHADER = "async_shader";
+    public static final String KEY_GPU_TEXTURE_DECODE = "gpu_texture_decode";
+    public static final String KEY_GENERATE_MIPMAPS = "generate_mipmaps";
+    public static final String KEY_MERGE_DRAW_CALLS = "merge_draw_calls";
+    public static final String KEY_SPECIALIZE_SHADER_UNIFORMS = "specialize_shader_uniforms";
+    public static final String KEY_CACHE_VERTEX_ARRAYS = "cache_vertex_arrays";
+    public static final String KEY_MULTITHREADED_SW_RASTERIZER = "multithreaded_sw_rasterizer";
+    public static final String KEY_USE_GPU_THREAD = "use_gpu_thread";
+    public static final String KEY_VERTEX_CACHE_SIZE = "vertex_cache_size";
+    public static final String KEY_USE_CODE_CACHE = "use_code_cache";
     public static final String KEY_POST_PROCESSING_SHADER = "pp_shader_name";
     // Audio
     public static final String KEY_ENABLE_DSP_LLE = "enable_dsp_lle";
     public static final String KEY_AUDIO_STRETCHING = "enable_audio_stretching";
+    public static final String KEY_AUDIO_STRETCH_LATENCY = "audio_stretch_latency";
+    public static final String KEY_AUDIO_THREAD = "enable_audio_thread";
     public static final String KEY_AUDIO_VOLUME = "volume";
     public static final String KEY_AUDIO_ENGINE = "output_engine";
     public static final String KEY_AUDIO_DEVICE = "output_device";
@@ -119,15 +119,29 @@ public final class SettingsFragment extends Fragment {
         Setting showFPS = rendererSection.getSetting(SettingsFile.KEY_SHOW_FPS);
         Setting resolution = rendererSection.getSetting(SettingsFile.KEY_RESOLUTION_FACTOR);
         Setting hwShader = rendererSection.getSetting(SettingsFile.KEY_USE_HW_SHADER);
+        Setting shaderJit = rendererSection.getSetting(SettingsFile.KEY_USE_SHADER_JIT);
         Setting accurateMul = rendererSection.getSetting(SettingsFile.KEY_SHADERS_ACCURATE_MUL);
         Setting shader = rendererSection.getSetting(SettingsFile.KEY_POST_PROCESSING_SHADER);
         Setting frameLimit = rendererSection.getSetting(SettingsFile.KEY_FRAME_LIMIT);
         Setting customTex = rendererSection.getSetting(SettingsFile.KEY_CUSTOM_TEXTURES);
         Setting preloadTex = rendererSection.getSetting(SettingsFile.KEY_PRELOAD_TEXTURES);
         Setting factor3d = rendererSection.getSetting(SettingsFile.KEY_FACTOR_3D);
+        Setting textureBudget = rendererSection.getSetting(SettingsFile.KEY_TEXTURE_MEMORY_BUDGET);
 
         SettingSection debugSection = mSettings.getSection(Settings.SECTION_INI_DEBUG);
         Setting shaderType = debugSection.getSetting(SettingsFile.KEY_SHADER_TYPE);
+        Setting asyncShader = debugSection.getSetting(SettingsFile.KEY_ASYNC_SHADER);
+        Setting gpuTextureDecode = debugSection.getSetting(SettingsFile.KEY_GPU_TEXTURE_DECODE);
+        Setting generateMipmaps = debugSection.getSetting(SettingsFile.KEY_GENERATE_MIPMAPS);
+        Setting mergeDrawCalls = debugSection.getSetting(SettingsFile.KEY_MERGE_DRAW_CALLS);
+        Setting specializeShaderUniforms =
+                debugSection.getSetting(SettingsFile.KEY_SPECIALIZE_SHADER_UNIFORMS);
+        Setting cacheVertexArrays = debugSection.getSetting(SettingsFile.KEY_CACHE_VERTEX_ARRAYS);
+        Setting swRasterizerThreads =
+            debugSection.getSetting(SettingsFile.KEY_MULTITHREADED_SW_RASTERIZER);
+        Setting useGpuThread = debugSection.getSetting(SettingsFile.KEY_USE_GPU_THREAD);
+        Setting vertexCacheSize = debugSection.getSetting(SettingsFile.KEY_VERTEX_CACHE_SIZE);
+        Setting codeCache = debugSection.getSetting(SettingsFile.KEY_USE_CODE_CACHE);
         Setting presentThread = debugSection.getSetting(SettingsFile.KEY_USE_PRESENT_THREAD);
         Setting cpuLimit = debugSection.getSetting(SettingsFile.KEY_CPU_USAGE_LIMIT);
         Setting ocrKey = debugSection.getSetting(SettingsFile.KEY_BAIDU_OCR_KEY);
@@ -146,6 +160,8 @@ public final class SettingsFragment extends Fragment {
                                    R.string.show_fps, 0, true, showFPS));
         sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_HW_SHADER, Settings.SECTION_INI_RENDERER,
                                    R.string.setting_hw_shader, R.string.setting_hw_shader_desc, true, hwShader));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_SHADER_JIT, Settings.SECTION_INI_RENDERER,
+                                   R.string.setting_shader_jit, R.string.setting_shader_jit_desc, false, shaderJit));
         sl.add(new SingleChoiceSetting(SettingsFile.KEY_SHADERS_ACCURATE_MUL,
                 Settings.SECTION_INI_RENDERER, R.string.setting_shaders_accurate_mul,
                 R.string.setting_shaders_accurate_mul_desc, R.array.accurateMulEntries,
@@ -153,6 +169,35 @@ public final class SettingsFragment extends Fragment {
         sl.add(new SingleChoiceSetting(SettingsFile.KEY_SHADER_TYPE, Settings.SECTION_INI_DEBUG,
                 R.string.setting_shader_type, 0, R.array.shaderEntries,
                 R.array.shaderValues, 1, shaderType));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_ASYNC_SHADER, Settings.SECTION_INI_DEBUG,
+                R.string.setting_async_shader, R.string.setting_async_shader_desc, false, asyncShader));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_GPU_TEXTURE_DECODE, Settings.SECTION_INI_DEBUG,
+                R.string.setting_gpu_texture_decode, R.string.setting_gpu_texture_decode_desc, false,
+                gpuTextureDecode));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_GENERATE_MIPMAPS, Settings.SECTION_INI_DEBUG,
+                R.string.setting_generate_mipmaps, R.string.setting_generate_mipmaps_desc, false,
+                generateMipmaps));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_MERGE_DRAW_CALLS, Settings.SECTION_INI_DEBUG,
+                R.string.setting_merge_draw_calls, R.string.setting_merge_draw_calls_desc, false,
+                mergeDrawCalls));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_SPECIALIZE_SHADER_UNIFORMS,
+                Settings.SECTION_INI_DEBUG, R.string.setting_specialize_shader_uniforms,
+                R.string.setting_specialize_shader_uniforms_desc, false, specializeShaderUniforms));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_CACHE_VERTEX_ARRAYS, Settings.SECTION_INI_DEBUG,
+                R.string.setting_cache_vertex_arrays, R.string.setting_cache_vertex_arrays_desc,
+                false, cacheVertexArrays));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_MULTITHREADED_SW_RASTERIZER,
+                Settings.SECTION_INI_DEBUG, R.string.setting_multithreaded_sw_rasterizer,
+                R.string.setting_multithreaded_sw_rasterizer_desc, false, swRasterizerThreads));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_GPU_THREAD, Settings.SECTION_INI_DEBUG,
+                R.string.setting_use_gpu_thread, R.string.setting_use_gpu_thread_desc, false,
+                useGpuThread));
+        sl.add(new SliderSetting(SettingsFile.KEY_VERTEX_CACHE_SIZE, Settings.SECTION_INI_DEBUG,
+                R.string.setting_vertex_cache_size, R.string.setting_vertex_cache_size_desc, 4096,
+                "", 1024, vertexCacheSize));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_CODE_CACHE, Settings.SECTION_INI_DEBUG,
+                R.string.setting_use_code_cache, R.string.setting_use_code_cache_desc, false,
+                codeCache));
         // post process shaders
         String[] stringValues = getShaderValues();
         String[] stringEntries = getSettingEntries(stringValues);
@@ -173,11 +218,15 @@ public final class SettingsFragment extends Fragment {
         sl.add(new SliderSetting(SettingsFile.KEY_FACTOR_3D, Settings.SECTION_INI_RENDERER,
                 R.string.setting_factor_3d, 0, 10, "",
                 0, factor3d));
+        sl.add(new SliderSetting(SettingsFile.KEY_TEXTURE_MEMORY_BUDGET,
+                Settings.SECTION_INI_RENDERER, R.string.setting_texture_memory_budget,
+                R.string.setting_texture_memory_budget_desc, 4096, "MB", 1024, textureBudget));
 
         // core
         sl.add(new HeaderSetting(null, null, R.string.setting_header_core, 0));
         SettingSection coreSection = mSettings.getSection(Settings.SECTION_INI_CORE);
         Setting isNew3DS = coreSection.getSetting(SettingsFile.KEY_IS_NEW_3DS);
+        Setting parallelCores = coreSection.getSetting(SettingsFile.KEY_USE_PARALLEL_CORES);
         Setting systemRegion = coreSection.getSetting(SettingsFile.KEY_SYSTEM_REGION);
         Setting cpuJIT = coreSection.getSetting(SettingsFile.KEY_USE_CPU_JIT);
         Setting language = coreSection.getSetting(SettingsFile.KEY_SYSTEM_LANGUAGE);
@@ -185,6 +234,9 @@ public final class SettingsFragment extends Fragment {
 
         sl.add(new CheckBoxSetting(SettingsFile.KEY_IS_NEW_3DS, Settings.SECTION_INI_CORE,
                 R.string.setting_is_new_3ds, R.string.setting_is_new_3ds_desc, false, isNew3DS));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_PARALLEL_CORES, Settings.SECTION_INI_CORE,
+                R.string.setting_use_parallel_cores, R.string.setting_use_parallel_cores_desc,
+                false, parallelCores));
         sl.add(new CheckBoxSetting(SettingsFile.KEY_USE_CPU_JIT, Settings.SECTION_INI_CORE,
                 R.string.setting_enable_cpu_jit, 0, true, cpuJIT));
         sl.add(new SingleChoiceSetting(SettingsFile.KEY_SYSTEM_REGION, Settings.SECTION_INI_CORE,
@@ -208,6 +260,9 @@ public final class SettingsFragment extends Fragment {
         SettingSection audioSection = mSettings.getSection(Settings.SECTION_INI_AUDIO);
         Setting audioOutput = audioSection.getSetting(SettingsFile.KEY_AUDIO_ENGINE);
         Setting audioStretching = audioSection.getSetting(SettingsFile.KEY_AUDIO_STRETCHING);
+        Setting audioStretchLatency =
+            audioSection.getSetting(SettingsFile.KEY_AUDIO_STRETCH_LATENCY);
+        Setting audioThread = audioSection.getSetting(SettingsFile.KEY_AUDIO_THREAD);
 
         stringEntries = getResources().getStringArray(R.array.audioOuputEntries);
         stringValues = getResources().getStringArray(R.array.audioOuputValues);
@@ -216,6 +271,12 @@ public final class SettingsFragment extends Fragment {
             R.string.setting_audio_output, 0, stringEntries, stringValues, "auto", audioOutput));
         sl.add(new CheckBoxSetting(SettingsFile.KEY_AUDIO_STRETCHING, Settings.SECTION_INI_AUDIO,
                                    R.string.setting_audio_stretching, R.string.setting_audio_stretching_description, false, audioStretching));
+        sl.add(new SliderSetting(SettingsFile.KEY_AUDIO_STRETCH_LATENCY, Settings.SECTION_INI_AUDIO,
+                                 R.string.setting_audio_stretch_latency,
+                                 R.string.setting_audio_stretch_latency_description, 250, "ms", 100,
+                                 audioStretchLatency));
+        sl.add(new CheckBoxSetting(SettingsFile.KEY_AUDIO_THREAD, Settings.SECTION_INI_AUDIO,
+                                   R.string.setting_audio_thread, R.string.setting_audio_thread_description, false, audioThread));
 
         // mic
         Setting micType = audioSection.getSetting(SettingsFile.KEY_MIC_INPUT_TYPE);
@@ -259,12 +259,17 @@ public final class EditorActivity extends AppCompatActivity {
     }
 
     private void deleteShaderCache() {
-        File cache = DirectoryInitialization.getShaderCacheFile(mProgramId);
-        if (cache.exists()) {
-            if (cache.delete()) {
-                Toast.makeText(this, R.string.delete_success, Toast.LENGTH_SHORT).show();
+        File[] caches = {DirectoryInitialization.getShaderCacheFile(mProgramId),
+                         DirectoryInitialization.getSeparableShaderCacheFile(mProgramId)};
+        boolean deleted = false;
+        for (File cache : caches) {
+            if (cache.exists() && cache.delete()) {
+                deleted = true;
             }
         }
+        if (deleted) {
+            Toast.makeText(this, R.string.delete_success, Toast.LENGTH_SHORT).show();
+        }
     }
 
     private void deleteAppSdmc() {
@@ -18,6 +18,7 @@ import android.widget.RadioButton;
 import android.widget.RadioGroup;
 import android.widget.SeekBar;
 import android.widget.TextView;
+import android.widget.Toast;
 
 import androidx.annotation.NonNull;
 import androidx.fragment.app.DialogFragment;
@@ -144,6 +145,7 @@ public class RunningSettingDialog extends DialogFragment {
         public static final int SETTING_MEMORY_VIEWER = 206;
         public static final int SETTING_EDIT_SCREEN = 207;
         public static final int SETTING_EXIT_GAME = 208;
+        public static final int SETTING_PROFILE_TRACE = 209;
 
         public static final int SETTING_TRANSLATE_ENABLED = 301;
         public static final int SETTING_TRANSLATE_VERTICAL = 302;
@@ -269,6 +271,12 @@ public class RunningSettingDialog extends DialogFragment {
                 activity.startConfiguringLayout();
                 dismiss();
                 break;
+            case SettingsItem.SETTING_PROFILE_TRACE:
+                Toast.makeText(getActivity(), NativeLibrary.ToggleProfileTrace() ?
+                        R.string.emulation_profile_trace_started :
+                        R.string.emulation_profile_trace_stopped, Toast.LENGTH_SHORT).show();
+                dismiss();
+                break;
             case SettingsItem.SETTING_EXIT_GAME:
                 NativeLibrary.StopEmulation();
                 activity.finish();
@@ -548,6 +556,7 @@ public class RunningSettingDialog extends DialogFragment {
             }
             mSettings.add(new SettingsItem(SettingsItem.SETTING_LOAD_SUBMENU, R.string.multiplayer, SettingsItem.TYPE_TEXT, MENU_MULTIPLAYER));
             mSettings.add(new SettingsItem(SettingsItem.SETTING_EDIT_SCREEN, R.string.emulation_screen_layout, SettingsItem.TYPE_TEXT, 0));
+            mSettings.add(new SettingsItem(SettingsItem.SETTING_PROFILE_TRACE, R.string.emulation_profile_trace, SettingsItem.TYPE_TEXT, 0));
             mSettings.add(new SettingsItem(SettingsItem.SETTING_EXIT_GAME, R.string.emulation_stop_running, SettingsItem.TYPE_TEXT, 0));
             notifyDataSetChanged();
         }
@@ -158,6 +158,10 @@ public final class DirectoryInitialization {
         return new File(getUserDirectory() + "/Cache/" + programId + ".cache");
     }
 
+    public static File getSeparableShaderCacheFile(String programId) {
+        return new File(getUserDirectory() + "/Cache/" + programId + ".sep.cache");
+    }
+
     public static void saveInputOverlay(Context context) {
         final int[] inputIds = InputOverlay.ResIds;
         final String[] inputNames = InputOverlay.ResNames;
@@ -222,8 +222,8 @@ struct CaptureSession {
         }
     }
 
-    std::vector<u16> GetOutput(const Service::CAM::Resolution& resolution, bool mirror, bool invert,
-                               bool rgb565) {
+    void GetOutput(std::vector<u16>& output, const Service::CAM::Resolution& resolution,
+                   bool mirror, bool invert, bool rgb565) {
         {
             std::lock_guard lock{image_mutex};
             out_image.Swap(yuv_image);
@@ -270,7 +270,7 @@ struct CaptureSession {
             std::swap(rotated_width, rotated_height);
         }
         // Rotate the image to get it in upright position
-        YUVImage rotated(rotated_width, rotated_height);
+        rotated.SetDimension(rotated_width, rotated_height);
         libyuv::I420Rotate(YUV(out_image), YUV(rotated), out_image.width, out_image.height,
                            rotation_mode);
 
@@ -289,7 +289,7 @@ struct CaptureSession {
         const int y_offset = crop_y * rotated.width + crop_x;
         const int uv_offset = crop_y / 2 * rotated.width / 2 + crop_x / 2;
 
-        YUVImage scaled(resolution.width, resolution.height);
+        scaled.SetDimension(resolution.width, resolution.height);
         // Crop and scale
         libyuv::I420Scale(rotated.y.data() + y_offset, rotated.width, rotated.u.data() + uv_offset,
                           rotated.width / 2, rotated.v.data() + uv_offset, rotated.width / 2,
@@ -297,12 +297,12 @@ struct CaptureSession {
                           libyuv::kFilterBilinear);
 
         if (mirror) {
-            YUVImage mirrored(scaled.width, scaled.height);
+            mirrored.SetDimension(scaled.width, scaled.height);
             libyuv::I420Mirror(YUV(scaled), YUV(mirrored), resolution.width, resolution.height);
             scaled.Swap(mirrored);
         }
 
-        std::vector<u16> output(resolution.width * resolution.height);
+        output.resize(resolution.width * resolution.height);
         if (rgb565) {
             libyuv::I420ToRGB565(YUV(scaled), reinterpret_cast<u8*>(output.data()),
                                  resolution.width * 2, resolution.width,
@@ -312,7 +312,6 @@ struct CaptureSession {
                                resolution.width * 2, resolution.width,
                                invert ? -resolution.height : resolution.height);
         }
-        return output;
     }
 
     static void OnCameraDisconnected(void* context, ACameraDevice* device) {
@@ -427,6 +426,10 @@ struct CaptureSession {
     std::mutex image_mutex;
     YUVImage yuv_image;
     YUVImage out_image;
+    // Intermediate images of GetOutput, kept to not reallocate them every frame
+    YUVImage rotated;
+    YUVImage scaled;
+    YUVImage mirrored;
 
     //
     std::string camera_id;
@@ -565,8 +568,8 @@ public:
         rgb565 = f == Service::CAM::OutputFormat::RGB565;
     }
 
-    std::vector<u16> ReceiveFrame() {
-        return GetCurrentSession().GetOutput(resolution, mirror, invert, rgb565);
+    void ReceiveFrame(std::vector<u16>& frame) {
+        GetCurrentSession().GetOutput(frame, resolution, mirror, invert, rgb565);
     }
 
     bool IsPreviewAvailable() {
@@ -624,8 +627,8 @@ void NDKCameraInterface::SetFrameRate(Service::CAM::FrameRate frame_rate) {
     // igore
 }
 
-std::vector<u16> NDKCameraInterface::ReceiveFrame() {
-    return impl->ReceiveFrame();
+void NDKCameraInterface::ReceiveFrame(std::vector<u16>& frame) {
+    impl->ReceiveFrame(frame);
 }
 
 bool NDKCameraInterface::IsPreviewAvailable() {
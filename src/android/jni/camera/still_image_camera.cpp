@@ -55,9 +55,9 @@ void StillImageCamera::SetFrameRate(Service::CAM::FrameRate frame_rate) {
     // ignore
 }
 
-std::vector<u16> StillImageCamera::ReceiveFrame() {
-    return CameraUtil::ProcessImage(pixels, width, height, output_rgb, flip_horizontal,
-                                    flip_vertical);
+void StillImageCamera::ReceiveFrame(std::vector<u16>& frame) {
+    frame = CameraUtil::ProcessImage(pixels, width, height, output_rgb, flip_horizontal,
+                                     flip_vertical);
 }
 
 bool StillImageCamera::IsPreviewAvailable() {
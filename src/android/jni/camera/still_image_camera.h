@@ -20,7 +20,7 @@ public:
     void SetEffect(Service::CAM::Effect) override;
     void SetFormat(Service::CAM::OutputFormat) override;
     void SetFrameRate(Service::CAM::FrameRate frame_rate) override;
-    std::vector<u16> ReceiveFrame() override;
+    void ReceiveFrame(std::vector<u16>& frame) override;
     bool IsPreviewAvailable() override;
 
 private:
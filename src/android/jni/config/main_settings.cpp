@@ -7,6 +7,7 @@ namespace Config {
 // core
 const ConfigInfo<bool> USE_CPU_JIT{{"Core", "use_cpu_jit"}, true};
 const ConfigInfo<bool> IS_NEW_3DS{{"Core", "is_new_3ds"}, false};
+const ConfigInfo<bool> USE_PARALLEL_CORES{{"Core", "use_parallel_cores"}, false};
 const ConfigInfo<bool> USE_VIRTUAL_SD{{"Core", "use_virtual_sd"}, true};
 const ConfigInfo<int> SYSTEM_REGION{{"Core", "region_value"}, Settings::REGION_VALUE_AUTO_SELECT};
 const ConfigInfo<Service::CFG::SystemLanguage> SYSTEM_LANGUAGE{
@@ -21,11 +22,20 @@ const ConfigInfo<bool> USE_SHADER_JIT{{"Renderer", "use_shader_jit"}, false};
 const ConfigInfo<Settings::AccurateMul> SHADERS_ACCURATE_MUL{{"Renderer", "accurate_mul_type"},
                                                              Settings::AccurateMul::OFF};
 const ConfigInfo<u16> RESOLUTION_FACTOR{{"Renderer", "resolution_factor"}, 1};
+const ConfigInfo<u16> RESOLUTION_FACTOR_DEPTH{{"Renderer", "resolution_factor_depth"}, 0};
+const ConfigInfo<u16> RESOLUTION_FACTOR_OFFSCREEN{{"Renderer", "resolution_factor_offscreen"}, 0};
+const ConfigInfo<u16> RESOLUTION_FACTOR_READBACK{{"Renderer", "resolution_factor_readback"}, 0};
+const ConfigInfo<bool> USE_DYNAMIC_RESOLUTION{{"Renderer", "use_dynamic_resolution"}, false};
+const ConfigInfo<u16> DYNAMIC_RESOLUTION_MIN{{"Renderer", "dynamic_resolution_min"}, 1};
+const ConfigInfo<u16> DYNAMIC_RESOLUTION_MAX{{"Renderer", "dynamic_resolution_max"}, 3};
 const ConfigInfo<bool> USE_FRAME_LIMIT{{"Renderer", "use_frame_limit"}, true};
 const ConfigInfo<u16> FRAME_LIMIT{{"Renderer", "frame_limit"}, 100};
+const ConfigInfo<u16> FRAME_SKIP{{"Renderer", "frame_skip"}, 0};
+const ConfigInfo<bool> AUTO_FRAME_SKIP{{"Renderer", "auto_frame_skip"}, false};
 const ConfigInfo<u8> FACTOR_3D{{"Renderer", "factor_3d"}, 0};
 const ConfigInfo<bool> CUSTOM_TEXTURES{{"Renderer", "custom_textures"}, false};
 const ConfigInfo<bool> PRELOAD_TEXTURES{{"Renderer", "preload_textures"}, false};
+const ConfigInfo<u16> TEXTURE_MEMORY_BUDGET{{"Renderer", "texture_memory_budget"}, 1024};
 const ConfigInfo<Settings::LayoutOption> LAYOUT_OPTION{{"Renderer", "layout_option"},
                                                        Settings::LayoutOption::Default};
 const ConfigInfo<std::string> POST_PROCESSING_SHADER{{"Renderer", "pp_shader_name"}, ""};
@@ -34,6 +44,8 @@ const ConfigInfo<std::string> POST_PROCESSING_SHADER{{"Renderer", "pp_shader_nam
 const ConfigInfo<bool> ENABLE_DSP_LLE{{"Audio", "enable_dsp_lle"}, false};
 const ConfigInfo<bool> DSP_LLE_MULTITHREAD{{"Audio", "enable_dsp_lle_multithread"}, true};
 const ConfigInfo<bool> AUDIO_STRETCHING{{"Audio", "enable_audio_stretching"}, false};
+const ConfigInfo<u16> AUDIO_STRETCH_LATENCY{{"Audio", "audio_stretch_latency"}, 100};
+const ConfigInfo<bool> AUDIO_THREAD{{"Audio", "enable_audio_thread"}, false};
 const ConfigInfo<float> AUDIO_VOLUME{{"Audio", "volume"}, 1.0F};
 const ConfigInfo<std::string> AUDIO_ENGINE{{"Audio", "output_engine"}, "auto"};
 const ConfigInfo<std::string> AUDIO_DEVICE{{"Audio", "output_device"}, "auto"};
@@ -49,9 +61,23 @@ const ConfigInfo<std::string> CAMERA_DEVICE{{"Camera", "camera_type"}, "blank"};
 // debug
 const ConfigInfo<bool> ALLOW_SHADOW{{"Debug", "allow_shadow"}, false};
 const ConfigInfo<u8> SHADER_TYPE{{"Debug", "shader_type"}, 1};
+const ConfigInfo<bool> ASYNC_SHADER{{"Debug", "async_shader"}, false};
+const ConfigInfo<bool> GPU_TEXTURE_DECODE{{"Debug", "gpu_texture_decode"}, false};
+const ConfigInfo<bool> GENERATE_MIPMAPS{{"Debug", "generate_mipmaps"}, false};
+const ConfigInfo<bool> MERGE_DRAW_CALLS{{"Debug", "merge_draw_calls"}, false};
+const ConfigInfo<bool> SPECIALIZE_SHADER_UNIFORMS{{"Debug", "specialize_shader_uniforms"}, false};
+const ConfigInfo<bool> CACHE_VERTEX_ARRAYS{{"Debug", "cache_vertex_arrays"}, false};
+const ConfigInfo<bool> MULTITHREADED_SW_RASTERIZER{{"Debug", "multithreaded_sw_rasterizer"},
+                                                   false};
+const ConfigInfo<bool> USE_GPU_THREAD{{"Debug", "use_gpu_thread"}, false};
+const ConfigInfo<u16> VERTEX_CACHE_SIZE{{"Debug", "vertex_cache_size"}, 1024};
+const ConfigInfo<bool> USE_CODE_CACHE{{"Debug", "use_code_cache"}, false};
+const ConfigInfo<u16> REWIND_INTERVAL{{"Debug", "rewind_interval"}, 0};
+const ConfigInfo<u16> REWIND_BUDGET{{"Debug", "rewind_budget"}, 256};
 const ConfigInfo<bool> USE_PRESENT_THREAD{{"Debug", "use_present_thread"}, true};
 const ConfigInfo<bool> CPU_USAGE_LIMIT{{"Debug", "cpu_usage_limit"}, false};
 const ConfigInfo<std::string> LLE_MODULES{{"Debug", "lle_modules"}, ""};
+const ConfigInfo<std::string> LLE_FAST_PATHS{{"Debug", "lle_fast_paths"}, ""};
 const ConfigInfo<std::string> BAIDU_OCR_KEY{{"Debug", "baidu_ocr_key"}, ""};
 const ConfigInfo<std::string> BAIDU_OCR_SECRET{{"Debug", "baidu_ocr_secret"}, ""};
 
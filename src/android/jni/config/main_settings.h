@@ -16,6 +16,7 @@ namespace Config {
 // core
 extern const ConfigInfo<bool> USE_CPU_JIT;
 extern const ConfigInfo<bool> IS_NEW_3DS;
+extern const ConfigInfo<bool> USE_PARALLEL_CORES;
 extern const ConfigInfo<bool> USE_VIRTUAL_SD;
 extern const ConfigInfo<int> SYSTEM_REGION;
 extern const ConfigInfo<Service::CFG::SystemLanguage> SYSTEM_LANGUAGE;
@@ -28,11 +29,20 @@ extern const ConfigInfo<bool> USE_HW_SHADER;
 extern const ConfigInfo<bool> USE_SHADER_JIT;
 extern const ConfigInfo<Settings::AccurateMul> SHADERS_ACCURATE_MUL;
 extern const ConfigInfo<u16> RESOLUTION_FACTOR;
+extern const ConfigInfo<u16> RESOLUTION_FACTOR_DEPTH;
+extern const ConfigInfo<u16> RESOLUTION_FACTOR_OFFSCREEN;
+extern const ConfigInfo<u16> RESOLUTION_FACTOR_READBACK;
+extern const ConfigInfo<bool> USE_DYNAMIC_RESOLUTION;
+extern const ConfigInfo<u16> DYNAMIC_RESOLUTION_MIN;
+extern const ConfigInfo<u16> DYNAMIC_RESOLUTION_MAX;
 extern const ConfigInfo<bool> USE_FRAME_LIMIT;
 extern const ConfigInfo<u16> FRAME_LIMIT;
+extern const ConfigInfo<u16> FRAME_SKIP;
+extern const ConfigInfo<bool> AUTO_FRAME_SKIP;
 extern const ConfigInfo<u8> FACTOR_3D;
 extern const ConfigInfo<bool> CUSTOM_TEXTURES;
 extern const ConfigInfo<bool> PRELOAD_TEXTURES;
+extern const ConfigInfo<u16> TEXTURE_MEMORY_BUDGET;
 extern const ConfigInfo<Settings::LayoutOption> LAYOUT_OPTION;
 extern const ConfigInfo<std::string> POST_PROCESSING_SHADER;
 
@@ -40,6 +50,8 @@ extern const ConfigInfo<std::string> POST_PROCESSING_SHADER;
 extern const ConfigInfo<bool> ENABLE_DSP_LLE;
 extern const ConfigInfo<bool> DSP_LLE_MULTITHREAD;
 extern const ConfigInfo<bool> AUDIO_STRETCHING;
+extern const ConfigInfo<u16> AUDIO_STRETCH_LATENCY;
+extern const ConfigInfo<bool> AUDIO_THREAD;
 extern const ConfigInfo<float> AUDIO_VOLUME;
 extern const ConfigInfo<std::string> AUDIO_ENGINE;
 extern const ConfigInfo<std::string> AUDIO_DEVICE;
@@ -54,9 +66,22 @@ extern const ConfigInfo<std::string> CAMERA_DEVICE;
 // debug
 extern const ConfigInfo<bool> ALLOW_SHADOW;
 extern const ConfigInfo<u8> SHADER_TYPE;
+extern const ConfigInfo<bool> ASYNC_SHADER;
+extern const ConfigInfo<bool> GPU_TEXTURE_DECODE;
+extern const ConfigInfo<bool> GENERATE_MIPMAPS;
+extern const ConfigInfo<bool> MERGE_DRAW_CALLS;
+extern const ConfigInfo<bool> SPECIALIZE_SHADER_UNIFORMS;
+extern const ConfigInfo<bool> CACHE_VERTEX_ARRAYS;
+extern const ConfigInfo<bool> MULTITHREADED_SW_RASTERIZER;
+extern const ConfigInfo<bool> USE_GPU_THREAD;
+extern const ConfigInfo<u16> VERTEX_CACHE_SIZE;
+extern const ConfigInfo<bool> USE_CODE_CACHE;
+extern const ConfigInfo<u16> REWIND_INTERVAL;
+extern const ConfigInfo<u16> REWIND_BUDGET;
 extern const ConfigInfo<bool> USE_PRESENT_THREAD;
 extern const ConfigInfo<bool> CPU_USAGE_LIMIT;
 extern const ConfigInfo<std::string> LLE_MODULES;
+extern const ConfigInfo<std::string> LLE_FAST_PATHS;
 extern const ConfigInfo<std::string> BAIDU_OCR_KEY;
 extern const ConfigInfo<std::string> BAIDU_OCR_SECRET;
 
@@ -3,6 +3,7 @@
 #include <android/native_window_jni.h>
 #include <glad/glad.h>
 #include <array>
+#include <cstring>
 
 #include "jni_common.h"
 #include "video_core/renderer_base.h"
@@ -26,7 +27,7 @@ static constexpr std::array<EGLint, 15> egl_attribs{EGL_SURFACE_TYPE,
 static constexpr std::array<EGLint, 5> egl_empty_attribs{EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
 static constexpr std::array<EGLint, 4> egl_context_attribs{EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
 
-class SharedContext_Android {
+class SharedContext_Android : public Frontend::GraphicsContext {
 public:
     SharedContext_Android(EGLDisplay egl_display, EGLConfig egl_config,
                           EGLContext egl_share_context)
@@ -35,7 +36,7 @@ public:
           egl_context{eglCreateContext(egl_display, egl_config, egl_share_context,
                                        egl_context_attribs.data())} {}
 
-    ~SharedContext_Android() {
+    ~SharedContext_Android() override {
         if (!eglDestroySurface(egl_display, egl_surface)) {
             LOG_CRITICAL(Frontend, "eglDestroySurface() failed");
         }
@@ -45,11 +46,11 @@ public:
         }
     }
 
-    void MakeCurrent() {
+    void MakeCurrent() override {
         eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
     }
 
-    void DoneCurrent() {
+    void DoneCurrent() override {
         eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
 
@@ -90,16 +91,37 @@ bool EGLAndroid::Initialize(ANativeWindow* surface) {
         core_context =
             std::make_unique<SharedContext_Android>(egl_display, egl_config, egl_context);
     } else {
+        egl_pbuffer = eglCreatePbufferSurface(egl_display, egl_config, egl_empty_attribs.data());
         presenting_state = PresentingState::Stopped;
     }
 
+    // Lets the compositor show each frame at the time the renderer paced it for
+    const char* extensions = eglQueryString(egl_display, EGL_EXTENSIONS);
+    if (extensions && std::strstr(extensions, "EGL_ANDROID_presentation_time")) {
+        presentation_time = reinterpret_cast<PFNEGLPRESENTATIONTIMEANDROIDPROC>(
+            eglGetProcAddress("eglPresentationTimeANDROID"));
+    }
+
     CreateWindowSurface();
 
     return gladLoadGLES2Loader((GLADloadproc)eglGetProcAddress);
 }
 
+std::unique_ptr<Frontend::GraphicsContext> EGLAndroid::CreateSharedContext() const {
+    if (egl_context == EGL_NO_CONTEXT) {
+        return nullptr;
+    }
+    return std::make_unique<SharedContext_Android>(egl_display, egl_config, egl_context);
+}
+
 void EGLAndroid::UpdateSurface(ANativeWindow* surface) {
+    if (surface == host_window && !window_changed) {
+        // Only the size changed, which doesn't need another window surface
+        UpdateWindow();
+        return;
+    }
     new_window = surface;
+    window_changed = true;
     StopPresenting();
 }
 
@@ -119,6 +141,8 @@ void EGLAndroid::UpdateLayout() {
 
 void EGLAndroid::CreateWindowSurface() {
     if (!host_window) {
+        // The context stays alive, so that nothing has to be reloaded when the window returns
+        MakeCurrent();
         return;
     }
     EGLint format;
@@ -160,6 +184,10 @@ void EGLAndroid::DestroyContext() {
     if (eglGetCurrentContext() == egl_context) {
         eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
+    if (egl_pbuffer != EGL_NO_SURFACE) {
+        eglDestroySurface(egl_display, egl_pbuffer);
+        egl_pbuffer = EGL_NO_SURFACE;
+    }
     if (!eglDestroyContext(egl_display, egl_context)) {
         // Could not destroy drawing context
     }
@@ -186,6 +214,10 @@ void EGLAndroid::TryPresenting() {
         }
     }
     if (VideoCore::Renderer()->TryPresent()) {
+        if (presentation_time) {
+            presentation_time(egl_display, egl_surface,
+                              VideoCore::Renderer()->GetPresentTimeNs());
+        }
         eglSwapBuffers(egl_display, egl_surface);
     }
 }
@@ -198,20 +230,24 @@ void EGLAndroid::StopPresenting() {
 }
 
 void EGLAndroid::SwapBuffers() {
-    eglSwapBuffers(egl_display, egl_surface);
+    if (egl_surface != EGL_NO_SURFACE) {
+        eglSwapBuffers(egl_display, egl_surface);
+    }
 }
 
 void EGLAndroid::PollEvents() {
-    if (!new_window) {
+    if (!window_changed.exchange(false)) {
         return;
     }
 
+    // Only the window surface is replaced, the context with the shader and texture caches of the
+    // renderer stays
     host_window = new_window;
     new_window = nullptr;
     DestroyWindowSurface();
     CreateWindowSurface();
     VideoCore::Renderer()->ResetPresent();
-    if (use_shared_context) {
+    if (use_shared_context && host_window) {
         presenting_state = PresentingState::Initial;
     }
 }
@@ -220,7 +256,8 @@ void EGLAndroid::MakeCurrent() {
     if (use_shared_context) {
         core_context->MakeCurrent();
     } else {
-        eglMakeCurrent(egl_display, egl_surface, egl_surface, egl_context);
+        EGLSurface surface = egl_surface != EGL_NO_SURFACE ? egl_surface : egl_pbuffer;
+        eglMakeCurrent(egl_display, surface, surface, egl_context);
     }
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #include <EGL/egl.h>
@@ -16,6 +17,7 @@ public:
     ~EGLAndroid();
 
     bool Initialize(ANativeWindow* surface);
+    /// Swaps the window surface on the next PollEvents, the context and its caches are kept
     void UpdateSurface(ANativeWindow* surface);
     void UpdateWindow();
     void UpdateLayout();
@@ -24,6 +26,7 @@ public:
     void DoneCurrent() override;
     void PollEvents() override;
     void SwapBuffers() override;
+    std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
 
     void TryPresenting();
     void StopPresenting();
@@ -35,16 +38,22 @@ private:
 
     ANativeWindow* new_window = nullptr;
     ANativeWindow* host_window = nullptr;
+    /// Set when new_window is to replace host_window, which may be no window
+    std::atomic<bool> window_changed{false};
 
     EGLint window_width = 1;
     EGLint window_height = 1;
 
     EGLConfig egl_config = nullptr;
     EGLSurface egl_surface = EGL_NO_SURFACE;
+    /// Keeps the context current while there is no window, without a shared context
+    EGLSurface egl_pbuffer = EGL_NO_SURFACE;
     EGLContext egl_context = EGL_NO_CONTEXT;
     EGLDisplay egl_display = EGL_NO_DISPLAY;
 
     std::unique_ptr<SharedContext_Android> core_context;
+    /// eglPresentationTimeANDROID, if the driver has it
+    PFNEGLPRESENTATIONTIMEANDROIDPROC presentation_time = nullptr;
 
     enum class PresentingState {
         Initial,
@@ -99,6 +99,7 @@ public:
             if (button->GetButtonId() == button_id) {
                 button->SetStatus(value);
                 is_found = true;
+                Input::NotifyInputEvent();
             }
         }
         // If we don't find the button don't consume the button press event
@@ -178,6 +179,7 @@ public:
             if (button->GetButtonId() == button_id) {
                 button->SetStatus(x, y);
                 is_found = true;
+                Input::NotifyInputEvent();
             }
         }
         return is_found;
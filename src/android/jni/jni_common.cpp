@@ -5,6 +5,8 @@ std::atomic<bool> NativeLibrary::using_front_camera = false;
 
 static constexpr char* CLASS = "org/citra/emu/NativeLibrary";
 static NativeLibrary::ImageLoadedHandler s_image_loaded_callback;
+// Custom textures are decoded on several threads, each one waits for its own image
+static thread_local NativeLibrary::ImageLoadedHandler s_file_loaded_callback;
 
 // jni for cubeb
 JNIEnv* cubeb_get_jni_env_for_thread() {
@@ -50,7 +52,7 @@ void NativeLibrary::SaveImageToFile(const std::string& path, const std::vector<u
 
 void NativeLibrary::LoadImageFromFile(std::vector<u8>& pixels, u32& width, u32& height,
                                       const std::string& path) {
-    s_image_loaded_callback = [&pixels, &width, &height](u32* data32, u32 w, u32 h) -> void {
+    s_file_loaded_callback = [&pixels, &width, &height](u32* data32, u32 w, u32 h) -> void {
         u32 size = w * h * 4;
         u8* data8 = reinterpret_cast<u8*>(data32);
         pixels.clear();
@@ -119,6 +121,11 @@ void NativeLibrary::HandleNFCScanning(bool isScanning) {
 }
 
 void NativeLibrary::ImageLoadedCallback(u32* pixels, u32 width, u32 height) {
+    if (s_file_loaded_callback) {
+        s_file_loaded_callback(pixels, width, height);
+        s_file_loaded_callback = nullptr;
+        return;
+    }
     s_image_loaded_callback(pixels, width, height);
     s_image_loaded_callback = nullptr;
 }
@@ -9,6 +9,8 @@
 
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/profile_trace.h"
+#include "common/thread.h"
 #include "core/cheats/cheats.h"
 #include "core/core.h"
 #include "core/frontend/applets/default_applets.h"
@@ -114,6 +116,7 @@ void BootGame(const std::string& path) {
     s_update_hid = false;
     s_stop_running = false;
     s_is_running = true;
+    Common::SetCurrentThreadFrameCritical();
     while (!s_stop_running) {
         if (s_is_running) {
             result = system.RunLoop();
@@ -137,7 +140,8 @@ void BootGame(const std::string& path) {
 
             std::unique_lock lock{s_running_mutex};
             s_running_cv.wait(lock, [] { return s_is_running || s_stop_running; });
-            s_render_window->PollEvents();
+            // A new surface is made current on the thread that owns the render context
+            VideoCore::RunOnGPUThread([] { s_render_window->PollEvents(); });
             Settings::values.volume = volume;
         }
     }
@@ -271,7 +275,12 @@ JNIEXPORT jboolean JNICALL Java_org_citra_emu_NativeLibrary_IsRunning(JNIEnv* en
 
 JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_SurfaceChanged(JNIEnv* env, jclass obj,
                                                                        jobject surf) {
-    s_surface = ANativeWindow_fromSurface(env, surf);
+    ANativeWindow* surface = ANativeWindow_fromSurface(env, surf);
+    if (surface == s_surface) {
+        // A resize of the same window, which already holds a reference
+        ANativeWindow_release(surface);
+    }
+    s_surface = surface;
     if (s_render_window) {
         s_render_window->UpdateSurface(s_surface);
     }
@@ -297,6 +306,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_DoFrame(JNIEnv* env, jcl
     if (!s_is_running || s_stop_running) {
         return;
     }
+    Common::SetCurrentThreadFrameCritical();
     s_render_window->TryPresenting();
 }
 
@@ -374,6 +384,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     // system
     Settings::values.use_cpu_jit = Config::Get(Config::USE_CPU_JIT);
     Settings::values.is_new_3ds = Config::Get(Config::IS_NEW_3DS);
+    Settings::values.use_parallel_cores = Config::Get(Config::USE_PARALLEL_CORES);
     Settings::values.use_virtual_sd = Config::Get(Config::USE_VIRTUAL_SD);
     Settings::values.region_value = Config::Get(Config::SYSTEM_REGION);
     // renderer
@@ -385,10 +396,19 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.shaders_accurate_mul = Config::Get(Config::SHADERS_ACCURATE_MUL);
     Settings::values.use_frame_limit = Config::Get(Config::USE_FRAME_LIMIT);
     Settings::values.frame_limit = Config::Get(Config::FRAME_LIMIT);
+    Settings::values.frame_skip = Config::Get(Config::FRAME_SKIP);
+    Settings::values.auto_frame_skip = Config::Get(Config::AUTO_FRAME_SKIP);
     Settings::values.resolution_factor = Config::Get(Config::RESOLUTION_FACTOR);
+    Settings::values.resolution_factor_depth = Config::Get(Config::RESOLUTION_FACTOR_DEPTH);
+    Settings::values.resolution_factor_offscreen = Config::Get(Config::RESOLUTION_FACTOR_OFFSCREEN);
+    Settings::values.resolution_factor_readback = Config::Get(Config::RESOLUTION_FACTOR_READBACK);
+    Settings::values.use_dynamic_resolution = Config::Get(Config::USE_DYNAMIC_RESOLUTION);
+    Settings::values.dynamic_resolution_min = Config::Get(Config::DYNAMIC_RESOLUTION_MIN);
+    Settings::values.dynamic_resolution_max = Config::Get(Config::DYNAMIC_RESOLUTION_MAX);
     Settings::values.factor_3d = Config::Get(Config::FACTOR_3D);
     Settings::values.custom_textures = Config::Get(Config::CUSTOM_TEXTURES);
     Settings::values.preload_textures = Config::Get(Config::PRELOAD_TEXTURES);
+    Settings::values.texture_memory_budget = Config::Get(Config::TEXTURE_MEMORY_BUDGET);
     Settings::values.layout_option = Config::Get(Config::LAYOUT_OPTION);
     Settings::values.pp_shader_name = Config::Get(Config::POST_PROCESSING_SHADER);
     // audio
@@ -398,6 +418,8 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.sink_id = Config::Get(Config::AUDIO_ENGINE);
     Settings::values.audio_device_id = Config::Get(Config::AUDIO_DEVICE);
     Settings::values.enable_audio_stretching = Config::Get(Config::AUDIO_STRETCHING);
+    Settings::values.audio_stretch_latency = Config::Get(Config::AUDIO_STRETCH_LATENCY);
+    Settings::values.enable_audio_thread = Config::Get(Config::AUDIO_THREAD);
     // mic
     Settings::values.mic_input_type = Config::Get(Config::MIC_INPUT_TYPE);
     Settings::values.mic_input_device = Config::Get(Config::MIC_INPUT_DEVICE);
@@ -412,11 +434,27 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     } else if (shaderType == 1) {
         Settings::values.use_separable_shader = false;
         Settings::values.use_shader_cache = true;
-    } else {
+    } else if (shaderType == 2) {
         Settings::values.use_separable_shader = true;
         Settings::values.use_shader_cache = false;
+    } else {
+        Settings::values.use_separable_shader = true;
+        Settings::values.use_shader_cache = true;
     }
+    Settings::values.use_async_shader = Config::Get(Config::ASYNC_SHADER);
+    Settings::values.use_gpu_texture_decode = Config::Get(Config::GPU_TEXTURE_DECODE);
+    Settings::values.generate_mipmaps = Config::Get(Config::GENERATE_MIPMAPS);
+    Settings::values.merge_draw_calls = Config::Get(Config::MERGE_DRAW_CALLS);
+    Settings::values.specialize_shader_uniforms = Config::Get(Config::SPECIALIZE_SHADER_UNIFORMS);
+    Settings::values.cache_vertex_arrays = Config::Get(Config::CACHE_VERTEX_ARRAYS);
+    Settings::values.multithreaded_sw_rasterizer = Config::Get(Config::MULTITHREADED_SW_RASTERIZER);
+    Settings::values.use_gpu_thread = Config::Get(Config::USE_GPU_THREAD);
+    Settings::values.vertex_cache_size = Config::Get(Config::VERTEX_CACHE_SIZE);
+    Settings::values.use_code_cache = Config::Get(Config::USE_CODE_CACHE);
+    Settings::values.rewind_interval = Config::Get(Config::REWIND_INTERVAL);
+    Settings::values.rewind_budget = Config::Get(Config::REWIND_BUDGET);
     Settings::SetLLEModules(Config::Get(Config::LLE_MODULES));
+    Settings::SetLLEFastPaths(Config::Get(Config::LLE_FAST_PATHS));
     // custom layout
     Settings::values.custom_layout = Config::Get(Config::USE_CUSTOM_LAYOUT);
     UpdateDisplayRotation();
@@ -425,8 +463,10 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     Settings::values.init_time = 946681277;
     Settings::values.core_ticks_hack = 0;
     Settings::values.skip_slow_draw = false;
+    Settings::values.use_huge_pages = false;
+    Settings::values.skip_unchanged_input_events = false;
     Settings::values.display_transfer_hack = false;
-    Settings::values.skip_cpu_write = false;
+    Settings::values.trust_cache_maintenance = false;
     Settings::values.disable_clip_coef = false;
     Settings::values.y2r_perform_hack = false;
     Settings::values.y2r_event_delay = false;
@@ -458,6 +498,7 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_Run(JNIEnv* env, jclass
     BootGame(JniHelper::Unwrap(jFile));
 
     // shotdown
+    Common::ProfileTrace::Stop();
     InputManager::GetInstance().Shutdown();
     NativeLibrary::Shutdown(env);
 }
@@ -486,7 +527,7 @@ JNIEXPORT jintArray JNICALL Java_org_citra_emu_NativeLibrary_getRunningSettings(
     // get settings
     settings[i++] = Settings::values.core_ticks_hack > 0;
     settings[i++] = Settings::values.skip_slow_draw;
-    settings[i++] = Settings::values.skip_cpu_write;
+    settings[i++] = Settings::values.trust_cache_maintenance;
     settings[i++] = Settings::values.use_linear_filter;
     settings[i++] = std::min(std::max(Settings::values.resolution_factor - 1, 0), 3);
     settings[i++] = static_cast<int>(Settings::values.layout_option);
@@ -510,8 +551,8 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_setRunningSettings(JNIEn
     // Skip Slow Draw
     Settings::values.skip_slow_draw = settings[i++] > 0;
 
-    // Skip CPU Write
-    Settings::values.skip_cpu_write = settings[i++] > 0;
+    // Skip CPU Write, relying on the cache maintenance of the game
+    Settings::values.trust_cache_maintenance = settings[i++] > 0;
 
     // Use Linear Filter
     Settings::values.use_linear_filter = settings[i++] > 0;
@@ -732,6 +773,11 @@ JNIEXPORT void JNICALL Java_org_citra_emu_NativeLibrary_ResetCamera(JNIEnv* env,
     Settings::Apply();
 }
 
+JNIEXPORT jboolean JNICALL Java_org_citra_emu_NativeLibrary_ToggleProfileTrace(JNIEnv* env,
+                                                                              jclass obj) {
+    return Common::ProfileTrace::Toggle();
+}
+
 JNIEXPORT jstring JNICALL Java_org_citra_emu_NativeLibrary_GetAppId(JNIEnv* env, jclass obj,
                                                                     jstring jPath) {
     Loader::AppLoader* app_loader = GetAppLoader(JniHelper::Unwrap(jPath));
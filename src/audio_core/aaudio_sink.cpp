@@ -0,0 +1,229 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <dlfcn.h>
+#include <aaudio/AAudio.h>
+#include "audio_core/aaudio_sink.h"
+#include "audio_core/audio_types.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// The AAudio entry points, the NDK only declares them when building for Android 8.0 and up
+struct AAudioLibrary {
+    aaudio_result_t (*createStreamBuilder)(AAudioStreamBuilder**);
+    const char* (*convertResultToText)(aaudio_result_t);
+    void (*setDirection)(AAudioStreamBuilder*, aaudio_direction_t);
+    void (*setSampleRate)(AAudioStreamBuilder*, int32_t);
+    void (*setChannelCount)(AAudioStreamBuilder*, int32_t);
+    void (*setFormat)(AAudioStreamBuilder*, aaudio_format_t);
+    void (*setSharingMode)(AAudioStreamBuilder*, aaudio_sharing_mode_t);
+    void (*setPerformanceMode)(AAudioStreamBuilder*, aaudio_performance_mode_t);
+    void (*setDataCallback)(AAudioStreamBuilder*, AAudioStream_dataCallback, void*);
+    void (*setErrorCallback)(AAudioStreamBuilder*, AAudioStream_errorCallback, void*);
+    aaudio_result_t (*openStream)(AAudioStreamBuilder*, AAudioStream**);
+    aaudio_result_t (*deleteBuilder)(AAudioStreamBuilder*);
+    aaudio_result_t (*close)(AAudioStream*);
+    aaudio_result_t (*requestStart)(AAudioStream*);
+    aaudio_result_t (*requestStop)(AAudioStream*);
+    int32_t (*getFramesPerBurst)(AAudioStream*);
+    aaudio_result_t (*setBufferSizeInFrames)(AAudioStream*, int32_t);
+    int32_t (*getSampleRate)(AAudioStream*);
+};
+
+template <typename T>
+bool LoadSymbol(void* handle, T*& function, const char* name) {
+    function = reinterpret_cast<T*>(dlsym(handle, name));
+    if (!function) {
+        LOG_ERROR(Audio_Sink, "Could not find {} in libaaudio.so", name);
+    }
+    return function != nullptr;
+}
+
+std::unique_ptr<AAudioLibrary> LoadAAudio() {
+    // The library stays loaded for the lifetime of the process
+    void* handle = dlopen("libaaudio.so", RTLD_NOW);
+    if (!handle) {
+        LOG_INFO(Audio_Sink, "AAudio is not available");
+        return nullptr;
+    }
+
+    auto lib = std::make_unique<AAudioLibrary>();
+    const bool loaded =
+        LoadSymbol(handle, lib->createStreamBuilder, "AAudio_createStreamBuilder") &&
+        LoadSymbol(handle, lib->convertResultToText, "AAudio_convertResultToText") &&
+        LoadSymbol(handle, lib->setDirection, "AAudioStreamBuilder_setDirection") &&
+        LoadSymbol(handle, lib->setSampleRate, "AAudioStreamBuilder_setSampleRate") &&
+        LoadSymbol(handle, lib->setChannelCount, "AAudioStreamBuilder_setChannelCount") &&
+        LoadSymbol(handle, lib->setFormat, "AAudioStreamBuilder_setFormat") &&
+        LoadSymbol(handle, lib->setSharingMode, "AAudioStreamBuilder_setSharingMode") &&
+        LoadSymbol(handle, lib->setPerformanceMode, "AAudioStreamBuilder_setPerformanceMode") &&
+        LoadSymbol(handle, lib->setDataCallback, "AAudioStreamBuilder_setDataCallback") &&
+        LoadSymbol(handle, lib->setErrorCallback, "AAudioStreamBuilder_setErrorCallback") &&
+        LoadSymbol(handle, lib->openStream, "AAudioStreamBuilder_openStream") &&
+        LoadSymbol(handle, lib->deleteBuilder, "AAudioStreamBuilder_delete") &&
+        LoadSymbol(handle, lib->close, "AAudioStream_close") &&
+        LoadSymbol(handle, lib->requestStart, "AAudioStream_requestStart") &&
+        LoadSymbol(handle, lib->requestStop, "AAudioStream_requestStop") &&
+        LoadSymbol(handle, lib->getFramesPerBurst, "AAudioStream_getFramesPerBurst") &&
+        LoadSymbol(handle, lib->setBufferSizeInFrames, "AAudioStream_setBufferSizeInFrames") &&
+        LoadSymbol(handle, lib->getSampleRate, "AAudioStream_getSampleRate");
+    if (!loaded) {
+        return nullptr;
+    }
+    return lib;
+}
+
+const AAudioLibrary* GetAAudio() {
+    static const std::unique_ptr<AAudioLibrary> library = LoadAAudio();
+    return library.get();
+}
+
+} // Anonymous namespace
+
+struct AAudioSink::Impl {
+    unsigned int sample_rate = native_sample_rate;
+    std::size_t burst_frames = 0;
+
+    std::mutex stream_mutex;
+    AAudioStream* stream = nullptr;
+    /// Reopens the stream after the device is disconnected, which can't be done in its callbacks
+    std::future<void> restart;
+
+    std::function<void(s16*, std::size_t)> cb;
+
+    bool Open();
+    void Close();
+
+    static aaudio_data_callback_result_t DataCallback(AAudioStream* stream, void* user_data,
+                                                      void* audio_data, int32_t num_frames);
+    static void ErrorCallback(AAudioStream* stream, void* user_data, aaudio_result_t error);
+};
+
+bool AAudioSink::Impl::Open() {
+    const AAudioLibrary& lib = *GetAAudio();
+
+    AAudioStreamBuilder* builder = nullptr;
+    aaudio_result_t result = lib.createStreamBuilder(&builder);
+    if (result != AAUDIO_OK) {
+        LOG_CRITICAL(Audio_Sink, "Error creating AAudio stream builder: {}",
+                     lib.convertResultToText(result));
+        return false;
+    }
+
+    // The DSP output is not resampled, so the stream runs at its rate. Exclusive mode falls back
+    // to shared mode by itself when the device can't be taken.
+    lib.setDirection(builder, AAUDIO_DIRECTION_OUTPUT);
+    lib.setSampleRate(builder, native_sample_rate);
+    lib.setChannelCount(builder, 2);
+    lib.setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+    lib.setSharingMode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+    lib.setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    lib.setDataCallback(builder, &DataCallback, this);
+    lib.setErrorCallback(builder, &ErrorCallback, this);
+
+    result = lib.openStream(builder, &stream);
+    lib.deleteBuilder(builder);
+    if (result != AAUDIO_OK) {
+        LOG_CRITICAL(Audio_Sink, "Error opening AAudio stream: {}",
+                     lib.convertResultToText(result));
+        stream = nullptr;
+        return false;
+    }
+
+    // Two bursts are the least that plays without glitches
+    const int32_t burst = lib.getFramesPerBurst(stream);
+    const int32_t buffer_size = lib.setBufferSizeInFrames(stream, 2 * burst);
+    burst_frames = static_cast<std::size_t>(burst);
+    sample_rate = static_cast<unsigned int>(lib.getSampleRate(stream));
+    LOG_INFO(Audio_Sink, "AAudio stream opened with bursts of {} frames, buffer of {} frames",
+             burst, buffer_size);
+
+    result = lib.requestStart(stream);
+    if (result != AAUDIO_OK) {
+        LOG_CRITICAL(Audio_Sink, "Error starting AAudio stream: {}",
+                     lib.convertResultToText(result));
+        return false;
+    }
+    return true;
+}
+
+void AAudioSink::Impl::Close() {
+    if (!stream) {
+        return;
+    }
+    const AAudioLibrary& lib = *GetAAudio();
+    lib.requestStop(stream);
+    lib.close(stream);
+    stream = nullptr;
+}
+
+AAudioSink::AAudioSink(std::string_view) : impl(std::make_unique<Impl>()) {
+    if (!IsAAudioAvailable()) {
+        LOG_CRITICAL(Audio_Sink, "AAudio sink created without AAudio");
+        return;
+    }
+    std::lock_guard lock{impl->stream_mutex};
+    impl->Open();
+}
+
+AAudioSink::~AAudioSink() {
+    if (impl->restart.valid()) {
+        impl->restart.wait();
+    }
+    std::lock_guard lock{impl->stream_mutex};
+    impl->Close();
+}
+
+unsigned int AAudioSink::GetNativeSampleRate() const {
+    return impl->sample_rate;
+}
+
+void AAudioSink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
+    impl->cb = cb;
+}
+
+std::size_t AAudioSink::GetCallbackFrames() const {
+    return impl->burst_frames;
+}
+
+aaudio_data_callback_result_t AAudioSink::Impl::DataCallback(AAudioStream* stream,
+                                                             void* user_data, void* audio_data,
+                                                             int32_t num_frames) {
+    Impl* impl = static_cast<Impl*>(user_data);
+    if (!impl || !impl->cb) {
+        std::memset(audio_data, 0, num_frames * 2 * sizeof(s16));
+        return AAUDIO_CALLBACK_RESULT_CONTINUE;
+    }
+
+    impl->cb(static_cast<s16*>(audio_data), static_cast<std::size_t>(num_frames));
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void AAudioSink::Impl::ErrorCallback(AAudioStream* stream, void* user_data,
+                                     aaudio_result_t error) {
+    Impl* impl = static_cast<Impl*>(user_data);
+    LOG_WARNING(Audio_Sink, "AAudio stream error: {}", GetAAudio()->convertResultToText(error));
+    if (error != AAUDIO_ERROR_DISCONNECTED) {
+        return;
+    }
+
+    // Headphones plugged in or out, the stream has to be opened again on the new device
+    impl->restart = std::async(std::launch::async, [impl] {
+        std::lock_guard lock{impl->stream_mutex};
+        impl->Close();
+        impl->Open();
+    });
+}
+
+bool IsAAudioAvailable() {
+    return GetAAudio() != nullptr;
+}
+
+} // namespace AudioCore
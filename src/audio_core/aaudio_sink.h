@@ -0,0 +1,37 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Android sink running a low-latency AAudio stream, sized to the burst of the output device.
+ * AAudio is only there from Android 8.0, so it is loaded at runtime.
+ */
+class AAudioSink final : public Sink {
+public:
+    explicit AAudioSink(std::string_view device_id);
+    ~AAudioSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void SetCallback(std::function<void(s16*, std::size_t)> cb) override;
+
+    std::size_t GetCallbackFrames() const override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+/// Returns true if the system has AAudio, OpenSLESSink is used instead otherwise
+bool IsAAudioAvailable();
+
+} // namespace AudioCore
@@ -2,21 +2,24 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <utility>
 #include <vector>
 #include <cubeb/cubeb.h>
 #include "audio_core/cubeb_input.h"
 #include "common/logging/log.h"
+#include "common/ring_buffer.h"
 
 namespace AudioCore {
 
-using SampleQueue = Common::SPSCQueue<Frontend::Mic::Samples>;
+/// Bytes received from the input thread, about a second of 16-bit samples at the highest rate
+using SampleBuffer = Common::RingBuffer<u8, 0x10000>;
 
 struct CubebInput::Impl {
     cubeb* ctx = nullptr;
     cubeb_stream* stream = nullptr;
 
-    std::unique_ptr<SampleQueue> sample_queue{};
+    std::unique_ptr<SampleBuffer> sample_buffer{};
     u8 sample_size_in_bytes = 0;
 
     static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
@@ -30,7 +33,7 @@ CubebInput::CubebInput(std::string device_id)
         LOG_ERROR(Audio, "cubeb_init failed! Mic will not work properly");
         return;
     }
-    impl->sample_queue = std::make_unique<SampleQueue>();
+    impl->sample_buffer = std::make_unique<SampleBuffer>();
 }
 
 CubebInput::~CubebInput() {
@@ -57,6 +60,8 @@ void CubebInput::StartSampling(const Frontend::Mic::Parameters& params) {
     }
 
     impl->sample_size_in_bytes = params.sample_size / 8;
+    // The stream is stopped, drop what the previous sampling left
+    impl->sample_buffer->Discard(impl->sample_buffer->Size());
 
     parameters = params;
     is_sampling = true;
@@ -122,13 +127,8 @@ void CubebInput::AdjustSampleRate(u32 sample_rate) {
     LOG_ERROR(Audio, "AdjustSampleRate unimplemented!");
 }
 
-Frontend::Mic::Samples CubebInput::Read() {
-    Frontend::Mic::Samples samples{};
-    Frontend::Mic::Samples queue;
-    while (impl->sample_queue->Pop(queue)) {
-        samples.insert(samples.end(), queue.begin(), queue.end());
-    }
-    return samples;
+std::size_t CubebInput::Read(u8* buffer, std::size_t max_size) {
+    return impl->sample_buffer->Pop(buffer, max_size);
 }
 
 long CubebInput::Impl::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
@@ -142,21 +142,25 @@ long CubebInput::Impl::DataCallback(cubeb_stream* stream, void* user_data, const
         return static_cast<u8>(static_cast<u16>(sample) >> 8);
     };
 
-    std::vector<u8> samples{};
-    samples.reserve(num_frames * impl->sample_size_in_bytes);
+    // Samples that don't fit are dropped, when the application doesn't read them fast enough
+    const u8* data = static_cast<const u8*>(input_buffer);
     if (impl->sample_size_in_bytes == 1) {
         // If the sample format is 8bit, then resample back to 8bit before passing back to core
-        for (std::size_t i = 0; i < static_cast<std::size_t>(num_frames); i++) {
-            s16 data;
-            std::memcpy(&data, static_cast<const u8*>(input_buffer) + i * 2, 2);
-            samples.push_back(resample_s16_s8(data));
+        std::array<u8, 256> samples;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(num_frames); i += samples.size()) {
+            const std::size_t count =
+                std::min(samples.size(), static_cast<std::size_t>(num_frames) - i);
+            for (std::size_t j = 0; j < count; j++) {
+                s16 sample;
+                std::memcpy(&sample, data + (i + j) * 2, 2);
+                samples[j] = resample_s16_s8(sample);
+            }
+            impl->sample_buffer->Push(samples.data(), count);
         }
     } else {
         // Otherwise copy all of the samples to the buffer (which will be treated as s16 by core)
-        const u8* data = reinterpret_cast<const u8*>(input_buffer);
-        samples.insert(samples.begin(), data, data + num_frames * impl->sample_size_in_bytes);
+        impl->sample_buffer->Push(data, num_frames * impl->sample_size_in_bytes);
     }
-    impl->sample_queue->Push(samples);
 
     // returning less than num_frames here signals cubeb to stop sampling
     return num_frames;
@@ -2,18 +2,30 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
+#include "core/core.h"
 #include "core/settings.h"
 
 namespace AudioCore {
 
+/// The emulation thread outputs the audio of a whole video frame at once, the fifo has to hold
+/// two of them on top of what the sink buffers to ride out the frame pacing
+constexpr std::size_t FIFO_FRAME_SLACK = 2 * native_sample_rate / 60;
+
 DspInterface::DspInterface() = default;
 DspInterface::~DspInterface() = default;
 
+std::vector<u8> DspInterface::PipeRead(DspPipe pipe_number, u32 length) {
+    std::vector<u8> data(length);
+    data.resize(PipeRead(pipe_number, data.data(), length));
+    return data;
+}
+
 void DspInterface::SetSink(const std::string& sink_id, const std::string& audio_device_id) {
     if (current_sink_id == sink_id && current_audio_device_id == audio_device_id) {
         return;
@@ -21,6 +33,10 @@ void DspInterface::SetSink(const std::string& sink_id, const std::string& audio_
     current_sink_id = sink_id;
     current_audio_device_id = audio_device_id;
     sink = CreateSinkFromID(sink_id, audio_device_id);
+    const std::size_t callback_frames = sink->GetCallbackFrames();
+    fifo_target = callback_frames == 0 ? fifo.Capacity()
+                                       : std::min(2 * callback_frames + FIFO_FRAME_SLACK,
+                                                  fifo.Capacity());
     sink->SetCallback(
         [this](s16* buffer, std::size_t num_frames) { OutputCallback(buffer, num_frames); });
     time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
@@ -46,6 +62,7 @@ void DspInterface::OutputFrame(const StereoFrame16& frame) {
         return;
 
     fifo.Push(frame.data(), frame.size());
+    UpdateEmulationSpeed(frame.size());
 }
 
 void DspInterface::OutputSample(std::array<s16, 2> sample) {
@@ -53,11 +70,28 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
         return;
 
     fifo.Push(sample.data(), 1);
+    UpdateEmulationSpeed(1);
+}
+
+void DspInterface::UpdateEmulationSpeed(std::size_t num_frames) {
+    // Once per video frame is as often as the measure changes
+    speed_sample_frames += num_frames;
+    if (!perform_time_stretching || speed_sample_frames < native_sample_rate / 60) {
+        return;
+    }
+    speed_sample_frames = 0;
+
+    const double time_scale = Core::System::GetInstance().perf_stats->GetLastFrameTimeScale();
+    if (time_scale > 0.0) {
+        emulation_speed = 1.0 / time_scale;
+    }
 }
 
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     std::size_t frames_written;
     if (perform_time_stretching) {
+        time_stretcher.SetEmulationSpeed(emulation_speed);
+        time_stretcher.SetTargetLatency(Settings::values.audio_stretch_latency / 1000.0);
         const std::vector<s16> in{fifo.Pop()};
         const std::size_t num_in{in.size() / 2};
         frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
@@ -68,6 +102,10 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
         flushing_time_stretcher = false;
     } else {
         frames_written = fifo.Pop(buffer, num_frames);
+        // Running ahead of the sink piles up latency, drop the oldest frames instead
+        if (fifo.Size() > fifo_target) {
+            fifo.Discard(fifo.Size() - fifo_target);
+        }
     }
 
     if (frames_written > 0) {
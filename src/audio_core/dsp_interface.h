@@ -63,7 +63,14 @@ public:
      * @param length the number of bytes to read. The max is 65,535 (max of u16).
      * @returns a vector of bytes from the specified pipe. On error, will be empty.
      */
-    virtual std::vector<u8> PipeRead(DspPipe pipe_number, u32 length) = 0;
+    std::vector<u8> PipeRead(DspPipe pipe_number, u32 length);
+
+    /**
+     * Reads up to `length` bytes from the DSP pipe identified with `pipe_number` into `buffer`,
+     * e.g. straight into the static buffer of an IPC reply. Same limits as the vector overload.
+     * @returns the number of bytes read
+     */
+    virtual std::size_t PipeRead(DspPipe pipe_number, u8* buffer, std::size_t length) = 0;
 
     /**
      * How much data is left in pipe
@@ -78,7 +85,12 @@ public:
      * @param pipe_number The Pipe ID
      * @param buffer The data to write to the pipe.
      */
-    virtual void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) = 0;
+    void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
+        PipeWrite(pipe_number, buffer.data(), buffer.size());
+    }
+
+    /// Writes `size` bytes from `buffer` to a DSP pipe
+    virtual void PipeWrite(DspPipe pipe_number, const u8* buffer, std::size_t size) = 0;
 
     /// Returns a reference to the array backing DSP memory
     virtual std::array<u8, Memory::DSP_RAM_SIZE>& GetDspMemory() = 0;
@@ -106,11 +118,18 @@ protected:
 private:
     void FlushResidualStretcherAudio();
     void OutputCallback(s16* buffer, std::size_t num_frames);
+    /// Samples the emulation speed for the stretcher, on the emulation thread
+    void UpdateEmulationSpeed(std::size_t num_frames);
 
     std::unique_ptr<Sink> sink;
     std::atomic<bool> perform_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
+    std::atomic<double> emulation_speed = 1.0;
+    /// Frames output since the emulation speed was last sampled
+    std::size_t speed_sample_frames = 0;
     Common::RingBuffer<s16, 0x2000, 2> fifo;
+    /// Most frames left in the fifo after a callback, the whole fifo if the sink gives no size
+    std::size_t fifo_target = 0x2000;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
     std::string current_sink_id;
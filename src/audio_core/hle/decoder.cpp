@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "audio_core/hle/decoder.h"
+#include "common/thread.h"
 
 namespace AudioCore::HLE {
 
@@ -58,4 +59,70 @@ std::optional<BinaryResponse> NullDecoder::ProcessRequest(const BinaryRequest& r
         return {};
     }
 };
+
+AsyncDecoder::AsyncDecoder(Factory factory) {
+    thread = std::thread(&AsyncDecoder::ThreadLoop, this, std::move(factory));
+}
+
+AsyncDecoder::~AsyncDecoder() {
+    {
+        std::lock_guard lock{mutex};
+        stop_requested = true;
+    }
+    request_cv.notify_one();
+    thread.join();
+}
+
+void AsyncDecoder::Submit(const BinaryRequest& request) {
+    {
+        std::lock_guard lock{mutex};
+        requests.push_back(request);
+    }
+    request_cv.notify_one();
+}
+
+std::size_t AsyncDecoder::WaitForResponses() const {
+    std::unique_lock lock{mutex};
+    done_cv.wait(lock, [this] { return requests.empty() && !busy; });
+    return responses.size();
+}
+
+std::size_t AsyncDecoder::CollectResponses(std::vector<u8>& pipe) {
+    std::lock_guard lock{mutex};
+    const std::size_t count = responses.size();
+    for (const BinaryResponse& response : responses) {
+        const u8* bytes = reinterpret_cast<const u8*>(&response);
+        pipe.insert(pipe.end(), bytes, bytes + sizeof(response));
+    }
+    responses.clear();
+    return count;
+}
+
+void AsyncDecoder::ThreadLoop(Factory factory) {
+    Common::SetCurrentThreadName("DspDecoder");
+    // Media Foundation is bound to the thread that starts it
+    std::unique_ptr<DecoderBase> decoder = factory();
+
+    std::unique_lock lock{mutex};
+    while (true) {
+        request_cv.wait(lock, [this] { return stop_requested || !requests.empty(); });
+        if (stop_requested) {
+            break;
+        }
+        const BinaryRequest request = requests.front();
+        requests.pop_front();
+        busy = true;
+
+        lock.unlock();
+        const std::optional<BinaryResponse> response = decoder->ProcessRequest(request);
+        lock.lock();
+
+        busy = false;
+        if (response) {
+            responses.push_back(*response);
+        }
+        done_cv.notify_all();
+    }
+}
+
 } // namespace AudioCore::HLE
@@ -4,8 +4,13 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
@@ -87,4 +92,40 @@ public:
     }
 };
 
+/**
+ * Runs the requests of a decoder on a thread of its own, so that decoding long AAC streams doesn't
+ * stall the emulation thread. The decoder is created, used and destroyed on that thread.
+ */
+class AsyncDecoder {
+public:
+    using Factory = std::function<std::unique_ptr<DecoderBase>()>;
+
+    explicit AsyncDecoder(Factory factory);
+    ~AsyncDecoder();
+
+    /// Queues a request, decoding starts right away
+    void Submit(const BinaryRequest& request);
+
+    /// Waits for the queued requests, then returns the number of responses left to collect
+    std::size_t WaitForResponses() const;
+
+    /**
+     * Appends the responses of the finished requests to a pipe, in submission order
+     * @returns the number of responses appended
+     */
+    std::size_t CollectResponses(std::vector<u8>& pipe);
+
+private:
+    void ThreadLoop(Factory factory);
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable request_cv;
+    mutable std::condition_variable done_cv;
+    std::deque<BinaryRequest> requests;
+    std::deque<BinaryResponse> responses;
+    bool busy = false;
+    bool stop_requested = false;
+};
+
 } // namespace AudioCore::HLE
@@ -19,8 +19,6 @@ public:
 private:
     std::optional<BinaryResponse> Initalize(const BinaryRequest& request);
 
-    void Clear();
-
     std::optional<BinaryResponse> Decode(const BinaryRequest& request);
 
     struct AVPacketDeleter {
@@ -57,6 +55,9 @@ private:
     std::unique_ptr<AVCodecParserContext, AVCodecParserContextDeleter> parser;
     std::unique_ptr<AVPacket, AVPacketDeleter> av_packet;
     std::unique_ptr<AVFrame, AVFrameDeleter> decoded_frame;
+
+    /// Decoded samples of a request, the allocations are kept from one request to the next
+    std::array<std::vector<u8>, 2> out_streams;
 };
 
 FFMPEGDecoder::Impl::Impl(Memory::MemorySystem& memory) : memory(memory) {
@@ -91,15 +92,13 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::ProcessRequest(const BinaryRe
 }
 
 std::optional<BinaryResponse> FFMPEGDecoder::Impl::Initalize(const BinaryRequest& request) {
-    if (initalized) {
-        Clear();
-    }
-
     BinaryResponse response;
     std::memcpy(&response, &request, sizeof(response));
     response.unknown1 = 0x0;
 
-    if (!have_ffmpeg_dl) {
+    // Every stream starts with ADTS headers describing it, so the codec context opened for a
+    // previous one can carry on
+    if (initalized || !have_ffmpeg_dl) {
         return response;
     }
 
@@ -132,17 +131,6 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Initalize(const BinaryRequest
     return response;
 }
 
-void FFMPEGDecoder::Impl::Clear() {
-    if (!have_ffmpeg_dl) {
-        return;
-    }
-
-    av_context.reset();
-    parser.reset();
-    decoded_frame.reset();
-    av_packet.reset();
-}
-
 std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& request) {
     BinaryResponse response;
     response.codec = request.codec;
@@ -164,7 +152,9 @@ std::optional<BinaryResponse> FFMPEGDecoder::Impl::Decode(const BinaryRequest& r
     }
     u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
 
-    std::array<std::vector<u8>, 2> out_streams;
+    for (auto& stream : out_streams) {
+        stream.clear();
+    }
 
     std::size_t data_size = request.size;
     while (data_size > 0) {
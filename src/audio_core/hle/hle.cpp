@@ -10,6 +10,7 @@
 #elif ANDROID
 #include "audio_core/hle/mediandk_decoder.h"
 #endif
+#include <thread>
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/decoder.h"
 #include "audio_core/hle/hle.h"
@@ -21,8 +22,11 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/settings.h"
 
 using InterruptType = Service::DSP::DSP_DSP::InterruptType;
 using Service::DSP::DSP_DSP;
@@ -30,6 +34,8 @@ using Service::DSP::DSP_DSP;
 namespace AudioCore {
 
 static constexpr u64 audio_frame_ticks = 160 * 4096 * 2ull; ///< Units: ARM11 cycles
+/// Time the audio thread gets to generate a frame before its interrupt, Units: ARM11 cycles
+static constexpr u64 audio_thread_ticks = audio_frame_ticks / 2;
 
 struct DspHle::Impl final {
 public:
@@ -40,9 +46,9 @@ public:
 
     u16 RecvData(u32 register_number);
     bool RecvDataIsReady(u32 register_number) const;
-    std::vector<u8> PipeRead(DspPipe pipe_number, u32 length);
+    std::size_t PipeRead(DspPipe pipe_number, u8* buffer, std::size_t length);
     std::size_t GetPipeReadableSize(DspPipe pipe_number) const;
-    void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer);
+    void PipeWrite(DspPipe pipe_number, const u8* buffer, std::size_t size);
 
     std::array<u8, Memory::DSP_RAM_SIZE>& GetDspMemory();
 
@@ -57,10 +63,29 @@ private:
     HLE::SharedMemory& ReadRegion();
     HLE::SharedMemory& WriteRegion();
 
+    /// Copies of the shared memory parts the audio thread reads and writes for a frame
+    struct FrameJob {
+        HLE::SharedMemory* write_region = nullptr;
+        HLE::IntermediateMixSamples read_mix_samples;
+        HLE::IntermediateMixSamples write_mix_samples;
+        HLE::SourceStatus source_statuses;
+        HLE::DspStatus dsp_status;
+    };
+
+    void ConfigureFrame(HLE::SharedMemory& read);
+    void MixFrame(const HLE::IntermediateMixSamples& read_mix_samples,
+                  HLE::IntermediateMixSamples& write_mix_samples,
+                  HLE::SourceStatus& source_statuses, HLE::DspStatus& dsp_status);
+    const StereoFrame16& WriteFinalSamples(HLE::SharedMemory& write);
     const StereoFrame16& GenerateCurrentFrame();
     bool Tick();
+    void SignalFrameInterrupts();
     void AudioTickCallback(s64 cycles_late);
 
+    void StartFrameJob();
+    void FinishFrameJob();
+    void AudioThreadLoop();
+
     DspState dsp_state = DspState::Off;
     std::array<std::vector<u8>, num_dsp_pipe> pipe_data{};
 
@@ -77,7 +102,16 @@ private:
     DspHle& parent;
     Core::TimingEventType* tick_event{};
 
-    std::unique_ptr<HLE::DecoderBase> decoder;
+    /// Generates the frames away from the emulation thread when enabled
+    std::thread audio_thread;
+    Core::TimingEventType* frame_done_event{};
+    FrameJob frame_job;
+    Common::Event job_ready;
+    Common::Event job_done;
+    bool job_pending = false;
+    bool stop_requested = false;
+
+    std::unique_ptr<HLE::AsyncDecoder> decoder;
 
     std::weak_ptr<DSP_DSP> dsp_dsp;
 };
@@ -89,28 +123,33 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory) : parent(paren
         source.SetMemory(memory);
     }
 
+    decoder = std::make_unique<HLE::AsyncDecoder>([&memory] {
+        std::unique_ptr<HLE::DecoderBase> decoder;
 #if defined(HAVE_MF) && defined(HAVE_FFMPEG)
-    decoder = std::make_unique<HLE::WMFDecoder>(memory);
-    if (!decoder->IsValid()) {
-        LOG_WARNING(Audio_DSP, "Unable to load MediaFoundation. Attempting to load FFMPEG instead");
-        decoder = std::make_unique<HLE::FFMPEGDecoder>(memory);
-    }
+        decoder = std::make_unique<HLE::WMFDecoder>(memory);
+        if (!decoder->IsValid()) {
+            LOG_WARNING(Audio_DSP,
+                        "Unable to load MediaFoundation. Attempting to load FFMPEG instead");
+            decoder = std::make_unique<HLE::FFMPEGDecoder>(memory);
+        }
 #elif defined(HAVE_MF)
-    decoder = std::make_unique<HLE::WMFDecoder>(memory);
+        decoder = std::make_unique<HLE::WMFDecoder>(memory);
 #elif defined(HAVE_FFMPEG)
-    decoder = std::make_unique<HLE::FFMPEGDecoder>(memory);
+        decoder = std::make_unique<HLE::FFMPEGDecoder>(memory);
 #elif ANDROID
-    decoder = std::make_unique<HLE::MediaNDKDecoder>(memory);
+        decoder = std::make_unique<HLE::MediaNDKDecoder>(memory);
 #else
-    LOG_WARNING(Audio_DSP, "No decoder found, this could lead to missing audio");
-    decoder = std::make_unique<HLE::NullDecoder>();
+        LOG_WARNING(Audio_DSP, "No decoder found, this could lead to missing audio");
+        decoder = std::make_unique<HLE::NullDecoder>();
 #endif // HAVE_MF
 
-    if (!decoder->IsValid()) {
-        LOG_WARNING(Audio_DSP,
-                    "Unable to load any decoders, this could cause missing audio in some games");
-        decoder = std::make_unique<HLE::NullDecoder>();
-    }
+        if (!decoder->IsValid()) {
+            LOG_WARNING(Audio_DSP,
+                        "Unable to load any decoders, this could cause missing audio in some games");
+            decoder = std::make_unique<HLE::NullDecoder>();
+        }
+        return decoder;
+    });
 
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     tick_event =
@@ -118,11 +157,27 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory) : parent(paren
             this->AudioTickCallback(cycles_late);
         });
     timing.ScheduleEvent(audio_frame_ticks, tick_event);
+
+    if (Settings::values.enable_audio_thread) {
+        frame_done_event = timing.RegisterEvent("AudioCore::DspHle::frame_done_event",
+                                                [this](u64, s64) { FinishFrameJob(); });
+        audio_thread = std::thread(&DspHle::Impl::AudioThreadLoop, this);
+    }
 }
 
 DspHle::Impl::~Impl() {
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     timing.UnscheduleEvent(tick_event, 0);
+
+    if (audio_thread.joinable()) {
+        timing.UnscheduleEvent(frame_done_event, 0);
+        if (job_pending) {
+            job_done.Wait();
+        }
+        stop_requested = true;
+        job_ready.Set();
+        audio_thread.join();
+    }
 }
 
 DspState DspHle::Impl::GetDspState() const {
@@ -152,35 +207,39 @@ bool DspHle::Impl::RecvDataIsReady(u32 register_number) const {
     return true;
 }
 
-std::vector<u8> DspHle::Impl::PipeRead(DspPipe pipe_number, u32 length) {
+std::size_t DspHle::Impl::PipeRead(DspPipe pipe_number, u8* buffer, std::size_t length) {
     const std::size_t pipe_index = static_cast<std::size_t>(pipe_number);
 
     if (pipe_index >= num_dsp_pipe) {
         LOG_ERROR(Audio_DSP, "pipe_number = {} invalid", pipe_index);
-        return {};
+        return 0;
     }
 
     if (length > UINT16_MAX) { // Can only read at most UINT16_MAX from the pipe
         LOG_ERROR(Audio_DSP, "length of {} greater than max of {}", length, UINT16_MAX);
-        return {};
+        return 0;
     }
 
     std::vector<u8>& data = pipe_data[pipe_index];
+    if (pipe_number == DspPipe::Binary) {
+        decoder->WaitForResponses();
+        decoder->CollectResponses(data);
+    }
 
     if (length > data.size()) {
         LOG_WARNING(
             Audio_DSP,
             "pipe_number = {} is out of data, application requested read of {} but {} remain",
             pipe_index, length, data.size());
-        length = static_cast<u32>(data.size());
+        length = data.size();
     }
 
     if (length == 0)
-        return {};
+        return 0;
 
-    std::vector<u8> ret(data.begin(), data.begin() + length);
+    std::memcpy(buffer, data.data(), length);
     data.erase(data.begin(), data.begin() + length);
-    return ret;
+    return length;
 }
 
 size_t DspHle::Impl::GetPipeReadableSize(DspPipe pipe_number) const {
@@ -191,15 +250,19 @@ size_t DspHle::Impl::GetPipeReadableSize(DspPipe pipe_number) const {
         return 0;
     }
 
+    if (pipe_number == DspPipe::Binary) {
+        // Applications check for a response right after their request, so it has to be there
+        const std::size_t pending = decoder->WaitForResponses();
+        return pipe_data[pipe_index].size() + pending * sizeof(HLE::BinaryResponse);
+    }
     return pipe_data[pipe_index].size();
 }
 
-void DspHle::Impl::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
+void DspHle::Impl::PipeWrite(DspPipe pipe_number, const u8* buffer, std::size_t size) {
     switch (pipe_number) {
     case DspPipe::Audio: {
-        if (buffer.size() != 4) {
-            LOG_ERROR(Audio_DSP, "DspPipe::Audio: Unexpected buffer length {} was written",
-                      buffer.size());
+        if (size != 4) {
+            LOG_ERROR(Audio_DSP, "DspPipe::Audio: Unexpected buffer length {} was written", size);
             return;
         }
 
@@ -249,25 +312,20 @@ void DspHle::Impl::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer)
         return;
     }
     case DspPipe::Binary: {
-        // TODO(B3N30): Make this async, and signal the interrupt
         HLE::BinaryRequest request;
-        if (sizeof(request) != buffer.size()) {
-            LOG_CRITICAL(Audio_DSP, "got binary pipe with wrong size {}", buffer.size());
+        if (sizeof(request) != size) {
+            LOG_CRITICAL(Audio_DSP, "got binary pipe with wrong size {}", size);
             UNIMPLEMENTED();
             return;
         }
-        std::memcpy(&request, buffer.data(), buffer.size());
+        std::memcpy(&request, buffer, size);
         if (request.codec != HLE::DecoderCodec::AAC) {
             LOG_CRITICAL(Audio_DSP, "got unknown codec {}", static_cast<u16>(request.codec));
             UNIMPLEMENTED();
             return;
         }
-        std::optional<HLE::BinaryResponse> response = decoder->ProcessRequest(request);
-        if (response) {
-            const HLE::BinaryResponse& value = *response;
-            pipe_data[static_cast<u32>(pipe_number)].resize(sizeof(value));
-            std::memcpy(pipe_data[static_cast<u32>(pipe_number)].data(), &value, sizeof(value));
-        }
+        // The response is written to the pipe on a later tick, or when the application reads it
+        decoder->Submit(request);
         break;
     }
     default:
@@ -362,25 +420,35 @@ HLE::SharedMemory& DspHle::Impl::WriteRegion() {
     return CurrentRegionIndex() != 0 ? dsp_memory.region_0 : dsp_memory.region_1;
 }
 
-const StereoFrame16& DspHle::Impl::GenerateCurrentFrame() {
-    HLE::SharedMemory& read = ReadRegion();
-    HLE::SharedMemory& write = WriteRegion();
+void DspHle::Impl::ConfigureFrame(HLE::SharedMemory& read) {
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        sources[i].Configure(read.source_configurations.config[i],
+                             read.adpcm_coefficients.coeff[i]);
+    }
+    mixers.Configure(read.dsp_configuration);
+}
 
+MICROPROFILE_DEFINE(Audio_MixFrame, "Audio", "Mix Frame", MP_RGB(192, 192, 64));
+
+void DspHle::Impl::MixFrame(const HLE::IntermediateMixSamples& read_mix_samples,
+                            HLE::IntermediateMixSamples& write_mix_samples,
+                            HLE::SourceStatus& source_statuses, HLE::DspStatus& dsp_status) {
+    MICROPROFILE_SCOPE(Audio_MixFrame);
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
     // Generate intermediate mixes
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        source_statuses.status[i] = sources[i].Generate();
         for (std::size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
     }
 
     // Generate final mix
-    write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples,
-                                   write.intermediate_mix_samples, intermediate_mixes);
+    dsp_status = mixers.Generate(read_mix_samples, write_mix_samples, intermediate_mixes);
+}
 
+const StereoFrame16& DspHle::Impl::WriteFinalSamples(HLE::SharedMemory& write) {
     const StereoFrame16& output_frame = mixers.GetOutput();
 
     // Write current output frame to the shared memory region
@@ -393,6 +461,16 @@ const StereoFrame16& DspHle::Impl::GenerateCurrentFrame() {
     return output_frame;
 }
 
+const StereoFrame16& DspHle::Impl::GenerateCurrentFrame() {
+    HLE::SharedMemory& read = ReadRegion();
+    HLE::SharedMemory& write = WriteRegion();
+
+    ConfigureFrame(read);
+    MixFrame(read.intermediate_mix_samples, write.intermediate_mix_samples, write.source_statuses,
+             write.dsp_status);
+    return WriteFinalSamples(write);
+}
+
 bool DspHle::Impl::Tick() {
     // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing to
     // shared memory region)
@@ -400,21 +478,84 @@ bool DspHle::Impl::Tick() {
     return true;
 }
 
+void DspHle::Impl::SignalFrameInterrupts() {
+    // TODO(merry): Signal all the other interrupts as appropriate.
+    if (auto service = dsp_dsp.lock()) {
+        service->SignalInterrupt(InterruptType::Pipe, DspPipe::Audio);
+        // HACK(merry): Added to prevent regressions. Will remove soon.
+        service->SignalInterrupt(InterruptType::Pipe, DspPipe::Binary);
+    }
+}
+
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
-    if (Tick()) {
-        // TODO(merry): Signal all the other interrupts as appropriate.
+    Core::Timing& timing = Core::System::GetInstance().CoreTiming();
+
+    // Responses of the requests decoded since the last tick
+    if (decoder->CollectResponses(pipe_data[static_cast<u32>(DspPipe::Binary)]) != 0) {
         if (auto service = dsp_dsp.lock()) {
-            service->SignalInterrupt(InterruptType::Pipe, DspPipe::Audio);
-            // HACK(merry): Added to prevent regressions. Will remove soon.
             service->SignalInterrupt(InterruptType::Pipe, DspPipe::Binary);
         }
     }
 
+    if (audio_thread.joinable()) {
+        // The interrupt comes a fixed time after the frame starts, whatever the host speed
+        StartFrameJob();
+        timing.ScheduleEvent(audio_thread_ticks - cycles_late, frame_done_event);
+    } else if (Tick()) {
+        SignalFrameInterrupts();
+    }
+
     // Reschedule recurrent event
-    Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     timing.ScheduleEvent(audio_frame_ticks - cycles_late, tick_event);
 }
 
+void DspHle::Impl::StartFrameJob() {
+    if (job_pending) {
+        FinishFrameJob();
+    }
+
+    HLE::SharedMemory& read = ReadRegion();
+    HLE::SharedMemory& write = WriteRegion();
+
+    // The configuration is taken on the emulation thread, which owns the shared memory, and the
+    // audio thread only works on copies of it
+    ConfigureFrame(read);
+    frame_job.write_region = &write;
+    frame_job.read_mix_samples = read.intermediate_mix_samples;
+    frame_job.write_mix_samples = write.intermediate_mix_samples;
+
+    job_pending = true;
+    job_ready.Set();
+}
+
+void DspHle::Impl::FinishFrameJob() {
+    job_done.Wait();
+    job_pending = false;
+
+    HLE::SharedMemory& write = *frame_job.write_region;
+    write.intermediate_mix_samples = frame_job.write_mix_samples;
+    write.source_statuses = frame_job.source_statuses;
+    write.dsp_status = frame_job.dsp_status;
+    parent.OutputFrame(WriteFinalSamples(write));
+
+    SignalFrameInterrupts();
+}
+
+void DspHle::Impl::AudioThreadLoop() {
+    Common::SetCurrentThreadName("AudioThread");
+    Common::SetCurrentThreadFrameCritical();
+
+    while (true) {
+        job_ready.Wait();
+        if (stop_requested) {
+            break;
+        }
+        MixFrame(frame_job.read_mix_samples, frame_job.write_mix_samples,
+                 frame_job.source_statuses, frame_job.dsp_status);
+        job_done.Set();
+    }
+}
+
 DspHle::DspHle(Memory::MemorySystem& memory) : impl(std::make_unique<Impl>(*this, memory)) {}
 DspHle::~DspHle() = default;
 
@@ -430,16 +571,16 @@ void DspHle::SetSemaphore(u16 semaphore_value) {
     // Do nothing in HLE
 }
 
-std::vector<u8> DspHle::PipeRead(DspPipe pipe_number, u32 length) {
-    return impl->PipeRead(pipe_number, length);
+std::size_t DspHle::PipeRead(DspPipe pipe_number, u8* buffer, std::size_t length) {
+    return impl->PipeRead(pipe_number, buffer, length);
 }
 
 size_t DspHle::GetPipeReadableSize(DspPipe pipe_number) const {
     return impl->GetPipeReadableSize(pipe_number);
 }
 
-void DspHle::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
-    impl->PipeWrite(pipe_number, buffer);
+void DspHle::PipeWrite(DspPipe pipe_number, const u8* buffer, std::size_t size) {
+    impl->PipeWrite(pipe_number, buffer, size);
 }
 
 std::array<u8, Memory::DSP_RAM_SIZE>& DspHle::GetDspMemory() {
@@ -18,8 +18,17 @@ void Mixers::Reset() {
 DspStatus Mixers::Tick(DspConfiguration& config, const IntermediateMixSamples& read_samples,
                        IntermediateMixSamples& write_samples,
                        const std::array<QuadFrame32, 3>& input) {
+    Configure(config);
+    return Generate(read_samples, write_samples, input);
+}
+
+void Mixers::Configure(DspConfiguration& config) {
     ParseConfig(config);
+}
 
+DspStatus Mixers::Generate(const IntermediateMixSamples& read_samples,
+                           IntermediateMixSamples& write_samples,
+                           const std::array<QuadFrame32, 3>& input) {
     AuxReturn(read_samples);
     AuxSend(write_samples, input);
 
@@ -97,6 +106,11 @@ static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
 void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
     // TODO(merry): Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
 
+    // A muted intermediate mix would only add zeroes
+    if (gain == 0.0f) {
+        return;
+    }
+
     switch (state.output_format) {
     case OutputFormat::Mono:
         std::transform(
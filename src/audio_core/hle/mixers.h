@@ -21,6 +21,17 @@ public:
     DspStatus Tick(DspConfiguration& config, const IntermediateMixSamples& read_samples,
                    IntermediateMixSamples& write_samples, const std::array<QuadFrame32, 3>& input);
 
+    /**
+     * The first half of Tick: takes the new configuration, clearing its dirty flags. This has to
+     * run on the emulation thread, since it writes to the shared memory of the application.
+     */
+    void Configure(DspConfiguration& config);
+
+    /// The second half of Tick: mixes the frame with the current configuration
+    DspStatus Generate(const IntermediateMixSamples& read_samples,
+                       IntermediateMixSamples& write_samples,
+                       const std::array<QuadFrame32, 3>& input);
+
     const StereoFrame16& GetOutput() const {
         return current_frame;
     }
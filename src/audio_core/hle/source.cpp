@@ -10,14 +10,23 @@
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/simd.h"
 #include "core/memory.h"
 
 namespace AudioCore::HLE {
 
 SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
                                   const s16_le (&adpcm_coeffs)[16]) {
+    Configure(config, adpcm_coeffs);
+    return Generate();
+}
+
+void Source::Configure(SourceConfiguration::Configuration& config,
+                       const s16_le (&adpcm_coeffs)[16]) {
     ParseConfig(config, adpcm_coeffs);
+}
 
+SourceStatus::Status Source::Generate() {
     if (state.enabled) {
         GenerateFrame();
     }
@@ -29,14 +38,29 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
+    // Sources usually feed a single intermediate mix, the others would only get zeroes added
     const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
+    if (std::all_of(gains.begin(), gains.end(), [](float gain) { return gain == 0.0f; })) {
+        return;
+    }
+
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+#ifdef HAVE_COMMON_SIMD
+    using namespace Common::SIMD;
+    const VecF gain = LoadF(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const VecF samples = LoadS16PairTwice(current_frame[samplei].data());
+        s32* const out = dest[samplei].data();
+        StoreI32(out, AddI32(LoadI32(out), TruncateToI32(Mul(gain, samples))));
+    }
+#else
     for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
         dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
         dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
         dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
         dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
     }
+#endif
 }
 
 void Source::Reset() {
@@ -279,11 +303,9 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            // LOG_DEBUG(Audio_DSP, "Polyphase interpolation unimplemented; falling back to
-            // linear");
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            // The polyphase filter of the firmware is approximated by quadratic interpolation
+            AudioInterp::Quadratic(state.interp_state, state.current_buffer,
+                                   state.rate_multiplier, current_frame, frame_position);
             break;
         default:
             UNIMPLEMENTED();
@@ -52,6 +52,15 @@ public:
     SourceStatus::Status Tick(SourceConfiguration::Configuration& config,
                               const s16_le (&adpcm_coeffs)[16]);
 
+    /**
+     * The first half of Tick: takes the new configuration, clearing its dirty flags. This has to
+     * run on the emulation thread, since it writes to the shared memory of the application.
+     */
+    void Configure(SourceConfiguration::Configuration& config, const s16_le (&adpcm_coeffs)[16]);
+
+    /// The second half of Tick: generates the frame of the current configuration
+    SourceStatus::Status Generate();
+
     /**
      * Mix this source's output into dest, using the gains for the `intermediate_mix_id`-th
      * intermediate mixer.
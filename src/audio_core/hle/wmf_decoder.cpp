@@ -23,7 +23,7 @@ private:
 
     std::optional<BinaryResponse> Decode(const BinaryRequest& request);
 
-    MFOutputState DecodingLoop(ADTSData adts_header, std::array<std::vector<u8>, 2>& out_streams);
+    MFOutputState DecodingLoop(ADTSData adts_header);
 
     bool transform_initialized = false;
     bool format_selected = false;
@@ -36,6 +36,9 @@ private:
     bool is_valid = false;
     bool mf_started = false;
     bool coinited = false;
+
+    /// Decoded samples of a request, the allocations are kept from one request to the next
+    std::array<std::vector<u8>, 2> out_streams;
 };
 
 WMFDecoder::Impl::Impl(Memory::MemorySystem& memory) : memory(memory) {
@@ -136,8 +139,7 @@ std::optional<BinaryResponse> WMFDecoder::Impl::Initalize(const BinaryRequest& r
     return response;
 }
 
-MFOutputState WMFDecoder::Impl::DecodingLoop(ADTSData adts_header,
-                                             std::array<std::vector<u8>, 2>& out_streams) {
+MFOutputState WMFDecoder::Impl::DecodingLoop(ADTSData adts_header) {
     MFOutputState output_status = MFOutputState::OK;
     std::optional<std::vector<f32>> output_buffer;
     unique_mfptr<IMFSample> output;
@@ -208,7 +210,9 @@ std::optional<BinaryResponse> WMFDecoder::Impl::Decode(const BinaryRequest& requ
     }
     u8* data = memory.GetFCRAMPointer(request.src_addr - Memory::FCRAM_PADDR);
 
-    std::array<std::vector<u8>, 2> out_streams;
+    for (auto& stream : out_streams) {
+        stream.clear();
+    }
     unique_mfptr<IMFSample> sample;
     MFInputState input_status = MFInputState::OK;
     MFOutputState output_status = MFOutputState::OK;
@@ -240,7 +244,7 @@ std::optional<BinaryResponse> WMFDecoder::Impl::Decode(const BinaryRequest& requ
 
     while (true) {
         input_status = SendSample(transform.get(), in_stream_id, sample.get());
-        output_status = DecodingLoop(adts_meta->ADTSHeader, out_streams);
+        output_status = DecodingLoop(adts_meta->ADTSHeader);
 
         if (output_status == MFOutputState::FatalError) {
             // if the decode issues are caused by MFT not accepting new samples, try again
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
+#include "common/simd.h"
 
 namespace AudioCore::AudioInterp {
 
@@ -73,4 +74,82 @@ void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& outp
                     });
 }
 
+/// Evaluates the quadratics of a block of lanes, each lane being one channel of one output sample
+static void EvaluateQuadratics(const float* x0, const float* delta, const float* curvature,
+                               const float* t, std::size_t lanes, s16* out) {
+    std::size_t i = 0;
+#ifdef HAVE_COMMON_SIMD
+    using namespace Common::SIMD;
+    const VecF one = SetF(1.0f);
+    const VecF half = SetF(0.5f);
+    for (; i + 4 <= lanes; i += 4) {
+        const VecF vt = LoadF(t + i);
+        const VecF weight = Mul(Mul(vt, Sub(vt, one)), half);
+        const VecF value = Add(Add(LoadF(x0 + i), Mul(vt, LoadF(delta + i))),
+                               Mul(weight, LoadF(curvature + i)));
+        // Truncating and then saturating gives the clamp of the scalar tail
+        StoreS16(out + i, value);
+    }
+#endif
+    for (; i < lanes; ++i) {
+        const float value = x0[i] + t[i] * delta[i] + t[i] * (t[i] - 1) * 0.5f * curvature[i];
+        out[i] = static_cast<s16>(std::clamp(value, -32768.0f, 32767.0f));
+    }
+}
+
+void Quadratic(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    ASSERT(rate > 0);
+
+    if (input.empty())
+        return;
+
+    input.insert(input.begin(), {state.xn2, state.xn1});
+
+    // Lagrange form over x0, x1 and x2, evaluated between x0 and x1. The terms of the whole block
+    // are gathered first, in the same order as the interleaved channels of the output, so that the
+    // polynomials are evaluated two stereo samples at a time.
+    std::array<float, 2 * samples_per_frame> x0;
+    std::array<float, 2 * samples_per_frame> delta;
+    std::array<float, 2 * samples_per_frame> curvature;
+    std::array<float, 2 * samples_per_frame> t;
+
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+    std::size_t lanes = 0;
+
+    for (std::size_t i = outputi; i < output.size(); ++i) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+
+        if (inputi + 2 >= input.size()) {
+            inputi = input.size() - 2;
+            break;
+        }
+
+        const float fraction = static_cast<float>(fposition & scale_mask) / scale_factor;
+        const auto& s0 = input[inputi];
+        const auto& s1 = input[inputi + 1];
+        const auto& s2 = input[inputi + 2];
+        for (std::size_t channel = 0; channel < 2; ++channel, ++lanes) {
+            x0[lanes] = s0[channel];
+            delta[lanes] = static_cast<float>(s1[channel] - s0[channel]);
+            curvature[lanes] = static_cast<float>(s2[channel] - 2 * s1[channel] + s0[channel]);
+            t[lanes] = fraction;
+        }
+
+        fposition += step_size;
+    }
+
+    EvaluateQuadratics(x0.data(), delta.data(), curvature.data(), t.data(), lanes,
+                       reinterpret_cast<s16*>(output.data() + outputi));
+    outputi += lanes / 2;
+
+    state.xn2 = input[inputi];
+    state.xn1 = input[inputi + 1];
+    state.fposition = fposition - inputi * scale_factor;
+
+    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+}
+
 } // namespace AudioCore::AudioInterp
@@ -147,10 +147,20 @@ struct DspLle::Impl final {
 
     static constexpr u32 DspDataOffset = 0x40000;
     static constexpr u32 TeakraSlice = 20000;
+    /// Slices the DSP thread runs between two syncs with the emulation thread. Both threads stall
+    /// at each sync, so it is amortized over about a millisecond of DSP time.
+    static constexpr u32 TeakraThreadSlices = 8;
+
+    /// DSP cycles run between two slice events
+    u32 SliceCycles() const {
+        return multithread ? TeakraSlice * TeakraThreadSlices : TeakraSlice;
+    }
 
     void TeakraThread() {
+        Common::SetCurrentThreadName("TeakraThread");
+        Common::SetCurrentThreadFrameCritical();
         while (true) {
-            teakra.Run(TeakraSlice);
+            teakra.Run(TeakraSlice * TeakraThreadSlices);
             teakra_slice_barrier.Sync();
             if (stop_signal) {
                 if (stop_generation == teakra_slice_barrier.Generation())
@@ -179,7 +189,7 @@ struct DspLle::Impl final {
 
     void TeakraSliceEvent(u64 late) {
         RunTeakraSlice();
-        u64 next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
+        u64 next = SliceCycles() * 2; // DSP runs at clock rate half of the CPU rate
         if (next < late)
             next = 0;
         else
@@ -218,11 +228,9 @@ struct DspLle::Impl final {
         }
     }
 
-    void WritePipe(u8 pipe_index, const std::vector<u8>& data) {
+    void WritePipe(u8 pipe_index, const u8* buffer_ptr, u16 bsize) {
         PipeStatus pipe_status = GetPipeStatus(pipe_index, PipeDirection::CPUtoDSP);
         bool need_update = false;
-        const u8* buffer_ptr = data.data();
-        u16 bsize = static_cast<u16>(data.size());
         while (bsize != 0) {
             ASSERT_MSG(!pipe_status.IsFull(), "Pipe is Full");
             u16 write_bend;
@@ -256,11 +264,9 @@ struct DspLle::Impl final {
         }
     }
 
-    std::vector<u8> ReadPipe(u8 pipe_index, u16 bsize) {
+    void ReadPipe(u8 pipe_index, u8* buffer_ptr, u16 bsize) {
         PipeStatus pipe_status = GetPipeStatus(pipe_index, PipeDirection::DSPtoCPU);
         bool need_update = false;
-        std::vector<u8> data(bsize);
-        u8* buffer_ptr = data.data();
         while (bsize != 0) {
             ASSERT_MSG(!pipe_status.IsEmpty(), "Pipe is empty");
             u16 read_bend;
@@ -291,7 +297,6 @@ struct DspLle::Impl final {
                 RunTeakraSlice();
             teakra.SendData(2, pipe_status.slot_index);
         }
-        return data;
     }
     u16 GetPipeReadableSize(u8 pipe_index) const {
         PipeStatus pipe_status = GetPipeStatus(pipe_index, PipeDirection::DSPtoCPU);
@@ -325,7 +330,7 @@ struct DspLle::Impl final {
 
         // TODO: load special segment
 
-        Core::System::GetInstance().CoreTiming().ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
+        Core::System::GetInstance().CoreTiming().ScheduleEvent(SliceCycles(), teakra_slice_event, 0);
 
         if (multithread) {
             teakra_thread = std::thread(&Impl::TeakraThread, this);
@@ -390,16 +395,18 @@ void DspLle::SetSemaphore(u16 semaphore_value) {
     impl->teakra.SetSemaphore(semaphore_value);
 }
 
-std::vector<u8> DspLle::PipeRead(DspPipe pipe_number, u32 length) {
-    return impl->ReadPipe(static_cast<u8>(pipe_number), static_cast<u16>(length));
+std::size_t DspLle::PipeRead(DspPipe pipe_number, u8* buffer, std::size_t length) {
+    const u16 bsize = static_cast<u16>(length);
+    impl->ReadPipe(static_cast<u8>(pipe_number), buffer, bsize);
+    return bsize;
 }
 
 std::size_t DspLle::GetPipeReadableSize(DspPipe pipe_number) const {
     return impl->GetPipeReadableSize(static_cast<u8>(pipe_number));
 }
 
-void DspLle::PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) {
-    impl->WritePipe(static_cast<u8>(pipe_number), buffer);
+void DspLle::PipeWrite(DspPipe pipe_number, const u8* buffer, std::size_t size) {
+    impl->WritePipe(static_cast<u8>(pipe_number), buffer, static_cast<u16>(size));
 }
 
 std::array<u8, Memory::DSP_RAM_SIZE>& DspLle::GetDspMemory() {
@@ -450,7 +457,8 @@ void DspLle::SetServiceToInterrupt(std::weak_ptr<Service::DSP::DSP_DSP> dsp) {
                 return;
             if (pipe == 0) {
                 // pipe 0 is for debug. 3DS automatically drains this pipe and discards the data
-                impl->ReadPipe(pipe, impl->GetPipeReadableSize(pipe));
+                std::vector<u8> discarded(impl->GetPipeReadableSize(pipe));
+                impl->ReadPipe(pipe, discarded.data(), static_cast<u16>(discarded.size()));
             } else {
                 std::lock_guard lock(HLE::g_hle_lock);
                 if (auto locked = dsp.lock()) {
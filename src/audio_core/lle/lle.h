@@ -16,9 +16,11 @@ public:
     u16 RecvData(u32 register_number) override;
     bool RecvDataIsReady(u32 register_number) const override;
     void SetSemaphore(u16 semaphore_value) override;
-    std::vector<u8> PipeRead(DspPipe pipe_number, u32 length) override;
+    using DspInterface::PipeRead;
+    using DspInterface::PipeWrite;
+    std::size_t PipeRead(DspPipe pipe_number, u8* buffer, std::size_t length) override;
     std::size_t GetPipeReadableSize(DspPipe pipe_number) const override;
-    void PipeWrite(DspPipe pipe_number, const std::vector<u8>& buffer) override;
+    void PipeWrite(DspPipe pipe_number, const u8* buffer, std::size_t size) override;
 
     std::array<u8, Memory::DSP_RAM_SIZE>& GetDspMemory() override;
 
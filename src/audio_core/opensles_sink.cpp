@@ -0,0 +1,161 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <SLES/OpenSLES.h>
+#include <SLES/OpenSLES_Android.h>
+#include "audio_core/audio_types.h"
+#include "audio_core/opensles_sink.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+/// OpenSL ES has no way to query the burst of the device, this is about the mixer period
+constexpr std::size_t BUFFER_FRAMES = 512;
+/// Buffers enqueued at once, one plays while the other one is filled
+constexpr std::size_t BUFFER_COUNT = 2;
+
+struct OpenSLESSink::Impl {
+    SLObjectItf engine_object = nullptr;
+    SLEngineItf engine = nullptr;
+    SLObjectItf output_mix = nullptr;
+    SLObjectItf player_object = nullptr;
+    SLPlayItf player = nullptr;
+    SLAndroidSimpleBufferQueueItf buffer_queue = nullptr;
+
+    std::array<std::array<s16, 2 * BUFFER_FRAMES>, BUFFER_COUNT> buffers{};
+    std::size_t next_buffer = 0;
+
+    std::function<void(s16*, std::size_t)> cb;
+
+    bool Open();
+    void Close();
+
+    static void BufferCallback(SLAndroidSimpleBufferQueueItf buffer_queue, void* context);
+};
+
+bool OpenSLESSink::Impl::Open() {
+    if (slCreateEngine(&engine_object, 0, nullptr, 0, nullptr, nullptr) != SL_RESULT_SUCCESS ||
+        (*engine_object)->Realize(engine_object, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS ||
+        (*engine_object)->GetInterface(engine_object, SL_IID_ENGINE, &engine) !=
+            SL_RESULT_SUCCESS) {
+        LOG_CRITICAL(Audio_Sink, "Error creating OpenSL ES engine");
+        return false;
+    }
+
+    if ((*engine)->CreateOutputMix(engine, &output_mix, 0, nullptr, nullptr) !=
+            SL_RESULT_SUCCESS ||
+        (*output_mix)->Realize(output_mix, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS) {
+        LOG_CRITICAL(Audio_Sink, "Error creating OpenSL ES output mix");
+        return false;
+    }
+
+    SLDataLocator_AndroidSimpleBufferQueue queue_locator{SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE,
+                                                         BUFFER_COUNT};
+    SLDataFormat_PCM format{SL_DATAFORMAT_PCM,
+                            2,
+                            native_sample_rate * 1000, // In milliHertz
+                            SL_PCMSAMPLEFORMAT_FIXED_16,
+                            SL_PCMSAMPLEFORMAT_FIXED_16,
+                            SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT,
+                            SL_BYTEORDER_LITTLEENDIAN};
+    SLDataSource source{&queue_locator, &format};
+    SLDataLocator_OutputMix mix_locator{SL_DATALOCATOR_OUTPUTMIX, output_mix};
+    SLDataSink sink{&mix_locator, nullptr};
+
+    const std::array<SLInterfaceID, 2> interfaces{SL_IID_ANDROIDSIMPLEBUFFERQUEUE,
+                                                  SL_IID_ANDROIDCONFIGURATION};
+    const std::array<SLboolean, 2> required{SL_BOOLEAN_TRUE, SL_BOOLEAN_FALSE};
+    if ((*engine)->CreateAudioPlayer(engine, &player_object, &source, &sink,
+                                     static_cast<SLuint32>(interfaces.size()), interfaces.data(),
+                                     required.data()) != SL_RESULT_SUCCESS) {
+        LOG_CRITICAL(Audio_Sink, "Error creating OpenSL ES audio player");
+        return false;
+    }
+
+    // Asks for the fast mixer path, which is only honoured from Android 7.1
+    SLAndroidConfigurationItf config;
+    if ((*player_object)
+            ->GetInterface(player_object, SL_IID_ANDROIDCONFIGURATION, &config) ==
+        SL_RESULT_SUCCESS) {
+        SLuint32 performance_mode = SL_ANDROID_PERFORMANCE_LATENCY;
+        (*config)->SetConfiguration(config, SL_ANDROID_KEY_PERFORMANCE_MODE, &performance_mode,
+                                    sizeof(performance_mode));
+    }
+
+    if ((*player_object)->Realize(player_object, SL_BOOLEAN_FALSE) != SL_RESULT_SUCCESS ||
+        (*player_object)->GetInterface(player_object, SL_IID_PLAY, &player) !=
+            SL_RESULT_SUCCESS ||
+        (*player_object)
+                ->GetInterface(player_object, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &buffer_queue) !=
+            SL_RESULT_SUCCESS ||
+        (*buffer_queue)->RegisterCallback(buffer_queue, &BufferCallback, this) !=
+            SL_RESULT_SUCCESS) {
+        LOG_CRITICAL(Audio_Sink, "Error setting up OpenSL ES audio player");
+        return false;
+    }
+
+    // The queue starts out with silence, the callback refills the buffers as they play
+    for (auto& buffer : buffers) {
+        (*buffer_queue)->Enqueue(buffer_queue, buffer.data(), sizeof(buffer));
+    }
+    if ((*player)->SetPlayState(player, SL_PLAYSTATE_PLAYING) != SL_RESULT_SUCCESS) {
+        LOG_CRITICAL(Audio_Sink, "Error starting OpenSL ES audio player");
+        return false;
+    }
+    LOG_INFO(Audio_Sink, "OpenSL ES player started with buffers of {} frames", BUFFER_FRAMES);
+    return true;
+}
+
+void OpenSLESSink::Impl::Close() {
+    if (player) {
+        (*player)->SetPlayState(player, SL_PLAYSTATE_STOPPED);
+    }
+    if (player_object) {
+        (*player_object)->Destroy(player_object);
+    }
+    if (output_mix) {
+        (*output_mix)->Destroy(output_mix);
+    }
+    if (engine_object) {
+        (*engine_object)->Destroy(engine_object);
+    }
+}
+
+OpenSLESSink::OpenSLESSink(std::string_view) : impl(std::make_unique<Impl>()) {
+    impl->Open();
+}
+
+OpenSLESSink::~OpenSLESSink() {
+    impl->Close();
+}
+
+unsigned int OpenSLESSink::GetNativeSampleRate() const {
+    return native_sample_rate;
+}
+
+void OpenSLESSink::SetCallback(std::function<void(s16*, std::size_t)> cb) {
+    impl->cb = cb;
+}
+
+std::size_t OpenSLESSink::GetCallbackFrames() const {
+    return BUFFER_FRAMES;
+}
+
+void OpenSLESSink::Impl::BufferCallback(SLAndroidSimpleBufferQueueItf buffer_queue,
+                                        void* context) {
+    Impl* impl = static_cast<Impl*>(context);
+    auto& buffer = impl->buffers[impl->next_buffer];
+    impl->next_buffer = (impl->next_buffer + 1) % BUFFER_COUNT;
+
+    if (impl->cb) {
+        impl->cb(buffer.data(), BUFFER_FRAMES);
+    } else {
+        buffer.fill(0);
+    }
+    (*buffer_queue)->Enqueue(buffer_queue, buffer.data(), sizeof(buffer));
+}
+
+} // namespace AudioCore
@@ -0,0 +1,31 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/// Android sink feeding an OpenSL ES buffer queue, for the systems without AAudio
+class OpenSLESSink final : public Sink {
+public:
+    explicit OpenSLESSink(std::string_view device_id);
+    ~OpenSLESSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void SetCallback(std::function<void(s16*, std::size_t)> cb) override;
+
+    std::size_t GetCallbackFrames() const override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace AudioCore
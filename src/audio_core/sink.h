@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include "common/common_types.h"
 
@@ -30,6 +31,12 @@ public:
      * @param sample_count Number of samples.
      */
     virtual void SetCallback(std::function<void(s16*, std::size_t)> cb) = 0;
+
+    /// Number of frames the sink asks for in each callback, 0 if unknown. The frames buffered
+    /// ahead of the sink are kept to a few callbacks worth when the size is known.
+    virtual std::size_t GetCallbackFrames() const {
+        return 0;
+    }
 };
 
 } // namespace AudioCore
@@ -8,6 +8,10 @@
 #include <vector>
 #include "audio_core/null_sink.h"
 #include "audio_core/sink_details.h"
+#ifdef ANDROID
+#include "audio_core/aaudio_sink.h"
+#include "audio_core/opensles_sink.h"
+#endif
 #ifdef HAVE_SDL2
 #include "audio_core/sdl2_sink.h"
 #endif
@@ -32,6 +36,21 @@ struct SinkDetails {
 
 // sink_details is ordered in terms of desirability, with the best choice at the top.
 constexpr SinkDetails sink_details[] = {
+#ifdef ANDROID
+    SinkDetails{"aaudio",
+                [](std::string_view device_id) -> std::unique_ptr<Sink> {
+                    if (!IsAAudioAvailable()) {
+                        return std::make_unique<OpenSLESSink>(device_id);
+                    }
+                    return std::make_unique<AAudioSink>(device_id);
+                },
+                [] { return std::vector<std::string>{"auto"}; }},
+    SinkDetails{"opensles",
+                [](std::string_view device_id) -> std::unique_ptr<Sink> {
+                    return std::make_unique<OpenSLESSink>(device_id);
+                },
+                [] { return std::vector<std::string>{"auto"}; }},
+#endif
 #ifdef HAVE_CUBEB
     SinkDetails{"cubeb",
                 [](std::string_view device_id) -> std::unique_ptr<Sink> {
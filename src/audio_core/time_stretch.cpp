@@ -19,6 +19,12 @@ TimeStretcher::TimeStretcher()
     sound_touch->setSampleRate(native_sample_rate);
     sound_touch->setPitch(1.0);
     sound_touch->setTempo(1.0);
+    // Shorter processing sequences than the defaults keep the latency of the stretcher itself
+    // down to a few tens of milliseconds, at the cost of some quality
+    sound_touch->setSetting(SETTING_SEQUENCE_MS, 30);
+    sound_touch->setSetting(SETTING_SEEKWINDOW_MS, 15);
+    sound_touch->setSetting(SETTING_OVERLAP_MS, 8);
+    sound_touch->setSetting(SETTING_USE_QUICKSEEK, 1);
 }
 
 TimeStretcher::~TimeStretcher() {
@@ -30,39 +36,45 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
     sample_rate = native_sample_rate;
 }
 
+void TimeStretcher::SetEmulationSpeed(double speed) {
+    emulation_speed = speed;
+}
+
+void TimeStretcher::SetTargetLatency(double latency) {
+    // Below a couple of output callbacks the backlog can't be held without dropping input
+    target_latency = std::max(latency, 0.02);
+}
+
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
     const double time_delta = static_cast<double>(num_out) / sample_rate; // seconds
-    double current_ratio = static_cast<double>(num_in) / static_cast<double>(num_out);
-
-    const double max_latency = 0.25; // seconds
-    const double max_backlog = sample_rate * max_latency;
-    const double backlog_fullness = sound_touch->numSamples() / max_backlog;
-    if (backlog_fullness > 4.0) {
+    const double backlog = static_cast<double>(sound_touch->numSamples()) / sample_rate; // seconds
+    if (backlog > target_latency) {
         // Too many samples in backlog: Don't push anymore on
         num_in = 0;
     }
 
-    // We ideally want the backlog to be about 50% full.
-    // This gives some headroom both ways to prevent underflow and overflow.
-    // We tweak current_ratio to encourage this.
-    constexpr double tweak_time_scale = 0.1; // seconds
-    const double tweak_correction = (backlog_fullness - 0.5) * (time_delta / tweak_time_scale);
-    current_ratio *= std::pow(1.0 + 2.0 * tweak_correction, tweak_correction < 0 ? 3.0 : 1.0);
+    // At a given emulation speed the DSP makes that fraction of real time worth of samples, so
+    // the tempo follows the speed. We ideally want the backlog to be about half the target,
+    // which gives some headroom both ways, and tweak the tempo to drain or fill it towards that.
+    constexpr double tweak_gain = 0.5;
+    const double backlog_error = backlog / (target_latency / 2.0) - 1.0;
+    const double current_ratio = emulation_speed * (1.0 + tweak_gain * backlog_error);
 
-    // This low-pass filter smoothes out variance in the calculated stretch ratio.
+    // This low-pass filter smoothes out variance in the measured speed and the backlog.
     // The time-scale determines how responsive this filter is.
-    constexpr double lpf_time_scale = 0.712; // seconds
+    constexpr double lpf_time_scale = 0.25; // seconds
     const double lpf_gain = 1.0 - std::exp(-time_delta / lpf_time_scale);
     stretch_ratio += lpf_gain * (current_ratio - stretch_ratio);
 
     // Place a lower limit of 5% speed. When a game boots up, there will be
     // many silence samples. These do not need to be timestretched.
-    stretch_ratio = std::max(stretch_ratio, 0.05);
+    // The upper limit keeps a backlog left over from a stall from being drained too fast.
+    stretch_ratio = std::clamp(stretch_ratio, 0.05, 4.0);
     sound_touch->setTempo(stretch_ratio);
 
-    LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} backlog:{:0.6f}", num_in, num_out, stretch_ratio,
-              backlog_fullness);
+    LOG_TRACE(Audio, "{:5}/{:5} ratio:{:0.6f} speed:{:0.6f} backlog:{:0.6f}", num_in, num_out,
+              stretch_ratio, emulation_speed, backlog);
 
     sound_touch->putSamples(in, static_cast<u32>(num_in));
     return sound_touch->receiveSamples(out, static_cast<u32>(num_out));
@@ -22,6 +22,12 @@ public:
 
     void SetOutputSampleRate(unsigned int sample_rate);
 
+    /// Sets the measured emulation speed, 1.0 being full speed. The tempo follows it.
+    void SetEmulationSpeed(double speed);
+
+    /// Sets the latency the output backlog is kept under, in seconds
+    void SetTargetLatency(double latency);
+
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
     /// @param out      Output sample buffer
@@ -37,6 +43,8 @@ private:
     unsigned int sample_rate;
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
     double stretch_ratio = 1.0;
+    double emulation_speed = 1.0;
+    double target_latency = 0.1;
 };
 
 } // namespace AudioCore
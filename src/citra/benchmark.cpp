@@ -0,0 +1,101 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "citra/benchmark.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hw/gpu.h"
+#include "core/memory.h"
+
+namespace {
+
+const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / GPU::SCREEN_REFRESH_RATE);
+
+using Microseconds = std::chrono::duration<double, std::micro>;
+
+} // Anonymous namespace
+
+Benchmark::Benchmark(Core::System& system, std::string output_path)
+    : system(system), output_path(std::move(output_path)) {
+    frame_event = system.CoreTiming().RegisterEvent(
+        "Benchmark::FrameCallback",
+        [this](u64 userdata, s64 cycles_late) { FrameCallback(cycles_late); });
+    system.CoreTiming().ScheduleEvent(frame_ticks, frame_event);
+    start_time = previous_frame_time = Clock::now();
+}
+
+Benchmark::~Benchmark() {
+    system.CoreTiming().UnscheduleEvent(frame_event, 0);
+}
+
+void Benchmark::FrameCallback(s64 cycles_late) {
+    const auto now = Clock::now();
+    frame_times.push_back(now - previous_frame_time);
+    previous_frame_time = now;
+    system.CoreTiming().ScheduleEvent(frame_ticks - cycles_late, frame_event);
+}
+
+u64 Benchmark::HashFramebuffer(std::size_t screen) const {
+    const auto& framebuffer = GPU::g_regs.framebuffer_config[screen];
+    const PAddr address =
+        framebuffer.active_fb == 0 ? framebuffer.address_left1 : framebuffer.address_left2;
+    const u32 size = framebuffer.stride * framebuffer.height;
+
+    // The hardware renderer may not have written the frame back to the emulated memory yet
+    Memory::RasterizerFlushRegion(address, size);
+    const u8* data = system.Memory().GetPhysicalPointer(address);
+    return data ? Common::ComputeHash64(data, size) : 0;
+}
+
+void Benchmark::Finish() {
+    const double total_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start_time).count();
+
+    std::vector<Clock::duration> sorted_times = frame_times;
+    std::sort(sorted_times.begin(), sorted_times.end());
+    const auto percentile = [&sorted_times](std::size_t percent) {
+        if (sorted_times.empty()) {
+            return 0.0;
+        }
+        return Microseconds(sorted_times[(sorted_times.size() - 1) * percent / 100]).count();
+    };
+
+    std::string frame_list;
+    for (const auto& frame_time : frame_times) {
+        if (!frame_list.empty()) {
+            frame_list += ", ";
+        }
+        frame_list += fmt::format("{:.0f}", Microseconds(frame_time).count());
+    }
+
+    const std::string json = fmt::format(
+        "{{\n"
+        "  \"build\": \"{}-{}\",\n"
+        "  \"frames\": {},\n"
+        "  \"total_ms\": {:.3f},\n"
+        "  \"fps\": {:.3f},\n"
+        "  \"frame_time_us_50\": {:.0f},\n"
+        "  \"frame_time_us_95\": {:.0f},\n"
+        "  \"frame_time_us_99\": {:.0f},\n"
+        "  \"top_screen_hash\": \"{:016x}\",\n"
+        "  \"bottom_screen_hash\": \"{:016x}\",\n"
+        "  \"frame_times_us\": [{}]\n"
+        "}}\n",
+        Common::g_scm_branch, Common::g_scm_desc, frame_times.size(), total_ms,
+        total_ms > 0.0 ? frame_times.size() * 1000.0 / total_ms : 0.0, percentile(50),
+        percentile(95), percentile(99), HashFramebuffer(0), HashFramebuffer(1), frame_list);
+
+    FileUtil::IOFile file(output_path, "w");
+    if (!file.IsOpen() || file.WriteString(json) != json.size()) {
+        LOG_ERROR(Frontend, "Could not write the benchmark results to {}", output_path);
+        return;
+    }
+    LOG_INFO(Frontend, "Benchmark of {} frames written to {}", frame_times.size(), output_path);
+}
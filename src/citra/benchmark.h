@@ -0,0 +1,44 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+struct TimingEventType;
+} // namespace Core
+
+/**
+ * Measures the wall time of every emulated frame while a movie plays back, then writes them with
+ * the hashes of the final framebuffers as JSON, so that runs of different builds can be compared.
+ */
+class Benchmark {
+public:
+    Benchmark(Core::System& system, std::string output_path);
+    ~Benchmark();
+
+    /// Writes the results, called once the movie has ended and the emulation stopped
+    void Finish();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void FrameCallback(s64 cycles_late);
+
+    /// Hashes the guest memory of the framebuffer the screen displays
+    u64 HashFramebuffer(std::size_t screen) const;
+
+    Core::System& system;
+    std::string output_path;
+
+    Core::TimingEventType* frame_event;
+    Clock::time_point start_time;
+    Clock::time_point previous_frame_time;
+    std::vector<Clock::duration> frame_times;
+};
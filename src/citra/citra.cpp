@@ -18,6 +18,7 @@
 #include <shellapi.h>
 #endif
 
+#include "citra/benchmark.h"
 #include "citra/config.h"
 #include "citra/emu_window/emu_window_sdl2.h"
 #include "citra/lodepng_image_interface.h"
@@ -30,6 +31,7 @@
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
 #include "common/string_util.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/dumping/backend.h"
 #include "core/file_sys/cia_container.h"
@@ -68,6 +70,13 @@ static void PrintHelp(const char* argv0) {
                  "-r, --movie-record=[file]  Record a movie (game inputs) to the given file\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "-b, --benchmark=[file]     Plays the movie unthrottled, then writes the frame "
+                 "times and framebuffer hashes to the given JSON file and exits\n"
+                 "-s, --record-surface-trace=[file]  Records the calls of the surface cache to "
+                 "the given file\n"
+                 "-t, --replay-surface-trace=[file]  Boots the game, replays the surface cache "
+                 "calls of the given file, logs the time spent in the cache and exits\n"
+                 "-o, --offscreen      Hide the window\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
@@ -194,6 +203,10 @@ int main(int argc, char** argv) {
     std::string movie_record;
     std::string movie_play;
     std::string dump_video;
+    std::string benchmark_output;
+    std::string surface_trace_record;
+    std::string surface_trace_replay;
+    bool offscreen = false;
 
     InitializeLogging();
 
@@ -220,12 +233,15 @@ int main(int argc, char** argv) {
         {"gdbport", required_argument, 0, 'g'},     {"install", required_argument, 0, 'i'},
         {"multiplayer", required_argument, 0, 'm'}, {"movie-record", required_argument, 0, 'r'},
         {"movie-play", required_argument, 0, 'p'},  {"dump-video", required_argument, 0, 'd'},
+        {"benchmark", required_argument, 0, 'b'},   {"offscreen", no_argument, 0, 'o'},
+        {"record-surface-trace", required_argument, 0, 's'},
+        {"replay-surface-trace", required_argument, 0, 't'},
         {"fullscreen", no_argument, 0, 'f'},        {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},           {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:d:b:s:t:ofhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -291,6 +307,18 @@ int main(int argc, char** argv) {
             case 'd':
                 dump_video = optarg;
                 break;
+            case 'b':
+                benchmark_output = optarg;
+                break;
+            case 's':
+                surface_trace_record = optarg;
+                break;
+            case 't':
+                surface_trace_replay = optarg;
+                break;
+            case 'o':
+                offscreen = true;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -318,6 +346,7 @@ int main(int argc, char** argv) {
 
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
+    Common::SetCurrentThreadFrameCritical();
 
     if (filepath.empty()) {
         LOG_CRITICAL(Frontend, "Failed to load ROM: No ROM specified");
@@ -329,6 +358,11 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!benchmark_output.empty() && movie_play.empty()) {
+        LOG_CRITICAL(Frontend, "A benchmark needs a movie to play");
+        return -1;
+    }
+
     if (!movie_record.empty()) {
         Core::Movie::GetInstance().PrepareForRecording();
     }
@@ -339,6 +373,9 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (!benchmark_output.empty()) {
+        Settings::values.use_frame_limit = false;
+    }
     Settings::Apply();
 
     // Register frontend applets
@@ -347,7 +384,8 @@ int main(int argc, char** argv) {
     // Register generic image interface
     Core::System::GetInstance().RegisterImageInterface(std::make_shared<LodePNGImageInterface>());
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2>(fullscreen)};
+    std::unique_ptr<EmuWindow_SDL2> emu_window{
+        std::make_unique<EmuWindow_SDL2>(fullscreen, offscreen)};
     Frontend::ScopeAcquireContext scope(*emu_window);
     Core::System& system{Core::System::GetInstance()};
 
@@ -400,7 +438,27 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (!movie_play.empty()) {
+    auto* rasterizer = system.Renderer().Rasterizer();
+    if (!surface_trace_replay.empty()) {
+        // Over the memory of the booted game, the contents don't change the lookups and copies
+        const bool replayed = rasterizer->ReplaySurfaceTrace(surface_trace_replay);
+        if (!replayed) {
+            LOG_CRITICAL(Frontend, "Failed to replay the surface trace {}", surface_trace_replay);
+        }
+        system.Shutdown();
+        detached_tasks.WaitForAllTasks();
+        return replayed ? 0 : -1;
+    }
+    if (!surface_trace_record.empty()) {
+        rasterizer->RecordSurfaceTrace(surface_trace_record);
+    }
+
+    std::unique_ptr<Benchmark> benchmark;
+    if (!benchmark_output.empty()) {
+        benchmark = std::make_unique<Benchmark>(system, benchmark_output);
+        Core::Movie::GetInstance().StartPlayback(movie_play,
+                                                 [&emu_window] { emu_window->Close(); });
+    } else if (!movie_play.empty()) {
         Core::Movie::GetInstance().StartPlayback(movie_play);
     }
     if (!movie_record.empty()) {
@@ -426,6 +484,14 @@ int main(int argc, char** argv) {
     }
     render_thread.join();
 
+    if (!surface_trace_record.empty()) {
+        rasterizer->RecordSurfaceTrace("");
+    }
+    if (benchmark) {
+        benchmark->Finish();
+        benchmark.reset();
+    }
+
     Core::Movie::GetInstance().Shutdown();
     if (system.VideoDumper().IsDumping()) {
         system.VideoDumper().StopDumping();
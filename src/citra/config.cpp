@@ -187,6 +187,8 @@ void Config::ReadValues() {
     Settings::values.sink_id = sdl2_config->GetString("Audio", "output_engine", "auto");
     Settings::values.enable_audio_stretching =
         sdl2_config->GetBoolean("Audio", "enable_audio_stretching", true);
+    Settings::values.audio_stretch_latency =
+        static_cast<u16>(sdl2_config->GetInteger("Audio", "audio_stretch_latency", 100));
     Settings::values.audio_device_id = sdl2_config->GetString("Audio", "output_device", "auto");
     Settings::values.volume = static_cast<float>(sdl2_config->GetReal("Audio", "volume", 1));
     Settings::values.mic_input_device =
@@ -260,6 +262,7 @@ void Config::ReadValues() {
         bool use_lle = sdl2_config->GetBoolean("Debugging", "LLE\\" + service_module.name, false);
         Settings::values.lle_modules.emplace(service_module.name, use_lle);
     }
+    Settings::SetLLEFastPaths(sdl2_config->GetString("Debugging", "lle_fast_paths", ""));
 
     // Web Service
     Settings::values.enable_telemetry =
@@ -228,6 +228,9 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Output latency the audio stretching keeps its backlog under, in milliseconds (default: 100)
+audio_stretch_latency =
+
 # Which audio device to use.
 # auto (default): Auto-select
 output_device =
@@ -293,6 +296,11 @@ record_frame_times =
 use_gdbstub=false
 gdbstub_port=24689
 # To LLE a service module add "LLE\<module name>=true"
+# Commands of the LLE modules answered by HLE, as "<service>/<command header>" separated by commas.
+# The HLE side keeps its own state, only list commands that don't depend on what the module did.
+# The IPC recorder statistics of the Qt frontend can copy the hottest commands in this form.
+# Example: lle_fast_paths = cfg:u/0x00010082, cfg:u/0x00020000
+lle_fast_paths =
 
 [WebService]
 # Whether or not to enable telemetry
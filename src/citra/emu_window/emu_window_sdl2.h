@@ -29,7 +29,8 @@ private:
 
 class EmuWindow_SDL2 : public Frontend::EmuWindow {
 public:
-    explicit EmuWindow_SDL2(bool fullscreen);
+    /// An offscreen window is hidden and presents without vsync
+    explicit EmuWindow_SDL2(bool fullscreen, bool offscreen = false);
     ~EmuWindow_SDL2();
 
     void Present();
@@ -46,6 +47,9 @@ public:
     /// Whether the window is still open, and a close request hasn't yet been sent
     bool IsOpen() const;
 
+    /// Ends the emulation and presentation loops as if the window had been closed
+    void Close();
+
     /// Creates a new context that is shared with the current context
     std::unique_ptr<GraphicsContext> CreateSharedContext() const override;
 
@@ -83,6 +87,9 @@ private:
     /// Is the window still open?
     bool is_open = true;
 
+    /// Whether the window is hidden, see the constructor
+    bool offscreen;
+
     /// Internal SDL2 render window
     SDL_Window* render_window;
 
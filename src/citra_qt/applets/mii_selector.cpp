@@ -84,7 +84,9 @@ QtMiiSelector::QtMiiSelector(QWidget& parent_) : parent(parent_) {}
 
 void QtMiiSelector::Setup(const Frontend::MiiSelectorConfig& config) {
     MiiSelector::Setup(config);
-    QMetaObject::invokeMethod(this, "OpenDialog", Qt::BlockingQueuedConnection);
+    // The dialog runs on the UI thread while the emulation goes on, the HLE applet polls for the
+    // selection
+    QMetaObject::invokeMethod(this, "OpenDialog", Qt::QueuedConnection);
 }
 
 void QtMiiSelector::OpenDialog() {
@@ -114,12 +114,14 @@ void QtKeyboard::Execute(const Frontend::KeyboardConfig& config) {
     if (this->config.button_config != Frontend::ButtonConfig::None) {
         ok_id = static_cast<u8>(this->config.button_config);
     }
-    QMetaObject::invokeMethod(this, "OpenInputDialog", Qt::BlockingQueuedConnection);
+    // The dialog runs on the UI thread while the emulation goes on, the HLE applet polls for the
+    // input
+    QMetaObject::invokeMethod(this, "OpenInputDialog", Qt::QueuedConnection);
 }
 
 void QtKeyboard::ShowError(const std::string& error) {
     QString message = QString::fromStdString(error);
-    QMetaObject::invokeMethod(this, "ShowErrorDialog", Qt::BlockingQueuedConnection,
+    QMetaObject::invokeMethod(this, "ShowErrorDialog", Qt::QueuedConnection,
                               Q_ARG(QString, message));
 }
 
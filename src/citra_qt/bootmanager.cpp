@@ -2,14 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
+#include <thread>
 #include <QApplication>
 #include <QDragEnterEvent>
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
-#include <QOpenGLFunctions>
-#include <QOpenGLFunctions_3_3_Core>
 #include <QOpenGLWindow>
 #include <QScreen>
 #include <QWindow>
@@ -18,6 +18,7 @@
 #include "citra_qt/main.h"
 #include "common/microprofile.h"
 #include "common/scm_rev.h"
+#include "common/thread.h"
 #include "core/3ds.h"
 #include "core/core.h"
 #include "core/frontend/scope_acquire_context.h"
@@ -44,6 +45,7 @@ static GMainWindow* GetMainWindow() {
 
 void EmuThread::run() {
     MicroProfileOnThreadCreate("EmuThread");
+    Common::SetCurrentThreadFrameCritical();
     Frontend::ScopeAcquireContext scope(core_context);
 
     emit LoadProgress(VideoCore::LoadCallbackStage::Prepare, 0, 0);
@@ -127,25 +129,25 @@ OpenGLWindow::~OpenGLWindow() {
     context->doneCurrent();
 }
 
-void OpenGLWindow::Present() {
+bool OpenGLWindow::Present() {
     if (!isExposed())
-        return;
+        return false;
 
     context->makeCurrent(this);
-    if (VideoCore::g_renderer) {
-        VideoCore::g_renderer->TryPresent(100);
+    if (!VideoCore::g_renderer->TryPresent()) {
+        return false;
     }
     context->swapBuffers(this);
-    auto f = context->versionFunctions<QOpenGLFunctions_3_3_Core>();
-    f->glFinish();
-    QWindow::requestUpdate();
+    return true;
+}
+
+void OpenGLWindow::MoveContextToThread(QThread* thread) {
+    context->doneCurrent();
+    context->moveToThread(thread);
 }
 
 bool OpenGLWindow::event(QEvent* event) {
     switch (event->type()) {
-    case QEvent::UpdateRequest:
-        Present();
-        return true;
     case QEvent::MouseButtonPress:
     case QEvent::MouseButtonRelease:
     case QEvent::MouseButtonDblClick:
@@ -183,9 +185,27 @@ bool OpenGLWindow::event(QEvent* event) {
     }
 }
 
-void OpenGLWindow::exposeEvent(QExposeEvent* event) {
-    QWindow::requestUpdate();
-    QWindow::exposeEvent(event);
+PresentThread::PresentThread(OpenGLWindow& window) : window(window) {}
+
+PresentThread::~PresentThread() = default;
+
+void PresentThread::run() {
+    MicroProfileOnThreadCreate("PresentThread");
+    Common::SetCurrentThreadFrameCritical();
+
+    while (!stop_run) {
+        if (!window.Present()) {
+            // No frame is due yet, the core thread produces one per guest VBlank
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Hands the context back, so that the window can be destroyed on the GUI thread
+    window.MoveContextToThread(qApp->thread());
+
+#if MICROPROFILE_ENABLED
+    MicroProfileOnThreadExit();
+#endif
 }
 
 GRenderWindow::GRenderWindow(QWidget* parent_, EmuThread* emu_thread)
@@ -208,6 +228,7 @@ GRenderWindow::GRenderWindow(QWidget* parent_, EmuThread* emu_thread)
 }
 
 GRenderWindow::~GRenderWindow() {
+    StopPresenting();
     InputCommon::Shutdown();
 }
 
@@ -219,6 +240,10 @@ void GRenderWindow::DoneCurrent() {
     core_context->DoneCurrent();
 }
 
+void GRenderWindow::SwapBuffers() {
+    // The renderer hands the frames over to the present thread, see PresentThread
+}
+
 void GRenderWindow::PollEvents() {
     if (!first_frame) {
         first_frame = true;
@@ -402,6 +427,7 @@ void GRenderWindow::InitRenderTarget() {
 }
 
 void GRenderWindow::ReleaseRenderTarget() {
+    StopPresenting();
     if (child_widget) {
         layout()->removeWidget(child_widget);
         delete child_widget;
@@ -433,12 +459,27 @@ void GRenderWindow::OnMinimalClientAreaChangeRequest(std::pair<u32, u32> minimal
 
 void GRenderWindow::OnEmulationStarting(EmuThread* emu_thread) {
     this->emu_thread = emu_thread;
+
+    present_thread = std::make_unique<PresentThread>(*child_window);
+    child_window->MoveContextToThread(present_thread.get());
+    present_thread->start();
 }
 
 void GRenderWindow::OnEmulationStopping() {
+    // The renderer is destroyed when the emulation thread stops, the present thread must be done
+    StopPresenting();
     emu_thread = nullptr;
 }
 
+void GRenderWindow::StopPresenting() {
+    if (!present_thread) {
+        return;
+    }
+    present_thread->RequestStop();
+    present_thread->wait();
+    present_thread.reset();
+}
+
 void GRenderWindow::showEvent(QShowEvent* event) {
     QWidget::showEvent(event);
 }
@@ -131,17 +131,47 @@ public:
 
     ~OpenGLWindow();
 
-    void Present();
+    /**
+     * Draws the newest due frame of the renderer to the window and swaps, which waits for vsync
+     * if it is enabled. Only call on the thread the context was moved to.
+     * @return False if no frame was due, the window then keeps showing the previous one
+     */
+    bool Present();
+
+    /// Moves the context to the thread presenting to the window, call on the thread owning it
+    void MoveContextToThread(QThread* thread);
 
 protected:
     bool event(QEvent* event) override;
-    void exposeEvent(QExposeEvent* event) override;
 
 private:
     QOpenGLContext* context;
     QWidget* event_handler;
 };
 
+/**
+ * Presents the frames the renderer hands over through its mailbox on a dedicated thread, so that
+ * waiting for vsync stalls neither the emulation thread nor the GUI thread.
+ */
+class PresentThread final : public QThread {
+    Q_OBJECT
+
+public:
+    explicit PresentThread(OpenGLWindow& window);
+    ~PresentThread() override;
+
+    void run() override;
+
+    /// Requests for the present thread to stop, wait() for it afterwards
+    void RequestStop() {
+        stop_run = true;
+    }
+
+private:
+    OpenGLWindow& window;
+    std::atomic<bool> stop_run{false};
+};
+
 class GRenderWindow : public QWidget, public Frontend::EmuWindow {
     Q_OBJECT
 
@@ -152,6 +182,7 @@ public:
     // EmuWindow implementation.
     void MakeCurrent() override;
     void DoneCurrent() override;
+    void SwapBuffers() override;
     void PollEvents() override;
     std::unique_ptr<Frontend::GraphicsContext> CreateSharedContext() const override;
 
@@ -207,12 +238,15 @@ private:
 
     void OnMinimalClientAreaChangeRequest(std::pair<u32, u32> minimal_size) override;
 
+    /// Stops the present thread if it runs, and waits for it
+    void StopPresenting();
+
     std::unique_ptr<GraphicsContext> core_context;
 
     QByteArray geometry;
 
     /// Native window handle that backs this presentation widget
-    QWindow* child_window = nullptr;
+    OpenGLWindow* child_window = nullptr;
 
     /// In order to embed the window into GRenderWindow, you need to use createWindowContainer to
     /// put the child_window into a widget then add it to the layout. This child_widget can be
@@ -221,6 +255,9 @@ private:
 
     EmuThread* emu_thread;
 
+    /// Presents to child_window while the emulation runs
+    std::unique_ptr<PresentThread> present_thread;
+
     /// Temporary storage of the screenshot taken
     QImage screenshot_image;
     bool first_frame = false;
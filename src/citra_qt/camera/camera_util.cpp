@@ -171,14 +171,17 @@ static constexpr int V(int r, int g, int b) {
 }
 } // namespace YuvTable
 
-std::vector<u16> Rgb2Yuv(const QImage& source, int width, int height) {
-    auto buffer = std::vector<u16>(width * height);
+void Rgb2Yuv(const QImage& source, std::vector<u16>& buffer, int width, int height) {
+    buffer.resize(width * height);
+    // Reads the scanlines directly rather than converting each pixel with QImage::pixel
+    const QImage rgb32 = source.convertToFormat(QImage::Format_RGB32);
     auto dest = buffer.begin();
     bool write = false;
     int py, pu, pv;
     for (int y = 0; y < height; ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(rgb32.constScanLine(y));
         for (int x = 0; x < width; ++x) {
-            QRgb rgb = source.pixel(x, y);
+            QRgb rgb = line[x];
             int r = qRed(rgb);
             int g = qGreen(rgb);
             int b = qBlue(rgb);
@@ -203,14 +206,13 @@ std::vector<u16> Rgb2Yuv(const QImage& source, int width, int height) {
             write = !write;
         }
     }
-    return buffer;
 }
 
-std::vector<u16> ProcessImage(const QImage& image, int width, int height, bool output_rgb = false,
-                              bool flip_horizontal = false, bool flip_vertical = false) {
-    std::vector<u16> buffer(width * height);
+void ProcessImage(const QImage& image, std::vector<u16>& buffer, int width, int height,
+                  bool output_rgb, bool flip_horizontal, bool flip_vertical) {
     if (image.isNull()) {
-        return buffer;
+        buffer.assign(width * height, 0);
+        return;
     }
     QImage scaled =
         image.scaled(width, height, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
@@ -219,11 +221,11 @@ std::vector<u16> ProcessImage(const QImage& image, int width, int height, bool o
             .mirrored(flip_horizontal, flip_vertical);
     if (output_rgb) {
         QImage converted = transformed.convertToFormat(QImage::Format_RGB16);
+        buffer.resize(width * height);
         std::memcpy(buffer.data(), converted.bits(), width * height * sizeof(u16));
     } else {
-        return CameraUtil::Rgb2Yuv(transformed, width, height);
+        Rgb2Yuv(transformed, buffer, width, height);
     }
-    return buffer;
 }
 
 } // namespace CameraUtil
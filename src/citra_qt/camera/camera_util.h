@@ -11,11 +11,11 @@ class QImage;
 
 namespace CameraUtil {
 
-/// Converts QImage to a yuv formatted std::vector
-std::vector<u16> Rgb2Yuv(const QImage& source, int width, int height);
+/// Converts QImage to yuv into the buffer, which is resized to width * height
+void Rgb2Yuv(const QImage& source, std::vector<u16>& buffer, int width, int height);
 
-/// Processes the QImage (resizing, flipping ...) and converts it to a std::vector
-std::vector<u16> ProcessImage(const QImage& source, int width, int height, bool output_rgb,
-                              bool flip_horizontal, bool flip_vertical);
+/// Processes the QImage (resizing, flipping ...) and converts it into the given buffer
+void ProcessImage(const QImage& source, std::vector<u16>& buffer, int width, int height,
+                  bool output_rgb, bool flip_horizontal, bool flip_vertical);
 
 } // namespace CameraUtil
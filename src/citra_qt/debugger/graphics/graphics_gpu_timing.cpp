@@ -0,0 +1,95 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <QBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTreeWidget>
+#include "citra_qt/debugger/graphics/graphics_gpu_timing.h"
+#include "video_core/gpu_timing.h"
+
+namespace {
+
+QString SectionName(const VideoCore::GPUTiming::Section& section) {
+    using VideoCore::GPUTiming::SectionType;
+    switch (section.type) {
+    case SectionType::Pass:
+        return QObject::tr("Pass color 0x%1 depth 0x%2")
+            .arg(section.color_addr, 8, 16, QLatin1Char('0'))
+            .arg(section.depth_addr, 8, 16, QLatin1Char('0'));
+    case SectionType::Upload:
+        return QObject::tr("Surface uploads");
+    case SectionType::Blit:
+        return QObject::tr("Blits");
+    case SectionType::Present:
+        return QObject::tr("Present");
+    }
+    return {};
+}
+
+QString FormatMicroseconds(u64 ns) {
+    return QString::number(ns / 1000.0, 'f', 1);
+}
+
+} // Anonymous namespace
+
+GraphicsGPUTimingWidget::GraphicsGPUTimingWidget(QWidget* parent)
+    : QDockWidget(tr("GPU Timing"), parent) {
+    setObjectName(QStringLiteral("GpuTiming"));
+
+    summary = new QLabel;
+    sections = new QTreeWidget;
+    sections->setRootIsDecorated(false);
+    sections->setAlternatingRowColors(true);
+    sections->setHeaderLabels({tr("Section"), tr("GPU time (us)"), tr("Runs"), tr("Draws")});
+    sections->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+
+    auto main_widget = new QWidget;
+    auto main_layout = new QVBoxLayout;
+    main_layout->addWidget(summary);
+    main_layout->addWidget(sections);
+    main_widget->setLayout(main_layout);
+    setWidget(main_widget);
+
+    connect(&update_timer, &QTimer::timeout, this, &GraphicsGPUTimingWidget::UpdateTimings);
+}
+
+void GraphicsGPUTimingWidget::showEvent(QShowEvent* ev) {
+    VideoCore::GPUTiming::SetEnabled(true);
+    update_timer.start(500);
+    QDockWidget::showEvent(ev);
+}
+
+void GraphicsGPUTimingWidget::hideEvent(QHideEvent* ev) {
+    update_timer.stop();
+    VideoCore::GPUTiming::SetEnabled(false);
+    QDockWidget::hideEvent(ev);
+}
+
+void GraphicsGPUTimingWidget::UpdateTimings() {
+    const VideoCore::GPUTiming::FrameTimings timings = VideoCore::GPUTiming::GetLastFrame();
+    if (timings.frame == 0) {
+        summary->setText(tr("No frame was measured, the driver may lack timer queries."));
+        sections->clear();
+        shown_frame = 0;
+        return;
+    }
+    if (timings.frame == shown_frame) {
+        return;
+    }
+    shown_frame = timings.frame;
+
+    summary->setText(tr("GPU time %1 us, %2 draws, %3 state changes")
+                         .arg(FormatMicroseconds(timings.gpu_ns))
+                         .arg(timings.draws)
+                         .arg(timings.state_changes));
+
+    sections->clear();
+    for (const auto& section : timings.sections) {
+        auto item = new QTreeWidgetItem(
+            {SectionName(section), FormatMicroseconds(section.gpu_ns),
+             QString::number(section.count), QString::number(section.draws)});
+        sections->addTopLevelItem(item);
+    }
+}
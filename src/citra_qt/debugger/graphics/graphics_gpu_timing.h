@@ -0,0 +1,34 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <QDockWidget>
+#include <QTimer>
+#include "common/common_types.h"
+
+class QLabel;
+class QTreeWidget;
+
+/// Shows the GPU time of the passes, the uploads, the blits and the presentation of the last
+/// measured frame. The renderer measures the frames only while the widget is visible.
+class GraphicsGPUTimingWidget : public QDockWidget {
+    Q_OBJECT
+
+public:
+    explicit GraphicsGPUTimingWidget(QWidget* parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent* ev) override;
+    void hideEvent(QHideEvent* ev) override;
+
+private:
+    void UpdateTimings();
+
+    QLabel* summary;
+    QTreeWidget* sections;
+    QTimer update_timer;
+    /// The frame shown, which is only replaced by newer ones
+    u64 shown_frame = 0;
+};
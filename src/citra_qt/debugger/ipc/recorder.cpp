@@ -2,8 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <QApplication>
+#include <QClipboard>
+#include <QDialog>
+#include <QPushButton>
 #include <QString>
+#include <QTreeWidget>
 #include <QTreeWidgetItem>
+#include <QVBoxLayout>
 #include <fmt/format.h>
 #include "citra_qt/debugger/ipc/record_dialog.h"
 #include "citra_qt/debugger/ipc/recorder.h"
@@ -23,6 +30,10 @@ IPCRecorderWidget::IPCRecorderWidget(QWidget* parent)
 
     connect(ui->enabled, &QCheckBox::stateChanged,
             [this](int new_state) { SetEnabled(new_state == Qt::Checked); });
+    connect(ui->sampleInterval, qOverload<int>(&QSpinBox::valueChanged), this,
+            &IPCRecorderWidget::SetSampleInterval);
+    connect(ui->statisticsButton, &QPushButton::clicked, this,
+            &IPCRecorderWidget::OpenStatisticsDialog);
     connect(ui->clearButton, &QPushButton::clicked, this, &IPCRecorderWidget::Clear);
     connect(ui->filter, &QLineEdit::textChanged, this, &IPCRecorderWidget::ApplyFilterToAll);
     connect(ui->main, &QTreeWidget::itemDoubleClicked, this, &IPCRecorderWidget::OpenRecordDialog);
@@ -72,8 +83,17 @@ void IPCRecorderWidget::OnEntryUpdated(IPCDebugger::RequestRecord record) {
         service = QStringLiteral("%1 (%2)").arg(service, record.is_hle ? tr("HLE") : tr("LLE"));
     }
 
-    QTreeWidgetItem item{
-        {QString::number(record.id), GetStatusStr(record), service, GetFunctionName(record)}};
+    QTreeWidgetItem item{{QString::number(record.id), GetStatusStr(record), service,
+                          GetFunctionName(record), GetHandlingTimeStr(record)}};
+    if (record.function_call_count != 0) {
+        // The average of the function over the recording, to spot the handlers that are slow
+        // overall rather than the ones that were slow once
+        item.setToolTip(4, tr("Average of %1 us over %2 calls")
+                               .arg(static_cast<double>(record.function_total_time_ns) / 1000.0 /
+                                        record.function_call_count,
+                                    0, 'f', 1)
+                               .arg(record.function_call_count));
+    }
 
     const int row_id = record.id - id_offset;
     if (ui->main->invisibleRootItem()->childCount() > row_id) {
@@ -103,6 +123,7 @@ void IPCRecorderWidget::SetEnabled(bool enabled) {
     }
 
     auto& ipc_recorder = Core::System::GetInstance().Kernel().GetIPCRecorder();
+    ipc_recorder.SetSampleInterval(static_cast<u32>(ui->sampleInterval->value()));
     ipc_recorder.SetEnabled(enabled);
 
     if (enabled) {
@@ -120,6 +141,13 @@ void IPCRecorderWidget::Clear() {
     ui->main->invisibleRootItem()->takeChildren();
 }
 
+QString IPCRecorderWidget::GetHandlingTimeStr(const IPCDebugger::RequestRecord& record) const {
+    if (record.function_call_count == 0) { // Not handled yet, or by LLE
+        return {};
+    }
+    return QString::number(static_cast<double>(record.handling_time_ns) / 1000.0, 'f', 1);
+}
+
 QString IPCRecorderWidget::GetServiceName(const IPCDebugger::RequestRecord& record) const {
     if (Core::System::GetInstance().IsPoweredOn() && record.client_port.id != -1) {
         const auto service_name =
@@ -181,3 +209,65 @@ void IPCRecorderWidget::OpenRecordDialog(QTreeWidgetItem* item, [[maybe_unused]]
                         item->text(3));
     dialog.exec();
 }
+
+void IPCRecorderWidget::SetSampleInterval(int interval) {
+    if (!Core::System::GetInstance().IsPoweredOn()) {
+        return;
+    }
+    Core::System::GetInstance().Kernel().GetIPCRecorder().SetSampleInterval(
+        static_cast<u32>(interval));
+}
+
+void IPCRecorderWidget::OpenStatisticsDialog() {
+    std::vector<IPCDebugger::CommandStats> stats;
+    if (Core::System::GetInstance().IsPoweredOn()) {
+        stats = Core::System::GetInstance().Kernel().GetIPCRecorder().GetCommandStats();
+    }
+    std::sort(stats.begin(), stats.end(),
+              [](const auto& a, const auto& b) { return a.total_ns > b.total_ns; });
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("IPC Statistics"));
+    dialog.resize(600, 400);
+    auto* tree = new QTreeWidget(&dialog);
+    tree->setAlternatingRowColors(true);
+    tree->setRootIsDecorated(false);
+    tree->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    tree->setHeaderLabels({tr("Service"), tr("Header"), tr("Count"), tr("Total (us)"),
+                           tr("Average (us)"), tr("50% under (us)"), tr("99% under (us)")});
+    for (const auto& command : stats) {
+        const QString service = command.port_name.empty()
+                                    ? tr("Portless")
+                                    : QString::fromStdString(command.port_name);
+        auto* item = new QTreeWidgetItem(
+            {service, QStringLiteral("0x%1").arg(command.header, 8, 16, QLatin1Char('0')),
+             QString::number(command.count), QString::number(command.total_ns / 1000),
+             QString::number(static_cast<double>(command.total_ns) / 1000.0 / command.count, 'f',
+                             1),
+             QString::number(command.GetPercentileUs(0.5)),
+             QString::number(command.GetPercentileUs(0.99))});
+        // Portless sessions aren't reached through srv, they can't have fast paths
+        if (command.port_name.empty()) {
+            item->setFlags(item->flags() & ~Qt::ItemIsSelectable);
+        }
+        tree->addTopLevelItem(item);
+    }
+
+    // The selected commands in the form of the lle_fast_paths setting
+    auto* copy_button = new QPushButton(tr("Copy as LLE Fast Paths"), &dialog);
+    copy_button->setToolTip(
+        tr("Copies the selected commands, to be answered by HLE while their module is LLE. Only "
+           "pick commands whose result doesn't depend on what the module was asked before."));
+    connect(copy_button, &QPushButton::clicked, &dialog, [tree] {
+        QStringList fast_paths;
+        for (const QTreeWidgetItem* item : tree->selectedItems()) {
+            fast_paths.append(QStringLiteral("%1/%2").arg(item->text(0), item->text(1)));
+        }
+        QApplication::clipboard()->setText(fast_paths.join(QStringLiteral(", ")));
+    });
+
+    auto* layout = new QVBoxLayout(&dialog);
+    layout->addWidget(tree);
+    layout->addWidget(copy_button);
+    dialog.exec();
+}
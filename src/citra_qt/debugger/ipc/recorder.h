@@ -30,6 +30,7 @@ signals:
 
 private:
     QString GetStatusStr(const IPCDebugger::RequestRecord& record) const;
+    QString GetHandlingTimeStr(const IPCDebugger::RequestRecord& record) const;
     void OnEntryUpdated(IPCDebugger::RequestRecord record);
     void SetEnabled(bool enabled);
     void Clear();
@@ -38,6 +39,8 @@ private:
     QString GetServiceName(const IPCDebugger::RequestRecord& record) const;
     QString GetFunctionName(const IPCDebugger::RequestRecord& record) const;
     void OpenRecordDialog(QTreeWidgetItem* item, int column);
+    void SetSampleInterval(int interval);
+    void OpenStatisticsDialog();
 
     std::unique_ptr<Ui::IPCRecorder> ui;
     IPCDebugger::CallbackHandle handle;
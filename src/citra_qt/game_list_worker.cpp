@@ -6,8 +6,11 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include <QDataStream>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
 #include "citra_qt/compatibility_list.h"
 #include "citra_qt/game_list.h"
 #include "citra_qt/game_list_p.h"
@@ -15,6 +18,7 @@
 #include "citra_qt/uisettings.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/logging/log.h"
 #include "core/hle/service/am/am.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/loader/loader.h"
@@ -24,6 +28,14 @@ bool HasSupportedFileExtension(const std::string& file_name) {
     const QFileInfo file = QFileInfo(QString::fromStdString(file_name));
     return GameList::supported_file_extensions.contains(file.suffix(), Qt::CaseInsensitive);
 }
+
+constexpr quint32 CacheMagic = 0x434C4743; // "CGLC"
+constexpr quint32 CacheVersion = 1;
+
+QString GetCachePath() {
+    return QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir)) +
+           QStringLiteral("game_list.bin");
+}
 } // Anonymous namespace
 
 GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
@@ -32,6 +44,167 @@ GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
 
 GameListWorker::~GameListWorker() = default;
 
+void GameListWorker::LoadCache() {
+    QFile file(GetCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic, version, count;
+    stream >> magic >> version >> count;
+    if (magic != CacheMagic || version != CacheVersion) {
+        return;
+    }
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        QByteArray smdh;
+        quint64 size, modification_time, program_id, extdata_id;
+        qint32 file_type;
+        bool executable;
+        stream >> path >> size >> modification_time >> executable >> program_id >> extdata_id >>
+            file_type >> smdh;
+
+        Metadata& metadata = cache[path.toStdString()];
+        metadata.size = size;
+        metadata.modification_time = modification_time;
+        metadata.executable = executable;
+        metadata.program_id = program_id;
+        metadata.extdata_id = extdata_id;
+        metadata.file_type = file_type;
+        metadata.smdh.assign(smdh.begin(), smdh.end());
+    }
+    if (stream.status() != QDataStream::Ok) {
+        cache.clear();
+    }
+}
+
+void GameListWorker::SaveCache() {
+    // Titles that were moved or removed are dropped
+    for (auto it = cache.begin(); it != cache.end();) {
+        it = FileUtil::Exists(it->first) ? std::next(it) : cache.erase(it);
+    }
+
+    FileUtil::CreateFullPath(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir));
+    QFile file(GetCachePath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_WARNING(Frontend, "Could not write the game list cache");
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << CacheMagic << CacheVersion << static_cast<quint32>(cache.size());
+    for (const auto& [path, metadata] : cache) {
+        stream << QString::fromStdString(path) << static_cast<quint64>(metadata.size)
+               << static_cast<quint64>(metadata.modification_time) << metadata.executable
+               << static_cast<quint64>(metadata.program_id)
+               << static_cast<quint64>(metadata.extdata_id)
+               << static_cast<qint32>(metadata.file_type)
+               << QByteArray(reinterpret_cast<const char*>(metadata.smdh.data()),
+                             static_cast<int>(metadata.smdh.size()));
+    }
+}
+
+std::optional<GameListWorker::Metadata> GameListWorker::FindCachedMetadata(
+    const std::string& physical_name, u64 size, u64 modification_time) const {
+    const auto it = cache.find(physical_name);
+    if (it == cache.end() || it->second.size != size ||
+        it->second.modification_time != modification_time) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<GameListWorker::Metadata> GameListWorker::GetMetadata(
+    const std::string& physical_name) {
+    Metadata metadata;
+    metadata.size = FileUtil::GetSize(physical_name);
+    metadata.modification_time = FileUtil::GetFileModificationTimestamp(physical_name);
+    {
+        std::lock_guard lock{cache_mutex};
+        if (auto cached = FindCachedMetadata(physical_name, metadata.size,
+                                             metadata.modification_time)) {
+            return cached;
+        }
+    }
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
+    if (!loader) {
+        return std::nullopt;
+    }
+
+    // Encrypted titles are listed too, but they may become readable once the keys are added, so
+    // those are not cached
+    const auto res = loader->IsExecutable(metadata.executable);
+    const bool encrypted = res == Loader::ResultStatus::ErrorEncrypted;
+    metadata.executable = metadata.executable || encrypted;
+    loader->ReadProgramId(metadata.program_id);
+    loader->ReadExtdataId(metadata.extdata_id);
+    loader->ReadIcon(metadata.smdh);
+    metadata.file_type = static_cast<int>(loader->GetFileType());
+
+    if (!encrypted) {
+        std::lock_guard lock{cache_mutex};
+        cache[physical_name] = metadata;
+        cache_changed = true;
+    }
+    return metadata;
+}
+
+void GameListWorker::AddEntry(const std::string& physical_name, GameListDir* parent_dir) {
+    if (stop_processing) {
+        return;
+    }
+
+    const std::optional<Metadata> metadata = GetMetadata(physical_name);
+    if (!metadata || !metadata->executable) {
+        return;
+    }
+    const u64 program_id = metadata->program_id;
+
+    std::vector<u8> smdh;
+    // Look for an update icon if available
+    if (!(program_id & ~0x00040000FFFFFFFF)) {
+        std::string update_path = Service::AM::GetTitleContentPath(
+            Service::FS::MediaType::SDMC, program_id | 0x0000000E00000000);
+        if (FileUtil::Exists(update_path)) {
+            if (const auto update_metadata = GetMetadata(update_path)) {
+                smdh = update_metadata->smdh;
+            }
+        }
+    }
+
+    if (!Loader::IsValidSMDH(smdh)) {
+        // Read the original smdh if there is no valid update smdh
+        smdh = metadata->smdh;
+    }
+
+    if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
+        // Skip this invalid entry
+        return;
+    }
+
+    auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
+
+    // The game list uses this as compatibility number for untested games
+    QString compatibility(QStringLiteral("99"));
+    if (it != compatibility_list.end())
+        compatibility = it->second.first;
+
+    const auto file_type = static_cast<Loader::FileType>(metadata->file_type);
+    emit EntryReady(
+        {
+            new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
+                                 metadata->extdata_id),
+            new GameListItemCompat(compatibility),
+            new GameListItemRegion(smdh),
+            new GameListItem(QString::fromStdString(Loader::GetFileTypeString(file_type))),
+            new GameListItemSize(metadata->size),
+        },
+        parent_dir);
+}
+
 void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                              GameListDir* parent_dir) {
     const auto callback = [this, recursion, parent_dir](u64* num_entries_out,
@@ -45,66 +218,11 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
         const std::string physical_name = directory + DIR_SEP + virtual_name;
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader) {
-                return true;
-            }
-
-            bool executable = false;
-            const auto res = loader->IsExecutable(executable);
-            if (!executable && res != Loader::ResultStatus::ErrorEncrypted) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh;
-            // Look for an update icon if available
-            if (!(program_id & ~0x00040000FFFFFFFF)) {
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id | 0x0000000E00000000);
-                if (FileUtil::Exists(update_path)) {
-                    std::unique_ptr<Loader::AppLoader> update_loader =
-                        Loader::GetLoader(update_path);
-                    if (update_loader) {
-                        update_loader->ReadIcon(smdh);
-                    }
-                }
-            }
-
-            if (!Loader::IsValidSMDH(smdh)) {
-                // Read the original smdh if there is no valid update smdh
-                loader->ReadIcon(smdh);
-            }
-
-            if (!Loader::IsValidSMDH(smdh) && UISettings::values.game_list_hide_no_icon) {
-                // Skip this invalid entry
-                return true;
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility(QStringLiteral("99"));
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                },
-                parent_dir);
-
+            // Cached entries come back at once, the others are parsed in parallel
+            pending_entries.push_back(
+                QtConcurrent::run(&parse_pool, [this, physical_name, parent_dir] {
+                    AddEntry(physical_name, parent_dir);
+                }));
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
             AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir);
@@ -118,6 +236,7 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
 
 void GameListWorker::run() {
     stop_processing = false;
+    LoadCache();
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == QStringLiteral("INSTALLED")) {
             QString games_path =
@@ -153,6 +272,14 @@ void GameListWorker::run() {
                                     game_list_dir);
         }
     };
+
+    for (auto& entry : pending_entries) {
+        entry.waitForFinished();
+    }
+    pending_entries.clear();
+    if (cache_changed) {
+        SaveCache();
+    }
     emit Finished(watch_list);
 }
 
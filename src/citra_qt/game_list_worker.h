@@ -7,12 +7,17 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <QFuture>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QString>
+#include <QThreadPool>
 #include <QVector>
 #include "citra_qt/compatibility_list.h"
 #include "common/common_types.h"
@@ -53,12 +58,47 @@ signals:
     void Finished(QStringList watch_list);
 
 private:
+    /// What the game list shows of a file, cached on disk between refreshes
+    struct Metadata {
+        u64 size = 0;
+        u64 modification_time = 0;
+        bool executable = false;
+        u64 program_id = 0;
+        u64 extdata_id = 0;
+        int file_type = 0;
+        std::vector<u8> smdh;
+    };
+
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir);
 
+    /// Emits the entry of a file, nothing if it is not a title
+    void AddEntry(const std::string& physical_name, GameListDir* parent_dir);
+
+    /**
+     * Returns the metadata of a file from the cache, or parses the file when it was changed since.
+     * Thread-safe. Empty if the file can't be loaded.
+     */
+    std::optional<Metadata> GetMetadata(const std::string& physical_name);
+
+    /// Returns the cached metadata if the file did not change since, with the cache mutex held
+    std::optional<Metadata> FindCachedMetadata(const std::string& physical_name, u64 size,
+                                               u64 modification_time) const;
+
+    void LoadCache();
+    void SaveCache();
+
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
 
     QStringList watch_list;
     std::atomic_bool stop_processing;
+
+    /// Parses the files missing from the cache, the worker itself only walks the directories
+    QThreadPool parse_pool;
+    std::vector<QFuture<void>> pending_entries;
+
+    std::mutex cache_mutex;
+    std::unordered_map<std::string, Metadata> cache;
+    bool cache_changed = false;
 };
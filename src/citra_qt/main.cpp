@@ -37,6 +37,7 @@
 #include "citra_qt/debugger/graphics/graphics.h"
 #include "citra_qt/debugger/graphics/graphics_breakpoints.h"
 #include "citra_qt/debugger/graphics/graphics_cmdlists.h"
+#include "citra_qt/debugger/graphics/graphics_gpu_timing.h"
 #include "citra_qt/debugger/graphics/graphics_surface.h"
 #include "citra_qt/debugger/graphics/graphics_tracing.h"
 #include "citra_qt/debugger/graphics/graphics_vertex_shader.h"
@@ -63,6 +64,7 @@
 #include "common/logging/log.h"
 #include "common/logging/text_formatter.h"
 #include "common/microprofile.h"
+#include "common/profile_trace.h"
 #include "common/scm_rev.h"
 #include "common/scope_exit.h"
 #ifdef ARCHITECTURE_x86_64
@@ -280,8 +282,8 @@ void GMainWindow::InitializeWidgets() {
                                   "This will vary from game to game and scene to scene."));
     emu_frametime_label = new QLabel();
     emu_frametime_label->setToolTip(
-        tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
-           "full-speed emulation this should be at most 16.67 ms."));
+        tr("Time between 3DS frames, including framelimiting. For full-speed emulation this "
+           "should be 16.67 ms."));
 
     for (auto& label : {emu_speed_label, game_fps_label, emu_frametime_label}) {
         label->setVisible(false);
@@ -353,6 +355,11 @@ void GMainWindow::InitializeDebugWidgets() {
     connect(this, &GMainWindow::EmulationStopping, graphicsTracingWidget,
             &GraphicsTracingWidget::OnEmulationStopping);
 
+    graphicsGPUTimingWidget = new GraphicsGPUTimingWidget(this);
+    addDockWidget(Qt::RightDockWidgetArea, graphicsGPUTimingWidget);
+    graphicsGPUTimingWidget->hide();
+    debug_menu->addAction(graphicsGPUTimingWidget->toggleViewAction());
+
     waitTreeWidget = new WaitTreeWidget(this);
     addDockWidget(Qt::LeftDockWidgetArea, waitTreeWidget);
     waitTreeWidget->hide();
@@ -499,6 +506,14 @@ void GMainWindow::InitializeHotkeys() {
     connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Toggle Texture Dumping"), this),
             &QShortcut::activated, this,
             [&] { Settings::values.dump_textures = !Settings::values.dump_textures; });
+    connect(hotkey_registry.GetHotkey(main_window, QStringLiteral("Toggle Profile Trace"), this),
+            &QShortcut::activated, this, [&] {
+                if (Common::ProfileTrace::Toggle()) {
+                    statusBar()->showMessage(tr("Started the profile trace"), 2000);
+                } else {
+                    statusBar()->showMessage(tr("Stopped the profile trace"), 2000);
+                }
+            });
     // We use "static" here in order to avoid capturing by lambda due to a MSVC bug, which makes
     // the variable hold a garbage value after this function exits
     static constexpr u16 SPEED_LIMIT_STEP = 5;
@@ -2029,7 +2044,22 @@ void GMainWindow::UpdateStatusBar() {
         emu_speed_label->setText(tr("Speed: %1%").arg(results.emulation_speed * 100.0, 0, 'f', 0));
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
-    emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    const auto& frame_stats = results.frame_time_stats;
+    emu_frametime_label->setText(tr("Frame: %1 ms (99%: %2 ms)")
+                                     .arg(frame_stats.percentile_50, 0, 'f', 2)
+                                     .arg(frame_stats.percentile_99, 0, 'f', 2));
+    QString frametime_tooltip =
+        tr("Frame times of the last 5 seconds. 50%: %1 ms, 95%: %2 ms, 99%: %3 ms")
+            .arg(frame_stats.percentile_50, 0, 'f', 2)
+            .arg(frame_stats.percentile_95, 0, 'f', 2)
+            .arg(frame_stats.percentile_99, 0, 'f', 2);
+    for (std::size_t i = 0; i < Core::NUM_PERF_CATEGORIES; ++i) {
+        frametime_tooltip += QStringLiteral("\n%1: %2 ms")
+                                 .arg(QString::fromUtf8(Core::GetPerfCategoryName(
+                                     static_cast<Core::PerfCategory>(i))))
+                                 .arg(frame_stats.category_time[i], 0, 'f', 2);
+    }
+    emu_frametime_label->setToolTip(frametime_tooltip);
 
     emu_speed_label->setVisible(true);
     game_fps_label->setVisible(true);
@@ -2343,8 +2373,8 @@ void GMainWindow::RetranslateStatusBar() {
     game_fps_label->setToolTip(tr("How many frames per second the game is currently displaying. "
                                   "This will vary from game to game and scene to scene."));
     emu_frametime_label->setToolTip(
-        tr("Time taken to emulate a 3DS frame, not counting framelimiting or v-sync. For "
-           "full-speed emulation this should be at most 16.67 ms."));
+        tr("Time between 3DS frames, including framelimiting. For full-speed emulation this "
+           "should be 16.67 ms."));
 
     multiplayer_state->retranslateUi();
 }
@@ -2369,7 +2399,10 @@ void GMainWindow::SetDiscordEnabled([[maybe_unused]] bool state) {
 int main(int argc, char* argv[]) {
     Common::DetachedTasks detached_tasks;
     MicroProfileOnThreadCreate("Frontend");
-    SCOPE_EXIT({ MicroProfileShutdown(); });
+    SCOPE_EXIT({
+        Common::ProfileTrace::Stop();
+        MicroProfileShutdown();
+    });
 
     // Init settings params
     QCoreApplication::setOrganizationName(QStringLiteral("Citra team"));
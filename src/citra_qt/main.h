@@ -29,6 +29,7 @@ class GImageInfo;
 class GPUCommandListWidget;
 class GPUCommandStreamWidget;
 class GraphicsBreakPointsWidget;
+class GraphicsGPUTimingWidget;
 class GraphicsTracingWidget;
 class GraphicsVertexShaderWidget;
 class GRenderWindow;
@@ -280,6 +281,7 @@ private:
     GraphicsBreakPointsWidget* graphicsBreakpointsWidget;
     GraphicsVertexShaderWidget* graphicsVertexShaderWidget;
     GraphicsTracingWidget* graphicsTracingWidget;
+    GraphicsGPUTimingWidget* graphicsGPUTimingWidget;
     IPCRecorderWidget* ipcRecorderWidget;
     LLEServiceModulesWidget* lleServiceModulesWidget;
     WaitTreeWidget* waitTreeWidget;
@@ -74,6 +74,8 @@ Lobby::Lobby(QWidget* parent, QStandardItemModel* list,
     connect(&room_list_watcher, &QFutureWatcher<AnnounceMultiplayerRoom::RoomList>::finished, this,
             &Lobby::OnRefreshLobby);
 
+    ResetModel();
+
     // manually start a refresh when the window is opening
     // TODO(jroweboy): if this refresh is slow for people with bad internet, then don't do it as
     // part of the constructor, but offload the refresh until after the window shown. perhaps emit a
@@ -91,6 +93,17 @@ void Lobby::UpdateGameList(QStandardItemModel* list) {
     }
     if (proxy)
         proxy->UpdateGameList(game_list);
+
+    // The rows are added again for the icons of the games now owned
+    if (!rooms.empty()) {
+        auto listed_rooms = std::move(rooms);
+        rooms.clear();
+        ResetModel();
+        for (auto& [id, room] : listed_rooms) {
+            QStandardItem* first_item = AddRoom(room.first);
+            rooms.emplace(id, std::make_pair(std::move(room.first), first_item));
+        }
+    }
 }
 
 void Lobby::RetranslateUi() {
@@ -191,7 +204,7 @@ void Lobby::ResetModel() {
 
 void Lobby::RefreshLobby() {
     if (auto session = announce_multiplayer_session.lock()) {
-        ResetModel();
+        // The rooms stay listed until the new list arrives
         ui->refresh_list->setEnabled(false);
         ui->refresh_list->setText(tr("Refreshing"));
         room_list_watcher.setFuture(
@@ -201,50 +214,75 @@ void Lobby::RefreshLobby() {
     }
 }
 
-void Lobby::OnRefreshLobby() {
-    AnnounceMultiplayerRoom::RoomList new_room_list = room_list_watcher.result();
-    for (auto room : new_room_list) {
-        // find the icon for the game if this person owns that game.
-        QPixmap smdh_icon;
-        for (int r = 0; r < game_list->rowCount(); ++r) {
-            auto index = game_list->index(r, 0);
-            auto game_id = game_list->data(index, GameListItemPath::ProgramIdRole).toULongLong();
-            if (game_id != 0 && room.preferred_game_id == game_id) {
-                smdh_icon = game_list->data(index, Qt::DecorationRole).value<QPixmap>();
-            }
+QStandardItem* Lobby::AddRoom(const AnnounceMultiplayerRoom::Room& room) {
+    // find the icon for the game if this person owns that game.
+    QPixmap smdh_icon;
+    for (int r = 0; r < game_list->rowCount(); ++r) {
+        auto index = game_list->index(r, 0);
+        auto game_id = game_list->data(index, GameListItemPath::ProgramIdRole).toULongLong();
+        if (game_id != 0 && room.preferred_game_id == game_id) {
+            smdh_icon = game_list->data(index, Qt::DecorationRole).value<QPixmap>();
         }
+    }
 
-        QList<QVariant> members;
-        for (auto member : room.members) {
-            QVariant var;
-            var.setValue(LobbyMember{QString::fromStdString(member.username),
-                                     QString::fromStdString(member.nickname), member.game_id,
-                                     QString::fromStdString(member.game_name)});
-            members.append(var);
-        }
+    QList<QVariant> members;
+    for (auto member : room.members) {
+        QVariant var;
+        var.setValue(LobbyMember{QString::fromStdString(member.username),
+                                 QString::fromStdString(member.nickname), member.game_id,
+                                 QString::fromStdString(member.game_name)});
+        members.append(var);
+    }
+
+    auto first_item = new LobbyItem();
+    auto row = QList<QStandardItem*>({
+        first_item,
+        new LobbyItemName(room.has_password, QString::fromStdString(room.name)),
+        new LobbyItemGame(room.preferred_game_id, QString::fromStdString(room.preferred_game),
+                          smdh_icon),
+        new LobbyItemHost(QString::fromStdString(room.owner), QString::fromStdString(room.ip),
+                          room.port, QString::fromStdString(room.verify_UID)),
+        new LobbyItemMemberList(members, room.max_player),
+    });
+    model->appendRow(row);
+    // To make the rows expandable, add the member data as a child of the first column of the
+    // rows with people in them and have qt set them to colspan after the model is finished
+    // resetting
+    if (!room.description.empty()) {
+        first_item->appendRow(
+            new LobbyItemDescription(QString::fromStdString(room.description)));
+    }
+    if (!room.members.empty()) {
+        first_item->appendRow(new LobbyItemExpandedMemberList(members));
+    }
+    return first_item;
+}
 
-        auto first_item = new LobbyItem();
-        auto row = QList<QStandardItem*>({
-            first_item,
-            new LobbyItemName(room.has_password, QString::fromStdString(room.name)),
-            new LobbyItemGame(room.preferred_game_id, QString::fromStdString(room.preferred_game),
-                              smdh_icon),
-            new LobbyItemHost(QString::fromStdString(room.owner), QString::fromStdString(room.ip),
-                              room.port, QString::fromStdString(room.verify_UID)),
-            new LobbyItemMemberList(members, room.max_player),
-        });
-        model->appendRow(row);
-        // To make the rows expandable, add the member data as a child of the first column of the
-        // rows with people in them and have qt set them to colspan after the model is finished
-        // resetting
-        if (!room.description.empty()) {
-            first_item->appendRow(
-                new LobbyItemDescription(QString::fromStdString(room.description)));
+void Lobby::OnRefreshLobby() {
+    AnnounceMultiplayerRoom::RoomList new_room_list = room_list_watcher.result();
+
+    // Only the rooms that changed get new rows, the others keep theirs and their expansion
+    std::unordered_map<std::string, std::pair<AnnounceMultiplayerRoom::Room, QStandardItem*>>
+        new_rooms;
+    for (auto& room : new_room_list) {
+        if (new_rooms.count(room.id)) {
+            continue;
         }
-        if (!room.members.empty()) {
-            first_item->appendRow(new LobbyItemExpandedMemberList(members));
+        auto listed = rooms.find(room.id);
+        if (listed != rooms.end() && listed->second.first == room) {
+            new_rooms.emplace(room.id, std::move(listed->second));
+            rooms.erase(listed);
+            continue;
         }
+        QStandardItem* first_item = AddRoom(room);
+        std::string id = room.id;
+        new_rooms.emplace(std::move(id), std::make_pair(std::move(room), first_item));
     }
+    // What is left are the rooms closed or changed
+    for (const auto& [id, room] : rooms) {
+        model->removeRow(room.second->row());
+    }
+    rooms = std::move(new_rooms);
 
     // Reenable the refresh button and resize the columns
     ui->refresh_list->setEnabled(true);
@@ -255,10 +293,15 @@ void Lobby::OnRefreshLobby() {
     }
 
     // Set the member list child items to span all columns
-    for (int i = 0; i < proxy->rowCount(); i++) {
+    for (int i = 0; i < model->rowCount(); i++) {
         auto parent = model->item(i, 0);
+        // The rows kept are not in the order of the model anymore
+        const QModelIndex parent_index = proxy->mapFromSource(parent->index());
+        if (!parent_index.isValid()) {
+            continue;
+        }
         for (int j = 0; j < parent->rowCount(); j++) {
-            ui->room_list->setFirstColumnSpanned(j, proxy->index(i, 0), true);
+            ui->room_list->setFirstColumnSpanned(j, parent_index, true);
         }
     }
 }
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <QDialog>
 #include <QFutureWatcher>
 #include <QSortFilterProxyModel>
@@ -75,6 +78,11 @@ private:
      */
     void ResetModel();
 
+    /**
+     * Adds the row of a room, returns the first item of the row.
+     */
+    QStandardItem* AddRoom(const AnnounceMultiplayerRoom::Room& room);
+
     /**
      * Prompts for a password. Returns an empty QString if the user either did not provide a
      * password or if the user closed the window.
@@ -88,6 +96,8 @@ private:
     LobbyFilterProxyModel* proxy{};
 
     QFutureWatcher<AnnounceMultiplayerRoom::RoomList> room_list_watcher;
+    /// The listed rooms by id, with the first item of their row
+    std::unordered_map<std::string, std::pair<AnnounceMultiplayerRoom::Room, QStandardItem*>> rooms;
     std::weak_ptr<Core::AnnounceMultiplayerSession> announce_multiplayer_session;
     QFutureWatcher<void>* watcher;
     Validation validation;
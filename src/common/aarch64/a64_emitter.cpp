@@ -0,0 +1,142 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include "common/aarch64/a64_emitter.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Common::A64 {
+
+CodeGenerator::CodeGenerator(std::size_t size) : max_size(size) {
+#ifdef _WIN32
+    code = static_cast<u8*>(
+        VirtualAlloc(nullptr, max_size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+    ASSERT_MSG(code != nullptr, "Failed to allocate executable memory");
+#else
+    void* memory = mmap(nullptr, max_size, PROT_READ | PROT_WRITE | PROT_EXEC,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ASSERT_MSG(memory != MAP_FAILED, "Failed to allocate executable memory");
+    code = static_cast<u8*>(memory);
+#endif
+}
+
+CodeGenerator::~CodeGenerator() {
+#ifdef _WIN32
+    VirtualFree(code, 0, MEM_RELEASE);
+#else
+    munmap(code, max_size);
+#endif
+}
+
+void CodeGenerator::ready() {
+#ifdef _WIN32
+    FlushInstructionCache(GetCurrentProcess(), code, size);
+#else
+    __builtin___clear_cache(reinterpret_cast<char*>(code), reinterpret_cast<char*>(code + size));
+#endif
+}
+
+void CodeGenerator::dw(u32 value) {
+    ASSERT_MSG(size + sizeof(u32) <= max_size, "Emitted code exceeds the allocated size");
+    std::memcpy(code + size, &value, sizeof(u32));
+    size += sizeof(u32);
+}
+
+void CodeGenerator::align(std::size_t alignment) {
+    while (size % alignment != 0) {
+        dw(0xD503201F); // nop
+    }
+}
+
+void CodeGenerator::L(Label& label) {
+    ASSERT_MSG(!label.IsBound(), "Label bound twice");
+    label.offset = size;
+    for (const auto& [at, type] : label.fixups) {
+        PatchBranch(at, size, type);
+    }
+    label.fixups.clear();
+}
+
+void CodeGenerator::EmitBranch(u32 opcode, Label& label, Label::FixupType type) {
+    const std::size_t at = size;
+    dw(opcode);
+    if (label.IsBound()) {
+        PatchBranch(at, *label.offset, type);
+    } else {
+        label.fixups.emplace_back(at, type);
+    }
+}
+
+void CodeGenerator::PatchBranch(std::size_t at, std::size_t target, Label::FixupType type) {
+    const s64 distance = (static_cast<s64>(target) - static_cast<s64>(at)) / 4;
+    u32 instruction;
+    std::memcpy(&instruction, code + at, sizeof(u32));
+    if (type == Label::FixupType::Branch26) {
+        ASSERT_MSG(distance >= -(1 << 25) && distance < (1 << 25), "Branch out of range");
+        instruction |= static_cast<u32>(distance) & 0x3FFFFFF;
+    } else {
+        ASSERT_MSG(distance >= -(1 << 18) && distance < (1 << 18), "Branch out of range");
+        instruction |= (static_cast<u32>(distance) & 0x7FFFF) << 5;
+    }
+    std::memcpy(code + at, &instruction, sizeof(u32));
+}
+
+void CodeGenerator::mov(XReg rd, u64 imm) {
+    bool first = true;
+    for (u32 shift = 0; shift < 64; shift += 16) {
+        const u32 part = static_cast<u32>(imm >> shift) & 0xFFFF;
+        if (part == 0)
+            continue;
+        // movz for the first non-zero halfword, movk for the rest
+        dw((first ? 0xD2800000 : 0xF2800000) | (shift / 16) << 21 | part << 5 | rd.index);
+        first = false;
+    }
+    if (first) {
+        dw(0xD2800000 | rd.index); // movz rd, #0
+    }
+}
+
+void CodeGenerator::mov(WReg rd, u32 imm) {
+    const u32 low = imm & 0xFFFF;
+    const u32 high = imm >> 16;
+    if (high == 0) {
+        dw(0x52800000 | low << 5 | rd.index);
+    } else {
+        dw(0x52A00000 | high << 5 | rd.index);
+        if (low != 0) {
+            dw(0x72800000 | low << 5 | rd.index);
+        }
+    }
+}
+
+void CodeGenerator::ldr(SReg rt, const void* literal) {
+    const s64 distance =
+        (reinterpret_cast<const u8*>(literal) - reinterpret_cast<const u8*>(getCurr())) / 4;
+    ASSERT_MSG(distance >= -(1 << 18) && distance < (1 << 18), "Literal out of range");
+    dw(0x1C000000 | (static_cast<u32>(distance) & 0x7FFFF) << 5 | rt.index);
+}
+
+u32 CodeGenerator::EncodeLogicalImm32(u32 imm) {
+    ASSERT_MSG(imm != 0 && imm != 0xFFFFFFFF, "Immediate not encodable");
+    u32 lsb = 0;
+    while (((imm >> lsb) & 1) == 0) {
+        ++lsb;
+    }
+    u32 ones = 0;
+    while (lsb + ones < 32 && ((imm >> (lsb + ones)) & 1) != 0) {
+        ++ones;
+    }
+    const u32 run = static_cast<u32>((u64{1} << ones) - 1) << lsb;
+    ASSERT_MSG(run == imm, "Immediate not encodable");
+    // N = 0 with a 32-bit element: imms holds the number of ones minus one, immr rotates the run
+    // back into place
+    return ((32 - lsb) % 32) << 16 | (ones - 1) << 10;
+}
+
+} // namespace Common::A64
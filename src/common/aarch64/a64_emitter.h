@@ -0,0 +1,488 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace Common::A64 {
+
+/// 64-bit general purpose register. Index 31 is SP when used as a base or with add/sub immediate,
+/// and XZR everywhere else.
+struct XReg {
+    u32 index;
+};
+
+/// 32-bit view of a general purpose register
+struct WReg {
+    u32 index;
+};
+
+/// SIMD register, used with the 4S arrangement by the vector instructions
+struct VReg {
+    u32 index;
+};
+
+/// Lowest single precision lane of a SIMD register, used by the scalar instructions
+struct SReg {
+    u32 index;
+};
+
+constexpr XReg X(u32 index) {
+    return {index};
+}
+constexpr WReg W(u32 index) {
+    return {index};
+}
+constexpr VReg V(u32 index) {
+    return {index};
+}
+constexpr SReg S(VReg reg) {
+    return {reg.index};
+}
+constexpr WReg ToW(XReg reg) {
+    return {reg.index};
+}
+
+constexpr XReg SP{31};
+constexpr XReg XZR{31};
+constexpr WReg WZR{31};
+/// Link register
+constexpr XReg LR{30};
+
+/// Argument and return registers of the AAPCS64
+constexpr XReg ABI_PARAM1{0};
+constexpr XReg ABI_PARAM2{1};
+constexpr XReg ABI_PARAM3{2};
+constexpr XReg ABI_PARAM4{3};
+constexpr XReg ABI_RETURN{0};
+
+/// Intra-procedure-call scratch register, free to use for far calls
+constexpr XReg IP0{16};
+
+enum class Cond : u32 {
+    EQ = 0,
+    NE = 1,
+    HS = 2,
+    LO = 3,
+    MI = 4,
+    PL = 5,
+    VS = 6,
+    VC = 7,
+    HI = 8,
+    LS = 9,
+    GE = 10,
+    LT = 11,
+    GT = 12,
+    LE = 13,
+};
+
+/// Position in the code, which can be used as a branch target before or after it is bound.
+/// Labels with pending branches must stay at the same address until they are bound.
+class Label {
+public:
+    bool IsBound() const {
+        return offset.has_value();
+    }
+
+private:
+    friend class CodeGenerator;
+
+    enum class FixupType {
+        Branch26,
+        Branch19,
+    };
+
+    std::optional<std::size_t> offset;
+    std::vector<std::pair<std::size_t, FixupType>> fixups;
+};
+
+/**
+ * Minimal AArch64 code emitter, covering the instructions used by the JITs in this project.
+ * Like Xbyak::CodeGenerator, it owns a fixed size block of executable memory and emitting past
+ * its end is a fatal error.
+ */
+class CodeGenerator {
+public:
+    explicit CodeGenerator(std::size_t size);
+    ~CodeGenerator();
+
+    CodeGenerator(const CodeGenerator&) = delete;
+    CodeGenerator& operator=(const CodeGenerator&) = delete;
+
+    const u8* getCode() const {
+        return code;
+    }
+    const u8* getCurr() const {
+        return code + size;
+    }
+    std::size_t getSize() const {
+        return size;
+    }
+
+    /// Address of a bound label
+    const u8* GetLabelAddress(const Label& label) const {
+        ASSERT(label.IsBound());
+        return code + *label.offset;
+    }
+
+    /// Makes everything emitted so far visible to the instruction fetch of this thread
+    void ready();
+
+    /// Binds a label to the current position and resolves the branches that refer to it
+    void L(Label& label);
+
+    void dw(u32 value);
+    void align(std::size_t alignment);
+
+    // Branches
+    void b(Label& label) {
+        EmitBranch(0x14000000, label, Label::FixupType::Branch26);
+    }
+    void bl(Label& label) {
+        EmitBranch(0x94000000, label, Label::FixupType::Branch26);
+    }
+    void b(Cond cond, Label& label) {
+        EmitBranch(0x54000000 | static_cast<u32>(cond), label, Label::FixupType::Branch19);
+    }
+    void cbz(WReg rt, Label& label) {
+        EmitBranch(0x34000000 | rt.index, label, Label::FixupType::Branch19);
+    }
+    void cbnz(WReg rt, Label& label) {
+        EmitBranch(0x35000000 | rt.index, label, Label::FixupType::Branch19);
+    }
+    void cbz(XReg rt, Label& label) {
+        EmitBranch(0xB4000000 | rt.index, label, Label::FixupType::Branch19);
+    }
+    void cbnz(XReg rt, Label& label) {
+        EmitBranch(0xB5000000 | rt.index, label, Label::FixupType::Branch19);
+    }
+    void br(XReg rn) {
+        dw(0xD61F0000 | rn.index << 5);
+    }
+    void blr(XReg rn) {
+        dw(0xD63F0000 | rn.index << 5);
+    }
+    void ret() {
+        dw(0xD65F03C0);
+    }
+
+    /// Loads an arbitrary 64-bit value with the shortest MOVZ/MOVK sequence
+    void mov(XReg rd, u64 imm);
+    void mov(WReg rd, u32 imm);
+    void mov(XReg rd, XReg rm) {
+        if (rd.index == 31 || rm.index == 31) {
+            add(rd, rm, 0); // Distinguishes SP from XZR
+        } else {
+            dw(0xAA0003E0 | rm.index << 16 | rd.index);
+        }
+    }
+    void mov(WReg rd, WReg rm) {
+        dw(0x2A0003E0 | rm.index << 16 | rd.index);
+    }
+    void movn(XReg rd, u16 imm) {
+        dw(0x92800000 | u32{imm} << 5 | rd.index);
+    }
+
+    // Integer arithmetic, the immediates are unsigned 12-bit values
+    void add(XReg rd, XReg rn, u32 imm) {
+        dw(0x91000000 | EncodeImm12(imm) | rn.index << 5 | rd.index);
+    }
+    void add(WReg rd, WReg rn, u32 imm) {
+        dw(0x11000000 | EncodeImm12(imm) | rn.index << 5 | rd.index);
+    }
+    void sub(XReg rd, XReg rn, u32 imm) {
+        dw(0xD1000000 | EncodeImm12(imm) | rn.index << 5 | rd.index);
+    }
+    void sub(WReg rd, WReg rn, u32 imm) {
+        dw(0x51000000 | EncodeImm12(imm) | rn.index << 5 | rd.index);
+    }
+    void subs(XReg rd, XReg rn, u32 imm) {
+        dw(0xF1000000 | EncodeImm12(imm) | rn.index << 5 | rd.index);
+    }
+    void subs(WReg rd, WReg rn, u32 imm) {
+        dw(0x71000000 | EncodeImm12(imm) | rn.index << 5 | rd.index);
+    }
+    void cmp(XReg rn, u32 imm) {
+        subs(XZR, rn, imm);
+    }
+    void add(XReg rd, XReg rn, XReg rm) {
+        dw(0x8B000000 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void add(WReg rd, WReg rn, WReg rm) {
+        dw(0x0B000000 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void and_(WReg rd, WReg rn, WReg rm) {
+        dw(0x0A000000 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void orr(WReg rd, WReg rn, WReg rm) {
+        dw(0x2A000000 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+
+    /**
+     * Logical operations with an immediate, limited to a single run of ones (not wrapping around),
+     * which covers the field masks the JITs need.
+     */
+    void and_(WReg rd, WReg rn, u32 imm) {
+        dw(0x12000000 | EncodeLogicalImm32(imm) | rn.index << 5 | rd.index);
+    }
+    void orr(WReg rd, WReg rn, u32 imm) {
+        dw(0x32000000 | EncodeLogicalImm32(imm) | rn.index << 5 | rd.index);
+    }
+    void eor(WReg rd, WReg rn, u32 imm) {
+        dw(0x52000000 | EncodeLogicalImm32(imm) | rn.index << 5 | rd.index);
+    }
+
+    // Bitfield moves and the shifts and extensions built on them
+    void ubfm(XReg rd, XReg rn, u32 immr, u32 imms) {
+        dw(0xD3400000 | immr << 16 | imms << 10 | rn.index << 5 | rd.index);
+    }
+    void sbfm(XReg rd, XReg rn, u32 immr, u32 imms) {
+        dw(0x93400000 | immr << 16 | imms << 10 | rn.index << 5 | rd.index);
+    }
+    void ubfm(WReg rd, WReg rn, u32 immr, u32 imms) {
+        dw(0x53000000 | immr << 16 | imms << 10 | rn.index << 5 | rd.index);
+    }
+    void sbfm(WReg rd, WReg rn, u32 immr, u32 imms) {
+        dw(0x13000000 | immr << 16 | imms << 10 | rn.index << 5 | rd.index);
+    }
+    void lsl(XReg rd, XReg rn, u32 shift) {
+        ubfm(rd, rn, (64 - shift) % 64, 63 - shift);
+    }
+    void lsr(XReg rd, XReg rn, u32 shift) {
+        ubfm(rd, rn, shift, 63);
+    }
+    void asr(XReg rd, XReg rn, u32 shift) {
+        sbfm(rd, rn, shift, 63);
+    }
+    void lsl(WReg rd, WReg rn, u32 shift) {
+        ubfm(rd, rn, (32 - shift) % 32, 31 - shift);
+    }
+    void lsr(WReg rd, WReg rn, u32 shift) {
+        ubfm(rd, rn, shift, 31);
+    }
+    void asr(WReg rd, WReg rn, u32 shift) {
+        sbfm(rd, rn, shift, 31);
+    }
+    void ubfx(XReg rd, XReg rn, u32 lsb, u32 width) {
+        ubfm(rd, rn, lsb, lsb + width - 1);
+    }
+    void ubfx(WReg rd, WReg rn, u32 lsb, u32 width) {
+        ubfm(rd, rn, lsb, lsb + width - 1);
+    }
+    void sbfiz(XReg rd, XReg rn, u32 lsb, u32 width) {
+        sbfm(rd, rn, (64 - lsb) % 64, width - 1);
+    }
+
+    // Loads and stores with an unsigned offset, scaled by the access size
+    void ldr(XReg rt, XReg rn, u32 offset) {
+        dw(0xF9400000 | EncodeScaledOffset(offset, 8) | rn.index << 5 | rt.index);
+    }
+    void str(XReg rt, XReg rn, u32 offset) {
+        dw(0xF9000000 | EncodeScaledOffset(offset, 8) | rn.index << 5 | rt.index);
+    }
+    void ldr(WReg rt, XReg rn, u32 offset) {
+        dw(0xB9400000 | EncodeScaledOffset(offset, 4) | rn.index << 5 | rt.index);
+    }
+    void str(WReg rt, XReg rn, u32 offset) {
+        dw(0xB9000000 | EncodeScaledOffset(offset, 4) | rn.index << 5 | rt.index);
+    }
+    void ldrsw(XReg rt, XReg rn, u32 offset) {
+        dw(0xB9800000 | EncodeScaledOffset(offset, 4) | rn.index << 5 | rt.index);
+    }
+    void ldrb(WReg rt, XReg rn, u32 offset) {
+        dw(0x39400000 | EncodeScaledOffset(offset, 1) | rn.index << 5 | rt.index);
+    }
+    void strb(WReg rt, XReg rn, u32 offset) {
+        dw(0x39000000 | EncodeScaledOffset(offset, 1) | rn.index << 5 | rt.index);
+    }
+    void ldr(VReg rt, XReg rn, u32 offset) {
+        dw(0x3DC00000 | EncodeScaledOffset(offset, 16) | rn.index << 5 | rt.index);
+    }
+    void str(VReg rt, XReg rn, u32 offset) {
+        dw(0x3D800000 | EncodeScaledOffset(offset, 16) | rn.index << 5 | rt.index);
+    }
+    /// Loads a single precision value placed in the code, within 1MiB of the load
+    void ldr(SReg rt, const void* literal);
+
+    // Pair and stack accesses, the offsets are signed and in bytes
+    void stp(XReg rt, XReg rt2, XReg rn, s32 offset) {
+        dw(0xA9000000 | EncodePairOffset(offset) | rt2.index << 10 | rn.index << 5 | rt.index);
+    }
+    void ldp(XReg rt, XReg rt2, XReg rn, s32 offset) {
+        dw(0xA9400000 | EncodePairOffset(offset) | rt2.index << 10 | rn.index << 5 | rt.index);
+    }
+    /// stp rt, rt2, [rn, #offset]!
+    void stp_pre(XReg rt, XReg rt2, XReg rn, s32 offset) {
+        dw(0xA9800000 | EncodePairOffset(offset) | rt2.index << 10 | rn.index << 5 | rt.index);
+    }
+    /// ldp rt, rt2, [rn], #offset
+    void ldp_post(XReg rt, XReg rt2, XReg rn, s32 offset) {
+        dw(0xA8C00000 | EncodePairOffset(offset) | rt2.index << 10 | rn.index << 5 | rt.index);
+    }
+    /// str rt, [rn, #offset]!
+    void str_pre(XReg rt, XReg rn, s32 offset) {
+        dw(0xF8000C00 | EncodeImm9(offset) | rn.index << 5 | rt.index);
+    }
+    /// ldr rt, [rn], #offset
+    void ldr_post(XReg rt, XReg rn, s32 offset) {
+        dw(0xF8400400 | EncodeImm9(offset) | rn.index << 5 | rt.index);
+    }
+
+    // Vector arithmetic on 4 single precision lanes
+    void fadd(VReg rd, VReg rn, VReg rm) {
+        dw(0x4E20D400 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void faddp(VReg rd, VReg rn, VReg rm) {
+        dw(0x6E20D400 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fmul(VReg rd, VReg rn, VReg rm) {
+        dw(0x6E20DC00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    /// Multiplication that returns +-2.0 instead of NaN for 0 * inf
+    void fmulx(VReg rd, VReg rn, VReg rm) {
+        dw(0x4E20DC00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fcmeq(VReg rd, VReg rn, VReg rm) {
+        dw(0x4E20E400 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fcmge(VReg rd, VReg rn, VReg rm) {
+        dw(0x6E20E400 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fcmgt(VReg rd, VReg rn, VReg rm) {
+        dw(0x6EA0E400 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fneg(VReg rd, VReg rn) {
+        dw(0x6EA0F800 | rn.index << 5 | rd.index);
+    }
+    void frintm(VReg rd, VReg rn) {
+        dw(0x4E219800 | rn.index << 5 | rd.index);
+    }
+    void fcvtzs(VReg rd, VReg rn) {
+        dw(0x4EA1B800 | rn.index << 5 | rd.index);
+    }
+    /// fmov rd.4s, #1.0
+    void fmov_one(VReg rd) {
+        dw(0x4F03F600 | rd.index);
+    }
+
+    // Bitwise operations on the whole register
+    void and_(VReg rd, VReg rn, VReg rm) {
+        dw(0x4E201C00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void bic(VReg rd, VReg rn, VReg rm) {
+        dw(0x4E601C00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void orr(VReg rd, VReg rn, VReg rm) {
+        dw(0x4EA01C00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void eor(VReg rd, VReg rn, VReg rm) {
+        dw(0x6E201C00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    /// Inserts the bits of rn where rm is clear
+    void bif(VReg rd, VReg rn, VReg rm) {
+        dw(0x6EE01C00 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void mvn(VReg rd, VReg rn) {
+        dw(0x6E205800 | rn.index << 5 | rd.index);
+    }
+    void mov(VReg rd, VReg rn) {
+        orr(rd, rn, rn);
+    }
+
+    // Lane moves
+    /// dup rd.4s, rn.s[lane]
+    void dup(VReg rd, VReg rn, u32 lane) {
+        dw(0x4E040400 | lane << 19 | rn.index << 5 | rd.index);
+    }
+    /// dup rd.4s, rn
+    void dup(VReg rd, WReg rn) {
+        dw(0x4E040C00 | rn.index << 5 | rd.index);
+    }
+    /// mov rd.s[lane], rn.s[src_lane]
+    void ins(VReg rd, u32 lane, VReg rn, u32 src_lane) {
+        dw(0x6E040400 | lane << 19 | src_lane << 13 | rn.index << 5 | rd.index);
+    }
+    /// mov rd, rn.d[0]
+    void umov_d0(XReg rd, VReg rn) {
+        dw(0x4E083C00 | rn.index << 5 | rd.index);
+    }
+
+    // Scalar single precision operations
+    void fadd(SReg rd, SReg rn, SReg rm) {
+        dw(0x1E202800 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fsub(SReg rd, SReg rn, SReg rm) {
+        dw(0x1E203800 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fmul(SReg rd, SReg rn, SReg rm) {
+        dw(0x1E200800 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fdiv(SReg rd, SReg rn, SReg rm) {
+        dw(0x1E201800 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fmax(SReg rd, SReg rn, SReg rm) {
+        dw(0x1E204800 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fmin(SReg rd, SReg rn, SReg rm) {
+        dw(0x1E205800 | rm.index << 16 | rn.index << 5 | rd.index);
+    }
+    void fsqrt(SReg rd, SReg rn) {
+        dw(0x1E21C000 | rn.index << 5 | rd.index);
+    }
+    void fcmp(SReg rn, SReg rm) {
+        dw(0x1E202000 | rm.index << 16 | rn.index << 5);
+    }
+    /// fcmp rn, #0.0
+    void fcmp_zero(SReg rn) {
+        dw(0x1E202008 | rn.index << 5);
+    }
+    void fmov(WReg rd, SReg rn) {
+        dw(0x1E260000 | rn.index << 5 | rd.index);
+    }
+    void fmov(SReg rd, WReg rn) {
+        dw(0x1E270000 | rn.index << 5 | rd.index);
+    }
+    void scvtf(SReg rd, WReg rn) {
+        dw(0x1E220000 | rn.index << 5 | rd.index);
+    }
+    /// Converts to an integer, rounding to nearest with ties to even
+    void fcvtns(WReg rd, SReg rn) {
+        dw(0x1E200000 | rn.index << 5 | rd.index);
+    }
+
+private:
+    void EmitBranch(u32 opcode, Label& label, Label::FixupType type);
+    void PatchBranch(std::size_t at, std::size_t target, Label::FixupType type);
+
+    static u32 EncodeImm12(u32 imm) {
+        ASSERT_MSG(imm < 0x1000, "Immediate out of range");
+        return imm << 10;
+    }
+    static u32 EncodeImm9(s32 offset) {
+        ASSERT_MSG(offset >= -256 && offset < 256, "Offset out of range");
+        return (static_cast<u32>(offset) & 0x1FF) << 12;
+    }
+    static u32 EncodeScaledOffset(u32 offset, u32 scale) {
+        ASSERT_MSG(offset % scale == 0 && offset / scale < 0x1000, "Offset out of range");
+        return offset / scale << 10;
+    }
+    static u32 EncodePairOffset(s32 offset) {
+        ASSERT_MSG(offset % 8 == 0 && offset >= -512 && offset < 512, "Offset out of range");
+        return (static_cast<u32>(offset / 8) & 0x7F) << 15;
+    }
+    static u32 EncodeLogicalImm32(u32 imm);
+
+    u8* code = nullptr;
+    std::size_t size = 0;
+    std::size_t max_size;
+};
+
+} // namespace Common::A64
@@ -7,6 +7,7 @@
 #include <array>
 #include <functional>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "common/common_types.h"
 #include "common/web_result.h"
@@ -23,6 +24,12 @@ struct Room {
         MacAddress mac_address;
         std::string game_name;
         u64 game_id;
+
+        bool operator==(const Member& other) const {
+            return std::tie(username, nickname, avatar_url, mac_address, game_name, game_id) ==
+                   std::tie(other.username, other.nickname, other.avatar_url, other.mac_address,
+                            other.game_name, other.game_id);
+        }
     };
     std::string id;
     std::string verify_UID; ///< UID used for verification
@@ -38,6 +45,15 @@ struct Room {
     u64 preferred_game_id;
 
     std::vector<Member> members;
+
+    bool operator==(const Room& other) const {
+        return std::tie(id, verify_UID, name, description, owner, ip, port, max_player,
+                        net_version, has_password, preferred_game, preferred_game_id, members) ==
+               std::tie(other.id, other.verify_UID, other.name, other.description, other.owner,
+                        other.ip, other.port, other.max_player, other.net_version,
+                        other.has_password, other.preferred_game, other.preferred_game_id,
+                        other.members);
+    }
 };
 using RoomList = std::vector<Room>;
 
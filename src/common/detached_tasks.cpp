@@ -2,9 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include <thread>
 #include "common/assert.h"
 #include "common/detached_tasks.h"
+#include "common/thread_pool.h"
 
 namespace Common {
 
@@ -27,15 +27,16 @@ DetachedTasks::~DetachedTasks() {
 }
 
 void DetachedTasks::AddTask(std::function<void()> task) {
-    std::unique_lock lock{instance->mutex};
-    ++instance->count;
-    std::thread([task{std::move(task)}]() {
+    {
+        std::unique_lock lock{instance->mutex};
+        ++instance->count;
+    }
+    ThreadPool::GetShared().Submit(TaskPriority::Background, [task{std::move(task)}]() {
         task();
         std::unique_lock lock{instance->mutex};
         --instance->count;
-        std::notify_all_at_thread_exit(instance->cv, std::move(lock));
-    })
-        .detach();
+        instance->cv.notify_all();
+    });
 }
 
 } // namespace Common
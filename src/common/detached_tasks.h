@@ -19,7 +19,8 @@ namespace Common {
  *
  * To make detached task safe, a single DetachedTasks object should be placed in the main(), and
  * call WaitForAllTasks() after all program execution but before global/static variable destruction.
- * Any potentially unsafe detached task should be executed via DetachedTasks::AddTask.
+ * Any potentially unsafe detached task should be executed via DetachedTasks::AddTask, which runs it
+ * as a background task of the shared ThreadPool.
  */
 class DetachedTasks {
 public:
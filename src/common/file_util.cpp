@@ -43,8 +43,10 @@
 #include <cstdlib>
 #include <cstring>
 #include <dirent.h>
+#include <fcntl.h>
 #include <pwd.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 #if defined(__APPLE__)
@@ -993,4 +995,67 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(Common::UTF8ToUTF16W(filename).c_str(), GENERIC_READ,
+                              FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR(Common_Filesystem, "Could not open {}", filename);
+        return;
+    }
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart != 0) {
+        // The mapping keeps the file open on its own
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+    if (!mapping) {
+        LOG_ERROR(Common_Filesystem, "Could not map {}: {}", filename, GetLastErrorMsg());
+        return;
+    }
+    data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        LOG_ERROR(Common_Filesystem, "Could not map {}: {}", filename, GetLastErrorMsg());
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return;
+    }
+    size = static_cast<u64>(file_size.QuadPart);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        LOG_ERROR(Common_Filesystem, "Could not open {}: {}", filename, GetLastErrorMsg());
+        return;
+    }
+    struct stat file_info;
+    if (fstat(fd, &file_info) == 0 && file_info.st_size != 0 &&
+        static_cast<u64>(file_info.st_size) <= std::numeric_limits<std::size_t>::max()) {
+        // The mapping keeps the file open on its own
+        void* map = mmap(nullptr, static_cast<std::size_t>(file_info.st_size), PROT_READ,
+                         MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            data = static_cast<const u8*>(map);
+            size = static_cast<u64>(file_info.st_size);
+        }
+    }
+    close(fd);
+    if (!data) {
+        LOG_ERROR(Common_Filesystem, "Could not map {}: {}", filename, GetLastErrorMsg());
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+    if (!data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(const_cast<u8*>(data), static_cast<std::size_t>(size));
+#endif
+}
+
 } // namespace FileUtil
@@ -319,6 +319,35 @@ private:
     u32 flags;
 };
 
+/**
+ * A file mapped read-only in memory, whose data is paged in by the OS as it is accessed. The
+ * mapping fails for files too large for the address space, such as big images on 32-bit systems.
+ */
+class MappedFile : public NonCopyable {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* GetData() const {
+        return data;
+    }
+
+    u64 GetSize() const {
+        return size;
+    }
+
+private:
+    const u8* data = nullptr;
+    u64 size = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
 } // namespace FileUtil
 
 // To deal with Windows being dumb at unicode:
@@ -5,15 +5,16 @@
 #include "common/common_types.h"
 #include "common/hash.h"
 
-#ifdef ARCHITECTURE_ARM64
+#if defined(ARCHITECTURE_ARM64) && defined(__ARM_FEATURE_CRC32)
 // Arm C Language Extension
 #include <arm_acle.h>
 #endif
 #include "common/cityhash.h"
+#include "common/xxh3.h"
 
 namespace Common {
-#ifdef ANDROID
-u64 ComputeHash64(const void* data, u32 len) {
+#if defined(ARCHITECTURE_ARM64) && defined(__ARM_FEATURE_CRC32)
+u64 ComputeCRC32Hash64(const void* data, u32 len) {
     const u8* p = static_cast<const u8*>(data);
     union {
         u64 crc64;
@@ -42,11 +43,12 @@ u64 ComputeHash64(const void* data, u32 len) {
         result.crc32[i & 1] = __crc32b(result.crc32[i & 1], *p);
     return result.crc64;
 }
-#else
+#endif
+
 u64 ComputeHash64(const void* data, u32 len) {
-    return CityHash64(static_cast<const char*>(data), len);
+    return XXH3Hash64(data, len);
 }
-#endif
+
 u64 TextureHash64(const void* data, u32 len) {
     return CityHash64(static_cast<const char*>(data), len);
 }
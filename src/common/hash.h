@@ -15,9 +15,15 @@ namespace Common {
  */
 u64 ComputeHash64(const void* data, u32 len);
 /**
+ * Computes the hash custom textures are named after. It stays on CityHash, unlike ComputeHash64,
+ * so that the texture packs and dumps made so far keep matching.
  * @param data Block of data to compute hash over
  * @param len Length of data (in bytes) to compute hash over
  * @returns 64-bit hash value that was computed over the data block
  */
 u64 TextureHash64(const void* data, u32 len);
+#if defined(ARCHITECTURE_ARM64) && defined(__ARM_FEATURE_CRC32)
+/// The hash ComputeHash64 used to compute on Android, from the CRC32 instructions
+u64 ComputeCRC32Hash64(const void* data, u32 len);
+#endif
 } // namespace Common
@@ -4,11 +4,18 @@
 
 #pragma once
 
+#include <cstring>
 #include <fstream>
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/scm_rev.h"
 
-// defined in Version.cpp
-extern const char* scm_rev_git_str;
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // On disk format:
 // header{
@@ -53,6 +60,18 @@ public:
         Close();
         m_num_entries = 0;
 
+#ifndef _WIN32
+        const std::streamoff valid_size = ReadMapped(filename, reader);
+        if (valid_size > 0) {
+            // append after the last good entry
+            OpenFStream(m_file, filename, ios_base::in | ios_base::out | ios_base::binary);
+            m_file.seekp(valid_size);
+            if (m_file.good()) {
+                return m_num_entries;
+            }
+            m_num_entries = 0;
+        }
+#else
         // try opening for reading/writing
         OpenFStream(m_file, filename, ios_base::in | ios_base::out | ios_base::binary);
 
@@ -98,6 +117,7 @@ public:
             delete[] value;
             return m_num_entries;
         }
+#endif
 
         // failed to open file for reading or bad header
         // close and recreate file
@@ -130,6 +150,60 @@ public:
     }
 
 private:
+#ifndef _WIN32
+    // Reads the entries straight from a read-only mapping of the file, values are handed to the
+    // reader without copying and are only byte aligned. Returns the size of the valid part of the
+    // file, or 0 if it could not be opened or the header does not match.
+    std::streamoff ReadMapped(const char* filename, LinearDiskCacheReader<K, V>& reader) {
+        const int fd = open(filename, O_RDONLY);
+        if (fd < 0) {
+            return 0;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+            close(fd);
+            return 0;
+        }
+        const std::size_t file_size = static_cast<std::size_t>(st.st_size);
+        void* base = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            return 0;
+        }
+
+        const u8* data = static_cast<const u8*>(base);
+        std::size_t offset = 0;
+        if (!std::memcmp(&m_header, data, sizeof(Header))) {
+            constexpr std::size_t entry_overhead = sizeof(u32) + sizeof(K) + sizeof(u32);
+            offset = sizeof(Header);
+            while (file_size - offset >= entry_overhead) {
+                u32 value_size;
+                std::memcpy(&value_size, data + offset, sizeof(u32));
+                const std::size_t value_bytes = static_cast<std::size_t>(value_size) * sizeof(V);
+                if (file_size - offset - entry_overhead < value_bytes) {
+                    break;
+                }
+
+                const u8* entry = data + offset + sizeof(u32);
+                K key;
+                u32 entry_number;
+                std::memcpy(&key, entry, sizeof(K));
+                std::memcpy(&entry_number, entry + sizeof(K) + value_bytes, sizeof(u32));
+                if (entry_number != m_num_entries + 1) {
+                    break;
+                }
+
+                reader.Read(key, reinterpret_cast<const V*>(entry + sizeof(K)), value_size);
+                m_num_entries++;
+                offset += entry_overhead + value_bytes;
+            }
+        }
+
+        munmap(base, file_size);
+        return static_cast<std::streamoff>(offset);
+    }
+#endif
+
     void WriteHeader() {
         Write(&m_header);
     }
@@ -153,15 +227,15 @@ private:
 
     struct Header {
         Header() : id(*(u32*)"DCAC"), key_t_size(sizeof(K)), value_t_size(sizeof(V)) {
-            memcpy(ver, scm_rev_git_str, 40);
+            std::strncpy(ver, Common::g_scm_rev, sizeof(ver));
         }
 
         const u32 id;
         const u16 key_t_size, value_t_size;
-        char ver[40];
+        char ver[40] = {};
 
     } m_header;
 
     std::fstream m_file;
-    u32 m_num_entries;
+    u32 m_num_entries = 0;
 };
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -28,6 +29,52 @@
 
 namespace Log {
 
+namespace {
+
+/// Records in the queue of each thread, when it is full the messages are formatted by the caller
+constexpr std::size_t MESSAGE_RING_SIZE = 256;
+
+/// A message whose arguments are formatted on the logging thread
+struct DeferredMessage {
+    std::chrono::microseconds timestamp;
+    const char* filename;
+    const char* function;
+    const char* format;
+    DeferredFormatter formatter;
+    unsigned int line_num;
+    Class log_class;
+    Level log_level;
+    alignas(std::max_align_t) std::array<u8, DEFERRED_ARGS_SIZE> args;
+};
+
+/// The queue of the messages of one thread, written by that thread and read by the logging thread
+struct MessageRing {
+    std::array<DeferredMessage, MESSAGE_RING_SIZE> messages;
+    std::atomic<std::size_t> write_index{0};
+    std::atomic<std::size_t> read_index{0};
+    /// Set when the thread exits, the ring is dropped once its messages are written
+    std::atomic<bool> orphaned{false};
+};
+
+int GetAndroidPriority(Level log_level) {
+    switch (log_level) {
+    case Level::Trace:
+        return ANDROID_LOG_VERBOSE;
+    case Level::Debug:
+        return ANDROID_LOG_DEBUG;
+    case Level::Info:
+        return ANDROID_LOG_INFO;
+    case Level::Warning:
+        return ANDROID_LOG_WARN;
+    case Level::Error:
+        return ANDROID_LOG_ERROR;
+    default:
+        return ANDROID_LOG_FATAL;
+    }
+}
+
+} // Anonymous namespace
+
 /**
  * Static state as a singleton.
  */
@@ -45,6 +92,39 @@ public:
                    const char* function, std::string message) {
         message_queue.Push(
             CreateEntry(log_class, log_level, filename, line_num, function, std::move(message)));
+        WakeBackend();
+    }
+
+    DeferredMessage* AcquireMessage(MessageRing& ring) const {
+        const std::size_t write_index = ring.write_index.load(std::memory_order_relaxed);
+        if (write_index - ring.read_index.load(std::memory_order_acquire) == MESSAGE_RING_SIZE) {
+            return nullptr;
+        }
+        DeferredMessage& message = ring.messages[write_index % MESSAGE_RING_SIZE];
+        message.timestamp = GetTimestamp();
+        return &message;
+    }
+
+    void CommitMessage(MessageRing& ring) {
+        ring.write_index.fetch_add(1, std::memory_order_release);
+        WakeBackend();
+    }
+
+    /// Returns the ring of the calling thread, created on its first message
+    MessageRing& GetThreadRing() {
+        struct ThreadRing {
+            std::shared_ptr<MessageRing> ring;
+            ~ThreadRing() {
+                ring->orphaned.store(true, std::memory_order_release);
+            }
+        };
+        thread_local const ThreadRing thread_ring = [this] {
+            auto ring = std::make_shared<MessageRing>();
+            std::lock_guard lock{rings_mutex};
+            rings.push_back(ring);
+            return ThreadRing{std::move(ring)};
+        }();
+        return *thread_ring.ring;
     }
 
     void AddBackend(std::unique_ptr<Backend> backend) {
@@ -80,46 +160,105 @@ public:
 private:
     Impl() {
         backend_thread = std::thread([&] {
-            Entry entry;
-            auto write_logs = [&](Entry& e) {
+            std::vector<Entry> entries;
+            auto write_logs = [&] {
+                // Each thread has its own queue, the timestamps put their messages back in order
+                std::stable_sort(entries.begin(), entries.end(),
+                                 [](const Entry& a, const Entry& b) {
+                                     return a.timestamp < b.timestamp;
+                                 });
                 std::lock_guard lock{writing_mutex};
-                for (const auto& backend : backends) {
-                    backend->Write(e);
+                for (const auto& entry : entries) {
+                    __android_log_print(GetAndroidPriority(entry.log_level), "citra", "%s",
+                                        entry.message.c_str());
+                    for (const auto& backend : backends) {
+                        backend->Write(entry);
+                    }
                 }
+                entries.clear();
             };
-            while (true) {
-                entry = message_queue.PopWait();
-                if (entry.final_entry) {
-                    break;
+            while (!stop_requested.load(std::memory_order_acquire)) {
+                CollectEntries(entries);
+                if (!entries.empty()) {
+                    write_logs();
+                    continue;
                 }
-                write_logs(entry);
+                // Producers don't take the mutex, a missed wakeup only delays the messages
+                std::unique_lock lock{wakeup_mutex};
+                backend_sleeping.store(true, std::memory_order_seq_cst);
+                wakeup_cv.wait_for(lock, IDLE_WAIT);
+                backend_sleeping.store(false, std::memory_order_relaxed);
             }
 
             // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a case
             // where a system is repeatedly spamming logs even on close.
-            constexpr int MAX_LOGS_TO_WRITE = 100;
-            int logs_written = 0;
-            while (logs_written++ < MAX_LOGS_TO_WRITE && message_queue.Pop(entry)) {
-                write_logs(entry);
+            CollectEntries(entries);
+            constexpr std::size_t MAX_LOGS_TO_WRITE = 100;
+            if (entries.size() > MAX_LOGS_TO_WRITE) {
+                entries.resize(MAX_LOGS_TO_WRITE);
             }
+            write_logs();
         });
     }
 
     ~Impl() {
-        Entry entry;
-        entry.final_entry = true;
-        message_queue.Push(entry);
+        stop_requested.store(true, std::memory_order_release);
+        {
+            std::lock_guard lock{wakeup_mutex};
+            wakeup_cv.notify_one();
+        }
         backend_thread.join();
     }
 
+    /// How long the logging thread sleeps when no wakeup comes
+    static constexpr std::chrono::milliseconds IDLE_WAIT{10};
+
+    void WakeBackend() {
+        if (backend_sleeping.load(std::memory_order_seq_cst)) {
+            wakeup_cv.notify_one();
+        }
+    }
+
+    /// Formats the messages of the thread rings and takes the preformatted ones, on the logging
+    /// thread
+    void CollectEntries(std::vector<Entry>& entries) {
+        Entry entry;
+        while (message_queue.Pop(entry)) {
+            entries.push_back(std::move(entry));
+        }
+
+        std::lock_guard lock{rings_mutex};
+        for (auto it = rings.begin(); it != rings.end();) {
+            MessageRing& ring = **it;
+            // Read before the messages, so that none written before the thread exited is missed
+            const bool orphaned = ring.orphaned.load(std::memory_order_acquire);
+            std::size_t read_index = ring.read_index.load(std::memory_order_relaxed);
+            const std::size_t write_index = ring.write_index.load(std::memory_order_acquire);
+            for (; read_index != write_index; ++read_index) {
+                const DeferredMessage& message = ring.messages[read_index % MESSAGE_RING_SIZE];
+                Entry& formatted = entries.emplace_back();
+                formatted.timestamp = message.timestamp;
+                formatted.log_class = message.log_class;
+                formatted.log_level = message.log_level;
+                formatted.filename = message.filename;
+                formatted.line_num = message.line_num;
+                formatted.function = message.function;
+                formatted.message = message.formatter(message.format, message.args.data());
+            }
+            ring.read_index.store(read_index, std::memory_order_release);
+            it = orphaned ? rings.erase(it) : it + 1;
+        }
+    }
+
+    std::chrono::microseconds GetTimestamp() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - time_origin);
+    }
+
     Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                       const char* function, std::string message) const {
-        using std::chrono::duration_cast;
-        using std::chrono::steady_clock;
-
         Entry entry;
-        entry.timestamp =
-            duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+        entry.timestamp = GetTimestamp();
         entry.log_class = log_class;
         entry.log_level = log_level;
         entry.filename = filename;
@@ -133,7 +272,14 @@ private:
     std::mutex writing_mutex;
     std::thread backend_thread;
     std::vector<std::unique_ptr<Backend>> backends;
+    /// Messages formatted by their thread, because of their arguments or a full ring
     Common::MPSCQueue<Log::Entry> message_queue;
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<MessageRing>> rings;
+    std::mutex wakeup_mutex;
+    std::condition_variable wakeup_cv;
+    std::atomic<bool> backend_sleeping{false};
+    std::atomic<bool> stop_requested{false};
     Filter filter;
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
 };
@@ -293,17 +439,38 @@ Backend* GetBackend(std::string_view backend_name) {
     return Impl::Instance().GetBackend(backend_name);
 }
 
+bool CheckLogFilter(Class log_class, Level log_level) {
+    return Impl::Instance().GetGlobalFilter().CheckMessage(log_class, log_level);
+}
+
+void* AcquireDeferredMessage(Class log_class, Level log_level, const char* filename,
+                             unsigned int line_num, const char* function, const char* format,
+                             DeferredFormatter formatter) {
+    auto& instance = Impl::Instance();
+    DeferredMessage* message = instance.AcquireMessage(instance.GetThreadRing());
+    if (!message) {
+        return nullptr;
+    }
+    message->log_class = log_class;
+    message->log_level = log_level;
+    message->filename = filename;
+    message->line_num = line_num;
+    message->function = function;
+    message->format = format;
+    message->formatter = formatter;
+    return message->args.data();
+}
+
+void CommitDeferredMessage() {
+    auto& instance = Impl::Instance();
+    instance.CommitMessage(instance.GetThreadRing());
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
-    // auto& instance = Impl::Instance();
-    // const auto& filter = instance.GetGlobalFilter();
-    // if (!filter.CheckMessage(log_class, log_level))
-    //    return;
-
-    __android_log_print(ANDROID_LOG_INFO, "citra", "%s", fmt::vformat(format, args).c_str());
-    // instance.PushEntry(log_class, log_level, filename, line_num, function,
-    //                   fmt::vformat(format, args));
+    Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
+                               fmt::vformat(format, args));
 }
 
 int64_t GetTimeNsec() {
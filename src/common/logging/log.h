@@ -4,6 +4,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
 #include <fmt/format.h>
 #include "common/common_types.h"
 
@@ -113,7 +118,40 @@ enum class Class : ClassType {
     Count              ///< Total number of logging classes
 };
 
-/// Logs a message to the global logger, using fmt
+/// Space in the record of a message for the arguments formatted on the logging thread
+constexpr std::size_t DEFERRED_ARGS_SIZE = 64;
+
+/// Formats the arguments a message left in its record
+using DeferredFormatter = std::string (*)(const char* format, const void* args);
+
+/// Arguments that are copied as they are into the record, instead of formatted by the caller
+template <typename... Args>
+constexpr bool IsDeferrable = sizeof(std::tuple<Args...>) <= DEFERRED_ARGS_SIZE &&
+                              alignof(std::tuple<Args...>) <= alignof(std::max_align_t) &&
+                              (... && (std::is_arithmetic_v<Args> || std::is_enum_v<Args>));
+
+template <typename... Args>
+std::string FormatDeferred(const char* format, const void* args) {
+    return std::apply(
+        [format](const Args&... values) {
+            return fmt::vformat(format, fmt::make_format_args(values...));
+        },
+        *static_cast<const std::tuple<Args...>*>(args));
+}
+
+/// Returns true if the global filter lets the messages of the class and level through
+bool CheckLogFilter(Class log_class, Level log_level);
+
+/**
+ * Takes the next record of the queue of the calling thread and returns where the arguments go,
+ * or nullptr when the queue is full. CommitDeferredMessage hands the record to the logging thread.
+ */
+void* AcquireDeferredMessage(Class log_class, Level log_level, const char* filename,
+                             unsigned int line_num, const char* function, const char* format,
+                             DeferredFormatter formatter);
+void CommitDeferredMessage();
+
+/// Logs a message to the global logger, using fmt. The caller checks the filter.
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
@@ -121,6 +159,18 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if (!CheckLogFilter(log_class, log_level)) {
+        return;
+    }
+    if constexpr (IsDeferrable<Args...>) {
+        void* storage = AcquireDeferredMessage(log_class, log_level, filename, line_num, function,
+                                               format, &FormatDeferred<Args...>);
+        if (storage) {
+            new (storage) std::tuple<Args...>(args...);
+            CommitDeferredMessage();
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -157,20 +207,3 @@ int64_t GetTimeNsec();
 #define LOG_CRITICAL(log_class, ...)                                                               \
     ::Log::FmtLogMessage(::Log::Class::log_class, ::Log::Level::Critical,                          \
                          ::Log::TrimSourcePath(__FILE__), __LINE__, __func__, __VA_ARGS__)
-
-
-#ifdef ANDROID
-#undef LOG_GENERIC
-#undef LOG_DEBUG
-#undef LOG_INFO
-#undef LOG_WARNING
-#undef LOG_ERROR
-#undef LOG_CRITICAL
-
-#define LOG_GENERIC(...) (void(0))
-#define LOG_DEBUG(...) (void(0))
-#define LOG_INFO(...) (void(0))
-#define LOG_WARNING(...) (void(0))
-#define LOG_ERROR(...) (void(0))
-#define LOG_CRITICAL(...) (void(0))
-#endif
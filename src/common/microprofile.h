@@ -21,9 +21,38 @@ typedef void* HANDLE;
 #endif
 
 #include <microprofile.h>
+#include "common/profile_trace.h"
 
 #define MP_RGB(r, g, b) ((r) << 16 | (g) << 8 | (b) << 0)
 
+// Every scope is also handed to Common::ProfileTrace, which works whether MicroProfile is enabled
+// or not.
+#undef MICROPROFILE_DECLARE
+#undef MICROPROFILE_DEFINE
+#undef MICROPROFILE_SCOPE
+
+#define PROFILE_TRACE_PASTE0(a, b) a##b
+#define PROFILE_TRACE_PASTE(a, b) PROFILE_TRACE_PASTE0(a, b)
+
+#if MICROPROFILE_ENABLED
+#define MICROPROFILE_DECLARE(var)                                                                  \
+    extern MicroProfileToken g_mp_##var;                                                           \
+    extern Common::ProfileTrace::Category g_trace_##var
+#define MICROPROFILE_DEFINE(var, group, name, color)                                               \
+    MicroProfileToken g_mp_##var =                                                                 \
+        MicroProfileGetToken(group, name, color, MicroProfileTokenTypeCpu);                        \
+    Common::ProfileTrace::Category g_trace_##var{group, name}
+#define MICROPROFILE_SCOPE(var)                                                                    \
+    MicroProfileScopeHandler PROFILE_TRACE_PASTE(foo, __LINE__)(g_mp_##var);                       \
+    Common::ProfileTrace::ScopeHandler PROFILE_TRACE_PASTE(trace_scope, __LINE__)(g_trace_##var)
+#else
+#define MICROPROFILE_DECLARE(var) extern Common::ProfileTrace::Category g_trace_##var
+#define MICROPROFILE_DEFINE(var, group, name, color)                                               \
+    Common::ProfileTrace::Category g_trace_##var{group, name}
+#define MICROPROFILE_SCOPE(var)                                                                    \
+    Common::ProfileTrace::ScopeHandler PROFILE_TRACE_PASTE(trace_scope, __LINE__)(g_trace_##var)
+#endif
+
 // On OS X, some Mach header included by MicroProfile defines these as macros, conflicting with
 // identifiers we use.
 #ifdef PAGE_SIZE
@@ -0,0 +1,222 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/profile_trace.h"
+#include "common/thread.h"
+
+namespace Common::ProfileTrace {
+
+std::atomic<bool> g_tracing{false};
+
+namespace {
+
+struct Event {
+    const Category* category;
+    s64 begin;
+    s64 end;
+};
+
+/// Events of one thread, the writer swaps them out so that the thread rarely waits for the mutex
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::string name;
+    u32 id = 0;
+    bool name_written = false;
+};
+
+/// The writer flushes the buffers this often, which bounds the memory a busy thread fills
+constexpr std::chrono::milliseconds FlushInterval{100};
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+u32 next_thread_id = 1;
+
+/// Serializes Start and Stop, session_mutex guards the file shared with the writer thread
+std::mutex control_mutex;
+std::mutex session_mutex;
+FileUtil::IOFile file;
+std::thread writer;
+Common::Event stop_event;
+s64 session_begin = 0;
+bool first_event = true;
+
+ThreadBuffer& GetThreadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto new_buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard lock{registry_mutex};
+        new_buffer->id = next_thread_id++;
+        registry.push_back(new_buffer);
+        return new_buffer;
+    }();
+    return *buffer;
+}
+
+void AppendEscaped(std::string& out, const char* str) {
+    for (; *str != '\0'; ++str) {
+        if (*str == '"' || *str == '\\') {
+            out += '\\';
+        }
+        out += *str;
+    }
+}
+
+void AppendSeparator(std::string& out) {
+    if (!first_event) {
+        out += ",\n";
+    }
+    first_event = false;
+}
+
+/// Writes the queued events of every thread, must be called with session_mutex held
+void Flush() {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard lock{registry_mutex};
+        buffers = registry;
+    }
+
+    std::string out;
+    std::vector<Event> events;
+    for (const auto& buffer : buffers) {
+        std::string name;
+        {
+            std::lock_guard lock{buffer->mutex};
+            events.swap(buffer->events);
+            if (!buffer->name_written && !buffer->name.empty()) {
+                name = buffer->name;
+                buffer->name_written = true;
+            }
+        }
+
+        if (!name.empty()) {
+            AppendSeparator(out);
+            out += fmt::format(
+                R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":")",
+                buffer->id);
+            AppendEscaped(out, name.c_str());
+            out += "\"}}";
+        }
+        for (const Event& event : events) {
+            // Scopes entered before the trace started belong to no session
+            if (event.begin < session_begin) {
+                continue;
+            }
+            AppendSeparator(out);
+            out += R"({"name":")";
+            AppendEscaped(out, event.category->name);
+            out += R"(","cat":")";
+            AppendEscaped(out, event.category->group);
+            out += fmt::format(R"(","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                               buffer->id, (event.begin - session_begin) / 1000.0,
+                               (event.end - event.begin) / 1000.0);
+        }
+        events.clear();
+    }
+
+    if (!out.empty()) {
+        file.WriteString(out);
+        file.Flush();
+    }
+
+    // The buffers of threads that exited are only referenced by the registry and this copy
+    std::lock_guard lock{registry_mutex};
+    buffers.clear();
+    registry.erase(std::remove_if(registry.begin(), registry.end(),
+                                  [](const auto& buffer) { return buffer.use_count() == 1; }),
+                   registry.end());
+}
+
+void WriterLoop() {
+    Common::SetCurrentThreadName("ProfileTraceWriter");
+    while (!stop_event.WaitUntil(std::chrono::steady_clock::now() + FlushInterval)) {
+        std::lock_guard lock{session_mutex};
+        Flush();
+    }
+}
+
+} // Anonymous namespace
+
+bool Start(const std::string& path) {
+    std::lock_guard control_lock{control_mutex};
+    std::lock_guard lock{session_mutex};
+    if (IsTracing()) {
+        return true;
+    }
+
+    file = FileUtil::IOFile(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Common, "Could not open the profile trace {}", path);
+        return false;
+    }
+    // The closing bracket of the array format is optional, so a trace cut short stays readable
+    file.WriteString("[\n");
+    first_event = true;
+    session_begin = Now();
+    {
+        std::lock_guard registry_lock{registry_mutex};
+        for (const auto& buffer : registry) {
+            std::lock_guard buffer_lock{buffer->mutex};
+            buffer->events.clear();
+            buffer->name_written = false;
+        }
+    }
+
+    stop_event.Reset();
+    writer = std::thread(WriterLoop);
+    g_tracing.store(true, std::memory_order_relaxed);
+    LOG_INFO(Common, "Writing a profile trace to {}", path);
+    return true;
+}
+
+void Stop() {
+    std::lock_guard control_lock{control_mutex};
+    if (!g_tracing.exchange(false, std::memory_order_relaxed)) {
+        return;
+    }
+    stop_event.Set();
+    writer.join();
+
+    std::lock_guard lock{session_mutex};
+    Flush();
+    file.WriteString("\n]\n");
+    file.Close();
+    LOG_INFO(Common, "Stopped the profile trace");
+}
+
+bool Toggle() {
+    if (IsTracing()) {
+        Stop();
+        return false;
+    }
+    const std::string path = fmt::format("{}profile_trace_{}.json",
+                                         FileUtil::GetUserPath(FileUtil::UserPath::LogDir),
+                                         std::time(nullptr));
+    FileUtil::CreateFullPath(path);
+    return Start(path);
+}
+
+void SetThreadName(const char* name) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard lock{buffer.mutex};
+    buffer.name = name;
+    buffer.name_written = false;
+}
+
+void RecordScope(const Category& category, s64 begin, s64 end) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard lock{buffer.mutex};
+    buffer.events.push_back({&category, begin, end});
+}
+
+} // namespace Common::ProfileTrace
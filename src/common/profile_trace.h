@@ -0,0 +1,76 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "common/common_types.h"
+
+/**
+ * Streams the MicroProfile scopes of every thread into a Chrome trace file (the JSON array format
+ * read by chrome://tracing and ui.perfetto.dev), so that sessions can be analyzed offline on
+ * platforms without the MicroProfile widget. The scopes only cost a relaxed load while no trace
+ * is being written.
+ */
+namespace Common::ProfileTrace {
+
+/// Group and name of a scope, defined next to its MicroProfile token by MICROPROFILE_DEFINE
+struct Category {
+    const char* group;
+    const char* name;
+};
+
+extern std::atomic<bool> g_tracing;
+
+inline bool IsTracing() {
+    return g_tracing.load(std::memory_order_relaxed);
+}
+
+/// Starts writing the scopes to the given file, returns false if it could not be opened
+bool Start(const std::string& path);
+
+/// Stops the trace and closes its file
+void Stop();
+
+/// Starts a trace in the log directory if none is running and stops it otherwise
+bool Toggle();
+
+/// Names the calling thread in the traces, called by Common::SetCurrentThreadName
+void SetThreadName(const char* name);
+
+/// Queues a complete event, times are in nanoseconds of the steady clock
+void RecordScope(const Category& category, s64 begin, s64 end);
+
+inline s64 Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+class ScopeHandler {
+public:
+    explicit ScopeHandler(const Category& category_) {
+        if (IsTracing()) {
+            category = &category_;
+            begin = Now();
+        }
+    }
+
+    ~ScopeHandler() {
+        if (category) {
+            RecordScope(*category, begin, Now());
+        }
+    }
+
+    ScopeHandler(const ScopeHandler&) = delete;
+    ScopeHandler& operator=(const ScopeHandler&) = delete;
+
+private:
+    const Category* category = nullptr;
+    s64 begin = 0;
+};
+
+} // namespace Common::ProfileTrace
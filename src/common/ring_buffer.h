@@ -90,6 +90,16 @@ public:
         return out;
     }
 
+    /// Drops the oldest slots of the ring buffer, to be called from the consumer side
+    /// @param max_slots  Maximum number of slots to drop
+    /// @returns The number of slots actually dropped
+    std::size_t Discard(std::size_t max_slots) {
+        const std::size_t read_index = m_read_index.load();
+        const std::size_t discard_count = std::min(m_write_index.load() - read_index, max_slots);
+        m_read_index.store(read_index + discard_count);
+        return discard_count;
+    }
+
     /// @returns Number of slots used
     std::size_t Size() const {
         return m_write_index.load() - m_read_index.load();
@@ -0,0 +1,76 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Hands a small value from one writer thread to any number of reader threads without a lock. The
+ * writer never waits, a reader that raced with a write reads the value again. The value is kept in
+ * atomic words, so a torn read is thrown away rather than being a data race.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+    static_assert(std::is_default_constructible_v<T>, "T must be default constructible");
+
+public:
+    SeqLock() {
+        Store(T{});
+    }
+
+    explicit SeqLock(const T& value) {
+        Store(value);
+    }
+
+    /// Publishes a new value, must only be called from one thread at a time
+    void Store(const T& value) {
+        std::array<u32, NUM_WORDS> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const u32 seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+            data[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Returns the last value that was completely stored
+    T Load() const {
+        std::array<u32, NUM_WORDS> words;
+        u32 seq_before;
+        u32 seq_after;
+        do {
+            seq_before = sequence.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+                words[i] = data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            seq_after = sequence.load(std::memory_order_relaxed);
+        } while ((seq_before & 1) != 0 || seq_before != seq_after);
+
+        T value;
+        std::memcpy(&value, words.data(), sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr std::size_t NUM_WORDS = (sizeof(T) + sizeof(u32) - 1) / sizeof(u32);
+
+    /// Odd while a write is in progress
+    std::atomic<u32> sequence{0};
+    std::array<std::atomic<u32>, NUM_WORDS> data{};
+};
+
+} // namespace Common
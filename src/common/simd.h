@@ -0,0 +1,169 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
+#include <cstring>
+#include "common/common_types.h"
+
+/**
+ * 128-bit vector helpers shared by the SIMD paths of the emulator, on top of SSE2 on x86_64 and
+ * NEON on ARM64. Both are part of the baseline of their architecture, so the code using them needs
+ * no runtime feature detection. Other architectures don't define HAVE_COMMON_SIMD and keep to the
+ * scalar paths.
+ */
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+#define HAVE_COMMON_SIMD
+
+namespace Common::SIMD {
+
+#if defined(ARCHITECTURE_x86_64)
+/// Sixteen bytes
+using Vec = __m128i;
+
+inline Vec Load(const u8* src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+inline void Store(u8* dst, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+}
+
+/// Reverses the byte order of each 32-bit lane
+inline Vec ByteSwap32(Vec v) {
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)),
+                               _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+/// Four floats
+using VecF = __m128;
+
+inline VecF LoadF(const float* src) {
+    return _mm_loadu_ps(src);
+}
+
+inline VecF SetF(float value) {
+    return _mm_set1_ps(value);
+}
+
+inline VecF Add(VecF a, VecF b) {
+    return _mm_add_ps(a, b);
+}
+
+inline VecF Sub(VecF a, VecF b) {
+    return _mm_sub_ps(a, b);
+}
+
+inline VecF Mul(VecF a, VecF b) {
+    return _mm_mul_ps(a, b);
+}
+
+/// Truncates each lane towards zero and stores it saturated to s16
+inline void StoreS16(s16* dst, VecF v) {
+    const __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(v), _mm_setzero_si128());
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), packed);
+}
+
+/// Loads two s16 as the floats of lanes 0 and 2, and 1 and 3
+inline VecF LoadS16PairTwice(const s16* src) {
+    s32 pair;
+    std::memcpy(&pair, src, sizeof(pair));
+    const __m128i v = _mm_set1_epi32(pair);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+/// Four s32
+using VecI32 = __m128i;
+
+inline VecI32 LoadI32(const s32* src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+inline void StoreI32(s32* dst, VecI32 v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+}
+
+inline VecI32 AddI32(VecI32 a, VecI32 b) {
+    return _mm_add_epi32(a, b);
+}
+
+/// Truncates each lane towards zero
+inline VecI32 TruncateToI32(VecF v) {
+    return _mm_cvttps_epi32(v);
+}
+#else
+using Vec = uint8x16_t;
+
+inline Vec Load(const u8* src) {
+    return vld1q_u8(src);
+}
+
+inline void Store(u8* dst, Vec v) {
+    vst1q_u8(dst, v);
+}
+
+inline Vec ByteSwap32(Vec v) {
+    return vrev32q_u8(v);
+}
+
+using VecF = float32x4_t;
+
+inline VecF LoadF(const float* src) {
+    return vld1q_f32(src);
+}
+
+inline VecF SetF(float value) {
+    return vdupq_n_f32(value);
+}
+
+inline VecF Add(VecF a, VecF b) {
+    return vaddq_f32(a, b);
+}
+
+inline VecF Sub(VecF a, VecF b) {
+    return vsubq_f32(a, b);
+}
+
+inline VecF Mul(VecF a, VecF b) {
+    return vmulq_f32(a, b);
+}
+
+inline void StoreS16(s16* dst, VecF v) {
+    vst1_s16(dst, vqmovn_s32(vcvtq_s32_f32(v)));
+}
+
+inline VecF LoadS16PairTwice(const s16* src) {
+    u32 pair;
+    std::memcpy(&pair, src, sizeof(pair));
+    return vcvtq_f32_s32(vmovl_s16(vreinterpret_s16_u32(vdup_n_u32(pair))));
+}
+
+using VecI32 = int32x4_t;
+
+inline VecI32 LoadI32(const s32* src) {
+    return vld1q_s32(src);
+}
+
+inline void StoreI32(s32* dst, VecI32 v) {
+    vst1q_s32(dst, v);
+}
+
+inline VecI32 AddI32(VecI32 a, VecI32 b) {
+    return vaddq_s32(a, b);
+}
+
+inline VecI32 TruncateToI32(VecF v) {
+    return vcvtq_s32_f32(v);
+}
+#endif
+
+} // namespace Common::SIMD
+
+#endif
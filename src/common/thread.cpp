@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "common/profile_trace.h"
 #include "common/thread.h"
 #ifdef __APPLE__
 #include <mach/mach.h>
+#include <pthread.h>
 #elif defined(_WIN32)
 #include <windows.h>
 #else
@@ -18,6 +20,17 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#ifdef __linux__
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+#ifdef __ANDROID__
+#include <dlfcn.h>
+#endif
 
 #ifdef __FreeBSD__
 #define cpu_set_t cpuset_t
@@ -31,6 +44,7 @@ namespace Common {
 // Uses trick documented in:
 // https://docs.microsoft.com/en-us/visualstudio/debugger/how-to-set-a-thread-name-in-native-code
 void SetCurrentThreadName(const char* name) {
+    ProfileTrace::SetThreadName(name);
     static const DWORD MS_VC_EXCEPTION = 0x406D1388;
 
 #pragma pack(push, 8)
@@ -58,6 +72,7 @@ void SetCurrentThreadName(const char* name) {
 // MinGW with the POSIX threading model does not support pthread_setname_np
 #if !defined(_WIN32) || defined(_MSC_VER)
 void SetCurrentThreadName(const char* name) {
+    ProfileTrace::SetThreadName(name);
 #ifdef __APPLE__
     pthread_setname_np(name);
 #elif defined(__Bitrig__) || defined(__DragonFly__) || defined(__FreeBSD__) || defined(__OpenBSD__)
@@ -72,4 +87,205 @@ void SetCurrentThreadName(const char* name) {
 
 #endif
 
+void SetCurrentThreadPriority(ThreadPriority priority) {
+#ifdef _WIN32
+    static constexpr int priorities[] = {THREAD_PRIORITY_LOWEST, THREAD_PRIORITY_NORMAL,
+                                         THREAD_PRIORITY_ABOVE_NORMAL};
+    SetThreadPriority(GetCurrentThread(), priorities[static_cast<int>(priority)]);
+#elif defined(__APPLE__)
+    // The QoS class also steers the thread between the performance and efficiency cores
+    static constexpr qos_class_t classes[] = {QOS_CLASS_BACKGROUND, QOS_CLASS_DEFAULT,
+                                              QOS_CLASS_USER_INTERACTIVE};
+    pthread_set_qos_class_self_np(classes[static_cast<int>(priority)], 0);
+#elif defined(__linux__)
+    // Unlike POSIX, Linux and so Android keep a nice value per thread. Desktop Linux needs
+    // CAP_SYS_NICE for negative values, without it the call fails and the thread stays at 0.
+    static constexpr int nice_values[] = {10, 0, -4};
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)),
+                nice_values[static_cast<int>(priority)]);
+#endif
+}
+
+void SetCurrentThreadLowPriority() {
+    SetCurrentThreadPriority(ThreadPriority::Low);
+}
+
+#ifdef __linux__
+/// Returns the cores faster than the slowest cluster, or nothing if all of them are alike
+static std::vector<int> FindBigCores() {
+    const long num_cores = sysconf(_SC_NPROCESSORS_CONF);
+    std::vector<std::pair<int, long>> max_freqs;
+    for (int core = 0; core < num_cores; ++core) {
+        // Cores that are offline have no cpufreq node, they are left out of the set
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(core) +
+                           "/cpufreq/cpuinfo_max_freq");
+        long freq = 0;
+        if (file >> freq) {
+            max_freqs.emplace_back(core, freq);
+        }
+    }
+    if (max_freqs.empty()) {
+        return {};
+    }
+
+    long slowest = max_freqs[0].second;
+    for (const auto& [core, freq] : max_freqs) {
+        slowest = std::min(slowest, freq);
+    }
+    std::vector<int> big_cores;
+    for (const auto& [core, freq] : max_freqs) {
+        if (freq > slowest) {
+            big_cores.push_back(core);
+        }
+    }
+    return big_cores;
+}
+#endif
+
+void SetCurrentThreadBigCoreAffinity() {
+#ifdef __linux__
+    static const std::vector<int> big_cores = FindBigCores();
+    if (big_cores.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core : big_cores) {
+        CPU_SET(core, &set);
+    }
+    // On Linux, pid 0 is the calling thread rather than its whole process
+    sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
+#ifdef __ANDROID__
+namespace {
+
+struct APerformanceHintManager;
+struct APerformanceHintSession;
+
+/**
+ * Performance hint session of the frame critical threads. The NDK API only exists from Android 13
+ * on, so it is looked up at run time and older versions keep working without hints.
+ */
+class FrameHint {
+public:
+    static FrameHint& Instance() {
+        static FrameHint hint;
+        return hint;
+    }
+
+    void AddThread(pid_t tid) {
+        std::lock_guard lock{mutex};
+        tids.push_back(static_cast<int32_t>(tid));
+        threads_changed = true;
+    }
+
+    void RemoveThread(pid_t tid) {
+        std::lock_guard lock{mutex};
+        tids.erase(std::remove(tids.begin(), tids.end(), static_cast<int32_t>(tid)), tids.end());
+        threads_changed = true;
+    }
+
+    void Report(s64 actual_ns, s64 target_ns) {
+        std::lock_guard lock{mutex};
+        if (manager == nullptr || actual_ns <= 0 || target_ns <= 0) {
+            return;
+        }
+        // A session keeps the threads it was created with, so it is replaced when they change
+        if (threads_changed) {
+            threads_changed = false;
+            if (session != nullptr) {
+                close_session(session);
+                session = nullptr;
+            }
+            if (!tids.empty()) {
+                session = create_session(manager, tids.data(), tids.size(), target_ns);
+                session_target_ns = target_ns;
+            }
+        }
+        if (session == nullptr) {
+            return;
+        }
+        if (target_ns != session_target_ns) {
+            update_target(session, target_ns);
+            session_target_ns = target_ns;
+        }
+        report_actual(session, actual_ns);
+    }
+
+private:
+    FrameHint() {
+        void* library = dlopen("libandroid.so", RTLD_NOW);
+        if (library == nullptr) {
+            return;
+        }
+        auto get_manager = reinterpret_cast<APerformanceHintManager* (*)()>(
+            dlsym(library, "APerformanceHint_getManager"));
+        create_session = reinterpret_cast<decltype(create_session)>(
+            dlsym(library, "APerformanceHint_createSession"));
+        update_target = reinterpret_cast<decltype(update_target)>(
+            dlsym(library, "APerformanceHint_updateTargetWorkDuration"));
+        report_actual = reinterpret_cast<decltype(report_actual)>(
+            dlsym(library, "APerformanceHint_reportActualWorkDuration"));
+        close_session = reinterpret_cast<decltype(close_session)>(
+            dlsym(library, "APerformanceHint_closeSession"));
+        if (get_manager && create_session && update_target && report_actual && close_session) {
+            manager = get_manager();
+        }
+    }
+
+    APerformanceHintSession* (*create_session)(APerformanceHintManager*, const int32_t*, size_t,
+                                               int64_t) = nullptr;
+    int (*update_target)(APerformanceHintSession*, int64_t) = nullptr;
+    int (*report_actual)(APerformanceHintSession*, int64_t) = nullptr;
+    void (*close_session)(APerformanceHintSession*) = nullptr;
+
+    std::mutex mutex;
+    APerformanceHintManager* manager = nullptr;
+    APerformanceHintSession* session = nullptr;
+    s64 session_target_ns = 0;
+    std::vector<int32_t> tids;
+    bool threads_changed = false;
+};
+
+/// Takes its thread out of the hint session when the thread exits
+struct FrameHintThread {
+    ~FrameHintThread() {
+        if (tid != 0) {
+            FrameHint::Instance().RemoveThread(tid);
+        }
+    }
+
+    pid_t tid = 0;
+};
+
+thread_local FrameHintThread frame_hint_thread;
+
+} // Anonymous namespace
+#endif
+
+void SetCurrentThreadFrameCritical() {
+    static thread_local bool is_frame_critical = false;
+    if (is_frame_critical) {
+        return;
+    }
+    is_frame_critical = true;
+
+    SetCurrentThreadPriority(ThreadPriority::High);
+    SetCurrentThreadBigCoreAffinity();
+#ifdef __ANDROID__
+    if (frame_hint_thread.tid == 0) {
+        frame_hint_thread.tid = static_cast<pid_t>(syscall(SYS_gettid));
+        FrameHint::Instance().AddThread(frame_hint_thread.tid);
+    }
+#endif
+}
+
+void ReportFrameWorkDuration(s64 actual_ns, s64 target_ns) {
+#ifdef __ANDROID__
+    FrameHint::Instance().Report(actual_ns, target_ns);
+#endif
+}
+
 } // namespace Common
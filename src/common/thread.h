@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <mutex>
 #include <thread>
+#include "common/common_types.h"
 
 namespace Common {
 
@@ -93,4 +94,36 @@ private:
 
 void SetCurrentThreadName(const char* name);
 
+enum class ThreadPriority {
+    Low,    ///< Background work the user doesn't wait on
+    Normal, ///< Default of new threads
+    High,   ///< Work the emulated frames wait on
+};
+
+/// Sets the scheduling priority of the calling thread, or its QoS class on macOS
+void SetCurrentThreadPriority(ThreadPriority priority);
+
+/// Lowers the priority of the calling thread, for background work the user doesn't wait on
+void SetCurrentThreadLowPriority();
+
+/**
+ * Keeps the calling thread off the slowest cores of big.LITTLE CPUs. Does nothing where every core
+ * runs at the same maximum frequency or where the OS does not expose it.
+ */
+void SetCurrentThreadBigCoreAffinity();
+
+/**
+ * Marks the calling thread as one that the emulated frames wait on: it gets a high priority, the
+ * big cores and, on Android, a place in the performance hint session fed by
+ * ReportFrameWorkDuration. The thread leaves the session when it exits, and calling it again on
+ * the same thread does nothing, so audio callbacks may call it on every invocation.
+ */
+void SetCurrentThreadFrameCritical();
+
+/**
+ * Reports the host time the work of the latest emulated frame took and the time it should take,
+ * so that the OS can pick the clocks of the frame critical threads. Only used on Android.
+ */
+void ReportFrameWorkDuration(s64 actual_ns, s64 target_ns);
+
 } // namespace Common
@@ -0,0 +1,165 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+/// Pool whose worker is the calling thread, tasks it submits run inline instead of waiting on it
+static thread_local const ThreadPool* current_pool = nullptr;
+
+ThreadPool::ThreadPool(std::size_t num_threads, const char* name, std::size_t queue_capacity)
+    : queue_capacity(queue_capacity) {
+    threads.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this, name);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{mutex};
+        stop = true;
+    }
+    work_cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::GetShared() {
+    static ThreadPool pool(
+        std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2, 9) - 1, "SharedPool");
+    return pool;
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func) {
+    if (count == 0) {
+        return;
+    }
+    if (threads.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    std::lock_guard loop_lock{loop_mutex};
+    {
+        std::lock_guard lock{mutex};
+        current_func = &func;
+        current_count = count;
+        next_index = 0;
+        ++generation;
+    }
+    work_cv.notify_all();
+
+    RunIterations();
+
+    // func must outlive every call to it, so the workers that joined are waited for even if they
+    // got nothing. Those that come later see no loop.
+    std::unique_lock lock{mutex};
+    done_cv.wait(lock, [this] { return busy_threads == 0; });
+    current_func = nullptr;
+}
+
+void ThreadPool::RunIterations() {
+    for (std::size_t i = next_index++; i < current_count; i = next_index++) {
+        (*current_func)(i);
+    }
+}
+
+std::deque<std::function<void()>>* ThreadPool::GetRunnableQueue() {
+    for (std::size_t i = 0; i < NUM_TASK_PRIORITIES; ++i) {
+        auto& queue = queues[i];
+        if (queue.empty()) {
+            continue;
+        }
+        // Background tasks may block for long, e.g. on the network, so one thread stays free
+        if (static_cast<TaskPriority>(i) == TaskPriority::Background && !stop &&
+            threads.size() > 1 && running_background_tasks + 1 >= threads.size()) {
+            continue;
+        }
+        return &queue;
+    }
+    return nullptr;
+}
+
+bool ThreadPool::Enqueue(TaskPriority priority, std::function<void()> task, bool wait) {
+    if (threads.empty() || current_pool == this) {
+        task();
+        return true;
+    }
+
+    auto& queue = queues[static_cast<std::size_t>(priority)];
+    {
+        std::unique_lock lock{mutex};
+        if (queue.size() >= queue_capacity) {
+            if (!wait) {
+                return false;
+            }
+            space_cv.wait(lock, [&] { return queue.size() < queue_capacity; });
+        }
+        queue.push_back(std::move(task));
+    }
+    work_cv.notify_one();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(const char* name) {
+    SetCurrentThreadName(name);
+    current_pool = this;
+    std::size_t last_generation = 0;
+    std::unique_lock lock{mutex};
+    while (true) {
+        std::deque<std::function<void()>>* queue = nullptr;
+        work_cv.wait(lock, [&] {
+            if (current_func != nullptr && generation != last_generation) {
+                return true;
+            }
+            queue = GetRunnableQueue();
+            return queue != nullptr || stop;
+        });
+
+        if (current_func != nullptr && generation != last_generation) {
+            last_generation = generation;
+            ++busy_threads;
+            lock.unlock();
+            RunIterations();
+            lock.lock();
+            if (--busy_threads == 0) {
+                done_cv.notify_one();
+            }
+            continue;
+        }
+
+        // The queued tasks still run when the pool is destroyed
+        if (queue == nullptr) {
+            return;
+        }
+
+        const bool is_background = queue == &queues[static_cast<std::size_t>(
+                                                 TaskPriority::Background)];
+        std::function<void()> task = std::move(queue->front());
+        queue->pop_front();
+        if (is_background) {
+            ++running_background_tasks;
+        }
+        lock.unlock();
+        space_cv.notify_all();
+
+        task();
+
+        lock.lock();
+        if (is_background) {
+            --running_background_tasks;
+            // A background task may have waited for this one to free its thread
+            work_cv.notify_one();
+        }
+    }
+}
+
+} // namespace Common
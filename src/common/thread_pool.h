@@ -0,0 +1,127 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+enum class TaskPriority {
+    LatencyCritical, ///< Work the emulation is about to wait on
+    Normal,
+    Background, ///< Work nobody waits on, e.g. telemetry
+};
+
+constexpr std::size_t NUM_TASK_PRIORITIES = 3;
+
+/**
+ * A fixed set of threads that split the iterations of a loop with the calling thread, and run
+ * queued tasks while no loop is going on. The loops are meant for short bursts of independent work,
+ * e.g. decoding the rows of a large texture, the tasks for background work that would otherwise get
+ * a thread of its own.
+ */
+class ThreadPool : NonCopyable {
+public:
+    /**
+     * @param num_threads Number of threads besides the calling one
+     * @param queue_capacity Tasks each priority queues before Submit blocks
+     */
+    ThreadPool(std::size_t num_threads, const char* name, std::size_t queue_capacity = 256);
+    /// Runs the tasks still queued before the threads exit
+    ~ThreadPool();
+
+    /// Pool shared by the subsystems, with a thread less than the host has cores
+    static ThreadPool& GetShared();
+
+    std::size_t GetNumThreads() const {
+        return threads.size();
+    }
+
+    /**
+     * Calls func for every index below count, spread over the threads of the pool and the calling
+     * thread. Returns once all calls returned, calls from several threads are serialized. Workers
+     * busy with a task leave their share of the loop to the others.
+     */
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& func);
+
+    /**
+     * Queues func and returns the future of its result. Blocks while the queue of the priority is
+     * full, unless called from a task of the pool or the pool has no thread, then func runs right
+     * away. Background tasks leave a thread to the other priorities.
+     */
+    template <typename Func>
+    auto Submit(TaskPriority priority, Func&& func) -> std::future<std::invoke_result_t<Func>> {
+        auto [task, future] = MakeTask(std::forward<Func>(func));
+        Enqueue(priority, std::move(task), true);
+        return std::move(future);
+    }
+
+    /// Like Submit, but returns nothing instead of blocking when the queue is full
+    template <typename Func>
+    auto TrySubmit(TaskPriority priority, Func&& func)
+        -> std::optional<std::future<std::invoke_result_t<Func>>> {
+        auto [task, future] = MakeTask(std::forward<Func>(func));
+        if (!Enqueue(priority, std::move(task), false)) {
+            return std::nullopt;
+        }
+        return std::move(future);
+    }
+
+private:
+    template <typename Func>
+    static auto MakeTask(Func&& func) {
+        using Result = std::invoke_result_t<Func>;
+        // std::function needs a copyable callable, which a packaged_task is not
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+        auto future = packaged->get_future();
+        return std::make_pair(std::function<void()>([packaged] { (*packaged)(); }),
+                              std::move(future));
+    }
+
+    /// Queues the task, returns false if the queue is full and wait is false
+    bool Enqueue(TaskPriority priority, std::function<void()> task, bool wait);
+
+    void WorkerLoop(const char* name);
+
+    /// Runs the iterations left of the current loop, returns once there are none
+    void RunIterations();
+
+    /// Returns the queue whose next task may run now, or nullptr, mutex must be held
+    std::deque<std::function<void()>>* GetRunnableQueue();
+
+    std::vector<std::thread> threads;
+    std::mutex loop_mutex;
+
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::condition_variable space_cv;
+    const std::function<void(std::size_t)>* current_func = nullptr;
+    std::size_t current_count = 0;
+    std::atomic<std::size_t> next_index{0};
+    std::size_t generation = 0;
+    /// Workers that joined the current loop
+    std::size_t busy_threads = 0;
+
+    std::array<std::deque<std::function<void()>>, NUM_TASK_PRIORITIES> queues;
+    std::size_t queue_capacity;
+    std::size_t running_background_tasks = 0;
+    bool stop = false;
+};
+
+} // namespace Common
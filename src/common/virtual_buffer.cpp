@@ -0,0 +1,48 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/virtual_buffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Common {
+
+VirtualBuffer::VirtualBuffer(std::size_t size, [[maybe_unused]] bool huge_pages) : buffer_size(size) {
+#ifdef _WIN32
+    // Committed pages are charged against the commit limit, but only get physical memory on their
+    // first access
+    base = static_cast<u8*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+    ASSERT_MSG(base != nullptr, "Failed to allocate {} bytes of virtual memory", size);
+#else
+#ifdef MAP_NORESERVE
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#else
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    ASSERT_MSG(memory != MAP_FAILED, "Failed to allocate {} bytes of virtual memory", size);
+    base = static_cast<u8*>(memory);
+#ifdef MADV_HUGEPAGE
+    if (huge_pages && madvise(memory, size, MADV_HUGEPAGE) != 0) {
+        LOG_WARNING(Common_Memory, "Transparent huge pages are not available");
+    }
+#endif
+#endif
+}
+
+VirtualBuffer::~VirtualBuffer() {
+#ifdef _WIN32
+    VirtualFree(base, 0, MEM_RELEASE);
+#else
+    munmap(base, buffer_size);
+#endif
+}
+
+} // namespace Common
@@ -0,0 +1,40 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Zeroed memory reserved from the host address space, whose pages are only backed by RAM once
+ * they're touched. Unlike a value-initialized array, a large buffer that's mostly unused doesn't
+ * count against the memory of the process.
+ */
+class VirtualBuffer : NonCopyable {
+public:
+    /**
+     * @param huge_pages Asks the host for transparent huge pages, which make the TLB cover more of
+     *     the buffer, but back it 2 MiB at a time. Ignored where the host doesn't support them.
+     */
+    explicit VirtualBuffer(std::size_t size, bool huge_pages = false);
+    ~VirtualBuffer();
+
+    u8* data() const {
+        return base;
+    }
+
+    std::size_t size() const {
+        return buffer_size;
+    }
+
+private:
+    u8* base = nullptr;
+    std::size_t buffer_size = 0;
+};
+
+} // namespace Common
@@ -17,6 +17,7 @@ struct WebResult {
         HttpError,
         WrongContent,
         NoWebservice,
+        NotModified, ///< A conditional request found the resource unchanged
     };
     Code result_code;
     std::string result_string;
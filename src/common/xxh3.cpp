@@ -0,0 +1,440 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Implementation of the 64-bit variant of XXH3, by Yann Collet, following the specification and
+// the reference implementation at https://github.com/Cyan4973/xxHash
+
+#include <array>
+#include <cstring>
+#if defined(ARCHITECTURE_x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "common/assert.h"
+#include "common/xxh3.h"
+
+#if defined(ARCHITECTURE_x86_64) && !defined(_MSC_VER)
+#define XXH3_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define XXH3_TARGET_AVX2
+#endif
+
+namespace Common {
+
+namespace {
+
+constexpr u64 PRIME32_1 = 0x9E3779B1U;
+constexpr u64 PRIME32_2 = 0x85EBCA77U;
+constexpr u64 PRIME32_3 = 0xC2B2AE3DU;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr u64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr u64 PRIME_MX1 = 0x165667919E3779F9ULL;
+constexpr u64 PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+constexpr std::size_t STRIPE_LEN = 64;
+constexpr std::size_t SECRET_CONSUME_RATE = 8;
+constexpr std::size_t ACC_NB = STRIPE_LEN / sizeof(u64);
+constexpr std::size_t SECRET_LASTACC_START = 7;
+constexpr std::size_t SECRET_MERGEACCS_START = 11;
+constexpr std::size_t MIDSIZE_MAX = 240;
+constexpr std::size_t MIDSIZE_STARTOFFSET = 3;
+constexpr std::size_t MIDSIZE_LASTOFFSET = 17;
+constexpr std::size_t SECRET_SIZE_MIN = 136;
+
+alignas(64) constexpr std::array<u8, 192> DEFAULT_SECRET{
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// The hash reads its input as little endian, like every host citra runs on
+inline u32 Read32(const u8* p) {
+    u32 value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline u64 Read64(const u8* p) {
+    u64 value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline u32 Swap32(u32 x) {
+    return ((x << 24) & 0xff000000) | ((x << 8) & 0x00ff0000) | ((x >> 8) & 0x0000ff00) |
+           ((x >> 24) & 0x000000ff);
+}
+
+inline u64 Swap64(u64 x) {
+    return (static_cast<u64>(Swap32(static_cast<u32>(x))) << 32) |
+           Swap32(static_cast<u32>(x >> 32));
+}
+
+inline u64 RotateLeft64(u64 x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/// Multiplies into 128 bits and folds the halves together
+inline u64 Mul128Fold64(u64 lhs, u64 rhs) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#elif defined(_MSC_VER) && defined(ARCHITECTURE_x86_64)
+    u64 high;
+    const u64 low = _umul128(lhs, rhs, &high);
+    return low ^ high;
+#else
+    const u64 lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    const u64 hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    const u64 lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    const u64 hi_hi = (lhs >> 32) * (rhs >> 32);
+    const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const u64 upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const u64 lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return lower ^ upper;
+#endif
+}
+
+inline u64 XXH64Avalanche(u64 h) {
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    return h ^ (h >> 32);
+}
+
+inline u64 Avalanche(u64 h) {
+    h ^= h >> 37;
+    h *= PRIME_MX1;
+    return h ^ (h >> 32);
+}
+
+inline u64 RRMXMX(u64 h, u64 len) {
+    h ^= RotateLeft64(h, 49) ^ RotateLeft64(h, 24);
+    h *= PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= PRIME_MX2;
+    return h ^ (h >> 28);
+}
+
+inline u64 Mix16B(const u8* input, const u8* secret) {
+    return Mul128Fold64(Read64(input) ^ Read64(secret), Read64(input + 8) ^ Read64(secret + 8));
+}
+
+u64 HashLen0To16(const u8* input, std::size_t len, const u8* secret) {
+    if (len > 8) {
+        const u64 input_lo = Read64(input) ^ (Read64(secret + 24) ^ Read64(secret + 32));
+        const u64 input_hi = Read64(input + len - 8) ^ (Read64(secret + 40) ^ Read64(secret + 48));
+        const u64 acc = len + Swap64(input_lo) + input_hi + Mul128Fold64(input_lo, input_hi);
+        return Avalanche(acc);
+    }
+    if (len >= 4) {
+        const u64 input64 = Read32(input + len - 4) + (static_cast<u64>(Read32(input)) << 32);
+        return RRMXMX(input64 ^ (Read64(secret + 8) ^ Read64(secret + 16)), len);
+    }
+    if (len > 0) {
+        const u32 combined = (static_cast<u32>(input[0]) << 16) |
+                             (static_cast<u32>(input[len >> 1]) << 24) | input[len - 1] |
+                             static_cast<u32>(len << 8);
+        const u64 bitflip = Read32(secret) ^ Read32(secret + 4);
+        return XXH64Avalanche(combined ^ bitflip);
+    }
+    return XXH64Avalanche(Read64(secret + 56) ^ Read64(secret + 64));
+}
+
+u64 HashLen17To128(const u8* input, std::size_t len, const u8* secret) {
+    u64 acc = len * PRIME64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += Mix16B(input + 48, secret + 96);
+                acc += Mix16B(input + len - 64, secret + 112);
+            }
+            acc += Mix16B(input + 32, secret + 64);
+            acc += Mix16B(input + len - 48, secret + 80);
+        }
+        acc += Mix16B(input + 16, secret + 32);
+        acc += Mix16B(input + len - 32, secret + 48);
+    }
+    acc += Mix16B(input, secret);
+    acc += Mix16B(input + len - 16, secret + 16);
+    return Avalanche(acc);
+}
+
+u64 HashLen129To240(const u8* input, std::size_t len, const u8* secret) {
+    u64 acc = len * PRIME64_1;
+    const std::size_t rounds = len / 16;
+    for (std::size_t i = 0; i < 8; ++i) {
+        acc += Mix16B(input + 16 * i, secret + 16 * i);
+    }
+    acc = Avalanche(acc);
+    for (std::size_t i = 8; i < rounds; ++i) {
+        acc += Mix16B(input + 16 * i, secret + 16 * (i - 8) + MIDSIZE_STARTOFFSET);
+    }
+    acc += Mix16B(input + len - 16, secret + SECRET_SIZE_MIN - MIDSIZE_LASTOFFSET);
+    return Avalanche(acc);
+}
+
+// Each kernel accumulates a number of consecutive stripes, then scrambles the accumulators at the
+// end of a block. Working a block at a time keeps the calls out of the inner loop, which lets the
+// AVX2 kernel be built for its target alone.
+
+struct ScalarKernel {
+    static void Accumulate(u64* acc, const u8* input, const u8* secret, std::size_t stripes) {
+        for (std::size_t n = 0; n < stripes; ++n) {
+            const u8* stripe = input + n * STRIPE_LEN;
+            const u8* key = secret + n * SECRET_CONSUME_RATE;
+            for (std::size_t i = 0; i < ACC_NB; ++i) {
+                const u64 data_val = Read64(stripe + 8 * i);
+                const u64 data_key = data_val ^ Read64(key + 8 * i);
+                acc[i ^ 1] += data_val;
+                acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+            }
+        }
+    }
+
+    static void Scramble(u64* acc, const u8* secret) {
+        for (std::size_t i = 0; i < ACC_NB; ++i) {
+            u64 acc64 = acc[i];
+            acc64 ^= acc64 >> 47;
+            acc64 ^= Read64(secret + 8 * i);
+            acc[i] = acc64 * PRIME32_1;
+        }
+    }
+};
+
+#if defined(ARCHITECTURE_x86_64)
+struct SSE2Kernel {
+    static void Accumulate(u64* acc, const u8* input, const u8* secret, std::size_t stripes) {
+        __m128i* const xacc = reinterpret_cast<__m128i*>(acc);
+        for (std::size_t n = 0; n < stripes; ++n) {
+            const u8* stripe = input + n * STRIPE_LEN;
+            const u8* key = secret + n * SECRET_CONSUME_RATE;
+            for (std::size_t i = 0; i < STRIPE_LEN / sizeof(__m128i); ++i) {
+                const __m128i data_vec =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe) + i);
+                const __m128i key_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key) + i);
+                const __m128i data_key = _mm_xor_si128(data_vec, key_vec);
+                const __m128i data_key_lo = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+                const __m128i product = _mm_mul_epu32(data_key, data_key_lo);
+                const __m128i data_swap = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+                xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], data_swap));
+            }
+        }
+    }
+
+    static void Scramble(u64* acc, const u8* secret) {
+        __m128i* const xacc = reinterpret_cast<__m128i*>(acc);
+        const __m128i prime32 = _mm_set1_epi32(static_cast<int>(PRIME32_1));
+        for (std::size_t i = 0; i < STRIPE_LEN / sizeof(__m128i); ++i) {
+            const __m128i acc_vec = _mm_xor_si128(xacc[i], _mm_srli_epi64(xacc[i], 47));
+            const __m128i key_vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i);
+            const __m128i data_key = _mm_xor_si128(acc_vec, key_vec);
+            const __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+            const __m128i product_lo = _mm_mul_epu32(data_key, prime32);
+            const __m128i product_hi = _mm_mul_epu32(data_key_hi, prime32);
+            xacc[i] = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+        }
+    }
+};
+
+struct AVX2Kernel {
+    XXH3_TARGET_AVX2 static void Accumulate(u64* acc, const u8* input, const u8* secret,
+                                            std::size_t stripes) {
+        __m256i* const xacc = reinterpret_cast<__m256i*>(acc);
+        for (std::size_t n = 0; n < stripes; ++n) {
+            const u8* stripe = input + n * STRIPE_LEN;
+            const u8* key = secret + n * SECRET_CONSUME_RATE;
+            for (std::size_t i = 0; i < STRIPE_LEN / sizeof(__m256i); ++i) {
+                const __m256i data_vec =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe) + i);
+                const __m256i key_vec =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key) + i);
+                const __m256i data_key = _mm256_xor_si256(data_vec, key_vec);
+                const __m256i data_key_lo = _mm256_srli_epi64(data_key, 32);
+                const __m256i product = _mm256_mul_epu32(data_key, data_key_lo);
+                const __m256i data_swap =
+                    _mm256_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+                xacc[i] = _mm256_add_epi64(product, _mm256_add_epi64(xacc[i], data_swap));
+            }
+        }
+    }
+
+    XXH3_TARGET_AVX2 static void Scramble(u64* acc, const u8* secret) {
+        __m256i* const xacc = reinterpret_cast<__m256i*>(acc);
+        const __m256i prime32 = _mm256_set1_epi32(static_cast<int>(PRIME32_1));
+        for (std::size_t i = 0; i < STRIPE_LEN / sizeof(__m256i); ++i) {
+            const __m256i acc_vec = _mm256_xor_si256(xacc[i], _mm256_srli_epi64(xacc[i], 47));
+            const __m256i key_vec =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i);
+            const __m256i data_key = _mm256_xor_si256(acc_vec, key_vec);
+            const __m256i data_key_hi = _mm256_srli_epi64(data_key, 32);
+            const __m256i product_lo = _mm256_mul_epu32(data_key, prime32);
+            const __m256i product_hi = _mm256_mul_epu32(data_key_hi, prime32);
+            xacc[i] = _mm256_add_epi64(product_lo, _mm256_slli_epi64(product_hi, 32));
+        }
+    }
+};
+#elif defined(ARCHITECTURE_ARM64)
+struct NEONKernel {
+    static void Accumulate(u64* acc, const u8* input, const u8* secret, std::size_t stripes) {
+        for (std::size_t n = 0; n < stripes; ++n) {
+            const u8* stripe = input + n * STRIPE_LEN;
+            const u8* key = secret + n * SECRET_CONSUME_RATE;
+            for (std::size_t i = 0; i < STRIPE_LEN / sizeof(uint64x2_t); ++i) {
+                const uint64x2_t data_vec = vreinterpretq_u64_u8(vld1q_u8(stripe + 16 * i));
+                const uint64x2_t key_vec = vreinterpretq_u64_u8(vld1q_u8(key + 16 * i));
+                const uint64x2_t data_key = veorq_u64(data_vec, key_vec);
+                const uint32x2_t data_key_lo = vmovn_u64(data_key);
+                const uint32x2_t data_key_hi = vshrn_n_u64(data_key, 32);
+                const uint64x2_t data_swap = vextq_u64(data_vec, data_vec, 1);
+                uint64x2_t acc_vec = vaddq_u64(vld1q_u64(acc + 2 * i), data_swap);
+                acc_vec = vmlal_u32(acc_vec, data_key_lo, data_key_hi);
+                vst1q_u64(acc + 2 * i, acc_vec);
+            }
+        }
+    }
+
+    static void Scramble(u64* acc, const u8* secret) {
+        const uint32x2_t prime32 = vdup_n_u32(static_cast<u32>(PRIME32_1));
+        for (std::size_t i = 0; i < STRIPE_LEN / sizeof(uint64x2_t); ++i) {
+            uint64x2_t acc_vec = vld1q_u64(acc + 2 * i);
+            acc_vec = veorq_u64(acc_vec, vshrq_n_u64(acc_vec, 47));
+            const uint64x2_t key_vec = vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i));
+            const uint64x2_t data_key = veorq_u64(acc_vec, key_vec);
+            const uint32x2_t data_key_lo = vmovn_u64(data_key);
+            const uint32x2_t data_key_hi = vshrn_n_u64(data_key, 32);
+            const uint64x2_t product_hi = vshlq_n_u64(vmull_u32(data_key_hi, prime32), 32);
+            vst1q_u64(acc + 2 * i, vmlal_u32(product_hi, data_key_lo, prime32));
+        }
+    }
+};
+#endif
+
+template <typename Kernel>
+u64 HashLong(const u8* input, std::size_t len) {
+    constexpr std::size_t secret_size = DEFAULT_SECRET.size();
+    constexpr std::size_t stripes_per_block = (secret_size - STRIPE_LEN) / SECRET_CONSUME_RATE;
+    constexpr std::size_t block_len = STRIPE_LEN * stripes_per_block;
+    const u8* secret = DEFAULT_SECRET.data();
+
+    alignas(32) std::array<u64, ACC_NB> acc{PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                                            PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+    const std::size_t blocks = (len - 1) / block_len;
+    for (std::size_t n = 0; n < blocks; ++n) {
+        Kernel::Accumulate(acc.data(), input + n * block_len, secret, stripes_per_block);
+        Kernel::Scramble(acc.data(), secret + secret_size - STRIPE_LEN);
+    }
+
+    // The last partial block, then the last stripe which may overlap it
+    const std::size_t stripes = ((len - 1) - block_len * blocks) / STRIPE_LEN;
+    Kernel::Accumulate(acc.data(), input + blocks * block_len, secret, stripes);
+    Kernel::Accumulate(acc.data(), input + len - STRIPE_LEN,
+                       secret + secret_size - STRIPE_LEN - SECRET_LASTACC_START, 1);
+
+    u64 result = len * PRIME64_1;
+    for (std::size_t i = 0; i < ACC_NB / 2; ++i) {
+        const u8* key = secret + SECRET_MERGEACCS_START + 16 * i;
+        result += Mul128Fold64(acc[2 * i] ^ Read64(key), acc[2 * i + 1] ^ Read64(key + 8));
+    }
+    return Avalanche(result);
+}
+
+using HashLongFunction = u64 (*)(const u8* input, std::size_t len);
+
+HashLongFunction GetHashLong(XXH3Kernel kernel) {
+    switch (kernel) {
+#if defined(ARCHITECTURE_x86_64)
+    case XXH3Kernel::SSE2:
+        return &HashLong<SSE2Kernel>;
+    case XXH3Kernel::AVX2:
+        return &HashLong<AVX2Kernel>;
+#elif defined(ARCHITECTURE_ARM64)
+    case XXH3Kernel::NEON:
+        return &HashLong<NEONKernel>;
+#endif
+    case XXH3Kernel::Scalar:
+        return &HashLong<ScalarKernel>;
+    default:
+        UNREACHABLE_MSG("XXH3 kernel {} is not built in", static_cast<int>(kernel));
+        return &HashLong<ScalarKernel>;
+    }
+}
+
+u64 Hash(const u8* input, std::size_t len, HashLongFunction hash_long) {
+    const u8* secret = DEFAULT_SECRET.data();
+    if (len <= 16) {
+        return HashLen0To16(input, len, secret);
+    }
+    if (len <= 128) {
+        return HashLen17To128(input, len, secret);
+    }
+    if (len <= MIDSIZE_MAX) {
+        return HashLen129To240(input, len, secret);
+    }
+    return hash_long(input, len);
+}
+
+} // Anonymous namespace
+
+bool IsXXH3KernelSupported(XXH3Kernel kernel) {
+    switch (kernel) {
+    case XXH3Kernel::Scalar:
+        return true;
+#if defined(ARCHITECTURE_x86_64)
+    // SSE2 is part of the x86_64 baseline
+    case XXH3Kernel::SSE2:
+        return true;
+    case XXH3Kernel::AVX2:
+        return GetCPUCaps().avx2;
+#elif defined(ARCHITECTURE_ARM64)
+    // So is NEON of AArch64
+    case XXH3Kernel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+XXH3Kernel GetXXH3Kernel() {
+    static const XXH3Kernel kernel = [] {
+        for (XXH3Kernel candidate : {XXH3Kernel::AVX2, XXH3Kernel::NEON, XXH3Kernel::SSE2}) {
+            if (IsXXH3KernelSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return XXH3Kernel::Scalar;
+    }();
+    return kernel;
+}
+
+u64 XXH3Hash64(const void* data, std::size_t len) {
+    static const HashLongFunction hash_long = GetHashLong(GetXXH3Kernel());
+    return Hash(static_cast<const u8*>(data), len, hash_long);
+}
+
+u64 XXH3Hash64(const void* data, std::size_t len, XXH3Kernel kernel) {
+    ASSERT(IsXXH3KernelSupported(kernel));
+    return Hash(static_cast<const u8*>(data), len, GetHashLong(kernel));
+}
+
+} // namespace Common
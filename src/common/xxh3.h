@@ -0,0 +1,35 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common {
+
+/// Implementations of the loop XXH3 runs over inputs longer than 240 bytes
+enum class XXH3Kernel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+/// Returns true if the kernel was built in and runs on the host CPU
+bool IsXXH3KernelSupported(XXH3Kernel kernel);
+
+/// Returns the fastest kernel supported by the host CPU, detected on the first call
+XXH3Kernel GetXXH3Kernel();
+
+/**
+ * Computes the 64-bit XXH3 hash of a block of data, with the default secret and a seed of 0. The
+ * values are the ones of the reference implementation whatever kernel runs.
+ */
+u64 XXH3Hash64(const void* data, std::size_t len);
+
+/// Computes the hash with the given kernel, which must be supported
+u64 XXH3Hash64(const void* data, std::size_t len, XXH3Kernel kernel);
+
+} // namespace Common
@@ -9,11 +9,13 @@
 #include "common/microprofile.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
+#include "core/arm/dynarmic/arm_exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 
 class DynarmicThreadContext final : public ARM_Interface::ThreadContext {
@@ -75,30 +77,50 @@ public:
         : parent(parent), svc_context(parent.system), memory(parent.memory) {}
     ~DynarmicUserCallbacks() = default;
 
+    // The jit reads and writes mapped pages itself, only the other pages reach these. They go
+    // through the page table of this core, which differs from the active one while the cores run
+    // in parallel.
     std::uint8_t MemoryRead8(VAddr vaddr) override {
-        return memory.Read8(vaddr);
+        return memory.Read8(*parent.current_page_table, vaddr);
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
-        return memory.Read16(vaddr);
+        return memory.Read16(*parent.current_page_table, vaddr);
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
-        return memory.Read32(vaddr);
+        return memory.Read32(*parent.current_page_table, vaddr);
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
-        return memory.Read64(vaddr);
+        return memory.Read64(*parent.current_page_table, vaddr);
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
-        memory.Write8(vaddr, value);
+        memory.Write8(*parent.current_page_table, vaddr, value);
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
-        memory.Write16(vaddr, value);
+        memory.Write16(*parent.current_page_table, vaddr, value);
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
-        memory.Write32(vaddr, value);
+        memory.Write32(*parent.current_page_table, vaddr, value);
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
-        memory.Write64(vaddr, value);
+        memory.Write64(*parent.current_page_table, vaddr, value);
+    }
+
+    // STREX, once the global monitor saw that the reservation of this core still holds
+    bool MemoryWriteExclusive8(VAddr vaddr, std::uint8_t value, std::uint8_t expected) override {
+        return memory.WriteExclusive8(*parent.current_page_table, vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive16(VAddr vaddr, std::uint16_t value,
+                                std::uint16_t expected) override {
+        return memory.WriteExclusive16(*parent.current_page_table, vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive32(VAddr vaddr, std::uint32_t value,
+                                std::uint32_t expected) override {
+        return memory.WriteExclusive32(*parent.current_page_table, vaddr, value, expected);
+    }
+    bool MemoryWriteExclusive64(VAddr vaddr, std::uint64_t value,
+                                std::uint64_t expected) override {
+        return memory.WriteExclusive64(*parent.current_page_table, vaddr, value, expected);
     }
 
     void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {
@@ -124,10 +146,15 @@ public:
                 return;
             }
             break;
-        case Dynarmic::A32::Exception::SendEvent:
-        case Dynarmic::A32::Exception::SendEventLocal:
         case Dynarmic::A32::Exception::WaitForInterrupt:
         case Dynarmic::A32::Exception::WaitForEvent:
+            // The core waits on another one or on an interrupt, neither of which can happen
+            // before the end of the slice
+            parent.GetTimer().Idle();
+            parent.jit->HaltExecution();
+            return;
+        case Dynarmic::A32::Exception::SendEvent:
+        case Dynarmic::A32::Exception::SendEventLocal:
         case Dynarmic::A32::Exception::Yield:
         case Dynarmic::A32::Exception::PreloadData:
         case Dynarmic::A32::Exception::PreloadDataWithIntentToWrite:
@@ -151,17 +178,18 @@ public:
     Memory::MemorySystem& memory;
 };
 
-ARM_Dynarmic::ARM_Dynarmic(Core::System* system, u32 id, std::shared_ptr<Core::Timing::Timer> timer)
+ARM_Dynarmic::ARM_Dynarmic(Core::System* system, u32 id, std::shared_ptr<Core::Timing::Timer> timer,
+                           Core::DynarmicExclusiveMonitor& exclusive_monitor)
     : ARM_Interface(id, timer), system(*system), memory(system->Memory()),
-      cb(std::make_unique<DynarmicUserCallbacks>(*this)) {}
+      exclusive_monitor(exclusive_monitor), cb(std::make_unique<DynarmicUserCallbacks>(*this)) {}
 
 ARM_Dynarmic::~ARM_Dynarmic() = default;
 
 MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
     MICROPROFILE_SCOPE(ARM_Jit);
+    PERF_SCOPE(CpuJit);
 
     jit->Run();
 }
@@ -283,7 +311,11 @@ void ARM_Dynarmic::ClearInstructionCache() {
 }
 
 void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, std::size_t length) {
-    jit->InvalidateCacheRange(start_address, length);
+    // The code may belong to a process other than the current one, whose jit would then keep
+    // running the stale translation on its next switch in
+    for (const auto& j : jits) {
+        j.second->InvalidateCacheRange(start_address, length);
+    }
     LOG_DEBUG(Core_ARM11, "arm jit invalidate cache range");
 }
 
@@ -321,8 +353,14 @@ void ARM_Dynarmic::ServeBreak() {
 std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.callbacks = cb.get();
+    // TODO: Every access goes through this table. A host-mapped arena (fastmem) would let the JIT
+    // use direct base+offset accesses, but the A32 UserConfig of the dynarmic we build has no
+    // fastmem pointer or fault reporting, and FCRAM/VRAM would have to move to a shared memory
+    // file so that pages can be viewed at several addresses. Revisit with a dynarmic update.
     config.page_table = &current_page_table->pointers;
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
+    config.processor_id = GetID();
+    config.global_monitor = &exclusive_monitor.monitor;
     config.define_unpredictable_behaviour = true;
     return std::make_unique<Dynarmic::A32::Jit>(config);
 }
@@ -17,14 +17,16 @@ class MemorySystem;
 } // namespace Memory
 
 namespace Core {
+class DynarmicExclusiveMonitor;
 class System;
-}
+} // namespace Core
 
 class DynarmicUserCallbacks;
 
 class ARM_Dynarmic final : public ARM_Interface {
 public:
-    ARM_Dynarmic(Core::System* system, u32 id, std::shared_ptr<Core::Timing::Timer> timer);
+    ARM_Dynarmic(Core::System* system, u32 id, std::shared_ptr<Core::Timing::Timer> timer,
+                 Core::DynarmicExclusiveMonitor& exclusive_monitor);
     ~ARM_Dynarmic() override;
 
     void Run() override;
@@ -63,6 +65,7 @@ private:
     friend class DynarmicUserCallbacks;
     Core::System& system;
     Memory::MemorySystem& memory;
+    Core::DynarmicExclusiveMonitor& exclusive_monitor;
     std::unique_ptr<DynarmicUserCallbacks> cb;
     std::unique_ptr<Dynarmic::A32::Jit> MakeJit();
 
@@ -0,0 +1,26 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <dynarmic/exclusive_monitor.h>
+#include "core/arm/exclusive_monitor.h"
+
+class ARM_Dynarmic;
+
+namespace Core {
+
+class DynarmicExclusiveMonitor final : public ExclusiveMonitor {
+public:
+    explicit DynarmicExclusiveMonitor(std::size_t core_count) : monitor(core_count) {}
+    ~DynarmicExclusiveMonitor() override = default;
+
+private:
+    friend class ::ARM_Dynarmic;
+
+    Dynarmic::ExclusiveMonitor monitor;
+};
+
+} // namespace Core
@@ -84,7 +84,7 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
+    state->ClearInstructionCache();
     trans_cache_buf_top = 0;
 }
 
@@ -1646,15 +1646,22 @@ DISPATCH : {
         cpu->Reg[15] &= 0xfffffffc;
 
     // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    auto& lookup = cpu->GetBlockLookupEntry(cpu->Reg[15]);
+    if (lookup.pc == cpu->Reg[15]) {
+        ptr = lookup.offset;
     } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+        auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
+        if (itr != cpu->instruction_cache.end()) {
+            ptr = itr->second;
+        } else if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
+        lookup.pc = cpu->Reg[15];
+        lookup.offset = static_cast<u32>(ptr);
     }
 
 #ifndef ANDROID
@@ -4546,9 +4553,13 @@ UXTB16_INST : {
 }
 
 WFE_INST : {
-    // Stubbed, as WFE is a hint instruction.
+    // Nothing can wake the core before the end of the slice, so give up the rest of it
     if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
         LOG_TRACE(Core_ARM11, "WFE executed.");
+        timer->AddTicks(num_instrs);
+        timer->Idle();
+        cpu->NumInstrsToExecute = 0;
+        num_instrs = 0;
     }
 
     cpu->Reg[15] += cpu->GetInstructionSize();
@@ -4558,9 +4569,13 @@ WFE_INST : {
 }
 
 WFI_INST : {
-    // Stubbed, as WFI is a hint instruction.
+    // Nothing can wake the core before the end of the slice, so give up the rest of it
     if (inst_base->cond == ConditionCode::AL || CondPassed(cpu, inst_base->cond)) {
         LOG_TRACE(Core_ARM11, "WFI executed.");
+        timer->AddTicks(num_instrs);
+        timer->Idle();
+        cpu->NumInstrsToExecute = 0;
+        num_instrs = 0;
     }
 
     cpu->Reg[15] += cpu->GetInstructionSize();
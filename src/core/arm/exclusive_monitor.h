@@ -0,0 +1,19 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+namespace Core {
+
+/**
+ * Keeps the addresses the cores reserved with LDREX, shared by all of them so that a STREX fails
+ * once another core wrote to the address in between. A monitor per core only sees its own writes,
+ * which stops being enough when the cores run on host threads of their own.
+ */
+class ExclusiveMonitor {
+public:
+    virtual ~ExclusiveMonitor() = default;
+};
+
+} // namespace Core
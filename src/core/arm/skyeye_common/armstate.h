@@ -256,6 +256,27 @@ public:
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
     std::unordered_map<u32, std::size_t> instruction_cache;
 
+    /// Direct-mapped copy of the recently dispatched instruction_cache entries, which saves the
+    /// hash lookup on most block transitions
+    struct BlockLookupEntry {
+        /// Never matches a dispatched PC, which is at least halfword aligned
+        static constexpr u32 INVALID_PC = 0xFFFFFFFF;
+        u32 pc = INVALID_PC;
+        u32 offset = 0;
+    };
+    static constexpr std::size_t BLOCK_LOOKUP_SIZE = 0x1000;
+    std::array<BlockLookupEntry, BLOCK_LOOKUP_SIZE> block_lookup{};
+
+    BlockLookupEntry& GetBlockLookupEntry(u32 pc) {
+        return block_lookup[(pc >> 1) & (BLOCK_LOOKUP_SIZE - 1)];
+    }
+
+    /// Clears the translated blocks, which must be retranslated on their next dispatch
+    void ClearInstructionCache() {
+        instruction_cache.clear();
+        block_lookup.fill({});
+    }
+
 private:
     void ResetMPCoreCP15Registers();
 
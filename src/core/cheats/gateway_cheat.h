@@ -53,6 +53,15 @@ public:
         bool valid = true;
     };
 
+    /// A cheat line prepared for execution, the patch data lines are folded into their code
+    struct Op {
+        CheatType type;
+        u32 address;
+        u32 value;
+        /// The mask of the 16-bit comparisons, or the offset of the bytes of a patch
+        u32 extra;
+    };
+
     GatewayCheat(std::string name, std::vector<CheatLine> cheat_lines, std::string comments);
     GatewayCheat(std::string name, std::string code, std::string comments);
     ~GatewayCheat();
@@ -78,9 +87,14 @@ public:
     static std::vector<std::unique_ptr<CheatBase>> LoadFile(const std::string& filepath);
 
 private:
+    /// Translates the cheat lines into ops once, so that Execute does not parse them every run
+    void Compile();
+
     std::atomic<bool> enabled = false;
     const std::string name;
     std::vector<CheatLine> cheat_lines;
+    std::vector<Op> ops;
+    std::vector<u8> patch_data;
     const std::string comments;
 };
 } // namespace Cheats
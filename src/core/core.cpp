@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <utility>
 #include "audio_core/dsp_interface.h"
@@ -9,16 +11,20 @@
 #include "audio_core/lle/lle.h"
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
+#include "core/arm/exclusive_monitor.h"
 #if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
 #include "core/arm/dynarmic/arm_dynarmic.h"
+#include "core/arm/dynarmic/arm_exclusive_monitor.h"
 #endif
 #include "core/arm/dyncom/arm_dyncom.h"
 #include "core/cheats/cheats.h"
 #include "core/core.h"
+#include "core/core_threads.h"
 #include "core/core_timing.h"
 #include "core/custom_tex_cache.h"
 #include "core/file_sys/archive_source_sd_savedata.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hack_tuner.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
@@ -29,8 +35,11 @@
 #include "core/hw/hw.h"
 #include "core/loader/loader.h"
 #include "core/movie.h"
+#include "core/rewind_buffer.h"
 #include "core/rpc/rpc_server.h"
 #include "core/settings.h"
+#include "core/slice_tuner.h"
+#include "core/title_profile.h"
 #include "network/network.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
@@ -39,7 +48,24 @@ namespace Core {
 
 System System::s_instance;
 
+/// Returns true if the core has no thread to run until an event wakes one up
+static bool IsCoreAsleep(Kernel::KernelSystem& kernel, u32 core_id) {
+    auto& thread_manager = kernel.GetThreadManager(core_id);
+    return thread_manager.GetCurrentThread() == nullptr && !thread_manager.HaveReadyThreads();
+}
+
 System::ResultStatus System::RunLoop() {
+    if (GDBStub::IsServerEnabled()) {
+        GDBStub::HandlePacket();
+        // While halted by the debugger, the CPU only runs the instructions it steps
+        if (GDBStub::IsConnected() && GDBStub::GetCpuHaltFlag()) {
+            if (GDBStub::GetCpuStepFlag()) {
+                GetRunningCore().Step();
+                GDBStub::SetCpuStepFlag(false);
+            }
+            return ResultStatus::Success;
+        }
+    }
     return Settings::values.is_new_3ds ? RunLoopMultiCores() : RunLoopSingleCore();
 }
 
@@ -65,14 +91,30 @@ System::ResultStatus System::RunLoopMultiCores() {
     } else {
         // Now all cores are at the same global time. So we will run them one after the other
         // with a max slice that is the minimum of all max slices of all cores
-        // TODO: Make special check for idle since we can easily revert the time of idle cores
         s64 max_slice = timing->GetMaxSliceLength();
         for (auto& cpu_core : cpu_cores) {
             kernel->Advance(cpu_core.get(), max_slice);
         }
+        // When every core sleeps, nothing can happen before the next event, so go straight to it
+        const bool all_asleep = std::all_of(cpu_cores.begin(), cpu_cores.end(), [this](auto& core) {
+            return IsCoreAsleep(*kernel, core->GetID());
+        });
+        if (all_asleep) {
+            const s64 idle_slice = timing->GetIdleSliceLength();
+            if (idle_slice > max_slice) {
+                for (auto& cpu_core : cpu_cores) {
+                    cpu_core->GetTimer().Skip(idle_slice);
+                }
+                max_slice = idle_slice;
+            }
+        }
         timing->AddToGlobalTicks(max_slice);
-        for (auto& cpu_core : cpu_cores) {
-            kernel->Run(cpu_core.get());
+        if (core_threads) {
+            core_threads->RunSlice();
+        } else {
+            for (auto& cpu_core : cpu_cores) {
+                kernel->Run(cpu_core.get());
+            }
         }
     }
 
@@ -89,6 +131,10 @@ System::ResultStatus System::RunLoopMultiCores() {
 
 System::ResultStatus System::RunLoopSingleCore() {
     kernel->Advance(cpu_cores[0].get(), Timing::MAX_SLICE_LENGTH);
+    if (IsCoreAsleep(*kernel, 0)) {
+        auto& timer = cpu_cores[0]->GetTimer();
+        timer.Skip(timer.GetMaxSliceLength());
+    }
     kernel->Run(cpu_cores[0].get());
     kernel->RescheduleSingleCore();
 
@@ -105,210 +151,32 @@ System::ResultStatus System::SingleStep() {
     return status;
 }
 
-static void LoadOverrides(u64 title_id) {
-    if (title_id == 0x0004000000068B00 || title_id == 0x0004000000061300 ||
-        title_id == 0x000400000004A700) {
-        // hack for Tales of the Abyss / Pac Man Party 3D
-        Settings::values.display_transfer_hack = true;
-        // crash on `g_state.geometry_pipeline.Reconfigure();`
-        // state.regs.pipeline.gs_unit_exclusive_configuration = 0
-        // state.regs.gs.max_input_attribute_index = 0
-        Settings::values.skip_slow_draw = true;
-    } else if (title_id == 0x00040000001CCD00 || title_id == 0x00040000001B4500) {
-        // The Alliance Alive
-        Settings::SetFMVHack(!Settings::values.core_downcount_hack);
-    } else if (title_id == 0x0004000000120900 || title_id == 0x0004000000164300) {
-        // Lord of Magna: Maiden Heaven
-        Settings::SetFMVHack(!Settings::values.core_downcount_hack);
-    } else if (title_id == 0x000400000015CB00) {
-        // New Atelier Rorona
-        Settings::values.skip_slow_draw = true;
-    } else if (title_id == 0x000400000018E900) {
-        // My Hero Academia
-        Settings::values.skip_slow_draw = true;
-    } else if (title_id == 0x000400000016AD00) {
-        // Dragon Quest Monsters Joker 3
-        Settings::values.skip_slow_draw = true;
-    } else if (title_id == 0x00040000001ACB00) {
-        // Dragon Quest Monsters Joker 3 Professional
-        Settings::values.skip_slow_draw = true;
-    } else if (title_id == 0x000400000019E700 || title_id == 0x00040000001A5600) {
-        // Armed Blue Gunvolt
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x000400000019B200 || title_id == 0x0004000000196A00 ||
-               title_id == 0x00040000001A6E00) {
-        // Armed Blue Gunvolt 2
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x0004000000149100) {
-        // Gravity Falls - Legend of the Gnome Gemulets
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x0004000000196900 || title_id == 0x0004000000119A00 ||
-               title_id == 0x000400000017C900 || title_id == 0x000400000017E100) {
-        // Shovel Knight
-        Settings::values.stream_buffer_hack = false;
-    } else if (title_id == 0x000400000008FE00) {
-        // 1001 Spikes [USA]
-        Settings::values.stream_buffer_hack = false;
-        Settings::SetFMVHack(!Settings::values.core_downcount_hack);
-    } else if (title_id == 0x0004000000049100 || title_id == 0x0004000000030400 ||
-               title_id == 0x0004000000049000) {
-        // Star Fox 64
-        Settings::values.disable_clip_coef = true;
-    } else if (title_id == 0x00040000000DCA00) {
-        // Danball Senki W Chou Custom
-        Settings::values.y2r_perform_hack = true;
+/// Logs how long each step of the boot took, to tell what holds up the first frame
+class BootTimer {
+public:
+    void Lap(std::string_view step) {
+        const auto now = Clock::now();
+        LOG_INFO(Core, "Boot: {} took {} ms", step, ToMs(now - lap_start));
+        lap_start = now;
     }
 
-    const std::array<u64, 7> cpu_limit_ids = {
-            0x000400000007C700, // Mario Tennis Open
-            0x000400000007C800, // Mario Tennis Open
-            0x0004000000064D00, // Mario Tennis Open
-            0x00040000000B9100, // Mario Tennis Open
-            0x00040000000DCD00, // Mario Golf: World Tour
-            0x00040000000A5300, // Mario Golf: World Tour
-            0x00040000000DCE00, // Mario Golf: World Tour
-    };
-    for (auto id : cpu_limit_ids) {
-        if (title_id == id) {
-            Settings::values.core_downcount_hack = true;
-            break;
-        }
+    void Total(std::string_view step) const {
+        LOG_INFO(Core, "Boot: {} took {} ms in total", step, ToMs(Clock::now() - start));
     }
 
-    const std::array<u64, 10> linear_ids = {
-        0x00040000001AA200, // Attack On Titan 2
-        0x0004000000134500, // Attack On Titan 1 CHAIN
-        0x0004000000152000, // Attack On Titan 1 CHAIN
-        0x0004000000134500, // Attack On Titan 1 CHAIN
-        0x00040000000DF800, // Attack On Titan 1
-    };
-    for (auto id : linear_ids) {
-        if (title_id == id) {
-            Settings::values.use_linear_filter = true;
-            break;
-        }
-    }
+private:
+    using Clock = std::chrono::steady_clock;
 
-    const std::array<u64, 12> fifa_ids = {
-        0x0004000000044700, // FIFA 12
-        0x0004000000047A00, // FIFA 12
-        0x0004000000044800, // FIFA 12
-        0x00040000000A2B00, // FIFA 13
-        0x00040000000A2900, // FIFA 13
-        0x00040000000A3000, // FIFA 13
-        0x00040000000E7900, // FIFA 14
-        0x00040000000DEA00, // FIFA 14
-        0x00040000000E7A00, // FIFA 14
-        0x000400000013C700, // FIFA 15
-        0x000400000013CA00, // FIFA 15
-        0x000400000013CB00, // FIFA 15
-    };
-    for (auto id : fifa_ids) {
-        if (title_id == id) {
-            Settings::values.y2r_event_delay = true;
-            break;
-        }
+    static long long ToMs(Clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
     }
 
-    const std::array<u64, 49> accurate_mul_ids = {
-        0x0004000000134500, // Attack on Titan
-        0x00040000000DF800, // Attack on Titan
-        0x0004000000152000, // Attack on Titan
-        0x00040000001AA200, // Attack on Titan
-        0x0004000000054000, // Super Mario 3D Land
-        0x0004000000053F00, // Super Mario 3D Land
-        0x0004000000054100, // Super Mario 3D Land
-        0x0004000000089F00, // Super Mario 3D Land
-        0x0004000000089E00, // Super Mario 3D Land
-        0x0004000000033400, // The Legend of Zelda: Ocarina of Time 3D
-        0x0004000000033500, // The Legend of Zelda: Ocarina of Time 3D
-        0x0004000000033600, // The Legend of Zelda: Ocarina of Time 3D
-        0x000400000008F800, // The Legend of Zelda: Ocarina of Time 3D
-        0x000400000008F900, // The Legend of Zelda: Ocarina of Time 3D
-        0x0004000000132700, // Mario & Luigi: Paper Jam
-        0x0004000000132600, // Mario & Luigi: Paper Jam
-        0x0004000000132800, // Mario & Luigi: Paper Jam
-        0x00040000001D1400, // Mario & Luigi: Bowsers Inside Story + Bowser Jrs Journey
-        0x00040000001D1500, // Mario & Luigi: Bowsers Inside Story + Bowser Jrs Journey
-        0x00040000001B8F00, // Mario & Luigi: Superstar Saga + Bowsers Minions
-        0x00040000001B9000, // Mario & Luigi: Superstar Saga + Bowsers Minions
-        0x0004000000194B00, // Mario & Luigi: Superstar Saga + Bowsers Minions
-        0x00040000001CB000, // Captain Toad: Treasure Tracker
-        0x00040000001CB200, // Captain Toad: Treasure Tracker
-        0x00040000001CB100, // Captain Toad: Treasure Tracker
-        0x00040000000EC200, // The Legend of Zelda: A Link Between Worlds
-        0x00040000000EC300, // The Legend of Zelda: A Link Between Worlds
-        0x00040000000EC400, // The Legend of Zelda: A Link Between Worlds
-        0x000400000007AD00, // New Super Mario Bros. 2
-        0x00040000000B8A00, // New Super Mario Bros. 2
-        0x000400000007AE00, // New Super Mario Bros. 2
-        0x000400000007AF00, // New Super Mario Bros. 2
-        0x0004000000079600, // Jett Rocket II
-        0x0004000000112600, // Cut the Rope
-        0x0004000000116700, // Cut the Rope
-        0x00040000000D0000, // Luigi's Mansion: Dark Moon
-        0x0004000000076400, // Luigi's Mansion: Dark Moon
-        0x0004000000055F00, // Luigi's Mansion: Dark Moon
-        0x0004000000076500, // Luigi's Mansion: Dark Moon
-        0x00040000000AFC00, // Digimon World Re:Digitize Decode
-        0x0004000000125600, // The Legend of Zelda: Majoras Mask 3D
-        0x0004000000125500, // The Legend of Zelda: Majoras Mask 3D
-        0x00040000000D6E00, // The Legend of Zelda: Majoras Mask 3D
-        0x0004000000154700, // Lego City Undercover
-        0x00040000000AD600, // Lego City Undercover
-        0x00040000000AD500, // Lego City Undercover
-        0x00040000001D1800, // Luigi's Mansion
-        0x00040000001D1A00, // Luigi's Mansion
-        0x00040000001D1900, // Luigi's Mansion
-    };
-    for (auto id : accurate_mul_ids) {
-        if (title_id == id) {
-            Settings::values.shaders_accurate_mul = Settings::AccurateMul::FAST;
-            break;
-        }
-    }
-
-    const std::array<u64, 30> new3ds_game_ids = {
-        0x000400000F700000, // Xenoblade Chronicles 3D [JPN]
-        0x000400000F700100, // Xenoblade Chronicles 3D [USA]
-        0x000400000F700200, // Xenoblade Chronicles 3D [EUR]
-        0x000400000F70CC00, // Fire Emblem Warriors [USA]
-        0x000400000F70CD00, // Fire Emblem Warriors [EUR]
-        0x000400000F70C100, // Fire Emblem Warriors [JPN]
-        0x000400000F700800, // The Binding of Isaac: Rebirth [USA]
-        0x000400000F701700, // The Binding of Isaac: Rebirth [JPN]
-        0x000400000F700900, // The Binding of Isaac: Rebirth [EUR]
-        0x00040000000CCE00, // Donkey Kong Country Returns 3D [USA]
-        0x00040000000CC000, // Donkey Kong Country Returns 3D [JPN]
-        0x00040000000CCF00, // Donkey Kong Country Returns 3D [EUR]
-        0x0004000000127500, // Sonic Boom: Shattered Crystal [USA]
-        0x000400000014AE00, // Sonic Boom: Shattered Crystal [JPN]
-        0x000400000012C200, // Sonic Boom: Shattered Crystal [EUR]
-        0x0004000000161300, // Sonic Boom: Fire & Ice [USA]
-        0x0004000000170700, // Sonic Boom: Fire & Ice [JPN]
-        0x0004000000164700, // Sonic Boom: Fire & Ice [EUR]
-        0x00040000000B3500, // Sonic & All-Stars Racing Transformed [USA]
-        0x000400000008FC00, // Sonic & All-Stars Racing Transformed [EUR]
-        0x00040000001B8700, // Minecraft [USA]
-        0x000400000F707F00, // Hyperlight EX [USA]
-        0x000400000008FE00, // 1001 Spikes [USA]
-        0x000400000007C700, // Mario Tennis Open
-        0x000400000007C800, // Mario Tennis Open
-        0x0004000000064D00, // Mario Tennis Open
-        0x00040000000B9100, // Mario Tennis Open
-        0x00040000000DCD00, // Mario Golf: World Tour
-        0x00040000000A5300, // Mario Golf: World Tour
-        0x00040000000DCE00, // Mario Golf: World Tour
-    };
-    for (auto id : new3ds_game_ids) {
-        if (title_id == id) {
-            Settings::values.is_new_3ds = true;
-            break;
-        }
-    }
-}
+    const Clock::time_point start = Clock::now();
+    Clock::time_point lap_start = start;
+};
 
 System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::string& filepath) {
+    BootTimer boot_timer;
     app_loader = Loader::GetLoader(filepath);
     if (!app_loader) {
         LOG_CRITICAL(Core, "Failed to obtain loader for {}!", filepath);
@@ -335,11 +203,13 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     if (app_loader->ReadProgramId(title_id) != Loader::ResultStatus::Success) {
         LOG_ERROR(Core, "Failed to find title id for ROM");
     }
-    LoadOverrides(title_id);
+    const TitleProfile title_profile = LoadTitleProfile(title_id);
+    ApplyTitleProfile(title_profile);
 
     ASSERT(system_mode.first);
     auto n3ds_mode = app_loader->LoadKernelN3dsMode();
     ASSERT(n3ds_mode.first);
+    boot_timer.Lap("Reading the ROM header");
     ResultStatus init_result = Init(emu_window, *system_mode.first, *n3ds_mode.first);
     if (init_result != ResultStatus::Success) {
         LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
@@ -347,6 +217,7 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
         System::Shutdown();
         return init_result;
     }
+    boot_timer.Lap("Initializing the system");
 
     telemetry_session->AddInitialInfo(*app_loader);
     std::shared_ptr<Kernel::Process> process;
@@ -365,6 +236,7 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
             return ResultStatus::ErrorLoader;
         }
     }
+    boot_timer.Lap("Loading the ROM");
     cheat_engine = std::make_unique<Cheats::CheatEngine>(*this);
     perf_stats = std::make_unique<PerfStats>();
 
@@ -378,14 +250,24 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     if (Settings::values.preload_textures) {
         custom_tex_cache->PreloadTextures();
     }
+    boot_timer.Lap("Loading the custom textures");
 
     status = ResultStatus::Success;
     m_emu_window = &emu_window;
     m_filepath = filepath;
 
+    // The clock level the user forces takes precedence over the tuned one
+    if (!Settings::values.core_downcount_hack) {
+        slice_tuner = std::make_unique<SliceTuner>(*timing, title_id);
+    }
+    if (title_profile.HasAutoSettings()) {
+        hack_tuner = std::make_unique<HackTuner>(*timing, *perf_stats, title_id, title_profile);
+    }
+
     // Reset counters and set time origin to current frame
     GetAndResetPerfStats();
     perf_stats->BeginSystemFrame();
+    boot_timer.Total("Loading");
     return status;
 }
 
@@ -395,6 +277,7 @@ PerfStats::Results System::GetAndResetPerfStats() {
 
 System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mode, u8 n3ds_mode) {
     LOG_DEBUG(HW_Memory, "initialized OK");
+    BootTimer boot_timer;
 
     memory = std::make_unique<Memory::MemorySystem>();
     timing = std::make_unique<Timing>();
@@ -402,10 +285,13 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
 
     if (Settings::values.use_cpu_jit) {
 #if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+        auto dynarmic_monitor = std::make_unique<DynarmicExclusiveMonitor>(cpu_cores.size());
         for (u32 i = 0; i < 4; ++i) {
-            cpu_cores[i] = std::make_shared<ARM_Dynarmic>(this, i, timing->GetTimer(i));
+            cpu_cores[i] =
+                std::make_shared<ARM_Dynarmic>(this, i, timing->GetTimer(i), *dynarmic_monitor);
             kernel->GetThreadManager(i).SetCPU(cpu_cores[i].get());
         }
+        exclusive_monitor = std::move(dynarmic_monitor);
 #else
         for (u32 i = 0; i < 4; ++i) {
             cpu_cores[i] = std::make_shared<ARM_DynCom>(this, i, timing->GetTimer(i));
@@ -432,13 +318,15 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     }
 
     memory->SetDSP(*dsp_core);
+    boot_timer.Lap("Creating the CPU and DSP cores");
 
     dsp_core->SetSink(Settings::values.sink_id, Settings::values.audio_device_id);
     dsp_core->EnableStretching(Settings::values.enable_audio_stretching);
 
     telemetry_session = std::make_unique<Core::TelemetrySession>();
 
-    rpc_server = std::make_unique<RPC::RPCServer>();
+    rpc_server = std::make_unique<RPC::RPCServer>(*this);
+    rewind_buffer = std::make_unique<Core::RewindBuffer>(*this);
 
     service_manager = std::make_unique<Service::SM::ServiceManager>(*this);
     archive_manager = std::make_unique<Service::FS::ArchiveManager>(*this);
@@ -446,6 +334,7 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
     HW::Init(*memory);
     Service::Init(*this);
     GDBStub::DeferStart();
+    boot_timer.Lap("Starting the services");
 
     VideoCore::ResultStatus result = VideoCore::Init(emu_window, *memory);
     if (result != VideoCore::ResultStatus::Success) {
@@ -458,6 +347,24 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window, u32 system_mo
             return ResultStatus::ErrorVideoCore;
         }
     }
+    boot_timer.Lap("Starting the video core");
+
+    if (Settings::values.is_new_3ds && Settings::values.use_parallel_cores) {
+        // Guest code of every core emits GPU commands, which needs the render context off the
+        // emulation thread. The interpreter keeps its exclusive monitor per core, which leaves
+        // the guest atomics racing.
+        if (!exclusive_monitor) {
+            LOG_WARNING(Core, "Parallel cores need the CPU JIT, running the cores in turn");
+        } else if (VideoCore::GetGPUThread()) {
+            std::vector<ARM_Interface*> cores;
+            for (auto& cpu_core : cpu_cores) {
+                cores.push_back(cpu_core.get());
+            }
+            core_threads = std::make_unique<CoreThreads>(*kernel, std::move(cores));
+        } else {
+            LOG_WARNING(Core, "Parallel cores need the GPU thread, running the cores in turn");
+        }
+    }
 
     return ResultStatus::Success;
 }
@@ -502,6 +409,23 @@ const Memory::MemorySystem& System::Memory() const {
     return *memory;
 }
 
+std::shared_ptr<Memory::RamSnapshot> System::TakeRamSnapshot(const Memory::RamSnapshot* base,
+                                                             bool compress) {
+    Memory::RasterizerFlushRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+    Memory::RasterizerFlushRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    return memory->TakeSnapshot(base, compress);
+}
+
+void System::RestoreRamSnapshot(const Memory::RamSnapshot& snapshot) {
+    // Surfaces with pending writes would overwrite the restored contents later on
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_N3DS_SIZE);
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+    memory->RestoreSnapshot(snapshot);
+    for (const auto& cpu : cpu_cores) {
+        cpu->ClearInstructionCache();
+    }
+}
+
 Cheats::CheatEngine& System::CheatEngine() {
     return *cheat_engine;
 }
@@ -531,30 +455,26 @@ void System::RegisterImageInterface(std::shared_ptr<Frontend::ImageInterface> im
 }
 
 void System::SetCpuUsageLimit(bool enabled) {
-    if (enabled) {
-        u32 hacks[4] = {1, 4, 2, 2};
-        for (u32 i = 0; i < 4; ++i) {
-            timing->GetTimer(i)->SetDowncountHack(hacks[i]);
-        }
-    } else {
-        for (u32 i = 0; i < 4; ++i) {
-            timing->GetTimer(i)->SetDowncountHack(0);
-        }
-    }
+    SetClockLevel(*timing, enabled ? MAX_CLOCK_LEVEL : 0);
 }
 
 void System::Shutdown() {
     // Shutdown emulation session
+    core_threads.reset();
+    slice_tuner.reset();
+    hack_tuner.reset();
     GDBStub::Shutdown();
     VideoCore::Shutdown();
     HW::Shutdown();
     telemetry_session.reset();
     perf_stats.reset();
+    rewind_buffer.reset();
     rpc_server.reset();
     cheat_engine.reset();
     archive_manager.reset();
     service_manager.reset();
     cpu_cores = {};
+    exclusive_monitor.reset();
     dsp_core.reset();
     kernel.reset();
     timing.reset();
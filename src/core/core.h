@@ -47,12 +47,21 @@ namespace Kernel {
 class KernelSystem;
 }
 
+namespace ArmTests {
+class TestEnvironment;
+}
+
 namespace Cheats {
 class CheatEngine;
 }
 
 namespace Core {
 
+class CoreThreads;
+class ExclusiveMonitor;
+class HackTuner;
+class RewindBuffer;
+class SliceTuner;
 class Timing;
 
 class System {
@@ -214,6 +223,23 @@ public:
     /// Gets a const reference to the memory system
     const Memory::MemorySystem& Memory() const;
 
+    /**
+     * Takes a snapshot of the emulated RAM, on top of a previous one when given, after the GPU
+     * wrote its cached surfaces back. The kernel, the services and the GPU state are not part of
+     * it, so it can only bring an emulation back together with those. See
+     * MemorySystem::TakeSnapshot for the compression.
+     */
+    std::shared_ptr<Memory::RamSnapshot> TakeRamSnapshot(const Memory::RamSnapshot* base = nullptr,
+                                                         bool compress = true);
+
+    /// Writes back the RAM of a snapshot, then drops the caches built from the previous contents
+    void RestoreRamSnapshot(const Memory::RamSnapshot& snapshot);
+
+    /// Gets a reference to the rewind buffer, only to be used on the emulation thread
+    Core::RewindBuffer& GetRewindBuffer() {
+        return *rewind_buffer;
+    }
+
     /// Gets a reference to the cheat engine
     Cheats::CheatEngine& CheatEngine();
 
@@ -288,6 +314,18 @@ private:
     /// ARM11 CPU core
     std::array<std::shared_ptr<ARM_Interface>, 4> cpu_cores;
 
+    /// Reservations of the exclusive accesses of every core, when the cores are JIT compiled
+    std::unique_ptr<ExclusiveMonitor> exclusive_monitor;
+
+    /// Host threads running the cores in parallel, when enabled
+    std::unique_ptr<CoreThreads> core_threads;
+
+    /// Picks the clock level of the cores from the speed the host reaches
+    std::unique_ptr<SliceTuner> slice_tuner;
+
+    /// Decides the settings the title profile leaves on auto from the frame times
+    std::unique_ptr<HackTuner> hack_tuner;
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -313,6 +351,8 @@ private:
     /// RPC Server for scripting support
     std::unique_ptr<RPC::RPCServer> rpc_server;
 
+    std::unique_ptr<Core::RewindBuffer> rewind_buffer;
+
     std::unique_ptr<Service::FS::ArchiveManager> archive_manager;
 
     std::unique_ptr<Memory::MemorySystem> memory;
@@ -320,6 +360,9 @@ private:
     std::unique_ptr<Timing> timing;
 
 private:
+    /// Sets up the memory and the kernel that the CPU core tests run on
+    friend class ArmTests::TestEnvironment;
+
     static System s_instance;
 
     ResultStatus status;
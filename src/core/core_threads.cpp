@@ -0,0 +1,51 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core_threads.h"
+#include "core/hle/kernel/kernel.h"
+
+namespace Core {
+
+CoreThreads::CoreThreads(Kernel::KernelSystem& kernel, std::vector<ARM_Interface*> cores_)
+    : kernel(kernel), cores(std::move(cores_)), slice_start(cores.size()),
+      slice_end(cores.size()) {
+    for (std::size_t i = 1; i < cores.size(); ++i) {
+        threads.emplace_back(&CoreThreads::ThreadLoop, this, cores[i]);
+    }
+    LOG_INFO(Core, "Running {} emulated cores in parallel", cores.size());
+}
+
+CoreThreads::~CoreThreads() {
+    stop_requested = true;
+    slice_start.Sync();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void CoreThreads::RunSlice() {
+    slice_start.Sync();
+    kernel.RunParallel(cores[0]);
+    slice_end.Sync();
+    kernel.FinishParallelRun();
+}
+
+void CoreThreads::ThreadLoop(ARM_Interface* core) {
+    Common::SetCurrentThreadName(fmt::format("ARM11Core{}", core->GetID()).c_str());
+    Common::SetCurrentThreadFrameCritical();
+
+    while (true) {
+        slice_start.Sync();
+        if (stop_requested) {
+            break;
+        }
+        kernel.RunParallel(core);
+        slice_end.Sync();
+    }
+}
+
+} // namespace Core
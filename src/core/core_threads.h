@@ -0,0 +1,46 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "common/thread.h"
+
+class ARM_Interface;
+
+namespace Kernel {
+class KernelSystem;
+}
+
+namespace Core {
+
+/**
+ * Host threads running the slices of the emulated cores in parallel. The first core keeps running
+ * on the emulation thread, every other one gets a thread of its own. Only guest code overlaps:
+ * timing events and rescheduling still happen between slices on the emulation thread, while
+ * syscalls are serialized by the HLE lock. The exclusive accesses of the cores go through one
+ * shared monitor, and the register handlers and rasterizer cached pages take locks of their own.
+ */
+class CoreThreads {
+public:
+    CoreThreads(Kernel::KernelSystem& kernel, std::vector<ARM_Interface*> cores);
+    ~CoreThreads();
+
+    /// Runs a slice of every core, returning once all of them reached the end of it
+    void RunSlice();
+
+private:
+    void ThreadLoop(ARM_Interface* core);
+
+    Kernel::KernelSystem& kernel;
+    std::vector<ARM_Interface*> cores;
+    std::vector<std::thread> threads;
+    Common::Barrier slice_start;
+    Common::Barrier slice_end;
+    std::atomic<bool> stop_requested{false};
+};
+
+} // namespace Core
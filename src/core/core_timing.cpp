@@ -11,6 +11,9 @@
 
 namespace Core {
 
+/// Timer of the core run by the calling thread while the emulated cores run in parallel
+static thread_local Timing::Timer* thread_timer = nullptr;
+
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
 bool Timing::Event::operator>(const Timing::Event& right) const {
     return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
@@ -39,16 +42,17 @@ TimingEventType* Timing::RegisterEvent(const std::string& name, TimedCallback ca
 void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type, u64 userdata,
                            std::size_t core_id) {
     ASSERT(event_type != nullptr);
+    Timing::Timer* const current = CurrentTimer();
     Timing::Timer* timer = nullptr;
     if (core_id == std::numeric_limits<std::size_t>::max()) {
-        timer = current_timer;
+        timer = current;
     } else {
         ASSERT(core_id < timers.size());
         timer = timers.at(core_id).get();
     }
 
     s64 timeout = timer->GetTicks() + cycles_into_future;
-    if (current_timer == timer) {
+    if (current == timer) {
         // If this event needs to be scheduled before the next advance(), force one early
         if (!timer->is_timer_sane)
             timer->ForceExceptionCheck(cycles_into_future);
@@ -64,29 +68,15 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, u64 userdata) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
+        timer->CancelEvents(
             [&](const Event& e) { return e.type == event_type && e.userdata == userdata; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
     }
     // TODO:remove events from ts_queue
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->CancelEvents([&](const Event& e) { return e.type == event_type; });
     }
     // TODO:remove events from ts_queue
 }
@@ -95,8 +85,20 @@ void Timing::SetCurrentTimer(u32 core_id) {
     current_timer = timers[core_id].get();
 }
 
+void Timing::SetThreadTimer(u32 core_id) {
+    thread_timer = timers[core_id].get();
+}
+
+void Timing::ClearThreadTimer() {
+    thread_timer = nullptr;
+}
+
+Timing::Timer* Timing::CurrentTimer() const {
+    return thread_timer ? thread_timer : current_timer;
+}
+
 s64 Timing::GetTicks() const {
-    return current_timer->GetTicks();
+    return CurrentTimer()->GetTicks();
 }
 
 s64 Timing::GetGlobalTicks() const {
@@ -117,6 +119,14 @@ s64 Timing::GetMaxSliceLength() const {
     return max_slice;
 }
 
+s64 Timing::GetIdleSliceLength() const {
+    s64 idle_slice = std::numeric_limits<s64>::max();
+    for (const auto& timer : timers) {
+        idle_slice = std::min(idle_slice, timer->GetMaxSliceLength());
+    }
+    return idle_slice;
+}
+
 std::chrono::microseconds Timing::GetGlobalTimeUs() const {
     return std::chrono::microseconds{GetTicks() * 1000000 / BASE_CLOCK_RATE_ARM11};
 }
@@ -157,6 +167,14 @@ void Timing::Timer::MoveEvents() {
     }
 }
 
+void Timing::Timer::PopCancelledEvents() {
+    while (!event_queue.empty() && event_queue.front().type == nullptr) {
+        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.pop_back();
+        --cancelled_events;
+    }
+}
+
 s64 Timing::Timer::GetMaxSliceLength() const {
     const auto& next_event = event_queue.begin();
     if (next_event != event_queue.end()) {
@@ -179,6 +197,7 @@ void Timing::Timer::Advance(s64 max_slice_length) {
         Event evt = std::move(event_queue.front());
         std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
         event_queue.pop_back();
+        PopCancelledEvents();
         evt.type->callback(evt.userdata, executed_ticks - evt.time);
     }
 
@@ -198,6 +217,13 @@ void Timing::Timer::Idle() {
     downcount = 0;
 }
 
+void Timing::Timer::Skip(s64 length) {
+    if (length > slice_length) {
+        slice_length = length;
+        downcount = length;
+    }
+}
+
 s64 Timing::Timer::GetDowncount() const {
     return downcount;
 }
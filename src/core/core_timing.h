@@ -17,6 +17,7 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <limits>
@@ -149,6 +150,12 @@ public:
 
         void Idle();
 
+        /**
+         * Lengthens the slice prepared by Advance to the given number of ticks, for a core that has
+         * nothing to run until then. Shorter lengths are ignored.
+         */
+        void Skip(s64 length);
+
         s64 GetTicks() const;
 
         void AddTicks(u64 ticks);
@@ -165,11 +172,40 @@ public:
 
     private:
         friend class Timing;
+
+        /**
+         * Cancels the queued events matching the predicate. They stay in the heap with a null type
+         * until they reach its top, since neither their time nor their order changes.
+         */
+        template <typename Predicate>
+        void CancelEvents(Predicate&& predicate) {
+            for (Event& event : event_queue) {
+                if (event.type != nullptr && predicate(event)) {
+                    event.type = nullptr;
+                    ++cancelled_events;
+                }
+            }
+            // Rebuild once most of the queue is cancelled, so that it doesn't grow unbounded
+            if (cancelled_events * 2 > event_queue.size()) {
+                event_queue.erase(std::remove_if(event_queue.begin(), event_queue.end(),
+                                                 [](const Event& e) { return e.type == nullptr; }),
+                                  event_queue.end());
+                std::make_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+                cancelled_events = 0;
+            }
+            PopCancelledEvents();
+        }
+
+        /// Removes the cancelled events from the top of the heap, so that it is always a live one
+        void PopCancelledEvents();
+
         // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
         // We don't use std::priority_queue because we need to be able to serialize, unserialize and
         // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
         // accomodated by the standard adaptor class.
         std::vector<Event> event_queue;
+        /// Events of the queue cancelled in place
+        std::size_t cancelled_events = 0;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
         // to the event_queue by the emu thread
@@ -209,6 +245,10 @@ public:
 
     void SetCurrentTimer(u32 core_id);
 
+    /// Makes the timer of a core current for the calling thread only, for the parallel slices
+    void SetThreadTimer(u32 core_id);
+    void ClearThreadTimer();
+
     s64 GetTicks() const;
 
     s64 GetGlobalTicks() const;
@@ -217,6 +257,9 @@ public:
 
     s64 GetMaxSliceLength() const;
 
+    /// Ticks until the first event of any core, not limited to MAX_SLICE_LENGTH
+    s64 GetIdleSliceLength() const;
+
     void AddToGlobalTicks(s64 ticks) {
         global_timer += ticks;
     }
@@ -232,6 +275,8 @@ private:
     // elements remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, TimingEventType> event_types;
 
+    Timer* CurrentTimer() const;
+
     std::array<std::shared_ptr<Timer>, 4> timers;
     Timer* current_timer = nullptr;
 };
@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <fmt/format.h>
 #include "common/file_util.h"
+#include "common/thread.h"
 #include "core.h"
 #include "core/custom_tex_cache.h"
 
@@ -40,14 +42,137 @@ static void FlipCustomTexture(u32* pixels, u32 width, u32 height) {
 
 CustomTexCache::CustomTexCache() = default;
 
-CustomTexCache::~CustomTexCache() = default;
+CustomTexCache::~CustomTexCache() {
+    {
+        std::lock_guard lock{mutex};
+        stop_requested = true;
+        jobs.clear();
+    }
+    jobs_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
 
-bool CustomTexCache::IsTextureCached(u64 hash) const {
-    return custom_textures.find(hash) != custom_textures.end();
+std::shared_ptr<const CustomTexInfo> CustomTexCache::GetTexture(u64 hash, u32 packed_formats) {
+    std::lock_guard lock{mutex};
+    if (auto packed = FindPackedTexture(hash, packed_formats)) {
+        return packed;
+    }
+    const auto it = custom_textures.find(hash);
+    if (it == custom_textures.end()) {
+        QueueTexture(hash, false);
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second.lru_entry);
+    return it->second.info;
 }
 
-const CustomTexInfo& CustomTexCache::LookupTexture(u64 hash) const {
-    return custom_textures.at(hash);
+std::shared_ptr<const CustomTexInfo> CustomTexCache::FindPackedTexture(u64 hash,
+                                                                       u32 packed_formats) {
+    const auto it = packed_textures.find(hash);
+    if (it != packed_textures.end()) {
+        return it->second;
+    }
+    for (const auto& pack : packs) {
+        const auto texture = pack->FindTexture(hash);
+        if (!texture || !(packed_formats & (1u << static_cast<u32>(texture->format)))) {
+            continue;
+        }
+        auto tex_info = std::make_shared<CustomTexInfo>();
+        tex_info->hash = hash;
+        tex_info->width = texture->width;
+        tex_info->height = texture->height;
+        tex_info->format = texture->format;
+        tex_info->packed_data = texture->data;
+        tex_info->packed_size =
+            GetCustomTexLevelSize(texture->format, texture->width, texture->height);
+        tex_info->pack = pack;
+        LOG_DEBUG(Render_OpenGL, "Loaded custom texture {:016X} from {}", hash, pack->GetPath());
+        return packed_textures[hash] = std::move(tex_info);
+    }
+    return nullptr;
+}
+
+bool CustomTexCache::IsTextureReady(u64 hash) const {
+    std::lock_guard lock{mutex};
+    return custom_textures.count(hash) != 0;
+}
+
+void CustomTexCache::QueueTexture(u64 hash, bool preload) {
+    const auto path = custom_texture_paths.find(hash);
+    if (path == custom_texture_paths.end() || started_textures.count(hash)) {
+        return;
+    }
+
+    // Textures a draw is waiting for go before the preloaded ones, even if they were queued for
+    // preloading already
+    if (preload) {
+        if (!preloaded_textures.insert(hash).second) {
+            return;
+        }
+        jobs.push_back({&path->second, true});
+    } else {
+        if (!requested_textures.insert(hash).second) {
+            return;
+        }
+        jobs.push_front({&path->second, false});
+    }
+
+    if (workers.empty()) {
+        const std::size_t num_workers =
+            std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            workers.emplace_back(&CustomTexCache::WorkerLoop, this);
+        }
+    }
+    jobs_cv.notify_one();
+}
+
+void CustomTexCache::WorkerLoop() {
+    Common::SetCurrentThreadName("CustomTexWorker");
+    std::unique_lock lock{mutex};
+    while (true) {
+        jobs_cv.wait(lock, [this] { return stop_requested || !jobs.empty(); });
+        if (stop_requested) {
+            return;
+        }
+        const Job job = jobs.front();
+        jobs.pop_front();
+        const u64 hash = job.path_info->hash;
+        if (!started_textures.insert(hash).second) {
+            continue;
+        }
+
+        // Preloading stops at the budget, so that it does not evict what it loaded itself
+        if (job.preload && memory_usage >= MemoryBudget) {
+            started_textures.erase(hash);
+            continue;
+        }
+
+        lock.unlock();
+        std::shared_ptr<const CustomTexInfo> info = DecodeTexture(*job.path_info);
+        lock.lock();
+
+        // Unusable textures stay marked as started, so that they are not decoded again
+        if (!info) {
+            continue;
+        }
+        lru.push_front(hash);
+        memory_usage += info->tex.size();
+        custom_textures[hash] = {std::move(info), lru.begin()};
+
+        while (memory_usage > MemoryBudget && lru.size() > 1) {
+            const u64 evicted_hash = lru.back();
+            const auto evicted = custom_textures.find(evicted_hash);
+            memory_usage -= evicted->second.info->tex.size();
+            custom_textures.erase(evicted);
+            lru.pop_back();
+            started_textures.erase(evicted_hash);
+            preloaded_textures.erase(evicted_hash);
+            requested_textures.erase(evicted_hash);
+        }
+    }
 }
 
 void CustomTexCache::AddTexturePath(u64 hash, const std::string& path) {
@@ -60,6 +185,7 @@ void CustomTexCache::AddTexturePath(u64 hash, const std::string& path) {
 void CustomTexCache::FindCustomTextures(u64 program_id) {
     // Custom textures are currently stored as
     // [TitleID]/tex1_[width]x[height]_[64-bit hash]_[format].png
+    // or in packs, [TitleID]/[name].ctp
 
     const std::string load_path = fmt::format(
         "{}textures/{:016X}", FileUtil::GetUserPath(FileUtil::UserPath::LoadDir), program_id);
@@ -74,6 +200,13 @@ void CustomTexCache::FindCustomTextures(u64 program_id) {
         for (const auto& file : textures) {
             if (file.isDirectory)
                 continue;
+            const std::string& name = file.virtualName;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".ctp") == 0) {
+                if (auto pack = CustomTexPack::Open(file.physicalName)) {
+                    packs.push_back(std::move(pack));
+                }
+                continue;
+            }
             if (file.virtualName.substr(0, 5) != "tex1_")
                 continue;
 
@@ -90,28 +223,37 @@ void CustomTexCache::FindCustomTextures(u64 program_id) {
 }
 
 void CustomTexCache::PreloadTextures() {
+    std::lock_guard lock{mutex};
     for (const auto& path : custom_texture_paths) {
-        LoadTexture(path.second);
+        const bool packed = std::any_of(packs.begin(), packs.end(), [&path](const auto& pack) {
+            return pack->FindTexture(path.first).has_value();
+        });
+        if (!packed) {
+            QueueTexture(path.first, true);
+        }
     }
 }
 
-void CustomTexCache::LoadTexture(const CustomTexPathInfo& path_info) {
+std::shared_ptr<CustomTexInfo> CustomTexCache::DecodeTexture(const CustomTexPathInfo& path_info) {
     const auto& image_interface = Core::System::GetInstance().GetImageInterface();
-    auto& tex_info = custom_textures[path_info.hash];
-    if (image_interface->DecodePNG(tex_info.tex, tex_info.width, tex_info.height, path_info.path)) {
-        // Make sure the texture size is a power of 2
-        if (!(tex_info.width & (tex_info.width - 1)) &&
-            !(tex_info.height & (tex_info.height - 1))) {
-            LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
-            FlipCustomTexture(reinterpret_cast<u32*>(tex_info.tex.data()), tex_info.width, tex_info.height);
-            tex_info.hash = path_info.hash;
-        } else {
-            LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
-            custom_textures.erase(path_info.hash);
-        }
-    } else {
+    auto tex_info = std::make_shared<CustomTexInfo>();
+    if (!image_interface->DecodePNG(tex_info->tex, tex_info->width, tex_info->height,
+                                    path_info.path)) {
         LOG_ERROR(Render_OpenGL, "Failed to load custom texture {}", path_info.path);
+        return nullptr;
     }
+
+    // Make sure the texture size is a power of 2
+    if ((tex_info->width & (tex_info->width - 1)) || (tex_info->height & (tex_info->height - 1))) {
+        LOG_ERROR(Render_OpenGL, "Texture {} size is not a power of 2", path_info.path);
+        return nullptr;
+    }
+
+    LOG_DEBUG(Render_OpenGL, "Loaded custom texture from {}", path_info.path);
+    FlipCustomTexture(reinterpret_cast<u32*>(tex_info->tex.data()), tex_info->width,
+                      tex_info->height);
+    tex_info->hash = path_info.hash;
+    return tex_info;
 }
 
 bool CustomTexCache::CustomTextureExists(u64 hash) const {
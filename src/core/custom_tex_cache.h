@@ -4,11 +4,18 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include "common/common_types.h"
+#include "core/custom_tex_pack.h"
 
 namespace Frontend {
 class ImageInterface;
@@ -19,7 +26,17 @@ struct CustomTexInfo {
     u64 hash;
     u32 width;
     u32 height;
+    CustomTexFormat format = CustomTexFormat::RGBA8;
+    /// Decoded texture, empty for the textures of packs
     std::vector<u8> tex;
+    /// Mapped level 0 of the textures of packs, which is kept alive with the texture
+    const u8* packed_data = nullptr;
+    std::size_t packed_size = 0;
+    std::shared_ptr<const CustomTexPack> pack;
+
+    const u8* GetData() const {
+        return pack ? packed_data : tex.data();
+    }
 };
 
 // This is to avoid parsing the filename multiple times
@@ -29,23 +46,84 @@ struct CustomTexPathInfo {
 };
 
 // TODO: think of a better name for this class...
+/**
+ * Custom textures found for the title, decoded by a pool of worker threads so that neither the
+ * boot nor the draws wait for the PNG decoder. Decoded textures are kept up to a memory budget,
+ * beyond it the least recently used ones are dropped. Surfaces keep the textures they use alive.
+ * Textures found in packs are mapped instead, and take precedence over the PNG files.
+ */
 class CustomTexCache {
 public:
     explicit CustomTexCache();
     ~CustomTexCache();
 
-    bool IsTextureCached(u64 hash) const;
-    const CustomTexInfo& LookupTexture(u64 hash) const;
+    /**
+     * Returns the texture, or nullptr and queues its decode if it is not ready yet.
+     * @param packed_formats Mask of the CustomTexFormat bits the GPU can sample, the textures of
+     *                       packs in other formats are decoded from their PNG file if there is one
+     */
+    std::shared_ptr<const CustomTexInfo> GetTexture(u64 hash, u32 packed_formats);
+
+    /// Returns true if the texture is decoded, without counting as a use
+    bool IsTextureReady(u64 hash) const;
 
     void AddTexturePath(u64 hash, const std::string& path);
     void FindCustomTextures(u64 program_id);
+
+    /**
+     * Queues the decode of every texture that is not in a pack, decoding stops once the memory
+     * budget is used up
+     */
     void PreloadTextures();
-    void LoadTexture(const CustomTexPathInfo& path_info);
+
+    /// Returns true if there is a PNG file to decode for the texture
     bool CustomTextureExists(u64 hash) const;
     const CustomTexPathInfo& LookupTexturePathInfo(u64 hash) const;
 
 private:
-    std::unordered_map<u64, CustomTexInfo> custom_textures;
+    /// Bytes of decoded textures kept in memory
+    static constexpr std::size_t MemoryBudget = 512 * 1024 * 1024;
+
+    struct CachedTexture {
+        std::shared_ptr<const CustomTexInfo> info;
+        std::list<u64>::iterator lru_entry;
+    };
+
+    struct Job {
+        const CustomTexPathInfo* path_info;
+        bool preload;
+    };
+
+    /// Queues a texture unless it is started or queued already, requires the mutex
+    void QueueTexture(u64 hash, bool preload);
+
+    void WorkerLoop();
+
+    /// Decodes and flips a texture, returns nullptr if it is unusable
+    static std::shared_ptr<CustomTexInfo> DecodeTexture(const CustomTexPathInfo& path_info);
+
+    /// Returns the texture of the first pack that has it in one of the given formats
+    std::shared_ptr<const CustomTexInfo> FindPackedTexture(u64 hash, u32 packed_formats);
+
+    /// Only filled before the workers start
     std::unordered_map<u64, CustomTexPathInfo> custom_texture_paths;
+    std::vector<std::shared_ptr<CustomTexPack>> packs;
+    /// Textures of packs that were used, they don't count against the budget as they are mapped
+    std::unordered_map<u64, std::shared_ptr<const CustomTexInfo>> packed_textures;
+
+    mutable std::mutex mutex;
+    std::unordered_map<u64, CachedTexture> custom_textures;
+    /// Hashes of the decoded textures, most recently used first
+    std::list<u64> lru;
+    std::size_t memory_usage = 0;
+    /// Textures queued for preloading and on demand, a texture can be queued for both
+    std::unordered_set<u64> preloaded_textures;
+    std::unordered_set<u64> requested_textures;
+    /// Textures being decoded, decoded or that failed to decode
+    std::unordered_set<u64> started_textures;
+    std::deque<Job> jobs;
+    std::condition_variable jobs_cv;
+    bool stop_requested = false;
+    std::vector<std::thread> workers;
 };
 } // namespace Core
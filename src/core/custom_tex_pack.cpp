@@ -0,0 +1,96 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/custom_tex_pack.h"
+
+namespace Core {
+
+u32 GetCustomTexBlockSize(CustomTexFormat format) {
+    switch (format) {
+    case CustomTexFormat::BC7:
+    case CustomTexFormat::ASTC4x4:
+        return 4;
+    case CustomTexFormat::ASTC6x6:
+        return 6;
+    case CustomTexFormat::ASTC8x8:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+std::size_t GetCustomTexLevelSize(CustomTexFormat format, u32 width, u32 height) {
+    if (format == CustomTexFormat::RGBA8) {
+        return static_cast<std::size_t>(width) * height * 4;
+    }
+    const u32 block_size = GetCustomTexBlockSize(format);
+    const std::size_t blocks_x = (width + block_size - 1) / block_size;
+    const std::size_t blocks_y = (height + block_size - 1) / block_size;
+    return blocks_x * blocks_y * 16;
+}
+
+std::shared_ptr<CustomTexPack> CustomTexPack::Open(const std::string& path) {
+    auto file = std::make_unique<FileUtil::MappedFile>(path);
+    if (!file->IsOpen() || file->GetSize() < sizeof(Header)) {
+        LOG_ERROR(Core, "Failed to open custom texture pack {}", path);
+        return nullptr;
+    }
+
+    Header header;
+    std::memcpy(&header, file->GetData(), sizeof(Header));
+    if (header.magic != Magic || header.version != Version) {
+        LOG_ERROR(Core, "{} is not a custom texture pack of version {}", path, Version);
+        return nullptr;
+    }
+    if ((file->GetSize() - sizeof(Header)) / sizeof(Entry) < header.num_entries) {
+        LOG_ERROR(Core, "Custom texture pack {} is truncated", path);
+        return nullptr;
+    }
+    return std::make_shared<CustomTexPack>(path, std::move(file));
+}
+
+CustomTexPack::CustomTexPack(std::string path, std::unique_ptr<FileUtil::MappedFile> file)
+    : path(std::move(path)), file(std::move(file)) {
+    // The entries follow the 16 byte header, so they are aligned in the mapping
+    entries = reinterpret_cast<const Entry*>(this->file->GetData() + sizeof(Header));
+    num_entries = reinterpret_cast<const Header*>(this->file->GetData())->num_entries;
+}
+
+CustomTexPack::~CustomTexPack() = default;
+
+std::optional<CustomTexPack::Texture> CustomTexPack::FindTexture(u64 hash) const {
+    const Entry* end = entries + num_entries;
+    const Entry* entry = std::lower_bound(
+        entries, end, hash, [](const Entry& entry, u64 hash) { return entry.hash < hash; });
+    if (entry == end || entry->hash != hash) {
+        return std::nullopt;
+    }
+
+    const u32 format = entry->format;
+    const u32 width = entry->width;
+    const u32 height = entry->height;
+    const u64 offset = entry->offset;
+    const u32 size = entry->size;
+    if (format >= NumCustomTexFormats || width == 0 || height == 0 || entry->num_levels == 0 ||
+        offset > file->GetSize() || size > file->GetSize() - offset ||
+        GetCustomTexLevelSize(static_cast<CustomTexFormat>(format), width, height) > size) {
+        LOG_ERROR(Core, "Texture {:016X} of custom texture pack {} is malformed", hash, path);
+        return std::nullopt;
+    }
+
+    Texture texture;
+    texture.format = static_cast<CustomTexFormat>(format);
+    texture.width = width;
+    texture.height = height;
+    texture.num_levels = entry->num_levels;
+    texture.data = file->GetData() + offset;
+    texture.size = size;
+    return texture;
+}
+
+} // namespace Core
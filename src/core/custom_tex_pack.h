@@ -0,0 +1,100 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include "common/common_types.h"
+#include "common/swap.h"
+
+namespace FileUtil {
+class MappedFile;
+} // namespace FileUtil
+
+namespace Core {
+
+/// Formats of the textures in a pack, the values are stored in the pack files
+enum class CustomTexFormat : u32 {
+    RGBA8 = 0,
+    BC7 = 1,
+    ASTC4x4 = 2,
+    ASTC6x6 = 3,
+    ASTC8x8 = 4,
+};
+
+constexpr u32 NumCustomTexFormats = 5;
+
+/// Returns the width and height of the blocks of a format, which always take 16 bytes
+u32 GetCustomTexBlockSize(CustomTexFormat format);
+
+/// Returns the size in bytes of a mipmap level, in blocks of 16 bytes for compressed formats
+std::size_t GetCustomTexLevelSize(CustomTexFormat format, u32 width, u32 height);
+
+/**
+ * Packs hold the custom textures of a title already encoded in the format the GPU samples, so
+ * that they are memory mapped and uploaded as they are instead of being decoded from PNG. A pack
+ * is a header, the entries sorted by hash, then the mipmap levels of every texture one after the
+ * other, the largest first. The images are stored bottom row first, as OpenGL expects them.
+ * Packs are written by dist/tools/pack_custom_textures.py.
+ */
+class CustomTexPack {
+public:
+    /// "CTPK"
+    static constexpr u32 Magic = 0x4B505443;
+    static constexpr u32 Version = 1;
+
+    struct Header {
+        u32_le magic;
+        u32_le version;
+        u32_le num_entries;
+        u32_le reserved;
+    };
+    static_assert(sizeof(Header) == 16, "CustomTexPack::Header has incorrect size");
+
+    struct Entry {
+        u64_le hash;
+        u32_le format;
+        u16_le width;
+        u16_le height;
+        u32_le num_levels;
+        /// Bytes of all the levels
+        u32_le size;
+        /// From the start of the file
+        u64_le offset;
+    };
+    static_assert(sizeof(Entry) == 32, "CustomTexPack::Entry has incorrect size");
+
+    /// A texture in the mapped pack, valid as long as the pack is alive
+    struct Texture {
+        CustomTexFormat format;
+        u32 width;
+        u32 height;
+        u32 num_levels;
+        const u8* data;
+        std::size_t size;
+    };
+
+    /// Maps a pack, returns nullptr if it is missing or malformed
+    static std::shared_ptr<CustomTexPack> Open(const std::string& path);
+
+    CustomTexPack(std::string path, std::unique_ptr<FileUtil::MappedFile> file);
+    ~CustomTexPack();
+
+    /// Returns the texture with the given hash if the pack has a valid one
+    std::optional<Texture> FindTexture(u64 hash) const;
+
+    const std::string& GetPath() const {
+        return path;
+    }
+
+private:
+    std::string path;
+    std::unique_ptr<FileUtil::MappedFile> file;
+    const Entry* entries = nullptr;
+    u32 num_entries = 0;
+};
+
+} // namespace Core
@@ -12,11 +12,7 @@ VideoFrame::VideoFrame(std::size_t width_, std::size_t height_, u8* data_)
     // While copying, rotate the image to put the pixels in correct order
     // (As OpenGL returns pixel data starting from the lowest position)
     for (std::size_t i = 0; i < height; i++) {
-        for (std::size_t j = 0; j < width; j++) {
-            for (std::size_t k = 0; k < 4; k++) {
-                data[i * stride + j * 4 + k] = data_[(height - i - 1) * stride + j * 4 + k];
-            }
-        }
+        std::memcpy(&data[i * stride], &data_[(height - i - 1) * stride], stride);
     }
 }
 
@@ -452,7 +452,13 @@ bool FFmpegBackend::StartDumping(const std::string& path, const std::string& for
 
 void FFmpegBackend::AddVideoFrame(const VideoFrame& frame) {
     event1.Wait();
-    video_frame_buffers[next_buffer] = std::move(frame);
+    // Copied into the buffer the encoder is done with, which keeps its allocation from the
+    // previous frames of the same size
+    VideoFrame& buffer = video_frame_buffers[next_buffer];
+    buffer.width = frame.width;
+    buffer.height = frame.height;
+    buffer.stride = frame.stride;
+    buffer.data.assign(frame.data.begin(), frame.data.end());
     event2.Set();
 }
 
@@ -158,6 +158,14 @@ public:
      */
     virtual u64 GetFreeBytes() const = 0;
 
+    /**
+     * Writes out the data held back by the files of the archive, as save data is committed
+     * @return Result of the operation
+     */
+    virtual ResultCode Commit() const {
+        return RESULT_SUCCESS;
+    }
+
     u64 GetOpenDelayNs() {
         if (delay_generator != nullptr) {
             return delay_generator->GetOpenDelayNs();
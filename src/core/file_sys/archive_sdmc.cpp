@@ -92,6 +92,7 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
         } else {
             // Create the file
             FileUtil::CreateEmptyFile(full_path);
+            DirectoryCache::Get().Invalidate(full_path);
         }
         break;
     case PathParser::FileFound:
@@ -105,7 +106,8 @@ ResultVal<std::unique_ptr<FileBackend>> SDMCArchive::OpenFileBase(const Path& pa
     }
 
     std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SDMCDelayGenerator>();
-    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator),
+                                                nullptr, full_path);
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
 
@@ -136,6 +138,7 @@ ResultCode SDMCArchive::DeleteFile(const Path& path) const {
     }
 
     if (FileUtil::Delete(full_path)) {
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
@@ -163,6 +166,8 @@ ResultCode SDMCArchive::RenameFile(const Path& src_path, const Path& dest_path)
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
     if (FileUtil::Rename(src_path_full, dest_path_full)) {
+        DirectoryCache::Get().Invalidate(src_path_full);
+        DirectoryCache::Get().Invalidate(dest_path_full);
         return RESULT_SUCCESS;
     }
 
@@ -204,6 +209,7 @@ static ResultCode DeleteDirectoryHelper(const Path& path, const std::string& mou
     }
 
     if (deleter(full_path)) {
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
@@ -250,10 +256,12 @@ ResultCode SDMCArchive::CreateFile(const FileSys::Path& path, u64 size) const {
 
     if (size == 0) {
         FileUtil::CreateEmptyFile(full_path);
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
     FileUtil::IOFile file(full_path, "wb");
+    DirectoryCache::Get().Invalidate(full_path);
     // Creates a sparse file (or a normal file on filesystems without the concept of sparse files)
     // We do this by seeking to the right size, then writing a single null byte.
     if (file.Seek(size - 1, SEEK_SET) && file.WriteBytes("", 1) == 1) {
@@ -292,6 +300,7 @@ ResultCode SDMCArchive::CreateDirectory(const Path& path) const {
     }
 
     if (FileUtil::CreateDir(mount_point + path.AsString())) {
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
@@ -320,6 +329,8 @@ ResultCode SDMCArchive::RenameDirectory(const Path& src_path, const Path& dest_p
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
     if (FileUtil::Rename(src_path_full, dest_path_full)) {
+        DirectoryCache::Get().Invalidate(src_path_full);
+        DirectoryCache::Get().Invalidate(dest_path_full);
         return RESULT_SUCCESS;
     }
 
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -16,13 +18,154 @@
 
 namespace FileSys {
 
+/// Writes this large go out right away, as do the pending ones once they add up to it
+constexpr std::size_t WriteBackMaxBytes = 0x40000;
+/// Age after which the pending writes go out with the next write
+constexpr std::chrono::seconds WriteBackMaxAge{5};
+/// Age after which a directory is scanned again, for the changes not made by the archives
+constexpr std::chrono::seconds DirectoryListingMaxAge{5};
+/// Listings kept before all of them are dropped
+constexpr std::size_t MaxDirectoryListings = 256;
+
+/// Cuts the trailing separators, a directory is cached under one name
+static std::string NormalizeDirectoryPath(const std::string& path) {
+    std::size_t end = path.size();
+    while (end > 1 && path[end - 1] == '/') {
+        --end;
+    }
+    return path.substr(0, end);
+}
+
+DirectoryCache& DirectoryCache::Get() {
+    static DirectoryCache cache;
+    return cache;
+}
+
+std::shared_ptr<const FileUtil::FSTEntry> DirectoryCache::GetListing(const std::string& path) {
+    const std::string key = NormalizeDirectoryPath(path);
+    const auto now = std::chrono::steady_clock::now();
+    u64 scan_generation;
+    {
+        std::lock_guard lock{mutex};
+        const auto it = listings.find(key);
+        if (it != listings.end() && now - it->second.scan_time < DirectoryListingMaxAge) {
+            return it->second.entry;
+        }
+        scan_generation = generation;
+    }
+
+    auto entry = std::make_shared<FileUtil::FSTEntry>();
+    entry->size = FileUtil::ScanDirectoryTree(key, *entry);
+    entry->isDirectory = true;
+
+    std::lock_guard lock{mutex};
+    if (generation == scan_generation) {
+        if (listings.size() >= MaxDirectoryListings) {
+            listings.clear();
+        }
+        listings.insert_or_assign(key, Listing{entry, now});
+    }
+    return entry;
+}
+
+void DirectoryCache::Invalidate(const std::string& path) {
+    const std::string key = NormalizeDirectoryPath(path);
+    std::lock_guard lock{mutex};
+    ++generation;
+    if (listings.empty()) {
+        return;
+    }
+    const std::size_t separator = key.rfind('/');
+    if (separator != std::string::npos) {
+        listings.erase(key.substr(0, std::max<std::size_t>(separator, 1)));
+    }
+    // The directories below come right after the directory itself, as '0' follows '/'
+    listings.erase(listings.lower_bound(key), listings.lower_bound(key + '0'));
+}
+
+namespace {
+/// The caches of every archive, for the flush of the stale writes
+struct WriteBackCaches {
+    std::mutex mutex;
+    std::set<WriteBackCache*> caches;
+};
+
+WriteBackCaches& GetWriteBackCaches() {
+    static WriteBackCaches caches;
+    return caches;
+}
+} // Anonymous namespace
+
+WriteBackCache::WriteBackCache() {
+    auto& registry = GetWriteBackCaches();
+    std::lock_guard lock{registry.mutex};
+    registry.caches.insert(this);
+}
+
+WriteBackCache::~WriteBackCache() {
+    auto& registry = GetWriteBackCaches();
+    std::lock_guard lock{registry.mutex};
+    registry.caches.erase(this);
+}
+
+void WriteBackCache::FlushAll() {
+    std::lock_guard lock{mutex};
+    for (const DiskFile* file : dirty_files) {
+        file->WritePending();
+    }
+    dirty_files.clear();
+}
+
+void WriteBackCache::FlushStale() {
+    const auto now = std::chrono::steady_clock::now();
+    auto& registry = GetWriteBackCaches();
+    std::lock_guard registry_lock{registry.mutex};
+    for (WriteBackCache* cache : registry.caches) {
+        std::lock_guard lock{cache->mutex};
+        for (auto it = cache->dirty_files.begin(); it != cache->dirty_files.end();) {
+            if (now - (*it)->pending_since >= WriteBackMaxAge) {
+                (*it)->WritePending();
+                it = cache->dirty_files.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+DiskFile::~DiskFile() {
+    std::lock_guard lock{mutex};
+    FlushPending();
+}
+
 ResultVal<std::size_t> DiskFile::Read(const u64 offset, const std::size_t length,
                                       u8* buffer) const {
     if (!mode.read_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
+    std::lock_guard lock{mutex};
     file->Seek(offset, SEEK_SET);
-    return MakeResult<std::size_t>(file->ReadBytes(buffer, length));
+    std::size_t read = file->ReadBytes(buffer, length);
+    if (pending.empty() || read > length)
+        return MakeResult<std::size_t>(read);
+
+    // The pending writes are laid over the data read, and may extend the file
+    const u64 end = offset + length;
+    auto it = pending.upper_bound(offset);
+    if (it != pending.begin() && std::prev(it)->first + std::prev(it)->second.size() > offset) {
+        --it;
+    }
+    for (; it != pending.end() && it->first < end; ++it) {
+        const u64 copy_start = std::max(it->first, offset);
+        const u64 copy_end = std::min(it->first + it->second.size(), end);
+        if (copy_end - offset > read) {
+            std::memset(buffer + read, 0, copy_end - offset - read);
+            read = copy_end - offset;
+        }
+        std::memcpy(buffer + (copy_start - offset), it->second.data() + (copy_start - it->first),
+                    copy_end - copy_start);
+    }
+    return MakeResult<std::size_t>(read);
 }
 
 ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t length, const bool flush,
@@ -30,40 +173,140 @@ ResultVal<std::size_t> DiskFile::Write(const u64 offset, const std::size_t lengt
     if (!mode.write_flag)
         return ERROR_INVALID_OPEN_FLAGS;
 
+    std::lock_guard lock{mutex};
+    // The flush flag is honoured by the commit, as data is only safe on the 3DS once committed
+    if (write_back && length < WriteBackMaxBytes) {
+        AddPending(offset, length, buffer);
+        if (pending_bytes >= WriteBackMaxBytes ||
+            std::chrono::steady_clock::now() - pending_since >= WriteBackMaxAge) {
+            FlushPending();
+        }
+        return MakeResult<std::size_t>(length);
+    }
+
+    FlushPending();
     file->Seek(offset, SEEK_SET);
     std::size_t written = file->WriteBytes(buffer, length);
     if (flush)
         file->Flush();
+    InvalidateListing();
     return MakeResult<std::size_t>(written);
 }
 
+void DiskFile::InvalidateListing() const {
+    if (!path.empty()) {
+        DirectoryCache::Get().Invalidate(path);
+    }
+}
+
+void DiskFile::AddPending(const u64 offset, const std::size_t length, const u8* buffer) {
+    if (pending.empty()) {
+        pending_since = std::chrono::steady_clock::now();
+        write_back->dirty_files.insert(this);
+    }
+
+    // Find the writes this one overlaps or touches, and merge them all in one
+    const u64 end = offset + length;
+    auto first = pending.upper_bound(offset);
+    if (first != pending.begin() &&
+        std::prev(first)->first + std::prev(first)->second.size() >= offset) {
+        --first;
+    }
+    u64 merged_start = offset;
+    u64 merged_end = end;
+    auto last = first;
+    for (; last != pending.end() && last->first <= end; ++last) {
+        merged_start = std::min(merged_start, last->first);
+        merged_end = std::max<u64>(merged_end, last->first + last->second.size());
+    }
+
+    std::vector<u8> merged;
+    auto it = first;
+    if (first != last && first->first == merged_start) {
+        // Mostly the write appends to the previous one, whose buffer gets reused
+        pending_bytes -= first->second.size();
+        merged = std::move(first->second);
+        ++it;
+    }
+    merged.resize(merged_end - merged_start);
+    for (; it != last; ++it) {
+        std::memcpy(merged.data() + (it->first - merged_start), it->second.data(),
+                    it->second.size());
+        pending_bytes -= it->second.size();
+    }
+    std::memcpy(merged.data() + (offset - merged_start), buffer, length);
+    pending.erase(first, last);
+    pending_bytes += merged.size();
+    pending.emplace(merged_start, std::move(merged));
+}
+
+void DiskFile::WritePending() const {
+    if (pending.empty())
+        return;
+
+    for (const auto& [offset, data] : pending) {
+        file->Seek(offset, SEEK_SET);
+        if (file->WriteBytes(data.data(), data.size()) != data.size()) {
+            LOG_ERROR(Service_FS, "Could not write back 0x{:X} bytes at 0x{:X}", data.size(),
+                      offset);
+        }
+    }
+    file->Flush();
+    pending.clear();
+    pending_bytes = 0;
+    InvalidateListing();
+}
+
+void DiskFile::FlushPending() const {
+    if (pending.empty())
+        return;
+
+    WritePending();
+    write_back->dirty_files.erase(this);
+}
+
 u64 DiskFile::GetSize() const {
-    return file->GetSize();
+    std::lock_guard lock{mutex};
+    u64 size = file->GetSize();
+    if (!pending.empty()) {
+        const auto& [offset, data] = *pending.rbegin();
+        size = std::max<u64>(size, offset + data.size());
+    }
+    return size;
 }
 
 bool DiskFile::SetSize(const u64 size) const {
+    std::lock_guard lock{mutex};
+    FlushPending();
     file->Resize(size);
     file->Flush();
+    InvalidateListing();
     return true;
 }
 
 bool DiskFile::Close() const {
+    std::lock_guard lock{mutex};
+    FlushPending();
     return file->Close();
 }
 
+void DiskFile::Flush() const {
+    std::lock_guard lock{mutex};
+    FlushPending();
+    file->Flush();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-DiskDirectory::DiskDirectory(const std::string& path) {
-    unsigned size = FileUtil::ScanDirectoryTree(path, directory);
-    directory.size = size;
-    directory.isDirectory = true;
-    children_iterator = directory.children.begin();
+DiskDirectory::DiskDirectory(const std::string& path)
+    : directory(DirectoryCache::Get().GetListing(path)) {
+    children_iterator = directory->children.begin();
 }
 
 u32 DiskDirectory::Read(const u32 count, Entry* entries) {
     u32 entries_read = 0;
 
-    while (entries_read < count && children_iterator != directory.children.cend()) {
+    while (entries_read < count && children_iterator != directory->children.cend()) {
         const FileUtil::FSTEntry& file = *children_iterator;
         const std::string& filename = file.virtualName;
         Entry& entry = entries[entries_read];
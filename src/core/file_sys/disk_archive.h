@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
@@ -20,29 +24,117 @@
 
 namespace FileSys {
 
+class DiskFile;
+
+/**
+ * Listings of the host directories opened lately, so that a directory opened again is not scanned
+ * again. The archives drop the listings their writes change, changes made by anything else show
+ * once a listing is a few seconds old.
+ */
+class DirectoryCache {
+public:
+    /// The cache of every archive, as several archives can reach the same host directories
+    static DirectoryCache& Get();
+
+    /// Returns the listing of the directory, scanning it if it is not cached
+    std::shared_ptr<const FileUtil::FSTEntry> GetListing(const std::string& path);
+
+    /**
+     * Drops the listings a change of the file or directory at path makes stale, those of its
+     * parent, of itself and of the directories below it
+     */
+    void Invalidate(const std::string& path);
+
+private:
+    struct Listing {
+        std::shared_ptr<const FileUtil::FSTEntry> entry;
+        std::chrono::steady_clock::time_point scan_time;
+    };
+
+    std::mutex mutex;
+    /// Ordered, so that the directories below one follow it
+    std::map<std::string, Listing> listings;
+    /// Counts the invalidations, a scan that raced with one is not cached
+    u64 generation = 0;
+};
+
+/**
+ * Keeps track of the files of an archive whose writes are held back in memory, so that they can
+ * all be written out when the archive commits. Its mutex guards the files as well, as the FS
+ * service reads them on host threads while the emulation thread writes and flushes them.
+ */
+class WriteBackCache {
+public:
+    WriteBackCache();
+    ~WriteBackCache();
+
+    /// Writes out the pending data of every file
+    void FlushAll();
+
+    /// Writes out the data that every archive held back for too long, for the files left idle
+    static void FlushStale();
+
+private:
+    friend class DiskFile;
+
+    std::mutex mutex;
+    std::set<const DiskFile*> dirty_files;
+};
+
 class DiskFile : public FileBackend {
 public:
+    /**
+     * @param write_back_ When set, small writes are merged in memory and only written out when the
+     * file is closed or flushed, when the archive commits, or after a few seconds
+     * @param path_ Host path of the file, whose size in the DirectoryCache is then kept up to date
+     */
     DiskFile(FileUtil::IOFile&& file_, const Mode& mode_,
-             std::unique_ptr<DelayGenerator> delay_generator_)
-        : file(new FileUtil::IOFile(std::move(file_))) {
+             std::unique_ptr<DelayGenerator> delay_generator_,
+             std::shared_ptr<WriteBackCache> write_back_ = nullptr, std::string path_ = {})
+        : file(new FileUtil::IOFile(std::move(file_))), write_back(std::move(write_back_)),
+          mutex(write_back ? write_back->mutex : own_mutex), path(std::move(path_)) {
         delay_generator = std::move(delay_generator_);
         mode.hex = mode_.hex;
     }
 
+    ~DiskFile() override;
+
     ResultVal<std::size_t> Read(u64 offset, std::size_t length, u8* buffer) const override;
     ResultVal<std::size_t> Write(u64 offset, std::size_t length, bool flush,
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
     bool Close() const override;
-
-    void Flush() const override {
-        file->Flush();
-    }
+    void Flush() const override;
 
 protected:
     Mode mode;
     std::unique_ptr<FileUtil::IOFile> file;
+
+private:
+    friend class WriteBackCache;
+
+    /// Merges a write into the pending data
+    void AddPending(u64 offset, std::size_t length, const u8* buffer);
+
+    /// Writes out the data held back, the caller holds the mutex and updates the dirty files
+    void WritePending() const;
+
+    /// Writes out the data held back and drops the file from the dirty ones
+    void FlushPending() const;
+
+    /// Drops the cached listing that holds the size of the file
+    void InvalidateListing() const;
+
+    std::shared_ptr<WriteBackCache> write_back;
+    mutable std::mutex own_mutex;
+    /// The mutex of the write back cache, or the file's own without one
+    std::mutex& mutex;
+    std::string path;
+    /// Pending writes, by offset. They neither overlap nor touch each other.
+    mutable std::map<u64, std::vector<u8>> pending;
+    mutable std::size_t pending_bytes = 0;
+    std::chrono::steady_clock::time_point pending_since;
 };
 
 class DiskDirectory : public DirectoryBackend {
@@ -60,11 +152,12 @@ public:
     }
 
 protected:
-    FileUtil::FSTEntry directory{};
+    /// Shared with the DirectoryCache, which replaces instead of changing it
+    std::shared_ptr<const FileUtil::FSTEntry> directory;
 
     // We need to remember the last entry we returned, so a subsequent call to Read will continue
     // from the next one.  This iterator will always point to the next unread entry.
-    std::vector<FileUtil::FSTEntry>::iterator children_iterator;
+    std::vector<FileUtil::FSTEntry>::const_iterator children_iterator;
 };
 
 } // namespace FileSys
@@ -4,10 +4,14 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
+#include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/file_sys/layered_fs.h"
@@ -19,7 +23,9 @@ struct FileRelocationInfo {
     int type;                      // 0 - none, 1 - replaced / created, 2 - patched, 3 - removed
     u64 original_offset;           // Type 0. Offset is absolute
     std::string replace_file_path; // Type 1
-    std::vector<u8> patched_file;  // Type 2
+    std::string patch_file_path;   // Type 2
+    std::vector<u8> patched_file;  // Type 2. Empty until the patch is applied
+    u64 original_size;             // Size before patching
     u64 size;                      // Relocated file size
 };
 struct LayeredFS::File {
@@ -51,6 +57,30 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+constexpr u32 CacheVersion = 1;
+
+struct CacheHeader {
+    u32_le version;
+    u32_le file_count;
+    u64_le romfs_hash;
+    u64_le mods_hash;
+    u64_le metadata_size;
+    u64_le data_size;
+};
+
+struct CacheFileEntry {
+    u64_le data_offset;
+    u64_le original_offset;
+    u64_le original_size;
+    u64_le size;
+    u32_le type;
+    u32_le path_length;
+    u32_le source_path_length; // Replacement or patch file
+    INSERT_PADDING_WORDS(1);
+    // Followed by the paths
+};
+static_assert(sizeof(CacheFileEntry) == 0x30, "Size of CacheFileEntry is not correct");
+
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
                      std::string patch_ext_path_, bool load_relocations_)
     : romfs(std::move(romfs_)), patch_path(std::move(patch_path_)),
@@ -63,6 +93,20 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    u64 romfs_hash = 0;
+    u64 mods_hash = 0;
+    if (load_relocations) {
+        std::vector<u8> original_metadata(header.file_data_offset);
+        romfs->ReadFile(0, original_metadata.size(), original_metadata.data());
+        romfs_hash = Common::ComputeHash64(original_metadata.data(),
+                                           static_cast<u32>(original_metadata.size()));
+        mods_hash = HashMods();
+        if (LoadCache(romfs_hash, mods_hash)) {
+            LOG_INFO(Service_FS, "LayeredFS metadata loaded from {}", GetCachePath());
+            return;
+        }
+    }
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
@@ -73,6 +117,10 @@ void LayeredFS::Load() {
     }
 
     RebuildMetadata();
+
+    if (load_relocations) {
+        SaveCache(romfs_hash, mods_hash);
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
@@ -118,7 +166,7 @@ void LayeredFS::LoadFile(Directory& parent, u32 offset) {
                           metadata.name_length);
     file->path = parent.path + file->name;
     file->relocation.original_offset = header.file_data_offset + metadata.file_data_offset;
-    file->relocation.size = metadata.file_data_length;
+    file->relocation.original_size = file->relocation.size = metadata.file_data_length;
     file->parent = &parent;
 
     file_path_map.emplace(file->path, file.get());
@@ -231,36 +279,13 @@ void LayeredFS::LoadExtRelocations() {
                 continue;
             }
 
-            FileUtil::IOFile patch_file(entry.physicalName, "rb");
-            if (!patch_file) {
-                LOG_ERROR(Service_FS, "LayeredFS Could not open file {}", entry.physicalName);
-                continue;
-            }
-
-            const auto size = patch_file.GetSize();
-            std::vector<u8> patch(size);
-            if (patch_file.ReadBytes(patch.data(), size) != size) {
-                LOG_ERROR(Service_FS, "LayeredFS Could not read file {}", entry.physicalName);
-                continue;
-            }
-
             auto& file = *file_path_map[file_path];
-            std::vector<u8> buffer(file.relocation.size); // Original size
-            romfs->ReadFile(file.relocation.original_offset, buffer.size(), buffer.data());
-
-            bool ret = false;
-            if (extension == ".ips") {
-                ret = Patch::ApplyIpsPatch(patch, buffer);
-            } else {
-                ret = Patch::ApplyBpsPatch(patch, buffer);
-            }
-
-            if (ret) {
+            file.relocation.patch_file_path = entry.physicalName;
+            if (PatchFile(file)) {
                 LOG_INFO(Service_FS, "LayeredFS patched file {}", file_path);
 
                 file.relocation.type = 2;
-                file.relocation.size = buffer.size();
-                file.relocation.patched_file = std::move(buffer);
+                file.relocation.size = file.relocation.patched_file.size();
             } else {
                 LOG_ERROR(Service_FS, "LayeredFS failed to patch file {}", file_path);
             }
@@ -270,6 +295,38 @@ void LayeredFS::LoadExtRelocations() {
     }
 }
 
+bool LayeredFS::PatchFile(File& file) {
+    auto& relocation = file.relocation;
+    FileUtil::IOFile patch_file(relocation.patch_file_path, "rb");
+    if (!patch_file) {
+        LOG_ERROR(Service_FS, "LayeredFS Could not open file {}", relocation.patch_file_path);
+        return false;
+    }
+
+    const auto size = patch_file.GetSize();
+    std::vector<u8> patch(size);
+    if (patch_file.ReadBytes(patch.data(), size) != size) {
+        LOG_ERROR(Service_FS, "LayeredFS Could not read file {}", relocation.patch_file_path);
+        return false;
+    }
+
+    std::vector<u8> buffer(relocation.original_size);
+    romfs->ReadFile(relocation.original_offset, buffer.size(), buffer.data());
+
+    const auto& path = relocation.patch_file_path;
+    bool ret = false;
+    if (path.substr(path.size() - 4) == ".ips") {
+        ret = Patch::ApplyIpsPatch(patch, buffer);
+    } else {
+        ret = Patch::ApplyBpsPatch(patch, buffer);
+    }
+
+    if (ret) {
+        relocation.patched_file = std::move(buffer);
+    }
+    return ret;
+}
+
 std::size_t GetNameSize(const std::string& name) {
     std::u16string u16name = Common::UTF8ToUTF16(name);
     return Common::AlignUp(u16name.size() * 2, 4);
@@ -523,7 +580,10 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
             romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
                             buffer + read_size);
         } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+            if (replace_file_owner != current->second) {
+                replace_file = FileUtil::IOFile(relocation.replace_file_path, "rb");
+                replace_file_owner = current->second;
+            }
             if (replace_file) {
                 replace_file.Seek(relative_offset, SEEK_SET);
                 replace_file.ReadBytes(buffer + read_size, to_read);
@@ -532,6 +592,13 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
                           current->second->path);
             }
         } else if (relocation.type == 2) { // patch
+            // Files loaded from the cache are patched when first read
+            if (relocation.patched_file.size() != relocation.size &&
+                (!PatchFile(*current->second) ||
+                 relocation.patched_file.size() != relocation.size)) {
+                LOG_ERROR(Service_FS, "Could not patch file {}", current->second->path);
+                relocation.patched_file.resize(relocation.size);
+            }
             std::memcpy(buffer + read_size, relocation.patched_file.data() + relative_offset,
                         to_read);
         } else {
@@ -548,6 +615,142 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
     return read_size;
 }
 
+u64 LayeredFS::HashMods() const {
+    // Directories count as well, empty ones still add to the metadata
+    std::string layout;
+    const std::function<void(const FileUtil::FSTEntry&)> add_entries =
+        [&layout, &add_entries](const FileUtil::FSTEntry& parent) {
+            for (const auto& entry : parent.children) {
+                layout += fmt::format("{}:{}:{}\n", entry.physicalName,
+                                      entry.isDirectory ? 0 : entry.size,
+                                      FileUtil::GetFileModificationTimestamp(entry.physicalName));
+                add_entries(entry);
+            }
+        };
+
+    for (auto path : {patch_path, patch_ext_path}) {
+        if (!FileUtil::Exists(path)) {
+            continue;
+        }
+        if (path.back() == '/' || path.back() == '\\') {
+            // ScanDirectoryTree expects a path without trailing '/'
+            path.erase(path.size() - 1, 1);
+        }
+        FileUtil::FSTEntry entries;
+        FileUtil::ScanDirectoryTree(path, entries, 256);
+        add_entries(entries);
+    }
+    return Common::ComputeHash64(layout.data(), static_cast<u32>(layout.size()));
+}
+
+std::string LayeredFS::GetCachePath() const {
+    return fmt::format(
+        "{}layeredfs{}{:016X}.bin", FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP,
+        Common::ComputeHash64(patch_path.data(), static_cast<u32>(patch_path.size())));
+}
+
+bool LayeredFS::LoadCache(u64 romfs_hash, u64 mods_hash) {
+    FileUtil::IOFile file(GetCachePath(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    CacheHeader cache_header;
+    if (file.ReadBytes(&cache_header, sizeof(cache_header)) != sizeof(cache_header) ||
+        cache_header.version != CacheVersion || cache_header.romfs_hash != romfs_hash ||
+        cache_header.mods_hash != mods_hash) {
+        return false;
+    }
+
+    metadata.resize(cache_header.metadata_size);
+    if (file.ReadBytes(metadata.data(), metadata.size()) != metadata.size()) {
+        return false;
+    }
+
+    const auto read_string = [&file](std::size_t length) {
+        std::string string(length, '\0');
+        return file.ReadBytes(string.data(), length) == length ? string : std::string{};
+    };
+    for (u32 i = 0; i < cache_header.file_count; i++) {
+        CacheFileEntry entry;
+        if (file.ReadBytes(&entry, sizeof(entry)) != sizeof(entry)) {
+            break;
+        }
+
+        auto cached_file = std::make_unique<File>();
+        cached_file->path = read_string(entry.path_length);
+        auto& relocation = cached_file->relocation;
+        relocation.type = entry.type;
+        relocation.original_offset = entry.original_offset;
+        relocation.original_size = entry.original_size;
+        relocation.size = entry.size;
+        if (relocation.type == 1) {
+            relocation.replace_file_path = read_string(entry.source_path_length);
+        } else {
+            relocation.patch_file_path = read_string(entry.source_path_length);
+        }
+        data_offset_map.emplace(entry.data_offset, cached_file.get());
+        cached_files.emplace_back(std::move(cached_file));
+    }
+
+    if (!file || data_offset_map.size() != cache_header.file_count) {
+        LOG_WARNING(Service_FS, "LayeredFS cache {} is corrupted", GetCachePath());
+        data_offset_map.clear();
+        cached_files.clear();
+        return false;
+    }
+
+    current_data_offset = cache_header.data_size;
+    return true;
+}
+
+void LayeredFS::SaveCache(u64 romfs_hash, u64 mods_hash) {
+    const auto path = GetCachePath();
+    if (!FileUtil::CreateFullPath(path)) {
+        LOG_WARNING(Service_FS, "Could not create path {}", path);
+        return;
+    }
+    FileUtil::IOFile file(path, "wb");
+    if (!file) {
+        LOG_WARNING(Service_FS, "Could not open file {}", path);
+        return;
+    }
+
+    CacheHeader cache_header{};
+    cache_header.version = CacheVersion;
+    cache_header.file_count = static_cast<u32>(data_offset_map.size());
+    cache_header.romfs_hash = romfs_hash;
+    cache_header.mods_hash = mods_hash;
+    cache_header.metadata_size = metadata.size();
+    cache_header.data_size = current_data_offset;
+    file.WriteObject(cache_header);
+    file.WriteBytes(metadata.data(), metadata.size());
+
+    for (const auto& [data_offset, cached_file] : data_offset_map) {
+        const auto& relocation = cached_file->relocation;
+        const auto& source_path =
+            relocation.type == 1 ? relocation.replace_file_path : relocation.patch_file_path;
+
+        CacheFileEntry entry{};
+        entry.data_offset = data_offset;
+        entry.original_offset = relocation.original_offset;
+        entry.original_size = relocation.original_size;
+        entry.size = relocation.size;
+        entry.type = relocation.type;
+        entry.path_length = static_cast<u32>(cached_file->path.size());
+        entry.source_path_length = static_cast<u32>(source_path.size());
+        file.WriteObject(entry);
+        file.WriteString(cached_file->path);
+        file.WriteString(source_path);
+    }
+
+    if (!file) {
+        LOG_WARNING(Service_FS, "Could not write LayeredFS cache {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+}
+
 bool LayeredFS::ExtractDirectory(Directory& current, const std::string& target_path) {
     if (!FileUtil::CreateFullPath(target_path + current.path)) {
         LOG_ERROR(Service_FS, "Could not create path {}", target_path + current.path);
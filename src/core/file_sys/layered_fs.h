@@ -37,6 +37,10 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ *
+ * With relocations, the rebuilt metadata is cached on disk, keyed by the original metadata and the
+ * sizes and modification times of the mod files. Patches are then applied on the first read of
+ * their files.
  */
 class LayeredFS : public RomFSReader {
 public:
@@ -92,6 +96,19 @@ private:
 
     void RebuildMetadata();
 
+    // Apply the patch of a type 2 relocation to the original file
+    bool PatchFile(File& file);
+
+    // Hash the layout of the mod directories
+    u64 HashMods() const;
+
+    std::string GetCachePath() const;
+
+    // Load the metadata and relocations from the disk cache, if it matches the given hashes
+    bool LoadCache(u64 romfs_hash, u64 mods_hash);
+
+    void SaveCache(u64 romfs_hash, u64 mods_hash);
+
     void Load();
 
     std::shared_ptr<RomFSReader> romfs;
@@ -105,6 +122,11 @@ private:
     std::unordered_map<std::string, Directory*> directory_path_map;
     std::map<u64, File*> data_offset_map; // assigned data offset -> file
     std::vector<u8> metadata;             // Includes header, hash table and metadata
+    std::vector<std::unique_ptr<File>> cached_files; // Files loaded from the cache, not in root
+
+    // Replacement file kept open for the reads that follow
+    FileUtil::IOFile replace_file;
+    File* replace_file_owner = nullptr;
 
     // Used for rebuilding header
     std::vector<u32_le> directory_hash_table;
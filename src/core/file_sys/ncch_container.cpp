@@ -5,16 +5,17 @@
 #include <cinttypes>
 #include <cstring>
 #include <memory>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
+#include <mutex>
 #include <cryptopp/sha.h>
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/patch.h"
 #include "core/file_sys/seed_db.h"
+#include "core/hw/aes/ctr.h"
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 
@@ -56,59 +57,61 @@ static u32 LZSS_GetDecompressedSize(const u8* buffer, u32 size) {
  */
 static bool LZSS_Decompress(const u8* compressed, u32 compressed_size, u8* decompressed,
                             u32 decompressed_size) {
+    if (compressed_size < 8 || decompressed_size < compressed_size)
+        return false;
     const u8* footer = compressed + compressed_size - 8;
 
     u32 buffer_top_and_bottom;
     std::memcpy(&buffer_top_and_bottom, footer, sizeof(u32));
 
+    const u32 header_size = (buffer_top_and_bottom >> 24) & 0xFF;
+    const u32 compressed_region = buffer_top_and_bottom & 0xFFFFFF;
+    if (header_size > compressed_size || compressed_region > compressed_size)
+        return false;
+
     u32 out = decompressed_size;
-    u32 index = compressed_size - ((buffer_top_and_bottom >> 24) & 0xFF);
-    u32 stop_index = compressed_size - (buffer_top_and_bottom & 0xFFFFFF);
+    u32 index = compressed_size - header_size;
+    const u32 stop_index = compressed_size - compressed_region;
 
-    memset(decompressed, 0, decompressed_size);
-    memcpy(decompressed, compressed, compressed_size);
+    // The data is decompressed in place, from the end of the buffer
+    std::memcpy(decompressed, compressed, compressed_size);
+    std::memset(decompressed + compressed_size, 0, decompressed_size - compressed_size);
 
     while (index > stop_index) {
         u8 control = compressed[--index];
 
-        for (unsigned i = 0; i < 8; i++) {
-            if (index <= stop_index)
-                break;
-            if (index <= 0)
-                break;
-            if (out <= 0)
-                break;
-
-            if (control & 0x80) {
-                // Check if compression is out of bounds
-                if (index < 2)
-                    return false;
-                index -= 2;
-
-                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
-                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
-                segment_offset &= 0x0FFF;
-                segment_offset += 2;
-
-                // Check if compression is out of bounds
-                if (out < segment_size)
-                    return false;
-
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed_size)
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
-                }
-            } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
+        for (unsigned i = 0; i < 8 && index > stop_index && out > 0; i++, control <<= 1) {
+            if (!(control & 0x80)) {
+                // The loop conditions leave room for the literal on both sides
                 decompressed[--out] = compressed[--index];
+                continue;
+            }
+
+            // Check if compression is out of bounds
+            if (index < 2)
+                return false;
+            index -= 2;
+
+            const u32 segment = compressed[index] | (compressed[index + 1] << 8);
+            const u32 segment_size = ((segment >> 12) & 15) + 3;
+            const u32 segment_offset = (segment & 0x0FFF) + 2;
+
+            // The segment is checked as a whole, it reads downwards from out + segment_offset
+            if (out < segment_size || out + segment_offset >= decompressed_size)
+                return false;
+
+            u8* dest = decompressed + out - segment_size;
+            const u8* source = dest + segment_offset + 1;
+            out -= segment_size;
+            if (segment_offset + 1 >= segment_size) {
+                // Neither range overlaps the other, all of the segment is copied at once
+                std::memcpy(dest, source, segment_size);
+            } else {
+                // The segment repeats bytes it writes itself, in the order of the format
+                for (u32 j = segment_size; j-- > 0;) {
+                    dest[j] = source[j];
+                }
             }
-            control <<= 1;
         }
     }
     return true;
@@ -199,6 +202,10 @@ Loader::ResultStatus NCCHContainer::Load() {
                 primary_key.fill(0);
                 secondary_key.fill(0);
             } else {
+                // The key slots are global, and the game list loads titles on several threads
+                static std::mutex key_slot_mutex;
+                std::lock_guard lock{key_slot_mutex};
+
                 using namespace HW::AES;
                 InitKeys();
                 std::array<u8, 16> key_y_primary, key_y_secondary;
@@ -336,10 +343,9 @@ Loader::ResultStatus NCCHContainer::Load() {
                         LOG_ERROR(Service_FS, "Failed to decrypt");
                         return Loader::ResultStatus::ErrorEncrypted;
                     }
-                    CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&exheader_header);
-                    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(
-                        primary_key.data(), primary_key.size(), exheader_ctr.data())
-                        .ProcessData(data, data, sizeof(exheader_header));
+                    HW::AES::CTRDecryptor(primary_key, exheader_ctr)
+                        .Decrypt(reinterpret_cast<u8*>(&exheader_header),
+                                 sizeof(exheader_header), 0);
                 }
             }
 
@@ -408,10 +414,8 @@ Loader::ResultStatus NCCHContainer::Load() {
                 return Loader::ResultStatus::Error;
 
             if (is_encrypted) {
-                CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&exefs_header);
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(primary_key.data(),
-                                                              primary_key.size(), exefs_ctr.data())
-                    .ProcessData(data, data, sizeof(exefs_header));
+                HW::AES::CTRDecryptor(primary_key, exefs_ctr)
+                    .Decrypt(reinterpret_cast<u8*>(&exefs_header), sizeof(exefs_header), 0);
             }
 
             exefs_file = FileUtil::IOFile(filepath, "rb");
@@ -424,6 +428,14 @@ Loader::ResultStatus NCCHContainer::Load() {
 
     LoadOverrides();
 
+    // Decrypted images are read from memory, leaving the caching to the OS
+    if (!is_encrypted && (has_exefs || has_romfs) && !mapped_file) {
+        auto mapping = std::make_shared<FileUtil::MappedFile>(filepath);
+        if (mapping->IsOpen()) {
+            mapped_file = std::move(mapping);
+        }
+    }
+
     // We need at least one of these or overrides, practically
     if (!(has_exefs || has_romfs || is_tainted))
         return Loader::ResultStatus::Error;
@@ -450,6 +462,7 @@ Loader::ResultStatus NCCHContainer::LoadOverrides() {
             exefs_offset = 0;
             is_tainted = true;
             has_exefs = true;
+            has_exefs_override = true;
         } else {
             exefs_file = FileUtil::IOFile(filepath, "rb");
         }
@@ -520,38 +533,50 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 key = secondary_key;
             }
 
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption dec(key.data(), key.size(),
-                                                              exefs_ctr.data());
-            dec.Seek(section.offset + sizeof(ExeFs_Header));
+            HW::AES::CTRDecryptor dec(key, exefs_ctr);
+            const u64 crypto_offset = section.offset + sizeof(ExeFs_Header);
+
+            // Sections of decrypted images are taken straight from the mapping
+            const u8* mapped_section = nullptr;
+            if (mapped_file && !has_exefs_override &&
+                section_offset + section.size <= mapped_file->GetSize()) {
+                mapped_section = mapped_file->GetData() + section_offset;
+            }
 
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
                 std::unique_ptr<u8[]> temp_buffer;
-                try {
-                    temp_buffer.reset(new u8[section.size]);
-                } catch (std::bad_alloc&) {
-                    return Loader::ResultStatus::ErrorMemoryAllocationFailed;
-                }
+                const u8* compressed = mapped_section;
+                if (!compressed) {
+                    try {
+                        temp_buffer.reset(new u8[section.size]);
+                    } catch (std::bad_alloc&) {
+                        return Loader::ResultStatus::ErrorMemoryAllocationFailed;
+                    }
 
-                if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
-                    return Loader::ResultStatus::Error;
+                    if (exefs_file.ReadBytes(&temp_buffer[0], section.size) != section.size)
+                        return Loader::ResultStatus::Error;
 
-                if (is_encrypted) {
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    if (is_encrypted) {
+                        dec.Decrypt(&temp_buffer[0], section.size, crypto_offset);
+                    }
+                    compressed = &temp_buffer[0];
                 }
 
                 // Decompress .code section...
-                u32 decompressed_size = LZSS_GetDecompressedSize(&temp_buffer[0], section.size);
+                u32 decompressed_size = LZSS_GetDecompressedSize(compressed, section.size);
                 buffer.resize(decompressed_size);
-                if (!LZSS_Decompress(&temp_buffer[0], section.size, &buffer[0], decompressed_size))
+                if (!LZSS_Decompress(compressed, section.size, &buffer[0], decompressed_size))
                     return Loader::ResultStatus::ErrorInvalidFormat;
+            } else if (mapped_section) {
+                buffer.assign(mapped_section, mapped_section + section.size);
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
                 if (exefs_file.ReadBytes(&buffer[0], section.size) != section.size)
                     return Loader::ResultStatus::Error;
                 if (is_encrypted) {
-                    dec.ProcessData(&buffer[0], &buffer[0], section.size);
+                    dec.Decrypt(&buffer[0], section.size, crypto_offset);
                 }
             }
 
@@ -597,6 +622,34 @@ Loader::ResultStatus NCCHContainer::ApplyCodePatch(std::vector<u8>& code) const
     return Loader::ResultStatus::ErrorNotUsed;
 }
 
+u64 NCCHContainer::GetCodeCacheKey() const {
+    const auto mods_path =
+        fmt::format("{}mods/{:016X}/", FileUtil::GetUserPath(FileUtil::UserPath::LoadDir),
+                    GetModId(ncch_header.program_id));
+    // The same files as LoadOverrideExeFSSection and ApplyCodePatch look for
+    const std::array<std::string, 10> paths{{
+        filepath,
+        mods_path + "exefs/code.bin",
+        mods_path + "code.bin",
+        filepath + ".exefsdir/code.bin",
+        mods_path + "exefs/code.ips",
+        mods_path + "exefs/code.bps",
+        mods_path + "code.ips",
+        mods_path + "code.bps",
+        filepath + ".exefsdir/code.ips",
+        filepath + ".exefsdir/code.bps",
+    }};
+
+    std::string key;
+    for (const auto& path : paths) {
+        if (FileUtil::Exists(path)) {
+            key += fmt::format("{}:{}:{};", path, FileUtil::GetSize(path),
+                               FileUtil::GetFileModificationTimestamp(path));
+        }
+    }
+    return Common::ComputeHash64(key.data(), static_cast<u32>(key.size()));
+}
+
 Loader::ResultStatus NCCHContainer::LoadOverrideExeFSSection(const char* name,
                                                              std::vector<u8>& buffer) {
     std::string override_name;
@@ -665,19 +718,23 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     if (file.GetSize() < romfs_offset + romfs_size)
         return Loader::ResultStatus::Error;
 
-    // We reopen the file, to allow its position to be independent from file's
-    FileUtil::IOFile romfs_file_inner(filepath, "rb");
-    if (!romfs_file_inner.IsOpen())
-        return Loader::ResultStatus::Error;
-
     std::shared_ptr<RomFSReader> direct_romfs;
-    if (is_encrypted) {
-        direct_romfs =
-            std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), romfs_offset,
-                                                romfs_size, secondary_key, romfs_ctr, 0x1000);
+    if (mapped_file) {
+        direct_romfs = std::make_shared<MappedRomFSReader>(mapped_file, romfs_offset, romfs_size);
     } else {
-        direct_romfs = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner),
-                                                           romfs_offset, romfs_size);
+        // We reopen the file, to allow its position to be independent from file's
+        FileUtil::IOFile romfs_file_inner(filepath, "rb");
+        if (!romfs_file_inner.IsOpen())
+            return Loader::ResultStatus::Error;
+
+        if (is_encrypted) {
+            direct_romfs =
+                std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner), romfs_offset,
+                                                    romfs_size, secondary_key, romfs_ctr, 0x1000);
+        } else {
+            direct_romfs = std::make_shared<DirectRomFSReader>(std::move(romfs_file_inner),
+                                                               romfs_offset, romfs_size);
+        }
     }
 
     const auto path =
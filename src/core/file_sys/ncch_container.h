@@ -293,6 +293,13 @@ public:
      */
     Loader::ResultStatus ApplyCodePatch(std::vector<u8>& code) const;
 
+    /**
+     * Get a key of the patched .code, for the code cache. It changes when the NCCH, the .code
+     * overrides or the .code patches are modified.
+     * @return the key
+     */
+    u64 GetCodeCacheKey() const;
+
     /**
      * Checks whether the NCCH container contains an ExeFS
      * @return bool check result
@@ -324,6 +331,7 @@ private:
     bool is_tainted = false; // Are there parts of this container being overridden?
     bool is_loaded = false;
     bool is_compressed = false;
+    bool has_exefs_override = false;
 
     bool is_encrypted = false;
     // for decrypting exheader, exefs header and icon/banner section
@@ -339,6 +347,8 @@ private:
     std::string filepath;
     FileUtil::IOFile file;
     FileUtil::IOFile exefs_file;
+    /// The whole image mapped in memory, for decrypted images only
+    std::shared_ptr<FileUtil::MappedFile> mapped_file;
 };
 
 } // namespace FileSys
@@ -1,22 +1,106 @@
 #include <algorithm>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
+#include <cstring>
 #include "core/file_sys/romfs_reader.h"
+#include "core/hw/aes/ctr.h"
 
 namespace FileSys {
 
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : decryptor(std::make_unique<HW::AES::CTRDecryptor>(key, ctr)), file(std::move(file)),
+      file_offset(file_offset), crypto_offset(crypto_offset), data_size(data_size) {}
+
+DirectRomFSReader::~DirectRomFSReader() = default;
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
-    if (length == 0)
-        return 0; // Crypto++ does not like zero size buffer
+    if (length == 0 || offset >= data_size)
+        return 0;
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+
+    // Streams and movies are read one chunk after the other, those get their next blocks early
+    const std::size_t read_ahead = offset == previous_read_end ? ReadAheadBlocks : 1;
+    previous_read_end = offset + length;
+
+    std::size_t read = 0;
+    while (read < length) {
+        const std::size_t position = offset + read;
+        const std::size_t block_offset = position % BlockSize;
+
+        // Whole blocks bypass the cache, so that large reads neither copy twice nor flush it
+        if (block_offset == 0 && length - read >= BlockSize) {
+            const std::size_t direct_length = (length - read) / BlockSize * BlockSize;
+            const std::size_t direct_read = ReadData(position, direct_length, buffer + read);
+            read += direct_read;
+            if (direct_read != direct_length)
+                break;
+            continue;
+        }
+
+        const Block& block = GetBlock(position / BlockSize, read_ahead);
+        if (block.data.size() <= block_offset)
+            break;
+        const std::size_t copy_length = std::min(length - read, block.data.size() - block_offset);
+        std::memcpy(buffer + read, block.data.data() + block_offset, copy_length);
+        read += copy_length;
+    }
+    return read;
+}
+
+std::size_t DirectRomFSReader::ReadData(std::size_t offset, std::size_t length, u8* buffer) {
     file.Seek(file_offset + offset, SEEK_SET);
-    std::size_t read_length = std::min(length, static_cast<std::size_t>(data_size) - offset);
-    read_length = file.ReadBytes(buffer, read_length);
-    if (is_encrypted) {
-        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-        d.Seek(crypto_offset + offset);
-        d.ProcessData(buffer, buffer, read_length);
+    const std::size_t read_length = file.ReadBytes(buffer, length);
+    if (decryptor) {
+        decryptor->Decrypt(buffer, read_length, crypto_offset + offset);
     }
     return read_length;
 }
 
+const DirectRomFSReader::Block& DirectRomFSReader::GetBlock(std::size_t index,
+                                                            std::size_t read_ahead) {
+    const auto find = [this](std::size_t index) {
+        return std::find_if(blocks.begin(), blocks.end(),
+                            [index](const Block& block) { return block.index == index; });
+    };
+
+    auto requested = find(index);
+    if (requested == blocks.end()) {
+        const std::size_t num_blocks = (data_size + BlockSize - 1) / BlockSize;
+        const std::size_t end = std::min(index + read_ahead, num_blocks);
+        for (std::size_t i = index; i < end; ++i) {
+            if (i != index && find(i) != blocks.end())
+                break;
+
+            // The evicted block gives its buffer to the new one
+            Block block;
+            if (blocks.size() >= CacheBlocks) {
+                block = std::move(blocks.back());
+                blocks.pop_back();
+            }
+            block.index = i;
+            block.data.resize(std::min<std::size_t>(BlockSize, data_size - i * BlockSize));
+            block.data.resize(ReadData(i * BlockSize, block.data.size(), block.data.data()));
+            blocks.push_front(std::move(block));
+            if (i == index) {
+                requested = blocks.begin();
+            }
+        }
+    }
+
+    blocks.splice(blocks.begin(), blocks, requested);
+    return blocks.front();
+}
+
+std::size_t MappedRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
+    if (offset >= data_size)
+        return 0;
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+    std::memcpy(buffer, file->GetData() + file_offset + offset, length);
+    return length;
+}
+
 } // namespace FileSys
@@ -1,9 +1,16 @@
 #pragma once
 
 #include <array>
+#include <list>
+#include <memory>
+#include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
 
+namespace HW::AES {
+class CTRDecryptor;
+}
+
 namespace FileSys {
 
 /**
@@ -18,21 +25,18 @@ public:
 };
 
 /**
- * A RomFS reader that directly reads the RomFS file.
+ * A RomFS reader that directly reads the RomFS file. The data is read and decrypted in blocks, the
+ * most recently used of which stay cached for the small reads games make of their file tables.
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -41,12 +45,59 @@ public:
     std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
 
 private:
-    bool is_encrypted;
+    /// Size of the blocks the data is read and decrypted in
+    static constexpr std::size_t BlockSize = 0x10000;
+    /// Number of blocks kept cached
+    static constexpr std::size_t CacheBlocks = 32;
+    /// Number of blocks read at once on a miss of sequential reads
+    static constexpr std::size_t ReadAheadBlocks = 4;
+
+    struct Block {
+        std::size_t index;
+        std::vector<u8> data;
+    };
+
+    /// Reads and decrypts `length` bytes of the data at `offset`, which must be in range
+    std::size_t ReadData(std::size_t offset, std::size_t length, u8* buffer);
+
+    /// Returns the cached block, reading it and the blocks after it if requested when missing
+    const Block& GetBlock(std::size_t index, std::size_t read_ahead);
+
+    /// Set up once with the key and counter, null for unencrypted data
+    std::unique_ptr<HW::AES::CTRDecryptor> decryptor;
+
     FileUtil::IOFile file;
-    std::array<u8, 16> key;
-    std::array<u8, 16> ctr;
     u64 file_offset;
-    u64 crypto_offset;
+    u64 crypto_offset = 0;
+    u64 data_size;
+
+    /// Cached blocks, most recently used first
+    std::list<Block> blocks;
+    /// End of the previous read, to detect sequential reads
+    std::size_t previous_read_end = 0;
+};
+
+/**
+ * A RomFS reader over a decrypted image mapped in memory. Reads are copies out of the mapping,
+ * the OS pages the data in and keeps it cached.
+ */
+class MappedRomFSReader : public RomFSReader {
+public:
+    MappedRomFSReader(std::shared_ptr<FileUtil::MappedFile> file, std::size_t file_offset,
+                      std::size_t data_size)
+        : file(std::move(file)), file_offset(file_offset), data_size(data_size) {}
+
+    ~MappedRomFSReader() override = default;
+
+    std::size_t GetSize() const override {
+        return data_size;
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override;
+
+private:
+    std::shared_ptr<FileUtil::MappedFile> file;
+    u64 file_offset;
     u64 data_size;
 };
 
@@ -35,6 +35,13 @@ public:
     }
 };
 
+SaveDataArchive::SaveDataArchive(const std::string& mount_point_)
+    : mount_point(mount_point_), write_back_cache(std::make_shared<WriteBackCache>()) {}
+
+SaveDataArchive::~SaveDataArchive() {
+    write_back_cache->FlushAll();
+}
+
 ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& path,
                                                                   const Mode& mode) const {
     LOG_DEBUG(Service_FS, "SaveDataArchive OpenFile called path={} mode={:01X}", path.DebugStr(), mode.hex);
@@ -77,6 +84,7 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
         } else {
             // Create the file
             FileUtil::CreateEmptyFile(full_path);
+            DirectoryCache::Get().Invalidate(full_path);
         }
         break;
     case PathParser::FileFound:
@@ -90,7 +98,8 @@ ResultVal<std::unique_ptr<FileBackend>> SaveDataArchive::OpenFile(const Path& pa
     }
 
     std::unique_ptr<DelayGenerator> delay_generator = std::make_unique<SaveDataDelayGenerator>();
-    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator));
+    auto disk_file = std::make_unique<DiskFile>(std::move(file), mode, std::move(delay_generator),
+                                                write_back_cache, full_path);
     return MakeResult<std::unique_ptr<FileBackend>>(std::move(disk_file));
 }
 
@@ -121,6 +130,7 @@ ResultCode SaveDataArchive::DeleteFile(const Path& path) const {
     }
 
     if (FileUtil::Delete(full_path)) {
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
@@ -148,6 +158,8 @@ ResultCode SaveDataArchive::RenameFile(const Path& src_path, const Path& dest_pa
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
     if (FileUtil::Rename(src_path_full, dest_path_full)) {
+        DirectoryCache::Get().Invalidate(src_path_full);
+        DirectoryCache::Get().Invalidate(dest_path_full);
         return RESULT_SUCCESS;
     }
 
@@ -189,6 +201,7 @@ static ResultCode DeleteDirectoryHelper(const Path& path, const std::string& mou
     }
 
     if (deleter(full_path)) {
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
@@ -235,10 +248,12 @@ ResultCode SaveDataArchive::CreateFile(const FileSys::Path& path, u64 size) cons
 
     if (size == 0) {
         FileUtil::CreateEmptyFile(full_path);
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
     FileUtil::IOFile file(full_path, "wb");
+    DirectoryCache::Get().Invalidate(full_path);
     // Creates a sparse file (or a normal file on filesystems without the concept of sparse files)
     // We do this by seeking to the right size, then writing a single null byte.
     if (file.Seek(size - 1, SEEK_SET) && file.WriteBytes("", 1) == 1) {
@@ -279,6 +294,7 @@ ResultCode SaveDataArchive::CreateDirectory(const Path& path) const {
     }
 
     if (FileUtil::CreateDir(mount_point + path.AsString())) {
+        DirectoryCache::Get().Invalidate(full_path);
         return RESULT_SUCCESS;
     }
 
@@ -307,6 +323,8 @@ ResultCode SaveDataArchive::RenameDirectory(const Path& src_path, const Path& de
     const auto dest_path_full = path_parser_dest.BuildHostPath(mount_point);
 
     if (FileUtil::Rename(src_path_full, dest_path_full)) {
+        DirectoryCache::Get().Invalidate(src_path_full);
+        DirectoryCache::Get().Invalidate(dest_path_full);
         return RESULT_SUCCESS;
     }
 
@@ -352,4 +370,9 @@ u64 SaveDataArchive::GetFreeBytes() const {
     return 1024 * 1024 * 32;
 }
 
+ResultCode SaveDataArchive::Commit() const {
+    write_back_cache->FlushAll();
+    return RESULT_SUCCESS;
+}
+
 } // namespace FileSys
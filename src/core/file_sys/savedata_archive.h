@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/directory_backend.h"
@@ -15,10 +16,13 @@
 
 namespace FileSys {
 
+class WriteBackCache;
+
 /// Archive backend for general save data archive type (SaveData and SystemSaveData)
 class SaveDataArchive : public ArchiveBackend {
 public:
-    explicit SaveDataArchive(const std::string& mount_point_) : mount_point(mount_point_) {}
+    explicit SaveDataArchive(const std::string& mount_point_);
+    ~SaveDataArchive() override;
 
     std::string GetName() const override {
         return "SaveDataArchive: " + mount_point;
@@ -35,9 +39,12 @@ public:
     ResultCode RenameDirectory(const Path& src_path, const Path& dest_path) const override;
     ResultVal<std::unique_ptr<DirectoryBackend>> OpenDirectory(const Path& path) const override;
     u64 GetFreeBytes() const override;
+    ResultCode Commit() const override;
 
 protected:
     std::string mount_point;
+    /// Holds back the writes to the save data until it is committed
+    std::shared_ptr<WriteBackCache> write_back_cache;
 };
 
 } // namespace FileSys
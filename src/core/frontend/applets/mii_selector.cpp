@@ -13,6 +13,7 @@ namespace Frontend {
 
 void MiiSelector::Finalize(u32 return_code, HLE::Applets::MiiData mii) {
     data = {return_code, mii};
+    data_ready = true;
 }
 
 std::vector<HLE::Applets::MiiData> LoadMiis() {
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include "core/hle/applets/mii_selector.h"
@@ -34,7 +35,19 @@ public:
         this->config = MiiSelectorConfig(config);
     }
 
-    const MiiSelectorData& ReceiveData() const {
+    /**
+     * Whether the result data is ready to be received. The frontend may finalize the selection on
+     * another thread while the HLE applet polls this.
+     */
+    bool DataReady() const {
+        return data_ready;
+    }
+
+    /**
+     * Receives the current result data stored in the applet, and clears the ready state.
+     */
+    const MiiSelectorData& ReceiveData() {
+        data_ready = false;
         return data;
     }
 
@@ -47,6 +60,8 @@ public:
 protected:
     MiiSelectorConfig config;
     MiiSelectorData data;
+
+    std::atomic<bool> data_ready{false};
 };
 
 std::vector<HLE::Applets::MiiData> LoadMiis();
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -90,7 +91,8 @@ public:
     }
 
     /**
-     * Whether the result data is ready to be received.
+     * Whether the result data is ready to be received. The frontend may finalize the input on
+     * another thread while the HLE applet polls this.
      */
     bool DataReady() const;
 
@@ -133,7 +135,7 @@ protected:
     KeyboardConfig config;
     KeyboardData data;
 
-    bool data_ready = false;
+    std::atomic<bool> data_ready{false};
 };
 
 class DefaultKeyboard final : public SoftwareKeyboard {
@@ -8,4 +8,10 @@ namespace Camera {
 
 CameraInterface::~CameraInterface() = default;
 
+std::vector<u16> CameraInterface::ReceiveFrame() {
+    std::vector<u16> frame;
+    ReceiveFrame(frame);
+    return frame;
+}
+
 } // namespace Camera
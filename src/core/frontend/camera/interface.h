@@ -58,10 +58,14 @@ public:
     /**
      * Receives a frame from the camera.
      * This function should be only called between a StartCapture call and a StopCapture call.
-     * @returns A std::vector<u16> containing pixels. The total size of the vector is width * height
-     *     where width and height are set by a call to SetResolution.
+     * @param frame Buffer the pixels are written to, resized to width * height where width and
+     *     height are set by a call to SetResolution. The CAM service passes the same buffer for
+     *     every frame of a port, so that it isn't reallocated as long as the resolution is kept.
      */
-    virtual std::vector<u16> ReceiveFrame() = 0;
+    virtual void ReceiveFrame(std::vector<u16>& frame) = 0;
+
+    /// Receives a frame from the camera into a new buffer
+    std::vector<u16> ReceiveFrame();
 
     /**
      * Test if the camera is opened successfully and can receive a preview frame. Only used for
@@ -22,6 +22,16 @@ struct FramebufferLayout {
      * screen.
      */
     u32 GetScalingRatio() const;
+
+    bool operator==(const FramebufferLayout& other) const {
+        return width == other.width && height == other.height &&
+               top_screen_enabled == other.top_screen_enabled &&
+               bottom_screen_enabled == other.bottom_screen_enabled &&
+               top_screen == other.top_screen && bottom_screen == other.bottom_screen;
+    }
+    bool operator!=(const FramebufferLayout& other) const {
+        return !operator==(other);
+    }
 };
 
 /**
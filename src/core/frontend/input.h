@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -132,4 +134,27 @@ using MotionDevice = InputDevice<std::tuple<Common::Vec3<float>, Common::Vec3<fl
  */
 using TouchDevice = InputDevice<std::tuple<float, float, bool>>;
 
+namespace Impl {
+/// Steady clock time of the first input event HID did not latch yet in nanoseconds, or zero
+inline std::atomic<s64> first_unlatched_event_ns{0};
+} // namespace Impl
+
+/**
+ * Records that an input event changed the state of a device. Input backends call it, so that the
+ * latency from the event to the pad update latching it and to the end of the frame is measured.
+ */
+inline void NotifyInputEvent() {
+    const s64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+    s64 expected = 0;
+    Impl::first_unlatched_event_ns.compare_exchange_strong(expected, now,
+                                                           std::memory_order_relaxed);
+}
+
+/// Returns the time of the first input event since the last call in nanoseconds, or zero
+inline s64 TakeInputEventTime() {
+    return Impl::first_unlatched_event_ns.exchange(0, std::memory_order_relaxed);
+}
+
 } // namespace Input
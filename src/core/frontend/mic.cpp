@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include "core/frontend/mic.h"
 
 #ifdef HAVE_CUBEB
@@ -33,8 +35,8 @@ void NullMic::AdjustSampleRate(u32 sample_rate) {
     parameters.sample_rate = sample_rate;
 }
 
-Samples NullMic::Read() {
-    return {};
+std::size_t NullMic::Read(u8* buffer, std::size_t max_size) {
+    return 0;
 }
 
 StaticMic::StaticMic()
@@ -57,8 +59,11 @@ void StaticMic::StopSampling() {
 
 void StaticMic::AdjustSampleRate(u32 sample_rate) {}
 
-Samples StaticMic::Read() {
-    return (sample_size == 8) ? CACHE_8_BIT : CACHE_16_BIT;
+std::size_t StaticMic::Read(u8* buffer, std::size_t max_size) {
+    const std::vector<u8>& noise = (sample_size == 8) ? CACHE_8_BIT : CACHE_16_BIT;
+    const std::size_t size = std::min(noise.size(), max_size);
+    std::memcpy(buffer, noise.data(), size);
+    return size;
 }
 
 RealMicFactory::~RealMicFactory() = default;
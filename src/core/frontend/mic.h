@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 #include "common/swap.h"
@@ -18,8 +19,6 @@ enum class Signedness : u8 {
     Unsigned,
 };
 
-using Samples = std::vector<u8>;
-
 struct Parameters {
     Signedness sign;
     u8 sample_size;
@@ -43,10 +42,13 @@ public:
 
     /**
      * Called from the actual event timing at a constant period under a given sample rate.
-     * When sampling is enabled this function is expected to return a buffer of 16 samples in ideal
-     * conditions, but can be lax if the data is coming in from another source like a real mic.
+     * Copies the samples received since the last call to the buffer, which is the guest buffer
+     * itself, up to its end. The samples that don't fit are kept for the next call. When sampling
+     * is enabled this function is expected to copy 16 samples in ideal conditions, but can be lax
+     * if the data is coming in from another source like a real mic.
+     * @returns the number of bytes copied
      */
-    virtual Samples Read() = 0;
+    virtual std::size_t Read(u8* buffer, std::size_t max_size) = 0;
 
     /**
      * Adjusts the Parameters. Implementations should update the parameters field in addition to
@@ -94,7 +96,7 @@ public:
 
     void AdjustSampleRate(u32 sample_rate) override;
 
-    Samples Read() override;
+    std::size_t Read(u8* buffer, std::size_t max_size) override;
 };
 
 class StaticMic final : public Interface {
@@ -106,7 +108,7 @@ public:
     void StopSampling() override;
     void AdjustSampleRate(u32 sample_rate) override;
 
-    Samples Read() override;
+    std::size_t Read(u8* buffer, std::size_t max_size) override;
 
 private:
     u16 sample_rate = 0;
@@ -6,13 +6,19 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <climits>
+#include <condition_variable>
 #include <csignal>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <numeric>
+#include <thread>
+#include <vector>
 #include <fcntl.h>
 #include <fmt/format.h>
 
@@ -32,6 +38,7 @@
 #endif
 
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
@@ -41,12 +48,18 @@
 
 namespace GDBStub {
 namespace {
-constexpr int GDB_BUFFER_SIZE = 10000;
+/// Large enough for the replies of memory reads of 32 KiB in hex
+constexpr int GDB_BUFFER_SIZE = 0x10004;
 
 constexpr char GDB_STUB_START = '$';
 constexpr char GDB_STUB_END = '#';
 constexpr char GDB_STUB_ACK = '+';
 constexpr char GDB_STUB_NACK = '-';
+constexpr char GDB_STUB_ESCAPE = '}';
+constexpr char GDB_STUB_INTERRUPT = 0x03;
+
+/// How long a halted CPU waits for the next packet before returning to the frontend
+constexpr std::chrono::milliseconds HALTED_PACKET_WAIT{10};
 
 #ifndef SIGTRAP
 constexpr u32 SIGTRAP = 5;
@@ -147,6 +160,20 @@ std::atomic<bool> server_enabled(false);
 WSADATA InitData;
 #endif
 
+/// Serializes the writes to the socket of the reader thread and of the emulation thread
+std::mutex send_mutex;
+
+/**
+ * The reader thread blocks on the socket and queues the packets received for the emulation thread,
+ * which only checks packets_pending when there are none.
+ */
+std::thread reader_thread;
+std::mutex packet_mutex;
+std::condition_variable packet_cv;
+std::deque<std::vector<u8>> received_packets;
+std::atomic<bool> packets_pending(false);
+std::atomic<bool> connection_lost(false);
+
 struct Breakpoint {
     bool active;
     VAddr addr;
@@ -363,18 +390,6 @@ static u64 GdbHexToLong(const u8* src) {
     return output;
 }
 
-/// Read a byte from the gdb client.
-static u8 ReadByte() {
-    u8 c;
-    std::size_t received_size = recv(gdbserver_socket, reinterpret_cast<char*>(&c), 1, MSG_WAITALL);
-    if (received_size != 1) {
-        LOG_ERROR(Debug_GDBStub, "recv failed : {}", received_size);
-        Shutdown();
-    }
-
-    return c;
-}
-
 /// Calculate the checksum of the current command buffer.
 static u8 CalculateChecksum(const u8* buffer, std::size_t length) {
     return static_cast<u8>(std::accumulate(buffer, buffer + length, 0, std::plus<u8>()));
@@ -486,6 +501,7 @@ bool CheckBreakpoint(VAddr addr, BreakpointType type) {
  * @param packet Packet to be sent to client.
  */
 static void SendPacket(const char packet) {
+    std::lock_guard lock{send_mutex};
     std::size_t sent_size = send(gdbserver_socket, &packet, 1, 0);
     if (sent_size != 1) {
         LOG_ERROR(Debug_GDBStub, "send failed");
@@ -518,13 +534,15 @@ static void SendReply(const char* reply) {
     command_buffer[command_length + 2] = NibbleToHex(checksum >> 4);
     command_buffer[command_length + 3] = NibbleToHex(checksum);
 
+    std::lock_guard lock{send_mutex};
     u8* ptr = command_buffer;
     u32 left = command_length + 4;
     while (left > 0) {
         int sent_size = send(gdbserver_socket, reinterpret_cast<char*>(ptr), left, 0);
         if (sent_size < 0) {
             LOG_ERROR(Debug_GDBStub, "gdb: send failed");
-            return Shutdown();
+            connection_lost = true;
+            return;
         }
 
         left -= sent_size;
@@ -532,6 +550,48 @@ static void SendReply(const char* reply) {
     }
 }
 
+/**
+ * Sends the part of an object that a qXfer read asks for, the query ending with its offset and
+ * length.
+ */
+static void SendXferReply(const char* query, const std::string& object) {
+    const char* annex_end = strrchr(query, ':');
+    const char* separator = strchr(annex_end, ',');
+    if (!separator) {
+        return SendReply("E01");
+    }
+    const u32 offset = HexToInt(reinterpret_cast<const u8*>(annex_end + 1),
+                                static_cast<u32>(separator - annex_end - 1));
+    const u32 length = HexToInt(reinterpret_cast<const u8*>(separator + 1),
+                                static_cast<u32>(strlen(separator + 1)));
+    if (offset >= object.size()) {
+        return SendReply("l");
+    }
+
+    const std::string part = object.substr(offset, length);
+    const bool is_last = offset + part.size() >= object.size();
+    SendReply(((is_last ? "l" : "m") + part).c_str());
+}
+
+/// Builds the memory map of the current process, so that gdb knows which addresses it can read
+static std::string GetMemoryMap() {
+    std::string memory_map =
+        R"(<?xml version="1.0"?>)"
+        R"(<!DOCTYPE memory-map PUBLIC "+//IDN gnu.org//DTD GDB Memory Map V1.0//EN")"
+        R"( "http://sourceware.org/gdb/gdb-memory-map.dtd">)"
+        "<memory-map>";
+    const auto process = Core::System::GetInstance().Kernel().GetCurrentProcess();
+    if (process) {
+        for (const auto& [base, vma] : process->vm_manager.vma_map) {
+            if (vma.type != Kernel::VMAType::Free) {
+                memory_map += fmt::format(R"(<memory type="ram" start="0x{:x}" length="0x{:x}"/>)",
+                                          base, vma.size);
+            }
+        }
+    }
+    return memory_map + "</memory-map>";
+}
+
 /// Handle query command from gdb client.
 static void HandleQuery() {
     LOG_DEBUG(Debug_GDBStub, "gdb: query '{}'\n", command_buffer + 1);
@@ -542,10 +602,15 @@ static void HandleQuery() {
         SendReply("T0");
     } else if (strncmp(query, "Supported", strlen("Supported")) == 0) {
         // PacketSize needs to be large enough for target xml
-        SendReply("PacketSize=2000;qXfer:features:read+;qXfer:threads:read+");
+        SendReply(fmt::format("PacketSize={:x};qXfer:features:read+;qXfer:threads:read+;"
+                              "qXfer:memory-map:read+",
+                              GDB_BUFFER_SIZE - 4)
+                      .c_str());
     } else if (strncmp(query, "Xfer:features:read:target.xml:",
                        strlen("Xfer:features:read:target.xml:")) == 0) {
         SendReply(target_xml);
+    } else if (strncmp(query, "Xfer:memory-map:read::", strlen("Xfer:memory-map:read::")) == 0) {
+        SendXferReply(query, GetMemoryMap());
     } else if (strncmp(query, "fThreadInfo", strlen("fThreadInfo")) == 0) {
         std::string val = "m";
         u32 num_cores = Core::GetNumCores();
@@ -631,11 +696,14 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
 
     std::string buffer;
     if (full) {
-
-        buffer = fmt::format("T{:02x}{:02x}:{:08x};{:02x}:{:08x};{:02x}:{:08x}", latest_signal,
-                             PC_REGISTER, htonl(Core::GetRunningCore().GetPC()), SP_REGISTER,
-                             htonl(Core::GetRunningCore().GetReg(SP_REGISTER)), LR_REGISTER,
-                             htonl(Core::GetRunningCore().GetReg(LR_REGISTER)));
+        // All the core registers go along, gdb doesn't have to ask for them one by one
+        buffer = fmt::format("T{:02x}", latest_signal);
+        for (u32 reg = 0; reg < PC_REGISTER; ++reg) {
+            buffer += fmt::format("{:02x}:{:08x};", reg, htonl(Core::GetRunningCore().GetReg(reg)));
+        }
+        buffer += fmt::format("{:02x}:{:08x};{:02x}:{:08x}", PC_REGISTER,
+                              htonl(Core::GetRunningCore().GetPC()), CPSR_REGISTER,
+                              htonl(Core::GetRunningCore().GetCPSR()));
     } else {
         buffer = fmt::format("T{:02x}", latest_signal);
     }
@@ -648,75 +716,115 @@ static void SendSignal(Kernel::Thread* thread, u32 signal, bool full = true) {
     SendReply(buffer.c_str());
 }
 
-/// Read command from gdb client.
-static void ReadCommand() {
-    command_length = 0;
-    memset(command_buffer, 0, sizeof(command_buffer));
+/// Receives the packets of the gdb client and queues them, until the connection is closed
+static void ReaderLoop(int socket) {
+    Common::SetCurrentThreadName("GDBStub");
+
+    std::vector<u8> buffer(GDB_BUFFER_SIZE);
+    std::size_t buffer_position = 0;
+    std::size_t buffer_size = 0;
+    const auto read_byte = [&](u8& c) {
+        if (buffer_position == buffer_size) {
+            const int received_size =
+                recv(socket, reinterpret_cast<char*>(buffer.data()), GDB_BUFFER_SIZE, 0);
+            if (received_size <= 0) {
+                return false;
+            }
+            buffer_position = 0;
+            buffer_size = static_cast<std::size_t>(received_size);
+        }
+        c = buffer[buffer_position++];
+        return true;
+    };
+    const auto queue_packet = [](std::vector<u8> packet) {
+        {
+            std::lock_guard lock{packet_mutex};
+            received_packets.push_back(std::move(packet));
+            packets_pending = true;
+        }
+        packet_cv.notify_one();
+    };
 
-    u8 c = ReadByte();
-    if (c == '+') {
-        // ignore ack
-        return;
-    } else if (c == 0x03) {
-        LOG_INFO(Debug_GDBStub, "gdb: found break command\n");
-        halt_loop = true;
-        SendSignal(current_thread, SIGTRAP);
-        return;
-    } else if (c != GDB_STUB_START) {
-        LOG_DEBUG(Debug_GDBStub, "gdb: read invalid byte {:02x}\n", c);
-        return;
-    }
+    std::vector<u8> packet;
+    u8 c;
+    while (read_byte(c)) {
+        if (c == GDB_STUB_ACK) {
+            continue;
+        } else if (c == GDB_STUB_INTERRUPT) {
+            queue_packet({c});
+            continue;
+        } else if (c != GDB_STUB_START) {
+            LOG_DEBUG(Debug_GDBStub, "gdb: read invalid byte {:02x}\n", c);
+            continue;
+        }
 
-    while ((c = ReadByte()) != GDB_STUB_END) {
-        if (command_length >= sizeof(command_buffer)) {
+        // Binary data escapes the end character, so it only ever ends the packet
+        packet.clear();
+        bool overflow = false;
+        while (read_byte(c) && c != GDB_STUB_END) {
+            overflow |= packet.size() >= GDB_BUFFER_SIZE - 1;
+            if (!overflow) {
+                packet.push_back(c);
+            }
+        }
+        u8 checksum_high, checksum_low;
+        if (c != GDB_STUB_END || !read_byte(checksum_high) || !read_byte(checksum_low)) {
+            break;
+        }
+        if (overflow) {
             LOG_ERROR(Debug_GDBStub, "gdb: command_buffer overflow\n");
             SendPacket(GDB_STUB_NACK);
-            return;
+            continue;
         }
-        command_buffer[command_length++] = c;
-    }
-
-    u8 checksum_received = HexCharToValue(ReadByte()) << 4;
-    checksum_received |= HexCharToValue(ReadByte());
-
-    u8 checksum_calculated = CalculateChecksum(command_buffer, command_length);
 
-    if (checksum_received != checksum_calculated) {
-        LOG_ERROR(
-            Debug_GDBStub,
-            "gdb: invalid checksum: calculated {:02x} and read {:02x} for ${}# (length: {})\n",
-            checksum_calculated, checksum_received, command_buffer, command_length);
-
-        command_length = 0;
+        const u8 checksum_received =
+            static_cast<u8>(HexCharToValue(checksum_high) << 4 | HexCharToValue(checksum_low));
+        const u8 checksum_calculated = CalculateChecksum(packet.data(), packet.size());
+        if (checksum_received != checksum_calculated) {
+            LOG_ERROR(Debug_GDBStub,
+                      "gdb: invalid checksum: calculated {:02x} and read {:02x} (length: {})\n",
+                      checksum_calculated, checksum_received, packet.size());
+            SendPacket(GDB_STUB_NACK);
+            continue;
+        }
 
-        SendPacket(GDB_STUB_NACK);
-        return;
+        SendPacket(GDB_STUB_ACK);
+        queue_packet(std::move(packet));
+        packet = {};
     }
 
-    SendPacket(GDB_STUB_ACK);
+    LOG_INFO(Debug_GDBStub, "gdb: connection closed");
+    connection_lost = true;
+    packet_cv.notify_one();
 }
 
-/// Check if there is data to be read from the gdb client.
-static bool IsDataAvailable() {
-    if (!IsConnected()) {
+/**
+ * Takes the next packet received into the command buffer, waiting for it up to the timeout.
+ * @return whether there was a packet
+ */
+static bool ReadCommand(std::chrono::milliseconds timeout) {
+    command_length = 0;
+    memset(command_buffer, 0, sizeof(command_buffer));
+
+    // Nothing to lock nor any syscall while no packet is waiting, this runs with every slice
+    if (!packets_pending && timeout.count() == 0) {
         return false;
     }
 
-    fd_set fd_socket;
-
-    FD_ZERO(&fd_socket);
-    FD_SET(gdbserver_socket, &fd_socket);
-
-    struct timeval t;
-    t.tv_sec = 0;
-    t.tv_usec = 0;
-
-    if (select(gdbserver_socket + 1, &fd_socket, nullptr, nullptr, &t) < 0) {
-        LOG_ERROR(Debug_GDBStub, "select failed");
+    std::unique_lock lock{packet_mutex};
+    if (!packet_cv.wait_for(lock, timeout,
+                            [] { return !received_packets.empty() || connection_lost; }) ||
+        received_packets.empty()) {
         return false;
     }
+    const std::vector<u8> packet = std::move(received_packets.front());
+    received_packets.pop_front();
+    packets_pending = !received_packets.empty();
+    lock.unlock();
 
-    return FD_ISSET(gdbserver_socket, &fd_socket) != 0;
+    command_length = static_cast<u32>(packet.size());
+    std::copy(packet.begin(), packet.end(), command_buffer);
+    return true;
 }
 
 /// Send requested register to gdb client.
@@ -763,7 +871,7 @@ static void ReadRegisters() {
     bufptr += 8;
 
     for (u32 reg = D0_REGISTER; reg < FPSCR_REGISTER; reg++) {
-        LongToGdbHex(bufptr + reg * 16, FpuRead(reg, current_thread));
+        LongToGdbHex(bufptr + (reg - D0_REGISTER) * 16, FpuRead(reg, current_thread));
     }
 
     bufptr += 16 * 16;
@@ -845,8 +953,8 @@ static void ReadMemory() {
 
     LOG_DEBUG(Debug_GDBStub, "gdb: addr: {:08x} len: {:08x}\n", addr, len);
 
-    if (len * 2 > sizeof(reply)) {
-        SendReply("E01");
+    if (len * 2 >= sizeof(reply)) {
+        return SendReply("E01");
     }
 
     if (!Memory::IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
@@ -887,6 +995,49 @@ static void WriteMemory() {
     SendReply("OK");
 }
 
+/// Modify location in memory with the binary data of an X packet from the gdb client.
+static void WriteMemoryBinary() {
+    auto start_offset = command_buffer + 1;
+    const auto command_end = command_buffer + command_length;
+    auto addr_pos = std::find(start_offset, command_end, ',');
+    VAddr addr = HexToInt(start_offset, static_cast<u32>(addr_pos - start_offset));
+
+    start_offset = addr_pos + 1;
+    auto len_pos = std::find(start_offset, command_end, ':');
+    u32 len = HexToInt(start_offset, static_cast<u32>(len_pos - start_offset));
+    if (len_pos == command_end) {
+        return SendReply("E01");
+    }
+    // gdb probes the support of X packets with an empty one
+    if (len == 0) {
+        return SendReply("OK");
+    }
+
+    if (!Memory::IsValidVirtualAddress(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
+                                       addr)) {
+        return SendReply("E00");
+    }
+
+    std::vector<u8> data;
+    data.reserve(len);
+    for (auto it = len_pos + 1; it != command_end && data.size() < len; ++it) {
+        if (*it == GDB_STUB_ESCAPE && it + 1 != command_end) {
+            ++it;
+            data.push_back(*it ^ 0x20);
+        } else {
+            data.push_back(*it);
+        }
+    }
+    if (data.size() != len) {
+        return SendReply("E01");
+    }
+
+    Core::System::GetInstance().Memory().WriteBlock(
+        *Core::System::GetInstance().Kernel().GetCurrentProcess(), addr, data.data(), len);
+    Core::GetRunningCore().ClearInstructionCache();
+    SendReply("OK");
+}
+
 void Break(bool is_memory_break) {
     send_trap = true;
 
@@ -1050,12 +1201,21 @@ void HandlePacket() {
         return;
     }
 
-    if (!IsDataAvailable()) {
+    if (connection_lost) {
+        Shutdown();
+        return;
+    }
+
+    // While halted nothing else runs, waiting for the next packet keeps the loop from spinning
+    if (!ReadCommand(halt_loop && !step_loop ? HALTED_PACKET_WAIT
+                                             : std::chrono::milliseconds::zero())) {
         return;
     }
 
-    ReadCommand();
-    if (command_length == 0) {
+    if (command_buffer[0] == GDB_STUB_INTERRUPT) {
+        LOG_INFO(Debug_GDBStub, "gdb: found break command\n");
+        halt_loop = true;
+        SendSignal(current_thread, SIGTRAP);
         return;
     }
 
@@ -1093,6 +1253,9 @@ void HandlePacket() {
     case 'M':
         WriteMemory();
         break;
+    case 'X':
+        WriteMemoryBinary();
+        break;
     case 's':
         Step();
         return;
@@ -1208,6 +1371,8 @@ static void Init(u16 port) {
     } else {
         LOG_INFO(Debug_GDBStub, "Client connected.\n");
         saddr_client.sin_addr.s_addr = ntohl(saddr_client.sin_addr.s_addr);
+        connection_lost = false;
+        reader_thread = std::thread(ReaderLoop, gdbserver_socket);
     }
 
     // Clean up temporary socket if it's still alive at this point.
@@ -1231,6 +1396,15 @@ void Shutdown() {
         shutdown(gdbserver_socket, SHUT_RDWR);
         gdbserver_socket = -1;
     }
+    // The shutdown ends the blocking receive of the reader thread
+    if (reader_thread.joinable()) {
+        reader_thread.join();
+    }
+    {
+        std::lock_guard lock{packet_mutex};
+        received_packets.clear();
+        packets_pending = false;
+    }
 
 #ifdef _WIN32
     WSACleanup();
@@ -0,0 +1,133 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <numeric>
+#include <string>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/cache_file.h"
+#include "core/core_timing.h"
+#include "core/hack_tuner.h"
+#include "core/perf_stats.h"
+
+namespace Core {
+
+static constexpr u32 TUNING_FILE_VERSION = 0x1;
+
+/// Emulated time of a measurement, longer than the frame history of PerfStats so that each
+/// window only measures its own setting
+static constexpr s64 WINDOW_TICKS = BASE_CLOCK_RATE_ARM11 * 6;
+
+/// Windows skipped after the boot, which mostly load
+static constexpr u32 WARMUP_WINDOWS = 2;
+
+/// Windows per candidate, alternating off and on to even out the changes of the scene
+static constexpr u32 CANDIDATE_WINDOWS = 4;
+
+/// Share of the frame time a setting must save to be kept on
+static constexpr double MIN_GAIN = 0.05;
+
+static std::string GetTuningFile(u64 title_id) {
+    const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    return fmt::format("{}{:016X}.hacks", dir, title_id);
+}
+
+static u32 GetSettingBit(ProfileSetting setting) {
+    return 1U << static_cast<u32>(setting);
+}
+
+HackTuner::HackTuner(Timing& timing, PerfStats& perf_stats, u64 title_id,
+                     const TitleProfile& profile)
+    : timing(timing), perf_stats(perf_stats), title_id(title_id) {
+    for (std::size_t i = 0; i < NUM_PROFILE_SETTINGS; ++i) {
+        const auto setting = static_cast<ProfileSetting>(i);
+        if (profile.Get(setting) == ProfileValue::Auto) {
+            candidates.push_back(setting);
+            candidate_mask |= GetSettingBit(setting);
+        }
+    }
+
+    if (title_id != 0 && FileUtil::Exists(GetTuningFile(title_id))) {
+        CacheFile file(GetTuningFile(title_id), CacheFile::MODE_LOAD);
+        u32 version = 0;
+        u32 saved_candidates = 0;
+        u32 saved_enabled = 0;
+        file.DoHeader(version);
+        file.Do(saved_candidates);
+        file.Do(saved_enabled);
+        if (file.IsGood() && version == TUNING_FILE_VERSION && saved_candidates == candidate_mask) {
+            enabled_mask = saved_enabled & candidate_mask;
+            done = true;
+        }
+    }
+    ApplyEnabled(enabled_mask);
+    if (done || candidates.empty()) {
+        return;
+    }
+
+    update_event =
+        timing.RegisterEvent("HackTuner", [this](u64, s64 cycles_late) { Update(cycles_late); });
+    timing.ScheduleEvent(WINDOW_TICKS, update_event, 0, 0);
+}
+
+HackTuner::~HackTuner() {
+    if (update_event) {
+        timing.RemoveEvent(update_event);
+    }
+}
+
+void HackTuner::Update(s64 cycles_late) {
+    if (window < WARMUP_WINDOWS) {
+        ++window;
+    } else {
+        const PerfStats::FrameTimeStats stats = perf_stats.GetFrameTimeStats();
+        const u32 candidate_window = window - WARMUP_WINDOWS;
+        frame_cost[candidate_window % 2] +=
+            std::accumulate(stats.category_time.begin(), stats.category_time.end(), 0.0);
+        ++window;
+
+        if (candidate_window + 1 == CANDIDATE_WINDOWS) {
+            const ProfileSetting setting = candidates[candidate];
+            const bool faster = frame_cost[1] < frame_cost[0] * (1.0 - MIN_GAIN);
+            LOG_INFO(Core, "Tuned {}: {:.2f} ms per frame off, {:.2f} ms on, keeping it {}",
+                     GetProfileSettingName(setting), frame_cost[0] / (CANDIDATE_WINDOWS / 2),
+                     frame_cost[1] / (CANDIDATE_WINDOWS / 2), faster ? "on" : "off");
+            if (faster) {
+                enabled_mask |= GetSettingBit(setting);
+            }
+            frame_cost = {};
+            window = WARMUP_WINDOWS;
+            if (++candidate == candidates.size()) {
+                done = true;
+            }
+        }
+    }
+
+    if (done) {
+        ApplyEnabled(enabled_mask);
+        CacheFile file(GetTuningFile(title_id), CacheFile::MODE_SAVE);
+        u32 version = TUNING_FILE_VERSION;
+        file.DoHeader(version);
+        file.Do(candidate_mask);
+        file.Do(enabled_mask);
+        return;
+    }
+
+    // The next window measures the candidate on after a window with it off, and the other way
+    u32 mask = enabled_mask;
+    if (window >= WARMUP_WINDOWS && (window - WARMUP_WINDOWS) % 2 == 1) {
+        mask |= GetSettingBit(candidates[candidate]);
+    }
+    ApplyEnabled(mask);
+    timing.ScheduleEvent(WINDOW_TICKS - cycles_late, update_event, 0, 0);
+}
+
+void HackTuner::ApplyEnabled(u32 mask) const {
+    for (ProfileSetting setting : candidates) {
+        ApplyProfileSetting(setting, (mask & GetSettingBit(setting)) != 0);
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,53 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "common/common_types.h"
+#include "core/title_profile.h"
+
+namespace Core {
+
+class PerfStats;
+class Timing;
+struct TimingEventType;
+
+/**
+ * Decides the settings a title profile leaves on auto from the frame times. The profile only does
+ * so for settings that are correct either way for the title. During the first minutes of play each
+ * of them is measured off and on over alternating windows, and kept on if that saves enough of
+ * the host time spent per frame. The result is kept on the disk per title, and used instead of
+ * the tuning from the next session on, until the auto settings of the profile change.
+ */
+class HackTuner {
+public:
+    HackTuner(Timing& timing, PerfStats& perf_stats, u64 title_id, const TitleProfile& profile);
+    ~HackTuner();
+
+private:
+    void Update(s64 cycles_late);
+    void ApplyEnabled(u32 mask) const;
+
+    Timing& timing;
+    PerfStats& perf_stats;
+    const u64 title_id;
+    TimingEventType* update_event = nullptr;
+
+    /// Settings left to the tuner, and the mask of them in ProfileSetting bits
+    std::vector<ProfileSetting> candidates;
+    u32 candidate_mask = 0;
+    /// Settings found to be faster on
+    u32 enabled_mask = 0;
+
+    /// Candidate being measured, and the window of its measurement
+    std::size_t candidate = 0;
+    u32 window = 0;
+    /// Host milliseconds per frame, summed over the windows with the candidate off and on
+    std::array<double, 2> frame_cost{};
+    bool done = false;
+};
+
+} // namespace Core
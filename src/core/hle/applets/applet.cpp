@@ -15,6 +15,7 @@
 #include "core/hle/applets/mii_selector.h"
 #include "core/hle/applets/mint.h"
 #include "core/hle/applets/swkbd.h"
+#include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -37,6 +38,9 @@ struct hash<Service::APT::AppletId> {
 namespace HLE::Applets {
 
 static std::unordered_map<Service::APT::AppletId, std::shared_ptr<Applet>> applets;
+/// Framebuffer memory of the applets, kept after they exit for their next run
+static std::unordered_map<Service::APT::AppletId, std::shared_ptr<Kernel::SharedMemory>>
+    framebuffer_memories;
 /// The CoreTiming event identifier for the Applet update callback.
 static Core::TimingEventType* applet_update_event = nullptr;
 /// The interval at which the Applet update callback will be called, 16.6ms
@@ -118,6 +122,17 @@ void Applet::SendParameter(const Service::APT::MessageParameter& parameter) {
     }
 }
 
+std::shared_ptr<Kernel::SharedMemory> Applet::GetFramebufferMemory(u32 size, std::string name) {
+    auto& memory = framebuffer_memories[id];
+    if (!memory || memory->GetSize() != size) {
+        using Kernel::MemoryPermission;
+        // Create a SharedMemory that directly points to this heap block.
+        memory = Core::System::GetInstance().Kernel().CreateSharedMemoryForApplet(
+            0, size, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite, std::move(name));
+    }
+    return memory;
+}
+
 bool IsLibraryAppletRunning() {
     // Check the applets map for instances of any applet
     for (auto itr = applets.begin(); itr != applets.end(); ++itr)
@@ -133,6 +148,7 @@ void Init() {
 }
 
 void Shutdown() {
+    framebuffer_memories.clear();
     Core::System::GetInstance().CoreTiming().RemoveEvent(applet_update_event);
 }
 } // namespace HLE::Applets
@@ -5,9 +5,14 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include "core/hle/result.h"
 #include "core/hle/service/apt/applet_manager.h"
 
+namespace Kernel {
+class SharedMemory;
+}
+
 namespace HLE::Applets {
 
 class Applet {
@@ -73,6 +78,13 @@ protected:
 
     void SendParameter(const Service::APT::MessageParameter& parameter);
 
+    /**
+     * Returns the shared memory the application captures its framebuffer to. The block of the last
+     * run of the applet is kept and reused if it has the same size, rather than allocating and
+     * clearing a new one every time the applet starts.
+     */
+    std::shared_ptr<Kernel::SharedMemory> GetFramebufferMemory(u32 size, std::string name);
+
 private:
     std::weak_ptr<Service::APT::AppletManager> manager;
 };
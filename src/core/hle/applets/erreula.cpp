@@ -25,12 +25,7 @@ ResultCode ErrEula::ReceiveParameter(const Service::APT::MessageParameter& param
 
     memcpy(&capture_info, parameter.buffer.data(), sizeof(capture_info));
 
-    // TODO: allocated memory never released
-    using Kernel::MemoryPermission;
-    // Create a SharedMemory that directly points to this heap block.
-    framebuffer_memory = Core::System::GetInstance().Kernel().CreateSharedMemoryForApplet(
-        0, capture_info.size, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
-        "ErrEula Memory");
+    framebuffer_memory = GetFramebufferMemory(capture_info.size, "ErrEula Memory");
 
     // Send the response message with the newly created SharedMemory
     Service::APT::MessageParameter result;
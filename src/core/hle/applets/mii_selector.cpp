@@ -35,11 +35,7 @@ ResultCode MiiSelector::ReceiveParameter(const Service::APT::MessageParameter& p
 
     memcpy(&capture_info, parameter.buffer.data(), sizeof(capture_info));
 
-    using Kernel::MemoryPermission;
-    // Create a SharedMemory that directly points to this heap block.
-    framebuffer_memory = Core::System::GetInstance().Kernel().CreateSharedMemoryForApplet(
-        0, capture_info.size, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
-        "MiiSelector Memory");
+    framebuffer_memory = GetFramebufferMemory(capture_info.size, "MiiSelector Memory");
 
     // Send the response message with the newly created SharedMemory
     Service::APT::MessageParameter result;
@@ -71,6 +67,9 @@ ResultCode MiiSelector::StartImpl(const Service::APT::AppletStartupParameter& pa
 }
 
 void MiiSelector::Update() {
+    if (!frontend_applet->DataReady())
+        return;
+
     using namespace Frontend;
     const MiiSelectorData& data = frontend_applet->ReceiveData();
     result.return_code = data.return_code;
@@ -80,8 +79,6 @@ void MiiSelector::Update() {
         &result.selected_mii_data, sizeof(HLE::Applets::MiiData) + sizeof(result.unknown1));
     result.selected_guest_mii_index = 0xFFFFFFFF;
 
-    // TODO(Subv): We're finalizing the applet immediately after it's started,
-    // but we should defer this call until after all the input has been collected.
     Finalize();
 }
 
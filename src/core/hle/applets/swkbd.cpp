@@ -32,11 +32,7 @@ ResultCode SoftwareKeyboard::ReceiveParameter(Service::APT::MessageParameter con
 
         std::memcpy(&capture_info, parameter.buffer.data(), sizeof(capture_info));
 
-        using Kernel::MemoryPermission;
-        // Create a SharedMemory that directly points to this heap block.
-        framebuffer_memory = Core::System::GetInstance().Kernel().CreateSharedMemoryForApplet(
-            0, capture_info.size, MemoryPermission::ReadWrite, MemoryPermission::ReadWrite,
-            "SoftwareKeyboard Memory");
+        framebuffer_memory = GetFramebufferMemory(capture_info.size, "SoftwareKeyboard Memory");
 
         // Send the response message with the newly created SharedMemory
         Service::APT::MessageParameter result;
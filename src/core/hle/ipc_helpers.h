@@ -95,6 +95,9 @@ public:
 
     void PushStaticBuffer(std::vector<u8> buffer, u8 buffer_id);
 
+    /// Pushes a static buffer of the given size and returns it to be filled before the reply
+    u8* PushStaticBuffer(std::size_t size, u8 buffer_id);
+
     /// Pushes an HLE MappedBuffer interface back to unmapped the buffer.
     void PushMappedBuffer(const Kernel::MappedBuffer& mapped_buffer);
 
@@ -203,6 +206,16 @@ inline void RequestBuilder::PushStaticBuffer(std::vector<u8> buffer, u8 buffer_i
     context->AddStaticBuffer(buffer_id, std::move(buffer));
 }
 
+inline u8* RequestBuilder::PushStaticBuffer(std::size_t size, u8 buffer_id) {
+    ASSERT_MSG(buffer_id < MAX_STATIC_BUFFERS, "Invalid static buffer id");
+
+    Push(StaticBufferDesc(size, buffer_id));
+    // This address will be replaced by the correct static buffer address during IPC translation.
+    Push<VAddr>(0xDEADC0DE);
+
+    return context->PrepareStaticBuffer(buffer_id, size);
+}
+
 inline void RequestBuilder::PushMappedBuffer(const Kernel::MappedBuffer& mapped_buffer) {
     Push(mapped_buffer.GenerateDescriptor());
     Push(mapped_buffer.GetId());
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
@@ -69,8 +70,15 @@ private:
     /// the resumed thread.
     std::shared_ptr<Thread> ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Removes the thread from the waiters of the address, dropping the bucket once it is empty
+    void RemoveWaitingThread(VAddr address, const std::shared_ptr<Thread>& thread);
+
+    /**
+     * Threads waiting for the address arbiter to be signaled, by arbitration address and in the
+     * order they started waiting. Priorities can change during the wait, so the buckets are not
+     * kept sorted and a signal looks for the highest priority among the waiters of its address.
+     */
+    std::unordered_map<VAddr, std::vector<std::shared_ptr<Thread>>> waiting_threads;
 };
 
 } // namespace Kernel
@@ -24,6 +24,8 @@ ClientSession::~ClientSession() {
         std::shared_ptr<SessionRequestHandler> hle_handler = server->hle_handler;
         if (hle_handler)
             hle_handler->ClientDisconnected(server);
+        else if (server->fast_path)
+            server->fast_path->handler->ClientDisconnected(server);
 
         // Clean up the list of client threads with pending requests, they are unneeded now that the
         // client endpoint is closed.
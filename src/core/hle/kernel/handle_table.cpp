@@ -11,15 +11,6 @@
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
-namespace {
-constexpr u16 GetSlot(Handle handle) {
-    return handle >> 15;
-}
-
-constexpr u16 GetGeneration(Handle handle) {
-    return handle & 0x7FFF;
-}
-} // Anonymous namespace
 
 HandleTable::HandleTable(KernelSystem& kernel) : kernel(kernel) {
     next_generation = 1;
@@ -46,6 +37,7 @@ ResultVal<Handle> HandleTable::Create(std::shared_ptr<Object> obj) {
         next_generation = 1;
 
     generations[slot] = generation;
+    handle_types[slot] = obj->GetHandleType();
     objects[slot] = std::move(obj);
 
     Handle handle = generation | (slot << 15);
@@ -65,9 +57,10 @@ ResultCode HandleTable::Close(Handle handle) {
     if (!IsValid(handle))
         return ERR_INVALID_HANDLE;
 
-    u16 slot = GetSlot(handle);
+    const auto slot = static_cast<u16>(GetSlot(handle));
 
     objects[slot] = nullptr;
+    handle_types[slot] = HandleType::Unknown;
 
     generations[slot] = next_free_slot;
     next_free_slot = slot;
@@ -98,6 +91,7 @@ void HandleTable::Clear() {
     for (u16 i = 0; i < MAX_COUNT; ++i) {
         generations[i] = i + 1;
         objects[i] = nullptr;
+        handle_types[i] = HandleType::Unknown;
     }
     next_free_slot = 0;
 }
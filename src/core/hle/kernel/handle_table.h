@@ -84,9 +84,36 @@ public:
      */
     template <class T>
     std::shared_ptr<T> Get(Handle handle) const {
+        const std::size_t slot = GetSlot(handle);
+        if (slot < MAX_COUNT && generations[slot] == GetGeneration(handle)) {
+            if (!IsObjectOfType<T>(handle_types[slot])) {
+                return nullptr;
+            }
+            return std::static_pointer_cast<T>(objects[slot]);
+        }
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /**
+     * Looks up a handle while verifying its type, without taking a reference to the object. The
+     * object stays alive as long as the handle isn't closed, so the pointer is meant to be used
+     * within the SVC that looked it up.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid or its
+     *         type differs from the requested one.
+     */
+    template <class T>
+    T* GetPointer(Handle handle) const {
+        const std::size_t slot = GetSlot(handle);
+        if (slot < MAX_COUNT && generations[slot] == GetGeneration(handle)) {
+            if (!IsObjectOfType<T>(handle_types[slot])) {
+                return nullptr;
+            }
+            return static_cast<T*>(objects[slot].get());
+        }
+        // The pseudo-handles, whose objects are kept alive by the kernel
+        return DynamicObjectCast<T>(GetGeneric(handle)).get();
+    }
+
     /// Closes all handles held in this table.
     void Clear();
 
@@ -108,9 +135,24 @@ private:
      */
     static const std::size_t MAX_COUNT = 4096;
 
+    static constexpr std::size_t GetSlot(Handle handle) {
+        return handle >> 15;
+    }
+
+    static constexpr u16 GetGeneration(Handle handle) {
+        return handle & 0x7FFF;
+    }
+
     /// Stores the Object referenced by the handle or null if the slot is empty.
     std::array<std::shared_ptr<Object>, MAX_COUNT> objects;
 
+    /**
+     * The type of the object of each slot, Unknown for empty slots. Lets lookups check the type
+     * without dereferencing the object, and without checking the slot isn't empty: no type
+     * matches Unknown.
+     */
+    std::array<HandleType, MAX_COUNT> handle_types;
+
     /**
      * The value of `next_generation` when the handle was created, used to check for validity. For
      * empty slots, contains the index of the next free slot in the list.
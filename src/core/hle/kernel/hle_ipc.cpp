@@ -58,6 +58,10 @@ void SessionRequestHandler::ClientConnected(std::shared_ptr<ServerSession> serve
     connected_sessions.emplace_back(std::move(server_session), MakeSessionData());
 }
 
+void SessionRequestHandler::FastPathClientConnected(std::shared_ptr<ServerSession> server_session) {
+    connected_sessions.emplace_back(std::move(server_session), MakeSessionData());
+}
+
 void SessionRequestHandler::ClientDisconnected(std::shared_ptr<ServerSession> server_session) {
     server_session->SetHleHandler(nullptr);
     connected_sessions.erase(
@@ -91,6 +95,17 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(std::shared_ptr<ServerSession> session_, Thread* thread_) {
+    session = std::move(session_);
+    thread = thread_;
+    cmd_buf[0] = 0;
+    request_handles.clear();
+    request_mapped_buffers.clear();
+    for (auto& buffer : static_buffers) {
+        buffer.clear();
+    }
+}
+
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
     return request_handles[id_from_cmdbuf];
@@ -113,6 +128,12 @@ void HLERequestContext::AddStaticBuffer(u8 buffer_id, std::vector<u8> data) {
     static_buffers[buffer_id] = std::move(data);
 }
 
+u8* HLERequestContext::PrepareStaticBuffer(u8 buffer_id, std::size_t size) {
+    std::vector<u8>& buffer = static_buffers[buffer_id];
+    buffer.resize(size);
+    return buffer.data();
+}
+
 ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* src_cmdbuf,
                                                                 Process& src_process) {
     IPC::Header header{src_cmdbuf[0]};
@@ -123,7 +144,11 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
 
     std::copy_n(src_cmdbuf, untranslated_size, cmd_buf.begin());
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
+    const auto record_mode = kernel.GetIPCRecorder().GetRecordMode(thread);
+    const bool should_record = record_mode == IPCDebugger::RecordMode::Full;
+    if (record_mode == IPCDebugger::RecordMode::Count) {
+        kernel.GetIPCRecorder().CountRequest(*thread, src_cmdbuf[0]);
+    }
 
     std::vector<u32> untranslated_cmdbuf;
     if (should_record) {
@@ -163,11 +188,11 @@ ResultCode HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* sr
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into our own vector, reusing the one of a previous request.
+            std::vector<u8>& data = static_buffers[buffer_info.buffer_id];
+            data.resize(buffer_info.size);
             kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
 
-            AddStaticBuffer(buffer_info.buffer_id, std::move(data));
             cmd_buf[i++] = source_address;
             break;
         }
@@ -202,7 +227,11 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
 
     std::copy_n(cmd_buf.begin(), untranslated_size, dst_cmdbuf);
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
+    const auto record_mode = kernel.GetIPCRecorder().GetRecordMode(thread);
+    const bool should_record = record_mode == IPCDebugger::RecordMode::Full;
+    if (record_mode == IPCDebugger::RecordMode::Count) {
+        kernel.GetIPCRecorder().CountReply(*thread);
+    }
 
     std::vector<u32> untranslated_cmdbuf;
     if (should_record) {
@@ -301,4 +330,28 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+std::shared_ptr<HLERequestContext> RequestContextPool::Acquire(
+    KernelSystem& kernel, std::shared_ptr<ServerSession> session, Thread* thread) {
+    for (const auto& context : contexts) {
+        if (context.use_count() == 1) {
+            context->Reset(std::move(session), thread);
+            return context;
+        }
+    }
+
+    auto context = std::make_shared<HLERequestContext>(kernel, std::move(session), thread);
+    if (contexts.size() < MAX_POOLED_CONTEXTS) {
+        contexts.push_back(context);
+    }
+    return context;
+}
+
+void RequestContextPool::Release(const std::shared_ptr<HLERequestContext>& context) {
+    // Any reference besides the ones of the pool and the caller belongs to a sleeping client
+    const bool pooled = std::find(contexts.begin(), contexts.end(), context) != contexts.end();
+    if (context.use_count() == (pooled ? 2 : 1)) {
+        context->Reset(nullptr, nullptr);
+    }
+}
+
 } // namespace Kernel
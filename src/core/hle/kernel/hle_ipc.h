@@ -64,6 +64,13 @@ public:
      */
     virtual void ClientDisconnected(std::shared_ptr<ServerSession> server_session);
 
+    /**
+     * Signals that a client has just connected to the LLE service this handler serves fast paths
+     * of. The session gets its session data, but its requests keep going to the LLE server.
+     * @param server_session ServerSession associated with the connection.
+     */
+    void FastPathClientConnected(std::shared_ptr<ServerSession> server_session);
+
     /// Empty placeholder structure for services with no per-session data. The session data classes
     /// in each service must inherit from this.
     struct SessionDataBase {
@@ -96,6 +103,21 @@ protected:
     std::vector<SessionInfo> connected_sessions;
 };
 
+/**
+ * An HLE handler answering a few commands of a service that an LLE module implements, the others
+ * still go to the module. The handler keeps its own state apart from the module's, so it should
+ * only answer commands whose result does not depend on what the module was asked before.
+ */
+struct FastPathHandler {
+    std::shared_ptr<SessionRequestHandler> handler;
+    /// Command headers the handler answers
+    std::vector<u32> headers;
+
+    bool Serves(u32 header) const {
+        return std::find(headers.begin(), headers.end(), header) != headers.end();
+    }
+};
+
 class MappedBuffer {
 public:
     MappedBuffer(Memory::MemorySystem& memory, const Process& process, u32 descriptor,
@@ -227,6 +249,12 @@ public:
      */
     void AddStaticBuffer(u8 buffer_id, std::vector<u8> data);
 
+    /**
+     * Like AddStaticBuffer, but returns a buffer of the given size to be filled in place. The
+     * memory of the buffers of earlier requests on this context is reused.
+     */
+    u8* PrepareStaticBuffer(u8 buffer_id, std::size_t size);
+
     /**
      * Gets a memory interface by the id from the request command buffer. See the "HLE mapped buffer
      * protocol" section in the class documentation for more details.
@@ -241,6 +269,12 @@ public:
     /// Reports an unimplemented function.
     void ReportUnimplemented() const;
 
+    /**
+     * Prepares a finished context for another request, keeping the capacity of its buffers so
+     * that the common requests do not allocate.
+     */
+    void Reset(std::shared_ptr<ServerSession> session, Thread* thread);
+
     class ThreadCallback;
     friend class ThreadCallback;
 
@@ -257,4 +291,23 @@ private:
     boost::container::small_vector<MappedBuffer, 8> request_mapped_buffers;
 };
 
+/**
+ * Recycles the contexts of finished HLE requests. A context is finished once nothing but the pool
+ * references it, which is right after the service returns unless it put the client to sleep.
+ */
+class RequestContextPool {
+public:
+    std::shared_ptr<HLERequestContext> Acquire(KernelSystem& kernel,
+                                               std::shared_ptr<ServerSession> session,
+                                               Thread* thread);
+
+    /// Drops the objects referenced by the context, the session among them, if it is finished
+    void Release(const std::shared_ptr<HLERequestContext>& context);
+
+private:
+    /// Enough for the requests of the clients put to sleep at once by most titles
+    static constexpr std::size_t MAX_POOLED_CONTEXTS = 16;
+    std::vector<std::shared_ptr<HLERequestContext>> contexts;
+};
+
 } // namespace Kernel
@@ -39,7 +39,17 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     memory.ReadBlock(*src_process, src_address, cmd_buf.data(), command_size * sizeof(u32));
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
+    auto& recorder = kernel.GetIPCRecorder();
+    const Thread& client_thread = reply ? *dst_thread : *src_thread;
+    const auto record_mode = recorder.GetRecordMode(&client_thread);
+    const bool should_record = record_mode == IPCDebugger::RecordMode::Full;
+    if (record_mode == IPCDebugger::RecordMode::Count) {
+        if (reply) {
+            recorder.CountReply(client_thread);
+        } else {
+            recorder.CountRequest(client_thread, cmd_buf[0]);
+        }
+    }
 
     std::vector<u32> untranslated_cmdbuf;
     if (should_record) {
@@ -188,33 +198,38 @@ ResultCode TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySy
                 break;
             }
 
-            VAddr target_address = 0;
-
             // TODO(Subv): Perform permission checks.
 
+            // The buffer is mapped with a reserved page on each side, which the reply unmaps
+            // together, so the three are placed with a single search of the mapping region.
+            auto& vm_manager = dst_process->vm_manager;
+            const VAddr reserve_address =
+                vm_manager
+                    .FindFreeRange(Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE,
+                                   (num_pages + 2) * Memory::PAGE_SIZE)
+                    .Unwrap();
+            const VAddr target_address = reserve_address + Memory::PAGE_SIZE;
+
             // Reserve a page of memory before the mapped buffer
             auto reserve_buffer = std::make_unique<u8[]>(Memory::PAGE_SIZE);
-            dst_process->vm_manager.MapBackingMemoryToBase(
-                Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE, reserve_buffer.get(),
-                Memory::PAGE_SIZE, Kernel::MemoryState::Reserved);
+            vm_manager.MapBackingMemory(reserve_address, reserve_buffer.get(), Memory::PAGE_SIZE,
+                                        Kernel::MemoryState::Reserved);
 
             auto buffer = std::make_unique<u8[]>(num_pages * Memory::PAGE_SIZE);
             memory.ReadBlock(*src_process, source_address, buffer.get() + page_offset, size);
 
             // Map the page(s) into the target process' address space.
-            target_address =
-                dst_process->vm_manager
-                    .MapBackingMemoryToBase(Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE,
-                                            buffer.get(), num_pages * Memory::PAGE_SIZE,
-                                            Kernel::MemoryState::Shared)
-                    .Unwrap();
+            vm_manager
+                .MapBackingMemory(target_address, buffer.get(), num_pages * Memory::PAGE_SIZE,
+                                  Kernel::MemoryState::Shared)
+                .Unwrap();
 
             cmd_buf[i++] = target_address + page_offset;
 
             // Reserve a page of memory after the mapped buffer
-            dst_process->vm_manager.MapBackingMemoryToBase(
-                Memory::IPC_MAPPING_VADDR, Memory::IPC_MAPPING_SIZE, reserve_buffer.get(),
-                Memory::PAGE_SIZE, Kernel::MemoryState::Reserved);
+            vm_manager.MapBackingMemory(target_address + num_pages * Memory::PAGE_SIZE,
+                                        reserve_buffer.get(), Memory::PAGE_SIZE,
+                                        Kernel::MemoryState::Reserved);
 
             mapped_buffer_context.push_back({permissions, size, source_address,
                                              target_address + page_offset, std::move(buffer),
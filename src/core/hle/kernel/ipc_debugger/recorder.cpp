@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/hle/kernel/client_port.h"
@@ -37,8 +38,28 @@ ObjectInfo GetObjectInfo(const Kernel::Process* process) {
     }
     return {process->GetTypeName(), process->GetName(), static_cast<int>(process->process_id)};
 }
+
+std::size_t GetLatencyBucket(u64 latency_ns) {
+    std::size_t bucket = 0;
+    for (u64 us = latency_ns / 1000; us != 0; us >>= 1) {
+        ++bucket;
+    }
+    return std::min(bucket, CommandStats::NUM_LATENCY_BUCKETS - 1);
+}
 } // namespace
 
+u64 CommandStats::GetPercentileUs(double fraction) const {
+    const u64 target = static_cast<u64>(count * fraction);
+    u64 below = 0;
+    for (std::size_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+        below += latency_histogram[i];
+        if (below > target) {
+            return u64{1} << i;
+        }
+    }
+    return u64{1} << (NUM_LATENCY_BUCKETS - 1);
+}
+
 Recorder::Recorder() = default;
 Recorder::~Recorder() = default;
 
@@ -50,10 +71,42 @@ bool Recorder::IsEnabled() const {
 #endif
 }
 
+RecordMode Recorder::GetRecordMode(const Kernel::Thread* client_thread) const {
+    if (!IsEnabled()) {
+        return RecordMode::None;
+    }
+    const auto pending = pending_map.find(client_thread->GetThreadId());
+    // A request sent before the recorder was enabled goes through the full path, which reports it
+    if (pending != pending_map.end() && !pending->second.full) {
+        return RecordMode::Count;
+    }
+    return RecordMode::Full;
+}
+
 void Recorder::RegisterRequest(const std::shared_ptr<Kernel::ClientSession>& client_session,
                                const std::shared_ptr<Kernel::Thread>& client_thread) {
     const u32 thread_id = client_thread->GetThreadId();
 
+    if (reset_requested.exchange(false, std::memory_order_relaxed)) {
+        handler_times.clear();
+        pending_map.clear();
+
+        std::lock_guard lock(command_stats_mutex);
+        command_stats.fill({});
+        num_command_stats = 0;
+    }
+
+    const u32 interval = sample_interval.load(std::memory_order_relaxed);
+    const bool full = interval <= 1 || ++sample_counter % interval == 0;
+    const auto& port = client_session->parent->port;
+    pending_map.insert_or_assign(
+        thread_id, PendingRequest{std::chrono::steady_clock::now(),
+                                  port ? port->GetName() : std::string{},
+                                  port ? static_cast<int>(port->GetObjectId()) : -1, 0, full});
+    if (!full) {
+        return;
+    }
+
     RequestRecord record = {/* id */ ++record_count,
                             /* status */ RequestStatus::Sent,
                             /* client_process */ GetObjectInfo(client_thread->owner_process),
@@ -82,6 +135,10 @@ void Recorder::SetRequestInfo(const std::shared_ptr<Kernel::Thread>& client_thre
 
     auto& record = *record_map[thread_id];
     record.status = RequestStatus::Handling;
+    const auto pending = pending_map.find(thread_id);
+    if (pending != pending_map.end() && !untranslated_cmdbuf.empty()) {
+        pending->second.header = untranslated_cmdbuf[0];
+    }
     record.untranslated_request_cmdbuf = std::move(untranslated_cmdbuf);
     record.translated_request_cmdbuf = std::move(translated_cmdbuf);
 
@@ -105,6 +162,11 @@ void Recorder::SetRequestInfo(const std::shared_ptr<Kernel::Thread>& client_thre
     client_session_map.erase(thread_id);
 
     InvokeCallbacks(record);
+
+    // Taken last, so that the callbacks aren't accounted to the handler
+    if (record.is_hle) {
+        handling_start_map.insert_or_assign(thread_id, std::chrono::steady_clock::now());
+    }
 }
 
 void Recorder::SetReplyInfo(const std::shared_ptr<Kernel::Thread>& client_thread,
@@ -122,14 +184,91 @@ void Recorder::SetReplyInfo(const std::shared_ptr<Kernel::Thread>& client_thread
         record.status = RequestStatus::Handled;
     }
 
+    const auto start = handling_start_map.find(thread_id);
+    if (start != handling_start_map.end()) {
+        record.handling_time_ns = static_cast<u64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                 start->second)
+                .count());
+        handling_start_map.erase(start);
+
+        HandlerTime& handler_time =
+            handler_times[record.server_session.name + "::" + record.function_name];
+        handler_time.total_ns += record.handling_time_ns;
+        ++handler_time.call_count;
+        record.function_total_time_ns = handler_time.total_ns;
+        record.function_call_count = handler_time.call_count;
+    }
+
     record.untranslated_reply_cmdbuf = std::move(untranslated_cmdbuf);
     record.translated_reply_cmdbuf = std::move(translated_cmdbuf);
+    CountLatency(thread_id);
     InvokeCallbacks(record);
 
     record_map.erase(thread_id);
 }
 
+void Recorder::CountRequest(const Kernel::Thread& client_thread, u32 header) {
+    const auto pending = pending_map.find(client_thread.GetThreadId());
+    if (pending != pending_map.end()) {
+        pending->second.header = header;
+    }
+}
+
+void Recorder::CountReply(const Kernel::Thread& client_thread) {
+    CountLatency(client_thread.GetThreadId());
+}
+
+void Recorder::CountLatency(u32 thread_id) {
+    const auto pending = pending_map.find(thread_id);
+    if (pending == pending_map.end()) {
+        return;
+    }
+    const PendingRequest& request = pending->second;
+    const u64 latency_ns = static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                             request.sent_time)
+            .count());
+
+    std::lock_guard lock(command_stats_mutex);
+    const std::size_t hash = std::hash<u64>{}(static_cast<u64>(request.port_id) << 32 |
+                                              request.header);
+    for (std::size_t probe = 0; probe < MAX_COMMAND_STATS; ++probe) {
+        CommandStats& stats = command_stats[(hash + probe) % MAX_COMMAND_STATS];
+        if (stats.count == 0) {
+            // Some room is kept so that the probes of the missing commands stay short
+            if (num_command_stats >= MAX_COMMAND_STATS * 3 / 4) {
+                break;
+            }
+            ++num_command_stats;
+            stats.port_name = request.port_name;
+            stats.port_id = request.port_id;
+            stats.header = request.header;
+        } else if (stats.port_id != request.port_id || stats.header != request.header) {
+            continue;
+        }
+        ++stats.count;
+        stats.total_ns += latency_ns;
+        ++stats.latency_histogram[GetLatencyBucket(latency_ns)];
+        break;
+    }
+    pending_map.erase(pending);
+}
+
+std::vector<CommandStats> Recorder::GetCommandStats() const {
+    std::lock_guard lock(command_stats_mutex);
+    std::vector<CommandStats> stats;
+    stats.reserve(num_command_stats);
+    std::copy_if(command_stats.begin(), command_stats.end(), std::back_inserter(stats),
+                 [](const CommandStats& entry) { return entry.count != 0; });
+    return stats;
+}
+
 void Recorder::SetHLEUnimplemented(const std::shared_ptr<Kernel::Thread>& client_thread) {
+    if (GetRecordMode(client_thread.get()) == RecordMode::Count) {
+        return;
+    }
+
     const u32 thread_id = client_thread->GetThreadId();
     if (!record_map.count(thread_id)) {
         // This is possible when the recorder is enabled after application started
@@ -163,7 +302,15 @@ void Recorder::InvokeCallbacks(const RequestRecord& request) {
 }
 
 void Recorder::SetEnabled(bool enabled_) {
+    if (enabled_ && !enabled.load(std::memory_order_relaxed)) {
+        // The counts belong to the emulation thread, which resets them with the next request
+        reset_requested.store(true, std::memory_order_relaxed);
+    }
     enabled.store(enabled_, std::memory_order_relaxed);
 }
 
+void Recorder::SetSampleInterval(u32 interval) {
+    sample_interval.store(interval, std::memory_order_relaxed);
+}
+
 } // namespace IPCDebugger
@@ -4,9 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <shared_mutex>
 #include <string>
@@ -62,6 +65,42 @@ struct RequestRecord {
     // Reply info is only available when status is `Handled`
     std::vector<u32> untranslated_reply_cmdbuf;
     std::vector<u32> translated_reply_cmdbuf;
+    // Host time the HLE handler took, and the totals of the function over the recording so far.
+    // Only available for HLE requests when status is `Handled`
+    u64 handling_time_ns = 0;
+    u64 function_total_time_ns = 0;
+    u64 function_call_count = 0;
+};
+
+/**
+ * Requests of a command of a service, counted whether they are recorded in full or not.
+ */
+struct CommandStats {
+    static constexpr std::size_t NUM_LATENCY_BUCKETS = 16;
+
+    std::string port_name; // Empty for portless sessions
+    int port_id = -1;
+    u32 header = 0;
+    u64 count = 0;
+    /// Host time from the request being sent to the reply, summed over the requests
+    u64 total_ns = 0;
+    /// Bucket i counts the latencies under 2^i microseconds, the last one all the longer ones
+    std::array<u32, NUM_LATENCY_BUCKETS> latency_histogram{};
+
+    /// Upper bound of the bucket the given fraction of the requests is under, in microseconds
+    u64 GetPercentileUs(double fraction) const;
+};
+
+/**
+ * How a request is recorded:
+ *  - None: the recorder is disabled
+ *  - Count: only its command and latency are counted, its command buffers aren't needed
+ *  - Full: the whole record is kept and passed to the callbacks
+ */
+enum class RecordMode {
+    None,
+    Count,
+    Full,
 };
 
 using CallbackType = std::function<void(const RequestRecord&)>;
@@ -77,8 +116,14 @@ public:
      */
     bool IsEnabled() const;
 
+    /**
+     * Returns how the request of the client thread is recorded.
+     */
+    RecordMode GetRecordMode(const Kernel::Thread* client_thread) const;
+
     /**
      * Registers a request into the recorder. The request is then assoicated with the client thread.
+     * When sampling, only every Nth request is recorded in full, the others are only counted.
      */
     void RegisterRequest(const std::shared_ptr<Kernel::ClientSession>& client_session,
                          const std::shared_ptr<Kernel::Thread>& client_thread);
@@ -98,6 +143,16 @@ public:
     void SetReplyInfo(const std::shared_ptr<Kernel::Thread>& client_thread,
                       std::vector<u32> untranslated_cmdbuf, std::vector<u32> translated_cmdbuf);
 
+    /**
+     * Sets the command of a request that is only counted, in place of SetRequestInfo.
+     */
+    void CountRequest(const Kernel::Thread& client_thread, u32 header);
+
+    /**
+     * Counts the reply to a request that is only counted, in place of SetReplyInfo.
+     */
+    void CountReply(const Kernel::Thread& client_thread);
+
     /**
      * Set the status of a record to HLEUnimplemented.
      */
@@ -108,19 +163,65 @@ public:
      */
     void SetEnabled(bool enabled);
 
+    /**
+     * Records only one request in full out of the given number, 0 and 1 record all of them.
+     */
+    void SetSampleInterval(u32 interval);
+
+    /**
+     * Returns the counts of the commands since the recorder was enabled.
+     */
+    std::vector<CommandStats> GetCommandStats() const;
+
     CallbackHandle BindCallback(CallbackType callback);
     void UnbindCallback(const CallbackHandle& handle);
 
 private:
     void InvokeCallbacks(const RequestRecord& request);
 
+    /// Time spent in the HLE handlers of a function since the recorder was enabled
+    struct HandlerTime {
+        u64 total_ns = 0;
+        u64 call_count = 0;
+    };
+
+    /// A request waiting for its reply
+    struct PendingRequest {
+        std::chrono::steady_clock::time_point sent_time;
+        std::string port_name;
+        int port_id;
+        u32 header;
+        bool full;
+    };
+
+    /// The commands counted beyond this are dropped
+    static constexpr std::size_t MAX_COMMAND_STATS = 1024;
+
+    /// Adds the latency of the pending request of a client thread to its command, and removes it
+    void CountLatency(u32 thread_id);
+
     std::unordered_map<u32, std::unique_ptr<RequestRecord>> record_map;
     int record_count{};
 
+    std::unordered_map<u32, PendingRequest> pending_map;
+    std::atomic<u32> sample_interval{0};
+    u32 sample_counter = 0;
+
+    // Open addressing over (port_id, header), an entry with a zero count is free
+    std::array<CommandStats, MAX_COMMAND_STATS> command_stats;
+    std::size_t num_command_stats = 0;
+    mutable std::mutex command_stats_mutex;
+
+    // When the HLE handler of the request of each client thread started
+    std::unordered_map<u32, std::chrono::steady_clock::time_point> handling_start_map;
+    // Keyed by server session and function name
+    std::unordered_map<std::string, HandlerTime> handler_times;
+
     // Temporary client session map for function name handling
     std::unordered_map<u32, std::shared_ptr<Kernel::ClientSession>> client_session_map;
 
     std::atomic_bool enabled{false};
+    std::atomic_bool reset_requested{false};
 
     std::set<CallbackHandle> callbacks;
     mutable std::shared_mutex callback_mutex;
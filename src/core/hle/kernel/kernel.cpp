@@ -5,6 +5,7 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
@@ -16,6 +17,9 @@
 
 namespace Kernel {
 
+/// Core run by the calling host thread during a parallel slice
+static thread_local ARM_Interface* parallel_cpu = nullptr;
+
 /// Initialize the kernel
 KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing, u32 system_mode,
                            u8 n3ds_mode)
@@ -28,6 +32,7 @@ KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing, u
     }
     timer_manager = std::make_unique<TimerManager>(timing);
     ipc_recorder = std::make_unique<IPCDebugger::Recorder>();
+    request_context_pool = std::make_unique<RequestContextPool>();
 
     next_thread_id = 1;
 }
@@ -59,11 +64,29 @@ void KernelSystem::Initialize(const std::shared_ptr<Process>& process, ARM_Inter
     }
 }
 
+ARM_Interface* KernelSystem::CurrentCPU() const {
+    return parallel_cpu ? parallel_cpu : current_cpu;
+}
+
+ARM_Interface& KernelSystem::GetRunningCore() {
+    return *CurrentCPU();
+}
+
 std::shared_ptr<Process> KernelSystem::GetCurrentProcess() const {
+    if (parallel_cpu) {
+        return stored_processes[parallel_cpu->GetID()];
+    }
     return current_process;
 }
 
 void KernelSystem::SetCurrentProcess(const std::shared_ptr<Process>& process) {
+    if (parallel_cpu) {
+        stored_processes[parallel_cpu->GetID()] = process;
+        memory.SetCurrentPageTable(&process->vm_manager.page_table);
+        parallel_cpu->SetPageTable(&process->vm_manager.page_table);
+        return;
+    }
+
     current_process = process;
     memory.SetCurrentPageTable(&process->vm_manager.page_table);
     stored_processes[current_cpu->GetID()] = process;
@@ -71,11 +94,16 @@ void KernelSystem::SetCurrentProcess(const std::shared_ptr<Process>& process) {
 }
 
 void KernelSystem::SetCurrentProcessForCPU(const std::shared_ptr<Process>& process, u32 core_id) {
-    if (current_cpu->GetID() == core_id) {
+    if (CurrentCPU()->GetID() == core_id) {
         SetCurrentProcess(process);
     } else {
         stored_processes[core_id] = process;
-        thread_managers[core_id]->cpu->SetPageTable(&process->vm_manager.page_table);
+        // The other core may be running on its own thread, it switches in FinishParallelRun
+        if (parallel_cpu) {
+            pending_page_tables[core_id] = true;
+        } else {
+            thread_managers[core_id]->cpu->SetPageTable(&process->vm_manager.page_table);
+        }
     }
 }
 
@@ -111,6 +139,41 @@ void KernelSystem::Run(ARM_Interface* cpu) {
     }
 }
 
+void KernelSystem::RunParallel(ARM_Interface* cpu) {
+    const u32 cpu_id = cpu->GetID();
+    parallel_cpu = cpu;
+    timing.SetThreadTimer(cpu_id);
+
+    if (thread_managers[cpu_id]->GetCurrentThread() == nullptr) {
+        LOG_TRACE(Core_ARM11, "Core {} idling", cpu_id);
+        cpu->GetTimer().Idle();
+        thread_managers[cpu_id]->PrepareReschedule();
+    } else {
+        cpu->Run();
+    }
+
+    timing.ClearThreadTimer();
+    parallel_cpu = nullptr;
+}
+
+void KernelSystem::ActivateParallelPageTable() {
+    if (parallel_cpu) {
+        memory.SetCurrentPageTable(&stored_processes[parallel_cpu->GetID()]->vm_manager.page_table);
+    }
+}
+
+void KernelSystem::FinishParallelRun() {
+    // Process switches during the slices only went to the records of each core
+    current_process = stored_processes[current_cpu->GetID()];
+    memory.SetCurrentPageTable(&current_process->vm_manager.page_table);
+    for (u32 i = 0; i < thread_managers.size(); ++i) {
+        if (pending_page_tables[i]) {
+            thread_managers[i]->cpu->SetPageTable(&stored_processes[i]->vm_manager.page_table);
+            pending_page_tables[i] = false;
+        }
+    }
+}
+
 ThreadManager& KernelSystem::GetThreadManager(u32 core_id) {
     return *thread_managers[core_id];
 }
@@ -120,11 +183,11 @@ const ThreadManager& KernelSystem::GetThreadManager(u32 core_id) const {
 }
 
 ThreadManager& KernelSystem::GetCurrentThreadManager() {
-    return *thread_managers[current_cpu->GetID()];
+    return *thread_managers[CurrentCPU()->GetID()];
 }
 
 const ThreadManager& KernelSystem::GetCurrentThreadManager() const {
-    return *thread_managers[current_cpu->GetID()];
+    return *thread_managers[CurrentCPU()->GetID()];
 }
 
 TimerManager& KernelSystem::GetTimerManager() {
@@ -151,12 +214,16 @@ const IPCDebugger::Recorder& KernelSystem::GetIPCRecorder() const {
     return *ipc_recorder;
 }
 
+RequestContextPool& KernelSystem::GetRequestContextPool() {
+    return *request_context_pool;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
 
 void KernelSystem::PrepareReschedule() {
-    current_cpu->PrepareReschedule();
+    CurrentCPU()->PrepareReschedule();
     for (auto& manager : thread_managers) {
         manager->PrepareReschedule();
     }
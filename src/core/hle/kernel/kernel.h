@@ -50,6 +50,7 @@ class ClientPort;
 class ServerPort;
 class ClientSession;
 class ServerSession;
+class RequestContextPool;
 class ResourceLimitList;
 class SharedMemory;
 class ThreadManager;
@@ -217,6 +218,23 @@ public:
     void Advance(ARM_Interface* cpu, s64 max_slice_length);
     void Run(ARM_Interface* cpu);
 
+    /**
+     * Runs a slice of a core on the calling host thread, alongside the other cores that run on
+     * their own threads. The core is only current for the calling thread, and process switches
+     * of other cores are applied by FinishParallelRun.
+     */
+    void RunParallel(ARM_Interface* cpu);
+
+    /// Brings the state shared by the cores up to date once all the parallel slices are done
+    void FinishParallelRun();
+
+    /**
+     * Makes the page table of the process of the calling core active, when it runs in a parallel
+     * slice. The guest code of the cores only goes through their own page tables, the active one
+     * serves the HLE code, which runs for one core at a time under the HLE lock.
+     */
+    void ActivateParallelPageTable();
+
     ThreadManager& GetThreadManager(u32 core_id);
     const ThreadManager& GetThreadManager(u32 core_id) const;
 
@@ -234,6 +252,8 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    RequestContextPool& GetRequestContextPool();
+
     MemoryRegionInfo* GetMemoryRegion(MemoryRegion region);
 
     u32 GetApplicationMemoryType() const;
@@ -252,9 +272,7 @@ public:
     void RescheduleSingleCore();
 
     /// Gets a reference to the emulated CPU
-    ARM_Interface& GetRunningCore() {
-        return *current_cpu;
-    };
+    ARM_Interface& GetRunningCore();
 
     u32 NewThreadId();
 
@@ -270,6 +288,8 @@ public:
 private:
     void MemoryInit(u32 mem_type, u8 n3ds_mode);
     void SetCurrentProcess(const std::shared_ptr<Process>& process);
+    /// Returns the core run by the calling thread, which differs between threads in parallel slices
+    ARM_Interface* CurrentCPU() const;
 
     std::unique_ptr<ResourceLimitList> resource_limits;
     std::atomic<u32> next_object_id{0};
@@ -294,6 +314,8 @@ private:
 
     std::shared_ptr<Process> current_process;
     std::array<std::shared_ptr<Process>, 4> stored_processes;
+    /// Cores whose process was switched by another core during a parallel slice
+    std::array<bool, 4> pending_page_tables{};
 
     std::array<std::unique_ptr<ThreadManager>, 4> thread_managers;
 
@@ -301,6 +323,7 @@ private:
     std::unique_ptr<SharedPage::Handler> shared_page_handler;
 
     std::unique_ptr<IPCDebugger::Recorder> ipc_recorder;
+    std::unique_ptr<RequestContextPool> request_context_pool;
 
     u32 next_thread_id;
 };
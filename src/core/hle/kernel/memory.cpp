@@ -181,72 +181,198 @@ void KernelSystem::MapSharedPages(VMManager& address_space) {
     address_space.Reprotect(shared_page_vma, VMAPermission::Read);
 }
 
+void FreePageTree::Reset(u32 num_pages) {
+    num_leaves = 1;
+    while (num_leaves < num_pages) {
+        num_leaves *= 2;
+    }
+    nodes.assign(num_leaves * 2, {});
+    Fill(nodes[1], num_leaves, true);
+    Mark(num_pages, num_leaves - num_pages, false);
+}
+
+void FreePageTree::Fill(Node& node, u32 length, bool free) {
+    const u32 free_pages = free ? length : 0;
+    node.free = node.prefix = node.suffix = node.longest = free_pages;
+    node.pending = free ? 1 : 0;
+}
+
+void FreePageTree::Mark(u32 first, u32 count, bool free) {
+    if (count != 0) {
+        Mark(1, 0, num_leaves, first, first + count, free);
+    }
+}
+
+void FreePageTree::Mark(std::size_t index, u32 lower, u32 upper, u32 first, u32 end, bool free) {
+    if (end <= lower || upper <= first) {
+        return;
+    }
+    Node& node = nodes[index];
+    if (first <= lower && upper <= end) {
+        Fill(node, upper - lower, free);
+        return;
+    }
+
+    const u32 middle = lower + (upper - lower) / 2;
+    Node& left = nodes[index * 2];
+    Node& right = nodes[index * 2 + 1];
+    if (node.pending != -1) {
+        Fill(left, middle - lower, node.pending == 1);
+        Fill(right, upper - middle, node.pending == 1);
+        node.pending = -1;
+    }
+    Mark(index * 2, lower, middle, first, end, free);
+    Mark(index * 2 + 1, middle, upper, first, end, free);
+
+    const u32 half = middle - lower;
+    node.free = left.free + right.free;
+    node.prefix = left.prefix == half ? half + right.prefix : left.prefix;
+    node.suffix = right.suffix == half ? half + left.suffix : right.suffix;
+    node.longest = std::max({left.longest, right.longest, left.suffix + right.prefix});
+}
+
+u32 FreePageTree::CountFree(u32 first, u32 count) const {
+    return CountFree(1, 0, num_leaves, first, first + count);
+}
+
+u32 FreePageTree::CountFree(std::size_t index, u32 lower, u32 upper, u32 first, u32 end) const {
+    if (end <= lower || upper <= first) {
+        return 0;
+    }
+    const Node& node = nodes[index];
+    if (first <= lower && upper <= end) {
+        return node.free;
+    }
+    // The children of a node whose pages are all free or all taken may be stale
+    if (node.free == 0 || node.free == upper - lower) {
+        return node.free == 0 ? 0 : std::min(upper, end) - std::max(lower, first);
+    }
+    const u32 middle = lower + (upper - lower) / 2;
+    return CountFree(index * 2, lower, middle, first, end) +
+           CountFree(index * 2 + 1, middle, upper, first, end);
+}
+
+std::optional<u32> FreePageTree::FindFirst(u32 count) const {
+    if (nodes[1].longest < count) {
+        return std::nullopt;
+    }
+    return FindFirst(1, 0, num_leaves, count);
+}
+
+u32 FreePageTree::FindFirst(std::size_t index, u32 lower, u32 upper, u32 count) const {
+    const Node& node = nodes[index];
+    if (node.prefix >= count) {
+        return lower;
+    }
+    const u32 middle = lower + (upper - lower) / 2;
+    const Node& left = nodes[index * 2];
+    const Node& right = nodes[index * 2 + 1];
+    if (left.longest >= count) {
+        return FindFirst(index * 2, lower, middle, count);
+    }
+    if (left.suffix + right.prefix >= count) {
+        return middle - left.suffix;
+    }
+    return FindFirst(index * 2 + 1, middle, upper, count);
+}
+
+std::vector<std::pair<u32, u32>> FreePageTree::FindFromTop(u32 count) const {
+    std::vector<std::pair<u32, u32>> runs;
+    if (nodes[1].free >= count) {
+        FindFromTop(1, 0, num_leaves, count, runs);
+    }
+    return runs;
+}
+
+void FreePageTree::FindFromTop(std::size_t index, u32 lower, u32 upper, u32& count,
+                               std::vector<std::pair<u32, u32>>& runs) const {
+    const Node& node = nodes[index];
+    if (count == 0 || node.free == 0) {
+        return;
+    }
+    if (node.free == upper - lower) {
+        const u32 first = upper - std::min(count, upper - lower);
+        count -= upper - first;
+        if (!runs.empty() && runs.back().first == upper) {
+            runs.back().first = first;
+        } else {
+            runs.emplace_back(first, upper);
+        }
+        return;
+    }
+    const u32 middle = lower + (upper - lower) / 2;
+    FindFromTop(index * 2 + 1, middle, upper, count, runs);
+    FindFromTop(index * 2, lower, middle, count, runs);
+}
+
+/// Converts a size to pages, rounding up
+static u32 SizeToPages(u32 size) {
+    return static_cast<u32>((static_cast<u64>(size) + Memory::PAGE_SIZE - 1) / Memory::PAGE_SIZE);
+}
+
 void MemoryRegionInfo::Reset(u32 base, u32 size) {
     this->base = base;
     this->size = size;
     used = 0;
-    free_blocks.clear();
 
     // mark the entire region as free
-    free_blocks.insert(Interval::right_open(base, base + size));
+    free_pages.Reset(size / Memory::PAGE_SIZE);
 }
 
 MemoryRegionInfo::IntervalSet MemoryRegionInfo::HeapAllocate(u32 size) {
-    IntervalSet result;
-    u32 rest = size;
-
     // Try allocating from the higher address
-    for (auto iter = free_blocks.rbegin(); iter != free_blocks.rend(); ++iter) {
-        if (iter->upper() - iter->lower() >= rest) {
-            // Requested size is fulfilled with this block
-            result += Interval(iter->upper() - rest, iter->upper());
-            rest = 0;
-            break;
-        }
-        result += *iter;
-        rest -= iter->upper() - iter->lower();
-    }
-
-    if (rest != 0) {
+    const u32 num_pages = SizeToPages(size);
+    const auto runs = free_pages.FindFromTop(num_pages);
+    if (runs.empty()) {
         // There is no enough free space
         return {};
     }
 
-    free_blocks -= result;
+    IntervalSet result;
+    for (const auto& [first, end] : runs) {
+        free_pages.Mark(first, end - first, false);
+        result += Interval(base + first * Memory::PAGE_SIZE, base + end * Memory::PAGE_SIZE);
+    }
+    // The requested size ends at the top of the highest block, a partial page is left at the bottom
+    const u32 lowest = base + runs.back().first * Memory::PAGE_SIZE;
+    result -= Interval(lowest, lowest + num_pages * Memory::PAGE_SIZE - size);
     used += size;
     return result;
 }
 
 bool MemoryRegionInfo::LinearAllocate(u32 offset, u32 size) {
-    Interval interval(offset, offset + size);
-    if (!boost::icl::contains(free_blocks, interval)) {
+    if (offset < base || offset - base > this->size || size > this->size - (offset - base)) {
+        return false;
+    }
+    const u32 first = (offset - base) / Memory::PAGE_SIZE;
+    const u32 num_pages = SizeToPages(offset - base + size) - first;
+    if (free_pages.CountFree(first, num_pages) != num_pages) {
         // The requested range is already allocated
         return false;
     }
-    free_blocks -= interval;
+    free_pages.Mark(first, num_pages, false);
     used += size;
     return true;
 }
 
 std::optional<u32> MemoryRegionInfo::LinearAllocate(u32 size) {
     // Find the first sufficient continuous block from the lower address
-    for (const auto& interval : free_blocks) {
-        if (interval.upper() - interval.lower() >= size) {
-            Interval allocated(interval.lower(), interval.lower() + size);
-            free_blocks -= allocated;
-            used += size;
-            return allocated.lower();
-        }
+    const u32 num_pages = SizeToPages(size);
+    const auto first = free_pages.FindFirst(num_pages);
+    if (!first) {
+        // No sufficient block found
+        return {};
     }
-
-    // No sufficient block found
-    return {};
+    free_pages.Mark(*first, num_pages, false);
+    used += size;
+    return base + *first * Memory::PAGE_SIZE;
 }
 
 void MemoryRegionInfo::Free(u32 offset, u32 size) {
-    Interval interval(offset, offset + size);
-    ASSERT(!boost::icl::intersects(free_blocks, interval)); // must be allocated blocks
-    free_blocks += interval;
+    const u32 first = (offset - base) / Memory::PAGE_SIZE;
+    const u32 num_pages = SizeToPages(offset - base + size) - first;
+    ASSERT(free_pages.CountFree(first, num_pages) == 0); // must be allocated blocks
+    free_pages.Mark(first, num_pages, true);
     used -= size;
 }
 
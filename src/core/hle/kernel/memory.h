@@ -5,6 +5,8 @@
 #pragma once
 
 #include <optional>
+#include <utility>
+#include <vector>
 #include <boost/icl/interval_set.hpp>
 #include "common/common_types.h"
 
@@ -13,6 +15,53 @@ namespace Kernel {
 struct AddressMapping;
 class VMManager;
 
+/**
+ * The free pages of a memory region, kept in a segment tree whose nodes know the longest run of
+ * free pages they hold. Finding, taking and returning a run of pages costs O(log n) in the pages
+ * of the region, however fragmented it is.
+ */
+class FreePageTree {
+public:
+    /// Marks all of the pages free
+    void Reset(u32 num_pages);
+
+    /// Marks the pages [first, first + count) free or taken
+    void Mark(u32 first, u32 count, bool free);
+
+    /// Returns how many of the pages [first, first + count) are free
+    u32 CountFree(u32 first, u32 count) const;
+
+    /// Returns the lowest page that starts count free pages in a row
+    std::optional<u32> FindFirst(u32 count) const;
+
+    /**
+     * Returns the runs of free pages from the highest one down, as [first, end) pairs, that hold
+     * count pages. The lowest run is cut to what is left of count.
+     */
+    std::vector<std::pair<u32, u32>> FindFromTop(u32 count) const;
+
+private:
+    struct Node {
+        u32 free;    ///< Free pages below the node
+        u32 prefix;  ///< Free pages at the start
+        u32 suffix;  ///< Free pages at the end
+        u32 longest; ///< Longest free run
+        /// The children are stale, the pages below are all free (1) or taken (0), -1 otherwise
+        s8 pending;
+    };
+
+    static void Fill(Node& node, u32 length, bool free);
+    void Mark(std::size_t index, u32 lower, u32 upper, u32 first, u32 end, bool free);
+    u32 CountFree(std::size_t index, u32 lower, u32 upper, u32 first, u32 end) const;
+    u32 FindFirst(std::size_t index, u32 lower, u32 upper, u32 count) const;
+    void FindFromTop(std::size_t index, u32 lower, u32 upper, u32& count,
+                     std::vector<std::pair<u32, u32>>& runs) const;
+
+    /// The pages past the region up to the next power of two are marked taken
+    u32 num_leaves = 0;
+    std::vector<Node> nodes;
+};
+
 struct MemoryRegionInfo {
     u32 base; // Not an address, but offset from start of FCRAM
     u32 size;
@@ -22,7 +71,8 @@ struct MemoryRegionInfo {
     using IntervalSet = boost::icl::interval_set<u32>;
     using Interval = IntervalSet::interval_type;
 
-    IntervalSet free_blocks;
+    /// Allocations are whole pages, sizes that are not a multiple of the page size are rounded up
+    FreePageTree free_pages;
 
     /**
      * Reset the allocator state
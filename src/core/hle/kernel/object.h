@@ -38,6 +38,22 @@ enum {
     DEFAULT_STACK_SIZE = 0x4000,
 };
 
+/// Returns true if a thread can wait on the objects of the given type
+constexpr bool IsWaitableHandleType(HandleType type) {
+    switch (type) {
+    case HandleType::Event:
+    case HandleType::Mutex:
+    case HandleType::Thread:
+    case HandleType::Semaphore:
+    case HandleType::Timer:
+    case HandleType::ServerPort:
+    case HandleType::ServerSession:
+        return true;
+    default:
+        return false;
+    }
+}
+
 class Object : NonCopyable, public std::enable_shared_from_this<Object> {
 public:
     explicit Object(KernelSystem& kernel);
@@ -74,13 +90,19 @@ std::shared_ptr<T> SharedFrom(T* raw) {
     return std::static_pointer_cast<T>(raw->shared_from_this());
 }
 
+/// Returns true if the objects of the given type can be downcast to T
+template <typename T>
+constexpr bool IsObjectOfType(HandleType type) {
+    return type == T::HANDLE_TYPE;
+}
+
 /**
  * Attempts to downcast the given Object pointer to a pointer to T.
  * @return Derived pointer to the object, or `nullptr` if `object` isn't of type T.
  */
 template <typename T>
 inline std::shared_ptr<T> DynamicObjectCast(std::shared_ptr<Object> object) {
-    if (object != nullptr && object->GetHandleType() == T::HANDLE_TYPE) {
+    if (object != nullptr && IsObjectOfType<T>(object->GetHandleType())) {
         return std::static_pointer_cast<T>(object);
     }
     return nullptr;
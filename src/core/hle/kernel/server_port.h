@@ -17,6 +17,7 @@ namespace Kernel {
 class ClientPort;
 class ServerSession;
 class SessionRequestHandler;
+struct FastPathHandler;
 
 class ServerPort final : public WaitObject {
 public:
@@ -58,6 +59,9 @@ public:
     /// ServerSessions created from this port inherit a reference to this handler.
     std::shared_ptr<SessionRequestHandler> hle_handler;
 
+    /// Commands an HLE handler answers although an LLE server accepts the sessions (optional)
+    std::shared_ptr<FastPathHandler> fast_path;
+
     bool ShouldWait(const Thread* thread) const override;
     void Acquire(Thread* thread) override;
 };
@@ -65,18 +65,29 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
     // from its ClientSession, so wake up any threads that may be waiting on a svcReplyAndReceive or
     // similar.
 
+    // The commands with a fast path are answered by the HLE handler, not the LLE server
+    std::shared_ptr<SessionRequestHandler> handler = hle_handler;
+    if (handler == nullptr && fast_path != nullptr) {
+        u32_le header;
+        kernel.memory.ReadBlock(*thread->owner_process, thread->GetCommandBufferAddress(), &header,
+                                sizeof(header));
+        if (fast_path->Serves(header)) {
+            handler = fast_path->handler;
+        }
+    }
+
     // If this ServerSession has an associated HLE handler, forward the request to it.
-    if (hle_handler != nullptr) {
+    if (handler != nullptr) {
         std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buf;
         auto current_process = thread->owner_process;
         kernel.memory.ReadBlock(*current_process, thread->GetCommandBufferAddress(), cmd_buf.data(),
                                 cmd_buf.size() * sizeof(u32));
 
         auto context =
-            std::make_shared<Kernel::HLERequestContext>(kernel, SharedFrom(this), thread.get());
+            kernel.GetRequestContextPool().Acquire(kernel, SharedFrom(this), thread.get());
         context->PopulateFromIncomingCommandBuffer(cmd_buf.data(), *current_process);
 
-        hle_handler->HandleSyncRequest(*context);
+        handler->HandleSyncRequest(*context);
 
         ASSERT(thread->status == Kernel::ThreadStatus::Running ||
                thread->status == Kernel::ThreadStatus::WaitHleEvent);
@@ -88,6 +99,7 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
             kernel.memory.WriteBlock(*current_process, thread->GetCommandBufferAddress(),
                                      cmd_buf.data(), cmd_buf.size() * sizeof(u32));
         }
+        kernel.GetRequestContextPool().Release(context);
     }
 
     if (thread->status == ThreadStatus::Running) {
@@ -95,7 +107,7 @@ ResultCode ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
         // svcReplyAndReceive for LLE servers.
         thread->status = ThreadStatus::WaitIPC;
 
-        if (hle_handler != nullptr) {
+        if (handler != nullptr) {
             // For HLE services, we put the request threads to sleep for a short duration to
             // simulate IPC overhead, but only if the HLE handler didn't put the thread to sleep for
             // other reasons like an async callback. The IPC overhead is needed to prevent
@@ -22,6 +22,7 @@ class ServerSession;
 class Session;
 class SessionRequestHandler;
 class Thread;
+struct FastPathHandler;
 
 /**
  * Kernel object representing the server endpoint of an IPC session. Sessions are the basic CTR-OS
@@ -76,6 +77,8 @@ public:
     std::shared_ptr<Session> parent; ///< The parent session, which links to the client endpoint.
     std::shared_ptr<SessionRequestHandler>
         hle_handler; ///< This session's HLE request handler (optional)
+    /// Commands an HLE handler answers in place of the LLE server (optional)
+    std::shared_ptr<FastPathHandler> fast_path;
 
     /// List of threads that are pending a response after a sync request. This list is processed in
     /// a LIFO manner, thus, the last request will be dispatched first.
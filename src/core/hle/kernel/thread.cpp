@@ -168,7 +168,7 @@ void Thread::WakeAfterDelay(s64 nanoseconds) {
                                                thread_manager.ThreadWakeupEventType, thread_id);
 }
 
-void Thread::ResumeFromWait() {
+void Thread::ResumeFromWait(bool reschedule) {
     ASSERT_MSG(wait_objects.empty(), "Thread is waking up while waiting for objects");
 
     switch (status) {
@@ -204,6 +204,12 @@ void Thread::ResumeFromWait() {
 
     thread_manager.ready_queue.push_back(current_priority, this);
     status = ThreadStatus::Ready;
+    if (reschedule) {
+        thread_manager.kernel.PrepareReschedule();
+    }
+}
+
+void Thread::PrepareReschedule() {
     thread_manager.kernel.PrepareReschedule();
 }
 
@@ -280,7 +286,6 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(std::string name,
     auto thread{std::make_shared<Thread>(*this, processor_id)};
 
     thread_managers[processor_id]->thread_list.push_back(thread);
-    thread_managers[processor_id]->ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = ThreadStatus::Dormant;
@@ -346,8 +351,6 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
 }
@@ -365,8 +368,6 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
     current_priority = priority;
 }
 
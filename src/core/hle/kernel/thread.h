@@ -201,8 +201,13 @@ public:
 
     /**
      * Resumes a thread from waiting
+     * @param reschedule Whether to ask the kernel to reschedule. A caller resuming several threads
+     *        at once passes false, and calls PrepareReschedule once afterwards.
      */
-    void ResumeFromWait();
+    void ResumeFromWait(bool reschedule = true);
+
+    /// Asks the kernel to reschedule, so that the threads resumed without it get to run
+    void PrepareReschedule();
 
     /**
      * Schedules an event to wake up the specified thread after the specified delay
@@ -52,27 +52,33 @@ VMManager::VMAHandle VMManager::FindVMA(VAddr target) const {
     }
 }
 
-ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, u8* buffer,
-                                                   u32 size, MemoryState state) {
-
-    // Find the first Free VMA.
-    VMAHandle vma_handle = std::find_if(vma_map.begin(), vma_map.end(), [base, size](const auto& vma) {
-        if (vma.second.type != VMAType::Free)
-            return false;
-
-        VAddr vma_end = vma.second.base + vma.second.size;
-        return vma_end > base && vma_end >= base + size;
-    });
-
-    VAddr target = std::max(base, vma_handle->second.base);
+ResultVal<VAddr> VMManager::FindFreeRange(VAddr base, u32 region_size, u32 size) const {
+    // The VMAs that end before the base can not hold the range, start at the one around it
+    // instead of walking the whole address space.
+    VMAHandle vma_handle =
+        std::find_if(FindVMA(base), vma_map.end(), [base, size](const auto& vma) {
+            if (vma.second.type != VMAType::Free)
+                return false;
+
+            const VAddr target = std::max(base, vma.second.base);
+            return vma.second.base + vma.second.size >= target + size;
+        });
 
     // Do not try to allocate the block if there are no available addresses within the desired
     // region.
-    if (vma_handle == vma_map.end() || target + size > base + region_size) {
+    if (vma_handle == vma_map.end() ||
+        std::max(base, vma_handle->second.base) + size > base + region_size) {
         return ResultCode(ErrorDescription::OutOfMemory, ErrorModule::Kernel,
                           ErrorSummary::OutOfResource, ErrorLevel::Permanent);
     }
 
+    return MakeResult<VAddr>(std::max(base, vma_handle->second.base));
+}
+
+ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size, u8* buffer,
+                                                   u32 size, MemoryState state) {
+    CASCADE_RESULT(VAddr target, FindFreeRange(base, region_size, size));
+
     auto result = MapBackingMemory(target, buffer, size, state);
 
     if (result.Failed())
@@ -329,9 +335,9 @@ ResultVal<std::vector<std::pair<u8*, u32>>> VMManager::GetBackingBlocksForRange(
                                                                                 u32 size) {
     std::vector<std::pair<u8*, u32>> backing_blocks;
     VAddr interval_target = address;
-    while (interval_target != address + size) {
-        auto vma = FindVMA(interval_target);
-        if (vma->second.type != VMAType::BackingMemory) {
+    // The VMAs cover the address space without gaps, so the range is walked from a single lookup
+    for (auto vma = FindVMA(address); interval_target != address + size; ++vma) {
+        if (vma == vma_map.end() || vma->second.type != VMAType::BackingMemory) {
             LOG_ERROR(Kernel, "Trying to use already freed memory");
             return ERR_INVALID_ADDRESS_STATE;
         }
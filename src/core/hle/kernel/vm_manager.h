@@ -111,6 +111,16 @@ public:
     /// Finds the VMA in which the given address is included in, or `vma_map.end()`.
     VMAHandle FindVMA(VAddr target) const;
 
+    /**
+     * Finds the first free address range of the given size after the given base.
+     *
+     * @param base The base address to start the search at.
+     * @param region_size The max size of the region from where we'll try to find an address.
+     * @param size Size of the range.
+     * @returns The address of the range.
+     */
+    ResultVal<VAddr> FindFreeRange(VAddr base, u32 region_size, u32 size) const;
+
     // TODO(yuriks): Should these functions actually return the handle?
 
     /**
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <iterator>
 #include <utility>
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -32,6 +33,20 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
         waiting_threads.erase(itr);
 }
 
+bool WaitObject::IsReadyToRun(const Thread* thread) const {
+    if (ShouldWait(thread))
+        return false;
+
+    // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
+    // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
+    if (thread->status != ThreadStatus::WaitSynchAll)
+        return true;
+    return std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
+                        [thread](const std::shared_ptr<WaitObject>& object) {
+                            return object->ShouldWait(thread);
+                        });
+}
+
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
     Thread* candidate = nullptr;
     u32 candidate_priority = ThreadPrioLowest + 1;
@@ -46,20 +61,7 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
         if (thread->current_priority >= candidate_priority)
             continue;
 
-        if (ShouldWait(thread.get()))
-            continue;
-
-        // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
-        // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
-        bool ready_to_run = true;
-        if (thread->status == ThreadStatus::WaitSynchAll) {
-            ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const std::shared_ptr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
-                                        });
-        }
-
-        if (ready_to_run) {
+        if (IsReadyToRun(thread.get())) {
             candidate = thread.get();
             candidate_priority = thread->current_priority;
         }
@@ -69,26 +71,54 @@ std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
-    while (auto thread = GetHighestPriorityReadyThread()) {
-        if (!thread->IsSleepingOnWaitAll()) {
-            Acquire(thread.get());
-        } else {
-            for (auto& object : thread->wait_objects) {
-                object->Acquire(thread.get());
+    std::shared_ptr<Thread> last_woken;
+    // Waking a thread only consumes the objects, so the threads that were ready in priority order
+    // are visited once and rechecked before waking them. The wakeup callbacks may signal other
+    // objects though, so the list is collected again until a pass wakes no thread.
+    bool woke_thread = !waiting_threads.empty();
+    while (woke_thread) {
+        woke_thread = false;
+        std::vector<std::shared_ptr<Thread>> candidates;
+        std::copy_if(waiting_threads.begin(), waiting_threads.end(),
+                     std::back_inserter(candidates), [this](const std::shared_ptr<Thread>& thread) {
+                         return !ShouldWait(thread.get());
+                     });
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const std::shared_ptr<Thread>& a, const std::shared_ptr<Thread>& b) {
+                             return a->current_priority < b->current_priority;
+                         });
+
+        for (auto& thread : candidates) {
+            // Skips the threads woken by another object in the meantime
+            if (thread->wait_objects.empty() || !IsReadyToRun(thread.get()))
+                continue;
+
+            if (!thread->IsSleepingOnWaitAll()) {
+                Acquire(thread.get());
+            } else {
+                for (auto& object : thread->wait_objects) {
+                    object->Acquire(thread.get());
+                }
             }
-        }
 
-        // Invoke the wakeup callback before clearing the wait objects
-        if (thread->wakeup_callback)
-            thread->wakeup_callback->WakeUp(ThreadWakeupReason::Signal, thread, SharedFrom(this));
+            // Invoke the wakeup callback before clearing the wait objects
+            if (thread->wakeup_callback)
+                thread->wakeup_callback->WakeUp(ThreadWakeupReason::Signal, thread,
+                                                SharedFrom(this));
 
-        for (auto& object : thread->wait_objects)
-            object->RemoveWaitingThread(thread.get());
-        thread->wait_objects.clear();
+            for (auto& object : thread->wait_objects)
+                object->RemoveWaitingThread(thread.get());
+            thread->wait_objects.clear();
 
-        thread->ResumeFromWait();
+            thread->ResumeFromWait(false);
+            last_woken = thread;
+            woke_thread = true;
+        }
     }
 
+    if (last_woken)
+        last_woken->PrepareReschedule();
+
     if (hle_notifier)
         hle_notifier();
 }
@@ -43,7 +43,8 @@ public:
 
     /**
      * Wake up all threads waiting on this object that can be awoken, in priority order,
-     * and set the synchronization result and output of the thread.
+     * and set the synchronization result and output of the thread. The kernel is asked to
+     * reschedule once for all of them.
      */
     virtual void WakeupAllWaitingThreads();
 
@@ -57,6 +58,12 @@ public:
     void SetHLENotifier(std::function<void()> callback);
 
 private:
+    /**
+     * Checks if a waiting thread can be woken by this object, which for WaitSynchronizationN
+     * with wait_all requires the rest of its objects to be ready as well.
+     */
+    bool IsReadyToRun(const Thread* thread) const;
+
     /// Threads waiting for this object to become available
     std::vector<std::shared_ptr<Thread>> waiting_threads;
 
@@ -64,13 +71,10 @@ private:
     std::function<void()> hle_notifier;
 };
 
-// Specialization of DynamicObjectCast for WaitObjects
+// Specialization of IsObjectOfType for WaitObjects, that covers several handle types
 template <>
-inline std::shared_ptr<WaitObject> DynamicObjectCast<WaitObject>(std::shared_ptr<Object> object) {
-    if (object != nullptr && object->IsWaitable()) {
-        return std::static_pointer_cast<WaitObject>(object);
-    }
-    return nullptr;
+constexpr bool IsObjectOfType<WaitObject>(HandleType type) {
+    return IsWaitableHandleType(type);
 }
 
 } // namespace Kernel
@@ -47,10 +47,17 @@ struct FileMetadata {
 
 static_assert(sizeof(FileMetadata) == 0x20, "FileMetadata has incorrect size");
 
+constexpr u32 INVALID_FIELD = 0xFFFFFFFF;
+
 static bool MatchName(const u8* buffer, u32 name_length, const std::u16string& name) {
-    std::vector<char16_t> name_buffer(name_length / sizeof(char16_t));
-    std::memcpy(name_buffer.data(), buffer, name_length);
-    return name == std::u16string(name_buffer.begin(), name_buffer.end());
+    return name.size() * sizeof(char16_t) == name_length &&
+           std::memcmp(buffer, name.data(), name_length) == 0;
+}
+
+static std::u16string ReadName(const u8* buffer, u32 name_length) {
+    std::u16string name(name_length / sizeof(char16_t), u'\0');
+    std::memcpy(name.data(), buffer, name.size() * sizeof(char16_t));
+    return name;
 }
 
 RomFSFile::RomFSFile(const u8* data, u64 length) : data(data), length(length) {}
@@ -64,8 +71,6 @@ u64 RomFSFile::Length() const {
 }
 
 const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path) {
-    constexpr u32 INVALID_FIELD = 0xFFFFFFFF;
-
     // Split path into directory names and file name
     std::vector<std::u16string> dir_names = path;
     dir_names.pop_back();
@@ -109,4 +114,49 @@ const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path
     return RomFSFile();
 }
 
+RomFSIndex::RomFSIndex(const u8* romfs) : romfs(romfs) {
+    Header header;
+    std::memcpy(&header, romfs, sizeof(header));
+    dir_table_offset = header.dir_table_offset;
+    file_table_offset = header.file_table_offset;
+    data_offset = header.data_offset;
+    // The root directory is the first entry of the directory table
+    IndexDirectory(0, {});
+}
+
+void RomFSIndex::IndexDirectory(u32 dir_offset, const std::u16string& prefix) {
+    DirectoryMetadata dir;
+    std::memcpy(&dir, romfs + dir_table_offset + dir_offset, sizeof(dir));
+
+    FileMetadata file;
+    for (u32 file_offset = dir.first_file_offset; file_offset != INVALID_FIELD;
+         file_offset = file.next_file_offset) {
+        const u8* current_file = romfs + file_table_offset + file_offset;
+        std::memcpy(&file, current_file, sizeof(file));
+        files.emplace(prefix + ReadName(current_file + sizeof(file), file.name_length),
+                      RomFSFile(romfs + data_offset + file.data_offset, file.data_length));
+    }
+
+    DirectoryMetadata child;
+    for (u32 child_offset = dir.first_child_dir_offset; child_offset != INVALID_FIELD;
+         child_offset = child.next_dir_offset) {
+        const u8* current_child = romfs + dir_table_offset + child_offset;
+        std::memcpy(&child, current_child, sizeof(child));
+        IndexDirectory(child_offset,
+                       prefix + ReadName(current_child + sizeof(child), child.name_length) + u'/');
+    }
+}
+
+RomFSFile RomFSIndex::GetFile(const std::vector<std::u16string>& path) const {
+    std::u16string key;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        if (i != 0) {
+            key += u'/';
+        }
+        key += path[i];
+    }
+    const auto it = files.find(key);
+    return it != files.end() ? it->second : RomFSFile();
+}
+
 } // namespace RomFS
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 
@@ -31,4 +32,31 @@ private:
  */
 const RomFSFile GetFile(const u8* romfs, const std::vector<std::u16string>& path);
 
+/**
+ * Index of the files of a RomFS image by their full path. It is built by a single walk of the
+ * directory tables, after which each lookup is one hash map access, so it pays off as soon as an
+ * image is searched for more than a few files. The image must outlive the index.
+ */
+class RomFSIndex {
+public:
+    explicit RomFSIndex(const u8* romfs);
+
+    /// Gets the file at the path, or an empty RomFSFile if the image has none there
+    RomFSFile GetFile(const std::vector<std::u16string>& path) const;
+
+    std::size_t GetFileCount() const {
+        return files.size();
+    }
+
+private:
+    void IndexDirectory(u32 dir_offset, const std::u16string& prefix);
+
+    const u8* romfs;
+    u32 dir_table_offset;
+    u32 file_table_offset;
+    u64 data_offset;
+    /// Paths are the names of their components joined by '/'
+    std::unordered_map<std::u16string, RomFSFile> files;
+};
+
 } // namespace RomFS
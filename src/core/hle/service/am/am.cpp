@@ -3,11 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
 #include <cstring>
+#include <future>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
 #include <fmt/format.h>
 #include "common/common_paths.h"
 #include "common/file_util.h"
@@ -80,6 +83,12 @@ static_assert(sizeof(TicketInfo) == 0x18, "Ticket info structure size is wrong")
 class CIAFile::DecryptionState {
 public:
     std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    /// Hashes of the decrypted contents, checked against the TMD as each one completes
+    std::vector<CryptoPP::SHA256> hashes;
+    /// The content files, open while their data comes in
+    std::vector<FileUtil::IOFile> files;
+    /// Set when a content does not match its hash, which aborts the install
+    std::atomic<bool> hash_mismatch{false};
 };
 
 CIAFile::CIAFile(Service::FS::MediaType media_type)
@@ -132,6 +141,8 @@ ResultCode CIAFile::WriteTitleMetadata() {
 
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
+    decryption_state->hashes.resize(content_count);
+    decryption_state->files.resize(content_count);
 
     if (auto title_key = container.GetTicket().GetTitleKey()) {
         decryption_state->content.resize(content_count);
@@ -151,8 +162,15 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
     // Data is not being buffered, so we have to keep track of how much of each <ID>.app
     // has been written since we might get a written buffer which contains multiple .app
     // contents or only part of a larger .app's contents.
+    const FileSys::TitleMetadata& tmd = container.GetTitleMetadata();
+    struct ContentPart {
+        u16 index;
+        const u8* data;
+        std::size_t size;
+    };
+    std::vector<ContentPart> parts;
     u64 offset_max = offset + length;
-    for (int i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
+    for (u16 i = 0; i < tmd.GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(i)) {
             // The size, minimum unwritten offset, and maximum unwritten offset of this content
             u64 size = container.GetContentSize(i);
@@ -166,33 +184,71 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // Figure out how much of this content ID we have just recieved/can write out
             u64 available_to_write = std::min(offset_max, range_max) - range_min;
+            if (available_to_write != 0) {
+                parts.push_back({i, buffer + (range_min - offset),
+                                 static_cast<std::size_t>(available_to_write)});
+            }
+        }
+    }
 
-            // Since the incoming TMD has already been written, we can use GetTitleContentPath
-            // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            FileUtil::IOFile file(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
-                                  content_written[i] ? "ab" : "wb");
-
+    // Each content has its own file, cipher and hash, so the contents of a buffer, as the many
+    // small ones of DLC, are decrypted, hashed and written in parallel
+    const auto write_part = [this, &tmd](const ContentPart& part) -> ResultCode {
+        const u16 i = part.index;
+        // Since the incoming TMD has already been written, we can use GetTitleContentPath
+        // to get the content paths to write to.
+        FileUtil::IOFile& file = decryption_state->files[i];
+        if (!file.IsOpen()) {
+            file = FileUtil::IOFile(GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update),
+                                    content_written[i] ? "ab" : "wb");
             if (!file.IsOpen())
                 return FileSys::ERROR_INSUFFICIENT_SPACE;
+        }
 
-            std::vector<u8> temp(buffer + (range_min - offset),
-                                 buffer + (range_min - offset) + available_to_write);
-
-            if (tmd.GetContentTypeByIndex(static_cast<u16>(i)) &
-                FileSys::TMDContentTypeFlag::Encrypted) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+        std::vector<u8> temp(part.data, part.data + part.size);
+        if (tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) {
+            decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+        }
+        decryption_state->hashes[i].Update(temp.data(), temp.size());
+
+        if (file.WriteBytes(temp.data(), temp.size()) != temp.size())
+            return FileSys::ERROR_INSUFFICIENT_SPACE;
+
+        // Keep tabs on how much of this content ID has been written so new range_min
+        // values can be calculated.
+        content_written[i] += part.size;
+        LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", part.size, i,
+                  content_written[i]);
+
+        if (content_written[i] == container.GetContentSize(i)) {
+            file.Close();
+            std::array<u8, CryptoPP::SHA256::DIGESTSIZE> hash;
+            decryption_state->hashes[i].Final(hash.data());
+            if (hash != tmd.GetContentHashByIndex(i)) {
+                LOG_ERROR(Service_AM, "Content {} does not match its hash in the TMD", i);
+                decryption_state->hash_mismatch = true;
+                return ResultCode(ErrorDescription::NotAuthorized, ErrorModule::AM,
+                                  ErrorSummary::InvalidState, ErrorLevel::Permanent);
             }
-
-            file.WriteBytes(temp.data(), temp.size());
-
-            // Keep tabs on how much of this content ID has been written so new range_min
-            // values can be calculated.
-            content_written[i] += available_to_write;
-            LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
-                      content_written[i]);
         }
+        return RESULT_SUCCESS;
+    };
+
+    std::vector<std::future<ResultCode>> workers;
+    for (std::size_t part = 1; part < parts.size(); part++) {
+        workers.push_back(std::async(std::launch::async, write_part, std::cref(parts[part])));
     }
+    ResultCode result = RESULT_SUCCESS;
+    if (!parts.empty()) {
+        result = write_part(parts[0]);
+    }
+    for (auto& worker : workers) {
+        const ResultCode worker_result = worker.get();
+        if (result.IsSuccess())
+            result = worker_result;
+    }
+    if (result.IsError())
+        return result;
 
     return MakeResult<std::size_t>(length);
 }
@@ -277,6 +333,10 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() const {
+    for (auto& file : decryption_state->files) {
+        file.Close();
+    }
+
     bool complete = true;
     for (std::size_t i = 0; i < container.GetTitleMetadata().GetContentCount(); i++) {
         if (content_written[i] < container.GetContentSize(static_cast<u16>(i)))
@@ -284,7 +344,7 @@ bool CIAFile::Close() const {
     }
 
     // Install aborted
-    if (!complete) {
+    if (!complete || decryption_state->hash_mismatch) {
         LOG_ERROR(Service_AM, "CIAFile closed prematurely, aborting install...");
         FileUtil::DeleteDir(GetTitlePath(media_type, container.GetTitleMetadata().GetTitleID()));
         return true;
@@ -355,21 +415,41 @@ InstallStatus InstallCIA(const std::string& path,
         if (!file.IsOpen())
             return InstallStatus::ErrorFailedToOpenFile;
 
-        std::array<u8, 0x10000> buffer;
+        // The next chunk is read while the current one is decrypted, verified and written
+        constexpr std::size_t chunk_size = 0x100000;
+        std::array<std::vector<u8>, 2> buffers{std::vector<u8>(chunk_size),
+                                               std::vector<u8>(chunk_size)};
+        const auto read_chunk = [&file](std::vector<u8>* buffer) {
+            return file.ReadBytes(buffer->data(), buffer->size());
+        };
+        const u64 file_size = file.GetSize();
+        std::future<std::size_t> next_read =
+            std::async(std::launch::async, read_chunk, &buffers[0]);
+
+        std::size_t current = 0;
         std::size_t total_bytes_read = 0;
-        while (total_bytes_read != file.GetSize()) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
+        while (total_bytes_read != file_size) {
+            std::size_t bytes_read = next_read.get();
+            if (bytes_read == 0 || bytes_read > chunk_size) {
+                LOG_ERROR(Service_AM, "Could not read CIA file {}", path);
+                return InstallStatus::ErrorAborted;
+            }
+            if (total_bytes_read + bytes_read != file_size) {
+                next_read = std::async(std::launch::async, read_chunk, &buffers[current ^ 1]);
+            }
+
             auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            static_cast<u8*>(buffer.data()));
+                                            buffers[current].data());
 
             if (update_callback)
-                update_callback(total_bytes_read, file.GetSize());
+                update_callback(total_bytes_read, file_size);
             if (result.Failed()) {
                 LOG_ERROR(Service_AM, "CIA file installation aborted with error code {:08x}",
                           result.Code().raw);
                 return InstallStatus::ErrorAborted;
             }
             total_bytes_read += bytes_read;
+            current ^= 1;
         }
         installFile.Close();
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <fmt/format.h>
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
@@ -26,6 +27,7 @@
 #include "core/hle/service/service.h"
 #include "core/hw/aes/ccm.h"
 #include "core/hw/aes/key.h"
+#include "core/loader/loader.h"
 
 namespace Service::APT {
 
@@ -121,6 +123,70 @@ static u32 DecompressLZ11(const u8* in, u8* out) {
     return decompressed_size;
 }
 
+/// Sits in front of the decompressed shared font in the cache directory
+struct SharedFontCacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le source_size; ///< Size of the RomFS of the system archive the font came from
+    u32_le font_size;   ///< Bytes of shared memory that follow, the 0x80 byte header included
+    INSERT_PADDING_WORDS(3);
+};
+static_assert(sizeof(SharedFontCacheHeader) == 0x20, "SharedFontCacheHeader has incorrect size");
+
+constexpr u32 SHARED_FONT_CACHE_MAGIC = Loader::MakeMagic('C', 'F', 'N', 'C');
+constexpr u32 SHARED_FONT_CACHE_VERSION = 1;
+
+static std::string GetSharedFontCachePath(u64 archive_id) {
+    return fmt::format("{}shared_font" DIR_SEP "{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), archive_id);
+}
+
+bool Module::LoadSharedFontCache(const std::string& path, u64 source_size) {
+    if (!FileUtil::Exists(path)) {
+        return false;
+    }
+    const FileUtil::MappedFile file(path);
+    if (!file.IsOpen() || file.GetSize() < sizeof(SharedFontCacheHeader)) {
+        return false;
+    }
+
+    SharedFontCacheHeader header;
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    if (header.magic != SHARED_FONT_CACHE_MAGIC || header.version != SHARED_FONT_CACHE_VERSION ||
+        header.source_size != source_size || header.font_size > shared_font_mem->GetSize() ||
+        file.GetSize() != sizeof(header) + header.font_size) {
+        LOG_INFO(Service_APT, "Shared font cache {} is stale", path);
+        return false;
+    }
+
+    std::memcpy(shared_font_mem->GetPointer(), file.GetData() + sizeof(header), header.font_size);
+    return true;
+}
+
+void Module::SaveSharedFontCache(const std::string& path, u64 source_size, u32 font_size) const {
+    SharedFontCacheHeader header{};
+    header.magic = SHARED_FONT_CACHE_MAGIC;
+    header.version = SHARED_FONT_CACHE_VERSION;
+    header.source_size = source_size;
+    header.font_size = font_size;
+
+    // Written aside and renamed, so a crash never leaves a truncated cache behind
+    const std::string temp_path = path + ".tmp";
+    FileUtil::CreateFullPath(path);
+    {
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file.IsOpen() || file.WriteObject(header) != 1 ||
+            file.WriteBytes(shared_font_mem->GetPointer(), font_size) != font_size) {
+            LOG_WARNING(Service_APT, "Could not write the shared font cache {}", path);
+            file.Close();
+            FileUtil::Delete(temp_path);
+            return;
+        }
+    }
+    FileUtil::Delete(path);
+    FileUtil::Rename(temp_path, path);
+}
+
 bool Module::LoadSharedFont() {
     u8 font_region_code;
     auto cfg = Service::CFG::GetModule(system);
@@ -152,7 +218,17 @@ bool Module::LoadSharedFont() {
         return false;
 
     auto romfs = std::move(file_result).Unwrap();
-    std::vector<u8> romfs_buffer(romfs->GetSize());
+
+    // Reading the whole archive and decompressing the font takes a good part of the boot, the
+    // result only changes along with the archive
+    const u64 romfs_size = romfs->GetSize();
+    const std::string cache_path = GetSharedFontCachePath(shared_font_archive_id_low);
+    if (LoadSharedFontCache(cache_path, romfs_size)) {
+        romfs->Close();
+        return true;
+    }
+
+    std::vector<u8> romfs_buffer(romfs_size);
     romfs->Read(0, romfs_buffer.size(), romfs_buffer.data());
     romfs->Close();
 
@@ -178,6 +254,9 @@ bool Module::LoadSharedFont() {
     std::memcpy(shared_font_mem->GetPointer(), &shared_font_header, sizeof(shared_font_header));
     *shared_font_mem->GetPointer(0x83) = 'U'; // Change the magic from "CFNT" to "CFNU"
 
+    SaveSharedFontCache(cache_path, romfs_size,
+                        static_cast<u32>(sizeof(shared_font_header) +
+                                         shared_font_header.decompressed_size));
     return true;
 }
 
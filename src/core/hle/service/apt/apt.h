@@ -696,6 +696,9 @@ public:
 
 private:
     bool LoadSharedFont();
+    /// Fills the shared font memory from the decompressed copy, if it was made from this archive
+    bool LoadSharedFontCache(const std::string& path, u64 source_size);
+    void SaveSharedFontCache(const std::string& path, u64 source_size, u32 font_size) const;
     bool LoadLegacySharedFont();
     bool LoadSharedFontFromFile();
 
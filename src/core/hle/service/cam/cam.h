@@ -792,7 +792,8 @@ private:
 
         std::deque<s64> vsync_timings;
 
-        std::future<std::vector<u16>> capture_result; // will hold the received frame.
+        std::future<void> capture_result; // ready once the frame is received.
+        std::vector<u16> frame; // the received frame, the buffer is reused by the next ones.
         Kernel::Process* dest_process{nullptr};
         VAddr dest{0};    // the destination address of the receiving process
         u32 dest_size{0}; // the destination size of the receiving process
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cryptopp/base64.h>
 #include <cryptopp/hmac.h>
 #include <cryptopp/sha.h>
@@ -102,6 +103,7 @@ void Module::Interface::Open(Kernel::HLERequestContext& ctx) {
             std::memcpy(program_id.data(), &le_program_id, sizeof(u64));
             session_data->file->Write(0, sizeof(u64), true, program_id.data());
             session_data->file->Close();
+            cecd->UncachePath(path.AsString());
         }
     }
     }
@@ -359,6 +361,7 @@ void Module::Interface::Write(Kernel::HLERequestContext& ctx) {
         const u32 bytes_written = static_cast<u32>(
             session_data->file->Write(0, buffer.size(), true, buffer.data()).Unwrap());
         session_data->file->Close();
+        cecd->UncachePath(session_data->path.AsString());
 
         rb.Push(RESULT_SUCCESS);
     }
@@ -421,6 +424,7 @@ void Module::Interface::WriteMessage(Kernel::HLERequestContext& ctx) {
         const u32 bytes_written =
             static_cast<u32>(message->Write(0, buffer_size, true, buffer.data()).Unwrap());
         message->Close();
+        cecd->UncachePath(message_path.AsString());
 
         rb.Push(RESULT_SUCCESS);
     } else {
@@ -508,6 +512,7 @@ void Module::Interface::WriteMessageWithHMAC(Kernel::HLERequestContext& ctx) {
         const u32 bytes_written =
             static_cast<u32>(message->Write(0, buffer_size, true, buffer.data()).Unwrap());
         message->Close();
+        cecd->UncachePath(message_path.AsString());
 
         rb.Push(RESULT_SUCCESS);
     } else {
@@ -543,10 +548,12 @@ void Module::Interface::Delete(Kernel::HLERequestContext& ctx) {
     case CecDataPathType::MboxDir:
     case CecDataPathType::InboxDir:
     case CecDataPathType::OutboxDir:
+        cecd->UncachePath(path.AsString());
         rb.Push(cecd->cecd_system_save_data_archive->DeleteDirectoryRecursively(path));
         break;
     default: // If not directory, then it is a file
         if (message_id_size == 0) {
+            cecd->UncachePath(path.AsString());
             rb.Push(cecd->cecd_system_save_data_archive->DeleteFile(path));
         } else {
             std::vector<u8> id_buffer(message_id_size);
@@ -557,6 +564,7 @@ void Module::Interface::Delete(Kernel::HLERequestContext& ctx) {
                                                            : CecDataPathType::InboxMsg,
                                                  ncch_program_id, id_buffer)
                     .data();
+            cecd->UncachePath(message_path.AsString());
             rb.Push(cecd->cecd_system_save_data_archive->DeleteFile(message_path));
         }
     }
@@ -578,23 +586,14 @@ void Module::Interface::SetData(Kernel::HLERequestContext& ctx) {
     auto& read_buffer = rp.PopMappedBuffer();
 
     if (option == 2 && buffer_size > 0) { // update obindex?
-        FileSys::Path path(
-            cecd->GetCecDataPathTypeAsString(CecDataPathType::OutboxIndex, ncch_program_id).data());
-        FileSys::Mode mode;
-        mode.write_flag.Assign(1);
-        mode.create_flag.Assign(1);
-
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-            std::vector<u8> buffer(buffer_size);
-            read_buffer.Read(buffer.data(), 0, buffer_size);
+        std::vector<u8> buffer(buffer_size);
+        read_buffer.Read(buffer.data(), 0, buffer_size);
 
-            cecd->CheckAndUpdateFile(CecDataPathType::OutboxIndex, ncch_program_id, buffer);
+        cecd->CheckAndUpdateFile(CecDataPathType::OutboxIndex, ncch_program_id, buffer);
 
-            file->Write(0, buffer.size(), true, buffer.data());
-            file->Close();
-        }
+        cecd->WriteBoxFile(
+            cecd->GetCecDataPathTypeAsString(CecDataPathType::OutboxIndex, ncch_program_id),
+            buffer);
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
@@ -719,9 +718,6 @@ void Module::Interface::OpenAndWrite(Kernel::HLERequestContext& ctx) {
     auto& read_buffer = rp.PopMappedBuffer();
 
     FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.write_flag.Assign(1);
-    mode.create_flag.Assign(1);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
     switch (path_type) {
@@ -733,30 +729,14 @@ void Module::Interface::OpenAndWrite(Kernel::HLERequestContext& ctx) {
                            ErrorSummary::NotFound, ErrorLevel::Status));
         break;
     default: // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
-
-            std::vector<u8> buffer(buffer_size);
-            read_buffer.Read(buffer.data(), 0, buffer_size);
-
-            if (file->GetSize() != buffer_size) {
-                file->SetSize(buffer_size);
-            }
-
-            if (open_mode.check) {
-                cecd->CheckAndUpdateFile(path_type, ncch_program_id, buffer);
-            }
-
-            const u32 bytes_written =
-                static_cast<u32>(file->Write(0, buffer.size(), true, buffer.data()).Unwrap());
-            file->Close();
+        std::vector<u8> buffer(buffer_size);
+        read_buffer.Read(buffer.data(), 0, buffer_size);
 
-            rb.Push(RESULT_SUCCESS);
-        } else {
-            rb.Push(ResultCode(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
-                               ErrorLevel::Status));
+        if (open_mode.check) {
+            cecd->CheckAndUpdateFile(path_type, ncch_program_id, buffer);
         }
+
+        rb.Push(cecd->WriteBoxFile(path.AsString(), buffer));
     }
     rb.PushMappedBuffer(read_buffer);
 
@@ -779,8 +759,6 @@ void Module::Interface::OpenAndRead(Kernel::HLERequestContext& ctx) {
     auto& write_buffer = rp.PopMappedBuffer();
 
     FileSys::Path path(cecd->GetCecDataPathTypeAsString(path_type, ncch_program_id).data());
-    FileSys::Mode mode;
-    mode.read_flag.Assign(1);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
     switch (path_type) {
@@ -793,15 +771,12 @@ void Module::Interface::OpenAndRead(Kernel::HLERequestContext& ctx) {
         rb.Push<u32>(0); // No entries read
         break;
     default: // If not directory, then it is a file
-        auto file_result = cecd->cecd_system_save_data_archive->OpenFile(path, mode);
-        if (file_result.Succeeded()) {
-            auto file = std::move(file_result).Unwrap();
+        if (const std::vector<u8>* contents = cecd->ReadBoxFile(path.AsString())) {
             std::vector<u8> buffer(buffer_size);
 
-            const u32 bytes_read =
-                static_cast<u32>(file->Read(0, buffer_size, buffer.data()).Unwrap());
+            const u32 bytes_read = std::min(buffer_size, static_cast<u32>(contents->size()));
+            std::memcpy(buffer.data(), contents->data(), bytes_read);
             write_buffer.Write(buffer.data(), 0, buffer_size);
-            file->Close();
 
             rb.Push(RESULT_SUCCESS);
             rb.Push<u32>(bytes_read);
@@ -925,6 +900,102 @@ std::string Module::GetCecCommandAsString(const CecCommand command) const {
     }
 }
 
+const std::vector<u8>* Module::ReadBoxFile(const std::string& path) {
+    const auto it = box_file_cache.find(path);
+    if (it != box_file_cache.end()) {
+        return &it->second;
+    }
+
+    FileSys::Mode mode;
+    mode.read_flag.Assign(1);
+    auto file_result = cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (file_result.Failed()) {
+        return nullptr;
+    }
+
+    auto file = std::move(file_result).Unwrap();
+    std::vector<u8> contents(static_cast<std::size_t>(file->GetSize()));
+    const auto read_result = file->Read(0, contents.size(), contents.data());
+    file->Close();
+    if (read_result.Failed()) {
+        return nullptr;
+    }
+    contents.resize(*read_result);
+    return &box_file_cache.insert_or_assign(path, std::move(contents)).first->second;
+}
+
+ResultCode Module::WriteBoxFile(const std::string& path, const std::vector<u8>& buffer) {
+    const auto it = box_file_cache.find(path);
+    if (it != box_file_cache.end() && it->second == buffer) {
+        return RESULT_SUCCESS;
+    }
+
+    FileSys::Mode mode;
+    mode.write_flag.Assign(1);
+    mode.create_flag.Assign(1);
+    auto file_result = cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (file_result.Failed()) {
+        return ResultCode(ErrorDescription::NoData, ErrorModule::CEC, ErrorSummary::NotFound,
+                          ErrorLevel::Status);
+    }
+
+    auto file = std::move(file_result).Unwrap();
+    if (file->GetSize() != buffer.size()) {
+        file->SetSize(buffer.size());
+    }
+    const auto write_result = file->Write(0, buffer.size(), true, buffer.data());
+    file->Close();
+    if (write_result.Failed()) {
+        box_file_cache.erase(path);
+        return write_result.Code();
+    }
+    box_file_cache.insert_or_assign(path, buffer);
+    return RESULT_SUCCESS;
+}
+
+std::optional<Module::CecMessageHeader> Module::GetMessageHeader(const std::string& path) {
+    const auto it = message_header_cache.find(path);
+    if (it != message_header_cache.end()) {
+        return it->second;
+    }
+
+    FileSys::Mode mode;
+    mode.read_flag.Assign(1);
+    auto message_result =
+        cecd_system_save_data_archive->OpenFile(FileSys::Path(path.data()), mode);
+    if (message_result.Failed()) {
+        return std::nullopt;
+    }
+
+    auto message = std::move(message_result).Unwrap();
+    CecMessageHeader header{};
+    const auto read_result =
+        message->Read(0, sizeof(CecMessageHeader), reinterpret_cast<u8*>(&header));
+    message->Close();
+    if (read_result.Failed() || *read_result != sizeof(CecMessageHeader)) {
+        return std::nullopt;
+    }
+    message_header_cache.emplace(path, header);
+    return header;
+}
+
+void Module::UncachePath(const std::string& path) {
+    const auto Uncache = [&path](auto& cache) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            const std::string& cached_path = it->first;
+            if (cached_path == path || (cached_path.size() > path.size() &&
+                                        cached_path.compare(0, path.size(), path) == 0 &&
+                                        cached_path[path.size()] == '/')) {
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+    Uncache(box_file_cache);
+    Uncache(message_header_cache);
+}
+
 void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_program_id,
                                 std::vector<u8>& file_buffer) {
     constexpr u32 max_num_boxes = 24;
@@ -1212,25 +1283,13 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
             if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0) {
                 LOG_DEBUG(Service_CECD, "Adding message to BoxInfo_____: {}", file_name);
 
-                FileSys::Path message_path(
-                    (GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
-                     file_name)
-                        .data());
-
-                FileSys::Mode mode;
-                mode.read_flag.Assign(1);
+                const std::string message_path =
+                    GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
+                    file_name;
 
-                auto message_result = cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-                auto message = std::move(message_result).Unwrap();
-                const u32 message_size = static_cast<u32>(message->GetSize());
-                std::vector<u8> buffer(message_size);
-
-                message->Read(0, message_size, buffer.data()).Unwrap();
-                message->Close();
-
-                std::memcpy(&message_headers[outbox_info_header.message_num++], buffer.data(),
-                            sizeof(CecMessageHeader));
+                if (const auto header = GetMessageHeader(message_path)) {
+                    message_headers[outbox_info_header.message_num++] = *header;
+                }
             }
         }
 
@@ -1302,25 +1361,13 @@ void Module::CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_
             file_name = Common::UTF16ToUTF8(u16_filename);
 
             if (boxinfo_name.compare(file_name) != 0 && obindex_name.compare(file_name) != 0) {
-                FileSys::Path message_path(
-                    (GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
-                     file_name)
-                        .data());
-
-                FileSys::Mode mode;
-                mode.read_flag.Assign(1);
+                const std::string message_path =
+                    GetCecDataPathTypeAsString(CecDataPathType::OutboxDir, ncch_program_id) + "/" +
+                    file_name;
 
-                auto message_result = cecd_system_save_data_archive->OpenFile(message_path, mode);
-
-                auto message = std::move(message_result).Unwrap();
-                const u32 message_size = static_cast<u32>(message->GetSize());
-                std::vector<u8> buffer(message_size);
-
-                message->Read(0, message_size, buffer.data()).Unwrap();
-                message->Close();
-
-                // Message id is at offset 0x20, and is 8 bytes
-                std::memcpy(&message_ids[obindex_header.message_num++], buffer.data() + 0x20, 8);
+                if (const auto header = GetMessageHeader(message_path)) {
+                    message_ids[obindex_header.message_num++] = header->message_id;
+                }
             }
         }
 
@@ -5,6 +5,10 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "common/bit_field.h"
 #include "common/common_funcs.h"
 #include "core/hle/kernel/event.h"
@@ -607,8 +611,25 @@ private:
     void CheckAndUpdateFile(const CecDataPathType path_type, const u32 ncch_program_id,
                             std::vector<u8>& file_buffer);
 
+    /// Reads a box file through the cache, returns nullptr if it can't be opened
+    const std::vector<u8>* ReadBoxFile(const std::string& path);
+
+    /// Writes a box file and keeps its contents, the archive isn't touched if they didn't change
+    ResultCode WriteBoxFile(const std::string& path, const std::vector<u8>& buffer);
+
+    /// Gets the header of a message, which is only read from the archive the first time
+    std::optional<CecMessageHeader> GetMessageHeader(const std::string& path);
+
+    /// Drops what is cached of a file, or of everything under a directory
+    void UncachePath(const std::string& path);
+
     std::unique_ptr<FileSys::ArchiveBackend> cecd_system_save_data_archive;
 
+    /// Contents of the box files (MBoxList, BoxInfo, OBIndex...) by path, as in the archive
+    std::unordered_map<std::string, std::vector<u8>> box_file_cache;
+    /// Headers of the messages by path, the box info and index are rebuilt from them
+    std::unordered_map<std::string, CecMessageHeader> message_header_cache;
+
     std::shared_ptr<Kernel::Event> cecinfo_event;
     std::shared_ptr<Kernel::Event> change_state_event;
 
@@ -316,16 +316,14 @@ ResultVal<void*> Module::GetConfigInfoBlockPointer(u32 block_id, u32 size, u32 f
     // Read the header
     SaveFileConfig* config = reinterpret_cast<SaveFileConfig*>(cfg_config_file_buffer.data());
 
-    auto itr =
-        std::find_if(std::begin(config->block_entries), std::end(config->block_entries),
-                     [&](const SaveConfigBlockEntry& entry) { return entry.block_id == block_id; });
-
-    if (itr == std::end(config->block_entries)) {
+    const auto index = block_index.find(block_id);
+    if (index == block_index.end()) {
         LOG_ERROR(Service_CFG, "Config block 0x{:X} with flags {} and size {} was not found",
                   block_id, flag, size);
         return ResultCode(ErrorDescription::NotFound, ErrorModule::Config,
                           ErrorSummary::WrongArgument, ErrorLevel::Permanent);
     }
+    SaveConfigBlockEntry* itr = &config->block_entries[index->second];
 
     if ((itr->flags & flag) == 0) {
         LOG_ERROR(Service_CFG, "Invalid flag {} for config block 0x{:X} with size {}", flag,
@@ -363,10 +361,27 @@ ResultCode Module::GetConfigInfoBlock(u32 block_id, u32 size, u32 flag, void* ou
 ResultCode Module::SetConfigInfoBlock(u32 block_id, u32 size, u32 flag, const void* input) {
     void* pointer;
     CASCADE_RESULT(pointer, GetConfigInfoBlockPointer(block_id, size, flag));
-    memcpy(pointer, input, size);
+    if (memcmp(pointer, input, size) != 0) {
+        memcpy(pointer, input, size);
+        config_dirty = true;
+    }
     return RESULT_SUCCESS;
 }
 
+void Module::RebuildBlockIndex() {
+    const SaveFileConfig* config =
+        reinterpret_cast<const SaveFileConfig*>(cfg_config_file_buffer.data());
+    const u16 total_entries =
+        std::min<u16>(config->total_entries, static_cast<u16>(CONFIG_FILE_MAX_BLOCK_ENTRIES));
+
+    block_index.clear();
+    block_index.reserve(total_entries);
+    for (u16 i = 0; i < total_entries; ++i) {
+        // Lookups used to find the first entry with the id
+        block_index.emplace(config->block_entries[i].block_id, i);
+    }
+}
+
 ResultCode Module::CreateConfigInfoBlk(u32 block_id, u16 size, u16 flags, const void* data) {
     SaveFileConfig* config = reinterpret_cast<SaveFileConfig*>(cfg_config_file_buffer.data());
     if (config->total_entries >= CONFIG_FILE_MAX_BLOCK_ENTRIES)
@@ -395,7 +410,9 @@ ResultCode Module::CreateConfigInfoBlk(u32 block_id, u16 size, u16 flags, const
         memcpy(&config->block_entries[config->total_entries].offset_or_data, data, size);
     }
 
+    block_index.emplace(block_id, config->total_entries);
     ++config->total_entries;
+    config_dirty = true;
     return RESULT_SUCCESS;
 }
 
@@ -405,6 +422,10 @@ ResultCode Module::DeleteConfigNANDSaveFile() {
 }
 
 ResultCode Module::UpdateConfigNANDSavegame() {
+    if (!config_dirty) {
+        return RESULT_SUCCESS;
+    }
+
     FileSys::Mode mode = {};
     mode.write_flag.Assign(1);
     mode.create_flag.Assign(1);
@@ -416,6 +437,7 @@ ResultCode Module::UpdateConfigNANDSavegame() {
 
     auto config = std::move(config_result).Unwrap();
     config->Write(0, CONFIG_SAVEFILE_SIZE, 1, cfg_config_file_buffer.data());
+    config_dirty = false;
 
     return RESULT_SUCCESS;
 }
@@ -428,6 +450,8 @@ ResultCode Module::FormatConfig() {
     }
     // Delete the old data
     cfg_config_file_buffer.fill(0);
+    block_index.clear();
+    config_dirty = true;
     // Create the header
     SaveFileConfig* config = reinterpret_cast<SaveFileConfig*>(cfg_config_file_buffer.data());
     // This value is hardcoded, taken from 3dbrew, verified by hardware, it's always the same value
@@ -572,6 +596,8 @@ ResultCode Module::LoadConfigNANDSaveFile() {
     if (config_result.Succeeded()) {
         auto config = std::move(config_result).Unwrap();
         config->Read(0, CONFIG_SAVEFILE_SIZE, cfg_config_file_buffer.data());
+        RebuildBlockIndex();
+        config_dirty = false;
         return RESULT_SUCCESS;
     }
 
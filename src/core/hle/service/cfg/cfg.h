@@ -7,6 +7,7 @@
 #include <array>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/service/service.h"
@@ -251,6 +252,9 @@ public:
 private:
     ResultVal<void*> GetConfigInfoBlockPointer(u32 block_id, u32 size, u32 flag);
 
+    /// Rebuilds the index of the block entries after the whole buffer changed
+    void RebuildBlockIndex();
+
     /**
      * Reads a block with the specified id and flag from the Config savegame buffer
      * and writes the output to output. The input size must match exactly the size of the requested
@@ -416,7 +420,9 @@ public:
     EULAVersion GetEULAVersion();
 
     /**
-     * Writes the config savegame memory buffer to the config savegame file in the filesystem
+     * Writes the config savegame memory buffer to the config savegame file in the filesystem.
+     * Nothing is written if no block changed since the last write, so the changes made between
+     * two calls are saved at once.
      * @returns ResultCode indicating the result of the operation, 0 on success
      */
     ResultCode UpdateConfigNANDSavegame();
@@ -424,6 +430,10 @@ public:
 private:
     static constexpr u32 CONFIG_SAVEFILE_SIZE = 0x8000;
     std::array<u8, CONFIG_SAVEFILE_SIZE> cfg_config_file_buffer;
+    /// Position of each block in the block entries by id, the first one if an id is repeated
+    std::unordered_map<u32, u16> block_index;
+    /// Set when the buffer has changes the savegame file doesn't have
+    bool config_dirty = false;
     std::unique_ptr<FileSys::ArchiveBackend> cfg_system_save_data_archive;
     u32 preferred_region_code = 0;
 };
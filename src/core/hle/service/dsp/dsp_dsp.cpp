@@ -71,7 +71,10 @@ void DSP_DSP::WriteProcessPipe(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0D, 2, 2);
     const u32 channel = rp.Pop<u32>();
     const u32 size = rp.Pop<u32>();
-    auto buffer = rp.PopStaticBuffer();
+    const std::vector<u8>& input = rp.PopStaticBuffer();
+    // Patched below, so copied into a buffer that keeps its memory between calls
+    std::vector<u8>& buffer = pipe_write_buffer;
+    buffer.assign(input.begin(), input.end());
 
     const DspPipe pipe = static_cast<DspPipe>(channel);
 
@@ -111,15 +114,14 @@ void DSP_DSP::ReadPipe(Kernel::HLERequestContext& ctx) {
     const DspPipe pipe = static_cast<DspPipe>(channel);
     const u16 pipe_readable_size = static_cast<u16>(system.DSP().GetPipeReadableSize(pipe));
 
-    std::vector<u8> pipe_buffer;
-    if (pipe_readable_size >= size)
-        pipe_buffer = system.DSP().PipeRead(pipe, size);
-    else
+    if (pipe_readable_size < size)
         UNREACHABLE(); // No more data is in pipe. Hardware hangs in this case; Should never happen.
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
     rb.Push(RESULT_SUCCESS);
-    rb.PushStaticBuffer(std::move(pipe_buffer), 0);
+    // The pipe is read straight into the reply
+    u8* pipe_buffer = rb.PushStaticBuffer(size, 0);
+    system.DSP().PipeRead(pipe, pipe_buffer, size);
 
     LOG_DEBUG(Service_DSP, "DSP ReadPipe channel={}, peer={}, size=0x{:04X}, pipe_readable_size=0x{:04X}",
               channel, peer, size, pipe_readable_size);
@@ -150,15 +152,15 @@ void DSP_DSP::ReadPipeIfPossible(Kernel::HLERequestContext& ctx) {
     const DspPipe pipe = static_cast<DspPipe>(channel);
     const u16 pipe_readable_size = static_cast<u16>(system.DSP().GetPipeReadableSize(pipe));
 
-    std::vector<u8> pipe_buffer;
-    if (pipe_readable_size >= size) {
-        pipe_buffer = system.DSP().PipeRead(pipe, size);
-    }
+    const u16 read_size = pipe_readable_size >= size ? size : 0;
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
     rb.Push(RESULT_SUCCESS);
-    rb.Push<u16>(pipe_buffer.size());
-    rb.PushStaticBuffer(std::move(pipe_buffer), 0);
+    rb.Push<u16>(read_size);
+    u8* pipe_buffer = rb.PushStaticBuffer(read_size, 0);
+    if (read_size != 0) {
+        system.DSP().PipeRead(pipe, pipe_buffer, read_size);
+    }
 
     LOG_DEBUG(Service_DSP, "DSP ReadPipeIfPossible channel={}, peer={}, size=0x{:04X}, pipe_readable_size=0x{:04X}",
               channel, peer, size, pipe_readable_size);
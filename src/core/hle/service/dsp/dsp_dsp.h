@@ -5,6 +5,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "audio_core/dsp_interface.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/result.h"
@@ -264,6 +265,9 @@ private:
 
     /// Each DSP pipe has an associated interrupt
     std::array<std::shared_ptr<Kernel::Event>, AudioCore::num_dsp_pipe> pipes = {{}};
+
+    /// Holds the data of WriteProcessPipe while it is patched, kept to avoid an allocation per call
+    std::vector<u8> pipe_write_buffer;
 };
 
 void InstallInterfaces(Core::System& system);
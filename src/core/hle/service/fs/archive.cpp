@@ -14,6 +14,7 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/archive_extsavedata.h"
 #include "core/file_sys/archive_ncch.h"
@@ -24,6 +25,7 @@
 #include "core/file_sys/archive_selfncch.h"
 #include "core/file_sys/archive_systemsavedata.h"
 #include "core/file_sys/directory_backend.h"
+#include "core/file_sys/disk_archive.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/result.h"
@@ -31,6 +33,9 @@
 
 namespace Service::FS {
 
+/// How often the writes held back by the save data archives are checked for their age
+constexpr s64 WriteBackFlushInterval = msToCycles(1000);
+
 ArchiveBackend* ArchiveManager::GetArchive(ArchiveHandle handle) {
     auto itr = handle_map.find(handle);
     return (itr == handle_map.end()) ? nullptr : itr->second.get();
@@ -63,6 +68,14 @@ ResultCode ArchiveManager::CloseArchive(ArchiveHandle handle) {
         return RESULT_SUCCESS;
 }
 
+ResultCode ArchiveManager::CommitArchive(ArchiveHandle handle) {
+    ArchiveBackend* archive = GetArchive(handle);
+    if (archive == nullptr)
+        return FileSys::ERR_INVALID_ARCHIVE_HANDLE;
+
+    return archive->Commit();
+}
+
 // TODO(yuriks): This might be what the fs:REG service is for. See the Register/Unregister calls in
 // http://3dbrew.org/wiki/Filesystem_services#ProgramRegistry_service_.22fs:REG.22
 ResultCode ArchiveManager::RegisterArchiveType(std::unique_ptr<FileSys::ArchiveFactory>&& factory,
@@ -371,8 +384,21 @@ bool ArchiveManager::CheckArchiveHandle(ArchiveHandle handle) {
     return handle_map.find(handle) != handle_map.end();
 }
 
+void ArchiveManager::FlushWriteBackCallback(u64 userdata, s64 cycles_late) {
+    FileSys::WriteBackCache::FlushStale();
+    system.CoreTiming().ScheduleEvent(WriteBackFlushInterval - cycles_late, write_back_event);
+}
+
 ArchiveManager::ArchiveManager(Core::System& system) : system(system) {
     RegisterArchiveTypes();
+    write_back_event = system.CoreTiming().RegisterEvent(
+        "FS::FlushWriteBackCallback",
+        [this](u64 userdata, s64 cycles_late) { FlushWriteBackCallback(userdata, cycles_late); });
+    system.CoreTiming().ScheduleEvent(WriteBackFlushInterval, write_back_event);
+}
+
+ArchiveManager::~ArchiveManager() {
+    system.CoreTiming().UnscheduleEvent(write_back_event, 0);
 }
 
 } // namespace Service::FS
@@ -25,7 +25,8 @@ class AppLoader;
 
 namespace Core {
 class System;
-}
+struct TimingEventType;
+} // namespace Core
 
 namespace Service::FS {
 
@@ -62,6 +63,7 @@ using FileSys::ArchiveFactory;
 class ArchiveManager {
 public:
     explicit ArchiveManager(Core::System& system);
+    ~ArchiveManager();
 
     /**
      * Opens an archive
@@ -79,6 +81,12 @@ public:
      */
     ResultCode CloseArchive(ArchiveHandle handle);
 
+    /**
+     * Commits the changes to an archive, writing out the data its files hold back
+     * @param handle Handle to the archive to commit
+     */
+    ResultCode CommitArchive(ArchiveHandle handle);
+
     /**
      * Open a File from an Archive
      * @param archive_handle Handle to an open Archive object
@@ -253,6 +261,11 @@ public:
 private:
     Core::System& system;
 
+    /// Writes out the save data held back for too long, the games may not write again for a while
+    void FlushWriteBackCallback(u64 userdata, s64 cycles_late);
+
+    Core::TimingEventType* write_back_event;
+
     /**
      * Registers an Archive type, instances of which can later be opened using its IdCode.
      * @param factory File system backend interface to the archive
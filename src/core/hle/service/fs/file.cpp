@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <future>
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
@@ -15,6 +16,37 @@
 
 namespace Service::FS {
 
+/// Reads this large are done on a host thread while the guest thread sleeps through the read delay
+constexpr std::size_t AsyncReadThreshold = 0x10000;
+
+class File::ReadCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    ReadCallback(const Kernel::MappedBuffer& buffer, std::shared_ptr<std::vector<u8>> data,
+                 std::shared_future<ResultVal<std::size_t>> read)
+        : buffer(buffer), data(std::move(data)), read(std::move(read)) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        // The host read is usually done by now, the delay of the 3DS is longer
+        const ResultVal<std::size_t>& result = read.get();
+        IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+        if (result.Failed()) {
+            rb.Push(result.Code());
+            rb.Push<u32>(0);
+        } else {
+            buffer.Write(data->data(), 0, *result);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push<u32>(static_cast<u32>(*result));
+        }
+        rb.PushMappedBuffer(buffer);
+    }
+
+private:
+    Kernel::MappedBuffer buffer;
+    std::shared_ptr<std::vector<u8>> data;
+    std::shared_future<ResultVal<std::size_t>> read;
+};
+
 File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
            const FileSys::Path& path)
     : ServiceFramework("", 1), path(path), backend(std::move(backend)), system(system) {
@@ -38,6 +70,17 @@ File::File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend
     RegisterHandlers(functions);
 }
 
+File::~File() {
+    WaitPendingRead();
+}
+
+void File::WaitPendingRead() {
+    if (pending_read.valid()) {
+        pending_read.wait();
+        pending_read = {};
+    }
+}
+
 void File::Read(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x0802, 3, 2);
     u64 offset = rp.Pop<u64>();
@@ -47,6 +90,9 @@ void File::Read(Kernel::HLERequestContext& ctx) {
 
     const FileSessionSlot* file = GetSessionData(ctx.Session());
 
+    // The backend is not thread safe, a read still running for another session has to end first
+    WaitPendingRead();
+
     if (file->subfile && length > file->size) {
         LOG_WARNING(Service_FS, "Trying to read beyond the subfile size, truncating");
         length = static_cast<u32>(file->size);
@@ -61,6 +107,18 @@ void File::Read(Kernel::HLERequestContext& ctx) {
                   offset, length, backend->GetSize());
     }
 
+    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
+
+    if (length >= AsyncReadThreshold) {
+        auto data = std::make_shared<std::vector<u8>>(length);
+        pending_read = std::async(std::launch::async, [this, offset, data] {
+                           return backend->Read(offset, data->size(), data->data());
+                       }).share();
+        ctx.SleepClientThread("file::read", read_timeout_ns,
+                              std::make_shared<ReadCallback>(buffer, data, pending_read));
+        return;
+    }
+
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
 
     std::vector<u8> data(length);
@@ -75,7 +133,6 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     }
     rb.PushMappedBuffer(buffer);
 
-    std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
     ctx.SleepClientThread("file::read", read_timeout_ns, nullptr);
 }
 
@@ -100,6 +157,7 @@ void File::Write(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    WaitPendingRead();
     std::vector<u8> data(length);
     buffer.Read(data.data(), 0, data.size());
     ResultVal<std::size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
@@ -141,6 +199,7 @@ void File::SetSize(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    WaitPendingRead();
     file->size = size;
     backend->SetSize(size);
     rb.Push(RESULT_SUCCESS);
@@ -154,6 +213,7 @@ void File::Close(Kernel::HLERequestContext& ctx) {
         LOG_WARNING(Service_FS, "Closing File backend but {} clients still connected",
                     connected_sessions.size());
 
+    WaitPendingRead();
     backend->Close();
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
@@ -172,6 +232,7 @@ void File::Flush(Kernel::HLERequestContext& ctx) {
         return;
     }
 
+    WaitPendingRead();
     backend->Flush();
     rb.Push(RESULT_SUCCESS);
 }
@@ -209,6 +270,7 @@ void File::OpenLinkFile(Kernel::HLERequestContext& ctx) {
 
     slot->priority = original_file->priority;
     slot->offset = 0;
+    WaitPendingRead();
     slot->size = backend->GetSize();
     slot->subfile = false;
 
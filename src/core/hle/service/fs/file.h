@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/service/service.h"
@@ -27,7 +28,7 @@ class File final : public ServiceFramework<File, FileSessionSlot> {
 public:
     File(Core::System& system, std::unique_ptr<FileSys::FileBackend>&& backend,
          const FileSys::Path& path);
-    ~File() = default;
+    ~File();
 
     std::string GetName() const {
         return "Path: " + path.DebugStr();
@@ -59,7 +60,14 @@ private:
     void OpenLinkFile(Kernel::HLERequestContext& ctx);
     void OpenSubFile(Kernel::HLERequestContext& ctx);
 
+    /// Waits for the read done on a host thread, if any, before the backend is used again
+    void WaitPendingRead();
+
+    class ReadCallback;
+
     Core::System& system;
+    /// Large reads run on a host thread while the guest thread sleeps, see Read
+    std::shared_future<ResultVal<std::size_t>> pending_read;
 };
 
 } // namespace Service::FS
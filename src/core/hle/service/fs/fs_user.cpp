@@ -348,6 +348,8 @@ void FS_USER::ControlArchive(Kernel::HLERequestContext& ctx) {
         if (!archives.CheckArchiveHandle(archive_handle)) {
             result = ResultCode(FileSys::ErrCodes::ArchiveNotMounted, ErrorModule::FS,
                                 ErrorSummary::NotFound, ErrorLevel::Status);
+        } else {
+            result = archives.CommitArchive(archive_handle);
         }
     } else if (action == 1) {
         // Action 1 : Retrieves a file's last-modified timestamp.
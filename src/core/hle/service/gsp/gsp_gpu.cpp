@@ -20,6 +20,7 @@
 #include "core/memory.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu_debugger.h"
+#include "video_core/video_core.h"
 
 // Main graphics debugger object - TODO: Here is probably not the best place for this
 GraphicsDebugger g_debugger;
@@ -329,12 +330,14 @@ void GSP_GPU::FlushDataCache(Kernel::HLERequestContext& ctx) {
     auto process = rp.PopObject<Kernel::Process>();
 
     // This calls svcFlushProcessDataCache with the specified KProcess handle, address, and size.
+    // The CPU wrote the region for the GPU to read, so the surfaces cached over it are stale.
+    Memory::RasterizerFlushVirtualRegion(address, size, Memory::FlushMode::Invalidate);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 
-    //LOG_DEBUG(Service_GSP, "(STUBBED) GSP_GPU FlushDataCache called address=0x{:08X}, size=0x{:08X}, process={}", address,
-    //          size, process->process_id);
+    LOG_TRACE(Service_GSP, "called address=0x{:08X}, size=0x{:08X}, process={}", address, size,
+              process->process_id);
 }
 
 void GSP_GPU::InvalidateDataCache(Kernel::HLERequestContext& ctx) {
@@ -345,11 +348,14 @@ void GSP_GPU::InvalidateDataCache(Kernel::HLERequestContext& ctx) {
 
     // TODO(purpasmart96): Verify return header on HW
 
+    // The CPU is about to read what the GPU rendered to the region
+    Memory::RasterizerFlushVirtualRegion(address, size, Memory::FlushMode::Flush);
+
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 
-    LOG_DEBUG(Service_GSP, "(STUBBED) GSP_GPU InvalidateDataCache called address=0x{:08X}, size=0x{:08X}, process={}", address,
-              size, process->process_id);
+    LOG_TRACE(Service_GSP, "called address=0x{:08X}, size=0x{:08X}, process={}", address, size,
+              process->process_id);
 }
 
 void GSP_GPU::SetAxiConfigQoSMode(Kernel::HLERequestContext& ctx) {
@@ -450,6 +456,13 @@ void GSP_GPU::SignalInterruptForThread(InterruptId interrupt_id, u32 thread_id)
  * @todo This probably does not belong in the GSP module, instead move to video_core
  */
 void GSP_GPU::SignalInterrupt(InterruptId interrupt_id) {
+    // Work running on the GPU thread has its interrupts signalled from the emulation thread
+    VideoCore::GPUThread* gpu_thread = VideoCore::GetGPUThread();
+    if (gpu_thread && gpu_thread->IsCurrentThread()) {
+        gpu_thread->PostToCPU([this, interrupt_id] { SignalInterrupt(interrupt_id); });
+        return;
+    }
+
     if (nullptr == shared_memory) {
         LOG_WARNING(Service_GSP, "cannot synchronize until GSP shared memory has been created!");
         return;
@@ -487,23 +500,25 @@ static void ExecuteCommand(const Command& command) {
 
     // GX request DMA - typically used for copying memory from GSP heap to VRAM
     case CommandId::REQUEST_DMA: {
-        MICROPROFILE_SCOPE(GPU_GSP_DMA);
-        Memory::MemorySystem& memory = Core::System::GetInstance().Memory();
-
-        // TODO: Consider attempting rasterizer-accelerated surface blit if that usage is ever
-        // possible/likely
-        Memory::RasterizerFlushVirtualRegion(command.dma_request.source_address,
-                                             command.dma_request.size, Memory::FlushMode::Flush);
-        Memory::RasterizerFlushVirtualRegion(command.dma_request.dest_address,
-                                             command.dma_request.size,
-                                             Memory::FlushMode::Invalidate);
-
-        // TODO(Subv): These memory accesses should not go through the application's memory mapping.
-        // They should go through the GSP module's memory mapping.
-        memory.CopyBlock(*Core::System::GetInstance().Kernel().GetCurrentProcess(),
-                         command.dma_request.dest_address, command.dma_request.source_address,
-                         command.dma_request.size);
-        SignalInterrupt(InterruptId::DMA);
+        // Queued as GPU work, command lists submitted earlier may still read the destination
+        GPU::QueueWork([dma_request = command.dma_request,
+                        process = Core::System::GetInstance().Kernel().GetCurrentProcess()] {
+            MICROPROFILE_SCOPE(GPU_GSP_DMA);
+            Memory::MemorySystem& memory = Core::System::GetInstance().Memory();
+
+            // TODO: Consider attempting rasterizer-accelerated surface blit if that usage is ever
+            // possible/likely
+            Memory::RasterizerFlushVirtualRegion(dma_request.source_address, dma_request.size,
+                                                 Memory::FlushMode::Flush);
+            Memory::RasterizerFlushVirtualRegion(dma_request.dest_address, dma_request.size,
+                                                 Memory::FlushMode::Invalidate);
+
+            // TODO(Subv): These memory accesses should not go through the application's memory
+            // mapping. They should go through the GSP module's memory mapping.
+            memory.CopyBlock(*process, dma_request.dest_address, dma_request.source_address,
+                             dma_request.size);
+            SignalInterrupt(InterruptId::DMA);
+        });
         break;
     }
     // TODO: This will need some rework in the future. (why?)
@@ -749,11 +764,14 @@ void GSP_GPU::StoreDataCache(Kernel::HLERequestContext& ctx) {
     u32 size = rp.Pop<u32>();
     auto process = rp.PopObject<Kernel::Process>();
 
+    // Same as FlushDataCache, the region is written back for the GPU
+    Memory::RasterizerFlushVirtualRegion(address, size, Memory::FlushMode::Invalidate);
+
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 
-    LOG_DEBUG(Service_GSP, "(STUBBED) GSP_GPU StoreDataCache called address=0x{:08X}, size=0x{:08X}, process={}", address,
-              size, process->process_id);
+    LOG_TRACE(Service_GSP, "called address=0x{:08X}, size=0x{:08X}, process={}", address, size,
+              process->process_id);
 }
 
 void GSP_GPU::SetLedForceOff(Kernel::HLERequestContext& ctx) {
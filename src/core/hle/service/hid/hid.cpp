@@ -8,6 +8,7 @@
 #include "core/3ds.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/frontend/input.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
@@ -73,7 +74,7 @@ void Module::LoadInputDevices() {
         Settings::values.current_input_profile.touch_device);
 }
 
-void Module::UpdatePad() {
+bool Module::UpdatePad() {
     auto mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     using namespace Settings::NativeButton;
@@ -128,6 +129,12 @@ void Module::UpdatePad() {
     pad_entry.circle_pad_x = circle_pad_x;
     pad_entry.circle_pad_y = circle_pad_y;
 
+    bool changed_input = state.hex != last_state.hex || circle_pad_x != last_circle_pad_x ||
+                         circle_pad_y != last_circle_pad_y;
+    last_state.hex = state.hex;
+    last_circle_pad_x = circle_pad_x;
+    last_circle_pad_y = circle_pad_y;
+
     // If we just updated index 0, provide a new timestamp
     if (mem->pad.index == 0) {
         mem->pad.index_reset_ticks_previous = mem->pad.index_reset_ticks;
@@ -148,6 +155,10 @@ void Module::UpdatePad() {
 
     Core::Movie::GetInstance().HandleTouchStatus(touch_entry);
 
+    changed_input |= touch_entry.x != last_touch.x || touch_entry.y != last_touch.y ||
+                     touch_entry.valid.Value() != last_touch.valid.Value();
+    last_touch = touch_entry;
+
     // TODO(bunnei): We're not doing anything with offset 0xA8 + 0x18 of HID SharedMemory, which
     // supposedly is "Touch-screen entry, which contains the raw coordinate data prior to being
     // converted to pixel coordinates." (http://3dbrew.org/wiki/HID_Shared_Memory#Offset_0xA8).
@@ -157,35 +168,60 @@ void Module::UpdatePad() {
         mem->touch.index_reset_ticks_previous = mem->touch.index_reset_ticks;
         mem->touch.index_reset_ticks = (s64)system.CoreTiming().GetTicks();
     }
+
+    return changed_input;
 }
 
-void Module::UpdatePadCallback(u64 userdata, s64 cycles_late) {
+void Module::UpdateInputCallback(u64 userdata, s64 cycles_late) {
     if (is_device_reload_pending.exchange(false))
         LoadInputDevices();
 
+    // Taken before the devices are read, an event coming in meanwhile counts for the next update
+    const s64 input_event_ns = Input::TakeInputEventTime();
+
     // gamepad input
-    UpdatePad();
+    const bool changed_input = UpdatePad();
+    if (input_event_ns != 0) {
+        system.perf_stats->AddInputLatch(input_event_ns);
+    }
 
-    // Signal both handles when there's an update to Pad or touch
-    event_pad_or_touch_1->Signal();
-    event_pad_or_touch_2->Signal();
+    // Signal both handles when there's an update to Pad or touch. Titles that only poll after
+    // the event can run without the wake-ups while nothing is pressed, when they are skipped.
+    if (changed_input || !Settings::values.skip_unchanged_input_events) {
+        event_pad_or_touch_1->Signal();
+        event_pad_or_touch_2->Signal();
+    }
+
+    const bool update_accelerometer =
+        enable_accelerometer_count > 0 && (accelerometer_ticks_left -= pad_update_ticks) <= 0;
+    const bool update_gyroscope =
+        enable_gyroscope_count > 0 && (gyroscope_ticks_left -= pad_update_ticks) <= 0;
+    if (update_accelerometer || update_gyroscope) {
+        const auto [accel, gyro] = motion_device->GetStatus();
+        if (update_accelerometer) {
+            accelerometer_ticks_left += accelerometer_update_ticks;
+            UpdateAccelerometer(accel);
+        }
+        if (update_gyroscope) {
+            gyroscope_ticks_left += gyroscope_update_ticks;
+            UpdateGyroscope(gyro);
+        }
+    }
 
     // TODO(xperia64): How the 3D Slider is updated by the HID module needs to be RE'd
     // and possibly moved to its own Core::Timing event.
     system.Kernel().GetSharedPageHandler().Set3DSlider(Settings::values.factor_3d / 100.0f);
 
     // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(pad_update_ticks - cycles_late, pad_update_event);
+    system.CoreTiming().ScheduleEvent(pad_update_ticks - cycles_late, input_update_event);
 }
 
-void Module::UpdateAccelerometerCallback(u64 userdata, s64 cycles_late) {
+void Module::UpdateAccelerometer(Common::Vec3<float> accel) {
     auto mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     mem->accelerometer.index = next_accelerometer_index;
     next_accelerometer_index = (next_accelerometer_index + 1) % mem->accelerometer.entries.size();
 
-    Common::Vec3<float> accel;
-    std::tie(accel, std::ignore) = motion_device->GetStatus();
     accel *= accelerometer_coef;
     // TODO(wwylele): do a time stretch like the one in UpdateGyroscopeCallback
     // The time stretch formula should be like
@@ -217,13 +253,9 @@ void Module::UpdateAccelerometerCallback(u64 userdata, s64 cycles_late) {
     }
 
     event_accelerometer->Signal();
-
-    // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(accelerometer_update_ticks - cycles_late,
-                                      accelerometer_update_event);
 }
 
-void Module::UpdateGyroscopeCallback(u64 userdata, s64 cycles_late) {
+void Module::UpdateGyroscope(Common::Vec3<float> gyro) {
     auto mem = reinterpret_cast<SharedMem*>(shared_mem->GetPointer());
 
     mem->gyroscope.index = next_gyroscope_index;
@@ -231,8 +263,6 @@ void Module::UpdateGyroscopeCallback(u64 userdata, s64 cycles_late) {
 
     GyroscopeDataEntry& gyroscope_entry = mem->gyroscope.entries[mem->gyroscope.index];
 
-    Common::Vec3<float> gyro;
-    std::tie(std::ignore, gyro) = motion_device->GetStatus();
     double stretch = system.perf_stats->GetLastFrameTimeScale();
     gyro *= gyroscope_coef * static_cast<float>(stretch);
     gyroscope_entry.x = static_cast<s16>(gyro.x);
@@ -253,9 +283,6 @@ void Module::UpdateGyroscopeCallback(u64 userdata, s64 cycles_late) {
     }
 
     event_gyroscope->Signal();
-
-    // Reschedule recurrent event
-    system.CoreTiming().ScheduleEvent(gyroscope_update_ticks - cycles_late, gyroscope_update_event);
 }
 
 void Module::Interface::GetIPCHandles(Kernel::HLERequestContext& ctx) {
@@ -271,10 +298,9 @@ void Module::Interface::EnableAccelerometer(Kernel::HLERequestContext& ctx) {
 
     ++hid->enable_accelerometer_count;
 
-    // Schedules the accelerometer update event if the accelerometer was just enabled
+    // Starts a period of the accelerometer if it was just enabled
     if (hid->enable_accelerometer_count == 1) {
-        hid->system.CoreTiming().ScheduleEvent(accelerometer_update_ticks,
-                                               hid->accelerometer_update_event);
+        hid->accelerometer_ticks_left = accelerometer_update_ticks;
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -288,11 +314,6 @@ void Module::Interface::DisableAccelerometer(Kernel::HLERequestContext& ctx) {
 
     --hid->enable_accelerometer_count;
 
-    // Unschedules the accelerometer update event if the accelerometer was just disabled
-    if (hid->enable_accelerometer_count == 0) {
-        hid->system.CoreTiming().UnscheduleEvent(hid->accelerometer_update_event, 0);
-    }
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 
@@ -304,9 +325,9 @@ void Module::Interface::EnableGyroscopeLow(Kernel::HLERequestContext& ctx) {
 
     ++hid->enable_gyroscope_count;
 
-    // Schedules the gyroscope update event if the gyroscope was just enabled
+    // Starts a period of the gyroscope if it was just enabled
     if (hid->enable_gyroscope_count == 1) {
-        hid->system.CoreTiming().ScheduleEvent(gyroscope_update_ticks, hid->gyroscope_update_event);
+        hid->gyroscope_ticks_left = gyroscope_update_ticks;
     }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
@@ -320,11 +341,6 @@ void Module::Interface::DisableGyroscopeLow(Kernel::HLERequestContext& ctx) {
 
     --hid->enable_gyroscope_count;
 
-    // Unschedules the gyroscope update event if the gyroscope was just disabled
-    if (hid->enable_gyroscope_count == 0) {
-        hid->system.CoreTiming().UnscheduleEvent(hid->gyroscope_update_event, 0);
-    }
-
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
 
@@ -389,22 +405,14 @@ Module::Module(Core::System& system) : system(system) {
     event_gyroscope = system.Kernel().CreateEvent(ResetType::OneShot, "HID:EventGyroscope");
     event_debug_pad = system.Kernel().CreateEvent(ResetType::OneShot, "HID:EventDebugPad");
 
-    // Register update callbacks
+    // Register update callback
     Core::Timing& timing = system.CoreTiming();
-    pad_update_event =
-        timing.RegisterEvent("HID::UpdatePadCallback", [this](u64 userdata, s64 cycles_late) {
-            UpdatePadCallback(userdata, cycles_late);
-        });
-    accelerometer_update_event = timing.RegisterEvent(
-        "HID::UpdateAccelerometerCallback", [this](u64 userdata, s64 cycles_late) {
-            UpdateAccelerometerCallback(userdata, cycles_late);
-        });
-    gyroscope_update_event =
-        timing.RegisterEvent("HID::UpdateGyroscopeCallback", [this](u64 userdata, s64 cycles_late) {
-            UpdateGyroscopeCallback(userdata, cycles_late);
+    input_update_event =
+        timing.RegisterEvent("HID::UpdateInputCallback", [this](u64 userdata, s64 cycles_late) {
+            UpdateInputCallback(userdata, cycles_late);
         });
 
-    timing.ScheduleEvent(pad_update_ticks, pad_update_event);
+    timing.ScheduleEvent(pad_update_ticks, input_update_event);
 }
 
 void Module::ReloadInputDevices() {
@@ -295,13 +295,20 @@ public:
 
     const PadState& GetState() const;
 
-    void UpdatePad();
+    /// Writes the pad and touch entries, returns true if the input differs from the last update
+    bool UpdatePad();
 
 private:
     void LoadInputDevices();
-    void UpdatePadCallback(u64 userdata, s64 cycles_late);
-    void UpdateAccelerometerCallback(u64 userdata, s64 cycles_late);
-    void UpdateGyroscopeCallback(u64 userdata, s64 cycles_late);
+    void UpdateAccelerometer(Common::Vec3<float> accel);
+    void UpdateGyroscope(Common::Vec3<float> gyro);
+
+    /**
+     * Updates every ring of the shared memory from a single event at the pad rate. The motion
+     * sensors, which run slower, are written when their own period elapsed, reading the motion
+     * device once for both.
+     */
+    void UpdateInputCallback(u64 userdata, s64 cycles_late);
 
     Core::System& system;
 
@@ -327,9 +334,17 @@ private:
     int enable_accelerometer_count = 0; // positive means enabled
     int enable_gyroscope_count = 0;     // positive means enabled
 
-    Core::TimingEventType* pad_update_event;
-    Core::TimingEventType* accelerometer_update_event;
-    Core::TimingEventType* gyroscope_update_event;
+    // Ticks until the next update of each motion sensor
+    s64 accelerometer_ticks_left = 0;
+    s64 gyroscope_ticks_left = 0;
+
+    // The last input written, to tell if an update changed anything
+    PadState last_state;
+    s16 last_circle_pad_x = 0;
+    s16 last_circle_pad_y = 0;
+    TouchDataEntry last_touch{};
+
+    Core::TimingEventType* input_update_event;
 
     std::atomic<bool> is_device_reload_pending{true};
     std::array<std::unique_ptr<Input::ButtonDevice>, Settings::NativeButton::NUM_BUTTONS_HID>
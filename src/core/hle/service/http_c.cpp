@@ -2,16 +2,24 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #ifdef ENABLE_WEB_SERVICE
 #include <LUrlParser.h>
 #endif
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
+#include "common/thread.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/archive_ncch.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/ipc.h"
 #include "core/hle/romfs.h"
 #include "core/hle/service/fs/archive.h"
@@ -51,25 +59,174 @@ const ResultCode ERROR_WRONG_CERT_HANDLE = // 0xD8A0A0C9
     ResultCode(201, ErrorModule::HTTP, ErrorSummary::InvalidState, ErrorLevel::Permanent);
 const ResultCode ERROR_CERT_ALREADY_SET = // 0xD8A0A03D
     ResultCode(61, ErrorModule::HTTP, ErrorSummary::InvalidState, ErrorLevel::Permanent);
+const ResultCode ERROR_BUFFER_TOO_SMALL = // 0xD840A02B
+    ResultCode(43, ErrorModule::HTTP, ErrorSummary::WouldBlock, ErrorLevel::Permanent);
+const ResultCode ERROR_TIMEOUT = // 0xD820A069
+    ResultCode(105, ErrorModule::HTTP, ErrorSummary::NothingHappened, ErrorLevel::Permanent);
+
+/// Number of threads sending the requests, the 3DS has about as many
+constexpr std::size_t NumRequestWorkers = 3;
+
+/// Number of idle clients kept for each host
+constexpr std::size_t MaxIdleClients = 4;
+
+/// Interval at which the threads waiting in ReceiveData check for their request
+constexpr s64 RequestPollInterval = msToCycles(1);
+
+/**
+ * Keeps the clients of the finished requests by host, so that the next requests to a host don't
+ * set up their client and SSL context again. The bundled httplib closes the connection at the end
+ * of each request, the sockets themselves can't be kept alive.
+ */
+class ClientPool {
+public:
+#ifdef ENABLE_WEB_SERVICE
+    /// Returns an idle client for the key, or nullptr if there is none
+    std::unique_ptr<httplib::Client> Acquire(const std::string& key) {
+        std::lock_guard lock{mutex};
+        auto& clients = idle_clients[key];
+        if (clients.empty()) {
+            return nullptr;
+        }
+        auto client = std::move(clients.back());
+        clients.pop_back();
+        return client;
+    }
+
+    void Release(const std::string& key, std::unique_ptr<httplib::Client> client) {
+        std::lock_guard lock{mutex};
+        auto& clients = idle_clients[key];
+        if (clients.size() < MaxIdleClients) {
+            clients.push_back(std::move(client));
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<httplib::Client>>> idle_clients;
+#endif
+};
 
-void Context::MakeRequest() {
+/// Runs the requests of all the contexts on a few threads, in the order they were begun
+class RequestWorkers {
+public:
+    explicit RequestWorkers(std::size_t num_threads) {
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back(&RequestWorkers::WorkerLoop, this);
+        }
+    }
+
+    /// Requests that didn't start yet are dropped, their futures report a broken promise
+    ~RequestWorkers() {
+        {
+            std::lock_guard lock{mutex};
+            stop_requested = true;
+            tasks.clear();
+        }
+        task_cv.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::future<void> Push(std::function<void()> task) {
+        std::packaged_task<void()> packaged_task{std::move(task)};
+        auto future = packaged_task.get_future();
+        {
+            std::lock_guard lock{mutex};
+            tasks.push_back(std::move(packaged_task));
+        }
+        task_cv.notify_one();
+        return future;
+    }
+
+private:
+    void WorkerLoop() {
+        Common::SetCurrentThreadName("HTTPWorker");
+        while (true) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock lock{mutex};
+                task_cv.wait(lock, [this] { return stop_requested || !tasks.empty(); });
+                if (stop_requested) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable task_cv;
+    std::deque<std::packaged_task<void()>> tasks;
+    bool stop_requested = false;
+};
+
+/// Returns true once the request of the context was sent and its response received
+static bool IsRequestDone(const Context& context) {
+    return context.request_future.valid() &&
+           context.request_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+class HTTP_C::ReceiveDataCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    ReceiveDataCallback(HTTP_C& service, u16 command_id, Context::Handle context_handle,
+                        u32 buffer_size, const Kernel::MappedBuffer& buffer)
+        : service(service), command_id(command_id), context_handle(context_handle),
+          buffer_size(buffer_size), buffer(buffer) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        // Nothing is left to remove when the poll woke the thread up
+        auto& pending = service.pending_receives;
+        pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                     [this](const PendingReceive& receive) {
+                                         return receive.id == id;
+                                     }),
+                      pending.end());
+        service.WriteReceivedData(ctx, command_id, context_handle, buffer_size, buffer);
+    }
+
+    u64 id = 0;
+
+private:
+    HTTP_C& service;
+    u16 command_id;
+    Context::Handle context_handle;
+    u32 buffer_size;
+    Kernel::MappedBuffer buffer;
+};
+
+void Context::MakeRequest(ClientPool& client_pool) {
     ASSERT(state == RequestState::NotStarted);
 
 #ifdef ENABLE_WEB_SERVICE
     LUrlParser::clParseURL parsedUrl = LUrlParser::clParseURL::ParseURL(url);
+    const bool is_ssl = parsedUrl.m_Scheme != "http";
     int port;
-    std::unique_ptr<httplib::Client> client;
-    if (parsedUrl.m_Scheme == "http") {
-        if (!parsedUrl.GetPort(&port)) {
-            port = 80;
-        }
+    if (!parsedUrl.GetPort(&port)) {
+        port = is_ssl ? 443 : 80;
+    }
+
+    // The client certificate is part of the SSL context, so clients are only shared by the
+    // requests that use the same one
+    const auto client_cert = ssl_config.client_cert_ctx.lock();
+    std::string pool_key = fmt::format("{}://{}:{}", parsedUrl.m_Scheme, parsedUrl.m_Host, port);
+    if (client_cert) {
+        pool_key += fmt::format("#{}", client_cert->handle);
+    }
+
+    std::unique_ptr<httplib::Client> client = client_pool.Acquire(pool_key);
+    if (client) {
+        LOG_DEBUG(Service_HTTP, "Reusing the client of {}", pool_key);
+    } else if (!is_ssl) {
         // TODO(B3N30): Support for setting timeout
         // Figure out what the default timeout on 3DS is
         client = std::make_unique<httplib::Client>(parsedUrl.m_Host.c_str(), port);
     } else {
-        if (!parsedUrl.GetPort(&port)) {
-            port = 443;
-        }
         // TODO(B3N30): Support for setting timeout
         // Figure out what the default timeout on 3DS is
 
@@ -77,7 +234,7 @@ void Context::MakeRequest() {
         SSL_CTX* ctx = ssl_client->ssl_context();
         client = std::move(ssl_client);
 
-        if (auto client_cert = ssl_config.client_cert_ctx.lock()) {
+        if (client_cert) {
             SSL_CTX_use_certificate_ASN1(ctx, static_cast<int>(client_cert->certificate.size()),
                                          client_cert->certificate.data());
             SSL_CTX_use_PrivateKey_ASN1(EVP_PKEY_RSA, ctx, client_cert->private_key.data(),
@@ -122,6 +279,7 @@ void Context::MakeRequest() {
         // TODO(B3N30): Verify this state on HW
         state = RequestState::ReadyToDownloadContent;
     }
+    client_pool.Release(pool_key, std::move(client));
 #else
     LOG_ERROR(Service_HTTP, "Tried to make request but WebServices is not enabled in this build");
     state = RequestState::TimedOut;
@@ -158,6 +316,125 @@ void HTTP_C::Initialize(Kernel::HLERequestContext& ctx) {
     rb.Push(RESULT_SUCCESS);
 }
 
+void HTTP_C::QueueRequest(Context& context) {
+    // On a 3DS BeginRequest and BeginRequestAsync will push the Request to a worker queue.
+    // You can only enqueue 8 requests at the same time.
+    // trying to enqueue any more will either fail (BeginRequestAsync), or block (BeginRequest)
+    // Note that you only can have 8 Contexts at a time. So this difference shouldn't matter
+    // Then there are 3? worker threads that pop the requests from the queue and send them
+    context.request_future =
+        request_workers->Push([&context, &client_pool = *client_pool] {
+            context.MakeRequest(client_pool);
+        });
+}
+
+void HTTP_C::ReceiveData(Kernel::HLERequestContext& ctx) {
+    ReceiveDataImpl(ctx, false);
+}
+
+void HTTP_C::ReceiveDataTimeout(Kernel::HLERequestContext& ctx) {
+    ReceiveDataImpl(ctx, true);
+}
+
+void HTTP_C::ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout) {
+    const u16 command_id = timeout ? 0xC : 0xB;
+    IPC::RequestParser rp(ctx, command_id, timeout ? 4 : 2, 2);
+    const Context::Handle context_handle = rp.Pop<u32>();
+    const u32 buffer_size = rp.Pop<u32>();
+    const u64 timeout_nanos = timeout ? rp.Pop<u64>() : 0;
+    Kernel::MappedBuffer buffer = rp.PopMappedBuffer();
+
+    LOG_DEBUG(Service_HTTP, "called, context_id={} buffer_size={} timeout={}", context_handle,
+              buffer_size, timeout_nanos);
+
+    auto itr = contexts.find(context_handle);
+    if (itr == contexts.end() || !itr->second.request_future.valid()) {
+        LOG_ERROR(Service_HTTP, "Tried to receive data of context {} without a request",
+                  context_handle);
+        IPC::RequestBuilder rb = rp.MakeBuilder(1, 2);
+        rb.Push(ResultCode(ErrCodes::InvalidRequestState, ErrorModule::HTTP,
+                           ErrorSummary::InvalidState, ErrorLevel::Permanent));
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+
+    if (IsRequestDone(itr->second)) {
+        WriteReceivedData(ctx, command_id, context_handle, buffer_size, buffer);
+        return;
+    }
+
+    // The emulation goes on while the request runs, the thread sleeps until the poll sees it done
+    auto callback = std::make_shared<ReceiveDataCallback>(*this, command_id, context_handle,
+                                                          buffer_size, buffer);
+    callback->id = ++next_receive_id;
+    auto event = ctx.SleepClientThread("http::ReceiveData", std::chrono::nanoseconds(timeout_nanos),
+                                       callback);
+    if (pending_receives.empty()) {
+        system.CoreTiming().ScheduleEvent(RequestPollInterval, request_poll_event);
+    }
+    pending_receives.push_back({callback->id, context_handle, std::move(event)});
+}
+
+void HTTP_C::WriteReceivedData(Kernel::HLERequestContext& ctx, u16 command_id,
+                               Context::Handle context_handle, u32 buffer_size,
+                               Kernel::MappedBuffer& buffer) {
+    IPC::RequestBuilder rb(ctx, command_id, 1, 2);
+
+    auto itr = contexts.find(context_handle);
+    if (itr == contexts.end()) {
+        rb.Push(ResultCode(ErrCodes::ContextNotFound, ErrorModule::HTTP, ErrorSummary::InvalidState,
+                           ErrorLevel::Permanent));
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+
+    Context& http_context = itr->second;
+    if (!IsRequestDone(http_context)) {
+        rb.Push(ERROR_TIMEOUT);
+        rb.PushMappedBuffer(buffer);
+        return;
+    }
+
+#ifdef ENABLE_WEB_SERVICE
+    // The body was buffered by the worker, it is handed out in the sizes the guest asks for
+    const std::string& body = http_context.response.body;
+    const std::size_t size =
+        std::min({body.size() - http_context.current_copied_data,
+                  static_cast<std::size_t>(buffer_size), buffer.GetSize()});
+    buffer.Write(body.data() + http_context.current_copied_data, 0, size);
+    http_context.current_copied_data += size;
+    rb.Push(http_context.current_copied_data == body.size() ? RESULT_SUCCESS
+                                                            : ERROR_BUFFER_TOO_SMALL);
+#else
+    rb.Push(RESULT_SUCCESS);
+#endif
+    rb.PushMappedBuffer(buffer);
+}
+
+void HTTP_C::RequestPollCallback(u64 userdata, s64 cycles_late) {
+    std::vector<std::shared_ptr<Kernel::Event>> ready;
+    pending_receives.erase(
+        std::remove_if(pending_receives.begin(), pending_receives.end(),
+                       [this, &ready](PendingReceive& receive) {
+                           const auto itr = contexts.find(receive.context_handle);
+                           if (itr != contexts.end() && !IsRequestDone(itr->second)) {
+                               return false;
+                           }
+                           ready.push_back(std::move(receive.event));
+                           return true;
+                       }),
+        pending_receives.end());
+
+    // The wakeup callbacks run right away and change the pending list, which is done by now
+    for (const auto& event : ready) {
+        event->Signal();
+    }
+
+    if (!pending_receives.empty()) {
+        system.CoreTiming().ScheduleEvent(RequestPollInterval - cycles_late, request_poll_event);
+    }
+}
+
 void HTTP_C::InitializeConnectionSession(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x8, 1, 2);
     const Context::Handle context_handle = rp.Pop<u32>();
@@ -232,15 +509,7 @@ void HTTP_C::BeginRequest(Kernel::HLERequestContext& ctx) {
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
 
-    // On a 3DS BeginRequest and BeginRequestAsync will push the Request to a worker queue.
-    // You can only enqueue 8 requests at the same time.
-    // trying to enqueue any more will either fail (BeginRequestAsync), or block (BeginRequest)
-    // Note that you only can have 8 Contexts at a time. So this difference shouldn't matter
-    // Then there are 3? worker threads that pop the requests from the queue and send them
-    // For now make every request async in it's own thread.
-
-    itr->second.request_future =
-        std::async(std::launch::async, &Context::MakeRequest, std::ref(itr->second));
+    QueueRequest(itr->second);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
@@ -285,15 +554,7 @@ void HTTP_C::BeginRequestAsync(Kernel::HLERequestContext& ctx) {
     auto itr = contexts.find(context_handle);
     ASSERT(itr != contexts.end());
 
-    // On a 3DS BeginRequest and BeginRequestAsync will push the Request to a worker queue.
-    // You can only enqueue 8 requests at the same time.
-    // trying to enqueue any more will either fail (BeginRequestAsync), or block (BeginRequest)
-    // Note that you only can have 8 Contexts at a time. So this difference shouldn't matter
-    // Then there are 3? worker threads that pop the requests from the queue and send them
-    // For now make every request async in it's own thread.
-
-    itr->second.request_future =
-        std::async(std::launch::async, &Context::MakeRequest, std::ref(itr->second));
+    QueueRequest(itr->second);
 
     IPC::RequestBuilder rb = rp.MakeBuilder(1, 0);
     rb.Push(RESULT_SUCCESS);
@@ -406,6 +667,9 @@ void HTTP_C::CloseContext(Kernel::HLERequestContext& ctx) {
     // TODO(Subv): Make sure that only the session that created the context can close it.
 
     // Note that this will block if a request is still in progress
+    if (itr->second.request_future.valid()) {
+        itr->second.request_future.wait();
+    }
     contexts.erase(itr);
     session_data->num_http_contexts--;
 
@@ -834,8 +1098,8 @@ void HTTP_C::DecryptClCertA() {
     }
     HW::AES::AESKey key = HW::AES::GetNormalKey(HW::AES::KeySlotID::SSLKey);
 
-    const RomFS::RomFSFile cert_file =
-        RomFS::GetFile(romfs_buffer.data(), {u"ctr-common-1-cert.bin"});
+    const RomFS::RomFSIndex romfs_index(romfs_buffer.data());
+    const RomFS::RomFSFile cert_file = romfs_index.GetFile({u"ctr-common-1-cert.bin"});
     if (cert_file.Length() == 0) {
         LOG_ERROR(Service_HTTP, "ctr-common-1-cert.bin missing");
         return;
@@ -856,8 +1120,7 @@ void HTTP_C::DecryptClCertA() {
     aes_cert.ProcessData(cert_data.data(), cert_file.Data() + iv_length,
                          cert_file.Length() - iv_length);
 
-    const RomFS::RomFSFile key_file =
-        RomFS::GetFile(romfs_buffer.data(), {u"ctr-common-1-key.bin"});
+    const RomFS::RomFSFile key_file = romfs_index.GetFile({u"ctr-common-1-key.bin"});
     if (key_file.Length() == 0) {
         LOG_ERROR(Service_HTTP, "ctr-common-1-key.bin missing");
         return;
@@ -882,7 +1145,9 @@ void HTTP_C::DecryptClCertA() {
     ClCertA.init = true;
 }
 
-HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
+HTTP_C::HTTP_C(Core::System& system)
+    : ServiceFramework("http:C", 32), system(system), client_pool(std::make_unique<ClientPool>()),
+      request_workers(std::make_unique<RequestWorkers>(NumRequestWorkers)) {
     static const FunctionInfo functions[] = {
         {0x00010044, &HTTP_C::Initialize, "Initialize"},
         {0x00020082, &HTTP_C::CreateContext, "CreateContext"},
@@ -894,8 +1159,8 @@ HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
         {0x00080042, &HTTP_C::InitializeConnectionSession, "InitializeConnectionSession"},
         {0x00090040, &HTTP_C::BeginRequest, "BeginRequest"},
         {0x000A0040, &HTTP_C::BeginRequestAsync, "BeginRequestAsync"},
-        {0x000B0082, nullptr, "ReceiveData"},
-        {0x000C0102, nullptr, "ReceiveDataTimeout"},
+        {0x000B0082, &HTTP_C::ReceiveData, "ReceiveData"},
+        {0x000C0102, &HTTP_C::ReceiveDataTimeout, "ReceiveDataTimeout"},
         {0x000D0146, nullptr, "SetProxy"},
         {0x000E0040, nullptr, "SetProxyDefault"},
         {0x000F00C4, nullptr, "SetBasicAuthorization"},
@@ -943,11 +1208,19 @@ HTTP_C::HTTP_C() : ServiceFramework("http:C", 32) {
     };
     RegisterHandlers(functions);
 
+    request_poll_event = system.CoreTiming().RegisterEvent(
+        "HTTP_C::RequestPollCallback",
+        [this](u64 userdata, s64 cycles_late) { RequestPollCallback(userdata, cycles_late); });
+
     DecryptClCertA();
 }
 
+HTTP_C::~HTTP_C() {
+    system.CoreTiming().UnscheduleEvent(request_poll_event, 0);
+}
+
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<HTTP_C>()->InstallAsService(service_manager);
+    std::make_shared<HTTP_C>(system)->InstallAsService(service_manager);
 }
 } // namespace Service::HTTP
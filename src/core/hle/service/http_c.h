@@ -21,10 +21,14 @@
 
 namespace Core {
 class System;
-}
+struct TimingEventType;
+} // namespace Core
 
 namespace Service::HTTP {
 
+class ClientPool;
+class RequestWorkers;
+
 enum class RequestMethod : u8 {
     None = 0x0,
     Get = 0x1,
@@ -85,7 +89,8 @@ public:
     Context(const Context&) = delete;
     Context& operator=(const Context&) = delete;
 
-    void MakeRequest();
+    /// Sends the request, with a client of the pool if one to the same host is idle
+    void MakeRequest(ClientPool& client_pool);
 
     struct Proxy {
         std::string url;
@@ -133,6 +138,8 @@ public:
     std::future<void> request_future;
     std::atomic<u64> current_download_size_bytes;
     std::atomic<u64> total_download_size_bytes;
+    /// Bytes of the response body already returned by ReceiveData
+    std::size_t current_copied_data = 0;
 #ifdef ENABLE_WEB_SERVICE
     httplib::Response response;
 #endif
@@ -157,7 +164,8 @@ struct SessionData : public Kernel::SessionRequestHandler::SessionDataBase {
 
 class HTTP_C final : public ServiceFramework<HTTP_C, SessionData> {
 public:
-    HTTP_C();
+    explicit HTTP_C(Core::System& system);
+    ~HTTP_C();
 
 private:
     /**
@@ -224,6 +232,48 @@ private:
      */
     void BeginRequestAsync(Kernel::HLERequestContext& ctx);
 
+    /**
+     * HTTP_C::ReceiveData service function
+     *  Inputs:
+     * 1 : Context handle
+     * 2 : Buffer size
+     * 3 : (OutSize<<4) | 12
+     * 4 : Output buffer
+     *  Outputs:
+     *      1 : Result of function, 0 on success, 0xD840A02B if the buffer was too small for the
+     *          rest of the body
+     *      2-3 : Output buffer descriptor
+     */
+    void ReceiveData(Kernel::HLERequestContext& ctx);
+
+    /**
+     * HTTP_C::ReceiveDataTimeout service function
+     *  Inputs:
+     * 1 : Context handle
+     * 2 : Buffer size
+     * 3-4 : Timeout in nanoseconds
+     * 5 : (OutSize<<4) | 12
+     * 6 : Output buffer
+     *  Outputs:
+     *      1 : Result of function, 0 on success, 0xD840A02B if the buffer was too small for the
+     *          rest of the body, 0xD820A069 if the request didn't finish in time
+     *      2-3 : Output buffer descriptor
+     */
+    void ReceiveDataTimeout(Kernel::HLERequestContext& ctx);
+
+    void ReceiveDataImpl(Kernel::HLERequestContext& ctx, bool timeout);
+
+    /// Writes the next part of the response body and the ReceiveData response
+    void WriteReceivedData(Kernel::HLERequestContext& ctx, u16 command_id,
+                           Context::Handle context_handle, u32 buffer_size,
+                           Kernel::MappedBuffer& buffer);
+
+    /// Queues the request of the context on the workers
+    void QueueRequest(Context& context);
+
+    /// Wakes up the threads waiting in ReceiveData for requests that finished
+    void RequestPollCallback(u64 userdata, s64 cycles_late);
+
     /**
      * HTTP_C::AddRequestHeader service function
      *  Inputs:
@@ -317,6 +367,10 @@ private:
 
     void DecryptClCertA();
 
+    class ReceiveDataCallback;
+
+    Core::System& system;
+
     std::shared_ptr<Kernel::SharedMemory> shared_memory = nullptr;
 
     /// The next number to use when a new HTTP session is initalized.
@@ -331,6 +385,23 @@ private:
     /// Global list of HTTP contexts currently opened.
     std::unordered_map<Context::Handle, Context> contexts;
 
+    /// Clients kept between the requests. Declared before the workers, which use them.
+    std::unique_ptr<ClientPool> client_pool;
+
+    /// Threads running the requests, shared by all the contexts
+    std::unique_ptr<RequestWorkers> request_workers;
+
+    /// A thread sleeping in ReceiveData until the request of its context finishes
+    struct PendingReceive {
+        u64 id;
+        Context::Handle context_handle;
+        std::shared_ptr<Kernel::Event> event;
+    };
+    std::vector<PendingReceive> pending_receives;
+    u64 next_receive_id = 0;
+
+    Core::TimingEventType* request_poll_event;
+
     /// Global list of  ClientCert contexts currently opened.
     std::unordered_map<ClientCertContext::Handle, std::shared_ptr<ClientCertContext>> client_certs;
 
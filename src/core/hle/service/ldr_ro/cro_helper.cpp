@@ -149,19 +149,36 @@ ResultCode CROHelper::ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool
     return RESULT_SUCCESS;
 }
 
+CROHelper::ExportNamedSymbolIndex CROHelper::GetExportNamedSymbolIndex() const {
+    ExportNamedSymbolIndex index;
+    index.tree = GetTable<ExportTreeEntry>(system.Memory());
+    index.symbols = GetTable<ExportNamedSymbolEntry>(system.Memory());
+    index.strings_size = GetField(ExportStringsSize);
+    return index;
+}
+
 VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
     if (!GetField(ExportTreeNum))
         return 0;
 
+    return FindExportNamedSymbol(GetExportNamedSymbolIndex(), name);
+}
+
+VAddr CROHelper::FindExportNamedSymbol(const ExportNamedSymbolIndex& index,
+                                       const std::string& name) const {
+    if (index.tree.empty())
+        return 0;
+
     std::size_t len = name.size();
-    ExportTreeEntry entry;
-    GetEntry(system.Memory(), 0, entry);
     ExportTreeEntry::Child next;
-    next.raw = entry.left.raw;
+    next.raw = index.tree[0].left.raw;
     u32 found_id;
 
     while (true) {
-        GetEntry(system.Memory(), next.next_index, entry);
+        // The indices were verified when the module was loaded
+        if (next.next_index >= index.tree.size())
+            return 0;
+        const ExportTreeEntry& entry = index.tree[next.next_index];
 
         if (next.is_end) {
             found_id = entry.export_table_index;
@@ -180,16 +197,11 @@ VAddr CROHelper::FindExportNamedSymbol(const std::string& name) const {
         }
     }
 
-    u32 export_named_symbol_num = GetField(ExportNamedSymbolNum);
-
-    if (found_id >= export_named_symbol_num)
+    if (found_id >= index.symbols.size())
         return 0;
 
-    u32 export_strings_size = GetField(ExportStringsSize);
-    ExportNamedSymbolEntry symbol_entry;
-    GetEntry(system.Memory(), found_id, symbol_entry);
-
-    if (system.Memory().ReadCString(symbol_entry.name_offset, export_strings_size) != name)
+    const ExportNamedSymbolEntry& symbol_entry = index.symbols[found_id];
+    if (system.Memory().ReadCString(symbol_entry.name_offset, index.strings_size) != name)
         return 0;
 
     return SegmentTagToAddress(symbol_entry.symbol_position);
@@ -748,45 +760,60 @@ void CROHelper::UnrebaseHeader() {
 }
 
 ResultCode CROHelper::ApplyImportNamedSymbol(VAddr crs_address) {
+    struct UnresolvedImport {
+        VAddr relocation_addr;
+        std::string symbol_name;
+        bool resolved;
+    };
+
     u32 import_strings_size = GetField(ImportStringsSize);
-    u32 symbol_import_num = GetField(ImportNamedSymbolNum);
-    for (u32 i = 0; i < symbol_import_num; ++i) {
-        ImportNamedSymbolEntry entry;
-        GetEntry(system.Memory(), i, entry);
+    std::vector<UnresolvedImport> imports;
+    for (const ImportNamedSymbolEntry& entry : GetTable<ImportNamedSymbolEntry>(system.Memory())) {
         VAddr relocation_addr = entry.relocation_batch_offset;
         ExternalRelocationEntry relocation_entry;
         system.Memory().ReadBlock(process, relocation_addr, &relocation_entry,
                                   sizeof(ExternalRelocationEntry));
 
         if (!relocation_entry.is_batch_resolved) {
-            ResultCode result = ForEachAutoLinkCRO(
-                process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
-                    std::string symbol_name =
-                        system.Memory().ReadCString(entry.name_offset, import_strings_size);
-                    u32 symbol_address = source.FindExportNamedSymbol(symbol_name);
+            imports.push_back({relocation_addr,
+                               system.Memory().ReadCString(entry.name_offset, import_strings_size),
+                               false});
+        }
+    }
 
-                    if (symbol_address != 0) {
-                        LOG_TRACE(Service_LDR, "CRO \"{}\" imports \"{}\" from \"{}\"",
-                                  ModuleName(), symbol_name, source.ModuleName());
+    // Each module is searched for all the imports left, with its export tables read once. The
+    // first module exporting a symbol still wins.
+    std::size_t num_unresolved = imports.size();
+    return ForEachAutoLinkCRO(
+        process, system, crs_address, [&](CROHelper source) -> ResultVal<bool> {
+            if (num_unresolved == 0) {
+                return MakeResult<bool>(false);
+            }
 
-                        ResultCode result = ApplyRelocationBatch(relocation_addr, symbol_address);
-                        if (result.IsError()) {
-                            LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}",
-                                      result.raw);
-                            return result;
-                        }
+            const ExportNamedSymbolIndex index = source.GetExportNamedSymbolIndex();
+            for (UnresolvedImport& import : imports) {
+                if (import.resolved) {
+                    continue;
+                }
+                u32 symbol_address = source.FindExportNamedSymbol(index, import.symbol_name);
+                if (symbol_address == 0) {
+                    continue;
+                }
 
-                        return MakeResult<bool>(false);
-                    }
+                LOG_TRACE(Service_LDR, "CRO \"{}\" imports \"{}\" from \"{}\"", ModuleName(),
+                          import.symbol_name, source.ModuleName());
 
-                    return MakeResult<bool>(true);
-                });
-            if (result.IsError()) {
-                return result;
+                ResultCode result = ApplyRelocationBatch(import.relocation_addr, symbol_address);
+                if (result.IsError()) {
+                    LOG_ERROR(Service_LDR, "Error applying relocation batch {:08X}", result.raw);
+                    return result;
+                }
+                import.resolved = true;
+                --num_unresolved;
             }
-        }
-    }
-    return RESULT_SUCCESS;
+
+            return MakeResult<bool>(num_unresolved != 0);
+        });
 }
 
 ResultCode CROHelper::ResetImportNamedSymbol() {
@@ -912,10 +939,9 @@ ResultCode CROHelper::ApplyExportNamedSymbol(CROHelper& target) {
     LOG_DEBUG(Service_LDR, "CRO \"{}\" exports named symbols to \"{}\"", ModuleName(),
               target.ModuleName());
     u32 target_import_strings_size = target.GetField(ImportStringsSize);
-    u32 target_symbol_import_num = target.GetField(ImportNamedSymbolNum);
-    for (u32 i = 0; i < target_symbol_import_num; ++i) {
-        ImportNamedSymbolEntry entry;
-        target.GetEntry(system.Memory(), i, entry);
+    const ExportNamedSymbolIndex index = GetExportNamedSymbolIndex();
+    for (const ImportNamedSymbolEntry& entry :
+         target.GetTable<ImportNamedSymbolEntry>(system.Memory())) {
         VAddr relocation_addr = entry.relocation_batch_offset;
         ExternalRelocationEntry relocation_entry;
         system.Memory().ReadBlock(process, relocation_addr, &relocation_entry,
@@ -924,7 +950,7 @@ ResultCode CROHelper::ApplyExportNamedSymbol(CROHelper& target) {
         if (!relocation_entry.is_batch_resolved) {
             std::string symbol_name =
                 system.Memory().ReadCString(entry.name_offset, target_import_strings_size);
-            u32 symbol_address = FindExportNamedSymbol(symbol_name);
+            u32 symbol_address = FindExportNamedSymbol(index, symbol_name);
             if (symbol_address != 0) {
                 LOG_TRACE(Service_LDR, "    exports symbol \"{}\"", symbol_name);
                 ResultCode result = target.ApplyRelocationBatch(relocation_addr, symbol_address);
@@ -943,10 +969,9 @@ ResultCode CROHelper::ResetExportNamedSymbol(CROHelper& target) {
               target.ModuleName());
     u32 unresolved_symbol = target.GetOnUnresolvedAddress();
     u32 target_import_strings_size = target.GetField(ImportStringsSize);
-    u32 target_symbol_import_num = target.GetField(ImportNamedSymbolNum);
-    for (u32 i = 0; i < target_symbol_import_num; ++i) {
-        ImportNamedSymbolEntry entry;
-        target.GetEntry(system.Memory(), i, entry);
+    const ExportNamedSymbolIndex index = GetExportNamedSymbolIndex();
+    for (const ImportNamedSymbolEntry& entry :
+         target.GetTable<ImportNamedSymbolEntry>(system.Memory())) {
         VAddr relocation_addr = entry.relocation_batch_offset;
         ExternalRelocationEntry relocation_entry;
         system.Memory().ReadBlock(process, relocation_addr, &relocation_entry,
@@ -955,7 +980,7 @@ ResultCode CROHelper::ResetExportNamedSymbol(CROHelper& target) {
         if (relocation_entry.is_batch_resolved) {
             std::string symbol_name =
                 system.Memory().ReadCString(entry.name_offset, target_import_strings_size);
-            u32 symbol_address = FindExportNamedSymbol(symbol_name);
+            u32 symbol_address = FindExportNamedSymbol(index, symbol_name);
             if (symbol_address != 0) {
                 LOG_TRACE(Service_LDR, "    unexports symbol \"{}\"", symbol_name);
                 ResultCode result =
@@ -1309,6 +1334,13 @@ ResultCode CROHelper::Link(VAddr crs_address, bool link_on_load_bug_fix) {
     // Exports symbols to other modules
     result = ForEachAutoLinkCRO(process, system, crs_address,
                                 [this](CROHelper target) -> ResultVal<bool> {
+                                    SCOPE_EXIT({
+                                        // The target writes its relocations through its own copy
+                                        invalidate_cache_ranges.insert(
+                                            invalidate_cache_ranges.end(),
+                                            target.invalidate_cache_ranges.begin(),
+                                            target.invalidate_cache_ranges.end());
+                                    });
                                     ResultCode result = ApplyExportNamedSymbol(target);
                                     if (result.IsError())
                                         return result;
@@ -1354,6 +1386,13 @@ ResultCode CROHelper::Unlink(VAddr crs_address) {
     // Note: the RO service seems only searching in auto-link modules
     result = ForEachAutoLinkCRO(process, system, crs_address,
                                 [this](CROHelper target) -> ResultVal<bool> {
+                                    SCOPE_EXIT({
+                                        // The target writes its relocations through its own copy
+                                        invalidate_cache_ranges.insert(
+                                            invalidate_cache_ranges.end(),
+                                            target.invalidate_cache_ranges.begin(),
+                                            target.invalidate_cache_ranges.end());
+                                    });
                                     ResultCode result = ResetExportNamedSymbol(target);
                                     if (result.IsError())
                                         return result;
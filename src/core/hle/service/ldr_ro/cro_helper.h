@@ -5,7 +5,9 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include <tuple>
+#include <vector>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/hle/result.h"
@@ -439,6 +441,19 @@ private:
                           &data, sizeof(T));
     }
 
+    /**
+     * Reads a whole table of the module with a single block read.
+     * @note the entry type must have the static member TABLE_OFFSET_FIELD
+     *       indicating which table to read. The entry count follows it in the header.
+     */
+    template <typename T>
+    std::vector<T> GetTable(Memory::MemorySystem& memory) const {
+        std::vector<T> table(GetField(static_cast<HeaderField>(T::TABLE_OFFSET_FIELD + 1)));
+        memory.ReadBlock(process, GetField(T::TABLE_OFFSET_FIELD), table.data(),
+                         table.size() * sizeof(T));
+        return table;
+    }
+
     /**
      * Converts a segment tag to virtual address in this module.
      * @param segment_tag the segment tag to convert
@@ -519,6 +534,19 @@ private:
      */
     ResultCode ApplyRelocationBatch(VAddr batch, u32 symbol_address, bool reset = false);
 
+    /**
+     * Copy of the tables an exported named symbol lookup walks, so that looking up many names in
+     * the same module doesn't read guest memory for every node of the export tree.
+     */
+    struct ExportNamedSymbolIndex {
+        std::vector<ExportTreeEntry> tree;
+        std::vector<ExportNamedSymbolEntry> symbols;
+        u32 strings_size = 0;
+    };
+
+    /// Reads the export tree and the exported named symbol tables of this module in bulk.
+    ExportNamedSymbolIndex GetExportNamedSymbolIndex() const;
+
     /**
      * Finds an exported named symbol in this module.
      * @param name the name of the symbol to find
@@ -526,6 +554,15 @@ private:
      */
     VAddr FindExportNamedSymbol(const std::string& name) const;
 
+    /**
+     * Finds an exported named symbol in this module through a copy of its tables.
+     * @param index the tables of this module, from GetExportNamedSymbolIndex
+     * @param name the name of the symbol to find
+     * @return VAddr the virtual address of the symbol; 0 if not found.
+     */
+    VAddr FindExportNamedSymbol(const ExportNamedSymbolIndex& index,
+                                const std::string& name) const;
+
     /**
      * Rebases offsets in module header according to module address.
      * @param cro_size the size of the CRO file
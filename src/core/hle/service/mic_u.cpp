@@ -65,25 +65,30 @@ struct State {
     u8 sample_size = 0;
     SampleRate sample_rate = SampleRate::Rate16360;
 
-    void WriteSamples(const std::vector<u8>& samples) {
-        u32 bytes_total_written = 0;
-        const std::size_t remaining_space = size - offset;
-        std::size_t bytes_to_write = std::min(samples.size(), remaining_space);
-
-        // Write as many samples as we can to the buffer.
-        // TODO if the sample size is 16bit, this could theoretically cut a sample in the case where
-        // the application configures an odd size
-        std::memcpy(sharedmem_buffer + offset, samples.data(), bytes_to_write);
-        offset += static_cast<u32>(bytes_to_write);
-        bytes_total_written += static_cast<u32>(bytes_to_write);
-
-        // If theres any samples left to write after we looped, go ahead and write them now
-        if (looped_buffer && samples.size() > bytes_total_written) {
-            offset = initial_offset;
-            bytes_to_write = std::min(samples.size() - bytes_total_written, size);
-            std::memcpy(sharedmem_buffer + offset, samples.data() + bytes_total_written,
-                        bytes_to_write);
-            offset += static_cast<u32>(bytes_to_write);
+    /// Reads the samples of the mic straight into the buffer, up to its end and then from its
+    /// start again if it loops
+    void WriteSamples(Frontend::Mic::Interface& mic) {
+        bool written = false;
+        while (true) {
+            if (offset >= size) {
+                // The samples are kept by the mic until the buffer loops
+                if (!looped_buffer || initial_offset >= size) {
+                    break;
+                }
+                offset = initial_offset;
+            }
+            // TODO if the sample size is 16bit, this could theoretically cut a sample in the case
+            // where the application configures an odd size
+            const std::size_t space = size - offset;
+            const std::size_t bytes_read = mic.Read(sharedmem_buffer + offset, space);
+            offset += static_cast<u32>(bytes_read);
+            written |= bytes_read != 0;
+            if (bytes_read < space) {
+                break;
+            }
+        }
+        if (!written) {
+            return;
         }
 
         // The last 4 bytes of the shared memory contains the latest offset
@@ -139,10 +144,9 @@ struct MIC_U::Impl {
             return;
         }
 
-        Frontend::Mic::Samples samples = mic->Read();
-        if (!samples.empty()) {
+        if (state.sharedmem_buffer) {
             // write the samples to sharedmem page
-            state.WriteSamples(samples);
+            state.WriteSamples(*mic);
         }
 
         // schedule next run
@@ -40,6 +40,24 @@ constexpr u16 BroadcastNetworkNodeId = 0xFFFF;
 // The Host has always dest_node_id 1
 constexpr u16 HostDestNodeId = 1;
 
+// Interval at which the frames received by the network thread are handled.
+constexpr s64 ReceivePollInterval = usToCycles(500);
+
+// Number of data frames pulled between two latency reports.
+constexpr u64 LatencyReportFrames = 1000;
+
+static u64 ToMicroseconds(std::chrono::steady_clock::duration duration) {
+    using std::chrono::microseconds;
+    return static_cast<u64>(std::chrono::duration_cast<microseconds>(duration).count());
+}
+
+void NWM_UDS::FrameLatency::Record(std::chrono::steady_clock::time_point received_time) {
+    const auto latency = std::chrono::steady_clock::now() - received_time;
+    ++frames;
+    total += latency;
+    max = std::max(max, latency);
+}
+
 std::list<Network::WifiPacket> NWM_UDS::GetReceivedBeacons(const MacAddress& sender,
                                                            u32 wlan_comm_id) {
     std::lock_guard lock(beacon_mutex);
@@ -313,7 +331,8 @@ void NWM_UDS::HandleEAPoLPacket(const Network::WifiPacket& packet) {
     }
 }
 
-void NWM_UDS::HandleSecureDataPacket(const Network::WifiPacket& packet) {
+void NWM_UDS::HandleSecureDataPacket(ReceivedFrame& frame) {
+    const Network::WifiPacket& packet = frame.packet;
     auto secure_data = ParseSecureDataHeader(packet.data);
     std::unique_lock hle_lock(HLE::g_hle_lock, std::defer_lock);
     std::unique_lock lock(connection_status_mutex, std::defer_lock);
@@ -346,9 +365,8 @@ void NWM_UDS::HandleSecureDataPacket(const Network::WifiPacket& packet) {
             // Broadcast the packet so the right receiver can get it.
             // TODO(B3N30): Is there a flag that makes this kind of routing be unicast instead of
             // multicast? Perhaps this is a way to allow spectators to see some of the packets.
-            Network::WifiPacket out_packet = packet;
-            out_packet.destination_address = Network::BroadcastMac;
-            SendPacket(out_packet);
+            frame.packet.destination_address = Network::BroadcastMac;
+            SendPacket(frame.packet);
         }
         return;
     }
@@ -368,7 +386,7 @@ void NWM_UDS::HandleSecureDataPacket(const Network::WifiPacket& packet) {
         return;
 
     // Add the received packet to the data queue.
-    channel_info->second.received_packets.emplace_back(packet.data);
+    channel_info->second.received_frames.emplace_back(std::move(frame));
 
     // Signal the data event. We can do this directly because we locked g_hle_lock
     channel_info->second.event->Signal();
@@ -496,22 +514,47 @@ void NWM_UDS::HandleDeauthenticationFrame(const Network::WifiPacket& packet) {
     connection_status_event->Signal();
 }
 
-void NWM_UDS::HandleDataFrame(const Network::WifiPacket& packet) {
-    switch (GetFrameEtherType(packet.data)) {
+void NWM_UDS::HandleDataFrame(ReceivedFrame& frame) {
+    switch (GetFrameEtherType(frame.packet.data)) {
     case EtherType::EAPoL:
-        HandleEAPoLPacket(packet);
+        HandleEAPoLPacket(frame.packet);
         break;
     case EtherType::SecureData:
-        HandleSecureDataPacket(packet);
+        HandleSecureDataPacket(frame);
         break;
     }
 }
 
-/// Callback to parse and handle a received wifi packet.
+/// Callback to queue a received wifi packet, called from the network thread.
 void NWM_UDS::OnWifiPacketReceived(const Network::WifiPacket& packet) {
     if (!initialized) {
         return;
     }
+    received_frames.Push(ReceivedFrame{packet, std::chrono::steady_clock::now()});
+}
+
+void NWM_UDS::DispatchReceivedFrames() {
+    ReceivedFrame frame;
+    while (received_frames.Pop(frame)) {
+        // Frames still queued on shutdown are dropped
+        if (!initialized) {
+            continue;
+        }
+        dispatch_latency.Record(frame.received_time);
+        HandleFrame(frame);
+    }
+}
+
+void NWM_UDS::ReceivePollCallback(u64 userdata, s64 cycles_late) {
+    DispatchReceivedFrames();
+    if (initialized) {
+        system.CoreTiming().ScheduleEvent(ReceivePollInterval - cycles_late, receive_poll_event,
+                                          0);
+    }
+}
+
+void NWM_UDS::HandleFrame(ReceivedFrame& frame) {
+    const Network::WifiPacket& packet = frame.packet;
     switch (packet.type) {
     case Network::WifiPacket::PacketType::Beacon:
         HandleBeaconFrame(packet);
@@ -523,7 +566,7 @@ void NWM_UDS::OnWifiPacketReceived(const Network::WifiPacket& packet) {
         HandleAssociationResponseFrame(packet);
         break;
     case Network::WifiPacket::PacketType::Data:
-        HandleDataFrame(packet);
+        HandleDataFrame(frame);
         break;
     case Network::WifiPacket::PacketType::Deauthentication:
         HandleDeauthenticationFrame(packet);
@@ -558,6 +601,8 @@ void NWM_UDS::Shutdown(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x03, 0, 0);
 
     initialized = false;
+    system.CoreTiming().UnscheduleEvent(receive_poll_event, 0);
+    DispatchReceivedFrames();
 
     for (auto& bind_node : channel_data) {
         bind_node.second.event->Signal();
@@ -645,6 +690,9 @@ ResultVal<std::shared_ptr<Kernel::Event>> NWM_UDS::Initialize(
     current_node = node;
     initialized = true;
 
+    system.CoreTiming().UnscheduleEvent(receive_poll_event, 0);
+    system.CoreTiming().ScheduleEvent(ReceivePollInterval, receive_poll_event, 0);
+
     recv_buffer_memory = std::move(sharedmem);
     ASSERT_MSG(recv_buffer_memory->GetSize() == sharedmem_size, "Invalid shared memory size.");
 
@@ -1182,7 +1230,10 @@ void NWM_UDS::PullPacket(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    if (channel->second.received_packets.empty()) {
+    // Frames that arrived since the last poll are delivered right away
+    DispatchReceivedFrames();
+
+    if (channel->second.received_frames.empty()) {
         std::vector<u8> output_buffer(buff_size);
         IPC::RequestBuilder rb = rp.MakeBuilder(3, 2);
         rb.Push(RESULT_SUCCESS);
@@ -1192,7 +1243,8 @@ void NWM_UDS::PullPacket(Kernel::HLERequestContext& ctx) {
         return;
     }
 
-    const auto& next_packet = channel->second.received_packets.front();
+    const ReceivedFrame& next_frame = channel->second.received_frames.front();
+    const auto& next_packet = next_frame.packet.data;
 
     auto secure_data = ParseSecureDataHeader(next_packet);
     auto data_size = secure_data.GetActualDataSize();
@@ -1216,7 +1268,21 @@ void NWM_UDS::PullPacket(Kernel::HLERequestContext& ctx) {
     rb.Push<u16>(secure_data.src_node_id);
     rb.PushStaticBuffer(std::move(output_buffer), 0);
 
-    channel->second.received_packets.pop_front();
+    pull_latency.Record(next_frame.received_time);
+    if (pull_latency.frames == LatencyReportFrames) {
+        LOG_DEBUG(Service_NWM,
+                  "Latency of the last {} data frames: queued avg={}us max={}us, "
+                  "pulled avg={}us max={}us",
+                  pull_latency.frames,
+                  ToMicroseconds(dispatch_latency.total / dispatch_latency.frames),
+                  ToMicroseconds(dispatch_latency.max),
+                  ToMicroseconds(pull_latency.total / pull_latency.frames),
+                  ToMicroseconds(pull_latency.max));
+        dispatch_latency.Reset();
+        pull_latency.Reset();
+    }
+
+    channel->second.received_frames.pop_front();
 }
 
 void NWM_UDS::GetChannel(Kernel::HLERequestContext& ctx) {
@@ -1404,21 +1470,31 @@ void NWM_UDS::BeaconBroadcastCallback(u64 userdata, s64 cycles_late) {
     if (connection_status.status != static_cast<u32>(NetworkStatus::ConnectedAsHost))
         return;
 
-    std::vector<u8> frame = GenerateBeaconFrame(network_info, node_info);
+    // The tags are encrypted, so the frame is only generated again when the network changed
+    if (beacon_frame.empty() ||
+        std::memcmp(&beacon_network_info, &network_info, sizeof(NetworkInfo)) != 0 ||
+        beacon_node_info.size() != node_info.size() ||
+        std::memcmp(beacon_node_info.data(), node_info.data(),
+                    node_info.size() * sizeof(NodeInfo)) != 0) {
+        beacon_frame = GenerateBeaconFrame(network_info, node_info);
+        beacon_network_info = network_info;
+        beacon_node_info = node_info;
+    }
 
     using Network::WifiPacket;
     WifiPacket packet;
     packet.type = WifiPacket::PacketType::Beacon;
-    packet.data = std::move(frame);
+    packet.data = beacon_frame;
     packet.destination_address = Network::BroadcastMac;
     packet.channel = network_channel;
 
     SendPacket(packet);
 
-    // Start broadcasting the network, send a beacon frame every 102.4ms.
-    system.CoreTiming().ScheduleEvent(msToCycles(DefaultBeaconInterval * MillisecondsPerTU) -
-                                          cycles_late,
-                                      beacon_broadcast_event, 0);
+    // Send a beacon frame every 102.4ms. The beacons missed while the emulation was behind are
+    // coalesced into this one instead of being sent in a burst.
+    const s64 interval = msToCycles(DefaultBeaconInterval * MillisecondsPerTU);
+    system.CoreTiming().ScheduleEvent(interval - cycles_late % interval, beacon_broadcast_event,
+                                      0);
 }
 
 NWM_UDS::NWM_UDS(Core::System& system) : ServiceFramework("nwm::UDS"), system(system) {
@@ -1461,6 +1537,9 @@ NWM_UDS::NWM_UDS(Core::System& system) : ServiceFramework("nwm::UDS"), system(sy
     beacon_broadcast_event = system.CoreTiming().RegisterEvent(
         "UDS::BeaconBroadcastCallback",
         [this](u64 userdata, s64 cycles_late) { BeaconBroadcastCallback(userdata, cycles_late); });
+    receive_poll_event = system.CoreTiming().RegisterEvent(
+        "UDS::ReceivePollCallback",
+        [this](u64 userdata, s64 cycles_late) { ReceivePollCallback(userdata, cycles_late); });
 
     CryptoPP::AutoSeededRandomPool rng;
     auto mac = SharedPage::DefaultMac;
@@ -1489,6 +1568,7 @@ NWM_UDS::~NWM_UDS() {
         room_member->Unbind(wifi_packet_received);
 
     system.CoreTiming().UnscheduleEvent(beacon_broadcast_event, 0);
+    system.CoreTiming().UnscheduleEvent(receive_poll_event, 0);
 }
 
 } // namespace Service::NWM
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <deque>
 #include <list>
@@ -17,6 +18,7 @@
 #include <boost/optional.hpp>
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "common/threadsafe_queue.h"
 #include "core/hle/service/service.h"
 #include "network/network.h"
 
@@ -435,6 +437,24 @@ private:
     template <u16 command_id>
     void DecryptBeaconData(Kernel::HLERequestContext& ctx);
 
+    /// A received wifi packet and the time the network thread got it
+    struct ReceivedFrame {
+        Network::WifiPacket packet;
+        std::chrono::steady_clock::time_point received_time;
+    };
+
+    /// Latency statistics of the received frames
+    struct FrameLatency {
+        u64 frames = 0;
+        std::chrono::steady_clock::duration total{};
+        std::chrono::steady_clock::duration max{};
+
+        void Record(std::chrono::steady_clock::time_point received_time);
+        void Reset() {
+            *this = {};
+        }
+    };
+
     ResultVal<std::shared_ptr<Kernel::Event>> Initialize(
         u32 sharedmem_size, const NodeInfo& node, u16 version,
         std::shared_ptr<Kernel::SharedMemory> sharedmem);
@@ -448,6 +468,10 @@ private:
 
     void BeaconBroadcastCallback(u64 userdata, s64 cycles_late);
 
+    /// Handles on the emulation thread the frames queued by the network thread
+    void ReceivePollCallback(u64 userdata, s64 cycles_late);
+    void DispatchReceivedFrames();
+
     /**
      * Returns a list of received 802.11 beacon frames from the specified sender and with the
      * specified wlan_comm_id since the last call.
@@ -465,7 +489,7 @@ private:
     void HandleBeaconFrame(const Network::WifiPacket& packet);
     void HandleAssociationResponseFrame(const Network::WifiPacket& packet);
     void HandleEAPoLPacket(const Network::WifiPacket& packet);
-    void HandleSecureDataPacket(const Network::WifiPacket& packet);
+    void HandleSecureDataPacket(ReceivedFrame& frame);
 
     /*
      * Start a connection sequence with an UDS server. The sequence starts by sending an 802.11
@@ -488,11 +512,14 @@ private:
     /// Handles the deauthentication frames sent from clients to hosts, when they leave a session
     void HandleDeauthenticationFrame(const Network::WifiPacket& packet);
 
-    void HandleDataFrame(const Network::WifiPacket& packet);
+    void HandleDataFrame(ReceivedFrame& frame);
 
-    /// Callback to parse and handle a received wifi packet.
+    /// Callback to queue a received wifi packet, called from the network thread.
     void OnWifiPacketReceived(const Network::WifiPacket& packet);
 
+    /// Parses and handles a received wifi packet.
+    void HandleFrame(ReceivedFrame& frame);
+
     boost::optional<Network::MacAddress> GetNodeMacAddress(u16 dest_node_id, u8 flags);
 
     // Event that is signaled every time the connection status changes.
@@ -522,8 +549,8 @@ private:
         u8 channel;          ///< Channel that this bind node was bound to.
         u16 network_node_id; ///< Node id this bind node is associated with, only packets from this
                              /// network node will be received.
-        std::shared_ptr<Kernel::Event> event;         ///< Receive event for this bind node.
-        std::deque<std::vector<u8>> received_packets; ///< List of packets received on this channel.
+        std::shared_ptr<Kernel::Event> event;     ///< Receive event for this bind node.
+        std::deque<ReceivedFrame> received_frames; ///< List of frames received on this channel.
     };
 
     // Mapping of data channels to their internal data.
@@ -547,6 +574,23 @@ private:
     // Event that will generate and send the 802.11 beacon frames.
     Core::TimingEventType* beacon_broadcast_event;
 
+    // Event that hands the received frames over to the emulation thread.
+    Core::TimingEventType* receive_poll_event;
+
+    // Frames received by the network thread, the only producer, waiting for the emulation thread.
+    // The network thread never blocks on the HLE lock this way.
+    Common::SPSCQueue<ReceivedFrame> received_frames;
+
+    // Time the frames spent in the queue and, for the data frames, until the application pulled
+    // them. Logged every LatencyReportFrames data frames.
+    FrameLatency dispatch_latency;
+    FrameLatency pull_latency;
+
+    // Last beacon frame sent and the network it was generated from.
+    std::vector<u8> beacon_frame;
+    NetworkInfo beacon_network_info{};
+    NodeList beacon_node_info;
+
     // Callback identifier for the OnWifiPacketReceived event.
     Network::RoomMember::CallbackHandle<Network::WifiPacket> wifi_packet_received;
 
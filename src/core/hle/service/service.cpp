@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <fmt/format.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
 #include "core/core.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
@@ -128,11 +130,39 @@ ServiceFrameworkBase::ServiceFrameworkBase(const char* service_name, u32 max_ses
 ServiceFrameworkBase::~ServiceFrameworkBase() = default;
 
 void ServiceFrameworkBase::InstallAsService(SM::ServiceManager& service_manager) {
+    if (service_manager.IsInstallingFastPaths()) {
+        const auto fast_path_headers = Settings::values.lle_fast_paths.find(service_name);
+        if (fast_path_headers == Settings::values.lle_fast_paths.end()) {
+            return;
+        }
+
+        auto fast_path = std::make_shared<Kernel::FastPathHandler>();
+        fast_path->handler = shared_from_this();
+        for (u32 header : fast_path_headers->second) {
+            const auto itr = handlers.find(header);
+            if (itr == handlers.end() || itr->second.handler_callback == nullptr) {
+                LOG_WARNING(Service, "{} has no HLE implementation of {:#010x}, it stays LLE",
+                            service_name, header);
+                continue;
+            }
+            LOG_INFO(Service, "{} is served by HLE for the LLE module", itr->second.name);
+            fast_path->headers.push_back(header);
+        }
+        if (!fast_path->headers.empty()) {
+            service_manager.AddFastPath(service_name, std::move(fast_path));
+        }
+        return;
+    }
+
     auto port = service_manager.RegisterService(service_name, max_sessions).Unwrap();
     port->SetHleHandler(shared_from_this());
 }
 
 void ServiceFrameworkBase::InstallAsNamedPort(Kernel::KernelSystem& kernel) {
+    // Named ports are not reached through srv, the LLE module keeps all of their commands
+    if (Core::System::GetInstance().ServiceManager().IsInstallingFastPaths()) {
+        return;
+    }
     auto [server_port, client_port] = kernel.CreatePortPair(max_sessions, service_name);
     server_port->SetHleHandler(shared_from_this());
     kernel.AddNamedPort(service_name, std::move(client_port));
@@ -167,7 +197,10 @@ void ServiceFrameworkBase::ReportUnimplementedFunction(u32* cmd_buf, const Funct
     cmd_buf[1] = 0;
 }
 
+MICROPROFILE_DEFINE(Service_HandleSyncRequest, "Service", "Handle Request", MP_RGB(70, 200, 140));
+
 void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context) {
+    MICROPROFILE_SCOPE(Service_HandleSyncRequest);
     u32 header_code = context.CommandBuffer()[0];
     auto itr = handlers.find(header_code);
     const FunctionInfoBase* info = itr == handlers.end() ? nullptr : &itr->second;
@@ -215,8 +248,22 @@ void Init(Core::System& core) {
     SM::ServiceManager::InstallInterfaces(core);
 
     for (const auto& service_module : service_module_map) {
-        if (!AttemptLLE(service_module) && service_module.init_function != nullptr)
+        if (AttemptLLE(service_module)) {
+            // The HLE implementation stays around to answer the fast path commands of the module
+            if (!Settings::values.lle_fast_paths.empty() &&
+                service_module.init_function != nullptr) {
+                core.ServiceManager().SetInstallingFastPaths(true);
+                service_module.init_function(core);
+                core.ServiceManager().SetInstallingFastPaths(false);
+            }
+        } else if (service_module.init_function != nullptr) {
+            const auto start = std::chrono::steady_clock::now();
             service_module.init_function(core);
+            LOG_DEBUG(Service, "{} started in {} us", service_module.name,
+                      std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count());
+        }
     }
     LOG_DEBUG(Service, "initialized OK");
 }
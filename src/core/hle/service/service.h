@@ -58,6 +58,7 @@ public:
     }
 
     /// Creates a port pair and registers this service with the given ServiceManager.
+    /// While the ServiceManager installs fast paths, the configured commands become one instead.
     void InstallAsService(SM::ServiceManager& service_manager);
     /// Creates a port pair and registers it on the kernel's global port registry.
     void InstallAsNamedPort(Kernel::KernelSystem& kernel);
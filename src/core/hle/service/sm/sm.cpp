@@ -41,6 +41,9 @@ ResultVal<std::shared_ptr<Kernel::ServerPort>> ServiceManager::RegisterService(
         return ERR_ALREADY_REGISTERED;
 
     auto [server_port, client_port] = system.Kernel().CreatePortPair(max_sessions, name);
+    if (const auto fast_path = fast_paths.find(name); fast_path != fast_paths.end()) {
+        server_port->fast_path = fast_path->second;
+    }
 
     registered_services_inverse.emplace(client_port->GetObjectId(), name);
     registered_services.emplace(std::move(name), std::move(client_port));
@@ -66,6 +69,11 @@ ResultVal<std::shared_ptr<Kernel::ClientSession>> ServiceManager::ConnectToServi
     return client_port->Connect();
 }
 
+void ServiceManager::AddFastPath(const std::string& name,
+                                 std::shared_ptr<Kernel::FastPathHandler> fast_path) {
+    fast_paths[name] = std::move(fast_path);
+}
+
 std::string ServiceManager::GetServiceNameByPortId(u32 port) const {
     if (registered_services_inverse.count(port)) {
         return registered_services_inverse.at(port);
@@ -54,6 +54,21 @@ public:
     // For IPC Recorder
     std::string GetServiceNameByPortId(u32 port) const;
 
+    /**
+     * While set, InstallAsService keeps the HLE handlers aside as fast paths instead of registering
+     * the services, which the LLE module of the same services registers later.
+     */
+    void SetInstallingFastPaths(bool installing) {
+        installing_fast_paths = installing;
+    }
+
+    bool IsInstallingFastPaths() const {
+        return installing_fast_paths;
+    }
+
+    /// Attaches the fast path to the service when the LLE module registers it
+    void AddFastPath(const std::string& name, std::shared_ptr<Kernel::FastPathHandler> fast_path);
+
     template <typename T>
     std::shared_ptr<T> GetService(const std::string& service_name) const {
         static_assert(std::is_base_of_v<Kernel::SessionRequestHandler, T>,
@@ -67,6 +82,10 @@ public:
         if (port == nullptr) {
             return nullptr;
         }
+        // The HLE side of a hybrid service is still there for the emulator to query
+        if (port->hle_handler == nullptr && port->fast_path != nullptr) {
+            return std::static_pointer_cast<T>(port->fast_path->handler);
+        }
         return std::static_pointer_cast<T>(port->hle_handler);
     }
 
@@ -80,6 +99,10 @@ private:
     // For IPC Recorder
     /// client port Object id -> service name
     std::unordered_map<u32, std::string> registered_services_inverse;
+
+    /// Fast paths of the services LLE modules are going to register
+    std::unordered_map<std::string, std::shared_ptr<Kernel::FastPathHandler>> fast_paths;
+    bool installing_fast_paths = false;
 };
 
 } // namespace Service::SM
@@ -3,7 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -11,8 +15,12 @@
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "common/swap.h"
+#include "common/thread.h"
+#include "common/threadsafe_queue.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/hle/ipc_helpers.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
 #include "core/hle/service/soc_u.h"
@@ -31,6 +39,7 @@
 #define ETIME 137
 #endif // _MSC_VER
 #else
+#include <arpa/inet.h>
 #include <cerrno>
 #include <fcntl.h>
 #include <netdb.h>
@@ -350,6 +359,248 @@ struct CTRAddrInfo {
 
 static_assert(sizeof(CTRAddrInfo) == 0x130, "Size of CTRAddrInfo is not correct");
 
+/// Returns true if a call on a non-blocking socket failed because it would have blocked
+static bool WouldBlock(int error) {
+    return error == ERRNO(EAGAIN) || error == ERRNO(EWOULDBLOCK) || error == ERRNO(EINPROGRESS);
+}
+
+/// Host sockets never block, the guest threads wait for them in the reactor instead
+static void SetHostNonBlocking(u32 socket_fd) {
+#ifdef _WIN32
+    unsigned long nonblocking = 1;
+    int ret = ioctlsocket(socket_fd, FIONBIO, &nonblocking);
+#else
+    int ret = ::fcntl(socket_fd, F_SETFL, ::fcntl(socket_fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    if (ret == SOCKET_ERROR_VALUE) {
+        LOG_ERROR(Service_SOC, "Could not make socket {} non-blocking, error {}", socket_fd,
+                  GET_ERRNO);
+    }
+}
+
+static pollfd MakePollFD(u32 socket_fd, short events) {
+    pollfd fd{};
+    fd.fd = socket_fd;
+    fd.events = events;
+    return fd;
+}
+
+/// Interval at which the emulation thread signals the sockets found ready by the reactor
+constexpr s64 ReadyPollInterval = usToCycles(500);
+
+/**
+ * Polls the sockets guest threads are sleeping on from a host thread. Once any of the sockets of
+ * a thread is ready, its event is queued for the emulation thread to signal, the wakeup callbacks
+ * write guest memory. A socket connected to itself interrupts the poll when the watched sockets
+ * change.
+ */
+class SocketReactor {
+public:
+    SocketReactor();
+    ~SocketReactor();
+
+    /// Queues the event once one of the sockets is ready, returns the id to cancel the watch with
+    u64 Watch(std::vector<pollfd> fds, std::shared_ptr<Kernel::Event> event);
+
+    /// Stops watching, does nothing if the event was already queued
+    void Cancel(u64 id);
+
+    /// Signals the queued events, called from the emulation thread
+    void SignalReady();
+
+    /// Returns true if no socket is watched nor any event queued
+    bool IsIdle();
+
+private:
+    struct Watcher {
+        u64 id;
+        std::vector<pollfd> fds;
+        std::shared_ptr<Kernel::Event> event;
+    };
+
+    void Interrupt();
+    void ThreadLoop();
+
+    u32 interrupt_socket;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::vector<Watcher> watchers;
+    u64 next_id = 1;
+    bool stop_requested = false;
+
+    /// Events of the ready sockets, the reactor thread is the only producer
+    Common::SPSCQueue<std::shared_ptr<Kernel::Event>> ready_events;
+};
+
+SocketReactor::SocketReactor() {
+    interrupt_socket = static_cast<u32>(::socket(AF_INET, SOCK_DGRAM, 0));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (::bind(interrupt_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(interrupt_socket, reinterpret_cast<sockaddr*>(&addr), &addr_len) != 0 ||
+        ::connect(interrupt_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LOG_ERROR(Service_SOC, "Could not set up the socket reactor, error {}", GET_ERRNO);
+    }
+    SetHostNonBlocking(interrupt_socket);
+
+    thread = std::thread(&SocketReactor::ThreadLoop, this);
+}
+
+SocketReactor::~SocketReactor() {
+    {
+        std::lock_guard lock{mutex};
+        stop_requested = true;
+    }
+    Interrupt();
+    thread.join();
+    closesocket(interrupt_socket);
+}
+
+u64 SocketReactor::Watch(std::vector<pollfd> fds, std::shared_ptr<Kernel::Event> event) {
+    u64 id;
+    {
+        std::lock_guard lock{mutex};
+        id = next_id++;
+        watchers.push_back({id, std::move(fds), std::move(event)});
+    }
+    Interrupt();
+    return id;
+}
+
+void SocketReactor::Cancel(u64 id) {
+    std::lock_guard lock{mutex};
+    watchers.erase(std::remove_if(watchers.begin(), watchers.end(),
+                                  [id](const Watcher& watcher) { return watcher.id == id; }),
+                   watchers.end());
+}
+
+void SocketReactor::SignalReady() {
+    std::shared_ptr<Kernel::Event> event;
+    while (ready_events.Pop(event)) {
+        event->Signal();
+    }
+}
+
+bool SocketReactor::IsIdle() {
+    std::lock_guard lock{mutex};
+    return watchers.empty() && ready_events.Empty();
+}
+
+void SocketReactor::Interrupt() {
+    const char byte = 0;
+    ::send(interrupt_socket, &byte, sizeof(byte), 0);
+}
+
+void SocketReactor::ThreadLoop() {
+    Common::SetCurrentThreadName("SocketReactor");
+
+    std::vector<pollfd> fds;
+    // Id of each watcher in the poll and the end of its sockets in fds
+    std::vector<std::pair<u64, std::size_t>> ranges;
+    while (true) {
+        fds.assign(1, MakePollFD(interrupt_socket, POLLIN));
+        ranges.clear();
+        {
+            std::lock_guard lock{mutex};
+            if (stop_requested) {
+                break;
+            }
+            for (const auto& watcher : watchers) {
+                fds.insert(fds.end(), watcher.fds.begin(), watcher.fds.end());
+                ranges.emplace_back(watcher.id, fds.size());
+            }
+        }
+
+        int ret = poll(fds.data(), static_cast<unsigned long>(fds.size()), -1);
+        if (ret == SOCKET_ERROR_VALUE) {
+            // Every guest thread is woken up, their calls report the error
+            LOG_ERROR(Service_SOC, "Socket reactor poll failed, error {}", GET_ERRNO);
+            for (auto& fd : fds) {
+                fd.revents = POLLERR;
+            }
+        }
+
+        if (fds[0].revents != 0) {
+            char byte;
+            while (::recv(interrupt_socket, &byte, sizeof(byte), 0) > 0) {
+            }
+        }
+
+        std::lock_guard lock{mutex};
+        std::size_t begin = 1;
+        for (const auto& [id, end] : ranges) {
+            const bool ready = std::any_of(fds.begin() + begin, fds.begin() + end,
+                                           [](const pollfd& fd) { return fd.revents != 0; });
+            begin = end;
+            if (!ready) {
+                continue;
+            }
+            const auto watcher =
+                std::find_if(watchers.begin(), watchers.end(),
+                             [id = id](const Watcher& watcher) { return watcher.id == id; });
+            if (watcher != watchers.end()) {
+                ready_events.Push(std::move(watcher->event));
+                watchers.erase(watcher);
+            }
+        }
+    }
+}
+
+class SocketCallback : public Kernel::HLERequestContext::WakeupCallback {
+public:
+    SocketCallback(SocketReactor& reactor, SocketOperation operation)
+        : reactor(reactor), operation(std::move(operation)) {}
+
+    void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
+                Kernel::ThreadWakeupReason reason) override {
+        reactor.Cancel(watch_id);
+        operation(ctx, false);
+    }
+
+    u64 watch_id = 0;
+
+private:
+    SocketReactor& reactor;
+    SocketOperation operation;
+};
+
+/**
+ * Runs the operation, and when it would block puts the guest thread to sleep until one of the
+ * sockets is ready or the timeout expires, then runs it again. A zero timeout never expires.
+ */
+void SOC_U::RunSocketOperation(Kernel::HLERequestContext& ctx, const std::string& reason,
+                               std::vector<pollfd> fds, std::chrono::nanoseconds timeout,
+                               bool can_sleep, SocketOperation operation) {
+    if (operation(ctx, can_sleep)) {
+        return;
+    }
+    auto callback = std::make_shared<SocketCallback>(*reactor, std::move(operation));
+    auto event = ctx.SleepClientThread(reason, timeout, callback);
+    callback->watch_id = reactor->Watch(std::move(fds), std::move(event));
+
+    if (!ready_poll_scheduled) {
+        ready_poll_scheduled = true;
+        system.CoreTiming().ScheduleEvent(ReadyPollInterval, ready_poll_event);
+    }
+}
+
+void SOC_U::ReadyPollCallback(u64 userdata, s64 cycles_late) {
+    reactor->SignalReady();
+    // The poll only runs while guest threads wait for their sockets
+    ready_poll_scheduled = !reactor->IsIdle();
+    if (ready_poll_scheduled) {
+        system.CoreTiming().ScheduleEvent(ReadyPollInterval - cycles_late, ready_poll_event);
+    }
+}
+
+bool SOC_U::IsBlocking(u32 socket_handle) const {
+    const auto holder = open_sockets.find(socket_handle);
+    return holder != open_sockets.end() && holder->second.blocking;
+}
+
 void SOC_U::CleanupSockets() {
     for (auto sock : open_sockets)
         closesocket(sock.second.socket_fd);
@@ -386,8 +637,10 @@ void SOC_U::Socket(Kernel::HLERequestContext& ctx) {
 
     u32 ret = static_cast<u32>(::socket(domain, type, protocol));
 
-    if ((s32)ret != SOCKET_ERROR_VALUE)
+    if ((s32)ret != SOCKET_ERROR_VALUE) {
+        SetHostNonBlocking(ret);
         open_sockets[ret] = {ret, true};
+    }
 
     if ((s32)ret == SOCKET_ERROR_VALUE)
         ret = TranslateError(GET_ERRNO);
@@ -432,50 +685,19 @@ void SOC_U::Fcntl(Kernel::HLERequestContext& ctx) {
         rb.Push(posix_ret);
     });
 
+    // The host socket is always non-blocking, the flag only tells whether guest calls wait
+    auto iter = open_sockets.find(socket_handle);
+    if (iter == open_sockets.end()) {
+        posix_ret = TranslateError(ERRNO(EBADF));
+        return;
+    }
+
     if (ctr_cmd == 3) { // F_GETFL
-#ifdef _WIN32
-        posix_ret = 0;
-        auto iter = open_sockets.find(socket_handle);
-        if (iter != open_sockets.end() && iter->second.blocking == false)
-            posix_ret |= 4; // O_NONBLOCK
-#else
-        int ret = ::fcntl(socket_handle, F_GETFL, 0);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
         posix_ret = 0;
-        if (ret & O_NONBLOCK)
+        if (!iter->second.blocking)
             posix_ret |= 4; // O_NONBLOCK
-#endif
     } else if (ctr_cmd == 4) { // F_SETFL
-#ifdef _WIN32
-        unsigned long tmp = (ctr_arg & 4 /* O_NONBLOCK */) ? 1 : 0;
-        int ret = ioctlsocket(socket_handle, FIONBIO, &tmp);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-        auto iter = open_sockets.find(socket_handle);
-        if (iter != open_sockets.end())
-            iter->second.blocking = (tmp == 0);
-#else
-        int flags = ::fcntl(socket_handle, F_GETFL, 0);
-        if (flags == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-
-        flags &= ~O_NONBLOCK;
-        if (ctr_arg & 4) // O_NONBLOCK
-            flags |= O_NONBLOCK;
-
-        int ret = ::fcntl(socket_handle, F_SETFL, flags);
-        if (ret == SOCKET_ERROR_VALUE) {
-            posix_ret = TranslateError(GET_ERRNO);
-            return;
-        }
-#endif
+        iter->second.blocking = (ctr_arg & 4 /* O_NONBLOCK */) == 0;
     } else {
         LOG_ERROR(Service_SOC, "Unsupported command ({}) in fcntl call", ctr_cmd);
         posix_ret = TranslateError(EINVAL); // TODO: Find the correct error
@@ -499,34 +721,42 @@ void SOC_U::Listen(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Accept(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x04, 2, 2);
     u32 socket_handle = rp.Pop<u32>();
     socklen_t max_addr_len = static_cast<socklen_t>(rp.Pop<u32>());
     rp.PopPID();
-    sockaddr addr;
-    socklen_t addr_len = sizeof(addr);
-    u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
 
-    if (static_cast<s32>(ret) != SOCKET_ERROR_VALUE) {
-        open_sockets[ret] = {ret, true};
-    }
+    RunSocketOperation(
+        ctx, "soc::Accept", {MakePollFD(socket_handle, POLLIN)},
+        std::chrono::nanoseconds(0), IsBlocking(socket_handle),
+        [this, socket_handle](Kernel::HLERequestContext& ctx, bool can_sleep) {
+            sockaddr addr;
+            socklen_t addr_len = sizeof(addr);
+            u32 ret = static_cast<u32>(::accept(socket_handle, &addr, &addr_len));
+
+            if (static_cast<s32>(ret) != SOCKET_ERROR_VALUE) {
+                SetHostNonBlocking(ret);
+                open_sockets[ret] = {ret, true};
+            }
 
-    CTRSockAddr ctr_addr;
-    std::vector<u8> ctr_addr_buf(sizeof(ctr_addr));
-    if (static_cast<s32>(ret) == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        ctr_addr = CTRSockAddr::FromPlatform(addr);
-        std::memcpy(ctr_addr_buf.data(), &ctr_addr, sizeof(ctr_addr));
-    }
+            CTRSockAddr ctr_addr;
+            std::vector<u8> ctr_addr_buf(sizeof(ctr_addr));
+            if (static_cast<s32>(ret) == SOCKET_ERROR_VALUE) {
+                const int error = GET_ERRNO;
+                if (can_sleep && WouldBlock(error))
+                    return false;
+                ret = TranslateError(error);
+            } else {
+                ctr_addr = CTRSockAddr::FromPlatform(addr);
+                std::memcpy(ctr_addr_buf.data(), &ctr_addr, sizeof(ctr_addr));
+            }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(std::move(ctr_addr_buf), 0);
+            IPC::RequestBuilder rb(ctx, 0x04, 2, 2);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(ret);
+            rb.PushStaticBuffer(std::move(ctr_addr_buf), 0);
+            return true;
+        });
 }
 
 void SOC_U::GetHostId(Kernel::HLERequestContext& ctx) {
@@ -576,24 +806,36 @@ void SOC_U::SendTo(Kernel::HLERequestContext& ctx) {
     auto input_buff = rp.PopStaticBuffer();
     auto dest_addr_buff = rp.PopStaticBuffer();
 
-    s32 ret = -1;
-    if (addr_len > 0) {
-        CTRSockAddr ctr_dest_addr;
-        std::memcpy(&ctr_dest_addr, dest_addr_buff.data(), sizeof(ctr_dest_addr));
-        sockaddr dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
-        ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                       &dest_addr, sizeof(dest_addr));
-    } else {
-        ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()), len, flags,
-                       nullptr, 0);
-    }
+    RunSocketOperation(
+        ctx, "soc::SendTo", {MakePollFD(socket_handle, POLLOUT)},
+        std::chrono::nanoseconds(0), IsBlocking(socket_handle),
+        [socket_handle, len, flags, addr_len, input_buff = std::move(input_buff),
+         dest_addr_buff = std::move(dest_addr_buff)](Kernel::HLERequestContext& ctx,
+                                                     bool can_sleep) {
+            s32 ret = -1;
+            if (addr_len > 0) {
+                CTRSockAddr ctr_dest_addr;
+                std::memcpy(&ctr_dest_addr, dest_addr_buff.data(), sizeof(ctr_dest_addr));
+                sockaddr dest_addr = CTRSockAddr::ToPlatform(ctr_dest_addr);
+                ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()),
+                               len, flags, &dest_addr, sizeof(dest_addr));
+            } else {
+                ret = ::sendto(socket_handle, reinterpret_cast<const char*>(input_buff.data()),
+                               len, flags, nullptr, 0);
+            }
 
-    if (ret == SOCKET_ERROR_VALUE)
-        ret = TranslateError(GET_ERRNO);
+            if (ret == SOCKET_ERROR_VALUE) {
+                const int error = GET_ERRNO;
+                if (can_sleep && WouldBlock(error))
+                    return false;
+                ret = TranslateError(error);
+            }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
+            IPC::RequestBuilder rb(ctx, 0x0A, 2, 0);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(ret);
+            return true;
+        });
 }
 
 void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
@@ -605,43 +847,50 @@ void SOC_U::RecvFromOther(Kernel::HLERequestContext& ctx) {
     rp.PopPID();
     auto& buffer = rp.PopMappedBuffer();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
-
-    s32 ret = -1;
-    if (addr_len > 0) {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
-        }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
+    RunSocketOperation(
+        ctx, "soc::RecvFromOther", {MakePollFD(socket_handle, POLLIN)},
+        std::chrono::nanoseconds(0), IsBlocking(socket_handle),
+        [socket_handle, len, flags, addr_len, buffer](Kernel::HLERequestContext& ctx,
+                                                      bool can_sleep) mutable {
+            CTRSockAddr ctr_src_addr;
+            std::vector<u8> output_buff(len);
+            std::vector<u8> addr_buff(sizeof(ctr_src_addr));
+            sockaddr src_addr;
+            socklen_t src_addr_len = sizeof(src_addr);
+
+            s32 ret = -1;
+            if (addr_len > 0) {
+                ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len,
+                                 flags, &src_addr, &src_addr_len);
+                if (ret >= 0 && src_addr_len > 0) {
+                    ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+                    std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+                }
+            } else {
+                ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len,
+                                 flags, NULL, 0);
+                addr_buff.resize(0);
+            }
 
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-    } else {
-        buffer.Write(output_buff.data(), 0, ret);
-    }
+            if (ret == SOCKET_ERROR_VALUE) {
+                const int error = GET_ERRNO;
+                if (can_sleep && WouldBlock(error))
+                    return false;
+                ret = TranslateError(error);
+            } else {
+                buffer.Write(output_buff.data(), 0, ret);
+            }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(std::move(addr_buff), 0);
-    rb.PushMappedBuffer(buffer);
+            IPC::RequestBuilder rb(ctx, 0x07, 2, 4);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(ret);
+            rb.PushStaticBuffer(std::move(addr_buff), 0);
+            rb.PushMappedBuffer(buffer);
+            return true;
+        });
 }
 
 void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x08, 4, 2);
     u32 socket_handle = rp.Pop<u32>();
     u32 len = rp.Pop<u32>();
@@ -649,42 +898,51 @@ void SOC_U::RecvFrom(Kernel::HLERequestContext& ctx) {
     u32 addr_len = rp.Pop<u32>();
     rp.PopPID();
 
-    CTRSockAddr ctr_src_addr;
-    std::vector<u8> output_buff(len);
-    std::vector<u8> addr_buff(sizeof(ctr_src_addr));
-    sockaddr src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
-
-    s32 ret = -1;
-    if (addr_len > 0) {
-        // Only get src adr if input adr available
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         &src_addr, &src_addr_len);
-        if (ret >= 0 && src_addr_len > 0) {
-            ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
-            std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
-        }
-    } else {
-        ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len, flags,
-                         NULL, 0);
-        addr_buff.resize(0);
-    }
-
-    s32 total_received = ret;
-    if (ret == SOCKET_ERROR_VALUE) {
-        ret = TranslateError(GET_ERRNO);
-        total_received = 0;
-    }
+    RunSocketOperation(
+        ctx, "soc::RecvFrom", {MakePollFD(socket_handle, POLLIN)},
+        std::chrono::nanoseconds(0), IsBlocking(socket_handle),
+        [socket_handle, len, flags, addr_len](Kernel::HLERequestContext& ctx, bool can_sleep) {
+            CTRSockAddr ctr_src_addr;
+            std::vector<u8> output_buff(len);
+            std::vector<u8> addr_buff(sizeof(ctr_src_addr));
+            sockaddr src_addr;
+            socklen_t src_addr_len = sizeof(src_addr);
+
+            s32 ret = -1;
+            if (addr_len > 0) {
+                // Only get src adr if input adr available
+                ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len,
+                                 flags, &src_addr, &src_addr_len);
+                if (ret >= 0 && src_addr_len > 0) {
+                    ctr_src_addr = CTRSockAddr::FromPlatform(src_addr);
+                    std::memcpy(addr_buff.data(), &ctr_src_addr, sizeof(ctr_src_addr));
+                }
+            } else {
+                ret = ::recvfrom(socket_handle, reinterpret_cast<char*>(output_buff.data()), len,
+                                 flags, NULL, 0);
+                addr_buff.resize(0);
+            }
 
-    // Write only the data we received to avoid overwriting parts of the buffer with zeros
-    output_buff.resize(total_received);
+            s32 total_received = ret;
+            if (ret == SOCKET_ERROR_VALUE) {
+                const int error = GET_ERRNO;
+                if (can_sleep && WouldBlock(error))
+                    return false;
+                ret = TranslateError(error);
+                total_received = 0;
+            }
 
-    IPC::RequestBuilder rb = rp.MakeBuilder(3, 4);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.Push(total_received);
-    rb.PushStaticBuffer(std::move(output_buff), 0);
-    rb.PushStaticBuffer(std::move(addr_buff), 1);
+            // Write only the data we received to avoid overwriting parts of the buffer with zeros
+            output_buff.resize(total_received);
+
+            IPC::RequestBuilder rb(ctx, 0x08, 3, 4);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(ret);
+            rb.Push(total_received);
+            rb.PushStaticBuffer(std::move(output_buff), 0);
+            rb.PushStaticBuffer(std::move(addr_buff), 1);
+            return true;
+        });
 }
 
 void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
@@ -703,22 +961,33 @@ void SOC_U::Poll(Kernel::HLERequestContext& ctx) {
     std::vector<pollfd> platform_pollfd(nfds);
     std::transform(ctr_fds.begin(), ctr_fds.end(), platform_pollfd.begin(), CTRPollFD::ToPlatform);
 
-    s32 ret = ::poll(platform_pollfd.data(), nfds, timeout);
-
-    // Now update the output pollfd structure
-    std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
-                   CTRPollFD::FromPlatform);
-
-    std::vector<u8> output_fds(nfds * sizeof(CTRPollFD));
-    std::memcpy(output_fds.data(), ctr_fds.data(), nfds * sizeof(CTRPollFD));
-
-    if (ret == SOCKET_ERROR_VALUE)
-        ret = TranslateError(GET_ERRNO);
-
-    IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-    rb.Push(RESULT_SUCCESS);
-    rb.Push(ret);
-    rb.PushStaticBuffer(std::move(output_fds), 0);
+    // The host is only ever polled without a timeout, the guest thread sleeps through it instead
+    const auto sleep_timeout =
+        std::chrono::nanoseconds(std::chrono::milliseconds(std::max(timeout, 0)));
+    RunSocketOperation(
+        ctx, "soc::Poll", platform_pollfd, sleep_timeout, timeout != 0,
+        [nfds, platform_pollfd](Kernel::HLERequestContext& ctx, bool can_sleep) mutable {
+            s32 ret = ::poll(platform_pollfd.data(), nfds, 0);
+            if (can_sleep && ret == 0)
+                return false;
+
+            // Now update the output pollfd structure
+            std::vector<CTRPollFD> ctr_fds(nfds);
+            std::transform(platform_pollfd.begin(), platform_pollfd.end(), ctr_fds.begin(),
+                           CTRPollFD::FromPlatform);
+
+            std::vector<u8> output_fds(nfds * sizeof(CTRPollFD));
+            std::memcpy(output_fds.data(), ctr_fds.data(), nfds * sizeof(CTRPollFD));
+
+            if (ret == SOCKET_ERROR_VALUE)
+                ret = TranslateError(GET_ERRNO);
+
+            IPC::RequestBuilder rb(ctx, 0x14, 2, 2);
+            rb.Push(RESULT_SUCCESS);
+            rb.Push(ret);
+            rb.PushStaticBuffer(std::move(output_fds), 0);
+            return true;
+        });
 }
 
 void SOC_U::GetSockName(Kernel::HLERequestContext& ctx) {
@@ -783,9 +1052,6 @@ void SOC_U::GetPeerName(Kernel::HLERequestContext& ctx) {
 }
 
 void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
-    // TODO(Subv): Calling this function on a blocking socket will block the emu thread,
-    // preventing graceful shutdown when closing the emulator, this can be fixed by always
-    // performing nonblocking operations and spinlock until the data is available
     IPC::RequestParser rp(ctx, 0x06, 2, 4);
     u32 socket_handle = rp.Pop<u32>();
     u32 input_addr_len = rp.Pop<u32>();
@@ -797,8 +1063,34 @@ void SOC_U::Connect(Kernel::HLERequestContext& ctx) {
 
     sockaddr input_addr = CTRSockAddr::ToPlatform(ctr_input_addr);
     s32 ret = ::connect(socket_handle, &input_addr, sizeof(input_addr));
-    if (ret != 0)
-        ret = TranslateError(GET_ERRNO);
+    if (ret != 0) {
+        const int error = GET_ERRNO;
+        if (IsBlocking(socket_handle) && WouldBlock(error)) {
+            // The connection goes on in the background, its result is known once it is writable
+            RunSocketOperation(
+                ctx, "soc::Connect", {MakePollFD(socket_handle, POLLOUT)},
+                std::chrono::nanoseconds(0), true,
+                [socket_handle](Kernel::HLERequestContext& ctx, bool can_sleep) {
+                    if (can_sleep)
+                        return false;
+
+                    int error = 0;
+                    socklen_t error_len = sizeof(error);
+                    if (::getsockopt(socket_handle, SOL_SOCKET, SO_ERROR,
+                                     reinterpret_cast<char*>(&error),
+                                     &error_len) == SOCKET_ERROR_VALUE) {
+                        error = GET_ERRNO;
+                    }
+
+                    IPC::RequestBuilder rb(ctx, 0x06, 2, 0);
+                    rb.Push(RESULT_SUCCESS);
+                    rb.Push<s32>(error != 0 ? TranslateError(error) : 0);
+                    return true;
+                });
+            return;
+        }
+        ret = TranslateError(error);
+    }
 
     IPC::RequestBuilder rb = rp.MakeBuilder(2, 0);
     rb.Push(RESULT_SUCCESS);
@@ -1028,7 +1320,7 @@ void SOC_U::GetNetworkOpt(Kernel::HLERequestContext& ctx) {
     LOG_WARNING(Service_SOC, "(STUBBED) SOC GetNetworkOpt called, level={}, optname={:04X}, optlen={}", level, optname, optlen);
 }
 
-SOC_U::SOC_U() : ServiceFramework("soc:U") {
+SOC_U::SOC_U(Core::System& system) : ServiceFramework("soc:U"), system(system) {
     static const FunctionInfo functions[] = {
         {0x00010044, &SOC_U::InitializeSockets, "InitializeSockets"},
         {0x000200C2, &SOC_U::Socket, "Socket"},
@@ -1071,9 +1363,16 @@ SOC_U::SOC_U() : ServiceFramework("soc:U") {
     WSADATA data;
     WSAStartup(MAKEWORD(2, 2), &data);
 #endif
+
+    reactor = std::make_unique<SocketReactor>();
+    ready_poll_event = system.CoreTiming().RegisterEvent(
+        "SOC_U::ReadyPollCallback",
+        [this](u64 userdata, s64 cycles_late) { ReadyPollCallback(userdata, cycles_late); });
 }
 
 SOC_U::~SOC_U() {
+    system.CoreTiming().UnscheduleEvent(ready_poll_event, 0);
+    reactor.reset();
     CleanupSockets();
 #ifdef _WIN32
     WSACleanup();
@@ -1082,7 +1381,7 @@ SOC_U::~SOC_U() {
 
 void InstallInterfaces(Core::System& system) {
     auto& service_manager = system.ServiceManager();
-    std::make_shared<SOC_U>()->InstallAsService(service_manager);
+    std::make_shared<SOC_U>(system)->InstallAsService(service_manager);
 }
 
 } // namespace Service::SOC
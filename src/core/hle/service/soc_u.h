@@ -4,24 +4,40 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 #include "core/hle/service/service.h"
 
+struct pollfd;
+
 namespace Core {
 class System;
-}
+struct TimingEventType;
+} // namespace Core
 
 namespace Service::SOC {
 
+class SocketReactor;
+
+/**
+ * Performs a socket call and writes its response. When the call would block and the thread may
+ * sleep, it returns false without writing anything.
+ */
+using SocketOperation = std::function<bool(Kernel::HLERequestContext& ctx, bool can_sleep)>;
+
 /// Holds information about a particular socket
 struct SocketHolder {
     u32 socket_fd; ///< The socket descriptor
-    bool blocking; ///< Whether the socket is blocking or not, it is only read on Windows.
+    bool blocking; ///< Whether guest calls wait on the socket, the host socket never blocks.
 };
 
 class SOC_U final : public ServiceFramework<SOC_U> {
 public:
-    SOC_U();
+    explicit SOC_U(Core::System& system);
     ~SOC_U();
 
 private:
@@ -54,8 +70,29 @@ private:
     /// Close all open sockets
     void CleanupSockets();
 
+    /// Returns true if the guest set the socket as blocking
+    bool IsBlocking(u32 socket_handle) const;
+
+    /**
+     * Runs the operation, and when it would block puts the guest thread to sleep until one of the
+     * sockets is ready or the timeout expires, then runs it again. A zero timeout never expires.
+     */
+    void RunSocketOperation(Kernel::HLERequestContext& ctx, const std::string& reason,
+                            std::vector<pollfd> fds, std::chrono::nanoseconds timeout,
+                            bool can_sleep, SocketOperation operation);
+
+    /// Signals the threads of the sockets the reactor found ready
+    void ReadyPollCallback(u64 userdata, s64 cycles_late);
+
+    Core::System& system;
+
     /// Holds info about the currently open sockets
     std::unordered_map<u32, SocketHolder> open_sockets;
+
+    /// Wakes up the guest threads waiting for their sockets
+    std::unique_ptr<SocketReactor> reactor;
+    Core::TimingEventType* ready_poll_event;
+    bool ready_poll_scheduled = false;
 };
 
 void InstallInterfaces(Core::System& system);
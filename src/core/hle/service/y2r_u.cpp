@@ -504,12 +504,6 @@ void Y2R_U::GetDitheringWeightParams(Kernel::HLERequestContext& ctx) {
 void Y2R_U::StartConversion(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx, 0x26, 0, 0);
 
-    // dst_image_size would seem to be perfect for this, but it doesn't include the gap :(
-    u32 total_output_size =
-        conversion.input_lines * (conversion.dst.transfer_unit + conversion.dst.gap);
-    Memory::RasterizerFlushVirtualRegion(conversion.dst.address, total_output_size,
-                                         Memory::FlushMode::FlushAndInvalidate);
-
     if (!Settings::values.y2r_perform_hack || completion_event->ShouldWait(nullptr)) {
         HW::Y2R::PerformConversion(system.Memory(), conversion);
     }
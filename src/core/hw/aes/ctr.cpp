@@ -0,0 +1,79 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/alignment.h"
+#include "core/hw/aes/ctr.h"
+
+namespace HW::AES {
+
+namespace {
+
+/// Buffers from this size on are decrypted on several threads
+constexpr std::size_t PARALLEL_MIN_SIZE = 4 * 1024 * 1024;
+/// The least a thread gets to decrypt, below which starting it costs more than it saves
+constexpr std::size_t PARALLEL_CHUNK_MIN_SIZE = 1024 * 1024;
+/// Threads decrypting at once, including the caller
+constexpr std::size_t PARALLEL_MAX_THREADS = 4;
+
+using Decryption = CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption;
+
+void DecryptChunk(Decryption& aes, u8* data, std::size_t size, u64 offset) {
+    aes.Seek(offset);
+    aes.ProcessData(data, data, size);
+}
+
+} // Anonymous namespace
+
+struct CTRDecryptor::Impl {
+    AESKey key;
+    AESKey ctr;
+    /// Set up once for the decryptions on the calling thread
+    Decryption aes;
+};
+
+CTRDecryptor::CTRDecryptor(const AESKey& key, const AESKey& ctr) : impl(std::make_unique<Impl>()) {
+    impl->key = key;
+    impl->ctr = ctr;
+    impl->aes.SetKeyWithIV(key.data(), key.size(), ctr.data());
+}
+
+CTRDecryptor::~CTRDecryptor() = default;
+
+void CTRDecryptor::Decrypt(u8* data, std::size_t size, u64 offset) {
+    if (size == 0) {
+        return; // Crypto++ does not like zero size buffer
+    }
+
+    const std::size_t max_threads = std::min<std::size_t>(
+        PARALLEL_MAX_THREADS, std::max(1u, std::thread::hardware_concurrency()));
+    if (size < PARALLEL_MIN_SIZE || max_threads == 1) {
+        DecryptChunk(impl->aes, data, size, offset);
+        return;
+    }
+
+    const std::size_t num_threads = std::min(max_threads, size / PARALLEL_CHUNK_MIN_SIZE);
+    const std::size_t chunk_size = Common::AlignUp(size / num_threads, AES_BLOCK_SIZE);
+
+    // Each worker needs a cipher of its own, the first chunk is left to the calling thread
+    std::vector<std::future<void>> workers;
+    for (std::size_t start = chunk_size; start < size; start += chunk_size) {
+        const std::size_t length = std::min(chunk_size, size - start);
+        workers.push_back(std::async(std::launch::async, [this, data, start, length, offset] {
+            Decryption aes(impl->key.data(), impl->key.size(), impl->ctr.data());
+            DecryptChunk(aes, data + start, length, offset + start);
+        }));
+    }
+    DecryptChunk(impl->aes, data, std::min(chunk_size, size), offset);
+    for (auto& worker : workers) {
+        worker.get();
+    }
+}
+
+} // namespace HW::AES
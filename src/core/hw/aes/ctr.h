@@ -0,0 +1,37 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+#include "core/hw/aes/key.h"
+
+namespace HW::AES {
+
+/**
+ * AES-CTR decryption of the ExeFS and RomFS sections of applications. Crypto++ runs the AES-NI or
+ * ARMv8 crypto instructions when the CPU has them. As counter mode decrypts every block on its
+ * own, large buffers are further split over several threads.
+ */
+class CTRDecryptor {
+public:
+    CTRDecryptor(const AESKey& key, const AESKey& ctr);
+    ~CTRDecryptor();
+
+    /**
+     * Decrypts data in place
+     * @param data The data to decrypt
+     * @param size The size of the data
+     * @param offset The offset of the data in the encrypted stream
+     */
+    void Decrypt(u8* data, std::size_t size, u64 offset);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace HW::AES
@@ -2,21 +2,24 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <numeric>
 #include <type_traits>
+#include <vector>
 #include "common/alignment.h"
-#include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
-#include "common/vector_math.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
 #include "core/hw/hw.h"
+#include "core/hw/pixel_convert.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
 #include "video_core/debug_utils/debug_utils.h"
@@ -34,6 +37,11 @@ Memory::MemorySystem* g_memory;
 const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / SCREEN_REFRESH_RATE);
 /// Event id for CoreTiming
 static Core::TimingEventType* vblank_event;
+/// Emulated time after which the emulation thread waits for work queued on the GPU thread
+constexpr u64 gpu_sync_ticks = frame_ticks / 8;
+static Core::TimingEventType* gpu_sync_event;
+/// Fence of the last buffer swap queued on the GPU thread
+static u64 swap_fence = 0;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -49,26 +57,27 @@ inline void Read(T& var, const u32 raw_addr) {
     var = g_regs[addr / 4];
 }
 
-static Common::Vec4<u8> DecodePixel(Regs::PixelFormat input_format, const u8* src_pixel) {
-    switch (input_format) {
-    case Regs::PixelFormat::RGBA8:
-        return Color::DecodeRGBA8(src_pixel);
-
-    case Regs::PixelFormat::RGB8:
-        return Color::DecodeRGB8(src_pixel);
-
-    case Regs::PixelFormat::RGB565:
-        return Color::DecodeRGB565(src_pixel);
-
-    case Regs::PixelFormat::RGB5A1:
-        return Color::DecodeRGB5A1(src_pixel);
-
-    case Regs::PixelFormat::RGBA4:
-        return Color::DecodeRGBA4(src_pixel);
+/// Copies a row of a tiled image into linear order
+static void GatherTiledRow(const u8* image, u32 y, u32 width, u32 stride, u32 bytes_per_pixel,
+                           u8* row) {
+    const u8* const tile_row = image + (y & ~7) * stride * bytes_per_pixel;
+    for (u32 x = 0; x < width; x += 2) {
+        // Horizontally adjacent pairs are contiguous in Morton order
+        const u32 num_pixels = std::min(width - x, 2u);
+        std::memcpy(row + x * bytes_per_pixel,
+                    tile_row + VideoCore::GetMortonOffset(x, y, bytes_per_pixel),
+                    num_pixels * bytes_per_pixel);
+    }
+}
 
-    default:
-        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", static_cast<u32>(input_format));
-        return {0, 0, 0, 0};
+/// Copies a linear row into a tiled image
+static void ScatterTiledRow(const u8* row, u32 y, u32 width, u32 stride, u32 bytes_per_pixel,
+                            u8* image) {
+    u8* const tile_row = image + (y & ~7) * stride * bytes_per_pixel;
+    for (u32 x = 0; x < width; x += 2) {
+        const u32 num_pixels = std::min(width - x, 2u);
+        std::memcpy(tile_row + VideoCore::GetMortonOffset(x, y, bytes_per_pixel),
+                    row + x * bytes_per_pixel, num_pixels * bytes_per_pixel);
     }
 }
 
@@ -102,25 +111,13 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerInvalidateRegion(start_addr,end_addr - start_addr);
 
     if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
+        const u32 value = config.value_24bit_r | (config.value_24bit_g << 8) |
+                          (config.value_24bit_b << 16);
+        PixelConvert::Fill(start, end, value, 3);
     } else if (config.fill_32bit) {
-        // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            std::size_t len = (end - start) / sizeof(u32);
-            for (std::size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
+        PixelConvert::Fill(start, end, config.value_32bit, 4);
     } else {
-        // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
+        PixelConvert::Fill(start, end, config.value_16bit, 2);
     }
 }
 
@@ -170,12 +167,6 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
         return;
     }
 
-    if (config.input_linear && config.scaling != config.NoScale) {
-        LOG_CRITICAL(HW_GPU, "Scaling is only implemented on tiled input");
-        UNIMPLEMENTED();
-        return;
-    }
-
     int horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
     int vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
 
@@ -189,111 +180,64 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
-    for (u32 y = 0; y < output_height; ++y) {
-        for (u32 x = 0; x < output_width; ++x) {
-            Common::Vec4<u8> src_color;
-
-            // Calculate the [x,y] position of the input image
-            // based on the current output position and the scale
-            u32 input_x = x << horizontal_scale;
-            u32 input_y = y << vertical_scale;
-
-            u32 output_y;
-            if (config.flip_vertically) {
-                // Flip the y value of the output data,
-                // we do this after calculating the [x,y] position of the input image
-                // to account for the scaling options.
-                output_y = output_height - y - 1;
-            } else {
-                output_y = y;
-            }
+    const u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
+    const u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
+    const bool output_tiled = config.input_linear != config.dont_swizzle;
+    const bool convert =
+        config.scaling != config.NoScale || config.input_format != config.output_format;
+    const u32 num_input_rows = config.scaling == config.ScaleXY ? 2 : 1;
+    const u32 input_row_width = output_width << horizontal_scale;
 
-            u32 dst_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.output_format);
-            u32 src_bytes_per_pixel = GPU::Regs::BytesPerPixel(config.input_format);
-            u32 src_offset;
-            u32 dst_offset;
+    // Each output row is gathered into linear order, converted through RGBA8 and written back
+    std::vector<u8> src_rows(input_row_width * src_bytes_per_pixel * num_input_rows);
+    std::vector<u8> rgba_rows(input_row_width * 4 * num_input_rows);
+    std::vector<u8> scaled_row(output_width * 4);
+    std::vector<u8> dst_row(output_width * dst_bytes_per_pixel);
 
+    for (u32 y = 0; y < output_height; ++y) {
+        std::array<const u8*, 2> src_row{};
+        for (u32 row = 0; row < num_input_rows; ++row) {
+            const u32 input_y = (y << vertical_scale) + row;
             if (config.input_linear) {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as linear and the output as tiled
-                    u32 coarse_y = output_y & ~7;
-                    u32 stride = output_width * dst_bytes_per_pixel;
-
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 coarse_y * stride;
-                } else {
-                    // Both input and output are linear
-                    src_offset = (input_x + input_y * config.input_width) * src_bytes_per_pixel;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                }
+                src_row[row] = src_pointer + input_y * config.input_width * src_bytes_per_pixel;
             } else {
-                if (!config.dont_swizzle) {
-                    // Interpret the input as tiled and the output as linear
-                    u32 coarse_y = input_y & ~7;
-                    u32 stride = config.input_width * src_bytes_per_pixel;
-
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 coarse_y * stride;
-                    dst_offset = (x + output_y * output_width) * dst_bytes_per_pixel;
-                } else {
-                    // Both input and output are tiled
-                    u32 out_coarse_y = output_y & ~7;
-                    u32 out_stride = output_width * dst_bytes_per_pixel;
-
-                    u32 in_coarse_y = input_y & ~7;
-                    u32 in_stride = config.input_width * src_bytes_per_pixel;
+                u8* const linear_row = &src_rows[row * input_row_width * src_bytes_per_pixel];
+                GatherTiledRow(src_pointer, input_y, input_row_width, config.input_width,
+                               src_bytes_per_pixel, linear_row);
+                src_row[row] = linear_row;
+            }
+        }
 
-                    src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bytes_per_pixel) +
-                                 in_coarse_y * in_stride;
-                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bytes_per_pixel) +
-                                 out_coarse_y * out_stride;
-                }
+        // Flip the y value of the output data after the input position has been worked out, to
+        // account for the scaling options
+        const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+        u8* const dst_line = output_tiled
+                                 ? dst_row.data()
+                                 : dst_pointer + output_y * output_width * dst_bytes_per_pixel;
+
+        if (!convert) {
+            std::memcpy(dst_line, src_row[0], output_width * dst_bytes_per_pixel);
+        } else {
+            for (u32 row = 0; row < num_input_rows; ++row) {
+                PixelConvert::DecodeRow(config.input_format, src_row[row],
+                                        &rgba_rows[row * input_row_width * 4], input_row_width);
             }
 
-            const u8* src_pixel = src_pointer + src_offset;
-            src_color = DecodePixel(config.input_format, src_pixel);
+            const u8* rgba_row = rgba_rows.data();
             if (config.scaling == config.ScaleX) {
-                Common::Vec4<u8> pixel =
-                    DecodePixel(config.input_format, src_pixel + src_bytes_per_pixel);
-                src_color = ((src_color + pixel) / 2).Cast<u8>();
+                PixelConvert::DownscaleRowX(rgba_row, scaled_row.data(), output_width);
+                rgba_row = scaled_row.data();
             } else if (config.scaling == config.ScaleXY) {
-                Common::Vec4<u8> pixel1 =
-                    DecodePixel(config.input_format, src_pixel + 1 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel2 =
-                    DecodePixel(config.input_format, src_pixel + 2 * src_bytes_per_pixel);
-                Common::Vec4<u8> pixel3 =
-                    DecodePixel(config.input_format, src_pixel + 3 * src_bytes_per_pixel);
-                src_color = (((src_color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+                PixelConvert::DownscaleRowXY(rgba_row, rgba_row + input_row_width * 4,
+                                             scaled_row.data(), output_width);
+                rgba_row = scaled_row.data();
             }
+            PixelConvert::EncodeRow(config.output_format, rgba_row, dst_line, output_width);
+        }
 
-            u8* dst_pixel = dst_pointer + dst_offset;
-            switch (config.output_format) {
-            case Regs::PixelFormat::RGBA8:
-                Color::EncodeRGBA8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB8:
-                Color::EncodeRGB8(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB565:
-                Color::EncodeRGB565(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGB5A1:
-                Color::EncodeRGB5A1(src_color, dst_pixel);
-                break;
-
-            case Regs::PixelFormat::RGBA4:
-                Color::EncodeRGBA4(src_color, dst_pixel);
-                break;
-
-            default:
-                LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}",
-                          static_cast<u32>(config.output_format.Value()));
-                break;
-            }
+        if (output_tiled) {
+            ScatterTiledRow(dst_line, output_y, output_width, output_width, dst_bytes_per_pixel,
+                            dst_pointer);
         }
     }
 }
@@ -399,19 +343,21 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+            QueueWork([config, is_second_filler] {
+                MemoryFill(config);
+                LOG_TRACE(HW_GPU, "MemoryFill from {:#010X} to {:#010X}", config.GetStartAddress(),
+                          config.GetEndAddress());
+
+                // It seems that it won't signal interrupt if "address_start" is zero.
+                // TODO: hwtest this
+                if (config.GetStartAddress() != 0) {
+                    if (!is_second_filler) {
+                        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
+                    } else {
+                        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+                    }
                 }
-            }
+            });
 
             // Reset "trigger" flag and set the "finish" flag
             // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
@@ -422,32 +368,35 @@ inline void Write(u32 addr, const T data) {
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
-        const auto& config = g_regs.display_transfer_config;
+        const auto config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU,
-                          "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
-                          "{:#010X}({}+{}), flags {:#010X}",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
-            } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU,
-                          "DisplayTransfer: {:#010X}({}x{})-> "
-                          "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          static_cast<u32>(config.output_format.Value()), config.flags);
-            }
+            QueueWork([config] {
+                MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+                if (config.is_texture_copy) {
+                    TextureCopy(config);
+                    LOG_TRACE(HW_GPU,
+                              "TextureCopy: {:#X} bytes from {:#010X}({}+{})-> "
+                              "{:#010X}({}+{}), flags {:#010X}",
+                              config.texture_copy.size, config.GetPhysicalInputAddress(),
+                              config.texture_copy.input_width * 16,
+                              config.texture_copy.input_gap * 16,
+                              config.GetPhysicalOutputAddress(),
+                              config.texture_copy.output_width * 16,
+                              config.texture_copy.output_gap * 16, config.flags);
+                } else {
+                    DisplayTransfer(config);
+                    LOG_TRACE(HW_GPU,
+                              "DisplayTransfer: {:#010X}({}x{})-> "
+                              "{:#010X}({}x{}), dst format {:x}, flags {:#010X}",
+                              config.GetPhysicalInputAddress(), config.input_width.Value(),
+                              config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                              config.output_width.Value(), config.output_height.Value(),
+                              static_cast<u32>(config.output_format.Value()), config.flags);
+                }
+                Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+            });
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -456,9 +405,11 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
-
-            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
+            QueueWork([address = config.GetPhysicalAddress(), size = config.size] {
+                MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+                PERF_SCOPE(GpuCommands);
+                Pica::CommandProcessor::ProcessCommandList(address, size);
+            });
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -483,8 +434,33 @@ template void Write<u16>(u32 addr, const u16 data);
 template void Write<u8>(u32 addr, const u8 data);
 
 /// Update hardware
+void QueueWork(std::function<void()> work) {
+    VideoCore::GPUThread* gpu_thread = VideoCore::GetGPUThread();
+    if (!gpu_thread) {
+        work();
+        return;
+    }
+
+    // The interrupts signalled by the work are delivered once the emulation thread waits for it,
+    // which leaves the GPU thread some emulated time to run in parallel
+    const u64 fence = gpu_thread->Push(std::move(work));
+    Core::System::GetInstance().CoreTiming().ScheduleEvent(gpu_sync_ticks, gpu_sync_event, fence);
+}
+
+static void GPUSyncCallback(u64 fence, s64 cycles_late) {
+    if (VideoCore::GPUThread* gpu_thread = VideoCore::GetGPUThread()) {
+        gpu_thread->WaitFence(fence);
+    }
+}
+
 static void VBlankCallback(u64 userdata, s64 cycles_late) {
-    VideoCore::Renderer()->SwapBuffers();
+    if (VideoCore::GPUThread* gpu_thread = VideoCore::GetGPUThread()) {
+        // The GPU thread may fall at most one frame behind
+        gpu_thread->WaitFence(swap_fence);
+        swap_fence = gpu_thread->Push([] { VideoCore::Renderer()->SwapBuffers(); });
+    } else {
+        VideoCore::Renderer()->SwapBuffers();
+    }
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -531,6 +507,8 @@ void Init(Memory::MemorySystem& memory) {
 
     Core::Timing& timing = Core::System::GetInstance().CoreTiming();
     vblank_event = timing.RegisterEvent("GPU::VBlankCallback", VBlankCallback);
+    gpu_sync_event = timing.RegisterEvent("GPU::GPUSyncCallback", GPUSyncCallback);
+    swap_fence = 0;
     timing.ScheduleEvent(frame_ticks, vblank_event);
 
     LOG_DEBUG(HW_GPU, "initialized OK");
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 #include <type_traits>
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -298,6 +299,12 @@ void Read(T& var, const u32 addr);
 template <typename T>
 void Write(u32 addr, const T data);
 
+/**
+ * Runs work of the GPU, such as a command list, in submission order. It goes to the GPU thread when
+ * that is enabled, in which case the interrupts it signals reach the guest a little later.
+ */
+void QueueWork(std::function<void()> work);
+
 /// Initialize hardware
 void Init(Memory::MemorySystem& memory);
 
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <mutex>
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hw/aes/key.h"
@@ -11,8 +12,12 @@
 
 namespace HW {
 
+/// The register handlers are not thread safe, while the cores may run on host threads of their own
+static std::mutex register_mutex;
+
 template <typename T>
 inline void Read(T& var, const u32 addr) {
+    std::lock_guard lock{register_mutex};
     if ((addr & 0xFFFF0000) == VADDR_GPU) {
         GPU::Read(var, addr);
     } else if ((addr & 0xFFFFF000) == VADDR_LCD) {
@@ -24,6 +29,7 @@ inline void Read(T& var, const u32 addr) {
 
 template <typename T>
 inline void Write(u32 addr, const T data) {
+    std::lock_guard lock{register_mutex};
     if ((addr & 0xFFFF0000) == VADDR_GPU) {
         GPU::Write(addr, data);
     } else if ((addr & 0xFFFFF000) == VADDR_LCD) {
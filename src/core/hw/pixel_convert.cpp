@@ -0,0 +1,426 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/color.h"
+#include "common/logging/log.h"
+#include "common/simd.h"
+#include "common/vector_math.h"
+#include "core/hw/pixel_convert.h"
+
+namespace GPU::PixelConvert {
+
+using PixelFormat = Regs::PixelFormat;
+
+#ifdef HAVE_COMMON_SIMD
+using VecU8 = Common::SIMD::Vec;
+using Common::SIMD::ByteSwap32;
+using Common::SIMD::Load;
+using Common::SIMD::Store;
+
+#if defined(ARCHITECTURE_x86_64)
+using VecU16 = __m128i;
+
+static inline VecU16 LoadU16(const u8* src) {
+    return Load(src);
+}
+
+static inline void StoreU16(u8* dst, VecU16 v) {
+    Store(dst, v);
+}
+
+template <int bits>
+static inline VecU16 ShiftLeft(VecU16 v) {
+    return _mm_slli_epi16(v, bits);
+}
+
+template <int bits>
+static inline VecU16 ShiftRight(VecU16 v) {
+    return _mm_srli_epi16(v, bits);
+}
+
+static inline VecU16 And(VecU16 v, u16 mask) {
+    return _mm_and_si128(v, _mm_set1_epi16(static_cast<s16>(mask)));
+}
+
+static inline VecU16 Or(VecU16 a, VecU16 b) {
+    return _mm_or_si128(a, b);
+}
+
+static inline VecU16 Sub(VecU16 a, VecU16 b) {
+    return _mm_sub_epi16(a, b);
+}
+
+static inline VecU16 Splat(u16 value) {
+    return _mm_set1_epi16(static_cast<s16>(value));
+}
+
+/// Stores eight RGBA8 pixels given as one 16-bit lane per channel and pixel
+static inline void StoreRGBA(u8* dst, VecU16 r, VecU16 g, VecU16 b, VecU16 a) {
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    Store(dst, _mm_unpacklo_epi16(rg, ba));
+    Store(dst + 16, _mm_unpackhi_epi16(rg, ba));
+}
+
+/// Loads eight RGBA8 pixels as one 16-bit lane per channel and pixel
+static inline void LoadRGBA(const u8* src, VecU16& r, VecU16& g, VecU16& b, VecU16& a) {
+    const __m128i lo = Load(src);
+    const __m128i hi = Load(src + 16);
+    // Sign extending the 16-bit halves keeps the signed saturation of the pack from altering them
+    const __m128i rg = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16),
+                                       _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+    const __m128i ba = _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+    r = And(rg, 0xFF);
+    g = ShiftRight<8>(rg);
+    b = And(ba, 0xFF);
+    a = ShiftRight<8>(ba);
+}
+
+/// Splits eight RGBA8 pixels into the even and the odd ones
+static inline void Deinterleave(const u8* src, VecU8& even, VecU8& odd) {
+    const __m128i lo = _mm_shuffle_epi32(Load(src), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i hi = _mm_shuffle_epi32(Load(src + 16), _MM_SHUFFLE(3, 1, 2, 0));
+    even = _mm_unpacklo_epi64(lo, hi);
+    odd = _mm_unpackhi_epi64(lo, hi);
+}
+
+/// Averages each byte, rounding down
+static inline VecU8 Average(VecU8 a, VecU8 b) {
+    const __m128i half =
+        _mm_and_si128(_mm_srli_epi16(_mm_xor_si128(a, b), 1), _mm_set1_epi8(0x7F));
+    return _mm_add_epi8(_mm_and_si128(a, b), half);
+}
+
+/// Averages each byte of four vectors, rounding down
+static inline VecU8 Average(VecU8 a, VecU8 b, VecU8 c, VecU8 d) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo =
+        _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                      _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+    const __m128i hi =
+        _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                      _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+    return _mm_packus_epi16(_mm_srli_epi16(lo, 2), _mm_srli_epi16(hi, 2));
+}
+#else
+using VecU16 = uint16x8_t;
+
+static inline VecU16 LoadU16(const u8* src) {
+    return vreinterpretq_u16_u8(vld1q_u8(src));
+}
+
+static inline void StoreU16(u8* dst, VecU16 v) {
+    vst1q_u8(dst, vreinterpretq_u8_u16(v));
+}
+
+template <int bits>
+static inline VecU16 ShiftLeft(VecU16 v) {
+    return vshlq_n_u16(v, bits);
+}
+
+template <int bits>
+static inline VecU16 ShiftRight(VecU16 v) {
+    return vshrq_n_u16(v, bits);
+}
+
+static inline VecU16 And(VecU16 v, u16 mask) {
+    return vandq_u16(v, vdupq_n_u16(mask));
+}
+
+static inline VecU16 Or(VecU16 a, VecU16 b) {
+    return vorrq_u16(a, b);
+}
+
+static inline VecU16 Sub(VecU16 a, VecU16 b) {
+    return vsubq_u16(a, b);
+}
+
+static inline VecU16 Splat(u16 value) {
+    return vdupq_n_u16(value);
+}
+
+static inline void StoreRGBA(u8* dst, VecU16 r, VecU16 g, VecU16 b, VecU16 a) {
+    const uint8x8x4_t pixels{{vmovn_u16(r), vmovn_u16(g), vmovn_u16(b), vmovn_u16(a)}};
+    vst4_u8(dst, pixels);
+}
+
+static inline void LoadRGBA(const u8* src, VecU16& r, VecU16& g, VecU16& b, VecU16& a) {
+    const uint8x8x4_t pixels = vld4_u8(src);
+    r = vmovl_u8(pixels.val[0]);
+    g = vmovl_u8(pixels.val[1]);
+    b = vmovl_u8(pixels.val[2]);
+    a = vmovl_u8(pixels.val[3]);
+}
+
+static inline void Deinterleave(const u8* src, VecU8& even, VecU8& odd) {
+    const uint32x4x2_t pixels = vld2q_u32(reinterpret_cast<const u32*>(src));
+    even = vreinterpretq_u8_u32(pixels.val[0]);
+    odd = vreinterpretq_u8_u32(pixels.val[1]);
+}
+
+static inline VecU8 Average(VecU8 a, VecU8 b) {
+    return vhaddq_u8(a, b);
+}
+
+static inline VecU8 Average(VecU8 a, VecU8 b, VecU8 c, VecU8 d) {
+    const uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(b)),
+                                    vaddl_u8(vget_low_u8(c), vget_low_u8(d)));
+    const uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(b)),
+                                    vaddl_u8(vget_high_u8(c), vget_high_u8(d)));
+    return vcombine_u8(vshrn_n_u16(lo, 2), vshrn_n_u16(hi, 2));
+}
+#endif
+
+static inline VecU16 Expand4(VecU16 v) {
+    return Or(ShiftLeft<4>(v), v);
+}
+
+static inline VecU16 Expand5(VecU16 v) {
+    return Or(ShiftLeft<3>(v), ShiftRight<2>(v));
+}
+
+static inline VecU16 Expand6(VecU16 v) {
+    return Or(ShiftLeft<2>(v), ShiftRight<4>(v));
+}
+
+/// Decodes eight pixels of a 16-bit format
+template <PixelFormat format>
+static inline void Decode16(const u8* src, u8* rgba) {
+    const VecU16 v = LoadU16(src);
+    if constexpr (format == PixelFormat::RGB565) {
+        StoreRGBA(rgba, Expand5(ShiftRight<11>(v)), Expand6(And(ShiftRight<5>(v), 0x3F)),
+                  Expand5(And(v, 0x1F)), Splat(0xFF));
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        const VecU16 a = And(v, 0x1);
+        StoreRGBA(rgba, Expand5(ShiftRight<11>(v)), Expand5(And(ShiftRight<6>(v), 0x1F)),
+                  Expand5(And(ShiftRight<1>(v), 0x1F)), Sub(ShiftLeft<8>(a), a));
+    } else if constexpr (format == PixelFormat::RGBA4) {
+        StoreRGBA(rgba, Expand4(ShiftRight<12>(v)), Expand4(And(ShiftRight<8>(v), 0xF)),
+                  Expand4(And(ShiftRight<4>(v), 0xF)), Expand4(And(v, 0xF)));
+    }
+}
+
+/// Encodes eight pixels into a 16-bit format
+template <PixelFormat format>
+static inline void Encode16(const u8* rgba, u8* dst) {
+    VecU16 r, g, b, a;
+    LoadRGBA(rgba, r, g, b, a);
+    if constexpr (format == PixelFormat::RGB565) {
+        StoreU16(dst, Or(Or(ShiftLeft<11>(ShiftRight<3>(r)), ShiftLeft<5>(ShiftRight<2>(g))),
+                         ShiftRight<3>(b)));
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        StoreU16(dst, Or(Or(ShiftLeft<11>(ShiftRight<3>(r)), ShiftLeft<6>(ShiftRight<3>(g))),
+                         Or(ShiftLeft<1>(ShiftRight<3>(b)), ShiftRight<7>(a))));
+    } else if constexpr (format == PixelFormat::RGBA4) {
+        StoreU16(dst, Or(Or(ShiftLeft<12>(ShiftRight<4>(r)), ShiftLeft<8>(ShiftRight<4>(g))),
+                         Or(ShiftLeft<4>(ShiftRight<4>(b)), ShiftRight<4>(a))));
+    }
+}
+#endif
+
+template <PixelFormat format>
+static Common::Vec4<u8> DecodePixel(const u8* src) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        return Color::DecodeRGBA8(src);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        return Color::DecodeRGB8(src);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        return Color::DecodeRGB565(src);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        return Color::DecodeRGB5A1(src);
+    } else {
+        return Color::DecodeRGBA4(src);
+    }
+}
+
+template <PixelFormat format>
+static void EncodePixel(const Common::Vec4<u8>& color, u8* dst) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        Color::EncodeRGBA8(color, dst);
+    } else if constexpr (format == PixelFormat::RGB8) {
+        Color::EncodeRGB8(color, dst);
+    } else if constexpr (format == PixelFormat::RGB565) {
+        Color::EncodeRGB565(color, dst);
+    } else if constexpr (format == PixelFormat::RGB5A1) {
+        Color::EncodeRGB5A1(color, dst);
+    } else {
+        Color::EncodeRGBA4(color, dst);
+    }
+}
+
+template <PixelFormat format>
+static void DecodeRowAs(const u8* src, u8* rgba, std::size_t count) {
+    constexpr std::size_t bytes_per_pixel = format == PixelFormat::RGBA8  ? 4
+                                            : format == PixelFormat::RGB8 ? 3
+                                                                          : 2;
+    std::size_t i = 0;
+#ifdef HAVE_COMMON_SIMD
+    if constexpr (format == PixelFormat::RGBA8) {
+        for (; i + 4 <= count; i += 4) {
+            Store(rgba + i * 4, ByteSwap32(Load(src + i * 4)));
+        }
+    } else if constexpr (format == PixelFormat::RGB8) {
+#if defined(ARCHITECTURE_ARM64)
+        // SSE2 has no byte shuffle, so this one is only vectorized on NEON
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16x3_t bgr = vld3q_u8(src + i * 3);
+            const uint8x16x4_t pixels{{bgr.val[2], bgr.val[1], bgr.val[0], vdupq_n_u8(0xFF)}};
+            vst4q_u8(rgba + i * 4, pixels);
+        }
+#endif
+    } else {
+        for (; i + 8 <= count; i += 8) {
+            Decode16<format>(src + i * 2, rgba + i * 4);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        const Common::Vec4<u8> color = DecodePixel<format>(src + i * bytes_per_pixel);
+        u8* const pixel = rgba + i * 4;
+        pixel[0] = color.r();
+        pixel[1] = color.g();
+        pixel[2] = color.b();
+        pixel[3] = color.a();
+    }
+}
+
+template <PixelFormat format>
+static void EncodeRowAs(const u8* rgba, u8* dst, std::size_t count) {
+    constexpr std::size_t bytes_per_pixel = format == PixelFormat::RGBA8  ? 4
+                                            : format == PixelFormat::RGB8 ? 3
+                                                                          : 2;
+    std::size_t i = 0;
+#ifdef HAVE_COMMON_SIMD
+    if constexpr (format == PixelFormat::RGBA8) {
+        for (; i + 4 <= count; i += 4) {
+            Store(dst + i * 4, ByteSwap32(Load(rgba + i * 4)));
+        }
+    } else if constexpr (format == PixelFormat::RGB8) {
+#if defined(ARCHITECTURE_ARM64)
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16x4_t pixels = vld4q_u8(rgba + i * 4);
+            const uint8x16x3_t bgr{{pixels.val[2], pixels.val[1], pixels.val[0]}};
+            vst3q_u8(dst + i * 3, bgr);
+        }
+#endif
+    } else {
+        for (; i + 8 <= count; i += 8) {
+            Encode16<format>(rgba + i * 4, dst + i * 2);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        const u8* const pixel = rgba + i * 4;
+        EncodePixel<format>({pixel[0], pixel[1], pixel[2], pixel[3]}, dst + i * bytes_per_pixel);
+    }
+}
+
+void Fill(u8* start, u8* end, u32 value, u32 bytes_per_value) {
+    ASSERT(bytes_per_value >= 2 && bytes_per_value <= 4);
+    const std::size_t region_size = static_cast<std::size_t>(end - start);
+    const std::size_t size = bytes_per_value == 4 ? Common::AlignDown(region_size, 4)
+                                                  : Common::AlignUp(region_size, bytes_per_value);
+
+    // 48 bytes hold a whole number of 16, 24 and 32-bit values, as well as of SIMD registers
+    std::array<u8, 48> pattern;
+    for (std::size_t offset = 0; offset < pattern.size(); offset += bytes_per_value) {
+        std::memcpy(&pattern[offset], &value, bytes_per_value);
+    }
+
+    u8* ptr = start;
+    u8* const fill_end = start + size;
+#ifdef HAVE_COMMON_SIMD
+    const VecU8 pattern0 = Load(&pattern[0]);
+    const VecU8 pattern1 = Load(&pattern[16]);
+    const VecU8 pattern2 = Load(&pattern[32]);
+    for (; fill_end - ptr >= static_cast<std::ptrdiff_t>(pattern.size()); ptr += pattern.size()) {
+        Store(ptr, pattern0);
+        Store(ptr + 16, pattern1);
+        Store(ptr + 32, pattern2);
+    }
+#else
+    for (; fill_end - ptr >= static_cast<std::ptrdiff_t>(pattern.size()); ptr += pattern.size()) {
+        std::memcpy(ptr, pattern.data(), pattern.size());
+    }
+#endif
+    std::memcpy(ptr, pattern.data(), fill_end - ptr);
+}
+
+void DecodeRow(PixelFormat format, const u8* src, u8* rgba, std::size_t count) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return DecodeRowAs<PixelFormat::RGBA8>(src, rgba, count);
+    case PixelFormat::RGB8:
+        return DecodeRowAs<PixelFormat::RGB8>(src, rgba, count);
+    case PixelFormat::RGB565:
+        return DecodeRowAs<PixelFormat::RGB565>(src, rgba, count);
+    case PixelFormat::RGB5A1:
+        return DecodeRowAs<PixelFormat::RGB5A1>(src, rgba, count);
+    case PixelFormat::RGBA4:
+        return DecodeRowAs<PixelFormat::RGBA4>(src, rgba, count);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown source framebuffer format {:x}", static_cast<u32>(format));
+        std::memset(rgba, 0, count * 4);
+        break;
+    }
+}
+
+void EncodeRow(PixelFormat format, const u8* rgba, u8* dst, std::size_t count) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return EncodeRowAs<PixelFormat::RGBA8>(rgba, dst, count);
+    case PixelFormat::RGB8:
+        return EncodeRowAs<PixelFormat::RGB8>(rgba, dst, count);
+    case PixelFormat::RGB565:
+        return EncodeRowAs<PixelFormat::RGB565>(rgba, dst, count);
+    case PixelFormat::RGB5A1:
+        return EncodeRowAs<PixelFormat::RGB5A1>(rgba, dst, count);
+    case PixelFormat::RGBA4:
+        return EncodeRowAs<PixelFormat::RGBA4>(rgba, dst, count);
+    default:
+        LOG_ERROR(HW_GPU, "Unknown destination framebuffer format {:x}", static_cast<u32>(format));
+        break;
+    }
+}
+
+void DownscaleRowX(const u8* rgba, u8* dst, std::size_t count) {
+    std::size_t i = 0;
+#ifdef HAVE_COMMON_SIMD
+    for (; i + 4 <= count; i += 4) {
+        VecU8 even, odd;
+        Deinterleave(rgba + i * 8, even, odd);
+        Store(dst + i * 4, Average(even, odd));
+    }
+#endif
+    for (; i < count; ++i) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            dst[i * 4 + c] = static_cast<u8>((rgba[i * 8 + c] + rgba[i * 8 + 4 + c]) / 2);
+        }
+    }
+}
+
+void DownscaleRowXY(const u8* row0, const u8* row1, u8* dst, std::size_t count) {
+    std::size_t i = 0;
+#ifdef HAVE_COMMON_SIMD
+    for (; i + 4 <= count; i += 4) {
+        VecU8 even0, odd0, even1, odd1;
+        Deinterleave(row0 + i * 8, even0, odd0);
+        Deinterleave(row1 + i * 8, even1, odd1);
+        Store(dst + i * 4, Average(even0, odd0, even1, odd1));
+    }
+#endif
+    for (; i < count; ++i) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            const u32 sum = row0[i * 8 + c] + row0[i * 8 + 4 + c] + row1[i * 8 + c] +
+                            row1[i * 8 + 4 + c];
+            dst[i * 4 + c] = static_cast<u8>(sum / 4);
+        }
+    }
+}
+
+} // namespace GPU::PixelConvert
@@ -0,0 +1,40 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+/**
+ * Row kernels behind the software MemoryFill and DisplayTransfer. Pixels are converted through an
+ * RGBA8 intermediate laid out like Common::Vec4<u8>, and every kernel gives the same result as
+ * the per-pixel Color:: functions.
+ */
+namespace GPU::PixelConvert {
+
+/**
+ * Fills memory with a repeated 16, 24 or 32-bit value, the same way the fill unit does.
+ * @param start Start of the region
+ * @param end End of the region. A 16 or 24-bit value that only partially fits is still written
+ * whole, a partial 32-bit value is skipped.
+ * @param value Value to fill with, in its little endian byte order
+ * @param bytes_per_value Size of value in bytes, 2, 3 or 4
+ */
+void Fill(u8* start, u8* end, u32 value, u32 bytes_per_value);
+
+/// Decodes count pixels of the given format into RGBA8
+void DecodeRow(Regs::PixelFormat format, const u8* src, u8* rgba, std::size_t count);
+
+/// Encodes count RGBA8 pixels into the given format
+void EncodeRow(Regs::PixelFormat format, const u8* rgba, u8* dst, std::size_t count);
+
+/// Averages each pair of horizontally adjacent RGBA8 pixels, producing count pixels
+void DownscaleRowX(const u8* rgba, u8* dst, std::size_t count);
+
+/// Averages each 2x2 block of RGBA8 pixels spread over two rows, producing count pixels
+void DownscaleRowXY(const u8* row0, const u8* row1, u8* dst, std::size_t count);
+
+} // namespace GPU::PixelConvert
@@ -5,7 +5,10 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <optional>
+#include <vector>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -14,6 +17,8 @@
 #include "core/hle/service/y2r_u.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/video_core.h"
 
 namespace HW::Y2R {
 
@@ -24,55 +29,88 @@ static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
 /// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
-static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
-                            const u8* input_V, ImageTile output[], unsigned int width,
-                            unsigned int height, const CoefficientSet& coefficients) {
+template <InputFormat input_format>
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
+                            ImageTile output[], unsigned int width, unsigned int height,
+                            const CoefficientSet& coefficients) {
+    // Lines are decoded first and converted in a separate pass without branches, the compiler
+    // turns that one into vector code
+    std::array<s32, MAX_TILES * 8> line_Y;
+    std::array<s32, MAX_TILES * 8> line_U;
+    std::array<s32, MAX_TILES * 8> line_V;
+    std::array<u32, MAX_TILES * 8> line_RGB;
+
+    const s32 c0 = coefficients[0];
+    const s32 c1 = coefficients[1];
+    const s32 c2 = coefficients[2];
+    const s32 c3 = coefficients[3];
+    const s32 c4 = coefficients[4];
+    const s32 rounding_offset = 0x18;
+    const s32 offset_r = coefficients[5] + rounding_offset;
+    const s32 offset_g = coefficients[6] + rounding_offset;
+    const s32 offset_b = coefficients[7] + rounding_offset;
 
     for (unsigned int y = 0; y < height; ++y) {
         for (unsigned int x = 0; x < width; ++x) {
-            s32 Y = 0;
-            s32 U = 0;
-            s32 V = 0;
-            switch (input_format) {
-            case InputFormat::YUV422_Indiv8:
-            case InputFormat::YUV422_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[(y * width + x) / 2];
-                V = input_V[(y * width + x) / 2];
-                break;
-            case InputFormat::YUV420_Indiv8:
-            case InputFormat::YUV420_Indiv16:
-                Y = input_Y[y * width + x];
-                U = input_U[((y / 2) * width + x) / 2];
-                V = input_V[((y / 2) * width + x) / 2];
-                break;
-            case InputFormat::YUYV422_Interleaved:
-                Y = input_Y[(y * width + x) * 2];
-                U = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
-                V = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
-                break;
+            if constexpr (input_format == InputFormat::YUV422_Indiv8 ||
+                          input_format == InputFormat::YUV422_Indiv16) {
+                line_Y[x] = input_Y[y * width + x];
+                line_U[x] = input_U[(y * width + x) / 2];
+                line_V[x] = input_V[(y * width + x) / 2];
+            } else if constexpr (input_format == InputFormat::YUV420_Indiv8 ||
+                                 input_format == InputFormat::YUV420_Indiv16) {
+                line_Y[x] = input_Y[y * width + x];
+                line_U[x] = input_U[((y / 2) * width + x) / 2];
+                line_V[x] = input_V[((y / 2) * width + x) / 2];
+            } else {
+                line_Y[x] = input_Y[(y * width + x) * 2];
+                line_U[x] = input_Y[(y * width + (x / 2) * 2) * 2 + 1];
+                line_V[x] = input_Y[(y * width + (x / 2) * 2) * 2 + 3];
             }
+        }
 
+        for (unsigned int x = 0; x < width; ++x) {
             // This conversion process is bit-exact with hardware, as far as could be tested.
-            auto& c = coefficients;
-            s32 cY = c[0] * Y;
-
-            s32 r = cY + c[1] * V;
-            s32 g = cY - c[2] * V - c[3] * U;
-            s32 b = cY + c[4] * U;
-
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
-
-            unsigned int tile = x / 8;
-            unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
-            *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
-                   ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
-                   ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
+            const s32 cY = c0 * line_Y[x];
+            const s32 r = ((cY + c1 * line_V[x]) >> 3) + offset_r;
+            const s32 g = ((cY - c2 * line_V[x] - c3 * line_U[x]) >> 3) + offset_g;
+            const s32 b = ((cY + c4 * line_U[x]) >> 3) + offset_b;
+
+            line_RGB[x] = (static_cast<u32>(std::clamp(r >> 5, 0, 0xFF)) << 24) |
+                          (static_cast<u32>(std::clamp(g >> 5, 0, 0xFF)) << 16) |
+                          (static_cast<u32>(std::clamp(b >> 5, 0, 0xFF)) << 8);
         }
+
+        for (unsigned int tile = 0; tile < width / 8; ++tile) {
+            std::memcpy(&output[tile][y * 8], &line_RGB[tile * 8], 8 * sizeof(u32));
+        }
+    }
+}
+
+static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u8* input_U,
+                            const u8* input_V, ImageTile output[], unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients) {
+    switch (input_format) {
+    case InputFormat::YUV422_Indiv8:
+        ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(input_Y, input_U, input_V, output, width,
+                                                    height, coefficients);
+        break;
+    case InputFormat::YUV420_Indiv8:
+        ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(input_Y, input_U, input_V, output, width,
+                                                    height, coefficients);
+        break;
+    case InputFormat::YUV422_Indiv16:
+        ConvertYUVToRGB<InputFormat::YUV422_Indiv16>(input_Y, input_U, input_V, output, width,
+                                                     height, coefficients);
+        break;
+    case InputFormat::YUV420_Indiv16:
+        ConvertYUVToRGB<InputFormat::YUV420_Indiv16>(input_Y, input_U, input_V, output, width,
+                                                     height, coefficients);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(input_Y, input_U, input_V, output,
+                                                          width, height, coefficients);
+        break;
     }
 }
 
@@ -102,8 +140,9 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
 
 /// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
 /// transfer.
+template <OutputFormat output_format>
 static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
-                     int amount_of_data, OutputFormat output_format, u8 alpha) {
+                     int amount_of_data, u8 alpha) {
 
     u8* output = memory.GetPointer(buf.address);
 
@@ -113,23 +152,18 @@ static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionB
             u32 color = *input++;
             Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
 
-            switch (output_format) {
-            case OutputFormat::RGBA8:
+            if constexpr (output_format == OutputFormat::RGBA8) {
                 Color::EncodeRGBA8(col_vec, output);
                 output += 4;
-                break;
-            case OutputFormat::RGB8:
+            } else if constexpr (output_format == OutputFormat::RGB8) {
                 Color::EncodeRGB8(col_vec, output);
                 output += 3;
-                break;
-            case OutputFormat::RGB5A1:
+            } else if constexpr (output_format == OutputFormat::RGB5A1) {
                 Color::EncodeRGB5A1(col_vec, output);
                 output += 2;
-                break;
-            case OutputFormat::RGB565:
+            } else {
                 Color::EncodeRGB565(col_vec, output);
                 output += 2;
-                break;
             }
 
             amount_of_data -= 1;
@@ -141,6 +175,24 @@ static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionB
     }
 }
 
+static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
+                     int amount_of_data, OutputFormat output_format, u8 alpha) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        SendData<OutputFormat::RGBA8>(memory, input, buf, amount_of_data, alpha);
+        break;
+    case OutputFormat::RGB8:
+        SendData<OutputFormat::RGB8>(memory, input, buf, amount_of_data, alpha);
+        break;
+    case OutputFormat::RGB5A1:
+        SendData<OutputFormat::RGB5A1>(memory, input, buf, amount_of_data, alpha);
+        break;
+    case OutputFormat::RGB565:
+        SendData<OutputFormat::RGB565>(memory, input, buf, amount_of_data, alpha);
+        break;
+    }
+}
+
 static const u8 linear_lut[TILE_SIZE] = {
     // clang-format off
      0,  1,  2,  3,  4,  5,  6,  7,
@@ -169,6 +221,10 @@ static const u8 morton_lut[TILE_SIZE] = {
 
 static void RotateTile0(const ImageTile& input, ImageTile& output, int height,
                         const u8 out_map[64]) {
+    if (out_map == linear_lut) {
+        std::memcpy(output.data(), input.data(), height * 8 * sizeof(u32));
+        return;
+    }
     for (int i = 0; i < height * 8; ++i) {
         output[out_map[i]] = input[i];
     }
@@ -204,10 +260,96 @@ static void RotateTile270(const ImageTile& input, ImageTile& output, int height,
 
 static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, int line_stride) {
     for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            output[y * line_stride + x] = tile[y * 8 + x];
-        }
+        std::memcpy(&output[y * line_stride], &tile[y * 8], 8 * sizeof(u32));
+    }
+}
+
+/// Returns the physical address of a region of the linear heap or VRAM, if it fits in one
+static std::optional<PAddr> GetPhysicalRegion(VAddr addr, u32 size) {
+    const auto InRegion = [addr, size](VAddr region_start, VAddr region_end) {
+        return addr >= region_start && addr < region_end && size <= region_end - addr;
+    };
+    if (InRegion(Memory::VRAM_VADDR, Memory::VRAM_VADDR_END)) {
+        return addr - Memory::VRAM_VADDR + Memory::VRAM_PADDR;
     }
+    if (InRegion(Memory::LINEAR_HEAP_VADDR, Memory::LINEAR_HEAP_VADDR_END)) {
+        return addr - Memory::LINEAR_HEAP_VADDR + Memory::FCRAM_PADDR;
+    }
+    if (InRegion(Memory::NEW_LINEAR_HEAP_VADDR, Memory::NEW_LINEAR_HEAP_VADDR_END)) {
+        return addr - Memory::NEW_LINEAR_HEAP_VADDR + Memory::FCRAM_PADDR;
+    }
+    return std::nullopt;
+}
+
+/**
+ * Converts the whole image on the GPU, straight into the rasterizer cache, so the output only
+ * reaches memory if the CPU reads it. The input is still received like the hardware would.
+ * @return false if the conversion has to run on the CPU, with the configuration left untouched
+ */
+static bool AccelerateConversion(Memory::MemorySystem& memory, ConversionConfiguration& cvt) {
+    // Rotated strips are not a plain image, and gaps would leave holes in the surface
+    if (cvt.rotation != Rotation::None || cvt.dst.gap != 0) {
+        return false;
+    }
+
+    const std::size_t num_pixels = cvt.input_line_width * cvt.input_lines;
+    std::size_t output_bpp = 2;
+    if (cvt.output_format == OutputFormat::RGBA8) {
+        output_bpp = 4;
+    } else if (cvt.output_format == OutputFormat::RGB8) {
+        output_bpp = 3;
+    }
+    const u32 output_size = static_cast<u32>(num_pixels * output_bpp);
+    const std::optional<PAddr> dst_addr = GetPhysicalRegion(cvt.dst.address, output_size);
+    if (!dst_addr) {
+        return false;
+    }
+
+    // The planes are gathered one after the other, the interleaved data takes their place
+    const ConversionConfiguration original = cvt;
+    std::vector<u8> input(num_pixels * 2);
+    u8* const input_Y = input.data();
+    u8* const input_U = input_Y + num_pixels;
+    switch (cvt.input_format) {
+    case InputFormat::YUV422_Indiv8:
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, num_pixels);
+        ReceiveData<1>(memory, input_U, cvt.src_U, num_pixels / 2);
+        ReceiveData<1>(memory, input_U + num_pixels / 2, cvt.src_V, num_pixels / 2);
+        break;
+    case InputFormat::YUV420_Indiv8:
+        input.resize(num_pixels * 3 / 2);
+        ReceiveData<1>(memory, input_Y, cvt.src_Y, num_pixels);
+        ReceiveData<1>(memory, input_U, cvt.src_U, num_pixels / 4);
+        ReceiveData<1>(memory, input_U + num_pixels / 4, cvt.src_V, num_pixels / 4);
+        break;
+    case InputFormat::YUV422_Indiv16:
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, num_pixels);
+        ReceiveData<2>(memory, input_U, cvt.src_U, num_pixels / 2);
+        ReceiveData<2>(memory, input_U + num_pixels / 2, cvt.src_V, num_pixels / 2);
+        break;
+    case InputFormat::YUV420_Indiv16:
+        input.resize(num_pixels * 3 / 2);
+        ReceiveData<2>(memory, input_Y, cvt.src_Y, num_pixels);
+        ReceiveData<2>(memory, input_U, cvt.src_U, num_pixels / 4);
+        ReceiveData<2>(memory, input_U + num_pixels / 4, cvt.src_V, num_pixels / 4);
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        ReceiveData<1>(memory, input_Y, cvt.src_YUYV, num_pixels * 2);
+        break;
+    }
+
+    bool accelerated = false;
+    VideoCore::RunOnGPUThread([&] {
+        accelerated = VideoCore::Rasterizer()->AccelerateY2RConversion(cvt, input, *dst_addr);
+    });
+    if (!accelerated) {
+        cvt = original;
+        return false;
+    }
+
+    cvt.dst.address += output_size;
+    cvt.dst.image_size -= output_size;
+    return true;
 }
 
 /**
@@ -267,6 +409,15 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
     std::size_t num_tiles = cvt.input_line_width / 8;
     ASSERT(num_tiles <= MAX_TILES);
 
+    if (AccelerateConversion(memory, cvt)) {
+        return;
+    }
+
+    // dst_image_size would seem to be perfect for this, but it doesn't include the gap :(
+    const u32 total_output_size = cvt.input_lines * (cvt.dst.transfer_unit + cvt.dst.gap);
+    Memory::RasterizerFlushVirtualRegion(cvt.dst.address, total_output_size,
+                                         Memory::FlushMode::FlushAndInvalidate);
+
     // Buffer used as a CDMA source/target.
     std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
     // Intermediate storage for decoded 8x8 image tiles. Always stored as RGB32.
@@ -323,8 +474,6 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
             break;
         }
 
-        // Note(yuriks): If additional optimization is required, input_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
         ConvertYUVToRGB(cvt.input_format, input_Y, input_U, input_V, tiles.get(),
                         cvt.input_line_width, row_height, cvt.coefficients);
 
@@ -371,8 +520,6 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration& cv
             }
         }
 
-        // Note(yuriks): If additional optimization is required, output_format can be moved to a
-        // template parameter, so that its dispatch can be moved to outside the inner loop.
         SendData(memory, reinterpret_cast<u32*>(data_buffer.get()), cvt.dst, (int)row_data_size,
                  cvt.output_format, (u8)cvt.alpha);
     }
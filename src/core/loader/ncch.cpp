@@ -10,9 +10,11 @@
 #include <memory>
 #include <vector>
 #include <fmt/format.h>
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
 #include "common/swap.h"
+#include "core/cache_file.h"
 #include "core/core.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/title_metadata.h"
@@ -24,6 +26,7 @@
 #include "core/loader/ncch.h"
 #include "core/loader/smdh.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "network/network.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -33,6 +36,13 @@ namespace Loader {
 
 static const u64 UPDATE_MASK = 0x0000000e00000000;
 
+static constexpr u32 CODE_CACHE_VERSION = 0x1;
+
+static std::string GetCodeCacheFile(u64 program_id) {
+    const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    return fmt::format("{}{:016X}.code", dir, program_id);
+}
+
 FileType AppLoader_NCCH::IdentifyType(FileUtil::IOFile& file) {
     u32 magic;
     file.Seek(0x100, SEEK_SET);
@@ -82,8 +92,11 @@ ResultStatus AppLoader_NCCH::LoadExec(std::shared_ptr<Kernel::Process>& process)
 
     std::vector<u8> code;
     u64_le program_id;
-    if (ResultStatus::Success == ReadCode(code) &&
-        ResultStatus::Success == ReadProgramId(program_id)) {
+    // TODO(yuriks): Not sure if the bss size is added to the page-aligned .data size or just
+    //               to the regular size. Playing it safe for now.
+    u32 bss_page_size = (overlay_ncch->exheader_header.codeset_info.bss_size + 0xFFF) & ~0xFFF;
+    if (ResultStatus::Success == ReadProgramId(program_id) &&
+        ResultStatus::Success == ReadPatchedCode(program_id, bss_page_size, code)) {
         std::string process_name = Common::StringFromFixedZeroTerminatedBuffer(
             (const char*)overlay_ncch->exheader_header.codeset_info.name, 8);
 
@@ -101,11 +114,6 @@ ResultStatus AppLoader_NCCH::LoadExec(std::shared_ptr<Kernel::Process>& process)
         codeset->RODataSegment().size =
             overlay_ncch->exheader_header.codeset_info.ro.num_max_pages * Memory::PAGE_SIZE;
 
-        // TODO(yuriks): Not sure if the bss size is added to the page-aligned .data size or just
-        //               to the regular size. Playing it safe for now.
-        u32 bss_page_size = (overlay_ncch->exheader_header.codeset_info.bss_size + 0xFFF) & ~0xFFF;
-        code.resize(code.size() + bss_page_size, 0);
-
         codeset->DataSegment().offset =
             codeset->RODataSegment().offset + codeset->RODataSegment().size;
         codeset->DataSegment().addr = overlay_ncch->exheader_header.codeset_info.data.address;
@@ -113,11 +121,6 @@ ResultStatus AppLoader_NCCH::LoadExec(std::shared_ptr<Kernel::Process>& process)
             overlay_ncch->exheader_header.codeset_info.data.num_max_pages * Memory::PAGE_SIZE +
             bss_page_size;
 
-        // Apply patches now that the entire codeset (including .bss) has been allocated
-        const ResultStatus patch_result = overlay_ncch->ApplyCodePatch(code);
-        if (patch_result != ResultStatus::Success && patch_result != ResultStatus::ErrorNotUsed)
-            return patch_result;
-
         codeset->entrypoint = codeset->CodeSegment().addr;
         codeset->memory = std::move(code);
         if (codeset->entrypoint == 0) {
@@ -152,6 +155,59 @@ ResultStatus AppLoader_NCCH::LoadExec(std::shared_ptr<Kernel::Process>& process)
     return ResultStatus::Error;
 }
 
+ResultStatus AppLoader_NCCH::ReadPatchedCode(u64 program_id, u32 bss_size,
+                                             std::vector<u8>& code) {
+    const std::string cache_file = GetCodeCacheFile(program_id);
+    const u64 key = Settings::values.use_code_cache ? overlay_ncch->GetCodeCacheKey() : 0;
+    if (Settings::values.use_code_cache && FileUtil::Exists(cache_file)) {
+        Core::CacheFile file(cache_file, Core::CacheFile::MODE_LOAD);
+
+        u32 version = 0;
+        u64 cached_key = 0;
+        file.DoHeader(version);
+        file.Do(cached_key);
+        if (version == CODE_CACHE_VERSION && cached_key == key) {
+            file.Do(code);
+            if (file.IsGood()) {
+                LOG_INFO(Loader, "Loaded the code of {:016X} from the cache", program_id);
+                return ResultStatus::Success;
+            }
+        }
+        code.clear();
+    }
+
+    ResultStatus result = ReadCode(code);
+    if (result != ResultStatus::Success)
+        return result;
+    code.resize(code.size() + bss_size, 0);
+
+    // Apply patches now that the entire codeset (including .bss) has been allocated
+    result = overlay_ncch->ApplyCodePatch(code);
+    if (result != ResultStatus::Success && result != ResultStatus::ErrorNotUsed)
+        return result;
+
+    if (Settings::values.use_code_cache) {
+        const std::string temp_path = cache_file + ".tmp";
+        bool saved;
+        {
+            Core::CacheFile file(temp_path, Core::CacheFile::MODE_SAVE);
+
+            u32 version = CODE_CACHE_VERSION;
+            u64 saved_key = key;
+            file.DoHeader(version);
+            file.Do(saved_key);
+            file.Do(code);
+            saved = file.IsGood();
+        }
+        if (saved) {
+            FileUtil::Rename(temp_path, cache_file);
+        } else {
+            FileUtil::Delete(temp_path);
+        }
+    }
+    return ResultStatus::Success;
+}
+
 void AppLoader_NCCH::ParseRegionLockoutInfo() {
     std::vector<u8> smdh_buffer;
     if (ReadIcon(smdh_buffer) == ResultStatus::Success && smdh_buffer.size() >= sizeof(SMDH)) {
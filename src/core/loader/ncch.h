@@ -75,6 +75,16 @@ private:
      */
     ResultStatus LoadExec(std::shared_ptr<Kernel::Process>& process);
 
+    /**
+     * Reads the .code section with its .bss allocated and its patches applied, from the code cache
+     * when it is enabled and up to date
+     * @param program_id Program ID of the title, which names the cache file
+     * @param bss_size Size of the .bss appended to the code
+     * @param code Buffer receiving the code
+     * @return ResultStatus result of function
+     */
+    ResultStatus ReadPatchedCode(u64 program_id, u32 bss_size, std::vector<u8>& code);
+
     /// Reads the region lockout info in the SMDH and send it to CFG service
     void ParseRegionLockoutInfo();
 
@@ -4,69 +4,112 @@
 
 #include <array>
 #include <cstring>
+#include <mutex>
+#include <minilzo.h>
 #include "audio_core/dsp_interface.h"
 #include "common/assert.h"
+#include "common/atomic_ops.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "common/virtual_buffer.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/lock.h"
 #include "core/memory.h"
+#include "core/settings.h"
 #include "video_core/renderer_base.h"
 #include "video_core/video_core.h"
 
 namespace Memory {
 
+/// Rasterizer-cached state of the pages that the cache can hold, one bit per page
 class RasterizerCacheMarker {
 public:
-    void Mark(VAddr addr, bool cached) {
-        bool* p = At(addr);
-        if (p)
-            *p = cached;
+    /// Marks the pages starting at addr, which must all lie in the same region
+    void Mark(VAddr addr, u32 num_pages, bool cached) {
+        u64* bitmap = At(addr);
+        if (!bitmap)
+            return;
+
+        u32 page = (addr >> PAGE_BITS) % BITS_PER_WORD;
+        while (num_pages > 0) {
+            const u32 count = std::min(num_pages, BITS_PER_WORD - page);
+            const u64 mask = (count == BITS_PER_WORD ? ~u64{0} : (u64{1} << count) - 1) << page;
+            if (cached) {
+                *bitmap |= mask;
+            } else {
+                *bitmap &= ~mask;
+            }
+            num_pages -= count;
+            page = 0;
+            ++bitmap;
+        }
     }
 
     bool IsCached(VAddr addr) {
-        bool* p = At(addr);
-        if (p)
-            return *p;
+        const u64* bitmap = At(addr);
+        if (bitmap)
+            return (*bitmap >> ((addr >> PAGE_BITS) % BITS_PER_WORD)) & 1;
         return false;
     }
 
 private:
-    bool* At(VAddr addr) {
+    static constexpr u32 BITS_PER_WORD = 64;
+
+    /// Returns the bitmap word holding the page of addr
+    u64* At(VAddr addr) {
         if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
-            return &vram[(addr - VRAM_VADDR) / PAGE_SIZE];
+            return &vram[(addr - VRAM_VADDR) / PAGE_SIZE / BITS_PER_WORD];
         }
         if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
-            return &linear_heap[(addr - LINEAR_HEAP_VADDR) / PAGE_SIZE];
+            return &linear_heap[(addr - LINEAR_HEAP_VADDR) / PAGE_SIZE / BITS_PER_WORD];
         }
         if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
-            return &new_linear_heap[(addr - NEW_LINEAR_HEAP_VADDR) / PAGE_SIZE];
+            return &new_linear_heap[(addr - NEW_LINEAR_HEAP_VADDR) / PAGE_SIZE / BITS_PER_WORD];
         }
         return nullptr;
     }
 
-    std::array<bool, VRAM_SIZE / PAGE_SIZE> vram{};
-    std::array<bool, LINEAR_HEAP_SIZE / PAGE_SIZE> linear_heap{};
-    std::array<bool, NEW_LINEAR_HEAP_SIZE / PAGE_SIZE> new_linear_heap{};
+    std::array<u64, VRAM_SIZE / PAGE_SIZE / BITS_PER_WORD> vram{};
+    std::array<u64, LINEAR_HEAP_SIZE / PAGE_SIZE / BITS_PER_WORD> linear_heap{};
+    std::array<u64, NEW_LINEAR_HEAP_SIZE / PAGE_SIZE / BITS_PER_WORD> new_linear_heap{};
 };
 
 class MemorySystem::Impl {
 public:
-    // Visual Studio would try to allocate these on compile time if they are std::array, which would
-    // exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // Only reserved up front, an Old 3DS title never touches the New 3DS part of FCRAM nor the
+    // extra RAM, so they don't take host memory.
+    Common::VirtualBuffer fcram_buffer{Memory::FCRAM_N3DS_SIZE, Settings::values.use_huge_pages};
+    Common::VirtualBuffer vram_buffer{Memory::VRAM_SIZE, Settings::values.use_huge_pages};
+    Common::VirtualBuffer n3ds_extra_ram_buffer{Memory::N3DS_EXTRA_RAM_SIZE,
+                                                Settings::values.use_huge_pages};
+    u8* const fcram = fcram_buffer.data();
+    u8* const vram = vram_buffer.data();
+    u8* const n3ds_extra_ram = n3ds_extra_ram_buffer.data();
 
     PageTable* current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
     std::vector<PageTable*> page_table_list;
-
-    AudioCore::DspInterface* dsp = nullptr;
+    /// Guards the page table list, whose pages the GPU thread marks as cached
+    std::mutex page_table_mutex;
+    /// Serializes the accesses to rasterizer cached pages of the cores running on host threads
+    std::mutex cached_access_mutex;
+
+    /// DSP RAM lives as long as the DSP, so its pointer is fetched once instead of per access
+    u8* dsp_ram = nullptr;
+
+    /// The memory a RAM snapshot covers, in the order of its pages
+    std::array<std::pair<u8*, u32>, 3> GetRamRegions() const {
+        return {{
+            {fcram, Memory::FCRAM_N3DS_SIZE},
+            {vram, Memory::VRAM_SIZE},
+            {n3ds_extra_ram, Memory::N3DS_EXTRA_RAM_SIZE},
+        }};
+    }
 };
 
 MemorySystem::MemorySystem() : impl(std::make_unique<Impl>()) {}
@@ -120,29 +163,31 @@ void MemorySystem::UnmapRegion(PageTable& page_table, VAddr base, u32 size) {
 
 u8* MemorySystem::GetPointerForRasterizerCache(VAddr addr) {
     if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
-        return impl->fcram.get() + (addr - LINEAR_HEAP_VADDR);
+        return impl->fcram + (addr - LINEAR_HEAP_VADDR);
     }
     if (addr >= NEW_LINEAR_HEAP_VADDR && addr < NEW_LINEAR_HEAP_VADDR_END) {
-        return impl->fcram.get() + (addr - NEW_LINEAR_HEAP_VADDR);
+        return impl->fcram + (addr - NEW_LINEAR_HEAP_VADDR);
     }
     if (addr >= VRAM_VADDR && addr < VRAM_VADDR_END) {
-        return impl->vram.get() + (addr - VRAM_VADDR);
+        return impl->vram + (addr - VRAM_VADDR);
     }
     UNREACHABLE();
 }
 
 void MemorySystem::RegisterPageTable(PageTable* page_table) {
+    std::lock_guard lock{impl->page_table_mutex};
     impl->page_table_list.push_back(page_table);
 }
 
 void MemorySystem::UnregisterPageTable(PageTable* page_table) {
+    std::lock_guard lock{impl->page_table_mutex};
     impl->page_table_list.erase(
         std::find(impl->page_table_list.begin(), impl->page_table_list.end(), page_table));
 }
 
 template <typename T>
-T MemorySystem::Read(const VAddr vaddr) {
-    const u8* page_pointer = impl->current_page_table->pointers[vaddr >> PAGE_BITS];
+T MemorySystem::Read(const PageTable& page_table, const VAddr vaddr) {
+    const u8* page_pointer = page_table.pointers[vaddr >> PAGE_BITS];
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         T value;
@@ -150,7 +195,7 @@ T MemorySystem::Read(const VAddr vaddr) {
         return value;
     }
 
-    PageType type = impl->current_page_table->attributes[vaddr >> PAGE_BITS];
+    PageType type = page_table.attributes[vaddr >> PAGE_BITS];
     switch (type) {
     case PageType::Unmapped:
         LOG_ERROR(HW_Memory, "unmapped Read{} @ 0x{:08X}", sizeof(T) * 8, vaddr);
@@ -159,6 +204,7 @@ T MemorySystem::Read(const VAddr vaddr) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         return 0;
     case PageType::RasterizerCachedMemory: {
+        std::lock_guard lock{impl->cached_access_mutex};
         T value;
         RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Flush);
         std::memcpy(&value, GetPointerForRasterizerCache(vaddr), sizeof(T));
@@ -170,15 +216,15 @@ T MemorySystem::Read(const VAddr vaddr) {
 }
 
 template <typename T>
-void MemorySystem::Write(const VAddr vaddr, const T data) {
-    u8* page_pointer = impl->current_page_table->pointers[vaddr >> PAGE_BITS];
+void MemorySystem::Write(const PageTable& page_table, const VAddr vaddr, const T data) {
+    u8* page_pointer = page_table.pointers[vaddr >> PAGE_BITS];
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         std::memcpy(&page_pointer[vaddr & PAGE_MASK], &data, sizeof(T));
         return;
     }
 
-    PageType type = impl->current_page_table->attributes[vaddr >> PAGE_BITS];
+    PageType type = page_table.attributes[vaddr >> PAGE_BITS];
     switch (type) {
     case PageType::Unmapped:
         LOG_ERROR(HW_Memory, "unmapped Write{} 0x{:08X} @ 0x{:08X}", sizeof(data) * 8, (u32)data,
@@ -188,6 +234,7 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
+        std::lock_guard lock{impl->cached_access_mutex};
         RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
         std::memcpy(GetPointerForRasterizerCache(vaddr), &data, sizeof(T));
         break;
@@ -197,6 +244,35 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
     }
 }
 
+template <typename T>
+bool MemorySystem::WriteExclusive(const PageTable& page_table, const VAddr vaddr, const T data,
+                                  const T expected) {
+    u8* page_pointer = page_table.pointers[vaddr >> PAGE_BITS];
+    if (page_pointer) {
+        return Common::AtomicCompareAndSwap(
+            reinterpret_cast<volatile T*>(&page_pointer[vaddr & PAGE_MASK]), data, expected);
+    }
+
+    PageType type = page_table.attributes[vaddr >> PAGE_BITS];
+    switch (type) {
+    case PageType::Unmapped:
+        LOG_ERROR(HW_Memory, "unmapped Write{} 0x{:08X} @ 0x{:08X}", sizeof(data) * 8, (u32)data,
+                  vaddr);
+        return true;
+    case PageType::Memory:
+        ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
+        return true;
+    case PageType::RasterizerCachedMemory: {
+        std::lock_guard lock{impl->cached_access_mutex};
+        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
+        return Common::AtomicCompareAndSwap(
+            reinterpret_cast<volatile T*>(GetPointerForRasterizerCache(vaddr)), data, expected);
+    }
+    default:
+        UNREACHABLE();
+    }
+}
+
 bool IsValidVirtualAddress(const Kernel::Process& process, const VAddr vaddr) {
     auto& page_table = process.vm_manager.page_table;
 
@@ -250,38 +326,59 @@ std::string MemorySystem::ReadCString(VAddr vaddr, u32 max_length) {
 
 u8* MemorySystem::GetPhysicalPointer(PAddr address) {
     if (address >= VRAM_PADDR && address <= VRAM_PADDR_END) {
-        return impl->vram.get() + (address - VRAM_PADDR);
+        return impl->vram + (address - VRAM_PADDR);
     }
     if (address >= DSP_RAM_PADDR && address <= DSP_RAM_PADDR_END) {
-        return impl->dsp->GetDspMemory().data() + (address - DSP_RAM_PADDR);
+        return impl->dsp_ram + (address - DSP_RAM_PADDR);
     }
     if (address >= FCRAM_PADDR && address <= FCRAM_N3DS_PADDR_END) {
-        return impl->fcram.get() + (address - FCRAM_PADDR);
+        return impl->fcram + (address - FCRAM_PADDR);
     }
     if (address >= N3DS_EXTRA_RAM_PADDR && address <= N3DS_EXTRA_RAM_PADDR_END) {
-        return impl->n3ds_extra_ram.get() + (address - N3DS_EXTRA_RAM_PADDR);
+        return impl->n3ds_extra_ram + (address - N3DS_EXTRA_RAM_PADDR);
     }
     LOG_ERROR(HW_Memory, "unknown GetPhysicalPointer @ 0x{:08X}", address);
     return nullptr;
 }
 
-/// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
-static std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr) {
-    if (addr >= VRAM_PADDR && addr < VRAM_PADDR_END) {
-        return {addr - VRAM_PADDR + VRAM_VADDR};
-    }
-    if (addr >= FCRAM_PADDR && addr < FCRAM_PADDR_END) {
-        return {addr - FCRAM_PADDR + LINEAR_HEAP_VADDR, addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
-    }
-    if (addr >= FCRAM_PADDR_END && addr < FCRAM_N3DS_PADDR_END) {
-        return {addr - FCRAM_PADDR + NEW_LINEAR_HEAP_VADDR};
+void MemorySystem::MarkPagesCached(PageTable& page_table, VAddr vaddr, u32 num_pages,
+                                   bool cached) {
+    for (u32 page = vaddr >> PAGE_BITS; num_pages > 0; ++page, --num_pages, vaddr += PAGE_SIZE) {
+        PageType& page_type = page_table.attributes[page];
+
+        if (cached) {
+            // Switch page type to cached if now cached
+            switch (page_type) {
+            case PageType::Unmapped:
+                // It is not necessary for a process to have this region mapped into its
+                // address space, for example, a system module need not have a VRAM mapping.
+                break;
+            case PageType::Memory:
+                page_type = PageType::RasterizerCachedMemory;
+                page_table.pointers[page] = nullptr;
+                break;
+            default:
+                UNREACHABLE();
+            }
+        } else {
+            // Switch page type to uncached if now uncached
+            switch (page_type) {
+            case PageType::Unmapped:
+                // It is not necessary for a process to have this region mapped into its
+                // address space, for example, a system module need not have a VRAM mapping.
+                break;
+            case PageType::RasterizerCachedMemory: {
+                // The pointer goes first, as the emulation thread may read the page while
+                // the GPU thread marks it and a plain page without a pointer is fatal
+                page_table.pointers[page] = GetPointerForRasterizerCache(vaddr);
+                page_type = PageType::Memory;
+                break;
+            }
+            default:
+                UNREACHABLE();
+            }
+        }
     }
-    // While the physical <-> virtual mapping is 1:1 for the regions supported by the cache,
-    // some games (like Pokemon Super Mystery Dungeon) will try to use textures that go beyond
-    // the end address of VRAM, causing the Virtual->Physical translation to fail when flushing
-    // parts of the texture.
-    LOG_ERROR(HW_Memory, "Trying to use invalid physical address for rasterizer: {:08X}", addr);
-    return {};
 }
 
 void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
@@ -289,252 +386,324 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
-    u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
-    PAddr paddr = start;
-
-    for (unsigned i = 0; i < num_pages; ++i, paddr += PAGE_SIZE) {
-        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
-            impl->cache_marker.Mark(vaddr, cached);
-            for (auto page_table : impl->page_table_list) {
-                PageType& page_type = page_table->attributes[vaddr >> PAGE_BITS];
-
-                if (cached) {
-                    // Switch page type to cached if now cached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::Memory:
-                        page_type = PageType::RasterizerCachedMemory;
-                        page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
-                        break;
-                    default:
-                        UNREACHABLE();
-                    }
-                } else {
-                    // Switch page type to uncached if now uncached
-                    switch (page_type) {
-                    case PageType::Unmapped:
-                        // It is not necessary for a process to have this region mapped into its
-                        // address space, for example, a system module need not have a VRAM mapping.
-                        break;
-                    case PageType::RasterizerCachedMemory: {
-                        page_type = PageType::Memory;
-                        page_table->pointers[vaddr >> PAGE_BITS] =
-                            GetPointerForRasterizerCache(vaddr & ~PAGE_MASK);
-                        break;
-                    }
-                    default:
-                        UNREACHABLE();
-                    }
-                }
-            }
+    const PAddr pages_start = start & ~PAGE_MASK;
+    const PAddr pages_end = ((start + size - 1) & ~PAGE_MASK) + PAGE_SIZE;
+
+    const auto OverlapSize = [pages_start, pages_end](PAddr region_start, PAddr region_end) {
+        const PAddr overlap_start = std::max(pages_start, region_start);
+        const PAddr overlap_end = std::min(pages_end, region_end);
+        return overlap_start < overlap_end ? overlap_end - overlap_start : 0;
+    };
+
+    // Each physical region supported by the cache maps 1:1 to one or two virtual regions, so the
+    // pages are marked a whole virtual range at a time
+    const auto MarkAlias = [&](PAddr region_start, PAddr region_end, VAddr vaddr_region_start) {
+        const u32 overlap_size = OverlapSize(region_start, region_end);
+        if (overlap_size == 0) {
+            return;
         }
+        const VAddr vaddr =
+            std::max(pages_start, region_start) - region_start + vaddr_region_start;
+        const u32 num_pages = overlap_size >> PAGE_BITS;
+
+        impl->cache_marker.Mark(vaddr, num_pages, cached);
+        for (auto page_table : impl->page_table_list) {
+            MarkPagesCached(*page_table, vaddr, num_pages, cached);
+        }
+    };
+
+    std::lock_guard lock{impl->page_table_mutex};
+    MarkAlias(VRAM_PADDR, VRAM_PADDR_END, VRAM_VADDR);
+    MarkAlias(FCRAM_PADDR, FCRAM_PADDR_END, LINEAR_HEAP_VADDR);
+    MarkAlias(FCRAM_PADDR, FCRAM_N3DS_PADDR_END, NEW_LINEAR_HEAP_VADDR);
+
+    // While the physical <-> virtual mapping is 1:1 for the regions supported by the cache,
+    // some games (like Pokemon Super Mystery Dungeon) will try to use textures that go beyond
+    // the end address of VRAM, causing the Virtual->Physical translation to fail when flushing
+    // parts of the texture.
+    if (OverlapSize(VRAM_PADDR, VRAM_PADDR_END) + OverlapSize(FCRAM_PADDR, FCRAM_N3DS_PADDR_END) !=
+        pages_end - pages_start) {
+        LOG_ERROR(HW_Memory, "Trying to use invalid physical address for rasterizer: {:08X}",
+                  start);
     }
 }
 
 void RasterizerFlushRegion(PAddr start, u32 size) {
-    VideoCore::Rasterizer()->FlushRegion(start, size);
+    VideoCore::RunOnGPUThread([=] { VideoCore::Rasterizer()->FlushRegion(start, size); });
 }
 
 void RasterizerInvalidateRegion(PAddr start, u32 size) {
-    VideoCore::Rasterizer()->InvalidateRegion(start, size);
+    VideoCore::RunOnGPUThread([=] { VideoCore::Rasterizer()->InvalidateRegion(start, size); });
 }
 
 void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
-    VideoCore::Rasterizer()->FlushAndInvalidateRegion(start, size);
+    VideoCore::RunOnGPUThread(
+        [=] { VideoCore::Rasterizer()->FlushAndInvalidateRegion(start, size); });
 }
 
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
     VAddr end = start + size;
 
-    auto CheckRegion = [&](VAddr region_start, VAddr region_end, PAddr paddr_region_start) {
-        if (start >= region_end || end <= region_start) {
-            // No overlap with region
-            return;
-        }
+    // Mappings outside of the regions the cache can hold have nothing to flush, and need not wait
+    // for the GPU thread
+    const auto Overlaps = [&](VAddr region_start, VAddr region_end) {
+        return start < region_end && end > region_start;
+    };
+    if (!Overlaps(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END) &&
+        !Overlaps(NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR_END) &&
+        !Overlaps(VRAM_VADDR, VRAM_VADDR_END)) {
+        return;
+    }
 
-        VAddr overlap_start = std::max(start, region_start);
-        VAddr overlap_end = std::min(end, region_end);
-        PAddr physical_start = paddr_region_start + (overlap_start - region_start);
-        u32 overlap_size = overlap_end - overlap_start;
+    const auto ForEachOverlap = [&](auto&& func) {
+        const auto CheckRegion = [&](VAddr region_start, VAddr region_end,
+                                     PAddr paddr_region_start) {
+            if (!Overlaps(region_start, region_end)) {
+                return;
+            }
 
-        auto* rasterizer = VideoCore::Rasterizer();
-        switch (mode) {
-        case FlushMode::Flush:
-            rasterizer->FlushRegion(physical_start, overlap_size);
-            break;
-        case FlushMode::Invalidate:
-            rasterizer->InvalidateRegion(physical_start, overlap_size);
-            break;
-        case FlushMode::FlushAndInvalidate:
-            rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
-            break;
-        }
+            VAddr overlap_start = std::max(start, region_start);
+            VAddr overlap_end = std::min(end, region_end);
+            func(paddr_region_start + (overlap_start - region_start), overlap_end - overlap_start);
+        };
+        CheckRegion(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END, FCRAM_PADDR);
+        CheckRegion(NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR_END, FCRAM_PADDR);
+        CheckRegion(VRAM_VADDR, VRAM_VADDR_END, VRAM_PADDR);
     };
 
-    CheckRegion(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END, FCRAM_PADDR);
-    CheckRegion(NEW_LINEAR_HEAP_VADDR, NEW_LINEAR_HEAP_VADDR_END, FCRAM_PADDR);
-    CheckRegion(VRAM_VADDR, VRAM_VADDR_END, VRAM_PADDR);
+    // A store only drops the surfaces cached over the region. Nothing can use them before the
+    // GPU work queued next, which the GPU thread runs after the invalidation.
+    VideoCore::GPUThread* gpu_thread = VideoCore::GetGPUThread();
+    if (mode == FlushMode::Invalidate && gpu_thread && !gpu_thread->IsCurrentThread()) {
+        ForEachOverlap([gpu_thread](PAddr physical_start, u32 overlap_size) {
+            gpu_thread->QueueInvalidation(physical_start, overlap_size);
+        });
+        return;
+    }
+
+    // The rasterizer cache belongs to the GPU thread, which also has to be done with the work
+    // queued before the flush
+    VideoCore::RunOnGPUThread([&] {
+        ForEachOverlap([mode](PAddr physical_start, u32 overlap_size) {
+            auto* rasterizer = VideoCore::Rasterizer();
+            switch (mode) {
+            case FlushMode::Flush:
+                rasterizer->FlushRegion(physical_start, overlap_size);
+                break;
+            case FlushMode::Invalidate:
+                rasterizer->InvalidateRegion(physical_start, overlap_size);
+                break;
+            case FlushMode::FlushAndInvalidate:
+                rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
+                break;
+            }
+        });
+    });
 }
 
 u8 MemorySystem::Read8(const VAddr addr) {
-    return Read<u8>(addr);
+    return Read<u8>(*impl->current_page_table, addr);
 }
 
 u16 MemorySystem::Read16(const VAddr addr) {
-    return Read<u16_le>(addr);
+    return Read<u16_le>(*impl->current_page_table, addr);
 }
 
 u32 MemorySystem::Read32(const VAddr addr) {
-    return Read<u32_le>(addr);
+    return Read<u32_le>(*impl->current_page_table, addr);
 }
 
 u64 MemorySystem::Read64(const VAddr addr) {
-    return Read<u64_le>(addr);
-}
-
-void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
-                             void* dest_buffer, const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped ReadBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, src_addr, size);
-            std::memset(dest_buffer, 0, copy_amount);
+    return Read<u64_le>(*impl->current_page_table, addr);
+}
+
+template <typename Visitor>
+void MemorySystem::WalkBlock(const PageTable& page_table, const VAddr addr, const std::size_t size,
+                             Visitor&& visitor) {
+    std::size_t offset = 0;
+    std::size_t page_index = addr >> PAGE_BITS;
+    std::size_t page_offset = addr & PAGE_MASK;
+
+    while (offset < size) {
+        const PageType type = page_table.attributes[page_index];
+        const VAddr span_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
+        u8* span_ptr = nullptr;
+        switch (type) {
+        case PageType::Unmapped:
             break;
-        }
-        case PageType::Memory: {
+        case PageType::Memory:
             DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_buffer, src_ptr, copy_amount);
+            span_ptr = page_table.pointers[page_index] + page_offset;
             break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
+        case PageType::RasterizerCachedMemory:
+            span_ptr = GetPointerForRasterizerCache(span_vaddr);
             break;
-        }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
+        // The span grows over the following pages of the same type whose host memory follows
+        std::size_t span_size = std::min<std::size_t>(PAGE_SIZE - page_offset, size - offset);
+        ++page_index;
+        while (offset + span_size < size && page_index < PAGE_TABLE_NUM_ENTRIES &&
+               page_table.attributes[page_index] == type) {
+            if (type == PageType::Memory &&
+                page_table.pointers[page_index] != span_ptr + span_size) {
+                break;
+            }
+            if (type == PageType::RasterizerCachedMemory &&
+                GetPointerForRasterizerCache(static_cast<VAddr>(page_index << PAGE_BITS)) !=
+                    span_ptr + span_size) {
+                break;
+            }
+            span_size += std::min<std::size_t>(PAGE_SIZE, size - offset - span_size);
+            ++page_index;
+        }
+
+        visitor(type, span_vaddr, offset, span_size, span_ptr);
+        offset += span_size;
         page_offset = 0;
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
     }
 }
 
+void MemorySystem::ReadBlock(const Kernel::Process& process, const VAddr src_addr,
+                             void* dest_buffer, const std::size_t size) {
+    u8* dest = static_cast<u8*>(dest_buffer);
+    WalkBlock(process.vm_manager.page_table, src_addr, size,
+              [&](PageType type, VAddr span_vaddr, std::size_t offset, std::size_t span_size,
+                  u8* span_ptr) {
+                  switch (type) {
+                  case PageType::Unmapped:
+                      LOG_ERROR(HW_Memory,
+                                "unmapped ReadBlock @ 0x{:08X} (start address = 0x{:08X}, size = "
+                                "{})",
+                                span_vaddr, src_addr, size);
+                      std::memset(dest + offset, 0, span_size);
+                      break;
+                  case PageType::RasterizerCachedMemory:
+                      RasterizerFlushVirtualRegion(span_vaddr, static_cast<u32>(span_size),
+                                                   FlushMode::Flush);
+                      [[fallthrough]];
+                  default:
+                      std::memcpy(dest + offset, span_ptr, span_size);
+                      break;
+                  }
+              });
+}
+
 void MemorySystem::Write8(const VAddr addr, const u8 data) {
-    Write<u8>(addr, data);
+    Write<u8>(*impl->current_page_table, addr, data);
 }
 
 void MemorySystem::Write16(const VAddr addr, const u16 data) {
-    Write<u16_le>(addr, data);
+    Write<u16_le>(*impl->current_page_table, addr, data);
 }
 
 void MemorySystem::Write32(const VAddr addr, const u32 data) {
-    Write<u32_le>(addr, data);
+    Write<u32_le>(*impl->current_page_table, addr, data);
 }
 
 void MemorySystem::Write64(const VAddr addr, const u64 data) {
-    Write<u64_le>(addr, data);
+    Write<u64_le>(*impl->current_page_table, addr, data);
+}
+
+u8 MemorySystem::Read8(const PageTable& page_table, const VAddr addr) {
+    return Read<u8>(page_table, addr);
+}
+
+u16 MemorySystem::Read16(const PageTable& page_table, const VAddr addr) {
+    return Read<u16_le>(page_table, addr);
+}
+
+u32 MemorySystem::Read32(const PageTable& page_table, const VAddr addr) {
+    return Read<u32_le>(page_table, addr);
+}
+
+u64 MemorySystem::Read64(const PageTable& page_table, const VAddr addr) {
+    return Read<u64_le>(page_table, addr);
+}
+
+void MemorySystem::Write8(const PageTable& page_table, const VAddr addr, const u8 data) {
+    Write<u8>(page_table, addr, data);
+}
+
+void MemorySystem::Write16(const PageTable& page_table, const VAddr addr, const u16 data) {
+    Write<u16_le>(page_table, addr, data);
+}
+
+void MemorySystem::Write32(const PageTable& page_table, const VAddr addr, const u32 data) {
+    Write<u32_le>(page_table, addr, data);
+}
+
+void MemorySystem::Write64(const PageTable& page_table, const VAddr addr, const u64 data) {
+    Write<u64_le>(page_table, addr, data);
+}
+
+bool MemorySystem::WriteExclusive8(const PageTable& page_table, const VAddr addr, const u8 data,
+                                   const u8 expected) {
+    return WriteExclusive<u8>(page_table, addr, data, expected);
+}
+
+bool MemorySystem::WriteExclusive16(const PageTable& page_table, const VAddr addr, const u16 data,
+                                    const u16 expected) {
+    return WriteExclusive<u16>(page_table, addr, data, expected);
+}
+
+bool MemorySystem::WriteExclusive32(const PageTable& page_table, const VAddr addr, const u32 data,
+                                    const u32 expected) {
+    return WriteExclusive<u32>(page_table, addr, data, expected);
+}
+
+bool MemorySystem::WriteExclusive64(const PageTable& page_table, const VAddr addr, const u64 data,
+                                    const u64 expected) {
+    return WriteExclusive<u64>(page_table, addr, data, expected);
 }
 
 void MemorySystem::WriteBlock(const Kernel::Process& process, const VAddr dest_addr,
                               const void* src_buffer, const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped WriteBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, dest_addr, size);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memcpy(dest_ptr, src_buffer, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
-    }
+    const u8* src = static_cast<const u8*>(src_buffer);
+    WalkBlock(process.vm_manager.page_table, dest_addr, size,
+              [&](PageType type, VAddr span_vaddr, std::size_t offset, std::size_t span_size,
+                  u8* span_ptr) {
+                  switch (type) {
+                  case PageType::Unmapped:
+                      LOG_ERROR(HW_Memory,
+                                "unmapped WriteBlock @ 0x{:08X} (start address = 0x{:08X}, size = "
+                                "{})",
+                                span_vaddr, dest_addr, size);
+                      break;
+                  case PageType::RasterizerCachedMemory:
+                      RasterizerFlushVirtualRegion(span_vaddr, static_cast<u32>(span_size),
+                                                   FlushMode::Invalidate);
+                      [[fallthrough]];
+                  default:
+                      std::memcpy(span_ptr, src + offset, span_size);
+                      break;
+                  }
+              });
 }
 
 void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_addr,
                              const std::size_t size) {
-    auto& page_table = process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> PAGE_BITS;
-    std::size_t page_offset = dest_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped ZeroBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, dest_addr, size);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memset(dest_ptr, 0, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
-    }
+    WalkBlock(process.vm_manager.page_table, dest_addr, size,
+              [&](PageType type, VAddr span_vaddr, std::size_t offset, std::size_t span_size,
+                  u8* span_ptr) {
+                  switch (type) {
+                  case PageType::Unmapped:
+                      LOG_ERROR(HW_Memory,
+                                "unmapped ZeroBlock @ 0x{:08X} (start address = 0x{:08X}, size = "
+                                "{})",
+                                span_vaddr, dest_addr, size);
+                      break;
+                  case PageType::RasterizerCachedMemory:
+                      RasterizerFlushVirtualRegion(span_vaddr, static_cast<u32>(span_size),
+                                                   FlushMode::Invalidate);
+                      [[fallthrough]];
+                  default:
+                      std::memset(span_ptr, 0, span_size);
+                      break;
+                  }
+              });
 }
 
 void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
@@ -545,61 +714,131 @@ void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VA
 void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
                              const Kernel::Process& src_process, VAddr dest_addr, VAddr src_addr,
                              std::size_t size) {
-    auto& page_table = src_process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> PAGE_BITS;
-    std::size_t page_offset = src_addr & PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = static_cast<VAddr>((page_index << PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped CopyBlock @ 0x{:08X} (start address = 0x{:08X}, size = {})",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(dest_process, dest_addr, copy_amount);
-            break;
-        }
-        case PageType::Memory: {
-            DEBUG_ASSERT(page_table.pointers[page_index]);
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            WriteBlock(dest_process, dest_addr, src_ptr, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
-                       copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
-    }
+    WalkBlock(src_process.vm_manager.page_table, src_addr, size,
+              [&](PageType type, VAddr span_vaddr, std::size_t offset, std::size_t span_size,
+                  u8* span_ptr) {
+                  const VAddr span_dest = dest_addr + static_cast<VAddr>(offset);
+                  switch (type) {
+                  case PageType::Unmapped:
+                      LOG_ERROR(HW_Memory,
+                                "unmapped CopyBlock @ 0x{:08X} (start address = 0x{:08X}, size = "
+                                "{})",
+                                span_vaddr, src_addr, size);
+                      ZeroBlock(dest_process, span_dest, span_size);
+                      break;
+                  case PageType::RasterizerCachedMemory:
+                      RasterizerFlushVirtualRegion(span_vaddr, static_cast<u32>(span_size),
+                                                   FlushMode::Flush);
+                      [[fallthrough]];
+                  default:
+                      WriteBlock(dest_process, span_dest, span_ptr, span_size);
+                      break;
+                  }
+              });
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) {
-    DEBUG_ASSERT(pointer >= impl->fcram.get() &&
-                 pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return static_cast<u32>(pointer - impl->fcram.get());
+    DEBUG_ASSERT(pointer >= impl->fcram && pointer <= impl->fcram + Memory::FCRAM_N3DS_SIZE);
+    return static_cast<u32>(pointer - impl->fcram);
 }
 
 u8* MemorySystem::GetFCRAMPointer(u32 offset) {
     DEBUG_ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 void MemorySystem::SetDSP(AudioCore::DspInterface& dsp) {
-    impl->dsp = &dsp;
+    impl->dsp_ram = dsp.GetDspMemory().data();
+}
+
+std::size_t RamSnapshot::GetCompressedSize() const {
+    std::size_t size = 0;
+    for (const Page& page : pages) {
+        size += page.data->size();
+    }
+    return size;
+}
+
+void RamSnapshot::Compress() {
+    static const bool lzo_initialized = lzo_init() == LZO_E_OK;
+    ASSERT_MSG(lzo_initialized, "lzo_init() failed");
+
+    std::vector<lzo_align_t> work_memory(LZO1X_1_MEM_COMPRESS / sizeof(lzo_align_t) + 1);
+    // The worst case of LZO1X for incompressible data
+    std::vector<u8> buffer(PAGE_SIZE + PAGE_SIZE / 16 + 64 + 3);
+    captured_size = 0;
+    for (Page& page : pages) {
+        if (!page.compressed) {
+            lzo_uint compressed_size = 0;
+            lzo1x_1_compress(page.data->data(), PAGE_SIZE, buffer.data(), &compressed_size,
+                             work_memory.data());
+            page.data = std::make_shared<const std::vector<u8>>(buffer.begin(),
+                                                                buffer.begin() + compressed_size);
+            page.compressed = true;
+            page.captured = true;
+        }
+        if (page.captured) {
+            captured_size += page.data->size();
+        }
+    }
+}
+
+std::shared_ptr<RamSnapshot> MemorySystem::TakeSnapshot(const RamSnapshot* base, bool compress) {
+    const auto regions = impl->GetRamRegions();
+    std::size_t num_pages = 0;
+    for (const auto& [memory, size] : regions) {
+        num_pages += size / PAGE_SIZE;
+    }
+    if (base && base->pages.size() != num_pages) {
+        base = nullptr;
+    }
+
+    auto snapshot = std::make_shared<RamSnapshot>();
+    snapshot->pages.reserve(num_pages);
+    for (const auto& [memory, size] : regions) {
+        for (u32 offset = 0; offset < size; offset += PAGE_SIZE) {
+            const u8* page = memory + offset;
+            const u64 hash = Common::ComputeHash64(page, PAGE_SIZE);
+            const std::size_t index = snapshot->pages.size();
+            if (base && base->pages[index].hash == hash) {
+                RamSnapshot::Page& shared = snapshot->pages.emplace_back(base->pages[index]);
+                shared.captured = false;
+                continue;
+            }
+            // Only the copy is made here, Compress can run on another thread
+            snapshot->pages.push_back(
+                {hash, std::make_shared<const std::vector<u8>>(page, page + PAGE_SIZE), false});
+            ++snapshot->captured_pages;
+        }
+    }
+    if (compress) {
+        snapshot->Compress();
+    }
+    return snapshot;
+}
+
+void MemorySystem::RestoreSnapshot(const RamSnapshot& snapshot) {
+    std::size_t index = 0;
+    for (const auto& [memory, size] : impl->GetRamRegions()) {
+        for (u32 offset = 0; offset < size; offset += PAGE_SIZE, ++index) {
+            ASSERT(index < snapshot.pages.size());
+            const RamSnapshot::Page& page = snapshot.pages[index];
+            u8* target = memory + offset;
+            // Most pages are the same when going back a few seconds
+            if (Common::ComputeHash64(target, PAGE_SIZE) == page.hash) {
+                continue;
+            }
+            if (!page.compressed) {
+                std::memcpy(target, page.data->data(), PAGE_SIZE);
+                continue;
+            }
+            lzo_uint decompressed_size = PAGE_SIZE;
+            const int result = lzo1x_decompress_safe(page.data->data(), page.data->size(),
+                                                     target, &decompressed_size, nullptr);
+            ASSERT_MSG(result == LZO_E_OK && decompressed_size == PAGE_SIZE,
+                       "Corrupted snapshot page {}", index);
+        }
+    }
 }
 
 } // namespace Memory
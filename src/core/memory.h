@@ -200,6 +200,44 @@ enum class FlushMode {
  */
 void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
+/**
+ * A copy of FCRAM, VRAM and the New 3DS extra RAM, kept as compressed pages. A snapshot taken on
+ * top of a previous one only compresses the pages whose contents changed since, and shares the
+ * others with it, so that snapshots can be taken every few seconds.
+ */
+class RamSnapshot {
+public:
+    /// Returns the memory the compressed pages of the snapshot take, shared ones included
+    std::size_t GetCompressedSize() const;
+
+    /// Returns the memory of the pages compressed for this snapshot, valid once compressed
+    std::size_t GetCapturedSize() const {
+        return captured_size;
+    }
+
+    /// Returns the number of pages captured for this snapshot, instead of shared with its base
+    std::size_t GetCapturedPages() const {
+        return captured_pages;
+    }
+
+    /// Compresses the pages a snapshot taken without compression copied
+    void Compress();
+
+private:
+    friend class MemorySystem;
+
+    struct Page {
+        u64 hash;
+        std::shared_ptr<const std::vector<u8>> data;
+        bool compressed;
+        /// Whether the data belongs to this snapshot, rather than to its base
+        bool captured = true;
+    };
+    std::vector<Page> pages;
+    std::size_t captured_pages = 0;
+    std::size_t captured_size = 0;
+};
+
 class MemorySystem {
 public:
     MemorySystem();
@@ -231,6 +269,28 @@ public:
     void Write32(VAddr addr, u32 data);
     void Write64(VAddr addr, u64 data);
 
+    /// Accesses through the page table of a core, the cores running on host threads of their own
+    /// don't share the active page table
+    u8 Read8(const PageTable& page_table, VAddr addr);
+    u16 Read16(const PageTable& page_table, VAddr addr);
+    u32 Read32(const PageTable& page_table, VAddr addr);
+    u64 Read64(const PageTable& page_table, VAddr addr);
+
+    void Write8(const PageTable& page_table, VAddr addr, u8 data);
+    void Write16(const PageTable& page_table, VAddr addr, u16 data);
+    void Write32(const PageTable& page_table, VAddr addr, u32 data);
+    void Write64(const PageTable& page_table, VAddr addr, u64 data);
+
+    /**
+     * Writes data if the memory still holds expected, atomically with respect to the other cores.
+     * Backs STREX once the exclusive monitor checked the reservation.
+     * @returns Whether data was written
+     */
+    bool WriteExclusive8(const PageTable& page_table, VAddr addr, u8 data, u8 expected);
+    bool WriteExclusive16(const PageTable& page_table, VAddr addr, u16 data, u16 expected);
+    bool WriteExclusive32(const PageTable& page_table, VAddr addr, u32 data, u32 expected);
+    bool WriteExclusive64(const PageTable& page_table, VAddr addr, u64 data, u64 expected);
+
     void ReadBlock(const Kernel::Process& process, VAddr src_addr, void* dest_buffer,
                    std::size_t size);
     void WriteBlock(const Kernel::Process& process, VAddr dest_addr, const void* src_buffer,
@@ -271,12 +331,40 @@ public:
 
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /**
+     * Takes a snapshot of the RAM. The pages that didn't change since the base snapshot, when
+     * one is given, are shared with it, the base must be compressed. Without compression, the
+     * changed pages are only copied and RamSnapshot::Compress has to be called before the
+     * snapshot serves as a base. The rasterizer cache has to be flushed before.
+     */
+    std::shared_ptr<RamSnapshot> TakeSnapshot(const RamSnapshot* base = nullptr,
+                                              bool compress = true);
+
+    /**
+     * Writes back the RAM of a snapshot. The rasterizer cache and the CPU caches have to be
+     * invalidated afterwards.
+     */
+    void RestoreSnapshot(const RamSnapshot& snapshot);
+
 private:
     template <typename T>
-    T Read(const VAddr vaddr);
+    T Read(const PageTable& page_table, const VAddr vaddr);
 
     template <typename T>
-    void Write(const VAddr vaddr, const T data);
+    void Write(const PageTable& page_table, const VAddr vaddr, const T data);
+
+    template <typename T>
+    bool WriteExclusive(const PageTable& page_table, const VAddr vaddr, const T data,
+                        const T expected);
+
+    /**
+     * Splits a block of virtual memory into spans of pages that share their type and whose host
+     * memory is contiguous, and calls visitor(type, vaddr, offset, size, pointer) for each span in
+     * order, so that a block costs a copy per span rather than per page. The pointer is nullptr
+     * for unmapped spans.
+     */
+    template <typename Visitor>
+    void WalkBlock(const PageTable& page_table, VAddr addr, std::size_t size, Visitor&& visitor);
 
     /**
      * Gets the pointer for virtual memory where the page is marked as RasterizerCachedMemory.
@@ -288,6 +376,9 @@ private:
 
     void MapPages(PageTable& page_table, u32 base, u32 size, u8* memory, PageType type);
 
+    /// Switches the type of the mapped pages of a page table to match their rasterizer-cached state
+    void MarkPagesCached(PageTable& page_table, VAddr vaddr, u32 num_pages, bool cached);
+
     class Impl;
 
     std::unique_ptr<Impl> impl;
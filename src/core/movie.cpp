@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstring>
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
 #include <cryptopp/hex.h>
+#include <minilzo.h>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -36,6 +38,8 @@ enum class ControllerStateType : u8 {
     ExtraHidResponse
 };
 
+constexpr std::size_t NumControllerStateTypes = 6;
+
 #pragma pack(push, 1)
 struct ControllerState {
     ControllerStateType type;
@@ -111,18 +115,101 @@ static_assert(sizeof(ControllerState) == 7, "ControllerState should be 7 bytes")
 
 constexpr std::array<u8, 4> header_magic_bytes{{'C', 'T', 'M', 0x1B}};
 
+enum class MovieFormat : u8 {
+    Raw,     ///< The states follow the header as they are, movies of older versions
+    Chunked, ///< The states follow the header in compressed chunks
+};
+
 #pragma pack(push, 1)
 struct CTMHeader {
     std::array<u8, 4> filetype;  /// Unique Identifier to check the file type (always "CTM"0x1B)
     u64_le program_id;           /// ID of the ROM being executed. Also called title_id
     std::array<u8, 20> revision; /// Git hash of the revision this movie was created with
     u64_le clock_init_time;      /// The init time of the system clock
+    MovieFormat format;          /// How the states are stored
 
-    std::array<u8, 216> reserved; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 215> reserved; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CTMHeader) == 256, "CTMHeader should be 256 bytes");
+
+/// Precedes the LZO1X compressed data of a chunk
+struct ChunkHeader {
+    u32_le num_states;
+    u32_le size; /// Size of the encoded states before they were compressed
+    u32_le compressed_size;
+};
+static_assert(sizeof(ChunkHeader) == 12, "ChunkHeader should be 12 bytes");
 #pragma pack(pop)
 
+/// States recorded before they are written out as a chunk, this bounds the memory of long movies
+constexpr std::size_t MaxChunkStates = 0x2000;
+/// Age after which the recorded states are written out, bounds what a crash loses
+constexpr std::chrono::seconds ChunkMaxAge{10};
+
+/**
+ * Set on the type of a state that equals the last state of the type in the chunk, the rest of the
+ * state is left out. The chunks start without a last state so that each decodes by itself.
+ */
+constexpr u8 RepeatedStateFlag = 0x80;
+
+static bool InitLZO() {
+    static const bool initialized = lzo_init() == LZO_E_OK;
+    return initialized;
+}
+
+static std::vector<u8> EncodeStates(const std::vector<u8>& states) {
+    std::array<std::array<u8, sizeof(ControllerState)>, NumControllerStateTypes> last_states;
+    std::array<bool, NumControllerStateTypes> has_last_state{};
+    std::vector<u8> encoded;
+    encoded.reserve(states.size());
+    for (std::size_t offset = 0; offset < states.size(); offset += sizeof(ControllerState)) {
+        const u8* state = &states[offset];
+        const u8 type = state[0];
+        auto& last_state = last_states[type];
+        if (has_last_state[type] && std::memcmp(last_state.data(), state, last_state.size()) == 0) {
+            encoded.push_back(type | RepeatedStateFlag);
+            continue;
+        }
+        encoded.insert(encoded.end(), state, state + sizeof(ControllerState));
+        std::memcpy(last_state.data(), state, last_state.size());
+        has_last_state[type] = true;
+    }
+    return encoded;
+}
+
+static bool DecodeStates(const std::vector<u8>& encoded, u32 num_states, std::vector<u8>& states) {
+    std::array<std::array<u8, sizeof(ControllerState)>, NumControllerStateTypes> last_states;
+    std::array<bool, NumControllerStateTypes> has_last_state{};
+    states.resize(num_states * sizeof(ControllerState));
+    std::size_t position = 0;
+    for (std::size_t offset = 0; offset < states.size(); offset += sizeof(ControllerState)) {
+        if (position >= encoded.size()) {
+            return false;
+        }
+        const u8 type = encoded[position] & ~RepeatedStateFlag;
+        if (type >= NumControllerStateTypes) {
+            return false;
+        }
+        auto& last_state = last_states[type];
+        if (encoded[position] & RepeatedStateFlag) {
+            if (!has_last_state[type]) {
+                return false;
+            }
+            std::memcpy(&states[offset], last_state.data(), last_state.size());
+            ++position;
+            continue;
+        }
+        if (encoded.size() - position < sizeof(ControllerState)) {
+            return false;
+        }
+        std::memcpy(&states[offset], &encoded[position], sizeof(ControllerState));
+        std::memcpy(last_state.data(), &encoded[position], last_state.size());
+        has_last_state[type] = true;
+        position += sizeof(ControllerState);
+    }
+    return position == encoded.size();
+}
+
 bool Movie::IsPlayingInput() const {
     return play_mode == PlayMode::Playing;
 }
@@ -131,7 +218,7 @@ bool Movie::IsRecordingInput() const {
 }
 
 void Movie::CheckInputEnd() {
-    if (current_byte + sizeof(ControllerState) > recorded_input.size()) {
+    if (current_byte + sizeof(ControllerState) > recorded_input.size() && !LoadNextChunk()) {
         LOG_INFO(Movie, "Playback finished");
         play_mode = PlayMode::None;
         init_time = 0;
@@ -266,6 +353,11 @@ void Movie::Record(const ControllerState& controller_state) {
     recorded_input.resize(current_byte + sizeof(ControllerState));
     std::memcpy(&recorded_input[current_byte], &controller_state, sizeof(ControllerState));
     current_byte += sizeof(ControllerState);
+
+    if (current_byte >= MaxChunkStates * sizeof(ControllerState) ||
+        std::chrono::steady_clock::now() - chunk_begin >= ChunkMaxAge) {
+        WriteChunk();
+    }
 }
 
 void Movie::Record(const Service::HID::PadState& pad_state, const s16& circle_pad_x,
@@ -363,6 +455,10 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header, u64 progr
         LOG_ERROR(Movie, "Playback file does not have valid header");
         return ValidationResult::Invalid;
     }
+    if (header.format != MovieFormat::Raw && header.format != MovieFormat::Chunked) {
+        LOG_ERROR(Movie, "Playback file has unknown format {}", static_cast<int>(header.format));
+        return ValidationResult::Invalid;
+    }
 
     std::string revision = fmt::format("{:02x}", fmt::join(header.revision, ""));
 
@@ -382,59 +478,144 @@ Movie::ValidationResult Movie::ValidateHeader(const CTMHeader& header, u64 progr
     return ValidationResult::OK;
 }
 
-void Movie::SaveMovie() {
-    LOG_INFO(Movie, "Saving recorded movie to '{}'", record_movie_file);
-    FileUtil::IOFile save_record(record_movie_file, "wb");
-
-    if (!save_record.IsGood()) {
-        LOG_ERROR(Movie, "Unable to open file to save movie");
+void Movie::WriteChunk() {
+    if (recorded_input.empty()) {
+        return;
+    }
+    const u32 num_states = static_cast<u32>(recorded_input.size() / sizeof(ControllerState));
+    const std::vector<u8> encoded = EncodeStates(recorded_input);
+    recorded_input.clear();
+    current_byte = 0;
+    chunk_begin = std::chrono::steady_clock::now();
+
+    std::vector<lzo_align_t> work_memory((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) /
+                                         sizeof(lzo_align_t));
+    std::vector<u8> compressed(encoded.size() + encoded.size() / 16 + 64 + 3);
+    lzo_uint compressed_size = 0;
+    if (!InitLZO() || lzo1x_1_compress(encoded.data(), encoded.size(), compressed.data(),
+                                       &compressed_size, work_memory.data()) != LZO_E_OK) {
+        LOG_ERROR(Movie, "Failed to compress {} recorded states", num_states);
         return;
     }
 
-    CTMHeader header = {};
-    header.filetype = header_magic_bytes;
-    header.clock_init_time = init_time;
-
-    Core::System::GetInstance().GetAppLoader().ReadProgramId(header.program_id);
-
-    std::string rev_bytes;
-    CryptoPP::StringSource(Common::g_scm_rev, true,
-                           new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
-    std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(CTMHeader::revision));
-
-    save_record.WriteBytes(&header, sizeof(CTMHeader));
-    save_record.WriteBytes(recorded_input.data(), recorded_input.size());
+    ChunkHeader chunk_header;
+    chunk_header.num_states = num_states;
+    chunk_header.size = static_cast<u32>(encoded.size());
+    chunk_header.compressed_size = static_cast<u32>(compressed_size);
+    file.WriteBytes(&chunk_header, sizeof(ChunkHeader));
+    file.WriteBytes(compressed.data(), compressed_size);
+    // What made it to the file survives a crash of the emulator
+    file.Flush();
 
-    if (!save_record.IsGood()) {
+    if (!file.IsGood()) {
         LOG_ERROR(Movie, "Error saving movie");
     }
 }
 
+bool Movie::LoadNextChunk() {
+    if (next_chunk >= chunks.size()) {
+        return false;
+    }
+    const ChunkInfo& chunk = chunks[next_chunk++];
+
+    std::vector<u8> compressed(chunk.compressed_size);
+    std::vector<u8> encoded(chunk.size);
+    lzo_uint encoded_size = encoded.size();
+    if (!file.Seek(chunk.offset + sizeof(ChunkHeader), SEEK_SET) ||
+        file.ReadBytes(compressed.data(), compressed.size()) != compressed.size() || !InitLZO() ||
+        lzo1x_decompress_safe(compressed.data(), compressed.size(), encoded.data(), &encoded_size,
+                              nullptr) != LZO_E_OK ||
+        encoded_size != encoded.size() || !DecodeStates(encoded, chunk.num_states, recorded_input)) {
+        LOG_ERROR(Movie, "Movie chunk at offset {} is corrupted", chunk.offset);
+        return false;
+    }
+    current_byte = 0;
+    return !recorded_input.empty();
+}
+
 void Movie::StartPlayback(const std::string& movie_file,
                           std::function<void()> completion_callback) {
     LOG_INFO(Movie, "Loading Movie for playback");
-    FileUtil::IOFile save_record(movie_file, "rb");
-    const u64 size = save_record.GetSize();
+    file = FileUtil::IOFile(movie_file, "rb");
+    const u64 size = file.GetSize();
 
-    if (save_record.IsGood() && size > sizeof(CTMHeader)) {
-        CTMHeader header;
-        save_record.ReadArray(&header, 1);
-        if (ValidateHeader(header) != ValidationResult::Invalid) {
-            play_mode = PlayMode::Playing;
-            recorded_input.resize(size - sizeof(CTMHeader));
-            save_record.ReadArray(recorded_input.data(), recorded_input.size());
-            current_byte = 0;
-            playback_completion_callback = completion_callback;
-        }
-    } else {
+    if (!file.IsGood() || size <= sizeof(CTMHeader)) {
         LOG_ERROR(Movie, "Failed to playback movie: Unable to open '{}'", movie_file);
+        file.Close();
+        return;
+    }
+
+    CTMHeader header;
+    file.ReadArray(&header, 1);
+    if (ValidateHeader(header) == ValidationResult::Invalid) {
+        file.Close();
+        return;
+    }
+
+    recorded_input.clear();
+    chunks.clear();
+    next_chunk = 0;
+    current_byte = 0;
+    if (header.format == MovieFormat::Raw) {
+        recorded_input.resize(size - sizeof(CTMHeader));
+        file.ReadArray(recorded_input.data(), recorded_input.size());
+        file.Close();
+    } else {
+        // The chunk headers are walked once so that the chunks can be loaded as playback goes on
+        u64 offset = sizeof(CTMHeader);
+        ChunkHeader chunk_header;
+        while (offset + sizeof(ChunkHeader) <= size && file.Seek(offset, SEEK_SET) &&
+               file.ReadBytes(&chunk_header, sizeof(ChunkHeader)) == sizeof(ChunkHeader)) {
+            const u64 end = offset + sizeof(ChunkHeader) + chunk_header.compressed_size;
+            if (end > size || chunk_header.num_states > MaxChunkStates ||
+                chunk_header.size > chunk_header.num_states * sizeof(ControllerState)) {
+                // The recording was cut short, e.g. by a crash, what came before still plays
+                LOG_WARNING(Movie, "Movie ends with an incomplete chunk at offset {}", offset);
+                break;
+            }
+            chunks.push_back({offset, chunk_header.num_states, chunk_header.size,
+                              chunk_header.compressed_size});
+            offset = end;
+        }
+        if (!LoadNextChunk()) {
+            LOG_ERROR(Movie, "Failed to playback movie: '{}' has no input", movie_file);
+            file.Close();
+            chunks.clear();
+            return;
+        }
     }
+
+    play_mode = PlayMode::Playing;
+    playback_completion_callback = completion_callback;
 }
 
 void Movie::StartRecording(const std::string& movie_file) {
-    LOG_INFO(Movie, "Enabling Movie recording");
+    LOG_INFO(Movie, "Enabling Movie recording to '{}'", movie_file);
+    file = FileUtil::IOFile(movie_file, "wb");
+    if (!file.IsGood()) {
+        LOG_ERROR(Movie, "Unable to open file to save movie");
+        return;
+    }
+
+    CTMHeader header = {};
+    header.filetype = header_magic_bytes;
+    header.clock_init_time = init_time;
+    header.format = MovieFormat::Chunked;
+
+    Core::System::GetInstance().GetAppLoader().ReadProgramId(header.program_id);
+
+    std::string rev_bytes;
+    CryptoPP::StringSource(Common::g_scm_rev, true,
+                           new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
+    std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(CTMHeader::revision));
+
+    file.WriteBytes(&header, sizeof(CTMHeader));
+    file.Flush();
+
+    recorded_input.clear();
+    current_byte = 0;
+    chunk_begin = std::chrono::steady_clock::now();
     play_mode = PlayMode::Recording;
-    record_movie_file = movie_file;
 }
 
 static boost::optional<CTMHeader> ReadHeader(const std::string& movie_file) {
@@ -488,12 +669,15 @@ u64 Movie::GetMovieProgramID(const std::string& movie_file) const {
 
 void Movie::Shutdown() {
     if (IsRecordingInput()) {
-        SaveMovie();
+        LOG_INFO(Movie, "Saving the rest of the recorded movie");
+        WriteChunk();
     }
 
     play_mode = PlayMode::None;
+    file.Close();
     recorded_input.resize(0);
-    record_movie_file.clear();
+    chunks.clear();
+    next_chunk = 0;
     current_byte = 0;
     init_time = 0;
 }
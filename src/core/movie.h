@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <string>
+#include <vector>
 #include "common/common_types.h"
+#include "common/file_util.h"
 
 namespace Service {
 namespace HID {
@@ -124,11 +128,27 @@ private:
 
     ValidationResult ValidateHeader(const CTMHeader& header, u64 program_id = 0) const;
 
-    void SaveMovie();
+    /// Compresses the recorded states and appends them to the movie file as a chunk
+    void WriteChunk();
+
+    /// Replaces the played states with the ones of the next chunk, returns false if there is none
+    bool LoadNextChunk();
+
+    /// Where a chunk of a movie file starts, found when the playback starts
+    struct ChunkInfo {
+        u64 offset;
+        u32 num_states;
+        u32 size;
+        u32 compressed_size;
+    };
 
     PlayMode play_mode;
-    std::string record_movie_file;
+    FileUtil::IOFile file;
+    /// States of the chunk being recorded or played
     std::vector<u8> recorded_input;
+    std::chrono::steady_clock::time_point chunk_begin;
+    std::vector<ChunkInfo> chunks;
+    std::size_t next_chunk = 0;
     u64 init_time;
     std::function<void()> playback_completion_callback;
     std::size_t current_byte = 0;
@@ -3,10 +3,20 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <fmt/chrono.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <time.h>
+#endif
+#include "common/logging/log.h"
 #include "core.h"
 #include "core/hw/gpu.h"
 #include "core/perf_stats.h"
@@ -16,11 +26,63 @@ using namespace std::chrono_literals;
 using DoubleSecs = std::chrono::duration<double, std::chrono::seconds::period>;
 using std::chrono::duration_cast;
 using std::chrono::microseconds;
+using DoubleMillis = std::chrono::duration<double, std::milli>;
 
 namespace Core {
 
+/// Time spent in each category since the end of the last system frame, by all threads
+static std::array<std::atomic<u64>, NUM_PERF_CATEGORIES> category_time_ns{};
+
+/// Innermost PerfScope of the thread
+static thread_local PerfScope* current_scope = nullptr;
+
+static u64 GetPerfTimeNs() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+}
+
+const char* GetPerfCategoryName(PerfCategory category) {
+    switch (category) {
+    case PerfCategory::CpuJit:
+        return "JIT";
+    case PerfCategory::HleServices:
+        return "HLE";
+    case PerfCategory::GpuCommands:
+        return "GPU";
+    case PerfCategory::RasterizerDraws:
+        return "Draw";
+    case PerfCategory::ShaderCompiles:
+        return "Shader";
+    case PerfCategory::SurfaceFlushes:
+        return "Flush";
+    }
+    return "";
+}
+
+PerfScope::PerfScope(PerfCategory category)
+    : category(category), parent(current_scope), start(GetPerfTimeNs()) {
+    if (parent) {
+        category_time_ns[static_cast<std::size_t>(parent->category)].fetch_add(
+            start - parent->start, std::memory_order_relaxed);
+    }
+    current_scope = this;
+}
+
+PerfScope::~PerfScope() {
+    const u64 end = GetPerfTimeNs();
+    category_time_ns[static_cast<std::size_t>(category)].fetch_add(end - start,
+                                                                   std::memory_order_relaxed);
+    current_scope = parent;
+    if (parent) {
+        parent->start = end;
+    }
+}
+
 void PerfStats::BeginSystemFrame() {
     frame_limiter.DoFrameLimiting(System::GetInstance().CoreTiming().GetGlobalTimeUs());
+    std::lock_guard lock{object_mutex};
+    work_begin_ns = GetPerfTimeNs();
 }
 
 void PerfStats::EndSystemFrame() {
@@ -29,6 +91,37 @@ void PerfStats::EndSystemFrame() {
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
     system_frames += 1;
+
+    if (!first_frame_ended) {
+        first_frame_ended = true;
+        LOG_INFO(Core, "Boot: first frame {} ms after the ROM was loaded",
+                 std::chrono::duration_cast<std::chrono::milliseconds>(frame_end - start_point)
+                     .count());
+    }
+
+    FrameRecord& record = frame_history[frame_history_next];
+    record.length = previous_frame_length;
+    for (std::size_t i = 0; i < NUM_PERF_CATEGORIES; ++i) {
+        record.category_ns[i] = category_time_ns[i].exchange(0, std::memory_order_relaxed);
+    }
+    frame_history_next = (frame_history_next + 1) % FRAME_HISTORY;
+    frame_history_size = std::min(frame_history_size + 1, FRAME_HISTORY);
+
+    if (pending_input_event_ns != 0) {
+        input_frame_ns += static_cast<s64>(GetPerfTimeNs()) - pending_input_event_ns;
+        input_frames += 1;
+        pending_input_event_ns = 0;
+    }
+
+    // The frame limiter sleep is not work, the target is its frame length at the limited speed
+    if (work_begin_ns != 0) {
+        double target_ns = 1e9 / GPU::SCREEN_REFRESH_RATE;
+        if (Settings::values.use_frame_limit && Settings::values.frame_limit != 0) {
+            target_ns /= Settings::values.frame_limit / 100.0;
+        }
+        Common::ReportFrameWorkDuration(static_cast<s64>(GetPerfTimeNs() - work_begin_ns),
+                                        static_cast<s64>(target_ns));
+    }
 }
 
 void PerfStats::EndGameFrame() {
@@ -36,6 +129,26 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddVertexCacheStats(u32 hits, u32 misses) {
+    std::lock_guard lock{object_mutex};
+    vertex_cache_hits += hits;
+    vertex_cache_misses += misses;
+}
+
+void PerfStats::AddInputLatch(s64 event_ns) {
+    std::lock_guard lock{object_mutex};
+    input_latch_ns += static_cast<s64>(GetPerfTimeNs()) - event_ns;
+    input_latches += 1;
+    if (pending_input_event_ns == 0) {
+        pending_input_event_ns = event_ns;
+    }
+}
+
+void PerfStats::AddSavedGLCalls(u32 calls) {
+    std::lock_guard lock{object_mutex};
+    gl_calls_saved += calls;
+}
+
 PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::lock_guard lock(object_mutex);
 
@@ -48,21 +161,119 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     results.system_fps = static_cast<double>(system_frames) / interval;
     results.game_fps = static_cast<double>(game_frames) / interval;
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    const u64 vertex_cache_lookups = vertex_cache_hits + vertex_cache_misses;
+    results.vertex_cache_hit_rate =
+        vertex_cache_lookups == 0
+            ? -1.0
+            : static_cast<double>(vertex_cache_hits) / static_cast<double>(vertex_cache_lookups);
+    results.frame_time_stats = ComputeFrameTimeStats();
+    results.input_latch_latency =
+        input_latches == 0 ? -1.0 : static_cast<double>(input_latch_ns) / 1e6 / input_latches;
+    results.input_frame_latency =
+        input_frames == 0 ? -1.0 : static_cast<double>(input_frame_ns) / 1e6 / input_frames;
+    results.gl_calls_saved =
+        system_frames == 0 ? 0.0 : static_cast<double>(gl_calls_saved) / system_frames;
 
     // Reset counters
     reset_point = now;
     reset_point_system_us = current_system_time_us;
     system_frames = 0;
     game_frames = 0;
+    vertex_cache_hits = 0;
+    vertex_cache_misses = 0;
+    input_latch_ns = 0;
+    input_latches = 0;
+    input_frame_ns = 0;
+    input_frames = 0;
+    gl_calls_saved = 0;
 
     return results;
 }
 
+PerfStats::FrameTimeStats PerfStats::GetFrameTimeStats() {
+    std::lock_guard lock{object_mutex};
+    return ComputeFrameTimeStats();
+}
+
+PerfStats::FrameTimeStats PerfStats::ComputeFrameTimeStats() const {
+    FrameTimeStats stats{};
+    if (frame_history_size == 0) {
+        return stats;
+    }
+
+    std::vector<Clock::duration> lengths(frame_history_size);
+    std::array<u64, NUM_PERF_CATEGORIES> category_ns{};
+    for (std::size_t i = 0; i < frame_history_size; ++i) {
+        const FrameRecord& record = frame_history[i];
+        lengths[i] = record.length;
+        for (std::size_t category = 0; category < NUM_PERF_CATEGORIES; ++category) {
+            category_ns[category] += record.category_ns[category];
+        }
+    }
+
+    const auto percentile = [&lengths](std::size_t percent) {
+        const auto nth = lengths.begin() + (lengths.size() - 1) * percent / 100;
+        std::nth_element(lengths.begin(), nth, lengths.end());
+        return duration_cast<DoubleMillis>(*nth).count();
+    };
+    stats.percentile_50 = percentile(50);
+    stats.percentile_95 = percentile(95);
+    stats.percentile_99 = percentile(99);
+    for (std::size_t category = 0; category < NUM_PERF_CATEGORIES; ++category) {
+        stats.category_time[category] =
+            static_cast<double>(category_ns[category]) / 1e6 / frame_history_size;
+    }
+    return stats;
+}
+
 double PerfStats::GetLastFrameTimeScale() {
     std::lock_guard lock{object_mutex};
     return duration_cast<DoubleSecs>(previous_frame_length).count() * GPU::SCREEN_REFRESH_RATE;
 }
 
+/**
+ * The OS sleeps overshoot, by up to a millisecond with a raised timer resolution on Windows and by
+ * the timer slack elsewhere. The thread sleeps until this long before the deadline, then spins.
+ */
+#ifdef _WIN32
+constexpr auto SPIN_MARGIN = 1500us;
+#else
+constexpr auto SPIN_MARGIN = 200us;
+#endif
+
+static void SleepUntil(FrameLimiter::Clock::time_point deadline) {
+    const auto coarse_deadline = deadline - SPIN_MARGIN;
+    if (FrameLimiter::Clock::now() < coarse_deadline) {
+#ifdef _WIN32
+        std::this_thread::sleep_until(coarse_deadline);
+#else
+        // An absolute deadline does not drift when the thread is woken up early by a signal
+        const auto since_epoch = coarse_deadline.time_since_epoch();
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(duration_cast<std::chrono::seconds>(since_epoch).count());
+        ts.tv_nsec = static_cast<long>((since_epoch % 1s) / 1ns);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+#endif
+    }
+    while (FrameLimiter::Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+FrameLimiter::FrameLimiter() {
+#ifdef _WIN32
+    // Sleeps are rounded up to the 15.6ms default timer period otherwise
+    timeBeginPeriod(1);
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
 void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
     if (!Settings::values.use_frame_limit) {
         return;
@@ -82,7 +293,7 @@ void FrameLimiter::DoFrameLimiting(microseconds current_system_time_us) {
         std::clamp(frame_limiting_delta_err, -max_lag_time_us, max_lag_time_us);
 
     if (frame_limiting_delta_err > microseconds::zero()) {
-        std::this_thread::sleep_for(frame_limiting_delta_err);
+        SleepUntil(now + frame_limiting_delta_err);
         auto now_after_sleep = Clock::now();
         frame_limiting_delta_err -= duration_cast<microseconds>(now_after_sleep - now);
         now = now_after_sleep;
@@ -4,18 +4,59 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/thread.h"
 
 namespace Core {
 
+/// Subsystems whose share of the system frames is measured
+enum class PerfCategory : u32 {
+    CpuJit,
+    HleServices,
+    GpuCommands,
+    RasterizerDraws,
+    ShaderCompiles,
+    SurfaceFlushes,
+};
+
+constexpr std::size_t NUM_PERF_CATEGORIES = 6;
+
+/// Returns the short name of the category shown by the frontends
+const char* GetPerfCategoryName(PerfCategory category);
+
+/**
+ * Adds the time spent in its scope to a category, it sits next to the MICROPROFILE_SCOPE of the
+ * same code. A nested scope pauses the enclosing one of its thread, so that each category only gets
+ * its own time, e.g. the HLE services called from the JIT are not counted as JIT time.
+ */
+class PerfScope {
+public:
+    explicit PerfScope(PerfCategory category);
+    ~PerfScope();
+
+private:
+    PerfCategory category;
+    PerfScope* parent;
+    /// Start of the part of the scope not spent in nested scopes, in nanoseconds
+    u64 start;
+};
+
+#define PERF_SCOPE(category)                                                                       \
+    ::Core::PerfScope CONCAT2(perf_scope_, __LINE__)(::Core::PerfCategory::category)
+
 class FrameLimiter {
 public:
-    using Clock = std::chrono::high_resolution_clock;
+    /// Steady, as the deadlines of the high resolution sleep are on the monotonic clock
+    using Clock = std::chrono::steady_clock;
+
+    FrameLimiter();
+    ~FrameLimiter();
 
     void DoFrameLimiting(std::chrono::microseconds current_system_time_us);
 
@@ -37,6 +78,16 @@ class PerfStats {
 public:
     using Clock = std::chrono::high_resolution_clock;
 
+    /// Statistics of the last FRAME_HISTORY system frames, none of them are reset on read
+    struct FrameTimeStats {
+        /// Percentiles of the visible system frame times, in milliseconds
+        double percentile_50;
+        double percentile_95;
+        double percentile_99;
+        /// Average time per system frame spent in each PerfCategory, in milliseconds
+        std::array<double, NUM_PERF_CATEGORIES> category_time;
+    };
+
     struct Results {
         /// System FPS (LCD VBlanks) in Hz
         double system_fps;
@@ -44,14 +95,30 @@ public:
         double game_fps;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        FrameTimeStats frame_time_stats;
+        /// Ratio of the indexed software draw vertices found in the post-transform cache, or a
+        /// negative value when no such vertex was drawn
+        double vertex_cache_hit_rate;
+        /// Average milliseconds from an input event to the pad update that latched it and to the
+        /// end of that system frame, or negative values when there was no input
+        double input_latch_latency;
+        double input_frame_latency;
+        /// GL calls per system frame the shadow state of OpenGLState::Apply skipped
+        double gl_calls_saved;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
+    void AddVertexCacheStats(u32 hits, u32 misses);
+    /// Records the pad update latching an input event, given in steady clock nanoseconds
+    void AddInputLatch(s64 event_ns);
+    void AddSavedGLCalls(u32 calls);
 
     Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
+    FrameTimeStats GetFrameTimeStats();
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
@@ -59,6 +126,17 @@ public:
     double GetLastFrameTimeScale();
 
 private:
+    /// System frames kept for the rolling statistics, about five seconds
+    static constexpr std::size_t FRAME_HISTORY = 300;
+
+    struct FrameRecord {
+        Clock::duration length;
+        std::array<u64, NUM_PERF_CATEGORIES> category_ns;
+    };
+
+    /// Computes the rolling statistics, object_mutex must be held
+    FrameTimeStats ComputeFrameTimeStats() const;
+
     std::mutex object_mutex;
 
     FrameLimiter frame_limiter;
@@ -72,11 +150,33 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
-
+    /// Cumulative post-transform vertex cache lookups of indexed software draws since last reset
+    u64 vertex_cache_hits = 0;
+    u64 vertex_cache_misses = 0;
+    /// Cumulative input latencies since last reset
+    u64 input_latch_ns = 0;
+    u32 input_latches = 0;
+    u64 input_frame_ns = 0;
+    u32 input_frames = 0;
+    /// Cumulative GL calls skipped by OpenGLState::Apply since last reset
+    u64 gl_calls_saved = 0;
+    /// Time of the first input event latched during the current system frame, or zero
+    s64 pending_input_event_ns = 0;
+
+    /// Ring of the last system frames, frame_history_next is where the next one is stored
+    std::array<FrameRecord, FRAME_HISTORY> frame_history{};
+    std::size_t frame_history_next = 0;
+    std::size_t frame_history_size = 0;
+
+    /// Point when the emulation started, the boot time is counted up to the first system frame
+    const Clock::time_point start_point = Clock::now();
+    bool first_frame_ended = false;
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
     /// Total visible duration (including frame-limiting, etc.) of the previous system frame
     Clock::duration previous_frame_length = Clock::duration::zero();
+    /// Point when the frame limiter let the current system frame start, in nanoseconds
+    u64 work_begin_ns = 0;
 };
 
 } // namespace Core
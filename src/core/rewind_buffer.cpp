@@ -0,0 +1,104 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hw/gpu.h"
+#include "core/memory.h"
+#include "core/rewind_buffer.h"
+#include "core/settings.h"
+
+namespace Core {
+
+namespace {
+
+const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / GPU::SCREEN_REFRESH_RATE);
+
+} // Anonymous namespace
+
+RewindBuffer::RewindBuffer(System& system) : system(system) {
+    frame_event = system.CoreTiming().RegisterEvent(
+        "RewindBuffer::FrameCallback",
+        [this](u64 userdata, s64 cycles_late) { FrameCallback(cycles_late); });
+    system.CoreTiming().ScheduleEvent(frame_ticks, frame_event);
+}
+
+RewindBuffer::~RewindBuffer() {
+    system.CoreTiming().UnscheduleEvent(frame_event, 0);
+    if (compression.valid()) {
+        compression.wait();
+    }
+}
+
+bool RewindBuffer::StepBack() {
+    FinishCompression();
+    if (snapshots.empty()) {
+        return false;
+    }
+    system.RestoreRamSnapshot(*snapshots.back());
+    snapshots.pop_back();
+    frames_since_snapshot = 0;
+    return true;
+}
+
+std::size_t RewindBuffer::GetMemoryUsage() const {
+    if (snapshots.empty()) {
+        return 0;
+    }
+    // The oldest snapshot holds all of its pages, the others only the ones they captured
+    std::size_t usage = snapshots.front()->GetCompressedSize();
+    for (auto it = snapshots.begin() + 1; it != snapshots.end(); ++it) {
+        usage += (*it)->GetCapturedSize();
+    }
+    return usage;
+}
+
+void RewindBuffer::FrameCallback(s64 cycles_late) {
+    system.CoreTiming().ScheduleEvent(frame_ticks - cycles_late, frame_event);
+
+    const u16 interval = Settings::values.rewind_interval;
+    if (interval == 0) {
+        if (!snapshots.empty()) {
+            FinishCompression();
+            snapshots.clear();
+        }
+        return;
+    }
+    if (++frames_since_snapshot < interval) {
+        return;
+    }
+    // A snapshot still being compressed can't be the base of the next one, which waits a frame
+    if (compression.valid() &&
+        compression.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    FinishCompression();
+
+    const Memory::RamSnapshot* base = snapshots.empty() ? nullptr : snapshots.back().get();
+    auto snapshot = system.TakeRamSnapshot(base, false);
+    LOG_DEBUG(Core, "Rewind snapshot captured {} pages", snapshot->GetCapturedPages());
+    compression = std::async(std::launch::async, [snapshot] {
+        Common::SetCurrentThreadName("RewindCompression");
+        Common::SetCurrentThreadLowPriority();
+        snapshot->Compress();
+    });
+    snapshots.push_back(std::move(snapshot));
+    frames_since_snapshot = 0;
+}
+
+void RewindBuffer::FinishCompression() {
+    if (!compression.valid()) {
+        return;
+    }
+    compression.get();
+
+    const std::size_t budget = static_cast<std::size_t>(Settings::values.rewind_budget) << 20;
+    while (snapshots.size() > 1 && GetMemoryUsage() > budget) {
+        snapshots.pop_front();
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,57 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <future>
+#include <memory>
+#include "common/common_types.h"
+
+namespace Memory {
+class RamSnapshot;
+}
+
+namespace Core {
+
+class System;
+struct TimingEventType;
+
+/**
+ * Takes a RAM snapshot every few frames, as set by Settings::values.rewind_interval, and keeps
+ * as many as the memory budget allows. On the emulation thread, a snapshot only copies the pages
+ * that changed since the previous one, which a worker thread compresses afterwards.
+ */
+class RewindBuffer {
+public:
+    explicit RewindBuffer(System& system);
+    ~RewindBuffer();
+
+    /// Brings the RAM back to the newest snapshot and drops it, false when there is none
+    bool StepBack();
+
+    /// Returns the number of snapshots held
+    std::size_t GetSnapshotCount() const {
+        return snapshots.size();
+    }
+
+private:
+    void FrameCallback(s64 cycles_late);
+
+    /// Returns the memory the snapshots take, once all of them are compressed
+    std::size_t GetMemoryUsage() const;
+
+    /// Waits for the compression of the newest snapshot, then drops the oldest ones over budget
+    void FinishCompression();
+
+    System& system;
+    TimingEventType* frame_event;
+    u32 frames_since_snapshot = 0;
+
+    /// Oldest first, each one shares its unchanged pages with the one before
+    std::deque<std::shared_ptr<Memory::RamSnapshot>> snapshots;
+    std::future<void> compression;
+};
+
+} // namespace Core
@@ -14,6 +14,29 @@ enum class PacketType {
     Undefined = 0,
     ReadMemory,
     WriteMemory,
+    /// Reads several address/size ranges, replying with their contents one after the other
+    ReadMemoryRanges,
+    /// Writes several ranges, each an address/size pair followed by its data
+    WriteMemoryRanges,
+    /**
+     * Watches ranges in the format of ReadMemoryRanges, whose contents are then sent in a packet of
+     * this type and id at the end of every frame they changed. The id identifies the subscription,
+     * subscribing again with it replaces the ranges and no ranges at all ends it.
+     */
+    SubscribeMemory,
+    /**
+     * Replies with the frame time statistics of the last seconds as floats in milliseconds: the
+     * 50th, 95th and 99th percentiles, then the average per frame of each Core::PerfCategory.
+     */
+    GetFrameTimeStats,
+    /**
+     * Replies with the IPC commands that took the most time since the recorder was enabled. Each
+     * entry is the service name as 8 chars, then the command header, request count, total time,
+     * and the 50th and 99th latency percentiles as u32, the times in microseconds. An optional u32
+     * in the request first enables the recorder, recording one request in full out of that
+     * number, or disables it if 0.
+     */
+    GetIPCStats,
 };
 
 struct PacketHeader {
@@ -23,9 +46,10 @@ struct PacketHeader {
     u32 packet_size;
 };
 
-constexpr u32 CURRENT_VERSION = 1;
+constexpr u32 CURRENT_VERSION = 3;
 constexpr u32 MIN_PACKET_SIZE = sizeof(PacketHeader);
-constexpr u32 MAX_PACKET_DATA_SIZE = 32;
+/// Keeps the packets within a single Ethernet frame
+constexpr u32 MAX_PACKET_DATA_SIZE = 1024;
 constexpr u32 MAX_PACKET_SIZE = MIN_PACKET_SIZE + MAX_PACKET_DATA_SIZE;
 constexpr u32 MAX_READ_SIZE = MAX_PACKET_DATA_SIZE;
 
@@ -1,16 +1,46 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
 #include "common/logging/log.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/process.h"
+#include "core/hw/gpu.h"
 #include "core/memory.h"
 #include "core/rpc/packet.h"
 #include "core/rpc/rpc_server.h"
 
 namespace RPC {
 
-RPCServer::RPCServer() : server(*this) {
+namespace {
+
+const u64 frame_ticks = static_cast<u64>(BASE_CLOCK_RATE_ARM11 / GPU::SCREEN_REFRESH_RATE);
+
+/// Requests not taken by a frame within this time are handled right away
+constexpr std::chrono::milliseconds FrameTimeout{100};
+
+/// The subscriptions beyond this replace the oldest ones
+constexpr std::size_t MaxSubscriptions = 16;
+
+bool IsWritableAddress(u32 address) {
+    // Only allow writing to certain memory regions
+    return (address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
+           (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
+           (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END);
+}
+
+} // Anonymous namespace
+
+RPCServer::RPCServer(Core::System& system) : system(system), server(*this) {
     LOG_INFO(RPC_Server, "Starting RPC server ...");
 
+    frame_event = system.CoreTiming().RegisterEvent(
+        "RPC::FrameCallback",
+        [this](u64 userdata, s64 cycles_late) { FrameCallback(cycles_late); });
+    system.CoreTiming().ScheduleEvent(frame_ticks, frame_event);
     Start();
 
     LOG_INFO(RPC_Server, "RPC started.");
@@ -20,6 +50,7 @@ RPCServer::~RPCServer() {
     LOG_INFO(RPC_Server, "Stopping RPC ...");
 
     Stop();
+    system.CoreTiming().UnscheduleEvent(frame_event, 0);
 
     LOG_INFO(RPC_Server, "RPC stopped.");
 }
@@ -29,40 +60,174 @@ void RPCServer::HandleReadMemory(Packet& packet, u32 address, u32 data_size) {
         return;
     }
 
-    // Note: Memory read occurs asynchronously from the state of the emulator
-    Core::System::GetInstance().Memory().ReadBlock(
-        *Core::System::GetInstance().Kernel().GetCurrentProcess(), address,
-        packet.GetPacketData().data(), data_size);
+    system.Memory().ReadBlock(*system.Kernel().GetCurrentProcess(), address,
+                              packet.GetPacketData().data(), data_size);
     packet.SetPacketDataSize(data_size);
     packet.SendReply();
 }
 
 void RPCServer::HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size) {
-    // Only allow writing to certain memory regions
-    if ((address >= Memory::PROCESS_IMAGE_VADDR && address <= Memory::PROCESS_IMAGE_VADDR_END) ||
-        (address >= Memory::HEAP_VADDR && address <= Memory::HEAP_VADDR_END) ||
-        (address >= Memory::N3DS_EXTRA_RAM_VADDR && address <= Memory::N3DS_EXTRA_RAM_VADDR_END)) {
-        // Note: Memory write occurs asynchronously from the state of the emulator
-        Core::System::GetInstance().Memory().WriteBlock(
-            *Core::System::GetInstance().Kernel().GetCurrentProcess(), address, data, data_size);
+    if (IsWritableAddress(address)) {
+        system.Memory().WriteBlock(*system.Kernel().GetCurrentProcess(), address, data,
+                                   data_size);
         // If the memory happens to be executable code, make sure the changes become visible
 
         // Is current core correct here?
-        Core::System::GetInstance().InvalidateCacheRange(address, data_size);
+        system.InvalidateCacheRange(address, data_size);
     }
     packet.SetPacketDataSize(0);
     packet.SendReply();
 }
 
+void RPCServer::HandleReadMemoryRanges(Packet& packet, const std::vector<MemoryRange>& ranges) {
+    // The ranges were copied out of the packet, the contents can overwrite them
+    u8* data = packet.GetPacketData().data();
+    u32 data_size = 0;
+    for (const MemoryRange& range : ranges) {
+        system.Memory().ReadBlock(*system.Kernel().GetCurrentProcess(), range.address,
+                                  data + data_size, range.size);
+        data_size += range.size;
+    }
+    packet.SetPacketDataSize(data_size);
+    packet.SendReply();
+}
+
+bool RPCServer::HandleWriteMemoryRanges(Packet& packet) {
+    const u8* data = packet.GetPacketData().data();
+    const u32 packet_size = packet.GetPacketDataSize();
+
+    // Nothing is written unless the whole packet is well formed
+    for (u32 offset = 0; offset < packet_size;) {
+        u32 data_size = 0;
+        if (packet_size - offset < sizeof(u32) * 2) {
+            return false;
+        }
+        std::memcpy(&data_size, data + offset + sizeof(u32), sizeof(data_size));
+        if (data_size == 0 || data_size > packet_size - offset - sizeof(u32) * 2) {
+            return false;
+        }
+        offset += sizeof(u32) * 2 + data_size;
+    }
+
+    for (u32 offset = 0; offset < packet_size;) {
+        u32 address = 0;
+        u32 data_size = 0;
+        std::memcpy(&address, data + offset, sizeof(address));
+        std::memcpy(&data_size, data + offset + sizeof(u32), sizeof(data_size));
+        offset += sizeof(u32) * 2;
+        if (IsWritableAddress(address)) {
+            system.Memory().WriteBlock(*system.Kernel().GetCurrentProcess(), address,
+                                       data + offset, data_size);
+            system.InvalidateCacheRange(address, data_size);
+        }
+        offset += data_size;
+    }
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+    return true;
+}
+
+void RPCServer::HandleSubscribeMemory(std::unique_ptr<Packet> packet,
+                                      std::vector<MemoryRange> ranges) {
+    packet->SetPacketDataSize(0);
+    packet->SendReply();
+
+    const u32 id = packet->GetId();
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                       [id](const Subscription& subscription) {
+                                           return subscription.packet->GetId() == id;
+                                       }),
+                        subscriptions.end());
+    if (ranges.empty()) {
+        return;
+    }
+
+    if (subscriptions.size() >= MaxSubscriptions) {
+        LOG_WARNING(RPC_Server, "Too many memory subscriptions, dropping id={}",
+                    subscriptions.front().packet->GetId());
+        subscriptions.erase(subscriptions.begin());
+    }
+    subscriptions.push_back({std::move(packet), std::move(ranges), {}});
+}
+
+void RPCServer::HandleGetFrameTimeStats(Packet& packet) {
+    const Core::PerfStats::FrameTimeStats stats = system.perf_stats->GetFrameTimeStats();
+    std::vector<float> values{static_cast<float>(stats.percentile_50),
+                              static_cast<float>(stats.percentile_95),
+                              static_cast<float>(stats.percentile_99)};
+    for (double category_time : stats.category_time) {
+        values.push_back(static_cast<float>(category_time));
+    }
+    const u32 data_size = static_cast<u32>(values.size() * sizeof(float));
+    std::memcpy(packet.GetPacketData().data(), values.data(), data_size);
+    packet.SetPacketDataSize(data_size);
+    packet.SendReply();
+}
+
+void RPCServer::HandleGetIPCStats(Packet& packet) {
+    auto& recorder = system.Kernel().GetIPCRecorder();
+    if (packet.GetPacketDataSize() == sizeof(u32)) {
+        u32 sample_interval;
+        std::memcpy(&sample_interval, packet.GetPacketData().data(), sizeof(u32));
+        recorder.SetSampleInterval(sample_interval);
+        recorder.SetEnabled(sample_interval != 0);
+    }
+
+    struct Entry {
+        std::array<char, 8> port_name;
+        u32 header;
+        u32 count;
+        u32 total_us;
+        u32 percentile_50_us;
+        u32 percentile_99_us;
+    };
+    constexpr std::size_t max_entries = MAX_PACKET_DATA_SIZE / sizeof(Entry);
+
+    std::vector<IPCDebugger::CommandStats> stats = recorder.GetCommandStats();
+    const std::size_t num_entries = std::min(stats.size(), max_entries);
+    std::partial_sort(stats.begin(), stats.begin() + num_entries, stats.end(),
+                      [](const auto& a, const auto& b) { return a.total_ns > b.total_ns; });
+
+    for (std::size_t i = 0; i < num_entries; ++i) {
+        const IPCDebugger::CommandStats& command = stats[i];
+        Entry entry{};
+        command.port_name.copy(entry.port_name.data(), entry.port_name.size());
+        entry.header = command.header;
+        entry.count = static_cast<u32>(command.count);
+        entry.total_us = static_cast<u32>(command.total_ns / 1000);
+        entry.percentile_50_us = static_cast<u32>(command.GetPercentileUs(0.5));
+        entry.percentile_99_us = static_cast<u32>(command.GetPercentileUs(0.99));
+        std::memcpy(packet.GetPacketData().data() + i * sizeof(Entry), &entry, sizeof(Entry));
+    }
+    packet.SetPacketDataSize(static_cast<u32>(num_entries * sizeof(Entry)));
+    packet.SendReply();
+}
+
 bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
     if (packet_header.version <= CURRENT_VERSION) {
         switch (packet_header.packet_type) {
         case PacketType::ReadMemory:
         case PacketType::WriteMemory:
+        case PacketType::WriteMemoryRanges:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
             break;
+        case PacketType::ReadMemoryRanges:
+            if (packet_header.packet_size >= (sizeof(u32) * 2) &&
+                packet_header.packet_size % (sizeof(u32) * 2) == 0) {
+                return true;
+            }
+            break;
+        case PacketType::SubscribeMemory:
+            if (packet_header.packet_size % (sizeof(u32) * 2) == 0) {
+                return true;
+            }
+            break;
+        case PacketType::GetFrameTimeStats:
+            return true;
+        case PacketType::GetIPCStats:
+            return packet_header.packet_size == 0 || packet_header.packet_size == sizeof(u32);
         default:
             break;
         }
@@ -74,12 +239,24 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     bool success = false;
 
     if (ValidatePacket(request_packet->GetHeader())) {
-        // Currently, all request types use the address/data_size wire format
+        // ReadMemory and WriteMemory use the address/data_size wire format, the range requests a
+        // list of them
+        const u8* packet_data = request_packet->GetPacketData().data();
+        const u32 packet_size = request_packet->GetPacketDataSize();
         u32 address = 0;
         u32 data_size = 0;
-        std::memcpy(&address, request_packet->GetPacketData().data(), sizeof(address));
-        std::memcpy(&data_size, request_packet->GetPacketData().data() + sizeof(address),
-                    sizeof(data_size));
+        std::memcpy(&address, packet_data, sizeof(address));
+        std::memcpy(&data_size, packet_data + sizeof(address), sizeof(data_size));
+
+        std::vector<MemoryRange> ranges(packet_size / (sizeof(u32) * 2));
+        std::memcpy(ranges.data(), packet_data, ranges.size() * sizeof(MemoryRange));
+        u32 ranges_size = 0;
+        const bool valid_ranges =
+            std::all_of(ranges.begin(), ranges.end(), [&ranges_size](const MemoryRange& range) {
+                ranges_size += range.size;
+                return range.size > 0 && range.size <= MAX_READ_SIZE &&
+                       ranges_size <= MAX_READ_SIZE;
+            });
 
         switch (request_packet->GetPacketType()) {
         case PacketType::ReadMemory:
@@ -95,6 +272,29 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ReadMemoryRanges:
+            if (valid_ranges) {
+                HandleReadMemoryRanges(*request_packet, ranges);
+                success = true;
+            }
+            break;
+        case PacketType::WriteMemoryRanges:
+            success = HandleWriteMemoryRanges(*request_packet);
+            break;
+        case PacketType::SubscribeMemory:
+            if (valid_ranges) {
+                HandleSubscribeMemory(std::move(request_packet), std::move(ranges));
+                return;
+            }
+            break;
+        case PacketType::GetFrameTimeStats:
+            HandleGetFrameTimeStats(*request_packet);
+            success = true;
+            break;
+        case PacketType::GetIPCStats:
+            HandleGetIPCStats(*request_packet);
+            success = true;
+            break;
         default:
             break;
         }
@@ -107,18 +307,89 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     }
 }
 
-void RPCServer::HandleRequestsLoop() {
-    std::unique_ptr<RPC::Packet> request_packet;
+void RPCServer::HandleRequests(std::vector<std::unique_ptr<Packet>> requests) {
+    std::lock_guard lock{handle_mutex};
+    if (!system.Kernel().GetCurrentProcess()) {
+        // No application running yet, the requests are answered with empty replies
+        for (auto& request : requests) {
+            request->SetPacketDataSize(0);
+            request->SendReply();
+        }
+        return;
+    }
+
+    for (auto& request : requests) {
+        HandleSingleRequest(std::move(request));
+    }
 
+    std::vector<u8> contents;
+    for (Subscription& subscription : subscriptions) {
+        contents.clear();
+        for (const MemoryRange& range : subscription.ranges) {
+            contents.resize(contents.size() + range.size);
+            system.Memory().ReadBlock(*system.Kernel().GetCurrentProcess(), range.address,
+                                      contents.data() + contents.size() - range.size, range.size);
+        }
+        if (contents == subscription.contents) {
+            continue;
+        }
+
+        std::memcpy(subscription.packet->GetPacketData().data(), contents.data(), contents.size());
+        subscription.packet->SetPacketDataSize(static_cast<u32>(contents.size()));
+        subscription.packet->SendReply();
+        subscription.contents.swap(contents);
+    }
+}
+
+void RPCServer::FrameCallback(s64 cycles_late) {
+    std::vector<std::unique_ptr<Packet>> requests;
+    {
+        std::lock_guard lock{pending_mutex};
+        requests.swap(pending_requests);
+    }
+    pending_cv.notify_one();
+    HandleRequests(std::move(requests));
+
+    system.CoreTiming().ScheduleEvent(frame_ticks - cycles_late, frame_event);
+}
+
+void RPCServer::HandleRequestsLoop() {
     LOG_INFO(RPC_Server, "Request handler started.");
 
-    while ((request_packet = request_queue.PopWait())) {
-        HandleSingleRequest(std::move(request_packet));
+    std::unique_lock lock{pending_mutex};
+    while (!stop_requested) {
+        if (pending_requests.empty()) {
+            pending_cv.wait(lock, [this] { return stop_requested || !pending_requests.empty(); });
+            continue;
+        }
+
+        // The requests are normally taken at the end of the frame, unless the emulation is paused
+        if (pending_cv.wait_until(lock, oldest_request_time + FrameTimeout, [this] {
+                return stop_requested || pending_requests.empty();
+            })) {
+            continue;
+        }
+        std::vector<std::unique_ptr<Packet>> requests;
+        requests.swap(pending_requests);
+        lock.unlock();
+        HandleRequests(std::move(requests));
+        lock.lock();
     }
 }
 
 void RPCServer::QueueRequest(std::unique_ptr<RPC::Packet> request) {
-    request_queue.Push(std::move(request));
+    {
+        std::lock_guard lock{pending_mutex};
+        if (!request) {
+            stop_requested = true;
+        } else {
+            if (pending_requests.empty()) {
+                oldest_request_time = std::chrono::steady_clock::now();
+            }
+            pending_requests.push_back(std::move(request));
+        }
+    }
+    pending_cv.notify_one();
 }
 
 void RPCServer::Start() {
@@ -4,37 +4,82 @@
 
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <thread>
-#include "common/threadsafe_queue.h"
+#include <vector>
+#include "common/common_types.h"
 #include "core/rpc/server.h"
 
+namespace Core {
+class System;
+struct TimingEventType;
+} // namespace Core
+
 namespace RPC {
 
 class Packet;
 struct PacketHeader;
 
+/**
+ * Services the memory requests of scripts. The requests received during a frame are handled
+ * together on the emulation thread at its end, so that they see a consistent state, or on the
+ * request handler thread when the emulation is paused.
+ */
 class RPCServer {
 public:
-    RPCServer();
+    explicit RPCServer(Core::System& system);
     ~RPCServer();
 
     void QueueRequest(std::unique_ptr<RPC::Packet> request);
 
 private:
+    struct MemoryRange {
+        u32 address;
+        u32 size;
+    };
+
+    struct Subscription {
+        std::unique_ptr<Packet> packet;
+        std::vector<MemoryRange> ranges;
+        /// What was last sent, the ranges are only sent again once they change
+        std::vector<u8> contents;
+    };
+
     void Start();
     void Stop();
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, const u8* data, u32 data_size);
+    void HandleReadMemoryRanges(Packet& packet, const std::vector<MemoryRange>& ranges);
+    bool HandleWriteMemoryRanges(Packet& packet);
+    void HandleSubscribeMemory(std::unique_ptr<Packet> packet, std::vector<MemoryRange> ranges);
+    void HandleGetFrameTimeStats(Packet& packet);
+    void HandleGetIPCStats(Packet& packet);
     bool ValidatePacket(const PacketHeader& packet_header);
     void HandleSingleRequest(std::unique_ptr<Packet> request);
+    /// Handles the requests and sends the subscribed ranges that changed
+    void HandleRequests(std::vector<std::unique_ptr<Packet>> requests);
     void HandleRequestsLoop();
+    void FrameCallback(s64 cycles_late);
+
+    Core::System& system;
+    Core::TimingEventType* frame_event;
 
     Server server;
-    Common::SPSCQueue<std::unique_ptr<Packet>> request_queue;
     std::thread request_handler_thread;
+
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    /// Received requests waiting for the end of the frame
+    std::vector<std::unique_ptr<Packet>> pending_requests;
+    std::chrono::steady_clock::time_point oldest_request_time;
+    bool stop_requested = false;
+
+    /// Held while handling requests, which the emulation and handler threads may both do
+    std::mutex handle_mutex;
+    std::vector<Subscription> subscriptions;
 };
 
 } // namespace RPC
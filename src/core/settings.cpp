@@ -2,8 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstdlib>
 #include <utility>
+#include <fmt/format.h>
 #include "audio_core/dsp_interface.h"
+#include "common/string_util.h"
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/hle/service/hid/hid.h"
@@ -56,14 +60,35 @@ void LogSetting(const std::string& name, const T& value) {
 void LogSettings() {
     LOG_INFO(Config, "Citra Configuration:");
     LogSetting("Core_UseCpuJit", Settings::values.use_cpu_jit);
+    LogSetting("Core_UseCodeCache", Settings::values.use_code_cache);
+    LogSetting("Core_RewindInterval", Settings::values.rewind_interval);
+    LogSetting("Core_RewindBudget", Settings::values.rewind_budget);
     LogSetting("Renderer_UseGLES", Settings::values.use_gles);
     LogSetting("Renderer_UseHwRenderer", Settings::values.use_hw_renderer);
     LogSetting("Renderer_UseHwShader", Settings::values.use_hw_shader);
     LogSetting("Renderer_ShadersAccurateMul", Settings::values.shaders_accurate_mul);
     LogSetting("Renderer_UseShaderJit", Settings::values.use_shader_jit);
+    LogSetting("Renderer_UseAsyncShader", Settings::values.use_async_shader);
+    LogSetting("Renderer_UseGpuTextureDecode", Settings::values.use_gpu_texture_decode);
+    LogSetting("Renderer_GenerateMipmaps", Settings::values.generate_mipmaps);
+    LogSetting("Renderer_MergeDrawCalls", Settings::values.merge_draw_calls);
+    LogSetting("Renderer_SpecializeShaderUniforms", Settings::values.specialize_shader_uniforms);
+    LogSetting("Renderer_CacheVertexArrays", Settings::values.cache_vertex_arrays);
+    LogSetting("Renderer_MultithreadedSwRasterizer", Settings::values.multithreaded_sw_rasterizer);
+    LogSetting("Renderer_UseGpuThread", Settings::values.use_gpu_thread);
+    LogSetting("Renderer_VertexCacheSize", Settings::values.vertex_cache_size);
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
+    LogSetting("Renderer_ResolutionFactorDepth", Settings::values.resolution_factor_depth);
+    LogSetting("Renderer_ResolutionFactorOffscreen", Settings::values.resolution_factor_offscreen);
+    LogSetting("Renderer_ResolutionFactorReadback", Settings::values.resolution_factor_readback);
+    LogSetting("Renderer_UseDynamicResolution", Settings::values.use_dynamic_resolution);
+    LogSetting("Renderer_DynamicResolutionMin", Settings::values.dynamic_resolution_min);
+    LogSetting("Renderer_DynamicResolutionMax", Settings::values.dynamic_resolution_max);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
     LogSetting("Renderer_FrameLimit", Settings::values.frame_limit);
+    LogSetting("Renderer_FrameSkip", Settings::values.frame_skip);
+    LogSetting("Renderer_AutoFrameSkip", Settings::values.auto_frame_skip);
+    LogSetting("Renderer_TextureMemoryBudget", Settings::values.texture_memory_budget);
     LogSetting("Renderer_PostProcessingShader", Settings::values.pp_shader_name);
     LogSetting("Layout_Factor3d", Settings::values.factor_3d);
     LogSetting("Layout_LayoutOption", static_cast<int>(Settings::values.layout_option));
@@ -73,6 +98,8 @@ void LogSettings() {
     LogSetting("Audio_EnableDspLleMultithread", Settings::values.enable_dsp_lle_multithread);
     LogSetting("Audio_OutputEngine", Settings::values.sink_id);
     LogSetting("Audio_EnableAudioStretching", Settings::values.enable_audio_stretching);
+    LogSetting("Audio_AudioStretchLatency", Settings::values.audio_stretch_latency);
+    LogSetting("Audio_EnableAudioThread", Settings::values.enable_audio_thread);
     LogSetting("Audio_OutputDevice", Settings::values.audio_device_id);
     LogSetting("Audio_InputDeviceType", static_cast<int>(Settings::values.mic_input_type));
     LogSetting("Audio_InputDevice", Settings::values.mic_input_device);
@@ -88,9 +115,11 @@ void LogSettings() {
     LogSetting("Camera_OuterLeftFlip", Settings::values.camera_flip[OuterLeftCamera]);
     LogSetting("DataStorage_UseVirtualSd", Settings::values.use_virtual_sd);
     LogSetting("System_IsNew3ds", Settings::values.is_new_3ds);
+    LogSetting("System_UseParallelCores", Settings::values.use_parallel_cores);
     LogSetting("System_RegionValue", Settings::values.region_value);
     LogSetting("Debugging_UseGdbstub", Settings::values.use_gdbstub);
     LogSetting("Debugging_GdbstubPort", Settings::values.gdbstub_port);
+    LogSetting("Debugging_LLEFastPaths", GetLLEFastPaths());
 }
 
 void SetFMVHack(bool enable) {
@@ -154,6 +183,56 @@ void SetLLEModules(const std::string& modules) {
     }
 }
 
+void SetLLEFastPaths(const std::string& fast_paths) {
+    Settings::values.lle_fast_paths.clear();
+
+    std::vector<std::string> entries;
+    Common::SplitString(fast_paths, ',', entries);
+    for (const std::string& raw_entry : entries) {
+        const std::string entry = Common::StripSpaces(raw_entry);
+        // Service names may contain colons, the header comes after the last slash
+        const std::size_t slash = entry.rfind('/');
+        if (slash == 0 || slash == std::string::npos || slash + 1 == entry.size()) {
+            if (!entry.empty()) {
+                LOG_ERROR(Config, "Invalid LLE fast path \"{}\"", entry);
+            }
+            continue;
+        }
+
+        char* end;
+        const unsigned long header = std::strtoul(entry.c_str() + slash + 1, &end, 16);
+        if (*end != '\0') {
+            LOG_ERROR(Config, "Invalid LLE fast path \"{}\"", entry);
+            continue;
+        }
+
+        auto& headers = Settings::values.lle_fast_paths[entry.substr(0, slash)];
+        if (std::find(headers.begin(), headers.end(), header) == headers.end()) {
+            headers.push_back(static_cast<u32>(header));
+        }
+    }
+}
+
+std::string GetLLEFastPaths() {
+    std::vector<std::string> entries;
+    for (const auto& [service, headers] : Settings::values.lle_fast_paths) {
+        for (u32 header : headers) {
+            entries.push_back(fmt::format("{}/{:#010x}", service, header));
+        }
+    }
+    // The map has no order, keep the config files stable
+    std::sort(entries.begin(), entries.end());
+
+    std::string fast_paths;
+    for (const std::string& entry : entries) {
+        if (!fast_paths.empty()) {
+            fast_paths += ", ";
+        }
+        fast_paths += entry;
+    }
+    return fast_paths;
+}
+
 void LoadProfile(int index) {
     Settings::values.current_input_profile = Settings::values.input_profiles[index];
     Settings::values.current_input_profile_index = index;
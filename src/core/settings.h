@@ -124,6 +124,7 @@ struct InputProfile {
 struct Values {
     // CheckNew3DS
     bool is_new_3ds;
+    bool use_parallel_cores;
 
     // Controls
     InputProfile current_input_profile;       ///< The current input profile
@@ -148,9 +149,24 @@ struct Values {
     bool use_hw_shader;
     bool use_shader_jit;
     u16 resolution_factor;
+    /// Resolution factors of depth only and shadow targets, of small or square offscreen targets
+    /// and of targets the CPU reads back. Zero uses resolution_factor.
+    u16 resolution_factor_depth;
+    u16 resolution_factor_offscreen;
+    u16 resolution_factor_readback;
+    /// Steps the render target scale between the bounds by the GPU time of the frames, starting
+    /// from resolution_factor
+    bool use_dynamic_resolution;
+    u16 dynamic_resolution_min;
+    u16 dynamic_resolution_max;
     bool vsync_enabled;
     bool use_frame_limit;
     u16 frame_limit;
+    /// Frames emulated but neither drawn nor shown after each shown one, the most in a row with
+    /// auto_frame_skip. Zero disables frame skipping.
+    u16 frame_skip;
+    /// Skips frames only while the emulation runs slower than the frame limit
+    bool auto_frame_skip;
 
     LayoutOption layout_option;
     bool swap_screen;
@@ -169,12 +185,18 @@ struct Values {
 
     bool custom_textures;
     bool preload_textures;
+    /// Texture memory used by the rasterizer cache before old surfaces get evicted, in MiB.
+    /// Zero disables the limit.
+    u16 texture_memory_budget;
 
     // Audio
     bool enable_dsp_lle;
     bool enable_dsp_lle_multithread;
     std::string sink_id;
     bool enable_audio_stretching;
+    /// Output latency the audio stretcher keeps its backlog under, in milliseconds
+    u16 audio_stretch_latency;
+    bool enable_audio_thread;
     std::string audio_device_id;
     float volume;
     MicInputType mic_input_type;
@@ -190,14 +212,36 @@ struct Values {
     u16 gdbstub_port;
     std::string log_filter;
     std::unordered_map<std::string, bool> lle_modules;
+    /// Commands of the services of LLE modules that the HLE implementation answers, by service
+    std::unordered_map<std::string, std::vector<u32>> lle_fast_paths;
 
     u32 core_ticks_hack;
     bool core_downcount_hack;
     bool allow_shadow;
     bool use_separable_shader;
     bool use_shader_cache;
+    bool use_code_cache;
+    /// Frames between the RAM snapshots of the rewind buffer, zero disables it
+    u16 rewind_interval;
+    /// Memory the rewind buffer keeps its snapshots under, in MiB
+    u16 rewind_budget;
+    /// Backs the emulated RAM with transparent huge pages where the host supports them
+    bool use_huge_pages;
+    bool use_async_shader;
+    bool use_gpu_texture_decode;
+    /// Generates the mipmaps of textures whose guest mipmaps are plain box filtered
+    bool generate_mipmaps;
+    bool merge_draw_calls;
+    bool specialize_shader_uniforms;
+    bool cache_vertex_arrays;
+    bool multithreaded_sw_rasterizer;
+    bool use_gpu_thread;
+    u16 vertex_cache_size;
     bool skip_slow_draw;
-    bool skip_cpu_write;
+    /// Doesn't signal the HID pad event while the buttons, circle pad and touch stay the same
+    bool skip_unchanged_input_events;
+    /// Leaves surfaces under small CPU writes to the data cache flushes the guest sends to GSP
+    bool trust_cache_maintenance;
     bool disable_clip_coef;
     bool display_transfer_hack;
     bool stream_buffer_hack;
@@ -223,6 +267,10 @@ void LogSettings();
 
 void SetFMVHack(bool enable);
 void SetLLEModules(const std::string& modules);
+/// Parses a list like "cfg:u/0x00010082, fs:USER/0x080201C2" into the LLE fast paths
+void SetLLEFastPaths(const std::string& fast_paths);
+/// Returns the LLE fast paths in the form SetLLEFastPaths takes
+std::string GetLLEFastPaths();
 
 // Input profiles
 void LoadProfile(int index);
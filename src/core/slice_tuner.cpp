@@ -0,0 +1,132 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/cache_file.h"
+#include "core/core_timing.h"
+#include "core/slice_tuner.h"
+
+namespace Core {
+
+static constexpr u32 TUNING_FILE_VERSION = 0x1;
+
+/// Emulated time between two measurements of the host speed
+static constexpr s64 WINDOW_TICKS = BASE_CLOCK_RATE_ARM11 / 2;
+static constexpr std::chrono::microseconds WINDOW_DURATION{500000};
+
+/// Windows longer than this cover a pause of the emulation or a hitch of the host
+static constexpr std::chrono::microseconds MAX_WINDOW_DURATION = WINDOW_DURATION * 4;
+
+/// Speed below which a window counts as slow, and above which it counts as full speed
+static constexpr double SLOW_SPEED = 0.9;
+static constexpr double FULL_SPEED = 0.98;
+
+/// Slow windows in a row before the level goes up
+static constexpr u32 SLOW_WINDOWS = 4;
+/// Full speed windows before a lower level counts as holding
+static constexpr u32 CONFIRM_WINDOWS = 20;
+static constexpr u32 INITIAL_PROBE_WINDOWS = 20;
+static constexpr u32 MAX_PROBE_WINDOWS = 600;
+
+static std::string GetTuningFile(u64 title_id) {
+    const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    return fmt::format("{}{:016X}.clock", dir, title_id);
+}
+
+void SetClockLevel(Timing& timing, u32 level) {
+    const auto& shifts = CLOCK_LEVEL_SHIFTS[std::min(level, MAX_CLOCK_LEVEL)];
+    for (u32 i = 0; i < shifts.size(); ++i) {
+        timing.GetTimer(i)->SetDowncountHack(shifts[i]);
+    }
+}
+
+SliceTuner::SliceTuner(Timing& timing, u64 title_id)
+    : timing(timing), title_id(title_id), probe_windows(INITIAL_PROBE_WINDOWS) {
+    if (title_id != 0 && FileUtil::Exists(GetTuningFile(title_id))) {
+        CacheFile file(GetTuningFile(title_id), CacheFile::MODE_LOAD);
+        u32 version = 0;
+        u32 saved_level = 0;
+        file.DoHeader(version);
+        file.Do(saved_level);
+        file.Do(probe_windows);
+        if (file.IsGood() && version == TUNING_FILE_VERSION) {
+            level = std::min(saved_level, MAX_CLOCK_LEVEL);
+            probe_windows = std::clamp(probe_windows, INITIAL_PROBE_WINDOWS, MAX_PROBE_WINDOWS);
+        } else {
+            probe_windows = INITIAL_PROBE_WINDOWS;
+        }
+    }
+    initial_level = level;
+    SetClockLevel(timing, level);
+
+    update_event = timing.RegisterEvent(
+        "SliceTuner", [this](u64, s64 cycles_late) { Update(cycles_late); });
+    window_start = Clock::now();
+    timing.ScheduleEvent(WINDOW_TICKS, update_event, 0, 0);
+}
+
+SliceTuner::~SliceTuner() {
+    timing.RemoveEvent(update_event);
+    if (title_id == 0 || level == initial_level) {
+        return;
+    }
+
+    CacheFile file(GetTuningFile(title_id), CacheFile::MODE_SAVE);
+    u32 version = TUNING_FILE_VERSION;
+    file.DoHeader(version);
+    file.Do(level);
+    file.Do(probe_windows);
+}
+
+void SliceTuner::Update(s64 cycles_late) {
+    const Clock::time_point now = Clock::now();
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - window_start);
+    window_start = now;
+    timing.ScheduleEvent(WINDOW_TICKS - cycles_late, update_event, 0, 0);
+
+    if (duration > MAX_WINDOW_DURATION || duration.count() <= 0) {
+        return;
+    }
+
+    const double speed = static_cast<double>(WINDOW_DURATION.count()) / duration.count();
+    if (speed < SLOW_SPEED) {
+        full_windows = 0;
+        if (++slow_windows < SLOW_WINDOWS || level == MAX_CLOCK_LEVEL) {
+            return;
+        }
+        if (probing) {
+            // The lower level did not hold, wait longer before the next try
+            probe_windows = std::min(probe_windows * 2, MAX_PROBE_WINDOWS);
+            probing = false;
+        }
+        SetLevel(level + 1);
+    } else if (speed >= FULL_SPEED) {
+        slow_windows = 0;
+        ++full_windows;
+        if (probing && full_windows >= CONFIRM_WINDOWS) {
+            probing = false;
+        }
+        if (level > 0 && full_windows >= probe_windows) {
+            probing = true;
+            SetLevel(level - 1);
+        }
+    } else {
+        slow_windows = 0;
+        full_windows = 0;
+    }
+}
+
+void SliceTuner::SetLevel(u32 new_level) {
+    LOG_INFO(Core, "CPU clock level {} -> {}", level, new_level);
+    level = new_level;
+    slow_windows = 0;
+    full_windows = 0;
+    SetClockLevel(timing, level);
+}
+
+} // namespace Core
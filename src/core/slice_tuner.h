@@ -0,0 +1,61 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include "common/common_types.h"
+
+namespace Core {
+
+class Timing;
+struct TimingEventType;
+
+/// Downcount shifts of the four cores at each clock level, 0 runs the cores at full clock
+constexpr std::array<std::array<u32, 4>, 3> CLOCK_LEVEL_SHIFTS{{
+    {0, 0, 0, 0},
+    {0, 2, 1, 1},
+    {1, 4, 2, 2},
+}};
+constexpr u32 MAX_CLOCK_LEVEL = static_cast<u32>(CLOCK_LEVEL_SHIFTS.size() - 1);
+
+/// Scales the clock of the emulated cores down, running fewer instructions per slice
+void SetClockLevel(Timing& timing, u32 level);
+
+/**
+ * Picks the clock level of the running title from the speed the host reaches. The level goes up
+ * while the title runs below full speed, and a lower one is tried again after a while at full
+ * speed, waiting twice as long each time the try fails. The level is kept on the disk per title,
+ * so the next session starts where this one ended.
+ */
+class SliceTuner {
+public:
+    SliceTuner(Timing& timing, u64 title_id);
+    ~SliceTuner();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Update(s64 cycles_late);
+    void SetLevel(u32 new_level);
+
+    Timing& timing;
+    const u64 title_id;
+    TimingEventType* update_event;
+    Clock::time_point window_start;
+
+    u32 level = 0;
+    u32 initial_level = 0;
+    /// Windows in a row below full speed
+    u32 slow_windows = 0;
+    /// Windows in a row at full speed
+    u32 full_windows = 0;
+    /// Windows at full speed before a lower level is tried
+    u32 probe_windows;
+    /// Whether the current level comes from a try that is yet to hold
+    bool probing = false;
+};
+
+} // namespace Core
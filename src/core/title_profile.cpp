@@ -0,0 +1,409 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <vector>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "core/settings.h"
+#include "core/title_profile.h"
+
+namespace Core {
+
+/// Profiles of the titles that need other settings than the configured ones to run well
+static const char builtin_profiles[] = R"(
+[0004000000068B00, 0004000000061300, 000400000004A700]
+# Tales of the Abyss / Pac Man Party 3D
+display_transfer_hack = on
+# Crashes reconfiguring the geometry pipeline
+skip_slow_draw = on
+
+[00040000001CCD00, 00040000001B4500]
+# The Alliance Alive
+fmv_hack = on
+
+[0004000000120900, 0004000000164300]
+# Lord of Magna: Maiden Heaven
+fmv_hack = on
+
+[000400000015CB00]
+# New Atelier Rorona
+# Its software geometry shader draws are only too slow to keep in the interpreter
+skip_slow_draw = interpreter
+
+[000400000018E900]
+# My Hero Academia
+skip_slow_draw = interpreter
+
+[000400000016AD00]
+# Dragon Quest Monsters Joker 3
+skip_slow_draw = interpreter
+
+[00040000001ACB00]
+# Dragon Quest Monsters Joker 3 Professional
+skip_slow_draw = interpreter
+
+[000400000019E700, 00040000001A5600]
+# Armed Blue Gunvolt
+stream_buffer_hack = off
+
+[000400000019B200, 0004000000196A00, 00040000001A6E00]
+# Armed Blue Gunvolt 2
+stream_buffer_hack = off
+
+[0004000000149100]
+# Gravity Falls - Legend of the Gnome Gemulets
+stream_buffer_hack = off
+
+[0004000000196900, 0004000000119A00, 000400000017C900, 000400000017E100]
+# Shovel Knight
+stream_buffer_hack = off
+
+[000400000008FE00]
+# 1001 Spikes [USA]
+stream_buffer_hack = off
+fmv_hack = on
+new_3ds = on
+
+[0004000000049100, 0004000000030400, 0004000000049000]
+# Star Fox 64
+disable_clip_coef = on
+
+[00040000000DCA00]
+# Danball Senki W Chou Custom
+y2r_perform_hack = on
+
+[00040000001AA200]
+# Attack On Titan 2
+linear_filter = on
+
+[0004000000134500, 0004000000152000]
+# Attack On Titan 1 CHAIN
+linear_filter = on
+
+[00040000000DF800]
+# Attack On Titan 1
+linear_filter = on
+
+[0004000000044700, 0004000000047A00, 0004000000044800]
+# FIFA 12
+y2r_event_delay = on
+
+[00040000000A2B00, 00040000000A2900, 00040000000A3000]
+# FIFA 13
+y2r_event_delay = on
+
+[00040000000E7900, 00040000000DEA00, 00040000000E7A00]
+# FIFA 14
+y2r_event_delay = on
+
+[000400000013C700, 000400000013CA00, 000400000013CB00]
+# FIFA 15
+y2r_event_delay = on
+
+[0004000000134500, 00040000000DF800, 0004000000152000, 00040000001AA200]
+# Attack on Titan
+accurate_mul = on
+
+[0004000000054000, 0004000000053F00, 0004000000054100, 0004000000089F00, 0004000000089E00]
+# Super Mario 3D Land
+accurate_mul = on
+
+[0004000000033400, 0004000000033500, 0004000000033600, 000400000008F800, 000400000008F900]
+# The Legend of Zelda: Ocarina of Time 3D
+accurate_mul = on
+
+[0004000000132700, 0004000000132600, 0004000000132800]
+# Mario & Luigi: Paper Jam
+accurate_mul = on
+
+[00040000001D1400, 00040000001D1500]
+# Mario & Luigi: Bowsers Inside Story + Bowser Jrs Journey
+accurate_mul = on
+
+[00040000001B8F00, 00040000001B9000, 0004000000194B00]
+# Mario & Luigi: Superstar Saga + Bowsers Minions
+accurate_mul = on
+
+[00040000001CB000, 00040000001CB200, 00040000001CB100]
+# Captain Toad: Treasure Tracker
+accurate_mul = on
+
+[00040000000EC200, 00040000000EC300, 00040000000EC400]
+# The Legend of Zelda: A Link Between Worlds
+accurate_mul = on
+
+[000400000007AD00, 00040000000B8A00, 000400000007AE00, 000400000007AF00]
+# New Super Mario Bros. 2
+accurate_mul = on
+
+[0004000000079600]
+# Jett Rocket II
+accurate_mul = on
+
+[0004000000112600, 0004000000116700]
+# Cut the Rope
+accurate_mul = on
+
+[00040000000D0000, 0004000000076400, 0004000000055F00, 0004000000076500]
+# Luigi's Mansion: Dark Moon
+accurate_mul = on
+
+[00040000000AFC00]
+# Digimon World Re:Digitize Decode
+accurate_mul = on
+
+[0004000000125600, 0004000000125500, 00040000000D6E00]
+# The Legend of Zelda: Majoras Mask 3D
+accurate_mul = on
+
+[0004000000154700, 00040000000AD600, 00040000000AD500]
+# Lego City Undercover
+accurate_mul = on
+
+[00040000001D1800, 00040000001D1A00, 00040000001D1900]
+# Luigi's Mansion
+accurate_mul = on
+
+[000400000F700000, 000400000F700100, 000400000F700200]
+# Xenoblade Chronicles 3D
+new_3ds = on
+
+[000400000F70CC00, 000400000F70CD00, 000400000F70C100]
+# Fire Emblem Warriors
+new_3ds = on
+
+[000400000F700800, 000400000F701700, 000400000F700900]
+# The Binding of Isaac: Rebirth
+new_3ds = on
+
+[00040000000CCE00, 00040000000CC000, 00040000000CCF00]
+# Donkey Kong Country Returns 3D
+new_3ds = on
+
+[0004000000127500, 000400000014AE00, 000400000012C200]
+# Sonic Boom: Shattered Crystal
+new_3ds = on
+
+[0004000000161300, 0004000000170700, 0004000000164700]
+# Sonic Boom: Fire & Ice
+new_3ds = on
+
+[00040000000B3500, 000400000008FC00]
+# Sonic & All-Stars Racing Transformed
+new_3ds = on
+
+[00040000001B8700]
+# Minecraft
+new_3ds = on
+
+[000400000F707F00]
+# Hyperlight EX
+new_3ds = on
+
+[000400000007C700, 000400000007C800, 0004000000064D00, 00040000000B9100]
+# Mario Tennis Open
+new_3ds = on
+
+[00040000000DCD00, 00040000000A5300, 00040000000DCE00]
+# Mario Golf: World Tour
+new_3ds = on
+)";
+
+const char* GetProfileSettingName(ProfileSetting setting) {
+    switch (setting) {
+    case ProfileSetting::DisplayTransferHack:
+        return "display_transfer_hack";
+    case ProfileSetting::SkipSlowDraw:
+        return "skip_slow_draw";
+    case ProfileSetting::FMVHack:
+        return "fmv_hack";
+    case ProfileSetting::StreamBufferHack:
+        return "stream_buffer_hack";
+    case ProfileSetting::DisableClipCoef:
+        return "disable_clip_coef";
+    case ProfileSetting::Y2RPerformHack:
+        return "y2r_perform_hack";
+    case ProfileSetting::Y2REventDelay:
+        return "y2r_event_delay";
+    case ProfileSetting::LinearFilter:
+        return "linear_filter";
+    case ProfileSetting::AccurateMul:
+        return "accurate_mul";
+    case ProfileSetting::New3DS:
+        return "new_3ds";
+    }
+    return "";
+}
+
+bool IsProfileSettingTunable(ProfileSetting setting) {
+    switch (setting) {
+    case ProfileSetting::DisplayTransferHack:
+    case ProfileSetting::SkipSlowDraw:
+    case ProfileSetting::FMVHack:
+    case ProfileSetting::DisableClipCoef:
+    case ProfileSetting::Y2RPerformHack:
+    case ProfileSetting::Y2REventDelay:
+        return true;
+    default:
+        // Read when the renderer or the system is created
+        return false;
+    }
+}
+
+bool TitleProfile::HasAutoSettings() const {
+    return std::find(values.begin(), values.end(), ProfileValue::Auto) != values.end();
+}
+
+static std::optional<ProfileSetting> FindProfileSetting(const std::string& name) {
+    for (std::size_t i = 0; i < NUM_PROFILE_SETTINGS; ++i) {
+        const auto setting = static_cast<ProfileSetting>(i);
+        if (name == GetProfileSettingName(setting)) {
+            return setting;
+        }
+    }
+    return std::nullopt;
+}
+
+static std::optional<ProfileValue> ParseProfileValue(const std::string& value) {
+    if (value == "off") {
+        return ProfileValue::Off;
+    }
+    if (value == "on") {
+        return ProfileValue::On;
+    }
+    if (value == "interpreter") {
+        return ProfileValue::Interpreter;
+    }
+    if (value == "auto") {
+        return ProfileValue::Auto;
+    }
+    return std::nullopt;
+}
+
+/// Returns true if the title is in the list of title IDs of an entry header
+static bool IsTitleListed(const std::string& header, u64 title_id) {
+    std::vector<std::string> ids;
+    Common::SplitString(header.substr(1, header.find(']') - 1), ',', ids);
+    return std::any_of(ids.begin(), ids.end(), [title_id](const std::string& id) {
+        const std::string hex = Common::StripSpaces(id);
+        return !hex.empty() && std::strtoull(hex.c_str(), nullptr, 16) == title_id;
+    });
+}
+
+void ParseTitleProfiles(const std::string& text, u64 title_id, TitleProfile& profile) {
+    std::istringstream stream(text);
+    std::string line;
+    bool in_entry = false;
+    while (std::getline(stream, line)) {
+        line = Common::StripSpaces(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            in_entry = IsTitleListed(line, title_id);
+            continue;
+        }
+        if (!in_entry) {
+            continue;
+        }
+
+        const std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            LOG_WARNING(Core, "Invalid line in title profile: {}", line);
+            continue;
+        }
+        const auto setting = FindProfileSetting(Common::StripSpaces(line.substr(0, equals)));
+        const auto value =
+            ParseProfileValue(Common::ToLower(Common::StripSpaces(line.substr(equals + 1))));
+        if (!setting || !value) {
+            LOG_WARNING(Core, "Invalid setting in title profile: {}", line);
+            continue;
+        }
+        if (*value == ProfileValue::Auto && !IsProfileSettingTunable(*setting)) {
+            LOG_WARNING(Core, "Setting {} of title profile can't be tuned",
+                        GetProfileSettingName(*setting));
+            continue;
+        }
+        profile.values[static_cast<std::size_t>(*setting)] = *value;
+    }
+}
+
+TitleProfile LoadTitleProfile(u64 title_id) {
+    TitleProfile profile;
+    if (title_id == 0) {
+        return profile;
+    }
+    ParseTitleProfiles(builtin_profiles, title_id, profile);
+
+    const std::string path =
+        FileUtil::GetUserPath(FileUtil::UserPath::ConfigDir) + "title_profiles.txt";
+    std::string user_profiles;
+    if (FileUtil::Exists(path) && FileUtil::ReadFileToString(true, path, user_profiles) > 0) {
+        ParseTitleProfiles(user_profiles, title_id, profile);
+    }
+    return profile;
+}
+
+void ApplyTitleProfile(const TitleProfile& profile) {
+    for (std::size_t i = 0; i < NUM_PROFILE_SETTINGS; ++i) {
+        const auto setting = static_cast<ProfileSetting>(i);
+        switch (profile.values[i]) {
+        case ProfileValue::Unset:
+            break;
+        case ProfileValue::Off:
+        case ProfileValue::Auto:
+            ApplyProfileSetting(setting, false);
+            break;
+        case ProfileValue::On:
+            ApplyProfileSetting(setting, true);
+            break;
+        case ProfileValue::Interpreter:
+            ApplyProfileSetting(setting, !Settings::values.use_shader_jit);
+            break;
+        }
+    }
+}
+
+void ApplyProfileSetting(ProfileSetting setting, bool enable) {
+    switch (setting) {
+    case ProfileSetting::DisplayTransferHack:
+        Settings::values.display_transfer_hack = enable;
+        break;
+    case ProfileSetting::SkipSlowDraw:
+        Settings::values.skip_slow_draw = enable;
+        break;
+    case ProfileSetting::FMVHack:
+        Settings::SetFMVHack(enable && !Settings::values.core_downcount_hack);
+        break;
+    case ProfileSetting::StreamBufferHack:
+        Settings::values.stream_buffer_hack = enable;
+        break;
+    case ProfileSetting::DisableClipCoef:
+        Settings::values.disable_clip_coef = enable;
+        break;
+    case ProfileSetting::Y2RPerformHack:
+        Settings::values.y2r_perform_hack = enable;
+        break;
+    case ProfileSetting::Y2REventDelay:
+        Settings::values.y2r_event_delay = enable;
+        break;
+    case ProfileSetting::LinearFilter:
+        Settings::values.use_linear_filter = enable;
+        break;
+    case ProfileSetting::AccurateMul:
+        Settings::values.shaders_accurate_mul =
+            enable ? Settings::AccurateMul::FAST : Settings::AccurateMul::OFF;
+        break;
+    case ProfileSetting::New3DS:
+        Settings::values.is_new_3ds = enable;
+        break;
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,79 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include "common/common_types.h"
+
+namespace Core {
+
+/// Settings a title profile can set before the title boots
+enum class ProfileSetting : u32 {
+    DisplayTransferHack,
+    SkipSlowDraw,
+    FMVHack,
+    StreamBufferHack,
+    DisableClipCoef,
+    Y2RPerformHack,
+    Y2REventDelay,
+    LinearFilter,
+    AccurateMul,
+    New3DS,
+};
+
+constexpr std::size_t NUM_PROFILE_SETTINGS = 10;
+
+enum class ProfileValue : u8 {
+    /// The profile leaves the configured value
+    Unset,
+    Off,
+    On,
+    /// On when the shader JIT is disabled
+    Interpreter,
+    /// The HackTuner measures which of on and off runs faster
+    Auto,
+};
+
+/// Returns the name of the setting in the profile files
+const char* GetProfileSettingName(ProfileSetting setting);
+
+/// Returns true if the setting is read while the title runs, so that it can be tuned
+bool IsProfileSettingTunable(ProfileSetting setting);
+
+struct TitleProfile {
+    std::array<ProfileValue, NUM_PROFILE_SETTINGS> values{};
+
+    ProfileValue Get(ProfileSetting setting) const {
+        return values[static_cast<std::size_t>(setting)];
+    }
+
+    /// Returns true if a setting of the profile is left to the HackTuner
+    bool HasAutoSettings() const;
+};
+
+/**
+ * Merges the entries of a profile file that list the title into the profile, the later ones
+ * taking precedence. A file has entries of the form
+ *     [0004000000068B00, 0004000000061300]
+ *     # Tales of the Abyss
+ *     display_transfer_hack = on
+ * with the values off, on, interpreter and auto.
+ */
+void ParseTitleProfiles(const std::string& text, u64 title_id, TitleProfile& profile);
+
+/**
+ * Looks the title up in the built-in profile database, and then in title_profiles.txt of the
+ * config directory, which can add titles and override the built-in settings.
+ */
+TitleProfile LoadTitleProfile(u64 title_id);
+
+/// Sets the settings the profile has a value for, the auto ones are turned off
+void ApplyTitleProfile(const TitleProfile& profile);
+
+/// Sets a setting of the profile, the FMV hack only takes effect without the downcount hack
+void ApplyProfileSetting(ProfileSetting setting, bool enable);
+
+} // namespace Core
@@ -2,17 +2,88 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include "common/assert.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/tracer/recorder.h"
 
 namespace CiTrace {
 
-Recorder::Recorder(const InitialState& initial_state) : initial_state(initial_state) {}
+Recorder::Recorder(const InitialState& initial_state)
+    : initial_state(initial_state),
+      data_path(FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "citrace.tmp") {
+    FileUtil::CreateFullPath(data_path);
+    data_file = FileUtil::IOFile(data_path, "wb");
+    if (!data_file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Could not open temporary CiTrace file {}", data_path);
+        write_failed = true;
+    }
+    writer_thread = std::thread(&Recorder::WriterLoop, this);
+}
+
+Recorder::~Recorder() {
+    StopWriter();
+    data_file.Close();
+    FileUtil::Delete(data_path);
+}
+
+void Recorder::StopWriter() {
+    if (!writer_thread.joinable())
+        return;
+    {
+        std::lock_guard lock{pending_mutex};
+        stop_writer = true;
+    }
+    pending_cv.notify_one();
+    writer_thread.join();
+}
+
+void Recorder::WriterLoop() {
+    Common::SetCurrentThreadName("CiTraceWriter");
+    std::vector<u8> buffer;
+    std::unique_lock lock{pending_mutex};
+    while (true) {
+        pending_cv.wait(lock, [this] { return stop_writer || !pending_data.empty(); });
+        if (pending_data.empty())
+            return;
+
+        // The buffers are swapped, so the emulation thread keeps appending to a block of memory
+        // that has already grown to the size of a frame's worth of updates
+        buffer.swap(pending_data);
+        const bool failed = write_failed;
+        lock.unlock();
+        const bool written =
+            !failed && data_file.WriteBytes(buffer.data(), buffer.size()) == buffer.size();
+        buffer.clear();
+        lock.lock();
+        write_failed = !written;
+    }
+}
+
+u32 Recorder::QueueData(const u8* data, u32 size) {
+    const u32 offset = data_size;
+    data_size += size;
+    {
+        std::lock_guard lock{pending_mutex};
+        pending_data.insert(pending_data.end(), data, data + size);
+    }
+    pending_cv.notify_one();
+    return offset;
+}
 
 void Recorder::Finish(const std::string& filename) {
+    StopWriter();
+    data_file.Close();
+    if (write_failed) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: Failed to write memory contents");
+        return;
+    }
+
     // Setup CiTrace header
     CTHeader header;
     std::memcpy(header.magic, CTHeader::ExpectedMagicWord(), 4);
@@ -51,26 +122,15 @@ void Recorder::Finish(const std::string& filename) {
         initial.gs_program_binary + initial.gs_program_binary_size * sizeof(u32);
     initial.gs_float_uniforms =
         initial.gs_swizzle_data + initial.gs_swizzle_data_size * sizeof(u32);
-    header.stream_offset = initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
+    const u32 data_offset =
+        initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
+    header.stream_offset = data_offset + data_size;
 
-    // Iterate through stream elements, update relevant stream element data
+    // Memory contents follow the initial state
     for (auto& stream_element : stream) {
-        switch (stream_element.data.type) {
-        case MemoryLoad: {
-            auto& file_offset = memory_regions[stream_element.hash];
-            if (!stream_element.uses_existing_data) {
-                file_offset = header.stream_offset;
-            }
-            stream_element.data.memory_load.file_offset = file_offset;
-            break;
+        if (stream_element.type == MemoryLoad) {
+            stream_element.memory_load.file_offset += data_offset;
         }
-
-        default:
-            // Other commands don't use any extra data
-            DEBUG_ASSERT(stream_element.extra_data.size() == 0);
-            break;
-        }
-        header.stream_offset += static_cast<u32>(stream_element.extra_data.size());
     }
 
     try {
@@ -139,64 +199,68 @@ void Recorder::Finish(const std::string& filename) {
             file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
             throw "Failed to write geometry shader float uniforms";
 
-        // Iterate through stream elements, write "extra data"
-        for (const auto& stream_element : stream) {
-            if (stream_element.extra_data.size() == 0)
-                continue;
-
-            written =
-                file.WriteBytes(stream_element.extra_data.data(), stream_element.extra_data.size());
-            if (written != stream_element.extra_data.size())
-                throw "Failed to write extra data";
+        // Copy the memory contents over from the temporary file
+        FileUtil::IOFile data(data_path, "rb");
+        std::array<u8, 0x100000> buffer;
+        for (u32 copied = 0; copied < data_size;) {
+            const std::size_t length = std::min<std::size_t>(buffer.size(), data_size - copied);
+            if (data.ReadBytes(buffer.data(), length) != length)
+                throw "Failed to read memory contents";
+            if (file.WriteBytes(buffer.data(), length) != length)
+                throw "Failed to write memory contents";
+            copied += static_cast<u32>(length);
         }
 
         if (file.Tell() != header.stream_offset)
             throw "Unexpected end of extra data";
 
         // Write actual stream elements
-        for (const auto& stream_element : stream) {
-            if (1 != file.WriteObject(stream_element.data))
-                throw "Failed to write stream element";
-        }
+        written = file.WriteArray(stream.data(), stream.size());
+        if (written != stream.size())
+            throw "Failed to write stream element";
     } catch (const char* str) {
         LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
     }
 }
 
 void Recorder::FrameFinished() {
-    stream.push_back({{FrameMarker}});
+    stream.push_back({FrameMarker});
 }
 
 void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
-    StreamElement element = {{MemoryLoad}};
-    element.data.memory_load.size = size;
-    element.data.memory_load.physical_address = physical_address;
-
-    // Compute hash over given memory region to check if the contents are already stored internally
-    boost::crc_32_type result;
-    result.process_bytes(data, size);
-    element.hash = result.checksum();
-
-    element.uses_existing_data = (memory_regions.find(element.hash) != memory_regions.end());
-    if (!element.uses_existing_data) {
-        element.extra_data.resize(size);
-        memcpy(element.extra_data.data(), data, size);
-        memory_regions.insert({element.hash, 0}); // file offset will be initialized in Finish()
-    }
+    // Loads are split at block boundaries, so that a buffer which is only updated in places stores
+    // the blocks that changed instead of the whole buffer again
+    while (size > 0) {
+        const u32 block_size = std::min(size, BlockSize - physical_address % BlockSize);
+        const u64 hash = Common::ComputeHash64(data, block_size);
+
+        auto [it, inserted] = memory_regions.try_emplace(hash);
+        if (inserted || it->second.size != block_size) {
+            it->second = {QueueData(data, block_size), block_size};
+        }
 
-    stream.push_back(element);
+        CTStreamElement element{MemoryLoad};
+        element.memory_load.file_offset = it->second.offset;
+        element.memory_load.size = block_size;
+        element.memory_load.physical_address = physical_address;
+        stream.push_back(element);
+
+        data += block_size;
+        size -= block_size;
+        physical_address += block_size;
+    }
 }
 
 template <typename T>
 void Recorder::RegisterWritten(u32 physical_address, T value) {
-    StreamElement element = {{RegisterWrite}};
-    element.data.register_write.size =
+    CTStreamElement element{RegisterWrite};
+    element.register_write.size =
         (sizeof(T) == 1) ? CTRegisterWrite::SIZE_8
                          : (sizeof(T) == 2) ? CTRegisterWrite::SIZE_16
                                             : (sizeof(T) == 4) ? CTRegisterWrite::SIZE_32
                                                                : CTRegisterWrite::SIZE_64;
-    element.data.register_write.physical_address = physical_address;
-    element.data.register_write.value = value;
+    element.register_write.physical_address = physical_address;
+    element.register_write.value = value;
 
     stream.push_back(element);
 }
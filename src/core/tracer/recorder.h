@@ -4,11 +4,14 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
-#include <boost/crc.hpp>
 #include "common/common_types.h"
+#include "common/file_util.h"
 #include "core/tracer/citrace.h"
 
 namespace CiTrace {
@@ -33,6 +36,7 @@ public:
      * @param initial_state Initial recorder state
      */
     explicit Recorder(const InitialState& initial_state);
+    ~Recorder();
 
     /// Finish recording of this Citrace and save it using the given filename.
     void Finish(const std::string& filename);
@@ -55,33 +59,48 @@ public:
     void RegisterWritten(u32 physical_address, T value);
 
 private:
-    // Initial state of recording start
-    InitialState initial_state;
+    /// Memory contents are deduplicated in blocks of this size, aligned to their guest address
+    static constexpr u32 BlockSize = 0x1000;
 
-    // Command stream
-    struct StreamElement {
-        CTStreamElement data;
+    struct StoredBlock {
+        u32 offset; ///< Offset in the memory contents written so far
+        u32 size;
+    };
 
-        /**
-         * Extra data to store along "core" data.
-         * This is e.g. used for data used in MemoryUpdates.
-         */
-        std::vector<u8> extra_data;
+    /// Hands a copy of new memory contents to the writer thread, returns their offset
+    u32 QueueData(const u8* data, u32 size);
 
-        /// Optional CRC hash (e.g. for hashing memory regions)
-        boost::crc_32_type::value_type hash;
+    /// Writes the queued memory contents to the temporary file until the recording finishes
+    void WriterLoop();
 
-        /// If true, refer to data already written to the output file instead of extra_data
-        bool uses_existing_data;
-    };
+    /// Stops the writer thread once it wrote out everything queued before
+    void StopWriter();
 
-    std::vector<StreamElement> stream;
+    // Initial state of recording start
+    InitialState initial_state;
 
     /**
-     * Internal cache which maps hashes of memory contents to file offsets at which those memory
-     * contents are stored.
+     * Command stream. The file offsets of memory loads are relative to the start of the memory
+     * contents until Finish() knows where those end up in the trace.
      */
-    std::unordered_map<boost::crc_32_type::value_type /*hash*/, u32 /*file_offset*/> memory_regions;
+    std::vector<CTStreamElement> stream;
+
+    /// Maps hashes of memory blocks to where their contents are stored
+    std::unordered_map<u64, StoredBlock> memory_regions;
+
+    /// Size of the memory contents queued so far
+    u32 data_size = 0;
+
+    // Memory contents are streamed to a temporary file, so that recording neither stalls the
+    // emulation on disk writes nor keeps every texture and vertex buffer in memory
+    std::string data_path;
+    FileUtil::IOFile data_file;
+    std::vector<u8> pending_data;
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    bool stop_writer = false;
+    bool write_failed = false;
+    std::thread writer_thread;
 };
 
 } // namespace CiTrace
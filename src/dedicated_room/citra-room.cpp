@@ -30,6 +30,7 @@
 #include "core/announce_multiplayer_session.h"
 #include "core/core.h"
 #include "core/settings.h"
+#include "dedicated_room/room_metrics.h"
 #include "network/network.h"
 #include "network/room.h"
 #include "network/verify_user.h"
@@ -60,6 +61,7 @@ static void PrintHelp(const char* argv0) {
                  "--ban-list-file     The file for storing the room ban list\n"
                  "--log-file          The file for storing the room log\n"
                  "--enable-citra-mods Allow Citra Community Moderators to moderate on your room\n"
+                 "--metrics-port      The port serving Prometheus metrics under /metrics\n"
                  "-h, --help          Display this help and exit\n"
                  "-v, --version       Output version information and exit\n";
 }
@@ -185,6 +187,7 @@ int main(int argc, char** argv) {
     u64 preferred_game_id = 0;
     u32 port = Network::DefaultRoomPort;
     u32 max_members = 16;
+    u32 metrics_port = 0;
     bool enable_citra_mods = false;
 
     static struct option long_options[] = {
@@ -201,6 +204,7 @@ int main(int argc, char** argv) {
         {"ban-list-file", required_argument, 0, 'b'},
         {"log-file", required_argument, 0, 'l'},
         {"enable-citra-mods", no_argument, 0, 'e'},
+        {"metrics-port", required_argument, 0, 'M'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -249,6 +253,9 @@ int main(int argc, char** argv) {
             case 'e':
                 enable_citra_mods = true;
                 break;
+            case 'M':
+                metrics_port = strtoul(optarg, &endarg, 0);
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -284,6 +291,11 @@ int main(int argc, char** argv) {
         PrintHelp(argv[0]);
         return -1;
     }
+    if (metrics_port > 65535) {
+        std::cout << "metrics-port needs to be in the range 0 - 65535!\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
     if (ban_list_file.empty()) {
         std::cout << "Ban list file not set!\nThis should get set to load and save room ban "
                      "list.\nSet with --ban-list-file <file>\n\n";
@@ -346,6 +358,14 @@ int main(int argc, char** argv) {
             return -1;
         }
         std::cout << "Room is open. Close with Q+Enter...\n\n";
+        std::unique_ptr<RoomMetricsServer> metrics_server;
+        if (metrics_port != 0) {
+            metrics_server = std::make_unique<RoomMetricsServer>(room, room_name);
+            if (!metrics_server->Start("0.0.0.0", static_cast<u16>(metrics_port))) {
+                std::cout << "Could not serve metrics on port " << metrics_port << "\n\n";
+                metrics_server.reset();
+            }
+        }
         auto announce_session = std::make_unique<Core::AnnounceMultiplayerSession>();
         if (announce) {
             announce_session->Start();
@@ -362,6 +382,7 @@ int main(int argc, char** argv) {
             announce_session->Stop();
         }
         announce_session.reset();
+        metrics_server.reset();
         // Save the ban list
         if (!ban_list_file.empty()) {
             SaveBanList(room->GetBanList(), ban_list_file);
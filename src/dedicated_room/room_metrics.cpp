@@ -0,0 +1,110 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <httplib.h>
+#include <fmt/format.h>
+#include "dedicated_room/room_metrics.h"
+
+namespace {
+
+std::string EscapeLabel(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void AppendMetric(std::string& out, const char* name, const char* type, const char* help,
+                  const std::string& labels, double value) {
+    out += fmt::format("# HELP {0} {1}\n# TYPE {0} {2}\n{0}{{{3}}} {4}\n", name, help, type,
+                       labels, value);
+}
+
+} // Anonymous namespace
+
+std::string FormatRoomMetrics(const Network::Room::Statistics& statistics,
+                              const std::string& room_name) {
+    const std::string room_label = fmt::format("room=\"{}\"", EscapeLabel(room_name));
+    std::string out;
+    AppendMetric(out, "citra_room_packets_received_total", "counter",
+                 "Packets received from members and joining clients.", room_label,
+                 static_cast<double>(statistics.packets_received));
+    AppendMetric(out, "citra_room_received_bytes_total", "counter",
+                 "Bytes received from members and joining clients.", room_label,
+                 static_cast<double>(statistics.bytes_received));
+    AppendMetric(out, "citra_room_wifi_packets_relayed_total", "counter",
+                 "Wifi packets sent on to members, once per recipient.", room_label,
+                 static_cast<double>(statistics.wifi_packets_relayed));
+    AppendMetric(out, "citra_room_wifi_relayed_bytes_total", "counter",
+                 "Bytes of the wifi packets sent on to members.", room_label,
+                 static_cast<double>(statistics.wifi_bytes_relayed));
+    AppendMetric(out, "citra_room_joins_total", "counter", "Members that joined.", room_label,
+                 static_cast<double>(statistics.joins));
+    AppendMetric(out, "citra_room_join_latency_seconds_total", "counter",
+                 "Summed time from the join requests to the members joining.", room_label,
+                 statistics.join_latency_us / 1e6);
+    AppendMetric(out, "citra_room_pending_joins", "gauge",
+                 "Join requests whose token is being verified.", room_label,
+                 statistics.pending_joins);
+    AppendMetric(out, "citra_room_members", "gauge", "Members in the room.", room_label,
+                 static_cast<double>(statistics.peers.size()));
+    AppendMetric(out, "citra_room_loop_iterations_total", "counter",
+                 "Events the room thread handled.", room_label,
+                 static_cast<double>(statistics.loop_iterations));
+    AppendMetric(out, "citra_room_loop_busy_seconds_total", "counter",
+                 "Time the room thread spent handling events.", room_label,
+                 statistics.loop_busy_us / 1e6);
+    AppendMetric(out, "citra_room_loop_busy_max_seconds", "gauge",
+                 "Longest event the room thread handled in the last second.", room_label,
+                 statistics.loop_busy_max_us / 1e6);
+
+    // The samples of a metric have to follow its header without gaps
+    out += "# HELP citra_room_peer_round_trip_time_seconds Mean round trip time of a member.\n"
+           "# TYPE citra_room_peer_round_trip_time_seconds gauge\n";
+    for (const auto& peer : statistics.peers) {
+        out += fmt::format("citra_room_peer_round_trip_time_seconds{{{},nickname=\"{}\"}} {}\n",
+                           room_label, EscapeLabel(peer.nickname),
+                           peer.round_trip_time_ms / 1e3);
+    }
+    out += "# HELP citra_room_peer_packet_loss_ratio Fraction of the packets sent to a member "
+           "again.\n"
+           "# TYPE citra_room_peer_packet_loss_ratio gauge\n";
+    for (const auto& peer : statistics.peers) {
+        out += fmt::format("citra_room_peer_packet_loss_ratio{{{},nickname=\"{}\"}} {}\n",
+                           room_label, EscapeLabel(peer.nickname), peer.packet_loss);
+    }
+    return out;
+}
+
+RoomMetricsServer::RoomMetricsServer(std::shared_ptr<Network::Room> room, std::string room_name)
+    : room(std::move(room)), room_name(std::move(room_name)) {}
+
+RoomMetricsServer::~RoomMetricsServer() {
+    if (thread.joinable()) {
+        server->stop();
+        thread.join();
+    }
+}
+
+bool RoomMetricsServer::Start(const std::string& host, u16 port) {
+    server = std::make_unique<httplib::Server>();
+    server->Get("/metrics", [this](const httplib::Request&, httplib::Response& response) {
+        response.set_content(FormatRoomMetrics(room->GetStatistics(), room_name),
+                             "text/plain; version=0.0.4");
+    });
+    if (!server->bind_to_port(host.c_str(), port)) {
+        return false;
+    }
+    thread = std::thread([this] { server->listen_after_bind(); });
+    return true;
+}
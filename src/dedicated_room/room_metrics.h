@@ -0,0 +1,38 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <thread>
+#include "common/common_types.h"
+#include "network/room.h"
+
+namespace httplib {
+class Server;
+}
+
+/**
+ * Formats the statistics of a room in the Prometheus text exposition format.
+ * @param room_name Value of the room label of every sample
+ */
+std::string FormatRoomMetrics(const Network::Room::Statistics& statistics,
+                              const std::string& room_name);
+
+/// Serves the statistics of a room under /metrics over HTTP
+class RoomMetricsServer {
+public:
+    RoomMetricsServer(std::shared_ptr<Network::Room> room, std::string room_name);
+    ~RoomMetricsServer();
+
+    /// Starts listening on the port, returns false if it could not be bound
+    bool Start(const std::string& host, u16 port);
+
+private:
+    std::shared_ptr<Network::Room> room;
+    std::string room_name;
+    std::unique_ptr<httplib::Server> server;
+    std::thread thread;
+};
@@ -81,10 +81,12 @@ std::unique_ptr<Input::ButtonDevice> Keyboard::Create(const Common::ParamPackage
 
 void Keyboard::PressKey(int key_code) {
     key_button_list->ChangeKeyStatus(key_code, true);
+    Input::NotifyInputEvent();
 }
 
 void Keyboard::ReleaseKey(int key_code) {
     key_button_list->ChangeKeyStatus(key_code, false);
+    Input::NotifyInputEvent();
 }
 
 void Keyboard::ReleaseAllKeys() {
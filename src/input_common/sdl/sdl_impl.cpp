@@ -243,24 +243,28 @@ void SDLState::HandleGameControllerEvent(const SDL_Event& event) {
     case SDL_JOYBUTTONUP: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jbutton.which)) {
             joystick->SetButton(event.jbutton.button, false);
+            Input::NotifyInputEvent();
         }
         break;
     }
     case SDL_JOYBUTTONDOWN: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jbutton.which)) {
             joystick->SetButton(event.jbutton.button, true);
+            Input::NotifyInputEvent();
         }
         break;
     }
     case SDL_JOYHATMOTION: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jhat.which)) {
             joystick->SetHat(event.jhat.hat, event.jhat.value);
+            Input::NotifyInputEvent();
         }
         break;
     }
     case SDL_JOYAXISMOTION: {
         if (auto joystick = GetSDLJoystickBySDLID(event.jaxis.which)) {
             joystick->SetAxis(event.jaxis.axis, event.jaxis.value);
+            Input::NotifyInputEvent();
         }
         break;
     }
@@ -478,10 +482,11 @@ SDLState::SDLState() {
     initialized = true;
     if (start_thread) {
         poll_thread = std::thread([this] {
-            using namespace std::chrono_literals;
+            // Returns as soon as an event comes in, the event watcher has handled it by then. The
+            // timeout only bounds the wait, the destructor wakes the thread up with an event.
+            SDL_Event event;
             while (initialized) {
-                SDL_PumpEvents();
-                std::this_thread::sleep_for(10ms);
+                SDL_WaitEventTimeout(&event, 100);
             }
         });
     }
@@ -502,6 +507,9 @@ SDLState::~SDLState() {
 
     initialized = false;
     if (start_thread) {
+        SDL_Event event{};
+        event.type = SDL_USEREVENT;
+        SDL_PushEvent(&event);
         poll_thread.join();
         SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
     }
@@ -158,15 +158,18 @@ void Client::OnPadData(Response::PadData data) {
         return;
     }
     packet_sequence = data.packet_counter;
+
+    PadSample sample{};
+    sample.host_time_ns = GetSampleTimeNs();
+    sample.motion_time_us = data.motion_timestamp;
+
     // Due to differences between the 3ds and cemuhookudp motion directions, we need to invert
     // accel.x and accel.z and also invert pitch and yaw. See
     // https://github.com/citra-emu/citra/pull/4049 for more details on gyro/accel
-    Common::Vec3f accel = Common::MakeVec<float>(-data.accel.x, data.accel.y, -data.accel.z);
-    Common::Vec3f gyro = Common::MakeVec<float>(-data.gyro.pitch, -data.gyro.yaw, data.gyro.roll);
+    sample.accel = Common::MakeVec<float>(-data.accel.x, data.accel.y, -data.accel.z);
+    sample.gyro = Common::MakeVec<float>(-data.gyro.pitch, -data.gyro.yaw, data.gyro.roll);
     {
-        std::lock_guard guard(status->update_mutex);
-
-        status->motion_status = {accel, gyro};
+        std::lock_guard guard(status->calibration_mutex);
 
         // TODO: add a setting for "click" touch. Click touch refers to a device that differentiates
         // between a simple "tap" and a hard press that causes the touch screen to click.
@@ -187,8 +190,42 @@ void Client::OnPadData(Response::PadData data) {
                 static_cast<float>(max_y - min_y);
         }
 
-        status->touch_status = {x, y, is_active};
+        sample.touch_x = x;
+        sample.touch_y = y;
+        sample.touch_pressed = is_active;
     }
+
+    status->pad.Store({sample, latest_sample});
+    latest_sample = sample;
+}
+
+std::tuple<Common::Vec3<float>, Common::Vec3<float>> InterpolateMotion(const PadSamples& samples,
+                                                                       s64 time_ns) {
+    // Pads that send bursts of samples or stall for a while are not worth predicting
+    constexpr s64 MAX_SAMPLE_INTERVAL_NS = 50'000'000;
+
+    const PadSample& latest = samples.latest;
+    const PadSample& previous = samples.previous;
+    if (previous.host_time_ns == 0 || latest.motion_time_us <= previous.motion_time_us) {
+        return {latest.accel, latest.gyro};
+    }
+
+    // The spacing comes from the pad, the arrival times carry the jitter of the network
+    const s64 interval_ns = static_cast<s64>(latest.motion_time_us - previous.motion_time_us) * 1000;
+    if (interval_ns > MAX_SAMPLE_INTERVAL_NS) {
+        return {latest.accel, latest.gyro};
+    }
+
+    const s64 age_ns = std::clamp<s64>(time_ns - latest.host_time_ns, 0, interval_ns);
+    const float t = static_cast<float>(age_ns) / static_cast<float>(interval_ns);
+    return {latest.accel + (latest.accel - previous.accel) * t,
+            latest.gyro + (latest.gyro - previous.gyro) * t};
+}
+
+s64 GetSampleTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
 }
 
 void Client::StartCommunication(const std::string& host, u16 port, u8 pad_index, u32 client_id) {
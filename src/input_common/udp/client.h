@@ -12,6 +12,7 @@
 #include <thread>
 #include <tuple>
 #include "common/common_types.h"
+#include "common/seqlock.h"
 #include "common/thread.h"
 #include "common/vector_math.h"
 
@@ -28,10 +29,28 @@ struct PortInfo;
 struct Version;
 } // namespace Response
 
+/// The state of the pad in one pad data packet
+struct PadSample {
+    Common::Vec3<float> accel;
+    Common::Vec3<float> gyro;
+    float touch_x;
+    float touch_y;
+    bool touch_pressed;
+    /// Steady clock time the packet arrived at in nanoseconds
+    s64 host_time_ns;
+    /// Time the pad took the motion sample at in microseconds, counted by the pad
+    u64 motion_time_us;
+};
+
+/// The latest two samples, the motion between them is carried on to the time HID reads it
+struct PadSamples {
+    PadSample latest;
+    PadSample previous;
+};
+
 struct DeviceStatus {
-    std::mutex update_mutex;
-    std::tuple<Common::Vec3<float>, Common::Vec3<float>> motion_status;
-    std::tuple<float, float, bool> touch_status;
+    /// Written by the socket thread on every packet, read by HID without taking a lock
+    Common::SeqLock<PadSamples> pad;
 
     // calibration data for scaling the device's touch area to 3ds
     struct CalibrationData {
@@ -40,9 +59,20 @@ struct DeviceStatus {
         u16 max_x;
         u16 max_y;
     };
+    std::mutex calibration_mutex;
     std::optional<CalibrationData> touch_calibration;
 };
 
+/**
+ * Returns the motion of the pad at time_ns. The latest samples are extrapolated, at most by one
+ * packet interval, to make up for the time the sample spent waiting to be read.
+ */
+std::tuple<Common::Vec3<float>, Common::Vec3<float>> InterpolateMotion(const PadSamples& samples,
+                                                                       s64 time_ns);
+
+/// Returns the steady clock time in nanoseconds, which the samples are timestamped with
+s64 GetSampleTimeNs();
+
 class Client {
 public:
     explicit Client(std::shared_ptr<DeviceStatus> status, const std::string& host = DEFAULT_ADDR,
@@ -61,6 +91,7 @@ private:
     std::shared_ptr<DeviceStatus> status;
     std::thread thread;
     u64 packet_sequence = 0;
+    PadSample latest_sample{};
 };
 
 /// An async job allowing configuration of the touchpad calibration.
@@ -25,11 +25,14 @@ u64 ntohll(u64 x) {
 }
 #endif
 
+void Packet::Reserve(std::size_t size_in_bytes) {
+    data.reserve(size_in_bytes);
+}
+
 void Packet::Append(const void* in_data, std::size_t size_in_bytes) {
     if (in_data && (size_in_bytes > 0)) {
-        std::size_t start = data.size();
-        data.resize(start + size_in_bytes);
-        std::memcpy(&data[start], in_data, size_in_bytes);
+        const char* bytes = static_cast<const char*>(in_data);
+        data.insert(data.end(), bytes, bytes + size_in_bytes);
     }
 }
 
@@ -5,7 +5,9 @@
 #pragma once
 
 #include <array>
+#include <type_traits>
 #include <vector>
+#include <boost/container/small_vector.hpp>
 #include "common/common_types.h"
 
 namespace Network {
@@ -13,9 +15,18 @@ namespace Network {
 /// A class that serializes data for network transfer. It also handles endianess
 class Packet {
 public:
+    /// Packets up to this size, which covers the 802.11 frames of UDS, don't allocate
+    static constexpr std::size_t InlineCapacity = 0x640;
+
     Packet() = default;
     ~Packet() = default;
 
+    /**
+     * Reserves storage for the packet, so that appending does not grow it several times
+     * @param size_in_bytes Size the packet is expected to reach
+     */
+    void Reserve(std::size_t size_in_bytes);
+
     /**
      * Append data to the end of the packet
      * @param data        Pointer to the sequence of bytes to append
@@ -111,8 +122,12 @@ private:
      */
     bool CheckSize(std::size_t size);
 
+    /// Bytes, and values that are bytes, have no endianness and are copied all at once
+    template <typename T>
+    static constexpr bool IsByte = sizeof(T) == 1 && std::is_arithmetic_v<T>;
+
     // Member data
-    std::vector<char> data;   ///< Data stored in the packet
+    boost::container::small_vector<char, InlineCapacity> data; ///< Data stored in the packet
     std::size_t read_pos = 0; ///< Current reading position in the packet
     bool is_valid = true;     ///< Reading state of the packet
 };
@@ -122,9 +137,19 @@ Packet& Packet::operator>>(std::vector<T>& out_data) {
     // First extract the size
     u32 size = 0;
     *this >> size;
+    if constexpr (IsByte<T>) {
+        if (!CheckSize(size)) {
+            out_data.clear();
+            return *this;
+        }
+    }
     out_data.resize(size);
 
     // Then extract the data
+    if constexpr (IsByte<T>) {
+        Read(out_data.data(), size);
+        return *this;
+    }
     for (std::size_t i = 0; i < out_data.size(); ++i) {
         T character;
         *this >> character;
@@ -135,6 +160,10 @@ Packet& Packet::operator>>(std::vector<T>& out_data) {
 
 template <typename T, std::size_t S>
 Packet& Packet::operator>>(std::array<T, S>& out_data) {
+    if constexpr (IsByte<T>) {
+        Read(out_data.data(), S);
+        return *this;
+    }
     for (std::size_t i = 0; i < out_data.size(); ++i) {
         T character;
         *this >> character;
@@ -149,6 +178,10 @@ Packet& Packet::operator<<(const std::vector<T>& in_data) {
     *this << static_cast<u32>(in_data.size());
 
     // Then insert the data
+    if constexpr (IsByte<T>) {
+        Append(in_data.data(), in_data.size());
+        return *this;
+    }
     for (std::size_t i = 0; i < in_data.size(); ++i) {
         *this << in_data[i];
     }
@@ -157,6 +190,10 @@ Packet& Packet::operator<<(const std::vector<T>& in_data) {
 
 template <typename T, std::size_t S>
 Packet& Packet::operator<<(const std::array<T, S>& in_data) {
+    if constexpr (IsByte<T>) {
+        Append(in_data.data(), S);
+        return *this;
+    }
     for (std::size_t i = 0; i < in_data.size(); ++i) {
         *this << in_data[i];
     }
@@ -4,17 +4,24 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
 #include <iomanip>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <regex>
+#include <shared_mutex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include "common/logging/log.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
 #include "network/verify_user.h"
+#include "network/wifi_compression.h"
 
 namespace Network {
 
@@ -41,12 +48,29 @@ public:
         MacAddress mac_address;      ///< The assigned mac address of the member.
         /// Data of the user, often including authenticated forum username.
         VerifyUser::UserData user_data;
-        ENetPeer* peer; ///< The remote peer.
+        ENetPeer* peer;   ///< The remote peer.
+        u32 features = 0; ///< RoomFeatures the member supports.
     };
     using MemberList = std::vector<Member>;
-    MemberList members;              ///< Information about the members of this room
-    mutable std::mutex member_mutex; ///< Mutex for locking the members list
-    /// This should be a std::shared_mutex as soon as C++17 is supported
+    MemberList members;                     ///< Information about the members of this room
+    mutable std::shared_mutex member_mutex; ///< Mutex for locking the members list
+    struct MemberPeer {
+        ENetPeer* peer;
+        bool wifi_compression; ///< Whether compressed wifi packets are forwarded as they are
+    };
+    /// Peers of the members by MAC address, which wifi packets are forwarded with. Locked by
+    /// member_mutex along with the members list.
+    std::unordered_map<u64, MemberPeer> member_peers;
+
+    /// A join request whose token is verified on a worker thread
+    struct PendingJoin {
+        Member member;
+        std::string ip;
+        std::future<VerifyUser::UserData> user_data;
+        std::chrono::steady_clock::time_point requested;
+    };
+    /// Join requests which are not members yet, only used by the room thread
+    std::vector<PendingJoin> pending_joins;
 
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
@@ -61,6 +85,11 @@ public:
     /// Verification backend of the room
     std::unique_ptr<VerifyUser::Backend> verify_backend;
 
+    Statistics statistics;               ///< Counted by the room thread alone
+    Statistics published_statistics;     ///< Copy of statistics that GetStatistics returns
+    mutable std::mutex statistics_mutex; ///< Mutex for published_statistics
+    std::chrono::steady_clock::time_point last_publish;
+
     /// Thread function that will receive and dispatch messages until the room is destroyed.
     void ServerLoop();
     void StartLoop();
@@ -72,6 +101,22 @@ public:
      */
     void HandleJoinRequest(const ENetEvent* event);
 
+    /**
+     * Adds the members whose verification is done, or rejects them if they are banned.
+     */
+    void FinishJoinRequests();
+
+    /**
+     * Copies the statistics for GetStatistics, along with the ENet statistics of the members, if
+     * a second passed since the last time.
+     */
+    void PublishStatistics();
+
+    /**
+     * Returns the key of a MAC address in member_peers.
+     */
+    static u64 GetMacKey(const MacAddress& address);
+
     /**
      * Parses and answers a kick request from a client.
      * Validates the permissions and that the given user exists and then kicks the member.
@@ -98,6 +143,7 @@ public:
 
     /**
      * Returns whether the nickname is valid, ie. isn't already taken by someone else in the room.
+     * Members still being verified count as being in the room in this and the next two checks.
      */
     bool IsValidNickname(const std::string& nickname) const;
 
@@ -228,6 +274,12 @@ public:
      */
     void HandleWifiPacket(const ENetEvent* event);
 
+    /**
+     * Creates the IdWifiPacket of an IdCompressedWifiPacket, for the members that can not
+     * decompress it. Returns nullptr if the packet is corrupted.
+     */
+    static ENetPacket* DecompressWifiPacket(const ENetPacket* enet_packet);
+
     /**
      * Extracts a chat entry from a received ENet packet and adds it to the chat queue.
      * @param event The ENet event that was received.
@@ -252,8 +304,11 @@ void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
         ENetEvent event;
         if (enet_host_service(server, &event, 50) > 0) {
+            const auto busy_begin = std::chrono::steady_clock::now();
             switch (event.type) {
             case ENET_EVENT_TYPE_RECEIVE:
+                ++statistics.packets_received;
+                statistics.bytes_received += event.packet->dataLength;
                 switch (event.packet->data[0]) {
                 case IdJoinRequest:
                     HandleJoinRequest(&event);
@@ -262,6 +317,7 @@ void Room::RoomImpl::ServerLoop() {
                     HandleGameNamePacket(&event);
                     break;
                 case IdWifiPacket:
+                case IdCompressedWifiPacket:
                     HandleWifiPacket(&event);
                     break;
                 case IdChatMessage:
@@ -281,7 +337,10 @@ void Room::RoomImpl::ServerLoop() {
                     HandleModGetBanListPacket(&event);
                     break;
                 }
-                enet_packet_destroy(event.packet);
+                // Forwarded packets are freed by ENet once the last recipient got them
+                if (event.packet->referenceCount == 0) {
+                    enet_packet_destroy(event.packet);
+                }
                 break;
             case ENET_EVENT_TYPE_DISCONNECT:
                 HandleClientDisconnection(event.peer);
@@ -290,9 +349,18 @@ void Room::RoomImpl::ServerLoop() {
             case ENET_EVENT_TYPE_CONNECT:
                 break;
             }
+            const u64 busy_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::steady_clock::now() - busy_begin)
+                                    .count();
+            ++statistics.loop_iterations;
+            statistics.loop_busy_us += busy_us;
+            statistics.loop_busy_max_us = std::max(statistics.loop_busy_max_us, busy_us);
         }
+        FinishJoinRequests();
+        PublishStatistics();
     }
     // Close the connection to all members:
+    pending_joins.clear();
     SendCloseMessage();
 }
 
@@ -302,8 +370,8 @@ void Room::RoomImpl::StartLoop() {
 
 void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     {
-        std::lock_guard lock(member_mutex);
-        if (members.size() >= room_information.member_slots) {
+        std::shared_lock lock(member_mutex);
+        if (members.size() + pending_joins.size() >= room_information.member_slots) {
             SendRoomIsFull(event->peer);
             return;
         }
@@ -329,6 +397,12 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     std::string token;
     packet >> token;
 
+    // Older clients end the request here
+    u32 features = 0;
+    if (!packet.EndOfPacket()) {
+        packet >> features;
+    }
+
     if (pass != password) {
         SendWrongPassword(event->peer);
         return;
@@ -366,53 +440,114 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     member.console_id_hash = console_id_hash;
     member.nickname = nickname;
     member.peer = event->peer;
+    member.features = features;
 
     std::string uid;
     {
         std::lock_guard lock(verify_UID_mutex);
         uid = verify_UID;
     }
-    member.user_data = verify_backend->LoadUserData(uid, token);
 
-    std::string ip;
-    {
-        std::lock_guard lock(ban_list_mutex);
+    char ip_raw[256];
+    enet_address_get_host_ip(&event->peer->address, ip_raw, sizeof(ip_raw) - 1);
 
-        // Check username ban
-        if (!member.user_data.username.empty() &&
-            std::find(username_ban_list.begin(), username_ban_list.end(),
-                      member.user_data.username) != username_ban_list.end()) {
+    // Verifying a token can take a while, the room keeps forwarding packets meanwhile
+    auto user_data = std::async(std::launch::async, [this, uid, token] {
+        return verify_backend->LoadUserData(uid, token);
+    });
+    pending_joins.push_back(
+        {std::move(member), ip_raw, std::move(user_data), std::chrono::steady_clock::now()});
+}
 
-            SendUserBanned(event->peer);
-            return;
+void Room::RoomImpl::FinishJoinRequests() {
+    for (auto it = pending_joins.begin(); it != pending_joins.end();) {
+        if (it->user_data.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
         }
+        Member member = std::move(it->member);
+        member.user_data = it->user_data.get();
+        const std::string ip = std::move(it->ip);
+        const auto requested = it->requested;
+        it = pending_joins.erase(it);
+
+        {
+            std::lock_guard lock(ban_list_mutex);
+
+            // Check username ban
+            if (!member.user_data.username.empty() &&
+                std::find(username_ban_list.begin(), username_ban_list.end(),
+                          member.user_data.username) != username_ban_list.end()) {
+
+                SendUserBanned(member.peer);
+                continue;
+            }
 
-        // Check IP ban
-        char ip_raw[256];
-        enet_address_get_host_ip(&event->peer->address, ip_raw, sizeof(ip_raw) - 1);
-        ip = ip_raw;
+            // Check IP ban
+            if (std::find(ip_ban_list.begin(), ip_ban_list.end(), ip) != ip_ban_list.end()) {
+                SendUserBanned(member.peer);
+                continue;
+            }
+        }
 
-        if (std::find(ip_ban_list.begin(), ip_ban_list.end(), ip) != ip_ban_list.end()) {
-            SendUserBanned(event->peer);
-            return;
+        // Notify everyone that the user has joined.
+        SendStatusMessage(IdMemberJoin, member.nickname, member.user_data.username, ip);
+
+        ENetPeer* const peer = member.peer;
+        const MacAddress mac_address = member.mac_address;
+        {
+            std::lock_guard lock(member_mutex);
+            member_peers[GetMacKey(mac_address)] = {
+                peer, (member.features & FeatureWifiCompression) != 0};
+            members.push_back(std::move(member));
+        }
+
+        ++statistics.joins;
+        statistics.join_latency_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - requested)
+                                          .count();
+
+        // Notify everyone that the room information has changed.
+        BroadcastRoomInformation();
+        if (HasModPermission(peer)) {
+            SendJoinSuccessAsMod(peer, mac_address);
+        } else {
+            SendJoinSuccess(peer, mac_address);
         }
     }
+}
 
-    // Notify everyone that the user has joined.
-    SendStatusMessage(IdMemberJoin, member.nickname, member.user_data.username, ip);
+void Room::RoomImpl::PublishStatistics() {
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_publish < std::chrono::seconds(1)) {
+        return;
+    }
+    last_publish = now;
 
+    std::vector<Statistics::Peer> peers;
     {
-        std::lock_guard lock(member_mutex);
-        members.push_back(std::move(member));
+        std::shared_lock lock(member_mutex);
+        peers.reserve(members.size());
+        for (const auto& member : members) {
+            peers.push_back({member.nickname, member.peer->roundTripTime,
+                             static_cast<double>(member.peer->packetLoss) /
+                                 ENET_PEER_PACKET_LOSS_SCALE});
+        }
     }
 
-    // Notify everyone that the room information has changed.
-    BroadcastRoomInformation();
-    if (HasModPermission(event->peer)) {
-        SendJoinSuccessAsMod(event->peer, preferred_mac);
-    } else {
-        SendJoinSuccess(event->peer, preferred_mac);
+    std::lock_guard lock(statistics_mutex);
+    published_statistics = statistics;
+    published_statistics.pending_joins = static_cast<u32>(pending_joins.size());
+    published_statistics.peers = std::move(peers);
+    statistics.loop_busy_max_us = 0;
+}
+
+u64 Room::RoomImpl::GetMacKey(const MacAddress& address) {
+    u64 key = 0;
+    for (const u8 byte : address) {
+        key = (key << 8) | byte;
     }
+    return key;
 }
 
 void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
@@ -449,6 +584,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        member_peers.erase(GetMacKey(target_member->mac_address));
         members.erase(target_member);
     }
 
@@ -492,6 +628,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        member_peers.erase(GetMacKey(target_member->mac_address));
         members.erase(target_member);
     }
 
@@ -571,28 +708,40 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
     if (!std::regex_match(nickname, nickname_regex))
         return false;
 
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&nickname](const auto& member) { return member.nickname != nickname; });
+    const auto is_other = [&nickname](const auto& member) { return member.nickname != nickname; };
+    if (!std::all_of(pending_joins.begin(), pending_joins.end(),
+                     [&is_other](const auto& join) { return is_other(join.member); })) {
+        return false;
+    }
+    std::shared_lock lock(member_mutex);
+    return std::all_of(members.begin(), members.end(), is_other);
 }
 
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.mac_address != address; });
+    if (std::any_of(pending_joins.begin(), pending_joins.end(),
+                    [&address](const auto& join) { return join.member.mac_address == address; })) {
+        return false;
+    }
+    std::shared_lock lock(member_mutex);
+    return member_peers.count(GetMacKey(address)) == 0;
 }
 
 bool Room::RoomImpl::IsValidConsoleId(const std::string& console_id_hash) const {
     // A Console ID is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(), [&console_id_hash](const auto& member) {
+    const auto is_other = [&console_id_hash](const auto& member) {
         return member.console_id_hash != console_id_hash;
-    });
+    };
+    if (!std::all_of(pending_joins.begin(), pending_joins.end(),
+                     [&is_other](const auto& join) { return is_other(join.member); })) {
+        return false;
+    }
+    std::shared_lock lock(member_mutex);
+    return std::all_of(members.begin(), members.end(), is_other);
 }
 
 bool Room::RoomImpl::HasModPermission(const ENetPeer* client) const {
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     const auto sending_member =
         std::find_if(members.begin(), members.end(),
                      [client](const auto& member) { return member.peer == client; });
@@ -677,6 +826,7 @@ void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccess);
     packet << mac_address;
+    packet << static_cast<u32>(FeatureWifiCompression);
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
@@ -687,6 +837,7 @@ void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_addre
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccessAsMod);
     packet << mac_address;
+    packet << static_cast<u32>(FeatureWifiCompression);
     ENetPacket* enet_packet =
         enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
@@ -751,7 +902,7 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
 void Room::RoomImpl::SendCloseMessage() {
     Packet packet;
     packet << static_cast<u8>(IdCloseRoom);
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     if (!members.empty()) {
         ENetPacket* enet_packet =
             enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
@@ -772,7 +923,7 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
     packet << static_cast<u8>(type);
     packet << nickname;
     packet << username;
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     if (!members.empty()) {
         ENetPacket* enet_packet =
             enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
@@ -814,9 +965,9 @@ void Room::RoomImpl::BroadcastRoomInformation() {
     packet << room_information.preferred_game;
     packet << room_information.host_username;
 
-    packet << static_cast<u32>(members.size());
     {
-        std::lock_guard lock(member_mutex);
+        std::shared_lock lock(member_mutex);
+        packet << static_cast<u32>(members.size());
         for (const auto& member : members) {
             packet << member.nickname;
             packet << member.mac_address;
@@ -847,53 +998,93 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // Message type, WifiPacket Type, WifiPacket Channel and WifiPacket Transmitter Address
+    constexpr std::size_t destination_offset = 3 * sizeof(u8) + sizeof(MacAddress);
+    ENetPacket* const enet_packet = event->packet;
+    if (enet_packet->dataLength < destination_offset + sizeof(MacAddress)) {
+        LOG_ERROR(Network, "Received a truncated wifi packet");
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
-
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    std::memcpy(destination_address.data(), enet_packet->data + destination_offset,
+                sizeof(MacAddress));
+
+    // The received packet is forwarded as it is, every recipient shares its buffer
+    enet_packet->flags = ENET_PACKET_FLAG_RELIABLE;
+
+    // Members that do not support compression share a decompressed copy, made on first use
+    const bool compressed = enet_packet->data[0] == IdCompressedWifiPacket;
+    ENetPacket* decompressed_packet = nullptr;
+    bool decompression_failed = false;
+    const auto send_to = [&](ENetPeer* peer, bool wifi_compression) {
+        ENetPacket* packet = enet_packet;
+        if (compressed && !wifi_compression) {
+            if (decompressed_packet == nullptr && !decompression_failed) {
+                decompressed_packet = DecompressWifiPacket(enet_packet);
+                decompression_failed = decompressed_packet == nullptr;
+            }
+            packet = decompressed_packet;
+        }
+        if (packet != nullptr && enet_peer_send(peer, 0, packet) == 0) {
+            ++statistics.wifi_packets_relayed;
+            statistics.wifi_bytes_relayed += packet->dataLength;
+        }
+    };
 
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
+        std::shared_lock lock(member_mutex);
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+                send_to(member.peer, (member.features & FeatureWifiCompression) != 0);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        std::shared_lock lock(member_mutex);
+        const auto member = member_peers.find(GetMacKey(destination_address));
+        if (member != member_peers.end()) {
+            send_to(member->second.peer, member->second.wifi_compression);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
+    if (decompressed_packet != nullptr && decompressed_packet->referenceCount == 0) {
+        enet_packet_destroy(decompressed_packet);
+    }
     enet_host_flush(server);
 }
 
+ENetPacket* Room::RoomImpl::DecompressWifiPacket(const ENetPacket* enet_packet) {
+    // Message type, WifiPacket Type, WifiPacket Channel and both addresses
+    constexpr std::size_t header_size = 3 * sizeof(u8) + 2 * sizeof(MacAddress);
+    Packet in_packet;
+    in_packet.Append(enet_packet->data, enet_packet->dataLength);
+    in_packet.IgnoreBytes(header_size);
+    u32 size = 0;
+    std::vector<u8> compressed;
+    in_packet >> size;
+    in_packet >> compressed;
+    std::optional<std::vector<u8>> data;
+    if (in_packet) {
+        data = DecompressWifiData(compressed, size);
+    }
+    if (!data) {
+        LOG_ERROR(Network, "Received a corrupted compressed wifi packet");
+        return nullptr;
+    }
+
+    Packet out_packet;
+    out_packet.Reserve(header_size + sizeof(u32) + data->size());
+    out_packet << static_cast<u8>(IdWifiPacket);
+    out_packet.Append(enet_packet->data + sizeof(u8), header_size - sizeof(u8));
+    out_packet << *data;
+    return enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
+                              ENET_PACKET_FLAG_RELIABLE);
+}
+
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
     Packet in_packet;
     in_packet.Append(event->packet->data, event->packet->dataLength);
@@ -905,7 +1096,7 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
         return member.peer == event->peer;
     };
 
-    std::lock_guard lock(member_mutex);
+    std::shared_lock lock(member_mutex);
     const auto sending_member = std::find_if(members.begin(), members.end(), CompareNetworkAddress);
     if (sending_member == members.end()) {
         return; // Received a chat message from a unknown sender
@@ -978,6 +1169,13 @@ void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
 }
 
 void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
+    // A client leaving before its verification is done is forgotten
+    pending_joins.erase(std::remove_if(pending_joins.begin(), pending_joins.end(),
+                                       [client](const auto& join) {
+                                           return join.member.peer == client;
+                                       }),
+                        pending_joins.end());
+
     // Remove the client from the members list.
     std::string nickname, username, ip;
     {
@@ -993,6 +1191,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
+            member_peers.erase(GetMacKey(member->mac_address));
             members.erase(member);
         }
     }
@@ -1029,6 +1228,11 @@ bool Room::Create(const std::string& name, const std::string& description,
         return false;
     }
     room_impl->state = State::Open;
+    room_impl->statistics = {};
+    {
+        std::lock_guard lock(room_impl->statistics_mutex);
+        room_impl->published_statistics = {};
+    }
 
     if (!verify_backend) {
         verify_backend = std::make_unique<Network::VerifyUser::NullBackend>();
@@ -1064,6 +1268,11 @@ std::string Room::GetVerifyUID() const {
     return room_impl->verify_UID;
 }
 
+Room::Statistics Room::GetStatistics() const {
+    std::lock_guard lock(room_impl->statistics_mutex);
+    return room_impl->published_statistics;
+}
+
 Room::BanList Room::GetBanList() const {
     std::lock_guard lock(room_impl->ban_list_mutex);
     return {room_impl->username_ban_list, room_impl->ip_ban_list};
@@ -1071,7 +1280,7 @@ Room::BanList Room::GetBanList() const {
 
 std::vector<Room::Member> Room::GetRoomMemberList() const {
     std::vector<Room::Member> member_list;
-    std::lock_guard lock(room_impl->member_mutex);
+    std::shared_lock lock(room_impl->member_mutex);
     for (const auto& member_impl : room_impl->members) {
         Member member;
         member.nickname = member_impl.nickname;
@@ -1107,6 +1316,7 @@ void Room::Destroy() {
     {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->member_peers.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
@@ -76,6 +76,14 @@ enum RoomMessageTypes : u8 {
     IdModPermissionDenied,
     IdModNoSuchUser,
     IdJoinSuccessAsMod,
+    /// A wifi packet whose data is compressed, only sent to peers that support it
+    IdCompressedWifiPacket,
+};
+
+/// Optional features, the join request carries those of the member and the join success those of
+/// the room. Older versions do not send them and skip them when they receive them.
+enum RoomFeatures : u32 {
+    FeatureWifiCompression = 1 << 0, ///< Understands IdCompressedWifiPacket
 };
 
 /// Types of system status messages
@@ -104,6 +112,28 @@ public:
         MacAddress mac_address;   ///< The assigned mac address of the member.
     };
 
+    /// Load of the room, the room thread refreshes it about once a second
+    struct Statistics {
+        u64 packets_received = 0; ///< Packets received from members and joining clients
+        u64 bytes_received = 0;
+        u64 wifi_packets_relayed = 0; ///< Wifi packets sent on, once per recipient
+        u64 wifi_bytes_relayed = 0;
+        u64 joins = 0;
+        u64 join_latency_us = 0; ///< Summed time from the join requests to the members joining
+        u64 loop_iterations = 0;
+        /// Summed time the room thread spent on the received events instead of waiting for them
+        u64 loop_busy_us = 0;
+        u64 loop_busy_max_us = 0; ///< Longest iteration since the previous refresh
+        u32 pending_joins = 0;    ///< Join requests whose token is being verified
+
+        struct Peer {
+            std::string nickname;
+            u32 round_trip_time_ms; ///< Mean round trip time ENet measured
+            double packet_loss;     ///< Fraction of the packets ENet had to send again
+        };
+        std::vector<Peer> peers;
+    };
+
     Room();
     ~Room();
 
@@ -132,6 +162,11 @@ public:
      */
     bool HasPassword() const;
 
+    /**
+     * Gets the load statistics of the room.
+     */
+    Statistics GetStatistics() const;
+
     using UsernameBanList = std::vector<std::string>;
     using IPBanList = std::vector<std::string>;
 
@@ -5,12 +5,14 @@
 #include <atomic>
 #include <list>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <thread>
 #include "common/assert.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room_member.h"
+#include "network/wifi_compression.h"
 
 namespace Network {
 
@@ -40,6 +42,8 @@ public:
     mutable std::mutex username_mutex; ///< Mutex for locking username.
 
     MacAddress mac_address; ///< The mac_address of this member.
+    /// RoomFeatures of the room we joined, written by the loop thread.
+    std::atomic<u32> room_features{0};
 
     std::mutex network_mutex; ///< Mutex that controls access to the `client` variable.
     /// Thread that receives and dispatches network packets
@@ -164,6 +168,7 @@ void RoomMember::RoomMemberImpl::MemberLoop() {
             case ENET_EVENT_TYPE_RECEIVE:
                 switch (event.packet->data[0]) {
                 case IdWifiPacket:
+                case IdCompressedWifiPacket:
                     HandleWifiPackets(&event);
                     break;
                 case IdChatMessage:
@@ -289,6 +294,8 @@ void RoomMember::RoomMemberImpl::SendJoinRequest(const std::string& nickname,
     packet << network_version;
     packet << password;
     packet << token;
+    packet << static_cast<u32>(FeatureWifiCompression);
+    room_features = 0;
     Send(std::move(packet));
 }
 
@@ -345,6 +352,13 @@ void RoomMember::RoomMemberImpl::HandleJoinPacket(const ENetEvent* event) {
 
     // Parse the MAC Address from the packet
     packet >> mac_address;
+
+    // Older rooms end the packet here
+    u32 features = 0;
+    if (!packet.EndOfPacket()) {
+        packet >> features;
+    }
+    room_features = features;
 }
 
 void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
@@ -364,7 +378,23 @@ void RoomMember::RoomMemberImpl::HandleWifiPackets(const ENetEvent* event) {
     packet >> wifi_packet.channel;
     packet >> wifi_packet.transmitter_address;
     packet >> wifi_packet.destination_address;
-    packet >> wifi_packet.data;
+    if (event->packet->data[0] == IdCompressedWifiPacket) {
+        u32 size = 0;
+        std::vector<u8> compressed;
+        packet >> size;
+        packet >> compressed;
+        std::optional<std::vector<u8>> data;
+        if (packet) {
+            data = DecompressWifiData(compressed, size);
+        }
+        if (!data) {
+            LOG_ERROR(Network, "Received a corrupted compressed wifi packet");
+            return;
+        }
+        wifi_packet.data = std::move(*data);
+    } else {
+        packet >> wifi_packet.data;
+    }
 
     Invoke<WifiPacket>(wifi_packet);
 }
@@ -585,13 +615,26 @@ bool RoomMember::IsConnected() const {
 }
 
 void RoomMember::SendWifiPacket(const WifiPacket& wifi_packet) {
+    std::optional<std::vector<u8>> compressed;
+    if (room_member_impl->room_features & FeatureWifiCompression) {
+        compressed = CompressWifiData(wifi_packet.data);
+    }
+
     Packet packet;
-    packet << static_cast<u8>(IdWifiPacket);
+    // The message id, the frame type, the channel, both addresses, the sizes and the data
+    packet.Reserve(3 * sizeof(u8) + 2 * sizeof(MacAddress) + 2 * sizeof(u32) +
+                   wifi_packet.data.size());
+    packet << static_cast<u8>(compressed ? IdCompressedWifiPacket : IdWifiPacket);
     packet << static_cast<u8>(wifi_packet.type);
     packet << wifi_packet.channel;
     packet << wifi_packet.transmitter_address;
     packet << wifi_packet.destination_address;
-    packet << wifi_packet.data;
+    if (compressed) {
+        packet << static_cast<u32>(wifi_packet.data.size());
+        packet << *compressed;
+    } else {
+        packet << wifi_packet.data;
+    }
     room_member_impl->Send(std::move(packet));
 }
 
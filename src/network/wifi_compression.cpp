@@ -0,0 +1,51 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <minilzo.h>
+#include "network/wifi_compression.h"
+
+namespace Network {
+
+static bool InitLZO() {
+    static const bool initialized = lzo_init() == LZO_E_OK;
+    return initialized;
+}
+
+std::optional<std::vector<u8>> CompressWifiData(const std::vector<u8>& data) {
+    if (data.size() < MinCompressedWifiFrameSize || data.size() > MaxWifiFrameSize || !InitLZO()) {
+        return std::nullopt;
+    }
+
+    // The frames come from the emulation thread and the room thread, each keeps its work memory
+    thread_local std::vector<lzo_align_t> work_memory(
+        (LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+    std::vector<u8> compressed(data.size() + data.size() / 16 + 64 + 3);
+    lzo_uint compressed_size = 0;
+    if (lzo1x_1_compress(data.data(), data.size(), compressed.data(), &compressed_size,
+                         work_memory.data()) != LZO_E_OK) {
+        return std::nullopt;
+    }
+    // Data that barely shrinks is not worth decompressing on the other side
+    if (compressed_size + compressed_size / 8 >= data.size()) {
+        return std::nullopt;
+    }
+    compressed.resize(compressed_size);
+    return compressed;
+}
+
+std::optional<std::vector<u8>> DecompressWifiData(const std::vector<u8>& compressed, u32 size) {
+    if (size > MaxWifiFrameSize || !InitLZO()) {
+        return std::nullopt;
+    }
+    std::vector<u8> data(size);
+    lzo_uint data_size = data.size();
+    if (lzo1x_decompress_safe(compressed.data(), compressed.size(), data.data(), &data_size,
+                              nullptr) != LZO_E_OK ||
+        data_size != data.size()) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+} // namespace Network
@@ -0,0 +1,32 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Network {
+
+/// Frames smaller than this are sent as they are, their headers would eat up most of the savings
+constexpr std::size_t MinCompressedWifiFrameSize = 64;
+/// Bounds what a corrupted or malicious size makes the decompression allocate
+constexpr u32 MaxWifiFrameSize = 0x10000;
+
+/**
+ * Compresses the data of a wifi frame with LZO1X-1.
+ * @returns the compressed data, or nothing if the data is too small or does not compress well
+ */
+std::optional<std::vector<u8>> CompressWifiData(const std::vector<u8>& data);
+
+/**
+ * Decompresses the data of a wifi frame.
+ * @param size the size of the data before it was compressed
+ * @returns the data, or nothing if the compressed data is corrupted
+ */
+std::optional<std::vector<u8>> DecompressWifiData(const std::vector<u8>& compressed, u32 size);
+
+} // namespace Network
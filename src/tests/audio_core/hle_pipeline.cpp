@@ -0,0 +1,257 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/mixers.h"
+#include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "core/memory.h"
+
+namespace AudioCore::HLE {
+
+namespace {
+
+using Configuration = SourceConfiguration::Configuration;
+
+/// Bytes of FCRAM given to the buffer of each source
+constexpr u32 BUFFER_STRIDE = 0x2000;
+/// 512 ADPCM frames of 8 bytes, each holding 14 samples
+constexpr u32 ADPCM_SAMPLES = 512 * 14;
+constexpr u32 PCM16_SAMPLES = 0x800;
+
+/**
+ * The frame of DspHle::Impl, on the sources and the mixers of a single shared memory region. The
+ * frames of DspHle are driven by the core timing events of the system, so the pipeline is run
+ * here without them.
+ */
+class DspPipeline {
+public:
+    explicit DspPipeline(Memory::MemorySystem& memory)
+        : shared_memory(std::make_unique<SharedMemory>()) {
+        sources.reserve(num_sources);
+        for (std::size_t i = 0; i < num_sources; ++i) {
+            sources.emplace_back(i);
+            sources[i].SetMemory(memory);
+        }
+    }
+
+    SharedMemory& GetSharedMemory() {
+        return *shared_memory;
+    }
+
+    const StereoFrame16& GenerateFrame() {
+        for (std::size_t i = 0; i < num_sources; ++i) {
+            sources[i].Configure(shared_memory->source_configurations.config[i],
+                                 shared_memory->adpcm_coefficients.coeff[i]);
+        }
+        mixers.Configure(shared_memory->dsp_configuration);
+
+        for (std::size_t i = 0; i < num_sources; ++i) {
+            shared_memory->source_statuses.status[i] = sources[i].Generate();
+        }
+        return MixFrame();
+    }
+
+    /// Mixes the last generated frame of the sources again, down to the output
+    const StereoFrame16& MixFrame() {
+        std::array<QuadFrame32, 3> intermediate_mixes = {};
+        for (std::size_t i = 0; i < num_sources; ++i) {
+            for (std::size_t mix = 0; mix < 3; ++mix) {
+                sources[i].MixInto(intermediate_mixes[mix], mix);
+            }
+        }
+        mixers.Generate(shared_memory->intermediate_mix_samples, write_mix_samples,
+                        intermediate_mixes);
+        return mixers.GetOutput();
+    }
+
+private:
+    std::unique_ptr<SharedMemory> shared_memory;
+    IntermediateMixSamples write_mix_samples{};
+    std::vector<Source> sources;
+    Mixers mixers;
+};
+
+/**
+ * Writes looping buffers of noise to FCRAM and enables every source on them, the even sources
+ * playing ADPCM and the odd ones PCM16, through both filters. The rates and the gains are powers
+ * of two or their sums, so that the output of the integer interpolations does not depend on how
+ * the host rounds.
+ */
+void ConfigureSources(Memory::MemorySystem& memory, SharedMemory& shared_memory,
+                      Configuration::InterpolationMode interpolation_mode) {
+    constexpr std::array<float, 4> rates = {1.0f, 0.5f, 2.0f, 0.75f};
+    constexpr std::array<float, 4> gains = {0.0625f, 0.03125f, 0.015625f, 0.0078125f};
+
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    u32 seed = 1;
+    for (u32 i = 0; i < num_sources; ++i) {
+        const bool adpcm = i % 2 == 0;
+        const bool stereo = !adpcm && i % 4 == 1;
+        u8* const data = fcram + i * BUFFER_STRIDE;
+        for (u32 offset = 0; offset < BUFFER_STRIDE; ++offset) {
+            seed = seed * 1103515245 + 12345;
+            data[offset] = static_cast<u8>(seed >> 16);
+        }
+
+        Configuration& config = shared_memory.source_configurations.config[i];
+        config.enable = 1;
+        config.enable_dirty.Assign(1);
+        config.rate_multiplier = rates[i % rates.size()];
+        config.rate_multiplier_dirty.Assign(1);
+        config.interpolation_mode = interpolation_mode;
+        config.interpolation_dirty.Assign(1);
+        for (std::size_t mix = 0; mix < 2; ++mix) {
+            for (std::size_t channel = 0; channel < 4; ++channel) {
+                config.gain[mix][channel] = gains[(i + mix + channel) % gains.size()];
+            }
+        }
+        config.gain_0_dirty.Assign(1);
+        config.gain_1_dirty.Assign(1);
+
+        config.simple_filter.b0 = 0x6000;
+        config.simple_filter.a1 = 0x2000;
+        config.biquad_filter.b0 = 0x1000;
+        config.biquad_filter.b1 = 0x2000;
+        config.biquad_filter.b2 = 0x1000;
+        config.biquad_filter.a1 = 0x1800;
+        config.biquad_filter.a2 = -0x0800;
+        config.simple_filter_enabled.Assign(1);
+        config.biquad_filter_enabled.Assign(i % 3 != 0);
+        config.filters_enabled_dirty.Assign(1);
+        config.simple_filter_dirty.Assign(1);
+        config.biquad_filter_dirty.Assign(1);
+
+        config.format.Assign(adpcm ? Configuration::Format::ADPCM : Configuration::Format::PCM16);
+        config.mono_or_stereo.Assign(stereo ? Configuration::MonoOrStereo::Stereo
+                                            : Configuration::MonoOrStereo::Mono);
+        config.physical_address = Memory::FCRAM_PADDR + i * BUFFER_STRIDE;
+        config.length = adpcm ? ADPCM_SAMPLES : (stereo ? PCM16_SAMPLES : 2 * PCM16_SAMPLES);
+        config.buffer_id = 1;
+        config.is_looping.Assign(1);
+        config.embedded_buffer_dirty.Assign(1);
+
+        if (adpcm) {
+            // The predictor of a frame header indexes one of the 8 coefficient pairs
+            for (u32 offset = 0; offset < ADPCM_SAMPLES / 14 * 8; offset += 8) {
+                data[offset] = static_cast<u8>((data[offset] & 0x70) | (data[offset] % 12));
+            }
+            config.adpcm_ps = data[0];
+            config.adpcm_yn[0] = 0;
+            config.adpcm_yn[1] = 0;
+            config.adpcm_dirty.Assign(1);
+            for (std::size_t pair = 0; pair < 8; ++pair) {
+                shared_memory.adpcm_coefficients.coeff[i][pair * 2] =
+                    static_cast<s16>(0x200 * pair);
+                shared_memory.adpcm_coefficients.coeff[i][pair * 2 + 1] =
+                    static_cast<s16>(-0x80 * static_cast<s16>(pair));
+            }
+            config.adpcm_coefficients_dirty.Assign(1);
+        }
+    }
+
+    DspConfiguration& dsp_config = shared_memory.dsp_configuration;
+    dsp_config.volume[0] = 1.0f;
+    dsp_config.volume[1] = 0.5f;
+    dsp_config.volume[2] = 0.0f;
+    dsp_config.output_format = DspConfiguration::OutputFormat::Stereo;
+    dsp_config.volume_0_dirty.Assign(1);
+    dsp_config.volume_1_dirty.Assign(1);
+    dsp_config.volume_2_dirty.Assign(1);
+    dsp_config.output_format_dirty.Assign(1);
+}
+
+/// FNV-1a, which unlike Common::ComputeHash64 is the same on every host
+u64 HashFrame(u64 hash, const StereoFrame16& frame) {
+    for (const auto& sample : frame) {
+        for (const s16 channel : sample) {
+            hash = (hash ^ static_cast<u16>(channel)) * 0x100000001B3;
+        }
+    }
+    return hash;
+}
+
+u64 HashFrames(Configuration::InterpolationMode interpolation_mode, u32 num_frames) {
+    Memory::MemorySystem memory;
+    DspPipeline pipeline(memory);
+    ConfigureSources(memory, pipeline.GetSharedMemory(), interpolation_mode);
+
+    u64 hash = 0xCBF29CE484222325;
+    for (u32 frame = 0; frame < num_frames; ++frame) {
+        hash = HashFrame(hash, pipeline.GenerateFrame());
+    }
+    return hash;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DSP HLE pipeline: Output is deterministic", "[audio_core]") {
+    using InterpolationMode = Configuration::InterpolationMode;
+
+    // The integer interpolations give the same frames on every host
+    REQUIRE(HashFrames(InterpolationMode::None, 1024) == 0x832CE74DA894C233);
+    REQUIRE(HashFrames(InterpolationMode::Linear, 1024) == 0xE0B8ACC08C47C5DA);
+
+    // The polyphase one is in floating point, and only has to agree with itself
+    REQUIRE(HashFrames(InterpolationMode::Polyphase, 1024) ==
+            HashFrames(InterpolationMode::Polyphase, 1024));
+}
+
+TEST_CASE("DSP HLE pipeline: Benchmark", "[.][benchmark][audio_core]") {
+    constexpr u32 num_frames = 8192;
+    /// A frame of 160 samples at the 32728 Hz of the DSP
+    constexpr double frame_us = 160 * 1e6 / 32728;
+
+    Memory::MemorySystem memory;
+    DspPipeline pipeline(memory);
+    ConfigureSources(memory, pipeline.GetSharedMemory(),
+                     Configuration::InterpolationMode::Polyphase);
+
+    double slowest_us = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 frame = 0; frame < num_frames; ++frame) {
+        const auto frame_start = std::chrono::steady_clock::now();
+        pipeline.GenerateFrame();
+        const std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - frame_start;
+        slowest_us = std::max(slowest_us, elapsed.count());
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const double average_us = elapsed.count() / num_frames;
+    WARN("DSP HLE, " << num_sources << " sources: " << average_us << " us per frame, slowest "
+                     << slowest_us << " us, " << average_us / frame_us * 100
+                     << "% of the frame time");
+}
+
+TEST_CASE("DSP HLE mixing: Benchmark", "[.][benchmark][audio_core]") {
+    constexpr u32 num_frames = 64 * 1024;
+
+    Memory::MemorySystem memory;
+    DspPipeline pipeline(memory);
+    // The sources feed the first two intermediate mixes, and the third one is muted
+    ConfigureSources(memory, pipeline.GetSharedMemory(), Configuration::InterpolationMode::Linear);
+    pipeline.GenerateFrame();
+
+    u64 hash = 0xCBF29CE484222325;
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 frame = 0; frame < num_frames; ++frame) {
+        hash = HashFrame(hash, pipeline.MixFrame());
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    REQUIRE(hash != 0);
+    WARN("DSP HLE mixing, " << num_sources
+                            << " sources: " << elapsed.count() / num_frames << " us per frame");
+}
+
+} // namespace AudioCore::HLE
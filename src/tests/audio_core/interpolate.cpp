@@ -0,0 +1,201 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore::AudioInterp {
+
+namespace {
+
+using Interpolator = void (*)(State&, StereoBuffer16&, float, StereoFrame16&, std::size_t&);
+
+/// Rates of the sources of a game: upsampling, the DSP rate, decimation, and an odd step
+constexpr std::array<float, 5> rates{0.5f, 1.0f, 1.37f, 2.0f, 3.9f};
+
+std::vector<std::array<s16, 2>> MakeSamples(std::size_t count) {
+    std::mt19937 rng(0xC17A);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<std::array<s16, 2>> samples(count);
+    for (auto& sample : samples) {
+        sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+    }
+    return samples;
+}
+
+/// The quadratic interpolation as it was written sample by sample, to check the block one against
+void ReferenceQuadratic(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+                        std::size_t& outputi) {
+    constexpr u64 scale_factor = 1 << 24;
+    if (input.empty())
+        return;
+
+    input.insert(input.begin(), {state.xn2, state.xn1});
+
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+    while (outputi < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+        if (inputi + 2 >= input.size()) {
+            inputi = input.size() - 2;
+            break;
+        }
+
+        const float t = static_cast<float>(fposition & (scale_factor - 1)) / scale_factor;
+        for (std::size_t i = 0; i < 2; i++) {
+            const float x0 = input[inputi][i];
+            const float x1 = input[inputi + 1][i];
+            const float x2 = input[inputi + 2][i];
+            const float value = x0 + t * (x1 - x0) + t * (t - 1) / 2 * (x2 - 2 * x1 + x0);
+            output[outputi][i] = static_cast<s16>(std::clamp(value, -32768.0f, 32767.0f));
+        }
+        outputi++;
+        fposition += step_size;
+    }
+
+    state.xn2 = input[inputi];
+    state.xn1 = input[inputi + 1];
+    state.fposition = fposition - inputi * scale_factor;
+    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+}
+
+/// Resamples the samples into whole frames, feeding the input in buffers of buffer_size
+std::vector<StereoFrame16> Resample(Interpolator interpolate, float rate,
+                                    const std::vector<std::array<s16, 2>>& samples,
+                                    std::size_t buffer_size) {
+    std::vector<StereoFrame16> frames;
+    State state;
+    StereoBuffer16 buffer;
+    StereoFrame16 frame{};
+    std::size_t outputi = 0;
+    for (std::size_t start = 0; start < samples.size(); start += buffer_size) {
+        const auto end = samples.begin() + std::min(start + buffer_size, samples.size());
+        buffer.insert(buffer.end(), samples.begin() + start, end);
+        while (!buffer.empty()) {
+            interpolate(state, buffer, rate, frame, outputi);
+            if (outputi == frame.size()) {
+                frames.push_back(frame);
+                outputi = 0;
+            } else {
+                break;
+            }
+        }
+    }
+    return frames;
+}
+
+/// Each output agrees with the same polynomial rounded without the float contraction of a compiler
+void RequireClose(const std::vector<StereoFrame16>& a, const std::vector<StereoFrame16>& b) {
+    REQUIRE(a.size() == b.size());
+    for (std::size_t frame = 0; frame < a.size(); ++frame) {
+        for (std::size_t i = 0; i < a[frame].size(); ++i) {
+            for (std::size_t channel = 0; channel < 2; ++channel) {
+                REQUIRE(std::abs(a[frame][i][channel] - b[frame][i][channel]) <= 1);
+            }
+        }
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AudioInterp::Quadratic matches the sample by sample polynomial", "[audio_core]") {
+    const auto samples = MakeSamples(16 * 1024);
+    for (const float rate : rates) {
+        RequireClose(Resample(Quadratic, rate, samples, 0x800),
+                     Resample(ReferenceQuadratic, rate, samples, 0x800));
+    }
+}
+
+TEST_CASE("AudioInterp::Quadratic carries its state across buffers", "[audio_core]") {
+    const auto samples = MakeSamples(16 * 1024);
+    for (const float rate : rates) {
+        // Buffers that end in the middle of a frame, and of the block of a frame
+        REQUIRE(Resample(Quadratic, rate, samples, 0x800) ==
+                Resample(Quadratic, rate, samples, 97));
+    }
+}
+
+TEST_CASE("AudioInterp::Quadratic reproduces a quadratic exactly", "[audio_core]") {
+    std::vector<std::array<s16, 2>> samples(256);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const s16 value = static_cast<s16>(static_cast<int>(i * (i - 1) / 2) - 16384);
+        samples[i] = {value, static_cast<s16>(-value)};
+    }
+
+    // At the DSP rate each output is an input sample, after the two-sample predelay
+    const auto frames = Resample(Quadratic, 1.0f, samples, samples.size());
+    REQUIRE(!frames.empty());
+    for (std::size_t frame = 0; frame < frames.size(); ++frame) {
+        for (std::size_t i = 0; i < frames[frame].size(); ++i) {
+            const std::size_t n = frame * frames[frame].size() + i;
+            const std::array<s16, 2> expected = n < 2 ? std::array<s16, 2>{} : samples[n - 2];
+            REQUIRE(frames[frame][i] == expected);
+        }
+    }
+
+    // Halfway between samples the parabola through the samples is exact up to the truncation
+    const auto halves = Resample(Quadratic, 0.5f, samples, samples.size());
+    for (std::size_t n = 8; n < halves.size() * samples_per_frame; n += 2) {
+        const auto& out = halves[n / samples_per_frame][n % samples_per_frame + 1];
+        const double x = static_cast<double>(n / 2) - 2 + 0.5;
+        const double expected = x * (x - 1) / 2 - 16384;
+        REQUIRE(std::abs(out[0] - expected) <= 1.0);
+        REQUIRE(std::abs(out[1] + expected) <= 1.0);
+    }
+}
+
+TEST_CASE("AudioInterp::Quadratic saturates", "[audio_core]") {
+    // The parabola through these overshoots the range of s16 between the first two
+    std::vector<std::array<s16, 2>> samples(1024);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        const s16 value = i % 3 == 2 ? -32768 : 32767;
+        samples[i] = {value, static_cast<s16>(value == 32767 ? -32768 : 32767)};
+    }
+
+    const auto frames = Resample(Quadratic, 0.25f, samples, samples.size());
+    RequireClose(frames, Resample(ReferenceQuadratic, 0.25f, samples, samples.size()));
+}
+
+TEST_CASE("AudioInterp: Benchmark", "[.][benchmark][audio_core]") {
+    constexpr std::size_t num_frames = 64 * 1024;
+    const auto samples = MakeSamples(2 * 1024);
+
+    const auto measure = [&](Interpolator interpolate, float rate) {
+        State state;
+        StereoBuffer16 buffer;
+        StereoFrame16 frame{};
+        u64 checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < num_frames; ++i) {
+            std::size_t outputi = 0;
+            while (outputi < frame.size()) {
+                if (buffer.size() < 4) {
+                    buffer.insert(buffer.end(), samples.begin(), samples.end());
+                }
+                interpolate(state, buffer, rate, frame, outputi);
+            }
+            checksum += static_cast<u16>(frame[i % frame.size()][0]);
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        REQUIRE(checksum != 0);
+        return elapsed.count() / num_frames;
+    };
+
+    for (const float rate : rates) {
+        const double linear = measure(Linear, rate);
+        const double quadratic = measure(Quadratic, rate);
+        const double reference = measure(ReferenceQuadratic, rate);
+        WARN("rate " << rate << ": linear " << linear << " ns, quadratic " << quadratic
+                     << " ns, sample by sample " << reference << " ns per frame");
+    }
+}
+
+} // namespace AudioCore::AudioInterp
@@ -0,0 +1,117 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/cityhash.h"
+#include "common/hash.h"
+#include "common/xxh3.h"
+
+namespace Common {
+
+static constexpr std::array<XXH3Kernel, 4> all_kernels{
+    XXH3Kernel::Scalar,
+    XXH3Kernel::SSE2,
+    XXH3Kernel::AVX2,
+    XXH3Kernel::NEON,
+};
+
+/// The buffer of the sanity checks of the reference implementation
+static std::vector<u8> SanityBuffer(std::size_t size) {
+    std::vector<u8> buffer(size);
+    u64 generator = 2654435761U;
+    for (u8& byte : buffer) {
+        byte = static_cast<u8>(generator >> 56);
+        generator *= 11400714785074694797ULL;
+    }
+    return buffer;
+}
+
+TEST_CASE("XXH3Hash64: Reference values", "[common]") {
+    // Every size class: empty, 1-3, 4-8, 9-16, 17-128, 129-240, then one or more blocks
+    constexpr std::array<std::pair<std::size_t, u64>, 13> reference{{
+        {0, 0x2D06800538D394C2ULL},
+        {1, 0xC44BDFF4074EECDBULL},
+        {6, 0x27B56A84CD2D7325ULL},
+        {12, 0xA713DAF0DFBB77E7ULL},
+        {24, 0xA3FE70BF9D3510EBULL},
+        {48, 0x397DA259ECBA1F11ULL},
+        {80, 0xBCDEFBBB2C47C90AULL},
+        {195, 0xCD94217EE362EC3AULL},
+        {403, 0xCDEB804D65C6DEA4ULL},
+        {512, 0x617E49599013CB6BULL},
+        {2048, 0xDD59E2C3A5F038E0ULL},
+        {2240, 0x6E73A90539CF2948ULL},
+        {2367, 0xCB37AEB9E5D361EDULL},
+    }};
+    const std::vector<u8> buffer = SanityBuffer(2367);
+    for (XXH3Kernel kernel : all_kernels) {
+        if (!IsXXH3KernelSupported(kernel)) {
+            continue;
+        }
+        for (const auto& [len, hash] : reference) {
+            INFO("Kernel " << static_cast<int>(kernel) << ", length " << len);
+            REQUIRE(XXH3Hash64(buffer.data(), len, kernel) == hash);
+        }
+    }
+}
+
+TEST_CASE("XXH3Hash64: Kernels agree", "[common]") {
+    // Long enough for a few blocks, every length covers another partial block and last stripe
+    const std::vector<u8> buffer = SanityBuffer(4096);
+    for (std::size_t len = 0; len <= buffer.size(); ++len) {
+        const u64 expected = XXH3Hash64(buffer.data(), len, XXH3Kernel::Scalar);
+        for (XXH3Kernel kernel : all_kernels) {
+            if (IsXXH3KernelSupported(kernel)) {
+                REQUIRE(XXH3Hash64(buffer.data(), len, kernel) == expected);
+            }
+        }
+        REQUIRE(ComputeHash64(buffer.data(), static_cast<u32>(len)) == expected);
+    }
+}
+
+// Microbenchmarks, run them with the [benchmark] tag
+template <typename Func>
+static double MeasureGigabytes(std::size_t bytes_per_call, Func&& func) {
+    const std::size_t iterations = 256 * 1024 * 1024 / bytes_per_call;
+    u64 sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sink += func();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    // Keeps the calls from being optimized away
+    REQUIRE(sink != 1);
+    return bytes_per_call * iterations / elapsed.count() / 1e9;
+}
+
+TEST_CASE("XXH3Hash64: Benchmark", "[.][benchmark]") {
+    // A shader config struct and a 256x256 RGBA8 texture
+    for (std::size_t size : {std::size_t{64}, std::size_t{256 * 1024}}) {
+        const std::vector<u8> buffer = SanityBuffer(size);
+        const u32 len = static_cast<u32>(size);
+        const double city = MeasureGigabytes(
+            size, [&] { return CityHash64(reinterpret_cast<const char*>(buffer.data()), size); });
+        WARN("Size " << size << ": CityHash64 " << city << " GB/s");
+#if defined(ARCHITECTURE_ARM64) && defined(__ARM_FEATURE_CRC32)
+        const double crc =
+            MeasureGigabytes(size, [&] { return ComputeCRC32Hash64(buffer.data(), len); });
+        WARN("Size " << size << ": CRC32 " << crc << " GB/s");
+#endif
+        for (XXH3Kernel kernel : all_kernels) {
+            if (!IsXXH3KernelSupported(kernel)) {
+                continue;
+            }
+            const double xxh3 =
+                MeasureGigabytes(size, [&] { return XXH3Hash64(buffer.data(), len, kernel); });
+            WARN("Size " << size << ": XXH3 kernel " << static_cast<int>(kernel) << " " << xxh3
+                         << " GB/s");
+        }
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,93 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "common/linear_disk_cache.h"
+
+namespace Common {
+
+namespace {
+class TestReader : public LinearDiskCacheReader<u64, u8> {
+public:
+    void Read(const u64& key, const u8* value, u32 value_size) override {
+        entries[key] = std::vector<u8>(value, value + value_size);
+    }
+
+    std::map<u64, std::vector<u8>> entries;
+};
+
+std::string GetTempFile() {
+    return FileUtil::GetCurrentDir().value_or(".") + "/linear_disk_cache_test.bin";
+}
+} // Anonymous namespace
+
+TEST_CASE("LinearDiskCache: Entries survive reopening", "[common]") {
+    const std::string path = GetTempFile();
+    FileUtil::Delete(path);
+
+    const std::vector<u8> first{1, 2, 3};
+    const std::vector<u8> second{4, 5, 6, 7};
+    {
+        LinearDiskCache<u64, u8> cache;
+        TestReader reader;
+        REQUIRE(cache.OpenAndRead(path.c_str(), reader) == 0);
+        cache.Append(10, first.data(), static_cast<u32>(first.size()));
+        cache.Append(20, second.data(), static_cast<u32>(second.size()));
+        cache.Sync();
+    }
+
+    LinearDiskCache<u64, u8> cache;
+    TestReader reader;
+    REQUIRE(cache.OpenAndRead(path.c_str(), reader) == 2);
+    REQUIRE(reader.entries[10] == first);
+    REQUIRE(reader.entries[20] == second);
+
+    // Appending after a reopen continues the existing journal
+    cache.Append(30, first.data(), static_cast<u32>(first.size()));
+    cache.Close();
+
+    TestReader reopened;
+    REQUIRE(cache.OpenAndRead(path.c_str(), reopened) == 3);
+    REQUIRE(reopened.entries[30] == first);
+    cache.Close();
+
+    FileUtil::Delete(path);
+}
+
+TEST_CASE("LinearDiskCache: Torn entries are dropped", "[common]") {
+    const std::string path = GetTempFile();
+    FileUtil::Delete(path);
+
+    const std::vector<u8> value{1, 2, 3, 4, 5, 6, 7, 8};
+    {
+        LinearDiskCache<u64, u8> cache;
+        TestReader reader;
+        cache.OpenAndRead(path.c_str(), reader);
+        cache.Append(1, value.data(), static_cast<u32>(value.size()));
+        cache.Append(2, value.data(), static_cast<u32>(value.size()));
+    }
+
+    // Cut the last entry in half, as if the process was killed while writing it
+    const u64 size = FileUtil::GetSize(path);
+    {
+        FileUtil::IOFile file(path, "r+b");
+        REQUIRE(file.Resize(size - 6));
+    }
+
+    LinearDiskCache<u64, u8> cache;
+    TestReader reader;
+    REQUIRE(cache.OpenAndRead(path.c_str(), reader) == 1);
+    REQUIRE(reader.entries.count(1) == 1);
+    REQUIRE(reader.entries.count(2) == 0);
+    cache.Close();
+
+    FileUtil::Delete(path);
+}
+
+} // namespace Common
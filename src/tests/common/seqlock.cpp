@@ -0,0 +1,63 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "common/seqlock.h"
+
+namespace Common {
+
+namespace {
+struct Sample {
+    std::array<u64, 7> values;
+    u8 flag;
+};
+} // namespace
+
+TEST_CASE("SeqLock: Loads the stored value", "[common]") {
+    SeqLock<Sample> lock;
+    REQUIRE(lock.Load().values[0] == 0);
+
+    lock.Store({{1, 2, 3, 4, 5, 6, 7}, 1});
+    const Sample sample = lock.Load();
+    REQUIRE(sample.values == std::array<u64, 7>{1, 2, 3, 4, 5, 6, 7});
+    REQUIRE(sample.flag == 1);
+}
+
+TEST_CASE("SeqLock: Readers never see a torn value", "[common]") {
+    SeqLock<Sample> lock;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&] {
+        for (u64 i = 1; i <= 200000; ++i) {
+            Sample sample;
+            sample.values.fill(i);
+            sample.flag = static_cast<u8>(i);
+            lock.Store(sample);
+        }
+        done = true;
+    });
+
+    u64 last = 0;
+    bool torn = false;
+    bool went_back = false;
+    while (!done) {
+        const Sample sample = lock.Load();
+        for (u64 value : sample.values) {
+            torn |= value != sample.values[0];
+        }
+        torn |= sample.flag != static_cast<u8>(sample.values[0]);
+        went_back |= sample.values[0] < last;
+        last = sample.values[0];
+    }
+    writer.join();
+
+    REQUIRE(!torn);
+    REQUIRE(!went_back);
+    REQUIRE(lock.Load().values[0] == 200000);
+}
+
+} // namespace Common
@@ -0,0 +1,88 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/thread_pool.h"
+
+namespace Common {
+
+TEST_CASE("ThreadPool: ParallelFor runs every index once", "[common]") {
+    for (std::size_t num_threads : {0, 1, 3}) {
+        ThreadPool pool(num_threads, "TestPool");
+        // Several loops in a row, so that the workers also wake up for later ones
+        for (std::size_t count : {0, 1, 2, 7, 1000}) {
+            std::vector<std::atomic<int>> calls(count);
+            pool.ParallelFor(count, [&](std::size_t i) { ++calls[i]; });
+            for (std::size_t i = 0; i < count; ++i) {
+                INFO("Threads " << num_threads << ", count " << count << ", index " << i);
+                REQUIRE(calls[i] == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("ThreadPool: Submit returns the results of the tasks", "[common]") {
+    for (std::size_t num_threads : {0, 1, 3}) {
+        ThreadPool pool(num_threads, "TestPool");
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 100; ++i) {
+            const auto priority = static_cast<TaskPriority>(i % NUM_TASK_PRIORITIES);
+            results.push_back(pool.Submit(priority, [i] { return i * i; }));
+        }
+        for (int i = 0; i < 100; ++i) {
+            INFO("Threads " << num_threads << ", task " << i);
+            REQUIRE(results[i].get() == i * i);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool: TrySubmit refuses tasks past the queue capacity", "[common]") {
+    ThreadPool pool(1, "TestPool", 2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> started;
+    auto blocker = pool.Submit(TaskPriority::Normal, [&] {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+
+    auto first = pool.TrySubmit(TaskPriority::Normal, [] { return 1; });
+    auto second = pool.TrySubmit(TaskPriority::Normal, [] { return 2; });
+    auto third = pool.TrySubmit(TaskPriority::Normal, [] { return 3; });
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE(!third.has_value());
+    // Each priority has a queue of its own
+    auto critical = pool.TrySubmit(TaskPriority::LatencyCritical, [] { return 4; });
+    REQUIRE(critical.has_value());
+
+    release.set_value();
+    blocker.get();
+    REQUIRE(critical->get() == 4);
+    REQUIRE(first->get() == 1);
+    REQUIRE(second->get() == 2);
+}
+
+TEST_CASE("ThreadPool: ParallelFor does not wait for busy workers", "[common]") {
+    ThreadPool pool(2, "TestPool");
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    auto blocker = pool.Submit(TaskPriority::Normal, [&] { released.wait(); });
+
+    std::vector<std::atomic<int>> calls(100);
+    pool.ParallelFor(calls.size(), [&](std::size_t i) { ++calls[i]; });
+    for (std::size_t i = 0; i < calls.size(); ++i) {
+        REQUIRE(calls[i] == 1);
+    }
+
+    release.set_value();
+    blocker.get();
+}
+
+} // namespace Common
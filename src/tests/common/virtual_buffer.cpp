@@ -0,0 +1,25 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "common/virtual_buffer.h"
+
+namespace Common {
+
+TEST_CASE("VirtualBuffer: Zeroed and writable", "[common]") {
+    constexpr std::size_t size = 64 * 1024 * 1024;
+    for (bool huge_pages : {false, true}) {
+        VirtualBuffer buffer(size, huge_pages);
+        REQUIRE(buffer.size() == size);
+        // Touches one byte per MiB only, the rest of the buffer stays unbacked
+        for (std::size_t offset = 0; offset < size; offset += 0x100000) {
+            REQUIRE(buffer.data()[offset] == 0);
+            buffer.data()[offset] = 0xAB;
+        }
+        REQUIRE(buffer.data()[size - 1] == 0);
+        REQUIRE(buffer.data()[0x100000] == 0xAB);
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,204 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "tests/core/arm/arm_test_common.h"
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#include "core/arm/dynarmic/arm_exclusive_monitor.h"
+#endif
+
+namespace ArmTests {
+
+namespace {
+
+/// A loop counting r3 down, followed by a branch to itself that ends the workload
+struct Workload {
+    const char* name;
+    bool thumb;
+    /// Instructions of ARM code, pairs of instructions of Thumb code
+    std::vector<u32> code;
+    u32 instructions_per_iteration;
+    u32 iterations;
+    std::function<void(ARM_Interface&)> setup;
+};
+
+constexpr u32 CPSR_THUMB = 1 << 5;
+
+/// Branches through the given number of one-instruction blocks, which stresses the block lookup
+std::vector<u32> MakeBlockChain(u32 blocks) {
+    std::vector<u32> code(blocks, 0xEAFFFFFF); // b +#4, to the next block
+    code.push_back(0xE2533001);                // subs r3, r3, #1
+    const s32 offset = -static_cast<s32>(code.size() * 4 + 8) / 4;
+    code.push_back(0x1A000000 | (static_cast<u32>(offset) & 0x00FFFFFF)); // bne to the first block
+    code.push_back(0xEAFFFFFE);                                           // b +#0
+    return code;
+}
+
+std::vector<Workload> GetWorkloads() {
+    return {
+        {"ARM integer",
+         false,
+         {
+             0xE0811000, // loop: add r1, r1, r0
+             0xE0212180, // eor r2, r1, r0, lsl #3
+             0xE18213E1, // orr r1, r2, r1, ror #7
+             0xE2800001, // add r0, r0, #1
+             0xE2533001, // subs r3, r3, #1
+             0x1AFFFFF9, // bne loop
+             0xEAFFFFFE, // b +#0
+         },
+         6,
+         4 * 1024 * 1024,
+         [](ARM_Interface&) {}},
+        {"Thumb integer",
+         true,
+         {
+             0x404A1809, // loop: adds r1, r1, r0; eors r2, r1
+             0x431100D2, // lsls r2, r2, #3; orrs r1, r2
+             0xD1F93B01, // subs r3, #1; bne loop
+             0xE7FEE7FE, // b +#0
+         },
+         6,
+         4 * 1024 * 1024,
+         [](ARM_Interface&) {}},
+        {"VFP",
+         false,
+         {
+             0xEE321A03, // loop: vadd.f32 s2, s4, s6
+             0xEE210A02, // vmul.f32 s0, s2, s4
+             0xEE003A04, // vmla.f32 s6, s0, s8
+             0xE2533001, // subs r3, r3, #1
+             0x1AFFFFFA, // bne loop
+             0xEAFFFFFE, // b +#0
+         },
+         5,
+         2 * 1024 * 1024,
+         [](ARM_Interface& core) {
+             // Values that stay the same, so that no iteration takes the slow paths of the NaNs
+             core.SetVFPReg(4, 0x3F800000);
+             core.SetVFPReg(6, 0);
+             core.SetVFPReg(8, 0);
+         }},
+        {"Memory copy",
+         false,
+         {
+             0xE8B100F0, // loop: ldmia r1!, {r4-r7}
+             0xE8A200F0, // stmia r2!, {r4-r7}
+             0xE2533001, // subs r3, r3, #1
+             0x1AFFFFFB, // bne loop
+             0xEAFFFFFE, // b +#0
+         },
+         4,
+         256 * 1024,
+         [](ARM_Interface& core) {
+             // 4 MiB from 1 MiB to 8 MiB
+             core.SetReg(1, 0x00100000);
+             core.SetReg(2, 0x00800000);
+         }},
+        {"SVC",
+         false,
+         {
+             0xEF000028, // loop: svc #0x28 (GetSystemTick, which clobbers r0 and r1)
+             0xE2533001, // subs r3, r3, #1
+             0x1AFFFFFC, // bne loop
+             0xEAFFFFFE, // b +#0
+         },
+         3,
+         256 * 1024,
+         [](ARM_Interface&) {}},
+        {"Block chain", false, MakeBlockChain(256), 258, 64 * 1024, [](ARM_Interface&) {}},
+    };
+}
+
+/// Wall time of the runs of a workload, in seconds
+struct WorkloadTimes {
+    /// With every block translated anew
+    double cold;
+    /// Of the same run once the blocks are translated
+    double warm;
+    /// Of all the iterations
+    double full;
+};
+
+class WorkloadRunner {
+public:
+    WorkloadRunner(TestEnvironment& test_env, ARM_Interface& core, const Workload& workload)
+        : test_env(test_env), core(core), workload(workload) {
+        for (std::size_t i = 0; i < workload.code.size(); ++i) {
+            test_env.SetMemory32(static_cast<VAddr>(i * 4), workload.code[i]);
+        }
+        core.ClearInstructionCache();
+    }
+
+    /// Runs the given number of iterations until the final branch
+    double Run(u32 iterations) {
+        const u32 end = static_cast<u32>(workload.code.size() - 1) * 4;
+        core.SetCPSR(USER32MODE | (workload.thumb ? CPSR_THUMB : 0));
+        core.SetPC(0);
+        core.SetReg(3, iterations);
+        workload.setup(core);
+
+        auto& timer = *test_env.GetTimer();
+        const auto start = std::chrono::steady_clock::now();
+        while (core.GetPC() != end) {
+            timer.Advance();
+            core.Run();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    WorkloadTimes Measure() {
+        WorkloadTimes times;
+        // A single iteration translates the loop, the final branch runs for the rest of the slice
+        times.cold = Run(1);
+        times.warm = Run(1);
+        times.full = Run(workload.iterations);
+        return times;
+    }
+
+private:
+    TestEnvironment& test_env;
+    ARM_Interface& core;
+    const Workload& workload;
+};
+
+void ReportWorkload(const char* core_name, const Workload& workload, const WorkloadTimes& times) {
+    const double instructions =
+        static_cast<double>(workload.iterations) * workload.instructions_per_iteration;
+    WARN(core_name << " " << workload.name << ": " << instructions / times.full / 1e6
+                   << " guest MIPS, translation " << (times.cold - times.warm) * 1e6 << " us");
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ARM cores: Benchmark", "[.][benchmark][core][arm]") {
+    for (const Workload& workload : GetWorkloads()) {
+        {
+            TestEnvironment test_env;
+            ARM_DynCom dyncom(&test_env.GetSystem(), 0, test_env.GetTimer());
+            test_env.SetCore(dyncom);
+            ReportWorkload("DynCom", workload, WorkloadRunner(test_env, dyncom, workload).Measure());
+        }
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+        {
+            TestEnvironment test_env;
+            Core::DynarmicExclusiveMonitor exclusive_monitor(1);
+            ARM_Dynarmic dynarmic(&test_env.GetSystem(), 0, test_env.GetTimer(), exclusive_monitor);
+            test_env.SetCore(dynarmic);
+            ReportWorkload("Dynarmic", workload,
+                           WorkloadRunner(test_env, dynarmic, workload).Measure());
+        }
+#endif
+    }
+}
+
+} // namespace ArmTests
@@ -19,11 +19,12 @@ struct VfpTestCase {
 };
 
 TEST_CASE("ARM_DynCom (vfp): vadd", "[arm_dyncom]") {
-    TestEnvironment test_env(false);
+    TestEnvironment test_env;
     test_env.SetMemory32(0, 0xEE321A03); // vadd.f32 s2, s4, s6
     test_env.SetMemory32(4, 0xEAFFFFFE); // b +#0
 
-    ARM_DynCom dyncom(nullptr, test_env.GetMemory(), USER32MODE, 0, nullptr);
+    ARM_DynCom dyncom(&test_env.GetSystem(), 0, test_env.GetTimer());
+    test_env.SetCore(dyncom);
 
     std::vector<VfpTestCase> test_cases{{
 #include "vfp_vadd_f32.inc"
@@ -7,6 +7,7 @@
 #include <array>
 #include <bitset>
 #include <string>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -43,7 +44,7 @@ static void AdvanceAndCheck(Core::Timing& timing, u32 idx, int downcount, int ex
 }
 
 TEST_CASE("CoreTiming[BasicOrder]", "[core]") {
-    Core::Timing timing(1, 100);
+    Core::Timing timing;
 
     Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
     Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
@@ -90,7 +91,7 @@ void FifoCallback(u64 userdata, s64 cycles_late) {
 TEST_CASE("CoreTiming[SharedSlot]", "[core]") {
     using namespace SharedSlotTest;
 
-    Core::Timing timing(1, 100);
+    Core::Timing timing;
 
     Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", FifoCallback<0>);
     Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", FifoCallback<1>);
@@ -118,7 +119,7 @@ TEST_CASE("CoreTiming[SharedSlot]", "[core]") {
 }
 
 TEST_CASE("CoreTiming[PredictableLateness]", "[core]") {
-    Core::Timing timing(1, 100);
+    Core::Timing timing;
 
     Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
     Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
@@ -133,6 +134,26 @@ TEST_CASE("CoreTiming[PredictableLateness]", "[core]") {
     AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH, 50, -50);
 }
 
+TEST_CASE("CoreTiming[IdleSkip]", "[core]") {
+    Core::Timing timing;
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+
+    timing.ScheduleEvent(MAX_SLICE_LENGTH * 3, cb_a, CB_IDS[0], 0);
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
+
+    // A sleeping core goes straight to the event instead of idling through three slices
+    timing.GetTimer(0)->Skip(timing.GetTimer(0)->GetMaxSliceLength());
+    REQUIRE(MAX_SLICE_LENGTH * 3 == timing.GetTimer(0)->GetDowncount());
+    timing.GetTimer(0)->Skip(100);
+    REQUIRE(MAX_SLICE_LENGTH * 3 == timing.GetTimer(0)->GetDowncount());
+
+    AdvanceAndCheck(timing, 0, MAX_SLICE_LENGTH);
+}
+
 namespace ChainSchedulingTest {
 static int reschedules = 0;
 
@@ -149,7 +170,7 @@ static void RescheduleCallback(Core::Timing& timing, u64 userdata, s64 cycles_la
 TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     using namespace ChainSchedulingTest;
 
-    Core::Timing timing(1, 100);
+    Core::Timing timing;
 
     Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
     Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
@@ -186,4 +207,48 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
+namespace ChurnTest {
+static std::vector<u64> woken;
+
+static void WakeupCallback(u64 userdata, s64 cycles_late) {
+    woken.push_back(userdata);
+}
+} // namespace ChurnTest
+
+TEST_CASE("CoreTiming[Churn]", "[core]") {
+    using namespace ChurnTest;
+
+    Core::Timing timing;
+    auto timer = timing.GetTimer(0);
+
+    Core::TimingEventType* cb_wakeup = timing.RegisterEvent("callbackWakeup", WakeupCallback);
+
+    // Enter slice 0
+    timer->Advance();
+
+    // Threads waiting with a timeout, most of which get signalled before it expires
+    constexpr u64 num_threads = 64;
+    for (int round = 0; round < 100; ++round) {
+        woken.clear();
+        for (u64 id = 0; id < num_threads; ++id) {
+            timing.ScheduleEvent(1000 + id * 10, cb_wakeup, id, 0);
+        }
+        for (u64 id = 0; id < num_threads; id += 2) {
+            timing.UnscheduleEvent(cb_wakeup, id);
+        }
+        // The first live event bounds the slice, not the cancelled one before it
+        REQUIRE(timer->GetMaxSliceLength() == 1000 + 10);
+
+        while (woken.size() < num_threads / 2) {
+            timer->AddTicks(timer->GetDowncount());
+            timer->Advance();
+        }
+
+        REQUIRE(woken.size() == num_threads / 2);
+        for (std::size_t i = 0; i < woken.size(); ++i) {
+            REQUIRE(woken[i] == i * 2 + 1);
+        }
+    }
+}
+
 // TODO: Add tests for multiple timers
@@ -0,0 +1,65 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/hle/kernel/memory.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+constexpr u32 PageSize = Memory::PAGE_SIZE;
+
+TEST_CASE("MemoryRegionInfo::LinearAllocate", "[core][kernel]") {
+    MemoryRegionInfo region;
+    region.Reset(0x100000, 10 * PageSize);
+
+    SECTION("first fit from the bottom") {
+        REQUIRE(region.LinearAllocate(2 * PageSize) == 0x100000);
+        REQUIRE(region.LinearAllocate(PageSize) == 0x100000 + 2 * PageSize);
+        region.Free(0x100000, 2 * PageSize);
+        // The hole is too small, the block after the others is taken
+        REQUIRE(region.LinearAllocate(3 * PageSize) == 0x100000 + 3 * PageSize);
+        REQUIRE(region.LinearAllocate(2 * PageSize) == 0x100000);
+        REQUIRE(region.used == 6 * PageSize);
+        REQUIRE(!region.LinearAllocate(5 * PageSize));
+    }
+
+    SECTION("fixed address") {
+        REQUIRE(region.LinearAllocate(0x100000 + 4 * PageSize, 2 * PageSize));
+        REQUIRE(!region.LinearAllocate(0x100000 + 5 * PageSize, 2 * PageSize));
+        REQUIRE(!region.LinearAllocate(0x100000 + 9 * PageSize, 2 * PageSize));
+        REQUIRE(!region.LinearAllocate(0x0F0000, PageSize));
+        REQUIRE(!region.LinearAllocate(5 * PageSize));
+        REQUIRE(region.LinearAllocate(4 * PageSize) == 0x100000);
+        region.Free(0x100000 + 4 * PageSize, 2 * PageSize);
+        REQUIRE(!region.LinearAllocate(0x100000 + 3 * PageSize, 3 * PageSize));
+        REQUIRE(region.LinearAllocate(0x100000 + 4 * PageSize, 3 * PageSize));
+    }
+}
+
+TEST_CASE("MemoryRegionInfo::HeapAllocate", "[core][kernel]") {
+    MemoryRegionInfo region;
+    region.Reset(0, 8 * PageSize);
+    REQUIRE(region.LinearAllocate(6 * PageSize, PageSize));
+    REQUIRE(region.LinearAllocate(2 * PageSize, PageSize));
+
+    // The blocks are taken from the top down, the lowest one only in part
+    const auto blocks = region.HeapAllocate(4 * PageSize);
+    MemoryRegionInfo::IntervalSet expected;
+    expected += MemoryRegionInfo::Interval(7 * PageSize, 8 * PageSize);
+    expected += MemoryRegionInfo::Interval(3 * PageSize, 6 * PageSize);
+    REQUIRE(blocks == expected);
+    REQUIRE(region.used == 6 * PageSize);
+
+    REQUIRE(region.HeapAllocate(3 * PageSize).empty());
+    const auto rest = region.HeapAllocate(2 * PageSize);
+    REQUIRE(rest == MemoryRegionInfo::IntervalSet(MemoryRegionInfo::Interval(0, 2 * PageSize)));
+
+    for (const auto& interval : blocks) {
+        region.Free(interval.lower(), interval.upper() - interval.lower());
+    }
+    REQUIRE(region.LinearAllocate(3 * PageSize) == 3 * PageSize);
+}
+
+} // namespace Kernel
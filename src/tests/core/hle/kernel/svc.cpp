@@ -0,0 +1,50 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <catch2/catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/svc.h"
+#include "tests/core/arm/arm_test_common.h"
+
+namespace Kernel {
+
+TEST_CASE("SVC dispatch: Benchmark", "[.][benchmark][core][kernel]") {
+    constexpr u32 num_calls = 1024 * 1024;
+
+    ArmTests::TestEnvironment test_env;
+    ARM_DynCom core(&test_env.GetSystem(), 0, test_env.GetTimer());
+    test_env.SetCore(core);
+    test_env.GetSystem().Kernel().GetCurrentProcess()->status = ProcessStatus::Running;
+    SVCContext svc(test_env.GetSystem());
+
+    struct Call {
+        const char* name;
+        u32 immediate;
+        u32 argument;
+    };
+    // GetSystemTick is served before the HLE lock, GetProcessId goes through it and the table
+    constexpr std::array<Call, 2> calls{{
+        {"GetSystemTick", 0x28, 0},
+        {"GetProcessId", 0x35, CurrentProcess},
+    }};
+
+    for (const Call& call : calls) {
+        const auto start = std::chrono::steady_clock::now();
+        for (u32 i = 0; i < num_calls; ++i) {
+            core.SetReg(1, call.argument);
+            svc.CallSVC(call.immediate);
+        }
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        WARN("svc " << call.name << ": " << elapsed.count() / num_calls << " ns per call");
+    }
+    REQUIRE(core.GetReg(0) == RESULT_SUCCESS.raw);
+}
+
+} // namespace Kernel
@@ -0,0 +1,186 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/string_util.h"
+#include "core/hle/romfs.h"
+
+namespace RomFS {
+
+constexpr u32 INVALID_FIELD = 0xFFFFFFFF;
+
+static void Append32(std::vector<u8>& buffer, u32 value) {
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(value));
+    std::memcpy(&buffer[offset], &value, sizeof(value));
+}
+
+static void Append64(std::vector<u8>& buffer, u64 value) {
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(value));
+    std::memcpy(&buffer[offset], &value, sizeof(value));
+}
+
+static void AppendName(std::vector<u8>& buffer, const std::u16string& name) {
+    const std::size_t offset = buffer.size();
+    const std::size_t name_length = name.size() * sizeof(char16_t);
+    // The entries are 4-byte aligned
+    buffer.resize(offset + ((name_length + 3) & ~std::size_t{3}));
+    std::memcpy(&buffer[offset], name.data(), name_length);
+}
+
+static void Set32(std::vector<u8>& buffer, std::size_t offset, u32 value) {
+    std::memcpy(&buffer[offset], &value, sizeof(value));
+}
+
+static std::u16string DirName(u32 dir) {
+    return Common::UTF8ToUTF16("dir" + std::to_string(dir));
+}
+
+static std::u16string FileName(u32 file) {
+    return Common::UTF8ToUTF16("file" + std::to_string(file) + ".bin");
+}
+
+/**
+ * Builds a RomFS image with a root.bin file in the root and num_dirs directories holding
+ * files_per_dir files each. The data of every file is its index as a u32. The hash tables are left
+ * empty, as the lookups don't use them.
+ */
+static std::vector<u8> MakeRomFS(u32 num_dirs, u32 files_per_dir) {
+    std::vector<u8> dir_table;
+    std::vector<u8> file_table;
+    std::vector<u8> data;
+
+    const auto add_file = [&](u32 parent, const std::u16string& name, u32 value) {
+        const u32 offset = static_cast<u32>(file_table.size());
+        Append32(file_table, parent);
+        Append32(file_table, INVALID_FIELD);
+        Append64(file_table, data.size());
+        Append64(file_table, sizeof(value));
+        Append32(file_table, INVALID_FIELD);
+        Append32(file_table, static_cast<u32>(name.size() * sizeof(char16_t)));
+        AppendName(file_table, name);
+        Append32(data, value);
+        return offset;
+    };
+    const auto add_dir = [&](const std::u16string& name) {
+        const u32 offset = static_cast<u32>(dir_table.size());
+        Append32(dir_table, 0);
+        Append32(dir_table, INVALID_FIELD);
+        Append32(dir_table, INVALID_FIELD);
+        Append32(dir_table, INVALID_FIELD);
+        Append32(dir_table, INVALID_FIELD);
+        Append32(dir_table, static_cast<u32>(name.size() * sizeof(char16_t)));
+        AppendName(dir_table, name);
+        return offset;
+    };
+
+    add_dir({});
+    Set32(dir_table, 12, add_file(0, u"root.bin", INVALID_FIELD));
+    u32 previous_dir = 0;
+    for (u32 dir = 0; dir < num_dirs; ++dir) {
+        const u32 dir_offset = add_dir(DirName(dir));
+        // The root links to its first child, the children to their next sibling
+        Set32(dir_table, previous_dir + (dir == 0 ? 8 : 4), dir_offset);
+        previous_dir = dir_offset;
+
+        u32 previous_file = 0;
+        for (u32 file = 0; file < files_per_dir; ++file) {
+            const u32 file_offset = add_file(dir_offset, FileName(file), dir * files_per_dir + file);
+            if (file == 0) {
+                Set32(dir_table, dir_offset + 12, file_offset);
+            } else {
+                Set32(file_table, previous_file + 4, file_offset);
+            }
+            previous_file = file_offset;
+        }
+    }
+
+    constexpr u32 header_length = 0x28;
+    const u32 dir_table_offset = header_length;
+    const u32 file_table_offset = dir_table_offset + static_cast<u32>(dir_table.size());
+    const u32 data_offset = file_table_offset + static_cast<u32>(file_table.size());
+    std::vector<u8> romfs;
+    for (const u32 value :
+         {header_length, dir_table_offset, 0u, dir_table_offset,
+          static_cast<u32>(dir_table.size()), file_table_offset, 0u, file_table_offset,
+          static_cast<u32>(file_table.size()), data_offset}) {
+        Append32(romfs, value);
+    }
+    romfs.insert(romfs.end(), dir_table.begin(), dir_table.end());
+    romfs.insert(romfs.end(), file_table.begin(), file_table.end());
+    romfs.insert(romfs.end(), data.begin(), data.end());
+    return romfs;
+}
+
+static u32 ReadValue(const RomFSFile& file) {
+    REQUIRE(file.Length() == sizeof(u32));
+    u32 value;
+    std::memcpy(&value, file.Data(), sizeof(value));
+    return value;
+}
+
+TEST_CASE("RomFS::RomFSIndex matches the table walk", "[core][romfs]") {
+    constexpr u32 num_dirs = 4;
+    constexpr u32 files_per_dir = 5;
+    const std::vector<u8> romfs = MakeRomFS(num_dirs, files_per_dir);
+    const RomFSIndex index(romfs.data());
+    CHECK(index.GetFileCount() == num_dirs * files_per_dir + 1);
+
+    CHECK(ReadValue(index.GetFile({u"root.bin"})) == INVALID_FIELD);
+    CHECK(ReadValue(GetFile(romfs.data(), {u"root.bin"})) == INVALID_FIELD);
+    for (u32 dir = 0; dir < num_dirs; ++dir) {
+        for (u32 file = 0; file < files_per_dir; ++file) {
+            const std::vector<std::u16string> path{DirName(dir), FileName(file)};
+            const RomFSFile indexed = index.GetFile(path);
+            CHECK(indexed.Data() == GetFile(romfs.data(), path).Data());
+            CHECK(ReadValue(indexed) == dir * files_per_dir + file);
+        }
+    }
+
+    CHECK(index.GetFile({u"missing.bin"}).Data() == nullptr);
+    CHECK(index.GetFile({DirName(0)}).Data() == nullptr);
+    CHECK(index.GetFile({DirName(num_dirs), FileName(0)}).Data() == nullptr);
+    CHECK(GetFile(romfs.data(), {DirName(num_dirs), FileName(0)}).Data() == nullptr);
+}
+
+// Lookups of every file of a large image, run it with the [benchmark] tag
+TEST_CASE("RomFS lookups: Benchmark", "[.][benchmark][core][romfs]") {
+    constexpr u32 num_dirs = 128;
+    constexpr u32 files_per_dir = 128;
+    const std::vector<u8> romfs = MakeRomFS(num_dirs, files_per_dir);
+    std::vector<std::vector<std::u16string>> paths;
+    for (u32 dir = 0; dir < num_dirs; ++dir) {
+        for (u32 file = 0; file < files_per_dir; ++file) {
+            paths.push_back({DirName(dir), FileName(file)});
+        }
+    }
+
+    u64 checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& path : paths) {
+        checksum += GetFile(romfs.data(), path).Length();
+    }
+    const std::chrono::duration<double> walked = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    const RomFSIndex index(romfs.data());
+    const std::chrono::duration<double> built = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (const auto& path : paths) {
+        checksum += index.GetFile(path).Length();
+    }
+    const std::chrono::duration<double> indexed = std::chrono::steady_clock::now() - start;
+
+    CHECK(checksum == 2 * paths.size() * sizeof(u32));
+    WARN(paths.size() << " files: table walk " << walked.count() * 1e9 / paths.size()
+                      << " ns/lookup, index " << indexed.count() * 1e9 / paths.size()
+                      << " ns/lookup after " << built.count() * 1e3 << " ms to build");
+}
+
+} // namespace RomFS
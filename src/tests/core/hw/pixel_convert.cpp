@@ -0,0 +1,171 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/color.h"
+#include "core/hw/pixel_convert.h"
+
+using GPU::Regs;
+using PixelFormat = GPU::Regs::PixelFormat;
+
+static constexpr std::array<PixelFormat, 5> all_formats{
+    PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565, PixelFormat::RGB5A1,
+    PixelFormat::RGBA4,
+};
+
+// Odd so that every kernel also runs its scalar tail
+static constexpr std::size_t num_pixels = 1021;
+
+static std::vector<u8> RandomBytes(std::size_t size, u32 seed = 0) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(distribution(generator));
+    }
+    return bytes;
+}
+
+static Common::Vec4<u8> DecodeReference(PixelFormat format, const u8* src) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src);
+    default:
+        return Color::DecodeRGBA4(src);
+    }
+}
+
+static void EncodeReference(PixelFormat format, const Common::Vec4<u8>& color, u8* dst) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::EncodeRGBA8(color, dst);
+    case PixelFormat::RGB8:
+        return Color::EncodeRGB8(color, dst);
+    case PixelFormat::RGB565:
+        return Color::EncodeRGB565(color, dst);
+    case PixelFormat::RGB5A1:
+        return Color::EncodeRGB5A1(color, dst);
+    default:
+        return Color::EncodeRGBA4(color, dst);
+    }
+}
+
+TEST_CASE("PixelConvert: Rows match the per-pixel conversion", "[core][gpu]") {
+    for (PixelFormat format : all_formats) {
+        const u32 bytes_per_pixel = Regs::BytesPerPixel(format);
+        const std::vector<u8> src = RandomBytes(num_pixels * bytes_per_pixel);
+
+        std::vector<u8> rgba(num_pixels * 4);
+        GPU::PixelConvert::DecodeRow(format, src.data(), rgba.data(), num_pixels);
+        for (std::size_t i = 0; i < num_pixels; ++i) {
+            const auto color = DecodeReference(format, &src[i * bytes_per_pixel]);
+            REQUIRE(rgba[i * 4 + 0] == color.r());
+            REQUIRE(rgba[i * 4 + 1] == color.g());
+            REQUIRE(rgba[i * 4 + 2] == color.b());
+            REQUIRE(rgba[i * 4 + 3] == color.a());
+        }
+
+        const std::vector<u8> colors = RandomBytes(num_pixels * 4, 1);
+        std::vector<u8> dst(num_pixels * bytes_per_pixel);
+        std::vector<u8> expected(num_pixels * bytes_per_pixel);
+        GPU::PixelConvert::EncodeRow(format, colors.data(), dst.data(), num_pixels);
+        for (std::size_t i = 0; i < num_pixels; ++i) {
+            const u8* color = &colors[i * 4];
+            EncodeReference(format, {color[0], color[1], color[2], color[3]},
+                            &expected[i * bytes_per_pixel]);
+        }
+        REQUIRE(dst == expected);
+    }
+}
+
+TEST_CASE("PixelConvert: Downscaling rounds down like the per-pixel average", "[core][gpu]") {
+    const std::vector<u8> row0 = RandomBytes(num_pixels * 2 * 4);
+    const std::vector<u8> row1 = RandomBytes(num_pixels * 2 * 4, 1);
+
+    std::vector<u8> scaled_x(num_pixels * 4);
+    std::vector<u8> scaled_xy(num_pixels * 4);
+    GPU::PixelConvert::DownscaleRowX(row0.data(), scaled_x.data(), num_pixels);
+    GPU::PixelConvert::DownscaleRowXY(row0.data(), row1.data(), scaled_xy.data(), num_pixels);
+    for (std::size_t i = 0; i < num_pixels * 4; ++i) {
+        const std::size_t left = (i / 4) * 8 + i % 4;
+        REQUIRE(scaled_x[i] == (row0[left] + row0[left + 4]) / 2);
+        REQUIRE(scaled_xy[i] == (row0[left] + row0[left + 4] + row1[left] + row1[left + 4]) / 4);
+    }
+}
+
+TEST_CASE("PixelConvert: Fill repeats the value", "[core][gpu]") {
+    constexpr u32 value = 0x12345678;
+    for (u32 bytes_per_value = 2; bytes_per_value <= 4; ++bytes_per_value) {
+        // Leave room for the partial value that 16 and 24-bit fills write whole
+        std::vector<u8> memory(num_pixels + 4, 0xAA);
+        GPU::PixelConvert::Fill(memory.data(), memory.data() + num_pixels, value,
+                                bytes_per_value);
+
+        const std::size_t num_values = bytes_per_value == 4
+                                           ? num_pixels / 4
+                                           : (num_pixels + bytes_per_value - 1) / bytes_per_value;
+        for (std::size_t i = 0; i < num_values; ++i) {
+            REQUIRE(std::memcmp(&memory[i * bytes_per_value], &value, bytes_per_value) == 0);
+        }
+        for (std::size_t i = num_values * bytes_per_value; i < memory.size(); ++i) {
+            REQUIRE(memory[i] == 0xAA);
+        }
+    }
+}
+
+// Microbenchmarks, run them with the [benchmark] tag
+template <typename Func>
+static double MeasureMegapixels(std::size_t pixels_per_call, Func&& func) {
+    constexpr int iterations = 200;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return pixels_per_call * iterations / elapsed.count() / 1e6;
+}
+
+TEST_CASE("PixelConvert: Benchmark", "[.][benchmark]") {
+    // A 400x240 top screen framebuffer
+    constexpr std::size_t pixels = 400 * 240;
+    std::vector<u8> src = RandomBytes(pixels * 4);
+    std::vector<u8> rgba(pixels * 4);
+    std::vector<u8> dst(pixels * 4);
+
+    for (PixelFormat format : all_formats) {
+        const double decode = MeasureMegapixels(pixels, [&] {
+            GPU::PixelConvert::DecodeRow(format, src.data(), rgba.data(), pixels);
+        });
+        const double encode = MeasureMegapixels(pixels, [&] {
+            GPU::PixelConvert::EncodeRow(format, rgba.data(), dst.data(), pixels);
+        });
+        WARN("Format " << static_cast<u32>(format) << ": decode " << decode << " MP/s, encode "
+                       << encode << " MP/s");
+    }
+
+    const double scale_x = MeasureMegapixels(pixels / 2, [&] {
+        GPU::PixelConvert::DownscaleRowX(src.data(), dst.data(), pixels / 2);
+    });
+    const double scale_xy = MeasureMegapixels(pixels / 4, [&] {
+        GPU::PixelConvert::DownscaleRowXY(src.data(), src.data() + pixels * 2, dst.data(),
+                                          pixels / 4);
+    });
+    WARN("Downscale X " << scale_x << " MP/s, XY " << scale_xy << " MP/s");
+
+    const double fill = MeasureMegapixels(pixels, [&] {
+        GPU::PixelConvert::Fill(dst.data(), dst.data() + pixels * 3, 0x123456, 3);
+    });
+    WARN("Fill 24-bit " << fill << " MP/s");
+}
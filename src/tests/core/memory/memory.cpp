@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <vector>
 #include <catch2/catch.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -54,3 +56,62 @@ TEST_CASE("Memory::IsValidVirtualAddress", "[core][memory]") {
         CHECK(Memory::IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("Memory::RamSnapshot", "[core][memory]") {
+    Memory::MemorySystem memory;
+    u8* fcram = memory.GetFCRAMPointer(0);
+    std::memset(fcram, 0x11, 3 * Memory::PAGE_SIZE);
+    const auto full = memory.TakeSnapshot();
+    CHECK(full->GetCapturedPages() == (Memory::FCRAM_N3DS_SIZE + Memory::VRAM_SIZE +
+                                       Memory::N3DS_EXTRA_RAM_SIZE) /
+                                          Memory::PAGE_SIZE);
+
+    fcram[Memory::PAGE_SIZE + 5] = 0x22;
+    const auto incremental = memory.TakeSnapshot(full.get());
+    CHECK(incremental->GetCapturedPages() == 1);
+
+    std::memset(fcram, 0x33, 3 * Memory::PAGE_SIZE);
+    memory.RestoreSnapshot(*incremental);
+    CHECK(fcram[0] == 0x11);
+    CHECK(fcram[Memory::PAGE_SIZE + 5] == 0x22);
+    CHECK(fcram[2 * Memory::PAGE_SIZE] == 0x11);
+
+    memory.RestoreSnapshot(*full);
+    CHECK(fcram[Memory::PAGE_SIZE + 5] == 0x11);
+}
+
+TEST_CASE("Memory::ReadBlock/WriteBlock across spans", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel(memory, timing, [] {}, 0, 1, 0);
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    u8* fcram = memory.GetFCRAMPointer(0);
+    constexpr u32 page = Memory::PAGE_SIZE;
+
+    // Two contiguous pages, then a page whose backing memory lies elsewhere, then a hole
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(Memory::HEAP_VADDR, fcram, 2 * page, Kernel::MemoryState::Private)
+                .Succeeded());
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(Memory::HEAP_VADDR + 2 * page, fcram + 8 * page, page,
+                                  Kernel::MemoryState::Private)
+                .Succeeded());
+
+    std::vector<u8> data(3 * page);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+    memory.WriteBlock(*process, Memory::HEAP_VADDR + 16, data.data(), data.size() - 32);
+    CHECK(std::memcmp(fcram + 16, data.data(), 2 * page - 16) == 0);
+    CHECK(std::memcmp(fcram + 8 * page, data.data() + 2 * page - 16, page - 16) == 0);
+
+    std::vector<u8> read(4 * page, 0xFF);
+    memory.ReadBlock(*process, Memory::HEAP_VADDR + 16, read.data(), read.size());
+    CHECK(std::memcmp(read.data(), data.data(), data.size() - 32) == 0);
+    // The unmapped page reads as zeroes
+    CHECK(read[3 * page] == 0);
+    CHECK(read[4 * page - 1] == 0);
+
+    memory.CopyBlock(*process, Memory::HEAP_VADDR, Memory::HEAP_VADDR + 2 * page, page);
+    CHECK(std::memcmp(fcram, fcram + 8 * page, page) == 0);
+}
@@ -44,6 +44,32 @@ TEST_CASE("Memory Basics", "[kernel][memory]") {
         CHECK(vma->second.backing_memory.GetPtr() == nullptr);
     }
 
+    SECTION("finding a free range") {
+        // Because of the PageTable, Kernel::VMManager is too big to be created on the stack.
+        auto manager = std::make_unique<Kernel::VMManager>(memory);
+        auto result = manager->MapBackingMemory(Memory::HEAP_VADDR + Memory::PAGE_SIZE, block,
+                                                block.GetSize(), Kernel::MemoryState::Private);
+        REQUIRE(result.Code() == RESULT_SUCCESS);
+
+        // The page left before the mapping is too small, the range goes after it
+        auto range = manager->FindFreeRange(Memory::HEAP_VADDR, Memory::HEAP_SIZE,
+                                            2 * Memory::PAGE_SIZE);
+        REQUIRE(range.Succeeded());
+        CHECK(*range == Memory::HEAP_VADDR + Memory::PAGE_SIZE + block.GetSize());
+
+        range = manager->FindFreeRange(Memory::HEAP_VADDR, Memory::PAGE_SIZE, Memory::PAGE_SIZE);
+        REQUIRE(range.Succeeded());
+        CHECK(*range == Memory::HEAP_VADDR);
+
+        range = manager->FindFreeRange(Memory::HEAP_VADDR, 2 * Memory::PAGE_SIZE,
+                                       2 * Memory::PAGE_SIZE);
+        CHECK(range.Failed());
+
+        ResultCode code = manager->UnmapRange(Memory::HEAP_VADDR + Memory::PAGE_SIZE,
+                                              block.GetSize());
+        REQUIRE(code == RESULT_SUCCESS);
+    }
+
     SECTION("changing memory permissions") {
         // Because of the PageTable, Kernel::VMManager is too big to be created on the stack.
         auto manager = std::make_unique<Kernel::VMManager>(memory);
@@ -0,0 +1,31 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/settings.h"
+
+namespace Settings {
+
+TEST_CASE("SetLLEFastPaths parses service and command pairs", "[core][settings]") {
+    SetLLEFastPaths(" cfg:u/0x00010082, cfg:u/00020000 ,fs:USER/0x080201C2, cfg:u/0x00010082");
+    REQUIRE(values.lle_fast_paths.size() == 2);
+    REQUIRE(values.lle_fast_paths["cfg:u"] == std::vector<u32>{0x00010082, 0x00020000});
+    REQUIRE(values.lle_fast_paths["fs:USER"] == std::vector<u32>{0x080201C2});
+    REQUIRE(GetLLEFastPaths() == "cfg:u/0x00010082, cfg:u/0x00020000, fs:USER/0x080201c2");
+
+    // What it prints reads back the same
+    const std::string fast_paths = GetLLEFastPaths();
+    SetLLEFastPaths(fast_paths);
+    REQUIRE(GetLLEFastPaths() == fast_paths);
+
+    // Malformed entries are dropped, the others are kept
+    SetLLEFastPaths("cfg:u, /0x1, cfg:u/, cfg:u/0x12zz, ptm:u/0x00050000");
+    REQUIRE(values.lle_fast_paths.size() == 1);
+    REQUIRE(values.lle_fast_paths["ptm:u"] == std::vector<u32>{0x00050000});
+
+    SetLLEFastPaths("");
+    REQUIRE(values.lle_fast_paths.empty());
+}
+
+} // namespace Settings
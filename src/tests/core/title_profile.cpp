@@ -0,0 +1,49 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "core/title_profile.h"
+
+namespace Core {
+
+TEST_CASE("ParseTitleProfiles", "[core]") {
+    const std::string text = R"(
+[0004000000068B00, 0004000000061300]
+# A comment
+display_transfer_hack = on
+skip_slow_draw = interpreter
+
+[0004000000061300]
+display_transfer_hack = OFF
+y2r_perform_hack = auto
+new_3ds = auto
+unknown_setting = on
+)";
+
+    SECTION("later entries take precedence") {
+        TitleProfile profile;
+        ParseTitleProfiles(text, 0x0004000000061300, profile);
+        REQUIRE(profile.Get(ProfileSetting::DisplayTransferHack) == ProfileValue::Off);
+        REQUIRE(profile.Get(ProfileSetting::SkipSlowDraw) == ProfileValue::Interpreter);
+        REQUIRE(profile.Get(ProfileSetting::Y2RPerformHack) == ProfileValue::Auto);
+        // Only read when the system is created
+        REQUIRE(profile.Get(ProfileSetting::New3DS) == ProfileValue::Unset);
+        REQUIRE(profile.HasAutoSettings());
+    }
+
+    SECTION("other titles are left out") {
+        TitleProfile profile;
+        ParseTitleProfiles(text, 0x0004000000068B00, profile);
+        REQUIRE(profile.Get(ProfileSetting::DisplayTransferHack) == ProfileValue::On);
+        REQUIRE(profile.Get(ProfileSetting::Y2RPerformHack) == ProfileValue::Unset);
+        REQUIRE(!profile.HasAutoSettings());
+
+        TitleProfile unlisted;
+        ParseTitleProfiles(text, 0x0004000000000100, unlisted);
+        REQUIRE(!unlisted.HasAutoSettings());
+        REQUIRE(unlisted.Get(ProfileSetting::DisplayTransferHack) == ProfileValue::Unset);
+    }
+}
+
+} // namespace Core
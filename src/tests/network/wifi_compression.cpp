@@ -0,0 +1,48 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "network/wifi_compression.h"
+
+namespace Network {
+
+TEST_CASE("WifiCompression: redundant frames round-trip", "[network]") {
+    std::vector<u8> frame(1024);
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<u8>(i % 24);
+    }
+
+    const auto compressed = CompressWifiData(frame);
+    REQUIRE(compressed);
+    REQUIRE(compressed->size() < frame.size() / 2);
+
+    const auto decompressed = DecompressWifiData(*compressed, static_cast<u32>(frame.size()));
+    REQUIRE(decompressed);
+    REQUIRE(*decompressed == frame);
+}
+
+TEST_CASE("WifiCompression: small and random frames stay uncompressed", "[network]") {
+    REQUIRE(!CompressWifiData(std::vector<u8>(MinCompressedWifiFrameSize - 1)));
+
+    std::vector<u8> frame(512);
+    u64 generator = 2654435761U;
+    for (u8& byte : frame) {
+        byte = static_cast<u8>(generator >> 56);
+        generator *= 11400714785074694797ULL;
+    }
+    REQUIRE(!CompressWifiData(frame));
+}
+
+TEST_CASE("WifiCompression: a wrong size is rejected", "[network]") {
+    const std::vector<u8> frame(256, 0x42);
+    const auto compressed = CompressWifiData(frame);
+    REQUIRE(compressed);
+
+    REQUIRE(!DecompressWifiData(*compressed, static_cast<u32>(frame.size()) + 1));
+    REQUIRE(!DecompressWifiData(*compressed, static_cast<u32>(frame.size()) - 1));
+    REQUIRE(!DecompressWifiData(*compressed, MaxWifiFrameSize + 1));
+}
+
+} // namespace Network
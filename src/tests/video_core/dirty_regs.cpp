@@ -0,0 +1,40 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/dirty_regs.h"
+
+namespace Pica {
+
+TEST_CASE("DirtyRegs::ForEachAndClear", "[video_core]") {
+    DirtyRegs dirty;
+    dirty.Set(PICA_REG_INDEX(rasterizer.cull_mode));
+    dirty.Set(PICA_REG_INDEX(texturing.tev_stage5.const_r));
+    dirty.Set(PICA_REG_INDEX(texturing.tev_stage0.color_op));
+    dirty.Set(PICA_REG_INDEX(texturing.fog_color));
+    dirty.Set(PICA_REG_INDEX(lighting.global_ambient));
+
+    const auto tev = DirtyRegs::GetMask({DirtyRegGroup::Tev});
+    std::vector<u32> ids;
+    dirty.ForEachAndClear(tev, [&ids](u32 id) { ids.push_back(id); });
+    REQUIRE(ids == std::vector<u32>{PICA_REG_INDEX(texturing.tev_stage0.color_op),
+                                    PICA_REG_INDEX(texturing.tev_stage5.const_r)});
+    REQUIRE(!dirty.Any(tev));
+
+    const auto others = DirtyRegs::GetMask(
+        {DirtyRegGroup::Rasterizer, DirtyRegGroup::Fog, DirtyRegGroup::Lighting});
+    REQUIRE(dirty.Any(others));
+    ids.clear();
+    dirty.ForEachAndClear(others, [&ids](u32 id) { ids.push_back(id); });
+    REQUIRE(ids == std::vector<u32>{PICA_REG_INDEX(rasterizer.cull_mode),
+                                    PICA_REG_INDEX(texturing.fog_color),
+                                    PICA_REG_INDEX(lighting.global_ambient)});
+    REQUIRE(!dirty.Any(others));
+
+    dirty.SetAll();
+    REQUIRE(dirty.Any(DirtyRegs::GetMask({DirtyRegGroup::VS})));
+}
+
+} // namespace Pica
@@ -0,0 +1,143 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/vector_math.h"
+#include "video_core/pica_types.h"
+
+namespace Pica {
+
+using Vec4f24 = Common::Vec4<float24>;
+
+static u32 ToBits(float24 value) {
+    const float f = value.ToFloat32();
+    u32 bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static bool BitwiseEqual(const Vec4f24& a, const Vec4f24& b) {
+    for (std::size_t i = 0; i < 4; ++i) {
+        // All NaNs look alike to the PICA, the payload is not compared
+        if (std::isnan(a[i].ToFloat32()) && std::isnan(b[i].ToFloat32())) {
+            continue;
+        }
+        if (ToBits(a[i]) != ToBits(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<Vec4f24> SpecialVectors() {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<float> values{0.f, -0.f, 1.f, -1.5f, 3.25e7f, -2.5e-7f, inf, -inf, nan};
+
+    std::vector<Vec4f24> vectors;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        for (std::size_t j = 0; j < values.size(); ++j) {
+            vectors.push_back({float24::FromFloat32(values[i]), float24::FromFloat32(values[j]),
+                               float24::FromFloat32(values[(i + j) % values.size()]),
+                               float24::FromFloat32(values[(i * 3 + j) % values.size()])});
+        }
+    }
+    return vectors;
+}
+
+TEST_CASE("Vec4<float24> arithmetic matches the scalar operators", "[video_core][pica_types]") {
+    const auto vectors = SpecialVectors();
+    for (const auto& a : vectors) {
+        for (const auto& b : vectors) {
+            INFO("a = (" << a.x.ToFloat32() << ", " << a.y.ToFloat32() << ", " << a.z.ToFloat32()
+                         << ", " << a.w.ToFloat32() << "), b = (" << b.x.ToFloat32() << ", "
+                         << b.y.ToFloat32() << ", " << b.z.ToFloat32() << ", " << b.w.ToFloat32()
+                         << ")");
+
+            REQUIRE(BitwiseEqual(a + b, {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w}));
+            REQUIRE(BitwiseEqual(a - b, {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w}));
+            REQUIRE(BitwiseEqual(a * b, {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w}));
+            REQUIRE(BitwiseEqual(a * b.y, {a.x * b.y, a.y * b.y, a.z * b.y, a.w * b.y}));
+
+            const float24 dot = Common::Dot(a, b);
+            const float24 expected_dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+            REQUIRE(BitwiseEqual(Vec4f24::AssignToAll(dot), Vec4f24::AssignToAll(expected_dot)));
+        }
+    }
+}
+
+TEST_CASE("Vec4<float24> min and max follow the PICA NaN semantics", "[video_core][pica_types]") {
+    const auto zero = Vec4f24::AssignToAll(float24::Zero());
+    const auto nan = Vec4f24::AssignToAll(float24::FromFloat32(std::nanf("")));
+    REQUIRE(std::isnan(Max(zero, nan).x.ToFloat32()));
+    REQUIRE(Max(nan, zero).x.ToFloat32() == 0.f);
+    REQUIRE(std::isnan(Min(zero, nan).x.ToFloat32()));
+    REQUIRE(Min(nan, zero).x.ToFloat32() == 0.f);
+
+    const auto vectors = SpecialVectors();
+    for (const auto& a : vectors) {
+        for (const auto& b : vectors) {
+            Vec4f24 expected_min, expected_max;
+            for (std::size_t i = 0; i < 4; ++i) {
+                expected_min[i] = (a[i] < b[i]) ? a[i] : b[i];
+                expected_max[i] = (a[i] > b[i]) ? a[i] : b[i];
+            }
+            REQUIRE(BitwiseEqual(Min(a, b), expected_min));
+            REQUIRE(BitwiseEqual(Max(a, b), expected_max));
+        }
+    }
+}
+
+TEST_CASE("Vec4<float24> arithmetic: Benchmark", "[.][benchmark][video_core][pica_types]") {
+    constexpr std::size_t num_vectors = 4096;
+    constexpr int num_rounds = 2000;
+
+    std::vector<Vec4f24> a(num_vectors), b(num_vectors);
+    for (std::size_t i = 0; i < num_vectors; ++i) {
+        for (std::size_t component = 0; component < 4; ++component) {
+            const float value = 0.5f + 0.25f * ((i + component) % 7);
+            a[i][component] = float24::FromFloat32(value);
+            // Keeps the repeated products from running into denormals or infinity
+            b[i][component] = float24::FromFloat32(1.f / value);
+        }
+    }
+
+    std::vector<Vec4f24> result;
+    const auto measure = [&](const char* name, auto&& op) {
+        result = a;
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < num_rounds; ++round) {
+            for (std::size_t i = 0; i < num_vectors; ++i) {
+                result[i] = op(result[i], a[i], b[i]);
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        WARN(name << ": " << num_vectors * num_rounds / elapsed.count() / 1e6 << " M vectors/s ("
+                  << result[0].x.ToFloat32() << ")");
+    };
+
+    measure("add", [](const Vec4f24& acc, const Vec4f24& x, const Vec4f24& y) {
+        return acc + x - y;
+    });
+    measure("mul", [](const Vec4f24& acc, const Vec4f24& x, const Vec4f24& y) {
+        return acc * x * y;
+    });
+    measure("dot", [](const Vec4f24& acc, const Vec4f24& x, const Vec4f24& y) {
+        return Vec4f24::AssignToAll(Common::Dot(x, y)) - acc;
+    });
+    measure("lerp", [](const Vec4f24& acc, const Vec4f24& x, const Vec4f24& y) {
+        const float24 t = float24::FromFloat32(0.25f);
+        return acc * t + x * (float24::FromFloat32(1.f) - t);
+    });
+    measure("min/max", [](const Vec4f24& acc, const Vec4f24& x, const Vec4f24& y) {
+        return Max(Min(acc, x), y);
+    });
+}
+
+} // namespace Pica
@@ -0,0 +1,27 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch.hpp>
+#include "video_core/renderer_opengl/gl_dynamic_resolution.h"
+
+namespace OpenGL {
+
+TEST_CASE("NextDynamicScale: Steps within the bounds", "[video_core][renderer_opengl]") {
+    constexpr double budget = 16e6;
+
+    // Frames over 90% of the budget step down, but not under the lower bound
+    REQUIRE(NextDynamicScale(3, 15e6, budget, 1, 4) == 2);
+    REQUIRE(NextDynamicScale(1, 30e6, budget, 1, 4) == 1);
+
+    // 2x to 3x has 2.25 times the pixels, which has to stay under 70% of the budget
+    REQUIRE(NextDynamicScale(2, 4e6, budget, 1, 4) == 3);
+    REQUIRE(NextDynamicScale(2, 6e6, budget, 1, 4) == 2);
+    REQUIRE(NextDynamicScale(4, 1e6, budget, 1, 4) == 4);
+
+    // Scales out of the bounds move into them first
+    REQUIRE(NextDynamicScale(6, 8e6, budget, 1, 4) == 4);
+    REQUIRE(NextDynamicScale(1, 12e6, budget, 2, 4) == 2);
+}
+
+} // namespace OpenGL
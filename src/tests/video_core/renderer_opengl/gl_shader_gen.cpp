@@ -0,0 +1,148 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/renderer_opengl/gl_shader_gen.h"
+
+namespace OpenGL {
+
+using Pica::FramebufferRegs;
+using Pica::LightingRegs;
+using Pica::RasterizerRegs;
+using Pica::TexturingRegs;
+using TevStageConfig = TexturingRegs::TevStageConfig;
+
+/// Pseudo-random generator, the configs are the same on every run
+class ConfigGenerator {
+public:
+    PicaFSConfig Next() {
+        PicaFSConfig config;
+        std::memset(&config, 0, sizeof(config));
+        auto& state = config.state;
+
+        state.logic_op = FramebufferRegs::LogicOp::Copy;
+        state.alpha_test_func = static_cast<FramebufferRegs::CompareFunc>(1 + Random(7));
+        state.scissor_test_mode = Random(4) == 0 ? RasterizerRegs::ScissorMode::Exclude
+                                                 : RasterizerRegs::ScissorMode::Disabled;
+        state.texture0_type = Random(4) == 0 ? TexturingRegs::TextureConfig::Projection2D
+                                             : TexturingRegs::TextureConfig::Texture2D;
+        state.texture2_use_coord1 = Random(2) != 0;
+        state.combiner_buffer_input = static_cast<u8>(Random(256));
+        state.depthmap_enable = Random(2) != 0 ? RasterizerRegs::DepthBuffering::ZBuffering
+                                               : RasterizerRegs::DepthBuffering::WBuffering;
+        state.fog_mode =
+            Random(4) == 0 ? TexturingRegs::FogMode::Fog : TexturingRegs::FogMode::None;
+        state.fog_flip = Random(2) != 0;
+
+        for (auto& raw_stage : state.tev_stages) {
+            TevStageConfig stage{};
+            stage.color_source1.Assign(RandomSource());
+            stage.color_source2.Assign(RandomSource());
+            stage.color_source3.Assign(RandomSource());
+            stage.alpha_source1.Assign(RandomSource());
+            stage.alpha_source2.Assign(RandomSource());
+            stage.alpha_source3.Assign(RandomSource());
+            stage.color_modifier1.Assign(RandomColorModifier());
+            stage.color_modifier2.Assign(RandomColorModifier());
+            stage.color_modifier3.Assign(RandomColorModifier());
+            stage.alpha_modifier1.Assign(static_cast<TevStageConfig::AlphaModifier>(Random(8)));
+            stage.alpha_modifier2.Assign(static_cast<TevStageConfig::AlphaModifier>(Random(8)));
+            stage.alpha_modifier3.Assign(static_cast<TevStageConfig::AlphaModifier>(Random(8)));
+            stage.color_op.Assign(static_cast<TevStageConfig::Operation>(Random(10)));
+            // Dot3 operations don't apply to alpha
+            stage.alpha_op.Assign(static_cast<TevStageConfig::Operation>(Random(6)));
+            stage.color_scale.Assign(Random(3));
+            stage.alpha_scale.Assign(Random(3));
+            raw_stage = {stage.sources_raw, stage.modifiers_raw, stage.ops_raw, stage.scales_raw};
+        }
+
+        auto& lighting = state.lighting;
+        lighting.enable = Random(2) != 0;
+        if (lighting.enable) {
+            lighting.src_num = 1 + Random(4);
+            for (u32 i = 0; i < lighting.src_num; ++i) {
+                auto& light = lighting.light[i];
+                light.num = i;
+                light.directional = Random(2) != 0;
+                light.two_sided_diffuse = Random(2) != 0;
+                light.dist_atten_enable = Random(2) != 0;
+                light.geometric_factor_0 = Random(2) != 0;
+            }
+            lighting.config = LightingRegs::LightingConfig::Config0;
+            lighting.clamp_highlights = Random(2) != 0;
+            lighting.lut_d0.enable = Random(2) != 0;
+            lighting.lut_d0.type = static_cast<LightingRegs::LightingLutInput>(Random(3));
+            lighting.lut_rr.enable = Random(2) != 0;
+        }
+        return config;
+    }
+
+private:
+    u32 Random(u32 range) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<u32>(seed >> 33) % range;
+    }
+
+    TevStageConfig::Source RandomSource() {
+        static constexpr std::array<TevStageConfig::Source, 10> sources{
+            TevStageConfig::Source::PrimaryColor,
+            TevStageConfig::Source::PrimaryFragmentColor,
+            TevStageConfig::Source::SecondaryFragmentColor,
+            TevStageConfig::Source::Texture0,
+            TevStageConfig::Source::Texture1,
+            TevStageConfig::Source::Texture2,
+            TevStageConfig::Source::PreviousBuffer,
+            TevStageConfig::Source::Constant,
+            TevStageConfig::Source::Previous,
+            TevStageConfig::Source::Previous,
+        };
+        return sources[Random(sources.size())];
+    }
+
+    TevStageConfig::ColorModifier RandomColorModifier() {
+        static constexpr std::array<u32, 10> modifiers{0x0, 0x1, 0x2, 0x3, 0x4,
+                                                       0x5, 0x8, 0x9, 0xc, 0xd};
+        return static_cast<TevStageConfig::ColorModifier>(modifiers[Random(modifiers.size())]);
+    }
+
+    u64 seed = 0x853C49E6748FEA9BULL;
+};
+
+TEST_CASE("GenerateFragmentShader: Reused buffers don't change the output", "[video_core]") {
+    ConfigGenerator generator;
+    const PicaFSConfig first = generator.Next();
+    const std::string expected = GenerateFragmentShader(first, false);
+    REQUIRE(expected.find("void main()") != std::string::npos);
+
+    for (int i = 0; i < 16; ++i) {
+        GenerateFragmentShader(generator.Next(), false);
+    }
+    REQUIRE(GenerateFragmentShader(first, false) == expected);
+}
+
+// Microbenchmark, run it with the [benchmark] tag
+TEST_CASE("GenerateFragmentShader: Benchmark", "[.][benchmark]") {
+    ConfigGenerator generator;
+    std::vector<PicaFSConfig> configs;
+    for (int i = 0; i < 4096; ++i) {
+        configs.push_back(generator.Next());
+    }
+
+    std::size_t bytes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& config : configs) {
+        bytes += GenerateFragmentShader(config, false).size();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(bytes != 0);
+    WARN(configs.size() << " fragment shaders in " << elapsed.count() * 1000.0 << " ms, "
+                        << bytes / configs.size() << " bytes each");
+}
+
+} // namespace OpenGL
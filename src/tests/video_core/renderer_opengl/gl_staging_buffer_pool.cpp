@@ -0,0 +1,71 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include <catch2/catch.hpp>
+#include "video_core/renderer_opengl/gl_staging_buffer_pool.h"
+
+namespace OpenGL {
+
+TEST_CASE("StagingBufferPool: Returned buffers are reused", "[video_core][renderer_opengl]") {
+    StagingBufferPool pool;
+    auto buffer = pool.Acquire(0x1000);
+    REQUIRE(!buffer.empty());
+    REQUIRE(buffer.size() == 0x1000);
+    REQUIRE(pool.GetPooledBytes() == 0);
+
+    const u8* const memory = buffer.data();
+    buffer.Release();
+    REQUIRE(buffer.empty());
+    REQUIRE(pool.GetPooledBytes() >= 0x1000);
+
+    // A smaller request fits in the returned memory
+    auto smaller = pool.Acquire(0x800);
+    REQUIRE(smaller.data() == memory);
+    REQUIRE(smaller.size() == 0x800);
+    REQUIRE(pool.GetPooledBytes() == 0);
+
+    // Moved buffers go back once, from their last owner
+    StagingBufferPool::Buffer moved = std::move(smaller);
+    REQUIRE(smaller.empty());
+    REQUIRE(pool.GetPooledBytes() == 0);
+    moved = {};
+    REQUIRE(pool.GetPooledBytes() >= 0x1000);
+}
+
+TEST_CASE("StagingBufferPool: Picks the smallest buffer that fits", "[video_core][renderer_opengl]") {
+    StagingBufferPool pool;
+    auto large = pool.Acquire(0x10000);
+    auto small = pool.Acquire(0x2000);
+    const u8* const small_memory = small.data();
+    large.Release();
+    small.Release();
+
+    auto buffer = pool.Acquire(0x1000);
+    REQUIRE(buffer.data() == small_memory);
+}
+
+TEST_CASE("StagingBufferPool: Frees idle and excess buffers", "[video_core][renderer_opengl]") {
+    StagingBufferPool pool;
+    pool.Acquire(0x1000);
+    REQUIRE(pool.GetPooledBytes() >= 0x1000);
+
+    for (u32 frame = 0; frame < StagingBufferPool::MAX_IDLE_FRAMES; ++frame) {
+        pool.EndFrame();
+    }
+    REQUIRE(pool.GetPooledBytes() >= 0x1000);
+    pool.EndFrame();
+    REQUIRE(pool.GetPooledBytes() == 0);
+
+    // Over the limit the largest buffers go first
+    auto huge = pool.Acquire(StagingBufferPool::MAX_POOLED_BYTES);
+    auto small = pool.Acquire(0x1000);
+    huge.Release();
+    small.Release();
+    pool.EndFrame();
+    REQUIRE(pool.GetPooledBytes() >= 0x1000);
+    REQUIRE(pool.GetPooledBytes() < StagingBufferPool::MAX_POOLED_BYTES);
+}
+
+} // namespace OpenGL
@@ -0,0 +1,79 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "video_core/renderer_opengl/gl_surface_trace.h"
+
+namespace OpenGL {
+
+TEST_CASE("SurfaceTraceRecorder: Records the outermost calls", "[video_core][renderer_opengl]") {
+    const std::string path = FileUtil::GetCurrentDir().value_or(".") + "/surface_trace_test.bin";
+
+    SurfaceParams params;
+    params.addr = 0x18000000;
+    params.width = 400;
+    params.height = 240;
+    params.is_tiled = true;
+    params.res_scale = 2;
+    params.pixel_format = SurfaceParams::PixelFormat::RGBA8;
+    params.UpdateParams();
+
+    Pica::Texture::TextureInfo info;
+    info.physical_address = 0x18100000;
+    info.width = 128;
+    info.height = 64;
+    info.format = Pica::TexturingRegs::TextureFormat::ETC1;
+    info.SetDefaultStride();
+
+    {
+        SurfaceTraceRecorder recorder(path);
+        REQUIRE(recorder.IsOpen());
+
+        SurfaceTraceRecorder::Scope outer(&recorder);
+        REQUIRE(outer.IsOutermost());
+        recorder.Record(SurfaceTraceEntry::SurfaceLookup(SurfaceTraceOp::GetSurfaceSubRect, params,
+                                                         2, true));
+        {
+            // A lookup of the recorded call, replaying the call makes it again
+            SurfaceTraceRecorder::Scope inner(&recorder);
+            REQUIRE(!inner.IsOutermost());
+        }
+        recorder.Record(SurfaceTraceEntry::TextureLookup(info, 3));
+        recorder.Record(SurfaceTraceEntry::Region(SurfaceTraceOp::InvalidateRegion, 0x18000100,
+                                                  0x40, &params));
+    }
+
+    const std::vector<SurfaceTraceEntry> entries = LoadSurfaceTrace(path);
+    FileUtil::Delete(path);
+    REQUIRE(entries.size() == 3);
+
+    REQUIRE(entries[0].op == SurfaceTraceOp::GetSurfaceSubRect);
+    REQUIRE(entries[0].match_res_scale == 2);
+    REQUIRE(entries[0].flag == 1);
+    const SurfaceParams loaded = entries[0].GetSurfaceParams();
+    REQUIRE(loaded.addr == params.addr);
+    REQUIRE(loaded.end == params.end);
+    REQUIRE(loaded.stride == params.stride);
+    REQUIRE(loaded.res_scale == params.res_scale);
+    REQUIRE(loaded.pixel_format == params.pixel_format);
+    REQUIRE(loaded.type == params.type);
+
+    REQUIRE(entries[1].op == SurfaceTraceOp::GetTextureSurface);
+    REQUIRE(entries[1].max_level == 3);
+    const Pica::Texture::TextureInfo loaded_info = entries[1].GetTextureInfo();
+    REQUIRE(loaded_info.physical_address == info.physical_address);
+    REQUIRE(loaded_info.stride == info.stride);
+    REQUIRE(loaded_info.format == info.format);
+
+    REQUIRE(entries[2].op == SurfaceTraceOp::InvalidateRegion);
+    REQUIRE(entries[2].flag == 1);
+    REQUIRE(entries[2].region_addr == 0x18000100);
+    REQUIRE(entries[2].region_size == 0x40);
+    REQUIRE(entries[2].GetSurfaceParams().addr == params.addr);
+}
+
+} // namespace OpenGL
@@ -0,0 +1,231 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
+#if defined(ARCHITECTURE_x86_64)
+#include "video_core/shader/shader_jit_x64.h"
+#elif defined(ARCHITECTURE_ARM64)
+#include "video_core/shader/shader_jit_a64.h"
+#endif
+
+namespace Pica::Shader {
+
+using float24 = Pica::float24;
+using DestRegister = nihstro::DestRegister;
+using InlineAsm = nihstro::InlineAsm;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+#if defined(ARCHITECTURE_x86_64)
+using JitEngine = JitX64Engine;
+#elif defined(ARCHITECTURE_ARM64)
+using JitEngine = JitA64Engine;
+#endif
+
+/// Writes the component of the mask with one row of a matrix times the source
+static InlineAsm Dp4Row(DestRegister dest, const char* mask, SourceRegister src,
+                        SourceRegister row) {
+    constexpr auto addressing = InlineAsm::RelativeAddress::None;
+    return {OpCode::Id::DP4, dest, mask, src, "xyzw", row, "xyzw", addressing};
+}
+
+static std::unique_ptr<ShaderSetup> MakeShaderSetup(std::initializer_list<InlineAsm> code) {
+    const auto shbin = InlineAsm::CompileToRawBinary(code);
+
+    auto setup = std::make_unique<ShaderSetup>();
+    std::transform(shbin.program.begin(), shbin.program.end(), setup->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   setup->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    setup->MarkProgramCodeDirty();
+    setup->MarkSwizzleDataDirty();
+
+    for (u32 i = 0; i < 17; ++i) {
+        for (u32 component = 0; component < 4; ++component) {
+            // Small positive values, so that the lighting doesn't take the logarithm of zero
+            setup->uniforms.f[i][component] =
+                float24::FromFloat32(0.25f + 0.125f * ((i + component) % 5));
+        }
+    }
+    return setup;
+}
+
+/// Representative vertex programs of the titles, with the vertex attributes and uniforms they read
+struct BenchmarkProgram {
+    std::string name;
+    std::unique_ptr<ShaderSetup> setup;
+};
+
+static std::vector<BenchmarkProgram> GetBenchmarkPrograms() {
+    const auto v0 = SourceRegister::MakeInput(0);
+    const auto v1 = SourceRegister::MakeInput(1);
+    const auto v2 = SourceRegister::MakeInput(2);
+    const auto v3 = SourceRegister::MakeInput(3);
+    const auto o0 = DestRegister::MakeOutput(0);
+    const auto o1 = DestRegister::MakeOutput(1);
+    const auto r0 = DestRegister::MakeTemporary(0);
+    const auto r1 = DestRegister::MakeTemporary(1);
+    const auto r2 = DestRegister::MakeTemporary(2);
+    const auto r3 = DestRegister::MakeTemporary(3);
+    const auto sr0 = SourceRegister::MakeTemporary(0);
+    const auto sr1 = SourceRegister::MakeTemporary(1);
+    const auto sr2 = SourceRegister::MakeTemporary(2);
+    const auto sr3 = SourceRegister::MakeTemporary(3);
+    const auto c = [](u32 index) { return SourceRegister::MakeFloat(index); };
+    std::vector<BenchmarkProgram> programs;
+
+    // clang-format off
+    // The position times the model view projection matrix in c0-c3, and the color passed through
+    programs.push_back({"Transform", MakeShaderSetup({
+        Dp4Row(o0, "x", v0, c(0)),
+        Dp4Row(o0, "y", v0, c(1)),
+        Dp4Row(o0, "z", v0, c(2)),
+        Dp4Row(o0, "w", v0, c(3)),
+        {OpCode::Id::MOV, o1, v1},
+        {OpCode::Id::END},
+    })});
+
+    // Two bones of c4-c11 blended by the weights in v2 and v3, then projected
+    programs.push_back({"Skinning", MakeShaderSetup({
+        Dp4Row(r0, "x", v0, c(4)),
+        Dp4Row(r0, "y", v0, c(5)),
+        Dp4Row(r0, "z", v0, c(6)),
+        Dp4Row(r0, "w", v0, c(7)),
+        Dp4Row(r1, "x", v0, c(8)),
+        Dp4Row(r1, "y", v0, c(9)),
+        Dp4Row(r1, "z", v0, c(10)),
+        Dp4Row(r1, "w", v0, c(11)),
+        {OpCode::Id::MUL, r0, sr0, v2},
+        {OpCode::Id::MAD, r0, sr1, v3, sr0},
+        Dp4Row(o0, "x", sr0, c(0)),
+        Dp4Row(o0, "y", sr0, c(1)),
+        Dp4Row(o0, "z", sr0, c(2)),
+        Dp4Row(o0, "w", sr0, c(3)),
+        {OpCode::Id::MOV, o1, v1},
+        {OpCode::Id::END},
+    })});
+
+    // A directional light with a specular highlight on the normal in v1: c12 is the direction,
+    // c13 zero, c14 the diffuse color, c15 the shininess and c16 the specular color
+    programs.push_back({"Lighting", MakeShaderSetup({
+        Dp4Row(o0, "x", v0, c(0)),
+        Dp4Row(o0, "y", v0, c(1)),
+        Dp4Row(o0, "z", v0, c(2)),
+        Dp4Row(o0, "w", v0, c(3)),
+        {OpCode::Id::DP3, r0, v1, v1},
+        {OpCode::Id::RSQ, r0, sr0},
+        {OpCode::Id::MUL, r1, v1, sr0},
+        {OpCode::Id::DP3, r2, sr1, c(12)},
+        {OpCode::Id::MAX, r2, sr2, c(13)},
+        {OpCode::Id::MUL, r3, sr2, c(14)},
+        {OpCode::Id::LG2, r2, sr2},
+        {OpCode::Id::MUL, r2, sr2, c(15)},
+        {OpCode::Id::EX2, r2, sr2},
+        {OpCode::Id::MAD, o1, sr2, c(16), sr3},
+        {OpCode::Id::END},
+    })});
+
+    // The arithmetic mix of the JIT tests
+    programs.push_back({"Arithmetic", MakeShaderSetup({
+        {OpCode::Id::DP4, o0, v0, v1},
+        {OpCode::Id::DP3, o0, v1, v2},
+        {OpCode::Id::MUL, o0, v0, v2},
+        {OpCode::Id::MAD, o0, v0, v1, v2},
+        {OpCode::Id::DP4, o0, v2, v0},
+        {OpCode::Id::MAD, o0, v2, v0, v1},
+        {OpCode::Id::END},
+    })});
+    // clang-format on
+
+    return programs;
+}
+
+/// A batch of vertices at different positions, with a normal and the bone weights
+static std::vector<UnitState> MakeVertices(std::size_t count) {
+    std::vector<UnitState> vertices(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (u32 attribute = 0; attribute < 4; ++attribute) {
+            for (u32 component = 0; component < 4; ++component) {
+                const float value = 0.5f + static_cast<float>((i * 7 + attribute + component) % 13);
+                vertices[i].registers.input[attribute][component] = float24::FromFloat32(value);
+            }
+        }
+    }
+    return vertices;
+}
+
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+TEST_CASE("Benchmark programs: JIT matches the interpreter", "[video_core][shader][shader_jit]") {
+    for (const BenchmarkProgram& program : GetBenchmarkPrograms()) {
+        INFO("Program " << program.name);
+        ShaderSetup& setup = *program.setup;
+        std::vector<UnitState> expected = MakeVertices(16);
+        std::vector<UnitState> actual = MakeVertices(16);
+
+        InterpreterEngine interpreter;
+        interpreter.SetupBatch(setup, 0);
+        interpreter.RunBatch(setup, expected.data(), expected.size());
+        JitEngine jit;
+        jit.SetupBatch(setup, 0);
+        jit.RunBatch(setup, actual.data(), actual.size());
+
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            for (u32 output = 0; output < 2; ++output) {
+                for (u32 component = 0; component < 4; ++component) {
+                    REQUIRE(actual[i].registers.output[output][component].ToFloat32() ==
+                            Approx(expected[i].registers.output[output][component].ToFloat32()));
+                }
+            }
+        }
+    }
+}
+#endif
+
+/// Runs the engine over the batch until a few million vertices went through, in vertices/second
+static double MeasureVerticesPerSecond(ShaderEngine& engine, ShaderSetup& setup,
+                                       std::vector<UnitState>& vertices, std::size_t total) {
+    engine.SetupBatch(setup, 0);
+    // Warms up the caches and compiles the JIT program outside of the measurement
+    engine.RunBatch(setup, vertices.data(), vertices.size());
+
+    const std::size_t passes = std::max<std::size_t>(1, total / vertices.size());
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t pass = 0; pass < passes; ++pass) {
+        engine.RunBatch(setup, vertices.data(), vertices.size());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return passes * vertices.size() / elapsed.count();
+}
+
+// Throughput of the engines, run it with the [benchmark] tag to compare code generation changes
+TEST_CASE("Shader engines: Benchmark", "[.][benchmark][video_core][shader]") {
+    constexpr std::size_t batch_size = 4096;
+    std::vector<UnitState> vertices = MakeVertices(batch_size);
+
+    for (const BenchmarkProgram& program : GetBenchmarkPrograms()) {
+        ShaderSetup& setup = *program.setup;
+
+        InterpreterEngine interpreter;
+        const double interpreted =
+            MeasureVerticesPerSecond(interpreter, setup, vertices, 1024 * 1024);
+        WARN(program.name << ": interpreter " << interpreted / 1e6 << " M vertices/s");
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+        JitEngine jit;
+        const double jitted = MeasureVerticesPerSecond(jit, setup, vertices, 16 * 1024 * 1024);
+        WARN(program.name << ": JIT " << jitted / 1e6 << " M vertices/s, "
+                          << jitted / interpreted << "x the interpreter");
+#endif
+    }
+}
+
+} // namespace Pica::Shader
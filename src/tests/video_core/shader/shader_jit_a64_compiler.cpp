@@ -0,0 +1,216 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/shader/shader_jit_a64_compiler.h"
+
+using float24 = Pica::float24;
+using JitShader = Pica::Shader::JitShader;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+static std::unique_ptr<JitShader> CompileShader(std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
+    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
+
+    std::transform(shbin.program.begin(), shbin.program.end(), program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+                   [](const auto& x) { return x.hex; });
+
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&program_code, &swizzle_data);
+
+    return shader;
+}
+
+class ShaderTest {
+public:
+    explicit ShaderTest(std::initializer_list<nihstro::InlineAsm> code)
+        : shader(CompileShader(code)) {}
+
+    float Run(float input) {
+        return Run({input});
+    }
+
+    /// Runs the shader with the X components of the first input registers set to `inputs`
+    float Run(std::initializer_list<float> inputs) {
+        Pica::Shader::ShaderSetup shader_setup;
+        Pica::Shader::UnitState shader_unit;
+
+        std::size_t i = 0;
+        for (float input : inputs) {
+            shader_unit.registers.input[i++].x = float24::FromFloat32(input);
+        }
+        shader->Run(shader_setup, shader_unit, 0);
+        return shader_unit.registers.output[0].x.ToFloat32();
+    }
+
+public:
+    std::unique_ptr<JitShader> shader;
+};
+
+TEST_CASE("LG2", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::LG2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(std::isnan(shader.Run(NAN)));
+    REQUIRE(std::isnan(shader.Run(-1.f)));
+    REQUIRE(std::isinf(shader.Run(0.f)));
+    REQUIRE(std::isinf(shader.Run(INFINITY)));
+    REQUIRE(shader.Run(4.f) == Approx(2.f));
+    REQUIRE(shader.Run(64.f) == Approx(6.f));
+    REQUIRE(shader.Run(1.e24f) == Approx(79.7262742773f));
+}
+
+TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::EX2, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(std::isnan(shader.Run(NAN)));
+    REQUIRE(shader.Run(-800.f) == Approx(0.f));
+    REQUIRE(shader.Run(0.f) == Approx(1.f));
+    REQUIRE(shader.Run(2.f) == Approx(4.f));
+    REQUIRE(shader.Run(6.f) == Approx(64.f));
+    REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
+    REQUIRE(std::isinf(shader.Run(800.f)));
+}
+
+TEST_CASE("MUL", "[video_core][shader][shader_jit]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MUL, sh_output, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run({2.f, 3.f}) == Approx(6.f));
+    REQUIRE(shader.Run({-2.f, 3.f}) == Approx(-6.f));
+    // PICA gives 0 instead of NaN when multiplying by inf
+    REQUIRE(shader.Run({0.f, INFINITY}) == 0.f);
+    REQUIRE(shader.Run({-INFINITY, 0.f}) == 0.f);
+    REQUIRE(std::isnan(shader.Run({NAN, 1.f})));
+    REQUIRE(std::isinf(shader.Run({INFINITY, 2.f})));
+}
+
+TEST_CASE("MAX", "[video_core][shader][shader_jit]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MAX, sh_output, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run({1.f, 2.f}) == 2.f);
+    REQUIRE(shader.Run({2.f, 1.f}) == 2.f);
+    // The second operand is picked when either of them is NaN
+    REQUIRE(shader.Run({NAN, 1.f}) == 1.f);
+    REQUIRE(std::isnan(shader.Run({1.f, NAN})));
+}
+
+TEST_CASE("RCP", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::RCP, sh_output, sh_input},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    REQUIRE(shader.Run(4.f) == Approx(0.25f));
+    REQUIRE(shader.Run(-0.5f) == Approx(-2.f));
+    REQUIRE(std::isinf(shader.Run(0.f)));
+}
+
+TEST_CASE("EMIT", "[video_core][shader][shader_jit]") {
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        // clang-format off
+        {OpCode::Id::MOV, sh_output, SourceRegister::MakeInput(0)},
+        {OpCode::Id::MOV, sh_output, SourceRegister::MakeInput(1)},
+        {OpCode::Id::MOV, sh_output, SourceRegister::MakeInput(2)},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    // The inline assembler has no syntax for the geometry shader instructions, so they are
+    // encoded by hand around the moves
+    const u32 emit = static_cast<u32>(OpCode::Id::EMIT) << 26;
+    const auto setemit = [](u32 vertex_id, bool prim_emit) {
+        return static_cast<u32>(OpCode::Id::SETEMIT) << 26 | vertex_id << 24 |
+               static_cast<u32>(prim_emit) << 23;
+    };
+
+    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
+    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
+    const std::array<u32, 10> program = {
+        // clang-format off
+        setemit(0, false), shbin.program[0].hex, emit,
+        setemit(1, false), shbin.program[1].hex, emit,
+        setemit(2, true),  shbin.program[2].hex, emit,
+        shbin.program[3].hex,
+        // clang-format on
+    };
+    std::copy(program.begin(), program.end(), program_code.begin());
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+                   [](const auto& x) { return x.hex; });
+
+    JitShader shader;
+    shader.Compile(&program_code, &swizzle_data);
+
+    Pica::ShaderRegs config{};
+    config.output_mask.Assign(1);
+
+    std::vector<float> emitted;
+    Pica::Shader::ShaderSetup shader_setup;
+    Pica::Shader::GSUnitState shader_unit;
+    shader_unit.SetVertexHandler(
+        [&](const Pica::Shader::AttributeBuffer& vertex) {
+            emitted.push_back(vertex.attr[0].x.ToFloat32());
+        },
+        [] {});
+    shader_unit.ConfigOutput(config);
+    for (u32 i = 0; i < 3; ++i) {
+        shader_unit.registers.input[i].x = float24::FromFloat32(1.f + i);
+    }
+
+    shader.Run(shader_setup, shader_unit, 0);
+
+    // Only the last SETEMIT ends a primitive, which sends the three buffered vertices
+    REQUIRE(emitted == std::vector<float>{1.f, 2.f, 3.f});
+}
@@ -3,8 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <memory>
+#include <vector>
 #include <catch2/catch.hpp>
 #include <nihstro/inline_assembly.h>
 #include "video_core/shader/shader_jit_x64_compiler.h"
@@ -89,3 +91,100 @@ TEST_CASE("EX2", "[video_core][shader][shader_jit]") {
     REQUIRE(shader.Run(79.7262742773f) == Approx(1.e24f));
     REQUIRE(std::isinf(shader.Run(800.f)));
 }
+
+TEST_CASE("EMIT", "[video_core][shader][shader_jit]") {
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        // clang-format off
+        {OpCode::Id::MOV, sh_output, SourceRegister::MakeInput(0)},
+        {OpCode::Id::MOV, sh_output, SourceRegister::MakeInput(1)},
+        {OpCode::Id::MOV, sh_output, SourceRegister::MakeInput(2)},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    // The inline assembler has no syntax for the geometry shader instructions, so they are
+    // encoded by hand around the moves
+    const u32 emit = static_cast<u32>(OpCode::Id::EMIT) << 26;
+    const auto setemit = [](u32 vertex_id, bool prim_emit) {
+        return static_cast<u32>(OpCode::Id::SETEMIT) << 26 | vertex_id << 24 |
+               static_cast<u32>(prim_emit) << 23;
+    };
+
+    std::array<u32, Pica::Shader::MAX_PROGRAM_CODE_LENGTH> program_code{};
+    std::array<u32, Pica::Shader::MAX_SWIZZLE_DATA_LENGTH> swizzle_data{};
+    const std::array<u32, 10> program = {
+        // clang-format off
+        setemit(0, false), shbin.program[0].hex, emit,
+        setemit(1, false), shbin.program[1].hex, emit,
+        setemit(2, true),  shbin.program[2].hex, emit,
+        shbin.program[3].hex,
+        // clang-format on
+    };
+    std::copy(program.begin(), program.end(), program_code.begin());
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(), swizzle_data.begin(),
+                   [](const auto& x) { return x.hex; });
+
+    JitShader shader;
+    shader.Compile(&program_code, &swizzle_data);
+
+    Pica::ShaderRegs config{};
+    config.output_mask.Assign(1);
+
+    std::vector<float> emitted;
+    Pica::Shader::ShaderSetup shader_setup;
+    Pica::Shader::GSUnitState shader_unit;
+    shader_unit.SetVertexHandler(
+        [&](const Pica::Shader::AttributeBuffer& vertex) {
+            emitted.push_back(vertex.attr[0].x.ToFloat32());
+        },
+        [] {});
+    shader_unit.ConfigOutput(config);
+    for (u32 i = 0; i < 3; ++i) {
+        shader_unit.registers.input[i].x = float24::FromFloat32(1.f + i);
+    }
+
+    shader.Run(shader_setup, shader_unit, 0);
+
+    // Only the last SETEMIT ends a primitive, which sends the three buffered vertices
+    REQUIRE(emitted == std::vector<float>{1.f, 2.f, 3.f});
+}
+
+// Microbenchmark of the arithmetic code generation, run it with the [benchmark] tag. The time per
+// vertex depends on the instruction tier picked from the host CPU features.
+TEST_CASE("Arithmetic throughput", "[.][benchmark][video_core][shader][shader_jit]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_input3 = SourceRegister::MakeInput(2);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader = ShaderTest({
+        // clang-format off
+        {OpCode::Id::DP4, sh_output, sh_input1, sh_input2},
+        {OpCode::Id::DP3, sh_output, sh_input2, sh_input3},
+        {OpCode::Id::MUL, sh_output, sh_input1, sh_input3},
+        {OpCode::Id::MAD, sh_output, sh_input1, sh_input2, sh_input3},
+        {OpCode::Id::DP4, sh_output, sh_input3, sh_input1},
+        {OpCode::Id::MAD, sh_output, sh_input3, sh_input1, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    Pica::Shader::ShaderSetup shader_setup;
+    Pica::Shader::UnitState shader_unit;
+    for (u32 i = 0; i < 3; ++i) {
+        for (u32 component = 0; component < 4; ++component) {
+            shader_unit.registers.input[i][component] = float24::FromFloat32(0.5f + i + component);
+        }
+    }
+
+    constexpr int iterations = 1000000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        shader.shader->Run(shader_setup, shader_unit, 0);
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    WARN("JIT: " << elapsed.count() / iterations << " ns per vertex");
+}
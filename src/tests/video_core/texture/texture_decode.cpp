@@ -0,0 +1,102 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "video_core/texture/texture_decode.h"
+#include "video_core/utils.h"
+
+namespace Pica::Texture {
+
+using TextureFormat = TexturingRegs::TextureFormat;
+
+static std::array<u8, 4> Components(const Common::Vec4<u8>& color) {
+    return {color.r(), color.g(), color.b(), color.a()};
+}
+
+TEST_CASE("DecodeTile: Matches LookupTexelInTile", "[video_core]") {
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<u8> tile(CalculateTileSize(TextureFormat::RGBA8));
+
+    for (u32 format = 0; format <= static_cast<u32>(TextureFormat::ETC1A4); ++format) {
+        TextureInfo info{};
+        info.width = 8;
+        info.height = 8;
+        info.format = static_cast<TextureFormat>(format);
+        info.SetDefaultStride();
+
+        for (int round = 0; round < 16; ++round) {
+            for (u8& byte : tile) {
+                byte = static_cast<u8>(distribution(generator));
+            }
+            for (bool disable_alpha : {false, true}) {
+                std::array<Common::Vec4<u8>, 8 * 8> texels;
+                DecodeTile(tile.data(), info, texels, disable_alpha);
+                for (unsigned int y = 0; y < 8; ++y) {
+                    for (unsigned int x = 0; x < 8; ++x) {
+                        INFO("Format " << format << ", texel " << x << ", " << y);
+                        const auto expected =
+                            LookupTexelInTile(tile.data(), x, y, info, disable_alpha);
+                        REQUIRE(Components(texels[y * 8 + x]) == Components(expected));
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// Builds the I8 texture of two mipmap levels, texel(level, x, y) gives the intensities
+template <typename Func>
+static std::vector<u8> MakeMipmappedI8(const TextureInfo& info, Func&& texel) {
+    std::vector<u8> data(info.width * info.height + info.width * info.height / 4);
+    u8* level = data.data();
+    for (u32 index = 0; index < 2; ++index) {
+        const u32 width = info.width >> index;
+        const u32 height = info.height >> index;
+        for (u32 y = 0; y < height; ++y) {
+            for (u32 x = 0; x < width; ++x) {
+                const u32 offset = (y / 8) * width * 8 + (x / 8) * 64 +
+                                   VideoCore::MortonInterleave(x % 8, y % 8);
+                level[offset] = texel(index, x, y);
+            }
+        }
+        level += width * height;
+    }
+    return data;
+}
+
+TEST_CASE("IsNextLevelBoxFiltered: Tells box filtered mipmaps from custom ones", "[video_core]") {
+    TextureInfo info{};
+    info.width = 64;
+    info.height = 32;
+    info.format = TextureFormat::I8;
+    info.SetDefaultStride();
+
+    const auto gradient = [](u32 x, u32 y) { return static_cast<u8>(x * 3 + y * 5); };
+    const auto box_filtered = MakeMipmappedI8(info, [&](u32 level, u32 x, u32 y) {
+        if (level == 0) {
+            return gradient(x, y);
+        }
+        const u32 sum = gradient(x * 2, y * 2) + gradient(x * 2 + 1, y * 2) +
+                        gradient(x * 2, y * 2 + 1) + gradient(x * 2 + 1, y * 2 + 1);
+        return static_cast<u8>((sum + 2) / 4);
+    });
+    REQUIRE(IsNextLevelBoxFiltered(box_filtered.data(), info));
+
+    // Games that fade their mipmaps into a flat color, or draw other images into them
+    const auto faded = MakeMipmappedI8(info, [&](u32 level, u32 x, u32 y) {
+        return level == 0 ? gradient(x, y) : static_cast<u8>(128);
+    });
+    REQUIRE(!IsNextLevelBoxFiltered(faded.data(), info));
+
+    const auto nearest = MakeMipmappedI8(info, [&](u32 level, u32 x, u32 y) {
+        return level == 0 ? static_cast<u8>((x + y) % 2 * 255) : static_cast<u8>(255);
+    });
+    REQUIRE(!IsNextLevelBoxFiltered(nearest.data(), info));
+}
+
+} // namespace Pica::Texture
@@ -2,17 +2,22 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
+#include "core/core.h"
 #include "core/hle/service/gsp/gsp.h"
 #include "core/hw/gpu.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "core/tracer/recorder.h"
 #include "video_core/command_processor.h"
@@ -33,6 +38,36 @@ namespace Pica::CommandProcessor {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+/// Number of vertices run through the vertex shader at a time, one shader unit each
+constexpr std::size_t VERTEX_BATCH_SIZE = 8;
+
+/// Smallest post-transform vertex cache, used whatever the configured size
+constexpr u32 MIN_VERTEX_CACHE_SIZE = 32;
+constexpr u32 INVALID_VERTEX_ID = 0xFFFFFFFF;
+
+/// Post-transform vertex cache of the indexed software draws, kept between draws to reuse the
+/// allocation
+static std::vector<Shader::AttributeBuffer> vertex_cache;
+static std::vector<u32> vertex_cache_ids;
+/// Shader unit of the current batch that will write each entry, or -1 once it is written
+static std::vector<int> vertex_cache_units;
+
+/// Loader of the software draws, rebuilt only when the attribute layout changes. Command lists
+/// that are submitted again every frame keep drawing with the same few layouts.
+static VertexLoader vertex_loader;
+static decltype(PipelineRegs::vertex_attributes) vertex_loader_config;
+static bool vertex_loader_valid = false;
+
+static const VertexLoader& GetVertexLoader(const PipelineRegs& regs) {
+    if (!vertex_loader_valid || std::memcmp(&vertex_loader_config, &regs.vertex_attributes,
+                                            sizeof(vertex_loader_config)) != 0) {
+        vertex_loader = VertexLoader(regs);
+        std::memcpy(&vertex_loader_config, &regs.vertex_attributes, sizeof(vertex_loader_config));
+        vertex_loader_valid = true;
+    }
+    return vertex_loader;
+}
+
 static const char* GetShaderSetupTypeName(Shader::ShaderSetup& setup) {
     if (&setup == &g_state.vs) {
         return "vertex shader";
@@ -103,6 +138,25 @@ static void WriteUniformFloatReg(ShaderRegs& config, Shader::ShaderSetup& setup,
     }
 }
 
+// Expand a 4-bit mask to 4-byte mask, e.g. 0b0101 -> 0x00FF00FF
+static constexpr std::array<u32, 16> expand_bits_to_bytes = {
+    0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff, 0x00ff0000, 0x00ff00ff,
+    0x00ffff00, 0x00ffffff, 0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
+    0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
+};
+
+static void WriteMaskedReg(u32 id, u32 value, u32 mask) {
+    u32& reg = g_state.regs.reg_array[id];
+    const u32 write_mask = expand_bits_to_bytes[mask];
+    reg = (reg & ~write_mask) | (value & write_mask);
+}
+
+/// Records the new value of a register for the users of the state and tells the rasterizer
+static void NotifyRegChanged(u32 id) {
+    g_state.dirty_regs.Set(id);
+    VideoCore::Rasterizer()->NotifyPicaRegisterChanged(id);
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -114,16 +168,9 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         return;
     }
 
-    // Expand a 4-bit mask to 4-byte mask, e.g. 0b0101 -> 0x00FF00FF
-    static const u32 expand_bits_to_bytes[] = {
-        0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff, 0x00ff0000, 0x00ff00ff,
-        0x00ffff00, 0x00ffffff, 0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
-        0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
-    };
     // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
     const u32 old_value = regs.reg_array[id];
-    const u32 write_mask = expand_bits_to_bytes[mask];
-    regs.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    WriteMaskedReg(id, value, mask);
 
     switch (id) {
     // Trigger IRQ
@@ -199,6 +246,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                     immediate_attribute_id += 1;
                 } else {
                     MICROPROFILE_SCOPE(GPU_Drawing);
+        PERF_SCOPE(RasterizerDraws);
+                    PERF_SCOPE(RasterizerDraws);
                     immediate_attribute_id = 0;
 
                     Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
@@ -255,6 +304,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(pipeline.trigger_draw):
     case PICA_REG_INDEX(pipeline.trigger_draw_indexed): {
         MICROPROFILE_SCOPE(GPU_Drawing);
+        PERF_SCOPE(RasterizerDraws);
 
 #if PICA_LOG_TEV
         DebugUtils::DumpTevStageConfig(regs.GetTevStages());
@@ -275,7 +325,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                 // game found yet that does this, so this is left unimplemented for now. Revisit
                 // this when an issue is found in games.
             } else {
-                accelerate_draw = false;
+                // The rasterizer falls back to the CPU for geometry shaders it can't translate
+                accelerate_draw = regs.pipeline.gs_config.mode == PipelineRegs::GSMode::Point;
             }
         }
 
@@ -289,9 +340,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
 
         // Processes information about internal vertex attributes to figure out how a vertex is
         // loaded.
-        // Later, these can be compiled and cached.
         const u32 base_address = regs.pipeline.vertex_attributes.GetPhysicalBaseAddress();
-        VertexLoader loader(regs.pipeline);
+        const VertexLoader& loader = GetVertexLoader(regs.pipeline);
         Shader::OutputVertex::ValidateSemantics(regs.rasterizer);
 
         // Load vertices
@@ -304,7 +354,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         DebugUtils::MemoryAccessTracker memory_accesses;
         Shader::AttributeBuffer vs_output;
         auto* shader_engine = Shader::GetEngine();
-        Shader::UnitState shader_unit;
+        std::array<Shader::UnitState, VERTEX_BATCH_SIZE> shader_units;
 
         shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
 
@@ -312,64 +362,130 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         g_state.geometry_pipeline.Setup(shader_engine);
 
         if (is_indexed) {
-            // Simple circular-replacement vertex cache
-            // The size has been tuned for optimal balance between hit-rate and the cost of lookup
-            const u32 VERTEX_CACHE_SIZE = 32;
-            std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-            std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-            std::array<Shader::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-            u32 vertex_cache_pos = 0;
-            u32 cache_lookup_limit = std::min(VERTEX_CACHE_SIZE, regs.pipeline.num_vertices - 1);
+            const auto read_index = [&](u32 index) -> u32 {
+                return index_u16 ? index_address_16[index] : index_address_8[index];
+            };
+
+            // Direct-mapped post-transform cache, sized to the index range of the draw so that
+            // every repeated index hits when the range fits
+            u32 min_index = 0xFFFF;
+            u32 max_index = 0;
+            for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
+                const u32 vertex = read_index(index);
+                min_index = std::min(min_index, vertex);
+                max_index = std::max(max_index, vertex);
+            }
+            const u32 max_cache_size =
+                std::max<u32>(MIN_VERTEX_CACHE_SIZE, Settings::values.vertex_cache_size);
+            const u32 index_range = max_index >= min_index ? max_index - min_index + 1 : 1;
+            u32 cache_size = MIN_VERTEX_CACHE_SIZE;
+            while (cache_size < index_range && cache_size * 2 <= max_cache_size) {
+                cache_size *= 2;
+            }
+
+            if (vertex_cache.size() < cache_size) {
+                vertex_cache.resize(cache_size);
+                vertex_cache_ids.resize(cache_size);
+                vertex_cache_units.resize(cache_size);
+            }
+            std::fill_n(vertex_cache_ids.begin(), cache_size, INVALID_VERTEX_ID);
+            std::fill_n(vertex_cache_units.begin(), cache_size, -1);
+            u32 cache_hits = 0;
+            u32 cache_misses = 0;
+
+            // Vertices go into the cache as soon as they miss so that repeated indices inside a
+            // batch only run once. Until the batch runs, the entry refers to its shader unit.
+            std::array<u32, VERTEX_BATCH_SIZE> unit_cache_pos;
+            u32 num_units = 0;
+
+            // Vertices waiting to be submitted, either a shader unit or a copy of a cache hit
+            std::array<int, VERTEX_BATCH_SIZE> pending_units;
+            std::array<Shader::AttributeBuffer, VERTEX_BATCH_SIZE> pending_outputs;
+            u32 num_pending = 0;
+
+            const auto flush_pending = [&] {
+                shader_engine->RunBatch(g_state.vs, shader_units.data(), num_units);
+                for (u32 i = 0; i < num_units; ++i) {
+                    shader_units[i].WriteOutput(regs.vs, vertex_cache[unit_cache_pos[i]]);
+                    vertex_cache_units[unit_cache_pos[i]] = -1;
+                }
+
+                // Send to geometry pipeline
+                for (u32 i = 0; i < num_pending; ++i) {
+                    const int unit = pending_units[i];
+                    g_state.geometry_pipeline.SubmitVertex(
+                        unit < 0 ? pending_outputs[i] : vertex_cache[unit_cache_pos[unit]]);
+                }
+                num_units = 0;
+                num_pending = 0;
+            };
 
             for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
                 // Indexed rendering doesn't use the start offset
-                u32 vertex = index_u16 ? index_address_16[index] : index_address_8[index];
+                u32 vertex = read_index(index);
 
                 if (g_state.geometry_pipeline.NeedIndexInput()) {
+                    flush_pending();
                     g_state.geometry_pipeline.SubmitIndex(vertex);
                     continue;
                 }
 
-                bool vertex_cache_hit = false;
-                for (u32 i = 0; i < cache_lookup_limit; ++i) {
-                    if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                        vs_output = vertex_cache[i];
-                        vertex_cache_hit = true;
-                        break;
+                const u32 cache_pos = (vertex - min_index) & (cache_size - 1);
+                if (vertex_cache_ids[cache_pos] == vertex) {
+                    // Entries of later misses in the batch may replace this one before it is
+                    // submitted, so finished outputs are copied right away
+                    pending_units[num_pending] = vertex_cache_units[cache_pos];
+                    if (vertex_cache_units[cache_pos] < 0) {
+                        pending_outputs[num_pending] = vertex_cache[cache_pos];
                     }
-                }
+                    ++cache_hits;
+                } else {
+                    if (vertex_cache_units[cache_pos] >= 0) {
+                        // The entry still waits for the output of a shader unit of this batch
+                        flush_pending();
+                    }
+                    ++cache_misses;
 
-                if (!vertex_cache_hit) {
                     // Initialize data for the current vertex
                     Shader::AttributeBuffer input;
                     loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
-                    shader_unit.LoadInput(regs.vs, input);
-                    shader_engine->Run(g_state.vs, shader_unit);
-                    shader_unit.WriteOutput(regs.vs, vs_output);
+                    shader_units[num_units].LoadInput(regs.vs, input);
+                    unit_cache_pos[num_units] = cache_pos;
+                    pending_units[num_pending] = static_cast<int>(num_units);
 
-                    vertex_cache[vertex_cache_pos] = vs_output;
-                    vertex_cache_valid[vertex_cache_pos] = true;
-                    vertex_cache_ids[vertex_cache_pos] = vertex;
-                    vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+                    vertex_cache_units[cache_pos] = static_cast<int>(num_units++);
+                    vertex_cache_ids[cache_pos] = vertex;
                 }
 
-                // Send to geometry pipeline
-                g_state.geometry_pipeline.SubmitVertex(vs_output);
+                if (++num_pending == VERTEX_BATCH_SIZE) {
+                    flush_pending();
+                }
             }
+            flush_pending();
+
+            Core::System::GetInstance().perf_stats->AddVertexCacheStats(cache_hits, cache_misses);
         } else {
-            for (u32 index = 0; index < regs.pipeline.num_vertices; ++index) {
-                // Indexed rendering doesn't use the start offset
-                u32 vertex = index + regs.pipeline.vertex_offset;
+            const u32 num_vertices = regs.pipeline.num_vertices;
+            for (u32 first = 0; first < num_vertices; first += VERTEX_BATCH_SIZE) {
+                const u32 count = std::min<u32>(VERTEX_BATCH_SIZE, num_vertices - first);
+                for (u32 i = 0; i < count; ++i) {
+                    const u32 index = first + i;
+                    // Indexed rendering doesn't use the start offset
+                    u32 vertex = index + regs.pipeline.vertex_offset;
 
-                // Initialize data for the current vertex
-                Shader::AttributeBuffer input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
-                shader_unit.LoadInput(regs.vs, input);
-                shader_engine->Run(g_state.vs, shader_unit);
-                shader_unit.WriteOutput(regs.vs, vs_output);
+                    // Initialize data for the current vertex
+                    Shader::AttributeBuffer input;
+                    loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
+                    shader_units[i].LoadInput(regs.vs, input);
+                }
+                shader_engine->RunBatch(g_state.vs, shader_units.data(), count);
 
-                // Send to geometry pipeline
-                g_state.geometry_pipeline.SubmitVertex(vs_output);
+                for (u32 i = 0; i < count; ++i) {
+                    shader_units[i].WriteOutput(regs.vs, vs_output);
+
+                    // Send to geometry pipeline
+                    g_state.geometry_pipeline.SubmitVertex(vs_output);
+                }
             }
         }
 
@@ -446,6 +562,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX(vs.bool_uniforms):
         // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
         WriteUniformBoolReg(g_state.vs, g_state.regs.vs.bool_uniforms.Value());
+        NotifyRegChanged(id);
         break;
 
     case PICA_REG_INDEX(vs.int_uniforms[0]):
@@ -457,6 +574,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         auto values = regs.vs.int_uniforms[index];
         WriteUniformIntReg(g_state.vs, index,
                            Common::Vec4<u8>(values.x, values.y, values.z, values.w));
+        NotifyRegChanged(id);
         break;
     }
 
@@ -471,6 +589,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         // TODO (wwylele): does regs.pipeline.gs_unit_exclusive_configuration affect this?
         WriteUniformFloatReg(g_state.regs.vs, g_state.vs, g_state.vs_float_regs_counter,
                              g_state.vs_uniform_write_buffer, value);
+        NotifyRegChanged(id);
         break;
     }
 
@@ -582,11 +701,54 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
         break;
     }
     default:
-        VideoCore::Rasterizer()->NotifyPicaRegisterChanged(id);
+        // Command lists rewrite most of the state for every draw, the rasterizer only needs to
+        // see the registers that changed
+        if (regs.reg_array[id] != old_value) {
+            NotifyRegChanged(id);
+        }
         break;
     }
 }
 
+/// Returns true if the registers first_id to last_id are all among the num_regs ones from base
+static bool IsInRegRange(u32 first_id, u32 last_id, u32 base, u32 num_regs) {
+    return first_id >= base && last_id < base + num_regs;
+}
+
+/**
+ * Writes the parameters of a command to the VS float uniform registers in one go. The rasterizer
+ * only picks up fully written vectors, so it is notified once per vector rather than once per word.
+ */
+static void WriteVSFloatUniforms(u32 id, u32 id_step, u32 value, const u32* extra_values,
+                                 u32 num_extra, u32 mask) {
+    for (u32 i = 0; i <= num_extra; ++i, id += id_step) {
+        const u32 word = i == 0 ? value : extra_values[i - 1];
+        WriteMaskedReg(id, word, mask);
+        WriteUniformFloatReg(g_state.regs.vs, g_state.vs, g_state.vs_float_regs_counter,
+                             g_state.vs_uniform_write_buffer, word);
+        if (g_state.vs_float_regs_counter == 0) {
+            NotifyRegChanged(id);
+        }
+    }
+}
+
+/// Writes the parameters of a command to the lighting LUT data registers in one go
+static void WriteLightingLutData(u32 id, u32 id_step, u32 value, const u32* extra_values,
+                                 u32 num_extra, u32 mask) {
+    auto& lut_config = g_state.regs.lighting.lut_config;
+    // Done ahead of the writes, since the rasterizer may first have to draw with the old data
+    VideoCore::Rasterizer()->SyncLightingLutData();
+
+    auto& lut = g_state.lighting.luts[lut_config.type];
+    for (u32 i = 0; i <= num_extra; ++i, id += id_step) {
+        const u32 word = i == 0 ? value : extra_values[i - 1];
+        WriteMaskedReg(id, word, mask);
+        ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
+        lut[lut_config.index].raw = word;
+        lut_config.index.Assign(lut_config.index + 1);
+    }
+}
+
 void ProcessCommandList(PAddr list, u32 size) {
     u32* buffer = (u32*)VideoCore::Memory()->GetPhysicalPointer(list);
     g_state.cmd_list.addr = list;
@@ -603,6 +765,21 @@ void ProcessCommandList(PAddr list, u32 size) {
         const u32 group_factor = header.group_commands;
         u32 cmd_id = header.cmd_id;
 
+        // Uniform and LUT uploads are long runs of parameters to the same few data registers
+        const u32 last_id = cmd_id + header.extra_data_length * group_factor;
+        if (IsInRegRange(cmd_id, last_id, PICA_REG_INDEX(vs.uniform_setup.set_value[0]), 8)) {
+            WriteVSFloatUniforms(cmd_id, group_factor, value, g_state.cmd_list.current_ptr,
+                                 header.extra_data_length, header.parameter_mask);
+            g_state.cmd_list.current_ptr += header.extra_data_length;
+            continue;
+        }
+        if (IsInRegRange(cmd_id, last_id, PICA_REG_INDEX(lighting.lut_data[0]), 8)) {
+            WriteLightingLutData(cmd_id, group_factor, value, g_state.cmd_list.current_ptr,
+                                 header.extra_data_length, header.parameter_mask);
+            g_state.cmd_list.current_ptr += header.extra_data_length;
+            continue;
+        }
+
         WritePicaReg(cmd_id, value, header.parameter_mask);
         for (u32 i = 0; i < header.extra_data_length; ++i) {
             cmd_id += group_factor;
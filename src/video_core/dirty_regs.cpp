@@ -0,0 +1,62 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/dirty_regs.h"
+
+namespace Pica {
+
+namespace {
+
+struct RegRange {
+    std::size_t first;
+    std::size_t end;
+};
+
+constexpr std::size_t TexturingEnd = PICA_REG_INDEX(texturing) + sizeof(TexturingRegs) / 4;
+
+/// Returns the registers [first, end) of a group, some groups consist of two ranges
+std::array<RegRange, 2> GetRanges(DirtyRegGroup group) {
+    switch (group) {
+    case DirtyRegGroup::Rasterizer:
+        return {{{PICA_REG_INDEX(rasterizer),
+                  PICA_REG_INDEX(rasterizer) + sizeof(RasterizerRegs) / 4}}};
+    case DirtyRegGroup::Texturing:
+        return {{{PICA_REG_INDEX(texturing), PICA_REG_INDEX(texturing.proctex)}}};
+    case DirtyRegGroup::ProcTex:
+        return {{{PICA_REG_INDEX(texturing.proctex), PICA_REG_INDEX(texturing.tev_stage0)}}};
+    case DirtyRegGroup::Tev:
+        return {{{PICA_REG_INDEX(texturing.tev_stage0), PICA_REG_INDEX(texturing.fog_color)},
+                 {PICA_REG_INDEX(texturing.tev_stage4), TexturingEnd}}};
+    case DirtyRegGroup::Fog:
+        return {{{PICA_REG_INDEX(texturing.fog_color), PICA_REG_INDEX(texturing.tev_stage4)}}};
+    case DirtyRegGroup::Framebuffer:
+        return {{{PICA_REG_INDEX(framebuffer),
+                  PICA_REG_INDEX(framebuffer) + sizeof(FramebufferRegs) / 4}}};
+    case DirtyRegGroup::Lighting:
+        return {{{PICA_REG_INDEX(lighting), PICA_REG_INDEX(lighting) + sizeof(LightingRegs) / 4}}};
+    case DirtyRegGroup::Pipeline:
+        return {{{PICA_REG_INDEX(pipeline), PICA_REG_INDEX(pipeline) + sizeof(PipelineRegs) / 4}}};
+    case DirtyRegGroup::GS:
+        return {{{PICA_REG_INDEX(gs), PICA_REG_INDEX(gs) + sizeof(ShaderRegs) / 4}}};
+    case DirtyRegGroup::VS:
+        return {{{PICA_REG_INDEX(vs), PICA_REG_INDEX(vs) + sizeof(ShaderRegs) / 4}}};
+    }
+    return {};
+}
+
+} // Anonymous namespace
+
+DirtyRegs::Mask DirtyRegs::GetMask(std::initializer_list<DirtyRegGroup> groups) {
+    Mask mask{};
+    for (const DirtyRegGroup group : groups) {
+        for (const RegRange& range : GetRanges(group)) {
+            for (std::size_t id = range.first; id < range.end; ++id) {
+                mask[id / 64] |= u64{1} << (id % 64);
+            }
+        }
+    }
+    return mask;
+}
+
+} // namespace Pica
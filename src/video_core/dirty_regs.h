@@ -0,0 +1,77 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include "common/bit_set.h"
+#include "common/common_types.h"
+#include "video_core/regs.h"
+
+namespace Pica {
+
+/// Registers that belong together, each group is meant to be consumed by one user of the state
+enum class DirtyRegGroup {
+    Rasterizer,  ///< Culling, clipping, viewport and scissor
+    Texturing,   ///< The texture units and the texturing switches
+    ProcTex,     ///< Procedural texture parameters
+    Tev,         ///< The TEV stages and the combiner buffer
+    Fog,         ///< Fog color and LUT
+    Framebuffer, ///< Output merger and framebuffer setup
+    Lighting,    ///< Fragment lighting
+    Pipeline,    ///< Vertex input and primitive setup
+    GS,          ///< Geometry shader setup
+    VS,          ///< Vertex shader setup
+};
+
+/**
+ * One bit for every PICA register that was written with a new value. The command processor sets
+ * them, the users of the state pick up their groups when they draw, which costs a few words plus
+ * one call per changed register rather than a call per write.
+ */
+class DirtyRegs {
+public:
+    using Mask = std::array<u64, (Regs::NUM_REGS + 63) / 64>;
+
+    void Set(u32 id) {
+        bits[id / 64] |= u64{1} << (id % 64);
+    }
+
+    /// Marks all of the registers dirty, e.g. after the state was reset or loaded
+    void SetAll() {
+        bits.fill(~u64{0});
+    }
+
+    bool Any(const Mask& mask) const {
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            if (bits[i] & mask[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Calls func with the index of every dirty register in mask, lowest first, and clears them
+    template <typename Func>
+    void ForEachAndClear(const Mask& mask, Func&& func) {
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            u64 word = bits[i] & mask[i];
+            bits[i] &= ~word;
+            while (word != 0) {
+                func(static_cast<u32>(i * 64 + Common::LeastSignificantSetBit(word)));
+                word &= word - 1;
+            }
+        }
+    }
+
+    /// Returns the registers of the groups
+    static Mask GetMask(std::initializer_list<DirtyRegGroup> groups);
+
+private:
+    Mask bits{};
+};
+
+} // namespace Pica
@@ -196,10 +196,6 @@ GeometryPipeline::GeometryPipeline(State& state) : state(state) {}
 
 GeometryPipeline::~GeometryPipeline() = default;
 
-void GeometryPipeline::SetVertexHandler(Shader::VertexHandler vertex_handler) {
-    this->vertex_handler = vertex_handler;
-}
-
 void GeometryPipeline::Setup(Shader::ShaderEngine* shader_engine) {
     if (!backend)
         return;
@@ -258,7 +254,7 @@ void GeometryPipeline::SubmitVertex(const Shader::AttributeBuffer& input) {
     if (!backend) {
         // No backend means the geometry shader is disabled, so we send the vertex shader output
         // directly to the primitive assembler.
-        vertex_handler(input);
+        state.SubmitVertex(input);
     } else {
         if (backend->SubmitVertex(input)) {
             shader_engine->Run(state.gs, state.gs_unit);
@@ -19,9 +19,6 @@ public:
     explicit GeometryPipeline(State& state);
     ~GeometryPipeline();
 
-    /// Sets the handler for receiving vertex outputs from vertex shader
-    void SetVertexHandler(Shader::VertexHandler vertex_handler);
-
     /**
      * Setup the geometry shader unit if it is in use
      * @param shader_engine the shader engine for the geometry shader to run
@@ -41,7 +38,6 @@ public:
     void SubmitVertex(const Shader::AttributeBuffer& input);
 
 private:
-    Shader::VertexHandler vertex_handler;
     Shader::ShaderEngine* shader_engine;
     std::unique_ptr<GeometryPipelineBackend> backend;
     State& state;
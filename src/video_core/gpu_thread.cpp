@@ -0,0 +1,137 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/video_core.h"
+
+namespace VideoCore {
+
+GPUThread::GPUThread(Frontend::EmuWindow& window) : window(window) {
+    // The context can only be current on one thread at a time
+    window.DoneCurrent();
+    thread = std::thread(&GPUThread::ThreadLoop, this);
+    LOG_INFO(HW_GPU, "GPU commands run on a dedicated thread");
+}
+
+GPUThread::~GPUThread() {
+    {
+        std::lock_guard lock{mutex};
+        stop_requested = true;
+    }
+    task_cv.notify_one();
+    thread.join();
+
+    // The guest is gone, so are the events the callbacks would signal
+    callbacks.clear();
+    window.MakeCurrent();
+}
+
+u64 GPUThread::Push(std::function<void()> task) {
+    u64 fence;
+    {
+        std::lock_guard lock{mutex};
+        PushInvalidation();
+        fence = ++last_fence;
+        tasks.emplace_back(fence, std::move(task));
+    }
+    task_cv.notify_one();
+    return fence;
+}
+
+void GPUThread::WaitFence(u64 fence) {
+    std::vector<std::function<void()>> ready;
+    {
+        std::unique_lock lock{mutex};
+        done_cv.wait(lock, [this, fence] { return completed_fence >= fence; });
+        // Tasks complete in order, and so are their callbacks queued
+        while (!callbacks.empty() && callbacks.front().first <= fence) {
+            ready.push_back(std::move(callbacks.front().second));
+            callbacks.pop_front();
+        }
+    }
+    for (const auto& callback : ready) {
+        callback();
+    }
+}
+
+void GPUThread::WaitIdle() {
+    u64 fence;
+    {
+        std::lock_guard lock{mutex};
+        PushInvalidation();
+        fence = last_fence;
+    }
+    task_cv.notify_one();
+    WaitFence(fence);
+}
+
+void GPUThread::QueueInvalidation(PAddr start, u32 size) {
+    std::lock_guard lock{mutex};
+    if (invalidation_start != invalidation_end &&
+        (start > invalidation_end || start + size < invalidation_start)) {
+        PushInvalidation();
+        task_cv.notify_one();
+    }
+    if (invalidation_start == invalidation_end) {
+        invalidation_start = start;
+        invalidation_end = start + size;
+    } else {
+        invalidation_start = std::min(invalidation_start, start);
+        invalidation_end = std::max(invalidation_end, start + size);
+    }
+}
+
+void GPUThread::PushInvalidation() {
+    if (invalidation_start == invalidation_end) {
+        return;
+    }
+    tasks.emplace_back(++last_fence, [start = invalidation_start, end = invalidation_end] {
+        VideoCore::Rasterizer()->InvalidateRegion(start, end - start);
+    });
+    invalidation_start = invalidation_end = 0;
+}
+
+void GPUThread::PostToCPU(std::function<void()> callback) {
+    std::lock_guard lock{mutex};
+    callbacks.emplace_back(running_fence, std::move(callback));
+}
+
+void GPUThread::ThreadLoop() {
+    Common::SetCurrentThreadName("GPUThread");
+    Common::SetCurrentThreadFrameCritical();
+    window.MakeCurrent();
+
+    while (true) {
+        std::pair<u64, std::function<void()>> task;
+        {
+            std::unique_lock lock{mutex};
+            task_cv.wait(lock, [this] { return stop_requested || !tasks.empty(); });
+            // Pending tasks still run on stop, they may write guest memory the caller expects
+            if (tasks.empty()) {
+                break;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            running_fence = task.first;
+        }
+
+        task.second();
+
+        {
+            std::lock_guard lock{mutex};
+            completed_fence = task.first;
+        }
+        done_cv.notify_all();
+    }
+
+    window.DoneCurrent();
+}
+
+} // namespace VideoCore
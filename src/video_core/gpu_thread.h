@@ -0,0 +1,89 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "common/common_types.h"
+
+namespace Frontend {
+class EmuWindow;
+}
+
+namespace VideoCore {
+
+/**
+ * A thread owning the render context that runs the GPU work submitted by the emulation thread in
+ * submission order: command lists, memory fills, display transfers and buffer swaps. Every task
+ * gets a fence, which the emulation thread can wait on before touching the results.
+ */
+class GPUThread {
+public:
+    /// Takes the render context away from the calling thread, which gets it back on destruction
+    explicit GPUThread(Frontend::EmuWindow& window);
+    ~GPUThread();
+
+    /// Queues a task and returns its fence
+    u64 Push(std::function<void()> task);
+
+    /**
+     * Waits for the task of the fence and all the ones queued before it, then runs on the calling
+     * thread the callbacks they posted with PostToCPU
+     */
+    void WaitFence(u64 fence);
+
+    /// Runs a task on the GPU thread and waits for it
+    void Sync(std::function<void()> task) {
+        WaitFence(Push(std::move(task)));
+    }
+
+    /// Waits for all the queued tasks
+    void WaitIdle();
+
+    /**
+     * Queues the invalidation of the surfaces cached over a region written by the CPU. The
+     * invalidations of adjacent writes are merged and run ahead of the next task pushed.
+     */
+    void QueueInvalidation(PAddr start, u32 size);
+
+    /**
+     * Called by a task to run something on the emulation thread, such as signalling an interrupt,
+     * once the emulation thread waits for the fence of the task
+     */
+    void PostToCPU(std::function<void()> callback);
+
+    /// Returns true if the caller is the GPU thread
+    bool IsCurrentThread() const {
+        return std::this_thread::get_id() == thread.get_id();
+    }
+
+private:
+    void ThreadLoop();
+
+    /// Turns the merged invalidation into a task, with the mutex held
+    void PushInvalidation();
+
+    Frontend::EmuWindow& window;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable task_cv;
+    std::condition_variable done_cv;
+    std::deque<std::pair<u64, std::function<void()>>> tasks;
+    std::deque<std::pair<u64, std::function<void()>>> callbacks;
+    u64 last_fence = 0;
+    u64 running_fence = 0;
+    u64 completed_fence = 0;
+    /// Region of the invalidation not pushed yet, empty when both ends are equal
+    PAddr invalidation_start = 0;
+    PAddr invalidation_end = 0;
+    bool stop_requested = false;
+};
+
+} // namespace VideoCore
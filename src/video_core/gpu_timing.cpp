@@ -0,0 +1,40 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include "video_core/gpu_timing.h"
+
+namespace VideoCore::GPUTiming {
+
+namespace {
+std::atomic<bool> enabled{false};
+std::mutex last_frame_mutex;
+FrameTimings last_frame;
+} // Anonymous namespace
+
+void SetEnabled(bool enable) {
+    enabled = enable;
+    if (!enable) {
+        std::lock_guard lock{last_frame_mutex};
+        last_frame = {};
+    }
+}
+
+bool IsEnabled() {
+    return enabled;
+}
+
+void Publish(FrameTimings timings) {
+    std::lock_guard lock{last_frame_mutex};
+    last_frame = std::move(timings);
+}
+
+FrameTimings GetLastFrame() {
+    std::lock_guard lock{last_frame_mutex};
+    return last_frame;
+}
+
+} // namespace VideoCore::GPUTiming
@@ -0,0 +1,58 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * The GPU time of the work of the last measured frame, for the graphics debugger. The renderer
+ * measures the frames only while some frontend enabled the measurements.
+ */
+namespace VideoCore::GPUTiming {
+
+enum class SectionType : u8 {
+    /// Draws into a framebuffer
+    Pass,
+    /// Surface uploads
+    Upload,
+    /// Blits and copies between surfaces
+    Blit,
+    /// Drawing of the screens to the window
+    Present,
+};
+
+struct Section {
+    SectionType type;
+    /// The attachments of a pass, 0 for the ones it doesn't use
+    PAddr color_addr;
+    PAddr depth_addr;
+    /// Times the section ran in the frame, which are summed up in one section
+    u32 count;
+    u32 draws;
+    u64 gpu_ns;
+};
+
+struct FrameTimings {
+    /// Number of the frame since the measurements began, 0 if none was measured yet
+    u64 frame = 0;
+    /// The passes in the order they first ran, then the other sections
+    std::vector<Section> sections;
+    u32 draws = 0;
+    /// GL calls the changes of the render state made in the frame
+    u32 state_changes = 0;
+    /// The GPU time of all the sections
+    u64 gpu_ns = 0;
+};
+
+/// Starts or stops the measurements, from any thread
+void SetEnabled(bool enabled);
+bool IsEnabled();
+
+/// Replaces the timings of the last measured frame
+void Publish(FrameTimings timings);
+FrameTimings GetLastFrame();
+
+} // namespace VideoCore::GPUTiming
@@ -27,24 +27,23 @@ void Zero(T& o) {
 }
 
 State::State() : geometry_pipeline(*this) {
-    auto SubmitVertex = [this](const Shader::AttributeBuffer& vertex) {
-        using Pica::Shader::OutputVertex;
-        auto AddTriangle = [](const OutputVertex& v0, const OutputVertex& v1,
-                              const OutputVertex& v2) {
-            VideoCore::Rasterizer()->AddTriangle(v0, v1, v2);
-        };
-        primitive_assembler.SubmitVertex(
-            Shader::OutputVertex::FromAttributeBuffer(regs.rasterizer, vertex), AddTriangle);
-    };
-
-    auto SetWinding = [this]() { primitive_assembler.SetWinding(); };
-
-    g_state.gs_unit.SetVertexHandler(SubmitVertex, SetWinding);
-    g_state.geometry_pipeline.SetVertexHandler(SubmitVertex);
+    gs_unit.SetVertexHandler([this](const Shader::AttributeBuffer& vertex) { SubmitVertex(vertex); },
+                             [this]() { primitive_assembler.SetWinding(); });
+}
+
+void State::SubmitVertex(const Shader::AttributeBuffer& vertex) {
+    using Pica::Shader::OutputVertex;
+    VideoCore::RasterizerInterface* rasterizer = VideoCore::Rasterizer();
+    primitive_assembler.SubmitVertex(
+        OutputVertex::FromAttributeBuffer(regs.rasterizer, vertex),
+        [rasterizer](const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2) {
+            rasterizer->AddTriangle(v0, v1, v2);
+        });
 }
 
 void State::Reset() {
     Zero(regs);
+    dirty_regs.SetAll();
     Zero(vs);
     Zero(gs);
     Zero(proctex);
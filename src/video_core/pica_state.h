@@ -8,6 +8,7 @@
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
+#include "video_core/dirty_regs.h"
 #include "video_core/geometry_pipeline.h"
 #include "video_core/primitive_assembly.h"
 #include "video_core/regs.h"
@@ -20,8 +21,13 @@ struct State {
     State();
     void Reset();
 
+    /// Sends a vertex shader or geometry shader output to the primitive assembler
+    void SubmitVertex(const Shader::AttributeBuffer& vertex);
+
     /// Pica registers
     Regs regs;
+    /// Registers written with a new value since their users last picked them up
+    DirtyRegs dirty_regs;
 
     Shader::ShaderSetup vs;
     Shader::ShaderSetup gs;
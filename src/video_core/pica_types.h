@@ -6,7 +6,13 @@
 
 #include <cmath>
 #include <cstring>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
 #include "common/common_types.h"
+#include "common/vector_math.h"
 
 namespace Pica {
 
@@ -146,4 +152,158 @@ using float24 = Float<16, 7>;
 using float20 = Float<12, 7>;
 using float16 = Float<10, 5>;
 
+static_assert(sizeof(Common::Vec4<float24>) == 4 * sizeof(float),
+              "Vec4<float24> must hold its components as packed floats");
+
+namespace detail {
+
+/*
+ * Component-wise operations on the four floats of a Vec4<float24>, with the same results as the
+ * float24 operators: products of infinity and zero give zero, MIN and MAX return the second
+ * operand unless the comparison holds, which decides their NaN behavior.
+ */
+#if defined(ARCHITECTURE_x86_64)
+using Vec4Register = __m128;
+
+inline Vec4Register Load(const Common::Vec4<float24>& vec) {
+    return _mm_loadu_ps(reinterpret_cast<const float*>(&vec.x));
+}
+
+inline Common::Vec4<float24> Store(Vec4Register value) {
+    Common::Vec4<float24> vec;
+    _mm_storeu_ps(reinterpret_cast<float*>(&vec.x), value);
+    return vec;
+}
+
+inline Vec4Register Add(Vec4Register a, Vec4Register b) {
+    return _mm_add_ps(a, b);
+}
+
+inline Vec4Register Sub(Vec4Register a, Vec4Register b) {
+    return _mm_sub_ps(a, b);
+}
+
+inline Vec4Register Mul(Vec4Register a, Vec4Register b) {
+    const Vec4Register product = _mm_mul_ps(a, b);
+    // NaN products of operands that are not NaN come from infinity times zero
+    const Vec4Register to_zero =
+        _mm_and_ps(_mm_cmpunord_ps(product, product), _mm_cmpord_ps(a, b));
+    return _mm_andnot_ps(to_zero, product);
+}
+
+inline Vec4Register Splat(float24 value) {
+    return _mm_set1_ps(value.ToFloat32());
+}
+
+inline Vec4Register Min(Vec4Register a, Vec4Register b) {
+    return _mm_min_ps(a, b);
+}
+
+inline Vec4Register Max(Vec4Register a, Vec4Register b) {
+    return _mm_max_ps(a, b);
+}
+#elif defined(ARCHITECTURE_ARM64)
+using Vec4Register = float32x4_t;
+
+inline Vec4Register Load(const Common::Vec4<float24>& vec) {
+    return vld1q_f32(reinterpret_cast<const float*>(&vec.x));
+}
+
+inline Common::Vec4<float24> Store(Vec4Register value) {
+    Common::Vec4<float24> vec;
+    vst1q_f32(reinterpret_cast<float*>(&vec.x), value);
+    return vec;
+}
+
+inline Vec4Register Add(Vec4Register a, Vec4Register b) {
+    return vaddq_f32(a, b);
+}
+
+inline Vec4Register Sub(Vec4Register a, Vec4Register b) {
+    return vsubq_f32(a, b);
+}
+
+inline Vec4Register Mul(Vec4Register a, Vec4Register b) {
+    const Vec4Register product = vmulq_f32(a, b);
+    // NaN products of operands that are not NaN come from infinity times zero
+    const uint32x4_t operands_ordered = vandq_u32(vceqq_f32(a, a), vceqq_f32(b, b));
+    const uint32x4_t to_zero = vbicq_u32(operands_ordered, vceqq_f32(product, product));
+    return vbslq_f32(to_zero, vdupq_n_f32(0.f), product);
+}
+
+inline Vec4Register Splat(float24 value) {
+    return vdupq_n_f32(value.ToFloat32());
+}
+
+inline Vec4Register Min(Vec4Register a, Vec4Register b) {
+    return vbslq_f32(vcltq_f32(a, b), a, b);
+}
+
+inline Vec4Register Max(Vec4Register a, Vec4Register b) {
+    return vbslq_f32(vcgtq_f32(a, b), a, b);
+}
+#endif
+
+} // namespace detail
+
+/// Component-wise minimum as the PICA computes it, min(x, NaN) is NaN and min(NaN, x) is x
+inline Common::Vec4<float24> Min(const Common::Vec4<float24>& a, const Common::Vec4<float24>& b) {
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+    return detail::Store(detail::Min(detail::Load(a), detail::Load(b)));
+#else
+    return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z,
+            a.w < b.w ? a.w : b.w};
+#endif
+}
+
+/// Component-wise maximum as the PICA computes it, max(x, NaN) is NaN and max(NaN, x) is x
+inline Common::Vec4<float24> Max(const Common::Vec4<float24>& a, const Common::Vec4<float24>& b) {
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+    return detail::Store(detail::Max(detail::Load(a), detail::Load(b)));
+#else
+    return {a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z,
+            a.w > b.w ? a.w : b.w};
+#endif
+}
+
 } // namespace Pica
+
+#if defined(ARCHITECTURE_x86_64) || defined(ARCHITECTURE_ARM64)
+namespace Common {
+
+// The float24 arithmetic of the shader interpreter, the clipper and the rasterizer mostly runs on
+// whole vectors, these do it four components at a time
+
+template <>
+inline Vec4<Pica::float24> Vec4<Pica::float24>::operator+(const Vec4& other) const {
+    using namespace Pica::detail;
+    return Store(Add(Load(*this), Load(other)));
+}
+
+template <>
+inline Vec4<Pica::float24> Vec4<Pica::float24>::operator-(const Vec4& other) const {
+    using namespace Pica::detail;
+    return Store(Sub(Load(*this), Load(other)));
+}
+
+template <>
+inline Vec4<Pica::float24> Vec4<Pica::float24>::operator*(const Vec4& other) const {
+    using namespace Pica::detail;
+    return Store(Mul(Load(*this), Load(other)));
+}
+
+template <>
+template <>
+inline Vec4<Pica::float24> Vec4<Pica::float24>::operator*(const Pica::float24& f) const {
+    using namespace Pica::detail;
+    return Store(Mul(Load(*this), Splat(f)));
+}
+
+/// The products are summed up one after the other, like the scalar version does
+inline Pica::float24 Dot(const Vec4<Pica::float24>& a, const Vec4<Pica::float24>& b) {
+    const Vec4<Pica::float24> products = a * b;
+    return products.x + products.y + products.z + products.w;
+}
+
+} // namespace Common
+#endif
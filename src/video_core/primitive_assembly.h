@@ -5,7 +5,6 @@
 #pragma once
 
 #include <array>
-#include <functional>
 #include "video_core/regs_pipeline.h"
 
 namespace Pica {
@@ -16,19 +15,36 @@ namespace Pica {
  */
 template <typename VertexType>
 struct PrimitiveAssembler {
-    using TriangleHandler =
-        std::function<void(const VertexType& v0, const VertexType& v1, const VertexType& v2)>;
-
     explicit PrimitiveAssembler(
         PipelineRegs::TriangleTopology topology = PipelineRegs::TriangleTopology::List);
 
     /*
      * Queues a vertex, builds primitives from the vertex queue according to the given
-     * triangle topology, and calls triangle_handler for each generated primitive.
+     * triangle topology, and calls triangle_handler(v0, v1, v2) for each generated primitive.
      * NOTE: We could specify the triangle handler in the constructor, but this way we can
-     * keep event and handler code next to each other.
+     * keep event and handler code next to each other. It is a template parameter rather than a
+     * std::function so that it inlines into the caller, which runs for every software vertex.
      */
-    void SubmitVertex(const VertexType& vtx, const TriangleHandler& triangle_handler);
+    template <typename TriangleHandler>
+    void SubmitVertex(const VertexType& vtx, TriangleHandler&& triangle_handler) {
+        switch (topology) {
+        case PipelineRegs::TriangleTopology::List:
+            SubmitListVertex<false>(vtx, triangle_handler);
+            break;
+        case PipelineRegs::TriangleTopology::Shader:
+            SubmitListVertex<true>(vtx, triangle_handler);
+            break;
+        case PipelineRegs::TriangleTopology::Strip:
+            SubmitStripVertex<false>(vtx, triangle_handler);
+            break;
+        case PipelineRegs::TriangleTopology::Fan:
+            SubmitStripVertex<true>(vtx, triangle_handler);
+            break;
+        default:
+            LogUnknownTopology();
+            break;
+        }
+    }
 
     /**
      * Invert the vertex order of the next triangle. Called by geometry shader emitter.
@@ -57,6 +73,40 @@ struct PrimitiveAssembler {
     PipelineRegs::TriangleTopology GetTopology() const;
 
 private:
+    /// Assembles independent triangles, the Shader topology lets the geometry shader flip them
+    template <bool is_shader, typename TriangleHandler>
+    void SubmitListVertex(const VertexType& vtx, TriangleHandler& triangle_handler) {
+        if (buffer_index < 2) {
+            buffer[buffer_index++] = vtx;
+            return;
+        }
+        buffer_index = 0;
+        if (is_shader && winding) {
+            triangle_handler(buffer[1], buffer[0], vtx);
+            winding = false;
+        } else {
+            triangle_handler(buffer[0], buffer[1], vtx);
+        }
+    }
+
+    /// Assembles triangles sharing the last two vertices (strip) or the first one (fan)
+    template <bool is_fan, typename TriangleHandler>
+    void SubmitStripVertex(const VertexType& vtx, TriangleHandler& triangle_handler) {
+        if (strip_ready)
+            triangle_handler(buffer[0], buffer[1], vtx);
+
+        buffer[buffer_index] = vtx;
+
+        strip_ready |= (buffer_index == 1);
+
+        if (is_fan)
+            buffer_index = 1;
+        else
+            buffer_index = !buffer_index;
+    }
+
+    void LogUnknownTopology() const;
+
     PipelineRegs::TriangleTopology topology;
 
     int buffer_index = 0;
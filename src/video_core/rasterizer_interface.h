@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hw/gpu.h"
 
@@ -11,6 +13,10 @@ namespace OpenGL {
 struct ScreenInfo;
 }
 
+namespace Service::Y2R {
+struct ConversionConfiguration;
+} // namespace Service::Y2R
+
 namespace Pica::Shader {
 struct OutputVertex;
 } // namespace Pica::Shader
@@ -55,6 +61,17 @@ public:
         return false;
     }
 
+    /**
+     * Attempt to perform a Y2R conversion on the GPU, into the surface at the output address
+     * @param config Conversion to perform, its rotation is Rotation::None
+     * @param input Y, U and V planes one after the other, or the interleaved YUYV data
+     * @param dst_addr Physical address of the contiguous output image
+     */
+    virtual bool AccelerateY2RConversion(const Service::Y2R::ConversionConfiguration& config,
+                                         const std::vector<u8>& input, PAddr dst_addr) {
+        return false;
+    }
+
     /// Attempt to use a faster method to fill a region
     virtual bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) {
         return false;
@@ -80,5 +97,13 @@ public:
     /// Handle any config changes, this gets propogated to the backend
     virtual void CheckForConfigChanges() {}
     virtual void OnFrameUpdate() {}
+
+    /// Starts recording the calls of the surface cache to a file, an empty path stops recording
+    virtual void RecordSurfaceTrace(const std::string& path) {}
+
+    /// Replays a recorded surface cache trace and logs where the cache spent its time
+    virtual bool ReplaySurfaceTrace(const std::string& path) {
+        return false;
+    }
 };
 } // namespace VideoCore
@@ -44,8 +44,15 @@ public:
         return render_window;
     }
 
+    /// Steady clock time in nanoseconds the frame drawn by the last TryPresent is due on screen,
+    /// frontends that can schedule the presentation pass it on to the compositor
+    s64 GetPresentTimeNs() const {
+        return present_time_ns;
+    }
+
 protected:
     Frontend::EmuWindow& render_window;
+    s64 present_time_ns = 0;
 };
 
 } // namespace VideoCore
@@ -0,0 +1,131 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/scope_exit.h"
+#include "core/custom_tex_cache.h"
+#include "video_core/renderer_opengl/gl_custom_tex_expander.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL {
+
+using Core::CustomTexFormat;
+
+constexpr char vs_source[] = R"(
+out vec2 tex_coord;
+
+const vec2 vertices[4] =
+    vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+void main() {
+    gl_Position = vec4(vertices[gl_VertexID], 0.0, 1.0);
+    tex_coord = vertices[gl_VertexID] / 2.0 + 0.5;
+}
+)";
+
+// The destination has the size of the source, every fragment copies one texel
+constexpr char fs_source[] = R"(
+in vec2 tex_coord;
+out vec4 frag_color;
+
+uniform sampler2D source;
+uniform ivec2 size;
+
+void main() {
+    frag_color = texelFetch(source, ivec2(tex_coord * vec2(size)), 0);
+}
+)";
+
+static GLenum GetInternalFormat(CustomTexFormat format) {
+    switch (format) {
+    case CustomTexFormat::BC7:
+        return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+    case CustomTexFormat::ASTC4x4:
+        return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+    case CustomTexFormat::ASTC6x6:
+        return GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+    case CustomTexFormat::ASTC8x8:
+        return GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+    default:
+        UNREACHABLE();
+        return GL_NONE;
+    }
+}
+
+CustomTexExpanderOpenGL::CustomTexExpanderOpenGL() = default;
+
+CustomTexExpanderOpenGL::~CustomTexExpanderOpenGL() = default;
+
+u32 CustomTexExpanderOpenGL::GetSupportedFormats() {
+    static const u32 formats = [] {
+        u32 formats = 1u << static_cast<u32>(CustomTexFormat::RGBA8);
+        if (GLAD_GL_ARB_texture_compression_bptc || GLAD_GL_EXT_texture_compression_bptc) {
+            formats |= 1u << static_cast<u32>(CustomTexFormat::BC7);
+        }
+        if (GLAD_GL_KHR_texture_compression_astc_ldr || (GLES && GLAD_GL_ES_VERSION_3_2)) {
+            formats |= (1u << static_cast<u32>(CustomTexFormat::ASTC4x4)) |
+                       (1u << static_cast<u32>(CustomTexFormat::ASTC6x6)) |
+                       (1u << static_cast<u32>(CustomTexFormat::ASTC8x8));
+        }
+        LOG_INFO(Render_OpenGL, "Custom texture packs BC7 {}, ASTC {}",
+                 (formats >> static_cast<u32>(CustomTexFormat::BC7)) & 1 ? "on" : "off",
+                 (formats >> static_cast<u32>(CustomTexFormat::ASTC4x4)) & 1 ? "on" : "off");
+        return formats;
+    }();
+    return formats;
+}
+
+MICROPROFILE_DEFINE(OpenGL_CustomTexExpand, "OpenGL", "Custom Texture Expand",
+                    MP_RGB(128, 192, 64));
+void CustomTexExpanderOpenGL::Expand(const Core::CustomTexInfo& info, GLuint dst_tex,
+                                     const Common::Rectangle<u32>& dst_rect,
+                                     GLuint draw_fb_handle) {
+    MICROPROFILE_SCOPE(OpenGL_CustomTexExpand);
+    if (program.handle == 0) {
+        std::string fs = GLES ? fragment_shader_precision_OES : "";
+        fs += fs_source;
+        program.Create(vs_source, fs.c_str());
+        auto old_program = OpenGLState::BindShaderProgram(program.handle);
+        glUniform1i(glGetUniformLocation(program.handle, "source"), 0);
+        size_loc = glGetUniformLocation(program.handle, "size");
+        OpenGLState::BindShaderProgram(old_program);
+        vao.Create();
+    }
+
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    // Compressed textures can't be attached to a framebuffer, which rules out blits
+    OGLTexture source;
+    source.Create();
+    OpenGLState::BindTexture2D(0, source.handle);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, GetInternalFormat(info.format),
+                           static_cast<GLsizei>(info.width), static_cast<GLsizei>(info.height), 0,
+                           static_cast<GLsizei>(info.packed_size), info.packed_data);
+
+    OpenGLState state;
+    state.texture_units[0].texture_2d = source.handle;
+    state.draw.draw_framebuffer = draw_fb_handle;
+    state.draw.shader_program = program.handle;
+    state.draw.vertex_array = vao.handle;
+    state.viewport = {static_cast<GLint>(dst_rect.left), static_cast<GLint>(dst_rect.bottom),
+                      static_cast<GLsizei>(dst_rect.GetWidth()),
+                      static_cast<GLsizei>(dst_rect.GetHeight())};
+    state.Apply();
+
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst_tex, 0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+    glUniform2i(size_loc, static_cast<GLint>(info.width), static_cast<GLint>(info.height));
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+} // namespace OpenGL
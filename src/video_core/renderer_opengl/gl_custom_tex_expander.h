@@ -0,0 +1,44 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Core {
+struct CustomTexInfo;
+} // namespace Core
+
+namespace OpenGL {
+
+/**
+ * Writes the compressed custom textures of packs to surfaces. Surfaces have to stay renderable,
+ * so the texture is uploaded as it is and a fragment shader draws its texels into the surface.
+ */
+class CustomTexExpanderOpenGL : NonCopyable {
+public:
+    CustomTexExpanderOpenGL();
+    ~CustomTexExpanderOpenGL();
+
+    /// Returns the mask of the Core::CustomTexFormat bits the driver can sample
+    static u32 GetSupportedFormats();
+
+    /**
+     * Draws level 0 of a compressed texture into a texture.
+     * @param dst_rect Rectangle of the destination, of the size of the custom texture
+     * @param draw_fb_handle Framebuffer the destination is attached to while drawing
+     */
+    void Expand(const Core::CustomTexInfo& info, GLuint dst_tex,
+                const Common::Rectangle<u32>& dst_rect, GLuint draw_fb_handle);
+
+private:
+    OGLProgram program;
+    OGLVertexArray vao;
+    GLint size_loc = -1;
+};
+
+} // namespace OpenGL
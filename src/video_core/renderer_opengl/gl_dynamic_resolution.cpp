@@ -0,0 +1,120 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/logging/log.h"
+#include "core/hw/gpu.h"
+#include "core/settings.h"
+#include "video_core/renderer_opengl/gl_dynamic_resolution.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL {
+
+u16 NextDynamicScale(u16 scale, double gpu_ns, double budget_ns, u16 min_scale, u16 max_scale) {
+    // Frames above this part of the budget step down, and stepping up has to leave frames under
+    // the lower one, which keeps the scale from going back and forth
+    constexpr double DownThreshold = 0.9;
+    constexpr double UpThreshold = 0.7;
+
+    scale = std::clamp(scale, min_scale, max_scale);
+    if (gpu_ns > budget_ns * DownThreshold && scale > min_scale) {
+        return static_cast<u16>(scale - 1);
+    }
+    // Most of the GPU time of the frames at high scales goes to their pixels
+    const double next_pixels = static_cast<double>((scale + 1) * (scale + 1)) / (scale * scale);
+    if (gpu_ns * next_pixels < budget_ns * UpThreshold && scale < max_scale) {
+        return static_cast<u16>(scale + 1);
+    }
+    return scale;
+}
+
+DynamicResolution::DynamicResolution(u16 scale, u16 min_scale, u16 max_scale)
+    : scale(std::clamp(scale, min_scale, max_scale)), min_scale(min_scale), max_scale(max_scale) {
+    for (OGLQuery& query : queries) {
+        query.Create();
+    }
+}
+
+DynamicResolution::~DynamicResolution() {
+    if (measuring) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+bool DynamicResolution::IsSupported() {
+    return GLES ? GLAD_GL_EXT_disjoint_timer_query != 0
+                : (GLAD_GL_VERSION_3_3 != 0 || GLAD_GL_ARB_timer_query != 0);
+}
+
+u16 DynamicResolution::FrameUpdate() {
+    if (measuring) {
+        glEndQuery(GL_TIME_ELAPSED);
+        measuring = false;
+        num_pending++;
+    }
+    ReadResults();
+
+    if (measured_frames >= AVERAGED_FRAMES) {
+        const u16 frame_limit = Settings::values.use_frame_limit ? Settings::values.frame_limit : 0;
+        const double budget_ns =
+            1e9 / GPU::SCREEN_REFRESH_RATE * (frame_limit != 0 ? 100.0 / frame_limit : 1.0);
+        const u16 next_scale =
+            NextDynamicScale(scale, static_cast<double>(total_ns) / measured_frames, budget_ns,
+                             min_scale, max_scale);
+        if (next_scale != scale) {
+            LOG_DEBUG(Render_OpenGL, "Render target scale {} -> {}, {} us GPU time per frame",
+                      scale, next_scale, total_ns / measured_frames / 1000);
+            scale = next_scale;
+            num_stale = num_pending;
+        }
+        total_ns = 0;
+        measured_frames = 0;
+    }
+
+    // The frame goes unmeasured when all the queries wait for their results
+    if (num_pending < NUM_QUERIES) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[(first_pending + num_pending) % NUM_QUERIES].handle);
+        measuring = true;
+    }
+    return scale;
+}
+
+void DynamicResolution::ReadResults() {
+    if (GLES) {
+        // The results of the queries in flight are undefined after a disjoint operation, like a
+        // change of the GPU clocks
+        GLint disjoint = GL_FALSE;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        if (disjoint) {
+            num_stale = num_pending;
+        }
+    }
+
+    while (num_pending > 0) {
+        const GLuint query = queries[first_pending].handle;
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+
+        GLuint64 elapsed_ns = 0;
+        if (GLES) {
+            glGetQueryObjectui64vEXT(query, GL_QUERY_RESULT, &elapsed_ns);
+        } else {
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+        }
+        first_pending = (first_pending + 1) % NUM_QUERIES;
+        num_pending--;
+
+        if (num_stale > 0) {
+            num_stale--;
+            continue;
+        }
+        total_ns += elapsed_ns;
+        measured_frames++;
+    }
+}
+
+} // namespace OpenGL
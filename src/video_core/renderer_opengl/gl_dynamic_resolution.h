@@ -0,0 +1,71 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Returns the render target scale of the frames after some that took gpu_ns of GPU time on
+ * average. The scale steps down when the frames take most of the budget, and up when the pixels
+ * of the next scale still fit well in it.
+ */
+u16 NextDynamicScale(u16 scale, double gpu_ns, double budget_ns, u16 min_scale, u16 max_scale);
+
+/**
+ * Measures the GPU time of the frames with GL_TIME_ELAPSED queries and picks the render target
+ * scale between the bounds from it. The results arrive some frames late, so the queries of the
+ * frames in flight are kept in a ring.
+ */
+class DynamicResolution : NonCopyable {
+public:
+    DynamicResolution(u16 scale, u16 min_scale, u16 max_scale);
+    ~DynamicResolution();
+
+    /// Returns true if the driver can measure GPU time
+    static bool IsSupported();
+
+    u16 GetScale() const {
+        return scale;
+    }
+
+    bool HasBounds(u16 min, u16 max) const {
+        return min_scale == min && max_scale == max;
+    }
+
+    /**
+     * Ends the measurement of the frame and starts the one of the next frame
+     * @returns The scale the render targets of the next frame should use
+     */
+    u16 FrameUpdate();
+
+private:
+    /// Frames in flight whose GPU time is measured
+    static constexpr std::size_t NUM_QUERIES = 4;
+    /// Frames averaged before each decision
+    static constexpr u32 AVERAGED_FRAMES = 16;
+
+    /// Adds the finished measurements to the average
+    void ReadResults();
+
+    std::array<OGLQuery, NUM_QUERIES> queries;
+    /// The oldest query waiting for its result, and the count of those
+    std::size_t first_pending = 0;
+    std::size_t num_pending = 0;
+    /// Pending queries of frames drawn before the last scale change, their results are dropped
+    std::size_t num_stale = 0;
+    bool measuring = false;
+
+    u16 scale;
+    u16 min_scale;
+    u16 max_scale;
+    u64 total_ns = 0;
+    u32 measured_frames = 0;
+};
+
+} // namespace OpenGL
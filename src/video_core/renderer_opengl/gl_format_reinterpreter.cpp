@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <string>
+#include <string_view>
 #include "common/assert.h"
 #include "common/scope_exit.h"
 #include "video_core/renderer_opengl/gl_format_reinterpreter.h"
@@ -12,57 +15,31 @@
 namespace OpenGL {
 
 using PixelFormat = SurfaceParams::PixelFormat;
-
-// Virtual Console
-class RGBA4toRGB5A1 final : public FormatReinterpreterBase {
+using SurfaceType = SurfaceParams::SurfaceType;
+
+/**
+ * Reinterprets the bits of one pixel format as another of the same size in a fragment shader.
+ * Every source texel is turned back into the value it has in guest memory, which is then
+ * decoded as the destination format. Stencil can't be exported from the shader portably, so it
+ * is written one bit per pass with the stencil test.
+ */
+class ShaderReinterpreter final : public FormatReinterpreterBase {
 public:
-    RGBA4toRGB5A1() {
-        constexpr std::string_view vs_source = R"(
-out vec2 tex_coord;
-
-const vec2 vertices[4] =
-    vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
-
-void main() {
-    gl_Position = vec4(vertices[gl_VertexID], 0.0, 1.0);
-    tex_coord = (vertices[gl_VertexID] / 2.0 + 0.5);
-}
-)";
-
-        std::string fs_source = GLES ? fragment_shader_precision_OES : "";
-        fs_source += R"(
-in vec2 tex_coord;
-
-out vec4 frag_color;
-
-uniform sampler2D source;
-uniform ivec2 src_size;
-uniform ivec2 src_offset;
-
-void main() {
-    ivec2 coord = ivec2(tex_coord * vec2(src_size)) + src_offset;
-
-    ivec4 rgba4 = ivec4(texelFetch(source, coord, 0) * 15.0f);
-    ivec3 rgb5 = ((rgba4.rgb << ivec3(1, 2, 3)) | (rgba4.gba >> ivec3(3, 2, 1))) & 31;
-    frag_color = vec4(vec3(rgb5) / 31.0, rgba4.a & 1);
-}
-)";
-
-        program.Create(vs_source.data(), fs_source.data());
-        auto old_program = OpenGLState::BindShaderProgram(program.handle);
-        glUniform1i(glGetUniformLocation(program.handle, "source"), 0);
-        src_size_loc = glGetUniformLocation(program.handle, "src_size");
-        src_offset_loc = glGetUniformLocation(program.handle, "src_offset");
-        OpenGLState::BindShaderProgram(old_program);
-        vao.Create();
-    }
+    ShaderReinterpreter(PixelFormat dst_format, PixelFormat src_format)
+        : dst_format(dst_format), src_format(src_format) {}
 
     void Reinterpret(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint read_fb_handle,
                      GLuint dst_tex, const Common::Rectangle<u32>& dst_rect,
                      GLuint draw_fb_handle) override {
+        if (program.handle == 0) {
+            CreateProgram();
+        }
+
         OpenGLState prev_state = OpenGLState::GetCurState();
         SCOPE_EXIT({ prev_state.Apply(); });
 
+        const SurfaceType dst_type = SurfaceParams::GetFormatType(dst_format);
+
         OpenGLState state;
         state.texture_units[0].texture_2d = src_tex;
         state.draw.draw_framebuffer = draw_fb_handle;
@@ -71,108 +48,184 @@ void main() {
         state.viewport = {static_cast<GLint>(dst_rect.left), static_cast<GLint>(dst_rect.bottom),
                           static_cast<GLsizei>(dst_rect.GetWidth()),
                           static_cast<GLsizei>(dst_rect.GetHeight())};
+        if (dst_type == SurfaceType::Depth || dst_type == SurfaceType::DepthStencil) {
+            state.depth.test_enabled = true;
+            state.depth.test_func = GL_ALWAYS;
+        }
+        if (dst_type == SurfaceType::DepthStencil) {
+            // Start from a cleared stencil, the passes below only set bits
+            state.stencil.test_enabled = true;
+            state.stencil.action_depth_pass = GL_REPLACE;
+        }
         state.Apply();
 
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst_tex,
-                               0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
-                               0);
+        if (dst_type == SurfaceType::Depth) {
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                                   dst_tex, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+        } else if (dst_type == SurfaceType::DepthStencil) {
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
+                                   dst_tex, 0);
+        } else {
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                                   dst_tex, 0);
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
+                                   0);
+        }
 
         glUniform2i(src_size_loc, src_rect.GetWidth(), src_rect.GetHeight());
         glUniform2i(src_offset_loc, src_rect.left, src_rect.bottom);
+        glUniform1i(stencil_bit_loc, -1);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        if (dst_type == SurfaceType::DepthStencil) {
+            state.depth.write_mask = GL_FALSE;
+            state.stencil.test_ref = 0xFF;
+            for (GLint bit = 0; bit < 8; ++bit) {
+                state.stencil.write_mask = 1u << bit;
+                state.Apply();
+                glUniform1i(stencil_bit_loc, bit);
+                glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+            }
+        }
     }
 
 private:
-    OGLProgram program;
-    GLint src_size_loc{-1}, src_offset_loc{-1};
-    OGLVertexArray vao;
-};
-
-// Batman
-class ShaderRGBA8toD24S8 final : public FormatReinterpreterBase {
-public:
-    ShaderRGBA8toD24S8() {
-        constexpr std::string_view vs_source = R"(
-out vec2 tex_coord;
-
-const vec2 vertices[4] =
-vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
-
-void main() {
-    gl_Position = vec4(vertices[gl_VertexID], 0.0, 1.0);
-    tex_coord = (vertices[gl_VertexID] / 2.0 + 0.5);
-}
-)";
-
-        std::string fs_source = GLES ? fragment_shader_precision_OES : "";
-        fs_source += R"(
-in vec2 tex_coord;
-
-uniform sampler2D source;
-uniform ivec2 src_size;
-uniform ivec2 src_offset;
-
-void main() {
-    ivec2 coord = ivec2(tex_coord * vec2(src_size)) + src_offset;
-    vec4 rgba = texelFetch(source, coord, 0);
-    gl_FragDepth = 0.0f;
-}
-)";
-
-        program.Create(vs_source.data(), fs_source.data());
-        auto old_program = OpenGLState::BindShaderProgram(program.handle);
-        glUniform1i(glGetUniformLocation(program.handle, "source"), 0);
-        src_size_loc = glGetUniformLocation(program.handle, "src_size");
-        src_offset_loc = glGetUniformLocation(program.handle, "src_offset");
-        OpenGLState::BindShaderProgram(old_program);
-        vao.Create();
+    /// Returns GLSL that rebuilds the guest memory value of a source texel in `value`
+    static std::string_view DecodeSource(PixelFormat format) {
+        switch (format) {
+        case PixelFormat::RGBA8: {
+            return R"(uvec4 c = uvec4(round(texel * 255.0));
+    uint value = (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;)";
+        }
+        case PixelFormat::RGB8: {
+            return R"(uvec4 c = uvec4(round(texel * 255.0));
+    uint value = (c.r << 16) | (c.g << 8) | c.b;)";
+        }
+        case PixelFormat::RGB5A1: {
+            return R"(uvec4 c = uvec4(round(texel * vec4(31.0, 31.0, 31.0, 1.0)));
+    uint value = (c.r << 11) | (c.g << 6) | (c.b << 1) | c.a;)";
+        }
+        case PixelFormat::RGB565: {
+            return R"(uvec4 c = uvec4(round(texel * vec4(31.0, 63.0, 31.0, 0.0)));
+    uint value = (c.r << 11) | (c.g << 5) | c.b;)";
+        }
+        case PixelFormat::RGBA4: {
+            return R"(uvec4 c = uvec4(round(texel * 15.0));
+    uint value = (c.r << 12) | (c.g << 8) | (c.b << 4) | c.a;)";
+        }
+        // Texture formats are stored decoded to RGBA8
+        case PixelFormat::IA8: {
+            return R"(uvec4 c = uvec4(round(texel * 255.0));
+    uint value = (c.r << 8) | c.a;)";
+        }
+        case PixelFormat::RG8: {
+            return R"(uvec4 c = uvec4(round(texel * 255.0));
+    uint value = (c.r << 8) | c.g;)";
+        }
+        case PixelFormat::I8: {
+            return "uint value = uint(round(texel.r * 255.0));";
+        }
+        case PixelFormat::A8: {
+            return "uint value = uint(round(texel.a * 255.0));";
+        }
+        case PixelFormat::IA4: {
+            return R"(uvec4 c = uvec4(round(texel * 15.0));
+    uint value = (c.r << 4) | c.a;)";
+        }
+        case PixelFormat::I4: {
+            return "uint value = uint(round(texel.r * 15.0));";
+        }
+        case PixelFormat::A4: {
+            return "uint value = uint(round(texel.a * 15.0));";
+        }
+        case PixelFormat::D16: {
+            return "uint value = uint(round(texel.r * 65535.0));";
+        }
+        case PixelFormat::D24: {
+            return "uint value = uint(round(texel.r * 16777215.0));";
+        }
+        default:
+            UNREACHABLE_MSG("Unsupported source format {}", format);
+            return "uint value = 0u;";
+        }
     }
 
-    void Reinterpret(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint read_fb_handle,
-                     GLuint dst_tex, const Common::Rectangle<u32>& dst_rect,
-                     GLuint draw_fb_handle) override {
-        OpenGLState prev_state = OpenGLState::GetCurState();
-        SCOPE_EXIT({ prev_state.Apply(); });
-
-        OpenGLState state;
-        state.texture_units[0].texture_2d = src_tex;
-        state.draw.draw_framebuffer = draw_fb_handle;
-        state.draw.shader_program = program.handle;
-        state.draw.vertex_array = vao.handle;
-        state.viewport = {static_cast<GLint>(dst_rect.left), static_cast<GLint>(dst_rect.bottom),
-                          static_cast<GLsizei>(dst_rect.GetWidth()),
-                          static_cast<GLsizei>(dst_rect.GetHeight())};
-        state.Apply();
-
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D,
-                               dst_tex, 0);
-
-        glUniform2i(src_size_loc, src_rect.GetWidth(), src_rect.GetHeight());
-        glUniform2i(src_offset_loc, src_rect.left, src_rect.bottom);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    /// Returns GLSL that writes `value` decoded as the destination format
+    static std::string_view EncodeDestination(PixelFormat format) {
+        switch (format) {
+        case PixelFormat::RGBA8: {
+            return "frag_color = vec4((uvec4(value) >> uvec4(24, 16, 8, 0)) & 255u) / 255.0;";
+        }
+        case PixelFormat::RGB8: {
+            return "frag_color = vec4(vec3((uvec3(value) >> uvec3(16, 8, 0)) & 255u) / 255.0, "
+                   "1.0);";
+        }
+        case PixelFormat::RGB5A1: {
+            return R"(uvec4 c = (uvec4(value) >> uvec4(11, 6, 1, 0)) & uvec4(31u, 31u, 31u, 1u);
+    frag_color = vec4(c) / vec4(31.0, 31.0, 31.0, 1.0);)";
+        }
+        case PixelFormat::RGB565: {
+            return R"(uvec3 c = (uvec3(value) >> uvec3(11, 5, 0)) & uvec3(31u, 63u, 31u);
+    frag_color = vec4(vec3(c) / vec3(31.0, 63.0, 31.0), 1.0);)";
+        }
+        case PixelFormat::RGBA4: {
+            return "frag_color = vec4((uvec4(value) >> uvec4(12, 8, 4, 0)) & 15u) / 15.0;";
+        }
+        case PixelFormat::IA8: {
+            return R"(vec2 c = vec2((uvec2(value) >> uvec2(8, 0)) & 255u) / 255.0;
+    frag_color = c.xxxy;)";
+        }
+        case PixelFormat::RG8: {
+            return R"(vec2 c = vec2((uvec2(value) >> uvec2(8, 0)) & 255u) / 255.0;
+    frag_color = vec4(c, 0.0, 1.0);)";
+        }
+        case PixelFormat::I8: {
+            return "frag_color = vec4(vec3(float(value & 255u) / 255.0), 1.0);";
+        }
+        case PixelFormat::A8: {
+            return "frag_color = vec4(0.0, 0.0, 0.0, float(value & 255u) / 255.0);";
+        }
+        case PixelFormat::IA4: {
+            return R"(vec2 c = vec2((uvec2(value) >> uvec2(4, 0)) & 15u) / 15.0;
+    frag_color = c.xxxy;)";
+        }
+        case PixelFormat::I4: {
+            return "frag_color = vec4(vec3(float(value & 15u) / 15.0), 1.0);";
+        }
+        case PixelFormat::A4: {
+            return "frag_color = vec4(0.0, 0.0, 0.0, float(value & 15u) / 15.0);";
+        }
+        case PixelFormat::D16: {
+            return "gl_FragDepth = float(value & 0xFFFFu) / 65535.0;";
+        }
+        case PixelFormat::D24: {
+            return "gl_FragDepth = float(value & 0xFFFFFFu) / 16777215.0;";
+        }
+        case PixelFormat::D24S8: {
+            return R"(if (stencil_bit >= 0 && ((value >> (24 + stencil_bit)) & 1u) == 0u) {
+        discard;
+    }
+    gl_FragDepth = float(value & 0xFFFFFFu) / 16777215.0;)";
+        }
+        default:
+            UNREACHABLE_MSG("Unsupported destination format {}", format);
+            return "";
+        }
     }
 
-private:
-    OGLProgram program;
-    GLint src_size_loc{-1}, src_offset_loc{-1};
-    OGLVertexArray vao;
-};
-
-// Dead or Alive
-class ShaderD16toRG8 final : public FormatReinterpreterBase {
-public:
-    ShaderD16toRG8() {
+    void CreateProgram() {
         constexpr std::string_view vs_source = R"(
 out vec2 tex_coord;
 
 const vec2 vertices[4] =
-vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+    vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
 
 void main() {
     gl_Position = vec4(vertices[gl_VertexID], 0.0, 1.0);
-    tex_coord = (vertices[gl_VertexID] / 2.0 + 0.5);
+    tex_coord = vertices[gl_VertexID] / 2.0 + 0.5;
 }
 )";
 
@@ -181,56 +234,34 @@ void main() {
 in vec2 tex_coord;
 out vec4 frag_color;
 
-uniform usampler2D depth;
+uniform sampler2D source;
 uniform ivec2 src_size;
 uniform ivec2 src_offset;
+uniform int stencil_bit;
 
 void main() {
     ivec2 coord = ivec2(tex_coord * vec2(src_size)) + src_offset;
-    uint depth_val = texelFetch(depth, coord, 0).x;
-    uvec2 components = (uvec2(depth_val) >> uvec2(8u, 0u)) & 255u;
-    frag_color = vec4(vec2(components) / 255.0f, 0.0f, 0.0f);
-}
-)";
-
-        program.Create(vs_source.data(), fs_source.data());
+    vec4 texel = texelFetch(source, coord, 0);
+    )";
+        fs_source += DecodeSource(src_format);
+        fs_source += "\n    ";
+        fs_source += EncodeDestination(dst_format);
+        fs_source += "\n}\n";
+
+        program.Create(vs_source.data(), fs_source.c_str());
         auto old_program = OpenGLState::BindShaderProgram(program.handle);
         glUniform1i(glGetUniformLocation(program.handle, "source"), 0);
         src_size_loc = glGetUniformLocation(program.handle, "src_size");
         src_offset_loc = glGetUniformLocation(program.handle, "src_offset");
+        stencil_bit_loc = glGetUniformLocation(program.handle, "stencil_bit");
         OpenGLState::BindShaderProgram(old_program);
         vao.Create();
     }
 
-    void Reinterpret(GLuint src_tex, const Common::Rectangle<u32>& src_rect, GLuint read_fb_handle,
-                     GLuint dst_tex, const Common::Rectangle<u32>& dst_rect,
-                     GLuint draw_fb_handle) override {
-        OpenGLState prev_state = OpenGLState::GetCurState();
-        SCOPE_EXIT({ prev_state.Apply(); });
-
-        OpenGLState state;
-        state.texture_units[0].texture_2d = src_tex;
-        state.draw.draw_framebuffer = draw_fb_handle;
-        state.draw.shader_program = program.handle;
-        state.draw.vertex_array = vao.handle;
-        state.viewport = {static_cast<GLint>(dst_rect.left), static_cast<GLint>(dst_rect.bottom),
-                          static_cast<GLsizei>(dst_rect.GetWidth()),
-                          static_cast<GLsizei>(dst_rect.GetHeight())};
-        state.Apply();
-
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst_tex,
-                               0);
-        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
-                               0);
-
-        glUniform2i(src_size_loc, src_rect.GetWidth(), src_rect.GetHeight());
-        glUniform2i(src_offset_loc, src_rect.left, src_rect.bottom);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    }
-
-private:
+    const PixelFormat dst_format;
+    const PixelFormat src_format;
     OGLProgram program;
-    GLint src_size_loc{-1}, src_offset_loc{-1};
+    GLint src_size_loc{-1}, src_offset_loc{-1}, stencil_bit_loc{-1};
     OGLVertexArray vao;
 };
 
@@ -494,12 +525,27 @@ FormatReinterpreterOpenGL::FormatReinterpreterOpenGL() {
                                     std::make_unique<PixelBufferD24S8toABGR>());
         LOG_INFO(Render_OpenGL, "Using pbo for D24S8 to RGBA8 reinterpretation");
     }
-    reinterpreters.emplace_back(PixelFormat::D24S8, PixelFormat::RGBA8,
-                                std::make_unique<ShaderRGBA8toD24S8>());
-    reinterpreters.emplace_back(PixelFormat::RG8, PixelFormat::D16,
-                                std::make_unique<ShaderD16toRG8>());
-    reinterpreters.emplace_back(PixelFormat::RGB5A1, PixelFormat::RGBA4,
-                                std::make_unique<RGBA4toRGB5A1>());
+
+    // ETC1 and ETC1A4 are block compressed and have no per-pixel bit pattern to reinterpret
+    static constexpr std::array<PixelFormat, 15> formats{
+        PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB5A1, PixelFormat::RGB565,
+        PixelFormat::RGBA4, PixelFormat::IA8,  PixelFormat::RG8,    PixelFormat::I8,
+        PixelFormat::A8,    PixelFormat::IA4,  PixelFormat::I4,     PixelFormat::A4,
+        PixelFormat::D16,   PixelFormat::D24,  PixelFormat::D24S8,
+    };
+    for (PixelFormat dst_format : formats) {
+        for (PixelFormat src_format : formats) {
+            // D24S8 sources need their stencil sampled separately, see the special cases above
+            if (dst_format == src_format || src_format == PixelFormat::D24S8 ||
+                SurfaceParams::GetFormatBpp(dst_format) !=
+                    SurfaceParams::GetFormatBpp(src_format)) {
+                continue;
+            }
+            reinterpreters.emplace_back(
+                dst_format, src_format,
+                std::make_unique<ShaderReinterpreter>(dst_format, src_format));
+        }
+    }
 }
 
 FormatReinterpreterOpenGL::~FormatReinterpreterOpenGL() = default;
@@ -0,0 +1,257 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+#include "video_core/renderer_opengl/gl_gpu_profiler.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL::GPUProfiler {
+
+namespace {
+
+using VideoCore::GPUTiming::FrameTimings;
+using VideoCore::GPUTiming::Section;
+using VideoCore::GPUTiming::SectionType;
+
+/// Frames in flight whose GPU time is measured
+constexpr std::size_t NUM_FRAMES = 4;
+
+struct TimedSection {
+    SectionType type;
+    PAddr color_addr;
+    PAddr depth_addr;
+    u32 draws;
+    /// The timestamp of the beginning, the one of the end follows it
+    std::size_t query;
+};
+
+struct Frame {
+    /// Queries of the earlier frames that used this one are reused
+    std::vector<OGLQuery> queries;
+    std::size_t num_queries = 0;
+    std::vector<TimedSection> sections;
+    u32 draws = 0;
+    u32 state_changes = 0;
+};
+
+class Profiler {
+public:
+    void CountDraw(PAddr color_addr, PAddr depth_addr) {
+        if (!measuring) {
+            return;
+        }
+        Frame& frame = CurrentFrame();
+        frame.draws++;
+        if (nesting > 0) {
+            return;
+        }
+        if (!section_open || frame.sections.back().type != SectionType::Pass ||
+            frame.sections.back().color_addr != color_addr ||
+            frame.sections.back().depth_addr != depth_addr) {
+            BeginSection(SectionType::Pass, color_addr, depth_addr);
+        }
+        frame.sections.back().draws++;
+    }
+
+    /// Returns true if the section is timed, which only the outermost ones are
+    bool BeginScope(SectionType type) {
+        if (!measuring) {
+            return false;
+        }
+        if (nesting++ == 0) {
+            BeginSection(type, 0, 0);
+        }
+        return true;
+    }
+
+    void EndScope() {
+        if (--nesting == 0) {
+            EndSection();
+        }
+    }
+
+    void FrameUpdate() {
+        if (measuring) {
+            EndSection();
+            CurrentFrame().state_changes = OpenGLState::TakeAppliedCalls();
+            measuring = false;
+            num_pending++;
+        }
+        ReadResults();
+
+        // The frame goes unmeasured when all the frames wait for their results
+        if (num_pending < NUM_FRAMES) {
+            Frame& frame = CurrentFrame();
+            frame.num_queries = 0;
+            frame.sections.clear();
+            frame.draws = 0;
+            OpenGLState::TakeAppliedCalls();
+            measuring = true;
+        }
+    }
+
+private:
+    Frame& CurrentFrame() {
+        return frames[(first_pending + num_pending) % NUM_FRAMES];
+    }
+
+    std::size_t WriteTimestamp() {
+        Frame& frame = CurrentFrame();
+        if (frame.num_queries == frame.queries.size()) {
+            frame.queries.emplace_back().Create();
+        }
+        const GLuint query = frame.queries[frame.num_queries].handle;
+        if (GLES) {
+            glQueryCounterEXT(query, GL_TIMESTAMP_EXT);
+        } else {
+            glQueryCounter(query, GL_TIMESTAMP);
+        }
+        return frame.num_queries++;
+    }
+
+    void BeginSection(SectionType type, PAddr color_addr, PAddr depth_addr) {
+        EndSection();
+        CurrentFrame().sections.push_back({type, color_addr, depth_addr, 0, WriteTimestamp()});
+        section_open = true;
+    }
+
+    void EndSection() {
+        if (section_open) {
+            WriteTimestamp();
+            section_open = false;
+        }
+    }
+
+    static bool IsAvailable(const Frame& frame) {
+        if (frame.num_queries == 0) {
+            return true;
+        }
+        // The timestamps are written in order, so the others are available with the last one
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(frame.queries[frame.num_queries - 1].handle,
+                            GL_QUERY_RESULT_AVAILABLE, &available);
+        return available != GL_FALSE;
+    }
+
+    void ReadResults() {
+        if (GLES) {
+            // The results of the queries in flight are undefined after a disjoint operation, like
+            // a change of the GPU clocks
+            GLint disjoint = GL_FALSE;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            if (disjoint) {
+                first_pending = (first_pending + num_pending) % NUM_FRAMES;
+                num_pending = 0;
+                return;
+            }
+        }
+
+        // Only the newest of the frames whose results arrived is shown
+        const Frame* newest = nullptr;
+        while (num_pending > 0 && IsAvailable(frames[first_pending])) {
+            newest = &frames[first_pending];
+            first_pending = (first_pending + 1) % NUM_FRAMES;
+            num_pending--;
+        }
+        if (newest != nullptr) {
+            VideoCore::GPUTiming::Publish(ReadFrame(*newest));
+        }
+    }
+
+    FrameTimings ReadFrame(const Frame& frame) {
+        std::vector<GLuint64> timestamps(frame.num_queries);
+        for (std::size_t i = 0; i < frame.num_queries; ++i) {
+            if (GLES) {
+                glGetQueryObjectui64vEXT(frame.queries[i].handle, GL_QUERY_RESULT, &timestamps[i]);
+            } else {
+                glGetQueryObjectui64v(frame.queries[i].handle, GL_QUERY_RESULT, &timestamps[i]);
+            }
+        }
+
+        FrameTimings timings;
+        timings.frame = ++measured_frames;
+        timings.draws = frame.draws;
+        timings.state_changes = frame.state_changes;
+        for (const TimedSection& timed : frame.sections) {
+            const u64 gpu_ns = timestamps[timed.query + 1] - timestamps[timed.query];
+            timings.gpu_ns += gpu_ns;
+
+            // The passes into the same attachments and the other sections of a type are summed
+            const auto it = std::find_if(
+                timings.sections.begin(), timings.sections.end(), [&timed](const Section& section) {
+                    return section.type == timed.type && section.color_addr == timed.color_addr &&
+                           section.depth_addr == timed.depth_addr;
+                });
+            if (it == timings.sections.end()) {
+                timings.sections.push_back(
+                    {timed.type, timed.color_addr, timed.depth_addr, 1, timed.draws, gpu_ns});
+            } else {
+                it->count++;
+                it->draws += timed.draws;
+                it->gpu_ns += gpu_ns;
+            }
+        }
+        std::stable_partition(
+            timings.sections.begin(), timings.sections.end(),
+            [](const Section& section) { return section.type == SectionType::Pass; });
+        return timings;
+    }
+
+    std::array<Frame, NUM_FRAMES> frames;
+    /// The oldest frame waiting for its results, and the count of those
+    std::size_t first_pending = 0;
+    std::size_t num_pending = 0;
+    bool measuring = false;
+    bool section_open = false;
+    /// The scopes the running section is in
+    u32 nesting = 0;
+    u64 measured_frames = 0;
+};
+
+std::unique_ptr<Profiler> profiler;
+
+} // Anonymous namespace
+
+bool IsSupported() {
+    return GLES ? GLAD_GL_EXT_disjoint_timer_query != 0
+                : (GLAD_GL_VERSION_3_3 != 0 || GLAD_GL_ARB_timer_query != 0);
+}
+
+void CountDraw(PAddr color_addr, PAddr depth_addr) {
+    if (profiler) {
+        profiler->CountDraw(color_addr, depth_addr);
+    }
+}
+
+void FrameUpdate() {
+    const bool enabled = VideoCore::GPUTiming::IsEnabled() && IsSupported();
+    if (enabled && !profiler) {
+        profiler = std::make_unique<Profiler>();
+    } else if (!enabled && profiler) {
+        profiler.reset();
+    }
+    if (profiler) {
+        profiler->FrameUpdate();
+    }
+}
+
+void Shutdown() {
+    profiler.reset();
+}
+
+Scope::Scope(VideoCore::GPUTiming::SectionType type)
+    : active(profiler && profiler->BeginScope(type)) {}
+
+Scope::~Scope() {
+    if (active) {
+        profiler->EndScope();
+    }
+}
+
+} // namespace OpenGL::GPUProfiler
@@ -0,0 +1,45 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "video_core/gpu_timing.h"
+
+/**
+ * Measures the GPU time of the passes, the surface uploads, the blits and the drawing of the
+ * screens with GL_TIMESTAMP queries, for VideoCore::GPUTiming. Each frame keeps its queries until
+ * their results arrive some frames later. All of it runs on the render thread, and does nothing
+ * while the measurements are disabled.
+ */
+namespace OpenGL::GPUProfiler {
+
+/// Returns true if the driver can measure GPU time
+bool IsSupported();
+
+/**
+ * Counts a draw into the framebuffer with the given attachments. A new pass begins when the
+ * attachments differ from the ones of the running pass or after another section.
+ */
+void CountDraw(PAddr color_addr, PAddr depth_addr);
+
+/// Ends the measured frame, publishes the oldest frame whose results arrived, and starts or stops
+/// the measurements following VideoCore::GPUTiming
+void FrameUpdate();
+
+/// Releases the queries, while the context is still current
+void Shutdown();
+
+/// Times a section of the work until the end of its scope. The sections nested in it count as
+/// part of it.
+class Scope : NonCopyable {
+public:
+    explicit Scope(VideoCore::GPUTiming::SectionType type);
+    ~Scope();
+
+private:
+    bool active;
+};
+
+} // namespace OpenGL::GPUProfiler
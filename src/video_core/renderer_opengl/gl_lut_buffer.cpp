@@ -0,0 +1,74 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/hash.h"
+#include "video_core/renderer_opengl/gl_lut_buffer.h"
+
+namespace OpenGL {
+
+OGLLUTBuffer::OGLLUTBuffer(GLsizeiptr slot_size, std::size_t num_slots, std::size_t num_users)
+    : slot_size(slot_size), slots(num_slots), user_slots(num_users, num_slots) {
+    // Every user holds a slot, one more is needed to switch a LUT
+    ASSERT(num_slots > num_users);
+    gl_buffer.Create();
+    glBindBuffer(GL_TEXTURE_BUFFER, gl_buffer.handle);
+    glBufferData(GL_TEXTURE_BUFFER, slot_size * num_slots, nullptr, GL_DYNAMIC_DRAW);
+}
+
+OGLLUTBuffer::~OGLLUTBuffer() = default;
+
+GLintptr OGLLUTBuffer::Upload(std::size_t user, const void* data, GLsizeiptr size) {
+    ASSERT(size <= slot_size);
+    const u64 hash = Common::ComputeHash64(data, static_cast<u32>(size));
+
+    std::size_t index;
+    auto it = slot_map.find(hash);
+    if (it != slot_map.end()) {
+        index = it->second;
+    } else {
+        index = FindFreeSlot();
+        Slot& slot = slots[index];
+        if (slot.valid) {
+            slot_map.erase(slot.hash);
+        }
+        slot.hash = hash;
+        slot.valid = true;
+        slot_map.emplace(hash, index);
+
+        // The driver keeps draws that still read the old contents of the slot correct
+        glBindBuffer(GL_TEXTURE_BUFFER, gl_buffer.handle);
+        glBufferSubData(GL_TEXTURE_BUFFER, slot_size * index, size, data);
+    }
+
+    std::size_t& user_slot = user_slots[user];
+    if (user_slot != index) {
+        if (user_slot != slots.size()) {
+            --slots[user_slot].users;
+        }
+        ++slots[index].users;
+        user_slot = index;
+    }
+    slots[index].last_use = ++use_counter;
+    return slot_size * index;
+}
+
+std::size_t OGLLUTBuffer::FindFreeSlot() const {
+    std::size_t best = slots.size();
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].users != 0) {
+            continue;
+        }
+        if (!slots[i].valid) {
+            return i;
+        }
+        if (best == slots.size() || slots[i].last_use < slots[best].last_use) {
+            best = i;
+        }
+    }
+    ASSERT(best != slots.size());
+    return best;
+}
+
+} // namespace OpenGL
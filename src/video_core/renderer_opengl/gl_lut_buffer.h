@@ -0,0 +1,63 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Texture buffer of fixed size slots holding LUTs. A LUT is only uploaded when no slot holds its
+ * contents yet, so LUTs that switch between a few tables keep their offsets, and with them the
+ * uniform block. Each user, e.g. a lighting sampler, holds one slot at a time, the slots nobody
+ * holds are reused in least recently used order.
+ */
+class OGLLUTBuffer : private NonCopyable {
+public:
+    OGLLUTBuffer(GLsizeiptr slot_size, std::size_t num_slots, std::size_t num_users);
+    ~OGLLUTBuffer();
+
+    GLuint GetHandle() const {
+        return gl_buffer.handle;
+    }
+
+    /// Returns true if the user holds a slot, i.e. uploaded a LUT before
+    bool IsHeld(std::size_t user) const {
+        return user_slots[user] != slots.size();
+    }
+
+    /**
+     * Makes a user hold the slot with the given LUT, uploading it to a free slot if needed.
+     * @param size Size of the LUT in bytes, at most the slot size
+     * @returns Offset of the slot in bytes
+     */
+    GLintptr Upload(std::size_t user, const void* data, GLsizeiptr size);
+
+private:
+    struct Slot {
+        u64 hash = 0;
+        u32 users = 0;
+        u64 last_use = 0;
+        bool valid = false;
+    };
+
+    /// Returns the least recently used slot no user holds
+    std::size_t FindFreeSlot() const;
+
+    OGLBuffer gl_buffer;
+    GLsizeiptr slot_size;
+    std::vector<Slot> slots;
+    /// Slot holding each LUT by its hash
+    std::unordered_map<u64, std::size_t> slot_map;
+    /// Slot held by each user, or num_slots
+    std::vector<std::size_t> user_slots;
+    u64 use_counter = 0;
+};
+
+} // namespace OpenGL
@@ -0,0 +1,290 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "common/string_util.h"
+#include "video_core/renderer_opengl/gl_post_processing.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+#include "video_core/renderer_opengl/renderer_opengl.h"
+
+namespace OpenGL {
+
+/// Textures of other sizes kept in the pool, e.g. after the resolution changed
+constexpr std::size_t MAX_FREE_TARGETS = 4;
+
+static const char post_processing_header[] = R"(
+// hlsl to glsl types
+#define float2 vec2
+#define float3 vec3
+#define float4 vec4
+#define uint2 uvec2
+#define uint3 uvec3
+#define uint4 uvec4
+#define int2 ivec2
+#define int3 ivec3
+#define int4 ivec4
+
+in float2 frag_tex_coord;
+out float4 output_color;
+
+uniform float4 resolution;
+uniform sampler2D color_texture;
+
+float4 Sample() { return texture(color_texture, frag_tex_coord); }
+float4 SampleLocation(float2 location) { return texture(color_texture, location); }
+float4 SampleFetch(int2 location) { return texelFetch(color_texture, location, 0); }
+int2 SampleSize() { return textureSize(color_texture, 0); }
+float2 GetResolution() { return resolution.xy; }
+float2 GetInvResolution() { return resolution.zw; }
+float2 GetCoordinates() { return frag_tex_coord; }
+void SetOutput(float4 color) { output_color = color; }
+)";
+
+/// Covers the whole target, and the part of the source texture the screen shows
+static const char pass_vertex_shader[] = R"(
+out vec2 frag_tex_coord;
+uniform vec4 src_rect;
+void main() {
+    vec2 rawpos = vec2(gl_VertexID & 1, (gl_VertexID & 2) >> 1);
+    frag_tex_coord = mix(src_rect.xy, src_rect.zw, rawpos);
+    gl_Position = vec4(rawpos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static void ParsePostShaderOptions(const std::string& shader,
+                                   std::unordered_map<std::string, std::string>& options) {
+    std::size_t i = 0;
+    std::size_t size = shader.size();
+
+    std::string key;
+    std::string value;
+
+    bool is_line_begin = true;
+    u32 slash_counter = 0;
+    bool is_option_key = false;
+    bool is_option_value = false;
+    while (i < size) {
+        char c = shader[i++];
+        switch (c) {
+        case '/':
+            slash_counter += 1;
+            break;
+        case '!':
+            if (is_line_begin && (slash_counter == 2)) {
+                is_option_key = true;
+            }
+            is_line_begin = false;
+            break;
+        case '=':
+            if (is_option_key) {
+                is_option_key = false;
+                is_option_value = true;
+            }
+            is_line_begin = false;
+            break;
+        case ' ':
+        case '\t':
+            is_line_begin = false;
+            break;
+        case '\n':
+        case '\r':
+            is_line_begin = true;
+            is_option_key = false;
+            is_option_value = false;
+            slash_counter = 0;
+            if (!key.empty() && !value.empty()) {
+                options[key] = value;
+                key.clear();
+                value.clear();
+            }
+            break;
+        default:
+            if (is_option_key) {
+                key += c;
+            } else if (is_option_value) {
+                value += c;
+            }
+            is_line_begin = false;
+            break;
+        }
+    }
+}
+
+bool LoadPostShader(const std::string& name, std::string& source,
+                    std::unordered_map<std::string, std::string>& options) {
+    std::string shader;
+    const std::string path = FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + name + ".glsl";
+    std::size_t size = FileUtil::ReadFileToString(true, path, shader);
+    if (size == 0 || size != shader.size()) {
+        return false;
+    }
+    ParsePostShaderOptions(shader, options);
+    source += post_processing_header;
+    source += shader;
+    return true;
+}
+
+PostProcessingChain::PostProcessingChain() = default;
+
+PostProcessingChain::~PostProcessingChain() = default;
+
+bool PostProcessingChain::Load(const std::string& pass_list) {
+    std::vector<std::string> names;
+    Common::SplitString(pass_list, ',', names);
+    for (const auto& entry : names) {
+        if (entry.empty()) {
+            continue;
+        }
+        const std::size_t colon = entry.find(':');
+        const std::string name = entry.substr(0, colon);
+        float scale = 1.0f;
+        if (colon != std::string::npos) {
+            scale = std::strtof(entry.c_str() + colon + 1, nullptr);
+            if (!(scale > 0.0f)) {
+                LOG_ERROR(Render_OpenGL, "Invalid scale of post-processing pass {}", entry);
+                scale = 1.0f;
+            }
+        }
+
+        std::string frag_source;
+        if (GLES) {
+            frag_source += fragment_shader_precision_OES;
+        }
+        std::unordered_map<std::string, std::string> options;
+        if (!LoadPostShader(name, frag_source, options)) {
+            LOG_ERROR(Render_OpenGL, "Failed to load post-processing pass {}", name);
+            passes.clear();
+            return false;
+        }
+
+        Pass& pass = passes.emplace_back();
+        pass.program.Create(pass_vertex_shader, frag_source.data());
+        pass.scale = scale;
+        pass.resolution_loc = glGetUniformLocation(pass.program.handle, "resolution");
+        pass.src_rect_loc = glGetUniformLocation(pass.program.handle, "src_rect");
+
+        pass.sampler.Create();
+        glSamplerParameteri(pass.sampler.handle, GL_TEXTURE_MAG_FILTER,
+                            options["mag_filter"] != "nearest" ? GL_LINEAR : GL_NEAREST);
+        glSamplerParameteri(pass.sampler.handle, GL_TEXTURE_MIN_FILTER,
+                            options["min_filter"] != "nearest" ? GL_LINEAR : GL_NEAREST);
+        glSamplerParameteri(pass.sampler.handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glSamplerParameteri(pass.sampler.handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        LOG_INFO(Render_OpenGL, "Post-processing pass {} at scale {}", name, scale);
+    }
+
+    if (!passes.empty() && vao.handle == 0) {
+        vao.Create();
+    }
+    return true;
+}
+
+PostProcessingChain::Output PostProcessingChain::Run(std::size_t index,
+                                                     const ScreenInfo& screen_info, float width,
+                                                     float height) {
+    ScreenState& screen = screens[index];
+
+    // A static screen, e.g. a menu on the bottom screen, is only processed once
+    const bool unchanged =
+        screen_info.display_version != 0 &&
+        screen_info.display_version == screen.source_version &&
+        screen_info.display_texture == screen.source_texture &&
+        screen_info.display_texcoords == screen.source_texcoords &&
+        width == screen.source_width && height == screen.source_height;
+    if (!unchanged) {
+        OpenGLState prev_state = OpenGLState::GetCurState();
+        SCOPE_EXIT({ prev_state.Apply(); });
+
+        screen.targets.resize(passes.size());
+        OpenGLState state;
+        state.draw.vertex_array = vao.handle;
+
+        GLuint src_texture = screen_info.display_texture;
+        // Texture coordinates of the screen are stored rotated
+        const auto& texcoords = screen_info.display_texcoords;
+        std::array<GLfloat, 4> src_rect{texcoords.top, texcoords.left, texcoords.bottom,
+                                        texcoords.right};
+        float src_width = width;
+        float src_height = height;
+        for (std::size_t i = 0; i < passes.size(); ++i) {
+            const Pass& pass = passes[i];
+            const GLsizei dst_width = std::max(1, static_cast<GLsizei>(width * pass.scale));
+            const GLsizei dst_height = std::max(1, static_cast<GLsizei>(height * pass.scale));
+            Target& target = screen.targets[i];
+            if (target.width != dst_width || target.height != dst_height) {
+                if (target.texture.handle != 0) {
+                    free_targets.push_back(std::move(target));
+                }
+                target = AcquireTarget(dst_width, dst_height);
+            }
+
+            state.texture_units[0].texture_2d = src_texture;
+            state.texture_units[0].sampler = pass.sampler.handle;
+            state.draw.draw_framebuffer = target.framebuffer.handle;
+            state.draw.shader_program = pass.program.handle;
+            state.viewport = {0, 0, dst_width, dst_height};
+            state.Apply();
+
+            glUniform4f(pass.resolution_loc, src_width, src_height, 1.0f / src_width,
+                        1.0f / src_height);
+            glUniform4fv(pass.src_rect_loc, 1, src_rect.data());
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+            src_texture = target.texture.handle;
+            src_rect = {0.0f, 0.0f, 1.0f, 1.0f};
+            src_width = static_cast<float>(dst_width);
+            src_height = static_cast<float>(dst_height);
+        }
+
+        screen.source_texture = screen_info.display_texture;
+        screen.source_texcoords = screen_info.display_texcoords;
+        screen.source_version = screen_info.display_version;
+        screen.source_width = width;
+        screen.source_height = height;
+    }
+
+    const Target& last = screen.targets.back();
+    return {last.texture.handle, Common::Rectangle<float>(0.0f, 0.0f, 1.0f, 1.0f),
+            static_cast<float>(last.width), static_cast<float>(last.height)};
+}
+
+PostProcessingChain::Target PostProcessingChain::AcquireTarget(GLsizei width, GLsizei height) {
+    auto it = std::find_if(free_targets.begin(), free_targets.end(), [=](const Target& target) {
+        return target.width == width && target.height == height;
+    });
+    if (it != free_targets.end()) {
+        Target target = std::move(*it);
+        free_targets.erase(it);
+        return target;
+    }
+    if (free_targets.size() > MAX_FREE_TARGETS) {
+        free_targets.erase(free_targets.begin());
+    }
+
+    Target target;
+    target.width = width;
+    target.height = height;
+    target.texture.Create();
+    GLuint old_tex = OpenGLState::BindTexture2D(0, target.texture.handle);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    OpenGLState::BindTexture2D(0, old_tex);
+
+    target.framebuffer.Create();
+    GLuint old_fb = OpenGLState::BindDrawFramebuffer(target.framebuffer.handle);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           target.texture.handle, 0);
+    OpenGLState::BindDrawFramebuffer(old_fb);
+    return target;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,99 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+struct ScreenInfo;
+
+/**
+ * Reads a post-processing shader of the shader directory, and prepends the header declaring its
+ * helper functions.
+ * option example: //! key = value
+ * @returns false if the shader couldn't be read
+ */
+bool LoadPostShader(const std::string& name, std::string& source,
+                    std::unordered_map<std::string, std::string>& options);
+
+/**
+ * Runs the passes a post-processing shader lists before itself, e.g.
+ * //! passes = downsample:0.5, bloom:0.5
+ * Each pass draws the whole screen into an intermediate texture of the source size times its
+ * scale, which the next pass samples. The selected shader stays the last pass and draws the
+ * output of the chain to the window. The intermediate framebuffers come from a pool, and a
+ * screen whose display texture didn't change since the last frame keeps its output.
+ */
+class PostProcessingChain : NonCopyable {
+public:
+    /// The texture the last pass samples for a screen
+    struct Output {
+        GLuint texture;
+        Common::Rectangle<float> texcoords;
+        float width;
+        float height;
+    };
+
+    PostProcessingChain();
+    ~PostProcessingChain();
+
+    /// Compiles the listed passes, returns false if one of them can't be loaded
+    bool Load(const std::string& passes);
+
+    bool IsEmpty() const {
+        return passes.empty();
+    }
+
+    /**
+     * Runs the chain on a screen, the state is restored afterwards.
+     * @param index Index of the screen, that keeps its intermediate textures
+     * @param width Size of the source in pixels
+     */
+    Output Run(std::size_t index, const ScreenInfo& screen_info, float width, float height);
+
+private:
+    struct Pass {
+        OGLProgram program;
+        OGLSampler sampler;
+        float scale;
+        GLint resolution_loc;
+        GLint src_rect_loc;
+    };
+
+    struct Target {
+        OGLTexture texture;
+        OGLFramebuffer framebuffer;
+        GLsizei width = 0;
+        GLsizei height = 0;
+    };
+
+    /// Intermediate textures of a screen, and the display texture they were drawn from
+    struct ScreenState {
+        std::vector<Target> targets;
+        GLuint source_texture = 0;
+        Common::Rectangle<float> source_texcoords;
+        u64 source_version = 0;
+        float source_width = 0.0f;
+        float source_height = 0.0f;
+    };
+
+    /// Takes a texture of the given size from the pool, or creates it
+    Target AcquireTarget(GLsizei width, GLsizei height);
+
+    std::vector<Pass> passes;
+    std::array<ScreenState, 3> screens;
+    std::vector<Target> free_targets;
+    OGLVertexArray vao;
+};
+
+} // namespace OpenGL
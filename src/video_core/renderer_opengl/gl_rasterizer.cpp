@@ -15,6 +15,7 @@
 #endif
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
@@ -26,6 +27,7 @@
 #include "video_core/regs_framebuffer.h"
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_texturing.h"
+#include "video_core/renderer_opengl/gl_gpu_profiler.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_vars.h"
@@ -39,23 +41,36 @@ namespace OpenGL {
 using PixelFormat = SurfaceParams::PixelFormat;
 using SurfaceType = SurfaceParams::SurfaceType;
 
+MICROPROFILE_DEFINE(OpenGL_VAO, "OpenGL", "Vertex Array Setup", MP_RGB(255, 128, 0));
+MICROPROFILE_DEFINE(OpenGL_VS, "OpenGL", "Vertex Shader Setup", MP_RGB(192, 128, 128));
+MICROPROFILE_DEFINE(OpenGL_GS, "OpenGL", "Geometry Shader Setup", MP_RGB(128, 192, 128));
+MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(100, 100, 255));
+MICROPROFILE_DEFINE(OpenGL_CacheManagement, "OpenGL", "Cache Mgmt", MP_RGB(100, 255, 100));
+
 static bool IsVendorMali() {
     std::string gpu_vendor{reinterpret_cast<char const*>(glGetString(GL_VENDOR))};
     return gpu_vendor.find("ARM") != std::string::npos;
 }
 
-RasterizerOpenGL::RasterizerOpenGL()
+RasterizerOpenGL::RasterizerOpenGL(Frontend::EmuWindow& emu_window)
     : is_mali_gpu(IsVendorMali()), shader_dirty(true),
       vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE),
       uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE),
       index_buffer(GL_ELEMENT_ARRAY_BUFFER, INDEX_BUFFER_SIZE),
-      texture_buffer(GL_TEXTURE_BUFFER, is_mali_gpu ? 11264 : TEXTURE_BUFFER_SIZE),
-      texture_lf_buffer(GL_TEXTURE_BUFFER, is_mali_gpu ? 525312 : TEXTURE_BUFFER_SIZE) {
+      texture_buffer(PROCTEX_LUT_SLOT_SIZE, PROCTEX_LUT_SLOTS, NUM_PROCTEX_LUTS),
+      texture_lf_buffer(LF_LUT_SLOT_SIZE, LF_LUT_SLOTS, NUM_LF_LUTS) {
 
     AllowShadow = (GLAD_GL_ARB_shader_image_load_store && GLAD_GL_ARB_shader_image_size &&
                    GLAD_GL_ARB_framebuffer_no_attachments) ||
                   Settings::values.allow_shadow;
-    if (!AllowShadow) {
+    // Image atomics are slow or broken on most mobile GPUs, render shadow maps through the depth
+    // test and blending there unless the image path is forced
+    ShadowBlending = GLES && !AllowShadow;
+    if (ShadowBlending) {
+        AllowShadow = true;
+        LOG_INFO(Render_OpenGL, "Rendering shadow maps with blending");
+    } else if (!AllowShadow) {
         LOG_WARNING(Render_OpenGL,
                     "Shadow might not be able to render because of unsupported OpenGL extensions.");
     }
@@ -68,16 +83,6 @@ RasterizerOpenGL::RasterizerOpenGL()
     // Clipping plane 0 is always enabled for PICA fixed clip plane z <= 0
     state.clip_distance[0] = true;
 
-    // Create sampler objects
-    for (std::size_t i = 0; i < texture_samplers.size(); ++i) {
-        texture_samplers[i].Create();
-        state.texture_units[i].sampler = texture_samplers[i].sampler.handle;
-    }
-
-    // Create cubemap texture and sampler objects
-    texture_cube_sampler.Create();
-    state.texture_cube_unit.sampler = texture_cube_sampler.sampler.handle;
-
     // Generate VAO
     sw_vao.Create();
     hw_vao.Create();
@@ -99,6 +104,8 @@ RasterizerOpenGL::RasterizerOpenGL()
     state.texture_buffer_lut_rgba.texture_buffer = texture_buffer_lut_rgba.handle;
 
     uniform_block_data.dirty = true;
+    vs_uniform_block_data.dirty = true;
+    gs_uniform_block_data.dirty = true;
 
     uniform_block_data.lighting_lut_dirty.fill(true);
     uniform_block_data.lighting_lut_dirty_any = true;
@@ -114,6 +121,8 @@ RasterizerOpenGL::RasterizerOpenGL()
     glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_buffer_alignment);
     uniform_size_aligned_vs =
         Common::AlignUp<std::size_t>(sizeof(VSUniformData), uniform_buffer_alignment);
+    uniform_size_aligned_gs =
+        Common::AlignUp<std::size_t>(sizeof(GSUniformData), uniform_buffer_alignment);
     uniform_size_aligned_fs =
         Common::AlignUp<std::size_t>(sizeof(UniformData), uniform_buffer_alignment);
 
@@ -176,7 +185,8 @@ RasterizerOpenGL::RasterizerOpenGL()
 
     // 845需要开启分离着色器，但开启后Mali GPU会挂掉，究极日也有显示问题！
     const bool use_separable_shader = Settings::values.use_separable_shader;
-    shader_program_manager = std::make_unique<ShaderProgramManager>(use_separable_shader);
+    shader_program_manager =
+        std::make_unique<ShaderProgramManager>(emu_window, use_separable_shader);
 
     // init opengl state
     glEnable(GL_CULL_FACE);
@@ -215,6 +225,8 @@ void RasterizerOpenGL::SyncEntireState() {
 
     SyncGlobalAmbient();
     SyncLightingLutData();
+    vs_uniform_block_data.data.uniforms.SetFromRegs(Pica::g_state.regs.vs, Pica::g_state.vs);
+    vs_uniform_block_data.dirty = true;
     for (u32 light_index = 0; light_index < 8; light_index++) {
         SyncLightSpecular0(light_index);
         SyncLightSpecular1(light_index);
@@ -323,30 +335,40 @@ RasterizerOpenGL::VertexArrayInfo RasterizerOpenGL::AnalyzeVertexArray(bool is_i
     }
 
     const u32 vertex_num = vertex_max - vertex_min + 1;
-    u32 vs_input_size = 0;
-    for (const auto& loader : vertex_attributes.attribute_loaders) {
-        if (loader.component_count != 0) {
-            vs_input_size += loader.byte_count * vertex_num;
-        }
-    }
+    const u32 vs_input_size = GetVertexLayoutInfo().vertex_stride * vertex_num;
 
     return {vertex_min, vertex_max, vs_input_size};
 }
 
-void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
-                                        GLuint vs_input_index_min, GLuint vs_input_index_max) {
-    MICROPROFILE_SCOPE(OpenGL_VAO);
+const RasterizerOpenGL::VertexLayoutInfo& RasterizerOpenGL::GetVertexLayoutInfo() {
+    if (!vertex_layout_dirty) {
+        return *vertex_layout;
+    }
+    vertex_layout_dirty = false;
+
     const auto& regs = Pica::g_state.regs;
-    const auto& vertex_attributes = regs.pipeline.vertex_attributes;
-    PAddr base_address = vertex_attributes.GetPhysicalBaseAddress();
+    std::array<u32, std::tuple_size_v<VertexLayout> + 2> key;
+    const VertexLayout layout = GetVertexLayout();
+    std::copy(layout.begin(), layout.end(), key.begin());
+    key[layout.size()] = regs.vs.input_attribute_to_register_map_low;
+    key[layout.size() + 1] = regs.vs.input_attribute_to_register_map_high;
 
-    std::array<bool, 16> enable_attributes{};
+    auto [iter, is_new] =
+        vertex_layout_cache.try_emplace(Common::ComputeHash64(key.data(), sizeof(key)));
+    vertex_layout = &iter->second;
+    if (!is_new) {
+        return *vertex_layout;
+    }
 
-    for (const auto& loader : vertex_attributes.attribute_loaders) {
+    VertexLayoutInfo& info = iter->second;
+    const auto& vertex_attributes = regs.pipeline.vertex_attributes;
+    for (std::size_t loader_index = 0; loader_index < 12; ++loader_index) {
+        const auto& loader = vertex_attributes.attribute_loaders[loader_index];
         if (loader.component_count == 0 || loader.byte_count == 0) {
             continue;
         }
 
+        const std::size_t first_attribute = info.attributes.size();
         u32 offset = 0;
         for (u32 comp = 0; comp < loader.component_count && comp < 12; ++comp) {
             u32 attribute_index = loader.GetComponent(comp);
@@ -359,10 +381,8 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
                     GLint size = vertex_attributes.GetNumElements(attribute_index);
                     GLenum type = vs_attrib_types[static_cast<u32>(
                         vertex_attributes.GetFormat(attribute_index))];
-                    GLsizei stride = loader.byte_count;
-                    glVertexAttribPointer(input_reg, size, type, GL_FALSE, stride,
-                                          reinterpret_cast<GLvoid*>(buffer_offset + offset));
-                    enable_attributes[input_reg] = true;
+                    info.attributes.push_back({input_reg, size, type, offset});
+                    info.enable_attributes[input_reg] = true;
 
                     offset += vertex_attributes.GetStride(attribute_index);
                 }
@@ -374,37 +394,164 @@ void RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
             }
         }
 
-        PAddr data_addr =
-            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
+        info.loaders.push_back({static_cast<u32>(loader_index), loader.byte_count, first_attribute,
+                                info.attributes.size() - first_attribute});
+        info.vertex_stride += loader.byte_count;
+    }
+
+    for (u32 i = 0; i < 16; ++i) {
+        if (vertex_attributes.IsDefaultAttribute(i)) {
+            const u32 reg = regs.vs.GetRegisterForAttribute(i);
+            if (!info.enable_attributes[reg]) {
+                info.default_attributes.emplace_back(i, reg);
+            }
+        }
+    }
+    return info;
+}
 
-        u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
-        u32 data_size = loader.byte_count * vertex_num;
+std::size_t RasterizerOpenGL::SetupVertexArray(u8* array_ptr, GLintptr buffer_offset,
+                                               GLuint vs_input_index_min,
+                                               GLuint vs_input_index_max, u32 vertex_capacity,
+                                               bool reuse_uploads) {
+    MICROPROFILE_SCOPE(OpenGL_VAO);
+    const auto& vertex_attributes = Pica::g_state.regs.pipeline.vertex_attributes;
+    const VertexLayoutInfo& layout = GetVertexLayoutInfo();
+    PAddr base_address = vertex_attributes.GetPhysicalBaseAddress();
+    u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+    std::size_t bytes_used = 0;
 
-        // res_cache.FlushRegion(data_addr, data_size, nullptr);
-        std::memcpy(array_ptr, VideoCore::Memory()->GetPhysicalPointer(data_addr), data_size);
+    for (const auto& loader_info : layout.loaders) {
+        const auto& loader = vertex_attributes.attribute_loaders[loader_info.index];
+        PAddr data_addr =
+            base_address + loader.data_offset + (vs_input_index_min * loader_info.byte_count);
+        u32 data_size = loader_info.byte_count * vertex_num;
+
+        // Arrays that weren't written since their last upload are still in the stream buffer
+        const bool cacheable = reuse_uploads && data_size >= MIN_CACHED_VERTEX_ARRAY_SIZE;
+        GLintptr data_offset = buffer_offset + bytes_used;
+        if (!cacheable || !res_cache.GetCachedVertexArray(data_addr, data_size, data_offset)) {
+            // res_cache.FlushRegion(data_addr, data_size, nullptr);
+            std::memcpy(array_ptr + bytes_used,
+                        VideoCore::Memory()->GetPhysicalPointer(data_addr), data_size);
+            if (cacheable) {
+                res_cache.CacheVertexArray(data_addr, data_size, data_offset);
+            }
+            bytes_used += loader_info.byte_count * vertex_capacity;
+        }
 
-        array_ptr += data_size;
-        buffer_offset += data_size;
+        for (std::size_t i = 0; i < loader_info.num_attributes; ++i) {
+            const auto& attribute = layout.attributes[loader_info.first_attribute + i];
+            glVertexAttribPointer(attribute.input_reg, attribute.size, attribute.type, GL_FALSE,
+                                  loader_info.byte_count,
+                                  reinterpret_cast<GLvoid*>(data_offset + attribute.offset));
+        }
     }
 
-    for (std::size_t i = 0; i < enable_attributes.size(); ++i) {
-        if (enable_attributes[i] != hw_vao_enabled_attributes[i]) {
-            if (enable_attributes[i]) {
+    for (std::size_t i = 0; i < layout.enable_attributes.size(); ++i) {
+        if (layout.enable_attributes[i] != hw_vao_enabled_attributes[i]) {
+            if (layout.enable_attributes[i]) {
                 glEnableVertexAttribArray(i);
             } else {
                 glDisableVertexAttribArray(i);
             }
-            hw_vao_enabled_attributes[i] = enable_attributes[i];
+            hw_vao_enabled_attributes[i] = layout.enable_attributes[i];
         }
+    }
 
-        if (vertex_attributes.IsDefaultAttribute(i)) {
-            const u32 reg = regs.vs.GetRegisterForAttribute(i);
-            if (!enable_attributes[reg]) {
-                const auto& attr = Pica::g_state.input_default_attributes.attr[i];
-                glVertexAttrib4f(reg, attr.x.ToFloat32(), attr.y.ToFloat32(), attr.z.ToFloat32(),
-                                 attr.w.ToFloat32());
-            }
+    for (const auto& [attribute_index, reg] : layout.default_attributes) {
+        const auto& attr = Pica::g_state.input_default_attributes.attr[attribute_index];
+        glVertexAttrib4f(reg, attr.x.ToFloat32(), attr.y.ToFloat32(), attr.z.ToFloat32(),
+                         attr.w.ToFloat32());
+    }
+
+    return bytes_used;
+}
+
+void RasterizerOpenGL::AppendBatchVertices(GLuint vs_input_index_min, GLuint vs_input_index_max) {
+    MICROPROFILE_SCOPE(OpenGL_VAO);
+    const auto& vertex_attributes = Pica::g_state.regs.pipeline.vertex_attributes;
+    PAddr base_address = vertex_attributes.GetPhysicalBaseAddress();
+    u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+
+    u8* block_ptr = draw_batch.vertex_ptr;
+    for (const auto& loader : vertex_attributes.attribute_loaders) {
+        if (loader.component_count == 0 || loader.byte_count == 0) {
+            continue;
         }
+
+        PAddr data_addr =
+            base_address + loader.data_offset + (vs_input_index_min * loader.byte_count);
+        std::memcpy(block_ptr + draw_batch.num_vertices * loader.byte_count,
+                    VideoCore::Memory()->GetPhysicalPointer(data_addr),
+                    loader.byte_count * vertex_num);
+        block_ptr += loader.byte_count * draw_batch.vertex_capacity;
+    }
+}
+
+void RasterizerOpenGL::AppendBatchIndices(GLuint vs_input_index_min) {
+    const auto& regs = Pica::g_state.regs;
+    const u8* index_data = VideoCore::Memory()->GetPhysicalPointer(
+        regs.pipeline.vertex_attributes.GetPhysicalBaseAddress() +
+        regs.pipeline.index_array.offset);
+    const u32 rebase = draw_batch.num_vertices - vs_input_index_min;
+    u16* indices = draw_batch.index_ptr + draw_batch.num_indices;
+
+    if (regs.pipeline.index_array.format != 0) {
+        const u16* index_data_16 = reinterpret_cast<const u16*>(index_data);
+        for (u32 i = 0; i < regs.pipeline.num_vertices; ++i) {
+            indices[i] = static_cast<u16>(index_data_16[i] + rebase);
+        }
+    } else {
+        for (u32 i = 0; i < regs.pipeline.num_vertices; ++i) {
+            indices[i] = static_cast<u16>(index_data[i] + rebase);
+        }
+    }
+    draw_batch.num_indices += regs.pipeline.num_vertices;
+}
+
+auto RasterizerOpenGL::GetVertexLayout() -> VertexLayout {
+    VertexLayout layout;
+    std::memcpy(layout.data(), &Pica::g_state.regs.pipeline.vertex_attributes,
+                sizeof(layout));
+    // Base address, followed by the two format words and three words per loader starting with
+    // the data offset
+    layout[0] = 0;
+    for (std::size_t word = 3; word < layout.size(); word += 3) {
+        layout[word] = 0;
+    }
+    return layout;
+}
+
+/// Returns true if the register only selects the vertex data of the next draw
+static bool IsVertexInputRegister(u32 id) {
+    constexpr u32 num_words = sizeof(Pica::PipelineRegs::vertex_attributes) / sizeof(u32);
+    if (id >= PICA_REG_INDEX(pipeline.vertex_attributes) &&
+        id < PICA_REG_INDEX(pipeline.vertex_attributes) + num_words) {
+        return true;
+    }
+    switch (id) {
+    case PICA_REG_INDEX(pipeline.index_array):
+    case PICA_REG_INDEX(pipeline.num_vertices):
+    case PICA_REG_INDEX(pipeline.vertex_offset):
+    case PICA_REG_INDEX(vs.bool_uniforms):
+    case PICA_REG_INDEX(vs.int_uniforms[0]):
+    case PICA_REG_INDEX(vs.int_uniforms[1]):
+    case PICA_REG_INDEX(vs.int_uniforms[2]):
+    case PICA_REG_INDEX(vs.int_uniforms[3]):
+    case PICA_REG_INDEX(vs.uniform_setup):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[0]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[1]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[2]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[3]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[4]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[5]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[6]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[7]):
+        // Changed uniform values are caught by the vertex uniform dirty flag
+        return true;
+    default:
+        return false;
     }
 }
 
@@ -420,10 +567,14 @@ bool RasterizerOpenGL::SetupGeometryShader() {
     if (regs.pipeline.use_gs == Pica::PipelineRegs::UseGS::No) {
         shader_program_manager->UseFixedGeometryShader(regs);
         return true;
-    } else {
-        LOG_ERROR(Render_OpenGL, "Accelerate draw doesn't support geometry shader");
-        return false;
     }
+    SyncGSUniforms();
+    return shader_program_manager->UseProgrammableGeometryShader(regs, Pica::g_state.gs);
+}
+
+/// Returns the number of vertices an invocation of the geometry shader reads in the point mode
+static u32 GetGSVerticesPerInvocation(const Pica::Regs& regs) {
+    return (regs.gs.max_input_attribute_index + 1) / (regs.pipeline.vs_outmap_total_minus_1_a + 1);
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
@@ -435,6 +586,13 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
         if (regs.pipeline.triangle_topology != Pica::PipelineRegs::TriangleTopology::Shader) {
             return false;
         }
+        // The GL primitives must not leave vertices for the next draw, which the geometry
+        // pipeline would keep buffered
+        const u32 vertices_per_invocation = GetGSVerticesPerInvocation(regs);
+        if (vertices_per_invocation == 0 ||
+            regs.pipeline.num_vertices % vertices_per_invocation != 0) {
+            return false;
+        }
     }
 
     if (!SetupVertexShader())
@@ -447,20 +605,72 @@ bool RasterizerOpenGL::AccelerateDrawBatch(bool is_indexed) {
 }
 
 void RasterizerOpenGL::CheckForConfigChanges() {
+    FlushDrawBatch();
     u16 scale_factor = VideoCore::GetResolutionScaleFactor();
-    if (res_cache.GetScaleFactor() != scale_factor) {
+    if (Settings::values.use_dynamic_resolution && DynamicResolution::IsSupported()) {
+        const u16 min_scale = std::max<u16>(Settings::values.dynamic_resolution_min, 1);
+        const u16 max_scale = std::max(Settings::values.dynamic_resolution_max, min_scale);
+        if (!dynamic_resolution || !dynamic_resolution->HasBounds(min_scale, max_scale)) {
+            dynamic_resolution =
+                std::make_unique<DynamicResolution>(scale_factor, min_scale, max_scale);
+        }
+        // The dynamic scale takes the place of the resolution factor
+        scale_factor = dynamic_resolution->GetScale();
+    } else {
+        dynamic_resolution.reset();
+    }
+
+    if (res_cache.GetScaleFactor() != scale_factor ||
+        res_cache.TargetScalesChanged(scale_factor)) {
         framebuffer_info = {};
         res_cache.SetScaleFactor(scale_factor);
     }
 }
 
 void RasterizerOpenGL::OnFrameUpdate() {
+    FlushDrawBatch();
     res_cache.OnFrameUpdate();
+
+    if (dynamic_resolution) {
+        const u16 scale = dynamic_resolution->FrameUpdate();
+        if (scale != res_cache.GetScaleFactor()) {
+            framebuffer_info = {};
+            res_cache.RescaleTargets(scale);
+        }
+    }
+}
+
+void RasterizerOpenGL::RecordSurfaceTrace(const std::string& path) {
+    FlushDrawBatch();
+    res_cache.RecordTrace(path);
+}
+
+bool RasterizerOpenGL::ReplaySurfaceTrace(const std::string& path) {
+    FlushDrawBatch();
+    return res_cache.ReplayTrace(path);
 }
 
 static GLenum GetCurrentPrimitiveMode() {
+    const auto& regs = Pica::g_state.regs;
+    if (regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No) {
+        // Matches the input layout of GenerateGeometryShader
+        switch (GetGSVerticesPerInvocation(regs)) {
+        case 1:
+            return GL_POINTS;
+        case 2:
+            return GL_LINES;
+        case 3:
+            return GL_TRIANGLES;
+        case 4:
+            return GL_LINES_ADJACENCY;
+        case 6:
+            return GL_TRIANGLES_ADJACENCY;
+        default:
+            UNREACHABLE();
+        }
+    }
     const GLenum prims[] = {GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES};
-    return prims[static_cast<u32>(Pica::g_state.regs.pipeline.triangle_topology.Value())];
+    return prims[static_cast<u32>(regs.pipeline.triangle_topology.Value())];
 }
 
 bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
@@ -476,14 +686,77 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
 
     state.draw.vertex_array = hw_vao.handle;
     state.draw.vertex_buffer = vertex_buffer.GetHandle();
-    shader_program_manager->ApplyTo(state);
+    if (!shader_program_manager->ApplyTo(state)) {
+        // The program is still being built in the background, drop this draw
+        return true;
+    }
     state.Apply();
 
+    const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+    const u32 vertex_stride = vs_input_size / vertex_num;
+    u32 vertex_capacity = vertex_num;
+    std::size_t vertex_reserve = vs_input_size;
+
+    // Triangle lists can be concatenated with the following draws, keep them for merging
+    bool start_batch = Settings::values.merge_draw_calls && primitive_mode == GL_TRIANGLES &&
+                       regs.pipeline.use_gs == Pica::PipelineRegs::UseGS::No &&
+                       vertex_stride != 0 && !regs.framebuffer.IsShadowRendering() &&
+                       (!is_indexed || regs.pipeline.num_vertices <= DRAW_BATCH_MAX_INDICES);
+    if (start_batch) {
+        vertex_capacity = std::min<u32>(DRAW_BATCH_MAX_VERTICES,
+                                        static_cast<u32>(DRAW_BATCH_VERTEX_RESERVE / vertex_stride));
+        start_batch = vertex_capacity >= vertex_num;
+        if (start_batch) {
+            vertex_reserve = vertex_stride * vertex_capacity;
+        } else {
+            vertex_capacity = vertex_num;
+        }
+    }
+
     u8* buffer_ptr;
     GLintptr buffer_offset;
-    std::tie(buffer_ptr, buffer_offset, std::ignore) = vertex_buffer.Map(vs_input_size, 4);
-    SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max);
-    vertex_buffer.Unmap(vs_input_size);
+    std::tie(buffer_ptr, buffer_offset, std::ignore) = vertex_buffer.Map(vertex_reserve, 4);
+    if (vertex_buffer.GetWrapCount() != vertex_buffer_wrap_count) {
+        // Vertex data uploaded before the stream buffer started over is being overwritten
+        res_cache.ClearVertexArrays();
+        vertex_buffer_wrap_count = vertex_buffer.GetWrapCount();
+    }
+    const std::size_t vertex_bytes =
+        SetupVertexArray(buffer_ptr, buffer_offset, vs_input_index_min, vs_input_index_max,
+                         vertex_capacity, Settings::values.cache_vertex_arrays && !start_batch);
+
+    if (start_batch) {
+        draw_batch.active = true;
+        draw_batch.indexed = is_indexed;
+        draw_batch.vertex_ptr = buffer_ptr;
+        draw_batch.vertex_capacity = vertex_capacity;
+        draw_batch.num_vertices = vertex_num;
+        draw_batch.last_block_offset = 0;
+        draw_batch.last_block_stride = 0;
+        for (const auto& loader : regs.pipeline.vertex_attributes.attribute_loaders) {
+            if (loader.component_count != 0 && loader.byte_count != 0) {
+                draw_batch.last_block_offset += draw_batch.last_block_stride * vertex_capacity;
+                draw_batch.last_block_stride = loader.byte_count;
+            }
+        }
+        draw_batch.num_indices = 0;
+        if (is_indexed) {
+            u8* index_ptr;
+            std::tie(index_ptr, draw_batch.index_offset, std::ignore) =
+                index_buffer.Map(DRAW_BATCH_MAX_INDICES * sizeof(u16), 4);
+            draw_batch.index_ptr = reinterpret_cast<u16*>(index_ptr);
+            draw_batch.num_vertices = 0;
+            AppendBatchIndices(vs_input_index_min);
+            draw_batch.num_vertices = vertex_num;
+        }
+        draw_batch.vs_program_hash = Pica::g_state.vs.GetProgramCodeHash();
+        draw_batch.vs_swizzle_hash = Pica::g_state.vs.GetSwizzleDataHash();
+        draw_batch.vertex_layout = GetVertexLayout();
+        draw_batch.default_attributes = Pica::g_state.input_default_attributes;
+        return true;
+    }
+
+    vertex_buffer.Unmap(vertex_bytes);
 
     if (is_indexed) {
         bool index_u16 = regs.pipeline.index_array.format != 0;
@@ -512,6 +785,79 @@ bool RasterizerOpenGL::AccelerateDrawBatchInternal(bool is_indexed) {
     return true;
 }
 
+bool RasterizerOpenGL::MergeDrawBatch(bool is_indexed) {
+    if (!draw_batch.active || draw_batch.indexed != is_indexed || vs_uniform_block_data.dirty ||
+        GetCurrentPrimitiveMode() != GL_TRIANGLES) {
+        return false;
+    }
+
+    // Everything else is either checked here or submits the batch when its register is written
+    auto& vs_setup = Pica::g_state.vs;
+    if (draw_batch.vs_program_hash != vs_setup.GetProgramCodeHash() ||
+        draw_batch.vs_swizzle_hash != vs_setup.GetSwizzleDataHash() ||
+        draw_batch.vertex_layout != GetVertexLayout() ||
+        std::memcmp(&draw_batch.default_attributes, &Pica::g_state.input_default_attributes,
+                    sizeof(draw_batch.default_attributes)) != 0) {
+        return false;
+    }
+
+    const auto& regs = Pica::g_state.regs;
+    auto [vs_input_index_min, vs_input_index_max, vs_input_size] = AnalyzeVertexArray(is_indexed);
+    const u32 vertex_num = vs_input_index_max - vs_input_index_min + 1;
+    if (draw_batch.num_vertices + vertex_num > draw_batch.vertex_capacity) {
+        return false;
+    }
+    if (is_indexed &&
+        draw_batch.num_indices + regs.pipeline.num_vertices > DRAW_BATCH_MAX_INDICES) {
+        return false;
+    }
+
+    AppendBatchVertices(vs_input_index_min, vs_input_index_max);
+    if (is_indexed) {
+        AppendBatchIndices(vs_input_index_min);
+    }
+    draw_batch.num_vertices += vertex_num;
+    return true;
+}
+
+void RasterizerOpenGL::FlushDrawBatch() {
+    if (!draw_batch.active) {
+        return;
+    }
+    draw_batch.active = false;
+
+    state.Apply();
+    vertex_buffer.Unmap(draw_batch.last_block_offset +
+                        draw_batch.last_block_stride * draw_batch.num_vertices);
+    if (draw_batch.indexed) {
+        index_buffer.Unmap(draw_batch.num_indices * sizeof(u16));
+        glDrawRangeElementsBaseVertex(GL_TRIANGLES, 0, draw_batch.num_vertices - 1,
+                                      draw_batch.num_indices, GL_UNSIGNED_SHORT,
+                                      reinterpret_cast<const void*>(draw_batch.index_offset), 0);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, draw_batch.num_vertices);
+    }
+
+    UnbindTextures();
+}
+
+void RasterizerOpenGL::UnbindTextures() {
+    for (auto& texture_unit : state.texture_units) {
+        texture_unit.texture_2d = 0;
+    }
+    state.texture_cube_unit.texture_cube = 0;
+    if (AllowShadow) {
+        state.image_shadow_texture_px = 0;
+        state.image_shadow_texture_nx = 0;
+        state.image_shadow_texture_py = 0;
+        state.image_shadow_texture_ny = 0;
+        state.image_shadow_texture_pz = 0;
+        state.image_shadow_texture_nz = 0;
+        state.image_shadow_buffer = 0;
+    }
+    state.Apply();
+}
+
 void RasterizerOpenGL::DrawTriangles() {
     if (vertex_batch.empty())
         return;
@@ -519,7 +865,23 @@ void RasterizerOpenGL::DrawTriangles() {
 }
 
 bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
+    MICROPROFILE_SCOPE(OpenGL_Drawing);
     const auto& regs = Pica::g_state.regs;
+
+    // The targets of skipped draws keep what memory holds. Guest code depends on the color buffers
+    // the CPU reads back, so the draws into those still run.
+    if (VideoCore::IsFrameSkipped() &&
+        !res_cache.IsReadbackTarget(regs.framebuffer.framebuffer.GetColorBufferPhysicalAddress())) {
+        vertex_batch.clear();
+        return true;
+    }
+
+    if (accelerate && MergeDrawBatch(is_indexed)) {
+        return true;
+    }
+    FlushDrawBatch();
+    SyncDirtyRegs();
+
     const bool shadow_rendering = regs.framebuffer.IsShadowRendering();
     if (shadow_rendering && !AllowShadow) {
         return true;
@@ -572,12 +934,17 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
                     if (!AllowShadow)
                         continue;
                     Surface surface = res_cache.GetTextureSurface(texture);
-                    state.image_shadow_texture_px =
-                        surface != nullptr ? surface->texture.handle : 0;
+                    if (ShadowBlending) {
+                        state.texture_units[0].texture_2d =
+                            surface != nullptr ? surface->texture.handle : 0;
+                    } else {
+                        state.image_shadow_texture_px =
+                            surface != nullptr ? surface->texture.handle : 0;
+                    }
                     continue;
                 }
                 case TextureType::ShadowCube: {
-                    if (!AllowShadow)
+                    if (!AllowShadow || ShadowBlending)
                         continue;
                     Pica::Texture::TextureInfo info = Pica::Texture::TextureInfo::FromPicaRegister(
                         texture.config, texture.format);
@@ -633,16 +1000,17 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
                     config.width = texture.config.width;
                     config.format = texture.format;
                     state.texture_cube_unit.texture_cube =
-                        res_cache.GetTextureCube(config).texture.handle;
+                        res_cache.GetTextureCube(config, texture.config.lod.max_level != 0)
+                            .texture.handle;
 
-                    texture_cube_sampler.SyncWithConfig(texture.config);
+                    state.texture_cube_unit.sampler = GetSampler(texture.config);
                     state.texture_units[texture_index].texture_2d = 0;
                     continue; // Texture unit 0 setup finished. Continue to next unit
                 }
                 state.texture_cube_unit.texture_cube = 0;
             }
 
-            texture_samplers[texture_index].SyncWithConfig(texture.config);
+            state.texture_units[texture_index].sampler = GetSampler(texture.config);
             Surface surface = res_cache.GetTextureSurface(texture);
             if (surface) {
                 if (surface->texture.handle == color_attachment) {
@@ -691,7 +1059,25 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     // Bind the framebuffer surfaces
     OpenGLState::BindDrawFramebuffer(framebuffer.handle);
 
-    if (shadow_rendering) {
+    if (shadow_rendering && ShadowBlending) {
+        if (color_surface == nullptr) {
+            return true;
+        }
+        const GLuint depth_attachment = shadow_depth_buffer.Load(
+            color_surface->texture.handle, color_surface->modification_id,
+            color_surface->GetScaledWidth(), color_surface->GetScaledHeight());
+        OpenGLState::BindDrawFramebuffer(framebuffer.handle);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               color_surface->texture.handle, 0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0,
+                               0);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                               depth_attachment, 0);
+        framebuffer_info.color_attachment = color_surface->texture.handle;
+        framebuffer_info.depth_attachment = depth_attachment;
+        framebuffer_info.width = color_surface->width;
+        framebuffer_info.height = color_surface->height;
+    } else if (shadow_rendering) {
         if (color_surface == nullptr) {
             return true;
         }
@@ -798,7 +1184,46 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
     state.scissor.width = draw_rect.GetWidth();
     state.scissor.height = draw_rect.GetHeight();
 
-    // Draw the vertex batch
+    GPUProfiler::CountDraw(color_surface ? color_surface->addr : 0,
+                           depth_surface ? depth_surface->addr : 0);
+    if (shadow_rendering && ShadowBlending) {
+        return DrawBlendedShadow(accelerate, is_indexed, color_surface, draw_rect, res_scale);
+    }
+
+    const bool succeeded = DrawVertexBatch(accelerate, is_indexed);
+    vertex_batch.clear();
+
+    // Reset textures in rasterizer state context because the rasterizer cache might delete them.
+    // A pending draw batch still samples them and resets them once it is submitted.
+    if (!draw_batch.active) {
+        UnbindTextures();
+    }
+
+    if (shadow_rendering) {
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                        GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    }
+
+    // Mark framebuffer surfaces as dirty
+    Common::Rectangle<u32> draw_rect_unscaled{draw_rect.left / res_scale, draw_rect.top / res_scale,
+                                              draw_rect.right / res_scale,
+                                              draw_rect.bottom / res_scale};
+
+    if (color_surface != nullptr) {
+        auto interval = color_surface->GetSubRectInterval(draw_rect_unscaled);
+        res_cache.InvalidateRegion(boost::icl::first(interval), boost::icl::length(interval),
+                                   color_surface);
+    }
+    if (depth_surface != nullptr && write_depth_fb) {
+        auto interval = depth_surface->GetSubRectInterval(draw_rect_unscaled);
+        res_cache.InvalidateRegion(boost::icl::first(interval), boost::icl::length(interval),
+                                   depth_surface);
+    }
+
+    return succeeded;
+}
+
+bool RasterizerOpenGL::DrawVertexBatch(bool accelerate, bool is_indexed) {
     bool succeeded = true;
     if (accelerate) {
         succeeded = AccelerateDrawBatchInternal(is_indexed);
@@ -807,11 +1232,11 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         state.draw.vertex_buffer = vertex_buffer.GetHandle();
         shader_program_manager->UseTrivialVertexShader();
         shader_program_manager->UseTrivialGeometryShader();
-        shader_program_manager->ApplyTo(state);
+        const bool shader_ready = shader_program_manager->ApplyTo(state);
         state.Apply();
 
         std::size_t max_vertices = 3 * (VERTEX_BUFFER_SIZE / (3 * sizeof(HardwareVertex)));
-        for (std::size_t base_vertex = 0; base_vertex < vertex_batch.size();
+        for (std::size_t base_vertex = 0; shader_ready && base_vertex < vertex_batch.size();
              base_vertex += max_vertices) {
             const std::size_t vertices = std::min(max_vertices, vertex_batch.size() - base_vertex);
             const std::size_t vertex_size = vertices * sizeof(HardwareVertex);
@@ -826,49 +1251,103 @@ bool RasterizerOpenGL::Draw(bool accelerate, bool is_indexed) {
         }
     }
 
-    vertex_batch.clear();
+    return succeeded;
+}
 
-    // Reset textures in rasterizer state context because the rasterizer cache might delete them
-    for (auto& texture_unit : state.texture_units) {
-        texture_unit.texture_2d = 0;
-    }
-    state.texture_cube_unit.texture_cube = 0;
-    if (AllowShadow) {
-        state.image_shadow_texture_px = 0;
-        state.image_shadow_texture_nx = 0;
-        state.image_shadow_texture_py = 0;
-        state.image_shadow_texture_ny = 0;
-        state.image_shadow_texture_pz = 0;
-        state.image_shadow_texture_nz = 0;
-        state.image_shadow_buffer = 0;
-    }
-    state.Apply();
+bool RasterizerOpenGL::DrawBlendedShadow(bool accelerate, bool is_indexed,
+                                         const Surface& color_surface,
+                                         const Common::Rectangle<u32>& draw_rect, u32 res_scale) {
+    const auto prev_depth = state.depth;
+    const auto prev_color_mask = state.color_mask;
+    const auto prev_blend = state.blend;
 
-    if (shadow_rendering) {
-        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
-                        GL_TEXTURE_UPDATE_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    // Opaque fragments write their depth where the depth test passes, then the others lower the
+    // intensity of the pixels they are in front of
+    bool succeeded = true;
+    for (GLint pass = 0; succeeded && pass < 2; ++pass) {
+        state.depth.test_enabled = true;
+        state.depth.test_func = GL_LESS;
+        state.depth.write_mask = pass == 0 ? GL_TRUE : GL_FALSE;
+        state.color_mask.red_enabled = pass == 0 ? GL_FALSE : GL_TRUE;
+        state.color_mask.green_enabled = pass == 0 ? GL_TRUE : GL_FALSE;
+        state.color_mask.blue_enabled = pass == 0 ? GL_TRUE : GL_FALSE;
+        state.color_mask.alpha_enabled = pass == 0 ? GL_TRUE : GL_FALSE;
+        state.blend.enabled = pass == 1;
+        state.blend.rgb_equation = GL_MIN;
+        state.blend.a_equation = GL_MIN;
+
+        if (uniform_block_data.data.shadow_pass != pass) {
+            uniform_block_data.data.shadow_pass = pass;
+            uniform_block_data.dirty = true;
+            UploadUniforms(accelerate);
+        }
+        succeeded = DrawVertexBatch(accelerate, is_indexed);
     }
 
-    // Mark framebuffer surfaces as dirty
+    state.depth = prev_depth;
+    state.color_mask = prev_color_mask;
+    state.blend = prev_blend;
+    vertex_batch.clear();
+    UnbindTextures();
+
     Common::Rectangle<u32> draw_rect_unscaled{draw_rect.left / res_scale, draw_rect.top / res_scale,
                                               draw_rect.right / res_scale,
                                               draw_rect.bottom / res_scale};
+    auto interval = color_surface->GetSubRectInterval(draw_rect_unscaled);
+    res_cache.InvalidateRegion(boost::icl::first(interval), boost::icl::length(interval),
+                               color_surface);
+    shadow_depth_buffer.SetModificationId(color_surface->modification_id);
+    return succeeded;
+}
 
-    if (color_surface != nullptr) {
-        auto interval = color_surface->GetSubRectInterval(draw_rect_unscaled);
-        res_cache.InvalidateRegion(boost::icl::first(interval), boost::icl::length(interval),
-                                   color_surface);
+void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
+    if (draw_batch.active && !IsVertexInputRegister(id)) {
+        FlushDrawBatch();
     }
-    if (depth_surface != nullptr && write_depth_fb) {
-        auto interval = depth_surface->GetSubRectInterval(draw_rect_unscaled);
-        res_cache.InvalidateRegion(boost::icl::first(interval), boost::icl::length(interval),
-                                   depth_surface);
+
+    constexpr u32 num_vertex_attribute_words =
+        sizeof(Pica::PipelineRegs::vertex_attributes) / sizeof(u32);
+    if ((id >= PICA_REG_INDEX(pipeline.vertex_attributes) &&
+         id < PICA_REG_INDEX(pipeline.vertex_attributes) + num_vertex_attribute_words) ||
+        id == PICA_REG_INDEX(vs.input_attribute_to_register_map_low) ||
+        id == PICA_REG_INDEX(vs.input_attribute_to_register_map_high)) {
+        vertex_layout_dirty = true;
     }
 
-    return succeeded;
+    switch (id) {
+    // Vertex shader uniforms
+    case PICA_REG_INDEX(vs.bool_uniforms):
+        SyncVSBoolUniforms();
+        break;
+    case PICA_REG_INDEX(vs.int_uniforms[0]):
+    case PICA_REG_INDEX(vs.int_uniforms[1]):
+    case PICA_REG_INDEX(vs.int_uniforms[2]):
+    case PICA_REG_INDEX(vs.int_uniforms[3]):
+        SyncVSIntUniform(id - PICA_REG_INDEX(vs.int_uniforms[0]));
+        break;
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[0]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[1]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[2]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[3]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[4]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[5]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[6]):
+    case PICA_REG_INDEX(vs.uniform_setup.set_value[7]):
+        SyncVSFloatUniform();
+        break;
+    }
 }
 
-void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
+void RasterizerOpenGL::SyncDirtyRegs() {
+    // The VS uniforms are picked up on the write, since batched draws are merged across them
+    static const auto mask = Pica::DirtyRegs::GetMask(
+        {Pica::DirtyRegGroup::Rasterizer, Pica::DirtyRegGroup::Texturing,
+         Pica::DirtyRegGroup::ProcTex, Pica::DirtyRegGroup::Tev, Pica::DirtyRegGroup::Fog,
+         Pica::DirtyRegGroup::Framebuffer, Pica::DirtyRegGroup::Lighting});
+    Pica::g_state.dirty_regs.ForEachAndClear(mask, [this](u32 id) { SyncRegister(id); });
+}
+
+void RasterizerOpenGL::SyncRegister(u32 id) {
     const auto& regs = Pica::g_state.regs;
 
     switch (id) {
@@ -1239,27 +1718,33 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
 
 void RasterizerOpenGL::FlushAll() {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushDrawBatch();
     res_cache.FlushAll();
 }
 
 void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushDrawBatch();
     res_cache.FlushRegion(addr, size);
 }
 
 void RasterizerOpenGL::InvalidateRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushDrawBatch();
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushDrawBatch();
     res_cache.FlushRegion(addr, size);
     res_cache.InvalidateRegion(addr, size, nullptr);
 }
 
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
+    GPUProfiler::Scope gpu_scope(VideoCore::GPUTiming::SectionType::Blit);
+    FlushDrawBatch();
 
     SurfaceParams src_params;
     src_params.addr = config.GetPhysicalInputAddress();
@@ -1323,6 +1808,7 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
 }
 
 bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) {
+    FlushDrawBatch();
     u32 copy_size = Common::AlignDown(config.texture_copy.size, 16);
     if (copy_size == 0) {
         return false;
@@ -1408,11 +1894,23 @@ bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferCon
 }
 
 bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config) {
-    Surface dst_surface = res_cache.GetFillSurface(config);
+    FlushDrawBatch();
+    Surface dst_surface = res_cache.FillCachedSurface(config);
+    if (dst_surface == nullptr) {
+        dst_surface = res_cache.GetFillSurface(config);
+    }
     res_cache.InvalidateRegion(dst_surface->addr, dst_surface->size, dst_surface);
     return true;
 }
 
+bool RasterizerOpenGL::AccelerateY2RConversion(const Service::Y2R::ConversionConfiguration& config,
+                                               const std::vector<u8>& input, PAddr dst_addr) {
+    MICROPROFILE_SCOPE(OpenGL_Blits);
+    GPUProfiler::Scope gpu_scope(VideoCore::GPUTiming::SectionType::Blit);
+    FlushDrawBatch();
+    return res_cache.ConvertY2R(config, input, dst_addr);
+}
+
 bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& config,
                                          PAddr framebuffer_addr, u32 pixel_stride,
                                          ScreenInfo& screen_info) {
@@ -1420,6 +1918,7 @@ bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& con
         return false;
     }
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    FlushDrawBatch();
 
     SurfaceParams src_params;
     src_params.addr = framebuffer_addr;
@@ -1447,87 +1946,73 @@ bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& con
         (float)src_rect.top / (float)scaled_height, (float)src_rect.right / (float)scaled_width);
 
     screen_info.display_texture = src_surface->texture.handle;
+    screen_info.display_version = src_surface->modification_id;
 
     return true;
 }
 
-void RasterizerOpenGL::SamplerInfo::Create() {
-    sampler.Create();
-    mag_filter = min_filter = mip_filter = TextureConfig::Linear;
-    wrap_s = wrap_t = TextureConfig::Repeat;
-    border_color = 0;
-    lod_min = lod_max = 0;
-    lod_bias = 0;
-
-    // default is 1000 and -1000
-    // Other attributes have correct defaults
-    glSamplerParameterf(sampler.handle, GL_TEXTURE_MAX_LOD, static_cast<float>(lod_max));
-    glSamplerParameterf(sampler.handle, GL_TEXTURE_MIN_LOD, static_cast<float>(lod_min));
-}
-
-void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const TextureConfig& config) {
-    GLuint s = sampler.handle;
-
-    using TextureFilter = Pica::TexturingRegs::TextureConfig::TextureFilter;
-    bool use_linear_filter =
+GLuint RasterizerOpenGL::GetSampler(const TextureConfig& config) {
+    using TextureFilter = TextureConfig::TextureFilter;
+    const bool use_linear_filter =
         Settings::values.use_linear_filter && config.mag_filter == TextureFilter::Nearest;
 
-    if (!use_linear_filter) {
-        if (mag_filter != config.mag_filter) {
-            mag_filter = config.mag_filter;
-            glSamplerParameteri(s, GL_TEXTURE_MAG_FILTER,
-                                PicaToGL::TextureMagFilterMode(mag_filter));
-        }
-
-        if (min_filter != config.min_filter || mip_filter != config.mip_filter) {
-            min_filter = config.min_filter;
-            mip_filter = config.mip_filter;
-            if (config.type == Pica::TexturingRegs::TextureConfig::TextureCube) {
-                // HACK: use mag filter converter for min filter because they are the same anyway
-                glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER,
-                                    PicaToGL::TextureMagFilterMode(min_filter));
-            } else {
-                glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER,
-                                    PicaToGL::TextureMinFilterMode(min_filter, mip_filter));
-            }
-        }
-    }
-
-    if (wrap_s != config.wrap_s) {
-        wrap_s = config.wrap_s;
-        glSamplerParameteri(s, GL_TEXTURE_WRAP_S, PicaToGL::WrapMode(wrap_s));
+    SamplerKey key{};
+    if (use_linear_filter) {
+        key.mag_filter.Assign(static_cast<u64>(TextureFilter::Linear));
+        key.min_filter.Assign(static_cast<u64>(TextureFilter::Linear));
+    } else {
+        key.mag_filter.Assign(static_cast<u64>(config.mag_filter.Value()));
+        key.min_filter.Assign(static_cast<u64>(config.min_filter.Value()));
     }
-    if (wrap_t != config.wrap_t) {
-        wrap_t = config.wrap_t;
-        glSamplerParameteri(s, GL_TEXTURE_WRAP_T, PicaToGL::WrapMode(wrap_t));
+    key.mip_filter.Assign(static_cast<u64>(config.mip_filter.Value()));
+    key.is_cube.Assign(config.type == TextureConfig::TextureCube);
+    key.wrap_s.Assign(static_cast<u64>(config.wrap_s.Value()));
+    key.wrap_t.Assign(static_cast<u64>(config.wrap_t.Value()));
+    key.lod_min.Assign(config.lod.min_level);
+    key.lod_max.Assign(config.lod.max_level);
+    key.lod_bias.Assign(config.lod.bias);
+    // Samplers that don't clamp to the border share the object whatever its color
+    if (config.wrap_s == TextureConfig::ClampToBorder ||
+        config.wrap_t == TextureConfig::ClampToBorder) {
+        key.border_color.Assign(config.border_color.raw);
     }
 
-    if (wrap_s == TextureConfig::ClampToBorder || wrap_t == TextureConfig::ClampToBorder) {
-        if (border_color != config.border_color.raw) {
-            border_color = config.border_color.raw;
-            auto gl_color = PicaToGL::ColorRGBA8(border_color);
-            glSamplerParameterfv(s, GL_TEXTURE_BORDER_COLOR, gl_color.data());
-        }
+    auto [it, is_new] = sampler_cache.try_emplace(key.raw);
+    OGLSampler& sampler = it->second;
+    if (!is_new) {
+        return sampler.handle;
     }
 
-    if (lod_min != config.lod.min_level) {
-        lod_min = config.lod.min_level;
-        glSamplerParameterf(s, GL_TEXTURE_MIN_LOD, static_cast<float>(lod_min));
+    sampler.Create();
+    const GLuint s = sampler.handle;
+    const auto mag_filter = static_cast<TextureFilter>(key.mag_filter.Value());
+    const auto min_filter = static_cast<TextureFilter>(key.min_filter.Value());
+    const auto mip_filter = static_cast<TextureFilter>(key.mip_filter.Value());
+    glSamplerParameteri(s, GL_TEXTURE_MAG_FILTER, PicaToGL::TextureMagFilterMode(mag_filter));
+    if (key.is_cube && key.lod_max == 0) {
+        // HACK: use mag filter converter for min filter because they are the same anyway
+        glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER, PicaToGL::TextureMagFilterMode(min_filter));
+    } else {
+        glSamplerParameteri(s, GL_TEXTURE_MIN_FILTER,
+                            PicaToGL::TextureMinFilterMode(min_filter, mip_filter));
     }
 
-    if (lod_max != config.lod.max_level) {
-        lod_max = config.lod.max_level;
-        glSamplerParameterf(s, GL_TEXTURE_MAX_LOD, static_cast<float>(lod_max));
+    glSamplerParameteri(s, GL_TEXTURE_WRAP_S, PicaToGL::WrapMode(config.wrap_s));
+    glSamplerParameteri(s, GL_TEXTURE_WRAP_T, PicaToGL::WrapMode(config.wrap_t));
+    if (key.border_color != 0) {
+        auto gl_color = PicaToGL::ColorRGBA8(static_cast<u32>(key.border_color));
+        glSamplerParameterfv(s, GL_TEXTURE_BORDER_COLOR, gl_color.data());
     }
 
-    if (lod_bias != config.lod.bias) {
-        lod_bias = config.lod.bias;
-        if (GLES) {
-            LOG_DEBUG(Render_OpenGL, "sync sampler lod bias: {}", lod_bias);
-        } else {
-            glSamplerParameterf(s, GL_TEXTURE_LOD_BIAS, lod_bias / 256.0f);
-        }
+    glSamplerParameterf(s, GL_TEXTURE_MIN_LOD, static_cast<float>(key.lod_min.Value()));
+    glSamplerParameterf(s, GL_TEXTURE_MAX_LOD, static_cast<float>(key.lod_max.Value()));
+    if (!GLES) {
+        glSamplerParameterf(s, GL_TEXTURE_LOD_BIAS, key.lod_bias / 256.0f);
     }
+
+    LOG_DEBUG(Render_OpenGL, "Created sampler {:016x}, {} in the cache", key.raw,
+              sampler_cache.size());
+    return s;
 }
 
 void RasterizerOpenGL::SetShader() {
@@ -1625,6 +2110,7 @@ void RasterizerOpenGL::SyncFogColor() {
 }
 
 void RasterizerOpenGL::SyncFogLutData() {
+    FlushDrawBatch();
     uniform_block_data.fog_lut_dirty = true;
 }
 
@@ -1655,6 +2141,7 @@ void RasterizerOpenGL::SyncProcTexBias() {
 }
 
 void RasterizerOpenGL::SyncProcTexLutData() {
+    FlushDrawBatch();
     using Pica::TexturingRegs;
     const auto& regs = Pica::g_state.regs;
     switch (regs.texturing.proctex_lut_config.ref_table.Value()) {
@@ -1814,6 +2301,7 @@ void RasterizerOpenGL::SyncLightingLutScale() {
 }
 
 void RasterizerOpenGL::SyncLightingLutData() {
+    FlushDrawBatch();
     const auto& regs = Pica::g_state.regs;
     auto& lut_config = regs.lighting.lut_config;
     uniform_block_data.lighting_lut_dirty[lut_config.type] = true;
@@ -1918,25 +2406,68 @@ void RasterizerOpenGL::SyncShadowTextureBias() {
     }
 }
 
-void RasterizerOpenGL::SyncAndUploadLUTsLF() {
-    constexpr std::size_t max_size =
-        sizeof(GLvec2) * 256 * Pica::LightingRegs::NumLightingSampler + sizeof(GLvec2) * 128; // fog
+void RasterizerOpenGL::SyncVSBoolUniforms() {
+    const auto& setup = Pica::g_state.vs;
+    auto& bools = vs_uniform_block_data.data.uniforms.bools;
+    for (std::size_t i = 0; i < bools.size(); ++i) {
+        const GLint value = setup.uniforms.b[i] ? GL_TRUE : GL_FALSE;
+        if (bools[i].b != value) {
+            bools[i].b = value;
+            vs_uniform_block_data.dirty = true;
+        }
+    }
+}
 
-    if (!uniform_block_data.lighting_lut_dirty_any && !uniform_block_data.fog_lut_dirty) {
+void RasterizerOpenGL::SyncVSIntUniform(u32 index) {
+    const auto& value = Pica::g_state.regs.vs.int_uniforms[index];
+    const GLuvec4 new_value{value.x.Value(), value.y.Value(), value.z.Value(), value.w.Value()};
+    auto& uniform = vs_uniform_block_data.data.uniforms.i[index];
+    if (uniform != new_value) {
+        uniform = new_value;
+        vs_uniform_block_data.dirty = true;
+    }
+}
+
+void RasterizerOpenGL::SyncVSFloatUniform() {
+    // Only a fully written vector is stored, after which the setup index moves to the next one
+    if (Pica::g_state.vs_float_regs_counter != 0) {
+        return;
+    }
+    const u32 next_index = Pica::g_state.regs.vs.uniform_setup.index;
+    auto& floats = vs_uniform_block_data.data.uniforms.f;
+    if (next_index == 0 || next_index > floats.size()) {
         return;
     }
+    const auto& value = Pica::g_state.vs.uniforms.f[next_index - 1];
+    const GLvec4 new_value{value.x.ToFloat32(), value.y.ToFloat32(), value.z.ToFloat32(),
+                           value.w.ToFloat32()};
+    auto& uniform = floats[next_index - 1];
+    if (uniform != new_value) {
+        uniform = new_value;
+        vs_uniform_block_data.dirty = true;
+    }
+}
 
-    u8* buffer;
-    GLintptr offset;
-    bool invalidate;
-    std::size_t bytes_used = 0;
-    glBindBuffer(GL_TEXTURE_BUFFER, texture_lf_buffer.GetHandle());
-    std::tie(buffer, offset, invalidate) = texture_lf_buffer.Map(max_size, sizeof(GLvec4));
+void RasterizerOpenGL::SyncGSUniforms() {
+    // The GS uniforms are only needed by the few draws that use it, so they are compared on those
+    // rather than tracked on every register write
+    GSUniformData data{};
+    data.uniforms.SetFromRegs(Pica::g_state.regs.gs, Pica::g_state.gs);
+    if (std::memcmp(&data, &gs_uniform_block_data.data, sizeof(data)) != 0) {
+        gs_uniform_block_data.data = data;
+        gs_uniform_block_data.dirty = true;
+    }
+}
+
+void RasterizerOpenGL::SyncAndUploadLUTsLF() {
+    if (!uniform_block_data.lighting_lut_dirty_any && !uniform_block_data.fog_lut_dirty) {
+        return;
+    }
 
     // Sync the lighting luts
-    if (uniform_block_data.lighting_lut_dirty_any || invalidate) {
+    if (uniform_block_data.lighting_lut_dirty_any) {
         for (unsigned index = 0; index < uniform_block_data.lighting_lut_dirty.size(); index++) {
-            if (uniform_block_data.lighting_lut_dirty[index] || invalidate) {
+            if (uniform_block_data.lighting_lut_dirty[index]) {
                 bool is_changed = false;
                 for (std::size_t i = 0; i < lighting_lut_data[index].size(); ++i) {
                     const auto& entry = Pica::g_state.lighting.luts[index][i];
@@ -1947,13 +2478,17 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
                         is_changed = true;
                     }
                 }
-                if (is_changed || invalidate) {
-                    std::memcpy(buffer + bytes_used, lighting_lut_data[index].data(),
-                                lighting_lut_data[index].size() * sizeof(GLvec2));
-                    uniform_block_data.data.lighting_lut_offset[index / 4][index % 4] =
-                        (offset + bytes_used) / sizeof(GLvec2);
-                    uniform_block_data.dirty = true;
-                    bytes_used += lighting_lut_data[index].size() * sizeof(GLvec2);
+                if (is_changed || !texture_lf_buffer.IsHeld(index)) {
+                    const GLintptr offset = texture_lf_buffer.Upload(
+                        index, lighting_lut_data[index].data(),
+                        lighting_lut_data[index].size() * sizeof(GLvec2));
+                    GLint& lut_offset =
+                        uniform_block_data.data.lighting_lut_offset[index / 4][index % 4];
+                    const auto new_offset = static_cast<GLint>(offset / sizeof(GLvec2));
+                    if (lut_offset != new_offset) {
+                        lut_offset = new_offset;
+                        uniform_block_data.dirty = true;
+                    }
                 }
                 uniform_block_data.lighting_lut_dirty[index] = false;
             }
@@ -1962,7 +2497,7 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
     }
 
     // Sync the fog lut
-    if (uniform_block_data.fog_lut_dirty || invalidate) {
+    if (uniform_block_data.fog_lut_dirty) {
         bool is_changed = false;
         for (std::size_t i = 0; i < fog_lut_data.size(); ++i) {
             const auto& entry = Pica::g_state.fog.lut[i];
@@ -1973,24 +2508,20 @@ void RasterizerOpenGL::SyncAndUploadLUTsLF() {
                 is_changed = true;
             }
         }
-        if (is_changed || invalidate) {
-            std::memcpy(buffer + bytes_used, fog_lut_data.data(),
-                        fog_lut_data.size() * sizeof(GLvec2));
-            uniform_block_data.data.fog_lut_offset = (offset + bytes_used) / sizeof(GLvec2);
-            uniform_block_data.dirty = true;
-            bytes_used += fog_lut_data.size() * sizeof(GLvec2);
+        if (is_changed || !texture_lf_buffer.IsHeld(FOG_LUT_USER)) {
+            const GLintptr offset = texture_lf_buffer.Upload(
+                FOG_LUT_USER, fog_lut_data.data(), fog_lut_data.size() * sizeof(GLvec2));
+            const auto new_offset = static_cast<GLint>(offset / sizeof(GLvec2));
+            if (uniform_block_data.data.fog_lut_offset != new_offset) {
+                uniform_block_data.data.fog_lut_offset = new_offset;
+                uniform_block_data.dirty = true;
+            }
         }
         uniform_block_data.fog_lut_dirty = false;
     }
-
-    texture_lf_buffer.Unmap(bytes_used);
 }
 
 void RasterizerOpenGL::SyncAndUploadLUTs() {
-    constexpr std::size_t max_size = sizeof(GLvec2) * 128 * 3 + // proctex: noise + color + alpha
-                                     sizeof(GLvec4) * 256 +     // proctex
-                                     sizeof(GLvec4) * 256;      // proctex diff
-
     if (!uniform_block_data.proctex_noise_lut_dirty &&
         !uniform_block_data.proctex_color_map_dirty &&
         !uniform_block_data.proctex_alpha_map_dirty && !uniform_block_data.proctex_lut_dirty &&
@@ -1998,15 +2529,20 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
         return;
     }
 
-    u8* buffer;
-    GLintptr offset;
-    bool invalidate;
-    std::size_t bytes_used = 0;
-    glBindBuffer(GL_TEXTURE_BUFFER, texture_buffer.GetHandle());
-    std::tie(buffer, offset, invalidate) = texture_buffer.Map(max_size, sizeof(GLvec4));
+    // Uploads a changed LUT, the offset only changes if no slot holds its contents yet
+    auto UploadLUT = [this](std::size_t user, const void* data, GLsizeiptr size,
+                            GLsizeiptr texel_size, GLint& lut_offset) {
+        const GLintptr offset = texture_buffer.Upload(user, data, size);
+        const auto new_offset = static_cast<GLint>(offset / texel_size);
+        if (lut_offset != new_offset) {
+            lut_offset = new_offset;
+            uniform_block_data.dirty = true;
+        }
+    };
 
     // helper function for SyncProcTexNoiseLUT/ColorMap/AlphaMap
-    auto SyncProcTexValueLUT = [this, buffer, offset, invalidate, &bytes_used](
+    auto SyncProcTexValueLUT = [this, &UploadLUT](
+                                   std::size_t user,
                                    const std::array<Pica::State::ProcTex::ValueEntry, 128>& lut,
                                    std::array<GLvec2, 128>& lut_data, GLint& lut_offset) {
         bool is_changed = false;
@@ -2019,37 +2555,38 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
                 is_changed = true;
             }
         }
-        if (is_changed || invalidate) {
-            std::memcpy(buffer + bytes_used, lut_data.data(), lut_data.size() * sizeof(GLvec2));
-            lut_offset = (offset + bytes_used) / sizeof(GLvec2);
-            uniform_block_data.dirty = true;
-            bytes_used += lut_data.size() * sizeof(GLvec2);
+        if (is_changed || !texture_buffer.IsHeld(user)) {
+            UploadLUT(user, lut_data.data(), lut_data.size() * sizeof(GLvec2), sizeof(GLvec2),
+                      lut_offset);
         }
     };
 
     // Sync the proctex noise lut
-    if (uniform_block_data.proctex_noise_lut_dirty || invalidate) {
-        SyncProcTexValueLUT(Pica::g_state.proctex.noise_table, proctex_noise_lut_data,
+    if (uniform_block_data.proctex_noise_lut_dirty) {
+        SyncProcTexValueLUT(PROCTEX_NOISE_LUT_USER, Pica::g_state.proctex.noise_table,
+                            proctex_noise_lut_data,
                             uniform_block_data.data.proctex_noise_lut_offset);
         uniform_block_data.proctex_noise_lut_dirty = false;
     }
 
     // Sync the proctex color map
-    if (uniform_block_data.proctex_color_map_dirty || invalidate) {
-        SyncProcTexValueLUT(Pica::g_state.proctex.color_map_table, proctex_color_map_data,
+    if (uniform_block_data.proctex_color_map_dirty) {
+        SyncProcTexValueLUT(PROCTEX_COLOR_MAP_USER, Pica::g_state.proctex.color_map_table,
+                            proctex_color_map_data,
                             uniform_block_data.data.proctex_color_map_offset);
         uniform_block_data.proctex_color_map_dirty = false;
     }
 
     // Sync the proctex alpha map
-    if (uniform_block_data.proctex_alpha_map_dirty || invalidate) {
-        SyncProcTexValueLUT(Pica::g_state.proctex.alpha_map_table, proctex_alpha_map_data,
+    if (uniform_block_data.proctex_alpha_map_dirty) {
+        SyncProcTexValueLUT(PROCTEX_ALPHA_MAP_USER, Pica::g_state.proctex.alpha_map_table,
+                            proctex_alpha_map_data,
                             uniform_block_data.data.proctex_alpha_map_offset);
         uniform_block_data.proctex_alpha_map_dirty = false;
     }
 
     // Sync the proctex lut
-    if (uniform_block_data.proctex_lut_dirty || invalidate) {
+    if (uniform_block_data.proctex_lut_dirty) {
         bool is_changed = false;
         for (std::size_t i = 0; i < proctex_lut_data.size(); ++i) {
             const auto& entry = Pica::g_state.proctex.color_table[i];
@@ -2061,18 +2598,16 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
                 is_changed = true;
             }
         }
-        if (is_changed || invalidate) {
-            std::memcpy(buffer + bytes_used, proctex_lut_data.data(),
-                        proctex_lut_data.size() * sizeof(GLvec4));
-            uniform_block_data.data.proctex_lut_offset = (offset + bytes_used) / sizeof(GLvec4);
-            uniform_block_data.dirty = true;
-            bytes_used += proctex_lut_data.size() * sizeof(GLvec4);
+        if (is_changed || !texture_buffer.IsHeld(PROCTEX_LUT_USER)) {
+            UploadLUT(PROCTEX_LUT_USER, proctex_lut_data.data(),
+                      proctex_lut_data.size() * sizeof(GLvec4), sizeof(GLvec4),
+                      uniform_block_data.data.proctex_lut_offset);
         }
         uniform_block_data.proctex_lut_dirty = false;
     }
 
     // Sync the proctex difference lut
-    if (uniform_block_data.proctex_diff_lut_dirty || invalidate) {
+    if (uniform_block_data.proctex_diff_lut_dirty) {
         bool is_changed = false;
         for (std::size_t i = 0; i < proctex_diff_lut_data.size(); ++i) {
             const auto& entry = Pica::g_state.proctex.color_diff_table[i];
@@ -2084,18 +2619,13 @@ void RasterizerOpenGL::SyncAndUploadLUTs() {
                 is_changed = true;
             }
         }
-        if (is_changed || invalidate) {
-            std::memcpy(buffer + bytes_used, proctex_diff_lut_data.data(),
-                        proctex_diff_lut_data.size() * sizeof(GLvec4));
-            uniform_block_data.data.proctex_diff_lut_offset =
-                (offset + bytes_used) / sizeof(GLvec4);
-            uniform_block_data.dirty = true;
-            bytes_used += proctex_diff_lut_data.size() * sizeof(GLvec4);
+        if (is_changed || !texture_buffer.IsHeld(PROCTEX_DIFF_LUT_USER)) {
+            UploadLUT(PROCTEX_DIFF_LUT_USER, proctex_diff_lut_data.data(),
+                      proctex_diff_lut_data.size() * sizeof(GLvec4), sizeof(GLvec4),
+                      uniform_block_data.data.proctex_diff_lut_offset);
         }
         uniform_block_data.proctex_diff_lut_dirty = false;
     }
-
-    texture_buffer.Unmap(bytes_used);
 }
 
 void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
@@ -2103,13 +2633,17 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     // first
     OpenGLState::BindUniformBuffer(uniform_buffer.GetHandle());
 
-    bool sync_vs = accelerate_draw;
+    const bool use_gs =
+        accelerate_draw && Pica::g_state.regs.pipeline.use_gs != Pica::PipelineRegs::UseGS::No;
+    bool sync_vs = accelerate_draw && vs_uniform_block_data.dirty;
+    bool sync_gs = use_gs && gs_uniform_block_data.dirty;
     bool sync_fs = uniform_block_data.dirty;
 
-    if (!sync_vs && !sync_fs)
+    if (!sync_vs && !sync_gs && !sync_fs)
         return;
 
-    std::size_t uniform_size = uniform_size_aligned_vs + uniform_size_aligned_fs;
+    std::size_t uniform_size =
+        uniform_size_aligned_vs + uniform_size_aligned_gs + uniform_size_aligned_fs;
     std::size_t used_bytes = 0;
     u8* uniforms;
     GLintptr offset;
@@ -2117,13 +2651,25 @@ void RasterizerOpenGL::UploadUniforms(bool accelerate_draw) {
     std::tie(uniforms, offset, invalidate) =
         uniform_buffer.Map(uniform_size, uniform_buffer_alignment);
 
-    if (sync_vs) {
-        VSUniformData vs_uniforms;
-        vs_uniforms.uniforms.SetFromRegs(Pica::g_state.regs.vs, Pica::g_state.vs);
-        std::memcpy(uniforms + used_bytes, &vs_uniforms, sizeof(vs_uniforms));
+    if (sync_vs || (accelerate_draw && invalidate)) {
+        std::memcpy(uniforms + used_bytes, &vs_uniform_block_data.data, sizeof(VSUniformData));
         glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::VS),
                           uniform_buffer.GetHandle(), offset + used_bytes, sizeof(VSUniformData));
+        vs_uniform_block_data.dirty = false;
         used_bytes += uniform_size_aligned_vs;
+    } else if (invalidate) {
+        // The block bound for the vertex shader went away with the old buffer contents
+        vs_uniform_block_data.dirty = true;
+    }
+
+    if (sync_gs || (use_gs && invalidate)) {
+        std::memcpy(uniforms + used_bytes, &gs_uniform_block_data.data, sizeof(GSUniformData));
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::GS),
+                          uniform_buffer.GetHandle(), offset + used_bytes, sizeof(GSUniformData));
+        gs_uniform_block_data.dirty = false;
+        used_bytes += uniform_size_aligned_gs;
+    } else if (invalidate) {
+        gs_uniform_block_data.dirty = true;
     }
 
     if (sync_fs || invalidate) {
@@ -8,6 +8,8 @@
 #include <cstddef>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <glad/glad.h>
 #include "common/bit_field.h"
@@ -21,19 +23,26 @@
 #include "video_core/regs_lighting.h"
 #include "video_core/regs_rasterizer.h"
 #include "video_core/regs_texturing.h"
+#include "video_core/renderer_opengl/gl_dynamic_resolution.h"
+#include "video_core/renderer_opengl/gl_lut_buffer.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
+#include "video_core/renderer_opengl/gl_shadow_depth_buffer.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_stream_buffer.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/shader/shader.h"
 
+namespace Frontend {
+class EmuWindow;
+}
+
 namespace OpenGL {
 
 class RasterizerOpenGL : public VideoCore::RasterizerInterface {
 public:
-    RasterizerOpenGL();
+    explicit RasterizerOpenGL(Frontend::EmuWindow& emu_window);
     ~RasterizerOpenGL() override;
 
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
@@ -47,36 +56,38 @@ public:
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
+    bool AccelerateY2RConversion(const Service::Y2R::ConversionConfiguration& config,
+                                 const std::vector<u8>& input, PAddr dst_addr) override;
     bool AccelerateDisplay(const GPU::Regs::FramebufferConfig& config, PAddr framebuffer_addr,
                            u32 pixel_stride, ScreenInfo& screen_info) override;
     bool AccelerateDrawBatch(bool is_indexed) override;
     void CheckForConfigChanges() override;
     void OnFrameUpdate() override;
+    void RecordSurfaceTrace(const std::string& path) override;
+    bool ReplaySurfaceTrace(const std::string& path) override;
 
 private:
-    struct SamplerInfo {
-        using TextureConfig = Pica::TexturingRegs::TextureConfig;
-
-        OGLSampler sampler;
-
-        /// Creates the sampler object, initializing its state so that it's in sync with the
-        /// SamplerInfo struct.
-        void Create();
-        /// Syncs the sampler object with the config, updating any necessary state.
-        void SyncWithConfig(const TextureConfig& config);
-
-    private:
-        TextureConfig::TextureFilter mag_filter;
-        TextureConfig::TextureFilter min_filter;
-        TextureConfig::TextureFilter mip_filter;
-        TextureConfig::WrapMode wrap_s;
-        TextureConfig::WrapMode wrap_t;
-        u32 border_color;
-        u32 lod_min;
-        u32 lod_max;
-        s32 lod_bias;
+    using TextureConfig = Pica::TexturingRegs::TextureConfig;
+
+    /// The sampler state of a texture config, which is the key of its sampler object
+    union SamplerKey {
+        u64 raw;
+        BitField<0, 1, u64> mag_filter;
+        BitField<1, 1, u64> min_filter;
+        BitField<2, 1, u64> mip_filter;
+        BitField<3, 1, u64> is_cube;
+        BitField<4, 3, u64> wrap_s;
+        BitField<7, 3, u64> wrap_t;
+        BitField<10, 4, u64> lod_min;
+        BitField<14, 4, u64> lod_max;
+        BitField<18, 13, s64> lod_bias;
+        BitField<32, 32, u64> border_color;
     };
 
+    /// Returns the sampler object of a texture config, which is created the first time the
+    /// config is seen and never modified, so that switching samplers is a single bind
+    GLuint GetSampler(const TextureConfig& config);
+
     /// Structure that the hardware rendered vertices are composed of
     struct HardwareVertex {
         HardwareVertex() = default;
@@ -124,6 +135,12 @@ private:
     /// Syncs entire status to match PICA registers
     void SyncEntireState();
 
+    /// Syncs the state of the registers written with a new value since the last draw
+    void SyncDirtyRegs();
+
+    /// Syncs the state that depends on the given PICA register
+    void SyncRegister(u32 id);
+
     /// Syncs the clip enabled status to match the PICA register
     void SyncClipEnabled();
 
@@ -196,6 +213,18 @@ private:
     /// Syncs the lighting global ambient color to match the PICA register
     void SyncGlobalAmbient();
 
+    /// Syncs the vertex shader bool uniforms to match the PICA register
+    void SyncVSBoolUniforms();
+
+    /// Syncs the specified vertex shader int uniform to match the PICA register
+    void SyncVSIntUniform(u32 index);
+
+    /// Syncs the vertex shader float uniform written last, once all its words have arrived
+    void SyncVSFloatUniform();
+
+    /// Syncs the geometry shader uniforms to match the PICA registers
+    void SyncGSUniforms();
+
     /// sync the lighting lut scale
     void SyncLightingLutScale();
 
@@ -245,6 +274,13 @@ private:
     /// Internal implementation for AccelerateDrawBatch
     bool AccelerateDrawBatchInternal(bool is_indexed);
 
+    /// Issues the draw of the vertex batch or the accelerated draw with the current state
+    bool DrawVertexBatch(bool accelerate, bool is_indexed);
+
+    /// Draws into a shadow map with the depth test and blending, see ShadowDepthBuffer
+    bool DrawBlendedShadow(bool accelerate, bool is_indexed, const Surface& color_surface,
+                           const Common::Rectangle<u32>& draw_rect, u32 res_scale);
+
     struct VertexArrayInfo {
         u32 vs_input_index_min;
         u32 vs_input_index_max;
@@ -254,9 +290,55 @@ private:
     /// Retrieve the range and the size of the input vertex
     VertexArrayInfo AnalyzeVertexArray(bool is_indexed);
 
-    /// Setup vertex array for AccelerateDrawBatch
-    void SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
-                          GLuint vs_input_index_max);
+    /// Attribute pointers and defaults derived from the vertex attribute registers
+    struct VertexLayoutInfo {
+        struct Attribute {
+            GLuint input_reg;
+            GLint size;
+            GLenum type;
+            GLuint offset;
+        };
+        struct Loader {
+            u32 index;
+            u32 byte_count;
+            std::size_t first_attribute;
+            std::size_t num_attributes;
+        };
+        std::vector<Loader> loaders;
+        std::vector<Attribute> attributes;
+        std::array<bool, 16> enable_attributes{};
+        /// Attribute index and input register of the attributes read from the default values
+        std::vector<std::pair<u32, u32>> default_attributes;
+        u32 vertex_stride = 0;
+    };
+
+    /// Returns the layout of the current vertex attribute registers, building it if it is new
+    const VertexLayoutInfo& GetVertexLayoutInfo();
+
+    /**
+     * Setup vertex array for AccelerateDrawBatch. The data of each attribute loader is placed in
+     * its own block of vertex_capacity vertices.
+     * @param reuse_uploads Point at arrays already in the stream buffer instead of copying them
+     * @return Number of bytes written to array_ptr
+     */
+    std::size_t SetupVertexArray(u8* array_ptr, GLintptr buffer_offset, GLuint vs_input_index_min,
+                                 GLuint vs_input_index_max, u32 vertex_capacity,
+                                 bool reuse_uploads);
+
+    /// Copies the vertex data of the current draw behind the vertices already in the draw batch
+    void AppendBatchVertices(GLuint vs_input_index_min, GLuint vs_input_index_max);
+
+    /// Copies the indices of the current draw into the draw batch, rebased on its vertices
+    void AppendBatchIndices(GLuint vs_input_index_min);
+
+    /// Records the current draw in the draw batch if nothing but its vertex data changed
+    bool MergeDrawBatch(bool is_indexed);
+
+    /// Submits the draws recorded in the draw batch
+    void FlushDrawBatch();
+
+    /// Unbinds the textures of the last draw, the rasterizer cache might delete them
+    void UnbindTextures();
 
     /// Setup vertex shader for AccelerateDrawBatch
     bool SetupVertexShader();
@@ -287,18 +369,83 @@ private:
         bool dirty;
     } uniform_block_data = {};
 
+    struct {
+        VSUniformData data;
+        bool dirty;
+    } vs_uniform_block_data = {};
+
+    struct {
+        GSUniformData data;
+        bool dirty;
+    } gs_uniform_block_data = {};
+
+    using VertexLayout =
+        std::array<u32, sizeof(Pica::PipelineRegs::vertex_attributes) / sizeof(u32)>;
+
+    /// Copies the vertex attribute registers that describe the vertex layout, leaving out the
+    /// addresses of the vertex data
+    static VertexLayout GetVertexLayout();
+
+    static constexpr u32 DRAW_BATCH_MAX_VERTICES = 0x2000;
+    static constexpr u32 DRAW_BATCH_MAX_INDICES = 0x6000;
+    static constexpr std::size_t DRAW_BATCH_VERTEX_RESERVE = 256 * 1024;
+
+    /// Consecutive accelerated triangle list draws that only differ in their vertex data. They
+    /// stay mapped in the stream buffers until a state change submits them as one draw call.
+    struct {
+        bool active;
+        bool indexed;
+        u8* vertex_ptr;
+        u32 vertex_capacity;
+        u32 num_vertices;
+        /// Position and per vertex size of the block of the last attribute loader
+        std::size_t last_block_offset;
+        u32 last_block_stride;
+        u16* index_ptr;
+        GLintptr index_offset;
+        u32 num_indices;
+        u64 vs_program_hash;
+        u64 vs_swizzle_hash;
+        VertexLayout vertex_layout;
+        Pica::Shader::AttributeBuffer default_attributes;
+    } draw_batch = {};
+
     std::unique_ptr<ShaderProgramManager> shader_program_manager;
 
     // They shall be big enough for about one frame.
     static constexpr std::size_t VERTEX_BUFFER_SIZE = 16 * 1024 * 1024;
     static constexpr std::size_t INDEX_BUFFER_SIZE = 4 * 1024 * 1024;
     static constexpr std::size_t UNIFORM_BUFFER_SIZE = 4 * 1024 * 1024;
-    static constexpr std::size_t TEXTURE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    // LUT slots, their users are the LUTs. A lighting or fog LUT has 256 RG32F texels, proctex
+    // LUTs up to 256 RGBA32F ones. Mali GPUs don't support texture buffers over 65536 texels.
+    static constexpr GLsizeiptr LF_LUT_SLOT_SIZE = 256 * sizeof(GLvec2);
+    static constexpr std::size_t LF_LUT_SLOTS = 128;
+    static constexpr std::size_t FOG_LUT_USER = Pica::LightingRegs::NumLightingSampler;
+    static constexpr std::size_t NUM_LF_LUTS = FOG_LUT_USER + 1;
+    static constexpr GLsizeiptr PROCTEX_LUT_SLOT_SIZE = 256 * sizeof(GLvec4);
+    static constexpr std::size_t PROCTEX_LUT_SLOTS = 64;
+    enum : std::size_t {
+        PROCTEX_NOISE_LUT_USER,
+        PROCTEX_COLOR_MAP_USER,
+        PROCTEX_ALPHA_MAP_USER,
+        PROCTEX_LUT_USER,
+        PROCTEX_DIFF_LUT_USER,
+        NUM_PROCTEX_LUTS,
+    };
 
     OGLVertexArray sw_vao; // VAO for software shader draw
     OGLVertexArray hw_vao; // VAO for hardware shader / accelerate draw
     std::array<bool, 16> hw_vao_enabled_attributes{};
 
+    std::unordered_map<u64, VertexLayoutInfo> vertex_layout_cache;
+    const VertexLayoutInfo* vertex_layout = nullptr;
+    bool vertex_layout_dirty = true;
+
+    /// Smallest vertex array that is worth tracking for reuse
+    static constexpr u32 MIN_CACHED_VERTEX_ARRAY_SIZE = 1024;
+    u32 vertex_buffer_wrap_count = 0;
+
     struct {
         GLuint color_attachment;
         GLuint depth_attachment;
@@ -306,19 +453,22 @@ private:
         u32 height;
     } framebuffer_info{};
 
-    std::array<SamplerInfo, 3> texture_samplers;
+    /// Sampler objects by SamplerKey
+    std::unordered_map<u64, OGLSampler> sampler_cache;
     OGLStreamBuffer vertex_buffer;
     OGLStreamBuffer uniform_buffer;
     OGLStreamBuffer index_buffer;
-    OGLStreamBuffer texture_buffer;
-    OGLStreamBuffer texture_lf_buffer;
+    OGLLUTBuffer texture_buffer;
+    OGLLUTBuffer texture_lf_buffer;
     OGLFramebuffer framebuffer;
+    ShadowDepthBuffer shadow_depth_buffer;
+    /// Picks the render target scale with use_dynamic_resolution, nullptr otherwise
+    std::unique_ptr<DynamicResolution> dynamic_resolution;
     GLint uniform_buffer_alignment;
     std::size_t uniform_size_aligned_vs;
+    std::size_t uniform_size_aligned_gs;
     std::size_t uniform_size_aligned_fs;
 
-    SamplerInfo texture_cube_sampler;
-
     OGLTexture texture_null;
     OGLTexture texture_buffer_lut_lf;
     OGLTexture texture_buffer_lut_rg;
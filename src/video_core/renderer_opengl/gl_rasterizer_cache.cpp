@@ -5,10 +5,12 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <cstring>
 #include <iterator>
 #include <memory>
 #include <optional>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -23,19 +25,28 @@
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
+#include "common/simd.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/custom_tex_cache.h"
 #include "core/frontend/emu_window.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/service/y2r_u.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 #include "core/settings.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_custom_tex_expander.h"
 #include "video_core/renderer_opengl/gl_format_reinterpreter.h"
+#include "video_core/renderer_opengl/gl_gpu_profiler.h"
 #include "video_core/renderer_opengl/gl_rasterizer_cache.h"
 #include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_surface_trace.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
 #include "video_core/renderer_opengl/gl_vars.h"
+#include "video_core/renderer_opengl/gl_y2r_converter.h"
 #include "video_core/utils.h"
 #include "video_core/video_core.h"
 
@@ -80,6 +91,20 @@ constexpr FormatTuple tex_tuple = {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
 
 static OGLFramebuffer g_read_framebuffer;
 static OGLFramebuffer g_draw_framebuffer;
+static std::unique_ptr<CustomTexExpanderOpenGL> g_custom_tex_expander;
+static std::unique_ptr<StagingBufferPool> g_staging_buffers;
+/// Where destroyed surfaces leave their texture, nullptr while no cache exists
+static std::unordered_multimap<u64, RecycledSurfaceTexture>* g_surface_texture_cache = nullptr;
+
+/// Frames a recycled surface texture waits for a new surface before it is freed
+constexpr u32 SURFACE_TEXTURE_IDLE_FRAMES = 60;
+/// Source of CachedSurface::modification_id
+static u64 g_modification_counter = 0;
+/// Set while a trace is replayed
+static SurfaceCacheTimes* g_cache_times = nullptr;
+
+/// Loads of tiled textures larger than this are decoded on several threads
+constexpr u32 PARALLEL_DECODE_THRESHOLD = 64 * 1024;
 
 const FormatTuple& GetFormatTuple(PixelFormat pixel_format) {
     const SurfaceType type = SurfaceParams::GetFormatType(pixel_format);
@@ -97,15 +122,182 @@ const FormatTuple& GetFormatTuple(PixelFormat pixel_format) {
     return tex_tuple;
 }
 
+/// Returns true if the range crosses the start or the end of VRAM
+static bool StraddlesVRAM(PAddr start, PAddr end) {
+    return (start < Memory::VRAM_VADDR_END && end > Memory::VRAM_VADDR_END) ||
+           (start < Memory::VRAM_VADDR && end > Memory::VRAM_VADDR);
+}
+
+/// Returns true if the first mipmap level of the texture in 3DS memory is its box filtered base
+static bool HasBoxFilteredMipmaps(const SurfaceParams& surface) {
+    if (surface.pixel_format > PixelFormat::ETC1A4 || surface.width < 16 || surface.height < 16) {
+        return false;
+    }
+    const PAddr levels_end = surface.end + surface.size / 4;
+    if (StraddlesVRAM(surface.addr, levels_end)) {
+        return false;
+    }
+    const u8* const data = VideoCore::Memory()->GetPhysicalPointer(surface.addr);
+    if (data == nullptr || VideoCore::Memory()->GetPhysicalPointer(levels_end - 1) == nullptr) {
+        return false;
+    }
+
+    Pica::Texture::TextureInfo info;
+    info.physical_address = surface.addr;
+    info.width = surface.width;
+    info.height = surface.height;
+    info.format = static_cast<Pica::TexturingRegs::TextureFormat>(surface.pixel_format);
+    info.SetDefaultStride();
+    return Pica::Texture::IsNextLevelBoxFiltered(data, info);
+}
+
 template <typename Map, typename Interval>
 static constexpr auto RangeFromInterval(Map& map, const Interval& interval) {
     return boost::make_iterator_range(map.equal_range(interval));
 }
 
+#ifdef HAVE_COMMON_SIMD
+namespace MortonSIMD {
+using Common::SIMD::ByteSwap32;
+using Common::SIMD::Load;
+using Common::SIMD::Store;
+using Common::SIMD::Vec;
+
+#if defined(ARCHITECTURE_x86_64)
+/// Returns the low 64 bits of a followed by the low 64 bits of b
+static inline Vec InterleaveLow(Vec a, Vec b) {
+    return _mm_unpacklo_epi64(a, b);
+}
+
+/// Returns the high 64 bits of a followed by the high 64 bits of b
+static inline Vec InterleaveHigh(Vec a, Vec b) {
+    return _mm_unpackhi_epi64(a, b);
+}
+
+/// Swaps the two middle 32-bit lanes
+static inline Vec SwapMiddle(Vec v) {
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/// Rotates each 32-bit lane left by the given number of bits
+template <int bits>
+static inline Vec RotateLeft32(Vec v) {
+    return _mm_or_si128(_mm_slli_epi32(v, bits), _mm_srli_epi32(v, 32 - bits));
+}
+#else
+static inline Vec InterleaveLow(Vec a, Vec b) {
+    return vcombine_u8(vget_low_u8(a), vget_low_u8(b));
+}
+
+static inline Vec InterleaveHigh(Vec a, Vec b) {
+    return vcombine_u8(vget_high_u8(a), vget_high_u8(b));
+}
+
+static inline Vec SwapMiddle(Vec v) {
+    const uint32x4_t lanes = vreinterpretq_u32_u8(v);
+    const uint32x2x2_t t = vtrn_u32(vget_low_u32(lanes), vget_high_u32(lanes));
+    return vreinterpretq_u8_u32(vcombine_u32(t.val[0], t.val[1]));
+}
+
+template <int bits>
+static inline Vec RotateLeft32(Vec v) {
+    const uint32x4_t lanes = vreinterpretq_u32_u8(v);
+    return vreinterpretq_u8_u32(
+        vorrq_u32(vshlq_n_u32(lanes, bits), vshrq_n_u32(lanes, 32 - bits)));
+}
+#endif
+
+/// Converts four guest pixels to the layout expected by OpenGL
+template <PixelFormat format>
+static inline Vec ToGL(Vec v, bool byteswap) {
+    if constexpr (format == PixelFormat::D24S8) {
+        // Stencil moves from the top byte to the bottom one
+        return RotateLeft32<8>(v);
+    } else if constexpr (format == PixelFormat::RGBA8) {
+        return byteswap ? ByteSwap32(v) : v;
+    } else {
+        return v;
+    }
+}
+
+/// Converts four OpenGL pixels back to the guest layout
+template <PixelFormat format>
+static inline Vec FromGL(Vec v) {
+    if constexpr (format == PixelFormat::D24S8) {
+        return RotateLeft32<24>(v);
+    } else {
+        return v;
+    }
+}
+
+/**
+ * Copies an 8x8 tile two rows at a time. Every 2x2 subtile is stored contiguously, so for 32-bit
+ * formats one 16 byte load holds two pixels of each row, and for 16-bit formats one load holds a
+ * pair of horizontally adjacent 2x2 subtiles that a lane swap turns into two half rows.
+ */
+template <bool morton_to_gl, PixelFormat format>
+static void CopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
+    constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
+    static_assert(bytes_per_pixel == 2 || bytes_per_pixel == 4);
+    // GLES has no ABGR format, so RGBA8 is byteswapped on the way to OpenGL
+    const bool byteswap = format == PixelFormat::RGBA8 && GLES;
+    const u32 gl_stride = stride * bytes_per_pixel;
+
+    for (u32 y = 0; y < 8; y += 2) {
+        u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(0, y) * bytes_per_pixel;
+        u8* row0 = gl_buffer + (7 - y) * gl_stride;
+        u8* row1 = row0 - gl_stride;
+        if constexpr (bytes_per_pixel == 4) {
+            // The 2x2 subtiles of a row pair start at pixels 0, 4, 16 and 20
+            if constexpr (morton_to_gl) {
+                const Vec q0 = Load(tile_ptr);
+                const Vec q1 = Load(tile_ptr + 16);
+                const Vec q2 = Load(tile_ptr + 64);
+                const Vec q3 = Load(tile_ptr + 80);
+                Store(row0, ToGL<format>(InterleaveLow(q0, q1), byteswap));
+                Store(row0 + 16, ToGL<format>(InterleaveLow(q2, q3), byteswap));
+                Store(row1, ToGL<format>(InterleaveHigh(q0, q1), byteswap));
+                Store(row1 + 16, ToGL<format>(InterleaveHigh(q2, q3), byteswap));
+            } else {
+                const Vec r0a = FromGL<format>(Load(row0));
+                const Vec r0b = FromGL<format>(Load(row0 + 16));
+                const Vec r1a = FromGL<format>(Load(row1));
+                const Vec r1b = FromGL<format>(Load(row1 + 16));
+                Store(tile_ptr, InterleaveLow(r0a, r1a));
+                Store(tile_ptr + 16, InterleaveHigh(r0a, r1a));
+                Store(tile_ptr + 64, InterleaveLow(r0b, r1b));
+                Store(tile_ptr + 80, InterleaveHigh(r0b, r1b));
+            }
+        } else {
+            // Pixels 0 to 7 cover columns 0 to 3, pixels 16 to 23 columns 4 to 7
+            if constexpr (morton_to_gl) {
+                const Vec left = SwapMiddle(Load(tile_ptr));
+                const Vec right = SwapMiddle(Load(tile_ptr + 32));
+                Store(row0, InterleaveLow(left, right));
+                Store(row1, InterleaveHigh(left, right));
+            } else {
+                const Vec r0 = Load(row0);
+                const Vec r1 = Load(row1);
+                Store(tile_ptr, SwapMiddle(InterleaveLow(r0, r1)));
+                Store(tile_ptr + 32, SwapMiddle(InterleaveHigh(r0, r1)));
+            }
+        }
+    }
+}
+} // namespace MortonSIMD
+#endif
+
 template <bool morton_to_gl, PixelFormat format>
 static void MortonCopyTile(u32 stride, u8* tile_buffer, u8* gl_buffer) {
     constexpr u32 bytes_per_pixel = SurfaceParams::GetFormatBpp(format) / 8;
     constexpr u32 gl_bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(format);
+#ifdef HAVE_COMMON_SIMD
+    if constexpr (bytes_per_pixel == gl_bytes_per_pixel &&
+                  (bytes_per_pixel == 2 || bytes_per_pixel == 4)) {
+        MortonSIMD::CopyTile<morton_to_gl, format>(stride, tile_buffer, gl_buffer);
+        return;
+    }
+#endif
     for (u32 y = 0; y < 8; ++y) {
         for (u32 x = 0; x < 8; ++x) {
             u8* tile_ptr = tile_buffer + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
@@ -238,6 +430,12 @@ static constexpr std::array<void (*)(u32, u32, u8*, PAddr, PAddr, PAddr), 18> gl
     MortonCopy<false, PixelFormat::D24S8> // 17
 };
 
+/// Surfaces with the same key can share a texture
+static u64 GetSurfaceTextureKey(const SurfaceParams& params) {
+    return static_cast<u64>(params.pixel_format) << 48 | static_cast<u64>(params.res_scale) << 32 |
+           static_cast<u64>(params.width) << 16 | params.height;
+}
+
 // Allocate an uninitialized texture of appropriate size and format for the surface
 static void AllocateSurfaceTexture(GLuint texture, const FormatTuple& format_tuple, u32 width,
                                    u32 height) {
@@ -256,7 +454,8 @@ static void AllocateSurfaceTexture(GLuint texture, const FormatTuple& format_tup
     OpenGLState::BindTexture2D(0, old_tex);
 }
 
-static void AllocateTextureCube(GLuint texture, const FormatTuple& format_tuple, u32 width) {
+static void AllocateTextureCube(GLuint texture, const FormatTuple& format_tuple, u32 width,
+                                u32 levels) {
     // Keep track of previous texture bindings
     GLuint old_tex = OpenGLState::BindTextureCube(texture);
 
@@ -266,9 +465,9 @@ static void AllocateTextureCube(GLuint texture, const FormatTuple& format_tuple,
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, levels - 1);
 
-    glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, format_tuple.internal_format, width, width);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, levels, format_tuple.internal_format, width, width);
 
     // Restore previous texture bindings
     OpenGLState::BindTextureCube(old_tex);
@@ -332,6 +531,50 @@ static bool BlitTextures(GLuint src_tex, const Common::Rectangle<u32>& src_rect,
 
 static bool FillSurface(const Surface& surface, const u8* fill_data,
                         const Common::Rectangle<u32>& fill_rect) {
+    // Clearing the texture itself needs no framebuffer or state changes
+    if (GLAD_GL_ARB_clear_texture) {
+        surface->InvalidateAllWatcher();
+        const auto x = static_cast<GLint>(fill_rect.left);
+        const auto y = static_cast<GLint>(fill_rect.bottom);
+        const auto width = static_cast<GLsizei>(fill_rect.GetWidth());
+        const auto height = static_cast<GLsizei>(fill_rect.GetHeight());
+        const GLuint texture = surface->texture.handle;
+
+        if (surface->type == SurfaceType::Color || surface->type == SurfaceType::Texture) {
+            Pica::Texture::TextureInfo tex_info{};
+            tex_info.format =
+                static_cast<Pica::TexturingRegs::TextureFormat>(surface->pixel_format);
+            Common::Vec4<u8> color = Pica::Texture::LookupTexture(fill_data, 0, 0, tex_info);
+            std::array<GLfloat, 4> color_values = {color.x / 255.f, color.y / 255.f,
+                                                   color.z / 255.f, color.w / 255.f};
+            glClearTexSubImage(texture, 0, x, y, 0, width, height, 1, GL_RGBA, GL_FLOAT,
+                               color_values.data());
+        } else if (surface->type == SurfaceType::Depth) {
+            u32 value_32bit = 0;
+            GLfloat value_float = 0.0f;
+            if (surface->pixel_format == SurfaceParams::PixelFormat::D16) {
+                std::memcpy(&value_32bit, fill_data, 2);
+                value_float = value_32bit / 65535.0f; // 2^16 - 1
+            } else if (surface->pixel_format == SurfaceParams::PixelFormat::D24) {
+                std::memcpy(&value_32bit, fill_data, 3);
+                value_float = value_32bit / 16777215.0f; // 2^24 - 1
+            }
+            glClearTexSubImage(texture, 0, x, y, 0, width, height, 1, GL_DEPTH_COMPONENT,
+                               GL_FLOAT, &value_float);
+        } else if (surface->type == SurfaceType::DepthStencil) {
+            u32 value_32bit;
+            std::memcpy(&value_32bit, fill_data, sizeof(u32));
+            // Layout of GL_FLOAT_32_UNSIGNED_INT_24_8_REV, the stencil is in the low byte
+            struct {
+                GLfloat depth;
+                GLuint stencil;
+            } value{(value_32bit & 0xFFFFFF) / 16777215.0f, value_32bit >> 24};
+            glClearTexSubImage(texture, 0, x, y, 0, width, height, 1, GL_DEPTH_STENCIL,
+                               GL_FLOAT_32_UNSIGNED_INT_24_8_REV, &value);
+        }
+        return true;
+    }
+
     OpenGLState prev_state = OpenGLState::GetCurState();
     OpenGLState state;
     state.scissor.enabled = true;
@@ -403,32 +646,36 @@ static bool FillSurface(const Surface& surface, const u8* fill_data,
     return true;
 }
 
-bool CachedSurface::CanFill(const SurfaceParams& dest_surface,
-                            SurfaceInterval fill_interval) const {
-    if (type == SurfaceType::Fill && IsRegionValid(fill_interval) &&
-        boost::icl::first(fill_interval) >= addr &&
-        boost::icl::last_next(fill_interval) <= end && // dest_surface is within our fill range
-        dest_surface.FromInterval(fill_interval).GetInterval() ==
-            fill_interval) { // make sure interval is a rectangle in dest surface
-        if (fill_size * 8 != dest_surface.GetFormatBpp()) {
-            // Check if bits repeat for our fill_size
-            const u32 dest_bytes_per_pixel = std::max(dest_surface.GetFormatBpp() / 8, 1u);
-            std::vector<u8> fill_test(fill_size * dest_bytes_per_pixel);
-
-            for (u32 i = 0; i < dest_bytes_per_pixel; ++i)
-                std::memcpy(&fill_test[i * fill_size], &fill_data[0], fill_size);
-
-            for (u32 i = 0; i < fill_size; ++i)
-                if (std::memcmp(&fill_test[dest_bytes_per_pixel * i], &fill_test[0],
-                                dest_bytes_per_pixel) != 0)
-                    return false;
-
-            if (dest_surface.GetFormatBpp() == 4 && (fill_test[0] & 0xF) != (fill_test[0] >> 4))
-                return false;
-        }
+/// Returns true if every pixel of the format gets the same value from the fill pattern
+static bool IsFillPatternUniform(const u8* fill_data, u32 fill_size, u32 dest_bpp) {
+    if (fill_size * 8 == dest_bpp) {
         return true;
     }
-    return false;
+    // Check if bits repeat for our fill_size
+    const u32 dest_bytes_per_pixel = std::max(dest_bpp / 8, 1u);
+    std::vector<u8> fill_test(fill_size * dest_bytes_per_pixel);
+
+    for (u32 i = 0; i < dest_bytes_per_pixel; ++i)
+        std::memcpy(&fill_test[i * fill_size], fill_data, fill_size);
+
+    for (u32 i = 0; i < fill_size; ++i)
+        if (std::memcmp(&fill_test[dest_bytes_per_pixel * i], &fill_test[0],
+                        dest_bytes_per_pixel) != 0)
+            return false;
+
+    if (dest_bpp == 4 && (fill_test[0] & 0xF) != (fill_test[0] >> 4))
+        return false;
+    return true;
+}
+
+bool CachedSurface::CanFill(const SurfaceParams& dest_surface,
+                            SurfaceInterval fill_interval) const {
+    return type == SurfaceType::Fill && IsRegionValid(fill_interval) &&
+           boost::icl::first(fill_interval) >= addr &&
+           boost::icl::last_next(fill_interval) <= end && // dest_surface is within our fill range
+           dest_surface.FromInterval(fill_interval).GetInterval() ==
+               fill_interval && // make sure interval is a rectangle in dest surface
+           IsFillPatternUniform(&fill_data[0], fill_size, dest_surface.GetFormatBpp());
 }
 
 bool CachedSurface::CanCopy(const SurfaceParams& dest_surface,
@@ -448,12 +695,15 @@ MICROPROFILE_DEFINE(OpenGL_CopySurface, "OpenGL", "CopySurface", MP_RGB(128, 192
 void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surface& dst_surface,
                                         SurfaceInterval copy_interval) {
     MICROPROFILE_SCOPE(OpenGL_CopySurface);
+    GPUProfiler::Scope gpu_scope(VideoCore::GPUTiming::SectionType::Blit);
 
     SurfaceParams subrect_params = dst_surface->FromInterval(copy_interval);
     ASSERT(subrect_params.GetInterval() == copy_interval);
 
     ASSERT(src_surface != dst_surface);
 
+    dst_surface->modification_id = ++g_modification_counter;
+
     // This is only called when CanCopy is true, no need to run checks here
     if (src_surface->type == SurfaceType::Fill) {
         // FillSurface needs a 4 bytes buffer
@@ -477,6 +727,21 @@ void RasterizerCacheOpenGL::CopySurface(const Surface& src_surface, const Surfac
     UNREACHABLE();
 }
 
+CachedSurface::~CachedSurface() {
+    if (texture.handle == 0 || custom_tex_storage || g_surface_texture_cache == nullptr) {
+        return;
+    }
+    // The next surface starts without mipmaps, the levels are specified again when it gets some
+    if (max_level != 0) {
+        GLuint old_tex = OpenGLState::BindTexture2D(0, texture.handle);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        OpenGLState::BindTexture2D(0, old_tex);
+    }
+    g_surface_texture_cache->emplace(
+        GetSurfaceTextureKey(*this),
+        RecycledSurfaceTexture{std::move(texture), VideoCore::GetCurrentFrame()});
+}
+
 MICROPROFILE_DEFINE(OpenGL_SurfaceLoad, "OpenGL", "Surface Load", MP_RGB(128, 192, 64));
 void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
     ASSERT(type != SurfaceType::Fill);
@@ -486,7 +751,7 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
         return;
 
     if (gl_buffer.empty()) {
-        gl_buffer.resize(width * height * GetGLBytesPerPixel(pixel_format));
+        gl_buffer = g_staging_buffers->Acquire(width * height * GetGLBytesPerPixel(pixel_format));
     }
 
     // TODO: Should probably be done in ::Memory:: and check for other regions too
@@ -539,15 +804,43 @@ void CachedSurface::LoadGLBuffer(PAddr load_start, PAddr load_end) {
             const auto rect = GetSubRect(FromInterval(load_interval));
             ASSERT(FromInterval(load_interval).GetInterval() == load_interval);
 
-            for (unsigned y = rect.bottom; y < rect.top; ++y) {
-                for (unsigned x = rect.left; x < rect.right; ++x) {
-                    auto vec4 =
-                        Pica::Texture::LookupTexture(texture_src_data, x, height - 1 - y, tex_info);
-                    const std::size_t offset = (x + (width * y)) * 4;
-                    std::memcpy(&gl_buffer[offset], vec4.AsArray(), 4);
+            // Decoded a tile at a time, the rows of the rect are flipped in texture coordinates
+            const std::size_t tile_size = Pica::Texture::CalculateTileSize(tex_info.format);
+            const u32 first_row = height - rect.top;
+            const u32 last_row = height - rect.bottom;
+            const u32 first_tile_y = first_row / 8 * 8;
+            const auto decode_tile_row = [&](std::size_t index) {
+                const u32 tile_y = first_tile_y + static_cast<u32>(index) * 8;
+                std::array<Common::Vec4<u8>, 8 * 8> texels;
+                for (u32 tile_x = rect.left / 8 * 8; tile_x < rect.right; tile_x += 8) {
+                    Pica::Texture::DecodeTile(texture_src_data + (tile_y / 8) * tex_info.stride +
+                                                  (tile_x / 8) * tile_size,
+                                              tex_info, texels);
+                    const u32 row_begin = std::max(tile_y, first_row);
+                    const u32 row_end = std::min(tile_y + 8, last_row);
+                    const u32 x_begin = std::max(tile_x, rect.left);
+                    const u32 x_end = std::min(tile_x + 8, rect.right);
+                    for (u32 row = row_begin; row < row_end; ++row) {
+                        const std::size_t offset = (x_begin + width * (height - 1 - row)) * 4;
+                        const std::size_t texel = (row - tile_y) * 8 + x_begin - tile_x;
+                        std::memcpy(&gl_buffer[offset], &texels[texel], (x_end - x_begin) * 4);
+                    }
+                }
+            };
+
+            // The tile rows write disjoint rows of the buffer, large loads like big ETC1
+            // textures spread them over the shared thread pool
+            SurfaceCacheTimer timer(g_cache_times, SurfaceCacheTimes::MortonCopy);
+            const std::size_t num_tile_rows = (last_row - first_tile_y + 7) / 8;
+            if (load_end - load_start > PARALLEL_DECODE_THRESHOLD) {
+                Common::ThreadPool::GetShared().ParallelFor(num_tile_rows, decode_tile_row);
+            } else {
+                for (std::size_t i = 0; i < num_tile_rows; ++i) {
+                    decode_tile_row(i);
                 }
             }
         } else {
+            SurfaceCacheTimer timer(g_cache_times, SurfaceCacheTimes::MortonCopy);
             morton_to_gl_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
                                                                      addr, load_start, load_end);
         }
@@ -569,6 +862,7 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
         flush_start = Memory::VRAM_VADDR;
 
     MICROPROFILE_SCOPE(OpenGL_SurfaceFlush);
+    PERF_SCOPE(SurfaceFlushes);
 
     ASSERT(flush_start >= addr && flush_end <= end);
     const u32 start_offset = flush_start - addr;
@@ -592,26 +886,20 @@ void CachedSurface::FlushGLBuffer(PAddr flush_start, PAddr flush_end) {
         ASSERT(type == SurfaceType::Color);
         std::memcpy(dst_buffer + start_offset, &gl_buffer[start_offset], flush_end - flush_start);
     } else {
+        SurfaceCacheTimer timer(g_cache_times, SurfaceCacheTimes::MortonCopy);
         gl_to_morton_fns[static_cast<std::size_t>(pixel_format)](stride, height, &gl_buffer[0],
                                                                  addr, flush_start, flush_end);
     }
 }
 
-const Core::CustomTexInfo* CachedSurface::LoadCustomTexture(u64 tex_hash,
-                                                            Common::Rectangle<u32>& custom_rect) {
-    const Core::CustomTexInfo* tex_info = nullptr;
+std::shared_ptr<const Core::CustomTexInfo> CachedSurface::LoadCustomTexture(
+    u64 tex_hash, Common::Rectangle<u32>& custom_rect) {
     auto& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
-
-    if (custom_tex_cache.IsTextureCached(tex_hash)) {
-        tex_info = &custom_tex_cache.LookupTexture(tex_hash);
-    } else {
-        if (custom_tex_cache.CustomTextureExists(tex_hash)) {
-            const auto& path_info = custom_tex_cache.LookupTexturePathInfo(tex_hash);
-            custom_tex_cache.LoadTexture(path_info);
-            if (custom_tex_cache.IsTextureCached(tex_hash)) {
-                tex_info = &custom_tex_cache.LookupTexture(tex_hash);
-            }
-        }
+    std::shared_ptr<const Core::CustomTexInfo> tex_info =
+        custom_tex_cache.GetTexture(tex_hash, CustomTexExpanderOpenGL::GetSupportedFormats());
+    pending_custom_hash.reset();
+    if (!tex_info && custom_tex_cache.CustomTextureExists(tex_hash)) {
+        pending_custom_hash = tex_hash;
     }
 
     if (tex_info) {
@@ -627,11 +915,17 @@ const Core::CustomTexInfo* CachedSurface::LoadCustomTexture(u64 tex_hash,
 MICROPROFILE_DEFINE(OpenGL_TextureUL, "OpenGL", "Texture Upload", MP_RGB(128, 192, 64));
 void CachedSurface::UploadGLTexture(const Common::Rectangle<u32>& rect) {
     MICROPROFILE_SCOPE(OpenGL_TextureUL);
+    GPUProfiler::Scope gpu_scope(VideoCore::GPUTiming::SectionType::Upload);
+    modification_id = ++g_modification_counter;
     // Required for rect to function properly with custom textures
     Common::Rectangle custom_rect = rect;
     PixelFormat custom_format = pixel_format;
 
-    if (Settings::values.custom_textures) {
+    if (Settings::values.custom_textures && rect != GetRect()) {
+        // The staging buffer only holds the rows that were just loaded, which can't be hashed
+        custom_tex_info.reset();
+        pending_custom_hash.reset();
+    } else if (Settings::values.custom_textures) {
         u64 tex_hash = Common::TextureHash64(gl_buffer.data(), gl_buffer.size());
         if (!custom_tex_info || custom_tex_info->hash != tex_hash) {
             custom_tex_info = LoadCustomTexture(tex_hash, custom_rect);
@@ -666,21 +960,32 @@ void CachedSurface::UploadGLTexture(const Common::Rectangle<u32>& rect) {
         target_tex = unscaled_tex.handle;
     } else if (custom_tex_info) {
         AllocateSurfaceTexture(texture.handle, tuple, custom_tex_info->width, custom_tex_info->height);
+        custom_tex_storage = true;
     }
 
-    GLuint old_tex = OpenGLState::BindTexture2D(0, target_tex);
-    if (custom_tex_info) {
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(custom_tex_info->width));
-        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, custom_tex_info->width, custom_tex_info->height,
-                        GL_RGBA, GL_UNSIGNED_BYTE, custom_tex_info->tex.data());
+    if (custom_tex_info && custom_tex_info->format != Core::CustomTexFormat::RGBA8) {
+        const u32 left = static_cast<u32>(x0);
+        const u32 bottom = static_cast<u32>(y0);
+        g_custom_tex_expander->Expand(
+            *custom_tex_info, target_tex,
+            {left, bottom + custom_tex_info->height, left + custom_tex_info->width, bottom},
+            g_draw_framebuffer.handle);
     } else {
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(stride));
-        glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
-                        static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                        &gl_buffer[buffer_offset]);
+        GLuint old_tex = OpenGLState::BindTexture2D(0, target_tex);
+        if (custom_tex_info) {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(custom_tex_info->width));
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, custom_tex_info->width,
+                            custom_tex_info->height, GL_RGBA, GL_UNSIGNED_BYTE,
+                            custom_tex_info->GetData());
+        } else {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(stride));
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, static_cast<GLsizei>(rect.GetWidth()),
+                            static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
+                            &gl_buffer[buffer_offset]);
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        OpenGLState::BindTexture2D(0, old_tex);
     }
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-    OpenGLState::BindTexture2D(0, old_tex);
 
     if (res_scale != 1) {
         auto scaled_rect = custom_rect;
@@ -698,11 +1003,24 @@ void CachedSurface::UploadGLTexture(const Common::Rectangle<u32>& rect) {
 MICROPROFILE_DEFINE(OpenGL_TextureDL, "OpenGL", "Texture Download", MP_RGB(128, 192, 64));
 void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect) {
     MICROPROFILE_SCOPE(OpenGL_TextureDL);
-    u32 bytes_per_pixel = GetGLBytesPerPixel(pixel_format);
-    const FormatTuple& tuple = GetFormatTuple(pixel_format);
+    const u32 bytes_per_pixel = GetGLBytesPerPixel(pixel_format);
     if (gl_buffer.empty()) {
-        gl_buffer.resize(stride * height * bytes_per_pixel);
+        gl_buffer = g_staging_buffers->Acquire(stride * height * bytes_per_pixel);
     }
+    const std::size_t buffer_offset = (rect.bottom * stride + rect.left) * bytes_per_pixel;
+    ReadGLTexture(rect, &gl_buffer[buffer_offset]);
+}
+
+void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint pack_buffer) {
+    MICROPROFILE_SCOPE(OpenGL_TextureDL);
+    const u32 bytes_per_pixel = GetGLBytesPerPixel(pixel_format);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pack_buffer);
+    ReadGLTexture(rect, reinterpret_cast<GLvoid*>(rect.left * bytes_per_pixel));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void CachedSurface::ReadGLTexture(const Common::Rectangle<u32>& rect, GLvoid* pixels) {
+    const FormatTuple& tuple = GetFormatTuple(pixel_format);
 
     GLint x0 = rect.left;
     GLint y0 = rect.bottom;
@@ -730,7 +1048,6 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect) {
 
     glPixelStorei(GL_PACK_ROW_LENGTH, static_cast<GLint>(stride));
     OpenGLState::BindReadFramebuffer(g_read_framebuffer.handle);
-    std::size_t buffer_offset = (y0 * stride + x0) * bytes_per_pixel;
     if (type == SurfaceType::Color || type == SurfaceType::Texture) {
         glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target_tex,
                                0);
@@ -747,15 +1064,12 @@ void CachedSurface::DownloadGLTexture(const Common::Rectangle<u32>& rect) {
                                target_tex, 0);
     }
     glReadPixels(x0, y0, static_cast<GLsizei>(rect.GetWidth()),
-                 static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type,
-                 &gl_buffer[buffer_offset]);
+                 static_cast<GLsizei>(rect.GetHeight()), tuple.format, tuple.type, pixels);
     glPixelStorei(GL_PACK_ROW_LENGTH, 0);
 }
 
 void CachedSurface::DumpToFile() {
-    if (gl_buffer.empty()) {
-        DownloadGLTexture(GetRect());
-    }
+    DownloadGLTexture(GetRect());
 
     const std::string& output = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
     const auto& image_interface = Core::System::GetInstance().GetImageInterface();
@@ -766,6 +1080,7 @@ void CachedSurface::DumpToFile() {
     std::vector<u8> pixels(width * height * bytes_per_pixel);
     ConvertToRGBA8888((u32*)pixels.data(), gl_buffer.data(), width * height, tuple.format,
                       tuple.type);
+    gl_buffer.Release();
     image_interface->EncodePNG(path, pixels, width, height);
 }
 
@@ -797,6 +1112,7 @@ template <MatchFlags find_flags>
 static Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams& params,
                          ScaleMatch match_scale_type,
                          std::optional<SurfaceInterval> validate_interval = std::nullopt) {
+    SurfaceCacheTimer timer(g_cache_times, SurfaceCacheTimes::FindMatch);
     Surface match_surface = nullptr;
     bool match_valid = false;
     u32 match_scale = 0;
@@ -883,15 +1199,36 @@ static Surface FindMatch(const SurfaceCache& surface_cache, const SurfaceParams&
 
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
     resolution_scale_factor = VideoCore::GetResolutionScaleFactor();
+    target_scales = LoadTargetScales(resolution_scale_factor);
     format_reinterpreter = std::make_unique<FormatReinterpreterOpenGL>();
+    if (Settings::values.use_gpu_texture_decode) {
+        if (TextureDecoderOpenGL::IsSupported()) {
+            texture_decoder = std::make_unique<TextureDecoderOpenGL>();
+            y2r_converter = std::make_unique<Y2RConverterOpenGL>();
+        } else {
+            LOG_WARNING(Render_OpenGL, "Compute shaders unavailable, textures decode on the CPU");
+        }
+    }
 
     g_read_framebuffer.Create();
     g_draw_framebuffer.Create();
+    g_custom_tex_expander = std::make_unique<CustomTexExpanderOpenGL>();
+    g_staging_buffers = std::make_unique<StagingBufferPool>();
+    g_surface_texture_cache = &surface_texture_cache;
 }
 
 RasterizerCacheOpenGL::~RasterizerCacheOpenGL() {
+    for (auto& download : pending_downloads) {
+        if (download.fence != nullptr) {
+            glDeleteSync(download.fence);
+        }
+    }
     g_read_framebuffer.Release();
     g_draw_framebuffer.Release();
+    g_custom_tex_expander.reset();
+    g_staging_buffers.reset();
+    // The surfaces still around free their textures
+    g_surface_texture_cache = nullptr;
 }
 
 MICROPROFILE_DEFINE(OpenGL_BlitSurface, "OpenGL", "BlitSurface", MP_RGB(128, 192, 64));
@@ -900,18 +1237,51 @@ bool RasterizerCacheOpenGL::BlitSurfaces(const Surface& src_surface,
                                          const Surface& dst_surface,
                                          const Common::Rectangle<u32>& dst_rect) {
     MICROPROFILE_SCOPE(OpenGL_BlitSurface);
+    GPUProfiler::Scope gpu_scope(VideoCore::GPUTiming::SectionType::Blit);
 
     if (!SurfaceParams::CheckFormatsBlittable(src_surface->pixel_format, dst_surface->pixel_format))
         return false;
 
     dst_surface->InvalidateAllWatcher();
 
+    if (src_surface == dst_surface) {
+        // Blitting between overlapping parts of the same texture is undefined, which in-place
+        // display transfers (e.g. a vertical flip) rely on. Go through a copy of the source.
+        const u32 width = src_rect.GetWidth();
+        const u32 height = src_rect.GetHeight();
+        const Common::Rectangle<u32> src_bounds{
+            std::min(src_rect.left, src_rect.right), std::max(src_rect.top, src_rect.bottom),
+            std::max(src_rect.left, src_rect.right), std::min(src_rect.top, src_rect.bottom)};
+        Common::Rectangle<u32> temp_rect{0, height, width, 0};
+
+        OGLTexture temp_tex;
+        temp_tex.Create();
+        AllocateSurfaceTexture(temp_tex.handle, GetFormatTuple(src_surface->pixel_format), width,
+                               height);
+        BlitTextures(src_surface->texture.handle, src_bounds, temp_tex.handle, temp_rect,
+                     src_surface->type);
+
+        if (src_rect.left > src_rect.right) {
+            std::swap(temp_rect.left, temp_rect.right);
+        }
+        if (src_rect.bottom > src_rect.top) {
+            std::swap(temp_rect.top, temp_rect.bottom);
+        }
+        return BlitTextures(temp_tex.handle, temp_rect, dst_surface->texture.handle, dst_rect,
+                            src_surface->type);
+    }
+
     return BlitTextures(src_surface->texture.handle, src_rect, dst_surface->texture.handle,
                         dst_rect, src_surface->type);
 }
 
 Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatch match_res_scale,
                                           bool load_if_create) {
+    SurfaceTraceRecorder::Scope trace_scope(trace_recorder.get());
+    if (trace_scope.IsOutermost()) {
+        trace_recorder->Record(SurfaceTraceEntry::SurfaceLookup(
+            SurfaceTraceOp::GetSurface, params, static_cast<u8>(match_res_scale), load_if_create));
+    }
     if (params.addr == 0 || params.height * params.width == 0) {
         return nullptr;
     }
@@ -964,6 +1334,13 @@ Surface RasterizerCacheOpenGL::GetSurface(const SurfaceParams& params, ScaleMatc
 SurfaceRect_Tuple RasterizerCacheOpenGL::GetSurfaceSubRect(const SurfaceParams& params,
                                                            ScaleMatch match_res_scale,
                                                            bool load_if_create) {
+    SurfaceTraceRecorder::Scope trace_scope(trace_recorder.get());
+    if (trace_scope.IsOutermost()) {
+        trace_recorder->Record(SurfaceTraceEntry::SurfaceLookup(SurfaceTraceOp::GetSurfaceSubRect,
+                                                                params,
+                                                                static_cast<u8>(match_res_scale),
+                                                                load_if_create));
+    }
     if (params.addr == 0 || params.height == 0 || params.width == 0) {
         return {};
     }
@@ -1054,6 +1431,10 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(
 
 Surface RasterizerCacheOpenGL::GetTextureSurface(const Pica::Texture::TextureInfo& info,
                                                  u32 max_level) {
+    SurfaceTraceRecorder::Scope trace_scope(trace_recorder.get());
+    if (trace_scope.IsOutermost()) {
+        trace_recorder->Record(SurfaceTraceEntry::TextureLookup(info, max_level));
+    }
     if (info.physical_address == 0) {
         return nullptr;
     }
@@ -1147,9 +1528,31 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(const Pica::Texture::TextureInf
                 glGenerateMipmap(GL_TEXTURE_2D);
             }
             surface->max_level = max_level;
+            surface->mipmaps_generated_id = 0;
             OpenGLState::BindTexture2D(0, old_tex);
         }
 
+        // Checked once per surface, games that draw their own mipmaps keep loading them from
+        // memory level by level
+        if (Settings::values.generate_mipmaps && !surface->custom_tex_info &&
+            surface->mipmap_source == MipmapSource::Unknown) {
+            if (HasBoxFilteredMipmaps(*surface)) {
+                surface->mipmap_source = MipmapSource::Generated;
+                surface->level_watchers.fill(nullptr);
+            } else {
+                surface->mipmap_source = MipmapSource::Guest;
+            }
+        }
+        if (surface->mipmap_source == MipmapSource::Generated && !surface->custom_tex_info) {
+            if (surface->mipmaps_generated_id != surface->modification_id) {
+                GLuint old_tex = OpenGLState::BindTexture2D(0, surface->texture.handle);
+                glGenerateMipmap(GL_TEXTURE_2D);
+                OpenGLState::BindTexture2D(0, old_tex);
+                surface->mipmaps_generated_id = surface->modification_id;
+            }
+            return surface;
+        }
+
         // Blit mipmaps that have been invalidated
         OpenGLState prev_state = OpenGLState::GetCurState();
         OpenGLState state;
@@ -1205,9 +1608,21 @@ Surface RasterizerCacheOpenGL::GetTextureSurface(const Pica::Texture::TextureInf
     return surface;
 }
 
-const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCubeConfig& config) {
+const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCubeConfig& config,
+                                                                bool use_mipmaps) {
     auto hash_key = Common::ComputeHash64(&config, sizeof(config));
     auto& cube = texture_cube_cache[hash_key];
+    cube.last_used_frame = VideoCore::GetCurrentFrame();
+
+    // Cubes only get a mipmap chain once a sampler reads it, the faces are reloaded into the new
+    // texture
+    if (use_mipmaps && cube.texture.handle != 0 && cube.levels == 1) {
+        cube.texture.Release();
+        texture_memory -= cube.memory_usage;
+        for (auto* watcher : {&cube.px, &cube.nx, &cube.py, &cube.ny, &cube.pz, &cube.nz}) {
+            watcher->reset();
+        }
+    }
 
     struct Face {
         Face(std::shared_ptr<SurfaceWatcher>& watcher, PAddr address, GLenum gl_face)
@@ -1254,11 +1669,23 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
             }
         }
 
+        const u32 face_size = cube.res_scale * config.width;
+        cube.levels = 1;
+        while (use_mipmaps && (face_size >> cube.levels) != 0) {
+            ++cube.levels;
+        }
         cube.texture.Create();
         AllocateTextureCube(
             cube.texture.handle,
-            GetFormatTuple(CachedSurface::PixelFormatFromTextureFormat(config.format)),
-            cube.res_scale * config.width);
+            GetFormatTuple(CachedSurface::PixelFormatFromTextureFormat(config.format)), face_size,
+            cube.levels);
+        cube.memory_usage = 0;
+        for (u32 level = 0; level < cube.levels; ++level) {
+            const std::size_t level_size = face_size >> level;
+            cube.memory_usage += 6 * level_size * level_size * 4;
+        }
+        texture_memory += cube.memory_usage;
+        cube.mipmaps_dirty = true;
     }
 
     u32 scaled_size = cube.res_scale * config.width;
@@ -1288,9 +1715,18 @@ const CachedTextureCube& RasterizerCacheOpenGL::GetTextureCube(const TextureCube
             glBlitFramebuffer(src_rect.left, src_rect.bottom, src_rect.right, src_rect.top, 0, 0,
                               scaled_size, scaled_size, GL_COLOR_BUFFER_BIT, GL_LINEAR);
             face.watcher->Validate();
+            cube.mipmaps_dirty = true;
         }
     }
     prev_state.SubApply();
+
+    // Faces that change while only the base level is sampled don't regenerate the chain
+    if (use_mipmaps && cube.mipmaps_dirty) {
+        GLuint old_tex = OpenGLState::BindTextureCube(cube.texture.handle);
+        glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        OpenGLState::BindTextureCube(old_tex);
+        cube.mipmaps_dirty = false;
+    }
     return cube;
 }
 
@@ -1308,7 +1744,7 @@ SurfaceSurfaceRect_Tuple RasterizerCacheOpenGL::GetFramebufferSurfaces(
     // get color and depth surfaces
     SurfaceParams color_params;
     color_params.is_tiled = true;
-    color_params.res_scale = resolution_scale_factor;
+    color_params.res_scale = GetTargetScale(using_color_fb);
     color_params.width = config.GetWidth();
     color_params.height = config.GetHeight();
 
@@ -1403,6 +1839,43 @@ Surface RasterizerCacheOpenGL::GetFillSurface(const GPU::Regs::MemoryFillConfig&
     return new_surface;
 }
 
+Surface RasterizerCacheOpenGL::FillCachedSurface(const GPU::Regs::MemoryFillConfig& config) {
+    const PAddr start = config.GetStartAddress();
+    const PAddr end = config.GetEndAddress();
+    const u32 fill_size = config.fill_32bit ? 4 : (config.fill_24bit ? 3 : 2);
+    std::array<u8, 4> fill_data;
+    std::memcpy(&fill_data[0], &config.value_32bit, 4);
+
+    // The most recently used surface covering exactly the filled region
+    Surface match_surface;
+    for (const auto& pair : RangeFromInterval(surface_cache, SurfaceInterval(start, end))) {
+        for (const auto& surface : pair.second) {
+            if (surface->addr != start || surface->end != end ||
+                (surface->type != SurfaceType::Color && surface->type != SurfaceType::Depth &&
+                 surface->type != SurfaceType::DepthStencil) ||
+                !IsFillPatternUniform(&fill_data[0], fill_size, surface->GetFormatBpp())) {
+                continue;
+            }
+            if (match_surface == nullptr ||
+                surface->last_used_frame > match_surface->last_used_frame) {
+                match_surface = surface;
+            }
+        }
+    }
+    if (match_surface == nullptr) {
+        return nullptr;
+    }
+
+    // FillSurface needs a 4 bytes buffer
+    std::array<u8, 4> fill_buffer;
+    for (u32 i = 0; i < 4; ++i) {
+        fill_buffer[i] = fill_data[i % fill_size];
+    }
+    FillSurface(match_surface, &fill_buffer[0], match_surface->GetScaledRect());
+    match_surface->last_used_frame = VideoCore::GetCurrentFrame();
+    return match_surface;
+}
+
 SurfaceRect_Tuple RasterizerCacheOpenGL::GetTexCopySurface(const SurfaceParams& params) {
     Common::Rectangle<u32> rect{};
 
@@ -1453,6 +1926,7 @@ void RasterizerCacheOpenGL::DuplicateSurface(const Surface& src_surface,
 }
 
 void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr, u32 size) {
+    SurfaceCacheTimer timer(g_cache_times, SurfaceCacheTimes::ValidateSurface);
     if (size == 0)
         return;
 
@@ -1465,6 +1939,9 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
     }
 
     auto validate_regions = surface->invalid_regions & validate_interval;
+    if (!validate_regions.empty()) {
+        surface->content_hash = 0;
+    }
     auto notify_validated = [&](SurfaceInterval interval) {
         surface->invalid_regions.erase(interval);
         validate_regions.erase(interval);
@@ -1513,8 +1990,15 @@ void RasterizerCacheOpenGL::ValidateSurface(const Surface& surface, PAddr addr,
         // Load data from 3DS memory
         if (surface->pixel_format < PixelFormat::D16) {
             FlushRegion(params.addr, params.size);
-            surface->LoadGLBuffer(params.addr, params.end);
-            surface->UploadGLTexture(surface->GetSubRect(params));
+            if (!ValidateByContentHash(surface, params) &&
+                !ValidateByComputeDecode(surface, params)) {
+                surface->LoadGLBuffer(params.addr, params.end);
+                surface->UploadGLTexture(surface->GetSubRect(params));
+                surface->gl_buffer.Release();
+                if (surface->pending_custom_hash) {
+                    pending_custom_surfaces.push_back(surface);
+                }
+            }
         } else {
             LOG_INFO(Render_OpenGL, "ValidateSurface load depth: {}", surface->pixel_format);
         }
@@ -1586,7 +2070,115 @@ bool RasterizerCacheOpenGL::ValidateByReinterpretation(const Surface& surface,
     return false;
 }
 
-void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const Surface& flush_surface) {
+bool RasterizerCacheOpenGL::ValidateByContentHash(const Surface& surface,
+                                                  const SurfaceParams& params) {
+    // Only whole textures are tracked, custom textures are looked up by the decoded data instead
+    if (surface->type != SurfaceType::Texture || Settings::values.custom_textures ||
+        params.addr != surface->addr || params.end != surface->end ||
+        StraddlesVRAM(params.addr, params.end)) {
+        return false;
+    }
+
+    const u8* const src_data = VideoCore::Memory()->GetPhysicalPointer(params.addr);
+    if (src_data == nullptr) {
+        return false;
+    }
+
+    std::size_t hash = Common::TextureHash64(src_data, params.size);
+    boost::hash_combine(hash, surface->width);
+    boost::hash_combine(hash, surface->height);
+    boost::hash_combine(hash, surface->pixel_format);
+    // Zero marks a surface without a known hash
+    const u64 content_hash = std::max<u64>(hash, 1);
+
+    auto& entry = texture_content_cache[content_hash];
+    const Surface src_surface = entry.lock();
+    surface->content_hash = content_hash;
+    if (src_surface == nullptr || src_surface == surface ||
+        src_surface->content_hash != content_hash) {
+        // The caller uploads the data, later surfaces can copy from this one
+        entry = surface;
+        return false;
+    }
+
+    BlitTextures(src_surface->texture.handle, src_surface->GetScaledRect(),
+                 surface->texture.handle, surface->GetScaledRect(), surface->type);
+    surface->modification_id = ++g_modification_counter;
+    surface->InvalidateAllWatcher();
+    return true;
+}
+
+bool RasterizerCacheOpenGL::ValidateByComputeDecode(const Surface& surface,
+                                                    const SurfaceParams& params) {
+    // Custom textures are looked up by the hash of the decoded CPU buffer
+    if (!texture_decoder || !surface->is_tiled || Settings::values.custom_textures ||
+        !TextureDecoderOpenGL::CanDecode(surface->pixel_format)) {
+        return false;
+    }
+
+    // Regions straddling the VRAM boundaries are clamped by LoadGLBuffer
+    if (StraddlesVRAM(params.addr, params.end)) {
+        return false;
+    }
+
+    const u8* const src_data = VideoCore::Memory()->GetPhysicalPointer(params.addr);
+    if (src_data == nullptr) {
+        return false;
+    }
+
+    const auto rect = surface->GetSubRect(params);
+    const GLuint decoded_tex =
+        texture_decoder->Decode(src_data, params.size, params.addr - surface->addr,
+                                surface->pixel_format, surface->stride, surface->height, rect);
+    BlitTextures(decoded_tex, {0, rect.GetHeight(), rect.GetWidth(), 0},
+                 surface->texture.handle, surface->GetScaledSubRect(params), surface->type);
+    surface->modification_id = ++g_modification_counter;
+    surface->InvalidateAllWatcher();
+    return true;
+}
+
+bool RasterizerCacheOpenGL::ConvertY2R(const Service::Y2R::ConversionConfiguration& config,
+                                       const std::vector<u8>& input, PAddr dst_addr) {
+    if (!y2r_converter) {
+        return false;
+    }
+
+    SurfaceParams dst_params;
+    dst_params.addr = dst_addr;
+    dst_params.width = config.input_line_width;
+    dst_params.height = config.input_lines;
+    dst_params.is_tiled = config.block_alignment == Service::Y2R::BlockAlignment::Block8x8;
+    // The output formats are the first four color formats
+    dst_params.pixel_format = static_cast<PixelFormat>(config.output_format);
+    dst_params.UpdateParams();
+
+    // The whole image is written, so nothing is loaded
+    Common::Rectangle<u32> dst_rect;
+    Surface dst_surface;
+    std::tie(dst_surface, dst_rect) = GetSurfaceSubRect(dst_params, ScaleMatch::Ignore, false);
+    if (dst_surface == nullptr) {
+        return false;
+    }
+
+    const GLuint converted_tex = y2r_converter->Convert(config, input, dst_params.is_tiled);
+    if (!BlitTextures(converted_tex, {0, dst_params.height, dst_params.width, 0},
+                      dst_surface->texture.handle, dst_rect, dst_surface->type)) {
+        return false;
+    }
+
+    // The image stays in the cache until the CPU reads it
+    InvalidateRegion(dst_params.addr, dst_params.size, dst_surface);
+    return true;
+}
+
+void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const Surface& flush_surface,
+                                        bool track_readback) {
+    SurfaceTraceRecorder::Scope trace_scope(trace_recorder.get());
+    if (trace_scope.IsOutermost() && flush_surface == nullptr) {
+        auto entry = SurfaceTraceEntry::Region(SurfaceTraceOp::FlushRegion, addr, size);
+        entry.flag = track_readback ? 1 : 0;
+        trace_recorder->Record(entry);
+    }
     if (size == 0 || surface_cache.rbegin()->first.upper() < addr) {
         return;
     }
@@ -1605,11 +2197,16 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const Surface& flu
             continue;
 
         if (!GLES || surface->pixel_format < PixelFormat::D16) {
-            if (surface->type != SurfaceType::Fill) {
+            if (surface->type != SurfaceType::Fill && !CompleteDownload(surface, interval)) {
                 SurfaceParams params = surface->FromInterval(interval);
                 surface->DownloadGLTexture(surface->GetSubRect(params));
+                surface->cpu_readback |= track_readback;
+                if (track_readback && surface->type == SurfaceType::Color) {
+                    readback_targets.insert(surface->addr);
+                }
             }
             surface->FlushGLBuffer(boost::icl::first(interval), boost::icl::last_next(interval));
+            surface->gl_buffer.Release();
         }
         flushed_intervals += interval;
     }
@@ -1618,11 +2215,144 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const Surface& flu
 }
 
 void RasterizerCacheOpenGL::FlushAll() {
-    FlushRegion(0, 0xFFFFFFFF);
+    // Flushing everything says nothing about what the CPU is going to read
+    FlushRegion(0, 0xFFFFFFFF, nullptr, false);
+}
+
+void RasterizerCacheOpenGL::QueueDownloads() {
+    for (const auto& pair : dirty_regions) {
+        const auto& surface = pair.second;
+        if (surface->cpu_readback && surface->type != SurfaceType::Fill &&
+            (!GLES || surface->pixel_format < PixelFormat::D16)) {
+            QueueDownload(surface, pair.first);
+        }
+    }
+}
+
+void RasterizerCacheOpenGL::QueueDownload(const Surface& surface,
+                                          const SurfaceInterval& interval) {
+    const auto is_queued = [&](const PendingDownload& download) {
+        return download.fence != nullptr && download.surface.lock() == surface &&
+               download.gpu_write_count == surface->gpu_write_count &&
+               boost::icl::contains(download.interval, interval);
+    };
+    if (std::any_of(pending_downloads.begin(), pending_downloads.end(), is_queued)) {
+        return;
+    }
+
+    PendingDownload& download = pending_downloads[next_download];
+    next_download = (next_download + 1) % NUM_PENDING_DOWNLOADS;
+
+    // The oldest readback is dropped, its data would have been needed by now
+    if (download.fence != nullptr) {
+        glDeleteSync(download.fence);
+        download.fence = nullptr;
+    }
+
+    const auto rect = surface->GetSubRect(surface->FromInterval(interval));
+    const u32 bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+    const std::size_t size = rect.GetHeight() * surface->stride * bytes_per_pixel;
+    if (download.buffer.handle == 0) {
+        download.buffer.Create();
+    }
+    if (download.buffer_size < size) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download.buffer.handle);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        download.buffer_size = size;
+    }
+
+    surface->DownloadGLTexture(rect, download.buffer.handle);
+    download.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    download.surface = surface;
+    download.interval = interval;
+    download.rect = rect;
+    download.gpu_write_count = surface->gpu_write_count;
+}
+
+bool RasterizerCacheOpenGL::CompleteDownload(const Surface& surface,
+                                             const SurfaceInterval& interval) {
+    for (auto& download : pending_downloads) {
+        if (download.fence == nullptr || download.surface.lock() != surface ||
+            !boost::icl::contains(download.interval, interval)) {
+            continue;
+        }
+
+        const bool stale = download.gpu_write_count != surface->gpu_write_count;
+        if (!stale) {
+            glClientWaitSync(download.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        }
+        glDeleteSync(download.fence);
+        download.fence = nullptr;
+        download.surface.reset();
+        if (stale) {
+            continue;
+        }
+
+        const u32 bytes_per_pixel = CachedSurface::GetGLBytesPerPixel(surface->pixel_format);
+        const std::size_t row_pitch = surface->stride * bytes_per_pixel;
+        const std::size_t row_size = download.rect.GetWidth() * bytes_per_pixel;
+        const std::size_t left_offset = download.rect.left * bytes_per_pixel;
+        const std::size_t size = download.rect.GetHeight() * row_pitch;
+        if (surface->gl_buffer.empty()) {
+            surface->gl_buffer =
+                g_staging_buffers->Acquire(surface->stride * surface->height * bytes_per_pixel);
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, download.buffer.handle);
+        const auto* pixels = static_cast<const u8*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+        if (pixels != nullptr) {
+            u8* dst = &surface->gl_buffer[download.rect.bottom * row_pitch + left_offset];
+            for (u32 y = 0; y < download.rect.GetHeight(); ++y) {
+                std::memcpy(dst + y * row_pitch, pixels + y * row_pitch + left_offset, row_size);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return pixels != nullptr;
+    }
+    return false;
+}
+
+void RasterizerCacheOpenGL::UpdatePendingCustomTextures() {
+    const auto& custom_tex_cache = Core::System::GetInstance().CustomTexCache();
+    const auto is_done = [this, &custom_tex_cache](const std::weak_ptr<CachedSurface>& weak) {
+        const Surface surface = weak.lock();
+        if (!surface || !surface->registered || !surface->pending_custom_hash) {
+            return true;
+        }
+        if (!custom_tex_cache.IsTextureReady(*surface->pending_custom_hash)) {
+            return false;
+        }
+
+        // The surface reloads from memory with the custom texture on its next use, unless the GPU
+        // has drawn over it since
+        surface->pending_custom_hash.reset();
+        if (!boost::icl::intersects(dirty_regions, surface->GetInterval())) {
+            surface->invalid_regions.insert(surface->GetInterval());
+        }
+        return true;
+    };
+    pending_custom_surfaces.erase(std::remove_if(pending_custom_surfaces.begin(),
+                                                 pending_custom_surfaces.end(), is_done),
+                                  pending_custom_surfaces.end());
 }
 
 void RasterizerCacheOpenGL::OnFrameUpdate() {
+    QueueDownloads();
+    UpdatePendingCustomTextures();
+    g_staging_buffers->EndFrame();
+
     u32 current_frame = VideoCore::GetCurrentFrame();
+    for (auto it = surface_texture_cache.begin(); it != surface_texture_cache.end();) {
+        if (current_frame - it->second.release_frame > SURFACE_TEXTURE_IDLE_FRAMES) {
+            it = surface_texture_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
     if (current_frame > last_clean_frame + CLEAN_FRAME_INTERVAL) {
         const u32 frame_lower_bound = current_frame - CLEAN_FRAME_INTERVAL;
         const SurfaceInterval interval(0, 0xFFFFFFFF);
@@ -1643,22 +2373,203 @@ void RasterizerCacheOpenGL::OnFrameUpdate() {
         }
         last_clean_frame = current_frame;
     }
+
+    EvictSurfaces();
+}
+
+bool RasterizerCacheOpenGL::IsSurfaceDirty(const Surface& surface) const {
+    for (const auto& pair : RangeFromInterval(dirty_regions, surface->GetInterval())) {
+        if (pair.second == surface) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RasterizerCacheOpenGL::EvictSurfaces() {
+    const std::size_t budget =
+        static_cast<std::size_t>(Settings::values.texture_memory_budget) * 1024 * 1024;
+    if (budget == 0 || texture_memory <= budget) {
+        return;
+    }
+
+    // Anything used by the frame that just finished, which includes its framebuffers, stays
+    const u32 current_frame = VideoCore::GetCurrentFrame();
+    const auto is_recent = [current_frame](u32 last_used_frame) {
+        return last_used_frame + 1 >= current_frame;
+    };
+
+    struct Candidate {
+        u32 last_used_frame;
+        Surface surface;
+        u64 cube_key;
+    };
+    std::vector<Candidate> candidates;
+    const SurfaceInterval interval(0, 0xFFFFFFFF);
+    for (const auto& pair : RangeFromInterval(surface_cache, interval)) {
+        for (const auto& surface : pair.second) {
+            if (surface->type == SurfaceType::Fill || is_recent(surface->last_used_frame) ||
+                IsSurfaceDirty(surface)) {
+                continue;
+            }
+            candidates.push_back({surface->last_used_frame, surface, 0});
+        }
+    }
+    for (const auto& [key, cube] : texture_cube_cache) {
+        if (cube.texture.handle != 0 && !is_recent(cube.last_used_frame)) {
+            candidates.push_back({cube.last_used_frame, nullptr, key});
+        }
+    }
+
+    // A surface spanning several intervals of the cache shows up once per interval
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.last_used_frame < rhs.last_used_frame;
+    });
+
+    const std::size_t old_usage = texture_memory;
+    for (const auto& candidate : candidates) {
+        if (texture_memory <= budget) {
+            break;
+        }
+        if (candidate.surface != nullptr) {
+            UnregisterSurface(candidate.surface);
+        } else {
+            texture_memory -= texture_cube_cache[candidate.cube_key].memory_usage;
+            texture_cube_cache.erase(candidate.cube_key);
+        }
+    }
+    LOG_DEBUG(Render_OpenGL, "Evicted {} KiB of textures", (old_usage - texture_memory) / 1024);
 }
 
 u16 RasterizerCacheOpenGL::GetScaleFactor() const {
     return resolution_scale_factor;
 }
 
+RasterizerCacheOpenGL::TargetScales RasterizerCacheOpenGL::LoadTargetScales(u16 scale) {
+    const auto class_scale = [scale](u16 factor) { return factor != 0 ? factor : scale; };
+    return {scale, class_scale(Settings::values.resolution_factor_depth),
+            class_scale(Settings::values.resolution_factor_offscreen),
+            class_scale(Settings::values.resolution_factor_readback)};
+}
+
+bool RasterizerCacheOpenGL::TargetScalesChanged(u16 scale) const {
+    return LoadTargetScales(scale) != target_scales;
+}
+
+void RasterizerCacheOpenGL::RescaleTargets(u16 scale) {
+    resolution_scale_factor = scale;
+    target_scales = LoadTargetScales(scale);
+}
+
+void RasterizerCacheOpenGL::RecordTrace(const std::string& path) {
+    trace_recorder.reset();
+    if (!path.empty()) {
+        trace_recorder = std::make_unique<SurfaceTraceRecorder>(path);
+    }
+}
+
+bool RasterizerCacheOpenGL::ReplayTrace(const std::string& path) {
+    const std::vector<SurfaceTraceEntry> entries = LoadSurfaceTrace(path);
+    if (entries.empty()) {
+        return false;
+    }
+
+    SurfaceCacheTimes times;
+    g_cache_times = &times;
+    SCOPE_EXIT({ g_cache_times = nullptr; });
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const SurfaceTraceEntry& entry : entries) {
+        const auto match_res_scale = static_cast<ScaleMatch>(entry.match_res_scale);
+        switch (entry.op) {
+        case SurfaceTraceOp::GetSurface:
+            GetSurface(entry.GetSurfaceParams(), match_res_scale, entry.flag != 0);
+            break;
+        case SurfaceTraceOp::GetSurfaceSubRect:
+            GetSurfaceSubRect(entry.GetSurfaceParams(), match_res_scale, entry.flag != 0);
+            break;
+        case SurfaceTraceOp::GetTextureSurface:
+            GetTextureSurface(entry.GetTextureInfo(), entry.max_level);
+            break;
+        case SurfaceTraceOp::FlushRegion:
+            FlushRegion(entry.region_addr, entry.region_size, nullptr, entry.flag != 0);
+            break;
+        case SurfaceTraceOp::InvalidateRegion: {
+            // The owner is the render target that the cache returns for its parameters
+            Surface owner;
+            if (entry.flag != 0) {
+                owner = std::get<0>(
+                    GetSurfaceSubRect(entry.GetSurfaceParams(), ScaleMatch::Ignore, false));
+            }
+            InvalidateRegion(entry.region_addr, entry.region_size, owner);
+            break;
+        }
+        }
+    }
+    glFinish();
+    const std::chrono::duration<double, std::milli> total =
+        std::chrono::steady_clock::now() - start;
+
+    const auto milliseconds = [&times](SurfaceCacheTimes::Part part) {
+        return static_cast<double>(times.ns[part]) / 1e6;
+    };
+    LOG_INFO(Render_OpenGL, "Replayed {} surface cache calls of {} in {:.3f} ms", entries.size(),
+             path, total.count());
+    LOG_INFO(Render_OpenGL, "FindMatch: {} calls, {:.3f} ms",
+             times.calls[SurfaceCacheTimes::FindMatch], milliseconds(SurfaceCacheTimes::FindMatch));
+    LOG_INFO(Render_OpenGL, "ValidateSurface: {} calls, {:.3f} ms",
+             times.calls[SurfaceCacheTimes::ValidateSurface],
+             milliseconds(SurfaceCacheTimes::ValidateSurface));
+    LOG_INFO(Render_OpenGL, "Morton copies: {} calls, {:.3f} ms",
+             times.calls[SurfaceCacheTimes::MortonCopy],
+             milliseconds(SurfaceCacheTimes::MortonCopy));
+    return true;
+}
+
+u16 RasterizerCacheOpenGL::GetTargetScale(bool using_color_fb) const {
+    // Largest side of the targets of effects, the screens are at least 320 pixels wide
+    constexpr u32 OffscreenSize = 256;
+
+    const auto& regs = Pica::g_state.regs.framebuffer;
+    const auto& config = regs.framebuffer;
+    TargetClass target_class = TargetClass::Framebuffer;
+    if (!using_color_fb || regs.IsShadowRendering()) {
+        target_class = TargetClass::Depth;
+    } else if (readback_targets.count(config.GetColorBufferPhysicalAddress())) {
+        target_class = TargetClass::ReadBack;
+    } else if (config.GetWidth() == config.GetHeight() ||
+               std::max<u32>(config.GetWidth(), config.GetHeight()) <= OffscreenSize) {
+        target_class = TargetClass::Offscreen;
+    }
+    return target_scales[static_cast<std::size_t>(target_class)];
+}
+
 void RasterizerCacheOpenGL::SetScaleFactor(u16 scale) {
     FlushAll();
     while (!surface_cache.empty())
         UnregisterSurface(*surface_cache.begin()->second.begin());
     texture_cube_cache.clear();
+    texture_content_cache.clear();
+    texture_memory = 0;
     surface_texture_cache.clear();
+    readback_targets.clear();
     resolution_scale_factor = scale;
+    target_scales = LoadTargetScales(scale);
 }
 
 void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner) {
+    SurfaceTraceRecorder::Scope trace_scope(trace_recorder.get());
+    if (trace_scope.IsOutermost()) {
+        trace_recorder->Record(SurfaceTraceEntry::Region(SurfaceTraceOp::InvalidateRegion, addr,
+                                                         size, region_owner.get()));
+    }
+    for (auto& vertex_array : cached_vertex_arrays) {
+        if (vertex_array.size != 0 && vertex_array.addr < addr + size &&
+            addr < vertex_array.addr + vertex_array.size) {
+            UncacheVertexArray(vertex_array);
+        }
+    }
+
     if (size == 0 || surface_cache.rbegin()->first.upper() < addr) {
         return;
     }
@@ -1671,6 +2582,8 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
         // Surfaces can't have a gap
         ASSERT(region_owner->width == region_owner->stride);
         region_owner->invalid_regions.erase(invalid_interval);
+        ++region_owner->gpu_write_count;
+        region_owner->modification_id = ++g_modification_counter;
     }
 
     for (const auto& pair : RangeFromInterval(surface_cache, invalid_interval)) {
@@ -1681,7 +2594,9 @@ void RasterizerCacheOpenGL::InvalidateRegion(PAddr addr, u32 size, const Surface
             // If cpu is invalidating this region we want to remove it
             // to (likely) mark the memory pages as uncached
             if (region_owner == nullptr && size <= 8) {
-                if (Settings::values.skip_cpu_write) {
+                // A well-behaved title flushes the data cache over what it wrote before the GPU
+                // reads it, which invalidates the surface then
+                if (Settings::values.trust_cache_maintenance) {
                     continue;
                 }
                 FlushRegion(cached_surface->addr, cached_surface->size, cached_surface);
@@ -1728,10 +2643,16 @@ Surface RasterizerCacheOpenGL::CreateSurface(const SurfaceParams& params) {
     Surface surface = std::make_shared<CachedSurface>();
     static_cast<SurfaceParams&>(*surface) = params;
 
-    surface->texture.Create();
     surface->invalid_regions.insert(surface->GetInterval());
-    AllocateSurfaceTexture(surface->texture.handle, GetFormatTuple(surface->pixel_format),
-                           surface->GetScaledWidth(), surface->GetScaledHeight());
+    const auto recycled = surface_texture_cache.find(GetSurfaceTextureKey(params));
+    if (recycled != surface_texture_cache.end()) {
+        surface->texture = std::move(recycled->second.texture);
+        surface_texture_cache.erase(recycled);
+    } else {
+        surface->texture.Create();
+        AllocateSurfaceTexture(surface->texture.handle, GetFormatTuple(surface->pixel_format),
+                               surface->GetScaledWidth(), surface->GetScaledHeight());
+    }
 
     return surface;
 }
@@ -1741,6 +2662,7 @@ void RasterizerCacheOpenGL::RegisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = true;
+    texture_memory += surface->GetMemoryUsage();
     surface_cache.add({surface->GetInterval(), SurfaceSet{surface}});
     UpdatePagesCachedCount(surface->addr, surface->size, 1);
 }
@@ -1750,10 +2672,50 @@ void RasterizerCacheOpenGL::UnregisterSurface(const Surface& surface) {
         return;
     }
     surface->registered = false;
+    texture_memory -= surface->GetMemoryUsage();
+    if (surface->content_hash != 0) {
+        const auto it = texture_content_cache.find(surface->content_hash);
+        if (it != texture_content_cache.end() && it->second.lock() == surface) {
+            texture_content_cache.erase(it);
+        }
+    }
     UpdatePagesCachedCount(surface->addr, surface->size, -1);
     surface_cache.subtract({surface->GetInterval(), SurfaceSet{surface}});
 }
 
+bool RasterizerCacheOpenGL::GetCachedVertexArray(PAddr addr, u32 size, GLintptr& offset) const {
+    for (const auto& vertex_array : cached_vertex_arrays) {
+        if (vertex_array.addr == addr && vertex_array.size == size) {
+            offset = vertex_array.offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RasterizerCacheOpenGL::CacheVertexArray(PAddr addr, u32 size, GLintptr offset) {
+    auto& vertex_array = cached_vertex_arrays[next_vertex_array];
+    next_vertex_array = (next_vertex_array + 1) % cached_vertex_arrays.size();
+    UncacheVertexArray(vertex_array);
+
+    // Marking the pages makes CPU writes to them invalidate the uploaded copy
+    vertex_array = {addr, size, offset};
+    UpdatePagesCachedCount(addr, size, 1);
+}
+
+void RasterizerCacheOpenGL::ClearVertexArrays() {
+    for (auto& vertex_array : cached_vertex_arrays) {
+        UncacheVertexArray(vertex_array);
+    }
+}
+
+void RasterizerCacheOpenGL::UncacheVertexArray(CachedVertexArray& vertex_array) {
+    if (vertex_array.size != 0) {
+        UpdatePagesCachedCount(vertex_array.addr, vertex_array.size, -1);
+        vertex_array = {};
+    }
+}
+
 void RasterizerCacheOpenGL::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
     const u32 num_pages =
         ((addr + size - 1) >> Memory::PAGE_BITS) - (addr >> Memory::PAGE_BITS) + 1;
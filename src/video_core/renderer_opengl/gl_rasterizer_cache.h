@@ -7,7 +7,9 @@
 #include <array>
 #include <list>
 #include <memory>
+#include <optional>
 #include <set>
+#include <string>
 #include <tuple>
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -19,6 +21,7 @@
 #pragma GCC diagnostic pop
 #endif
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/functional/hash.hpp>
 #include <glad/glad.h>
 #include "common/assert.h"
@@ -27,12 +30,20 @@
 #include "common/math_util.h"
 #include "core/custom_tex_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_staging_buffer_pool.h"
 #include "video_core/renderer_opengl/gl_surface_params.h"
 #include "video_core/texture/texture_decode.h"
 
+namespace Service::Y2R {
+struct ConversionConfiguration;
+} // namespace Service::Y2R
+
 namespace OpenGL {
 
 class FormatReinterpreterOpenGL;
+class SurfaceTraceRecorder;
+class TextureDecoderOpenGL;
+class Y2RConverterOpenGL;
 
 using SurfaceSet = std::set<Surface>;
 
@@ -102,7 +113,17 @@ private:
     bool valid = false;
 };
 
+/// Where the mipmap levels of a texture surface come from
+enum class MipmapSource : u8 {
+    Unknown,   ///< Not decided yet, the levels weren't needed so far
+    Guest,     ///< Blitted from the surfaces of the levels in 3DS memory
+    Generated, ///< Generated from the base level, the guest levels are plain box filtered
+};
+
 struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface> {
+    /// Hands the texture to the cache for reuse by a surface of the same format and size
+    ~CachedSurface();
+
     bool CanFill(const SurfaceParams& dest_surface, SurfaceInterval fill_interval) const;
     bool CanCopy(const SurfaceParams& dest_surface, SurfaceInterval copy_interval) const;
 
@@ -128,10 +149,36 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     u32 max_level = 0;
     /// level_watchers[i] watches the (i+1)-th level mipmap source surface
     std::array<std::shared_ptr<SurfaceWatcher>, 7> level_watchers;
+    MipmapSource mipmap_source = MipmapSource::Unknown;
+    /// modification_id of the texture when its mipmaps were last generated
+    u64 mipmaps_generated_id = 0;
 
-    const Core::CustomTexInfo* custom_tex_info = nullptr;
+    std::shared_ptr<const Core::CustomTexInfo> custom_tex_info;
+    /// Hash of the custom texture the surface waits for, the original texture is used meanwhile
+    std::optional<u64> pending_custom_hash;
     u32 last_used_frame = 0;
 
+    /// Hash of the guest data the whole texture was last loaded from, zero once it changed since
+    u64 content_hash = 0;
+
+    /// Bumped whenever the GPU writes to the surface, used to detect stale readbacks
+    u32 gpu_write_count = 0;
+    /// Changes whenever the texture is written, unique across all surfaces
+    u64 modification_id = 0;
+    /// Set once GPU written data of the surface had to be flushed back to 3DS memory
+    bool cpu_readback = false;
+    /// Set once the texture got the size of a custom texture, it can't be reused by others then
+    bool custom_tex_storage = false;
+
+    /// Returns the size of the surface texture in bytes
+    std::size_t GetMemoryUsage() const {
+        if (type == SurfaceType::Fill) {
+            return 0;
+        }
+        return static_cast<std::size_t>(GetScaledWidth()) * GetScaledHeight() *
+               GetGLBytesPerPixel(pixel_format);
+    }
+
     static constexpr unsigned int GetGLBytesPerPixel(PixelFormat format) {
         // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
         return format == PixelFormat::Invalid
@@ -141,19 +188,25 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
                          : SurfaceParams::GetFormatBpp(format) / 8;
     }
 
-    std::vector<u8> gl_buffer;
+    /// Borrowed from the staging pool between a load and its upload, or a download and its flush
+    StagingBufferPool::Buffer gl_buffer;
 
     // Read/Write data in 3DS memory to/from gl_buffer
     void LoadGLBuffer(PAddr load_start, PAddr load_end);
     void FlushGLBuffer(PAddr flush_start, PAddr flush_end);
 
     // Custom texture loading and dumping
-    const Core::CustomTexInfo* LoadCustomTexture(u64 tex_hash, Common::Rectangle<u32>& custom_rect);
+    std::shared_ptr<const Core::CustomTexInfo> LoadCustomTexture(
+        u64 tex_hash, Common::Rectangle<u32>& custom_rect);
 
     // Upload/Download data in gl_buffer in/to this surface's texture
     void UploadGLTexture(const Common::Rectangle<u32>& rect);
     void DownloadGLTexture(const Common::Rectangle<u32>& rect);
 
+    // Start an asynchronous download into a pixel pack buffer. The rows are laid out with the
+    // surface stride, beginning at the bottom row of rect.
+    void DownloadGLTexture(const Common::Rectangle<u32>& rect, GLuint pack_buffer);
+
     void DumpToFile();
     GLuint GetTextureCopyHandle();
 
@@ -182,12 +235,26 @@ struct CachedSurface : SurfaceParams, std::enable_shared_from_this<CachedSurface
     }
 
 private:
+    void ReadGLTexture(const Common::Rectangle<u32>& rect, GLvoid* pixels);
+
     std::list<std::weak_ptr<SurfaceWatcher>> watchers;
 };
 
+/// The texture of a destroyed surface, waiting for a new surface of the same format and size
+struct RecycledSurfaceTexture {
+    OGLTexture texture;
+    u32 release_frame = 0;
+};
+
 struct CachedTextureCube {
     OGLTexture texture;
     u16 res_scale = 1;
+    /// Number of levels of the texture, more than one once a sampler used its mipmaps
+    u32 levels = 1;
+    /// Whether a face changed since the mipmaps were last generated
+    bool mipmaps_dirty = true;
+    std::size_t memory_usage = 0;
+    u32 last_used_frame = 0;
     std::shared_ptr<SurfaceWatcher> px;
     std::shared_ptr<SurfaceWatcher> nx;
     std::shared_ptr<SurfaceWatcher> py;
@@ -222,8 +289,13 @@ public:
     Surface GetTextureSurface(const Pica::TexturingRegs::FullTextureConfig& config);
     Surface GetTextureSurface(const Pica::Texture::TextureInfo& info, u32 max_level = 0);
 
-    /// Get a texture cube based on the texture configuration
-    const CachedTextureCube& GetTextureCube(const TextureCubeConfig& config);
+    /**
+     * Get a texture cube based on the texture configuration. Only the faces that changed since the
+     * last call are copied into it.
+     * @param use_mipmaps Whether the sampler reads the mipmaps, which are generated from the
+     *                    faces on demand
+     */
+    const CachedTextureCube& GetTextureCube(const TextureCubeConfig& config, bool use_mipmaps);
 
     /// Get the color and depth surfaces based on the framebuffer configuration
     SurfaceSurfaceRect_Tuple GetFramebufferSurfaces(bool using_color_fb, bool using_depth_fb,
@@ -232,11 +304,23 @@ public:
     /// Get a surface that matches the fill config
     Surface GetFillSurface(const GPU::Regs::MemoryFillConfig& config);
 
+    /**
+     * Clears the cached surface that covers exactly the region of the fill config, so that the fill
+     * doesn't need a fill surface.
+     * @returns The filled surface, nullptr if no surface covers the region
+     */
+    Surface FillCachedSurface(const GPU::Regs::MemoryFillConfig& config);
+
     /// Get a surface that matches a "texture copy" display transfer config
     SurfaceRect_Tuple GetTexCopySurface(const SurfaceParams& params);
 
+    /// Performs a Y2R conversion into the surface at dst_addr, false if it has to run on the CPU
+    bool ConvertY2R(const Service::Y2R::ConversionConfiguration& config,
+                    const std::vector<u8>& input, PAddr dst_addr);
+
     /// Write any cached resources overlapping the region back to memory (if dirty)
-    void FlushRegion(PAddr addr, u32 size, const Surface& flush_surface = nullptr);
+    void FlushRegion(PAddr addr, u32 size, const Surface& flush_surface = nullptr,
+                     bool track_readback = true);
 
     /// Mark region as being invalidated by region_owner (nullptr if 3DS memory)
     void InvalidateRegion(PAddr addr, u32 size, const Surface& region_owner);
@@ -244,13 +328,53 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    /**
+     * Looks up vertex data uploaded to the vertex stream buffer before
+     * @param offset Set to the stream buffer offset of the data if it was found
+     * @return true if the region was uploaded and hasn't been written since
+     */
+    bool GetCachedVertexArray(PAddr addr, u32 size, GLintptr& offset) const;
+
+    /// Remembers that the vertex data of the region was uploaded at the given stream buffer offset
+    void CacheVertexArray(PAddr addr, u32 size, GLintptr offset);
+
+    /// Forgets all uploaded vertex data, used when the stream buffer wraps around
+    void ClearVertexArrays();
+
     /// Handle any config changes
     void OnFrameUpdate();
 
     u16 GetScaleFactor() const;
 
+    /// Drops every surface and renders at the given scale, the scales of the other render target
+    /// classes are reloaded from the settings
     void SetScaleFactor(u16 scale);
 
+    /// Returns true if the settings ask for other render target scales than the current ones
+    bool TargetScalesChanged(u16 scale) const;
+
+    /**
+     * Renders at the given scale without dropping the surfaces. The render targets at the old
+     * scale are replaced on their next use by surfaces at the new one, validated by copies of
+     * them, and the old ones go once they are invalid or unused.
+     */
+    void RescaleTargets(u16 scale);
+
+    /// Returns true if the CPU has read back a color buffer at the address
+    bool IsReadbackTarget(PAddr color_addr) const {
+        return readback_targets.count(color_addr) != 0;
+    }
+
+    /// Starts recording the calls of the cache to a trace file, an empty path stops recording
+    void RecordTrace(const std::string& path);
+
+    /**
+     * Makes the calls of a trace file over the current guest memory, and logs the time spent in
+     * FindMatch, ValidateSurface and the Morton copies.
+     * @returns false if the trace couldn't be read
+     */
+    bool ReplayTrace(const std::string& path);
+
 private:
     void DuplicateSurface(const Surface& src_surface, const Surface& dest_surface);
 
@@ -269,6 +393,14 @@ private:
     bool ValidateByReinterpretation(const Surface& surface, SurfaceParams& params,
                                     const SurfaceInterval& interval);
 
+    // Copy the texture from another surface that was loaded from identical data, returns false
+    // if the surface has to be loaded from 3DS memory
+    bool ValidateByContentHash(const Surface& surface, const SurfaceParams& params);
+
+    // Decode the region from 3DS memory with the compute texture decoder, returns false if the
+    // surface has to be loaded on the CPU instead
+    bool ValidateByComputeDecode(const Surface& surface, const SurfaceParams& params);
+
     /// Create a new surface
     Surface CreateSurface(const SurfaceParams& params);
 
@@ -281,12 +413,74 @@ private:
     /// Increase/decrease the number of surface in pages touching the specified region
     void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
 
+    struct CachedVertexArray {
+        PAddr addr;
+        u32 size;
+        GLintptr offset;
+    };
+
+    /// Drops a cached vertex array and releases its pages
+    void UncacheVertexArray(CachedVertexArray& vertex_array);
+
+    /// Returns true if the surface holds GPU written data that was not flushed yet
+    bool IsSurfaceDirty(const Surface& surface) const;
+
+    /// Release least recently used clean surfaces and cubes until the memory budget is met
+    void EvictSurfaces();
+
+    /// Reloads the surfaces whose custom texture got decoded since they were uploaded
+    void UpdatePendingCustomTextures();
+
+    /// Start reading back the dirty regions of surfaces that the CPU is known to read
+    void QueueDownloads();
+
+    /// Start reading back a region of the surface into the next pixel pack buffer of the ring
+    void QueueDownload(const Surface& surface, const SurfaceInterval& interval);
+
+    /// Fill gl_buffer from a finished readback covering the interval, returns false if none does
+    bool CompleteDownload(const Surface& surface, const SurfaceInterval& interval);
+
+    struct PendingDownload {
+        std::weak_ptr<CachedSurface> surface;
+        SurfaceInterval interval;
+        Common::Rectangle<u32> rect;
+        u32 gpu_write_count = 0;
+        OGLBuffer buffer;
+        std::size_t buffer_size = 0;
+        GLsync fence = nullptr;
+    };
+    static constexpr std::size_t NUM_PENDING_DOWNLOADS = 8;
+    std::array<PendingDownload, NUM_PENDING_DOWNLOADS> pending_downloads;
+    std::size_t next_download = 0;
+
+    static constexpr std::size_t NUM_CACHED_VERTEX_ARRAYS = 32;
+    std::array<CachedVertexArray, NUM_CACHED_VERTEX_ARRAYS> cached_vertex_arrays{};
+    std::size_t next_vertex_array = 0;
+
     // clean surface cache
     constexpr static u32 CLEAN_FRAME_INTERVAL = 60 * 60;
     u32 last_clean_frame = 0;
 
     u16 resolution_scale_factor = 1;
 
+    /// Render targets with their own resolution scale, so that upscaling goes where it is seen
+    enum class TargetClass {
+        Framebuffer,
+        Depth,
+        Offscreen,
+        ReadBack,
+    };
+    using TargetScales = std::array<u16, 4>;
+
+    static TargetScales LoadTargetScales(u16 scale);
+
+    /// Returns the scale of the render target of the current framebuffer configuration
+    u16 GetTargetScale(bool using_color_fb) const;
+
+    TargetScales target_scales{1, 1, 1, 1};
+    /// Color buffers the CPU has read back, they keep the read back scale
+    std::unordered_set<PAddr> readback_targets;
+
     using PageMap = boost::icl::interval_map<u32, int>;
 
     SurfaceCache surface_cache;
@@ -295,6 +489,18 @@ private:
     SurfaceSet remove_surfaces;
 
     std::unordered_map<u64, CachedTextureCube> texture_cube_cache;
+    /// Textures of destroyed surfaces by format, size and scale, so that render targets that are
+    /// recreated every frame don't allocate new storage each time
+    std::unordered_multimap<u64, RecycledSurfaceTexture> surface_texture_cache;
+    /// Texture surfaces by the content hash of the guest data they were loaded from
+    std::unordered_map<u64, std::weak_ptr<CachedSurface>> texture_content_cache;
+    /// Bytes used by the textures of registered surfaces and cubes
+    std::size_t texture_memory = 0;
     std::unique_ptr<FormatReinterpreterOpenGL> format_reinterpreter;
+    std::unique_ptr<TextureDecoderOpenGL> texture_decoder;
+    std::unique_ptr<Y2RConverterOpenGL> y2r_converter;
+    /// Surfaces showing their original texture until the custom one is decoded
+    std::vector<std::weak_ptr<CachedSurface>> pending_custom_surfaces;
+    std::unique_ptr<SurfaceTraceRecorder> trace_recorder;
 };
 } // namespace OpenGL
@@ -197,6 +197,11 @@ private:
 
 class ShaderWriter {
 public:
+    ShaderWriter() {
+        // Programs are a few thousand lines long, start large enough for most of them
+        shader_source.reserve(64 * 1024);
+    }
+
     void AddLine(std::string_view text) {
         DEBUG_ASSERT(scope >= 0);
         if (!text.empty()) {
@@ -260,10 +265,11 @@ public:
                   const Pica::Shader::ProgramCode& program_code,
                   const Pica::Shader::SwizzleData& swizzle_data, u32 main_offset,
                   const RegGetter& inputreg_getter, const RegGetter& outputreg_getter,
-                  u8 sanitize_mul)
+                  u8 sanitize_mul, bool is_gs, const StaticUniforms* static_uniforms)
         : subroutines(subroutines), program_code(program_code), swizzle_data(swizzle_data),
           main_offset(main_offset), inputreg_getter(inputreg_getter),
-          outputreg_getter(outputreg_getter), sanitize_mul(sanitize_mul) {
+          outputreg_getter(outputreg_getter), sanitize_mul(sanitize_mul), is_gs(is_gs),
+          static_uniforms(static_uniforms) {
 
         Generate();
     }
@@ -356,6 +362,11 @@ private:
         return "uniforms.b[" + std::to_string(index) + "]";
     }
 
+    /// Returns the value of a bool uniform folded into the program
+    bool GetStaticBool(u32 index) const {
+        return (static_uniforms->bools >> index) & 1;
+    }
+
     /**
      * Adds code that calls a subroutine.
      * @param subroutine the subroutine to call.
@@ -428,7 +439,7 @@ private:
                 : instr.common.operand_desc_id;
         const SwizzlePattern swizzle = {swizzle_data[swizzle_offset]};
 
-        shader.AddLine("// " + std::to_string(offset) + ": " + instr.opcode.Value().GetInfo().name);
+        shader.AddLine(fmt::format("// {}: {}", offset, instr.opcode.Value().GetInfo().name));
 
         switch (instr.opcode.Value().GetInfo().type) {
         case OpCode::Type::Arithmetic: {
@@ -646,8 +657,16 @@ private:
                     condition = EvaluateCondition(instr.flow_control);
                 } else {
                     bool invert_test = instr.flow_control.num_instructions & 1;
-                    condition = (invert_test ? "!" : "") +
-                                GetUniformBool(instr.flow_control.bool_uniform_id);
+                    if (static_uniforms != nullptr) {
+                        // The jump is either always or never taken
+                        if (GetStaticBool(instr.flow_control.bool_uniform_id) == invert_test) {
+                            break;
+                        }
+                        condition = "true";
+                    } else {
+                        condition = (invert_test ? "!" : "") +
+                                    GetUniformBool(instr.flow_control.bool_uniform_id);
+                    }
                 }
 
                 shader.AddLine("if (" + condition + ") {");
@@ -667,7 +686,11 @@ private:
                 if (instr.opcode.Value() == OpCode::Id::CALLC) {
                     condition = EvaluateCondition(instr.flow_control);
                 } else if (instr.opcode.Value() == OpCode::Id::CALLU) {
-                    condition = GetUniformBool(instr.flow_control.bool_uniform_id);
+                    if (static_uniforms == nullptr) {
+                        condition = GetUniformBool(instr.flow_control.bool_uniform_id);
+                    } else if (!GetStaticBool(instr.flow_control.bool_uniform_id)) {
+                        break;
+                    }
                 }
 
                 shader.AddLine(condition.empty() ? "{" : "if (" + condition + ") {");
@@ -695,8 +718,11 @@ private:
             case OpCode::Id::IFC:
             case OpCode::Id::IFU: {
                 std::string condition;
+                std::optional<bool> static_condition;
                 if (instr.opcode.Value() == OpCode::Id::IFC) {
                     condition = EvaluateCondition(instr.flow_control);
+                } else if (static_uniforms != nullptr) {
+                    static_condition = GetStaticBool(instr.flow_control.bool_uniform_id);
                 } else {
                     condition = GetUniformBool(instr.flow_control.bool_uniform_id);
                 }
@@ -706,28 +732,43 @@ private:
                 const u32 endif_offset =
                     instr.flow_control.dest_offset + instr.flow_control.num_instructions;
 
-                shader.AddLine("if (" + condition + ") {");
-                ++shader.scope;
-
                 auto& if_sub = GetSubroutine(if_offset, else_offset);
-                CallSubroutine(if_sub);
+                const Subroutine* else_sub = nullptr;
                 offset = else_offset - 1;
-
                 if (instr.flow_control.num_instructions != 0) {
-                    --shader.scope;
-                    shader.AddLine("} else {");
-                    ++shader.scope;
-
-                    auto& else_sub = GetSubroutine(else_offset, endif_offset);
-                    CallSubroutine(else_sub);
+                    else_sub = &GetSubroutine(else_offset, endif_offset);
                     offset = endif_offset - 1;
 
                     if (if_sub.exit_method == ExitMethod::AlwaysEnd &&
-                        else_sub.exit_method == ExitMethod::AlwaysEnd) {
+                        else_sub->exit_method == ExitMethod::AlwaysEnd) {
                         offset = PROGRAM_END - 1;
                     }
                 }
 
+                if (static_condition) {
+                    // Only the branch taken is kept
+                    const Subroutine* taken_sub = *static_condition ? &if_sub : else_sub;
+                    if (taken_sub != nullptr) {
+                        shader.AddLine("{");
+                        ++shader.scope;
+                        CallSubroutine(*taken_sub);
+                        --shader.scope;
+                        shader.AddLine("}");
+                    }
+                    break;
+                }
+
+                shader.AddLine("if (" + condition + ") {");
+                ++shader.scope;
+                CallSubroutine(if_sub);
+
+                if (else_sub != nullptr) {
+                    --shader.scope;
+                    shader.AddLine("} else {");
+                    ++shader.scope;
+                    CallSubroutine(*else_sub);
+                }
+
                 --shader.scope;
                 shader.AddLine("}");
                 break;
@@ -736,13 +777,22 @@ private:
             case OpCode::Id::LOOP: {
                 std::string int_uniform =
                     "uniforms.i[" + std::to_string(instr.flow_control.int_uniform_id) + "]";
+                std::string count = int_uniform + ".x";
+                std::string init = "int(" + int_uniform + ".y)";
+                std::string step = "int(" + int_uniform + ".z)";
+                if (static_uniforms != nullptr) {
+                    // Constant bounds let the GLSL compiler unroll the loop
+                    const u32 value = static_uniforms->ints[instr.flow_control.int_uniform_id];
+                    count = std::to_string(value & 0xFF) + "u";
+                    init = std::to_string((value >> 8) & 0xFF);
+                    step = std::to_string((value >> 16) & 0xFF);
+                }
 
-                shader.AddLine("address_registers.z = int(" + int_uniform + ".y);");
+                shader.AddLine("address_registers.z = " + init + ";");
 
                 std::string loop_var = "loop" + std::to_string(offset);
-                shader.AddLine("for (uint " + loop_var + " = 0u; " + loop_var +
-                               " <= " + int_uniform + ".x; address_registers.z += int(" +
-                               int_uniform + ".z), ++" + loop_var + ") {");
+                shader.AddLine("for (uint " + loop_var + " = 0u; " + loop_var + " <= " + count +
+                               "; address_registers.z += " + step + ", ++" + loop_var + ") {");
                 ++shader.scope;
 
                 auto& loop_sub = GetSubroutine(offset + 1, instr.flow_control.dest_offset + 1);
@@ -760,8 +810,24 @@ private:
             }
 
             case OpCode::Id::EMIT:
+                if (!is_gs) {
+                    LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                    break;
+                }
+                shader.AddLine("emit();");
+                break;
+
             case OpCode::Id::SETEMIT:
-                LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                if (!is_gs) {
+                    LOG_ERROR(HW_GPU, "Geometry shader operation detected in vertex shader");
+                    break;
+                }
+                if (instr.setemit.vertex_id >= 3) {
+                    throw DecompileFail("Invalid emit vertex");
+                }
+                shader.AddLine(fmt::format("setemit({}u, {}, {});", instr.setemit.vertex_id.Value(),
+                                           instr.setemit.prim_emit != 0 ? "true" : "false",
+                                           instr.setemit.winding != 0 ? "true" : "false"));
                 break;
 
             default: {
@@ -907,6 +973,8 @@ private:
     const RegGetter& inputreg_getter;
     const RegGetter& outputreg_getter;
     const u8 sanitize_mul;
+    const bool is_gs;
+    const StaticUniforms* static_uniforms;
 
     ShaderWriter shader;
 };
@@ -927,12 +995,14 @@ bool exec_shader();
 std::optional<ProgramResult> DecompileProgram(const Pica::Shader::ProgramCode& program_code,
                                               const Pica::Shader::SwizzleData& swizzle_data,
                                               u32 main_offset, const RegGetter& inputreg_getter,
-                                              const RegGetter& outputreg_getter, u8 sanitize_mul) {
+                                              const RegGetter& outputreg_getter, u8 sanitize_mul,
+                                              bool is_gs, const StaticUniforms* static_uniforms) {
 
     try {
         auto subroutines = ControlFlowAnalyzer(program_code, main_offset).MoveSubroutines();
         GLSLGenerator generator(subroutines, program_code, swizzle_data, main_offset,
-                                inputreg_getter, outputreg_getter, sanitize_mul);
+                                inputreg_getter, outputreg_getter, sanitize_mul, is_gs,
+                                static_uniforms);
         return {ProgramResult{generator.MoveShaderCode()}};
     } catch (const DecompileFail& exception) {
         LOG_INFO(HW_GPU, "Shader decompilation failed: {}", exception.what());
@@ -19,11 +19,27 @@ struct ProgramResult {
     std::string code;
 };
 
+/// Bool and int uniforms a specialized program is compiled with instead of reading them
+struct StaticUniforms {
+    u16 bools;
+    // x | y << 8 | z << 16 of each int uniform
+    std::array<u32, 4> ints;
+};
+
 std::string GetCommonDeclarations();
 
+/**
+ * Translates a PICA shader program to GLSL
+ * @param is_gs translates EMIT and SETEMIT to calls of emit() and setemit(vertex_id, prim_emit,
+ *              winding), which the geometry shader source has to define
+ * @param static_uniforms folds these values into the branches and loops on bool and int uniforms,
+ *                        nullptr to read the uniforms
+ * @returns the GLSL code, std::nullopt if the program uses something that can't be translated
+ */
 std::optional<ProgramResult> DecompileProgram(const Pica::Shader::ProgramCode& program_code,
                                               const Pica::Shader::SwizzleData& swizzle_data,
                                               u32 main_offset, const RegGetter& inputreg_getter,
-                                              const RegGetter& outputreg_getter, u8 sanitize_mul);
+                                              const RegGetter& outputreg_getter, u8 sanitize_mul,
+                                              bool is_gs, const StaticUniforms* static_uniforms);
 
 } // namespace OpenGL::ShaderDecompiler
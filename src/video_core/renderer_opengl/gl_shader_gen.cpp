@@ -4,6 +4,7 @@
 
 #include <array>
 #include <cstddef>
+#include <iterator>
 #include <string_view>
 #include <fmt/format.h>
 #include "common/assert.h"
@@ -28,6 +29,10 @@ using Pica::LightingRegs;
 using Pica::RasterizerRegs;
 using Pica::TexturingRegs;
 using TevStageConfig = TexturingRegs::TevStageConfig;
+
+/// Initial capacity of the generated sources, most shaders fit in without growing the buffer
+constexpr std::size_t FRAGMENT_SHADER_RESERVE = 32 * 1024;
+constexpr std::size_t VERTEX_SHADER_RESERVE = 16 * 1024;
 using VSOutputAttributes = RasterizerRegs::VSOutputAttributes;
 
 namespace OpenGL {
@@ -73,6 +78,7 @@ layout (std140) uniform shader_data {
     float lut_scale_rb;
     float lut_scale_rg;
     float lut_scale_rr;
+    int shadow_pass;
     ivec4 lighting_lut_offset[NUM_LIGHTING_SAMPLERS / 4];
     vec3 fog_color;
     vec2 proctex_noise_f;
@@ -86,6 +92,66 @@ layout (std140) uniform shader_data {
 };
 )";
 
+constexpr std::string_view FragmentSamplerDefs = R"(
+uniform sampler2D tex0;
+uniform sampler2D tex1;
+uniform sampler2D tex2;
+uniform samplerCube tex_cube;
+uniform samplerBuffer texture_buffer_lut_lf;
+uniform samplerBuffer texture_buffer_lut_rg;
+uniform samplerBuffer texture_buffer_lut_rgba;
+)";
+
+constexpr std::string_view FragmentShaderHelpers = R"(
+// Rotate the vector v by the quaternion q
+vec3 quaternion_rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+float LookupLightingLUT(int lut_index, int index, float delta) {
+    vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
+    return entry.r + entry.g * delta;
+}
+
+float LookupLightingLUTUnsigned(int lut_index, float pos) {
+    int index = clamp(int(pos * 256.0), 0, 255);
+    float delta = pos * 256.0 - float(index);
+    return LookupLightingLUT(lut_index, index, delta);
+}
+
+float LookupLightingLUTSigned(int lut_index, float pos) {
+    int index = clamp(int(pos * 128.0), -128, 127);
+    float delta = pos * 128.0 - float(index);
+    if (index < 0) index += 256;
+    return LookupLightingLUT(lut_index, index, delta);
+}
+
+float byteround(float x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec2 byteround(vec2 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec3 byteround(vec3 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+vec4 byteround(vec4 x) {
+    return round(x * 255.0) * (1.0 / 255.0);
+}
+
+// PICA's LOD formula for 2D textures.
+// This LOD formula is the same as the LOD lower limit defined in OpenGL.
+// f(x, y) >= max{m_u, m_v, m_w}
+// (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
+float getLod(vec2 coord) {
+    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
+    return log2(max(d.x, d.y));
+}
+)";
+
 static bool s_use_fragment_color;
 static bool s_use_texcolor0;
 static bool s_use_texcolor1;
@@ -269,6 +335,8 @@ void PicaShaderConfigCommon::Init(const Pica::ShaderRegs& regs, Pica::Shader::Sh
     swizzle_hash = setup.GetSwizzleDataHash();
     main_offset = regs.main_offset;
     sanitize_mul = static_cast<u8>(Settings::values.shaders_accurate_mul);
+    specialized = 0;
+    bool_uniforms = 0;
 
     num_outputs = 0;
     output_map.fill(16);
@@ -276,6 +344,21 @@ void PicaShaderConfigCommon::Init(const Pica::ShaderRegs& regs, Pica::Shader::Sh
     for (int reg : Common::BitSet<u32>(regs.output_mask)) {
         output_map[reg] = num_outputs++;
     }
+
+    int_uniforms.fill(0);
+}
+
+void PicaShaderConfigCommon::Specialize(const Pica::ShaderRegs& regs,
+                                        const Pica::Shader::ShaderSetup& setup) {
+    specialized = 1;
+    bool_uniforms = 0;
+    for (u32 i = 0; i < setup.uniforms.b.size(); ++i) {
+        bool_uniforms |= static_cast<u16>(setup.uniforms.b[i]) << i;
+    }
+    for (u32 i = 0; i < int_uniforms.size(); ++i) {
+        const auto& value = regs.int_uniforms[i];
+        int_uniforms[i] = value.x.Value() | value.y.Value() << 8 | value.z.Value() << 16;
+    }
 }
 
 void PicaGSConfigCommonRaw::Init(const Pica::Regs& regs) {
@@ -302,6 +385,20 @@ void PicaGSConfigCommonRaw::Init(const Pica::Regs& regs) {
     }
 }
 
+void PicaGSConfigRaw::Init(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
+    shader.Init(regs.gs, setup);
+    common.Init(regs);
+    common.gs_output_attributes = shader.num_outputs;
+
+    num_inputs = regs.gs.max_input_attribute_index + 1;
+    input_map.fill(num_inputs);
+    for (u32 attr = 0; attr < num_inputs; ++attr) {
+        input_map[regs.gs.GetRegisterForAttribute(attr)] = attr;
+    }
+
+    attributes_per_vertex = regs.pipeline.vs_outmap_total_minus_1_a + 1;
+}
+
 /// Detects if a TEV stage is configured to be skipped (to avoid generating unnecessary code)
 static bool IsPassThroughTevStage(const TevStageConfig& stage) {
     return (stage.color_op == TevStageConfig::Operation::Replace &&
@@ -313,7 +410,7 @@ static bool IsPassThroughTevStage(const TevStageConfig& stage) {
             stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1);
 }
 
-static std::string SampleTexture(const PicaFSConfig& config, unsigned texture_unit) {
+static std::string_view SampleTexture(const PicaFSConfig& config, unsigned texture_unit) {
     const auto& state = config.state;
     switch (texture_unit) {
     case 0:
@@ -529,31 +626,32 @@ static void AppendColorCombiner(std::string& out, TevStageConfig::Operation oper
         out += results[0];
         break;
     case Operation::Modulate:
-        out += fmt::format("{} * {}", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} * {}", results[0], results[1]);
         break;
     case Operation::Add:
-        out += fmt::format("{} + {}", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} + {}", results[0], results[1]);
         break;
     case Operation::AddSigned:
-        out += fmt::format("{} + {} - vec3(0.5)", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} + {} - vec3(0.5)", results[0], results[1]);
         break;
     case Operation::Lerp:
-        out +=
-            fmt::format("{0} * {2} + {1} * (vec3(1.0) - {2})", results[0], results[1], results[2]);
+        fmt::format_to(std::back_inserter(out), "{0} * {2} + {1} * (vec3(1.0) - {2})", results[0],
+                       results[1], results[2]);
         break;
     case Operation::Subtract:
-        out += fmt::format("{} - {}", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} - {}", results[0], results[1]);
         break;
     case Operation::MultiplyThenAdd:
-        out += fmt::format("{} * {} + {}", results[0], results[1], results[2]);
+        fmt::format_to(std::back_inserter(out), "{} * {} + {}", results[0], results[1], results[2]);
         break;
     case Operation::AddThenMultiply:
-        out += fmt::format("min({} + {}, vec3(1.0)) * {}", results[0], results[1], results[2]);
+        fmt::format_to(std::back_inserter(out), "min({} + {}, vec3(1.0)) * {}", results[0],
+                       results[1], results[2]);
         break;
     case Operation::Dot3_RGB:
     case Operation::Dot3_RGBA:
-        out +=
-            fmt::format("vec3(dot({} - vec3(0.5), {} - vec3(0.5)) * 4.0)", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out),
+                       "vec3(dot({} - vec3(0.5), {} - vec3(0.5)) * 4.0)", results[0], results[1]);
         break;
     default:
         out += "vec3(0.0)";
@@ -574,25 +672,27 @@ static void AppendAlphaCombiner(std::string& out, TevStageConfig::Operation oper
         out += results[0];
         break;
     case Operation::Modulate:
-        out += fmt::format("{} * {}", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} * {}", results[0], results[1]);
         break;
     case Operation::Add:
-        out += fmt::format("{} + {}", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} + {}", results[0], results[1]);
         break;
     case Operation::AddSigned:
-        out += fmt::format("{} + {} - 0.5", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} + {} - 0.5", results[0], results[1]);
         break;
     case Operation::Lerp:
-        out += fmt::format("{0} * {2} + {1} * (1.0 - {2})", results[0], results[1], results[2]);
+        fmt::format_to(std::back_inserter(out), "{0} * {2} + {1} * (1.0 - {2})", results[0],
+                       results[1], results[2]);
         break;
     case Operation::Subtract:
-        out += fmt::format("{} - {}", results[0], results[1]);
+        fmt::format_to(std::back_inserter(out), "{} - {}", results[0], results[1]);
         break;
     case Operation::MultiplyThenAdd:
-        out += fmt::format("{} * {} + {}", results[0], results[1], results[2]);
+        fmt::format_to(std::back_inserter(out), "{} * {} + {}", results[0], results[1], results[2]);
         break;
     case Operation::AddThenMultiply:
-        out += fmt::format("min({} + {}, 1.0) * {}", results[0], results[1], results[2]);
+        fmt::format_to(std::back_inserter(out), "min({} + {}, 1.0) * {}", results[0], results[1],
+                       results[2]);
         break;
     default:
         out += "0.0";
@@ -621,7 +721,8 @@ static void AppendAlphaTestCondition(std::string& out, FramebufferRegs::CompareF
     case CompareFunc::GreaterThanOrEqual: {
         static constexpr std::array op{"!=", "==", ">=", ">", "<=", "<"};
         const auto index = static_cast<u32>(func) - static_cast<u32>(CompareFunc::Equal);
-        out += fmt::format("int(last_tex_env_out.a * 255.0) {} alphatest_ref", op[index]);
+        fmt::format_to(std::back_inserter(out), "int(last_tex_env_out.a * 255.0) {} alphatest_ref",
+                       op[index]);
         break;
     }
 
@@ -637,9 +738,18 @@ static void WriteTevStage(std::string& out, const PicaFSConfig& config, u32 inde
     const auto stage =
         static_cast<const TexturingRegs::TevStageConfig>(config.state.tev_stages[index]);
     if (!IsPassThroughTevStage(stage)) {
-        std::string index_name = std::to_string(index);
+        const std::string index_name = std::to_string(index);
+
+        // Kept across stages and shaders, so that the operands don't allocate again
+        thread_local std::array<std::string, 3> color_results;
+        thread_local std::array<std::string, 3> alpha_results;
+        for (auto& result : color_results) {
+            result.clear();
+        }
+        for (auto& result : alpha_results) {
+            result.clear();
+        }
 
-        std::array<std::string, 3> color_results;
         AppendColorModifier(color_results[0], config, stage.color_modifier1, stage.color_source1,
                             index_name);
         if (stage.color_op != TevStageConfig::Operation::Replace) {
@@ -650,15 +760,15 @@ static void WriteTevStage(std::string& out, const PicaFSConfig& config, u32 inde
         }
 
         // Round the output of each TEV stage to maintain the PICA's 8 bits of precision
-        out += "vec3 color_output_" + index_name + " = byteround(";
+        fmt::format_to(std::back_inserter(out), "vec3 color_output_{} = byteround(", index);
         AppendColorCombiner(out, stage.color_op, color_results);
         out += ");\n";
 
         if (stage.color_op == TevStageConfig::Operation::Dot3_RGBA) {
             // result of Dot3_RGBA operation is also placed to the alpha component
-            out += "float alpha_output_" + index_name + " = color_output_" + index_name + "[0];\n";
+            fmt::format_to(std::back_inserter(out),
+                           "float alpha_output_{0} = color_output_{0}[0];\n", index);
         } else {
-            std::array<std::string, 3> alpha_results;
             AppendAlphaModifier(alpha_results[0], config, stage.alpha_modifier1,
                                 stage.alpha_source1, index_name);
             if (stage.alpha_op != TevStageConfig::Operation::Replace) {
@@ -668,7 +778,7 @@ static void WriteTevStage(std::string& out, const PicaFSConfig& config, u32 inde
                                     stage.alpha_source3, index_name);
             }
 
-            out += "float alpha_output_" + index_name + " = byteround(";
+            fmt::format_to(std::back_inserter(out), "float alpha_output_{} = byteround(", index);
             AppendAlphaCombiner(out, stage.alpha_op, alpha_results);
             out += ");\n";
         }
@@ -676,13 +786,15 @@ static void WriteTevStage(std::string& out, const PicaFSConfig& config, u32 inde
         u32 color_scale = stage.GetColorMultiplier();
         u32 alpha_scale = stage.GetAlphaMultiplier();
         if (color_scale == 1 && alpha_scale == 1) {
-            out += "last_tex_env_out = clamp(vec4(color_output_" + index_name + ", alpha_output_" +
-                   index_name + "), vec4(0.0), vec4(1.0));\n";
+            fmt::format_to(std::back_inserter(out),
+                           "last_tex_env_out = clamp(vec4(color_output_{0}, alpha_output_{0}), "
+                           "vec4(0.0), vec4(1.0));\n",
+                           index);
         } else {
-            out += "last_tex_env_out = clamp(vec4(color_output_" + index_name + " * " +
-                   std::to_string(stage.GetColorMultiplier()) + ".0, alpha_output_" + index_name +
-                   " * " + std::to_string(stage.GetAlphaMultiplier()) +
-                   ".0), vec4(0.0), vec4(1.0));\n";
+            fmt::format_to(std::back_inserter(out),
+                           "last_tex_env_out = clamp(vec4(color_output_{0} * {1}.0, "
+                           "alpha_output_{0} * {2}.0), vec4(0.0), vec4(1.0));\n",
+                           index, color_scale, alpha_scale);
         }
     }
 
@@ -752,7 +864,7 @@ static void WriteLighting(std::string& out, const PicaFSConfig& config) {
            "vec3 tangent = quaternion_rotate(normalized_normquat, surface_tangent);\n";
 
     if (lighting.enable_shadow) {
-        std::string shadow_texture = SampleTexture(config, lighting.shadow_selector);
+        const std::string_view shadow_texture = SampleTexture(config, lighting.shadow_selector);
         if (lighting.shadow_invert) {
             out += fmt::format("vec4 shadow = vec4(1.0) - {};\n", shadow_texture);
         } else {
@@ -1294,6 +1406,30 @@ static void AppendProcLogicOp(std::string& out, FramebufferRegs::LogicOp logic_o
 }
 
 static void AppendShadowRendering(std::string& out, const PicaFSConfig& config) {
+    if (ShadowBlending) {
+        // The shadow map is bound to tex0 as RGBA8, put back together the value of the r32ui view
+        out += R"(
+ivec2 ShadowSize() {
+    return textureSize(tex0, 0);
+}
+
+uint LoadShadow(ivec2 uv) {
+    uvec4 texel = uvec4(texelFetch(tex0, uv, 0) * 255.0 + 0.5);
+    return texel.r | (texel.g << 8) | (texel.b << 16) | (texel.a << 24);
+}
+)";
+    } else {
+        out += R"(
+ivec2 ShadowSize() {
+    return imageSize(shadow_texture_px);
+}
+
+uint LoadShadow(ivec2 uv) {
+    return imageLoad(shadow_texture_px, uv).x;
+}
+)";
+    }
+
     out += R"(
 uvec2 DecodeShadow(uint pixel) {
     return uvec2(pixel >> 8, pixel & 255u);
@@ -1309,9 +1445,9 @@ float CompareShadow(uint pixel, uint z) {
 }
 
 float SampleShadow2D(ivec2 uv, uint z) {
-    if (any(bvec4( lessThan(uv, ivec2(0)), greaterThanEqual(uv, imageSize(shadow_texture_px)) )))
+    if (any(bvec4( lessThan(uv, ivec2(0)), greaterThanEqual(uv, ShadowSize()) )))
         return 1.0;
-    return CompareShadow(imageLoad(shadow_texture_px, uv).x, z);
+    return CompareShadow(LoadShadow(uv), z);
 }
 
 float mix2(vec4 s, vec2 a) {
@@ -1327,7 +1463,7 @@ vec4 shadowTexture(vec2 uv, float w) {
     out +=
             "uint z = uint(max(0, int(min(abs(w), 1.0) * (exp2(24.0) - 1.0)) - shadow_texture_bias));";
     out += R"(
-    vec2 coord = vec2(imageSize(shadow_texture_px)) * uv - vec2(0.5);
+    vec2 coord = vec2(ShadowSize()) * uv - vec2(0.5);
     vec2 coord_floor = floor(coord);
     vec2 f = coord - coord_floor;
     ivec2 i = ivec2(coord_floor);
@@ -1338,7 +1474,19 @@ vec4 shadowTexture(vec2 uv, float w) {
         SampleShadow2D(i + ivec2(1, 1), z));
     return vec4(mix2(s, f));
 }
+)";
+
+    if (ShadowBlending) {
+        // Only the texture units of the PICA are available, not one for each face
+        out += R"(
+vec4 shadowTextureCube(vec2 uv, float w) {
+    return vec4(1.0);
+}
+)";
+        return;
+    }
 
+    out += R"(
 vec4 shadowTextureCube(vec2 uv, float w) {
     ivec2 size = imageSize(shadow_texture_px);
     vec3 c = vec3(uv, w);
@@ -1426,7 +1574,10 @@ vec4 shadowTextureCube(vec2 uv, float w) {
 
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader) {
     const auto& state = config.state;
-    std::string out;
+    // Emission buffer reused across shaders, keeping its capacity. The result is copied out once.
+    thread_local std::string out;
+    out.clear();
+    out.reserve(FRAGMENT_SHADER_RESERVE);
     bool shadow_rendering = false;
     bool shader_logic_ops = false;
 
@@ -1472,17 +1623,9 @@ in vec4 gl_FragCoord;
         out += "out vec4 color;\n";
     }
 
-    out += R"(
-uniform sampler2D tex0;
-uniform sampler2D tex1;
-uniform sampler2D tex2;
-uniform samplerCube tex_cube;
-uniform samplerBuffer texture_buffer_lut_lf;
-uniform samplerBuffer texture_buffer_lut_rg;
-uniform samplerBuffer texture_buffer_lut_rgba;
-)";
+    out += FragmentSamplerDefs;
 
-    if (shadow_rendering) {
+    if (shadow_rendering && !ShadowBlending) {
         out += R"(
 layout(r32ui) uniform readonly uimage2D shadow_texture_px;
 layout(r32ui) uniform readonly uimage2D shadow_texture_nx;
@@ -1496,55 +1639,7 @@ layout(r32ui) uniform uimage2D shadow_buffer;
 
     out += UniformBlockDef;
 
-    out += R"(
-// Rotate the vector v by the quaternion q
-vec3 quaternion_rotate(vec4 q, vec3 v) {
-    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
-}
-
-float LookupLightingLUT(int lut_index, int index, float delta) {
-    vec2 entry = texelFetch(texture_buffer_lut_lf, lighting_lut_offset[lut_index >> 2][lut_index & 3] + index).rg;
-    return entry.r + entry.g * delta;
-}
-
-float LookupLightingLUTUnsigned(int lut_index, float pos) {
-    int index = clamp(int(pos * 256.0), 0, 255);
-    float delta = pos * 256.0 - float(index);
-    return LookupLightingLUT(lut_index, index, delta);
-}
-
-float LookupLightingLUTSigned(int lut_index, float pos) {
-    int index = clamp(int(pos * 128.0), -128, 127);
-    float delta = pos * 128.0 - float(index);
-    if (index < 0) index += 256;
-    return LookupLightingLUT(lut_index, index, delta);
-}
-
-float byteround(float x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec2 byteround(vec2 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec3 byteround(vec3 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-vec4 byteround(vec4 x) {
-    return round(x * 255.0) * (1.0 / 255.0);
-}
-
-// PICA's LOD formula for 2D textures.
-// This LOD formula is the same as the LOD lower limit defined in OpenGL.
-// f(x, y) >= max{m_u, m_v, m_w}
-// (See OpenGL 4.6 spec, 8.14.1 - Scale Factor and Level-of-Detail)
-float getLod(vec2 coord) {
-    vec2 d = max(abs(dFdx(coord)), abs(dFdy(coord)));
-    return log2(max(d.x, d.y));
-}
-)";
+    out += FragmentShaderHelpers;
 
     if (shadow_rendering) {
         AppendShadowRendering(out, config);
@@ -1610,11 +1705,13 @@ vec4 secondary_fragment_color = vec4(0.0);
     s_use_texcolor1 = false;
     s_use_texcolor2 = false;
 
-    std::string tev_stages;
+    thread_local std::string tev_stages;
+    tev_stages.clear();
     for (u32 index = 0; index < state.tev_stages.size(); ++index)
         WriteTevStage(tev_stages, config, index);
 
-    std::string lighting_codes;
+    thread_local std::string lighting_codes;
+    lighting_codes.clear();
     if (state.lighting.enable && s_use_fragment_color)
         WriteLighting(lighting_codes, config);
 
@@ -1670,7 +1767,23 @@ vec4 secondary_fragment_color = vec4(0.0);
         return out;
     }
 
-    if (shadow_rendering) {
+    if (shadow_rendering && ShadowBlending) {
+        // The depth test and the depth buffer take the place of the stored depth. Opaque fragments
+        // write the depth bytes in the first pass, the others lower the intensity through a min
+        // blend in the second one. The bias term can't read the stored depth, and takes it as d.
+        out += R"(
+uint d = uint(clamp(depth, 0.0, 1.0) * (exp2(24.0) - 1.0));
+uint s = uint(last_tex_env_out.g * 255.0);
+if ((s == 0u) != (shadow_pass == 0)) {
+    discard;
+}
+if (s != 0u) {
+    s = uint(float(s) / (shadow_bias_constant + shadow_bias_linear));
+}
+gl_FragDepth = float(d) / (exp2(24.0) - 1.0);
+color = vec4(float(min(s, 255u)) / 255.0, vec3(uvec3(d, d >> 8, d >> 16) & 255u) / 255.0);
+)";
+    } else if (shadow_rendering) {
         out += R"(
 uint d = uint(clamp(depth, 0.0, 1.0) * (exp2(24.0) - 1.0));
 uint s = uint(last_tex_env_out.g * 255.0);
@@ -1730,6 +1843,438 @@ do {
     return out;
 }
 
+constexpr std::string_view UberConfigDef = R"(
+layout (std140) uniform uber_config {
+    uvec4 tev_config[NUM_TEV_STAGES];
+    uint combiner_buffer_input;
+    uint alpha_test_func;
+    uint scissor_test_mode;
+    uint texture0_type;
+    uint texture2_use_coord1;
+    uint depthmap_enable;
+    uint fog_mode;
+    uint fog_flip;
+    uint lighting_enable;
+    uint lighting_src_num;
+    uint bump_mode;
+    uint bump_selector;
+    uint bump_renorm;
+    uint clamp_highlights;
+    uint lighting_config;
+    uint lighting_flags;
+    uint shadow_selector;
+    uint logic_op;
+    uvec4 light_config[NUM_LIGHTS];
+    uvec4 lut_config[7];
+};
+)";
+
+constexpr std::string_view UberShaderMain = R"(
+vec4 texcolor0 = vec4(0.0);
+vec4 texcolor1 = vec4(0.0);
+vec4 texcolor2 = vec4(0.0);
+vec4 rounded_primary_color = vec4(0.0);
+vec4 primary_fragment_color = vec4(0.0);
+vec4 secondary_fragment_color = vec4(0.0);
+vec4 combiner_buffer = vec4(0.0);
+vec4 last_tex_env_out = vec4(0.0);
+
+vec4 GetTexture(uint unit) {
+    if (unit == 0u) return texcolor0;
+    if (unit == 1u) return texcolor1;
+    if (unit == 2u) return texcolor2;
+    return vec4(0.0);
+}
+
+vec4 GetSource(uint source, int stage) {
+    switch (source) {
+    case 0u: return rounded_primary_color;
+    case 1u: return primary_fragment_color;
+    case 2u: return secondary_fragment_color;
+    case 3u: return texcolor0;
+    case 4u: return texcolor1;
+    case 5u: return texcolor2;
+    case 13u: return combiner_buffer;
+    case 14u: return const_color[stage];
+    case 15u: return last_tex_env_out;
+    }
+    return vec4(0.0);
+}
+
+vec3 ApplyColorModifier(uint modifier, vec4 v) {
+    switch (modifier) {
+    case 0u: return v.rgb;
+    case 1u: return vec3(1.0) - v.rgb;
+    case 2u: return v.aaa;
+    case 3u: return vec3(1.0) - v.aaa;
+    case 4u: return v.rrr;
+    case 5u: return vec3(1.0) - v.rrr;
+    case 8u: return v.ggg;
+    case 9u: return vec3(1.0) - v.ggg;
+    case 12u: return v.bbb;
+    case 13u: return vec3(1.0) - v.bbb;
+    }
+    return vec3(0.0);
+}
+
+float ApplyAlphaModifier(uint modifier, vec4 v) {
+    switch (modifier) {
+    case 0u: return v.a;
+    case 1u: return 1.0 - v.a;
+    case 2u: return v.r;
+    case 3u: return 1.0 - v.r;
+    case 4u: return v.g;
+    case 5u: return 1.0 - v.g;
+    case 6u: return v.b;
+    case 7u: return 1.0 - v.b;
+    }
+    return 0.0;
+}
+
+vec3 CombineColor(uint op, vec3 a, vec3 b, vec3 c) {
+    vec3 result = vec3(0.0);
+    switch (op) {
+    case 0u: result = a; break;
+    case 1u: result = a * b; break;
+    case 2u: result = a + b; break;
+    case 3u: result = a + b - vec3(0.5); break;
+    case 4u: result = a * c + b * (vec3(1.0) - c); break;
+    case 5u: result = a - b; break;
+    case 6u:
+    case 7u: result = vec3(dot(a - vec3(0.5), b - vec3(0.5)) * 4.0); break;
+    case 8u: result = a * b + c; break;
+    case 9u: result = min(a + b, vec3(1.0)) * c; break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float CombineAlpha(uint op, float a, float b, float c) {
+    float result = 0.0;
+    switch (op) {
+    case 0u: result = a; break;
+    case 1u: result = a * b; break;
+    case 2u: result = a + b; break;
+    case 3u: result = a + b - 0.5; break;
+    case 4u: result = a * c + b * (1.0 - c); break;
+    case 5u: result = a - b; break;
+    case 8u: result = a * b + c; break;
+    case 9u: result = min(a + b, 1.0) * c; break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+bool AlphaTestFails(int alpha) {
+    switch (alpha_test_func) {
+    case 0u: return true;
+    case 2u: return alpha != alphatest_ref;
+    case 3u: return alpha == alphatest_ref;
+    case 4u: return alpha >= alphatest_ref;
+    case 5u: return alpha > alphatest_ref;
+    case 6u: return alpha <= alphatest_ref;
+    case 7u: return alpha < alphatest_ref;
+    }
+    return false;
+}
+
+float LookupLightingSampler(uint lut, int sampler, bool two_sided, vec3 normal, vec3 tangent,
+                            vec3 light_vector, vec3 spot_dir, vec3 half_vector) {
+    float index = 0.0;
+    switch (lut_config[lut].z) {
+    case 0u: index = dot(normal, normalize(half_vector)); break;
+    case 1u: index = dot(normalize(view), normalize(half_vector)); break;
+    case 2u: index = dot(normal, normalize(view)); break;
+    case 3u: index = dot(light_vector, normal); break;
+    case 4u: index = dot(light_vector, spot_dir); break;
+    case 5u:
+        // CP input is only available with configuration 7
+        if (lighting_config == 8u) {
+            vec3 half_angle = normalize(half_vector);
+            index = dot(half_angle - normal * dot(normal, half_angle), tangent);
+        }
+        break;
+    }
+    if (lut_config[lut].y != 0u) {
+        index = two_sided ? abs(index) : max(index, 0.0);
+        return LookupLightingLUTUnsigned(sampler, index);
+    }
+    return LookupLightingLUTSigned(sampler, index);
+}
+
+void ComputeLighting() {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    vec3 surface_tangent = vec3(1.0, 0.0, 0.0);
+    if (bump_mode == 1u) {
+        surface_normal = 2.0 * GetTexture(bump_selector).rgb - 1.0;
+        if (bump_renorm != 0u) {
+            surface_normal.z = sqrt(max(1.0 - (surface_normal.x * surface_normal.x +
+                                               surface_normal.y * surface_normal.y), 0.0));
+        }
+    } else if (bump_mode == 2u) {
+        surface_tangent = 2.0 * GetTexture(bump_selector).rgb - 1.0;
+    }
+
+    vec4 normalized_normquat = normalize(normquat);
+    vec3 normal = quaternion_rotate(normalized_normquat, surface_normal);
+    vec3 tangent = quaternion_rotate(normalized_normquat, surface_tangent);
+
+    vec4 shadow = vec4(1.0);
+    if ((lighting_flags & 4u) != 0u) {
+        shadow = GetTexture(shadow_selector);
+        if ((lighting_flags & 32u) != 0u) {
+            shadow = vec4(1.0) - shadow;
+        }
+    }
+
+    for (uint i = 0u; i < lighting_src_num; ++i) {
+        int num = int(light_config[i].x);
+        uint flags = light_config[i].y;
+        bool two_sided = (flags & 2u) != 0u;
+
+        vec3 light_vector = (flags & 1u) != 0u ? normalize(light_src[num].position)
+                                               : normalize(light_src[num].position + view);
+        vec3 spot_dir = light_src[num].spot_direction;
+        vec3 half_vector = normalize(view) + light_vector;
+        float dot_product = two_sided ? abs(dot(light_vector, normal))
+                                      : max(dot(light_vector, normal), 0.0);
+        float clamp_factor = clamp_highlights != 0u ? sign(dot_product) : 1.0;
+
+        float spot_atten = 1.0;
+        if ((flags & 8u) != 0u && lut_config[2].x != 0u) {
+            spot_atten = lut_scale_sp * LookupLightingSampler(2u, 8 + num, two_sided, normal,
+                                                              tangent, light_vector, spot_dir,
+                                                              half_vector);
+        }
+
+        float dist_atten = 1.0;
+        if ((flags & 4u) != 0u) {
+            float index = clamp(light_src[num].dist_atten_scale *
+                                length(-view - light_src[num].position) +
+                                light_src[num].dist_atten_bias, 0.0, 1.0);
+            dist_atten = LookupLightingLUTUnsigned(16 + num, index);
+        }
+
+        float geo_factor = 1.0;
+        if ((flags & 48u) != 0u) {
+            geo_factor = dot(half_vector, half_vector);
+            geo_factor = geo_factor == 0.0 ? 0.0 : min(dot_product / geo_factor, 1.0);
+        }
+
+        vec3 specular_0 = light_src[num].specular_0;
+        if (lut_config[0].x != 0u) {
+            specular_0 *= lut_scale_d0 * LookupLightingSampler(0u, 0, two_sided, normal, tangent,
+                                                               light_vector, spot_dir,
+                                                               half_vector);
+        }
+        if ((flags & 16u) != 0u) {
+            specular_0 *= geo_factor;
+        }
+
+        vec3 refl_value = vec3(1.0);
+        if (lut_config[4].x != 0u) {
+            refl_value.r = lut_scale_rr * LookupLightingSampler(4u, 6, two_sided, normal, tangent,
+                                                                light_vector, spot_dir,
+                                                                half_vector);
+        }
+        refl_value.g = refl_value.r;
+        if (lut_config[5].x != 0u) {
+            refl_value.g = lut_scale_rg * LookupLightingSampler(5u, 5, two_sided, normal, tangent,
+                                                                light_vector, spot_dir,
+                                                                half_vector);
+        }
+        refl_value.b = refl_value.r;
+        if (lut_config[6].x != 0u) {
+            refl_value.b = lut_scale_rb * LookupLightingSampler(6u, 4, two_sided, normal, tangent,
+                                                                light_vector, spot_dir,
+                                                                half_vector);
+        }
+
+        vec3 specular_1 = refl_value * light_src[num].specular_1;
+        if (lut_config[1].x != 0u) {
+            specular_1 *= lut_scale_d1 * LookupLightingSampler(1u, 1, two_sided, normal, tangent,
+                                                               light_vector, spot_dir,
+                                                               half_vector);
+        }
+        if ((flags & 32u) != 0u) {
+            specular_1 *= geo_factor;
+        }
+
+        // Only the last entry in the light slots applies the Fresnel factor
+        if (i == lighting_src_num - 1u && lut_config[3].x != 0u) {
+            float fresnel = lut_scale_fr * LookupLightingSampler(3u, 3, two_sided, normal,
+                                                                 tangent, light_vector, spot_dir,
+                                                                 half_vector);
+            if ((lighting_flags & 1u) != 0u) {
+                diffuse_sum.a = fresnel;
+            }
+            if ((lighting_flags & 2u) != 0u) {
+                specular_sum.a = fresnel;
+            }
+        }
+
+        bool light_shadow = (flags & 64u) != 0u;
+        vec3 shadow_primary = (light_shadow && (lighting_flags & 8u) != 0u) ? shadow.rgb
+                                                                             : vec3(1.0);
+        vec3 shadow_secondary = (light_shadow && (lighting_flags & 16u) != 0u) ? shadow.rgb
+                                                                               : vec3(1.0);
+
+        diffuse_sum.rgb += ((light_src[num].diffuse * dot_product) + light_src[num].ambient) *
+                           dist_atten * spot_atten * shadow_primary;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_factor * dist_atten * spot_atten *
+                            shadow_secondary;
+    }
+
+    if ((lighting_flags & 64u) != 0u) {
+        if ((lighting_flags & 1u) != 0u) {
+            diffuse_sum.a *= shadow.a;
+        }
+        if ((lighting_flags & 2u) != 0u) {
+            specular_sum.a *= shadow.a;
+        }
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+void main() {
+    if (alpha_test_func == 0u) {
+        discard;
+    }
+
+    if (scissor_test_mode != 0u) {
+        bool inside = gl_FragCoord.x >= float(scissor_x1) && gl_FragCoord.y >= float(scissor_y1) &&
+                      gl_FragCoord.x < float(scissor_x2) && gl_FragCoord.y < float(scissor_y2);
+        if (inside == (scissor_test_mode == 1u)) {
+            discard;
+        }
+    }
+
+    float z_over_w = 2.0 * gl_FragCoord.z - 1.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (depthmap_enable == 0u) {
+        depth /= gl_FragCoord.w;
+    }
+
+    rounded_primary_color = byteround(primary_color);
+
+    if (texture0_type == 0u) {
+        texcolor0 = textureLod(tex0, texcoord0, getLod(texcoord0 * vec2(textureSize(tex0, 0))));
+    } else if (texture0_type == 1u) {
+        texcolor0 = texture(tex_cube, vec3(texcoord0, texcoord0_w));
+    } else if (texture0_type == 3u) {
+        texcolor0 = textureProj(tex0, vec3(texcoord0, texcoord0_w));
+    } else if (texture0_type != 5u) {
+        texcolor0 = vec4(1.0);
+    }
+    texcolor1 = textureLod(tex1, texcoord1, getLod(texcoord1 * vec2(textureSize(tex1, 0))));
+    if (texture2_use_coord1 != 0u) {
+        texcolor2 = textureLod(tex2, texcoord1, getLod(texcoord1 * vec2(textureSize(tex2, 0))));
+    } else {
+        texcolor2 = textureLod(tex2, texcoord2, getLod(texcoord2 * vec2(textureSize(tex2, 0))));
+    }
+
+    if (lighting_enable != 0u) {
+        ComputeLighting();
+    }
+
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    for (int i = 0; i < NUM_TEV_STAGES; ++i) {
+        uvec4 stage = tev_config[i];
+        uint color_op = stage.z & 0xFu;
+        uint alpha_op = (stage.z >> 16) & 0xFu;
+
+        vec3 color_a = ApplyColorModifier(stage.y & 0xFu, GetSource(stage.x & 0xFu, i));
+        vec3 color_b = ApplyColorModifier((stage.y >> 4) & 0xFu, GetSource((stage.x >> 4) & 0xFu, i));
+        vec3 color_c = ApplyColorModifier((stage.y >> 8) & 0xFu, GetSource((stage.x >> 8) & 0xFu, i));
+        vec3 color_output = byteround(CombineColor(color_op, color_a, color_b, color_c));
+
+        float alpha_output;
+        if (color_op == 7u) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output.r;
+        } else {
+            float alpha_a = ApplyAlphaModifier((stage.y >> 12) & 0x7u, GetSource((stage.x >> 16) & 0xFu, i));
+            float alpha_b = ApplyAlphaModifier((stage.y >> 16) & 0x7u, GetSource((stage.x >> 20) & 0xFu, i));
+            float alpha_c = ApplyAlphaModifier((stage.y >> 20) & 0x7u, GetSource((stage.x >> 24) & 0xFu, i));
+            alpha_output = byteround(CombineAlpha(alpha_op, alpha_a, alpha_b, alpha_c));
+        }
+
+        uint color_scale = stage.w & 0x3u;
+        uint alpha_scale = (stage.w >> 16) & 0x3u;
+        float color_multiplier = color_scale < 3u ? float(1u << color_scale) : 1.0;
+        float alpha_multiplier = alpha_scale < 3u ? float(1u << alpha_scale) : 1.0;
+        last_tex_env_out = clamp(vec4(color_output * color_multiplier,
+                                      alpha_output * alpha_multiplier), vec4(0.0), vec4(1.0));
+
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4) {
+            if (((combiner_buffer_input >> uint(i)) & 1u) != 0u) {
+                next_combiner_buffer.rgb = last_tex_env_out.rgb;
+            }
+            if (((combiner_buffer_input >> uint(i + 4)) & 1u) != 0u) {
+                next_combiner_buffer.a = last_tex_env_out.a;
+            }
+        }
+    }
+
+    if (AlphaTestFails(int(last_tex_env_out.a * 255.0))) {
+        discard;
+    }
+
+    if (fog_mode == 5u) {
+        float fog_index = (fog_flip != 0u ? (1.0 - depth) : depth) * 128.0;
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        vec2 fog_lut_entry = texelFetch(texture_buffer_lut_lf, int(fog_i) + fog_lut_offset).rg;
+        float fog_factor = clamp(fog_lut_entry.r + fog_lut_entry.g * fog_f, 0.0, 1.0);
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    } else if (fog_mode == 7u) {
+        color = vec4(0.0);
+        return;
+    }
+
+    gl_FragDepth = depth;
+    color = byteround(last_tex_env_out);
+    if (logic_op == 0u) {
+        color = vec4(0.0);
+    } else if (logic_op == 4u) {
+        color = vec4(1.0);
+    } else if (logic_op == 5u) {
+        color = vec4(1.0) - color;
+    }
+}
+)";
+
+std::string GenerateFragmentUberShader(bool separable_shader) {
+    std::string out;
+    if (separable_shader) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n";
+    }
+    if (GLES) {
+        out += fragment_shader_precision_OES;
+    }
+
+    out += GetVertexInterfaceDeclaration(false, separable_shader);
+    out += R"(
+#ifndef CITRA_GLES
+in vec4 gl_FragCoord;
+#endif // CITRA_GLES
+
+out vec4 color;
+)";
+
+    out += FragmentSamplerDefs;
+    out += UniformBlockDef;
+    out += UberConfigDef;
+    out += FragmentShaderHelpers;
+    out += UberShaderMain;
+    return out;
+}
+
 std::string GenerateTrivialVertexShader(bool separable_shader) {
     std::string out;
     if (separable_shader) {
@@ -1781,6 +2326,7 @@ void main() {
 std::string GenerateVertexShader(const Pica::Shader::ShaderSetup& setup, const PicaVSConfig& config,
                                  bool separable_shader) {
     std::string out;
+    out.reserve(VERTEX_SHADER_RESERVE);
     if (separable_shader) {
         out += "#extension GL_ARB_separate_shader_objects : enable\n";
     }
@@ -1802,9 +2348,13 @@ std::string GenerateVertexShader(const Pica::Shader::ShaderSetup& setup, const P
         return "";
     };
 
+    const ShaderDecompiler::StaticUniforms static_uniforms{config.state.bool_uniforms,
+                                                           config.state.int_uniforms};
+
     auto program_source_opt = ShaderDecompiler::DecompileProgram(
         setup.program_code, setup.swizzle_data, config.state.main_offset, get_input_reg,
-        get_output_reg, config.state.sanitize_mul);
+        get_output_reg, config.state.sanitize_mul, false,
+        config.state.specialized ? &static_uniforms : nullptr);
 
     if (!program_source_opt)
         return {};
@@ -1821,20 +2371,24 @@ layout (std140) uniform vs_config {
     // input attributes declaration
     for (std::size_t i = 0; i < used_regs.size(); ++i) {
         if (used_regs[i]) {
-            out += fmt::format("layout(location = {0}) in vec4 vs_in_reg{0};\n", i);
+            fmt::format_to(std::back_inserter(out),
+                           "layout(location = {0}) in vec4 vs_in_reg{0};\n", i);
         }
     }
     out += '\n';
 
     // output attributes declaration
     for (u32 i = 0; i < config.state.num_outputs; ++i) {
-        out += (separable_shader ? "layout(location = " + std::to_string(i) + ")" : std::string{}) +
-               " out vec4 vs_out_attr" + std::to_string(i) + ";\n";
+        if (separable_shader) {
+            fmt::format_to(std::back_inserter(out), "layout(location = {})", i);
+        }
+        fmt::format_to(std::back_inserter(out), " out vec4 vs_out_attr{};\n", i);
     }
 
     out += "\nvoid main() {\n";
     for (u32 i = 0; i < config.state.num_outputs; ++i) {
-        out += fmt::format("    vs_out_attr{} = vec4(0.0, 0.0, 0.0, 1.0);\n", i);
+        fmt::format_to(std::back_inserter(out), "    vs_out_attr{} = vec4(0.0, 0.0, 0.0, 1.0);\n",
+                       i);
     }
     out += "\n    exec_shader();\n}\n\n";
 
@@ -1958,4 +2512,115 @@ void main() {
 
     return out;
 }
+
+std::string GenerateGeometryShader(const Pica::Shader::ShaderSetup& setup, const PicaGSConfig& config,
+                                   bool separable_shader) {
+    const auto& state = config.state;
+    if (state.shader.num_outputs == 0 || state.num_inputs % state.attributes_per_vertex != 0) {
+        return {};
+    }
+
+    // The vertices of an invocation arrive as one GL primitive, see GetCurrentPrimitiveMode
+    std::string_view input_layout;
+    switch (state.num_inputs / state.attributes_per_vertex) {
+    case 1:
+        input_layout = "points";
+        break;
+    case 2:
+        input_layout = "lines";
+        break;
+    case 3:
+        input_layout = "triangles";
+        break;
+    case 4:
+        input_layout = "lines_adjacency";
+        break;
+    case 6:
+        input_layout = "triangles_adjacency";
+        break;
+    default:
+        return {};
+    }
+
+    const auto get_input_reg = [&state](u32 reg) -> std::string {
+        ASSERT(reg < 16);
+        const u32 attr = state.input_map[reg];
+        const u32 vs_attr = attr % state.attributes_per_vertex;
+        if (attr < state.num_inputs && vs_attr < state.common.vs_output_attributes) {
+            return fmt::format("vs_out_attr{}[{}]", vs_attr, attr / state.attributes_per_vertex);
+        }
+        return "vec4(0.0, 0.0, 0.0, 1.0)";
+    };
+
+    const auto get_output_reg = [&state](u32 reg) -> std::string {
+        ASSERT(reg < 16);
+        if (state.shader.output_map[reg] < state.shader.num_outputs) {
+            return fmt::format("output_buffer.attributes[{}]", state.shader.output_map[reg]);
+        }
+        return "";
+    };
+
+    auto program_source_opt = ShaderDecompiler::DecompileProgram(
+        setup.program_code, setup.swizzle_data, state.shader.main_offset, get_input_reg,
+        get_output_reg, state.shader.sanitize_mul, true, nullptr);
+
+    if (!program_source_opt)
+        return {};
+
+    std::string out;
+    out.reserve(VERTEX_SHADER_RESERVE);
+    if (separable_shader) {
+        out += "#extension GL_ARB_separate_shader_objects : enable\n\n";
+    }
+
+    // Vertices emitted past max_vertices are dropped. 30 vertices stay within the minimum of
+    // GL_MAX_GEOMETRY_TOTAL_OUTPUT_COMPONENTS for our outputs.
+    fmt::format_to(std::back_inserter(out), "layout({}) in;\n", input_layout);
+    out += "layout(triangle_strip, max_vertices = 30) out;\n\n";
+
+    out += ShaderDecompiler::GetCommonDeclarations();
+    out += GetGSCommonSource(state.common, separable_shader);
+
+    out += R"(
+Vertex output_buffer;
+Vertex prim_buffer[3];
+uint vertex_id = 0u;
+bool prim_emit = false;
+bool winding = false;
+
+#define uniforms gs_uniforms
+layout (std140) uniform gs_config {
+    pica_uniforms uniforms;
+};
+
+void setemit(uint vertex_id_, bool prim_emit_, bool winding_) {
+    vertex_id = vertex_id_;
+    prim_emit = prim_emit_;
+    winding = winding_;
+}
+
+// Mirrors GSEmitter::Emit, a winding primitive is sent like the primitive assembler reorders it
+void emit() {
+    prim_buffer[vertex_id] = output_buffer;
+    if (prim_emit) {
+        if (winding) {
+            EmitPrim(prim_buffer[1], prim_buffer[0], prim_buffer[2]);
+        } else {
+            EmitPrim(prim_buffer[0], prim_buffer[1], prim_buffer[2]);
+        }
+    }
+}
+
+void main() {
+)";
+    for (u32 i = 0; i < state.shader.num_outputs; ++i) {
+        fmt::format_to(std::back_inserter(out),
+                       "    output_buffer.attributes[{}] = vec4(0.0, 0.0, 0.0, 1.0);\n", i);
+    }
+    out += "\n    exec_shader();\n}\n\n";
+
+    out += program_source_opt->code;
+
+    return out;
+}
 } // namespace OpenGL
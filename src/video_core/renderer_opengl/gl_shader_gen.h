@@ -146,15 +146,23 @@ struct PicaFSConfig {
 struct PicaShaderConfigCommon {
     void Init(const Pica::ShaderRegs& regs, Pica::Shader::ShaderSetup& setup);
 
+    /// Folds the current bool and int uniforms into the program
+    void Specialize(const Pica::ShaderRegs& regs, const Pica::Shader::ShaderSetup& setup);
+
     u64 program_hash;
     u64 swizzle_hash;
     u32 main_offset;
     u8 sanitize_mul;
+    u8 specialized;
+    u16 bool_uniforms;
 
     u32 num_outputs;
 
     // output_map[output register index] -> output attribute index
     std::array<u32, 16> output_map;
+
+    // x, y and z of the int uniforms, only set when specialized
+    std::array<u32, 4> int_uniforms;
 };
 
 /**
@@ -162,7 +170,7 @@ struct PicaShaderConfigCommon {
  * shader.
  */
 struct PicaVSConfig {
-    PicaVSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
+    PicaVSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) : state{} {
         state.Init(regs.vs, setup);
     }
     PicaShaderConfigCommon state;
@@ -194,6 +202,32 @@ struct PicaFixedGSConfig {
     PicaGSConfigCommonRaw state;
 };
 
+/**
+ * This struct contains information to identify a GL geometry shader generated from PICA geometry
+ * shader.
+ */
+struct PicaGSConfigRaw {
+    void Init(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup);
+
+    PicaShaderConfigCommon shader;
+    PicaGSConfigCommonRaw common;
+
+    u32 num_inputs;
+    // Attributes the vertex shader outputs for each vertex, the inputs of an invocation are
+    // gathered from num_inputs / attributes_per_vertex vertices
+    u32 attributes_per_vertex;
+
+    // input_map[input register index] -> input attribute index
+    std::array<u32, 16> input_map;
+};
+
+struct PicaGSConfig {
+    PicaGSConfig(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) : state{} {
+        state.Init(regs, setup);
+    }
+    PicaGSConfigRaw state;
+};
+
 /**
  * Generates the GLSL vertex shader program source code that accepts vertices from software shader
  * and directly passes them to the fragment shader.
@@ -215,6 +249,15 @@ std::string GenerateVertexShader(const Pica::Shader::ShaderSetup& setup, const P
  */
 std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config, bool separable_shader);
 
+/**
+ * Generates the GLSL geometry shader program source code for the given GS program, which runs in
+ * the point mode of the geometry pipeline
+ * @returns String of the shader source code; empty if the program or the input layout can't be
+ *          translated, the draw then has to run on the CPU
+ */
+std::string GenerateGeometryShader(const Pica::Shader::ShaderSetup& setup, const PicaGSConfig& config,
+                                   bool separable_shader);
+
 /**
  * Generates the GLSL fragment shader program source code for the current Pica state
  * @param config ShaderCacheKey object generated for the current Pica state, used for the shader
@@ -224,4 +267,14 @@ std::string GenerateFixedGeometryShader(const PicaFixedGSConfig& config, bool se
  */
 std::string GenerateFragmentShader(const PicaFSConfig& config, bool separable_shader);
 
+/**
+ * Generates a GLSL fragment shader that emulates any Pica fragment pipeline configuration by
+ * reading the TEV, lighting and fog setup from the uber_config uniform block. It is used in place
+ * of the specialized shader from GenerateFragmentShader while the latter is being compiled.
+ * Procedural textures and shadow rendering are not supported.
+ * @param separable_shader generates shader that can be used for separate shader object
+ * @returns String of the shader source code
+ */
+std::string GenerateFragmentUberShader(bool separable_shader);
+
 } // namespace OpenGL
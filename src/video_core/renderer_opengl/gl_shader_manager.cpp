@@ -3,10 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include "core/cache_file.h"
 #include "core/settings.h"
 #include "video_core/renderer_opengl/gl_shader_manager.h"
+#include "video_core/renderer_opengl/gl_shader_store.h"
+#include "video_core/renderer_opengl/gl_shader_worker.h"
 #include "video_core/renderer_opengl/on_screen_display.h"
 
 namespace OpenGL {
@@ -28,6 +33,9 @@ static void SetShaderUniformBlockBindings(GLuint shader) {
     SetShaderUniformBlockBinding(shader, "shader_data", UniformBindings::Common,
                                  sizeof(UniformData));
     SetShaderUniformBlockBinding(shader, "vs_config", UniformBindings::VS, sizeof(VSUniformData));
+    SetShaderUniformBlockBinding(shader, "gs_config", UniformBindings::GS, sizeof(GSUniformData));
+    SetShaderUniformBlockBinding(shader, "uber_config", UniformBindings::Uber,
+                                 sizeof(UberUniformData));
 }
 
 static void SetShaderSamplerBinding(GLuint shader, const char* name,
@@ -85,6 +93,69 @@ void PicaUniformsData::SetFromRegs(const Pica::ShaderRegs& regs,
                    });
 }
 
+void UberUniformData::SetFromConfig(const PicaFSConfig& config) {
+    const auto& state = config.state;
+    std::transform(state.tev_stages.begin(), state.tev_stages.end(), tev_config.begin(),
+                   [](const TevStageConfigRaw& stage) -> GLuvec4 {
+                       return {stage.sources_raw, stage.modifiers_raw, stage.ops_raw,
+                               stage.scales_raw};
+                   });
+    combiner_buffer_input = state.combiner_buffer_input;
+    alpha_test_func = static_cast<GLuint>(state.alpha_test_func);
+    scissor_test_mode = static_cast<GLuint>(state.scissor_test_mode);
+    texture0_type = static_cast<GLuint>(state.texture0_type);
+    texture2_use_coord1 = state.texture2_use_coord1;
+    depthmap_enable = static_cast<GLuint>(state.depthmap_enable);
+    fog_mode = static_cast<GLuint>(state.fog_mode);
+    fog_flip = state.fog_flip;
+
+    const auto& lighting = state.lighting;
+    lighting_enable = lighting.enable;
+    lighting_src_num = lighting.src_num;
+    bump_mode = static_cast<GLuint>(lighting.bump_mode);
+    bump_selector = lighting.bump_selector;
+    bump_renorm = lighting.bump_renorm;
+    clamp_highlights = lighting.clamp_highlights;
+    lighting_config = static_cast<GLuint>(lighting.config);
+    lighting_flags = lighting.enable_primary_alpha | lighting.enable_secondary_alpha << 1 |
+                     lighting.enable_shadow << 2 | lighting.shadow_primary << 3 |
+                     lighting.shadow_secondary << 4 | lighting.shadow_invert << 5 |
+                     lighting.shadow_alpha << 6;
+    shadow_selector = lighting.shadow_selector;
+
+    for (std::size_t i = 0; i < light_config.size(); ++i) {
+        const auto& light = lighting.light[i];
+        const GLuint flags = light.directional | light.two_sided_diffuse << 1 |
+                             light.dist_atten_enable << 2 | light.spot_atten_enable << 3 |
+                             light.geometric_factor_0 << 4 | light.geometric_factor_1 << 5 |
+                             light.shadow_enable << 6;
+        light_config[i] = {light.num, flags, 0, 0};
+    }
+
+    using Pica::LightingRegs;
+    const auto set_lut = [&](std::size_t index, const auto& lut, bool enable,
+                             LightingRegs::LightingSampler sampler) {
+        const bool enabled =
+            enable && LightingRegs::IsLightingSamplerSupported(lighting.config, sampler);
+        lut_config[index] = {enabled, lut.abs_input, static_cast<GLuint>(lut.type), 0};
+    };
+    set_lut(0, lighting.lut_d0, lighting.lut_d0.enable,
+            LightingRegs::LightingSampler::Distribution0);
+    set_lut(1, lighting.lut_d1, lighting.lut_d1.enable,
+            LightingRegs::LightingSampler::Distribution1);
+    // Spotlight attenuation is gated per light by spot_atten_enable
+    set_lut(2, lighting.lut_sp, true, LightingRegs::LightingSampler::SpotlightAttenuation);
+    set_lut(3, lighting.lut_fr, lighting.lut_fr.enable, LightingRegs::LightingSampler::Fresnel);
+    set_lut(4, lighting.lut_rr, lighting.lut_rr.enable,
+            LightingRegs::LightingSampler::ReflectRed);
+    set_lut(5, lighting.lut_rg, lighting.lut_rg.enable,
+            LightingRegs::LightingSampler::ReflectGreen);
+    set_lut(6, lighting.lut_rb, lighting.lut_rb.enable,
+            LightingRegs::LightingSampler::ReflectBlue);
+
+    logic_op = static_cast<GLuint>(state.logic_op);
+}
+
 /**
  * An object representing a shader program staging. It can be either a shader object or a program
  * object, depending on whether separable program is used.
@@ -108,6 +179,50 @@ public:
         }
     }
 
+    /// Loads a separable stage from a program binary, returns false if the driver rejected it
+    bool CreateFromBinary(GLenum type, u64 hash, GLenum format, const std::vector<GLbyte>& binary) {
+        ASSERT(separable);
+        this->hash = hash;
+        program.Create(format, binary);
+        if (program.handle == 0) {
+            return false;
+        }
+        SetShaderUniformBlockBindings(program.handle);
+        if (type == GL_FRAGMENT_SHADER) {
+            SetShaderSamplerBindings(program.handle);
+        }
+        return true;
+    }
+
+    void GetProgramBinary(GLenum& format, std::vector<GLbyte>& binary) const {
+        program.GetProgramBinary(format, binary);
+    }
+
+    /// Marks the stage as being built by a shader worker, see Adopt
+    void SetPending(GLenum type, u64 hash) {
+        this->type = type;
+        this->hash = hash;
+        pending = true;
+    }
+
+    /// Takes ownership of an object built on a worker context for this stage
+    void Adopt(GLuint handle) {
+        pending = false;
+        if (separable) {
+            program.handle = handle;
+            SetShaderUniformBlockBindings(program.handle);
+            if (type == GL_FRAGMENT_SHADER) {
+                SetShaderSamplerBindings(program.handle);
+            }
+        } else {
+            shader.handle = handle;
+        }
+    }
+
+    bool IsPending() const {
+        return pending;
+    }
+
     GLuint GetHandle() const {
         if (separable) {
             return program.handle;
@@ -124,25 +239,148 @@ private:
     OGLShader shader;
     OGLProgram program;
     bool separable;
+    bool pending = false;
+    GLenum type = GL_NONE;
     u64 hash = 0;
 };
 
+/**
+ * Maps config hashes to shader stages with open addressing, it's looked up on every draw that
+ * switches shaders. The keys are already hashes, so their low bits index the table directly.
+ */
+class ShaderRefMap {
+public:
+    /// Returns the stage the hash was set to, or nullptr if it wasn't added
+    OGLShaderStage* const* Find(u64 hash) const {
+        if (entries.empty()) {
+            return nullptr;
+        }
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Entry& entry = entries[i];
+            if (!entry.used) {
+                return nullptr;
+            }
+            if (entry.hash == hash) {
+                return &entry.stage;
+            }
+        }
+    }
+
+    /// Sets the stage of a hash, the stage is nullptr for configs that run on the CPU
+    void Set(u64 hash, OGLShaderStage* stage) {
+        // Keeps the load factor below 3/4
+        if ((count + 1) * 4 > entries.size() * 3) {
+            Grow();
+        }
+        Entry& entry = Probe(hash);
+        if (!entry.used) {
+            entry.used = true;
+            entry.hash = hash;
+            ++count;
+        }
+        entry.stage = stage;
+    }
+
+    template <typename Func>
+    void ForEach(Func&& func) const {
+        for (const Entry& entry : entries) {
+            if (entry.used) {
+                func(entry.hash, entry.stage);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        u64 hash = 0;
+        OGLShaderStage* stage = nullptr;
+        bool used = false;
+    };
+
+    /// Returns the entry of the hash, or the empty one it goes to
+    Entry& Probe(u64 hash) {
+        std::size_t i = hash & mask;
+        while (entries[i].used && entries[i].hash != hash) {
+            i = (i + 1) & mask;
+        }
+        return entries[i];
+    }
+
+    void Grow() {
+        std::vector<Entry> old_entries = std::move(entries);
+        entries.assign(std::max<std::size_t>(256, old_entries.size() * 2), Entry{});
+        mask = entries.size() - 1;
+        for (const Entry& entry : old_entries) {
+            if (entry.used) {
+                Probe(entry.hash) = entry;
+            }
+        }
+    }
+
+    std::vector<Entry> entries;
+    std::size_t mask = 0;
+    std::size_t count = 0;
+};
+
+/// The config a stage was last looked up with, a draw with the same config skips hashing it
+template <typename Config>
+struct LastStageConfig {
+    bool Matches(const Config& other) const {
+        return valid && std::memcmp(&config, &other, sizeof(Config)) == 0;
+    }
+
+    void Set(const Config& other, OGLShaderStage* other_stage) {
+        config = other;
+        stage = other_stage;
+        valid = true;
+    }
+
+    Config config{};
+    OGLShaderStage* stage = nullptr;
+    bool valid = false;
+};
+
 class ShaderProgramManager::Impl {
+    struct ProgramCacheEntity {
+        explicit ProgramCacheEntity(GLenum format, std::vector<GLbyte>&& binary)
+            : format(format), binary(std::move(binary)) {}
+        GLenum format;
+        std::vector<GLbyte> binary;
+    };
+
 public:
-    explicit Impl(bool separable)
+    explicit Impl(Frontend::EmuWindow& emu_window, bool separable)
         : separable(separable), trivial_vertex_shader(separable),
-          trivial_geometry_shader(separable) {
+          trivial_geometry_shader(separable), uber_fragment_shader(separable) {
+        if (Settings::values.use_async_shader) {
+            const std::size_t num_workers = std::clamp<std::size_t>(
+                std::thread::hardware_concurrency() / 2, 1, MAX_SHADER_WORKERS);
+            worker_pool = std::make_unique<ShaderWorkerPool>(emu_window, num_workers);
+            if (!worker_pool->IsEnabled()) {
+                worker_pool.reset();
+            }
+        }
+        if (worker_pool) {
+            // The ubershader stands in for fragment shaders that are still being compiled
+            uber_fragment_shader.Create(GenerateFragmentUberShader(separable), GL_FRAGMENT_SHADER,
+                                        UBER_SHADER_HASH);
+            uber_uniform_buffer.Create();
+            GLuint old_buffer = OpenGLState::BindUniformBuffer(uber_uniform_buffer.handle);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(UberUniformData), nullptr, GL_DYNAMIC_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBindings::Uber),
+                             uber_uniform_buffer.handle);
+            OpenGLState::BindUniformBuffer(old_buffer);
+        }
         if (separable) {
             pipeline.Create();
-        } else if (Settings::values.use_shader_cache) {
-            u64 size = LoadProgramCache();
-            if (size > 0) {
-                std::string log{"Load Shader Cache"};
-                size >>= 20;
-                if (size > 0) {
-                    log = fmt::format("{} ({}MB)", log, size);
-                }
-                OSD::AddMessage(log, OSD::MessageType::ShaderCache, OSD::Duration::NORMAL,
+        }
+        if (Settings::values.use_shader_cache) {
+            store = std::make_unique<ShaderStore>(GetStoreFile(), GetDriverHash());
+            const std::size_t count = LoadProgramCache();
+            PreloadShaders();
+            if (count > 0) {
+                OSD::AddMessage(fmt::format("Load Shader Cache ({} shaders)", count),
+                                OSD::MessageType::ShaderCache, OSD::Duration::NORMAL,
                                 OSD::Color::YELLOW);
             }
         }
@@ -150,7 +388,7 @@ public:
     }
 
     ~Impl() {
-        if (!separable && Settings::values.use_shader_cache) {
+        if (store) {
             SaveProgramCache();
         }
     }
@@ -160,44 +398,153 @@ public:
         auto [iter, new_shader] = shaders.emplace(code_hash, separable);
         OGLShaderStage& cached_shader = iter->second;
         if (new_shader) {
-            cached_shader.Create(shader_code, shader_type, code_hash);
+            // In separable mode each stage is a program of its own, so its binary is cached by
+            // code hash
+            const bool use_binary = separable && store;
+            const ProgramCacheEntity* cached_binary = use_binary ? FindBinary(code_hash) : nullptr;
+            if (worker_pool) {
+                cached_shader.SetPending(shader_type, code_hash);
+                if (cached_binary != nullptr) {
+                    worker_pool->QueueStageBinary(code_hash, shader_code, shader_type,
+                                                  cached_binary->format, cached_binary->binary);
+                } else {
+                    worker_pool->QueueStage(code_hash, shader_code, shader_type, separable,
+                                            use_binary);
+                }
+            } else if (cached_binary == nullptr ||
+                       !cached_shader.CreateFromBinary(shader_type, code_hash,
+                                                       cached_binary->format,
+                                                       cached_binary->binary)) {
+                cached_shader.Create(shader_code, shader_type, code_hash);
+                if (use_binary) {
+                    GLenum format;
+                    std::vector<GLbyte> binary;
+                    cached_shader.GetProgramBinary(format, binary);
+                    if (!binary.empty()) {
+                        AddBinary(code_hash, format, std::move(binary));
+                    }
+                }
+            }
             // load cached shader reference
             auto iter = reference_cache.find(code_hash);
             if (iter != reference_cache.end()) {
                 for (const auto& hash : iter->second) {
-                    shaders_ref[hash] = &cached_shader;
+                    shaders_ref.Set(hash, &cached_shader);
                 }
             }
         }
         return &cached_shader;
     }
 
+    /// Returns the stage of the vertex shader config, nullptr if it could not be decompiled
+    OGLShaderStage* GetVertexStage(const PicaVSConfig& key, u64 key_hash,
+                                   const Pica::Shader::ShaderSetup& setup) {
+        OGLShaderStage* const* stage_ref = shaders_ref.Find(key_hash);
+        if (stage_ref != nullptr) {
+            return *stage_ref;
+        }
+        auto [code_iter, new_code] = vertex_cache.emplace(key_hash, std::string{});
+        if (new_code) {
+            // always new code
+            code_iter->second = GenerateVertexShader(setup, key, separable);
+        }
+        const std::string& vs_code = code_iter->second;
+        OGLShaderStage* stage = nullptr;
+        if (!vs_code.empty()) {
+            stage = GetShaderStageRef(vs_code, GL_VERTEX_SHADER);
+        }
+        shaders_ref.Set(key_hash, stage);
+        return stage;
+    }
+
+    /**
+     * Returns the stage of the program specialized on the uniforms of the key, nullptr once the
+     * program has as many variants as allowed
+     */
+    OGLShaderStage* GetSpecializedVertexStage(const PicaVSConfig& key, u64 generic_hash,
+                                              const Pica::Shader::ShaderSetup& setup) {
+        const u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
+        if (shaders_ref.Find(key_hash) == nullptr && vertex_cache.count(key_hash) == 0 &&
+            specialized_variants[generic_hash]++ >= MAX_SPECIALIZED_VARIANTS) {
+            // Uniforms that keep changing would otherwise compile a shader per draw
+            shaders_ref.Set(key_hash, nullptr);
+            return nullptr;
+        }
+        return GetVertexStage(key, key_hash, setup);
+    }
+
     bool UseProgrammableVertexShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
         PicaVSConfig key(regs, setup);
+        if (Settings::values.specialize_shader_uniforms) {
+            key.state.Specialize(regs.vs, setup);
+        }
+        if (last_vs.Matches(key.state)) {
+            current_shaders.vs = last_vs.stage;
+            return (current_shaders.vs != nullptr);
+        }
+        if (!key.state.specialized) {
+            current_shaders.vs =
+                GetVertexStage(key, Common::ComputeHash64(&key, sizeof(key)), setup);
+            last_vs.Set(key.state, current_shaders.vs);
+            return (current_shaders.vs != nullptr);
+        }
+
+        PicaVSConfig generic_key(regs, setup);
+        const u64 generic_hash = Common::ComputeHash64(&generic_key, sizeof(generic_key));
+        OGLShaderStage* stage = GetSpecializedVertexStage(key, generic_hash, setup);
+        if (stage != nullptr && !stage->IsPending()) {
+            current_shaders.vs = stage;
+            last_vs.Set(key.state, stage);
+            return true;
+        }
+
+        // The generic program stands in while the specialized one is compiled, or for good when
+        // there is none
+        OGLShaderStage* generic_stage = GetVertexStage(generic_key, generic_hash, setup);
+        if (stage == nullptr) {
+            current_shaders.vs = generic_stage;
+            last_vs.Set(key.state, generic_stage);
+        } else if (generic_stage != nullptr && !generic_stage->IsPending()) {
+            current_shaders.vs = generic_stage;
+        } else {
+            current_shaders.vs = stage;
+        }
+        return (current_shaders.vs != nullptr);
+    }
+
+    bool UseProgrammableGeometryShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup) {
+        PicaGSConfig key(regs, setup);
+        if (last_programmable_gs.Matches(key.state)) {
+            current_shaders.gs = last_programmable_gs.stage;
+            return (current_shaders.gs != nullptr);
+        }
         u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
-        auto iter_ref = shaders_ref.find(key_hash);
-        if (iter_ref == shaders_ref.end()) {
-            auto [code_iter, new_code] = vertex_cache.emplace(key_hash, std::string{});
+        OGLShaderStage* const* stage_ref = shaders_ref.Find(key_hash);
+        if (stage_ref == nullptr) {
+            auto [code_iter, new_code] = geometry_cache.emplace(key_hash, std::string{});
             if (new_code) {
-                // always new code
-                code_iter->second = GenerateVertexShader(setup, key, separable);
+                code_iter->second = GenerateGeometryShader(setup, key, separable);
             }
-            const std::string& vs_code = code_iter->second;
-            if (vs_code.empty()) {
-                shaders_ref[key_hash] = nullptr;
-                current_shaders.vs = nullptr;
+            const std::string& gs_code = code_iter->second;
+            if (gs_code.empty()) {
+                current_shaders.gs = nullptr;
             } else {
-                current_shaders.vs = GetShaderStageRef(vs_code, GL_VERTEX_SHADER);
-                shaders_ref[key_hash] = current_shaders.vs;
+                current_shaders.gs = GetShaderStageRef(gs_code, GL_GEOMETRY_SHADER);
             }
+            shaders_ref.Set(key_hash, current_shaders.gs);
         } else {
-            current_shaders.vs = iter_ref->second;
+            current_shaders.gs = *stage_ref;
         }
-        return (current_shaders.vs != nullptr);
+        last_programmable_gs.Set(key.state, current_shaders.gs);
+        return (current_shaders.gs != nullptr);
     }
 
     void UseFixedGeometryShader(const Pica::Regs& regs) {
         PicaFixedGSConfig key(regs);
+        if (last_gs.Matches(key.state)) {
+            current_shaders.gs = last_gs.stage;
+            return;
+        }
         u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
         auto [iter, new_shader] = shaders.emplace(key_hash, separable);
         OGLShaderStage& cached_shader = iter->second;
@@ -206,22 +553,30 @@ public:
             cached_shader.Create(gs_code, GL_GEOMETRY_SHADER, key_hash);
         }
         current_shaders.gs = &cached_shader;
+        last_gs.Set(key.state, current_shaders.gs);
     }
 
     void UseFragmentShader(const Pica::Regs& regs) {
         auto key = PicaFSConfig::BuildFromRegs(regs);
+        // Most register writes that mark the shader dirty leave the config as it was
+        if (current_shaders.fs != nullptr &&
+            std::memcmp(&key, &current_fs_config, sizeof(key)) == 0) {
+            return;
+        }
         u64 key_hash = Common::ComputeHash64(&key, sizeof(key));
-        auto iter_ref = shaders_ref.find(key_hash);
-        if (iter_ref == shaders_ref.end()) {
+        current_fs_config = key;
+        current_fs_key_hash = key_hash;
+        OGLShaderStage* const* stage_ref = shaders_ref.Find(key_hash);
+        if (stage_ref == nullptr) {
             auto [code_iter, new_code] = fragment_cache.emplace(key_hash, std::string{});
             if (new_code) {
                 // always new code
                 code_iter->second = GenerateFragmentShader(key, separable);
             }
             current_shaders.fs = GetShaderStageRef(code_iter->second, GL_FRAGMENT_SHADER);
-            shaders_ref[key_hash] = current_shaders.fs;
+            shaders_ref.Set(key_hash, current_shaders.fs);
         } else {
-            current_shaders.fs = iter_ref->second;
+            current_shaders.fs = *stage_ref;
         }
     }
 
@@ -233,10 +588,53 @@ public:
         current_shaders.gs = &trivial_geometry_shader;
     }
 
-    void ApplyTo(OpenGLState& state) {
+    /// Adopts the objects finished by the shader workers since the last draw
+    void CollectWorkerResults() {
+        for (auto& result : worker_pool->PopResults()) {
+            if (result.type == GL_NONE) {
+                OGLProgram& cached_program = program_cache[result.hash];
+                cached_program.handle = result.handle;
+                SetShaderUniformBlockBindings(cached_program.handle);
+                SetShaderSamplerBindings(cached_program.handle);
+                if (!result.binary.empty()) {
+                    AddBinary(result.hash, result.binary_format, std::move(result.binary));
+                }
+                pending_programs.erase(result.hash);
+            } else {
+                auto iter = shaders.find(result.hash);
+                ASSERT(iter != shaders.end());
+                iter->second.Adopt(result.handle);
+                if (!result.binary.empty()) {
+                    AddBinary(result.hash, result.binary_format, std::move(result.binary));
+                }
+            }
+        }
+    }
+
+    bool ApplyTo(OpenGLState& state) {
+        if (worker_pool) {
+            if (worker_pool->HasResults()) {
+                CollectWorkerResults();
+            }
+            // Skip the draw until the specialized vertex stages are ready
+            if (current_shaders.vs->IsPending() || current_shaders.gs->IsPending()) {
+                return false;
+            }
+            // Draw with the ubershader while the specialized fragment stage is being built
+            if (current_shaders.fs->IsPending() ||
+                !BindStages(state, *current_shaders.fs, false)) {
+                return UseUberShader() && BindStages(state, uber_fragment_shader, true);
+            }
+            return true;
+        }
+        return BindStages(state, *current_shaders.fs, false);
+    }
+
+    /// Returns false if the program for the given stages is still being linked in the background
+    bool BindStages(OpenGLState& state, const OGLShaderStage& fs_stage, bool is_uber) {
         GLuint vs = current_shaders.vs->GetHandle();
         GLuint gs = current_shaders.gs->GetHandle();
-        GLuint fs = current_shaders.fs->GetHandle();
+        GLuint fs = fs_stage.GetHandle();
 
         if (separable) {
             glUseProgramStages(pipeline.handle, GL_VERTEX_SHADER_BIT, vs);
@@ -248,11 +646,18 @@ public:
             const std::array<u64, 3> bundle{
                 current_shaders.vs->GetHash(),
                 current_shaders.gs->GetHash(),
-                current_shaders.fs->GetHash(),
+                fs_stage.GetHash(),
             };
             u64 hash = Common::ComputeHash64(bundle.data(), bundle.size() * sizeof(u64));
             OGLProgram& cached_program = program_cache[hash];
             if (cached_program.handle == 0) {
+                if (worker_pool && FindBinary(hash) == nullptr) {
+                    if (pending_programs.insert(hash).second) {
+                        // Ubershader programs are transient, keep them out of the disk cache
+                        worker_pool->QueueProgram(hash, {vs, gs, fs}, store && !is_uber);
+                    }
+                    return false;
+                }
                 CreateProgram(cached_program, hash, vs, gs, fs);
                 SetShaderUniformBlockBindings(cached_program.handle);
                 SetShaderSamplerBindings(cached_program.handle);
@@ -260,16 +665,36 @@ public:
             state.draw.shader_program = cached_program.handle;
             state.draw.program_pipeline = 0;
         }
+        return true;
+    }
+
+    /**
+     * Uploads the current fragment configuration for the ubershader
+     * @returns false if the configuration uses features the ubershader does not emulate
+     */
+    bool UseUberShader() {
+        const auto& fs_state = current_fs_config.state;
+        if (fs_state.shadow_rendering || fs_state.proctex.enable) {
+            return false;
+        }
+        if (uber_key_hash != current_fs_key_hash) {
+            UberUniformData data;
+            data.SetFromConfig(current_fs_config);
+            GLuint old_buffer = OpenGLState::BindUniformBuffer(uber_uniform_buffer.handle);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UberUniformData), &data);
+            OpenGLState::BindUniformBuffer(old_buffer);
+            uber_key_hash = current_fs_key_hash;
+        }
+        return true;
     }
 
     void CreateProgram(OGLProgram& program, u64 hash, GLuint vs, GLuint gs, GLuint fs) {
-        auto iter = binary_cache.find(hash);
         // load opengl program binary cache
-        if (iter != binary_cache.end()) {
-            program.Create(iter->second.format, iter->second.binary);
+        if (const ProgramCacheEntity* cached_binary = FindBinary(hash)) {
+            program.Create(cached_binary->format, cached_binary->binary);
             if (program.handle == 0) {
                 // cache data corrupted
-                binary_cache.clear();
+                binary_cache.erase(hash);
             }
         }
         if (program.handle == 0) {
@@ -278,63 +703,145 @@ public:
             program.Create(false, {vs, gs, fs});
             program.GetProgramBinary(format, binary);
             if (!binary.empty()) {
-                binary_cache.emplace(hash, ProgramCacheEntity{format, std::move(binary)});
+                AddBinary(hash, format, std::move(binary));
             } else {
                 LOG_DEBUG(Render_OpenGL, "failed to get program binary!");
             }
         }
     }
 
-    static constexpr u32 PROGRAM_CACHE_VERSION = 0x6;
+    static constexpr u32 PROGRAM_CACHE_VERSION = 0xB;
+    static constexpr std::size_t MAX_SHADER_WORKERS = 2;
+    static constexpr u32 MAX_SPECIALIZED_VARIANTS = 4;
+    static constexpr u64 UBER_SHADER_HASH = 0xFFFFFFFFFFFFFFFF;
 
-    static std::string GetCacheFile() {
+    std::string GetCacheFile() const {
         u64 program_id = 0;
         Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id);
         const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
-        return fmt::format("{}{:016X}.cache", dir, program_id);
+        // Separable stages and linked programs are not interchangeable
+        return fmt::format("{}{:016X}{}.cache", dir, program_id, separable ? ".sep" : "");
     }
 
-    void SaveProgramCache() {
-        Core::CacheFile file(GetCacheFile(), Core::CacheFile::MODE_SAVE);
+    static std::string GetStoreFile() {
+        return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "shaders.store";
+    }
 
-        u32 verion = PROGRAM_CACHE_VERSION;
-        file.DoHeader(verion);
+    /// Program binaries are only valid for the driver that produced them
+    static u64 GetDriverHash() {
+        std::string driver;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const auto* value = reinterpret_cast<const char*>(glGetString(name));
+            if (value != nullptr) {
+                driver += value;
+            }
+        }
+        return Common::ComputeHash64(driver.data(), driver.size());
+    }
 
-        s32 count = static_cast<s32>(binary_cache.size());
-        file.Do(count);
+    ShaderStore::EntryType GetBinaryType() const {
+        return separable ? ShaderStore::EntryType::SeparableStage : ShaderStore::EntryType::Program;
+    }
 
-        u64 hash;
-        u32 length;
+    /// Returns the binary for the given program or separable stage, looking into the store
+    const ProgramCacheEntity* FindBinary(u64 hash) {
+        auto iter = binary_cache.find(hash);
+        if (iter != binary_cache.end()) {
+            return &iter->second;
+        }
         GLenum format;
         std::vector<GLbyte> binary;
-        for (auto& pair : binary_cache) {
-            hash = pair.first;
-            format = pair.second.format;
-            length = static_cast<u32>(pair.second.binary.size());
-            file.Do(hash);
-            file.Do(format);
-            file.Do(length);
-            file.Do(pair.second.binary);
+        if (!store || !store->GetBinary(GetBinaryType(), hash, format, binary)) {
+            return nullptr;
         }
+        return &binary_cache.emplace(hash, ProgramCacheEntity{format, std::move(binary)})
+                    .first->second;
+    }
 
-        if (!file.IsGood()) {
-            return;
+    /// Stores a program binary created during this session
+    void AddBinary(u64 hash, GLenum format, std::vector<GLbyte>&& binary) {
+        auto [iter, inserted] =
+            binary_cache.insert_or_assign(hash, ProgramCacheEntity{format, std::move(binary)});
+        if (store) {
+            store->AddBinary(GetBinaryType(), hash, format, iter->second.binary);
         }
+    }
 
-        file.DoMarker("ShadersRef");
-        SaveShadersRef(file);
-        if (!file.IsGood()) {
-            return;
+    /// Adds the config hashes of every live shader stage to reference_cache
+    void MergeShadersRef() {
+        shaders_ref.ForEach([this](u64 hash, const OGLShaderStage* stage) {
+            if (stage == nullptr) {
+                // vertex and geometry configs that fall back to the software shader
+                return;
+            }
+            reference_cache[stage->GetHash()].insert(hash);
+        });
+    }
+
+    /// Moves the sources into the store and returns the config to code hash manifest
+    std::unordered_map<u64, u64> StoreCode(const std::unordered_map<u64, std::string>& cache) {
+        std::unordered_map<u64, u64> manifest;
+        for (const auto& [key_hash, code] : cache) {
+            if (code.empty()) {
+                continue;
+            }
+            const u64 code_hash = Common::ComputeHash64(code.data(), code.size());
+            store->AddCode(code_hash, code);
+            manifest.emplace(key_hash, code_hash);
         }
+        return manifest;
+    }
 
-        file.DoMarker("VertexCache");
-        file.Do(vertex_cache);
+    /// Resolves a config to code hash manifest against the store
+    void LoadCode(const std::unordered_map<u64, u64>& manifest,
+                  std::unordered_map<u64, std::string>& cache) {
+        for (const auto& [key_hash, code_hash] : manifest) {
+            if (auto code = store->GetCode(code_hash)) {
+                cache.emplace(key_hash, std::move(*code));
+            }
+        }
+    }
 
-        file.DoMarker("FragmentCache");
-        file.Do(fragment_cache);
+    /**
+     * The per-title cache file is a manifest of the configs seen in the title, the sources and
+     * binaries themselves live in the shared store. It is written to a temporary file first, so
+     * that a crash never leaves a truncated manifest.
+     */
+    void SaveProgramCache() {
+        MergeShadersRef();
+        auto vertex_manifest = StoreCode(vertex_cache);
+        auto geometry_manifest = StoreCode(geometry_cache);
+        auto fragment_manifest = StoreCode(fragment_cache);
+
+        const std::string temp_path = GetCacheFile() + ".tmp";
+        {
+            Core::CacheFile file(temp_path, Core::CacheFile::MODE_SAVE);
+
+            u32 verion = PROGRAM_CACHE_VERSION;
+            file.DoHeader(verion);
+
+            file.DoMarker("ShadersRef");
+            SaveShadersRef(file);
+
+            file.DoMarker("VertexCache");
+            file.Do(vertex_manifest);
+
+            file.DoMarker("GeometryCache");
+            file.Do(geometry_manifest);
+
+            file.DoMarker("FragmentCache");
+            file.Do(fragment_manifest);
+
+            if (!file.IsGood()) {
+                FileUtil::Delete(temp_path);
+                return;
+            }
+        }
+        FileUtil::Rename(temp_path, GetCacheFile());
     }
 
-    u64 LoadProgramCache() {
+    /// Returns the number of configs found in the manifest
+    std::size_t LoadProgramCache() {
         Core::CacheFile file(GetCacheFile(), Core::CacheFile::MODE_LOAD);
 
         u32 verion = 0;
@@ -344,26 +851,6 @@ public:
             return 0;
         }
 
-        s32 count = 0;
-        file.Do(count);
-
-        u64 hash;
-        u32 length;
-        GLenum format;
-        std::vector<GLbyte> binary;
-        for (s32 i = 0; i < count; ++i) {
-            file.Do(hash);
-            file.Do(format);
-            file.Do(length);
-            file.Do(binary);
-            binary_cache.emplace(hash, ProgramCacheEntity{format, std::move(binary)});
-        }
-
-        if (!file.IsGood()) {
-            binary_cache.clear();
-            return 0;
-        }
-
         file.DoMarker("ShadersRef");
         LoadShadersRef(file);
         if (!file.IsGood()) {
@@ -371,48 +858,55 @@ public:
             return 0;
         }
 
+        std::unordered_map<u64, u64> vertex_manifest;
         file.DoMarker("VertexCache");
-        file.Do(vertex_cache);
+        file.Do(vertex_manifest);
+        if (!file.IsGood()) {
+            return 0;
+        }
+
+        std::unordered_map<u64, u64> geometry_manifest;
+        file.DoMarker("GeometryCache");
+        file.Do(geometry_manifest);
         if (!file.IsGood()) {
-            vertex_cache.clear();
             return 0;
         }
 
+        std::unordered_map<u64, u64> fragment_manifest;
         file.DoMarker("FragmentCache");
-        file.Do(fragment_cache);
+        file.Do(fragment_manifest);
         if (!file.IsGood()) {
-            fragment_cache.clear();
             return 0;
         }
 
+        LoadCode(vertex_manifest, vertex_cache);
+        LoadCode(geometry_manifest, geometry_cache);
+        LoadCode(fragment_manifest, fragment_cache);
+        return vertex_cache.size() + geometry_cache.size() + fragment_cache.size();
+    }
+
+    /// Builds the stages of every cached config ahead of their first draw
+    void PreloadShaders() {
         for (const auto& entity : vertex_cache) {
             GetShaderStageRef(entity.second, GL_VERTEX_SHADER);
         }
 
+        for (const auto& entity : geometry_cache) {
+            GetShaderStageRef(entity.second, GL_GEOMETRY_SHADER);
+        }
+
         for (const auto& entity : fragment_cache) {
             GetShaderStageRef(entity.second, GL_FRAGMENT_SHADER);
         }
-
-        return file.GetSize();
     }
 
     void SaveShadersRef(Core::CacheFile& file) {
-        for (const auto& ref : shaders_ref) {
-            u64 key_hash = ref.first;
-            u64 code_hash = ref.second->GetHash();
-            auto iter = reference_cache.find(code_hash);
-            if (iter != reference_cache.end()) {
-                iter->second.insert(key_hash);
-            } else {
-                reference_cache[code_hash] = {key_hash};
-            }
-        }
-
-        u32 count = reference_cache.size();
+        u32 count = static_cast<u32>(reference_cache.size());
         file.Do(count);
 
         for (auto& ref : reference_cache) {
-            file.Do(ref.first);
+            u64 code_hash = ref.first;
+            file.Do(code_hash);
             file.Do(ref.second);
         }
     }
@@ -439,28 +933,40 @@ private:
         OGLShaderStage* fs;
     } current_shaders{};
 
-    struct ProgramCacheEntity {
-        explicit ProgramCacheEntity(GLenum format, std::vector<GLbyte>&& binary)
-            : format(format), binary(binary) {}
-        GLenum format;
-        std::vector<GLbyte> binary;
-    };
     std::unordered_map<u64, ProgramCacheEntity> binary_cache;
     std::unordered_map<u64, std::unordered_set<u64>> reference_cache;
     std::unordered_map<u64, std::string> vertex_cache;
+    std::unordered_map<u64, std::string> geometry_cache;
     std::unordered_map<u64, std::string> fragment_cache;
 
+    std::unique_ptr<ShaderStore> store;
+
     OGLShaderStage trivial_vertex_shader;
     OGLShaderStage trivial_geometry_shader;
-    std::unordered_map<u64, OGLShaderStage*> shaders_ref;
+    ShaderRefMap shaders_ref;
     std::unordered_map<u64, OGLShaderStage> shaders;
+    LastStageConfig<PicaShaderConfigCommon> last_vs;
+    /// Specialized vertex shaders generated per generic config hash
+    std::unordered_map<u64, u32> specialized_variants;
+    LastStageConfig<PicaGSConfigCommonRaw> last_gs;
+    LastStageConfig<PicaGSConfigRaw> last_programmable_gs;
 
     OGLPipeline pipeline;
     std::unordered_map<u64, OGLProgram> program_cache;
+    std::unordered_set<u64> pending_programs;
+
+    OGLShaderStage uber_fragment_shader;
+    OGLBuffer uber_uniform_buffer;
+    PicaFSConfig current_fs_config{};
+    u64 current_fs_key_hash = 0;
+    u64 uber_key_hash = 0;
+
+    // Declared last so that the workers are joined before the objects they reference go away
+    std::unique_ptr<ShaderWorkerPool> worker_pool;
 };
 
-ShaderProgramManager::ShaderProgramManager(bool separable)
-    : impl(std::make_unique<Impl>(separable)) {}
+ShaderProgramManager::ShaderProgramManager(Frontend::EmuWindow& emu_window, bool separable)
+    : impl(std::make_unique<Impl>(emu_window, separable)) {}
 
 ShaderProgramManager::~ShaderProgramManager() = default;
 
@@ -473,6 +979,11 @@ void ShaderProgramManager::UseTrivialVertexShader() {
     impl->UseTrivialVertexShader();
 }
 
+bool ShaderProgramManager::UseProgrammableGeometryShader(const Pica::Regs& regs,
+                                                         Pica::Shader::ShaderSetup& setup) {
+    return impl->UseProgrammableGeometryShader(regs, setup);
+}
+
 void ShaderProgramManager::UseFixedGeometryShader(const Pica::Regs& regs) {
     impl->UseFixedGeometryShader(regs);
 }
@@ -485,7 +996,7 @@ void ShaderProgramManager::UseFragmentShader(const Pica::Regs& regs) {
     impl->UseFragmentShader(regs);
 }
 
-void ShaderProgramManager::ApplyTo(OpenGLState& state) {
-    impl->ApplyTo(state);
+bool ShaderProgramManager::ApplyTo(OpenGLState& state) {
+    return impl->ApplyTo(state);
 }
 } // namespace OpenGL
@@ -12,9 +12,13 @@
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 
+namespace Frontend {
+class EmuWindow;
+}
+
 namespace OpenGL {
 
-enum class UniformBindings : GLuint { Common, VS, GS };
+enum class UniformBindings : GLuint { Common, VS, GS, Uber };
 
 struct LightSrc {
     alignas(16) GLvec3 specular_0;
@@ -50,6 +54,7 @@ struct UniformData {
     GLfloat proctex_bias;
     GLint shadow_texture_bias;
     GLfloat lighting_lut_scales[7];
+    GLint shadow_pass;
     alignas(16) GLivec4 lighting_lut_offset[Pica::LightingRegs::NumLightingSampler / 4];
     alignas(16) GLvec3 fog_color;
     alignas(8) GLvec2 proctex_noise_f;
@@ -63,7 +68,7 @@ struct UniformData {
 };
 
 static_assert(
-    sizeof(UniformData) == 0x500,
+    sizeof(UniformData) == 0x510,
     "The size of the UniformData structure has changed, update the structure in the shader");
 static_assert(sizeof(UniformData) < 0x4000,
               "UniformData structure must be less than 16kb as per the OpenGL spec");
@@ -91,23 +96,72 @@ static_assert(
 static_assert(sizeof(VSUniformData) < 0x4000,
               "VSUniformData structure must be less than 16kb as per the OpenGL spec");
 
+struct GSUniformData {
+    PicaUniformsData uniforms;
+};
+static_assert(
+    sizeof(GSUniformData) == 1856,
+    "The size of the GSUniformData structure has changed, update the structure in the shader");
+static_assert(sizeof(GSUniformData) < 0x4000,
+              "GSUniformData structure must be less than 16kb as per the OpenGL spec");
+
+/// Uniform struct for the Uniform Buffer Object that describes the fragment pipeline configuration
+/// to the fragment ubershader, see GenerateFragmentUberShader.
+// NOTE: the same rule from UniformData also applies here.
+struct UberUniformData {
+    void SetFromConfig(const PicaFSConfig& config);
+
+    alignas(16) std::array<GLuvec4, 6> tev_config; // sources, modifiers, ops, scales
+    GLuint combiner_buffer_input;
+    GLuint alpha_test_func;
+    GLuint scissor_test_mode;
+    GLuint texture0_type;
+    GLuint texture2_use_coord1;
+    GLuint depthmap_enable;
+    GLuint fog_mode;
+    GLuint fog_flip;
+    GLuint lighting_enable;
+    GLuint lighting_src_num;
+    GLuint bump_mode;
+    GLuint bump_selector;
+    GLuint bump_renorm;
+    GLuint clamp_highlights;
+    GLuint lighting_config;
+    GLuint lighting_flags;
+    GLuint shadow_selector;
+    GLuint logic_op;
+    alignas(16) std::array<GLuvec4, 8> light_config; // x = light index, y = flags
+    alignas(16) std::array<GLuvec4, 7> lut_config;   // x = enabled, y = abs input, z = input
+};
+static_assert(
+    sizeof(UberUniformData) == 0x1A0,
+    "The size of the UberUniformData structure has changed, update the structure in the shader");
+
 /// A class that manage different shader stages and configures them with given config data.
 class ShaderProgramManager {
 public:
-    ShaderProgramManager(bool separable);
+    ShaderProgramManager(Frontend::EmuWindow& emu_window, bool separable);
     ~ShaderProgramManager();
 
     bool UseProgrammableVertexShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup);
 
     void UseTrivialVertexShader();
 
+    /// Returns false if the program can't be translated and the draw has to run on the CPU
+    bool UseProgrammableGeometryShader(const Pica::Regs& regs, Pica::Shader::ShaderSetup& setup);
+
     void UseFixedGeometryShader(const Pica::Regs& regs);
 
     void UseTrivialGeometryShader();
 
     void UseFragmentShader(const Pica::Regs& regs);
 
-    void ApplyTo(OpenGLState& state);
+    /**
+     * Binds the current shader stages to the given state
+     * @returns false if a stage is still being compiled in the background and the draw should be
+     * skipped
+     */
+    bool ApplyTo(OpenGLState& state);
 
 private:
     class Impl;
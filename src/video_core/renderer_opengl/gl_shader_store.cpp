@@ -0,0 +1,235 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_shader_store.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace OpenGL {
+
+namespace {
+constexpr u32 STORE_MAGIC = 0x53484353; // "SCHS"
+constexpr u32 STORE_VERSION = 2;
+
+struct StoreHeader {
+    u32 magic;
+    u32 version;
+};
+} // Anonymous namespace
+
+ShaderStore::ShaderStore(const std::string& path, u64 driver_hash)
+    : path(path), driver_hash(driver_hash) {
+    const std::size_t valid_size = MapAndIndex();
+    if (valid_size == 0) {
+        // Missing or incompatible store, start a new one
+        Unmap();
+        code_index.clear();
+        program_index.clear();
+        stage_index.clear();
+        file = FileUtil::IOFile(path, "wb");
+        file.WriteObject(StoreHeader{STORE_MAGIC, STORE_VERSION});
+    } else {
+        file = FileUtil::IOFile(path, "r+b");
+        // Drop the entry torn by a killed process, new entries would be unreachable behind it
+        if (file.GetSize() != valid_size) {
+            LOG_WARNING(Render_OpenGL, "Discarding incomplete entry at the end of {}", path);
+            file.Resize(valid_size);
+        }
+        file.Seek(static_cast<s64>(valid_size), SEEK_SET);
+    }
+
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_OpenGL, "Failed to open shader store {}", path);
+        return;
+    }
+    LOG_INFO(Render_OpenGL, "Shader store has {} sources, {} programs and {} stages",
+             code_index.size(), program_index.size(), stage_index.size());
+}
+
+ShaderStore::~ShaderStore() {
+    file.Close();
+    Unmap();
+}
+
+bool ShaderStore::Contains(EntryType type, u64 hash) const {
+    const Index& index = GetIndex(type);
+    return index.find(hash) != index.end();
+}
+
+std::optional<std::string> ShaderStore::GetCode(u64 hash) const {
+    auto iter = code_index.find(hash);
+    if (iter == code_index.end()) {
+        return {};
+    }
+    const u8* data = GetData(iter->second);
+    if (data == nullptr) {
+        return {};
+    }
+    return std::string(reinterpret_cast<const char*>(data), iter->second.size);
+}
+
+bool ShaderStore::GetBinary(EntryType type, u64 hash, GLenum& format,
+                            std::vector<GLbyte>& binary) const {
+    const Index& index = GetIndex(type);
+    auto iter = index.find(hash);
+    if (iter == index.end()) {
+        return false;
+    }
+    const u8* data = GetData(iter->second);
+    if (data == nullptr) {
+        return false;
+    }
+    format = iter->second.format;
+    binary.assign(data, data + iter->second.size);
+    return true;
+}
+
+void ShaderStore::AddCode(u64 hash, std::string_view code) {
+    auto [iter, inserted] = code_index.emplace(hash, Location{npos, 0, GL_NONE, 0});
+    if (!inserted) {
+        return;
+    }
+    const u32 size = static_cast<u32>(code.size());
+    const u64 checksum = Common::ComputeHash64(code.data(), size);
+    Append({EntryType::Code, size, hash, 0, checksum, GL_NONE, 0}, code.data());
+}
+
+void ShaderStore::AddBinary(EntryType type, u64 hash, GLenum format,
+                            const std::vector<GLbyte>& binary) {
+    auto [iter, inserted] = GetIndex(type).emplace(hash, Location{npos, 0, GL_NONE, 0});
+    if (!inserted) {
+        if (iter->second.offset == npos) {
+            return;
+        }
+        // The stored binary was rejected by the driver, the new entry shadows it
+        iter->second = Location{npos, 0, GL_NONE, 0};
+    }
+    const u32 size = static_cast<u32>(binary.size());
+    const u64 checksum = Common::ComputeHash64(binary.data(), size);
+    Append({type, size, hash, driver_hash, checksum, format, 0}, binary.data());
+}
+
+std::size_t ShaderStore::MapAndIndex() {
+#ifdef _WIN32
+    FileUtil::IOFile in(path, "rb");
+    if (!in.IsOpen()) {
+        return 0;
+    }
+    contents.resize(in.GetSize());
+    if (in.ReadBytes(contents.data(), contents.size()) != contents.size()) {
+        return 0;
+    }
+    mapping = contents.data();
+    mapping_size = contents.size();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StoreHeader))) {
+        close(fd);
+        return 0;
+    }
+    void* base = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return 0;
+    }
+    mapping = static_cast<const u8*>(base);
+    mapping_size = static_cast<std::size_t>(st.st_size);
+#endif
+
+    StoreHeader store_header;
+    if (mapping_size < sizeof(StoreHeader)) {
+        return 0;
+    }
+    std::memcpy(&store_header, mapping, sizeof(StoreHeader));
+    if (store_header.magic != STORE_MAGIC || store_header.version != STORE_VERSION) {
+        return 0;
+    }
+
+    std::size_t offset = sizeof(StoreHeader);
+    while (mapping_size - offset >= sizeof(EntryHeader)) {
+        EntryHeader header;
+        std::memcpy(&header, mapping + offset, sizeof(EntryHeader));
+        const std::size_t data_offset = offset + sizeof(EntryHeader);
+        if (header.type < EntryType::Code || header.type > EntryType::SeparableStage ||
+            mapping_size - data_offset < header.size) {
+            break;
+        }
+        // Binaries built by another driver are kept in the file but never handed out
+        if (header.type == EntryType::Code || header.driver_hash == driver_hash) {
+            GetIndex(header.type)
+                .insert_or_assign(header.hash, Location{data_offset, header.size, header.format,
+                                                        header.checksum});
+        }
+        offset = data_offset + header.size;
+    }
+    return offset;
+}
+
+void ShaderStore::Unmap() {
+#ifdef _WIN32
+    contents.clear();
+    contents.shrink_to_fit();
+#else
+    if (mapping != nullptr) {
+        munmap(const_cast<u8*>(mapping), mapping_size);
+    }
+#endif
+    mapping = nullptr;
+    mapping_size = 0;
+}
+
+const ShaderStore::Index& ShaderStore::GetIndex(EntryType type) const {
+    switch (type) {
+    case EntryType::Code:
+        return code_index;
+    case EntryType::Program:
+        return program_index;
+    case EntryType::SeparableStage:
+        return stage_index;
+    }
+    UNREACHABLE();
+    return code_index;
+}
+
+ShaderStore::Index& ShaderStore::GetIndex(EntryType type) {
+    return const_cast<Index&>(static_cast<const ShaderStore*>(this)->GetIndex(type));
+}
+
+const u8* ShaderStore::GetData(const Location& location) const {
+    if (location.offset == npos) {
+        // Added this session, the caller already holds the data
+        return nullptr;
+    }
+    const u8* data = mapping + location.offset;
+    if (Common::ComputeHash64(data, location.size) != location.checksum) {
+        LOG_ERROR(Render_OpenGL, "Corrupted entry in shader store at offset {}", location.offset);
+        return nullptr;
+    }
+    return data;
+}
+
+void ShaderStore::Append(const EntryHeader& header, const void* data) {
+    if (!file.IsOpen()) {
+        return;
+    }
+    file.WriteObject(header);
+    file.WriteBytes(static_cast<const u8*>(data), header.size);
+    file.Flush();
+}
+
+} // namespace OpenGL
@@ -0,0 +1,98 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/file_util.h"
+
+namespace OpenGL {
+
+/**
+ * An append-only store of GLSL sources and program binaries shared by every title. Entries are
+ * addressed by the hash of their content, so titles built on the same engine reuse each other's
+ * work and the store only grows with distinct shaders. Binaries are tagged with the driver that
+ * produced them and are ignored on any other driver.
+ *
+ * The file is mapped on open and only the entry headers are scanned, entry data is read on demand.
+ * Every entry is written out as soon as it is added, so a killed process loses nothing but the
+ * entry being written, which is dropped on the next open.
+ */
+class ShaderStore {
+public:
+    enum class EntryType : u32 {
+        Code = 1,
+        Program = 2,        ///< Linked program, keyed by the hash of its stages
+        SeparableStage = 3, ///< Separable single stage program, keyed by its code hash
+    };
+
+    ShaderStore(const std::string& path, u64 driver_hash);
+    ~ShaderStore();
+
+    bool Contains(EntryType type, u64 hash) const;
+
+    std::optional<std::string> GetCode(u64 hash) const;
+
+    bool GetBinary(EntryType type, u64 hash, GLenum& format, std::vector<GLbyte>& binary) const;
+
+    void AddCode(u64 hash, std::string_view code);
+
+    /// Adds a binary, replacing the stored one for the same hash since that one was not usable
+    void AddBinary(EntryType type, u64 hash, GLenum format, const std::vector<GLbyte>& binary);
+
+private:
+    struct EntryHeader {
+        EntryType type;
+        u32 size;
+        u64 hash;
+        u64 driver_hash;
+        u64 checksum;
+        GLenum format;
+        u32 padding;
+    };
+    static_assert(sizeof(EntryHeader) == 40, "EntryHeader has unexpected padding");
+
+    struct Location {
+        /// Offset of the entry data in the mapping, or npos for entries added this session
+        std::size_t offset;
+        u32 size;
+        GLenum format;
+        u64 checksum;
+    };
+    using Index = std::unordered_map<u64, Location>;
+
+    /// Maps the file and indexes its entries, returns the size of the valid part of the file
+    std::size_t MapAndIndex();
+    void Unmap();
+
+    const Index& GetIndex(EntryType type) const;
+    Index& GetIndex(EntryType type);
+    const u8* GetData(const Location& location) const;
+    void Append(const EntryHeader& header, const void* data);
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::string path;
+    u64 driver_hash;
+
+    const u8* mapping = nullptr;
+    std::size_t mapping_size = 0;
+#ifdef _WIN32
+    std::vector<u8> contents;
+#endif
+
+    Index code_index;
+    Index program_index;
+    Index stage_index;
+
+    FileUtil::IOFile file;
+};
+
+} // namespace OpenGL
@@ -10,12 +10,21 @@
 #include "common/assert.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/perf_stats.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 
 namespace OpenGL {
 
+MICROPROFILE_DEFINE(OpenGL_ShaderCompile, "OpenGL", "Shader Compile", MP_RGB(192, 64, 128));
+MICROPROFILE_DEFINE(OpenGL_ProgramLink, "OpenGL", "Program Link", MP_RGB(192, 64, 128));
+
 GLuint LoadShader(const char* source, GLenum type) {
+    MICROPROFILE_SCOPE(OpenGL_ShaderCompile);
+    PERF_SCOPE(ShaderCompiles);
+
+    // Desktop drivers only accept compute shaders from GLSL 4.30 on
     const std::string version = GLES ? R"(#version 320 es
 
 #define CITRA_GLES
@@ -28,7 +37,8 @@ GLuint LoadShader(const char* source, GLenum type) {
 #extension GL_EXT_clip_cull_distance : enable
 #endif // defined(GL_EXT_clip_cull_distance)
 )"
-                                     : "#version 330\n";
+                                     : type == GL_COMPUTE_SHADER ? "#version 430 core\n"
+                                                                 : "#version 330\n";
 
     const char* debug_type;
     switch (type) {
@@ -41,6 +51,9 @@ GLuint LoadShader(const char* source, GLenum type) {
     case GL_FRAGMENT_SHADER:
         debug_type = "fragment";
         break;
+    case GL_COMPUTE_SHADER:
+        debug_type = "compute";
+        break;
     default:
         UNREACHABLE();
     }
@@ -81,6 +94,9 @@ GLuint LoadShader(const char* source, GLenum type) {
 }
 
 GLuint LoadProgram(bool separable_program, const std::vector<GLuint>& shaders) {
+    MICROPROFILE_SCOPE(OpenGL_ProgramLink);
+    PERF_SCOPE(ShaderCompiles);
+
     // Link the program
     LOG_DEBUG(Render_OpenGL, "Linking program...");
 
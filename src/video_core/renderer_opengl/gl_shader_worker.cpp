@@ -0,0 +1,176 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+#include "video_core/renderer_opengl/gl_shader_worker.h"
+
+namespace OpenGL {
+
+ShaderWorkerPool::ShaderWorkerPool(const Frontend::EmuWindow& emu_window,
+                                   std::size_t num_workers) {
+    // Contexts are created on the caller thread so that the share group is set up before any
+    // worker starts using it.
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        auto context = emu_window.CreateSharedContext();
+        if (!context) {
+            break;
+        }
+        contexts.push_back(std::move(context));
+    }
+
+    if (contexts.empty()) {
+        LOG_WARNING(Render_OpenGL, "Shared contexts unavailable, shaders compile synchronously");
+        return;
+    }
+
+    for (auto& context : contexts) {
+        workers.emplace_back(&ShaderWorkerPool::WorkerLoop, this, context.get());
+    }
+    LOG_INFO(Render_OpenGL, "Asynchronous shader compilation with {} workers", workers.size());
+}
+
+ShaderWorkerPool::~ShaderWorkerPool() {
+    {
+        std::lock_guard lock{queue_mutex};
+        stop_requested = true;
+        jobs.clear();
+    }
+    queue_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Objects that were never collected are still owned by us
+    for (const auto& result : results) {
+        if (glIsProgram(result.handle)) {
+            glDeleteProgram(result.handle);
+        } else {
+            glDeleteShader(result.handle);
+        }
+    }
+}
+
+void ShaderWorkerPool::QueueStage(u64 hash, std::string code, GLenum type, bool separable,
+                                  bool retrieve_binary) {
+    {
+        std::lock_guard lock{queue_mutex};
+        jobs.push_back({hash, type, std::move(code), {}, separable, retrieve_binary, GL_NONE, {}});
+    }
+    queue_cv.notify_one();
+}
+
+void ShaderWorkerPool::QueueStageBinary(u64 hash, std::string code, GLenum type,
+                                        GLenum binary_format, std::vector<GLbyte> binary) {
+    {
+        std::lock_guard lock{queue_mutex};
+        jobs.push_back(
+            {hash, type, std::move(code), {}, true, true, binary_format, std::move(binary)});
+    }
+    queue_cv.notify_one();
+}
+
+void ShaderWorkerPool::QueueProgram(u64 hash, std::vector<GLuint> shaders, bool retrieve_binary) {
+    {
+        std::lock_guard lock{queue_mutex};
+        jobs.push_back(
+            {hash, GL_NONE, {}, std::move(shaders), false, retrieve_binary, GL_NONE, {}});
+    }
+    queue_cv.notify_one();
+}
+
+std::vector<ShaderWorkerPool::Result> ShaderWorkerPool::PopResults() {
+    std::vector<Result> finished;
+    std::lock_guard lock{result_mutex};
+    finished.swap(results);
+    num_results.store(0, std::memory_order_release);
+    return finished;
+}
+
+static void RetrieveBinary(ShaderWorkerPool::Result& result) {
+    GLint binary_size = 0;
+    glGetProgramiv(result.handle, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+    if (binary_size > 0) {
+        GLsizei length = 0;
+        result.binary.resize(binary_size);
+        glGetProgramBinary(result.handle, binary_size, &length, &result.binary_format,
+                           result.binary.data());
+        result.binary.resize(length);
+    }
+}
+
+static GLuint LoadProgramBinary(GLenum format, const std::vector<GLbyte>& binary) {
+    GLuint handle = glCreateProgram();
+    glProgramBinary(handle, format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint link_status = GL_FALSE;
+    glGetProgramiv(handle, GL_LINK_STATUS, &link_status);
+    if (link_status != GL_TRUE) {
+        glDeleteProgram(handle);
+        return 0;
+    }
+    return handle;
+}
+
+ShaderWorkerPool::Result ShaderWorkerPool::RunJob(const Job& job) {
+    Result result{job.hash, job.type, 0, GL_NONE, {}};
+    if (job.type == GL_NONE) {
+        result.handle = LoadProgram(false, job.shaders);
+        if (job.retrieve_binary) {
+            RetrieveBinary(result);
+        }
+    } else {
+        if (!job.binary.empty()) {
+            result.handle = LoadProgramBinary(job.binary_format, job.binary);
+            if (result.handle == 0) {
+                LOG_DEBUG(Render_OpenGL, "Program binary rejected, compiling stage {:016X}",
+                          job.hash);
+            }
+        }
+        if (result.handle == 0) {
+            GLuint shader = LoadShader(job.code.c_str(), job.type);
+            if (job.separable) {
+                result.handle = LoadProgram(true, {shader});
+                glDeleteShader(shader);
+                if (job.retrieve_binary) {
+                    RetrieveBinary(result);
+                }
+            } else {
+                result.handle = shader;
+            }
+        }
+    }
+    // The main context may only use the object once the driver has fully built it
+    glFinish();
+    return result;
+}
+
+void ShaderWorkerPool::WorkerLoop(Frontend::GraphicsContext* context) {
+    Common::SetCurrentThreadName("ShaderWorker");
+    context->MakeCurrent();
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock{queue_mutex};
+            queue_cv.wait(lock, [this] { return stop_requested || !jobs.empty(); });
+            if (stop_requested) {
+                break;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        Result result = RunJob(job);
+
+        std::lock_guard lock{result_mutex};
+        results.push_back(std::move(result));
+        num_results.store(results.size(), std::memory_order_release);
+    }
+
+    context->DoneCurrent();
+}
+
+} // namespace OpenGL
@@ -0,0 +1,101 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+
+namespace Frontend {
+class EmuWindow;
+class GraphicsContext;
+} // namespace Frontend
+
+namespace OpenGL {
+
+/**
+ * A pool of threads, each owning a graphics context shared with the main one, that compiles and
+ * links GLSL programs away from the emulation thread. Finished objects are handed back through
+ * PopResults and must be adopted by the caller on the main context.
+ */
+class ShaderWorkerPool {
+public:
+    struct Result {
+        u64 hash;
+        /// Shader stage type, or GL_NONE for a linked program
+        GLenum type;
+        GLuint handle;
+        GLenum binary_format;
+        std::vector<GLbyte> binary;
+    };
+
+    ShaderWorkerPool(const Frontend::EmuWindow& emu_window, std::size_t num_workers);
+    ~ShaderWorkerPool();
+
+    /// Returns true if at least one worker owns a shared context
+    bool IsEnabled() const {
+        return !workers.empty();
+    }
+
+    /**
+     * Queues a single shader stage. In separable mode the result is a program object with the
+     * stage attached, otherwise it is a bare shader object.
+     */
+    void QueueStage(u64 hash, std::string code, GLenum type, bool separable, bool retrieve_binary);
+
+    /**
+     * Queues the load of a separable stage from a program binary. The code is compiled instead if
+     * the driver rejects the binary, in which case the result carries the new binary.
+     */
+    void QueueStageBinary(u64 hash, std::string code, GLenum type, GLenum binary_format,
+                          std::vector<GLbyte> binary);
+
+    /// Queues the link of a non-separable program made of already compiled shader objects
+    void QueueProgram(u64 hash, std::vector<GLuint> shaders, bool retrieve_binary);
+
+    /// Returns true if there are finished objects waiting to be collected
+    bool HasResults() const {
+        return num_results.load(std::memory_order_acquire) != 0;
+    }
+
+    /// Collects the objects finished since the last call
+    std::vector<Result> PopResults();
+
+private:
+    struct Job {
+        u64 hash;
+        GLenum type;
+        std::string code;
+        std::vector<GLuint> shaders;
+        bool separable;
+        bool retrieve_binary;
+        GLenum binary_format;
+        std::vector<GLbyte> binary;
+    };
+
+    void WorkerLoop(Frontend::GraphicsContext* context);
+    static Result RunJob(const Job& job);
+
+    std::vector<std::unique_ptr<Frontend::GraphicsContext>> contexts;
+    std::vector<std::thread> workers;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Job> jobs;
+    bool stop_requested = false;
+
+    std::mutex result_mutex;
+    std::vector<Result> results;
+    std::atomic<std::size_t> num_results{0};
+};
+
+} // namespace OpenGL
@@ -0,0 +1,94 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include "common/scope_exit.h"
+#include "video_core/renderer_opengl/gl_shader_util.h"
+#include "video_core/renderer_opengl/gl_shadow_depth_buffer.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL {
+
+static const char vertex_shader[] = R"(
+void main() {
+    vec2 rawpos = vec2(gl_VertexID & 1, (gl_VertexID & 2) >> 1);
+    gl_Position = vec4(rawpos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// A shadow map pixel holds the intensity in the red channel and the depth in the others, in the
+// same layout the image load/store path reads as r32ui
+static const char fragment_shader[] = R"(
+uniform sampler2D shadow_map;
+void main() {
+    uvec4 texel = uvec4(texelFetch(shadow_map, ivec2(gl_FragCoord.xy), 0) * 255.0 + 0.5);
+    uint depth = texel.g | (texel.b << 8) | (texel.a << 16);
+    gl_FragDepth = float(depth) / (exp2(24.0) - 1.0);
+}
+)";
+
+ShadowDepthBuffer::ShadowDepthBuffer() = default;
+
+ShadowDepthBuffer::~ShadowDepthBuffer() = default;
+
+GLuint ShadowDepthBuffer::Load(GLuint shadow_map, u64 modification_id, GLsizei width,
+                               GLsizei height) {
+    if (program.handle == 0) {
+        CreateProgram();
+    }
+
+    if (this->width != width || this->height != height) {
+        this->width = width;
+        this->height = height;
+        texture.Release();
+        texture.Create();
+        GLuint old_tex = OpenGLState::BindTexture2D(0, texture.handle);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT,
+                     GL_UNSIGNED_INT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        OpenGLState::BindTexture2D(0, old_tex);
+
+        GLuint old_fb = OpenGLState::BindDrawFramebuffer(framebuffer.handle);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                               texture.handle, 0);
+        OpenGLState::BindDrawFramebuffer(old_fb);
+        loaded_shadow_map = 0;
+    }
+
+    if (loaded_shadow_map == shadow_map && loaded_id == modification_id) {
+        return texture.handle;
+    }
+    loaded_shadow_map = shadow_map;
+    loaded_id = modification_id;
+
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    SCOPE_EXIT({ prev_state.Apply(); });
+
+    OpenGLState state;
+    state.texture_units[0].texture_2d = shadow_map;
+    state.draw.draw_framebuffer = framebuffer.handle;
+    state.draw.shader_program = program.handle;
+    state.draw.vertex_array = vao.handle;
+    state.depth.test_enabled = true;
+    state.depth.test_func = GL_ALWAYS;
+    state.viewport = {0, 0, width, height};
+    state.Apply();
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    return texture.handle;
+}
+
+void ShadowDepthBuffer::CreateProgram() {
+    std::string frag_source;
+    if (GLES) {
+        frag_source += fragment_shader_precision_OES;
+    }
+    frag_source += fragment_shader;
+    program.Create(vertex_shader, frag_source.c_str());
+    vao.Create();
+    framebuffer.Create();
+}
+
+} // namespace OpenGL
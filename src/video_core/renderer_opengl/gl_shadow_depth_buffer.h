@@ -0,0 +1,48 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace OpenGL {
+
+/**
+ * Depth buffer shadow map draws test against when they are rendered with blending instead of
+ * image atomics. The shadow map itself stays in the PICA format, its depth is copied into the
+ * buffer when another shadow map is drawn to, or the shadow map changed since the last draw.
+ */
+class ShadowDepthBuffer : NonCopyable {
+public:
+    ShadowDepthBuffer();
+    ~ShadowDepthBuffer();
+
+    /**
+     * Makes the buffer hold the depth of the shadow map
+     * @param modification_id Modification id of the shadow map surface
+     * @returns The depth texture to attach
+     */
+    GLuint Load(GLuint shadow_map, u64 modification_id, GLsizei width, GLsizei height);
+
+    /// Marks the buffer as matching the shadow map after a draw changed both
+    void SetModificationId(u64 modification_id) {
+        loaded_id = modification_id;
+    }
+
+private:
+    void CreateProgram();
+
+    OGLTexture texture;
+    OGLFramebuffer framebuffer;
+    OGLProgram program;
+    OGLVertexArray vao;
+    GLsizei width = 0;
+    GLsizei height = 0;
+    GLuint loaded_shadow_map = 0;
+    u64 loaded_id = 0;
+};
+
+} // namespace OpenGL
@@ -0,0 +1,92 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "video_core/renderer_opengl/gl_staging_buffer_pool.h"
+
+namespace OpenGL {
+
+StagingBufferPool::Buffer::Buffer(Buffer&& other) noexcept
+    : pool(std::exchange(other.pool, nullptr)), memory(std::move(other.memory)) {}
+
+StagingBufferPool::Buffer& StagingBufferPool::Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        Release();
+        pool = std::exchange(other.pool, nullptr);
+        memory = std::move(other.memory);
+    }
+    return *this;
+}
+
+StagingBufferPool::Buffer::~Buffer() {
+    Release();
+}
+
+void StagingBufferPool::Buffer::Release() {
+    if (pool != nullptr) {
+        std::exchange(pool, nullptr)->Return(std::move(memory));
+    }
+    memory = {};
+}
+
+StagingBufferPool::~StagingBufferPool() = default;
+
+StagingBufferPool::Buffer StagingBufferPool::Acquire(std::size_t size) {
+    Buffer buffer;
+    buffer.pool = this;
+
+    // The smallest free buffer that fits, growing one would reallocate it anyway
+    auto best = free_buffers.end();
+    for (auto it = free_buffers.begin(); it != free_buffers.end(); ++it) {
+        if (it->memory.capacity() >= size &&
+            (best == free_buffers.end() || it->memory.capacity() < best->memory.capacity())) {
+            best = it;
+        }
+    }
+    if (best != free_buffers.end()) {
+        pooled_bytes -= best->memory.capacity();
+        buffer.memory = std::move(best->memory);
+        free_buffers.erase(best);
+    }
+    buffer.memory.resize(size);
+    return buffer;
+}
+
+void StagingBufferPool::Return(std::vector<u8> memory) {
+    if (memory.capacity() == 0) {
+        return;
+    }
+    pooled_bytes += memory.capacity();
+    free_buffers.push_back({std::move(memory), current_frame});
+}
+
+void StagingBufferPool::EndFrame() {
+    ++current_frame;
+
+    const auto is_idle = [this](const FreeBuffer& buffer) {
+        return current_frame - buffer.last_used_frame > MAX_IDLE_FRAMES;
+    };
+    for (const auto& buffer : free_buffers) {
+        if (is_idle(buffer)) {
+            pooled_bytes -= buffer.memory.capacity();
+        }
+    }
+    free_buffers.erase(std::remove_if(free_buffers.begin(), free_buffers.end(), is_idle),
+                       free_buffers.end());
+
+    // Past the limit the largest buffers go first, the common small surfaces keep theirs
+    if (pooled_bytes > MAX_POOLED_BYTES) {
+        std::sort(free_buffers.begin(), free_buffers.end(),
+                  [](const FreeBuffer& a, const FreeBuffer& b) {
+                      return a.memory.capacity() < b.memory.capacity();
+                  });
+        while (pooled_bytes > MAX_POOLED_BYTES) {
+            pooled_bytes -= free_buffers.back().memory.capacity();
+            free_buffers.pop_back();
+        }
+    }
+}
+
+} // namespace OpenGL
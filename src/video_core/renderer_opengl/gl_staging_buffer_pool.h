@@ -0,0 +1,93 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+
+namespace OpenGL {
+
+/**
+ * CPU side memory that surfaces hold while they move data between 3DS memory and their texture.
+ * A surface borrows a buffer for one load and upload, or one download and flush, and gives it back
+ * right after, so the cache keeps a few buffers around rather than a copy of every surface.
+ */
+class StagingBufferPool : NonCopyable {
+public:
+    /// A borrowed buffer, it goes back to the pool when released or destroyed
+    class Buffer {
+    public:
+        Buffer() = default;
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+        ~Buffer();
+
+        /// Gives the memory back to the pool, the buffer is empty afterwards
+        void Release();
+
+        bool empty() const {
+            return pool == nullptr;
+        }
+
+        std::size_t size() const {
+            return memory.size();
+        }
+
+        u8* data() {
+            return memory.data();
+        }
+
+        const u8* data() const {
+            return memory.data();
+        }
+
+        u8& operator[](std::size_t i) {
+            return memory[i];
+        }
+
+        const u8& operator[](std::size_t i) const {
+            return memory[i];
+        }
+
+    private:
+        friend class StagingBufferPool;
+
+        StagingBufferPool* pool = nullptr;
+        std::vector<u8> memory;
+    };
+
+    ~StagingBufferPool();
+
+    /// Returns a buffer of size bytes, its contents are undefined
+    Buffer Acquire(std::size_t size);
+
+    /// Frees the buffers that went unused for a while, or that exceed the memory kept around
+    void EndFrame();
+
+    /// Returns the bytes held by buffers nobody borrowed
+    std::size_t GetPooledBytes() const {
+        return pooled_bytes;
+    }
+
+    /// Frames a returned buffer is kept for without being borrowed again
+    static constexpr u32 MAX_IDLE_FRAMES = 120;
+    /// Bytes of returned buffers kept around at most
+    static constexpr std::size_t MAX_POOLED_BYTES = 32 * 1024 * 1024;
+
+private:
+    struct FreeBuffer {
+        std::vector<u8> memory;
+        u32 last_used_frame;
+    };
+
+    void Return(std::vector<u8> memory);
+
+    std::vector<FreeBuffer> free_buffers;
+    std::size_t pooled_bytes = 0;
+    u32 current_frame = 0;
+};
+
+} // namespace OpenGL
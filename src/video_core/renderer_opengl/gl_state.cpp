@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <utility>
 #include <glad/glad.h>
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
@@ -11,6 +13,9 @@
 namespace OpenGL {
 
 OpenGLState OpenGLState::cur_state;
+bool OpenGLState::cur_state_valid = false;
+u32 OpenGLState::saved_calls = 0;
+u32 OpenGLState::applied_calls = 0;
 
 OpenGLState::OpenGLState() {
     // These all match default OpenGL values
@@ -93,50 +98,76 @@ OpenGLState::OpenGLState() {
     renderbuffer = 0;
 }
 
+bool OpenGLState::NeedsApply(bool changed, u32 calls) {
+    if (changed) {
+        applied_calls += calls;
+    } else {
+        saved_calls += calls;
+    }
+    return changed;
+}
+
 void OpenGLState::Apply() const {
+    // Every state is applied once after the shadow state got out of sync with the context
+    const bool force = !cur_state_valid;
+    const OpenGLState& cur = cur_state;
+
     // Culling
-    if (cull.enabled) {
-        glEnable(GL_CULL_FACE);
-    } else {
-        glDisable(GL_CULL_FACE);
+    if (NeedsApply(force || cull.enabled != cur.cull.enabled)) {
+        if (cull.enabled) {
+            glEnable(GL_CULL_FACE);
+        } else {
+            glDisable(GL_CULL_FACE);
+        }
     }
 
-    glCullFace(cull.mode);
+    if (NeedsApply(force || cull.mode != cur.cull.mode)) {
+        glCullFace(cull.mode);
+    }
 
-    glFrontFace(cull.front_face);
+    if (NeedsApply(force || cull.front_face != cur.cull.front_face)) {
+        glFrontFace(cull.front_face);
+    }
 
     // Depth test
-    if (depth.test_enabled) {
-        glEnable(GL_DEPTH_TEST);
-    } else {
-        glDisable(GL_DEPTH_TEST);
+    if (NeedsApply(force || depth.test_enabled != cur.depth.test_enabled)) {
+        if (depth.test_enabled) {
+            glEnable(GL_DEPTH_TEST);
+        } else {
+            glDisable(GL_DEPTH_TEST);
+        }
     }
 
-    glDepthFunc(depth.test_func);
-
-    // Depth mask
-    glDepthMask(depth.write_mask);
+    if (NeedsApply(force || depth.test_func != cur.depth.test_func)) {
+        glDepthFunc(depth.test_func);
+    }
 
-    // Color mask
-    glColorMask(color_mask.red_enabled, color_mask.green_enabled, color_mask.blue_enabled,
-                color_mask.alpha_enabled);
+    ApplyMasks(force);
 
     // Stencil test
-    if (stencil.test_enabled) {
-        glEnable(GL_STENCIL_TEST);
-    } else {
-        glDisable(GL_STENCIL_TEST);
+    if (NeedsApply(force || stencil.test_enabled != cur.stencil.test_enabled)) {
+        if (stencil.test_enabled) {
+            glEnable(GL_STENCIL_TEST);
+        } else {
+            glDisable(GL_STENCIL_TEST);
+        }
     }
 
-    glStencilFunc(stencil.test_func, stencil.test_ref, stencil.test_mask);
-
-    glStencilOp(stencil.action_stencil_fail, stencil.action_depth_fail, stencil.action_depth_pass);
+    if (NeedsApply(force || stencil.test_func != cur.stencil.test_func ||
+                   stencil.test_ref != cur.stencil.test_ref ||
+                   stencil.test_mask != cur.stencil.test_mask)) {
+        glStencilFunc(stencil.test_func, stencil.test_ref, stencil.test_mask);
+    }
 
-    // Stencil mask
-    glStencilMask(stencil.write_mask);
+    if (NeedsApply(force || stencil.action_stencil_fail != cur.stencil.action_stencil_fail ||
+                   stencil.action_depth_fail != cur.stencil.action_depth_fail ||
+                   stencil.action_depth_pass != cur.stencil.action_depth_pass)) {
+        glStencilOp(stencil.action_stencil_fail, stencil.action_depth_fail,
+                    stencil.action_depth_pass);
+    }
 
     // Blending
-    if (blend.enabled != cur_state.blend.enabled) {
+    if (NeedsApply(force || blend.enabled != cur.blend.enabled)) {
         if (blend.enabled) {
             glEnable(GL_BLEND);
         } else {
@@ -153,143 +184,162 @@ void OpenGLState::Apply() const {
         }
     }
 
-    glBlendColor(blend.color.red, blend.color.green, blend.color.blue, blend.color.alpha);
+    if (NeedsApply(force || blend.color.red != cur.blend.color.red ||
+                   blend.color.green != cur.blend.color.green ||
+                   blend.color.blue != cur.blend.color.blue ||
+                   blend.color.alpha != cur.blend.color.alpha)) {
+        glBlendColor(blend.color.red, blend.color.green, blend.color.blue, blend.color.alpha);
+    }
 
-    glBlendFuncSeparate(blend.src_rgb_func, blend.dst_rgb_func, blend.src_a_func, blend.dst_a_func);
+    if (NeedsApply(force || blend.src_rgb_func != cur.blend.src_rgb_func ||
+                   blend.dst_rgb_func != cur.blend.dst_rgb_func ||
+                   blend.src_a_func != cur.blend.src_a_func ||
+                   blend.dst_a_func != cur.blend.dst_a_func)) {
+        glBlendFuncSeparate(blend.src_rgb_func, blend.dst_rgb_func, blend.src_a_func,
+                            blend.dst_a_func);
+    }
 
-    glBlendEquationSeparate(blend.rgb_equation, blend.a_equation);
+    if (NeedsApply(force || blend.rgb_equation != cur.blend.rgb_equation ||
+                   blend.a_equation != cur.blend.a_equation)) {
+        glBlendEquationSeparate(blend.rgb_equation, blend.a_equation);
+    }
 
     // GLES does not support glLogicOp
     if (!GLES) {
-        if (logic_op != cur_state.logic_op) {
+        if (NeedsApply(force || logic_op != cur.logic_op)) {
             glLogicOp(logic_op);
         }
     }
 
-    // Textures
-    for (unsigned i = 0; i < ARRAY_SIZE(texture_units); ++i) {
-        if (texture_units[i].texture_2d != cur_state.texture_units[i].texture_2d) {
-            glActiveTexture(TextureUnits::PicaTexture(i).Enum());
-            glBindTexture(GL_TEXTURE_2D, texture_units[i].texture_2d);
-        }
-        if (texture_units[i].sampler != cur_state.texture_units[i].sampler) {
-            glBindSampler(i, texture_units[i].sampler);
+    // Textures, the units are compared at once since most draws keep all of them
+    if (force || std::memcmp(texture_units, cur.texture_units, sizeof(texture_units)) != 0) {
+        for (unsigned i = 0; i < ARRAY_SIZE(texture_units); ++i) {
+            if (NeedsApply(force || texture_units[i].texture_2d != cur.texture_units[i].texture_2d,
+                           2)) {
+                glActiveTexture(TextureUnits::PicaTexture(i).Enum());
+                glBindTexture(GL_TEXTURE_2D, texture_units[i].texture_2d);
+            }
+            if (NeedsApply(force || texture_units[i].sampler != cur.texture_units[i].sampler)) {
+                glBindSampler(i, texture_units[i].sampler);
+            }
         }
+    } else {
+        saved_calls += 3 * ARRAY_SIZE(texture_units);
     }
 
-    if (texture_cube_unit.texture_cube != cur_state.texture_cube_unit.texture_cube) {
+    if (NeedsApply(force || texture_cube_unit.texture_cube != cur.texture_cube_unit.texture_cube,
+                   2)) {
         glActiveTexture(TextureUnits::TextureCube.Enum());
         glBindTexture(GL_TEXTURE_CUBE_MAP, texture_cube_unit.texture_cube);
     }
-    if (texture_cube_unit.sampler != cur_state.texture_cube_unit.sampler) {
+    if (NeedsApply(force || texture_cube_unit.sampler != cur.texture_cube_unit.sampler)) {
         glBindSampler(TextureUnits::TextureCube.id, texture_cube_unit.sampler);
     }
 
     // Texture buffer LUTs
-    if (texture_buffer_lut_lf.texture_buffer != cur_state.texture_buffer_lut_lf.texture_buffer) {
+    if (NeedsApply(force || texture_buffer_lut_lf.texture_buffer !=
+                                cur.texture_buffer_lut_lf.texture_buffer,
+                   2)) {
         glActiveTexture(TextureUnits::TextureBufferLUT_LF.Enum());
         glBindTexture(GL_TEXTURE_BUFFER, texture_buffer_lut_lf.texture_buffer);
     }
 
     // Texture buffer LUTs
-    if (texture_buffer_lut_rg.texture_buffer != cur_state.texture_buffer_lut_rg.texture_buffer) {
+    if (NeedsApply(force || texture_buffer_lut_rg.texture_buffer !=
+                                cur.texture_buffer_lut_rg.texture_buffer,
+                   2)) {
         glActiveTexture(TextureUnits::TextureBufferLUT_RG.Enum());
         glBindTexture(GL_TEXTURE_BUFFER, texture_buffer_lut_rg.texture_buffer);
     }
 
     // Texture buffer LUTs
-    if (texture_buffer_lut_rgba.texture_buffer !=
-        cur_state.texture_buffer_lut_rgba.texture_buffer) {
+    if (NeedsApply(force || texture_buffer_lut_rgba.texture_buffer !=
+                                cur.texture_buffer_lut_rgba.texture_buffer,
+                   2)) {
         glActiveTexture(TextureUnits::TextureBufferLUT_RGBA.Enum());
         glBindTexture(GL_TEXTURE_BUFFER, texture_buffer_lut_rgba.texture_buffer);
     }
 
     // Shadow Images
-    if (AllowShadow) {
-        if (image_shadow_buffer != cur_state.image_shadow_buffer) {
+    if (AllowShadow && !ShadowBlending) {
+        if (NeedsApply(force || image_shadow_buffer != cur.image_shadow_buffer)) {
             glBindImageTexture(ImageUnits::ShadowBuffer, image_shadow_buffer, 0, GL_FALSE, 0,
                                GL_READ_WRITE, GL_R32UI);
         }
 
-        if (image_shadow_texture_px != cur_state.image_shadow_texture_px) {
+        if (NeedsApply(force || image_shadow_texture_px != cur.image_shadow_texture_px)) {
             glBindImageTexture(ImageUnits::ShadowTexturePX, image_shadow_texture_px, 0, GL_FALSE, 0,
                                GL_READ_ONLY, GL_R32UI);
         }
 
-        if (image_shadow_texture_nx != cur_state.image_shadow_texture_nx) {
+        if (NeedsApply(force || image_shadow_texture_nx != cur.image_shadow_texture_nx)) {
             glBindImageTexture(ImageUnits::ShadowTextureNX, image_shadow_texture_nx, 0, GL_FALSE, 0,
                                GL_READ_ONLY, GL_R32UI);
         }
 
-        if (image_shadow_texture_py != cur_state.image_shadow_texture_py) {
+        if (NeedsApply(force || image_shadow_texture_py != cur.image_shadow_texture_py)) {
             glBindImageTexture(ImageUnits::ShadowTexturePY, image_shadow_texture_py, 0, GL_FALSE, 0,
                                GL_READ_ONLY, GL_R32UI);
         }
 
-        if (image_shadow_texture_ny != cur_state.image_shadow_texture_ny) {
+        if (NeedsApply(force || image_shadow_texture_ny != cur.image_shadow_texture_ny)) {
             glBindImageTexture(ImageUnits::ShadowTextureNY, image_shadow_texture_ny, 0, GL_FALSE, 0,
                                GL_READ_ONLY, GL_R32UI);
         }
 
-        if (image_shadow_texture_pz != cur_state.image_shadow_texture_pz) {
+        if (NeedsApply(force || image_shadow_texture_pz != cur.image_shadow_texture_pz)) {
             glBindImageTexture(ImageUnits::ShadowTexturePZ, image_shadow_texture_pz, 0, GL_FALSE, 0,
                                GL_READ_ONLY, GL_R32UI);
         }
 
-        if (image_shadow_texture_nz != cur_state.image_shadow_texture_nz) {
+        if (NeedsApply(force || image_shadow_texture_nz != cur.image_shadow_texture_nz)) {
             glBindImageTexture(ImageUnits::ShadowTextureNZ, image_shadow_texture_nz, 0, GL_FALSE, 0,
                                GL_READ_ONLY, GL_R32UI);
         }
     }
 
-    // Framebuffer
-    if (draw.read_framebuffer != cur_state.draw.read_framebuffer) {
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, draw.read_framebuffer);
-    }
-    if (draw.draw_framebuffer != cur_state.draw.draw_framebuffer) {
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw.draw_framebuffer);
-    }
-
-    // Vertex array
-    if (draw.vertex_array != cur_state.draw.vertex_array) {
-        glBindVertexArray(draw.vertex_array);
-    }
+    ApplyFramebuffers(force);
 
-    // Vertex buffer
-    if (draw.vertex_buffer != cur_state.draw.vertex_buffer) {
-        glBindBuffer(GL_ARRAY_BUFFER, draw.vertex_buffer);
-    }
+    // Buffers and programs
+    if (force || draw.vertex_array != cur.draw.vertex_array ||
+        draw.vertex_buffer != cur.draw.vertex_buffer ||
+        draw.uniform_buffer != cur.draw.uniform_buffer ||
+        draw.shader_program != cur.draw.shader_program ||
+        draw.program_pipeline != cur.draw.program_pipeline) {
+        // Vertex array
+        if (NeedsApply(force || draw.vertex_array != cur.draw.vertex_array)) {
+            glBindVertexArray(draw.vertex_array);
+        }
 
-    // Uniform buffer
-    if (draw.uniform_buffer != cur_state.draw.uniform_buffer) {
-        glBindBuffer(GL_UNIFORM_BUFFER, draw.uniform_buffer);
-    }
+        // Vertex buffer
+        if (NeedsApply(force || draw.vertex_buffer != cur.draw.vertex_buffer)) {
+            glBindBuffer(GL_ARRAY_BUFFER, draw.vertex_buffer);
+        }
 
-    // Shader program
-    if (draw.shader_program != cur_state.draw.shader_program) {
-        glUseProgram(draw.shader_program);
-    }
+        // Uniform buffer
+        if (NeedsApply(force || draw.uniform_buffer != cur.draw.uniform_buffer)) {
+            glBindBuffer(GL_UNIFORM_BUFFER, draw.uniform_buffer);
+        }
 
-    // Program pipeline
-    if (draw.program_pipeline != cur_state.draw.program_pipeline) {
-        glBindProgramPipeline(draw.program_pipeline);
-    }
+        // Shader program
+        if (NeedsApply(force || draw.shader_program != cur.draw.shader_program)) {
+            glUseProgram(draw.shader_program);
+        }
 
-    // Scissor test
-    if (scissor.enabled) {
-        glEnable(GL_SCISSOR_TEST);
+        // Program pipeline
+        if (NeedsApply(force || draw.program_pipeline != cur.draw.program_pipeline)) {
+            glBindProgramPipeline(draw.program_pipeline);
+        }
     } else {
-        glDisable(GL_SCISSOR_TEST);
+        saved_calls += 5;
     }
 
-    glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
-
-    glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+    ApplyScissorViewport(force);
 
     // Clip distance
     if (!GLES || GLAD_GL_EXT_clip_cull_distance) {
         for (size_t i = 0; i < clip_distance.size(); ++i) {
-            if (clip_distance[i] != cur_state.clip_distance[i]) {
+            if (NeedsApply(force || clip_distance[i] != cur.clip_distance[i])) {
                 if (clip_distance[i]) {
                     glEnable(GL_CLIP_DISTANCE0 + static_cast<GLenum>(i));
                 } else {
@@ -300,39 +350,93 @@ void OpenGLState::Apply() const {
     }
 
     cur_state = *this;
+    cur_state_valid = true;
 }
 
 void OpenGLState::SubApply() const {
+    const bool force = !cur_state_valid;
+    ApplyMasks(force);
+    ApplyFramebuffers(force);
+    ApplyScissorViewport(force);
+
+    // The other states weren't applied, the shadow state keeps them
+    cur_state.depth.write_mask = depth.write_mask;
+    cur_state.stencil.write_mask = stencil.write_mask;
+    cur_state.color_mask = color_mask;
+    cur_state.draw.read_framebuffer = draw.read_framebuffer;
+    cur_state.draw.draw_framebuffer = draw.draw_framebuffer;
+    cur_state.scissor = scissor;
+    cur_state.viewport = viewport;
+}
+
+void OpenGLState::ApplyMasks(bool force) const {
+    const OpenGLState& cur = cur_state;
+
     // Depth mask
-    glDepthMask(depth.write_mask);
+    if (NeedsApply(force || depth.write_mask != cur.depth.write_mask)) {
+        glDepthMask(depth.write_mask);
+    }
 
     // Stencil mask
-    glStencilMask(stencil.write_mask);
+    if (NeedsApply(force || stencil.write_mask != cur.stencil.write_mask)) {
+        glStencilMask(stencil.write_mask);
+    }
 
     // Color mask
-    glColorMask(color_mask.red_enabled, color_mask.green_enabled, color_mask.blue_enabled,
-                color_mask.alpha_enabled);
+    if (NeedsApply(force || color_mask.red_enabled != cur.color_mask.red_enabled ||
+                   color_mask.green_enabled != cur.color_mask.green_enabled ||
+                   color_mask.blue_enabled != cur.color_mask.blue_enabled ||
+                   color_mask.alpha_enabled != cur.color_mask.alpha_enabled)) {
+        glColorMask(color_mask.red_enabled, color_mask.green_enabled, color_mask.blue_enabled,
+                    color_mask.alpha_enabled);
+    }
+}
 
+void OpenGLState::ApplyFramebuffers(bool force) const {
     // Framebuffer
-    if (draw.read_framebuffer != cur_state.draw.read_framebuffer) {
+    if (NeedsApply(force || draw.read_framebuffer != cur_state.draw.read_framebuffer)) {
         glBindFramebuffer(GL_READ_FRAMEBUFFER, draw.read_framebuffer);
     }
-    if (draw.draw_framebuffer != cur_state.draw.draw_framebuffer) {
+    if (NeedsApply(force || draw.draw_framebuffer != cur_state.draw.draw_framebuffer)) {
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw.draw_framebuffer);
     }
+}
+
+void OpenGLState::ApplyScissorViewport(bool force) const {
+    const OpenGLState& cur = cur_state;
 
     // Scissor test
-    if (scissor.enabled) {
-        glEnable(GL_SCISSOR_TEST);
-    } else {
-        glDisable(GL_SCISSOR_TEST);
+    if (NeedsApply(force || scissor.enabled != cur.scissor.enabled)) {
+        if (scissor.enabled) {
+            glEnable(GL_SCISSOR_TEST);
+        } else {
+            glDisable(GL_SCISSOR_TEST);
+        }
     }
 
-    glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
+    if (NeedsApply(force || scissor.x != cur.scissor.x || scissor.y != cur.scissor.y ||
+                   scissor.width != cur.scissor.width || scissor.height != cur.scissor.height)) {
+        glScissor(scissor.x, scissor.y, scissor.width, scissor.height);
+    }
 
-    glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+    if (NeedsApply(force || viewport.x != cur.viewport.x || viewport.y != cur.viewport.y ||
+                   viewport.width != cur.viewport.width ||
+                   viewport.height != cur.viewport.height)) {
+        glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+    }
+}
 
-    cur_state = *this;
+void OpenGLState::Invalidate() {
+    cur_state = OpenGLState();
+    cur_state_valid = false;
+}
+
+u32 OpenGLState::TakeSavedCalls() {
+    return std::exchange(saved_calls, 0);
+}
+
+u32 OpenGLState::TakeAppliedCalls() {
+    return std::exchange(applied_calls, 0);
 }
 
 GLuint OpenGLState::BindVertexArray(GLuint array) {
@@ -422,7 +526,7 @@ void OpenGLState::ResetTexture(GLuint handle) {
         glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
     }
 
-    if (AllowShadow) {
+    if (AllowShadow && !ShadowBlending) {
         if (cur_state.image_shadow_buffer == handle) {
             cur_state.image_shadow_buffer = 0;
             glBindImageTexture(ImageUnits::ShadowBuffer, 0, 0, GL_FALSE, 0, GL_READ_WRITE,
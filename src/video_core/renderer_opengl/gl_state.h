@@ -6,6 +6,7 @@
 
 #include <array>
 #include <glad/glad.h>
+#include "common/common_types.h"
 
 namespace OpenGL {
 
@@ -161,8 +162,18 @@ public:
     /// Apply this state as the current OpenGL state
     void Apply() const;
 
+    /// Apply only the masks, framebuffers, scissor and viewport of this state
     void SubApply() const;
 
+    /// Makes the next Apply set every state, for a new context the shadow state doesn't match
+    static void Invalidate();
+
+    /// Returns the number of GL calls skipped since the last call, as their state was current
+    static u32 TakeSavedCalls();
+
+    /// Returns the number of GL calls made since the last call, as their state changed
+    static u32 TakeAppliedCalls();
+
     /// apply directly
     static GLuint BindVertexArray(GLuint array);
     static GLuint BindVertexBuffer(GLuint buffer);
@@ -186,7 +197,19 @@ public:
     static void ResetRenderbuffer(GLuint handle);
 
 private:
+    /// Returns whether a state changed, and counts the GL calls that applying it makes or saves
+    static bool NeedsApply(bool changed, u32 calls = 1);
+
+    void ApplyMasks(bool force) const;
+    void ApplyFramebuffers(bool force) const;
+    void ApplyScissorViewport(bool force) const;
+
+    /// Shadow copy of the state of the context
     static OpenGLState cur_state;
+    /// Cleared when cur_state can't be trusted, until the next Apply
+    static bool cur_state_valid;
+    static u32 saved_calls;
+    static u32 applied_calls;
 };
 
 } // namespace OpenGL
@@ -2,9 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 #include "common/alignment.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "core/settings.h"
 #include "video_core/renderer_opengl/gl_state.h"
@@ -15,12 +17,40 @@ namespace OpenGL {
 OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size) : gl_target(target), buffer_size(size) {
     gl_buffer.Create();
     glBindBuffer(gl_target, gl_buffer.handle);
+    gl_target_invalidate_hack = Settings::values.stream_buffer_hack ? GL_TEXTURE_BUFFER : 0;
+
+    if (GLAD_GL_ARB_buffer_storage || GLAD_GL_EXT_buffer_storage) {
+        // A coherent mapping that stays valid for the lifetime of the buffer, reuse of its memory
+        // is synchronized with fences instead of having the driver orphan it
+        segment_size = static_cast<GLsizeiptr>(
+            Common::AlignUp<std::size_t>(buffer_size, NUM_SEGMENTS) / NUM_SEGMENTS);
+        buffer_size = segment_size * NUM_SEGMENTS;
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        if (GLAD_GL_ARB_buffer_storage) {
+            glBufferStorage(gl_target, buffer_size, nullptr, flags);
+        } else {
+            glBufferStorageEXT(gl_target, buffer_size, nullptr, flags);
+        }
+        persistent_ptr = static_cast<u8*>(glMapBufferRange(gl_target, 0, buffer_size, flags));
+        if (persistent_ptr != nullptr) {
+            return;
+        }
+        LOG_WARNING(Render_OpenGL, "Persistent mapping failed, falling back to buffer orphaning");
+        gl_buffer.Release();
+        gl_buffer.Create();
+        glBindBuffer(gl_target, gl_buffer.handle);
+    }
+
     // prefer `glBufferData` than `glBufferStorage` on mobile device
     glBufferData(gl_target, buffer_size, nullptr, GL_STREAM_DRAW);
-    gl_target_invalidate_hack = Settings::values.stream_buffer_hack ? GL_TEXTURE_BUFFER : 0;
 }
 
 OGLStreamBuffer::~OGLStreamBuffer() {
+    for (GLsync fence : fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
     gl_buffer.Release();
 }
 
@@ -36,8 +66,27 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
     bool invalidate = false;
 
     buffer_pos = Common::AlignUp<std::size_t>(buffer_pos, alignment);
+    if (persistent_ptr != nullptr) {
+        if (buffer_pos + size > buffer_size) {
+            FenceSegments(current_segment, NUM_SEGMENTS);
+            current_segment = 0;
+            buffer_pos = 0;
+            ++wrap_count;
+            invalidate = true;
+        }
+
+        // Segments left behind were read by the draws issued since they were written
+        const std::size_t begin_segment = GetSegment(buffer_pos);
+        const std::size_t end_segment = GetSegment(buffer_pos + std::max<GLsizeiptr>(size, 1) - 1);
+        FenceSegments(current_segment, begin_segment);
+        WaitSegments(begin_segment, end_segment + 1);
+        current_segment = end_segment;
+        return std::make_tuple(persistent_ptr + buffer_pos, buffer_pos, invalidate);
+    }
+
     if (buffer_pos + size > buffer_size) {
         buffer_pos = 0;
+        ++wrap_count;
         if (gl_target_invalidate_hack == 0 || gl_target == gl_target_invalidate_hack) {
             invalidate = true;
         }
@@ -50,6 +99,12 @@ std::tuple<u8*, GLintptr, bool> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr a
 }
 
 void OGLStreamBuffer::Unmap(GLsizeiptr size) {
+    if (persistent_ptr != nullptr) {
+        // Writes to a coherent mapping need no flush
+        buffer_pos += size;
+        return;
+    }
+
     if (size > 0) {
         // flush is relative to the start of the currently mapped range of buffer
         glFlushMappedBufferRange(gl_target, 0, size);
@@ -62,4 +117,23 @@ void OGLStreamBuffer::Unmap(GLsizeiptr size) {
     buffer_pos += size;
 }
 
+void OGLStreamBuffer::FenceSegments(std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        if (fences[i] != nullptr) {
+            glDeleteSync(fences[i]);
+        }
+        fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void OGLStreamBuffer::WaitSegments(std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        if (fences[i] != nullptr) {
+            glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+}
+
 } // namespace OpenGL
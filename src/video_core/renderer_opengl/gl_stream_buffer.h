@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <tuple>
 #include <glad/glad.h>
 #include "common/common_types.h"
@@ -19,6 +20,11 @@ public:
     GLuint GetHandle() const;
     GLsizeiptr GetSize() const;
 
+    /// Returns how many times the buffer wrapped around, older data may have been overwritten
+    u32 GetWrapCount() const {
+        return wrap_count;
+    }
+
     /*
      * Allocates a linear chunk of memory in the GPU buffer with at least "size" bytes
      * and the optional alignment requirement.
@@ -32,12 +38,32 @@ public:
     void Unmap(GLsizeiptr size);
 
 private:
+    /// Number of regions the persistent buffer is split into, each guarded by its own fence
+    static constexpr std::size_t NUM_SEGMENTS = 16;
+
+    std::size_t GetSegment(GLintptr offset) const {
+        return static_cast<std::size_t>(offset / segment_size);
+    }
+
+    /// Marks the segments in [begin, end) as in use by the commands submitted so far
+    void FenceSegments(std::size_t begin, std::size_t end);
+
+    /// Waits until the GPU is done with the segments in [begin, end)
+    void WaitSegments(std::size_t begin, std::size_t end);
+
     OGLBuffer gl_buffer;
     GLenum gl_target;
     GLenum gl_target_invalidate_hack;
 
     GLintptr buffer_pos = 0;
     GLsizeiptr buffer_size = 0;
+    u32 wrap_count = 0;
+
+    // Persistent coherent mapping, used when the driver supports buffer storage
+    u8* persistent_ptr = nullptr;
+    GLsizeiptr segment_size = 0;
+    std::size_t current_segment = 0;
+    std::array<GLsync, NUM_SEGMENTS> fences{};
 };
 
 } // namespace OpenGL
@@ -0,0 +1,156 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include "common/logging/log.h"
+#include "video_core/renderer_opengl/gl_surface_trace.h"
+
+namespace OpenGL {
+
+namespace {
+constexpr u32 TRACE_MAGIC = 0x43535452; // "RTSC"
+constexpr u32 TRACE_VERSION = 1;
+
+struct TraceHeader {
+    u32 magic;
+    u32 version;
+};
+
+u64 GetTimeNs() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+}
+} // Anonymous namespace
+
+SurfaceTraceEntry SurfaceTraceEntry::SurfaceLookup(SurfaceTraceOp op, const SurfaceParams& params,
+                                                   u8 match_res_scale, bool load_if_create) {
+    SurfaceTraceEntry entry{};
+    entry.op = op;
+    entry.match_res_scale = match_res_scale;
+    entry.flag = load_if_create ? 1 : 0;
+    entry.format = static_cast<u8>(params.pixel_format);
+    entry.is_tiled = params.is_tiled ? 1 : 0;
+    entry.res_scale = params.res_scale;
+    entry.addr = params.addr;
+    entry.width = params.width;
+    entry.height = params.height;
+    entry.stride = params.stride;
+    return entry;
+}
+
+SurfaceTraceEntry SurfaceTraceEntry::TextureLookup(const Pica::Texture::TextureInfo& info,
+                                                   u32 max_level) {
+    SurfaceTraceEntry entry{};
+    entry.op = SurfaceTraceOp::GetTextureSurface;
+    entry.format = static_cast<u8>(info.format);
+    entry.is_tiled = 1;
+    entry.max_level = static_cast<u8>(max_level);
+    entry.addr = info.physical_address;
+    entry.width = info.width;
+    entry.height = info.height;
+    entry.stride = static_cast<u32>(info.stride);
+    return entry;
+}
+
+SurfaceTraceEntry SurfaceTraceEntry::Region(SurfaceTraceOp op, PAddr addr, u32 size,
+                                            const SurfaceParams* owner) {
+    SurfaceTraceEntry entry{};
+    if (owner != nullptr) {
+        entry = SurfaceLookup(op, *owner, 0, true);
+    }
+    entry.op = op;
+    entry.flag = owner != nullptr ? 1 : 0;
+    entry.region_addr = addr;
+    entry.region_size = size;
+    return entry;
+}
+
+SurfaceParams SurfaceTraceEntry::GetSurfaceParams() const {
+    SurfaceParams params;
+    params.addr = addr;
+    params.width = width;
+    params.height = height;
+    params.stride = stride;
+    params.res_scale = res_scale;
+    params.is_tiled = is_tiled != 0;
+    params.pixel_format = static_cast<SurfaceParams::PixelFormat>(format);
+    params.UpdateParams();
+    return params;
+}
+
+Pica::Texture::TextureInfo SurfaceTraceEntry::GetTextureInfo() const {
+    Pica::Texture::TextureInfo info;
+    info.physical_address = addr;
+    info.width = width;
+    info.height = height;
+    info.stride = stride;
+    info.format = static_cast<Pica::TexturingRegs::TextureFormat>(format);
+    return info;
+}
+
+SurfaceTraceRecorder::SurfaceTraceRecorder(const std::string& path) : file(path, "wb") {
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_OpenGL, "Failed to open surface trace {}", path);
+        return;
+    }
+    file.WriteObject(TraceHeader{TRACE_MAGIC, TRACE_VERSION});
+    LOG_INFO(Render_OpenGL, "Recording surface cache calls to {}", path);
+}
+
+SurfaceTraceRecorder::~SurfaceTraceRecorder() {
+    if (file.IsOpen()) {
+        LOG_INFO(Render_OpenGL, "Recorded {} surface cache calls", num_entries);
+    }
+}
+
+void SurfaceTraceRecorder::Record(const SurfaceTraceEntry& entry) {
+    if (file.IsOpen()) {
+        file.WriteObject(entry);
+        num_entries++;
+    }
+}
+
+SurfaceTraceRecorder::Scope::Scope(SurfaceTraceRecorder* recorder) : recorder(recorder) {
+    if (recorder != nullptr) {
+        recorder->depth++;
+    }
+}
+
+SurfaceTraceRecorder::Scope::~Scope() {
+    if (recorder != nullptr) {
+        recorder->depth--;
+    }
+}
+
+std::vector<SurfaceTraceEntry> LoadSurfaceTrace(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    TraceHeader header{};
+    if (!file.IsOpen() || file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != TRACE_MAGIC || header.version != TRACE_VERSION) {
+        LOG_ERROR(Render_OpenGL, "{} is not a surface trace of this version", path);
+        return {};
+    }
+
+    std::vector<SurfaceTraceEntry> entries((file.GetSize() - sizeof(header)) /
+                                           sizeof(SurfaceTraceEntry));
+    entries.resize(file.ReadArray(entries.data(), entries.size()));
+    return entries;
+}
+
+SurfaceCacheTimer::SurfaceCacheTimer(SurfaceCacheTimes* times, SurfaceCacheTimes::Part part)
+    : times(times), part(part) {
+    if (times != nullptr) {
+        start = GetTimeNs();
+    }
+}
+
+SurfaceCacheTimer::~SurfaceCacheTimer() {
+    if (times != nullptr) {
+        times->ns[part] += GetTimeNs() - start;
+        times->calls[part]++;
+    }
+}
+
+} // namespace OpenGL
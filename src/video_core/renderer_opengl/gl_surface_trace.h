@@ -0,0 +1,125 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/renderer_opengl/gl_surface_params.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace OpenGL {
+
+/// Calls of the surface cache kept in a trace
+enum class SurfaceTraceOp : u8 {
+    GetSurface,
+    GetSurfaceSubRect,
+    GetTextureSurface,
+    FlushRegion,
+    InvalidateRegion,
+};
+
+/**
+ * A call of the surface cache. The surface fields describe the requested surface, the texture
+ * of GetTextureSurface or the owner of an invalidated region.
+ */
+struct SurfaceTraceEntry {
+    SurfaceTraceOp op;
+    /// ScaleMatch of the surface lookups
+    u8 match_res_scale;
+    /// load_if_create of the surface lookups, whether an invalidated region has an owner
+    u8 flag;
+    /// PixelFormat of a surface, TextureFormat of a texture
+    u8 format;
+    u8 is_tiled;
+    u8 max_level;
+    u16 res_scale;
+    /// Region of FlushRegion and InvalidateRegion
+    PAddr region_addr;
+    u32 region_size;
+    PAddr addr;
+    u32 width;
+    u32 height;
+    u32 stride;
+
+    static SurfaceTraceEntry SurfaceLookup(SurfaceTraceOp op, const SurfaceParams& params,
+                                           u8 match_res_scale, bool load_if_create);
+    static SurfaceTraceEntry TextureLookup(const Pica::Texture::TextureInfo& info, u32 max_level);
+    /// The owner is null for regions that the CPU wrote
+    static SurfaceTraceEntry Region(SurfaceTraceOp op, PAddr addr, u32 size,
+                                    const SurfaceParams* owner = nullptr);
+
+    /// Returns the parameters of the surface fields
+    SurfaceParams GetSurfaceParams() const;
+    Pica::Texture::TextureInfo GetTextureInfo() const;
+};
+static_assert(sizeof(SurfaceTraceEntry) == 32, "SurfaceTraceEntry has the wrong size");
+
+/**
+ * Appends the calls of the surface cache to a trace file. The calls made by another traced call
+ * are left out, so that replaying the trace makes them again.
+ */
+class SurfaceTraceRecorder {
+public:
+    explicit SurfaceTraceRecorder(const std::string& path);
+    ~SurfaceTraceRecorder();
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    /// Marks a call of the cache, only the outermost one of the nested calls is recorded
+    class Scope {
+    public:
+        explicit Scope(SurfaceTraceRecorder* recorder);
+        ~Scope();
+
+        bool IsOutermost() const {
+            return recorder != nullptr && recorder->depth == 1;
+        }
+
+    private:
+        SurfaceTraceRecorder* recorder;
+    };
+
+    void Record(const SurfaceTraceEntry& entry);
+
+private:
+    FileUtil::IOFile file;
+    u32 depth = 0;
+    std::size_t num_entries = 0;
+};
+
+/// Reads a trace file, returns no entries if it is missing or of another version
+std::vector<SurfaceTraceEntry> LoadSurfaceTrace(const std::string& path);
+
+/// Time spent in the parts of the surface cache while a trace is replayed, a part includes the
+/// parts it calls
+struct SurfaceCacheTimes {
+    enum Part : std::size_t {
+        FindMatch,
+        ValidateSurface,
+        MortonCopy,
+        NumParts,
+    };
+    std::array<u64, NumParts> ns{};
+    std::array<u64, NumParts> calls{};
+};
+
+/// Adds the time of its scope to a part of the times, nothing is measured without the times
+class SurfaceCacheTimer {
+public:
+    SurfaceCacheTimer(SurfaceCacheTimes* times, SurfaceCacheTimes::Part part);
+    ~SurfaceCacheTimer();
+
+private:
+    SurfaceCacheTimes* times;
+    SurfaceCacheTimes::Part part;
+    u64 start = 0;
+};
+
+} // namespace OpenGL
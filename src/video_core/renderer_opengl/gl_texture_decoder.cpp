@@ -0,0 +1,296 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_texture_decoder.h"
+#include "video_core/renderer_opengl/gl_vars.h"
+
+namespace OpenGL {
+
+using PixelFormat = SurfaceParams::PixelFormat;
+
+// The format values match SurfaceParams::PixelFormat, which in turn match the PICA texture formats
+constexpr char decoder_source[] = R"(
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(std430, binding = 0) readonly buffer texture_data {
+    uint words[];
+};
+
+layout(rgba8, binding = 0) uniform writeonly highp image2D dest;
+
+uniform int format;
+uniform uint bpp;
+uniform uint stride;
+uniform uint height;
+uniform uvec2 rect_origin;
+uniform uvec2 rect_size;
+uniform uint data_offset;
+
+const ivec2 etc1_modifier_table[8] = ivec2[8](ivec2(2, 8), ivec2(5, 17), ivec2(9, 29),
+                                              ivec2(13, 42), ivec2(18, 60), ivec2(24, 80),
+                                              ivec2(33, 106), ivec2(47, 183));
+
+uint ReadByte(uint offset) {
+    uint index = offset - data_offset;
+    return (words[index >> 2] >> ((index & 3u) * 8u)) & 0xFFu;
+}
+
+uint ReadHalf(uint offset) {
+    uint index = offset - data_offset;
+    return (words[index >> 2] >> ((index & 2u) * 8u)) & 0xFFFFu;
+}
+
+uint ReadWord(uint offset) {
+    return words[(offset - data_offset) >> 2];
+}
+
+uint MortonInterleave(uvec2 pos) {
+    return (pos.x & 1u) | ((pos.y & 1u) << 1) | ((pos.x & 2u) << 1) | ((pos.y & 2u) << 2) |
+           ((pos.x & 4u) << 2) | ((pos.y & 4u) << 3);
+}
+
+uint Convert4To8(uint value) {
+    return value * 17u;
+}
+
+uint Convert5To8(uint value) {
+    return ((value << 3) | (value >> 2)) & 0xFFu;
+}
+
+uint Convert6To8(uint value) {
+    return ((value << 2) | (value >> 4)) & 0xFFu;
+}
+
+uvec3 SampleETC1Subtile(uint low, uint high, uvec2 pos) {
+    uint texel = 4u * pos.x + pos.y;
+    if ((high & 1u) != 0u) {
+        pos = pos.yx;
+    }
+
+    ivec3 color;
+    if ((high & 2u) != 0u) {
+        uvec3 base = uvec3(high >> 27, high >> 19, high >> 11) & 31u;
+        if (pos.x >= 2u) {
+            ivec3 delta = ivec3(bitfieldExtract(int(high), 24, 3),
+                                bitfieldExtract(int(high), 16, 3),
+                                bitfieldExtract(int(high), 8, 3));
+            base = uvec3(ivec3(base) + delta) & 0xFFu;
+        }
+        color = ivec3(Convert5To8(base.r), Convert5To8(base.g), Convert5To8(base.b));
+    } else {
+        uint shift = pos.x < 2u ? 4u : 0u;
+        uvec3 base = uvec3(high >> (24u + shift), high >> (16u + shift), high >> (8u + shift));
+        color = ivec3(Convert4To8(base.r & 15u), Convert4To8(base.g & 15u),
+                      Convert4To8(base.b & 15u));
+    }
+
+    uint table_index = pos.x < 2u ? (high >> 5) & 7u : (high >> 2) & 7u;
+    int modifier = etc1_modifier_table[table_index][(low >> texel) & 1u];
+    if (((low >> (16u + texel)) & 1u) != 0u) {
+        modifier = -modifier;
+    }
+    return uvec3(clamp(color + modifier, 0, 255));
+}
+
+uvec4 DecodeETC1(uint tile_offset, uvec2 fine, bool has_alpha) {
+    uint subtile_index = (fine.x >> 2) + 2u * (fine.y >> 2);
+    uint subtile_offset = tile_offset + subtile_index * (has_alpha ? 16u : 8u);
+    uvec2 pos = fine & 3u;
+
+    uint alpha = 255u;
+    if (has_alpha) {
+        uint shift = 4u * (pos.x * 4u + pos.y);
+        uint packed_alpha = ReadWord(subtile_offset + (shift >= 32u ? 4u : 0u));
+        alpha = Convert4To8((packed_alpha >> (shift & 31u)) & 15u);
+        subtile_offset += 8u;
+    }
+
+    uvec3 rgb = SampleETC1Subtile(ReadWord(subtile_offset), ReadWord(subtile_offset + 4u), pos);
+    return uvec4(rgb, alpha);
+}
+
+void main() {
+    uvec2 local = gl_GlobalInvocationID.xy;
+    if (any(greaterThanEqual(local, rect_size))) {
+        return;
+    }
+
+    // The guest stores rows top to bottom
+    uvec2 gl_pos = rect_origin + local;
+    uvec2 pos = uvec2(gl_pos.x, height - 1u - gl_pos.y);
+    uvec2 fine = pos & 7u;
+    uint tile_offset = ((pos.y >> 3) * (stride >> 3) + (pos.x >> 3)) * bpp * 8u;
+    uint texel = MortonInterleave(fine);
+
+    uvec4 color;
+    switch (format) {
+    case 0: { // RGBA8
+        uint value = ReadWord(tile_offset + texel * 4u);
+        color = uvec4(value >> 24, value >> 16, value >> 8, value) & 0xFFu;
+        break;
+    }
+    case 1: { // RGB8
+        uint offset = tile_offset + texel * 3u;
+        color = uvec4(ReadByte(offset + 2u), ReadByte(offset + 1u), ReadByte(offset), 255u);
+        break;
+    }
+    case 2: { // RGB5A1
+        uint value = ReadHalf(tile_offset + texel * 2u);
+        color = uvec4(Convert5To8((value >> 11) & 31u), Convert5To8((value >> 6) & 31u),
+                      Convert5To8((value >> 1) & 31u), (value & 1u) * 255u);
+        break;
+    }
+    case 3: { // RGB565
+        uint value = ReadHalf(tile_offset + texel * 2u);
+        color = uvec4(Convert5To8((value >> 11) & 31u), Convert6To8((value >> 5) & 63u),
+                      Convert5To8(value & 31u), 255u);
+        break;
+    }
+    case 4: { // RGBA4
+        uint value = ReadHalf(tile_offset + texel * 2u);
+        color = uvec4(Convert4To8((value >> 12) & 15u), Convert4To8((value >> 8) & 15u),
+                      Convert4To8((value >> 4) & 15u), Convert4To8(value & 15u));
+        break;
+    }
+    case 5: { // IA8
+        uint value = ReadHalf(tile_offset + texel * 2u);
+        uint i = value >> 8;
+        color = uvec4(i, i, i, value & 0xFFu);
+        break;
+    }
+    case 6: { // RG8
+        uint value = ReadHalf(tile_offset + texel * 2u);
+        color = uvec4(value >> 8, value & 0xFFu, 0u, 255u);
+        break;
+    }
+    case 7: { // I8
+        uint i = ReadByte(tile_offset + texel);
+        color = uvec4(i, i, i, 255u);
+        break;
+    }
+    case 8: // A8
+        color = uvec4(0u, 0u, 0u, ReadByte(tile_offset + texel));
+        break;
+    case 9: { // IA4
+        uint value = ReadByte(tile_offset + texel);
+        uint i = Convert4To8(value >> 4);
+        color = uvec4(i, i, i, Convert4To8(value & 15u));
+        break;
+    }
+    case 10: { // I4
+        uint value = ReadByte(tile_offset + (texel >> 1)) >> ((texel & 1u) * 4u);
+        uint i = Convert4To8(value & 15u);
+        color = uvec4(i, i, i, 255u);
+        break;
+    }
+    case 11: { // A4
+        uint value = ReadByte(tile_offset + (texel >> 1)) >> ((texel & 1u) * 4u);
+        color = uvec4(0u, 0u, 0u, Convert4To8(value & 15u));
+        break;
+    }
+    case 12: // ETC1
+        color = DecodeETC1(tile_offset, fine, false);
+        break;
+    case 13: // ETC1A4
+        color = DecodeETC1(tile_offset, fine, true);
+        break;
+    default:
+        color = uvec4(0u);
+        break;
+    }
+
+    imageStore(dest, ivec2(local), vec4(color) / 255.0);
+}
+)";
+
+MICROPROFILE_DEFINE(OpenGL_TextureDecode, "OpenGL", "Texture Decode", MP_RGB(128, 192, 128));
+
+TextureDecoderOpenGL::TextureDecoderOpenGL() {
+    OGLShader shader;
+    shader.Create(decoder_source, GL_COMPUTE_SHADER);
+    program.Create(false, {shader.handle});
+
+    format_loc = glGetUniformLocation(program.handle, "format");
+    bpp_loc = glGetUniformLocation(program.handle, "bpp");
+    stride_loc = glGetUniformLocation(program.handle, "stride");
+    height_loc = glGetUniformLocation(program.handle, "height");
+    rect_origin_loc = glGetUniformLocation(program.handle, "rect_origin");
+    rect_size_loc = glGetUniformLocation(program.handle, "rect_size");
+    data_offset_loc = glGetUniformLocation(program.handle, "data_offset");
+
+    source_buffer.Create();
+}
+
+TextureDecoderOpenGL::~TextureDecoderOpenGL() = default;
+
+bool TextureDecoderOpenGL::IsSupported() {
+    if (GLES) {
+        return GLAD_GL_ES_VERSION_3_1;
+    }
+    return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object &&
+           GLAD_GL_ARB_shader_image_load_store;
+}
+
+bool TextureDecoderOpenGL::CanDecode(PixelFormat format) {
+    // Color formats are converted to their own internal format by the blit out of the staging
+    // texture, depth formats cannot be written through an image
+    return format <= PixelFormat::ETC1A4;
+}
+
+void TextureDecoderOpenGL::ReserveStaging(u32 width, u32 height) {
+    if (width <= staging_width && height <= staging_height) {
+        return;
+    }
+
+    // Immutable storage is required to bind the texture as an image on GLES
+    staging_width = std::max(staging_width, Common::AlignUp(width, 64));
+    staging_height = std::max(staging_height, Common::AlignUp(height, 64));
+    staging.Release();
+    staging.Create();
+
+    GLuint old_tex = OpenGLState::BindTexture2D(0, staging.handle);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, staging_width, staging_height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    OpenGLState::BindTexture2D(0, old_tex);
+}
+
+GLuint TextureDecoderOpenGL::Decode(const u8* data, u32 size, u32 data_offset, PixelFormat format,
+                                    u32 stride, u32 height, const Common::Rectangle<u32>& rect) {
+    MICROPROFILE_SCOPE(OpenGL_TextureDecode);
+    ASSERT(CanDecode(format));
+    // Tiles are at least 32 bytes, so the region is always made of whole words
+    ASSERT(data_offset % 4 == 0 && size % 4 == 0);
+
+    const u32 width = rect.GetWidth();
+    const u32 rect_height = rect.GetHeight();
+    ReserveStaging(width, rect_height);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, source_buffer.handle);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_STREAM_DRAW);
+    glBindImageTexture(0, staging.handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    GLuint old_program = OpenGLState::BindShaderProgram(program.handle);
+    glUniform1i(format_loc, static_cast<GLint>(format));
+    glUniform1ui(bpp_loc, SurfaceParams::GetFormatBpp(format));
+    glUniform1ui(stride_loc, stride);
+    glUniform1ui(height_loc, height);
+    glUniform2ui(rect_origin_loc, rect.left, rect.bottom);
+    glUniform2ui(rect_size_loc, width, rect_height);
+    glUniform1ui(data_offset_loc, data_offset);
+    glDispatchCompute((width + 7) / 8, (rect_height + 7) / 8, 1);
+    OpenGLState::BindShaderProgram(old_program);
+
+    // The staging texture is read back through a framebuffer blit
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    return staging.handle;
+}
+
+} // namespace OpenGL
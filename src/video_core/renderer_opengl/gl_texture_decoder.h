@@ -0,0 +1,64 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_surface_params.h"
+
+namespace OpenGL {
+
+/**
+ * Decodes tiled guest texture data with a compute shader. The raw bytes are uploaded to a shader
+ * storage buffer and every invocation untiles and converts one texel, so neither the Morton
+ * swizzle nor the ETC1 decompression runs on the CPU.
+ */
+class TextureDecoderOpenGL : NonCopyable {
+public:
+    TextureDecoderOpenGL();
+    ~TextureDecoderOpenGL();
+
+    /// Returns true if the driver provides compute shaders, storage buffers and image stores
+    static bool IsSupported();
+
+    /// Returns true if tiled data of the given format can be decoded on the GPU
+    static bool CanDecode(SurfaceParams::PixelFormat format);
+
+    /**
+     * Decodes a tiled region of a surface into the staging texture.
+     * @param data Guest memory of the region, starting at data_offset bytes into the surface
+     * @param size Size of the region in bytes
+     * @param data_offset Offset of the region in bytes from the start of the surface
+     * @param format Pixel format of the surface
+     * @param stride Stride of the surface in pixels
+     * @param height Height of the surface in pixels
+     * @param rect Rectangle covered by the region, in OpenGL coordinates
+     * @return RGBA8 texture holding the decoded rectangle in its bottom left corner
+     */
+    GLuint Decode(const u8* data, u32 size, u32 data_offset, SurfaceParams::PixelFormat format,
+                  u32 stride, u32 height, const Common::Rectangle<u32>& rect);
+
+private:
+    /// Makes sure the staging texture is at least the given size
+    void ReserveStaging(u32 width, u32 height);
+
+    OGLProgram program;
+    OGLBuffer source_buffer;
+    OGLTexture staging;
+    u32 staging_width = 0;
+    u32 staging_height = 0;
+
+    GLint format_loc = -1;
+    GLint bpp_loc = -1;
+    GLint stride_loc = -1;
+    GLint height_loc = -1;
+    GLint rect_origin_loc = -1;
+    GLint rect_size_loc = -1;
+    GLint data_offset_loc = -1;
+};
+
+} // namespace OpenGL
@@ -11,6 +11,7 @@
 namespace OpenGL {
 bool GLES;
 bool AllowShadow;
+bool ShadowBlending;
 
 void CheckGLError(const char* file, int line) {
     GLenum err = glGetError();
@@ -10,6 +10,8 @@
 namespace OpenGL {
 extern bool GLES;
 extern bool AllowShadow;
+/// Shadow maps are rendered with the depth test and blending, without image load/store
+extern bool ShadowBlending;
 
 // #define DEBUG_OPENGL
 #if defined(DEBUG_OPENGL)
@@ -0,0 +1,173 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/alignment.h"
+#include "common/microprofile.h"
+#include "core/hle/service/y2r_u.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_y2r_converter.h"
+
+namespace OpenGL {
+
+using Service::Y2R::InputFormat;
+
+// The format values match Service::Y2R::InputFormat, the math is the one of HW::Y2R
+constexpr char converter_source[] = R"(
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(std430, binding = 0) readonly buffer yuv_data {
+    uint words[];
+};
+
+layout(rgba8, binding = 0) uniform writeonly highp image2D dest;
+
+uniform int format;
+uniform uvec2 size;
+uniform uint u_offset;
+uniform uint v_offset;
+uniform ivec4 coefficients_low;
+uniform ivec4 coefficients_high;
+uniform float alpha;
+uniform bool flip;
+
+int ReadByte(uint offset) {
+    return int((words[offset >> 2] >> ((offset & 3u) * 8u)) & 0xFFu);
+}
+
+void main() {
+    uvec2 pos = gl_GlobalInvocationID.xy;
+    if (any(greaterThanEqual(pos, size))) {
+        return;
+    }
+
+    uint width = size.x;
+    uint index = pos.y * width + pos.x;
+    int y;
+    int u;
+    int v;
+    switch (format) {
+    case 0: // YUV422_Indiv8
+    case 2: // YUV422_Indiv16
+        y = ReadByte(index);
+        u = ReadByte(u_offset + index / 2u);
+        v = ReadByte(v_offset + index / 2u);
+        break;
+    case 1: // YUV420_Indiv8
+    case 3: // YUV420_Indiv16
+        y = ReadByte(index);
+        u = ReadByte(u_offset + ((pos.y / 2u) * width + pos.x) / 2u);
+        v = ReadByte(v_offset + ((pos.y / 2u) * width + pos.x) / 2u);
+        break;
+    default: { // YUYV422_Interleaved
+        uint pair = (pos.y * width + (pos.x / 2u) * 2u) * 2u;
+        y = ReadByte(index * 2u);
+        u = ReadByte(pair + 1u);
+        v = ReadByte(pair + 3u);
+        break;
+    }
+    }
+
+    ivec4 c = coefficients_low;
+    int cy = c.x * y;
+    int r = ((cy + c.y * v) >> 3) + coefficients_high.y + 0x18;
+    int g = ((cy - c.z * v - c.w * u) >> 3) + coefficients_high.z + 0x18;
+    int b = ((cy + coefficients_high.x * u) >> 3) + coefficients_high.w + 0x18;
+    vec3 rgb = vec3(clamp(ivec3(r, g, b) >> 5, 0, 255)) / 255.0;
+
+    uint out_y = flip ? size.y - 1u - pos.y : pos.y;
+    imageStore(dest, ivec2(pos.x, out_y), vec4(rgb, alpha));
+}
+)";
+
+MICROPROFILE_DEFINE(OpenGL_Y2RConversion, "OpenGL", "Y2R Conversion", MP_RGB(192, 128, 192));
+
+Y2RConverterOpenGL::Y2RConverterOpenGL() {
+    OGLShader shader;
+    shader.Create(converter_source, GL_COMPUTE_SHADER);
+    program.Create(false, {shader.handle});
+
+    format_loc = glGetUniformLocation(program.handle, "format");
+    size_loc = glGetUniformLocation(program.handle, "size");
+    u_offset_loc = glGetUniformLocation(program.handle, "u_offset");
+    v_offset_loc = glGetUniformLocation(program.handle, "v_offset");
+    coefficients_low_loc = glGetUniformLocation(program.handle, "coefficients_low");
+    coefficients_high_loc = glGetUniformLocation(program.handle, "coefficients_high");
+    alpha_loc = glGetUniformLocation(program.handle, "alpha");
+    flip_loc = glGetUniformLocation(program.handle, "flip");
+
+    source_buffer.Create();
+}
+
+Y2RConverterOpenGL::~Y2RConverterOpenGL() = default;
+
+void Y2RConverterOpenGL::ReserveStaging(u32 width, u32 height) {
+    if (width <= staging_width && height <= staging_height) {
+        return;
+    }
+
+    // Immutable storage is required to bind the texture as an image on GLES
+    staging_width = std::max(staging_width, Common::AlignUp(width, 64));
+    staging_height = std::max(staging_height, Common::AlignUp(height, 64));
+    staging.Release();
+    staging.Create();
+
+    GLuint old_tex = OpenGLState::BindTexture2D(0, staging.handle);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, staging_width, staging_height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    OpenGLState::BindTexture2D(0, old_tex);
+}
+
+GLuint Y2RConverterOpenGL::Convert(const Service::Y2R::ConversionConfiguration& config,
+                                   const std::vector<u8>& input, bool flip) {
+    MICROPROFILE_SCOPE(OpenGL_Y2RConversion);
+    const u32 width = config.input_line_width;
+    const u32 height = config.input_lines;
+    ReserveStaging(width, height);
+
+    u32 u_offset = 0;
+    u32 v_offset = 0;
+    switch (config.input_format) {
+    case InputFormat::YUV422_Indiv8:
+    case InputFormat::YUV422_Indiv16:
+        u_offset = width * height;
+        v_offset = u_offset + width * height / 2;
+        break;
+    case InputFormat::YUV420_Indiv8:
+    case InputFormat::YUV420_Indiv16:
+        u_offset = width * height;
+        v_offset = u_offset + width * height / 4;
+        break;
+    case InputFormat::YUYV422_Interleaved:
+        break;
+    }
+
+    // Storage buffers are read in words, the tail of the data is padded
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, source_buffer.handle);
+    const GLsizeiptr buffer_size = Common::AlignUp(static_cast<u32>(input.size()), 4);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, buffer_size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, input.size(), input.data());
+    glBindImageTexture(0, staging.handle, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+    const auto& c = config.coefficients;
+    GLuint old_program = OpenGLState::BindShaderProgram(program.handle);
+    glUniform1i(format_loc, static_cast<GLint>(config.input_format));
+    glUniform2ui(size_loc, width, height);
+    glUniform1ui(u_offset_loc, u_offset);
+    glUniform1ui(v_offset_loc, v_offset);
+    glUniform4i(coefficients_low_loc, c[0], c[1], c[2], c[3]);
+    glUniform4i(coefficients_high_loc, c[4], c[5], c[6], c[7]);
+    glUniform1f(alpha_loc, static_cast<u8>(config.alpha) / 255.0f);
+    glUniform1i(flip_loc, flip);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+    OpenGLState::BindShaderProgram(old_program);
+
+    // The staging texture is read back through a framebuffer blit
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    return staging.handle;
+}
+
+} // namespace OpenGL
@@ -0,0 +1,57 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Service::Y2R {
+struct ConversionConfiguration;
+} // namespace Service::Y2R
+
+namespace OpenGL {
+
+/**
+ * Performs Y2R conversions with a compute shader. The YUV planes are uploaded to a shader storage
+ * buffer and every invocation converts one pixel with the fixed point math of the hardware.
+ */
+class Y2RConverterOpenGL : NonCopyable {
+public:
+    Y2RConverterOpenGL();
+    ~Y2RConverterOpenGL();
+
+    /**
+     * Converts an image into the staging texture.
+     * @param config Conversion to perform
+     * @param input Y, U and V planes one after the other, or the interleaved YUYV data
+     * @param flip Whether the first line goes to the top of the texture, as in tiled surfaces
+     * @return RGBA8 texture holding the converted image in its bottom left corner
+     */
+    GLuint Convert(const Service::Y2R::ConversionConfiguration& config,
+                   const std::vector<u8>& input, bool flip);
+
+private:
+    /// Makes sure the staging texture is at least the given size
+    void ReserveStaging(u32 width, u32 height);
+
+    OGLProgram program;
+    OGLBuffer source_buffer;
+    OGLTexture staging;
+    u32 staging_width = 0;
+    u32 staging_height = 0;
+
+    GLint format_loc = -1;
+    GLint size_loc = -1;
+    GLint u_offset_loc = -1;
+    GLint v_offset_loc = -1;
+    GLint coefficients_low_loc = -1;
+    GLint coefficients_high_loc = -1;
+    GLint alpha_loc = -1;
+    GLint flip_loc = -1;
+};
+
+} // namespace OpenGL
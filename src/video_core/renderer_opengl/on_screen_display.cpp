@@ -1,5 +1,8 @@
 #include "video_core/renderer_opengl/on_screen_display.h"
 
+#include <array>
+#include <cstddef>
+#include <cstring>
 #include <memory>
 
 #include "common/timer.h"
@@ -20,12 +23,16 @@ public:
     void Draw(const Frontend::EmuWindow& window, const Layout::FramebufferLayout& layout);
 
 private:
-    void UpdateDebugInfo();
-    void DrawText(std::string_view text, u32 color);
+    struct Vertex {
+        GLfloat position[2];
+        GLfloat tex_coord[2];
+        std::array<GLubyte, 4> color;
+    };
 
-    GLint uniform_texture_id;
-    GLint uniform_color_id;
-    GLint uniform_offset_id;
+    void UpdateDebugInfo();
+    void UpdateDrawInfo(const Frontend::EmuWindow& window, const Layout::FramebufferLayout& layout);
+    void AppendText(std::string_view text, u32 color);
+    void UploadGeometry();
 
     OpenGL::OGLVertexArray vertex_array;
     OpenGL::OGLBuffer vertex_buffer;
@@ -51,7 +58,12 @@ private:
         float screen_height;
         float start_x;
         float start_y;
-    } draw_info;
+    } draw_info{};
+
+    /// Quads of every message, shadows and text, uploaded together and drawn in one call
+    std::vector<Vertex> vertices;
+    /// Set when the messages or the layout changed since the vertices were built
+    bool geometry_dirty = true;
 
     u64 debug_timestamp;
 };
@@ -159,21 +171,23 @@ static const u8 rasters[CHARACTER_COUNT][CHARACTER_HEIGHT] = {
     {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x8f, 0xf1, 0x60, 0x00, 0x00, 0x00}};
 
 static const char* s_vertexShaderSrc = R"(uniform vec2 charSize;
-uniform vec2 offset;
 in vec2 rawpos;
 in vec2 rawtex0;
+in vec4 rawcolor;
 out vec2 uv0;
+out vec4 color0;
 void main() {
-    gl_Position = vec4(rawpos + offset, 0, 1);
+    gl_Position = vec4(rawpos, 0, 1);
     uv0 = rawtex0 * charSize;
+    color0 = rawcolor;
 })";
 
 static const char* s_fragmentShaderSrc = R"(uniform sampler2D samp0;
-uniform vec4 color;
 in vec2 uv0;
+in vec4 color0;
 out vec4 ocol0;
 void main() {
-    ocol0 = texture(samp0, uv0) * color;
+    ocol0 = texture(samp0, uv0) * color0;
 })";
 
 bool RasterFont::Initialize() {
@@ -226,102 +240,94 @@ bool RasterFont::Initialize() {
                  GL_RGBA, GL_UNSIGNED_BYTE, texture_data.data());
 
     // bound uniforms
-    uniform_texture_id = glGetUniformLocation(shader.handle, "samp0");
-    uniform_color_id = glGetUniformLocation(shader.handle, "color");
-    uniform_offset_id = glGetUniformLocation(shader.handle, "offset");
-    glUniform1i(uniform_texture_id, 0);
+    glUniform1i(glGetUniformLocation(shader.handle, "samp0"), 0);
     glUniform2f(glGetUniformLocation(shader.handle, "charSize"), 1.0F / GLfloat(CHARACTER_COUNT),
                 1.0F);
 
     // generate VBO & VAO
     GLuint attrib_position = glGetAttribLocation(shader.handle, "rawpos");
     GLuint attrib_tex_coord = glGetAttribLocation(shader.handle, "rawtex0");
+    GLuint attrib_color = glGetAttribLocation(shader.handle, "rawcolor");
     glEnableVertexAttribArray(attrib_position);
-    glVertexAttribPointer(attrib_position, 2, GL_FLOAT, 0, sizeof(GLfloat) * 4, nullptr);
+    glVertexAttribPointer(attrib_position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const GLvoid*>(offsetof(Vertex, position)));
     glEnableVertexAttribArray(attrib_tex_coord);
-    glVertexAttribPointer(attrib_tex_coord, 2, GL_FLOAT, 0, sizeof(GLfloat) * 4,
-                          (GLfloat*)nullptr + 2);
+    glVertexAttribPointer(attrib_tex_coord, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                          reinterpret_cast<const GLvoid*>(offsetof(Vertex, tex_coord)));
+    glEnableVertexAttribArray(attrib_color);
+    glVertexAttribPointer(attrib_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                          reinterpret_cast<const GLvoid*>(offsetof(Vertex, color)));
 
     prev_state.Apply();
 
     return true;
 }
 
-void RasterFont::DrawText(std::string_view text, u32 color) {
-    int usage = 0;
-    GLfloat x = draw_info.start_x;
-    GLfloat y = draw_info.start_y;
-    std::vector<GLfloat> vertices(text.length() * 6 * 4);
-
-    for (const char& c : text) {
-        if (c == '\n') {
-            x = draw_info.start_x;
-            y -= draw_info.font_height + draw_info.border_y;
-            continue;
-        }
-
-        // do not print spaces, they can be skipped easily
-        if (c == ' ') {
-            x += draw_info.font_width + draw_info.border_x;
-            continue;
-        }
-
-        if (c < CHARACTER_OFFSET || c >= CHARACTER_COUNT + CHARACTER_OFFSET)
-            continue;
-
-        vertices[usage++] = x;
-        vertices[usage++] = y;
-        vertices[usage++] = GLfloat(c - CHARACTER_OFFSET);
-        vertices[usage++] = 0.0f;
+void RasterFont::AppendText(std::string_view text, u32 color) {
+    // The shadow goes first so the text of every message is blended over its own shadow
+    const GLubyte alpha = static_cast<GLubyte>((color >> 24) & 0xff);
+    const std::array<GLubyte, 4> shadow_color{0, 0, 0, alpha};
+    const std::array<GLubyte, 4> text_color{static_cast<GLubyte>((color >> 16) & 0xff),
+                                            static_cast<GLubyte>((color >> 8) & 0xff),
+                                            static_cast<GLubyte>(color & 0xff), alpha};
 
-        vertices[usage++] = x + draw_info.font_width;
-        vertices[usage++] = y;
-        vertices[usage++] = GLfloat(c - CHARACTER_OFFSET + 1);
-        vertices[usage++] = 0.0f;
+    GLfloat y = draw_info.start_y;
+    const auto append_quads = [&](GLfloat offset_x, GLfloat offset_y,
+                                  const std::array<GLubyte, 4>& quad_color) {
+        GLfloat x = draw_info.start_x;
+        y = draw_info.start_y;
+        for (const char& c : text) {
+            if (c == '\n') {
+                x = draw_info.start_x;
+                y -= draw_info.font_height + draw_info.border_y;
+                continue;
+            }
 
-        vertices[usage++] = x + draw_info.font_width;
-        vertices[usage++] = y + draw_info.font_height;
-        vertices[usage++] = GLfloat(c - CHARACTER_OFFSET + 1);
-        vertices[usage++] = 1.0f;
+            // do not print spaces, they can be skipped easily
+            if (c == ' ') {
+                x += draw_info.font_width + draw_info.border_x;
+                continue;
+            }
 
-        vertices[usage++] = x;
-        vertices[usage++] = y;
-        vertices[usage++] = GLfloat(c - CHARACTER_OFFSET);
-        vertices[usage++] = 0.0f;
+            if (c < CHARACTER_OFFSET || c >= CHARACTER_COUNT + CHARACTER_OFFSET)
+                continue;
 
-        vertices[usage++] = x + draw_info.font_width;
-        vertices[usage++] = y + draw_info.font_height;
-        vertices[usage++] = GLfloat(c - CHARACTER_OFFSET + 1);
-        vertices[usage++] = 1.0f;
+            const GLfloat left = x + offset_x;
+            const GLfloat right = left + draw_info.font_width;
+            const GLfloat bottom = y + offset_y;
+            const GLfloat top = bottom + draw_info.font_height;
+            const GLfloat u0 = GLfloat(c - CHARACTER_OFFSET);
+            const GLfloat u1 = u0 + 1.0f;
 
-        vertices[usage++] = x;
-        vertices[usage++] = y + draw_info.font_height;
-        vertices[usage++] = GLfloat(c - CHARACTER_OFFSET);
-        vertices[usage++] = 1.0f;
+            vertices.push_back({{left, bottom}, {u0, 0.0f}, quad_color});
+            vertices.push_back({{right, bottom}, {u1, 0.0f}, quad_color});
+            vertices.push_back({{right, top}, {u1, 1.0f}, quad_color});
+            vertices.push_back({{left, bottom}, {u0, 0.0f}, quad_color});
+            vertices.push_back({{right, top}, {u1, 1.0f}, quad_color});
+            vertices.push_back({{left, top}, {u0, 1.0f}, quad_color});
 
-        x += draw_info.font_width + draw_info.border_x;
-    }
+            x += draw_info.font_width + draw_info.border_x;
+        }
+    };
+    append_quads(draw_info.shadow_x, draw_info.shadow_y, shadow_color);
+    append_quads(0.0f, 0.0f, text_color);
     draw_info.start_y = y - draw_info.font_height - draw_info.border_y;
+}
 
-    if (!usage) {
-        return;
+void RasterFont::UploadGeometry() {
+    vertices.clear();
+    const float start_y = draw_info.start_y;
+    for (const Message& message : messages) {
+        AppendText(message.text, message.color);
     }
+    draw_info.start_y = start_y;
 
-    GLsizeiptr need_size = usage * sizeof(GLfloat);
-    // prefer `glBufferData` than `glBufferSubData` on mobile device
-    glBufferData(GL_ARRAY_BUFFER, need_size, vertices.data(), GL_STREAM_DRAW);
-
-    // text shadow
-    glUniform2f(uniform_offset_id, draw_info.shadow_x, draw_info.shadow_y);
-    glUniform4f(uniform_color_id, 0.0f, 0.0f, 0.0f, GLfloat((color >> 24) & 0xff) / 255.f);
-    glDrawArrays(GL_TRIANGLES, 0, usage / 4);
-
-    // text
-    glUniform2f(uniform_offset_id, 0.0f, 0.0f);
-    glUniform4f(uniform_color_id, GLfloat((color >> 16) & 0xff) / 255.f,
-                GLfloat((color >> 8) & 0xff) / 255.f, GLfloat((color >> 0) & 0xff) / 255.f,
-                GLfloat((color >> 24) & 0xff) / 255.f);
-    glDrawArrays(GL_TRIANGLES, 0, usage / 4);
+    if (!vertices.empty()) {
+        // prefer `glBufferData` than `glBufferSubData` on mobile device
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(),
+                     GL_STATIC_DRAW);
+    }
+    geometry_dirty = false;
 }
 
 void RasterFont::AddMessage(const std::string& message, MessageType type, u32 duration, u32 color) {
@@ -330,15 +336,19 @@ void RasterFont::AddMessage(const std::string& message, MessageType type, u32 du
         auto iter = messages.begin();
         while (iter != messages.end()) {
             if (iter->type == type) {
-                iter->text = message;
+                if (iter->text != message || iter->color != color) {
+                    iter->text = message;
+                    iter->color = color;
+                    geometry_dirty = true;
+                }
                 iter->timestamp = now + duration;
-                iter->color = color;
                 return;
             }
             ++iter;
         }
     }
     messages.emplace_back(Message{message, type, now + duration, color});
+    geometry_dirty = true;
 }
 
 void RasterFont::UpdateDebugInfo() {
@@ -346,49 +356,69 @@ void RasterFont::UpdateDebugInfo() {
     std::string text = fmt::format(
         "FPS:{:>2} - VPS:{:>2} - SPD:{:>2}", static_cast<int>(stats.game_fps),
         static_cast<int>(stats.system_fps), static_cast<int>(stats.emulation_speed * 100.0));
+    if (stats.vertex_cache_hit_rate >= 0.0) {
+        text += fmt::format(" - VC:{:>2}%", static_cast<int>(stats.vertex_cache_hit_rate * 100.0));
+    }
+    // Input latency to the pad update, then to the end of the frame
+    if (stats.input_latch_latency >= 0.0 && stats.input_frame_latency >= 0.0) {
+        text += fmt::format(" - IN:{:.1f}/{:.1f}ms", stats.input_latch_latency,
+                            stats.input_frame_latency);
+    }
+
+    if (stats.gl_calls_saved > 0.0) {
+        text += fmt::format(" - GL:{}", static_cast<int>(stats.gl_calls_saved));
+    }
 
     AddMessage(text, MessageType::FPS, Duration::FOREVER, Color::BLUE);
+
+    // Frame time percentiles, then the average milliseconds of each subsystem per frame
+    const Core::PerfStats::FrameTimeStats& frame_stats = stats.frame_time_stats;
+    std::string frame_text =
+        fmt::format("FT:{:.1f}/{:.1f}/{:.1f}ms", frame_stats.percentile_50,
+                    frame_stats.percentile_95, frame_stats.percentile_99);
+    for (std::size_t i = 0; i < Core::NUM_PERF_CATEGORIES; ++i) {
+        frame_text += fmt::format(" {}:{:.1f}",
+                                  Core::GetPerfCategoryName(static_cast<Core::PerfCategory>(i)),
+                                  frame_stats.category_time[i]);
+    }
+    AddMessage(frame_text, MessageType::FrameTime, Duration::FOREVER, Color::BLUE);
 }
 
-void RasterFont::Draw(const Frontend::EmuWindow& window, const Layout::FramebufferLayout& layout) {
+void RasterFont::UpdateDrawInfo(const Frontend::EmuWindow& window,
+                                const Layout::FramebufferLayout& layout) {
     const float scaled_density = window.GetScaleDensity();
     const int safe_left = window.GetSafeInsetLeft();
     const int safe_top = window.GetSafeInsetTop();
-    draw_info.screen_width = static_cast<float>(layout.width);
-    draw_info.screen_height = static_cast<float>(layout.height);
-    draw_info.font_width = CHARACTER_WIDTH / draw_info.screen_width * scaled_density * 1.25f;
-    draw_info.font_height = CHARACTER_HEIGHT / draw_info.screen_height * scaled_density * 1.25f;
-    draw_info.border_x = draw_info.font_width / 2.0f;
-    draw_info.border_y = draw_info.font_height / 2.0f;
-    draw_info.shadow_x = draw_info.font_width * 0.1f;
-    draw_info.shadow_y = draw_info.font_height * -0.1f;
+
+    DrawInfo info;
+    info.screen_width = static_cast<float>(layout.width);
+    info.screen_height = static_cast<float>(layout.height);
+    info.font_width = CHARACTER_WIDTH / info.screen_width * scaled_density * 1.25f;
+    info.font_height = CHARACTER_HEIGHT / info.screen_height * scaled_density * 1.25f;
+    info.border_x = info.font_width / 2.0f;
+    info.border_y = info.font_height / 2.0f;
+    info.shadow_x = info.font_width * 0.1f;
+    info.shadow_y = info.font_height * -0.1f;
 
     if (safe_left > 0) {
-        draw_info.start_x = safe_left / draw_info.screen_width * scaled_density - 1.0f;
+        info.start_x = safe_left / info.screen_width * scaled_density - 1.0f;
     } else {
-        draw_info.start_x = draw_info.font_width - 1.0f;
+        info.start_x = info.font_width - 1.0f;
     }
 
     if (safe_top > 0) {
-        draw_info.start_y = 1.0f - safe_top / draw_info.screen_height * scaled_density;
+        info.start_y = 1.0f - safe_top / info.screen_height * scaled_density;
     } else {
-        draw_info.start_y = 1.0f - draw_info.font_height * 1.5f;
+        info.start_y = 1.0f - info.font_height * 1.5f;
     }
 
-    OpenGL::OpenGLState state = OpenGL::OpenGLState::GetCurState();
-    state.draw.shader_program = shader.handle;
-    state.draw.vertex_array = vertex_array.handle;
-    state.draw.vertex_buffer = vertex_buffer.handle;
-    state.texture_units[0].texture_2d = texture.handle;
-    state.blend.enabled = true;
-    state.blend.src_rgb_func = GL_SRC_COLOR;
-    state.blend.src_a_func = GL_ZERO;
-    state.blend.dst_rgb_func = GL_ONE_MINUS_SRC_ALPHA;
-    state.blend.dst_a_func = GL_ONE;
-    state.Apply();
-
-    glActiveTexture(GL_TEXTURE0);
+    if (std::memcmp(&info, &draw_info, sizeof(DrawInfo)) != 0) {
+        draw_info = info;
+        geometry_dirty = true;
+    }
+}
 
+void RasterFont::Draw(const Frontend::EmuWindow& window, const Layout::FramebufferLayout& layout) {
     u64 now = static_cast<u64>(Common::Timer::GetTimeMs().count());
 
     if (now - debug_timestamp > 500) {
@@ -400,11 +430,34 @@ void RasterFont::Draw(const Frontend::EmuWindow& window, const Layout::Framebuff
     while (iter != messages.end()) {
         if (iter->timestamp < now) {
             iter = messages.erase(iter);
+            geometry_dirty = true;
         } else {
-            DrawText(iter->text, iter->color);
             ++iter;
         }
     }
+
+    UpdateDrawInfo(window, layout);
+
+    OpenGL::OpenGLState state = OpenGL::OpenGLState::GetCurState();
+    state.draw.shader_program = shader.handle;
+    state.draw.vertex_array = vertex_array.handle;
+    state.draw.vertex_buffer = vertex_buffer.handle;
+    state.texture_units[0].texture_2d = texture.handle;
+    state.blend.enabled = true;
+    state.blend.src_rgb_func = GL_SRC_COLOR;
+    state.blend.src_a_func = GL_ZERO;
+    state.blend.dst_rgb_func = GL_ONE_MINUS_SRC_ALPHA;
+    state.blend.dst_a_func = GL_ONE;
+    state.Apply();
+
+    // The text only changes every few hundred milliseconds, most frames reuse the uploaded quads
+    if (geometry_dirty) {
+        UploadGeometry();
+    }
+
+    if (!vertices.empty()) {
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+    }
 }
 
 static std::unique_ptr<RasterFont> s_raster_font;
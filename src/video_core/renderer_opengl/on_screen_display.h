@@ -17,6 +17,7 @@ namespace OSD {
 
 enum class MessageType {
     FPS,
+    FrameTime,
     D24S8,
     ShaderCache,
     Typeless,
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdlib>
 #include <memory>
@@ -10,6 +11,7 @@
 #include <queue>
 
 #include "common/bit_field.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -23,6 +25,8 @@
 #include "core/tracer/recorder.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_gpu_profiler.h"
+#include "video_core/renderer_opengl/gl_post_processing.h"
 #include "video_core/renderer_opengl/gl_state.h"
 #include "video_core/renderer_opengl/gl_vars.h"
 #include "video_core/renderer_opengl/on_screen_display.h"
@@ -45,24 +49,33 @@ struct OGLFrame {
     OGLFramebuffer present{};    /// FBO created on the present thread
     GLsync render_fence{};       /// Fence created on the render thread
     GLsync present_fence{};      /// Fence created on the presentation thread
+    std::chrono::steady_clock::time_point present_time{}; /// When the frame is due on screen
 };
 
+/**
+ * Hands the frames of the core thread over to the present thread. Every frame is one guest VBlank,
+ * so each one is given a present time a VBlank after the previous one. The present thread shows
+ * the newest frame that is due and drops the older ones, and keeps the frame on screen when no
+ * frame is due yet, which evens out the jitter of the frame production.
+ */
 class OGLTextureMailbox {
 public:
+    using Clock = std::chrono::steady_clock;
+
     std::mutex swap_chain_lock;
     std::condition_variable free_cv;
     std::array<OGLFrame, SWAP_CHAIN_SIZE> swap_chain{};
     std::queue<OGLFrame*> free_queue;
     std::deque<OGLFrame*> present_queue;
     OGLFrame* previous_frame = nullptr;
-    std::chrono::milliseconds elapsed{0};
+    /// Present time of the last frame released by the core thread
+    Clock::time_point last_present_time{};
+    /// Frames dropped and VBlanks with no due frame since the last report
+    u32 dropped_frames = 0;
+    u32 repeated_frames = 0;
+    Clock::time_point last_report_time = Clock::now();
 
     OGLTextureMailbox() {
-        if (Settings::values.use_frame_limit) {
-            // min to 1, speed 200%
-            u16 time = std::max(200 - Settings::values.frame_limit, 2) >> 1;
-            elapsed = std::chrono::milliseconds{time};
-        }
         for (auto& frame : swap_chain) {
             free_queue.push(&frame);
         }
@@ -79,13 +92,12 @@ public:
 
     /// called in core thread
     void ResetPresent() {
-        if (!present_queue.empty()) {
-            std::scoped_lock lock(swap_chain_lock);
-            for (auto& frame : present_queue) {
-                free_queue.push(frame);
-            }
-            present_queue.clear();
+        std::scoped_lock lock(swap_chain_lock);
+        for (auto& frame : present_queue) {
+            free_queue.push(frame);
         }
+        present_queue.clear();
+        last_present_time = {};
     }
 
     /// called in core thread
@@ -112,6 +124,17 @@ public:
         frame->color_reloaded = true;
     }
 
+    /// The longest the core thread waits for a free frame: one frame at the speed the frame
+    /// limiter targets, so that the wait does not add up with its sleep into a stutter
+    static std::chrono::microseconds GetFrameWaitTime() {
+        if (!Settings::values.use_frame_limit) {
+            return std::chrono::microseconds::zero();
+        }
+        const double speed = std::max<u16>(Settings::values.frame_limit, 1) / 100.0;
+        return std::chrono::microseconds{
+            static_cast<s64>(1'000'000 / (GPU::SCREEN_REFRESH_RATE * speed))};
+    }
+
     /// called in core thread
     OGLFrame* GetRenderFrame() {
         std::unique_lock<std::mutex> lock(swap_chain_lock);
@@ -119,7 +142,7 @@ public:
         // If theres no free frames, we will reuse the oldest render frame
         if (free_queue.empty()) {
             // wait for new entries in the present_queue
-            free_cv.wait_for(lock, elapsed, [this] { return !free_queue.empty(); });
+            free_cv.wait_for(lock, GetFrameWaitTime(), [this] { return !free_queue.empty(); });
             if (free_queue.empty()) {
                 auto frame = present_queue.front();
                 present_queue.pop_front();
@@ -139,35 +162,66 @@ public:
 
     /// called in core thread
     void ReleaseRenderFrame(OGLFrame* frame) {
+        const auto now = Clock::now();
+        const auto interval = GetFrameWaitTime();
         std::unique_lock<std::mutex> lock(swap_chain_lock);
+
+        // A late frame is due right away and starts the cadence over. The cadence also restarts
+        // when it got ahead of the frames by more than the queue absorbs, e.g. after a slowdown.
+        Clock::time_point present_time = last_present_time + interval;
+        if (present_time < now || present_time > now + 2 * interval) {
+            present_time = now;
+        }
+        frame->present_time = present_time;
+        last_present_time = present_time;
         present_queue.push_back(frame);
     }
 
     /// called in present thread
     OGLFrame* TryGetPresentFrame() {
-        if (present_queue.empty()) {
-            return nullptr;
-        } else {
-            std::unique_lock<std::mutex> lock(swap_chain_lock);
+        const auto now = Clock::now();
+        std::unique_lock<std::mutex> lock(swap_chain_lock);
+        ReportPacing(now);
 
-            // free the previous frame and add it back to the free queue
+        // Frames due by the middle of the coming guest VBlank can be shown in this refresh
+        const auto deadline = now + GetFrameWaitTime() / 2;
+        if (present_queue.empty() || present_queue.front()->present_time > deadline) {
             if (previous_frame) {
-                free_queue.push(previous_frame);
-                free_cv.notify_one();
+                ++repeated_frames;
             }
+            return nullptr;
+        }
 
-            // the newest entries are pushed to the front of the queue
-            previous_frame = present_queue.front();
+        // free the previous frame and add it back to the free queue
+        if (previous_frame) {
+            free_queue.push(previous_frame);
+        }
+
+        // Only the newest due frame is shown, the older ones missed their refresh
+        while (present_queue.size() > 1 && present_queue[1]->present_time <= deadline) {
+            free_queue.push(present_queue.front());
             present_queue.pop_front();
+            ++dropped_frames;
+        }
+        free_cv.notify_one();
 
-            if (present_queue.size() > 1) {
-                // skip a frame if pendings more than 1
-                free_queue.push(present_queue.front());
-                present_queue.pop_front();
-            }
+        previous_frame = present_queue.front();
+        present_queue.pop_front();
+        return previous_frame;
+    }
 
-            return previous_frame;
+    /// called in present thread, requires swap_chain_lock
+    void ReportPacing(Clock::time_point now) {
+        if (now - last_report_time < std::chrono::seconds{5}) {
+            return;
+        }
+        if (dropped_frames != 0 || repeated_frames != 0) {
+            LOG_DEBUG(Render_OpenGL, "Presentation dropped {} frames and repeated {} frames",
+                      dropped_frames, repeated_frames);
         }
+        dropped_frames = 0;
+        repeated_frames = 0;
+        last_report_time = now;
     }
 
     /// called in present thread
@@ -218,34 +272,6 @@ void main() {
 }
 )";
 
-static const char post_processing_header[] = R"(
-// hlsl to glsl types
-#define float2 vec2
-#define float3 vec3
-#define float4 vec4
-#define uint2 uvec2
-#define uint3 uvec3
-#define uint4 uvec4
-#define int2 ivec2
-#define int3 ivec3
-#define int4 ivec4
-
-in float2 frag_tex_coord;
-out float4 output_color;
-
-uniform float4 resolution;
-uniform sampler2D color_texture;
-
-float4 Sample() { return texture(color_texture, frag_tex_coord); }
-float4 SampleLocation(float2 location) { return texture(color_texture, location); }
-float4 SampleFetch(int2 location) { return texelFetch(color_texture, location, 0); }
-int2 SampleSize() { return textureSize(color_texture, 0); }
-float2 GetResolution() { return resolution.xy; }
-float2 GetInvResolution() { return resolution.zw; }
-float2 GetCoordinates() { return frag_tex_coord; }
-void SetOutput(float4 color) { output_color = color; }
-)";
-
 /**
  * Vertex structure that the drawn screen rectangles are composed of.
  */
@@ -280,81 +306,26 @@ static std::array<GLfloat, 3 * 2> MakeOrthographicMatrix(float width, float heig
     return matrix;
 }
 
-/**
- * option example: //! key = value
- * @param shader
- * @param options
- */
-static void ParsePostShaderOptions(const std::string& shader,
-                                   std::unordered_map<std::string, std::string>& options) {
-    std::size_t i = 0;
-    std::size_t size = shader.size();
-
-    std::string key;
-    std::string value;
-
-    bool is_line_begin = true;
-    u32 slash_counter = 0;
-    bool is_option_key = false;
-    bool is_option_value = false;
-    while (i < size) {
-        char c = shader[i++];
-        switch (c) {
-        case '/':
-            slash_counter += 1;
-            break;
-        case '!':
-            if (is_line_begin && (slash_counter == 2)) {
-                is_option_key = true;
-            }
-            is_line_begin = false;
-            break;
-        case '=':
-            if (is_option_key) {
-                is_option_key = false;
-                is_option_value = true;
-            }
-            is_line_begin = false;
-            break;
-        case ' ':
-        case '\t':
-            is_line_begin = false;
-            break;
-        case '\n':
-        case '\r':
-            is_line_begin = true;
-            is_option_key = false;
-            is_option_value = false;
-            slash_counter = 0;
-            if (!key.empty() && !value.empty()) {
-                options[key] = value;
-                key.clear();
-                value.clear();
-            }
-            break;
-        default:
-            if (is_option_key) {
-                key += c;
-            } else if (is_option_value) {
-                value += c;
-            }
-            is_line_begin = false;
-            break;
-        }
-    }
-}
-
 RendererOpenGL::RendererOpenGL(Frontend::EmuWindow& window, bool use_gles) : RendererBase{window} {
     OpenGL::GLES = use_gles;
     mailbox = std::make_unique<OGLTextureMailbox>();
 }
 
 RendererOpenGL::~RendererOpenGL() {
+    GPUProfiler::Shutdown();
     OSD::Shutdown();
 }
 
 /// Swap buffers (render frame)
 void RendererOpenGL::SwapBuffers() {
+    // Skipped frames are not presented, the window keeps showing the last one
+    if (VideoCore::IsFrameSkipped() && !VideoCore::g_screenshot_complete_callback) {
+        Core::System::GetInstance().perf_stats->AddSavedGLCalls(OpenGLState::TakeSavedCalls());
+        GPUProfiler::FrameUpdate();
+        VideoCore::FrameUpdate();
+        return;
+    }
+
     const Layout::FramebufferLayout& layout = render_window.GetFramebufferLayout();
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
@@ -364,6 +335,14 @@ void RendererOpenGL::SwapBuffers() {
     state.viewport.height = layout.height;
     state.Apply();
 
+    // Static screens, e.g. in menus, are neither drawn nor swapped again, which lets the GPU and
+    // the display of phones idle. The framebuffers the GSP swaps in are other cached surfaces,
+    // so the swaps show up as changes of the display textures. The frame counter of the on
+    // screen display changes all the time.
+    bool redraw = force_redraw.exchange(false) || Settings::values.show_fps ||
+                  layout != drawn_layout;
+    drawn_layout = layout;
+
     for (int i : {0, 2}) {
         int fb_id = i == 2 ? 1 : 0;
         const auto& framebuffer = GPU::g_regs.framebuffer_config[fb_id];
@@ -382,6 +361,7 @@ void RendererOpenGL::SwapBuffers() {
             // Resize the texture in case the framebuffer size has changed
             screen_infos[i].texture.width = 1;
             screen_infos[i].texture.height = 1;
+            screen_infos[i].texture.data_hash = 0;
         } else {
             if (screen_infos[i].texture.width != (GLsizei)framebuffer.width ||
                 screen_infos[i].texture.height != (GLsizei)framebuffer.height ||
@@ -393,18 +373,31 @@ void RendererOpenGL::SwapBuffers() {
             }
             LoadFBToScreenInfo(framebuffer, screen_infos[i], i == 1);
         }
+
+        const ScreenInfo& screen_info = screen_infos[i];
+        const DrawnScreen drawn{screen_info.display_texture, screen_info.display_texcoords,
+                                screen_info.display_version, color_fill.raw};
+        if (drawn.version == 0 || !(drawn == drawn_screens[i])) {
+            redraw = true;
+        }
+        drawn_screens[i] = drawn;
     }
 
     RenderScreenshot();
 
-    if (Settings::values.use_present_thread) {
-        RenderToMailbox(layout);
-    } else {
-        DrawScreens(layout);
-        render_window.SwapBuffers();
+    // Otherwise the window keeps showing the last frame
+    if (redraw) {
+        if (Settings::values.use_present_thread) {
+            RenderToMailbox(layout);
+        } else {
+            DrawScreens(layout);
+            render_window.SwapBuffers();
+        }
     }
     prev_state.Apply();
 
+    Core::System::GetInstance().perf_stats->AddSavedGLCalls(OpenGLState::TakeSavedCalls());
+    GPUProfiler::FrameUpdate();
     VideoCore::FrameUpdate();
 }
 
@@ -479,9 +472,11 @@ void RendererOpenGL::RenderToMailbox(const Layout::FramebufferLayout& layout) {
 bool RendererOpenGL::TryPresent() {
     auto frame = mailbox->TryGetPresentFrame();
     if (!frame) {
-        LOG_DEBUG(Render_OpenGL, "TryGetPresentFrame returned no frame to present");
         return false;
     }
+    present_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          frame->present_time.time_since_epoch())
+                          .count();
 
     const auto& layout = render_window.GetFramebufferLayout();
 
@@ -515,6 +510,7 @@ bool RendererOpenGL::TryPresent() {
 ///
 void RendererOpenGL::ResetPresent() {
     mailbox->ResetPresent();
+    force_redraw = true;
 }
 
 void RendererOpenGL::LoadBackgroundImage(u32* pixels, u32 width, u32 height) {
@@ -531,6 +527,7 @@ void RendererOpenGL::LoadBackgroundImage(u32* pixels, u32 width, u32 height) {
         float r = static_cast<float>((pixel >> 16) & 255) / 255.0f;
         glClearColor(r, g, b, 0.0f);
         bg_texture.Release();
+        force_redraw = true;
         return;
     }
 
@@ -575,6 +572,7 @@ void main() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     OpenGLState::BindTexture2D(0, old_tex);
+    force_redraw = true;
 }
 
 /**
@@ -607,14 +605,24 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
 
     if (!VideoCore::Rasterizer()->AccelerateDisplay(framebuffer, framebuffer_addr,
                                                     static_cast<u32>(pixel_stride), screen_info)) {
-        // Reset the screen info's display texture to its own permanent texture
-        screen_info.display_texture = screen_info.texture.resource.handle;
-        screen_info.display_texcoords = Common::Rectangle<float>(0.f, 0.f, 1.f, 1.f);
-
         Memory::RasterizerFlushRegion(framebuffer_addr, framebuffer.stride * framebuffer.height);
 
         const u8* framebuffer_data = VideoCore::Memory()->GetPhysicalPointer(framebuffer_addr);
 
+        // Frames the CPU didn't change aren't uploaded again
+        const u64 data_hash =
+            Common::ComputeHash64(framebuffer_data, framebuffer.stride * framebuffer.height);
+        if (screen_info.display_texture == screen_info.texture.resource.handle &&
+            screen_info.texture.data_hash == data_hash) {
+            return;
+        }
+
+        // Reset the screen info's display texture to its own permanent texture
+        screen_info.display_texture = screen_info.texture.resource.handle;
+        screen_info.display_texcoords = Common::Rectangle<float>(0.f, 0.f, 1.f, 1.f);
+        screen_info.display_version = ++upload_count;
+        screen_info.texture.data_hash = data_hash;
+
         GLuint old_tex = OpenGLState::BindTexture2D(0, screen_info.texture.resource.handle);
 
         glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)pixel_stride);
@@ -683,19 +691,17 @@ void RendererOpenGL::InitOpenGLObjects() {
     if (GLES) {
         frag_source += fragment_shader_precision_OES;
     }
-    if (!Settings::values.pp_shader_name.empty()) {
-        std::string pp_shader = FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) +
-                                Settings::values.pp_shader_name + ".glsl";
-        std::size_t size = FileUtil::ReadFileToString(true, pp_shader, pp_shader);
-        if (size > 0 && size == pp_shader.size()) {
-            std::unordered_map<std::string, std::string> options;
-            ParsePostShaderOptions(pp_shader, options);
-            linear_mag_filter = options["mag_filter"] != "nearest";
-            linear_min_filter = options["min_filter"] != "nearest";
-            frag_source += post_processing_header;
-            frag_source += pp_shader;
-        } else {
-            frag_source += fragment_shader;
+    std::unordered_map<std::string, std::string> options;
+    if (!Settings::values.pp_shader_name.empty() &&
+        LoadPostShader(Settings::values.pp_shader_name, frag_source, options)) {
+        linear_mag_filter = options["mag_filter"] != "nearest";
+        linear_min_filter = options["min_filter"] != "nearest";
+        // The passes listed by the shader run before it
+        if (!options["passes"].empty()) {
+            post_processing_chain = std::make_unique<PostProcessingChain>();
+            if (!post_processing_chain->Load(options["passes"])) {
+                post_processing_chain.reset();
+            }
         }
     } else {
         frag_source += fragment_shader;
@@ -778,6 +784,7 @@ void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
     texture.format = format;
     texture.width = framebuffer.width;
     texture.height = framebuffer.height;
+    texture.data_hash = 0;
 
     switch (format) {
     case GPU::Regs::PixelFormat::RGBA8:
@@ -832,33 +839,47 @@ void RendererOpenGL::ConfigureFramebufferTexture(TextureInfo& texture,
  * Draws a single texture to the emulator window, rotating the texture to correct for the 3DS's LCD
  * rotation.
  */
-void RendererOpenGL::DrawSingleScreenRotated(u32 index) {
-    const ScreenInfo& screen_info = screen_infos[index];
-    OpenGLState::BindTexture2D(0, screen_info.display_texture);
-
-    float src_width = screen_info.texture.width * Settings::values.resolution_factor;
-    float src_height = screen_info.texture.height * Settings::values.resolution_factor;
-    glUniform4f(uniform_resolution, src_width, src_height, 1.0f / src_width, 1.0f / src_height);
+void RendererOpenGL::DrawSingleScreenRotated(u32 index, const PostProcessingChain::Output& input) {
+    OpenGLState::BindTexture2D(0, input.texture);
+    glUniform4f(uniform_resolution, input.width, input.height, 1.0f / input.width,
+                1.0f / input.height);
 
     glDrawArrays(GL_TRIANGLE_STRIP, index * 2, 4);
 }
 
+/**
+ * Returns the texture the last post-processing pass draws to the window for a screen.
+ */
+PostProcessingChain::Output RendererOpenGL::ProcessScreen(u32 index, bool enabled) {
+    const ScreenInfo& screen_info = screen_infos[index];
+    const float src_width = screen_info.texture.width * Settings::values.resolution_factor;
+    const float src_height = screen_info.texture.height * Settings::values.resolution_factor;
+    if (post_processing_chain && enabled) {
+        return post_processing_chain->Run(index, screen_info, src_width, src_height);
+    }
+    return {screen_info.display_texture, screen_info.display_texcoords, src_width, src_height};
+}
+
 /**
  * Draws the emulated screens to the emulator window.
  */
 void RendererOpenGL::DrawScreens(const Layout::FramebufferLayout& layout) {
+    GPUProfiler::Scope gpu_scope(VideoCore::GPUTiming::SectionType::Present);
     OpenGLState::BindSampler(0, filter_sampler.handle);
 
     // Set projection matrix
     std::array<GLfloat, 3 * 2> ortho_matrix = MakeOrthographicMatrix(layout.width, layout.height);
     glUniformMatrix3x2fv(uniform_modelview_matrix, 1, GL_FALSE, ortho_matrix.data());
 
+    const PostProcessingChain::Output top_input = ProcessScreen(0, layout.top_screen_enabled);
+    const PostProcessingChain::Output bottom_input = ProcessScreen(2, layout.bottom_screen_enabled);
+
     // Set vertices
     const auto& top_screen = layout.top_screen;
-    const auto& top_texcoords = screen_infos[0].display_texcoords;
+    const auto& top_texcoords = top_input.texcoords;
 
     const auto& bottom_screen = layout.bottom_screen;
-    const auto& bottom_texcoords = screen_infos[2].display_texcoords;
+    const auto& bottom_texcoords = bottom_input.texcoords;
 
     const std::array<ScreenRectVertex, 8> vertices = {{
         // top screen
@@ -895,11 +916,11 @@ void RendererOpenGL::DrawScreens(const Layout::FramebufferLayout& layout) {
     }
 
     if (layout.top_screen_enabled) {
-        DrawSingleScreenRotated(0);
+        DrawSingleScreenRotated(0, top_input);
     }
 
     if (layout.bottom_screen_enabled) {
-        DrawSingleScreenRotated(2);
+        DrawSingleScreenRotated(2, bottom_input);
     }
 
     // draw on screen display
@@ -929,6 +950,8 @@ VideoCore::ResultStatus RendererOpenGL::Init() {
         return VideoCore::ResultStatus::ErrorBelowGL33;
     }
 
+    // The context is new, the state left over from a previous one doesn't apply
+    OpenGLState::Invalidate();
     InitOpenGLObjects();
 
     return VideoCore::ResultStatus::Success;
@@ -5,18 +5,18 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <memory>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
+#include "core/frontend/framebuffer_layout.h"
 #include "core/hw/gpu.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_post_processing.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_state.h"
 
-namespace Layout {
-struct FramebufferLayout;
-}
-
 namespace OpenGL {
 
 class OGLTextureMailbox;
@@ -29,12 +29,16 @@ struct TextureInfo {
     GPU::Regs::PixelFormat format;
     GLenum gl_format;
     GLenum gl_type;
+    /// Hash of the frame last uploaded from 3DS memory, zero when the contents are unknown
+    u64 data_hash = 0;
 };
 
 /// Structure used for storing information about the display target for each 3DS screen
 struct ScreenInfo {
     GLuint display_texture;
     Common::Rectangle<float> display_texcoords;
+    /// Changes with the contents of the display texture, zero when they are unknown
+    u64 display_version = 0;
     TextureInfo texture;
 };
 
@@ -65,7 +69,8 @@ private:
                                      const GPU::Regs::FramebufferConfig& framebuffer);
     void RenderScreenshot();
     void DrawScreens(const Layout::FramebufferLayout& layout);
-    void DrawSingleScreenRotated(u32 index);
+    void DrawSingleScreenRotated(u32 index, const PostProcessingChain::Output& input);
+    PostProcessingChain::Output ProcessScreen(u32 index, bool enabled);
     void RenderToMailbox(const Layout::FramebufferLayout& layout);
 
     // Loads framebuffer from emulated memory into the display information structure
@@ -84,12 +89,34 @@ private:
     OGLProgram shader;
     OGLSampler filter_sampler;
 
+    /// Passes of the post-processing shader that run before it
+    std::unique_ptr<PostProcessingChain> post_processing_chain;
+
     OGLProgram bg_shader;
     OGLTexture bg_texture;
 
     /// Display information for top and bottom screens respectively
     std::array<ScreenInfo, 3> screen_infos;
 
+    /// What a screen showed in the last frame drawn to the window
+    struct DrawnScreen {
+        GLuint texture = 0;
+        Common::Rectangle<float> texcoords;
+        u64 version = 0;
+        u32 color_fill = 0;
+
+        bool operator==(const DrawnScreen& other) const {
+            return texture == other.texture && texcoords == other.texcoords &&
+                   version == other.version && color_fill == other.color_fill;
+        }
+    };
+    std::array<DrawnScreen, 3> drawn_screens{};
+    Layout::FramebufferLayout drawn_layout{};
+    /// Set when the window has to be drawn even if the screens didn't change
+    std::atomic<bool> force_redraw{true};
+    /// Source of the display versions of the frames uploaded from 3DS memory
+    u64 upload_count = 0;
+
     // Shader uniform location indices
     GLuint uniform_modelview_matrix;
     GLuint uniform_resolution;
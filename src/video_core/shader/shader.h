@@ -256,6 +256,16 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader on several shader units in one call, which saves the
+     * per-invocation overhead of Run. The units are processed in order.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param states Shader unit states, each must be setup with its own input data.
+     * @param count Number of shader unit states.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, UnitState* states, std::size_t count) const = 0;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
@@ -0,0 +1,1098 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdint>
+#include <nihstro/shader_bytecode.h>
+#include "common/aarch64/a64_emitter.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/vector_math.h"
+#include "video_core/pica_state.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_a64_compiler.h"
+
+using namespace Common::A64;
+
+namespace Pica::Shader {
+
+typedef void (JitShader::*JitFunction)(Instruction instr);
+
+const JitFunction instr_table[64] = {
+    &JitShader::Compile_ADD,    // add
+    &JitShader::Compile_DP3,    // dp3
+    &JitShader::Compile_DP4,    // dp4
+    &JitShader::Compile_DPH,    // dph
+    nullptr,                    // unknown
+    &JitShader::Compile_EX2,    // ex2
+    &JitShader::Compile_LG2,    // lg2
+    nullptr,                    // unknown
+    &JitShader::Compile_MUL,    // mul
+    &JitShader::Compile_SGE,    // sge
+    &JitShader::Compile_SLT,    // slt
+    &JitShader::Compile_FLR,    // flr
+    &JitShader::Compile_MAX,    // max
+    &JitShader::Compile_MIN,    // min
+    &JitShader::Compile_RCP,    // rcp
+    &JitShader::Compile_RSQ,    // rsq
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    &JitShader::Compile_MOVA,   // mova
+    &JitShader::Compile_MOV,    // mov
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    &JitShader::Compile_DPH,    // dphi
+    nullptr,                    // unknown
+    &JitShader::Compile_SGE,    // sgei
+    &JitShader::Compile_SLT,    // slti
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    nullptr,                    // unknown
+    &JitShader::Compile_NOP,    // nop
+    &JitShader::Compile_END,    // end
+    &JitShader::Compile_BREAKC, // breakc
+    &JitShader::Compile_CALL,   // call
+    &JitShader::Compile_CALLC,  // callc
+    &JitShader::Compile_CALLU,  // callu
+    &JitShader::Compile_IF,     // ifu
+    &JitShader::Compile_IF,     // ifc
+    &JitShader::Compile_LOOP,   // loop
+    &JitShader::Compile_EMIT,   // emit
+    &JitShader::Compile_SETE,   // sete
+    &JitShader::Compile_JMP,    // jmpc
+    &JitShader::Compile_JMP,    // jmpu
+    &JitShader::Compile_CMP,    // cmp
+    &JitShader::Compile_CMP,    // cmp
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // madi
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+    &JitShader::Compile_MAD,    // mad
+};
+
+// The following is used to alias some commonly used registers. Generally, X0-X15 and V0-V7 can be
+// used as scratch registers within a compiler function. The other registers have designated
+// purposes, as documented below:
+
+/// Pointer to the uniform memory
+static constexpr XReg UNIFORMS = X(19);
+/// Pointer to the UnitState instance for the current VS unit
+static constexpr XReg STATE = X(20);
+/// The two 32-bit VS address offset registers set by the MOVA instruction, sign extended to 64 bits
+static constexpr XReg ADDROFFS_REG_0 = X(21);
+static constexpr XReg ADDROFFS_REG_1 = X(22);
+/// VS loop count register (Multiplied by 16)
+static constexpr XReg LOOPCOUNT_REG = X(23);
+/// Current VS loop iteration number (we could probably use LOOPCOUNT_REG, but this quicker)
+static constexpr WReg LOOPCOUNT = W(24);
+/// Number to increment LOOPCOUNT_REG by on each loop iteration (Multiplied by 16)
+static constexpr WReg LOOPINC = W(25);
+/// Result of the previous CMP instruction for the X-component comparison
+static constexpr XReg COND0 = X(26);
+/// Result of the previous CMP instruction for the Y-component comparison
+static constexpr XReg COND1 = X(27);
+/// Number of shader units left in the batch, including the current one
+static constexpr XReg UNITS_LEFT = X(28);
+/// General purpose scratch registers, W0 also holds the evaluated flow control conditions
+static constexpr XReg XSCRATCH0 = X(0);
+static constexpr XReg XSCRATCH1 = X(1);
+static constexpr WReg WSCRATCH0 = W(0);
+static constexpr WReg WSCRATCH1 = W(1);
+/// SIMD scratch register
+static constexpr VReg SCRATCH = V(0);
+/// Loaded with the first swizzled source register, otherwise can be used as a scratch register
+static constexpr VReg SRC1 = V(1);
+/// Loaded with the second swizzled source register, otherwise can be used as a scratch register
+static constexpr VReg SRC2 = V(2);
+/// Loaded with the third swizzled source register, otherwise can be used as a scratch register
+static constexpr VReg SRC3 = V(3);
+/// Additional scratch registers
+static constexpr VReg SCRATCH2 = V(4);
+static constexpr VReg SCRATCH3 = V(5);
+/// Constant vector of [1.0f, 1.0f, 1.0f, 1.0f], used to efficiently set a vector to one
+static constexpr VReg ONE = V(31);
+
+// X19-X28 are callee saved, so only ONE has to be restored after calling other functions. V8-V15
+// are avoided since the callee only has to preserve their lower halves.
+
+/// Size of the stack frame set up by the compiled shader
+static constexpr u32 FRAME_SIZE = 112;
+/// Frame slot checked by Compile_Return, holds an offset no subroutine can end at
+static constexpr u32 FRAME_DUMMY_RETURN = 0;
+/// Frame slot with the address of the entry point
+static constexpr u32 FRAME_ENTRY_POINT = 8;
+
+/// Raw constant for the source register selector that indicates no swizzling is performed
+static const u8 NO_SRC_REG_SWIZZLE = 0x1b;
+/// Raw constant for the destination register enable mask that indicates all components are enabled
+static const u8 NO_DEST_REG_MASK = 0xf;
+
+static void LogCritical(const char* msg) {
+    LOG_CRITICAL(HW_GPU, "{}", msg);
+}
+
+void JitShader::Compile_CallHost(const void* function) {
+    str_pre(LR, SP, -16);
+    mov(IP0, reinterpret_cast<u64>(function));
+    blr(IP0);
+    ldr_post(LR, SP, 16);
+    fmov_one(ONE);
+}
+
+void JitShader::Compile_Assert(bool condition, const char* msg) {
+    if (!condition) {
+        mov(ABI_PARAM1, reinterpret_cast<u64>(msg));
+        Compile_CallHost(reinterpret_cast<const void*>(&LogCritical));
+    }
+}
+
+/**
+ * Loads and swizzles a source register into the specified SIMD register.
+ * @param instr VS instruction, used for determining how to load the source register
+ * @param src_num Number indicating which source register to load (1 = src1, 2 = src2, 3 = src3)
+ * @param src_reg SourceRegister object corresponding to the source register to load
+ * @param dest Destination SIMD register to store the loaded, swizzled source register
+ */
+void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
+                                   VReg dest) {
+    XReg src_ptr;
+    std::size_t src_offset;
+
+    if (src_reg.GetRegisterType() == RegisterType::FloatUniform) {
+        src_ptr = UNIFORMS;
+        src_offset = Uniforms::GetFloatUniformOffset(src_reg.GetIndex());
+    } else {
+        src_ptr = STATE;
+        src_offset = UnitState::InputOffset(src_reg);
+    }
+
+    unsigned operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    unsigned address_register_index;
+    unsigned offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    if (src_num == offset_src && address_register_index != 0) {
+        switch (address_register_index) {
+        case 1: // address offset 1
+            add(XSCRATCH0, src_ptr, ADDROFFS_REG_0);
+            break;
+        case 2: // address offset 2
+            add(XSCRATCH0, src_ptr, ADDROFFS_REG_1);
+            break;
+        case 3: // address offset 3
+            add(XSCRATCH0, src_ptr, LOOPCOUNT_REG);
+            break;
+        default:
+            UNREACHABLE();
+            break;
+        }
+        src_ptr = XSCRATCH0;
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    // Generate instructions for source register swizzling as needed
+    const u8 sel = swiz.GetRawSelector(src_num);
+    if (sel != NO_SRC_REG_SWIZZLE) {
+        // The selector holds the source component of the X lane in its top bits
+        std::array<u32, 4> components;
+        for (u32 lane = 0; lane < 4; ++lane) {
+            components[lane] = (sel >> (6 - 2 * lane)) & 3;
+        }
+
+        ldr(SCRATCH, src_ptr, static_cast<u32>(src_offset));
+        if (std::all_of(components.begin(), components.end(),
+                        [&](u32 component) { return component == components[0]; })) {
+            dup(dest, SCRATCH, components[0]);
+        } else {
+            mov(dest, SCRATCH);
+            for (u32 lane = 0; lane < 4; ++lane) {
+                if (components[lane] != lane) {
+                    ins(dest, lane, SCRATCH, components[lane]);
+                }
+            }
+        }
+    } else {
+        // Load the source
+        ldr(dest, src_ptr, static_cast<u32>(src_offset));
+    }
+
+    // If the source register should be negated, flip the negative bit
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        fneg(dest, dest);
+    }
+}
+
+void JitShader::Compile_DestEnable(Instruction instr, VReg src) {
+    DestRegister dest;
+    unsigned operand_desc_id;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        dest = instr.mad.dest.Value();
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        dest = instr.common.dest.Value();
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+
+    const u32 dest_offset = static_cast<u32>(UnitState::OutputOffset(dest));
+
+    // If all components are enabled, write the result to the destination register
+    if (swiz.dest_mask == NO_DEST_REG_MASK) {
+        // Store dest back to memory
+        str(src, STATE, dest_offset);
+
+    } else {
+        // Not all components are enabled, so merge the enabled ones into the old value
+        ldr(SCRATCH, STATE, dest_offset);
+        for (u32 lane = 0; lane < 4; ++lane) {
+            if (swiz.DestComponentEnabled(lane)) {
+                ins(SCRATCH, lane, src, lane);
+            }
+        }
+
+        // Store dest back to memory
+        str(SCRATCH, STATE, dest_offset);
+    }
+}
+
+void JitShader::Compile_SanitizedMul(VReg src1, VReg src2, VReg scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. FMULX returns 2.0 for
+    // exactly these cases and otherwise matches FMUL, so lanes where only the FMUL result is NaN
+    // are transformed to 0 to match PICA fp rules.
+    fmulx(scratch, src1, src2);
+    fmul(src1, src1, src2);
+
+    // Set scratch to mask of (FMULX result != NaN), src2 to mask of (result != NaN)
+    fcmeq(scratch, scratch, scratch);
+    fcmeq(src2, src1, src1);
+
+    // Clear components where the result is NaN but the FMULX result isn't
+    bic(scratch, scratch, src2);
+    bic(src1, src1, scratch);
+}
+
+void JitShader::Compile_EvaluateCondition(Instruction instr) {
+    // Note: NXOR is used below to check for equality
+    const auto load_condition = [this](WReg dest, XReg cond, u32 ref) {
+        if ((ref ^ 1) != 0) {
+            eor(dest, ToW(cond), 1);
+        } else {
+            mov(dest, ToW(cond));
+        }
+    };
+
+    switch (instr.flow_control.op) {
+    case Instruction::FlowControlType::Or:
+        load_condition(WSCRATCH0, COND0, instr.flow_control.refx.Value());
+        load_condition(WSCRATCH1, COND1, instr.flow_control.refy.Value());
+        orr(WSCRATCH0, WSCRATCH0, WSCRATCH1);
+        break;
+
+    case Instruction::FlowControlType::And:
+        load_condition(WSCRATCH0, COND0, instr.flow_control.refx.Value());
+        load_condition(WSCRATCH1, COND1, instr.flow_control.refy.Value());
+        and_(WSCRATCH0, WSCRATCH0, WSCRATCH1);
+        break;
+
+    case Instruction::FlowControlType::JustX:
+        load_condition(WSCRATCH0, COND0, instr.flow_control.refx.Value());
+        break;
+
+    case Instruction::FlowControlType::JustY:
+        load_condition(WSCRATCH0, COND1, instr.flow_control.refy.Value());
+        break;
+    }
+}
+
+void JitShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    ldrb(WSCRATCH0, UNIFORMS, static_cast<u32>(offset));
+}
+
+void JitShader::Compile_ADD(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    fadd(SRC1, SRC1, SRC2);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_DP3(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    // Add in the same order as the x64 JIT, (x + y) + z
+    dup(SRC2, SRC1, 1);
+    dup(SRC3, SRC1, 2);
+    dup(SRC1, SRC1, 0);
+    fadd(SRC1, SRC1, SRC2);
+    fadd(SRC1, SRC1, SRC3);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_DP4(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    faddp(SRC1, SRC1, SRC1);
+    faddp(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    // Set 4th component to 1.0
+    ins(SRC1, 3, ONE, 0);
+
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+
+    faddp(SRC1, SRC1, SRC1);
+    faddp(SRC1, SRC1, SRC1);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_EX2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    str_pre(LR, SP, -16);
+    bl(exp2_subroutine);
+    ldr_post(LR, SP, 16);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_LG2(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    str_pre(LR, SP, -16);
+    bl(log2_subroutine);
+    ldr_post(LR, SP, 16);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_MUL(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_SGE(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    fcmge(SRC2, SRC1, SRC2);
+    and_(SRC2, SRC2, ONE);
+
+    Compile_DestEnable(instr, SRC2);
+}
+
+void JitShader::Compile_SLT(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    fcmgt(SRC1, SRC2, SRC1);
+    and_(SRC1, SRC1, ONE);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_FLR(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    frintm(SRC1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_MAX(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    // FMAX propagates NaNs, the PICA200 returns SRC2 instead like SSE does. Select with a compare.
+    fcmgt(SCRATCH, SRC1, SRC2);
+    bif(SRC1, SRC2, SCRATCH);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_MIN(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    // FMIN propagates NaNs, the PICA200 returns SRC2 instead like SSE does. Select with a compare.
+    fcmgt(SCRATCH, SRC2, SRC1);
+    bif(SRC1, SRC2, SCRATCH);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_MOVA(Instruction instr) {
+    SwizzlePattern swiz = {(*swizzle_data)[instr.common.operand_desc_id]};
+
+    if (!swiz.DestComponentEnabled(0) && !swiz.DestComponentEnabled(1)) {
+        return; // NoOp
+    }
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // Convert floats to integers using truncation (only care about X and Y components)
+    fcvtzs(SRC1, SRC1);
+
+    // Get result
+    umov_d0(XSCRATCH0, SRC1);
+
+    // Sign extend each component and multiply it by 16 to be used as an offset later
+    if (swiz.DestComponentEnabled(0)) {
+        sbfiz(ADDROFFS_REG_0, XSCRATCH0, 4, 32);
+    }
+    if (swiz.DestComponentEnabled(1)) {
+        asr(ADDROFFS_REG_1, XSCRATCH0, 32);
+        lsl(ADDROFFS_REG_1, ADDROFFS_REG_1, 4);
+    }
+}
+
+void JitShader::Compile_MOV(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // FRECPE is only accurate to 8 bits, a division matches the interpreter
+    fdiv(S(SRC1), S(ONE), S(SRC1));
+    dup(SRC1, SRC1, 0); // XYWZ -> XXXX
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+
+    // FRSQRTE is only accurate to 8 bits, a square root and a division match the interpreter
+    fsqrt(S(SRC1), S(SRC1));
+    fdiv(S(SRC1), S(ONE), S(SRC1));
+    dup(SRC1, SRC1, 0); // XYWZ -> XXXX
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_NOP(Instruction instr) {}
+
+void JitShader::Compile_END(Instruction instr) {
+    // Save conditional code
+    strb(ToW(COND0), STATE, offsetof(UnitState, conditional_code[0]));
+    strb(ToW(COND1), STATE, offsetof(UnitState, conditional_code[1]));
+
+    // Save address/loop registers
+    asr(ADDROFFS_REG_0, ADDROFFS_REG_0, 4);
+    asr(ADDROFFS_REG_1, ADDROFFS_REG_1, 4);
+    asr(ToW(LOOPCOUNT_REG), ToW(LOOPCOUNT_REG), 4);
+    str(ToW(ADDROFFS_REG_0), STATE, offsetof(UnitState, address_registers[0]));
+    str(ToW(ADDROFFS_REG_1), STATE, offsetof(UnitState, address_registers[1]));
+    str(ToW(LOOPCOUNT_REG), STATE, offsetof(UnitState, address_registers[2]));
+
+    b(end_unit_label);
+}
+
+void JitShader::Compile_BREAKC(Instruction instr) {
+    Compile_Assert(looping, "BREAKC must be inside a LOOP");
+    if (looping) {
+        Compile_EvaluateCondition(instr);
+        ASSERT(loop_break_label);
+        cbnz(WSCRATCH0, *loop_break_label);
+    }
+}
+
+void JitShader::Compile_CALL(Instruction instr) {
+    // Push offset of the return, along with the link register of the caller
+    mov(XSCRATCH0, instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+    stp_pre(XSCRATCH0, LR, SP, -16);
+
+    // Call the subroutine
+    bl(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Restore the link register, skipping over the return offset
+    ldp_post(XSCRATCH0, LR, SP, 16);
+}
+
+void JitShader::Compile_CALLC(Instruction instr) {
+    Compile_EvaluateCondition(instr);
+    Label b;
+    cbz(WSCRATCH0, b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    cbz(WSCRATCH0, b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitShader::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    Op op_x = instr.common.compare_op.x;
+    Op op_y = instr.common.compare_op.y;
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    // NEON only has EQ, GE and GT comparisons, the others swap the operands or invert the result.
+    // Every ordered comparison is false for NaNs, and NotEqual is true, like on the x64 JIT.
+    const auto compare = [this](VReg dest, Op op) {
+        switch (op) {
+        case Op::Equal:
+            fcmeq(dest, SRC1, SRC2);
+            break;
+        case Op::NotEqual:
+            fcmeq(dest, SRC1, SRC2);
+            mvn(dest, dest);
+            break;
+        case Op::LessThan:
+            fcmgt(dest, SRC2, SRC1);
+            break;
+        case Op::LessEqual:
+            fcmge(dest, SRC2, SRC1);
+            break;
+        case Op::GreaterThan:
+            fcmgt(dest, SRC1, SRC2);
+            break;
+        case Op::GreaterEqual:
+            fcmge(dest, SRC1, SRC2);
+            break;
+        default:
+            LOG_ERROR(HW_GPU, "Unknown compare mode {:x}", static_cast<int>(op));
+            eor(dest, dest, dest);
+            break;
+        }
+    };
+
+    compare(SCRATCH, op_x);
+    umov_d0(XSCRATCH0, SCRATCH);
+    if (op_x == op_y) {
+        // Both components were compared together
+        mov(XSCRATCH1, XSCRATCH0);
+    } else {
+        compare(SCRATCH2, op_y);
+        umov_d0(XSCRATCH1, SCRATCH2);
+    }
+
+    // Take the top bit of the X and Y lane results
+    ubfx(COND0, XSCRATCH0, 31, 1);
+    lsr(COND1, XSCRATCH1, 63);
+}
+
+void JitShader::Compile_MAD(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.mad.src1, SRC1);
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2i, SRC2);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3i, SRC3);
+    } else {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2, SRC2);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3);
+    }
+
+    // Not fused, so that the rounding matches the other backends
+    Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
+    fadd(SRC1, SRC1, SRC3);
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShader::Compile_IF(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards if-statements not supported");
+    Label l_else, l_endif;
+
+    // Evaluate the "IF" condition
+    if (instr.opcode.Value() == OpCode::Id::IFU) {
+        Compile_UniformCondition(instr);
+    } else if (instr.opcode.Value() == OpCode::Id::IFC) {
+        Compile_EvaluateCondition(instr);
+    }
+    cbz(WSCRATCH0, l_else);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        L(l_else);
+        return;
+    }
+
+    b(l_endif);
+
+    L(l_else);
+    // This code corresponds to the "ELSE" condition
+    // Comple the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    L(l_endif);
+}
+
+void JitShader::Compile_LOOP(Instruction instr) {
+    Compile_Assert(instr.flow_control.dest_offset >= program_counter,
+                   "Backwards loops not supported");
+    Compile_Assert(!looping, "Nested loops not supported");
+
+    looping = true;
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
+    // The Y (LOOPCOUNT_REG) and Z (LOOPINC) component are kept multiplied by 16 (Left shifted by
+    // 4 bits) to be used as an offset into the 16-byte vector registers later
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    ldr(LOOPCOUNT, UNIFORMS, static_cast<u32>(offset));
+    ubfx(ToW(LOOPCOUNT_REG), LOOPCOUNT, 8, 8); // Y-component is the start
+    lsl(ToW(LOOPCOUNT_REG), ToW(LOOPCOUNT_REG), 4);
+    ubfx(LOOPINC, LOOPCOUNT, 16, 8); // Z-component is the incrementer
+    lsl(LOOPINC, LOOPINC, 4);
+    ubfx(LOOPCOUNT, LOOPCOUNT, 0, 8); // X-component is iteration count
+    add(LOOPCOUNT, LOOPCOUNT, 1);     // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    loop_break_label.emplace();
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(ToW(LOOPCOUNT_REG), ToW(LOOPCOUNT_REG), LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    subs(LOOPCOUNT, LOOPCOUNT, 1);                        // Increment loop count by 1
+    b(Cond::NE, l_loop_start);                            // Loop if not equal
+    L(*loop_break_label);
+    loop_break_label.reset();
+
+    looping = false;
+}
+
+void JitShader::Compile_JMP(Instruction instr) {
+    if (instr.opcode.Value() == OpCode::Id::JMPC)
+        Compile_EvaluateCondition(instr);
+    else if (instr.opcode.Value() == OpCode::Id::JMPU)
+        Compile_UniformCondition(instr);
+    else
+        UNREACHABLE();
+
+    bool inverted_condition =
+        (instr.opcode.Value() == OpCode::Id::JMPU) && (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        cbz(WSCRATCH0, b);
+    } else {
+        cbnz(WSCRATCH0, b);
+    }
+}
+
+static void Emit(GSEmitter* emitter, Common::Vec4<float24> (*output)[16]) {
+    emitter->Emit(*output);
+}
+
+void JitShader::Compile_EMIT(Instruction instr) {
+    Label have_emitter, end;
+    ldr(XSCRATCH0, STATE, offsetof(UnitState, emitter_ptr));
+    cbnz(XSCRATCH0, have_emitter);
+
+    mov(ABI_PARAM1, reinterpret_cast<u64>("Execute EMIT on VS"));
+    Compile_CallHost(reinterpret_cast<const void*>(&LogCritical));
+    b(end);
+
+    L(have_emitter);
+    // ABI_PARAM1 already holds the emitter
+    add(ABI_PARAM2, STATE, static_cast<u32>(offsetof(UnitState, registers.output)));
+    Compile_CallHost(reinterpret_cast<const void*>(&Emit));
+    L(end);
+}
+
+void JitShader::Compile_SETE(Instruction instr) {
+    Label have_emitter, end;
+    ldr(XSCRATCH0, STATE, offsetof(UnitState, emitter_ptr));
+    cbnz(XSCRATCH0, have_emitter);
+
+    mov(ABI_PARAM1, reinterpret_cast<u64>("Execute SETEMIT on VS"));
+    Compile_CallHost(reinterpret_cast<const void*>(&LogCritical));
+    b(end);
+
+    L(have_emitter);
+    mov(WSCRATCH1, instr.setemit.vertex_id);
+    strb(WSCRATCH1, XSCRATCH0, offsetof(GSEmitter, vertex_id));
+    mov(WSCRATCH1, instr.setemit.prim_emit);
+    strb(WSCRATCH1, XSCRATCH0, offsetof(GSEmitter, prim_emit));
+    mov(WSCRATCH1, instr.setemit.winding);
+    strb(WSCRATCH1, XSCRATCH0, offsetof(GSEmitter, winding));
+    L(end);
+}
+
+void JitShader::Compile_Block(unsigned end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    ldr(XSCRATCH0, SP, 0);
+    cmp(XSCRATCH0, program_counter);
+
+    // If so, jump back to before CALL
+    Label l_continue;
+    b(Cond::NE, l_continue);
+    ret();
+    L(l_continue);
+}
+
+void JitShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = instr_table[static_cast<unsigned>(opcode)];
+
+    if (instr_func) {
+        // JIT the instruction!
+        ((*this).*instr_func)(instr);
+    } else {
+        // Unhandled instruction
+        LOG_CRITICAL(HW_GPU, "Unhandled instruction: 0x{:02x} (0x{:08x})",
+                     static_cast<u32>(instr.opcode.Value().EffectiveOpCode()), instr.hex);
+    }
+}
+
+void JitShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                        const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+
+    // Reset flow control state
+    program = (CompiledShader*)getCurr();
+    program_counter = 0;
+    looping = false;
+    instruction_labels.fill(Label());
+    next_unit_label = Label();
+    end_unit_label = Label();
+
+    // Find all `CALL` instructions and identify return locations
+    FindReturnOffsets();
+
+    // Save the callee saved registers. The bottom of the frame holds a dummy return offset, to
+    // catch any potential return checks (see Compile_Return) that happen in shader main routine,
+    // and the entry point.
+    sub(SP, SP, FRAME_SIZE);
+    stp(X(19), X(20), SP, 16);
+    stp(X(21), X(22), SP, 32);
+    stp(X(23), X(24), SP, 48);
+    stp(X(25), X(26), SP, 64);
+    stp(X(27), X(28), SP, 80);
+    stp(X(29), LR, SP, 96);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+    mov(UNITS_LEFT, ABI_PARAM4);
+
+    str(ABI_PARAM3, SP, FRAME_ENTRY_POINT);
+    movn(XSCRATCH0, 0);
+    str(XSCRATCH0, SP, FRAME_DUMMY_RETURN);
+
+    // Used to set a register to one
+    fmov_one(ONE);
+
+    L(next_unit_label);
+
+    // Load address/loop registers
+    ldrsw(ADDROFFS_REG_0, STATE, offsetof(UnitState, address_registers[0]));
+    ldrsw(ADDROFFS_REG_1, STATE, offsetof(UnitState, address_registers[1]));
+    ldr(ToW(LOOPCOUNT_REG), STATE, offsetof(UnitState, address_registers[2]));
+    lsl(ADDROFFS_REG_0, ADDROFFS_REG_0, 4);
+    lsl(ADDROFFS_REG_1, ADDROFFS_REG_1, 4);
+    lsl(ToW(LOOPCOUNT_REG), ToW(LOOPCOUNT_REG), 4);
+
+    // Load conditional code
+    ldrb(ToW(COND0), STATE, offsetof(UnitState, conditional_code[0]));
+    ldrb(ToW(COND1), STATE, offsetof(UnitState, conditional_code[1]));
+
+    // Jump to start of the shader program
+    ldr(XSCRATCH0, SP, FRAME_ENTRY_POINT);
+    br(XSCRATCH0);
+
+    // Compile entire program
+    Compile_Block(static_cast<unsigned>(program_code->size()));
+
+    // Every END instruction ends up here
+    L(end_unit_label);
+    add(STATE, STATE, static_cast<u32>(sizeof(UnitState)));
+    subs(UNITS_LEFT, UNITS_LEFT, 1);
+    b(Cond::NE, next_unit_label);
+
+    ldp(X(19), X(20), SP, 16);
+    ldp(X(21), X(22), SP, 32);
+    ldp(X(23), X(24), SP, 48);
+    ldp(X(25), X(26), SP, 64);
+    ldp(X(27), X(28), SP, 80);
+    ldp(X(29), LR, SP, 96);
+    add(SP, SP, FRAME_SIZE);
+    ret();
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_SHADER_SIZE, "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled shader size={}", getSize());
+}
+
+JitShader::JitShader() : Common::A64::CodeGenerator(MAX_SHADER_SIZE) {
+    CompilePrelude();
+}
+
+void JitShader::CompilePrelude() {
+    CompilePrelude_Log2();
+    CompilePrelude_Exp2();
+}
+
+void JitShader::CompilePrelude_Log2() {
+    // NEON does not have a log instruction, thus we must approximate.
+    // We perform this approximation first performaing a range reduction into the range [1.0, 2.0).
+    // A minimax polynomial which was fit for the function log2(x) / (x - 1) is then evaluated.
+    // We multiply the result by (x - 1) then restore the result into the appropriate range.
+    // The steps and the constants are the same as on the x64 JIT.
+
+    // Coefficients for the minimax polynomial.
+    // f(x) computes approximately log2(x) / (x - 1).
+    // f(x) = c4 + x * (c3 + x * (c2 + x * (c1 + x * c0)).
+    align(16);
+    const void* c0 = getCurr();
+    dw(0x3d74552f);
+    const void* c1 = getCurr();
+    dw(0xbeee7397);
+    const void* c2 = getCurr();
+    dw(0x3fbd96dd);
+    const void* c3 = getCurr();
+    dw(0xc02153f6);
+    const void* c4 = getCurr();
+    dw(0x4038d96c);
+
+    const void* positive_infinity = getCurr();
+    dw(0x7f800000);
+
+    Label input_is_nan_or_inf, input_is_zero, input_out_of_range;
+
+    align(16);
+    L(log2_subroutine);
+
+    // Here we handle edge cases: input in {NaN, 0, -Inf, Negative, Inf}.
+    fcmp_zero(S(SRC1));
+    b(Cond::VS, input_is_nan_or_inf);
+    b(Cond::LS, input_out_of_range);
+    ldr(S(SCRATCH), positive_infinity);
+    fcmp(S(SRC1), S(SCRATCH));
+    b(Cond::EQ, input_is_nan_or_inf);
+
+    // Split input
+    fmov(WSCRATCH0, S(SRC1));
+    and_(WSCRATCH1, WSCRATCH0, 0x007fffff);
+    ldr(S(SCRATCH), c0); // Preload c0.
+    orr(WSCRATCH1, WSCRATCH1, 0x3f800000);
+    fmov(S(SRC1), WSCRATCH1);
+    // SRC1 now contains the mantissa of the input.
+    fmul(S(SCRATCH), S(SCRATCH), S(SRC1));
+    ubfx(WSCRATCH0, WSCRATCH0, 23, 8);
+    sub(WSCRATCH0, WSCRATCH0, 0x7f);
+    scvtf(S(SCRATCH2), WSCRATCH0);
+    // SCRATCH2 now contains the exponent of the input.
+
+    // Complete computation of polynomial
+    ldr(S(SCRATCH3), c1);
+    fadd(S(SCRATCH), S(SCRATCH), S(SCRATCH3));
+    fmul(S(SCRATCH), S(SCRATCH), S(SRC1));
+    ldr(S(SCRATCH3), c2);
+    fadd(S(SCRATCH), S(SCRATCH), S(SCRATCH3));
+    fmul(S(SCRATCH), S(SCRATCH), S(SRC1));
+    ldr(S(SCRATCH3), c3);
+    fadd(S(SCRATCH), S(SCRATCH), S(SCRATCH3));
+    fmul(S(SCRATCH), S(SCRATCH), S(SRC1));
+    fsub(S(SRC1), S(SRC1), S(ONE));
+    ldr(S(SCRATCH3), c4);
+    fadd(S(SCRATCH), S(SCRATCH), S(SCRATCH3));
+    fmul(S(SCRATCH), S(SCRATCH), S(SRC1));
+    fadd(S(SCRATCH2), S(SCRATCH2), S(SCRATCH));
+
+    // Duplicate result across vector
+    dup(SRC1, SCRATCH2, 0);
+    ret();
+
+    L(input_is_nan_or_inf);
+    dup(SRC1, SRC1, 0);
+    ret();
+
+    L(input_out_of_range);
+    b(Cond::EQ, input_is_zero);
+    mov(WSCRATCH0, 0x7fc00000); // Default quiet NaN
+    dup(SRC1, WSCRATCH0);
+    ret();
+
+    L(input_is_zero);
+    mov(WSCRATCH0, 0xff800000); // Negative infinity
+    dup(SRC1, WSCRATCH0);
+    ret();
+}
+
+void JitShader::CompilePrelude_Exp2() {
+    // NEON does not have a exp instruction, thus we must approximate.
+    // We perform this approximation first performaing a range reduction into the range [-0.5, 0.5).
+    // A minimax polynomial which was fit for the function exp2(x) is then evaluated.
+    // We then restore the result into the appropriate range.
+
+    align(16);
+    const void* input_max = getCurr();
+    dw(0x43010000);
+    const void* input_min = getCurr();
+    dw(0xc2fdffff);
+    const void* c0 = getCurr();
+    dw(0x3c5dbe69);
+    const void* half = getCurr();
+    dw(0x3f000000);
+    const void* c1 = getCurr();
+    dw(0x3d5509f9);
+    const void* c2 = getCurr();
+    dw(0x3e773cc5);
+    const void* c3 = getCurr();
+    dw(0x3f3168b3);
+    const void* c4 = getCurr();
+    dw(0x3f800016);
+
+    Label ret_label;
+
+    align(16);
+    L(exp2_subroutine);
+
+    // Handle edge cases
+    fcmp(S(SRC1), S(SRC1));
+    b(Cond::VS, ret_label);
+    // Clamp to maximum range since we shift the value directly into the exponent.
+    ldr(S(SCRATCH3), input_max);
+    fmin(S(SRC1), S(SRC1), S(SCRATCH3));
+    ldr(S(SCRATCH3), input_min);
+    fmax(S(SRC1), S(SRC1), S(SCRATCH3));
+
+    // Decompose input
+    ldr(S(SCRATCH3), half);
+    fsub(S(SCRATCH), S(SRC1), S(SCRATCH3));
+    ldr(S(SCRATCH2), c0); // Preload c0.
+    fcvtns(WSCRATCH0, S(SCRATCH));
+    scvtf(S(SCRATCH), WSCRATCH0);
+    // SCRATCH now contains input rounded to the nearest integer.
+    add(WSCRATCH0, WSCRATCH0, 0x7f);
+    fsub(S(SRC1), S(SRC1), S(SCRATCH));
+    // SRC1 contains input - round(input), which is in [-0.5, 0.5).
+    fmul(S(SCRATCH2), S(SCRATCH2), S(SRC1));
+    lsl(WSCRATCH0, WSCRATCH0, 23);
+    fmov(S(SCRATCH), WSCRATCH0);
+    // SCRATCH contains 2^(round(input)).
+
+    // Complete computation of polynomial.
+    ldr(S(SCRATCH3), c1);
+    fadd(S(SCRATCH2), S(SCRATCH2), S(SCRATCH3));
+    fmul(S(SCRATCH2), S(SCRATCH2), S(SRC1));
+    ldr(S(SCRATCH3), c2);
+    fadd(S(SCRATCH2), S(SCRATCH2), S(SCRATCH3));
+    fmul(S(SCRATCH2), S(SCRATCH2), S(SRC1));
+    ldr(S(SCRATCH3), c3);
+    fadd(S(SCRATCH2), S(SCRATCH2), S(SCRATCH3));
+    fmul(S(SRC1), S(SRC1), S(SCRATCH2));
+    ldr(S(SCRATCH3), c4);
+    fadd(S(SRC1), S(SRC1), S(SCRATCH3));
+    fmul(S(SRC1), S(SRC1), S(SCRATCH));
+
+    // Duplicate result across vector
+    L(ret_label);
+    dup(SRC1, SRC1, 0);
+
+    ret();
+}
+
+} // namespace Pica::Shader
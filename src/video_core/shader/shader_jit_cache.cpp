@@ -0,0 +1,91 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/cache_file.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "core/settings.h"
+#include "video_core/shader/shader_jit_cache.h"
+
+namespace Pica::Shader {
+
+static constexpr u32 JIT_CACHE_VERSION = 0x2;
+
+static std::string GetCacheFile() {
+    u64 program_id = 0;
+    Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id);
+    const std::string& dir = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    return fmt::format("{}{:016X}.jit", dir, program_id);
+}
+
+static void DoProgram(Core::CacheFile& file, JitProgram& program) {
+    file.Do(program.program_code);
+    file.Do(program.swizzle_data);
+    file.Do(program.uses);
+}
+
+JitProgramMap LoadJitPrograms() {
+    JitProgramMap programs;
+    if (!Settings::values.use_shader_cache || !FileUtil::Exists(GetCacheFile())) {
+        return programs;
+    }
+
+    Core::CacheFile file(GetCacheFile(), Core::CacheFile::MODE_LOAD);
+
+    u32 version = 0;
+    file.DoHeader(version);
+    if (version != JIT_CACHE_VERSION) {
+        FileUtil::Delete(GetCacheFile());
+        return programs;
+    }
+
+    u32 count = 0;
+    file.Do(count);
+    for (; count != 0 && file.IsGood(); --count) {
+        u64 key = 0;
+        JitProgram program;
+        file.Do(key);
+        DoProgram(file, program);
+        programs.emplace(key, std::move(program));
+    }
+    if (!file.IsGood()) {
+        LOG_WARNING(HW_GPU, "Shader JIT cache is corrupted, ignoring it");
+        programs.clear();
+    }
+    return programs;
+}
+
+void SaveJitPrograms(const JitProgramMap& programs) {
+    if (!Settings::values.use_shader_cache) {
+        return;
+    }
+
+    const std::string temp_path = GetCacheFile() + ".tmp";
+    {
+        Core::CacheFile file(temp_path, Core::CacheFile::MODE_SAVE);
+
+        u32 version = JIT_CACHE_VERSION;
+        file.DoHeader(version);
+
+        u32 count = static_cast<u32>(programs.size());
+        file.Do(count);
+        for (const auto& [key, program] : programs) {
+            u64 saved_key = key;
+            JitProgram saved_program = program;
+            file.Do(saved_key);
+            DoProgram(file, saved_program);
+        }
+
+        if (!file.IsGood()) {
+            FileUtil::Delete(temp_path);
+            return;
+        }
+    }
+    FileUtil::Rename(temp_path, GetCacheFile());
+}
+
+} // namespace Pica::Shader
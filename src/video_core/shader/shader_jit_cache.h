@@ -0,0 +1,159 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica::Shader {
+
+/// Program as recorded in the on-disk JIT cache, trailing zero words are not stored
+struct JitProgram {
+    std::vector<u32> program_code;
+    std::vector<u32> swizzle_data;
+    /// Number of batches set up with this program, used to pick the ones to compile at boot
+    u32 uses = 0;
+};
+
+using JitProgramMap = std::unordered_map<u64, JitProgram>;
+
+/**
+ * Loads the programs the JIT compiled in previous sessions of the running title. Only the PICA
+ * programs are kept on disk: the host code embeds the addresses of emulator functions and depends
+ * on the features of the host CPU, while recompiling a program takes a fraction of a millisecond.
+ */
+JitProgramMap LoadJitPrograms();
+
+/// Writes the programs compiled by the running title to the disk, for LoadJitPrograms
+void SaveJitPrograms(const JitProgramMap& programs);
+
+/// Limit on the total size of host code kept compiled, least recently used shaders go first
+constexpr std::size_t MAX_RESIDENT_CODE_SIZE = 8 * 1024 * 1024;
+
+/**
+ * Compiled shaders of a JIT engine, keyed by the program and swizzle hashes. The programs of the
+ * on-disk cache are compiled ahead of their first draw when the cache is created.
+ */
+template <typename JitShader>
+class JitShaderCache {
+public:
+    JitShaderCache() : programs(LoadJitPrograms()) {
+        Preload();
+    }
+
+    ~JitShaderCache() {
+        if (!programs.empty()) {
+            SaveJitPrograms(programs);
+        }
+    }
+
+    /// Returns the compiled shader for the program and swizzle data of setup, compiling it if needed
+    const JitShader* Get(ShaderSetup& setup) {
+        const u64 key = setup.GetProgramCodeHash() ^ setup.GetSwizzleDataHash();
+
+        auto& program = programs[key];
+        if (program.uses == 0) {
+            program.program_code = Trim(setup.program_code.data(), setup.program_code.size());
+            program.swizzle_data = Trim(setup.swizzle_data.data(), setup.swizzle_data.size());
+        }
+        ++program.uses;
+
+        auto iter = shaders.find(key);
+        if (iter != shaders.end()) {
+            lru.splice(lru.begin(), lru, iter->second.lru);
+            return iter->second.shader.get();
+        }
+
+        auto shader = std::make_unique<JitShader>();
+        shader->Compile(&setup.program_code, &setup.swizzle_data);
+        return Insert(key, std::move(shader));
+    }
+
+private:
+    struct Entry {
+        std::unique_ptr<JitShader> shader;
+        std::list<u64>::iterator lru;
+    };
+
+    static std::vector<u32> Trim(const u32* data, std::size_t size) {
+        while (size > 0 && data[size - 1] == 0) {
+            --size;
+        }
+        return {data, data + size};
+    }
+
+    const JitShader* Insert(u64 key, std::unique_ptr<JitShader> shader) {
+        resident_size += shader->getSize();
+        lru.push_front(key);
+        const JitShader* result = shader.get();
+        shaders.emplace(key, Entry{std::move(shader), lru.begin()});
+
+        // The two most recent shaders can be the vertex and geometry shaders of the current draw,
+        // both of which are still referenced by their setup
+        while (resident_size > MAX_RESIDENT_CODE_SIZE && lru.size() > 2) {
+            auto evicted = shaders.find(lru.back());
+            resident_size -= evicted->second.shader->getSize();
+            shaders.erase(evicted);
+            lru.pop_back();
+        }
+        return result;
+    }
+
+    /// Compiles the most used programs of the on-disk cache, as far as the resident limit allows
+    void Preload() {
+        std::vector<std::pair<u32, u64>> order;
+        order.reserve(programs.size());
+        for (const auto& [key, program] : programs) {
+            order.emplace_back(program.uses, key);
+        }
+        std::sort(order.begin(), order.end(), std::greater<>());
+
+        auto code = std::make_unique<ProgramCode>();
+        auto swizzle = std::make_unique<SwizzleData>();
+        for (const auto& [uses, key] : order) {
+            const JitProgram& program = programs[key];
+            if (program.program_code.size() > code->size() ||
+                program.swizzle_data.size() > swizzle->size()) {
+                programs.erase(key);
+                continue;
+            }
+            code->fill(0);
+            swizzle->fill(0);
+            std::copy(program.program_code.begin(), program.program_code.end(), code->begin());
+            std::copy(program.swizzle_data.begin(), program.swizzle_data.end(), swizzle->begin());
+            if ((Common::ComputeHash64(code.get(), sizeof(ProgramCode)) ^
+                 Common::ComputeHash64(swizzle.get(), sizeof(SwizzleData))) != key) {
+                programs.erase(key);
+                continue;
+            }
+
+            auto shader = std::make_unique<JitShader>();
+            shader->Compile(code.get(), swizzle.get());
+            if (resident_size + shader->getSize() > MAX_RESIDENT_CODE_SIZE) {
+                break;
+            }
+            Insert(key, std::move(shader));
+        }
+        // Compiled from the most used down, which should be the last to be evicted
+        lru.reverse();
+    }
+
+    JitProgramMap programs;
+    std::unordered_map<u64, Entry> shaders;
+    /// Keys of the compiled shaders, most recently used first
+    std::list<u64> lru;
+    std::size_t resident_size = 0;
+};
+
+} // namespace Pica::Shader
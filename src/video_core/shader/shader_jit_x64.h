@@ -4,10 +4,9 @@
 
 #pragma once
 
-#include <memory>
-#include <unordered_map>
 #include "common/common_types.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_cache.h"
 
 namespace Pica::Shader {
 
@@ -20,9 +19,10 @@ public:
 
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, UnitState* states, std::size_t count) const override;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    JitShaderCache<JitShader> cache;
 };
 
 } // namespace Pica::Shader
@@ -211,24 +211,22 @@ void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRe
         address_register_index = instr.common.address_register_index;
     }
 
+    Xbyak::RegExp src_address = src_ptr + src_offset_disp;
     if (src_num == offset_src && address_register_index != 0) {
         switch (address_register_index) {
         case 1: // address offset 1
-            movaps(dest, xword[src_ptr + ADDROFFS_REG_0 + src_offset_disp]);
+            src_address = src_address + ADDROFFS_REG_0;
             break;
         case 2: // address offset 2
-            movaps(dest, xword[src_ptr + ADDROFFS_REG_1 + src_offset_disp]);
+            src_address = src_address + ADDROFFS_REG_1;
             break;
         case 3: // address offset 3
-            movaps(dest, xword[src_ptr + LOOPCOUNT_REG.cvt64() + src_offset_disp]);
+            src_address = src_address + LOOPCOUNT_REG.cvt64();
             break;
         default:
             UNREACHABLE();
             break;
         }
-    } else {
-        // Load the source
-        movaps(dest, xword[src_ptr + src_offset_disp]);
     }
 
     SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
@@ -239,8 +237,17 @@ void JitShader::Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRe
         // Selector component order needs to be reversed for the SHUFPS instruction
         sel = ((sel & 0xc0) >> 6) | ((sel & 3) << 6) | ((sel & 0xc) << 2) | ((sel & 0x30) >> 2);
 
-        // Shuffle inputs for swizzle
-        shufps(dest, dest, sel);
+        if (Common::GetCPUCaps().avx) {
+            // Load and shuffle the source in one instruction
+            vpermilps(dest, xword[src_address], sel);
+        } else {
+            // Load the source and shuffle inputs for swizzle
+            movaps(dest, xword[src_address]);
+            shufps(dest, dest, sel);
+        }
+    } else {
+        // Load the source
+        movaps(dest, xword[src_address]);
     }
 
     // If the source register should be negated, flip the negative bit using XOR
@@ -274,13 +281,17 @@ void JitShader::Compile_DestEnable(Instruction instr, Xmm src) {
     } else {
         // Not all components are enabled, so mask the result when storing to the destination
         // register...
-        movaps(SCRATCH, xword[STATE + dest_offset_disp]);
-
-        if (Common::GetCPUCaps().sse4_1) {
-            u8 mask = ((swiz.dest_mask & 1) << 3) | ((swiz.dest_mask & 8) >> 3) |
-                      ((swiz.dest_mask & 2) << 1) | ((swiz.dest_mask & 4) >> 1);
+        const u8 mask = ((swiz.dest_mask & 1) << 3) | ((swiz.dest_mask & 8) >> 3) |
+                        ((swiz.dest_mask & 2) << 1) | ((swiz.dest_mask & 4) >> 1);
+
+        if (Common::GetCPUCaps().avx) {
+            // Take the disabled components straight from memory
+            vblendps(SCRATCH, src, xword[STATE + dest_offset_disp], ~mask & 0xF);
+        } else if (Common::GetCPUCaps().sse4_1) {
+            movaps(SCRATCH, xword[STATE + dest_offset_disp]);
             blendps(SCRATCH, src, mask);
         } else {
+            movaps(SCRATCH, xword[STATE + dest_offset_disp]);
             movaps(SCRATCH2, src);
             unpckhps(SCRATCH2, SCRATCH); // Unpack X/Y components of source and destination
             unpcklps(SCRATCH, src);      // Unpack Z/W components of source and destination
@@ -305,6 +316,16 @@ void JitShader::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
     // where neither source was, this NaN was generated by a 0 * inf multiplication, and so the
     // result should be transformed to 0 to match PICA fp rules.
 
+    if (Common::GetCPUCaps().avx) {
+        // Same sequence as below, the non-destructive forms make the copies unnecessary
+        vcmpordps(scratch, src1, src2);
+        vmulps(src1, src1, src2);
+        vcmpunordps(src2, src1, src1);
+        vxorps(scratch, scratch, src2);
+        vandps(src1, src1, scratch);
+        return;
+    }
+
     // Set scratch to mask of (src1 != NaN and src2 != NaN)
     movaps(scratch, src1);
     cmpordps(scratch, src2);
@@ -373,11 +394,16 @@ void JitShader::Compile_DP3(Instruction instr) {
 
     Compile_SanitizedMul(SRC1, SRC2, SCRATCH);
 
-    movaps(SRC2, SRC1);
-    shufps(SRC2, SRC2, _MM_SHUFFLE(1, 1, 1, 1));
+    if (Common::GetCPUCaps().avx) {
+        vshufps(SRC2, SRC1, SRC1, _MM_SHUFFLE(1, 1, 1, 1));
+        vshufps(SRC3, SRC1, SRC1, _MM_SHUFFLE(2, 2, 2, 2));
+    } else {
+        movaps(SRC2, SRC1);
+        shufps(SRC2, SRC2, _MM_SHUFFLE(1, 1, 1, 1));
 
-    movaps(SRC3, SRC1);
-    shufps(SRC3, SRC3, _MM_SHUFFLE(2, 2, 2, 2));
+        movaps(SRC3, SRC1);
+        shufps(SRC3, SRC3, _MM_SHUFFLE(2, 2, 2, 2));
+    }
 
     shufps(SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0));
     addps(SRC1, SRC2);
@@ -590,8 +616,7 @@ void JitShader::Compile_END(Instruction instr) {
     mov(dword[STATE + offsetof(UnitState, address_registers[1])], ADDROFFS_REG_1.cvt32());
     mov(dword[STATE + offsetof(UnitState, address_registers[2])], LOOPCOUNT_REG);
 
-    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
-    ret();
+    jmp(end_unit_label, T_NEAR);
 }
 
 void JitShader::Compile_BREAKC(Instruction instr) {
@@ -894,19 +919,38 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     program_counter = 0;
     looping = false;
     instruction_labels.fill(Xbyak::Label());
+    next_unit_label = Xbyak::Label();
+    end_unit_label = Xbyak::Label();
 
     // Find all `CALL` instructions and identify return locations
     FindReturnOffsets();
 
     // The stack pointer is 8 modulo 16 at the entry of a procedure
-    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
-    // return checks (see Compile_Return) that happen in shader main routine.
-    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    // We reserve 32 bytes and assign a dummy value to the second 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine. The remaining space
+    // keeps the entry point and the number of shader units left in the batch.
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 32);
     mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
 
+    // Save these first, ABI_PARAM4 is the same register as UNIFORMS on Windows
+    mov(qword[rsp + 16], ABI_PARAM3);
+    mov(qword[rsp + 24], ABI_PARAM4);
+
     mov(UNIFORMS, ABI_PARAM1);
     mov(STATE, ABI_PARAM2);
 
+    // Used to set a register to one
+    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
+    mov(rax, reinterpret_cast<std::size_t>(&one));
+    movaps(ONE, xword[rax]);
+
+    // Used to negate registers
+    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
+    mov(rax, reinterpret_cast<std::size_t>(&neg));
+    movaps(NEGBIT, xword[rax]);
+
+    L(next_unit_label);
+
     // Load address/loop registers
     movsxd(ADDROFFS_REG_0, dword[STATE + offsetof(UnitState, address_registers[0])]);
     movsxd(ADDROFFS_REG_1, dword[STATE + offsetof(UnitState, address_registers[1])]);
@@ -919,22 +963,21 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     mov(COND0, byte[STATE + offsetof(UnitState, conditional_code[0])]);
     mov(COND1, byte[STATE + offsetof(UnitState, conditional_code[1])]);
 
-    // Used to set a register to one
-    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
-    mov(rax, reinterpret_cast<std::size_t>(&one));
-    movaps(ONE, xword[rax]);
-
-    // Used to negate registers
-    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
-    mov(rax, reinterpret_cast<std::size_t>(&neg));
-    movaps(NEGBIT, xword[rax]);
-
     // Jump to start of the shader program
-    jmp(ABI_PARAM3);
+    jmp(qword[rsp + 16]);
 
     // Compile entire program
     Compile_Block(static_cast<unsigned>(program_code->size()));
 
+    // Every END instruction ends up here
+    L(end_unit_label);
+    add(STATE, static_cast<u32>(sizeof(UnitState)));
+    dec(qword[rsp + 24]);
+    jnz(next_unit_label, T_NEAR);
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 32);
+    ret();
+
     // Free memory that's no longer needed
     program_code = nullptr;
     swizzle_data = nullptr;
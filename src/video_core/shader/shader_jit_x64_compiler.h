@@ -33,7 +33,13 @@ public:
     JitShader();
 
     void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
-        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+        program(&setup.uniforms, &state, instruction_labels[offset].getAddress(), 1);
+    }
+
+    /// Runs the program on count consecutive shader units, count must not be zero
+    void RunBatch(const ShaderSetup& setup, UnitState* states, std::size_t count,
+                  unsigned offset) const {
+        program(&setup.uniforms, states, instruction_labels[offset].getAddress(), count);
     }
 
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
@@ -129,9 +135,15 @@ private:
     unsigned program_counter = 0; ///< Offset of the next instruction to decode
     bool looping = false;         ///< True if compiling a loop, used to check for nested loops
 
-    using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
+    using CompiledShader = void(const void* setup, void* states, const u8* start_addr,
+                                std::size_t count);
     CompiledShader* program = nullptr;
 
+    /// Loads the state of the next shader unit of the batch and jumps to the entry point
+    Xbyak::Label next_unit_label;
+    /// Moves on to the next shader unit of the batch, or returns after the last one
+    Xbyak::Label end_unit_label;
+
     Xbyak::Label log2_subroutine;
     Xbyak::Label exp2_subroutine;
 };
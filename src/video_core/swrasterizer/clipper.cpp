@@ -5,6 +5,11 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#if defined(ARCHITECTURE_x86_64)
+#include <xmmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
 #include <boost/container/static_vector.hpp>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -15,6 +20,7 @@
 #include "video_core/shader/shader.h"
 #include "video_core/swrasterizer/clipper.h"
 #include "video_core/swrasterizer/rasterizer.h"
+#include "video_core/swrasterizer/tile_binner.h"
 
 using Pica::Rasterizer::Vertex;
 
@@ -45,12 +51,145 @@ public:
         return Vertex::Lerp(factor, v0, v1);
     }
 
-private:
-    float24 pos;
     Common::Vec4<float24> coeffs;
     Common::Vec4<float24> bias;
 };
 
+/// Number of planes a triangle is tested against, in groups of four for the SIMD test
+constexpr std::size_t NUM_CLIP_PLANES = 8;
+constexpr std::size_t NUM_PLANE_GROUPS = NUM_CLIP_PLANES / 4;
+
+/**
+ * Triangles only get clipped against the x and y planes when they leave this range of screen
+ * coordinates, the rasterizer takes care of the pixels outside of the framebuffer. Its 12.4 fixed
+ * point coordinates are unsigned, so the band can't reach left or above the origin, and its edge
+ * functions overflow past 2048 pixels.
+ */
+constexpr float GUARD_BAND_MIN = 0.0f;
+constexpr float GUARD_BAND_MAX = 2040.0f;
+
+/**
+ * The clip planes as x * pos.x + y * pos.y + z * pos.z + w * pos.w + k >= 0, transposed so that
+ * the distances of a vertex to four planes are computed at once.
+ */
+struct alignas(16) PlaneGroup {
+    std::array<float, 4> x;
+    std::array<float, 4> y;
+    std::array<float, 4> z;
+    std::array<float, 4> w;
+    std::array<float, 4> k;
+};
+
+struct ClipPlanes {
+    std::array<ClippingEdge, NUM_CLIP_PLANES> edges;
+    std::array<PlaneGroup, NUM_PLANE_GROUPS> groups;
+};
+
+/// Returns the range of x / w that keeps a screen coordinate inside of the guard band
+static std::pair<float, float> GetGuardBand(float halfsize, float offset) {
+    if (halfsize == 0.0f) {
+        return {-1.0f, 1.0f};
+    }
+    const float a = (GUARD_BAND_MIN - offset) / halfsize - 1.0f;
+    const float b = (GUARD_BAND_MAX - offset) / halfsize - 1.0f;
+    return {std::min(a, b), std::max(a, b)};
+}
+
+static ClipPlanes GetClipPlanes() {
+    // NOTE: We clip against a w=epsilon plane to guarantee that the output has a positive w value.
+    // TODO: Not sure if this is a valid approach. Also should probably instead use the smallest
+    //       epsilon possible within float24 accuracy.
+    static const float24 EPSILON = float24::FromFloat32(0.00001f);
+    static const float24 f0 = float24::FromFloat32(0.0);
+    static const float24 f1 = float24::FromFloat32(1.0);
+
+    const auto& regs = g_state.regs.rasterizer;
+    const auto [left, right] =
+        GetGuardBand(float24::FromRaw(regs.viewport_size_x).ToFloat32(),
+                     static_cast<float>(regs.viewport_corner.x));
+    const auto [top, bottom] =
+        GetGuardBand(float24::FromRaw(regs.viewport_size_y).ToFloat32(),
+                     static_cast<float>(regs.viewport_corner.y));
+    const auto f = [](float value) { return float24::FromFloat32(value); };
+
+    // A disabled user plane has no coefficients, everything is inside of it
+    const Common::Vec4<float24> user_coeffs =
+        regs.clip_enable ? regs.GetClipCoef() : Common::MakeVec(f0, f0, f0, f0);
+
+    ClipPlanes planes{{{
+        {Common::MakeVec(f1, f0, f0, f(-left))},   // x = left * w
+        {Common::MakeVec(-f1, f0, f0, f(right))},  // x = right * w
+        {Common::MakeVec(f0, f1, f0, f(-top))},    // y = top * w
+        {Common::MakeVec(f0, -f1, f0, f(bottom))}, // y = bottom * w
+        {Common::MakeVec(f0, f0, -f1, f0)},        // z =  0
+        {Common::MakeVec(f0, f0, f1, f1)},         // z = -w
+        {Common::MakeVec(f0, f0, f0, f1),
+         Common::Vec4<float24>(f0, f0, f0, EPSILON)}, // w = EPSILON
+        {user_coeffs},
+    }}};
+
+    for (std::size_t i = 0; i < NUM_CLIP_PLANES; ++i) {
+        const ClippingEdge& edge = planes.edges[i];
+        PlaneGroup& group = planes.groups[i / 4];
+        group.x[i % 4] = edge.coeffs.x.ToFloat32();
+        group.y[i % 4] = edge.coeffs.y.ToFloat32();
+        group.z[i % 4] = edge.coeffs.z.ToFloat32();
+        group.w[i % 4] = edge.coeffs.w.ToFloat32();
+        group.k[i % 4] = Common::Dot(edge.bias, edge.coeffs).ToFloat32();
+    }
+    return planes;
+}
+
+/// Returns a mask of the planes the position is outside of
+static u32 GetOutcode(const ClipPlanes& planes, const Common::Vec4<float24>& pos) {
+    u32 outcode = 0;
+#if defined(ARCHITECTURE_x86_64)
+    const __m128 x = _mm_set1_ps(pos.x.ToFloat32());
+    const __m128 y = _mm_set1_ps(pos.y.ToFloat32());
+    const __m128 z = _mm_set1_ps(pos.z.ToFloat32());
+    const __m128 w = _mm_set1_ps(pos.w.ToFloat32());
+    for (std::size_t i = 0; i < NUM_PLANE_GROUPS; ++i) {
+        const PlaneGroup& group = planes.groups[i];
+        __m128 distance = _mm_load_ps(group.k.data());
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(group.x.data()), x));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(group.y.data()), y));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(group.z.data()), z));
+        distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(group.w.data()), w));
+        const u32 outside = _mm_movemask_ps(_mm_cmplt_ps(distance, _mm_setzero_ps()));
+        outcode |= outside << (4 * i);
+    }
+#elif defined(ARCHITECTURE_ARM64)
+    static constexpr u32 lane_bits[4]{1, 2, 4, 8};
+    const float32x4_t x = vdupq_n_f32(pos.x.ToFloat32());
+    const float32x4_t y = vdupq_n_f32(pos.y.ToFloat32());
+    const float32x4_t z = vdupq_n_f32(pos.z.ToFloat32());
+    const float32x4_t w = vdupq_n_f32(pos.w.ToFloat32());
+    for (std::size_t i = 0; i < NUM_PLANE_GROUPS; ++i) {
+        const PlaneGroup& group = planes.groups[i];
+        float32x4_t distance = vld1q_f32(group.k.data());
+        distance = vmlaq_f32(distance, vld1q_f32(group.x.data()), x);
+        distance = vmlaq_f32(distance, vld1q_f32(group.y.data()), y);
+        distance = vmlaq_f32(distance, vld1q_f32(group.z.data()), z);
+        distance = vmlaq_f32(distance, vld1q_f32(group.w.data()), w);
+        const uint32x4_t outside = vcltq_f32(distance, vdupq_n_f32(0.0f));
+        outcode |= vaddvq_u32(vandq_u32(outside, vld1q_u32(lane_bits))) << (4 * i);
+    }
+#else
+    const float x = pos.x.ToFloat32();
+    const float y = pos.y.ToFloat32();
+    const float z = pos.z.ToFloat32();
+    const float w = pos.w.ToFloat32();
+    for (std::size_t i = 0; i < NUM_CLIP_PLANES; ++i) {
+        const PlaneGroup& group = planes.groups[i / 4];
+        const std::size_t lane = i % 4;
+        const float distance = group.k[lane] + group.x[lane] * x + group.y[lane] * y +
+                               group.z[lane] * z + group.w[lane] * w;
+        outcode |= (distance < 0.0f ? 1u : 0u) << i;
+    }
+#endif
+    return outcode;
+}
+
 static void InitScreenCoordinates(Vertex& vtx) {
     struct {
         float24 halfsize_x;
@@ -84,14 +223,15 @@ static void InitScreenCoordinates(Vertex& vtx) {
     vtx.screenpos[2] = vtx.pos.z * inv_w;
 }
 
-void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2) {
+void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2,
+                     Rasterizer::TileBinner* binner) {
     using boost::container::static_vector;
 
     // Clipping a planar n-gon against a plane will remove at least 1 vertex and introduces 2 at
     // the new edge (or less in degenerate cases). As such, we can say that each clipping plane
-    // introduces at most 1 new vertex to the polygon. Since we start with a triangle and have a
-    // fixed 6 clipping planes, the maximum number of vertices of the clipped polygon is 3 + 6 = 9.
-    static const std::size_t MAX_VERTICES = 9;
+    // introduces at most 1 new vertex to the polygon. Since we start with a triangle, the maximum
+    // number of vertices of the clipped polygon is 3 plus the number of planes.
+    static const std::size_t MAX_VERTICES = 3 + NUM_CLIP_PLANES;
     static_vector<Vertex, MAX_VERTICES> buffer_a = {v0, v1, v2};
     static_vector<Vertex, MAX_VERTICES> buffer_b;
 
@@ -108,22 +248,14 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
     auto* output_list = &buffer_a;
     auto* input_list = &buffer_b;
 
-    // NOTE: We clip against a w=epsilon plane to guarantee that the output has a positive w value.
-    // TODO: Not sure if this is a valid approach. Also should probably instead use the smallest
-    //       epsilon possible within float24 accuracy.
-    static const float24 EPSILON = float24::FromFloat32(0.00001f);
-    static const float24 f0 = float24::FromFloat32(0.0);
-    static const float24 f1 = float24::FromFloat32(1.0);
-    static const std::array<ClippingEdge, 7> clipping_edges = {{
-        {Common::MakeVec(-f1, f0, f0, f1)}, // x = +w
-        {Common::MakeVec(f1, f0, f0, f1)},  // x = -w
-        {Common::MakeVec(f0, -f1, f0, f1)}, // y = +w
-        {Common::MakeVec(f0, f1, f0, f1)},  // y = -w
-        {Common::MakeVec(f0, f0, -f1, f0)}, // z =  0
-        {Common::MakeVec(f0, f0, f1, f1)},  // z = -w
-        {Common::MakeVec(f0, f0, f0, f1),
-         Common::Vec4<float24>(f0, f0, f0, EPSILON)}, // w = EPSILON
-    }};
+    // Most triangles are either completely inside of the guard band and the other planes, or
+    // completely outside of one of them, which the outcodes of the vertices tell without clipping
+    const ClipPlanes planes = GetClipPlanes();
+    const u32 outcode0 = GetOutcode(planes, v0.pos);
+    const u32 outcode1 = GetOutcode(planes, v1.pos);
+    const u32 outcode2 = GetOutcode(planes, v2.pos);
+    if ((outcode0 & outcode1 & outcode2) != 0)
+        return;
 
     // Simple implementation of the Sutherland-Hodgman clipping algorithm.
     // TODO: Make this less inefficient (currently lots of useless buffering overhead happens here)
@@ -148,18 +280,16 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
         }
     };
 
-    for (auto edge : clipping_edges) {
-        Clip(edge);
+    // The vertices created on one plane lie between vertices inside of the others, so only the
+    // planes that a vertex of the triangle is outside of need clipping
+    const u32 crossed_planes = outcode0 | outcode1 | outcode2;
+    for (std::size_t i = 0; i < NUM_CLIP_PLANES; ++i) {
+        if ((crossed_planes & (1u << i)) == 0)
+            continue;
 
-        // Need to have at least a full triangle to continue...
-        if (output_list->size() < 3)
-            return;
-    }
-
-    if (g_state.regs.rasterizer.clip_enable) {
-        ClippingEdge custom_edge{g_state.regs.rasterizer.GetClipCoef()};
-        Clip(custom_edge);
+        Clip(planes.edges[i]);
 
+        // Need to have at least a full triangle to continue...
         if (output_list->size() < 3)
             return;
     }
@@ -189,7 +319,11 @@ void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const Outpu
             vtx2.screenpos.x.ToFloat32(), vtx2.screenpos.y.ToFloat32(),
             vtx2.screenpos.z.ToFloat32());
 
-        Rasterizer::ProcessTriangle(vtx0, vtx1, vtx2);
+        if (binner) {
+            binner->AddTriangle(vtx0, vtx1, vtx2);
+        } else {
+            Rasterizer::ProcessTriangle(vtx0, vtx1, vtx2);
+        }
     }
 }
 
@@ -9,11 +9,20 @@ namespace Shader {
 struct OutputVertex;
 }
 
+namespace Rasterizer {
+class TileBinner;
+}
+
 namespace Clipper {
 
 using Shader::OutputVertex;
 
-void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2);
+/**
+ * Clips the triangle and rasterizes the result, or queues it in binner for the worker threads
+ * to rasterize if one is given.
+ */
+void ProcessTriangle(const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2,
+                     Rasterizer::TileBinner* binner = nullptr);
 
 } // namespace Clipper
 } // namespace Pica
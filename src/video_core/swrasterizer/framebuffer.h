@@ -4,18 +4,85 @@
 
 #pragma once
 
+#include "common/color.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/regs_framebuffer.h"
+#include "video_core/utils.h"
 
 namespace Pica::Rasterizer {
 
-void DrawPixel(int x, int y, const Common::Vec4<u8>& color);
-const Common::Vec4<u8> GetPixel(int x, int y);
-u32 GetDepth(int x, int y);
-u8 GetStencil(int x, int y);
-void SetDepth(int x, int y, u32 value);
-void SetStencil(int x, int y, u8 value);
+/**
+ * Color and depth buffer of the current draw. The addresses and the conversions of the pixel
+ * formats are resolved from the registers once, instead of for every fragment.
+ */
+class FramebufferAccess {
+public:
+    /// Reads the buffers configured in g_state.regs
+    FramebufferAccess();
+
+    Common::Vec4<u8> GetPixel(int x, int y) const {
+        return decode_color(color_buffer + GetOffset(x, y, color_bytes_per_pixel));
+    }
+
+    void DrawPixel(int x, int y, const Common::Vec4<u8>& color) const {
+        encode_color(color, color_buffer + GetOffset(x, y, color_bytes_per_pixel));
+    }
+
+    u32 GetDepth(int x, int y) const {
+        return decode_depth(depth_buffer + GetOffset(x, y, depth_bytes_per_pixel));
+    }
+
+    void SetDepth(int x, int y, u32 value) const {
+        encode_depth(value, depth_buffer + GetOffset(x, y, depth_bytes_per_pixel));
+    }
+
+    /// Returns 0 if the depth buffer has no stencil component
+    u8 GetStencil(int x, int y) const {
+        if (!has_stencil) {
+            return 0;
+        }
+        return Color::DecodeD24S8(depth_buffer + GetOffset(x, y, depth_bytes_per_pixel)).y;
+    }
+
+    /// Does nothing if the depth buffer has no stencil component
+    void SetStencil(int x, int y, u8 value) const {
+        if (has_stencil) {
+            Color::EncodeX24S8(value, depth_buffer + GetOffset(x, y, depth_bytes_per_pixel));
+        }
+    }
+
+    /// Number of bits of the depth values
+    u32 GetDepthBits() const {
+        return depth_bits;
+    }
+
+private:
+    u32 GetOffset(int x, int y, u32 bytes_per_pixel) const {
+        // Similarly to textures, the render framebuffer is laid out from bottom to top, too.
+        // NOTE: The framebuffer height register contains the actual FB height minus one.
+        y = height - y;
+
+        const u32 coarse_y = y & ~7;
+        return VideoCore::GetMortonOffset(x, y, bytes_per_pixel) +
+               coarse_y * width * bytes_per_pixel;
+    }
+
+    u8* color_buffer = nullptr;
+    u8* depth_buffer = nullptr;
+    u32 width = 0;
+    u32 height = 0;
+    u32 color_bytes_per_pixel = 0;
+    u32 depth_bytes_per_pixel = 0;
+    u32 depth_bits = 0;
+    bool has_stencil = false;
+
+    Common::Vec4<u8> (*decode_color)(const u8* bytes) = nullptr;
+    void (*encode_color)(const Common::Vec4<u8>& color, u8* bytes) = nullptr;
+    u32 (*decode_depth)(const u8* bytes) = nullptr;
+    void (*encode_depth)(u32 value, u8* bytes) = nullptr;
+};
+
 u8 PerformStencilAction(FramebufferRegs::StencilAction action, u8 old_stencil, u8 ref);
 
 Common::Vec4<u8> EvaluateBlendEquation(const Common::Vec4<u8>& src,
@@ -0,0 +1,38 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "video_core/swrasterizer/lut_cache.h"
+
+namespace Pica::Rasterizer {
+
+LutCache g_lut_cache;
+
+template <typename Entries, std::size_t N>
+static void ConvertEntries(std::array<LutCache::Entry, N>& dst, const Entries& src) {
+    for (std::size_t i = 0; i < N; ++i) {
+        dst[i] = {src[i].ToFloat(), src[i].DiffToFloat()};
+    }
+}
+
+void LutCache::SyncProcTex(const State::ProcTex& state) {
+    ConvertEntries(proctex.noise_table, state.noise_table);
+    ConvertEntries(proctex.color_map_table, state.color_map_table);
+    ConvertEntries(proctex.alpha_map_table, state.alpha_map_table);
+    for (std::size_t i = 0; i < proctex.color_table.size(); ++i) {
+        proctex.color_table[i] = state.color_table[i].ToVector().Cast<float>();
+        proctex.color_diff_table[i] = state.color_diff_table[i].ToVector().Cast<float>();
+    }
+}
+
+void LutCache::SyncLighting(const State::Lighting& state) {
+    for (std::size_t i = 0; i < lighting.luts.size(); ++i) {
+        ConvertEntries(lighting.luts[i], state.luts[i]);
+    }
+}
+
+void LutCache::SyncFog(const decltype(State::fog)& state) {
+    ConvertEntries(fog.lut, state.lut);
+}
+
+} // namespace Pica::Rasterizer
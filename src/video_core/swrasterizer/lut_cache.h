@@ -0,0 +1,47 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/vector_math.h"
+#include "video_core/pica_state.h"
+
+namespace Pica::Rasterizer {
+
+/**
+ * Floating point copies of the lookup tables in the PICA state. The tables are uploaded as fixed
+ * point, converting them once per upload takes the divisions out of every fragment that samples
+ * them. The copies are refreshed between draws, while rasterizing they are only read.
+ */
+struct LutCache {
+    struct Entry {
+        float value;
+        float difference;
+    };
+
+    struct ProcTex {
+        std::array<Entry, 128> noise_table;
+        std::array<Entry, 128> color_map_table;
+        std::array<Entry, 128> alpha_map_table;
+        std::array<Common::Vec4<float>, 256> color_table;
+        std::array<Common::Vec4<float>, 256> color_diff_table;
+    } proctex;
+
+    struct Lighting {
+        std::array<std::array<Entry, 256>, 24> luts;
+    } lighting;
+
+    struct Fog {
+        std::array<Entry, 128> lut;
+    } fog;
+
+    void SyncProcTex(const State::ProcTex& state);
+    void SyncLighting(const State::Lighting& state);
+    void SyncFog(const decltype(State::fog)& state);
+};
+
+extern LutCache g_lut_cache; ///< Tables of the current Pica state
+
+} // namespace Pica::Rasterizer
@@ -7,10 +7,12 @@
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/pica_state.h"
+#include "video_core/swrasterizer/lut_cache.h"
 
 namespace Pica::Rasterizer {
 
 /// Generates procedural texture color for the given coordinates
-Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs, const State::ProcTex& state);
+Common::Vec4<u8> ProcTex(float u, float v, const TexturingRegs& regs,
+                         const LutCache::ProcTex& luts);
 
 } // namespace Pica::Rasterizer
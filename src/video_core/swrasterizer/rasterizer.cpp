@@ -6,11 +6,17 @@
 #include <array>
 #include <cmath>
 #include <tuple>
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>
+#endif
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
 #include "common/vector_math.h"
@@ -25,6 +31,7 @@
 #include "video_core/shader/shader.h"
 #include "video_core/swrasterizer/framebuffer.h"
 #include "video_core/swrasterizer/lighting.h"
+#include "video_core/swrasterizer/lut_cache.h"
 #include "video_core/swrasterizer/proctex.h"
 #include "video_core/swrasterizer/rasterizer.h"
 #include "video_core/swrasterizer/texturing.h"
@@ -72,6 +79,92 @@ static int SignedArea(const Common::Vec2<Fix12P4>& vtx1, const Common::Vec2<Fix1
     return Common::Cross(vec1, vec2).z;
 };
 
+/**
+ * Edge functions of a triangle, evaluated for groups of four neighbouring pixels of a row. The
+ * functions are linear in x, so every value is the one at the start of the row plus a multiple
+ * of a constant step. The arithmetic wraps the same way as evaluating SignedArea per pixel.
+ */
+class EdgeGroups {
+public:
+    explicit EdgeGroups(const Common::Vec3<Fix12P4> (&vtxpos)[3]) {
+        // The functions of the edges v1v2, v2v0 and v0v1 decrease by 16 times the height of the
+        // edge for every pixel to the right
+        const std::array<int, 3> height{
+            (int)vtxpos[2].y - (int)vtxpos[1].y,
+            (int)vtxpos[0].y - (int)vtxpos[2].y,
+            (int)vtxpos[1].y - (int)vtxpos[0].y,
+        };
+        for (std::size_t edge = 0; edge < 3; ++edge) {
+            const u32 step = static_cast<u32>(-16 * height[edge]);
+            for (u32 lane = 0; lane < 4; ++lane) {
+                offsets[edge][lane] = static_cast<s32>(step * lane);
+            }
+            group_step[edge] = step * 4;
+        }
+    }
+
+    /// Starts a row with the values of the three edge functions at its first pixel
+    void BeginRow(int w0, int w1, int w2) {
+        start = {static_cast<u32>(w0), static_cast<u32>(w1), static_cast<u32>(w2)};
+    }
+
+    /// Evaluates the next group of the row, bit i of the result is set if pixel i is covered
+    u32 Next() {
+#if defined(ARCHITECTURE_x86_64)
+        __m128i outside = _mm_setzero_si128();
+        for (std::size_t edge = 0; edge < 3; ++edge) {
+            const __m128i value = _mm_add_epi32(
+                _mm_set1_epi32(static_cast<s32>(start[edge])),
+                _mm_load_si128(reinterpret_cast<const __m128i*>(offsets[edge].data())));
+            _mm_store_si128(reinterpret_cast<__m128i*>(values[edge].data()), value);
+            outside = _mm_or_si128(outside, value);
+            start[edge] += group_step[edge];
+        }
+        // A pixel is covered when none of its edge functions is negative
+        const u32 coverage = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+#elif defined(ARCHITECTURE_ARM64)
+        int32x4_t outside = vdupq_n_s32(0);
+        for (std::size_t edge = 0; edge < 3; ++edge) {
+            const int32x4_t value = vaddq_s32(vdupq_n_s32(static_cast<s32>(start[edge])),
+                                              vld1q_s32(offsets[edge].data()));
+            vst1q_s32(values[edge].data(), value);
+            outside = vorrq_s32(outside, value);
+            start[edge] += group_step[edge];
+        }
+        // A pixel is covered when none of its edge functions is negative
+        static constexpr s32 lane_bits[4]{1, 2, 4, 8};
+        const u32 coverage =
+            ~vaddvq_s32(vandq_s32(vshrq_n_s32(outside, 31), vld1q_s32(lane_bits))) & 0xF;
+#else
+        s32 outside[4]{};
+        for (std::size_t edge = 0; edge < 3; ++edge) {
+            for (u32 lane = 0; lane < 4; ++lane) {
+                values[edge][lane] =
+                    static_cast<s32>(start[edge] + static_cast<u32>(offsets[edge][lane]));
+                outside[lane] |= values[edge][lane];
+            }
+            start[edge] += group_step[edge];
+        }
+        u32 coverage = 0;
+        for (u32 lane = 0; lane < 4; ++lane) {
+            coverage |= (outside[lane] >= 0 ? 1u : 0u) << lane;
+        }
+#endif
+        return coverage;
+    }
+
+    /// Returns the value of an edge function at a pixel of the last evaluated group
+    int Get(std::size_t edge, u32 lane) const {
+        return values[edge][lane];
+    }
+
+private:
+    alignas(16) std::array<std::array<s32, 4>, 3> offsets;
+    alignas(16) std::array<std::array<s32, 4>, 3> values;
+    std::array<u32, 3> group_step;
+    std::array<u32, 3> start;
+};
+
 /// Convert a 3D vector for cube map coordinates to 2D texture coordinates along with the face name
 static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u, float24 v,
                                                                      float24 w,
@@ -119,25 +212,54 @@ static std::tuple<float24, float24, float24, PAddr> ConvertCubeCoord(float24 u,
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/// Converts a screen position to rasterizer coordinates
+static Common::Vec3<Fix12P4> ScreenToRasterizerCoordinates(const Common::Vec3<float24>& vec) {
+    static auto FloatToFix = [](float24 flt) {
+        // TODO: Rounding here is necessary to prevent garbage pixels at
+        //       triangle borders. Is it that the correct solution, though?
+        return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
+    };
+    return Common::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
+}
+
+/**
+ * Calculates the bounding box of the triangle in 12.4 fixed point, clamped to an Include mode
+ * scissor box and rounded out to whole pixels. Right and bottom are exclusive.
+ */
+static Common::Rectangle<u16> CalculateBounds(const Common::Vec3<Fix12P4> (&vtxpos)[3]) {
+    const auto& regs = g_state.regs;
+
+    u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
+    u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+    u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
+    u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+
+    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
+        // Convert the scissor box coordinates to 12.4 fixed point and calculate the new bounds.
+        // x2,y2 have +1 added to cover the entire sub-pixel area
+        min_x = std::max(min_x, (u16)(regs.rasterizer.scissor_test.x1 << 4));
+        min_y = std::max(min_y, (u16)(regs.rasterizer.scissor_test.y1 << 4));
+        max_x = std::min(max_x, (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4));
+        max_y = std::min(max_y, (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4));
+    }
+
+    min_x &= Fix12P4::IntMask();
+    min_y &= Fix12P4::IntMask();
+    max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
+    max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
+    return {min_x, min_y, max_x, max_y};
+}
+
 /**
  * Helper function for ProcessTriangle with the "reversed" flag to allow for implementing
- * culling via recursion.
+ * culling via recursion. Only the pixels inside tile are drawn.
  */
 static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                    bool reversed = false) {
+                                    const Common::Rectangle<u16>& tile, bool reversed = false) {
     const auto& regs = g_state.regs;
     MICROPROFILE_SCOPE(GPU_Rasterization);
 
     // vertex positions in rasterizer coordinates
-    static auto FloatToFix = [](float24 flt) {
-        // TODO: Rounding here is necessary to prevent garbage pixels at
-        //       triangle borders. Is it that the correct solution, though?
-        return Fix12P4(static_cast<unsigned short>(round(flt.ToFloat32() * 16.0f)));
-    };
-    static auto ScreenToRasterizerCoordinates = [](const Common::Vec3<float24>& vec) {
-        return Common::Vec3<Fix12P4>{FloatToFix(vec.x), FloatToFix(vec.y), FloatToFix(vec.z)};
-    };
-
     Common::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
                                     ScreenToRasterizerCoordinates(v1.screenpos),
                                     ScreenToRasterizerCoordinates(v2.screenpos)};
@@ -145,13 +267,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, tile, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangleInternal(v0, v2, v1, true);
+            ProcessTriangleInternal(v0, v2, v1, tile, true);
             return;
         }
 
@@ -160,10 +282,13 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             return;
     }
 
-    u16 min_x = std::min({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
-    u16 min_y = std::min({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
-    u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
-    u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
+    const Common::Rectangle<u16> bounds = CalculateBounds(vtxpos);
+    const u16 min_x = std::max(bounds.left, static_cast<u16>(tile.left << 4));
+    const u16 min_y = std::max(bounds.top, static_cast<u16>(tile.top << 4));
+    const u16 max_x = std::min(bounds.right, static_cast<u16>(tile.right << 4));
+    const u16 max_y = std::min(bounds.bottom, static_cast<u16>(tile.bottom << 4));
+    if (min_x >= max_x || min_y >= max_y)
+        return;
 
     // Convert the scissor box coordinates to 12.4 fixed point
     u16 scissor_x1 = (u16)(regs.rasterizer.scissor_test.x1 << 4);
@@ -172,19 +297,6 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
     u16 scissor_x2 = (u16)((regs.rasterizer.scissor_test.x2 + 1) << 4);
     u16 scissor_y2 = (u16)((regs.rasterizer.scissor_test.y2 + 1) << 4);
 
-    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
-        // Calculate the new bounds
-        min_x = std::max(min_x, scissor_x1);
-        min_y = std::max(min_y, scissor_y1);
-        max_x = std::min(max_x, scissor_x2);
-        max_y = std::min(max_y, scissor_y2);
-    }
-
-    min_x &= Fix12P4::IntMask();
-    min_y &= Fix12P4::IntMask();
-    max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
-    max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
-
     // Triangle filling rules: Pixels on the right-sided edge or on flat bottom edges are not
     // drawn. Pixels on any other triangle border are drawn. This is implemented with three bias
     // values which are added to the barycentric coordinates w0, w1 and w2, respectively.
@@ -219,11 +331,36 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
         g_state.regs.framebuffer.output_merger.stencil_test.enable &&
         g_state.regs.framebuffer.framebuffer.depth_format == FramebufferRegs::DepthFormat::D24S8;
     const auto stencil_test = g_state.regs.framebuffer.output_merger.stencil_test;
+    const FramebufferAccess framebuffer;
+    const u32 depth_max = (1u << framebuffer.GetDepthBits()) - 1;
+
+    // These only depend on the triangle and the registers
+    const float z_over_w[3]{v0.screenpos[2].ToFloat32(), v1.screenpos[2].ToFloat32(),
+                            v2.screenpos[2].ToFloat32()};
+    const float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    const float depth_offset =
+        float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+
+    EdgeGroups edges(vtxpos);
+    u32 coverage = 0;
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
     for (u16 y = min_y + 8; y < max_y; y += 0x10) {
+        const Common::Vec2<Fix12P4> row_start{static_cast<u16>(min_x + 8), y};
+        edges.BeginRow(bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), row_start),
+                       bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), row_start),
+                       bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), row_start));
+
         for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+            // Calculate the barycentric coordinates w0, w1 and w2, four pixels at a time
+            const u32 lane = ((x - min_x) >> 4) & 3;
+            if (lane == 0)
+                coverage = edges.Next();
+
+            // If current pixel is not covered by the current primitive
+            if ((coverage & (1u << lane)) == 0)
+                continue;
 
             // Do not process the pixel if it's inside the scissor box and the scissor mode is set
             // to Exclude
@@ -232,16 +369,11 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     continue;
             }
 
-            // Calculate the barycentric coordinates w0, w1 and w2
-            int w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-            int w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-            int w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
+            int w0 = edges.Get(0, lane);
+            int w1 = edges.Get(1, lane);
+            int w2 = edges.Get(2, lane);
             int wsum = w0 + w1 + w2;
 
-            // If current pixel is not covered by the current primitive
-            if (w0 < 0 || w1 < 0 || w2 < 0)
-                continue;
-
             auto baricentric_coordinates =
                 Common::MakeVec(float24::FromFloat32(static_cast<float>(w0)),
                                 float24::FromFloat32(static_cast<float>(w1)),
@@ -251,15 +383,10 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 
             // interpolated_z = z / w
             float interpolated_z_over_w =
-                (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                 v2.screenpos[2].ToFloat32() * w2) /
-                wsum;
+                (z_over_w[0] * w0 + z_over_w[1] * w1 + z_over_w[2] * w2) / wsum;
 
             // Not fully accurate. About 3 bits in precision are missing.
             // Z-Buffer (z / w * scale + offset)
-            float depth_scale = float24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-            float depth_offset =
-                float24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
             float depth = interpolated_z_over_w * depth_scale + depth_offset;
 
             // Potentially switch to W-Buffer
@@ -434,7 +561,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (regs.texturing.main_config.texture3_enable) {
                 const auto& proctex_uv = uv[regs.texturing.main_config.texture3_coordinates];
                 texture_color[3] = ProcTex(proctex_uv.u().ToFloat32(), proctex_uv.v().ToFloat32(),
-                                           g_state.regs.texturing, g_state.proctex);
+                                           g_state.regs.texturing, g_lut_cache.proctex);
             }
 
             // Texture environment - consists of 6 stages of color and alpha combining.
@@ -472,7 +599,7 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                     GetInterpolatedAttribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
                 };
                 std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
-                    g_state.regs.lighting, g_state.lighting, normquat, view, texture_color);
+                    g_state.regs.lighting, g_lut_cache.lighting, normquat, view, texture_color);
             }
 
             for (unsigned tev_stage_index = 0; tev_stage_index < tev_stages.size();
@@ -650,8 +777,8 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
                 // Generate clamped fog factor from LUT for given fog index
                 float fog_i = std::clamp(floorf(fog_index), 0.0f, 127.0f);
                 float fog_f = fog_index - fog_i;
-                const auto& fog_lut_entry = g_state.fog.lut[static_cast<unsigned int>(fog_i)];
-                float fog_factor = fog_lut_entry.ToFloat() + fog_lut_entry.DiffToFloat() * fog_f;
+                const auto& fog_lut_entry = g_lut_cache.fog.lut[static_cast<unsigned int>(fog_i)];
+                float fog_factor = fog_lut_entry.value + fog_lut_entry.difference * fog_f;
                 fog_factor = std::clamp(fog_factor, 0.0f, 1.0f);
 
                 // Blend the fog
@@ -663,18 +790,18 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
 
             u8 old_stencil = 0;
 
-            auto UpdateStencil = [stencil_test, x, y,
+            auto UpdateStencil = [stencil_test, x, y, &framebuffer,
                                   &old_stencil](Pica::FramebufferRegs::StencilAction action) {
                 u8 new_stencil =
                     PerformStencilAction(action, old_stencil, stencil_test.reference_value);
                 if (g_state.regs.framebuffer.framebuffer.allow_depth_stencil_write != 0)
-                    SetStencil(x >> 4, y >> 4,
-                               (new_stencil & stencil_test.write_mask) |
-                                   (old_stencil & ~stencil_test.write_mask));
+                    framebuffer.SetStencil(x >> 4, y >> 4,
+                                           (new_stencil & stencil_test.write_mask) |
+                                               (old_stencil & ~stencil_test.write_mask));
             };
 
             if (stencil_action_enable) {
-                old_stencil = GetStencil(x >> 4, y >> 4);
+                old_stencil = framebuffer.GetStencil(x >> 4, y >> 4);
                 u8 dest = old_stencil & stencil_test.input_mask;
                 u8 ref = stencil_test.reference_value & stencil_test.input_mask;
 
@@ -720,12 +847,10 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             }
 
             // Convert float to integer
-            unsigned num_bits =
-                FramebufferRegs::DepthBitsPerPixel(regs.framebuffer.framebuffer.depth_format);
-            u32 z = (u32)(depth * ((1 << num_bits) - 1));
+            u32 z = (u32)(depth * depth_max);
 
             if (output_merger.depth_test_enable) {
-                u32 ref_z = GetDepth(x >> 4, y >> 4);
+                u32 ref_z = framebuffer.GetDepth(x >> 4, y >> 4);
 
                 bool pass = false;
 
@@ -773,14 +898,14 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             if (regs.framebuffer.framebuffer.allow_depth_stencil_write != 0 &&
                 output_merger.depth_write_enable) {
 
-                SetDepth(x >> 4, y >> 4, z);
+                framebuffer.SetDepth(x >> 4, y >> 4, z);
             }
 
             // The stencil depth_pass action is executed even if depth testing is disabled
             if (stencil_action_enable)
                 UpdateStencil(stencil_test.action_depth_pass);
 
-            auto dest = GetPixel(x >> 4, y >> 4);
+            auto dest = framebuffer.GetPixel(x >> 4, y >> 4);
             Common::Vec4<u8> blend_output = combiner_output;
 
             if (output_merger.alphablend_enable) {
@@ -886,13 +1011,27 @@ static void ProcessTriangleInternal(const Vertex& v0, const Vertex& v1, const Ve
             };
 
             if (regs.framebuffer.framebuffer.allow_color_write != 0)
-                DrawPixel(x >> 4, y >> 4, result);
+                framebuffer.DrawPixel(x >> 4, y >> 4, result);
         }
     }
 }
 
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
-    ProcessTriangleInternal(v0, v1, v2);
+    ProcessTriangleInternal(v0, v1, v2, FULL_FRAMEBUFFER);
+}
+
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const Common::Rectangle<u16>& tile) {
+    ProcessTriangleInternal(v0, v1, v2, tile);
+}
+
+Common::Rectangle<u16> GetTriangleBounds(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    const Common::Vec3<Fix12P4> vtxpos[3]{ScreenToRasterizerCoordinates(v0.screenpos),
+                                          ScreenToRasterizerCoordinates(v1.screenpos),
+                                          ScreenToRasterizerCoordinates(v2.screenpos)};
+    const Common::Rectangle<u16> bounds = CalculateBounds(vtxpos);
+    return {static_cast<u16>(bounds.left >> 4), static_cast<u16>(bounds.top >> 4),
+            static_cast<u16>(bounds.right >> 4), static_cast<u16>(bounds.bottom >> 4)};
 }
 
 } // namespace Pica::Rasterizer
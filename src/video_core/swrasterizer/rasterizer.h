@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/math_util.h"
 #include "video_core/shader/shader.h"
 
 namespace Pica::Rasterizer {
@@ -39,6 +40,19 @@ struct Vertex : Shader::OutputVertex {
     }
 };
 
+/// Tile covering every pixel the rasterizer can address, right and bottom are exclusive
+constexpr Common::Rectangle<u16> FULL_FRAMEBUFFER{0, 0, 0xFFF, 0xFFF};
+
 void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
 
+/// Rasterizes only the pixels of the triangle inside tile, given in pixels
+void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                     const Common::Rectangle<u16>& tile);
+
+/**
+ * Returns the pixels the triangle can cover after the scissor test, right and bottom are
+ * exclusive. Only valid until the rasterizer registers change.
+ */
+Common::Rectangle<u16> GetTriangleBounds(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
 } // namespace Pica::Rasterizer
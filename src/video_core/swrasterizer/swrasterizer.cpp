@@ -2,15 +2,61 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <thread>
+#include "core/settings.h"
+#include "video_core/pica_state.h"
 #include "video_core/swrasterizer/clipper.h"
+#include "video_core/swrasterizer/lut_cache.h"
 #include "video_core/swrasterizer/swrasterizer.h"
+#include "video_core/swrasterizer/tile_binner.h"
 
 namespace VideoCore {
 
+SWRasterizer::SWRasterizer() = default;
+
+SWRasterizer::~SWRasterizer() = default;
+
 void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v1,
                                const Pica::Shader::OutputVertex& v2) {
-    Pica::Clipper::ProcessTriangle(v0, v1, v2);
+    SyncLutCache();
+    Pica::Clipper::ProcessTriangle(v0, v1, v2, binner.get());
+}
+
+void SWRasterizer::DrawTriangles() {
+    // Register writes only happen between draws, so the state the queued triangles were clipped
+    // with is still current here
+    if (binner) {
+        binner->Flush();
+    }
+}
+
+void SWRasterizer::SyncLutCache() {
+    // LUT uploads only happen between draws, after the queued triangles have been drawn
+    auto& lut_cache = Pica::Rasterizer::g_lut_cache;
+    if (fog_lut_dirty) {
+        lut_cache.SyncFog(Pica::g_state.fog);
+        fog_lut_dirty = false;
+    }
+    if (lighting_lut_dirty) {
+        lut_cache.SyncLighting(Pica::g_state.lighting);
+        lighting_lut_dirty = false;
+    }
+    if (proctex_lut_dirty) {
+        lut_cache.SyncProcTex(Pica::g_state.proctex);
+        proctex_lut_dirty = false;
+    }
+}
+
+void SWRasterizer::CheckForConfigChanges() {
+    // The emulation thread shades tiles during the flush, it is not counted as a worker
+    const unsigned num_threads = std::thread::hardware_concurrency();
+    const bool use_binner = Settings::values.multithreaded_sw_rasterizer && num_threads > 1;
+    if (use_binner && !binner) {
+        binner = std::make_unique<Pica::Rasterizer::TileBinner>(num_threads - 1);
+    } else if (!use_binner) {
+        binner.reset();
+    }
 }
 
 } // namespace VideoCore
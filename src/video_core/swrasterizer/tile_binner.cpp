@@ -0,0 +1,142 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "video_core/pica_state.h"
+#include "video_core/swrasterizer/tile_binner.h"
+
+namespace Pica::Rasterizer {
+
+MICROPROFILE_DEFINE(GPU_TileBinning, "GPU", "Tile Binning", MP_RGB(70, 70, 240));
+
+TileBinner::TileBinner(std::size_t num_workers) {
+    triangles.reserve(MAX_QUEUED_TRIANGLES);
+    active_tiles.reserve(NUM_TILES);
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+TileBinner::~TileBinner() {
+    {
+        std::lock_guard lock{mutex};
+        stop_requested = true;
+    }
+    work_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TileBinner::AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2) {
+    const Common::Rectangle<u16> area = GetBinnedArea();
+    const Common::Rectangle<u16> bounds = GetTriangleBounds(v0, v1, v2);
+    const u32 right = std::min(bounds.right, area.right);
+    const u32 bottom = std::min(bounds.bottom, area.bottom);
+    if (bounds.left >= right || bounds.top >= bottom)
+        return;
+
+    const u32 index = static_cast<u32>(triangles.size());
+    triangles.push_back({v0, v1, v2});
+
+    for (u32 tile_y = bounds.top / TILE_SIZE; tile_y <= (bottom - 1) / TILE_SIZE; ++tile_y) {
+        for (u32 tile_x = bounds.left / TILE_SIZE; tile_x <= (right - 1) / TILE_SIZE; ++tile_x) {
+            const u32 tile = tile_y * TILES_PER_ROW + tile_x;
+            if (bins[tile].empty()) {
+                active_tiles.push_back(tile);
+            }
+            bins[tile].push_back(index);
+        }
+    }
+
+    if (triangles.size() >= MAX_QUEUED_TRIANGLES) {
+        Flush();
+    }
+}
+
+void TileBinner::Flush() {
+    if (triangles.empty())
+        return;
+
+    MICROPROFILE_SCOPE(GPU_TileBinning);
+    next_tile.store(0, std::memory_order_relaxed);
+    {
+        std::lock_guard lock{mutex};
+        ++generation;
+        num_busy = workers.size();
+    }
+    work_cv.notify_all();
+
+    // The emulation thread would only wait otherwise, so it shades tiles as well
+    ProcessTiles();
+    {
+        std::unique_lock lock{mutex};
+        done_cv.wait(lock, [this] { return num_busy == 0; });
+    }
+
+    for (const u32 tile : active_tiles) {
+        bins[tile].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+void TileBinner::WorkerLoop() {
+    Common::SetCurrentThreadName("SwRasterizer");
+    u64 last_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock{mutex};
+            work_cv.wait(lock,
+                         [&] { return stop_requested || generation != last_generation; });
+            if (stop_requested)
+                return;
+            last_generation = generation;
+        }
+
+        ProcessTiles();
+
+        bool done;
+        {
+            std::lock_guard lock{mutex};
+            done = --num_busy == 0;
+        }
+        if (done) {
+            done_cv.notify_one();
+        }
+    }
+}
+
+Common::Rectangle<u16> TileBinner::GetBinnedArea() {
+    // Pixels outside of the framebuffer map to the memory of other rows, keep them out of the
+    // tiles so that no two threads can ever touch the same bytes
+    const auto& framebuffer = g_state.regs.framebuffer.framebuffer;
+    return {0, 0, static_cast<u16>(std::min(framebuffer.GetWidth(), TILES_PER_ROW * TILE_SIZE)),
+            static_cast<u16>(std::min(framebuffer.GetHeight(), TILES_PER_ROW * TILE_SIZE))};
+}
+
+void TileBinner::ProcessTiles() {
+    const Common::Rectangle<u16> area = GetBinnedArea();
+    while (true) {
+        const std::size_t next = next_tile.fetch_add(1, std::memory_order_relaxed);
+        if (next >= active_tiles.size())
+            return;
+
+        const u32 tile = active_tiles[next];
+        const u16 left = static_cast<u16>(tile % TILES_PER_ROW * TILE_SIZE);
+        const u16 top = static_cast<u16>(tile / TILES_PER_ROW * TILE_SIZE);
+        const Common::Rectangle<u16> rect{
+            left, top, std::min(static_cast<u16>(left + TILE_SIZE), area.right),
+            std::min(static_cast<u16>(top + TILE_SIZE), area.bottom)};
+        for (const u32 index : bins[tile]) {
+            const auto& triangle = triangles[index];
+            ProcessTriangle(triangle[0], triangle[1], triangle[2], rect);
+        }
+    }
+}
+
+} // namespace Pica::Rasterizer
@@ -0,0 +1,76 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/common_types.h"
+#include "common/math_util.h"
+#include "video_core/swrasterizer/rasterizer.h"
+
+namespace Pica::Rasterizer {
+
+/**
+ * Buckets clipped triangles into screen tiles and rasterizes the tiles on a pool of threads.
+ * Each tile is shaded by a single thread at a time, which replays the triangles touching it in
+ * submission order, so the blend order inside every tile stays the same as the serial path.
+ * The queue reads the PICA state while it is flushed, so it has to be flushed before any
+ * register changes.
+ */
+class TileBinner {
+public:
+    /// Width and height of a tile in pixels, a multiple of the 8x8 framebuffer tiling
+    static constexpr u32 TILE_SIZE = 32;
+
+    explicit TileBinner(std::size_t num_workers);
+    ~TileBinner();
+
+    TileBinner(const TileBinner&) = delete;
+    TileBinner& operator=(const TileBinner&) = delete;
+
+    /// Queues a triangle that went through the clipper
+    void AddTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2);
+
+    /// Rasterizes every queued triangle, returning once all threads are done
+    void Flush();
+
+private:
+    /// Framebuffers are at most 1024x1024
+    static constexpr u32 TILES_PER_ROW = 1024 / TILE_SIZE;
+    static constexpr u32 NUM_TILES = TILES_PER_ROW * TILES_PER_ROW;
+
+    /// Triangles are flushed mid-draw past this point to bound the memory of the queue
+    static constexpr std::size_t MAX_QUEUED_TRIANGLES = 8192;
+
+    /// Returns the part of the framebuffer covered by the tiles, in pixels
+    static Common::Rectangle<u16> GetBinnedArea();
+
+    void WorkerLoop();
+
+    /// Shades tiles until every one of the current flush has been taken
+    void ProcessTiles();
+
+    std::vector<std::array<Vertex, 3>> triangles;
+    /// Indices into triangles of the ones touching each tile, in submission order
+    std::array<std::vector<u32>, NUM_TILES> bins;
+    /// Tiles with at least one triangle, shaded during the next flush
+    std::vector<u32> active_tiles;
+    std::atomic<std::size_t> next_tile{0};
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    u64 generation = 0;
+    std::size_t num_busy = 0;
+    bool stop_requested = false;
+};
+
+} // namespace Pica::Rasterizer
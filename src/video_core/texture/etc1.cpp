@@ -115,6 +115,50 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    /// Decodes every texel, the base colors and modifier tables of both halves are looked up once
+    void GetAllRGB(std::array<Common::Vec3<u8>, 16>& texels) const {
+        std::array<Common::Vec3<int>, 2> base;
+        if (differential_mode) {
+            const Common::Vec3<int> first{static_cast<int>(differential.r),
+                                          static_cast<int>(differential.g),
+                                          static_cast<int>(differential.b)};
+            const Common::Vec3<int> second{first.r() + static_cast<int>(differential.dr),
+                                           first.g() + static_cast<int>(differential.dg),
+                                           first.b() + static_cast<int>(differential.db)};
+            for (std::size_t half = 0; half < base.size(); ++half) {
+                const Common::Vec3<int>& color = half == 0 ? first : second;
+                base[half] = {Color::Convert5To8(color.r()), Color::Convert5To8(color.g()),
+                              Color::Convert5To8(color.b())};
+            }
+        } else {
+            base[0] = {Color::Convert4To8(static_cast<u8>(separate.r1)),
+                       Color::Convert4To8(static_cast<u8>(separate.g1)),
+                       Color::Convert4To8(static_cast<u8>(separate.b1))};
+            base[1] = {Color::Convert4To8(static_cast<u8>(separate.r2)),
+                       Color::Convert4To8(static_cast<u8>(separate.g2)),
+                       Color::Convert4To8(static_cast<u8>(separate.b2))};
+        }
+        const std::array<const std::array<u8, 2>*, 2> tables{
+            &etc1_modifier_table[table_index_1.Value()],
+            &etc1_modifier_table[table_index_2.Value()],
+        };
+
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const unsigned int texel = 4 * x + y;
+                const std::size_t half = ((flip ? y : x) >= 2) ? 1 : 0;
+                int modifier = (*tables[half])[GetTableSubIndex(texel)];
+                if (GetNegationFlag(texel))
+                    modifier *= -1;
+
+                const Common::Vec3<int>& color = base[half];
+                texels[y * 4 + x] = {static_cast<u8>(std::clamp(color.r() + modifier, 0, 255)),
+                                     static_cast<u8>(std::clamp(color.g() + modifier, 0, 255)),
+                                     static_cast<u8>(std::clamp(color.b() + modifier, 0, 255))};
+            }
+        }
+    }
 };
 
 } // anonymous namespace
@@ -124,4 +168,9 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, std::array<Common::Vec3<u8>, 16>& texels) {
+    ETC1Tile tile{value};
+    tile.GetAllRGB(texels);
+}
+
 } // namespace Pica::Texture
@@ -2,12 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstdlib>
+#include <utility>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/swap.h"
 #include "common/vector_math.h"
+#include "core/hw/gpu.h"
+#include "core/hw/pixel_convert.h"
 #include "video_core/regs_texturing.h"
 #include "video_core/texture/etc1.h"
 #include "video_core/texture/texture_decode.h"
@@ -211,6 +215,168 @@ Common::Vec4<u8> LookupTexelInTile(const u8* source, unsigned int x, unsigned in
     }
 }
 
+/// Row major index in a tile of each texel in Morton order
+static constexpr std::array<u8, TILE_SIZE> tile_texel_order = [] {
+    std::array<u8, TILE_SIZE> order{};
+    for (u32 y = 0; y < 8; ++y) {
+        for (u32 x = 0; x < 8; ++x) {
+            order[VideoCore::MortonInterleave(x, y)] = static_cast<u8>(y * 8 + x);
+        }
+    }
+    return order;
+}();
+
+static GPU::Regs::PixelFormat ToPixelFormat(TextureFormat format) {
+    switch (format) {
+    case TextureFormat::RGB8:
+        return GPU::Regs::PixelFormat::RGB8;
+    case TextureFormat::RGB5A1:
+        return GPU::Regs::PixelFormat::RGB5A1;
+    case TextureFormat::RGB565:
+        return GPU::Regs::PixelFormat::RGB565;
+    case TextureFormat::RGBA4:
+        return GPU::Regs::PixelFormat::RGBA4;
+    default:
+        return GPU::Regs::PixelFormat::RGBA8;
+    }
+}
+
+template <typename Func>
+static void DecodeTexels(std::array<Common::Vec4<u8>, TILE_SIZE>& texels, Func&& decode) {
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        texels[i] = decode(i);
+    }
+}
+
+static void DecodeETC1Tile(const u8* source, bool has_alpha,
+                           std::array<Common::Vec4<u8>, TILE_SIZE>& texels, bool disable_alpha) {
+    const std::size_t subtile_size = has_alpha ? 16 : 8;
+    std::array<Common::Vec3<u8>, 16> colors;
+    for (unsigned int subtile_index = 0; subtile_index < ETC1_SUBTILES; ++subtile_index) {
+        const u8* subtile_ptr = source + subtile_index * subtile_size;
+
+        u64_le packed_alpha = 0xFFFFFFFFFFFFFFFFULL;
+        if (has_alpha) {
+            memcpy(&packed_alpha, subtile_ptr, sizeof(u64));
+            subtile_ptr += sizeof(u64);
+        }
+        u64_le subtile_data;
+        memcpy(&subtile_data, subtile_ptr, sizeof(u64));
+        DecodeETC1Subtile(subtile_data, colors);
+
+        const unsigned int base_x = (subtile_index % 2) * 4;
+        const unsigned int base_y = (subtile_index / 2) * 4;
+        for (unsigned int y = 0; y < 4; ++y) {
+            for (unsigned int x = 0; x < 4; ++x) {
+                const u8 alpha = Color::Convert4To8((packed_alpha >> (4 * (x * 4 + y))) & 0xF);
+                texels[(base_y + y) * 8 + base_x + x] =
+                    Common::MakeVec(colors[y * 4 + x], disable_alpha ? u8{255} : alpha);
+            }
+        }
+    }
+}
+
+void DecodeTile(const u8* source, const TextureInfo& info,
+                std::array<Common::Vec4<u8>, TILE_SIZE>& texels, bool disable_alpha) {
+    // Texels in the order they are stored
+    std::array<Common::Vec4<u8>, TILE_SIZE> stored;
+    switch (info.format) {
+    case TextureFormat::RGBA8:
+    case TextureFormat::RGB8:
+    case TextureFormat::RGB5A1:
+    case TextureFormat::RGB565:
+    case TextureFormat::RGBA4:
+        // Same encodings as the framebuffer formats, which have a vectorized row decoder
+        GPU::PixelConvert::DecodeRow(ToPixelFormat(info.format), source, stored[0].AsArray(),
+                                     TILE_SIZE);
+        if (disable_alpha) {
+            for (auto& texel : stored) {
+                texel.a() = 255;
+            }
+        }
+        break;
+
+    case TextureFormat::ETC1:
+    case TextureFormat::ETC1A4:
+        // Its subtiles are decoded row by row already
+        return DecodeETC1Tile(source, info.format == TextureFormat::ETC1A4, texels,
+                              disable_alpha);
+
+    case TextureFormat::IA8:
+        if (disable_alpha) {
+            // Show intensity as red, alpha as green
+            DecodeTexels(stored, [source](std::size_t i) {
+                return Common::Vec4<u8>{source[i * 2 + 1], source[i * 2], 0, 255};
+            });
+        } else {
+            DecodeTexels(stored, [source](std::size_t i) {
+                const u8 intensity = source[i * 2 + 1];
+                return Common::Vec4<u8>{intensity, intensity, intensity, source[i * 2]};
+            });
+        }
+        break;
+
+    case TextureFormat::RG8:
+        DecodeTexels(stored, [source](std::size_t i) {
+            return Common::Vec4<u8>{source[i * 2 + 1], source[i * 2], 0, 255};
+        });
+        break;
+
+    case TextureFormat::I8:
+        DecodeTexels(stored, [source](std::size_t i) {
+            return Common::Vec4<u8>{source[i], source[i], source[i], 255};
+        });
+        break;
+
+    case TextureFormat::A8:
+        if (disable_alpha) {
+            DecodeTexels(stored, [source](std::size_t i) {
+                return Common::Vec4<u8>{source[i], source[i], source[i], 255};
+            });
+        } else {
+            DecodeTexels(stored, [source](std::size_t i) {
+                return Common::Vec4<u8>{0, 0, 0, source[i]};
+            });
+        }
+        break;
+
+    case TextureFormat::IA4:
+        DecodeTexels(stored, [source, disable_alpha](std::size_t i) {
+            const u8 intensity = Color::Convert4To8(source[i] >> 4);
+            const u8 alpha = Color::Convert4To8(source[i] & 0xF);
+            // Show intensity as red, alpha as green
+            return disable_alpha ? Common::Vec4<u8>{intensity, alpha, 0, 255}
+                                 : Common::Vec4<u8>{intensity, intensity, intensity, alpha};
+        });
+        break;
+
+    case TextureFormat::I4:
+        DecodeTexels(stored, [source](std::size_t i) {
+            const u8 intensity = Color::Convert4To8((source[i / 2] >> (4 * (i % 2))) & 0xF);
+            return Common::Vec4<u8>{intensity, intensity, intensity, 255};
+        });
+        break;
+
+    case TextureFormat::A4:
+        DecodeTexels(stored, [source, disable_alpha](std::size_t i) {
+            const u8 alpha = Color::Convert4To8((source[i / 2] >> (4 * (i % 2))) & 0xF);
+            return disable_alpha ? Common::Vec4<u8>{alpha, alpha, alpha, 255}
+                                 : Common::Vec4<u8>{0, 0, 0, alpha};
+        });
+        break;
+
+    default:
+        LOG_ERROR(HW_GPU, "Unknown texture format: {:x}", (u32)info.format);
+        DEBUG_ASSERT(false);
+        stored.fill({});
+        break;
+    }
+
+    for (std::size_t i = 0; i < TILE_SIZE; ++i) {
+        texels[tile_texel_order[i]] = stored[i];
+    }
+}
+
 TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& config,
                                           const TexturingRegs::TextureFormat& format) {
     TextureInfo info;
@@ -222,4 +388,64 @@ TextureInfo TextureInfo::FromPicaRegister(const TexturingRegs::TextureConfig& co
     return info;
 }
 
+bool IsNextLevelBoxFiltered(const u8* level, const TextureInfo& info) {
+    TextureInfo next_info = info;
+    next_info.width /= 2;
+    next_info.height /= 2;
+    next_info.SetDefaultStride();
+    const u8* next_level = level + info.stride * (info.height / 8);
+    const std::size_t tile_size = CalculateTileSize(info.format);
+
+    // Encoding the mipmaps with ETC1 adds some error of its own
+    const bool is_compressed =
+        info.format == TextureFormat::ETC1 || info.format == TextureFormat::ETC1A4;
+    const u32 max_error_per_tile = (is_compressed ? 8 : 2) * 8 * 8 * 4;
+
+    // The corners and the center of the next level
+    const u32 tiles_x = next_info.width / 8;
+    const u32 tiles_y = next_info.height / 8;
+    const std::array<std::pair<u32, u32>, 5> samples{{
+        {0, 0},
+        {tiles_x - 1, 0},
+        {0, tiles_y - 1},
+        {tiles_x - 1, tiles_y - 1},
+        {tiles_x / 2, tiles_y / 2},
+    }};
+
+    for (const auto& [tile_x, tile_y] : samples) {
+        std::array<Common::Vec4<u8>, 8 * 8> next_texels;
+        DecodeTile(next_level + tile_y * next_info.stride + tile_x * tile_size, next_info,
+                   next_texels);
+
+        // The 16x16 texels of the level that make up the tile
+        std::array<std::array<Common::Vec4<u8>, 8 * 8>, 4> texels;
+        for (u32 i = 0; i < 4; ++i) {
+            const u32 source_x = tile_x * 2 + i % 2;
+            const u32 source_y = tile_y * 2 + i / 2;
+            DecodeTile(level + source_y * info.stride + source_x * tile_size, info, texels[i]);
+        }
+        const auto texel = [&texels](u32 x, u32 y) -> const Common::Vec4<u8>& {
+            return texels[(y / 8) * 2 + x / 8][(y % 8) * 8 + x % 8];
+        };
+
+        u32 error = 0;
+        for (u32 y = 0; y < 8; ++y) {
+            for (u32 x = 0; x < 8; ++x) {
+                const auto& next = next_texels[y * 8 + x];
+                for (std::size_t component = 0; component < 4; ++component) {
+                    const int sum = texel(x * 2, y * 2)[component] +
+                                    texel(x * 2 + 1, y * 2)[component] +
+                                    texel(x * 2, y * 2 + 1)[component] +
+                                    texel(x * 2 + 1, y * 2 + 1)[component];
+                    error += std::abs((sum + 2) / 4 - next[component]);
+                }
+            }
+        }
+        if (error > max_error_per_tile) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace Pica::Texture
@@ -1,10 +1,14 @@
+#include <array>
+#include <cstring>
 #include <memory>
+#include <type_traits>
 #include <boost/range/algorithm/fill.hpp>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/simd.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
 #include "video_core/debug_utils/debug_utils.h"
@@ -17,6 +21,76 @@
 
 namespace Pica {
 
+/// Converts the components of an attribute, padded with (0, 0, 0, 1), to float24
+template <typename T>
+static void ConvertAttribute(const std::array<T, 4>& data, Common::Vec4<float24>& attr) {
+    static_assert(sizeof(Common::Vec4<float24>) == 4 * sizeof(float));
+    float* dest = reinterpret_cast<float*>(&attr);
+    if constexpr (std::is_same_v<T, float>) {
+        std::memcpy(dest, data.data(), sizeof(data));
+    } else {
+#if defined(ARCHITECTURE_x86_64)
+        __m128i value;
+        if constexpr (std::is_same_v<T, s16>) {
+            value = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data.data()));
+            value = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+        } else {
+            u32 packed;
+            std::memcpy(&packed, data.data(), sizeof(packed));
+            value = _mm_cvtsi32_si128(static_cast<s32>(packed));
+            if constexpr (std::is_same_v<T, s8>) {
+                value = _mm_unpacklo_epi8(value, value);
+                value = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 24);
+            } else {
+                const __m128i zero = _mm_setzero_si128();
+                value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(value, zero), zero);
+            }
+        }
+        _mm_storeu_ps(dest, _mm_cvtepi32_ps(value));
+#elif defined(ARCHITECTURE_ARM64)
+        if constexpr (std::is_same_v<T, s16>) {
+            vst1q_f32(dest, vcvtq_f32_s32(vmovl_s16(vld1_s16(data.data()))));
+        } else {
+            u32 packed;
+            std::memcpy(&packed, data.data(), sizeof(packed));
+            if constexpr (std::is_same_v<T, s8>) {
+                const int16x8_t value = vmovl_s8(vreinterpret_s8_u32(vdup_n_u32(packed)));
+                vst1q_f32(dest, vcvtq_f32_s32(vmovl_s16(vget_low_s16(value))));
+            } else {
+                const uint16x8_t value = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packed)));
+                vst1q_f32(dest, vcvtq_f32_u32(vmovl_u16(vget_low_u16(value))));
+            }
+        }
+#else
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            dest[comp] = static_cast<float>(data[comp]);
+        }
+#endif
+    }
+}
+
+/**
+ * Loads an attribute with `count` components of type T. Default values are set if array elements
+ * have < 4 components. This is *not* carried over from the default attribute settings even if
+ * they're enabled for this attribute.
+ */
+template <typename T, std::size_t count>
+static void CopyAttribute(Common::Vec4<float24>& attr, const u8* source) {
+    std::array<T, 4> data{0, 0, 0, 1};
+    std::memcpy(data.data(), source, count * sizeof(T));
+    ConvertAttribute(data, attr);
+}
+
+/// Handlers indexed by VertexAttributeFormat and then by the number of components minus one
+static constexpr std::array<std::array<VertexLoader::CopyHandler, 4>, 4> copy_handlers{{
+    {&CopyAttribute<s8, 1>, &CopyAttribute<s8, 2>, &CopyAttribute<s8, 3>, &CopyAttribute<s8, 4>},
+    {&CopyAttribute<u8, 1>, &CopyAttribute<u8, 2>, &CopyAttribute<u8, 3>, &CopyAttribute<u8, 4>},
+    {&CopyAttribute<s16, 1>, &CopyAttribute<s16, 2>, &CopyAttribute<s16, 3>,
+     &CopyAttribute<s16, 4>},
+    {&CopyAttribute<float, 1>, &CopyAttribute<float, 2>, &CopyAttribute<float, 3>,
+     &CopyAttribute<float, 4>},
+}};
+
 void VertexLoader::Setup(const PipelineRegs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
@@ -68,100 +142,67 @@ void VertexLoader::Setup(const PipelineRegs& regs) {
         }
     }
 
-    is_setup = true;
-}
-
-using CopyHandler = void (*)(int, int, Shader::AttributeBuffer&, u32);
-
-static void CopyBYTE(int i, int size, Shader::AttributeBuffer& input, u32 source_addr) {
-    const s8* srcdata =
-        reinterpret_cast<const s8*>(VideoCore::Memory()->GetPhysicalPointer(source_addr));
-    for (unsigned int comp = 0; comp < size; ++comp) {
-        input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-    }
-}
-
-static void CopyUBYTE(int i, int size, Shader::AttributeBuffer& input, u32 source_addr) {
-    const u8* srcdata =
-        reinterpret_cast<const u8*>(VideoCore::Memory()->GetPhysicalPointer(source_addr));
-    for (unsigned int comp = 0; comp < size; ++comp) {
-        input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-    }
-}
-
-static void CopySHORT(int i, int size, Shader::AttributeBuffer& input, u32 source_addr) {
-    const s16* srcdata =
-        reinterpret_cast<const s16*>(VideoCore::Memory()->GetPhysicalPointer(source_addr));
-    for (unsigned int comp = 0; comp < size; ++comp) {
-        input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
+    // Resolve the handler of every attribute now, so that loading a vertex only walks the
+    // attributes that are actually loaded
+    for (int i = 0; i < num_total_attributes; ++i) {
+        const u32 elements = vertex_attribute_elements[i];
+        if (elements != 0) {
+            const auto format = vertex_attribute_formats[i];
+            const u32 element_size = format == PipelineRegs::VertexAttributeFormat::FLOAT
+                                         ? 4
+                                         : format == PipelineRegs::VertexAttributeFormat::SHORT
+                                               ? 2
+                                               : 1;
+            attribute_loads[num_attribute_loads++] = {
+                copy_handlers[static_cast<u32>(format)][elements - 1], static_cast<u32>(i),
+                vertex_attribute_sources[i], vertex_attribute_strides[i], elements * element_size};
+        } else if (vertex_attribute_is_default[i]) {
+            default_attributes[num_default_attributes++] = static_cast<u32>(i);
+        }
     }
-}
 
-static void CopyFLOAT(int i, int size, Shader::AttributeBuffer& input, u32 source_addr) {
-    const float* srcdata =
-        reinterpret_cast<const float*>(VideoCore::Memory()->GetPhysicalPointer(source_addr));
-    for (unsigned int comp = 0; comp < size; ++comp) {
-        input.attr[i][comp] = float24::FromFloat32(srcdata[comp]);
-    }
+    is_setup = true;
 }
 
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex,
                               Shader::AttributeBuffer& input,
-                              DebugUtils::MemoryAccessTracker& memory_accesses) {
+                              DebugUtils::MemoryAccessTracker& memory_accesses) const {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
-    CopyHandler handlers[4] = {&CopyBYTE, &CopyUBYTE, &CopySHORT, &CopyFLOAT};
-
-    for (int i = 0; i < num_total_attributes; ++i) {
-        if (vertex_attribute_elements[i] != 0) {
-            // Load per-vertex data from the loader arrays
-            u32 source_addr =
-                base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
+    for (std::size_t n = 0; n < num_attribute_loads; ++n) {
+        const AttributeLoad& load = attribute_loads[n];
+        const u32 i = load.attribute;
+        // Load per-vertex data from the loader arrays
+        u32 source_addr = base_address + load.source + load.stride * vertex;
 #ifdef DEBUG_CONTEXT
-            if (g_debug_context && Pica::g_debug_context->recorder) {
-                memory_accesses.AddAccess(
-                    source_addr,
-                    vertex_attribute_elements[i] *
-                        ((vertex_attribute_formats[i] == PipelineRegs::VertexAttributeFormat::FLOAT)
-                             ? 4
-                             : (vertex_attribute_formats[i] ==
-                                PipelineRegs::VertexAttributeFormat::SHORT)
-                                   ? 2
-                                   : 1));
-            }
+        if (g_debug_context && Pica::g_debug_context->recorder) {
+            memory_accesses.AddAccess(source_addr, load.size);
+        }
 #endif
-            handlers[static_cast<int>(vertex_attribute_formats[i])](i, vertex_attribute_elements[i],
-                                                                    input, source_addr);
-
-            // Default attribute values set if array elements have < 4 components. This
-            // is *not* carried over from the default attribute settings even if they're
-            // enabled for this attribute.
-            for (unsigned int comp = vertex_attribute_elements[i]; comp < 4; ++comp) {
-                input.attr[i][comp] =
-                    comp == 3 ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
-            }
+        load.handler(input.attr[i], VideoCore::Memory()->GetPhysicalPointer(source_addr));
+
+        LOG_TRACE(HW_GPU,
+                  "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
+                  "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
+                  vertex_attribute_elements[i], i, vertex, index, base_address, load.source,
+                  load.stride * vertex, input.attr[i][0].ToFloat32(),
+                  input.attr[i][1].ToFloat32(), input.attr[i][2].ToFloat32(),
+                  input.attr[i][3].ToFloat32());
+    }
 
-            LOG_TRACE(HW_GPU,
-                      "Loaded {} components of attribute {:x} for vertex {:x} (index {:x}) from "
-                      "0x{:08x} + 0x{:08x} + 0x{:04x}: {} {} {} {}",
-                      vertex_attribute_elements[i], i, vertex, index, base_address,
-                      vertex_attribute_sources[i], vertex_attribute_strides[i] * vertex,
-                      input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                      input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else if (vertex_attribute_is_default[i]) {
-            // Load the default attribute if we're configured to do so
-            input.attr[i] = g_state.input_default_attributes.attr[i];
-            LOG_TRACE(
-                HW_GPU,
-                "Loaded default attribute {:x} for vertex {:x} (index {:x}): ({}, {}, {}, {})", i,
-                vertex, index, input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
-                input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
-        } else {
-            // TODO(yuriks): In this case, no data gets loaded and the vertex
-            // remains with the last value it had. This isn't currently maintained
-            // as global state, however, and so won't work in Citra yet.
-        }
+    for (std::size_t n = 0; n < num_default_attributes; ++n) {
+        const u32 i = default_attributes[n];
+        // Load the default attribute if we're configured to do so
+        input.attr[i] = g_state.input_default_attributes.attr[i];
+        LOG_TRACE(HW_GPU,
+                  "Loaded default attribute {:x} for vertex {:x} (index {:x}): ({}, {}, {}, {})",
+                  i, vertex, index, input.attr[i][0].ToFloat32(), input.attr[i][1].ToFloat32(),
+                  input.attr[i][2].ToFloat32(), input.attr[i][3].ToFloat32());
     }
+
+    // TODO(yuriks): Attributes that are neither loaded nor default get no data, and the vertex
+    // remains with the last value it had. This isn't currently maintained as global state, however,
+    // and so won't work in Citra yet.
 }
 
 } // namespace Pica
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/pica_types.h"
 #include "video_core/regs_pipeline.h"
 
 namespace Pica {
@@ -23,12 +26,15 @@ public:
 
     void Setup(const PipelineRegs& regs);
     void LoadVertex(u32 base_address, int index, int vertex, Shader::AttributeBuffer& input,
-                    DebugUtils::MemoryAccessTracker& memory_accesses);
+                    DebugUtils::MemoryAccessTracker& memory_accesses) const;
 
     int GetNumTotalAttributes() const {
         return num_total_attributes;
     }
 
+    /// Loads an attribute from memory, with a specialization for each format and component count
+    using CopyHandler = void (*)(Common::Vec4<float24>& attr, const u8* source);
+
 private:
     std::array<u32, 16> vertex_attribute_sources;
     std::array<u32, 16> vertex_attribute_strides{};
@@ -36,6 +42,20 @@ private:
     std::array<u32, 16> vertex_attribute_elements{};
     std::array<bool, 16> vertex_attribute_is_default;
     int num_total_attributes = 0;
+
+    struct AttributeLoad {
+        CopyHandler handler;
+        u32 attribute;
+        u32 source;
+        u32 stride;
+        u32 size; ///< Number of bytes read for each vertex
+    };
+    /// Attributes loaded from the loader arrays, in order
+    std::array<AttributeLoad, 16> attribute_loads;
+    std::size_t num_attribute_loads = 0;
+    /// Attributes that take their value from the default attributes
+    std::array<u32, 16> default_attributes;
+    std::size_t num_default_attributes = 0;
     bool is_setup = false;
 };
 
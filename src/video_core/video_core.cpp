@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
 #include "common/logging/log.h"
 #include "core/frontend/emu_window.h"
@@ -21,16 +22,22 @@ namespace VideoCore {
 
 static std::unique_ptr<RendererBase> g_renderer;
 static std::unique_ptr<RasterizerInterface> g_rasterizer;
+static std::unique_ptr<GPUThread> g_gpu_thread;
 static Memory::MemorySystem* g_memory = nullptr;
 static bool g_setting_update = false;
 static u16 g_scale_factor = 1;
 static u32 g_current_frame = 0;
+static bool g_frame_skipped = false;
+static u16 g_skipped_frames = 0;
+/// Frames the emulation is behind the frame limit, which the automatic frame skip catches up on
+static double g_frame_lag = 0.0;
 
 static u32 g_background_width = 0;
 static u32 g_background_height = 0;
 static std::vector<u32> g_background_pixels;
 
 std::atomic<bool> g_hw_shader_enabled;
+std::atomic<bool> g_shader_jit_enabled;
 std::function<void(u32 width, u32 height, const std::vector<u32>& pixels)>
     g_screenshot_complete_callback;
 
@@ -50,25 +57,41 @@ static void ApplySetting() {
 
     g_rasterizer->CheckForConfigChanges();
     g_hw_shader_enabled = Settings::values.use_hw_shader;
+    g_shader_jit_enabled = Settings::values.use_shader_jit;
 
     g_setting_update = false;
 }
 
+/// Creates the renderer of the graphics API, the only place that picks a backend
+static std::unique_ptr<RendererBase> CreateRenderer(Frontend::EmuWindow& window) {
+    return std::make_unique<OpenGL::RendererOpenGL>(window, Settings::values.use_gles);
+}
+
+/// Creates the rasterizer matching the renderer, or the software one
+static std::unique_ptr<RasterizerInterface> CreateRasterizer(Frontend::EmuWindow& window) {
+    if (Settings::values.use_hw_renderer) {
+        return std::make_unique<OpenGL::RasterizerOpenGL>(window);
+    }
+    return std::make_unique<VideoCore::SWRasterizer>();
+}
+
 /// Initialize the video core
 ResultStatus Init(Frontend::EmuWindow& window, Memory::MemorySystem& memory) {
     g_memory = &memory;
     Pica::Init();
 
-    g_renderer = std::make_unique<OpenGL::RendererOpenGL>(window, Settings::values.use_gles);
+    g_renderer = CreateRenderer(window);
     ResultStatus result = g_renderer->Init();
     if (result == ResultStatus::Success) {
-        if (Settings::values.use_hw_renderer) {
-            g_rasterizer = std::make_unique<OpenGL::RasterizerOpenGL>();
-        } else {
-            g_rasterizer = std::make_unique<VideoCore::SWRasterizer>();
-        }
+        g_rasterizer = CreateRasterizer(window);
         ApplySetting();
         g_current_frame = 0;
+        g_frame_skipped = false;
+        g_skipped_frames = 0;
+        g_frame_lag = 0.0;
+        if (Settings::values.use_gpu_thread) {
+            g_gpu_thread = std::make_unique<GPUThread>(window);
+        }
     } else {
         g_renderer.reset();
     }
@@ -88,6 +111,32 @@ RasterizerInterface* Rasterizer() {
     return g_rasterizer.get();
 }
 
+GPUThread* GetGPUThread() {
+    return g_gpu_thread.get();
+}
+
+/// Decides whether the next frame is skipped, from the settings and the time the last one took
+static bool SkipNextFrame() {
+    const u16 frame_skip = Settings::values.frame_skip;
+    if (frame_skip == 0) {
+        g_frame_lag = 0.0;
+        return false;
+    }
+
+    if (Settings::values.auto_frame_skip) {
+        const u16 frame_limit = Settings::values.use_frame_limit ? Settings::values.frame_limit : 0;
+        const double target_scale = frame_limit != 0 ? 100.0 / frame_limit : 1.0;
+        const double scale = Core::System::GetInstance().perf_stats->GetLastFrameTimeScale();
+        // A long stall, like a loading screen, doesn't make the frames after it skip for long
+        g_frame_lag = std::clamp(g_frame_lag + scale / target_scale - 1.0, 0.0,
+                                 static_cast<double>(frame_skip));
+        if (g_frame_lag < 1.0) {
+            return false;
+        }
+    }
+    return g_skipped_frames < frame_skip;
+}
+
 void FrameUpdate() {
     Core::System::GetInstance().perf_stats->EndSystemFrame();
     Core::System::GetInstance().perf_stats->BeginSystemFrame();
@@ -95,6 +144,8 @@ void FrameUpdate() {
     // processing thread events
     g_renderer->GetRenderWindow().PollEvents();
     g_current_frame += 1;
+    g_frame_skipped = SkipNextFrame();
+    g_skipped_frames = g_frame_skipped ? static_cast<u16>(g_skipped_frames + 1) : 0;
 
     // background
     if (!g_background_pixels.empty()) {
@@ -125,6 +176,10 @@ u32 GetCurrentFrame() {
     return g_current_frame;
 }
 
+bool IsFrameSkipped() {
+    return g_frame_skipped;
+}
+
 void SetBackgroundImage(u32* pixels, u32 width, u32 height) {
     g_background_pixels.insert(g_background_pixels.begin(), pixels, pixels + width * height);
     g_background_width = width;
@@ -133,6 +188,8 @@ void SetBackgroundImage(u32* pixels, u32 width, u32 height) {
 
 /// Shutdown the video core
 void Shutdown() {
+    // Finishes the queued work and hands the render context back for the cleanup
+    g_gpu_thread.reset();
     Pica::Shutdown();
     g_rasterizer.reset();
     g_renderer.reset();
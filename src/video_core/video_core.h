@@ -6,7 +6,9 @@
 
 #include <atomic>
 #include <memory>
+#include <utility>
 #include <vector>
+#include "video_core/gpu_thread.h"
 
 namespace Frontend {
 class EmuWindow;
@@ -27,6 +29,7 @@ class RasterizerInterface;
 // TODO: Wrap these in a user settings struct along with any other graphics settings (often set from
 // qt ui)
 extern std::atomic<bool> g_hw_shader_enabled;
+extern std::atomic<bool> g_shader_jit_enabled;
 extern std::function<void(u32 width, u32 height, const std::vector<u32>& pixels)>
     g_screenshot_complete_callback;
 
@@ -46,9 +49,26 @@ u16 GetResolutionScaleFactor();
 u32 GetCurrentFrame();
 void SetBackgroundImage(u32* pixels, u32 width, u32 height);
 
+/// Returns the GPU thread, or nullptr when the GPU work runs on the emulation thread
+GPUThread* GetGPUThread();
+
+/// Runs a function that uses the render context and waits for it, on the GPU thread if there is one
+template <typename Func>
+void RunOnGPUThread(Func&& func) {
+    GPUThread* gpu_thread = GetGPUThread();
+    if (gpu_thread && !gpu_thread->IsCurrentThread()) {
+        gpu_thread->Sync(std::forward<Func>(func));
+    } else {
+        func();
+    }
+}
+
 void FrameUpdate();
 void SettingUpdate();
 
+/// Returns true if the current frame is emulated but neither drawn nor shown
+bool IsFrameSkipped();
+
 /// Shutdown the video core
 void Shutdown();
 
@@ -134,11 +134,19 @@ void RoomJson::ClearPlayers() {
 }
 
 AnnounceMultiplayerRoom::RoomList RoomJson::GetRoomList() {
-    auto reply = client.GetJson("/lobby", true).returned_data;
-    if (reply.empty()) {
+    std::lock_guard lock{lobby_mutex};
+    const auto reply = lobby_client.GetJsonIfModified("/lobby", true, lobby_validators);
+    if (reply.result_code == Common::WebResult::Code::NotModified) {
+        return lobby;
+    }
+    if (reply.returned_data.empty()) {
+        lobby_validators = {};
         return {};
     }
-    return nlohmann::json::parse(reply).at("rooms").get<AnnounceMultiplayerRoom::RoomList>();
+    lobby = nlohmann::json::parse(reply.returned_data)
+                .at("rooms")
+                .get<AnnounceMultiplayerRoom::RoomList>();
+    return lobby;
 }
 
 void RoomJson::Delete() {
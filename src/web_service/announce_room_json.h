@@ -5,6 +5,7 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 #include <string>
 #include "common/announce_multiplayer_room.h"
 #include "web_service/web_backend.h"
@@ -18,7 +19,8 @@ namespace WebService {
 class RoomJson : public AnnounceMultiplayerRoom::Backend {
 public:
     RoomJson(const std::string& host, const std::string& username, const std::string& token)
-        : client(host, username, token), host(host), username(username), token(token) {}
+        : client(host, username, token), lobby_client(host, username, token), host(host),
+          username(username), token(token) {}
     ~RoomJson() = default;
     void SetRoomInformation(const std::string& name, const std::string& description, const u16 port,
                             const u32 max_player, const u32 net_version, const bool has_password,
@@ -37,6 +39,14 @@ public:
 private:
     AnnounceMultiplayerRoom::Room room;
     Client client;
+
+    /// The lobby is fetched from other threads than the announce, with its own client
+    std::mutex lobby_mutex;
+    Client lobby_client;
+    /// The last lobby received, sent again while the web service reports it unchanged
+    CacheValidators lobby_validators;
+    AnnounceMultiplayerRoom::RoomList lobby;
+
     std::string host;
     std::string username;
     std::string token;
@@ -0,0 +1,262 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+#include <minilzo.h>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread.h"
+#include "common/web_result.h"
+#include "web_service/telemetry_spool.h"
+#include "web_service/web_backend.h"
+
+namespace WebService {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Reports queued within this delay of each other are uploaded together
+constexpr std::chrono::seconds BatchDelay{5};
+/// Delay before retrying a failed upload, doubled on each failure up to MaxRetryDelay
+constexpr std::chrono::seconds MinRetryDelay{60};
+constexpr std::chrono::seconds MaxRetryDelay{60 * 60};
+/// The oldest reports are dropped beyond this, for hosts unreachable over many sessions
+constexpr std::size_t MaxQueuedReports = 64;
+/// How long the destructor waits for the upload thread before leaving it to the process exit
+constexpr std::chrono::milliseconds StopGrace{500};
+
+constexpr u32 ReportMagic = 0x4D4C5443; // "CTLM"
+constexpr char ReportExtension[] = ".ctlm";
+
+struct ReportHeader {
+    u32_le magic;
+    u32_le host_size;
+    u32_le content_size;
+    u32_le compressed_size;
+};
+static_assert(sizeof(ReportHeader) == 16, "ReportHeader has incorrect size");
+
+std::string GetSpoolDir() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "telemetry" DIR_SEP;
+}
+
+/// Returns the paths of the queued reports, oldest first
+std::vector<std::string> ListReports() {
+    std::vector<std::string> reports;
+    const std::string dir = GetSpoolDir();
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, dir,
+        [&reports](u64*, const std::string& directory, const std::string& virtual_name) {
+            const std::size_t extension = virtual_name.rfind(ReportExtension);
+            if (extension != std::string::npos &&
+                extension + std::strlen(ReportExtension) == virtual_name.size()) {
+                reports.push_back(directory + DIR_SEP_CHR + virtual_name);
+            }
+            return true;
+        });
+    // The names start with the time the reports were queued
+    std::sort(reports.begin(), reports.end());
+    return reports;
+}
+
+std::string EncodeReport(const std::string& host, const std::string& content) {
+    std::vector<u8> compressed(content.size() + content.size() / 16 + 64 + 3);
+    std::vector<lzo_align_t> work_memory((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) /
+                                         sizeof(lzo_align_t));
+    lzo_uint compressed_size = 0;
+    lzo1x_1_compress(reinterpret_cast<const u8*>(content.data()), content.size(),
+                     compressed.data(), &compressed_size, work_memory.data());
+
+    ReportHeader header;
+    header.magic = ReportMagic;
+    header.host_size = static_cast<u32>(host.size());
+    header.content_size = static_cast<u32>(content.size());
+    header.compressed_size = static_cast<u32>(compressed_size);
+
+    std::string report(reinterpret_cast<const char*>(&header), sizeof(header));
+    report += host;
+    report.append(reinterpret_cast<const char*>(compressed.data()), compressed_size);
+    return report;
+}
+
+bool DecodeReport(const std::string& report, std::string& host, std::string& content) {
+    ReportHeader header;
+    if (report.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, report.data(), sizeof(header));
+    if (header.magic != ReportMagic ||
+        report.size() != sizeof(header) + header.host_size + header.compressed_size) {
+        return false;
+    }
+
+    host = report.substr(sizeof(header), header.host_size);
+    content.resize(header.content_size);
+    lzo_uint content_size = content.size();
+    const auto compressed = reinterpret_cast<const u8*>(report.data()) + sizeof(header) +
+                            header.host_size;
+    return lzo1x_decompress_safe(compressed, header.compressed_size,
+                                 reinterpret_cast<u8*>(content.data()), &content_size,
+                                 nullptr) == LZO_E_OK &&
+           content_size == content.size();
+}
+
+} // Anonymous namespace
+
+struct TelemetrySpool::Impl {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic_bool stop_requested{false};
+    bool running = true;
+    /// Whether there are reports to upload at upload_time
+    bool pending = true;
+    Clock::time_point upload_time = Clock::now() + BatchDelay;
+    u32 next_id = 0;
+
+    /// Uploads the queued reports, returns false when one failed and the rest has to wait
+    bool UploadReports();
+
+    static void ThreadLoop(std::shared_ptr<Impl> impl);
+};
+
+bool TelemetrySpool::Impl::UploadReports() {
+    for (const std::string& path : ListReports()) {
+        if (stop_requested) {
+            return true;
+        }
+
+        std::string report, host, content;
+        FileUtil::ReadFileToString(false, path, report);
+        if (!DecodeReport(report, host, content)) {
+            LOG_ERROR(WebService, "Dropping invalid telemetry report {}", path);
+            FileUtil::Delete(path);
+            continue;
+        }
+
+        // The report is only dequeued once received, an exit in between sends it again
+        const auto result = Client{host, "", ""}.PostJson("/telemetry", content, true);
+        if (result.result_code != Common::WebResult::Code::Success) {
+            return false;
+        }
+        FileUtil::Delete(path);
+    }
+    return true;
+}
+
+void TelemetrySpool::Impl::ThreadLoop(std::shared_ptr<Impl> impl) {
+    Common::SetCurrentThreadName("TelemetrySpool");
+    Common::SetCurrentThreadLowPriority();
+
+    std::chrono::seconds retry_delay = MinRetryDelay;
+    std::unique_lock lock{impl->mutex};
+    while (!impl->stop_requested) {
+        if (!impl->pending) {
+            impl->cv.wait(lock, [&impl] { return impl->stop_requested || impl->pending; });
+            continue;
+        }
+        // A report queued in the meantime moves the upload time, which is checked again
+        const auto stopped = [&impl] { return impl->stop_requested.load(); };
+        if (impl->cv.wait_until(lock, impl->upload_time, stopped) ||
+            Clock::now() < impl->upload_time) {
+            continue;
+        }
+
+        impl->pending = false;
+        lock.unlock();
+        const bool uploaded = impl->UploadReports();
+        lock.lock();
+
+        if (impl->stop_requested) {
+            break;
+        }
+        if (uploaded) {
+            retry_delay = MinRetryDelay;
+        } else {
+            LOG_INFO(WebService, "Telemetry upload failed, retrying in {} seconds",
+                     retry_delay.count());
+            impl->pending = true;
+            impl->upload_time = std::max(impl->upload_time, Clock::now() + retry_delay);
+            retry_delay = std::min(retry_delay * 2, MaxRetryDelay);
+        }
+    }
+    impl->running = false;
+    impl->cv.notify_all();
+}
+
+TelemetrySpool::TelemetrySpool() : impl(std::make_shared<Impl>()) {
+    if (lzo_init() != LZO_E_OK) {
+        LOG_ERROR(WebService, "lzo_init() failed, telemetry is not sent");
+        impl->running = false;
+        return;
+    }
+    FileUtil::CreateFullPath(GetSpoolDir());
+    // Also sends what previous sessions left queued
+    thread = std::thread(&Impl::ThreadLoop, impl);
+}
+
+TelemetrySpool::~TelemetrySpool() {
+    if (!thread.joinable()) {
+        return;
+    }
+
+    std::unique_lock lock{impl->mutex};
+    impl->stop_requested = true;
+    impl->cv.notify_all();
+    if (impl->cv.wait_for(lock, StopGrace, [this] { return !impl->running; })) {
+        lock.unlock();
+        thread.join();
+    } else {
+        thread.detach();
+    }
+}
+
+TelemetrySpool& TelemetrySpool::GetInstance() {
+    static TelemetrySpool spool;
+    return spool;
+}
+
+void TelemetrySpool::Push(const std::string& host, const std::string& content) {
+    std::unique_lock lock{impl->mutex};
+    if (!impl->running) {
+        return;
+    }
+    const u32 id = impl->next_id++;
+    lock.unlock();
+
+    // Written aside first, so that the upload thread never reads a partial report
+    const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    const std::string path = fmt::format("{}{:016x}{:08x}", GetSpoolDir(), time.count(), id);
+    const std::string report = EncodeReport(host, content);
+    if (FileUtil::WriteStringToFile(false, path + ".tmp", report) != report.size() ||
+        !FileUtil::Rename(path + ".tmp", path + ReportExtension)) {
+        LOG_ERROR(WebService, "Could not queue the telemetry report {}", path);
+        FileUtil::Delete(path + ".tmp");
+        return;
+    }
+
+    const std::vector<std::string> reports = ListReports();
+    if (reports.size() > MaxQueuedReports) {
+        LOG_WARNING(WebService, "Dropping the {} oldest telemetry reports",
+                    reports.size() - MaxQueuedReports);
+        std::for_each(reports.begin(), reports.end() - MaxQueuedReports, FileUtil::Delete);
+    }
+
+    lock.lock();
+    impl->pending = true;
+    impl->upload_time = std::max(impl->upload_time, Clock::now() + BatchDelay);
+    impl->cv.notify_all();
+}
+
+} // namespace WebService
@@ -0,0 +1,38 @@
+// Copyright 2020 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace WebService {
+
+/**
+ * Queue of the telemetry reports waiting to be sent, kept compressed on disk so that the reports of
+ * sessions that ended offline, or right before the program exited, are sent by the next ones. A low
+ * priority thread uploads the queued reports together a little after the last one was added, and
+ * retries the failed ones with an increasing delay.
+ */
+class TelemetrySpool {
+public:
+    TelemetrySpool();
+    /// Stops the upload thread without waiting on the report in flight, which stays queued
+    ~TelemetrySpool();
+
+    /// Returns the spool of the process, created on first use
+    static TelemetrySpool& GetInstance();
+
+    /// Queues a report to be posted to the telemetry endpoint of the host
+    void Push(const std::string& host, const std::string& content);
+
+private:
+    struct Impl;
+    /// Shared with the upload thread, which may outlive the spool
+    std::shared_ptr<Impl> impl;
+    std::thread thread;
+};
+
+} // namespace WebService
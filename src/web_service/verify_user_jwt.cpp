@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
 #include <system_error>
 #include <jwt/jwt.hpp>
 #include "common/logging/log.h"
@@ -11,36 +13,110 @@
 
 namespace WebService {
 
-static std::string public_key;
-std::string GetPublicKey(const std::string& host) {
-    if (public_key.empty()) {
-        Client client(host, "", ""); // no need for credentials here
-        public_key = client.GetPlain("/jwt/external/key.pem", true).returned_data;
-        if (public_key.empty()) {
-            LOG_ERROR(WebService, "Could not fetch external JWT public key, verification may fail");
-        } else {
-            LOG_INFO(WebService, "Fetched external JWT public key (size={})", public_key.size());
+/// Verified tokens are kept at most this long, so that revoked roles take effect eventually
+constexpr std::chrono::minutes MaxTokenLifetime{30};
+/// Tokens kept before the expired ones are dropped, and all of them if none are expired
+constexpr std::size_t MaxCachedTokens = 4096;
+/// How often the public key is fetched again, and how soon after a failed fetch
+constexpr std::chrono::minutes KeyRefreshInterval{6 * 60};
+constexpr std::chrono::minutes KeyRetryInterval{1};
+
+static std::string FetchPublicKey(const std::string& host) {
+    Client client(host, "", ""); // no need for credentials here
+    std::string key = client.GetPlain("/jwt/external/key.pem", true).returned_data;
+    if (key.empty()) {
+        LOG_ERROR(WebService, "Could not fetch external JWT public key, verification may fail");
+    } else {
+        LOG_INFO(WebService, "Fetched external JWT public key (size={})", key.size());
+    }
+    return key;
+}
+
+VerifyUserJWT::VerifyUserJWT(const std::string& host) : host(host), pub_key(FetchPublicKey(host)) {
+    refresh_thread = std::thread(&VerifyUserJWT::RefreshLoop, this);
+}
+
+VerifyUserJWT::~VerifyUserJWT() {
+    stop_event.Set();
+    refresh_thread.join();
+}
+
+void VerifyUserJWT::RefreshLoop() {
+    Common::SetCurrentThreadName("JWTKeyRefresh");
+    bool have_key;
+    {
+        std::lock_guard lock{mutex};
+        have_key = !pub_key.empty();
+    }
+    while (!stop_event.WaitUntil(std::chrono::steady_clock::now() +
+                                 (have_key ? KeyRefreshInterval : KeyRetryInterval))) {
+        std::string key = FetchPublicKey(host);
+        have_key = !key.empty();
+        if (!have_key) {
+            // Keep verifying with the old key until a new one is fetched
+            continue;
+        }
+        std::lock_guard lock{mutex};
+        if (key != pub_key) {
+            // Tokens signed with the old key are verified again
+            pub_key = std::move(key);
+            token_cache.clear();
         }
     }
-    return public_key;
 }
 
-VerifyUserJWT::VerifyUserJWT(const std::string& host) : pub_key(GetPublicKey(host)) {}
+bool VerifyUserJWT::FindCachedToken(const std::string& audience, const std::string& token,
+                                    Network::VerifyUser::UserData& user_data) {
+    std::lock_guard lock{mutex};
+    const auto iter = token_cache.find(token);
+    if (iter == token_cache.end() || iter->second.audience != audience) {
+        return false;
+    }
+    if (iter->second.expiry <= std::chrono::system_clock::now()) {
+        token_cache.erase(iter);
+        return false;
+    }
+    user_data = iter->second.user_data;
+    return true;
+}
+
+void VerifyUserJWT::CacheToken(const std::string& token, CachedToken cached) {
+    std::lock_guard lock{mutex};
+    if (token_cache.size() >= MaxCachedTokens) {
+        const auto now = std::chrono::system_clock::now();
+        for (auto iter = token_cache.begin(); iter != token_cache.end();) {
+            iter = iter->second.expiry <= now ? token_cache.erase(iter) : std::next(iter);
+        }
+        if (token_cache.size() >= MaxCachedTokens) {
+            token_cache.clear();
+        }
+    }
+    token_cache.insert_or_assign(token, std::move(cached));
+}
 
 Network::VerifyUser::UserData VerifyUserJWT::LoadUserData(const std::string& verify_UID,
                                                           const std::string& token) {
     const std::string audience = fmt::format("external-{}", verify_UID);
+    Network::VerifyUser::UserData user_data{};
+    if (FindCachedToken(audience, token, user_data)) {
+        return user_data;
+    }
+
+    std::string key;
+    {
+        std::lock_guard lock{mutex};
+        key = pub_key;
+    }
     using namespace jwt::params;
     std::error_code error;
     auto decoded =
-        jwt::decode(token, algorithms({"rs256"}), error, secret(pub_key), issuer("citra-core"),
+        jwt::decode(token, algorithms({"rs256"}), error, secret(key), issuer("citra-core"),
                     aud(audience), validate_iat(true), validate_jti(true));
     if (error) {
         LOG_INFO(WebService, "Verification failed: category={}, code={}, message={}",
                  error.category().name(), error.value(), error.message());
         return {};
     }
-    Network::VerifyUser::UserData user_data{};
     if (decoded.payload().has_claim("username")) {
         user_data.username = decoded.payload().get_claim_value<std::string>("username");
     }
@@ -54,6 +130,14 @@ Network::VerifyUser::UserData VerifyUserJWT::LoadUserData(const std::string& ver
         auto roles = decoded.payload().get_claim_value<std::vector<std::string>>("roles");
         user_data.moderator = std::find(roles.begin(), roles.end(), "moderator") != roles.end();
     }
+
+    auto expiry = std::chrono::system_clock::now() + MaxTokenLifetime;
+    if (decoded.payload().has_claim("exp")) {
+        const std::chrono::system_clock::time_point token_expiry{
+            std::chrono::seconds{decoded.payload().get_claim_value<uint64_t>("exp")}};
+        expiry = std::min(expiry, token_expiry);
+    }
+    CacheToken(token, {audience, user_data, expiry});
     return user_data;
 }
 
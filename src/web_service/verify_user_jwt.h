@@ -4,22 +4,54 @@
 
 #pragma once
 
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <fmt/format.h>
+#include "common/thread.h"
 #include "network/verify_user.h"
 #include "web_service/web_backend.h"
 
 namespace WebService {
 
+/**
+ * Verifies the JWTs of the web service. Tokens that verified are cached until they expire, so that
+ * members who reconnect are not verified again, and the public key is refreshed in the background.
+ * LoadUserData may be called from several threads at once.
+ */
 class VerifyUserJWT final : public Network::VerifyUser::Backend {
 public:
     VerifyUserJWT(const std::string& host);
-    ~VerifyUserJWT() = default;
+    ~VerifyUserJWT();
 
     Network::VerifyUser::UserData LoadUserData(const std::string& verify_UID,
                                                const std::string& token) override;
 
 private:
+    struct CachedToken {
+        std::string audience;
+        Network::VerifyUser::UserData user_data;
+        std::chrono::system_clock::time_point expiry;
+    };
+
+    /// Returns the cached user data of a token, false if it is not cached or expired
+    bool FindCachedToken(const std::string& audience, const std::string& token,
+                         Network::VerifyUser::UserData& user_data);
+
+    void CacheToken(const std::string& token, CachedToken cached);
+
+    void RefreshLoop();
+
+    const std::string host;
+
+    std::mutex mutex;
     std::string pub_key;
+    std::unordered_map<std::string, CachedToken> token_cache;
+
+    std::thread refresh_thread;
+    Common::Event stop_event;
 };
 
 } // namespace WebService
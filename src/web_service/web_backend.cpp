@@ -38,7 +38,8 @@ struct Client::Impl {
     /// A generic function handles POST, GET and DELETE request together
     Common::WebResult GenericRequest(const std::string& method, const std::string& path,
                                      const std::string& data, bool allow_anonymous,
-                                     const std::string& accept) {
+                                     const std::string& accept,
+                                     CacheValidators* validators = nullptr) {
         if (jwt.empty()) {
             UpdateJWT();
         }
@@ -49,11 +50,11 @@ struct Client::Impl {
                                      "Credentials needed"};
         }
 
-        auto result = GenericRequest(method, path, data, accept, jwt);
+        auto result = GenericRequest(method, path, data, accept, jwt, "", "", validators);
         if (result.result_string == "401") {
             // Try again with new JWT
             UpdateJWT();
-            result = GenericRequest(method, path, data, accept, jwt);
+            result = GenericRequest(method, path, data, accept, jwt, "", "", validators);
         }
 
         return result;
@@ -64,11 +65,13 @@ struct Client::Impl {
      * JWT is used if the jwt parameter is not empty
      * username + token is used if jwt is empty but username and token are
      * not empty anonymous if all of jwt, username and token are empty
+     * The request is conditional if validators are given
      */
     Common::WebResult GenericRequest(const std::string& method, const std::string& path,
                                      const std::string& data, const std::string& accept,
                                      const std::string& jwt = "", const std::string& username = "",
-                                     const std::string& token = "") {
+                                     const std::string& token = "",
+                                     CacheValidators* validators = nullptr) {
         if (cli == nullptr) {
             auto parsedUrl = LUrlParser::clParseURL::ParseURL(host);
             int port;
@@ -111,6 +114,12 @@ struct Client::Impl {
         if (method != "GET") {
             params.emplace(std::string("Content-Type"), std::string("application/json"));
         };
+        if (validators && !validators->etag.empty()) {
+            params.emplace(std::string("If-None-Match"), validators->etag);
+        }
+        if (validators && !validators->last_modified.empty()) {
+            params.emplace(std::string("If-Modified-Since"), validators->last_modified);
+        }
 
         httplib::Request request;
         request.method = method;
@@ -132,6 +141,10 @@ struct Client::Impl {
                                      std::to_string(response.status)};
         }
 
+        if (validators && response.status == 304) {
+            return Common::WebResult{Common::WebResult::Code::NotModified, "304"};
+        }
+
         auto content_type = response.headers.find("content-type");
 
         if (content_type == response.headers.end()) {
@@ -144,6 +157,11 @@ struct Client::Impl {
                       content_type->second);
             return Common::WebResult{Common::WebResult::Code::WrongContent, "Wrong content"};
         }
+
+        if (validators) {
+            validators->etag = response.get_header_value("ETag");
+            validators->last_modified = response.get_header_value("Last-Modified");
+        }
         return Common::WebResult{Common::WebResult::Code::Success, "", response.body};
     }
 
@@ -193,6 +211,11 @@ Common::WebResult Client::GetJson(const std::string& path, bool allow_anonymous)
     return impl->GenericRequest("GET", path, "", allow_anonymous, "application/json");
 }
 
+Common::WebResult Client::GetJsonIfModified(const std::string& path, bool allow_anonymous,
+                                           CacheValidators& validators) {
+    return impl->GenericRequest("GET", path, "", allow_anonymous, "application/json", &validators);
+}
+
 Common::WebResult Client::DeleteJson(const std::string& path, const std::string& data,
                                      bool allow_anonymous) {
     return impl->GenericRequest("DELETE", path, data, allow_anonymous, "application/json");
@@ -13,6 +13,12 @@ struct WebResult;
 
 namespace WebService {
 
+/// Identifies the version of a resource received, for conditional requests
+struct CacheValidators {
+    std::string etag;
+    std::string last_modified;
+};
+
 class Client {
 public:
     Client(std::string host, std::string username, std::string token);
@@ -36,6 +42,16 @@ public:
      */
     Common::WebResult GetJson(const std::string& path, bool allow_anonymous);
 
+    /**
+     * Gets JSON from the specified path, unless it didn't change since a previous request.
+     * @param path the URL segment after the host address.
+     * @param allow_anonymous If true, allow anonymous unauthenticated requests.
+     * @param validators the validators of the previous reply, replaced by those of this one.
+     * @return the result of the request, NotModified when the previous reply is still current.
+     */
+    Common::WebResult GetJsonIfModified(const std::string& path, bool allow_anonymous,
+                                        CacheValidators& validators);
+
     /**
      * Deletes JSON to the specified path.
      * @param path the URL segment after the host address.